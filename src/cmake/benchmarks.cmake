@@ -0,0 +1,41 @@
+include_directories(${PROJECT_SOURCE_DIR}/mavsdk/core)
+include_directories(${PROJECT_SOURCE_DIR}/third_party/mavlink/include)
+
+find_package(benchmark REQUIRED)
+
+add_executable(mavsdk_benchmarks
+    ${BENCHMARK_SOURCES}
+)
+
+set_target_properties(mavsdk_benchmarks
+    PROPERTIES COMPILE_FLAGS ${warnings}
+)
+
+target_link_libraries(mavsdk_benchmarks
+    mavsdk
+    benchmark::benchmark
+    benchmark::benchmark_main
+)
+
+if(TARGET mavsdk_server AND SERVER_BENCHMARK_SOURCES)
+    target_sources(mavsdk_benchmarks PRIVATE ${SERVER_BENCHMARK_SOURCES})
+
+    target_include_directories(mavsdk_benchmarks
+        PRIVATE
+        ${PROJECT_SOURCE_DIR}/mavsdk_server/src
+        ${PROJECT_SOURCE_DIR}/mavsdk_server/src/plugins
+        ${PROJECT_SOURCE_DIR}/mavsdk
+        ${PROJECT_SOURCE_DIR}/mavsdk/plugins
+    )
+
+    target_include_directories(mavsdk_benchmarks
+        SYSTEM
+        PRIVATE
+        ${PROJECT_SOURCE_DIR}/mavsdk_server/src/generated
+    )
+
+    target_link_libraries(mavsdk_benchmarks
+        mavsdk_server
+        gRPC::grpc++
+    )
+endif()
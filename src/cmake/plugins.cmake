@@ -0,0 +1,103 @@
+# Selection of the plugins built into the mavsdk library and served by
+# mavsdk_server, e.g.
+#
+#   -DMAVSDK_PLUGINS="action;mission;telemetry;param;offboard"
+#
+# Plugins needed by the selected ones are added, and so are the optional parts
+# of the core and third party libraries they use. Leaving them out saves the
+# binary size and the startup cost (relocations, static initialization, pages
+# touched) of everything unused. The integration tests and the mavsdk_server
+# tests need all plugins and are skipped otherwise.
+
+set(MAVSDK_ALL_PLUGINS
+    action
+    action_server
+    calibration
+    camera
+    component_information
+    component_information_server
+    failure
+    follow_me
+    ftp
+    geofence
+    gimbal
+    info
+    log_files
+    logging
+    manual_control
+    mavlink_passthrough
+    mission
+    mission_raw
+    mission_raw_server
+    mocap
+    offboard
+    param
+    param_server
+    rtk
+    server_utility
+    shell
+    telemetry
+    telemetry_server
+    tracking_server
+    transponder
+    tune
+)
+
+set(MAVSDK_PLUGINS "all" CACHE STRING
+    "Plugins to build, separated by semicolons, or all")
+
+# What a plugin needs apart from the core, other plugins first:
+#   http: HttpLoader and libcurl in the core
+#   jsoncpp, tinyxml2, lzma: the third party libraries
+set(MAVSDK_PLUGIN_DEPENDS_camera http tinyxml2)
+set(MAVSDK_PLUGIN_DEPENDS_component_information http jsoncpp lzma)
+set(MAVSDK_PLUGIN_DEPENDS_component_information_server jsoncpp)
+
+if("${MAVSDK_PLUGINS}" STREQUAL "all")
+    set(MAVSDK_ENABLED_PLUGINS ${MAVSDK_ALL_PLUGINS})
+else()
+    set(MAVSDK_ENABLED_PLUGINS "")
+    set(pending_plugins ${MAVSDK_PLUGINS})
+    while(pending_plugins)
+        list(GET pending_plugins 0 plugin)
+        list(REMOVE_AT pending_plugins 0)
+        if(NOT plugin IN_LIST MAVSDK_ALL_PLUGINS)
+            message(FATAL_ERROR "Unknown plugin '${plugin}' in MAVSDK_PLUGINS")
+        endif()
+        if(NOT plugin IN_LIST MAVSDK_ENABLED_PLUGINS)
+            list(APPEND MAVSDK_ENABLED_PLUGINS ${plugin})
+            foreach(dependency ${MAVSDK_PLUGIN_DEPENDS_${plugin}})
+                if(dependency IN_LIST MAVSDK_ALL_PLUGINS)
+                    list(APPEND pending_plugins ${dependency})
+                endif()
+            endforeach()
+        endif()
+    endwhile()
+endif()
+
+set(MAVSDK_WITH_HTTP OFF)
+set(MAVSDK_WITH_JSONCPP OFF)
+set(MAVSDK_WITH_TINYXML2 OFF)
+set(MAVSDK_WITH_LZMA OFF)
+foreach(plugin ${MAVSDK_ENABLED_PLUGINS})
+    foreach(dependency ${MAVSDK_PLUGIN_DEPENDS_${plugin}})
+        if(dependency STREQUAL "http")
+            set(MAVSDK_WITH_HTTP ON)
+        elseif(dependency STREQUAL "jsoncpp")
+            set(MAVSDK_WITH_JSONCPP ON)
+        elseif(dependency STREQUAL "tinyxml2")
+            set(MAVSDK_WITH_TINYXML2 ON)
+        elseif(dependency STREQUAL "lzma")
+            set(MAVSDK_WITH_LZMA ON)
+        endif()
+    endforeach()
+endforeach()
+
+list(LENGTH MAVSDK_ENABLED_PLUGINS num_enabled_plugins)
+list(LENGTH MAVSDK_ALL_PLUGINS num_all_plugins)
+if(num_enabled_plugins EQUAL num_all_plugins)
+    set(MAVSDK_ALL_PLUGINS_ENABLED ON)
+else()
+    set(MAVSDK_ALL_PLUGINS_ENABLED OFF)
+    message(STATUS "Building plugins: ${MAVSDK_ENABLED_PLUGINS}")
+endif()
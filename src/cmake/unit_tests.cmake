@@ -1,7 +1,6 @@
 include_directories(${PROJECT_SOURCE_DIR}/mavsdk/core)
 include_directories(${PROJECT_SOURCE_DIR}/third_party/mavlink/include)
 
-find_package(jsoncpp REQUIRED)
 
 add_executable(unit_tests_runner
     ${UNIT_TEST_SOURCES}
@@ -15,13 +14,20 @@ set_target_properties(unit_tests_runner
 
 target_link_libraries(unit_tests_runner
     mavsdk
-    CURL::libcurl
-    JsonCpp::JsonCpp
     gtest
     gtest_main
     gmock
 )
 
+if(MAVSDK_WITH_HTTP)
+    target_link_libraries(unit_tests_runner CURL::libcurl)
+endif()
+
+if(MAVSDK_WITH_JSONCPP)
+    find_package(jsoncpp REQUIRED)
+    target_link_libraries(unit_tests_runner JsonCpp::JsonCpp)
+endif()
+
 if (MSVC AND BUILD_SHARED_LIBS)
     target_compile_definitions(unit_tests_runner PRIVATE -DGTEST_LINKED_AS_SHARED_LIBRARY)
     set_target_properties(unit_tests_runner
@@ -17,22 +17,26 @@ TEST_F(SitlTest, PX4Logging)
     auto system = mavsdk.systems().at(0);
     ASSERT_TRUE(system->has_autopilot());
     auto logging = std::make_shared<Logging>(system);
-    Logging::Result log_ret = logging->start_logging();
+    Logging::Result log_ret = logging->start_logging("streamed.ulg");
 
-    if (log_ret == Logging::Result::COMMAND_DENIED) {
+    if (log_ret == Logging::Result::CommandDenied) {
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
         logging->stop_logging();
-        // ASSERT_EQ(log_ret, Logging::Result::SUCCESS);
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        log_ret = logging->start_logging();
+        log_ret = logging->start_logging("streamed.ulg");
     }
 
-    ASSERT_EQ(log_ret, Logging::Result::SUCCESS);
+    ASSERT_EQ(log_ret, Logging::Result::Success);
 
     for (unsigned i = 0; i < 10; ++i) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
 
     log_ret = logging->stop_logging();
-    ASSERT_EQ(log_ret, Logging::Result::SUCCESS);
+    ASSERT_EQ(log_ret, Logging::Result::Success);
+
+    const auto stats = logging->stats();
+    LogInfo() << "Streamed " << stats.bytes_written << " bytes, lost " << stats.packets_lost
+              << " of " << stats.packets_received + stats.packets_lost << " packets";
+    EXPECT_GT(stats.bytes_written, 0u);
 }
@@ -0,0 +1,292 @@
+#include "allocation_tracker.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace mavsdk {
+
+namespace {
+
+// All of these are constant initialized, so they can be used by an operator
+// new called before main or while a thread is being torn down.
+thread_local AllocationRegion current_region{AllocationRegion::Other};
+thread_local AllocationTracker::Counts this_thread_counts{};
+
+} // namespace
+
+std::array<AllocationTracker::Slot, AllocationTracker::MAX_THREADS> AllocationTracker::_slots{};
+AllocationTracker::Slot AllocationTracker::_total{};
+
+uint64_t AllocationTracker::Counts::total_allocations() const
+{
+    uint64_t sum = 0;
+    for (const auto count : allocations) {
+        sum += count;
+    }
+    return sum;
+}
+
+AllocationTracker::Counts AllocationTracker::this_thread()
+{
+    return this_thread_counts;
+}
+
+AllocationTracker::Counts AllocationTracker::total()
+{
+    return counts_of(_total);
+}
+
+std::vector<AllocationTracker::ThreadCounts> AllocationTracker::threads()
+{
+    std::vector<ThreadCounts> result;
+    for (std::size_t i = 0; i < _slots.size(); ++i) {
+        if (!_slots[i].claimed.load(std::memory_order_acquire)) {
+            // Slots are claimed in order.
+            break;
+        }
+        result.push_back(ThreadCounts{static_cast<uint32_t>(i), counts_of(_slots[i])});
+    }
+    return result;
+}
+
+void AllocationTracker::reset()
+{
+    clear(_total);
+    for (auto& slot : _slots) {
+        clear(slot);
+    }
+}
+
+const char* AllocationTracker::region_name(AllocationRegion region)
+{
+    switch (region) {
+        case AllocationRegion::Other:
+            return "other";
+        case AllocationRegion::Receive:
+            return "receive";
+        case AllocationRegion::Dispatch:
+            return "dispatch";
+        case AllocationRegion::Callback:
+            return "callback";
+        case AllocationRegion::Send:
+            return "send";
+    }
+    return "unknown";
+}
+
+void AllocationTracker::record(std::size_t bytes)
+{
+    const auto index = static_cast<std::size_t>(current_region);
+
+    ++this_thread_counts.allocations[index];
+    this_thread_counts.bytes[index] += bytes;
+
+    _total.allocations[index].fetch_add(1, std::memory_order_relaxed);
+    _total.bytes[index].fetch_add(bytes, std::memory_order_relaxed);
+
+    if (auto* slot = slot_of_this_thread()) {
+        // Only ever written by this thread, so there is no need for an
+        // atomic increment.
+        auto& allocations = slot->allocations[index];
+        allocations.store(
+            allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        auto& slot_bytes = slot->bytes[index];
+        slot_bytes.store(
+            slot_bytes.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+    }
+}
+
+AllocationTracker::Slot* AllocationTracker::slot_of_this_thread()
+{
+    thread_local Slot* slot{nullptr};
+    thread_local bool searched{false};
+
+    if (!searched) {
+        searched = true;
+        for (auto& candidate : _slots) {
+            bool expected = false;
+            if (candidate.claimed.compare_exchange_strong(
+                    expected, true, std::memory_order_acq_rel)) {
+                slot = &candidate;
+                break;
+            }
+        }
+    }
+    return slot;
+}
+
+AllocationTracker::Counts AllocationTracker::counts_of(const Slot& slot)
+{
+    Counts counts;
+    for (std::size_t i = 0; i < NUM_REGIONS; ++i) {
+        counts.allocations[i] = slot.allocations[i].load(std::memory_order_relaxed);
+        counts.bytes[i] = slot.bytes[i].load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+void AllocationTracker::clear(Slot& slot)
+{
+    for (std::size_t i = 0; i < NUM_REGIONS; ++i) {
+        slot.allocations[i].store(0, std::memory_order_relaxed);
+        slot.bytes[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+AllocationTracker::Scope::Scope(AllocationRegion region) : _previous(current_region)
+{
+    current_region = region;
+}
+
+AllocationTracker::Scope::~Scope()
+{
+    current_region = _previous;
+}
+
+} // namespace mavsdk
+
+#if MAVSDK_ALLOCATION_TRACKING
+
+// The replacements of the global allocation functions. Everything is
+// allocated with malloc, as the default ones do, so memory allocated before
+// or without them can still be freed.
+
+namespace {
+
+void* tracked_allocate(std::size_t size)
+{
+    mavsdk::AllocationTracker::record(size);
+    return std::malloc(size != 0 ? size : 1);
+}
+
+void* tracked_allocate_aligned(std::size_t size, std::align_val_t alignment)
+{
+    mavsdk::AllocationTracker::record(size);
+    const auto align = static_cast<std::size_t>(alignment);
+#if defined(_WIN32)
+    return _aligned_malloc(size != 0 ? size : 1, align);
+#else
+    // The size needs to be a multiple of the alignment.
+    const auto rounded = ((size != 0 ? size : 1) + align - 1) / align * align;
+    return std::aligned_alloc(align, rounded);
+#endif
+}
+
+void free_aligned(void* ptr)
+{
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    if (void* ptr = tracked_allocate(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return tracked_allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return tracked_allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void* ptr = tracked_allocate_aligned(size, alignment)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return tracked_allocate_aligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return tracked_allocate_aligned(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    free_aligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    free_aligned(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    free_aligned(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    free_aligned(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    free_aligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    free_aligned(ptr);
+}
+
+#endif
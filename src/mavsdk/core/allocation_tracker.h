@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Counting allocations replaces the global operator new of the whole program,
+// so it is only built in with MAVSDK_ALLOCATION_TRACKING=1. Otherwise the
+// regions are compiled out and nothing is counted.
+#if !defined(MAVSDK_ALLOCATION_TRACKING)
+#define MAVSDK_ALLOCATION_TRACKING 0
+#endif
+
+#if MAVSDK_ALLOCATION_TRACKING
+
+#define MAVSDK_ALLOCATION_CONCAT_(a, b) a##b
+#define MAVSDK_ALLOCATION_CONCAT(a, b) MAVSDK_ALLOCATION_CONCAT_(a, b)
+
+// Counts the allocations of the rest of the enclosing block in the region.
+#define MAVSDK_ALLOCATION_REGION(region) \
+    mavsdk::AllocationTracker::Scope MAVSDK_ALLOCATION_CONCAT(allocation_scope_, __LINE__)( \
+        mavsdk::AllocationRegion::region)
+
+#else
+
+#define MAVSDK_ALLOCATION_REGION(region) static_cast<void>(0)
+
+#endif
+
+namespace mavsdk {
+
+// Where on the way of a message an allocation happened. A region nested in
+// another one counts its allocations on its own, e.g. the dispatch started
+// from the receive path.
+enum class AllocationRegion : uint8_t { Other, Receive, Dispatch, Callback, Send };
+
+// Counts heap allocations done with operator new, per thread and per region.
+//
+// This is meant to find allocations on the hot paths, which should not
+// allocate anything per message once warmed up. Each thread counts into its
+// own slot, so counting never takes a lock. Allocations done with malloc
+// directly are not seen.
+class AllocationTracker {
+public:
+    static constexpr std::size_t NUM_REGIONS = 5;
+    // Threads after these are only counted in the total.
+    static constexpr std::size_t MAX_THREADS = 64;
+
+    struct Counts {
+        std::array<uint64_t, NUM_REGIONS> allocations{};
+        std::array<uint64_t, NUM_REGIONS> bytes{};
+
+        [[nodiscard]] uint64_t allocations_in(AllocationRegion region) const
+        {
+            return allocations[static_cast<std::size_t>(region)];
+        }
+
+        [[nodiscard]] uint64_t total_allocations() const;
+    };
+
+    struct ThreadCounts {
+        // In the order the threads first allocated.
+        uint32_t thread_number{0};
+        Counts counts{};
+    };
+
+    [[nodiscard]] static constexpr bool enabled() { return MAVSDK_ALLOCATION_TRACKING != 0; }
+
+    // Of the calling thread since it started, not affected by reset(). Cheap
+    // enough to compare before and after something ran.
+    [[nodiscard]] static Counts this_thread();
+
+    // Since the last reset.
+    [[nodiscard]] static Counts total();
+    [[nodiscard]] static std::vector<ThreadCounts> threads();
+    static void reset();
+
+    [[nodiscard]] static const char* region_name(AllocationRegion region);
+
+    // Called by operator new.
+    static void record(std::size_t bytes);
+
+    class Scope {
+    public:
+        explicit Scope(AllocationRegion region);
+        ~Scope();
+
+        // Non-copyable
+        Scope(const Scope&) = delete;
+        const Scope& operator=(const Scope&) = delete;
+
+    private:
+        AllocationRegion _previous;
+    };
+
+private:
+    struct Slot {
+        std::atomic<bool> claimed{false};
+        std::array<std::atomic<uint64_t>, NUM_REGIONS> allocations{};
+        std::array<std::atomic<uint64_t>, NUM_REGIONS> bytes{};
+    };
+
+    static Slot* slot_of_this_thread();
+    static Counts counts_of(const Slot& slot);
+    static void clear(Slot& slot);
+
+    static std::array<Slot, MAX_THREADS> _slots;
+    static Slot _total;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,165 @@
+#include "allocation_tracker.h"
+
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+#include "mavlink_message_handler.h"
+#include "mavlink_receiver.h"
+
+using namespace mavsdk;
+
+namespace {
+
+// Keeps the compiler from leaving out an allocation that is freed right away.
+void* volatile sink = nullptr;
+
+void allocate_one()
+{
+    sink = new int(42);
+    delete static_cast<int*>(sink);
+}
+
+std::vector<char> make_heartbeats(unsigned count)
+{
+    std::vector<char> stream;
+    mavlink_message_t message;
+    for (unsigned i = 0; i < count; ++i) {
+        mavlink_msg_heartbeat_pack(
+            1, 1, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const uint16_t len = mavlink_msg_to_send_buffer(buffer, &message);
+        stream.insert(stream.end(), buffer, buffer + len);
+    }
+    return stream;
+}
+
+} // namespace
+
+TEST(AllocationTracker, CountsNothingWhenDisabled)
+{
+    if (AllocationTracker::enabled()) {
+        GTEST_SKIP() << "Built with MAVSDK_ALLOCATION_TRACKING";
+    }
+
+    allocate_one();
+    EXPECT_EQ(AllocationTracker::this_thread().total_allocations(), 0);
+    EXPECT_EQ(AllocationTracker::total().total_allocations(), 0);
+}
+
+TEST(AllocationTracker, CountsPerRegion)
+{
+    if (!AllocationTracker::enabled()) {
+        GTEST_SKIP() << "Built without MAVSDK_ALLOCATION_TRACKING";
+    }
+
+    const auto before = AllocationTracker::this_thread();
+    {
+        MAVSDK_ALLOCATION_REGION(Receive);
+        allocate_one();
+        {
+            MAVSDK_ALLOCATION_REGION(Dispatch);
+            allocate_one();
+            allocate_one();
+        }
+        allocate_one();
+    }
+    allocate_one();
+    const auto after = AllocationTracker::this_thread();
+
+    const auto delta = [&](AllocationRegion region) {
+        return after.allocations_in(region) - before.allocations_in(region);
+    };
+    EXPECT_EQ(delta(AllocationRegion::Receive), 2);
+    EXPECT_EQ(delta(AllocationRegion::Dispatch), 2);
+    EXPECT_EQ(delta(AllocationRegion::Callback), 0);
+    EXPECT_EQ(delta(AllocationRegion::Send), 0);
+    EXPECT_GE(delta(AllocationRegion::Other), 1);
+    EXPECT_GE(
+        after.bytes[static_cast<std::size_t>(AllocationRegion::Receive)] -
+            before.bytes[static_cast<std::size_t>(AllocationRegion::Receive)],
+        2 * sizeof(int));
+}
+
+TEST(AllocationTracker, CountsPerThread)
+{
+    if (!AllocationTracker::enabled()) {
+        GTEST_SKIP() << "Built without MAVSDK_ALLOCATION_TRACKING";
+    }
+
+    AllocationTracker::reset();
+    {
+        MAVSDK_ALLOCATION_REGION(Send);
+        allocate_one();
+    }
+
+    EXPECT_GE(AllocationTracker::total().allocations_in(AllocationRegion::Send), 1);
+
+    const auto threads = AllocationTracker::threads();
+    ASSERT_FALSE(threads.empty());
+    uint64_t send_allocations = 0;
+    for (const auto& thread : threads) {
+        send_allocations += thread.counts.allocations_in(AllocationRegion::Send);
+    }
+    EXPECT_GE(send_allocations, 1);
+}
+
+TEST(AllocationTracker, MessageHandlerDoesNotAllocatePerMessage)
+{
+    if (!AllocationTracker::enabled()) {
+        GTEST_SKIP() << "Built without MAVSDK_ALLOCATION_TRACKING";
+    }
+
+    MAVLinkMessageHandler handler{};
+    unsigned heartbeats = 0;
+    const int cookie = 0;
+    handler.register_one(
+        MAVLINK_MSG_ID_HEARTBEAT, [&](const mavlink_message_t&) { ++heartbeats; }, &cookie);
+
+    mavlink_message_t message{};
+    message.msgid = MAVLINK_MSG_ID_HEARTBEAT;
+    message.compid = 1;
+
+    for (unsigned i = 0; i < 10; ++i) {
+        handler.process_message(message);
+    }
+
+    const auto before = AllocationTracker::this_thread();
+    for (unsigned i = 0; i < 1000; ++i) {
+        handler.process_message(message);
+    }
+    const auto after = AllocationTracker::this_thread();
+
+    EXPECT_EQ(heartbeats, 1010);
+    EXPECT_EQ(after.total_allocations() - before.total_allocations(), 0);
+}
+
+TEST(AllocationTracker, ReceiverDoesNotAllocatePerMessage)
+{
+    if (!AllocationTracker::enabled()) {
+        GTEST_SKIP() << "Built without MAVSDK_ALLOCATION_TRACKING";
+    }
+
+    auto stream = make_heartbeats(100);
+    MAVLinkReceiver receiver{nullptr};
+
+    const auto parse_all = [&]() {
+        unsigned parsed = 0;
+        receiver.set_new_datagram(stream.data(), static_cast<unsigned>(stream.size()));
+        while (receiver.parse_message()) {
+            ++parsed;
+        }
+        return parsed;
+    };
+
+    EXPECT_EQ(parse_all(), 100);
+
+    const auto before = AllocationTracker::this_thread();
+    unsigned parsed = 0;
+    for (unsigned i = 0; i < 10; ++i) {
+        parsed += parse_all();
+    }
+    const auto after = AllocationTracker::this_thread();
+
+    EXPECT_EQ(parsed, 1000);
+    EXPECT_EQ(after.total_allocations() - before.total_allocations(), 0);
+}
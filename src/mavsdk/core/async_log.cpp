@@ -0,0 +1,259 @@
+#include "async_log.h"
+#include "log.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace mavsdk {
+
+namespace {
+
+void write_to_console(const AsyncLog::Record& record)
+{
+    switch (record.level) {
+        case log::Level::Debug:
+            set_color(Color::Green);
+            break;
+        case log::Level::Info:
+            set_color(Color::Blue);
+            break;
+        case log::Level::Warn:
+            set_color(Color::Yellow);
+            break;
+        case log::Level::Err:
+            set_color(Color::Red);
+            break;
+    }
+
+    // Time output taken from:
+    // https://stackoverflow.com/questions/16357999#answer-16358264
+    // Only ever called by one thread at a time, so localtime is fine.
+    struct tm* timeinfo = localtime(&record.time);
+    char time_buffer[10]{}; // We need 8 characters + \0
+    strftime(time_buffer, sizeof(time_buffer), "%I:%M:%S", timeinfo);
+    std::cout << "[" << time_buffer;
+
+    switch (record.level) {
+        case log::Level::Debug:
+            std::cout << "|Debug] ";
+            break;
+        case log::Level::Info:
+            std::cout << "|Info ] ";
+            break;
+        case log::Level::Warn:
+            std::cout << "|Warn ] ";
+            break;
+        case log::Level::Err:
+            std::cout << "|Error] ";
+            break;
+    }
+
+    set_color(Color::Reset);
+
+    std::cout << record.text;
+    std::cout << " (" << record.filename << ":" << std::dec << record.line << ")";
+
+    std::cout << '\n';
+}
+
+bool rate_limit_enabled()
+{
+    static const bool enabled = []() {
+        const char* env_p = std::getenv("MAVSDK_LOG_RATE_LIMIT");
+        return env_p == nullptr || std::strcmp(env_p, "0") != 0;
+    }();
+    return enabled;
+}
+
+uint64_t now_ms()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+} // namespace
+
+AsyncLog::AsyncLog(Write write) : _write(std::move(write))
+{
+    for (std::size_t i = 0; i < CAPACITY; ++i) {
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    _thread = std::thread(&AsyncLog::run, this);
+}
+
+AsyncLog::~AsyncLog()
+{
+    stop();
+}
+
+AsyncLog& AsyncLog::instance()
+{
+    // This is never destroyed because anything, even the destructor of
+    // another static, might still log. The thread is stopped at exit instead.
+    static AsyncLog* instance = []() {
+        auto* async_log = new AsyncLog(write_to_console);
+        std::atexit([]() { AsyncLog::instance().stop(); });
+        return async_log;
+    }();
+    return *instance;
+}
+
+void AsyncLog::push(Record record)
+{
+    if (!_running.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(_direct_mutex);
+        // Something might have made it into the ring while stopping.
+        Record earlier;
+        while (pop(earlier)) {
+            _write(earlier);
+        }
+        _write(record);
+        return;
+    }
+
+    std::size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = _slots[pos % CAPACITY];
+        const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+        if (diff == 0) {
+            if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.record = std::move(record);
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                break;
+            }
+        } else if (diff < 0) {
+            // Full, the writer is behind.
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            _dropped_total.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = _enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Without the lock, at worst the wakeup is missed and the writer comes
+    // around on its own a bit later.
+    _cv.notify_one();
+}
+
+bool AsyncLog::has_record() const
+{
+    const std::size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+    return _slots[pos % CAPACITY].sequence.load(std::memory_order_acquire) == pos + 1;
+}
+
+bool AsyncLog::pop(Record& record)
+{
+    // There is only ever one reader, the thread or whoever stopped it.
+    if (!has_record()) {
+        return false;
+    }
+
+    const std::size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+    Slot& slot = _slots[pos % CAPACITY];
+
+    record = std::move(slot.record);
+    slot.record = {};
+    slot.sequence.store(pos + CAPACITY, std::memory_order_release);
+    _dequeue_pos.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+void AsyncLog::flush()
+{
+    const std::size_t target = _enqueue_pos.load(std::memory_order_acquire);
+    while (_running.load(std::memory_order_acquire) &&
+           _written.load(std::memory_order_acquire) < target) {
+        _cv.notify_one();
+        std::this_thread::yield();
+    }
+}
+
+void AsyncLog::stop()
+{
+    if (!_running.exchange(false)) {
+        return;
+    }
+
+    {
+        // Under the lock so the writer can't miss it before sleeping.
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cv.notify_one();
+    }
+    _thread.join();
+
+    std::lock_guard<std::mutex> lock(_direct_mutex);
+    Record record;
+    while (pop(record)) {
+        _write(record);
+    }
+    write_dropped();
+}
+
+void AsyncLog::run()
+{
+    Record record;
+    while (_running.load(std::memory_order_acquire)) {
+        if (pop(record)) {
+            write_dropped();
+            _write(record);
+            _written.fetch_add(1, std::memory_order_release);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait_for(lock, std::chrono::milliseconds(100), [this]() {
+            return !_running.load(std::memory_order_acquire) || has_record();
+        });
+    }
+}
+
+void AsyncLog::write_dropped()
+{
+    const auto dropped = _dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped == 0) {
+        return;
+    }
+
+    Record record;
+    record.level = log::Level::Warn;
+    record.time = std::time(nullptr);
+    record.text = std::to_string(dropped) + " log messages dropped, writing could not keep up";
+    record.filename = FILENAME;
+    record.line = __LINE__;
+    _write(record);
+}
+
+bool LogRateLimit::allow(uint32_t& suppressed)
+{
+    suppressed = 0;
+
+    if (!rate_limit_enabled()) {
+        return true;
+    }
+
+    const uint64_t now = now_ms();
+    uint64_t window_start_ms = _window_start_ms.load(std::memory_order_relaxed);
+    if (now - window_start_ms >= WINDOW_MS &&
+        _window_start_ms.compare_exchange_strong(
+            window_start_ms, now, std::memory_order_relaxed)) {
+        _count.store(0, std::memory_order_relaxed);
+    }
+
+    if (_count.fetch_add(1, std::memory_order_relaxed) < MAX_PER_WINDOW) {
+        suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    _suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+} // namespace mavsdk
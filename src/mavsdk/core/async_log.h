@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "log_callback.h"
+
+namespace mavsdk {
+
+// Writes the log on a thread of its own, so logging never blocks on a slow
+// console or a pipe to journald.
+//
+// Records are handed over through a bounded lock-free ring, each slot having
+// a sequence number telling whether it is free or filled (Vyukov's bounded
+// queue). If the writer can't keep up and the ring is full, records are
+// dropped and counted, the count is written with the next record.
+class AsyncLog {
+public:
+    struct Record {
+        log::Level level{log::Level::Debug};
+        std::time_t time{0};
+        std::string text{};
+        const char* filename{nullptr};
+        int line{0};
+    };
+
+    using Write = std::function<void(const Record&)>;
+
+    static constexpr std::size_t CAPACITY = 1024;
+
+    explicit AsyncLog(Write write);
+    ~AsyncLog();
+
+    // Non-copyable
+    AsyncLog(const AsyncLog&) = delete;
+    const AsyncLog& operator=(const AsyncLog&) = delete;
+
+    // The one writing to the console. It is stopped at exit, anything logged
+    // after that is written directly.
+    static AsyncLog& instance();
+
+    void push(Record record);
+
+    // Waits until everything pushed before was written.
+    void flush();
+
+    // Writes what is left and stops the thread.
+    void stop();
+
+    [[nodiscard]] uint64_t dropped() const { return _dropped_total.load(); }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence{0};
+        Record record{};
+    };
+
+    bool has_record() const;
+    bool pop(Record& record);
+    void run();
+    void write_dropped();
+
+    const Write _write;
+
+    std::array<Slot, CAPACITY> _slots{};
+    alignas(64) std::atomic<std::size_t> _enqueue_pos{0};
+    alignas(64) std::atomic<std::size_t> _dequeue_pos{0};
+    std::atomic<std::size_t> _written{0};
+
+    std::atomic<uint64_t> _dropped{0};
+    std::atomic<uint64_t> _dropped_total{0};
+
+    // Only for the writer to sleep on, pushing never takes it.
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+
+    // Serializes writing directly once stopped.
+    std::mutex _direct_mutex{};
+
+    std::atomic<bool> _running{true};
+    std::thread _thread{};
+};
+
+// Limits how often a single LogX() call site writes, so a message in a hot
+// path can't flood the log. The limit can be turned off by setting the
+// environment variable MAVSDK_LOG_RATE_LIMIT to 0.
+class LogRateLimit {
+public:
+    static constexpr uint32_t MAX_PER_WINDOW = 20;
+    static constexpr uint64_t WINDOW_MS = 1000;
+
+    // Whether the call may write now. If so, suppressed is set to the
+    // number of messages suppressed since the last one written.
+    bool allow(uint32_t& suppressed);
+
+private:
+    std::atomic<uint64_t> _window_start_ms{0};
+    std::atomic<uint32_t> _count{0};
+    std::atomic<uint32_t> _suppressed{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,119 @@
+#include "async_log.h"
+#include "log.h"
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+AsyncLog::Record make_record(const std::string& text)
+{
+    AsyncLog::Record record;
+    record.level = log::Level::Info;
+    record.text = text;
+    record.filename = "async_log_test.cpp";
+    record.line = 1;
+    return record;
+}
+
+} // namespace
+
+TEST(AsyncLog, WritesRecordsInOrder)
+{
+    std::mutex mutex;
+    std::vector<std::string> written;
+
+    auto async_log = std::make_unique<AsyncLog>([&](const AsyncLog::Record& record) {
+        std::lock_guard<std::mutex> lock(mutex);
+        written.push_back(record.text);
+    });
+
+    for (int i = 0; i < 100; ++i) {
+        async_log->push(make_record(std::to_string(i)));
+    }
+    async_log->flush();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(written.size(), 100u);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(written[i], std::to_string(i));
+    }
+}
+
+TEST(AsyncLog, DropsWhenWriterIsBehind)
+{
+    std::promise<void> unblock;
+    auto unblocked = unblock.get_future().share();
+    std::atomic<unsigned> written{0};
+
+    auto async_log = std::make_unique<AsyncLog>([&](const AsyncLog::Record&) {
+        unblocked.wait();
+        ++written;
+    });
+
+    // The first one blocks the writer, the ring takes the next CAPACITY.
+    const unsigned pushed = AsyncLog::CAPACITY + 50;
+    for (unsigned i = 0; i < pushed; ++i) {
+        async_log->push(make_record("spam"));
+    }
+    EXPECT_GE(async_log->dropped(), 49u);
+    EXPECT_LE(async_log->dropped(), 50u);
+
+    unblock.set_value();
+    async_log->stop();
+
+    // Everything not dropped, plus the note about the dropped ones.
+    EXPECT_EQ(written, pushed - async_log->dropped() + 1);
+}
+
+TEST(AsyncLog, WritesDirectlyOnceStopped)
+{
+    std::vector<std::string> written;
+
+    AsyncLog async_log([&](const AsyncLog::Record& record) { written.push_back(record.text); });
+    async_log.stop();
+
+    async_log.push(make_record("after"));
+    ASSERT_EQ(written.size(), 1u);
+    EXPECT_EQ(written[0], "after");
+}
+
+TEST(LogRateLimit, SuppressesBurstsAndCountsThem)
+{
+    LogRateLimit rate_limit;
+    uint32_t suppressed = 0;
+
+    for (uint32_t i = 0; i < LogRateLimit::MAX_PER_WINDOW; ++i) {
+        EXPECT_TRUE(rate_limit.allow(suppressed));
+        EXPECT_EQ(suppressed, 0u);
+    }
+
+    EXPECT_FALSE(rate_limit.allow(suppressed));
+    EXPECT_FALSE(rate_limit.allow(suppressed));
+}
+
+TEST(Log, CallSitesAreLimitedOnTheirOwn)
+{
+    std::vector<std::string> written;
+    log::subscribe([&](log::Level, const std::string& message, const std::string&, int) {
+        written.push_back(message);
+        return true;
+    });
+
+    for (uint32_t i = 0; i < LogRateLimit::MAX_PER_WINDOW + 5; ++i) {
+        LogDebug() << "spam";
+    }
+    LogDebug() << "other";
+
+    log::subscribe(nullptr);
+
+    ASSERT_EQ(written.size(), LogRateLimit::MAX_PER_WINDOW + 1);
+    EXPECT_EQ(written.back(), "other");
+}
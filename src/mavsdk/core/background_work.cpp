@@ -0,0 +1,142 @@
+#include "background_work.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace mavsdk {
+
+BackgroundWork::BackgroundWork(ThreadPool& pool, PostCompletion post_completion) :
+    _pool(pool),
+    _state(std::make_shared<State>())
+{
+    _state->post_completion = std::move(post_completion);
+}
+
+BackgroundWork::~BackgroundWork()
+{
+    stop();
+}
+
+void BackgroundWork::post(Task task, const void* cookie, const void* origin)
+{
+    {
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        if (_state->stopped) {
+            return;
+        }
+        auto job = std::make_shared<Job>();
+        job->cookie = cookie;
+        job->origin = origin;
+        job->task = std::move(task);
+        _state->queue.push_back(job);
+        _state->jobs.push_back(std::move(job));
+    }
+
+    // One run for each task posted. Whatever got cancelled in the meantime
+    // leaves a run with nothing to do.
+    _pool.post([state = _state]() { run_next(state); });
+}
+
+void BackgroundWork::cancel(const void* cookie)
+{
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    cancel_if(*_state, lock, [cookie](const Job& job) { return job.cookie == cookie; });
+}
+
+void BackgroundWork::stop()
+{
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    _state->stopped = true;
+    cancel_if(*_state, lock, [](const Job&) { return true; });
+}
+
+void BackgroundWork::run_next(const std::shared_ptr<State>& state)
+{
+    std::shared_ptr<Job> job;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->queue.empty()) {
+            return;
+        }
+        job = std::move(state->queue.front());
+        state->queue.pop_front();
+        job->running = true;
+    }
+
+    auto completion = job->task();
+    job->task = nullptr;
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    job->running = false;
+    if (job->cancelled || !completion) {
+        finish(*state, job);
+        return;
+    }
+    lock.unlock();
+
+    const auto* origin = job->origin;
+    state->post_completion(
+        [state, job, completion = std::move(completion)]() mutable {
+            run_completion(state, job, completion);
+        },
+        origin);
+}
+
+void BackgroundWork::run_completion(
+    const std::shared_ptr<State>& state, const std::shared_ptr<Job>& job, Completion& completion)
+{
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (job->cancelled) {
+            return;
+        }
+        job->running = true;
+    }
+
+    completion();
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    job->running = false;
+    finish(*state, job);
+}
+
+void BackgroundWork::finish(State& state, const std::shared_ptr<Job>& job)
+{
+    state.jobs.erase(std::remove(state.jobs.begin(), state.jobs.end(), job), state.jobs.end());
+    state.cv.notify_all();
+}
+
+void BackgroundWork::cancel_if(
+    State& state,
+    std::unique_lock<std::mutex>& lock,
+    const std::function<bool(const Job&)>& matches)
+{
+    for (auto& job : state.jobs) {
+        if (matches(*job)) {
+            job->cancelled = true;
+        }
+    }
+
+    state.queue.erase(
+        std::remove_if(
+            state.queue.begin(),
+            state.queue.end(),
+            [](const std::shared_ptr<Job>& job) { return job->cancelled; }),
+        state.queue.end());
+
+    state.cv.wait(lock, [&]() {
+        return std::none_of(state.jobs.begin(), state.jobs.end(), [&](const auto& job) {
+            return matches(*job) && job->running;
+        });
+    });
+
+    // Completions dropped without being run are cleaned up here as well.
+    state.jobs.erase(
+        std::remove_if(
+            state.jobs.begin(),
+            state.jobs.end(),
+            [&](const std::shared_ptr<Job>& job) { return matches(*job); }),
+        state.jobs.end());
+}
+
+} // namespace mavsdk
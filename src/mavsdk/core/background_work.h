@@ -0,0 +1,83 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "thread_pool.h"
+#include "unique_function.h"
+
+namespace mavsdk {
+
+// CPU heavy tasks of plugins, like parsing a camera definition or component
+// metadata, run on a small pool of their own. This way they hold up neither
+// the messages nor the queued work of a system, and only as many run at once
+// as the pool has threads, no matter how many components ask for it.
+//
+// A task returns what is to be done with its result, if anything. That is
+// handed to post_completion with the origin of the task, which queues it
+// with the user callbacks, so plugins get back their results without a
+// thread of their own.
+class BackgroundWork {
+public:
+    using Completion = UniqueFunction<void()>;
+    using Task = UniqueFunction<Completion()>;
+    using PostCompletion = std::function<void(Completion, const void* origin)>;
+
+    BackgroundWork(ThreadPool& pool, PostCompletion post_completion);
+    ~BackgroundWork();
+
+    // Tasks of the same cookie may run at the same time.
+    void post(Task task, const void* cookie, const void* origin = nullptr);
+
+    // Drops the tasks and completions of the cookie which have not started,
+    // and waits for the ones running. Must not be called from a task or
+    // completion of the cookie.
+    void cancel(const void* cookie);
+
+    // Cancels everything, tasks posted afterwards are dropped.
+    void stop();
+
+    // Non-copyable
+    BackgroundWork(const BackgroundWork&) = delete;
+    const BackgroundWork& operator=(const BackgroundWork&) = delete;
+
+private:
+    struct Job {
+        const void* cookie{nullptr};
+        const void* origin{nullptr};
+        Task task{};
+        bool running{false};
+        bool cancelled{false};
+    };
+
+    // Shared with what is queued on the pool and with the user callbacks, so
+    // it outlives whatever might still run after we are gone.
+    struct State {
+        std::mutex mutex{};
+        std::condition_variable cv{};
+        std::deque<std::shared_ptr<Job>> queue{};
+        std::vector<std::shared_ptr<Job>> jobs{};
+        PostCompletion post_completion{};
+        bool stopped{false};
+    };
+
+    static void run_next(const std::shared_ptr<State>& state);
+    static void run_completion(
+        const std::shared_ptr<State>& state,
+        const std::shared_ptr<Job>& job,
+        Completion& completion);
+    static void finish(State& state, const std::shared_ptr<Job>& job);
+    static void cancel_if(
+        State& state,
+        std::unique_lock<std::mutex>& lock,
+        const std::function<bool(const Job&)>& matches);
+
+    ThreadPool& _pool;
+    std::shared_ptr<State> _state;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "background_work.h"
+
+using namespace mavsdk;
+
+namespace {
+
+// Stands in for the user callbacks: completions are kept until run().
+class Completions {
+public:
+    BackgroundWork::PostCompletion poster()
+    {
+        return [this](BackgroundWork::Completion completion, const void*) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _completions.push_back(std::move(completion));
+        };
+    }
+
+    std::size_t size()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _completions.size();
+    }
+
+    void run()
+    {
+        std::vector<BackgroundWork::Completion> completions;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            completions.swap(_completions);
+        }
+        for (auto& completion : completions) {
+            completion();
+        }
+    }
+
+private:
+    std::mutex _mutex;
+    std::vector<BackgroundWork::Completion> _completions;
+};
+
+bool wait_for(const std::function<bool()>& condition)
+{
+    for (int i = 0; i < 1000; ++i) {
+        if (condition()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(BackgroundWork, RunsTaskOnPoolAndPostsCompletion)
+{
+    ThreadPool pool(2);
+    Completions completions;
+    BackgroundWork background_work{pool, completions.poster()};
+
+    std::thread::id task_thread;
+    int result = 0;
+    const int cookie = 0;
+
+    background_work.post(
+        [&]() -> BackgroundWork::Completion {
+            task_thread = std::this_thread::get_id();
+            const int parsed = 42;
+            return [&result, parsed]() { result = parsed; };
+        },
+        &cookie);
+
+    ASSERT_TRUE(wait_for([&]() { return completions.size() == 1; }));
+    EXPECT_NE(task_thread, std::this_thread::get_id());
+    EXPECT_EQ(result, 0);
+
+    completions.run();
+    EXPECT_EQ(result, 42);
+}
+
+TEST(BackgroundWork, TaskWithoutCompletion)
+{
+    ThreadPool pool(1);
+    Completions completions;
+    BackgroundWork background_work{pool, completions.poster()};
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    const int cookie = 0;
+
+    background_work.post(
+        [&]() -> BackgroundWork::Completion {
+            prom.set_value();
+            return nullptr;
+        },
+        &cookie);
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(completions.size(), 0);
+}
+
+TEST(BackgroundWork, RunsNoMoreTasksAtOnceThanThreads)
+{
+    ThreadPool pool(2);
+    Completions completions;
+    BackgroundWork background_work{pool, completions.poster()};
+
+    std::atomic<int> running{0};
+    std::atomic<int> max_running{0};
+    std::atomic<int> done{0};
+    const int cookie = 0;
+
+    for (int i = 0; i < 20; ++i) {
+        background_work.post(
+            [&]() -> BackgroundWork::Completion {
+                const int now = ++running;
+                int max = max_running;
+                while (now > max && !max_running.compare_exchange_weak(max, now)) {}
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                --running;
+                ++done;
+                return nullptr;
+            },
+            &cookie);
+    }
+
+    ASSERT_TRUE(wait_for([&]() { return done == 20; }));
+    EXPECT_LE(max_running, 2);
+}
+
+TEST(BackgroundWork, CancelDropsQueuedTasksAndCompletions)
+{
+    ThreadPool pool(1);
+    Completions completions;
+    BackgroundWork background_work{pool, completions.poster()};
+
+    const int cookie1 = 0;
+    const int cookie2 = 0;
+
+    std::promise<void> started;
+    std::promise<void> proceed;
+    auto proceed_future = proceed.get_future().share();
+
+    // Keeps the only thread busy, so the others stay queued.
+    background_work.post(
+        [&]() -> BackgroundWork::Completion {
+            started.set_value();
+            proceed_future.wait();
+            return nullptr;
+        },
+        &cookie2);
+    started.get_future().wait();
+
+    int completed1 = 0;
+    int completed2 = 0;
+    std::atomic<int> ran1{0};
+    for (int i = 0; i < 3; ++i) {
+        background_work.post(
+            [&]() -> BackgroundWork::Completion {
+                ++ran1;
+                return [&completed1]() { ++completed1; };
+            },
+            &cookie1);
+    }
+    background_work.post(
+        [&]() -> BackgroundWork::Completion { return [&completed2]() { ++completed2; }; },
+        &cookie2);
+
+    background_work.cancel(&cookie1);
+    proceed.set_value();
+
+    ASSERT_TRUE(wait_for([&]() { return completions.size() == 1; }));
+    completions.run();
+    EXPECT_EQ(ran1, 0);
+    EXPECT_EQ(completed1, 0);
+    EXPECT_EQ(completed2, 1);
+
+    // A completion already posted is not run once cancelled.
+    background_work.post(
+        [&]() -> BackgroundWork::Completion { return [&completed1]() { ++completed1; }; },
+        &cookie1);
+    ASSERT_TRUE(wait_for([&]() { return completions.size() == 1; }));
+    background_work.cancel(&cookie1);
+    completions.run();
+    EXPECT_EQ(completed1, 0);
+}
+
+TEST(BackgroundWork, CancelWaitsForRunningTask)
+{
+    ThreadPool pool(1);
+    Completions completions;
+    BackgroundWork background_work{pool, completions.poster()};
+
+    const int cookie = 0;
+    std::promise<void> started;
+    std::atomic<bool> finished{false};
+
+    background_work.post(
+        [&]() -> BackgroundWork::Completion {
+            started.set_value();
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            finished = true;
+            return []() {};
+        },
+        &cookie);
+
+    started.get_future().wait();
+    background_work.cancel(&cookie);
+    EXPECT_TRUE(finished);
+}
+
+TEST(BackgroundWork, DropsTasksPostedAfterStop)
+{
+    ThreadPool pool(1);
+    Completions completions;
+    BackgroundWork background_work{pool, completions.poster()};
+
+    background_work.stop();
+
+    std::atomic<bool> ran{false};
+    const int cookie = 0;
+    background_work.post(
+        [&]() -> BackgroundWork::Completion {
+            ran = true;
+            return nullptr;
+        },
+        &cookie);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_FALSE(ran);
+}
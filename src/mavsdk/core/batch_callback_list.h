@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "handle.h"
+#include "handle_id.h"
+#include "subscription_options.h"
+
+namespace mavsdk {
+
+// List of subscribers which get their updates in batches.
+//
+// Each subscriber collects samples into its own vector, reserved up front for
+// a full batch. Once it is full, or its first sample is older than the
+// allowed latency, the vector is moved into the queued function, so a batch
+// costs one slot in the user callback queue and is never copied.
+//
+// The latency is checked whenever a sample arrives. If the stream stops,
+// flush_overdue() needs to be called now and then to hand out the rest.
+template<typename T> class BatchCallbackList {
+public:
+    using Batch = std::vector<T>;
+    using Callback = std::function<void(const Batch&)>;
+    using SubscriptionHandle = Handle<Batch>;
+
+    BatchCallbackList() = default;
+    ~BatchCallbackList() = default;
+
+    // Non-copyable
+    BatchCallbackList(const BatchCallbackList&) = delete;
+    const BatchCallbackList& operator=(const BatchCallbackList&) = delete;
+
+    SubscriptionHandle subscribe(const Callback& callback, const BatchOptions& options)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const uint64_t id = next_handle_id();
+
+        Subscriber subscriber{
+            id,
+            std::make_shared<const Callback>(callback),
+            std::max(options.max_samples, 1u),
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(std::max(options.max_latency_s, 0.0))),
+            {},
+            {}};
+        subscriber.batch.reserve(subscriber.max_samples);
+        _subscribers.push_back(std::move(subscriber));
+
+        return SubscriptionHandle{id};
+    }
+
+    void unsubscribe(SubscriptionHandle handle)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _subscribers.erase(
+            std::remove_if(
+                _subscribers.begin(),
+                _subscribers.end(),
+                [&](const Subscriber& subscriber) { return subscriber.id == handle._id; }),
+            _subscribers.end());
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _subscribers.clear();
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _subscribers.empty();
+    }
+
+    // Adds the sample to every batch, and hands the batches which are due to
+    // queue_func, which is meant to put them on the user callback queue.
+    template<typename QueueFunc> void queue(const T& sample, const QueueFunc& queue_func)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        std::vector<Delivery> due;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto& subscriber : _subscribers) {
+                if (subscriber.batch.empty()) {
+                    subscriber.first_sample = now;
+                }
+                subscriber.batch.push_back(sample);
+                if (subscriber.batch.size() >= subscriber.max_samples ||
+                    overdue(subscriber, now)) {
+                    due.push_back(take_batch(subscriber));
+                }
+            }
+        }
+
+        for (auto& delivery : due) {
+            queue_func(std::move(delivery));
+        }
+    }
+
+    // Hands out the batches which have waited for longer than allowed.
+    template<typename QueueFunc> void flush_overdue(const QueueFunc& queue_func)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        std::vector<Delivery> due;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto& subscriber : _subscribers) {
+                if (!subscriber.batch.empty() && overdue(subscriber, now)) {
+                    due.push_back(take_batch(subscriber));
+                }
+            }
+        }
+
+        for (auto& delivery : due) {
+            queue_func(std::move(delivery));
+        }
+    }
+
+private:
+    struct Subscriber {
+        uint64_t id;
+        std::shared_ptr<const Callback> callback;
+        std::size_t max_samples;
+        std::chrono::steady_clock::duration max_latency;
+        Batch batch;
+        std::chrono::steady_clock::time_point first_sample;
+    };
+
+    // The batch is moved in, so nothing is copied on the way to the callback.
+    struct Delivery {
+        std::shared_ptr<const Callback> callback;
+        std::shared_ptr<const Batch> batch;
+
+        void operator()() const { (*callback)(*batch); }
+    };
+
+    static bool overdue(const Subscriber& subscriber, std::chrono::steady_clock::time_point now)
+    {
+        return subscriber.max_latency != std::chrono::steady_clock::duration::zero() &&
+               now - subscriber.first_sample >= subscriber.max_latency;
+    }
+
+    static Delivery take_batch(Subscriber& subscriber)
+    {
+        auto batch = std::make_shared<const Batch>(std::move(subscriber.batch));
+        subscriber.batch = Batch{};
+        subscriber.batch.reserve(subscriber.max_samples);
+        return Delivery{subscriber.callback, std::move(batch)};
+    }
+
+    std::vector<Subscriber> _subscribers{};
+    mutable std::mutex _mutex{};
+};
+
+} // namespace mavsdk
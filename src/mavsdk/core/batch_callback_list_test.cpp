@@ -0,0 +1,126 @@
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "batch_callback_list.h"
+
+using namespace mavsdk;
+
+namespace {
+
+using QueuedFunc = std::function<void()>;
+
+BatchOptions batch_options(unsigned max_samples, double max_latency_s)
+{
+    BatchOptions options;
+    options.max_samples = max_samples;
+    options.max_latency_s = max_latency_s;
+    return options;
+}
+
+} // namespace
+
+TEST(BatchCallbackList, DeliversFullBatches)
+{
+    BatchCallbackList<int> list;
+    std::vector<std::vector<int>> received;
+    list.subscribe(
+        [&](const std::vector<int>& batch) { received.push_back(batch); },
+        batch_options(3, 0.0));
+
+    std::vector<QueuedFunc> queued;
+    const auto queue_func = [&](QueuedFunc func) { queued.push_back(std::move(func)); };
+
+    for (int i = 0; i < 7; ++i) {
+        list.queue(i, queue_func);
+    }
+
+    // Only one queued function per batch.
+    ASSERT_EQ(queued.size(), 2);
+    for (auto& func : queued) {
+        func();
+    }
+    ASSERT_EQ(received.size(), 2);
+    EXPECT_EQ(received[0], (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(received[1], (std::vector<int>{3, 4, 5}));
+
+    // Without a latency limit the rest stays until the batch is full.
+    queued.clear();
+    list.flush_overdue(queue_func);
+    EXPECT_TRUE(queued.empty());
+}
+
+TEST(BatchCallbackList, SubscribersHaveTheirOwnBatches)
+{
+    BatchCallbackList<int> list;
+    unsigned small_batches = 0;
+    unsigned large_batches = 0;
+    list.subscribe([&](const std::vector<int>&) { ++small_batches; }, batch_options(2, 0.0));
+    list.subscribe([&](const std::vector<int>&) { ++large_batches; }, batch_options(5, 0.0));
+
+    for (int i = 0; i < 10; ++i) {
+        list.queue(i, [](QueuedFunc func) { func(); });
+    }
+
+    EXPECT_EQ(small_batches, 5);
+    EXPECT_EQ(large_batches, 2);
+}
+
+TEST(BatchCallbackList, DeliversOverdueBatches)
+{
+    BatchCallbackList<int> list;
+    std::vector<std::vector<int>> received;
+    list.subscribe(
+        [&](const std::vector<int>& batch) { received.push_back(batch); },
+        batch_options(100, 0.01));
+
+    const auto queue_func = [](QueuedFunc func) { func(); };
+
+    list.queue(1, queue_func);
+    list.queue(2, queue_func);
+    list.flush_overdue(queue_func);
+    EXPECT_TRUE(received.empty());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // The next sample goes out with the overdue batch.
+    list.queue(3, queue_func);
+    ASSERT_EQ(received.size(), 1);
+    EXPECT_EQ(received[0], (std::vector<int>{1, 2, 3}));
+
+    // And without one, the timer has to hand it out.
+    list.queue(4, queue_func);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    list.flush_overdue(queue_func);
+    ASSERT_EQ(received.size(), 2);
+    EXPECT_EQ(received[1], (std::vector<int>{4}));
+}
+
+TEST(BatchCallbackList, Unsubscribe)
+{
+    BatchCallbackList<int> list;
+    unsigned batches = 0;
+    auto handle =
+        list.subscribe([&](const std::vector<int>&) { ++batches; }, batch_options(1, 0.0));
+    EXPECT_TRUE(handle.valid());
+    EXPECT_FALSE(list.empty());
+
+    list.queue(1, [](QueuedFunc func) { func(); });
+    EXPECT_EQ(batches, 1);
+
+    list.unsubscribe(handle);
+    EXPECT_TRUE(list.empty());
+    list.queue(2, [](QueuedFunc func) { func(); });
+    EXPECT_EQ(batches, 1);
+}
+
+TEST(BatchCallbackList, ZeroSamplesMeansOne)
+{
+    BatchCallbackList<int> list;
+    unsigned batches = 0;
+    list.subscribe([&](const std::vector<int>&) { ++batches; }, batch_options(0, 0.0));
+
+    list.queue(1, [](QueuedFunc func) { func(); });
+    EXPECT_EQ(batches, 1);
+}
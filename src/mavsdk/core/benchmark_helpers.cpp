@@ -0,0 +1,300 @@
+#include "benchmark_helpers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#if !defined(WINDOWS)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace mavsdk {
+
+mavlink_message_t px4_stream_message(uint32_t message_id, uint8_t system_id)
+{
+    const uint8_t component_id = MAV_COMP_ID_AUTOPILOT1;
+    mavlink_message_t message{};
+
+    // The payloads are mostly zeros, which is fine for everything measured
+    // here, apart from the quaternions which need to be valid.
+    switch (message_id) {
+        case MAVLINK_MSG_ID_HEARTBEAT: {
+            mavlink_heartbeat_t heartbeat{};
+            heartbeat.type = MAV_TYPE_QUADROTOR;
+            heartbeat.autopilot = MAV_AUTOPILOT_PX4;
+            heartbeat.system_status = MAV_STATE_ACTIVE;
+            mavlink_msg_heartbeat_encode(system_id, component_id, &message, &heartbeat);
+        } break;
+        case MAVLINK_MSG_ID_SYS_STATUS: {
+            mavlink_sys_status_t sys_status{};
+            sys_status.voltage_battery = 16000;
+            sys_status.battery_remaining = 80;
+            mavlink_msg_sys_status_encode(system_id, component_id, &message, &sys_status);
+        } break;
+        case MAVLINK_MSG_ID_EXTENDED_SYS_STATE: {
+            mavlink_extended_sys_state_t extended_sys_state{};
+            extended_sys_state.landed_state = MAV_LANDED_STATE_IN_AIR;
+            mavlink_msg_extended_sys_state_encode(
+                system_id, component_id, &message, &extended_sys_state);
+        } break;
+        case MAVLINK_MSG_ID_SYSTEM_TIME: {
+            mavlink_system_time_t system_time{};
+            mavlink_msg_system_time_encode(system_id, component_id, &message, &system_time);
+        } break;
+        case MAVLINK_MSG_ID_ALTITUDE: {
+            mavlink_altitude_t altitude{};
+            mavlink_msg_altitude_encode(system_id, component_id, &message, &altitude);
+        } break;
+        case MAVLINK_MSG_ID_ATTITUDE: {
+            mavlink_attitude_t attitude{};
+            attitude.roll = 0.1f;
+            mavlink_msg_attitude_encode(system_id, component_id, &message, &attitude);
+        } break;
+        case MAVLINK_MSG_ID_ATTITUDE_QUATERNION: {
+            mavlink_attitude_quaternion_t attitude_quaternion{};
+            attitude_quaternion.q1 = 1.0f;
+            mavlink_msg_attitude_quaternion_encode(
+                system_id, component_id, &message, &attitude_quaternion);
+        } break;
+        case MAVLINK_MSG_ID_ATTITUDE_TARGET: {
+            mavlink_attitude_target_t attitude_target{};
+            attitude_target.q[0] = 1.0f;
+            mavlink_msg_attitude_target_encode(
+                system_id, component_id, &message, &attitude_target);
+        } break;
+        case MAVLINK_MSG_ID_BATTERY_STATUS: {
+            mavlink_battery_status_t battery_status{};
+            std::fill(
+                std::begin(battery_status.voltages), std::end(battery_status.voltages), UINT16_MAX);
+            battery_status.voltages[0] = 16000;
+            mavlink_msg_battery_status_encode(system_id, component_id, &message, &battery_status);
+        } break;
+        case MAVLINK_MSG_ID_ESTIMATOR_STATUS: {
+            mavlink_estimator_status_t estimator_status{};
+            mavlink_msg_estimator_status_encode(
+                system_id, component_id, &message, &estimator_status);
+        } break;
+        case MAVLINK_MSG_ID_GLOBAL_POSITION_INT: {
+            mavlink_global_position_int_t global_position_int{};
+            global_position_int.lat = 473977418;
+            global_position_int.lon = 85455939;
+            global_position_int.alt = 488000;
+            mavlink_msg_global_position_int_encode(
+                system_id, component_id, &message, &global_position_int);
+        } break;
+        case MAVLINK_MSG_ID_GPS_RAW_INT: {
+            mavlink_gps_raw_int_t gps_raw_int{};
+            gps_raw_int.fix_type = GPS_FIX_TYPE_3D_FIX;
+            gps_raw_int.satellites_visible = 12;
+            mavlink_msg_gps_raw_int_encode(system_id, component_id, &message, &gps_raw_int);
+        } break;
+        case MAVLINK_MSG_ID_HOME_POSITION: {
+            mavlink_home_position_t home_position{};
+            home_position.q[0] = 1.0f;
+            mavlink_msg_home_position_encode(system_id, component_id, &message, &home_position);
+        } break;
+        case MAVLINK_MSG_ID_LOCAL_POSITION_NED: {
+            mavlink_local_position_ned_t local_position_ned{};
+            mavlink_msg_local_position_ned_encode(
+                system_id, component_id, &message, &local_position_ned);
+        } break;
+        case MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT: {
+            mavlink_nav_controller_output_t nav_controller_output{};
+            mavlink_msg_nav_controller_output_encode(
+                system_id, component_id, &message, &nav_controller_output);
+        } break;
+        case MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED: {
+            mavlink_position_target_local_ned_t position_target_local_ned{};
+            mavlink_msg_position_target_local_ned_encode(
+                system_id, component_id, &message, &position_target_local_ned);
+        } break;
+        case MAVLINK_MSG_ID_RC_CHANNELS: {
+            mavlink_rc_channels_t rc_channels{};
+            rc_channels.chancount = 8;
+            rc_channels.rssi = 200;
+            mavlink_msg_rc_channels_encode(system_id, component_id, &message, &rc_channels);
+        } break;
+        case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW: {
+            mavlink_servo_output_raw_t servo_output_raw{};
+            mavlink_msg_servo_output_raw_encode(
+                system_id, component_id, &message, &servo_output_raw);
+        } break;
+        case MAVLINK_MSG_ID_VFR_HUD: {
+            mavlink_vfr_hud_t vfr_hud{};
+            mavlink_msg_vfr_hud_encode(system_id, component_id, &message, &vfr_hud);
+        } break;
+        case MAVLINK_MSG_ID_VIBRATION: {
+            mavlink_vibration_t vibration{};
+            mavlink_msg_vibration_encode(system_id, component_id, &message, &vibration);
+        } break;
+        case MAVLINK_MSG_ID_WIND_COV: {
+            mavlink_wind_cov_t wind_cov{};
+            mavlink_msg_wind_cov_encode(system_id, component_id, &message, &wind_cov);
+        } break;
+        default:
+            break;
+    }
+    return message;
+}
+
+const std::vector<StreamRate>& px4_default_streams()
+{
+    // As configured in PX4's mavlink_main.cpp for MAVLINK_MODE_NORMAL.
+    static const std::vector<StreamRate> streams{
+        {MAVLINK_MSG_ID_HEARTBEAT, 1.0f},
+        {MAVLINK_MSG_ID_SYS_STATUS, 5.0f},
+        {MAVLINK_MSG_ID_EXTENDED_SYS_STATE, 1.0f},
+        {MAVLINK_MSG_ID_SYSTEM_TIME, 1.0f},
+        {MAVLINK_MSG_ID_ALTITUDE, 1.0f},
+        {MAVLINK_MSG_ID_ATTITUDE, 15.0f},
+        {MAVLINK_MSG_ID_ATTITUDE_QUATERNION, 10.0f},
+        {MAVLINK_MSG_ID_ATTITUDE_TARGET, 2.0f},
+        {MAVLINK_MSG_ID_BATTERY_STATUS, 0.5f},
+        {MAVLINK_MSG_ID_ESTIMATOR_STATUS, 1.0f},
+        {MAVLINK_MSG_ID_GLOBAL_POSITION_INT, 5.0f},
+        {MAVLINK_MSG_ID_GPS_RAW_INT, 1.0f},
+        {MAVLINK_MSG_ID_HOME_POSITION, 0.5f},
+        {MAVLINK_MSG_ID_LOCAL_POSITION_NED, 1.0f},
+        {MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, 1.0f},
+        {MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED, 1.5f},
+        {MAVLINK_MSG_ID_RC_CHANNELS, 5.0f},
+        {MAVLINK_MSG_ID_SERVO_OUTPUT_RAW, 1.0f},
+        {MAVLINK_MSG_ID_VFR_HUD, 4.0f},
+        {MAVLINK_MSG_ID_VIBRATION, 0.1f},
+        {MAVLINK_MSG_ID_WIND_COV, 0.5f},
+    };
+    return streams;
+}
+
+std::vector<mavlink_message_t> px4_default_stream_mix(unsigned scale, uint8_t system_id)
+{
+    constexpr double duration_s = 10.0;
+
+    struct Scheduled {
+        double time_s;
+        uint32_t message_id;
+    };
+    std::vector<Scheduled> schedule;
+
+    for (const auto& stream : px4_default_streams()) {
+        const double rate_hz = static_cast<double>(stream.rate_hz) * scale;
+        const auto count = static_cast<unsigned>(std::lround(rate_hz * duration_s));
+        for (unsigned i = 0; i < count; ++i) {
+            schedule.push_back({(i + 0.5) / rate_hz, stream.message_id});
+        }
+    }
+
+    std::stable_sort(schedule.begin(), schedule.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.time_s < rhs.time_s;
+    });
+
+    std::vector<mavlink_message_t> messages;
+    messages.reserve(schedule.size());
+    for (const auto& scheduled : schedule) {
+        messages.push_back(px4_stream_message(scheduled.message_id, system_id));
+    }
+    return messages;
+}
+
+std::vector<uint8_t> serialize(const std::vector<mavlink_message_t>& messages)
+{
+    std::vector<uint8_t> bytes;
+    bytes.reserve(messages.size() * 64);
+
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    for (const auto& message : messages) {
+        const auto length = mavlink_msg_to_send_buffer(buffer, &message);
+        bytes.insert(bytes.end(), buffer, buffer + length);
+    }
+    return bytes;
+}
+
+void count_messages(benchmark::State& state, std::size_t num_messages)
+{
+    const auto total = static_cast<double>(num_messages);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * num_messages));
+    state.counters["msgs/s"] =
+        benchmark::Counter(total, benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["ns/msg"] = benchmark::Counter(
+        total / 1e9, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+void px4_stream_scales(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgName("scale")->Arg(1)->Arg(10)->Arg(100);
+}
+
+void lossy_links(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"rtt_ms", "loss_percent", "kB_per_s"})
+        ->Args({2, 0, 0}) // Local simulator
+        ->Args({20, 2, 1000}) // WiFi
+        ->Args({100, 1, 200}) // LTE
+        ->Args({200, 5, 6}); // Telemetry radio at 57600 baud
+}
+
+SimulatedLink::Config lossy_link_config(const benchmark::State& state)
+{
+    SimulatedLink::Config config;
+    config.latency_s = double(state.range(0)) / 1000.0 / 2.0;
+    config.loss_probability = double(state.range(1)) / 100.0;
+    config.bytes_per_s = double(state.range(2)) * 1000.0;
+    return config;
+}
+
+void report_transfer(
+    benchmark::State& state,
+    bool success,
+    double completion_s,
+    uint64_t retransmissions,
+    std::size_t payload_bytes)
+{
+    if (!success) {
+        state.SkipWithError("Transfer failed");
+        return;
+    }
+    state.counters["completion_s"] = completion_s;
+    state.counters["retransmissions"] = double(retransmissions);
+    state.counters["goodput_B_per_s"] =
+        completion_s > 0.0 ? double(payload_bytes) / completion_s : 0.0;
+}
+
+ProcessStats process_stats()
+{
+    ProcessStats stats;
+
+#if !defined(WINDOWS)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    const auto to_ns = [](const timeval& time) {
+        return static_cast<uint64_t>(time.tv_sec) * 1000000000 +
+               static_cast<uint64_t>(time.tv_usec) * 1000;
+    };
+    stats.cpu_time_ns = to_ns(usage.ru_utime) + to_ns(usage.ru_stime);
+#endif
+
+#if defined(LINUX)
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size_pages = 0;
+    uint64_t resident_pages = 0;
+    if (statm >> size_pages >> resident_pages) {
+        stats.rss_bytes = resident_pages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("Threads:", 0) == 0) {
+            stats.threads = static_cast<unsigned>(std::stoul(line.substr(8)));
+            break;
+        }
+    }
+#endif
+
+    return stats;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "mavlink_include.h"
+#include "simulated_link.h"
+
+namespace mavsdk {
+
+// A message of the stream set PX4 sends to a ground station by default
+// (MAVLink mode "normal"), and the rate at which it is sent.
+struct StreamRate {
+    uint32_t message_id;
+    float rate_hz;
+};
+
+const std::vector<StreamRate>& px4_default_streams();
+
+// A message of one of the PX4 default streams.
+mavlink_message_t px4_stream_message(uint32_t message_id, uint8_t system_id);
+
+// Ten seconds worth of the PX4 default streams, with every rate multiplied
+// by scale, in the order they would be sent.
+std::vector<mavlink_message_t> px4_default_stream_mix(unsigned scale, uint8_t system_id = 1);
+
+// The messages serialized back to back, as they would come in over a link.
+std::vector<uint8_t> serialize(const std::vector<mavlink_message_t>& messages);
+
+// Reports msgs/s and ns/msg, for num_messages processed per iteration.
+void count_messages(benchmark::State& state, std::size_t num_messages);
+
+// The message mix scales benchmarks are run with.
+void px4_stream_scales(benchmark::internal::Benchmark* benchmark);
+
+// The links transfer benchmarks run over, from a local simulator to a
+// telemetry radio, as round trip in ms, loss in percent and bandwidth in
+// kB/s, 0 for unlimited. Other links can be given to a benchmark with Args
+// the same way.
+void lossy_links(benchmark::internal::Benchmark* benchmark);
+
+// The simulated link for the arguments of lossy_links().
+SimulatedLink::Config lossy_link_config(const benchmark::State& state);
+
+// Reports a transfer of payload_bytes which took completion_s on virtual
+// time and needed retransmissions messages beyond what a loss free link
+// needs, as well as the goodput, the payload bytes per second.
+void report_transfer(
+    benchmark::State& state,
+    bool success,
+    double completion_s,
+    uint64_t retransmissions,
+    std::size_t payload_bytes);
+
+// What the whole process uses, for benchmarks which watch it over time.
+struct ProcessStats {
+    uint64_t cpu_time_ns{0};
+    uint64_t rss_bytes{0};
+    unsigned threads{0};
+};
+
+// The RSS and thread count are only known on Linux, elsewhere they are 0.
+ProcessStats process_stats();
+
+} // namespace mavsdk
@@ -0,0 +1,185 @@
+#include "cache_file.h"
+#include "crc32.h"
+#include "fs.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <type_traits>
+#include <variant>
+
+namespace mavsdk {
+
+using ParamVariant = decltype(MAVLinkParameters::ParamValue::_value);
+
+static constexpr std::size_t crc_len = 4;
+
+void cache_put_uint(std::vector<uint8_t>& buffer, uint64_t value, std::size_t num_bytes)
+{
+    for (std::size_t i = 0; i < num_bytes; ++i) {
+        buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+bool cache_get_uint(
+    const std::vector<uint8_t>& buffer, std::size_t& pos, std::size_t num_bytes, uint64_t& value)
+{
+    if (buffer.size() < pos || buffer.size() - pos < num_bytes) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t i = 0; i < num_bytes; ++i) {
+        value |= static_cast<uint64_t>(buffer[pos++]) << (8 * i);
+    }
+    return true;
+}
+
+void cache_put_string(std::vector<uint8_t>& buffer, const std::string& value, std::size_t len_bytes)
+{
+    cache_put_uint(buffer, value.size(), len_bytes);
+    buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+bool cache_get_string(
+    const std::vector<uint8_t>& buffer, std::size_t& pos, std::string& value, std::size_t len_bytes)
+{
+    uint64_t len;
+    if (!cache_get_uint(buffer, pos, len_bytes, len) || buffer.size() - pos < len) {
+        return false;
+    }
+    value.assign(
+        reinterpret_cast<const char*>(buffer.data() + pos), static_cast<std::size_t>(len));
+    pos += static_cast<std::size_t>(len);
+    return true;
+}
+
+template<typename T> using RawBits = std::conditional_t<sizeof(T) <= 4, uint32_t, uint64_t>;
+
+template<typename T> static uint64_t to_bits(T value)
+{
+    if constexpr (std::is_floating_point_v<T>) {
+        RawBits<T> raw;
+        std::memcpy(&raw, &value, sizeof(T));
+        return raw;
+    } else {
+        return static_cast<std::make_unsigned_t<T>>(value);
+    }
+}
+
+template<typename T> static T from_bits(uint64_t bits)
+{
+    if constexpr (std::is_floating_point_v<T>) {
+        const auto raw = static_cast<RawBits<T>>(bits);
+        T value;
+        std::memcpy(&value, &raw, sizeof(T));
+        return value;
+    } else {
+        return static_cast<T>(static_cast<std::make_unsigned_t<T>>(bits));
+    }
+}
+
+template<std::size_t I = 0>
+static bool get_value(
+    const std::vector<uint8_t>& buffer,
+    std::size_t& pos,
+    std::size_t type_index,
+    MAVLinkParameters::ParamValue& value)
+{
+    if constexpr (I < std::variant_size_v<ParamVariant>) {
+        if (type_index != I) {
+            return get_value<I + 1>(buffer, pos, type_index, value);
+        }
+        using T = std::variant_alternative_t<I, ParamVariant>;
+        uint64_t bits;
+        if (!cache_get_uint(buffer, pos, sizeof(T), bits)) {
+            return false;
+        }
+        value.set<T>(from_bits<T>(bits));
+        return true;
+    } else {
+        return false;
+    }
+}
+
+void cache_put_param_value(std::vector<uint8_t>& buffer, const MAVLinkParameters::ParamValue& value)
+{
+    cache_put_uint(buffer, value._value.index(), 1);
+    std::visit(
+        [&buffer](auto raw) { cache_put_uint(buffer, to_bits(raw), sizeof(raw)); }, value._value);
+}
+
+bool cache_get_param_value(
+    const std::vector<uint8_t>& buffer, std::size_t& pos, MAVLinkParameters::ParamValue& value)
+{
+    uint64_t type_index;
+    return cache_get_uint(buffer, pos, 1, type_index) &&
+           get_value(buffer, pos, static_cast<std::size_t>(type_index), value);
+}
+
+static uint32_t checksum(const std::vector<uint8_t>& buffer, std::size_t len)
+{
+    Crc32 crc;
+    crc.add(buffer.data(), static_cast<uint32_t>(len));
+    return crc.get();
+}
+
+bool cache_file_write(const std::string& path, std::vector<uint8_t> buffer)
+{
+    cache_put_uint(buffer, checksum(buffer, buffer.size()), crc_len);
+
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            LogWarn() << "Could not write cache " << tmp_path;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        if (!file) {
+            LogWarn() << "Could not write cache " << tmp_path;
+            fs_remove(tmp_path);
+            return false;
+        }
+    }
+
+    if (!fs_rename(tmp_path, path)) {
+        LogWarn() << "Could not move cache to " << path;
+        fs_remove(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+std::optional<std::vector<uint8_t>>
+cache_file_read(const std::string& path, const std::vector<uint8_t>& magic)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+
+    std::vector<uint8_t> buffer(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (buffer.size() < magic.size() + crc_len ||
+        !std::equal(magic.begin(), magic.end(), buffer.begin())) {
+        LogDebug() << "Ignoring cache " << path << " of unknown format";
+        return std::nullopt;
+    }
+
+    const std::size_t payload_len = buffer.size() - crc_len;
+    std::size_t pos = payload_len;
+    uint64_t crc;
+    cache_get_uint(buffer, pos, crc_len, crc);
+    if (crc != checksum(buffer, payload_len)) {
+        LogWarn() << "Ignoring corrupt cache " << path;
+        return std::nullopt;
+    }
+
+    buffer.resize(payload_len);
+    return buffer;
+}
+
+} // namespace mavsdk
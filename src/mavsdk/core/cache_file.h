@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "mavlink_parameters.h"
+
+namespace mavsdk {
+
+// Building blocks for the binary cache files written by mavsdk.
+//
+// Integers are stored in little endian with as many bytes as given, strings
+// with their length in front and param values with their type index in front.
+// The get functions advance pos and return false if the buffer is too short.
+
+void cache_put_uint(std::vector<uint8_t>& buffer, uint64_t value, std::size_t num_bytes);
+bool cache_get_uint(
+    const std::vector<uint8_t>& buffer, std::size_t& pos, std::size_t num_bytes, uint64_t& value);
+
+void cache_put_string(
+    std::vector<uint8_t>& buffer, const std::string& value, std::size_t len_bytes = 4);
+bool cache_get_string(
+    const std::vector<uint8_t>& buffer,
+    std::size_t& pos,
+    std::string& value,
+    std::size_t len_bytes = 4);
+
+void cache_put_param_value(
+    std::vector<uint8_t>& buffer, const MAVLinkParameters::ParamValue& value);
+bool cache_get_param_value(
+    const std::vector<uint8_t>& buffer, std::size_t& pos, MAVLinkParameters::ParamValue& value);
+
+// Appends a CRC32 of the buffer and writes it to a temporary file first which
+// is then renamed, so an interrupted write never leaves a broken cache behind.
+bool cache_file_write(const std::string& path, std::vector<uint8_t> buffer);
+
+// Returns the content written with cache_file_write() without the CRC, or
+// nullopt if there is no such file, it doesn't start with magic or it is
+// corrupt.
+std::optional<std::vector<uint8_t>>
+cache_file_read(const std::string& path, const std::vector<uint8_t>& magic);
+
+} // namespace mavsdk
@@ -1,92 +1,172 @@
 #include "call_every_handler.h"
+#include "log.h"
 
+#include <algorithm>
+#include <cstring>
 #include <utility>
 
 namespace mavsdk {
 
 CallEveryHandler::CallEveryHandler(Time& time) : _time(time) {}
 
-void CallEveryHandler::add(std::function<void()> callback, double interval_s, void** cookie)
+namespace {
+
+// splitmix64, to spread similar keys over the whole range.
+uint64_t mix(uint64_t value)
+{
+    value += 0x9e3779b97f4a7c15ull;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+} // namespace
+
+void CallEveryHandler::add(
+    std::function<void()> callback, double interval_s, void** cookie, std::optional<Phase> phase)
 {
-    auto new_entry = std::make_shared<Entry>();
-    new_entry->callback = std::move(callback);
+    Entry new_entry{};
+    new_entry.callback = std::move(callback);
     auto before = _time.steady_time();
-    // Make sure it gets run straightaway. The epsilon seemed not enough, so
-    // we use the arbitrary value of 1 ms.
-    _time.shift_steady_time_by(before, -interval_s - 0.001);
-    new_entry->last_time = before;
-    new_entry->interval_s = interval_s;
+    // Make sure it gets run straightaway, or right at the offset. The epsilon
+    // seemed not enough, so we use the arbitrary value of 1 ms.
+    const double offset_s = phase ? phase_offset_s(phase->key, interval_s) : 0.0;
+    _time.shift_steady_time_by(before, -interval_s - 0.001 + offset_s);
+    new_entry.last_time = before;
+    new_entry.interval_s = interval_s;
+    if (phase) {
+        new_entry.jitter_s = phase->jitter_s;
+    }
 
-    void* new_cookie = static_cast<void*>(new_entry.get());
+    void* new_cookie;
 
     {
         std::lock_guard<std::mutex> lock(_entries_mutex);
-        _entries.insert(std::pair<void*, std::shared_ptr<Entry>>(new_cookie, new_entry));
+        new_cookie = _entries.insert(due_time(new_entry), std::move(new_entry));
+    }
+
+    if (new_cookie == nullptr) {
+        LogErr() << "Too many call every entries";
     }
 
     if (cookie != nullptr) {
         *cookie = new_cookie;
     }
+
+    if (_wakeup_callback) {
+        _wakeup_callback();
+    }
 }
 
 void CallEveryHandler::change(double interval_s, const void* cookie)
 {
-    std::lock_guard<std::mutex> lock(_entries_mutex);
+    {
+        std::lock_guard<std::mutex> lock(_entries_mutex);
 
-    auto it = _entries.find(const_cast<void*>(cookie));
-    if (it != _entries.end()) {
-        it->second->interval_s = interval_s;
+        auto entry = _entries.find(cookie);
+        if (entry == nullptr) {
+            return;
+        }
+        entry->interval_s = interval_s;
+        _entries.update(cookie, due_time(*entry));
+    }
+
+    // The interval might have become shorter, so the next deadline could be earlier.
+    if (_wakeup_callback) {
+        _wakeup_callback();
     }
 }
 
 void CallEveryHandler::reset(const void* cookie)
 {
+    // A reset only ever moves the next call later, so there is no need to
+    // wake up whoever is waiting for the next deadline.
     std::lock_guard<std::mutex> lock(_entries_mutex);
 
-    auto it = _entries.find(const_cast<void*>(cookie));
-    if (it != _entries.end()) {
-        it->second->last_time = _time.steady_time();
+    auto entry = _entries.find(cookie);
+    if (entry != nullptr) {
+        entry->last_time = _time.steady_time();
+        _entries.update(cookie, due_time(*entry));
     }
 }
 
+void CallEveryHandler::set_wakeup_callback(std::function<void()> callback)
+{
+    _wakeup_callback = std::move(callback);
+}
+
 void CallEveryHandler::remove(const void* cookie)
 {
     std::lock_guard<std::mutex> lock(_entries_mutex);
-
-    auto it = _entries.find(const_cast<void*>(cookie));
-    if (it != _entries.end()) {
-        _entries.erase(const_cast<void*>(cookie));
-        _iterator_invalidated = true;
-    }
+    _entries.remove(cookie);
 }
 
 void CallEveryHandler::run_once()
 {
-    _entries_mutex.lock();
+    std::unique_lock<std::mutex> lock(_entries_mutex);
 
-    for (auto& entry : _entries) {
-        if (_time.elapsed_since_s(entry.second->last_time) > double(entry.second->interval_s)) {
-            _time.shift_steady_time_by(entry.second->last_time, double(entry.second->interval_s));
+    const dl_time_t now = _time.steady_time();
 
-            if (entry.second->callback) {
-                // Get a copy for the callback because we unlock.
-                std::function<void()> callback = entry.second->callback;
+    // The heap is ordered by the next due time, so we only ever need to look at the top.
+    while (!_entries.empty() && _entries.next_due().value() < now) {
+        void* cookie = _entries.top();
+        auto entry = _entries.find(cookie);
 
-                // Unlock while we call back because it might in turn want to add timeouts.
-                _entries_mutex.unlock();
-                callback();
-                _entries_mutex.lock();
-            }
+        _time.shift_steady_time_by(entry->last_time, entry->interval_s);
+        if (entry->jitter_s > 0.0) {
+            entry->next_jitter_s =
+                std::uniform_real_distribution<double>(0.0, entry->jitter_s)(_random);
         }
-
-        // We leave the loop.
-        // FIXME: there should be a nicer way to do this.
-        if (_iterator_invalidated) {
-            _iterator_invalidated = false;
-            break;
+        if (due_time(*entry) < now) {
+            // We have fallen behind by more than one interval. Instead of
+            // calling in a burst to catch up, we skip the missed calls.
+            entry->last_time = now;
+        }
+        _entries.update(cookie, due_time(*entry));
+
+        if (entry->callback) {
+            // Take the callback out while we call it, so we don't need to copy it.
+            std::function<void()> callback = std::move(entry->callback);
+
+            // Unlock while we call back because it might in turn want to add,
+            // change, or remove entries.
+            lock.unlock();
+            callback();
+            lock.lock();
+
+            // The entry might have been removed in the meantime, in which case
+            // the cookie is no longer found, even if the slot has been reused.
+            entry = _entries.find(cookie);
+            if (entry != nullptr && !entry->callback) {
+                entry->callback = std::move(callback);
+            }
         }
     }
-    _entries_mutex.unlock();
+}
+
+std::optional<dl_time_t> CallEveryHandler::next_deadline()
+{
+    std::lock_guard<std::mutex> lock(_entries_mutex);
+    return _entries.next_due();
+}
+
+dl_time_t CallEveryHandler::due_time(const Entry& entry)
+{
+    dl_time_t due = entry.last_time;
+    Time::shift_steady_time_by(due, entry.interval_s + entry.next_jitter_s);
+    return due;
+}
+
+double CallEveryHandler::phase_offset_s(uint64_t key, double interval_s)
+{
+    // Mixed with the interval, so entries of the same key with different
+    // intervals don't all start together either.
+    uint64_t interval_bits;
+    std::memcpy(&interval_bits, &interval_s, sizeof(interval_bits));
+    const uint64_t hash = mix(key ^ mix(interval_bits));
+
+    const double fraction = static_cast<double>(hash >> 11) / static_cast<double>(1ull << 53);
+    return fraction * std::min(interval_s, MAX_PHASE_OFFSET_S);
 }
 
 } // namespace mavsdk
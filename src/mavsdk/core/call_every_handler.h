@@ -1,10 +1,12 @@
 #pragma once
 
+#include <cstdint>
 #include <mutex>
-#include <memory>
 #include <functional>
-#include <unordered_map>
+#include <optional>
+#include <random>
 #include "mavsdk_time.h"
+#include "timer_heap.h"
 
 namespace mavsdk {
 
@@ -19,23 +21,62 @@ public:
     CallEveryHandler& operator=(CallEveryHandler const&) = delete; // Copy assign
     CallEveryHandler& operator=(CallEveryHandler&&) = delete; // Move assign
 
-    void add(std::function<void()> callback, double interval_s, void** cookie);
+    // Without a phase an entry is called straightaway and then every interval.
+    //
+    // With many systems, all their entries would be called in the same tick
+    // if they were added at the same time, e.g. when they connect at once,
+    // and stay in lockstep from then on. A phase spreads them out instead:
+    // the first call is delayed by an offset hashed from the key and the
+    // interval, of at most the interval or MAX_PHASE_OFFSET_S, whichever is
+    // shorter.
+    struct Phase {
+        uint64_t key{0}; // E.g. the system.
+        // Up to this much is added to every call, drawn anew each time,
+        // without drifting from the interval.
+        double jitter_s{0.0};
+    };
+
+    static constexpr double MAX_PHASE_OFFSET_S = 1.0;
+
+    void add(
+        std::function<void()> callback,
+        double interval_s,
+        void** cookie,
+        std::optional<Phase> phase = std::nullopt);
     void change(double interval_s, const void* cookie);
     void reset(const void* cookie);
     void remove(const void* cookie);
 
     void run_once();
 
+    // Returns the earliest time at which an entry is due to be called, or
+    // nothing if there are no entries.
+    std::optional<dl_time_t> next_deadline();
+
+    // The wakeup callback is called (without any lock held) whenever an entry is
+    // added or changed, so that a thread waiting for the next deadline can
+    // re-evaluate. It needs to be set before the handler is used.
+    void set_wakeup_callback(std::function<void()> callback);
+
 private:
     struct Entry {
         std::function<void()> callback{nullptr};
         dl_time_t last_time{};
         double interval_s{0.0};
+        double jitter_s{0.0};
+        double next_jitter_s{0.0};
     };
 
-    std::unordered_map<void*, std::shared_ptr<Entry>> _entries{};
+    static dl_time_t due_time(const Entry& entry);
+    static double phase_offset_s(uint64_t key, double interval_s);
+
+    // The entries are ordered by the time they are due next which is
+    // last_time + interval_s.
+    TimerHeap<Entry> _entries{};
     std::mutex _entries_mutex{};
-    bool _iterator_invalidated{false};
+    std::minstd_rand _random{}; // For the jitter, guarded by _entries_mutex.
+
+    std::function<void()> _wakeup_callback{nullptr};
 
     Time& _time;
 };
@@ -1,5 +1,8 @@
 #include "call_every_handler.h"
 #include "unused.h"
+#include <algorithm>
+#include <numeric>
+#include <vector>
 #include <gtest/gtest.h>
 
 #ifdef FAKE_TIME
@@ -143,3 +146,101 @@ TEST(CallEveryHandler, CallImmediately)
     }
     EXPECT_EQ(num_called, 1);
 }
+
+TEST(CallEveryHandler, NextDeadline)
+{
+    Time time{};
+    CallEveryHandler ceh(time);
+
+    int num_wakeups = 0;
+    ceh.set_wakeup_callback([&num_wakeups]() { ++num_wakeups; });
+
+    EXPECT_FALSE(ceh.next_deadline().has_value());
+
+    void* cookie = nullptr;
+    ceh.add([]() {}, 0.1, &cookie);
+    EXPECT_EQ(num_wakeups, 1);
+
+    // A new entry is due straightaway.
+    auto deadline = ceh.next_deadline();
+    ASSERT_TRUE(deadline.has_value());
+    EXPECT_LT(deadline.value(), time.steady_time());
+
+    ceh.run_once();
+    deadline = ceh.next_deadline();
+    ASSERT_TRUE(deadline.has_value());
+    EXPECT_GT(deadline.value(), time.steady_time());
+
+    ceh.change(0.2, cookie);
+    EXPECT_EQ(num_wakeups, 2);
+
+    ceh.remove(cookie);
+    EXPECT_FALSE(ceh.next_deadline().has_value());
+}
+
+TEST(CallEveryHandler, SpreadsPhases)
+{
+    FakeTime time{};
+    CallEveryHandler ceh(time);
+
+    // Systems connecting all at once.
+    constexpr int num_systems = 200;
+    std::vector<int> num_called(num_systems, 0);
+    for (int i = 0; i < num_systems; ++i) {
+        void* cookie = nullptr;
+        ceh.add(
+            [&num_called, i]() { ++num_called[i]; },
+            1.0,
+            &cookie,
+            CallEveryHandler::Phase{static_cast<uint64_t>(i)});
+    }
+
+    int max_calls_per_tick = 0;
+    int total_calls = 0;
+    for (int tick = 0; tick < 100; ++tick) {
+        time.advance_to(time.steady_time() + std::chrono::milliseconds(10));
+        const int before = total_calls;
+        ceh.run_once();
+        total_calls = std::accumulate(num_called.begin(), num_called.end(), 0);
+        max_calls_per_tick = std::max(max_calls_per_tick, total_calls - before);
+    }
+
+    // All of them within the first interval, but not in one burst.
+    EXPECT_EQ(total_calls, num_systems);
+    EXPECT_LE(max_calls_per_tick, 10);
+}
+
+TEST(CallEveryHandler, KeepsIntervalWithJitter)
+{
+    FakeTime time{};
+    CallEveryHandler ceh(time);
+
+    std::vector<dl_time_t> calls;
+    void* cookie = nullptr;
+    ceh.add(
+        [&]() { calls.push_back(time.steady_time()); },
+        0.1,
+        &cookie,
+        CallEveryHandler::Phase{42, 0.02});
+
+    for (int i = 0; i < 10000; ++i) {
+        time.advance_to(time.steady_time() + std::chrono::milliseconds(1));
+        ceh.run_once();
+    }
+
+    // Jitter doesn't add up, so it stays at 10 Hz.
+    EXPECT_GE(calls.size(), 99u);
+    EXPECT_LE(calls.size(), 100u);
+
+    double min_interval_s = 1.0;
+    double max_interval_s = 0.0;
+    for (std::size_t i = 1; i < calls.size(); ++i) {
+        const double interval_s =
+            std::chrono::duration<double>(calls[i] - calls[i - 1]).count();
+        min_interval_s = std::min(min_interval_s, interval_s);
+        max_interval_s = std::max(max_interval_s, interval_s);
+    }
+    EXPECT_GT(max_interval_s - min_interval_s, 0.005);
+    EXPECT_GT(min_interval_s, 0.075);
+    EXPECT_LT(max_interval_s, 0.125);
+}
@@ -0,0 +1,139 @@
+#include "callback_executor.h"
+
+#include <algorithm>
+
+namespace mavsdk {
+
+CallbackExecutor::CallbackExecutor(std::size_t num_threads, ThreadSetup thread_setup) :
+    _thread_setup(std::move(thread_setup))
+{
+    num_threads = std::max<std::size_t>(num_threads, 1);
+    _threads.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        _threads.emplace_back(_thread_setup.settings.stack_size_bytes, [this, i]() { worker(i); });
+    }
+}
+
+CallbackExecutor::~CallbackExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_exit = true;
+    }
+    _work_cv.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+uint64_t CallbackExecutor::attach(UserCallbackQueue& queue, Runner runner)
+{
+    queue.set_notify([this]() { notify(); });
+
+    auto entry = std::make_shared<Entry>();
+    entry->queue = &queue;
+    entry->runner = std::move(runner);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        entry->handle = _next_handle++;
+        _entries.push_back(entry);
+    }
+    return entry->handle;
+}
+
+void CallbackExecutor::detach(uint64_t handle)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    const auto it = std::find_if(_entries.begin(), _entries.end(), [&](const auto& entry) {
+        return entry->handle == handle;
+    });
+    if (it == _entries.end()) {
+        return;
+    }
+
+    auto entry = *it;
+    _entries.erase(it);
+    _idle_cv.wait(lock, [&]() { return !entry->busy; });
+}
+
+bool CallbackExecutor::is_callback_thread() const
+{
+    const auto this_thread_id = std::this_thread::get_id();
+    return std::any_of(_threads.begin(), _threads.end(), [&](const auto& thread) {
+        return thread.get_id() == this_thread_id;
+    });
+}
+
+void CallbackExecutor::notify()
+{
+    // The queue has made its push visible, so either a sleeping thread is
+    // counted here, or it sees the callback when it looks again before
+    // waiting.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_sleeping.load() == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_wakeups;
+    }
+    _work_cv.notify_one();
+}
+
+std::shared_ptr<CallbackExecutor::Entry> CallbackExecutor::next_ready_locked()
+{
+    // Round robin, so a busy instance doesn't starve the others.
+    for (std::size_t i = 0; i < _entries.size(); ++i) {
+        const std::size_t index = (_next_entry + i) % _entries.size();
+        const auto& entry = _entries[index];
+        if (!entry->busy && !entry->queue->empty()) {
+            _next_entry = index + 1;
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+void CallbackExecutor::worker(std::size_t index)
+{
+    _thread_setup.with_index(index).apply();
+
+    std::vector<UserCallback> batch;
+    batch.reserve(BATCH_SIZE);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_should_exit) {
+        if (auto entry = next_ready_locked()) {
+            entry->busy = true;
+            lock.unlock();
+
+            batch.clear();
+            if (entry->queue->try_dequeue_batch(batch, BATCH_SIZE)) {
+                entry->runner(batch, index);
+            }
+            // The callbacks' captures are destroyed before the queue could be
+            // detached.
+            batch.clear();
+
+            lock.lock();
+            entry->busy = false;
+            _idle_cv.notify_all();
+            continue;
+        }
+
+        ++_sleeping;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        // Something might have been queued while we were getting ready to wait.
+        if (next_ready_locked() == nullptr) {
+            const uint64_t wakeups = _wakeups;
+            _work_cv.wait(lock, [&]() { return _wakeups != wakeups || _should_exit; });
+        }
+        --_sleeping;
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "native_thread.h"
+#include "thread_setup.h"
+#include "user_callback_queue.h"
+
+namespace mavsdk {
+
+// Callback threads serving the callback queues of several Mavsdk instances,
+// see Mavsdk::Runtime.
+//
+// A queue is only ever served by one thread at a time, so its callbacks keep
+// their order, while the queues of different instances can run concurrently.
+class CallbackExecutor {
+public:
+    // Runs a batch of callbacks taken off the queue, on callback thread
+    // thread_index.
+    using Runner = std::function<void(std::vector<UserCallback>& batch, std::size_t thread_index)>;
+
+    static constexpr std::size_t BATCH_SIZE = 16;
+
+    // Each thread applies the setup with its index, see ThreadSetup::with_index().
+    explicit CallbackExecutor(std::size_t num_threads, ThreadSetup thread_setup = {});
+    ~CallbackExecutor();
+
+    // Sets the queue's notify, so it must not be in use yet.
+    uint64_t attach(UserCallbackQueue& queue, Runner runner);
+
+    // Once this returns the queue is not used anymore, a batch of it which
+    // is running is waited for. Must not be called from one of its callbacks.
+    void detach(uint64_t handle);
+
+    [[nodiscard]] bool is_callback_thread() const;
+
+    [[nodiscard]] std::size_t num_threads() const { return _threads.size(); }
+
+    // Non-copyable
+    CallbackExecutor(const CallbackExecutor&) = delete;
+    const CallbackExecutor& operator=(const CallbackExecutor&) = delete;
+
+private:
+    struct Entry {
+        uint64_t handle{0};
+        UserCallbackQueue* queue{nullptr};
+        Runner runner{};
+        bool busy{false};
+    };
+
+    void notify();
+    void worker(std::size_t index);
+    std::shared_ptr<Entry> next_ready_locked();
+
+    std::mutex _mutex{};
+    std::condition_variable _work_cv{};
+    std::condition_variable _idle_cv{};
+    std::vector<std::shared_ptr<Entry>> _entries{};
+    std::size_t _next_entry{0};
+    uint64_t _next_handle{1};
+    uint64_t _wakeups{0};
+    std::atomic<unsigned> _sleeping{0};
+    bool _should_exit{false};
+
+    const ThreadSetup _thread_setup;
+    std::vector<NativeThread> _threads{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,111 @@
+#include "callback_executor.h"
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+using OverflowPolicy = Mavsdk::Configuration::CallbackOverflowPolicy;
+
+namespace {
+
+CallbackExecutor::Runner run_all()
+{
+    return [](std::vector<UserCallback>& batch, std::size_t) {
+        for (auto& callback : batch) {
+            callback.func();
+        }
+    };
+}
+
+} // namespace
+
+TEST(CallbackExecutor, QueuesKeepTheirOrder)
+{
+    CallbackExecutor executor{2};
+    UserCallbackQueue first{1000, OverflowPolicy::Block};
+    UserCallbackQueue second{1000, OverflowPolicy::Block};
+    const auto first_handle = executor.attach(first, run_all());
+    const auto second_handle = executor.attach(second, run_all());
+
+    std::vector<int> first_called;
+    std::vector<int> second_called;
+    std::promise<void> first_done;
+    std::promise<void> second_done;
+    for (int i = 0; i < 500; ++i) {
+        first.enqueue(UserCallback{[&, i]() {
+            first_called.push_back(i);
+            if (i == 499) {
+                first_done.set_value();
+            }
+        }});
+        second.enqueue(UserCallback{[&, i]() {
+            second_called.push_back(i);
+            if (i == 499) {
+                second_done.set_value();
+            }
+        }});
+    }
+
+    ASSERT_EQ(
+        first_done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    ASSERT_EQ(
+        second_done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+
+    executor.detach(first_handle);
+    executor.detach(second_handle);
+
+    ASSERT_EQ(first_called.size(), 500);
+    ASSERT_EQ(second_called.size(), 500);
+    for (int i = 0; i < 500; ++i) {
+        EXPECT_EQ(first_called[i], i);
+        EXPECT_EQ(second_called[i], i);
+    }
+}
+
+TEST(CallbackExecutor, SlowQueueDoesNotHoldUpOthers)
+{
+    CallbackExecutor executor{2};
+    UserCallbackQueue slow{10, OverflowPolicy::DropNewest};
+    UserCallbackQueue fast{10, OverflowPolicy::DropNewest};
+    const auto slow_handle = executor.attach(slow, run_all());
+    const auto fast_handle = executor.attach(fast, run_all());
+
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    slow.enqueue(UserCallback{[released]() { released.wait(); }});
+
+    std::promise<void> fast_done;
+    fast.enqueue(UserCallback{[&]() { fast_done.set_value(); }});
+    EXPECT_EQ(
+        fast_done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+
+    release.set_value();
+    executor.detach(slow_handle);
+    executor.detach(fast_handle);
+}
+
+TEST(CallbackExecutor, DetachWaitsForRunningBatch)
+{
+    CallbackExecutor executor{1};
+    UserCallbackQueue queue{10, OverflowPolicy::DropNewest};
+    const auto handle = executor.attach(queue, run_all());
+
+    std::promise<void> started;
+    bool finished = false;
+    queue.enqueue(UserCallback{[&]() {
+        started.set_value();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        finished = true;
+    }});
+
+    started.get_future().wait();
+    executor.detach(handle);
+    EXPECT_TRUE(finished);
+
+    EXPECT_FALSE(executor.is_callback_thread());
+}
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "change_filter.h"
+#include "handle.h"
+#include "handle_id.h"
+#include "subscription_options.h"
+#include "unique_function.h"
+
+namespace mavsdk {
+
+// List of subscribers for one topic, each identified by a Handle.
+//
+// Subscribing and unsubscribing copies the list, publishing an update only
+// loads the current snapshot, so the receive path never takes a lock.
+//
+// An update is stored once in a ref-counted immutable copy which is shared
+// by all subscribers, so fanning out to N subscribers does not copy the
+// arguments or the callbacks N times.
+//
+// Arguments which are small and trivially copyable are copied into the
+// queued function instead, which then fits into UserCallbackFunction, so
+// delivering them does not allocate at all.
+//
+// Each subscriber can thin out its updates using SubscriptionOptions. This
+// is checked before anything is queued, so updates which are not wanted cost
+// neither a slot in the user callback queue nor a copy. Unchanged updates are
+// compared against the last one passed on, so if the rate limit drops a
+// change, it is delayed but not lost.
+template<typename... Args> class CallbackList {
+public:
+    using Callback = std::function<void(Args...)>;
+    using SubscriptionHandle = Handle<Args...>;
+
+    CallbackList() = default;
+    ~CallbackList() = default;
+
+    // Non-copyable
+    CallbackList(const CallbackList&) = delete;
+    const CallbackList& operator=(const CallbackList&) = delete;
+
+    SubscriptionHandle
+    subscribe(const Callback& callback, const SubscriptionOptions& options = SubscriptionOptions{})
+    {
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        const uint64_t id = next_handle_id();
+
+        auto subscribers = std::make_shared<Subscribers>(*std::atomic_load(&_subscribers));
+        subscribers->push_back(Subscriber{
+            id, std::make_shared<const Callback>(callback), std::make_shared<Filter>(options)});
+        std::atomic_store(&_subscribers, std::shared_ptr<const Subscribers>(subscribers));
+
+        return SubscriptionHandle{id};
+    }
+
+    void unsubscribe(SubscriptionHandle handle)
+    {
+        std::lock_guard<std::mutex> lock(_write_mutex);
+
+        auto subscribers = std::make_shared<Subscribers>(*std::atomic_load(&_subscribers));
+        subscribers->erase(
+            std::remove_if(
+                subscribers->begin(),
+                subscribers->end(),
+                [&](const Subscriber& subscriber) { return subscriber.id == handle._id; }),
+            subscribers->end());
+        std::atomic_store(&_subscribers, std::shared_ptr<const Subscribers>(subscribers));
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        std::atomic_store(&_subscribers, std::make_shared<const Subscribers>());
+    }
+
+    [[nodiscard]] bool empty() const { return std::atomic_load(&_subscribers)->empty(); }
+
+    // For subscribers with on_change, lets the next update pass even if it
+    // is the same as the last one, e.g. once the state it refers to was
+    // reset.
+    void reset_changes()
+    {
+        for (const auto& subscriber : *std::atomic_load(&_subscribers)) {
+            subscriber.filter->change.reset();
+        }
+    }
+
+    // Hands one function per subscriber to queue_func, which is meant to put
+    // it on the user callback queue.
+    template<typename QueueFunc> void queue(Args... args, const QueueFunc& queue_func) const
+    {
+        const auto subscribers = std::atomic_load(&_subscribers);
+        if (subscribers->empty()) {
+            return;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        std::shared_ptr<const Arguments> shared_args;
+
+        for (const auto& subscriber : *subscribers) {
+            auto& filter = *subscriber.filter;
+            if (!filter.passes(now) || !filter.change.passes(now, args...)) {
+                continue;
+            }
+
+            if (filter.options.coalesce) {
+                std::unique_lock<std::mutex> lock(filter.latest_mutex);
+                const bool already_queued = filter.latest.has_value();
+                if (shared_args) {
+                    filter.latest = *shared_args;
+                } else {
+                    filter.latest.emplace(args...);
+                }
+                if (already_queued) {
+                    continue;
+                }
+                Delivery delivery{subscriber.callback, subscriber.filter};
+                lock.unlock();
+                queue_func(std::move(delivery));
+            } else if constexpr (INLINE_ARGUMENTS) {
+                queue_func(Call{subscriber.callback, Arguments{args...}});
+            } else {
+                if (!shared_args) {
+                    shared_args = std::make_shared<const Arguments>(std::forward<Args>(args)...);
+                }
+                queue_func([callback = subscriber.callback, shared_args]() {
+                    std::apply(*callback, *shared_args);
+                });
+            }
+        }
+    }
+
+private:
+    using Arguments = std::tuple<std::decay_t<Args>...>;
+
+    struct Call {
+        std::shared_ptr<const Callback> callback;
+        Arguments args;
+
+        void operator()() const { std::apply(*callback, args); }
+    };
+
+    static constexpr bool INLINE_ARGUMENTS =
+        std::conjunction_v<std::is_trivially_copyable<std::decay_t<Args>>...> &&
+        UniqueFunction<void()>::fits_inline<Call>();
+
+    struct Filter {
+        explicit Filter(const SubscriptionOptions& options_) :
+            options(options_),
+            change(options_),
+            min_interval(
+                options_.max_rate_hz > 0.0 ?
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double>(1.0 / options_.max_rate_hz)) :
+                    std::chrono::steady_clock::duration::zero())
+        {}
+
+        bool passes(std::chrono::steady_clock::time_point now)
+        {
+            if (options.decimation > 1 &&
+                count.fetch_add(1, std::memory_order_relaxed) % options.decimation != 0) {
+                return false;
+            }
+
+            if (min_interval == std::chrono::steady_clock::duration::zero()) {
+                return true;
+            }
+
+            auto due = next_due.load(std::memory_order_relaxed);
+            const auto now_ticks = now.time_since_epoch().count();
+            if (now_ticks < due) {
+                return false;
+            }
+            // If another thread got in first, it delivers this period's update.
+            return next_due.compare_exchange_strong(
+                due, now_ticks + min_interval.count(), std::memory_order_relaxed);
+        }
+
+        const SubscriptionOptions options;
+        ChangeFilter<Args...> change;
+        const std::chrono::steady_clock::duration min_interval;
+        std::atomic<uint64_t> count{0};
+        std::atomic<std::chrono::steady_clock::rep> next_due{
+            std::numeric_limits<std::chrono::steady_clock::rep>::min()};
+
+        // Only used for coalescing, set while an update is waiting to be
+        // delivered. The generation changes whenever the waiting update is
+        // delivered or released, and copies of the Delivery queued for it
+        // are counted.
+        std::mutex latest_mutex{};
+        std::optional<Arguments> latest{};
+        uint64_t generation{0};
+        uint32_t delivery_refs{0};
+    };
+
+    // Pending delivery of a coalescing subscriber. If all copies of it are
+    // dropped without being called, e.g. because the queue was full, the
+    // pending value is released so the next update gets queued again.
+    //
+    // The copies are counted in the Filter rather than by sharing a state, so
+    // queueing it does not allocate.
+    class Delivery {
+    public:
+        // To be created with the latest_mutex of the filter held.
+        Delivery(std::shared_ptr<const Callback> callback, std::shared_ptr<Filter> filter) :
+            _callback(std::move(callback)),
+            _filter(std::move(filter)),
+            _generation(++_filter->generation)
+        {
+            _filter->delivery_refs = 1;
+        }
+
+        Delivery(const Delivery& other) :
+            _callback(other._callback),
+            _filter(other._filter),
+            _generation(other._generation)
+        {
+            std::lock_guard<std::mutex> lock(_filter->latest_mutex);
+            if (_generation == _filter->generation) {
+                ++_filter->delivery_refs;
+            }
+        }
+
+        Delivery(Delivery&& other) noexcept :
+            _callback(std::move(other._callback)),
+            _filter(std::move(other._filter)),
+            _generation(other._generation)
+        {}
+
+        ~Delivery()
+        {
+            if (!_filter) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(_filter->latest_mutex);
+            if (_generation == _filter->generation && --_filter->delivery_refs == 0) {
+                _filter->latest.reset();
+                ++_filter->generation;
+            }
+        }
+
+        const Delivery& operator=(const Delivery&) = delete;
+        Delivery& operator=(Delivery&&) = delete;
+
+        void operator()()
+        {
+            std::optional<Arguments> latest;
+            {
+                std::lock_guard<std::mutex> lock(_filter->latest_mutex);
+                if (_generation != _filter->generation) {
+                    return;
+                }
+                latest.swap(_filter->latest);
+                ++_filter->generation;
+            }
+            if (latest) {
+                std::apply(*_callback, *latest);
+            }
+        }
+
+    private:
+        std::shared_ptr<const Callback> _callback;
+        std::shared_ptr<Filter> _filter;
+        uint64_t _generation;
+    };
+
+    struct Subscriber {
+        uint64_t id;
+        std::shared_ptr<const Callback> callback;
+        std::shared_ptr<Filter> filter;
+    };
+    using Subscribers = std::vector<Subscriber>;
+
+    std::shared_ptr<const Subscribers> _subscribers{std::make_shared<const Subscribers>()};
+    std::mutex _write_mutex{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,404 @@
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "callback_list.h"
+#include "unique_function.h"
+
+using namespace mavsdk;
+
+namespace {
+
+using QueuedFunc = std::function<void()>;
+
+thread_local bool counting_allocations = false;
+thread_local std::size_t num_allocations = 0;
+
+// Counts the allocations of this thread while it exists.
+class AllocationCounter {
+public:
+    AllocationCounter()
+    {
+        num_allocations = 0;
+        counting_allocations = true;
+    }
+    ~AllocationCounter() { counting_allocations = false; }
+
+    std::size_t stop()
+    {
+        counting_allocations = false;
+        return num_allocations;
+    }
+};
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    if (counting_allocations) {
+        ++num_allocations;
+    }
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+TEST(CallbackList, QueuesNothingWithoutSubscribers)
+{
+    CallbackList<int> list;
+    EXPECT_TRUE(list.empty());
+
+    std::vector<QueuedFunc> queued;
+    list.queue(42, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+    EXPECT_TRUE(queued.empty());
+}
+
+TEST(CallbackList, FansOutToAllSubscribers)
+{
+    CallbackList<int> list;
+
+    int first = 0;
+    int second = 0;
+    auto first_handle = list.subscribe([&](int value) { first = value; });
+    auto second_handle = list.subscribe([&](int value) { second = value; });
+    EXPECT_TRUE(first_handle.valid());
+    EXPECT_TRUE(second_handle.valid());
+    EXPECT_FALSE(first_handle == second_handle);
+
+    std::vector<QueuedFunc> queued;
+    list.queue(42, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+    ASSERT_EQ(queued.size(), 2u);
+
+    for (auto& func : queued) {
+        func();
+    }
+    EXPECT_EQ(first, 42);
+    EXPECT_EQ(second, 42);
+}
+
+TEST(CallbackList, Unsubscribe)
+{
+    CallbackList<int> list;
+
+    int first = 0;
+    int second = 0;
+    auto first_handle = list.subscribe([&](int value) { first = value; });
+    list.subscribe([&](int value) { second = value; });
+
+    list.unsubscribe(first_handle);
+
+    std::vector<QueuedFunc> queued;
+    list.queue(7, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+    ASSERT_EQ(queued.size(), 1u);
+    queued.front()();
+
+    EXPECT_EQ(first, 0);
+    EXPECT_EQ(second, 7);
+
+    // Unsubscribing twice or with an invalid handle is harmless.
+    list.unsubscribe(first_handle);
+    list.unsubscribe(Handle<int>{});
+    EXPECT_FALSE(list.empty());
+}
+
+TEST(CallbackList, HandleOfOtherListDoesNotUnsubscribe)
+{
+    // E.g. position and home, which share a handle type.
+    CallbackList<int> position;
+    CallbackList<int> home;
+
+    auto position_handle = position.subscribe([](int) {});
+    home.subscribe([](int) {});
+
+    home.unsubscribe(position_handle);
+    EXPECT_FALSE(home.empty());
+
+    position.unsubscribe(position_handle);
+    EXPECT_TRUE(position.empty());
+}
+
+TEST(CallbackList, Clear)
+{
+    CallbackList<int> list;
+    list.subscribe([](int) {});
+    list.subscribe([](int) {});
+
+    list.clear();
+    EXPECT_TRUE(list.empty());
+}
+
+TEST(CallbackList, QueuedCallbackOutlivesUnsubscribe)
+{
+    CallbackList<std::string> list;
+
+    std::string received;
+    auto handle = list.subscribe([&](const std::string& value) { received = value; });
+
+    std::vector<QueuedFunc> queued;
+    list.queue("hello", [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+
+    list.unsubscribe(handle);
+    ASSERT_EQ(queued.size(), 1u);
+    queued.front()();
+
+    EXPECT_EQ(received, "hello");
+}
+
+TEST(CallbackList, Decimation)
+{
+    CallbackList<int> list;
+
+    std::vector<int> received;
+    SubscriptionOptions options;
+    options.decimation = 3;
+    list.subscribe([&](int value) { received.push_back(value); }, options);
+
+    std::vector<QueuedFunc> queued;
+    for (int i = 0; i < 10; ++i) {
+        list.queue(i, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+    }
+    for (auto& func : queued) {
+        func();
+    }
+
+    EXPECT_EQ(received, (std::vector<int>{0, 3, 6, 9}));
+}
+
+TEST(CallbackList, MaxRate)
+{
+    CallbackList<int> list;
+
+    std::vector<int> limited;
+    SubscriptionOptions options;
+    options.max_rate_hz = 10.0;
+    list.subscribe([&](int value) { limited.push_back(value); }, options);
+
+    std::vector<int> unlimited;
+    list.subscribe([&](int value) { unlimited.push_back(value); });
+
+    std::vector<QueuedFunc> queued;
+    for (int i = 0; i < 100; ++i) {
+        list.queue(i, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    list.queue(100, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+
+    for (auto& func : queued) {
+        func();
+    }
+
+    EXPECT_EQ(limited, (std::vector<int>{0, 100}));
+    EXPECT_EQ(unlimited.size(), 101u);
+}
+
+TEST(CallbackList, CoalesceDeliversLatestValue)
+{
+    CallbackList<int> list;
+
+    std::vector<int> received;
+    SubscriptionOptions options;
+    options.coalesce = true;
+    list.subscribe([&](int value) { received.push_back(value); }, options);
+
+    std::vector<QueuedFunc> queued;
+    for (int i = 0; i < 5; ++i) {
+        list.queue(i, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+    }
+    ASSERT_EQ(queued.size(), 1u);
+    queued.front()();
+    EXPECT_EQ(received, (std::vector<int>{4}));
+
+    // Once delivered, the next update is queued again.
+    queued.clear();
+    list.queue(5, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+    ASSERT_EQ(queued.size(), 1u);
+    queued.front()();
+    EXPECT_EQ(received, (std::vector<int>{4, 5}));
+}
+
+TEST(CallbackList, CoalesceRecoversFromDroppedCallback)
+{
+    CallbackList<int> list;
+
+    std::vector<int> received;
+    SubscriptionOptions options;
+    options.coalesce = true;
+    list.subscribe([&](int value) { received.push_back(value); }, options);
+
+    // The queue drops the first function without calling it.
+    list.queue(1, [](QueuedFunc) {});
+
+    std::vector<QueuedFunc> queued;
+    list.queue(2, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+    ASSERT_EQ(queued.size(), 1u);
+    queued.front()();
+    EXPECT_EQ(received, (std::vector<int>{2}));
+}
+
+TEST(CallbackList, OnChangeDropsRepeatedUpdates)
+{
+    CallbackList<bool> list;
+
+    std::vector<bool> changes;
+    SubscriptionOptions options;
+    options.on_change = true;
+    list.subscribe([&](bool armed) { changes.push_back(armed); }, options);
+
+    std::vector<bool> all;
+    list.subscribe([&](bool armed) { all.push_back(armed); });
+
+    std::vector<QueuedFunc> queued;
+    for (const bool armed : {false, false, true, true, true, false}) {
+        list.queue(armed, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+    }
+    for (auto& func : queued) {
+        func();
+    }
+
+    EXPECT_EQ(changes, (std::vector<bool>{false, true, false}));
+    EXPECT_EQ(all.size(), 6u);
+}
+
+TEST(CallbackList, OnChangeRepeatsAfterKeepAlive)
+{
+    CallbackList<int> list;
+
+    std::vector<int> received;
+    SubscriptionOptions options;
+    options.on_change = true;
+    options.keep_alive_s = 0.05;
+    list.subscribe([&](int value) { received.push_back(value); }, options);
+
+    std::vector<QueuedFunc> queued;
+    list.queue(1, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+    list.queue(1, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    list.queue(1, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+    for (auto& func : queued) {
+        func();
+    }
+
+    EXPECT_EQ(received, (std::vector<int>{1, 1}));
+}
+
+TEST(CallbackList, OnChangeDelaysChangeDroppedByRateLimit)
+{
+    CallbackList<int> list;
+
+    std::vector<int> received;
+    SubscriptionOptions options;
+    options.on_change = true;
+    options.max_rate_hz = 10.0;
+    list.subscribe([&](int value) { received.push_back(value); }, options);
+
+    std::vector<QueuedFunc> queued;
+    list.queue(1, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+    list.queue(2, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    list.queue(2, [&](QueuedFunc func) { queued.push_back(std::move(func)); });
+    for (auto& func : queued) {
+        func();
+    }
+
+    EXPECT_EQ(received, (std::vector<int>{1, 2}));
+}
+
+TEST(CallbackList, DeliveryDoesNotAllocate)
+{
+    CallbackList<int, double> list;
+
+    int sum = 0;
+    list.subscribe([&](int value, double) { sum += value; });
+    list.subscribe([&](int value, double) { sum += value; });
+
+    std::vector<UniqueFunction<void()>> queued;
+    queued.reserve(200);
+    const auto queue_func = [&](UniqueFunction<void()> func) { queued.push_back(std::move(func)); };
+
+    AllocationCounter counter;
+    for (int i = 0; i < 100; ++i) {
+        list.queue(1, 2.0, queue_func);
+    }
+    for (auto& func : queued) {
+        func();
+    }
+    queued.clear();
+    EXPECT_EQ(counter.stop(), 0u);
+
+    EXPECT_EQ(sum, 200);
+}
+
+TEST(CallbackList, CoalescedDeliveryDoesNotAllocate)
+{
+    CallbackList<int> list;
+
+    std::vector<int> received;
+    received.reserve(100);
+    SubscriptionOptions options;
+    options.coalesce = true;
+    list.subscribe([&](int value) { received.push_back(value); }, options);
+
+    std::vector<UniqueFunction<void()>> queued;
+    queued.reserve(100);
+    const auto queue_func = [&](UniqueFunction<void()> func) { queued.push_back(std::move(func)); };
+
+    AllocationCounter counter;
+    for (int i = 0; i < 100; ++i) {
+        list.queue(i, queue_func);
+        list.queue(i + 1000, queue_func);
+        for (auto& func : queued) {
+            func();
+        }
+        queued.clear();
+    }
+    // Dropped without being called.
+    list.queue(1, [](UniqueFunction<void()>) {});
+    EXPECT_EQ(counter.stop(), 0u);
+
+    ASSERT_EQ(received.size(), 100u);
+    EXPECT_EQ(received.back(), 1099);
+}
+
+TEST(CallbackList, LargeArgumentsAreSharedByAllSubscribers)
+{
+    using Large = std::array<double, 32>;
+    CallbackList<Large> list;
+
+    double sum = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        list.subscribe([&](const Large& value) { sum += value[0]; });
+    }
+
+    std::vector<UniqueFunction<void()>> queued;
+    queued.reserve(3);
+    const auto queue_func = [&](UniqueFunction<void()> func) { queued.push_back(std::move(func)); };
+
+    Large large{};
+    large[0] = 1.0;
+
+    // One copy for all of them.
+    AllocationCounter counter;
+    list.queue(large, queue_func);
+    EXPECT_EQ(counter.stop(), 1u);
+
+    for (auto& func : queued) {
+        func();
+    }
+    EXPECT_DOUBLE_EQ(sum, 3.0);
+}
@@ -0,0 +1,111 @@
+#include "callback_watchdog.h"
+
+#include <algorithm>
+#include <string>
+
+namespace mavsdk {
+
+CallbackWatchdog::CallbackWatchdog(std::size_t num_threads) :
+    _num_threads(num_threads),
+    _slots(std::make_unique<Slot[]>(num_threads))
+{}
+
+void CallbackWatchdog::begin(
+    std::size_t thread_index, const char* filename, int linenumber, uint64_t now_ns)
+{
+    auto& slot = _slots[thread_index];
+    slot.filename.store(filename, std::memory_order_release);
+    slot.linenumber.store(linenumber, std::memory_order_release);
+    slot.start_ns.store(now_ns, std::memory_order_release);
+    slot.sequence.fetch_add(1, std::memory_order_release);
+}
+
+void CallbackWatchdog::end(std::size_t thread_index, uint64_t now_ns)
+{
+    auto& slot = _slots[thread_index];
+    slot.sequence.fetch_add(1, std::memory_order_release);
+
+    if (_duration_stats_enabled.load(std::memory_order_relaxed)) {
+        const auto start_ns = slot.start_ns.load(std::memory_order_relaxed);
+        const CallSite call_site{
+            slot.filename.load(std::memory_order_relaxed),
+            slot.linenumber.load(std::memory_order_relaxed)};
+
+        std::lock_guard<std::mutex> lock(slot.durations_mutex);
+        slot.durations[call_site].record(now_ns > start_ns ? now_ns - start_ns : 0);
+    }
+}
+
+std::vector<CallbackWatchdog::Stalled>
+CallbackWatchdog::check(uint64_t now_ns, uint64_t timeout_ns)
+{
+    std::vector<Stalled> stalled;
+
+    for (std::size_t i = 0; i < _num_threads; ++i) {
+        auto& slot = _slots[i];
+
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence % 2 == 0 || sequence == slot.reported_sequence) {
+            continue;
+        }
+
+        const auto start_ns = slot.start_ns.load(std::memory_order_acquire);
+        const auto* filename = slot.filename.load(std::memory_order_acquire);
+        const auto linenumber = slot.linenumber.load(std::memory_order_acquire);
+
+        // The callback might have finished, and the next one begun, meanwhile.
+        if (slot.sequence.load(std::memory_order_acquire) != sequence) {
+            continue;
+        }
+
+        if (now_ns > start_ns && now_ns - start_ns > timeout_ns) {
+            slot.reported_sequence = sequence;
+            stalled.push_back(Stalled{filename, linenumber, now_ns - start_ns});
+        }
+    }
+
+    return stalled;
+}
+
+void CallbackWatchdog::set_duration_stats_enabled(bool enabled)
+{
+    _duration_stats_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+std::vector<Mavsdk::CallbackDurationStats> CallbackWatchdog::duration_stats() const
+{
+    // The same call site can show up on several threads.
+    std::unordered_map<CallSite, LatencyHistogram, CallSite::Hash> merged;
+    for (std::size_t i = 0; i < _num_threads; ++i) {
+        std::lock_guard<std::mutex> lock(_slots[i].durations_mutex);
+        for (const auto& pair : _slots[i].durations) {
+            merged[pair.first].merge(pair.second);
+        }
+    }
+
+    std::vector<Mavsdk::CallbackDurationStats> result;
+    result.reserve(merged.size());
+    for (const auto& pair : merged) {
+        Mavsdk::CallbackDurationStats stats;
+        stats.filename = pair.first.filename;
+        stats.linenumber = pair.first.linenumber;
+        stats.duration = pair.second.stats();
+        result.push_back(std::move(stats));
+    }
+
+    std::sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+        const int compared = lhs.filename.compare(rhs.filename);
+        return compared != 0 ? compared < 0 : lhs.linenumber < rhs.linenumber;
+    });
+    return result;
+}
+
+void CallbackWatchdog::reset_duration_stats()
+{
+    for (std::size_t i = 0; i < _num_threads; ++i) {
+        std::lock_guard<std::mutex> lock(_slots[i].durations_mutex);
+        _slots[i].durations.clear();
+    }
+}
+
+} // namespace mavsdk
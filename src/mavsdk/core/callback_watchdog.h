@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "mavsdk.h"
+#include "message_latency.h"
+
+namespace mavsdk {
+
+// Watches the user callback threads for callbacks which take too long.
+//
+// Each callback thread publishes the callback it is running in a slot of its
+// own, and a timer on the work thread samples the slots. This costs a few
+// atomic stores per callback, rather than adding and removing a timeout for
+// every single one.
+//
+// Optionally, the duration of each callback is recorded in a histogram per
+// call site.
+class CallbackWatchdog {
+public:
+    explicit CallbackWatchdog(std::size_t num_threads);
+    ~CallbackWatchdog() = default;
+
+    // Called by callback thread thread_index around every callback.
+    void begin(std::size_t thread_index, const char* filename, int linenumber, uint64_t now_ns);
+    void end(std::size_t thread_index, uint64_t now_ns);
+
+    struct Stalled {
+        const char* filename;
+        int linenumber;
+        uint64_t running_ns;
+    };
+
+    // Callbacks which are running for longer than the timeout, each one is
+    // only returned once. Meant to be called from one thread only.
+    std::vector<Stalled> check(uint64_t now_ns, uint64_t timeout_ns);
+
+    void set_duration_stats_enabled(bool enabled);
+    [[nodiscard]] std::vector<Mavsdk::CallbackDurationStats> duration_stats() const;
+    void reset_duration_stats();
+
+    // Non-copyable
+    CallbackWatchdog(const CallbackWatchdog&) = delete;
+    const CallbackWatchdog& operator=(const CallbackWatchdog&) = delete;
+
+private:
+    struct CallSite {
+        // Always a string literal (see FILENAME), so the pointer is enough.
+        const char* filename;
+        int linenumber;
+
+        bool operator==(const CallSite& other) const
+        {
+            return filename == other.filename && linenumber == other.linenumber;
+        }
+
+        struct Hash {
+            std::size_t operator()(const CallSite& call_site) const
+            {
+                return std::hash<const char*>{}(call_site.filename) ^
+                       (std::hash<int>{}(call_site.linenumber) << 1);
+            }
+        };
+    };
+
+    struct Slot {
+        // Odd while a callback is running. The call site is stored before a
+        // callback begins, so a sampled call site belongs to the sequence if
+        // the sequence is unchanged afterwards.
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<uint64_t> start_ns{0};
+        std::atomic<const char*> filename{""};
+        std::atomic<int> linenumber{0};
+
+        // Only used by check().
+        uint64_t reported_sequence{0};
+
+        mutable std::mutex durations_mutex{};
+        std::unordered_map<CallSite, LatencyHistogram, CallSite::Hash> durations{};
+    };
+
+    const std::size_t _num_threads;
+    std::unique_ptr<Slot[]> _slots;
+    std::atomic<bool> _duration_stats_enabled{false};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,85 @@
+#include "callback_watchdog.h"
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace mavsdk;
+
+static constexpr uint64_t SECOND_NS = 1000000000;
+
+TEST(CallbackWatchdog, NothingRunning)
+{
+    CallbackWatchdog watchdog(2);
+    EXPECT_TRUE(watchdog.check(10 * SECOND_NS, SECOND_NS).empty());
+}
+
+TEST(CallbackWatchdog, ReportsStalledCallbackOnce)
+{
+    CallbackWatchdog watchdog(2);
+    static const char* filename = "foo_impl.cpp";
+
+    watchdog.begin(1, filename, 42, 1 * SECOND_NS);
+    EXPECT_TRUE(watchdog.check(1 * SECOND_NS + SECOND_NS / 2, SECOND_NS).empty());
+
+    const auto stalled = watchdog.check(3 * SECOND_NS, SECOND_NS);
+    ASSERT_EQ(stalled.size(), 1u);
+    EXPECT_EQ(stalled[0].filename, filename);
+    EXPECT_EQ(stalled[0].linenumber, 42);
+    EXPECT_EQ(stalled[0].running_ns, 2 * SECOND_NS);
+
+    // Still the same callback.
+    EXPECT_TRUE(watchdog.check(4 * SECOND_NS, SECOND_NS).empty());
+
+    // The next one gets reported again.
+    watchdog.end(1, 5 * SECOND_NS);
+    EXPECT_TRUE(watchdog.check(10 * SECOND_NS, SECOND_NS).empty());
+    watchdog.begin(1, filename, 43, 10 * SECOND_NS);
+    EXPECT_EQ(watchdog.check(12 * SECOND_NS, SECOND_NS).size(), 1u);
+}
+
+TEST(CallbackWatchdog, DurationStatsAreOptIn)
+{
+    CallbackWatchdog watchdog(1);
+
+    watchdog.begin(0, "foo_impl.cpp", 1, 0);
+    watchdog.end(0, 1000);
+    EXPECT_TRUE(watchdog.duration_stats().empty());
+
+    watchdog.set_duration_stats_enabled(true);
+    watchdog.begin(0, "foo_impl.cpp", 1, 0);
+    watchdog.end(0, 1000);
+    watchdog.begin(0, "foo_impl.cpp", 1, 0);
+    watchdog.end(0, 3000);
+
+    const auto stats = watchdog.duration_stats();
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].filename, "foo_impl.cpp");
+    EXPECT_EQ(stats[0].linenumber, 1);
+    EXPECT_EQ(stats[0].duration.count, 2u);
+    EXPECT_EQ(stats[0].duration.max_ns, 3000u);
+
+    watchdog.reset_duration_stats();
+    EXPECT_TRUE(watchdog.duration_stats().empty());
+}
+
+TEST(CallbackWatchdog, DurationStatsAreMergedAcrossThreads)
+{
+    CallbackWatchdog watchdog(2);
+    watchdog.set_duration_stats_enabled(true);
+    static const char* filename = "bar_impl.cpp";
+
+    watchdog.begin(0, filename, 7, 0);
+    watchdog.end(0, 100);
+    watchdog.begin(1, filename, 7, 0);
+    watchdog.end(1, 200);
+    watchdog.begin(1, filename, 3, 0);
+    watchdog.end(1, 50);
+
+    const auto stats = watchdog.duration_stats();
+    ASSERT_EQ(stats.size(), 2u);
+    EXPECT_EQ(stats[0].linenumber, 3);
+    EXPECT_EQ(stats[0].duration.count, 1u);
+    EXPECT_EQ(stats[1].linenumber, 7);
+    EXPECT_EQ(stats[1].duration.count, 2u);
+    EXPECT_EQ(stats[1].duration.max_ns, 200u);
+}
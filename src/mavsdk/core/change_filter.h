@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "subscription_options.h"
+
+namespace mavsdk {
+
+// Drops updates equal to the last one passed, for subscriptions with
+// SubscriptionOptions::on_change. With keep_alive_s, an unchanged update
+// still passes once that long after the last one passed.
+//
+// Updates of types which can't be compared always count as changed.
+template<typename... Args> class ChangeFilter {
+public:
+    explicit ChangeFilter(const SubscriptionOptions& options) :
+        _on_change(options.on_change),
+        _keep_alive(
+            options.keep_alive_s > 0.0 ?
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(options.keep_alive_s)) :
+                std::chrono::steady_clock::duration::zero())
+    {}
+
+    ~ChangeFilter() = default;
+
+    // Non-copyable
+    ChangeFilter(const ChangeFilter&) = delete;
+    const ChangeFilter& operator=(const ChangeFilter&) = delete;
+
+    bool passes(std::chrono::steady_clock::time_point now, const Args&... args)
+    {
+        if (!_on_change) {
+            return true;
+        }
+
+        if constexpr (COMPARABLE) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            const bool changed = !_last.has_value() || !(*_last == std::tie(args...));
+            const bool keep_alive_due =
+                _keep_alive != std::chrono::steady_clock::duration::zero() &&
+                now - _last_passed >= _keep_alive;
+            if (!changed && !keep_alive_due) {
+                return false;
+            }
+            _last.emplace(args...);
+            _last_passed = now;
+        }
+        return true;
+    }
+
+    // Lets the next update pass, changed or not.
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _last.reset();
+    }
+
+private:
+    template<typename T, typename = void> struct is_comparable : std::false_type {};
+    template<typename T>
+    struct is_comparable<
+        T,
+        std::void_t<decltype(std::declval<const T&>() == std::declval<const T&>())>>
+        : std::true_type {};
+
+    static constexpr bool COMPARABLE = std::conjunction_v<is_comparable<std::decay_t<Args>>...>;
+
+    const bool _on_change;
+    const std::chrono::steady_clock::duration _keep_alive;
+
+    std::mutex _mutex{};
+    std::optional<std::tuple<std::decay_t<Args>...>> _last{};
+    std::chrono::steady_clock::time_point _last_passed{};
+};
+
+} // namespace mavsdk
@@ -12,6 +12,8 @@ void CliArg::reset()
     _path.clear();
     _baudrate = 0;
     _port = 0;
+    _fast_replay = false;
+    _emulation.clear();
 }
 
 bool CliArg::parse(const std::string& uri)
@@ -23,6 +25,11 @@ bool CliArg::parse(const std::string& uri)
         return false;
     }
 
+    // A path to a tlog can contain a '?' as well.
+    if (_protocol != Protocol::Replay && !find_options(rest)) {
+        return false;
+    }
+
     if (!find_path(rest)) {
         return false;
     }
@@ -31,6 +38,8 @@ bool CliArg::parse(const std::string& uri)
         if (!find_baudrate(rest)) {
             return false;
         }
+    } else if (_protocol == Protocol::Replay) {
+        // The path is all there is.
     } else {
         if (!find_port(rest)) {
             return false;
@@ -44,8 +53,11 @@ bool CliArg::find_protocol(std::string& rest)
 {
     const std::string udp = "udp";
     const std::string tcp = "tcp";
+    const std::string tcpin = "tcpin";
     const std::string serial = "serial";
     const std::string serial_flowcontrol = "serial_flowcontrol";
+    const std::string replay = "replay";
+    const std::string replay_fast = "replay_fast";
     const std::string delimiter = "://";
 
     if (rest.find(udp + delimiter) == 0) {
@@ -56,6 +68,10 @@ bool CliArg::find_protocol(std::string& rest)
         _protocol = Protocol::Tcp;
         rest.erase(0, tcp.length() + delimiter.length());
         return true;
+    } else if (rest.find(tcpin + delimiter) == 0) {
+        _protocol = Protocol::TcpIn;
+        rest.erase(0, tcpin.length() + delimiter.length());
+        return true;
     } else if (rest.find(serial + delimiter) == 0) {
         _protocol = Protocol::Serial;
         _flow_control_enabled = false;
@@ -66,24 +82,74 @@ bool CliArg::find_protocol(std::string& rest)
         _flow_control_enabled = true;
         rest.erase(0, serial_flowcontrol.length() + delimiter.length());
         return true;
+    } else if (rest.find(replay + delimiter) == 0) {
+        _protocol = Protocol::Replay;
+        _fast_replay = false;
+        rest.erase(0, replay.length() + delimiter.length());
+        return true;
+    } else if (rest.find(replay_fast + delimiter) == 0) {
+        _protocol = Protocol::Replay;
+        _fast_replay = true;
+        rest.erase(0, replay_fast.length() + delimiter.length());
+        return true;
     } else {
         LogWarn() << "Unknown protocol";
         return false;
     }
 }
 
+bool CliArg::find_options(std::string& rest)
+{
+    const auto pos = rest.find('?');
+    if (pos == std::string::npos) {
+        return true;
+    }
+    const std::string options = rest.substr(pos + 1);
+    rest.erase(pos);
+
+    std::size_t start = 0;
+    while (start <= options.size()) {
+        auto end = options.find('&', start);
+        if (end == std::string::npos) {
+            end = options.size();
+        }
+        const std::string option = options.substr(start, end - start);
+        start = end + 1;
+
+        const std::string emulate = "emulate=";
+        if (option.find(emulate) == 0 && option.length() > emulate.length()) {
+            _emulation = option.substr(emulate.length());
+        } else {
+            LogWarn() << "Unknown connection option: " << option;
+            return false;
+        }
+    }
+    return true;
+}
+
 bool CliArg::find_path(std::string& rest)
 {
     if (rest.length() == 0) {
-        if (_protocol == Protocol::Udp || _protocol == Protocol::Tcp) {
+        if (_protocol == Protocol::Udp || _protocol == Protocol::Tcp ||
+            _protocol == Protocol::TcpIn) {
             // We have to use the default path
             return true;
+        } else if (_protocol == Protocol::Replay) {
+            LogWarn() << "Path of tlog to replay required.";
+            return false;
         } else {
             LogWarn() << "Path for serial device required.";
             return false;
         }
     }
 
+    // A path to a file can contain anything.
+    if (_protocol == Protocol::Replay) {
+        _path = rest;
+        rest = "";
+        return true;
+    }
+
     const std::string delimiter = ":";
     size_t pos = rest.find(delimiter);
     if (pos != std::string::npos) {
@@ -6,7 +6,7 @@ namespace mavsdk {
 
 class CliArg {
 public:
-    enum class Protocol { None, Udp, Tcp, Serial };
+    enum class Protocol { None, Udp, Tcp, TcpIn, Serial, Replay };
 
     bool parse(const std::string& uri);
 
@@ -18,11 +18,18 @@ public:
 
     [[nodiscard]] bool get_flow_control() const { return _flow_control_enabled; }
 
+    // For replay, whether to replay as fast as possible instead of at the original timing.
+    [[nodiscard]] bool get_fast_replay() const { return _fast_replay; }
+
     [[nodiscard]] std::string get_path() const { return _path; }
 
+    // The link impairments asked for with "?emulate=...", see LinkEmulator::parse().
+    [[nodiscard]] std::string get_emulation() const { return _emulation; }
+
 private:
     void reset();
     bool find_protocol(std::string& rest);
+    bool find_options(std::string& rest);
     bool find_path(std::string& rest);
     bool find_port(std::string& rest);
     bool find_baudrate(std::string& rest);
@@ -32,6 +39,8 @@ private:
     int _port{0};
     int _baudrate{0};
     bool _flow_control_enabled{false};
+    bool _fast_replay{false};
+    std::string _emulation{};
 };
 
 } // namespace mavsdk
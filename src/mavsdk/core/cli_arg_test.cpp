@@ -116,6 +116,29 @@ TEST(CliArg, TCPConnections)
     EXPECT_FALSE(ca.parse("tcp://127.0.0.1:-5"));
 }
 
+TEST(CliArg, TCPServerConnections)
+{
+    CliArg ca;
+
+    EXPECT_TRUE(ca.parse("tcpin://0.0.0.0:5760"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::TcpIn);
+    EXPECT_STREQ(ca.get_path().c_str(), "0.0.0.0");
+    EXPECT_EQ(5760, ca.get_port());
+
+    EXPECT_TRUE(ca.parse("tcpin://"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::TcpIn);
+    EXPECT_STREQ(ca.get_path().c_str(), "");
+    EXPECT_EQ(0, ca.get_port());
+
+    EXPECT_TRUE(ca.parse("tcpin://:5761"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::TcpIn);
+    EXPECT_STREQ(ca.get_path().c_str(), "");
+    EXPECT_EQ(5761, ca.get_port());
+
+    EXPECT_FALSE(ca.parse("tcpin:/0.0.0.0:5760"));
+    EXPECT_FALSE(ca.parse("tcpin://0.0.0.0:100000"));
+}
+
 TEST(CliArg, SerialConnections)
 {
     CliArg ca;
@@ -167,3 +190,53 @@ TEST(CliArg, SerialConnections)
     EXPECT_FALSE(ca.parse("serial://SOM3:57600"));
     EXPECT_FALSE(ca.parse("serial://COM3:-1"));
 }
+
+TEST(CliArg, ReplayConnections)
+{
+    CliArg ca;
+
+    EXPECT_TRUE(ca.parse("replay://flight.tlog"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::Replay);
+    EXPECT_STREQ(ca.get_path().c_str(), "flight.tlog");
+    EXPECT_EQ(false, ca.get_fast_replay());
+
+    EXPECT_TRUE(ca.parse("replay_fast:///tmp/logs/2021-01-01 10:00:00.tlog"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::Replay);
+    EXPECT_STREQ(ca.get_path().c_str(), "/tmp/logs/2021-01-01 10:00:00.tlog");
+    EXPECT_EQ(true, ca.get_fast_replay());
+
+    EXPECT_TRUE(ca.parse("replay://flight.tlog"));
+    EXPECT_EQ(false, ca.get_fast_replay());
+
+    EXPECT_FALSE(ca.parse("replay://"));
+    EXPECT_FALSE(ca.parse("replay:/flight.tlog"));
+}
+
+TEST(CliArg, LinkEmulation)
+{
+    CliArg ca;
+
+    EXPECT_TRUE(ca.parse("udp://:14540?emulate=rtt:300,loss:5,bw:57600"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::Udp);
+    EXPECT_STREQ(ca.get_path().c_str(), "");
+    EXPECT_EQ(14540, ca.get_port());
+    EXPECT_STREQ(ca.get_emulation().c_str(), "rtt:300,loss:5,bw:57600");
+
+    EXPECT_TRUE(ca.parse("serial:///dev/ttyUSB0:57600?emulate=loss:1"));
+    EXPECT_STREQ(ca.get_path().c_str(), "/dev/ttyUSB0");
+    EXPECT_EQ(57600, ca.get_baudrate());
+    EXPECT_STREQ(ca.get_emulation().c_str(), "loss:1");
+
+    EXPECT_TRUE(ca.parse("tcp://127.0.0.1:5760"));
+    EXPECT_STREQ(ca.get_emulation().c_str(), "");
+
+    // For a replay, it's part of the path.
+    EXPECT_TRUE(ca.parse("replay://flight.tlog?emulate=loss:1"));
+    EXPECT_STREQ(ca.get_path().c_str(), "flight.tlog?emulate=loss:1");
+    EXPECT_STREQ(ca.get_emulation().c_str(), "");
+
+    EXPECT_FALSE(ca.parse("udp://:14540?"));
+    EXPECT_FALSE(ca.parse("udp://:14540?emulate="));
+    EXPECT_FALSE(ca.parse("udp://:14540?delay=300"));
+    EXPECT_FALSE(ca.parse("udp://:14540?emulate=loss:1&delay=300"));
+}
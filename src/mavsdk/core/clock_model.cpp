@@ -0,0 +1,160 @@
+#include "clock_model.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mavsdk {
+
+bool ClockModel::add_sample(int64_t local_send_ns, int64_t remote_ns, int64_t local_receive_ns)
+{
+    const int64_t rtt_ns = local_receive_ns - local_send_ns;
+    if (rtt_ns < 0) {
+        return false;
+    }
+
+    // Assuming the delay is the same both ways, the remote time was taken
+    // half way through the round trip. The error of that is at most half
+    // the round trip, anywhere within it.
+    const int64_t local_ns = local_send_ns + rtt_ns / 2;
+    const int64_t measured_offset_ns = remote_ns - local_ns;
+    const double half_rtt_ns = static_cast<double>(rtt_ns) / 2.0;
+    const double variance =
+        std::max(half_rtt_ns * half_rtt_ns / 3.0, MIN_MEASUREMENT_VARIANCE_NS2);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const bool too_slow = is_round_trip_too_slow(rtt_ns);
+
+    // Slow round trips count as well, so the window follows a link which
+    // got slower for good.
+    _rtts_ns[_next_rtt] = rtt_ns;
+    _next_rtt = (_next_rtt + 1) % RTT_WINDOW;
+    _num_rtts = std::min(_num_rtts + 1, RTT_WINDOW);
+
+    if (too_slow) {
+        return false;
+    }
+
+    if (!_initialized) {
+        start_over(local_ns, measured_offset_ns, variance);
+        publish();
+        return true;
+    }
+
+    if (local_ns < _last_local_ns) {
+        return false;
+    }
+
+    // Predict up to the time of the sample.
+    const double dt = static_cast<double>(local_ns - _last_local_ns);
+    _offset_ns += _drift * dt;
+    _p00 += 2.0 * dt * _p01 + dt * dt * _p11 + OFFSET_NOISE_NS2_PER_NS * dt;
+    _p01 += dt * _p11;
+    _p11 += DRIFT_NOISE_PER_NS * dt;
+    _last_local_ns = local_ns;
+
+    const double innovation =
+        static_cast<double>(measured_offset_ns - _base_offset_ns) - _offset_ns;
+    const double innovation_variance = _p00 + variance;
+
+    if (innovation * innovation > OUTLIER_SIGMAS * OUTLIER_SIGMAS * innovation_variance) {
+        if (++_consecutive_outliers > MAX_CONSECUTIVE_OUTLIERS) {
+            start_over(local_ns, measured_offset_ns, variance);
+            publish();
+            return true;
+        }
+        publish();
+        return false;
+    }
+    _consecutive_outliers = 0;
+
+    const double gain_offset = _p00 / innovation_variance;
+    const double gain_drift = _p01 / innovation_variance;
+    _offset_ns += gain_offset * innovation;
+    _drift += gain_drift * innovation;
+
+    const double p00 = _p00;
+    const double p01 = _p01;
+    _p00 = p00 - gain_offset * p00;
+    _p01 = p01 - gain_offset * p01;
+    _p11 -= gain_drift * p01;
+
+    ++_num_samples;
+    publish();
+    return true;
+}
+
+void ClockModel::reset()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _initialized = false;
+    _num_samples = 0;
+    _consecutive_outliers = 0;
+    _num_rtts = 0;
+    _next_rtt = 0;
+    publish();
+}
+
+std::optional<int64_t> ClockModel::to_local_ns(int64_t remote_ns) const
+{
+    const auto estimate = _estimate.load();
+    if (!estimate.synced) {
+        return std::nullopt;
+    }
+
+    const int64_t delta_ns = remote_ns - estimate.base_offset_ns - estimate.reference_local_ns;
+    const double since_reference_ns =
+        (static_cast<double>(delta_ns) - estimate.offset_ns) / (1.0 + estimate.drift);
+    return estimate.reference_local_ns + std::llround(since_reference_ns);
+}
+
+std::optional<int64_t> ClockModel::to_remote_ns(int64_t local_ns) const
+{
+    const auto estimate = _estimate.load();
+    if (!estimate.synced) {
+        return std::nullopt;
+    }
+
+    const double since_reference_ns = static_cast<double>(local_ns - estimate.reference_local_ns);
+    return local_ns + estimate.base_offset_ns +
+           std::llround(estimate.offset_ns + estimate.drift * since_reference_ns);
+}
+
+void ClockModel::start_over(int64_t local_ns, int64_t measured_offset_ns, double variance)
+{
+    _initialized = true;
+    _num_samples = 1;
+    _consecutive_outliers = 0;
+    _base_offset_ns = measured_offset_ns;
+    _last_local_ns = local_ns;
+    _offset_ns = 0.0;
+    _drift = 0.0;
+    _p00 = variance;
+    _p01 = 0.0;
+    _p11 = INITIAL_DRIFT_VARIANCE;
+}
+
+void ClockModel::publish()
+{
+    Estimate estimate;
+    estimate.synced = _initialized && _num_samples >= MIN_SAMPLES;
+    estimate.base_offset_ns = _base_offset_ns;
+    estimate.reference_local_ns = _last_local_ns;
+    estimate.offset_ns = _offset_ns;
+    estimate.drift = _drift;
+    estimate.offset_stddev_ns = std::sqrt(std::max(_p00, 0.0));
+    _estimate.store(estimate);
+}
+
+bool ClockModel::is_round_trip_too_slow(int64_t rtt_ns) const
+{
+    if (_num_rtts == 0) {
+        return false;
+    }
+
+    const int64_t fastest_ns = *std::min_element(_rtts_ns.begin(), _rtts_ns.begin() + _num_rtts);
+    return static_cast<double>(rtt_ns) >
+           static_cast<double>(fastest_ns) * MAX_RTT_FACTOR + static_cast<double>(RTT_SLACK_NS);
+}
+
+} // namespace mavsdk
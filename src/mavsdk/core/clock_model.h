@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include "seqlock.h"
+
+namespace mavsdk {
+
+// Estimate of how the clock of a remote system maps to the local monotonic
+// clock, from TIMESYNC round trips.
+//
+// The remote clock is modelled as the local one plus an offset which drifts
+// linearly. A Kalman filter tracks offset and drift, weighing every sample
+// by how much its round trip leaves the one way delay open. Samples which
+// took much longer than the fastest recent round trip are dropped, their
+// delay was likely spent in a queue on one of the ways only.
+//
+// Samples are added under a lock, the conversions read the latest estimate
+// through a seqlock and don't take any.
+class ClockModel {
+public:
+    ClockModel() = default;
+    ~ClockModel() = default;
+
+    // Non-copyable
+    ClockModel(const ClockModel&) = delete;
+    const ClockModel& operator=(const ClockModel&) = delete;
+
+    // A round trip from local_send_ns to local_receive_ns, the remote system
+    // answering with remote_ns. Returns false if the sample was dropped.
+    bool add_sample(int64_t local_send_ns, int64_t remote_ns, int64_t local_receive_ns);
+
+    void reset();
+
+    [[nodiscard]] bool is_synced() const { return _estimate.load().synced; }
+
+    // Empty as long as the model is not synced.
+    [[nodiscard]] std::optional<int64_t> to_local_ns(int64_t remote_ns) const;
+    [[nodiscard]] std::optional<int64_t> to_remote_ns(int64_t local_ns) const;
+
+    // How much faster the remote clock runs, in parts per million.
+    [[nodiscard]] double drift_ppm() const { return _estimate.load().drift * 1e6; }
+
+    // Standard deviation of the offset estimate.
+    [[nodiscard]] double offset_stddev_ns() const { return _estimate.load().offset_stddev_ns; }
+
+    // Samples accepted before the model counts as synced.
+    static constexpr unsigned MIN_SAMPLES = 3;
+
+    // Consecutive outliers after which the remote clock is assumed to have
+    // jumped, e.g. because it rebooted, and the model starts over.
+    static constexpr unsigned MAX_CONSECUTIVE_OUTLIERS = 5;
+
+private:
+    // remote = local + base_offset_ns + offset_ns + drift * (local - reference_local_ns)
+    struct Estimate {
+        bool synced{false};
+        int64_t base_offset_ns{0};
+        int64_t reference_local_ns{0};
+        double offset_ns{0.0};
+        double drift{0.0};
+        double offset_stddev_ns{0.0};
+    };
+
+    void start_over(int64_t local_ns, int64_t measured_offset_ns, double variance);
+    void publish();
+    [[nodiscard]] bool is_round_trip_too_slow(int64_t rtt_ns) const;
+
+    static constexpr std::size_t RTT_WINDOW = 16;
+    // A round trip may take this much longer than the fastest recent one.
+    static constexpr double MAX_RTT_FACTOR = 2.0;
+    static constexpr int64_t RTT_SLACK_NS = 1000000;
+    // Samples further off than this many standard deviations are outliers.
+    static constexpr double OUTLIER_SIGMAS = 4.0;
+    // How fast offset and drift are allowed to wander, per nanosecond.
+    static constexpr double OFFSET_NOISE_NS2_PER_NS = 1e-3;
+    static constexpr double DRIFT_NOISE_PER_NS = 1e-23;
+    static constexpr double INITIAL_DRIFT_VARIANCE = 1e-8;
+    // The one way delay is known to be within the round trip, but not better
+    // than the timestamps.
+    static constexpr double MIN_MEASUREMENT_VARIANCE_NS2 = 1e6;
+
+    mutable std::mutex _mutex{};
+    bool _initialized{false};
+    unsigned _num_samples{0};
+    unsigned _consecutive_outliers{0};
+    int64_t _base_offset_ns{0};
+    int64_t _last_local_ns{0};
+    // State relative to _base_offset_ns, and its covariance.
+    double _offset_ns{0.0};
+    double _drift{0.0};
+    double _p00{0.0};
+    double _p01{0.0};
+    double _p11{0.0};
+
+    std::array<int64_t, RTT_WINDOW> _rtts_ns{};
+    std::size_t _num_rtts{0};
+    std::size_t _next_rtt{0};
+
+    Seqlock<Estimate> _estimate{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,150 @@
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <gtest/gtest.h>
+#include "clock_model.h"
+
+using namespace mavsdk;
+
+namespace {
+
+constexpr int64_t ms = 1000000;
+constexpr int64_t s = 1000 * ms;
+
+// A remote clock which started later and runs slightly faster.
+struct RemoteClock {
+    int64_t offset_ns{-42 * s};
+    double drift{20e-6};
+
+    int64_t at(int64_t local_ns) const
+    {
+        return local_ns + offset_ns + std::llround(drift * static_cast<double>(local_ns));
+    }
+};
+
+// Sends a TIMESYNC at local_ns which is answered after a random forward and
+// return delay.
+bool add_round_trip(
+    ClockModel& model,
+    const RemoteClock& remote,
+    int64_t local_ns,
+    int64_t forward_ns,
+    int64_t back_ns)
+{
+    return model.add_sample(
+        local_ns, remote.at(local_ns + forward_ns), local_ns + forward_ns + back_ns);
+}
+
+} // namespace
+
+TEST(ClockModel, NotSyncedWithoutSamples)
+{
+    ClockModel model;
+    EXPECT_FALSE(model.is_synced());
+    EXPECT_FALSE(model.to_local_ns(123).has_value());
+    EXPECT_FALSE(model.to_remote_ns(123).has_value());
+}
+
+TEST(ClockModel, SyncsAfterMinSamples)
+{
+    ClockModel model;
+    RemoteClock remote;
+
+    for (unsigned i = 0; i < ClockModel::MIN_SAMPLES; ++i) {
+        EXPECT_FALSE(model.is_synced());
+        EXPECT_TRUE(add_round_trip(model, remote, 100 * s + i * s, 1 * ms, 1 * ms));
+    }
+    EXPECT_TRUE(model.is_synced());
+}
+
+TEST(ClockModel, ConvergesWithJitter)
+{
+    ClockModel model;
+    RemoteClock remote;
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<int64_t> delay_ns(1 * ms, 3 * ms);
+
+    int64_t local_ns = 100 * s;
+    for (int i = 0; i < 300; ++i) {
+        add_round_trip(model, remote, local_ns, delay_ns(generator), delay_ns(generator));
+        local_ns += s;
+    }
+
+    ASSERT_TRUE(model.is_synced());
+    EXPECT_NEAR(model.drift_ppm(), 20.0, 1.0);
+
+    const auto remote_ns = model.to_remote_ns(local_ns);
+    ASSERT_TRUE(remote_ns.has_value());
+    EXPECT_NEAR(static_cast<double>(remote_ns.value() - remote.at(local_ns)), 0.0, 0.5 * ms);
+
+    const auto local_again_ns = model.to_local_ns(remote.at(local_ns));
+    ASSERT_TRUE(local_again_ns.has_value());
+    EXPECT_NEAR(static_cast<double>(local_again_ns.value() - local_ns), 0.0, 0.5 * ms);
+
+    EXPECT_LT(model.offset_stddev_ns(), 0.5 * ms);
+}
+
+TEST(ClockModel, DropsSlowRoundTrips)
+{
+    ClockModel model;
+    RemoteClock remote;
+
+    int64_t local_ns = 100 * s;
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(add_round_trip(model, remote, local_ns, 1 * ms, 1 * ms));
+        local_ns += s;
+    }
+
+    // Stuck in a queue on the way back, which would skew the offset by 50 ms.
+    EXPECT_FALSE(add_round_trip(model, remote, local_ns, 1 * ms, 100 * ms));
+
+    const auto remote_ns = model.to_remote_ns(local_ns);
+    ASSERT_TRUE(remote_ns.has_value());
+    EXPECT_NEAR(static_cast<double>(remote_ns.value() - remote.at(local_ns)), 0.0, 1.0 * ms);
+}
+
+TEST(ClockModel, StartsOverAfterClockJump)
+{
+    ClockModel model;
+    RemoteClock remote;
+
+    int64_t local_ns = 100 * s;
+    for (int i = 0; i < 10; ++i) {
+        add_round_trip(model, remote, local_ns, 1 * ms, 1 * ms);
+        local_ns += s;
+    }
+
+    // The remote system rebooted.
+    remote.offset_ns = -local_ns;
+    for (unsigned i = 0; i < ClockModel::MAX_CONSECUTIVE_OUTLIERS; ++i) {
+        EXPECT_FALSE(add_round_trip(model, remote, local_ns, 1 * ms, 1 * ms));
+        local_ns += s;
+    }
+    EXPECT_TRUE(add_round_trip(model, remote, local_ns, 1 * ms, 1 * ms));
+    EXPECT_FALSE(model.is_synced());
+
+    for (unsigned i = 1; i < ClockModel::MIN_SAMPLES; ++i) {
+        local_ns += s;
+        EXPECT_TRUE(add_round_trip(model, remote, local_ns, 1 * ms, 1 * ms));
+    }
+    ASSERT_TRUE(model.is_synced());
+
+    const auto remote_ns = model.to_remote_ns(local_ns);
+    ASSERT_TRUE(remote_ns.has_value());
+    EXPECT_NEAR(static_cast<double>(remote_ns.value() - remote.at(local_ns)), 0.0, 1.0 * ms);
+}
+
+TEST(ClockModel, Reset)
+{
+    ClockModel model;
+    RemoteClock remote;
+
+    for (unsigned i = 0; i < ClockModel::MIN_SAMPLES; ++i) {
+        add_round_trip(model, remote, 100 * s + i * s, 1 * ms, 1 * ms);
+    }
+    ASSERT_TRUE(model.is_synced());
+
+    model.reset();
+    EXPECT_FALSE(model.is_synced());
+    EXPECT_FALSE(model.to_local_ns(123).has_value());
+}
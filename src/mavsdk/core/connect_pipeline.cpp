@@ -0,0 +1,213 @@
+#include "connect_pipeline.h"
+#include "log.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace mavsdk {
+
+ConnectPipeline::ConnectPipeline(
+    Time& time, TimeoutHandler& timeout_handler, std::size_t max_in_flight) :
+    _time(time),
+    _timeout_handler(timeout_handler),
+    _max_in_flight(max_in_flight)
+{}
+
+ConnectPipeline::~ConnectPipeline()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& step : _steps) {
+        _timeout_handler.remove(step.timeout_cookie);
+    }
+}
+
+void ConnectPipeline::add_step(std::string name, Start start, const void* cookie, double timeout_s)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    Step step;
+    step.id = _next_id++;
+    step.timing.name = name;
+    step.name = std::move(name);
+    step.start = std::move(start);
+    step.cookie = cookie;
+    step.timeout_s = timeout_s;
+    _steps.push_back(std::move(step));
+
+    if (!_running) {
+        return;
+    }
+
+    _ready = false;
+    run(launch_locked(), lock);
+}
+
+void ConnectPipeline::remove_steps(const void* cookie)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (auto it = _steps.begin(); it != _steps.end(); /* ++it */) {
+        if (it->cookie == cookie) {
+            _timeout_handler.remove(it->timeout_cookie);
+            it = _steps.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Might have been the last one we were waiting for.
+    run(launch_locked(), lock);
+}
+
+void ConnectPipeline::set_ready_callback(ReadyCallback callback)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _ready_callback = std::move(callback);
+}
+
+void ConnectPipeline::start()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    ++_generation;
+    _running = true;
+    _ready = false;
+    _connected = _time.steady_time();
+
+    for (auto& step : _steps) {
+        _timeout_handler.remove(step.timeout_cookie);
+        step.timeout_cookie = nullptr;
+        step.state = State::Waiting;
+        step.timing = System::StartupStep{};
+        step.timing.name = step.name;
+    }
+
+    run(launch_locked(), lock);
+}
+
+void ConnectPipeline::stop()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    ++_generation;
+    _running = false;
+
+    for (auto& step : _steps) {
+        _timeout_handler.remove(step.timeout_cookie);
+        step.timeout_cookie = nullptr;
+        step.state = State::Waiting;
+    }
+}
+
+std::vector<ConnectPipeline::Launch> ConnectPipeline::launch_locked()
+{
+    std::vector<Launch> launches;
+    if (!_running) {
+        return launches;
+    }
+
+    auto in_flight =
+        static_cast<std::size_t>(std::count_if(_steps.begin(), _steps.end(), [](const Step& step) {
+            return step.state == State::InFlight;
+        }));
+
+    for (auto& step : _steps) {
+        if (in_flight >= _max_in_flight) {
+            break;
+        }
+        if (step.state != State::Waiting) {
+            continue;
+        }
+
+        step.state = State::InFlight;
+        step.started = _time.steady_time();
+        step.timing.queued_s = _time.elapsed_since_s(_connected);
+        ++in_flight;
+
+        const auto id = step.id;
+        const auto generation = _generation;
+        _timeout_handler.add(
+            [this, id, generation]() { finish(id, generation, false, true); },
+            step.timeout_s,
+            &step.timeout_cookie);
+
+        launches.push_back(Launch{step.start, [this, id, generation](bool success) {
+                                      finish(id, generation, success, false);
+                                  }});
+    }
+
+    return launches;
+}
+
+bool ConnectPipeline::take_ready_locked(System::Ready& ready)
+{
+    if (!_running || _ready) {
+        return false;
+    }
+
+    const bool pending = std::any_of(
+        _steps.begin(), _steps.end(), [](const Step& step) { return step.state != State::Done; });
+    if (pending) {
+        return false;
+    }
+
+    _ready = true;
+    ready.time_to_ready_s = _time.elapsed_since_s(_connected);
+    ready.steps.clear();
+    for (const auto& step : _steps) {
+        ready.steps.push_back(step.timing);
+    }
+    return true;
+}
+
+void ConnectPipeline::finish(uint64_t id, uint64_t generation, bool success, bool timed_out)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (!_running || generation != _generation) {
+        return;
+    }
+
+    auto it = std::find_if(
+        _steps.begin(), _steps.end(), [id](const Step& step) { return step.id == id; });
+    if (it == _steps.end() || it->state != State::InFlight) {
+        return;
+    }
+
+    it->state = State::Done;
+    it->timing.duration_s = _time.elapsed_since_s(it->started);
+    it->timing.success = success;
+
+    if (timed_out) {
+        // The handler is done with it already.
+        it->timeout_cookie = nullptr;
+        LogWarn() << "No answer to connect step '" << it->name << "' in time";
+    } else {
+        _timeout_handler.remove(it->timeout_cookie);
+        it->timeout_cookie = nullptr;
+    }
+
+    run(launch_locked(), lock);
+}
+
+void ConnectPipeline::run(std::vector<Launch> launches, std::unique_lock<std::mutex>& lock)
+{
+    System::Ready ready;
+    const bool is_ready = take_ready_locked(ready);
+    const auto callback = _ready_callback;
+    lock.unlock();
+
+    for (auto& launch : launches) {
+        if (launch.start) {
+            launch.start(std::move(launch.done));
+        } else {
+            launch.done(true);
+        }
+    }
+
+    if (is_ready && callback) {
+        callback(ready);
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "mavsdk_time.h"
+#include "system.h"
+#include "timeout_handler.h"
+
+namespace mavsdk {
+
+// Makes the requests the core and the plugins need once a system is
+// connected, and tells when all of them are done.
+//
+// Steps are known up front, plugins add theirs in init(). On connect they are
+// all started, at most max_in_flight at once so a slow link isn't flooded,
+// and each one that doesn't finish within its timeout counts as failed. Once
+// no step is left the ready callback is called with the timing of each.
+// Steps added while connected are started right away, and ready is reported
+// again once they are done.
+class ConnectPipeline {
+public:
+    using Done = std::function<void(bool success)>;
+    // Starts the request and calls done, from any thread, once it is answered.
+    using Start = std::function<void(Done done)>;
+    using ReadyCallback = std::function<void(const System::Ready&)>;
+
+    ConnectPipeline(Time& time, TimeoutHandler& timeout_handler, std::size_t max_in_flight);
+    ~ConnectPipeline();
+
+    void add_step(std::string name, Start start, const void* cookie, double timeout_s = 3.0);
+    void remove_steps(const void* cookie);
+
+    // Called without any lock held.
+    void set_ready_callback(ReadyCallback callback);
+
+    void start();
+    void stop();
+
+    // Non-copyable
+    ConnectPipeline(const ConnectPipeline&) = delete;
+    const ConnectPipeline& operator=(const ConnectPipeline&) = delete;
+
+private:
+    enum class State { Waiting, InFlight, Done };
+
+    struct Step {
+        uint64_t id{0};
+        std::string name{};
+        Start start{};
+        const void* cookie{nullptr};
+        double timeout_s{0.0};
+
+        State state{State::Waiting};
+        dl_time_t started{};
+        void* timeout_cookie{nullptr};
+        System::StartupStep timing{};
+    };
+
+    struct Launch {
+        Start start;
+        Done done;
+    };
+
+    // These need _mutex to be held.
+    std::vector<Launch> launch_locked();
+    bool take_ready_locked(System::Ready& ready);
+
+    void finish(uint64_t id, uint64_t generation, bool success, bool timed_out);
+    void run(std::vector<Launch> launches, std::unique_lock<std::mutex>& lock);
+
+    Time& _time;
+    TimeoutHandler& _timeout_handler;
+    const std::size_t _max_in_flight;
+
+    std::mutex _mutex{};
+    std::vector<Step> _steps{};
+    uint64_t _next_id{1};
+
+    // Answers of a previous connection are ignored.
+    uint64_t _generation{0};
+    bool _running{false};
+    bool _ready{false};
+    dl_time_t _connected{};
+
+    ReadyCallback _ready_callback{nullptr};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,211 @@
+#include "connect_pipeline.h"
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <optional>
+
+#ifdef FAKE_TIME
+#define Time FakeTime
+#endif
+
+using namespace mavsdk;
+
+namespace {
+const void* cookie = reinterpret_cast<const void*>(0x1);
+}
+
+TEST(ConnectPipeline, ReadyWithoutSteps)
+{
+    Time time;
+    TimeoutHandler th(time);
+    ConnectPipeline pipeline(time, th, 4);
+
+    unsigned num_ready = 0;
+    pipeline.set_ready_callback([&](const System::Ready& ready) {
+        ++num_ready;
+        EXPECT_TRUE(ready.steps.empty());
+    });
+
+    pipeline.start();
+    EXPECT_EQ(num_ready, 1);
+}
+
+TEST(ConnectPipeline, KeepsToInFlightBudget)
+{
+    Time time;
+    TimeoutHandler th(time);
+    ConnectPipeline pipeline(time, th, 2);
+
+    std::vector<ConnectPipeline::Done> in_flight;
+    for (unsigned i = 0; i < 5; ++i) {
+        pipeline.add_step(
+            "step " + std::to_string(i),
+            [&](ConnectPipeline::Done done) { in_flight.push_back(std::move(done)); },
+            cookie);
+    }
+
+    std::optional<System::Ready> ready;
+    pipeline.set_ready_callback([&](const System::Ready& new_ready) { ready = new_ready; });
+
+    // Nothing is started before connecting.
+    EXPECT_TRUE(in_flight.empty());
+
+    pipeline.start();
+    EXPECT_EQ(in_flight.size(), 2);
+
+    // Each answer frees a slot for the next one.
+    for (unsigned i = 0; i < 3; ++i) {
+        auto done = std::move(in_flight.front());
+        in_flight.erase(in_flight.begin());
+        done(true);
+        EXPECT_EQ(in_flight.size(), 2);
+        EXPECT_FALSE(ready);
+    }
+
+    in_flight[0](true);
+    EXPECT_FALSE(ready);
+    in_flight[1](false);
+    ASSERT_TRUE(ready);
+
+    ASSERT_EQ(ready->steps.size(), 5);
+    EXPECT_EQ(ready->steps[0].name, "step 0");
+    EXPECT_TRUE(ready->steps[3].success);
+    EXPECT_FALSE(ready->steps[4].success);
+}
+
+TEST(ConnectPipeline, ReportsTimings)
+{
+    Time time;
+    TimeoutHandler th(time);
+    ConnectPipeline pipeline(time, th, 1);
+
+    std::vector<ConnectPipeline::Done> in_flight;
+    pipeline.add_step(
+        "first", [&](ConnectPipeline::Done done) { in_flight.push_back(std::move(done)); }, cookie);
+    pipeline.add_step(
+        "second",
+        [&](ConnectPipeline::Done done) { in_flight.push_back(std::move(done)); },
+        cookie);
+
+    std::optional<System::Ready> ready;
+    pipeline.set_ready_callback([&](const System::Ready& new_ready) { ready = new_ready; });
+
+    pipeline.start();
+    time.sleep_for(std::chrono::milliseconds(200));
+    in_flight[0](true);
+    time.sleep_for(std::chrono::milliseconds(100));
+    in_flight[1](true);
+
+    ASSERT_TRUE(ready);
+    ASSERT_EQ(ready->steps.size(), 2);
+    EXPECT_NEAR(ready->steps[0].queued_s, 0.0, 0.05);
+    EXPECT_NEAR(ready->steps[0].duration_s, 0.2, 0.05);
+    EXPECT_NEAR(ready->steps[1].queued_s, 0.2, 0.05);
+    EXPECT_NEAR(ready->steps[1].duration_s, 0.1, 0.05);
+    EXPECT_NEAR(ready->time_to_ready_s, 0.3, 0.05);
+}
+
+TEST(ConnectPipeline, TimeoutCountsAsFailure)
+{
+    Time time;
+    TimeoutHandler th(time);
+    ConnectPipeline pipeline(time, th, 4);
+
+    ConnectPipeline::Done late_done;
+    pipeline.add_step(
+        "silent", [&](ConnectPipeline::Done done) { late_done = std::move(done); }, cookie, 0.5);
+
+    std::optional<System::Ready> ready;
+    unsigned num_ready = 0;
+    pipeline.set_ready_callback([&](const System::Ready& new_ready) {
+        ready = new_ready;
+        ++num_ready;
+    });
+
+    pipeline.start();
+    time.sleep_for(std::chrono::milliseconds(250));
+    th.run_once();
+    EXPECT_FALSE(ready);
+
+    time.sleep_for(std::chrono::milliseconds(500));
+    th.run_once();
+    ASSERT_TRUE(ready);
+    ASSERT_EQ(ready->steps.size(), 1);
+    EXPECT_FALSE(ready->steps[0].success);
+
+    // An answer coming after all doesn't change anything.
+    late_done(true);
+    EXPECT_EQ(num_ready, 1);
+}
+
+TEST(ConnectPipeline, IgnoresAnswersFromBeforeReconnect)
+{
+    Time time;
+    TimeoutHandler th(time);
+    ConnectPipeline pipeline(time, th, 4);
+
+    std::vector<ConnectPipeline::Done> in_flight;
+    pipeline.add_step(
+        "step", [&](ConnectPipeline::Done done) { in_flight.push_back(std::move(done)); }, cookie);
+
+    unsigned num_ready = 0;
+    pipeline.set_ready_callback([&](const System::Ready&) { ++num_ready; });
+
+    pipeline.start();
+    pipeline.stop();
+    in_flight[0](true);
+    EXPECT_EQ(num_ready, 0);
+
+    pipeline.start();
+    ASSERT_EQ(in_flight.size(), 2);
+    in_flight[0](true);
+    EXPECT_EQ(num_ready, 0);
+    in_flight[1](true);
+    EXPECT_EQ(num_ready, 1);
+}
+
+TEST(ConnectPipeline, ReportsAgainForStepAddedLater)
+{
+    Time time;
+    TimeoutHandler th(time);
+    ConnectPipeline pipeline(time, th, 4);
+
+    unsigned num_ready = 0;
+    std::size_t num_steps = 0;
+    pipeline.set_ready_callback([&](const System::Ready& ready) {
+        ++num_ready;
+        num_steps = ready.steps.size();
+    });
+
+    pipeline.add_step("first", [](ConnectPipeline::Done done) { done(true); }, cookie);
+    pipeline.start();
+    EXPECT_EQ(num_ready, 1);
+    EXPECT_EQ(num_steps, 1);
+
+    ConnectPipeline::Done pending;
+    int other_cookie = 0;
+    pipeline.add_step(
+        "later", [&](ConnectPipeline::Done done) { pending = std::move(done); }, &other_cookie);
+    EXPECT_EQ(num_ready, 1);
+
+    pending(true);
+    EXPECT_EQ(num_ready, 2);
+    EXPECT_EQ(num_steps, 2);
+}
+
+TEST(ConnectPipeline, RemovingLastPendingStepMakesReady)
+{
+    Time time;
+    TimeoutHandler th(time);
+    ConnectPipeline pipeline(time, th, 4);
+
+    unsigned num_ready = 0;
+    pipeline.set_ready_callback([&](const System::Ready&) { ++num_ready; });
+
+    pipeline.add_step("never", [](ConnectPipeline::Done) {}, cookie);
+    pipeline.start();
+    EXPECT_EQ(num_ready, 0);
+
+    pipeline.remove_steps(cookie);
+    EXPECT_EQ(num_ready, 1);
+}
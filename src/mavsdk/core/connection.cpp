@@ -2,21 +2,25 @@
 
 #include <memory>
 #include <utility>
+#include "allocation_tracker.h"
 #include "mavsdk_impl.h"
-#include "mavlink_channels.h"
+#include "message_latency.h"
 
 namespace mavsdk {
 
 std::atomic<unsigned> Connection::_forwarding_connections_count = 0;
 
+MavlinkFrame::MavlinkFrame(const mavlink_message_t& message) :
+    length(mavlink_msg_to_send_buffer(buffer, &message)),
+    target_system_id(MavsdkImpl::get_target_system_id(message)),
+    message_id(message.msgid)
+{}
+
 Connection::Connection(receiver_callback_t receiver_callback, ForwardingOption forwarding_option) :
     _receiver_callback(std::move(receiver_callback)),
     _mavlink_receiver(),
     _forwarding_option(forwarding_option)
 {
-    // Insert system ID 0 in all connections for broadcast.
-    _system_ids.insert(0);
-
     if (forwarding_option == ForwardingOption::ForwardingOn) {
         _forwarding_connections_count++;
     }
@@ -31,32 +35,189 @@ Connection::~Connection()
 
 bool Connection::start_mavlink_receiver()
 {
-    uint8_t channel;
-    if (!MAVLinkChannels::Instance().checkout_free_channel(channel)) {
-        return false;
-    }
-
-    _mavlink_receiver = std::make_unique<MAVLinkReceiver>(channel);
+    _mavlink_receiver = std::make_unique<MAVLinkReceiver>(&_link_stats);
     return true;
 }
 
 void Connection::stop_mavlink_receiver()
 {
-    if (_mavlink_receiver) {
-        uint8_t used_channel = _mavlink_receiver->get_channel();
-        // Destroy receiver before giving the channel back.
-        _mavlink_receiver.reset();
-        MAVLinkChannels::Instance().checkin_used_channel(used_channel);
+    _mavlink_receiver.reset();
+}
+
+void Connection::start_send_queue(SendQueue::WriteFunction write_function)
+{
+    if (_send_queue_bytes == 0) {
+        return;
     }
+    _send_queue = std::make_unique<SendQueue>(
+        std::move(write_function), _send_queue_bytes, _congestion_callback, _thread_setup);
+}
+
+void Connection::stop_send_queue()
+{
+    _send_queue.reset();
+}
+
+void Connection::set_link_emulation(const LinkEmulator::Config& config)
+{
+    if (!config.active()) {
+        _link_emulator.reset();
+        return;
+    }
+    _link_emulator = std::make_unique<LinkEmulator>(
+        config, ThreadSetup{_thread_setup.name + "-emu", _thread_setup.settings});
+}
+
+void Connection::stop_link_emulation()
+{
+    if (_link_emulator) {
+        _link_emulator->stop();
+    }
+}
+
+bool Connection::send_congested() const
+{
+    return _send_queue && _send_queue->congested();
+}
+
+std::size_t Connection::send_queued_bytes() const
+{
+    return _send_queue ? _send_queue->queued_bytes() : 0;
+}
+
+uint64_t Connection::send_would_block_count() const
+{
+    return _send_queue ? _send_queue->would_block_count() : 0;
 }
 
 void Connection::receive_message(mavlink_message_t& message, Connection* connection)
 {
-    // Register system ID when receiving a message from a new system.
-    if (_system_ids.find(message.sysid) == _system_ids.end()) {
-        _system_ids.insert(message.sysid);
+    receive_message(
+        message,
+        connection,
+        _mavlink_receiver ? _mavlink_receiver->datagram_time_ns() : MessageLatency::now_ns());
+}
+
+void Connection::receive_message(
+    mavlink_message_t& message, Connection* connection, uint64_t receive_time_ns)
+{
+    MAVSDK_ALLOCATION_REGION(Receive);
+
+    if (_link_emulator) {
+        _link_emulator->transmit(
+            LinkEmulator::Direction::Incoming,
+            MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len,
+            [this, message, connection]() mutable {
+                // The latency measured is MAVSDK's own, not the link's.
+                dispatch_message(message, connection, MessageLatency::now_ns());
+            });
+        return;
+    }
+
+    dispatch_message(message, connection, receive_time_ns);
+}
+
+void Connection::dispatch_message(
+    mavlink_message_t& message, Connection* connection, uint64_t receive_time_ns)
+{
+    // Everything done for this message from here on can be traced back to
+    // when it was received.
+    const MessageLatency::DispatchScope dispatch_scope{message.msgid, receive_time_ns};
+
+    if (_capture) {
+        // The bytes as received are gone, serializing gives them back.
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const auto length = mavlink_msg_to_send_buffer(buffer, &message);
+        _capture->write(buffer, length, TlogWriter::now_us());
     }
+
     _receiver_callback(message, connection);
+
+    const uint64_t done_time_ns = MessageLatency::now_ns();
+    std::lock_guard<std::mutex> lock(_read_to_dispatch_mutex);
+    _read_to_dispatch.record(done_time_ns > receive_time_ns ? done_time_ns - receive_time_ns : 0);
+}
+
+Mavsdk::LatencyStats Connection::read_to_dispatch_stats() const
+{
+    std::lock_guard<std::mutex> lock(_read_to_dispatch_mutex);
+    return _read_to_dispatch.stats();
+}
+
+bool Connection::send_message(const mavlink_message_t& message)
+{
+    return send(MavlinkFrame(message));
+}
+
+bool Connection::send(const MavlinkFrame& frame)
+{
+    if (_link_emulator) {
+        emulate_send(frame, true);
+        return true;
+    }
+
+    if (!send_frame(frame)) {
+        return false;
+    }
+
+    if (_capture) {
+        _capture->write(frame.buffer, frame.length, TlogWriter::now_us());
+    }
+    return true;
+}
+
+bool Connection::forward(const MavlinkFrame& frame)
+{
+    if (_link_emulator) {
+        emulate_send(frame, false);
+        return true;
+    }
+
+    return send_frame(frame);
+}
+
+void Connection::emulate_send(const MavlinkFrame& frame, bool capture)
+{
+    // Like on a real link, the sender can't tell whether it arrived.
+    _link_emulator->transmit(
+        LinkEmulator::Direction::Outgoing, frame.length, [this, frame, capture]() {
+            if (send_frame(frame) && capture && _capture) {
+                _capture->write(frame.buffer, frame.length, TlogWriter::now_us());
+            }
+        });
+}
+
+bool Connection::send(const std::vector<const MavlinkFrame*>& frames)
+{
+    if (_link_emulator) {
+        for (const auto* frame : frames) {
+            emulate_send(*frame, true);
+        }
+        return true;
+    }
+
+    if (!send_frames(frames)) {
+        return false;
+    }
+
+    if (_capture) {
+        const auto now_us = TlogWriter::now_us();
+        for (const auto* frame : frames) {
+            _capture->write(frame->buffer, frame->length, now_us);
+        }
+    }
+    return true;
+}
+
+bool Connection::send_frames(const std::vector<const MavlinkFrame*>& frames)
+{
+    bool send_successful = true;
+    for (const auto* frame : frames) {
+        if (!send_frame(*frame)) {
+            send_successful = false;
+        }
+    }
+    return send_successful;
 }
 
 bool Connection::should_forward_messages() const
@@ -69,9 +230,4 @@ unsigned Connection::forwarding_connections_count()
     return _forwarding_connections_count;
 }
 
-bool Connection::has_system_id(uint8_t system_id)
-{
-    return _system_ids.find(system_id) != _system_ids.end();
-}
-
 } // namespace mavsdk
@@ -1,12 +1,36 @@
 #pragma once
 
+#include "link_emulator.h"
+#include "link_stats.h"
 #include "mavsdk.h"
 #include "mavlink_receiver.h"
+#include "mavlink_signing.h"
+#include "message_latency.h"
+#include "native_thread.h"
+#include "route_table.h"
+#include "send_queue.h"
+#include "thread_setup.h"
+#include "tlog.h"
 #include <memory>
-#include <unordered_set>
+#include <mutex>
+#include <vector>
 
 namespace mavsdk {
 
+// A message serialized once, so it can be sent over all connections (and to
+// all remotes of a connection) without serializing it again for each of them.
+struct MavlinkFrame {
+    explicit MavlinkFrame(const mavlink_message_t& message);
+
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    uint16_t length{0};
+
+    // 0 if the message is not targeted at one system, so it goes to every remote.
+    uint8_t target_system_id{0};
+
+    uint32_t message_id{0};
+};
+
 class Connection {
 public:
     typedef std::function<void(mavlink_message_t& message, Connection* connection)>
@@ -20,12 +44,73 @@ public:
     virtual ConnectionResult start() = 0;
     virtual ConnectionResult stop() = 0;
 
-    virtual bool send_message(const mavlink_message_t& message) = 0;
+    bool send_message(const mavlink_message_t& message);
+    virtual bool send_frame(const MavlinkFrame& frame) = 0;
+
+    // Sends several frames at once. Connections which can hand them to the
+    // OS in one go override this, the default sends them one by one.
+    virtual bool send_frames(const std::vector<const MavlinkFrame*>& frames);
+
+    // Like send_frame() and send_frames(), but what was sent is captured.
+    bool send(const MavlinkFrame& frame);
+    bool send(const std::vector<const MavlinkFrame*>& frames);
+
+    // Like send(), for messages forwarded from another connection, which
+    // were captured already when they were received.
+    bool forward(const MavlinkFrame& frame);
+
+    // Writes everything received, and everything sent with send(), to the
+    // tlog. Needs to be set before start().
+    void set_capture(std::shared_ptr<TlogWriter> capture) { _capture = std::move(capture); }
+
+    // Applied by the threads the connection starts of its own, if any. Needs
+    // to be set before start().
+    void set_thread_setup(ThreadSetup thread_setup) { _thread_setup = std::move(thread_setup); }
+
+    // Impairs both directions like a bad link would, see LinkEmulator. What
+    // is sent is captured when it leaves, and what is received when it
+    // arrives. Needs to be set before start().
+    void set_link_emulation(const LinkEmulator::Config& config);
+
+    // Sends are queued up to this many bytes and written by a thread of their
+    // own instead of blocking the caller, see SendQueue. Only connections
+    // which can block use it. Both need to be set before start().
+    void set_send_queue_bytes(std::size_t bytes) { _send_queue_bytes = bytes; }
+    void set_congestion_callback(SendQueue::CongestionCallback callback)
+    {
+        _congestion_callback = std::move(callback);
+    }
+
+    // Whether the send queue is congested, always false without one.
+    [[nodiscard]] bool send_congested() const;
+
+    // Without a send queue, both are 0.
+    [[nodiscard]] std::size_t send_queued_bytes() const;
+    [[nodiscard]] uint64_t send_would_block_count() const;
+
+    // Index of the connection in the RouteTable, -1 if there are too many connections.
+    void set_route_index(int route_index) { _route_index = route_index; }
+    int route_index() const { return _route_index; }
+
+    // Whether the connection leads to any of the given routes. A connection
+    // without route index is never excluded.
+    bool is_on_routes(uint64_t routes) const
+    {
+        const uint64_t bit = RouteTable::route_bit(_route_index);
+        return bit == 0 || (routes & bit) != 0;
+    }
 
-    bool has_system_id(uint8_t system_id);
     bool should_forward_messages() const;
     static unsigned forwarding_connections_count();
 
+    LinkStats& link_stats() { return _link_stats; }
+
+    // From reading a message off the connection until MAVSDK took it over.
+    [[nodiscard]] Mavsdk::LatencyStats read_to_dispatch_stats() const;
+
+    // Replay protection of signed messages received over this connection.
+    MavlinkSigning::Streams& signing_streams() { return _signing_streams; }
+
     // Non-copyable
     Connection(const Connection&) = delete;
     const Connection& operator=(const Connection&) = delete;
@@ -33,16 +118,48 @@ public:
 protected:
     bool start_mavlink_receiver();
     void stop_mavlink_receiver();
+    // Does nothing unless a send queue size was set.
+    void start_send_queue(SendQueue::WriteFunction write_function);
+    // Writes what is still queued.
+    void stop_send_queue();
+    // Drops what is still on the way, needs to be called first thing on stop().
+    void stop_link_emulation();
     void receive_message(mavlink_message_t& message, Connection* connection);
+    // For connections with a receiver of their own per remote.
+    void receive_message(
+        mavlink_message_t& message, Connection* connection, uint64_t receive_time_ns);
 
     receiver_callback_t _receiver_callback{};
     std::unique_ptr<MAVLinkReceiver> _mavlink_receiver;
     ForwardingOption _forwarding_option;
-    std::unordered_set<uint8_t> _system_ids;
+    std::atomic<int> _route_index{-1};
+
+    // Outlives the receiver, which is recreated whenever the connection restarts.
+    LinkStats _link_stats{};
+
+    MavlinkSigning::Streams _signing_streams{};
+
+    std::size_t _send_queue_bytes{0};
+    SendQueue::CongestionCallback _congestion_callback{};
+    std::unique_ptr<SendQueue> _send_queue{};
+
+    mutable std::mutex _read_to_dispatch_mutex{};
+    LatencyHistogram _read_to_dispatch{};
+
+    std::shared_ptr<TlogWriter> _capture{};
+
+    ThreadSetup _thread_setup{};
+
+    std::unique_ptr<LinkEmulator> _link_emulator{};
 
     static std::atomic<unsigned> _forwarding_connections_count;
 
     // void received_mavlink_message(mavlink_message_t &);
+
+private:
+    void dispatch_message(
+        mavlink_message_t& message, Connection* connection, uint64_t receive_time_ns);
+    void emulate_send(const MavlinkFrame& frame, bool capture);
 };
 
 } // namespace mavsdk
@@ -45,9 +45,16 @@
 
 #include "crc32.h"
 
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#else
+#include <array>
+#include <cstddef>
+#endif
+
 namespace mavsdk {
 
-static const uint32_t crc32_tab[] = {
+static constexpr uint32_t crc32_tab[] = {
     0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f, 0xe963a535, 0x9e6495a3,
     0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988, 0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91,
     0x1db71064, 0x6ab020f2, 0xf3b97148, 0x84be41de, 0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7,
@@ -81,7 +88,54 @@ static const uint32_t crc32_tab[] = {
     0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6, 0xbad03605, 0xcdd70693, 0x54de5729, 0x23d967bf,
     0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d};
 
-uint32_t Crc32::add(const uint8_t* src, uint32_t len)
+static inline uint32_t load_le32(const uint8_t* src)
+{
+    // Compiles to a single load on little endian machines.
+    return static_cast<uint32_t>(src[0]) | (static_cast<uint32_t>(src[1]) << 8) |
+           (static_cast<uint32_t>(src[2]) << 16) | (static_cast<uint32_t>(src[3]) << 24);
+}
+
+#if defined(__ARM_FEATURE_CRC32)
+
+// The CRC32 instructions of ARMv8 use the same polynomial and, like us, don't
+// invert the value before or after, so they are a drop-in replacement.
+static uint32_t add_arm(uint32_t val, const uint8_t* src, uint32_t len)
+{
+    for (; len >= 8; src += 8, len -= 8) {
+        const uint64_t word = static_cast<uint64_t>(load_le32(src)) |
+                              (static_cast<uint64_t>(load_le32(src + 4)) << 32);
+        val = __crc32d(val, word);
+    }
+    for (; len > 0; ++src, --len) {
+        val = __crc32b(val, *src);
+    }
+    return val;
+}
+
+#else
+
+// For slicing-by-8, table k advances the CRC of a byte by k more zero bytes,
+// so that 8 bytes can be looked up independently and combined.
+using SliceTables = std::array<std::array<uint32_t, 256>, 8>;
+
+static constexpr SliceTables make_slice_tables()
+{
+    SliceTables tables{};
+    for (std::size_t i = 0; i < 256; ++i) {
+        tables[0][i] = crc32_tab[i];
+    }
+    for (std::size_t k = 1; k < tables.size(); ++k) {
+        for (std::size_t i = 0; i < 256; ++i) {
+            const uint32_t previous = tables[k - 1][i];
+            tables[k][i] = (previous >> 8) ^ crc32_tab[previous & 0xff];
+        }
+    }
+    return tables;
+}
+
+static constexpr SliceTables slice_tab = make_slice_tables();
+
+static uint32_t add_bytewise(uint32_t val, const uint8_t* src, uint32_t len)
 {
     for (uint32_t i = 0; i < len; i++) {
         val = crc32_tab[(val ^ src[i]) & 0xff] ^ (val >> 8);
@@ -89,4 +143,29 @@ uint32_t Crc32::add(const uint8_t* src, uint32_t len)
     return val;
 }
 
+static uint32_t add_sliced(uint32_t val, const uint8_t* src, uint32_t len)
+{
+    for (; len >= 8; src += 8, len -= 8) {
+        const uint32_t low = load_le32(src) ^ val;
+        const uint32_t high = load_le32(src + 4);
+        val = slice_tab[7][low & 0xff] ^ slice_tab[6][(low >> 8) & 0xff] ^
+              slice_tab[5][(low >> 16) & 0xff] ^ slice_tab[4][low >> 24] ^
+              slice_tab[3][high & 0xff] ^ slice_tab[2][(high >> 8) & 0xff] ^
+              slice_tab[1][(high >> 16) & 0xff] ^ slice_tab[0][high >> 24];
+    }
+    return add_bytewise(val, src, len);
+}
+
+#endif
+
+uint32_t Crc32::add(const uint8_t* src, uint32_t len)
+{
+#if defined(__ARM_FEATURE_CRC32)
+    val = add_arm(val, src, len);
+#else
+    val = add_sliced(val, src, len);
+#endif
+    return val;
+}
+
 } // namespace mavsdk
\ No newline at end of file
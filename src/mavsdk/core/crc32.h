@@ -9,6 +9,8 @@ namespace mavsdk {
 
 class Crc32 {
 public:
+    // Processes 8 bytes at a time, using the CRC32 instructions on ARMv8 if
+    // the compiler targets them.
     uint32_t add(const uint8_t* src, uint32_t len);
 
     [[nodiscard]] uint32_t get() const { return val; }
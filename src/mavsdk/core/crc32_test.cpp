@@ -0,0 +1,80 @@
+#include "crc32.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+// Plain bitwise version of the same CRC, to check the optimized ones against.
+uint32_t reference_crc32(const uint8_t* src, std::size_t len)
+{
+    uint32_t val = 0;
+    for (std::size_t i = 0; i < len; ++i) {
+        val ^= src[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            val = (val & 1) ? (val >> 1) ^ 0xedb88320 : (val >> 1);
+        }
+    }
+    return val;
+}
+} // namespace
+
+TEST(Crc32, KnownValue)
+{
+    const std::string input = "123456789";
+
+    Crc32 crc;
+    crc.add(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+
+    // Not the usual 0xCBF43926 because MAVLink starts at 0 and doesn't invert at the end.
+    EXPECT_EQ(crc.get(), 0x2dfd2d88);
+}
+
+TEST(Crc32, EmptyInput)
+{
+    Crc32 crc;
+    EXPECT_EQ(crc.add(nullptr, 0), 0);
+}
+
+TEST(Crc32, MatchesReferenceForAllLengthsAndAlignments)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 255);
+    std::vector<uint8_t> data(1024 + 8);
+    for (auto& byte : data) {
+        byte = static_cast<uint8_t>(distribution(generator));
+    }
+
+    for (std::size_t alignment = 0; alignment < 8; ++alignment) {
+        for (std::size_t len = 0; len <= 64; ++len) {
+            Crc32 crc;
+            crc.add(data.data() + alignment, len);
+            EXPECT_EQ(crc.get(), reference_crc32(data.data() + alignment, len))
+                << "alignment " << alignment << ", length " << len;
+        }
+    }
+
+    Crc32 crc;
+    crc.add(data.data(), 1024);
+    EXPECT_EQ(crc.get(), reference_crc32(data.data(), 1024));
+}
+
+TEST(Crc32, IncrementalEqualsWhole)
+{
+    std::vector<uint8_t> data(1000);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+
+    Crc32 whole;
+    whole.add(data.data(), data.size());
+
+    Crc32 pieces;
+    pieces.add(data.data(), 3);
+    pieces.add(data.data() + 3, 500);
+    pieces.add(data.data() + 503, data.size() - 503);
+
+    EXPECT_EQ(pieces.get(), whole.get());
+}
@@ -0,0 +1,198 @@
+#include "curl_multi.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+namespace mavsdk {
+
+CurlMulti::CurlMulti() : _multi(curl_multi_init())
+{
+    if (_multi == nullptr) {
+        LogErr() << "Error: cannot start fetching because of curl initialization error.";
+        return;
+    }
+
+    curl_multi_setopt(_multi, CURLMOPT_MAX_HOST_CONNECTIONS, MAX_HOST_CONNECTIONS);
+    curl_multi_setopt(_multi, CURLMOPT_MAXCONNECTS, MAX_CONNECTIONS);
+
+    _thread = std::thread(&CurlMulti::run, this);
+}
+
+CurlMulti::~CurlMulti()
+{
+    _should_exit = true;
+    if (_thread.joinable()) {
+        curl_multi_wakeup(_multi);
+        _thread.join();
+    }
+
+    // Nobody must wait forever for what was never done.
+    for (auto& [easy, transfer] : _transfers) {
+        curl_multi_remove_handle(_multi, easy);
+        curl_easy_cleanup(easy);
+        curl_slist_free_all(transfer->headers);
+        fail(*transfer, CURLE_ABORTED_BY_CALLBACK);
+    }
+    _transfers.clear();
+
+    for (auto& transfer : _pending) {
+        fail(*transfer, CURLE_ABORTED_BY_CALLBACK);
+    }
+    _pending.clear();
+
+    if (_multi != nullptr) {
+        curl_multi_cleanup(_multi);
+    }
+}
+
+void CurlMulti::fetch_async(HttpRequest request, http_callback_t callback)
+{
+    auto transfer = std::make_unique<Transfer>();
+    transfer->request = std::move(request);
+    transfer->callback = std::move(callback);
+
+    if (_multi == nullptr) {
+        fail(*transfer, CURLE_FAILED_INIT);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_pending_mutex);
+        _pending.push_back(std::move(transfer));
+    }
+    curl_multi_wakeup(_multi);
+}
+
+void CurlMulti::run()
+{
+    while (!_should_exit) {
+        start_pending();
+
+        int running = 0;
+        curl_multi_perform(_multi, &running);
+
+        int queued = 0;
+        while (CURLMsg* message = curl_multi_info_read(_multi, &queued)) {
+            if (message->msg == CURLMSG_DONE) {
+                finish(message->easy_handle, message->data.result);
+            }
+        }
+
+        // Woken up by new requests, otherwise by curl when there is
+        // something to do or at the latest after the timeout.
+        curl_multi_poll(_multi, nullptr, 0, 1000, nullptr);
+    }
+}
+
+void CurlMulti::start_pending()
+{
+    std::vector<std::unique_ptr<Transfer>> pending;
+    {
+        std::lock_guard<std::mutex> lock(_pending_mutex);
+        pending.swap(_pending);
+    }
+
+    for (auto& transfer : pending) {
+        CURL* easy = curl_easy_init();
+        if (easy == nullptr) {
+            LogErr() << "Error: cannot start fetching because of curl initialization error.";
+            fail(*transfer, CURLE_FAILED_INIT);
+            continue;
+        }
+
+        if (!transfer->request.etag.empty()) {
+            const std::string header = "If-None-Match: " + transfer->request.etag;
+            transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+        }
+        if (!transfer->request.last_modified.empty()) {
+            const std::string header = "If-Modified-Since: " + transfer->request.last_modified;
+            transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+        }
+
+        curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT, 5L);
+        curl_easy_setopt(easy, CURLOPT_URL, transfer->request.url.c_str());
+        curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer->headers);
+        curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, write_callback);
+        curl_easy_setopt(easy, CURLOPT_WRITEDATA, transfer.get());
+        curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, header_callback);
+        curl_easy_setopt(easy, CURLOPT_HEADERDATA, transfer.get());
+
+        transfer->easy = easy;
+        curl_multi_add_handle(_multi, easy);
+        _transfers.emplace(easy, std::move(transfer));
+    }
+}
+
+void CurlMulti::finish(CURL* easy, CURLcode result)
+{
+    auto it = _transfers.find(easy);
+    if (it == _transfers.end()) {
+        return;
+    }
+    auto transfer = std::move(it->second);
+    _transfers.erase(it);
+
+    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &transfer->response.status_code);
+    curl_multi_remove_handle(_multi, easy);
+    curl_easy_cleanup(easy);
+    curl_slist_free_all(transfer->headers);
+    transfer->headers = nullptr;
+
+    if (result != CURLE_OK) {
+        LogErr() << "Error while fetching " << transfer->request.url
+                 << ", curl error code: " << curl_easy_strerror(result);
+    }
+
+    transfer->response.curl_code = result;
+    if (transfer->callback) {
+        transfer->callback(std::move(transfer->response));
+    }
+}
+
+void CurlMulti::fail(Transfer& transfer, CURLcode result)
+{
+    HttpResponse response;
+    response.curl_code = result;
+    if (transfer.callback) {
+        transfer.callback(std::move(response));
+    }
+}
+
+size_t CurlMulti::write_callback(char* data, size_t size, size_t nmemb, void* userdata)
+{
+    auto* transfer = reinterpret_cast<Transfer*>(userdata);
+    transfer->response.body.append(data, size * nmemb);
+    return size * nmemb;
+}
+
+size_t CurlMulti::header_callback(char* data, size_t size, size_t nmemb, void* userdata)
+{
+    auto* transfer = reinterpret_cast<Transfer*>(userdata);
+    const std::string line(data, size * nmemb);
+
+    const auto colon = line.find(':');
+    if (colon == std::string::npos) {
+        return size * nmemb;
+    }
+
+    std::string name = line.substr(0, colon);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+
+    const auto begin = line.find_first_not_of(" \t", colon + 1);
+    const auto end = line.find_last_not_of(" \t\r\n");
+    const std::string value =
+        (begin == std::string::npos || end < begin) ? "" : line.substr(begin, end - begin + 1);
+
+    if (name == "etag") {
+        transfer->response.etag = value;
+    } else if (name == "last-modified") {
+        transfer->response.last_modified = value;
+    }
+    return size * nmemb;
+}
+
+} // namespace mavsdk
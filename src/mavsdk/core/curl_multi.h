@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "curl_include.h"
+#include "curl_wrapper_types.h"
+
+namespace mavsdk {
+
+// Runs HTTP requests concurrently on one thread using a curl multi handle.
+//
+// The multi handle keeps finished connections in its cache, so requests to
+// a host already talked to reuse the connection instead of opening a new one.
+// Callbacks are called on the thread of the CurlMulti and should not block.
+class CurlMulti {
+public:
+    CurlMulti();
+    ~CurlMulti();
+
+    void fetch_async(HttpRequest request, http_callback_t callback);
+
+    // Non-copyable
+    CurlMulti(const CurlMulti&) = delete;
+    const CurlMulti& operator=(const CurlMulti&) = delete;
+
+private:
+    struct Transfer {
+        HttpRequest request{};
+        http_callback_t callback{nullptr};
+        HttpResponse response{};
+        CURL* easy{nullptr};
+        curl_slist* headers{nullptr};
+    };
+
+    void run();
+    void start_pending();
+    void finish(CURL* easy, CURLcode result);
+    static void fail(Transfer& transfer, CURLcode result);
+
+    static size_t write_callback(char* data, size_t size, size_t nmemb, void* userdata);
+    static size_t header_callback(char* data, size_t size, size_t nmemb, void* userdata);
+
+    // Limits per host and of connections kept open overall.
+    static constexpr long MAX_HOST_CONNECTIONS = 6;
+    static constexpr long MAX_CONNECTIONS = 16;
+
+    CURLM* _multi{nullptr};
+
+    std::mutex _pending_mutex{};
+    std::vector<std::unique_ptr<Transfer>> _pending{};
+
+    // Only touched by the thread.
+    std::unordered_map<CURL*, std::unique_ptr<Transfer>> _transfers{};
+
+    std::atomic<bool> _should_exit{false};
+    std::thread _thread{};
+};
+
+} // namespace mavsdk
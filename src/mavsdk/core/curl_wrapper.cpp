@@ -1,4 +1,5 @@
 #include "log.h"
+#include "curl_multi.h"
 #include "curl_wrapper.h"
 #include "unused.h"
 #include <iostream>
@@ -8,6 +9,21 @@
 
 namespace mavsdk {
 
+CurlWrapper::CurlWrapper() = default;
+
+CurlWrapper::~CurlWrapper() = default;
+
+void CurlWrapper::fetch_async(const HttpRequest& request, http_callback_t callback)
+{
+    std::unique_lock<std::mutex> lock(_multi_mutex);
+    if (_multi == nullptr) {
+        _multi = std::make_unique<CurlMulti>();
+    }
+    lock.unlock();
+
+    _multi->fetch_async(request, std::move(callback));
+}
+
 // converts curl output to string
 // taken from
 // https://stackoverflow.com/questions/9786150/save-curl-content-result-into-a-string-in-c
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <memory>
+#include <mutex>
 #include "curl_include.h"
 #include "curl_wrapper_types.h"
 
@@ -12,6 +13,8 @@ using namespace testing;
 
 namespace mavsdk {
 
+class CurlMulti;
+
 class ICurlWrapper {
 public:
     virtual bool download_text(const std::string& url, std::string& content) = 0;
@@ -23,10 +26,15 @@ public:
         const std::string& url,
         const std::string& path,
         const progress_callback_t& progress_callback) = 0;
+    // The callback is called on a thread of the wrapper once done.
+    virtual void fetch_async(const HttpRequest& request, http_callback_t callback) = 0;
 };
 
 class CurlWrapper : public ICurlWrapper {
 public:
+    CurlWrapper();
+    ~CurlWrapper();
+
     // ICurlWrapper
     bool download_text(const std::string& url, std::string& content) override;
     bool download_file_to_path(
@@ -37,6 +45,16 @@ public:
         const std::string& url,
         const std::string& path,
         const progress_callback_t& progress_callback) override;
+    // Fetches run concurrently on one CurlMulti, started on first use.
+    void fetch_async(const HttpRequest& request, http_callback_t callback) override;
+
+    // Non-copyable
+    CurlWrapper(const CurlWrapper&) = delete;
+    const CurlWrapper& operator=(const CurlWrapper&) = delete;
+
+private:
+    std::mutex _multi_mutex{};
+    std::unique_ptr<CurlMulti> _multi{};
 };
 
 #ifdef TESTING
@@ -55,6 +73,7 @@ public:
             const std::string& url,
             const std::string& path,
             const progress_callback_t& progress_callback));
+    MOCK_METHOD2(fetch_async, void(const HttpRequest& request, http_callback_t callback));
 };
 #endif // TESTING
 
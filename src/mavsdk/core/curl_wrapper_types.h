@@ -1,6 +1,7 @@
 #pragma once
 #include "curl_include.h"
 #include <functional>
+#include <string>
 
 namespace mavsdk {
 
@@ -13,4 +14,21 @@ struct dl_up_progress {
     progress_callback_t progress_callback{nullptr};
 };
 
+// A GET request, made conditional by the validators of a cached response.
+struct HttpRequest {
+    std::string url{};
+    std::string etag{};
+    std::string last_modified{};
+};
+
+struct HttpResponse {
+    CURLcode curl_code{CURLE_OK};
+    long status_code{0};
+    std::string body{};
+    std::string etag{};
+    std::string last_modified{};
+};
+
+typedef std::function<void(HttpResponse response)> http_callback_t;
+
 } // namespace mavsdk
@@ -0,0 +1,38 @@
+#include "cycle_clock.h"
+
+#include <thread>
+
+namespace mavsdk {
+
+namespace {
+
+double measure_ticks_per_s()
+{
+#if defined(__aarch64__)
+    uint64_t frequency;
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+    return static_cast<double>(frequency);
+#elif defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    // The counter of any CPU still in use runs at a constant rate, which is
+    // not the nominal clock though, so it is measured against the steady
+    // clock.
+    const auto start_time = std::chrono::steady_clock::now();
+    const auto start_ticks = CycleClock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const auto ticks = CycleClock::now() - start_ticks;
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    return static_cast<double>(ticks) / elapsed.count();
+#else
+    return 1e9;
+#endif
+}
+
+} // namespace
+
+double CycleClock::to_seconds(uint64_t ticks)
+{
+    static const double ticks_per_s = measure_ticks_per_s();
+    return static_cast<double>(ticks) / ticks_per_s;
+}
+
+} // namespace mavsdk
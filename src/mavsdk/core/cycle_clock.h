@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace mavsdk {
+
+// Cheap timestamps to time short stretches of code which run all the time,
+// e.g. each message handler. On x86 and ARM64 this reads the CPU's counter,
+// which takes a few ns and doesn't go through the OS, elsewhere it falls
+// back to the steady clock.
+//
+// Ticks only make sense as differences, converted with to_seconds().
+class CycleClock {
+public:
+    static uint64_t now()
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t ticks;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+#endif
+    }
+
+    // The first call on x86 takes a few ms to measure the rate.
+    static double to_seconds(uint64_t ticks);
+};
+
+} // namespace mavsdk
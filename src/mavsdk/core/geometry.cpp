@@ -6,7 +6,9 @@ namespace mavsdk::geometry {
 
 CoordinateTransformation::CoordinateTransformation(GlobalCoordinate reference) :
     _ref_lat_rad(to_rad_from_deg(reference.latitude_deg)),
-    _ref_lon_rad(to_rad_from_deg(reference.longitude_deg))
+    _ref_lon_rad(to_rad_from_deg(reference.longitude_deg)),
+    _ref_sin_lat(sin(_ref_lat_rad)),
+    _ref_cos_lat(cos(_ref_lat_rad))
 {}
 
 CoordinateTransformation::LocalCoordinate
@@ -20,17 +22,14 @@ CoordinateTransformation::local_from_global(GlobalCoordinate global_coordinate)
 
     const double cos_d_lon = cos(lon_rad - _ref_lon_rad);
 
-    const double ref_sin_lat = sin(_ref_lat_rad);
-    const double ref_cos_lat = cos(_ref_lat_rad);
-
     const double arg =
-        constrain(ref_sin_lat * sin_lat + ref_cos_lat * cos_lat * cos_d_lon, -1.0, 1.0);
+        constrain(_ref_sin_lat * sin_lat + _ref_cos_lat * cos_lat * cos_d_lon, -1.0, 1.0);
     const double c = acos(arg);
 
     const double k = (fabs(c) > 0) ? (c / sin(c)) : 1.0;
 
     return LocalCoordinate{
-        k * (ref_cos_lat * sin_lat - ref_sin_lat * cos_lat * cos_d_lon) * world_radius_m,
+        k * (_ref_cos_lat * sin_lat - _ref_sin_lat * cos_lat * cos_d_lon) * world_radius_m,
         k * cos_lat * sin(lon_rad - _ref_lon_rad) * world_radius_m};
 }
 
@@ -47,13 +46,10 @@ CoordinateTransformation::global_from_local(LocalCoordinate local_coordinate) co
         const double sin_c = sin(c);
         const double cos_c = cos(c);
 
-        const double ref_sin_lat = sin(_ref_lat_rad);
-        const double ref_cos_lat = cos(_ref_lat_rad);
-
-        const double lat_rad = asin(cos_c * ref_sin_lat + (x_rad * sin_c * ref_cos_lat) / c);
+        const double lat_rad = asin(cos_c * _ref_sin_lat + (x_rad * sin_c * _ref_cos_lat) / c);
         const double lon_rad =
             (_ref_lon_rad +
-             atan2(y_rad * sin_c, c * ref_cos_lat * cos_c - x_rad * ref_sin_lat * sin_c));
+             atan2(y_rad * sin_c, c * _ref_cos_lat * cos_c - x_rad * _ref_sin_lat * sin_c));
 
         global.latitude_deg = to_deg_from_rad(lat_rad);
         global.longitude_deg = to_deg_from_rad(lon_rad);
@@ -66,4 +62,44 @@ CoordinateTransformation::global_from_local(LocalCoordinate local_coordinate) co
     return global;
 }
 
+void CoordinateTransformation::local_from_global(
+    const GlobalCoordinate* global_coordinates,
+    LocalCoordinate* local_coordinates,
+    std::size_t count) const
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        local_coordinates[i] = local_from_global(global_coordinates[i]);
+    }
+}
+
+std::vector<CoordinateTransformation::LocalCoordinate>
+CoordinateTransformation::local_from_global(
+    const std::vector<GlobalCoordinate>& global_coordinates) const
+{
+    std::vector<LocalCoordinate> local_coordinates(global_coordinates.size());
+    local_from_global(
+        global_coordinates.data(), local_coordinates.data(), global_coordinates.size());
+    return local_coordinates;
+}
+
+void CoordinateTransformation::global_from_local(
+    const LocalCoordinate* local_coordinates,
+    GlobalCoordinate* global_coordinates,
+    std::size_t count) const
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        global_coordinates[i] = global_from_local(local_coordinates[i]);
+    }
+}
+
+std::vector<CoordinateTransformation::GlobalCoordinate>
+CoordinateTransformation::global_from_local(
+    const std::vector<LocalCoordinate>& local_coordinates) const
+{
+    std::vector<GlobalCoordinate> global_coordinates(local_coordinates.size());
+    global_from_local(
+        local_coordinates.data(), global_coordinates.data(), local_coordinates.size());
+    return global_coordinates;
+}
+
 } // namespace mavsdk::geometry
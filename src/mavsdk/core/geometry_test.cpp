@@ -48,3 +48,36 @@ TEST(Geoemtry, LocalToGlobalAndBack)
     EXPECT_NEAR(location.north_m, location_again.north_m, 1e-8);
     EXPECT_NEAR(location.east_m, location_again.east_m, 1e-8);
 }
+
+TEST(Geometry, BatchMatchesSingle)
+{
+    CoordinateTransformation ct({47.356042, 8.519031});
+
+    std::vector<CoordinateTransformation::GlobalCoordinate> globals;
+    for (int i = 0; i < 100; ++i) {
+        globals.push_back({47.356042 + (i - 50) * 1e-4, 8.519031 + (i % 7 - 3) * 1e-3});
+    }
+    // The reference itself is special.
+    globals.push_back({47.356042, 8.519031});
+
+    const auto locals = ct.local_from_global(globals);
+    ASSERT_EQ(locals.size(), globals.size());
+    for (std::size_t i = 0; i < globals.size(); ++i) {
+        const auto single = ct.local_from_global(globals[i]);
+        EXPECT_DOUBLE_EQ(locals[i].north_m, single.north_m);
+        EXPECT_DOUBLE_EQ(locals[i].east_m, single.east_m);
+    }
+
+    const auto globals_again = ct.global_from_local(locals);
+    ASSERT_EQ(globals_again.size(), globals.size());
+    for (std::size_t i = 0; i < globals.size(); ++i) {
+        const auto single = ct.global_from_local(locals[i]);
+        EXPECT_DOUBLE_EQ(globals_again[i].latitude_deg, single.latitude_deg);
+        EXPECT_DOUBLE_EQ(globals_again[i].longitude_deg, single.longitude_deg);
+        EXPECT_NEAR(globals_again[i].latitude_deg, globals[i].latitude_deg, 1e-9);
+        EXPECT_NEAR(globals_again[i].longitude_deg, globals[i].longitude_deg, 1e-9);
+    }
+
+    EXPECT_TRUE(ct.local_from_global(std::vector<CoordinateTransformation::GlobalCoordinate>{})
+                    .empty());
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace mavsdk {
+
+// Ids of subscription handles, unique within the process.
+//
+// Topics can share a handle type, e.g. position and home both use
+// Handle<Telemetry::Position>. With ids from one counter for all of them, a
+// handle passed to the wrong unsubscribe matches nothing there, rather than
+// removing the subscriber which happens to have the same id.
+inline uint64_t next_handle_id()
+{
+    static std::atomic<uint64_t> next_id{1};
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace mavsdk
@@ -0,0 +1,61 @@
+#include "http_cache.h"
+#include "cache_file.h"
+#include "crc32.h"
+#include "fs.h"
+
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+namespace mavsdk {
+
+// Bump the last char whenever the format changes, old caches are then just
+// ignored.
+static const std::vector<uint8_t> file_magic = {'M', 'H', 'C', '1'};
+
+std::string http_cache_path(const std::string& directory, const std::string& url)
+{
+    Crc32 crc;
+    crc.add(reinterpret_cast<const uint8_t*>(url.data()), static_cast<uint32_t>(url.size()));
+
+    std::stringstream file_name;
+    file_name << "http-" << std::hex << crc.get() << ".cache";
+    return directory + path_separator + file_name.str();
+}
+
+bool http_cache_save(const std::string& path, const std::string& url, const HttpCacheEntry& entry)
+{
+    std::vector<uint8_t> buffer;
+    buffer.reserve(
+        file_magic.size() + 4 * 4 + url.size() + entry.etag.size() + entry.last_modified.size() +
+        entry.body.size());
+
+    buffer.insert(buffer.end(), file_magic.begin(), file_magic.end());
+    cache_put_string(buffer, url);
+    cache_put_string(buffer, entry.etag);
+    cache_put_string(buffer, entry.last_modified);
+    cache_put_string(buffer, entry.body);
+
+    return cache_file_write(path, std::move(buffer));
+}
+
+std::optional<HttpCacheEntry> http_cache_load(const std::string& path, const std::string& url)
+{
+    const auto buffer = cache_file_read(path, file_magic);
+    if (!buffer) {
+        return std::nullopt;
+    }
+
+    std::size_t pos = file_magic.size();
+    std::string cached_url;
+    HttpCacheEntry entry;
+    if (!cache_get_string(*buffer, pos, cached_url) || cached_url != url ||
+        !cache_get_string(*buffer, pos, entry.etag) ||
+        !cache_get_string(*buffer, pos, entry.last_modified) ||
+        !cache_get_string(*buffer, pos, entry.body)) {
+        return std::nullopt;
+    }
+    return entry;
+}
+
+} // namespace mavsdk
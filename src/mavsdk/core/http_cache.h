@@ -0,0 +1,27 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+namespace mavsdk {
+
+// A response kept on disk together with its validators, so it can be
+// revalidated with a conditional request instead of downloaded again.
+struct HttpCacheEntry {
+    std::string body{};
+    std::string etag{};
+    std::string last_modified{};
+};
+
+// Path of the cache file for the URL in the directory.
+std::string http_cache_path(const std::string& directory, const std::string& url);
+
+// The file stores the URL, the validators and the body, with a CRC32 at the
+// end, see cache_file_write().
+bool http_cache_save(const std::string& path, const std::string& url, const HttpCacheEntry& entry);
+
+// Returns nullopt if there is no cache, it can't be used or it is for another
+// URL with the same file name.
+std::optional<HttpCacheEntry> http_cache_load(const std::string& path, const std::string& url);
+
+} // namespace mavsdk
@@ -0,0 +1,49 @@
+#include "http_cache.h"
+#include "fs.h"
+
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+static const std::string example_url = "http://example.com/camera/definition.xml";
+
+TEST(HttpCache, SaveAndLoad)
+{
+    const auto dir = create_tmp_directory("mavsdk-http-cache-test");
+    ASSERT_TRUE(dir);
+    const auto path = http_cache_path(*dir, example_url);
+
+    HttpCacheEntry entry;
+    entry.body = std::string("<xml>\0binary</xml>", 18);
+    entry.etag = "\"abc123\"";
+    entry.last_modified = "Wed, 21 Oct 2015 07:28:00 GMT";
+    ASSERT_TRUE(http_cache_save(path, example_url, entry));
+
+    const auto loaded = http_cache_load(path, example_url);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->body, entry.body);
+    EXPECT_EQ(loaded->etag, entry.etag);
+    EXPECT_EQ(loaded->last_modified, entry.last_modified);
+}
+
+TEST(HttpCache, OtherUrlsDontMatch)
+{
+    const auto dir = create_tmp_directory("mavsdk-http-cache-test");
+    ASSERT_TRUE(dir);
+
+    EXPECT_NE(http_cache_path(*dir, example_url), http_cache_path(*dir, example_url + "?v=2"));
+
+    // Same file, e.g. after a collision of the file names.
+    const auto path = http_cache_path(*dir, example_url);
+    HttpCacheEntry entry;
+    entry.body = "content";
+    ASSERT_TRUE(http_cache_save(path, example_url, entry));
+    EXPECT_FALSE(http_cache_load(path, example_url + "?v=2"));
+}
+
+TEST(HttpCache, MissingFile)
+{
+    const auto dir = create_tmp_directory("mavsdk-http-cache-test");
+    ASSERT_TRUE(dir);
+    EXPECT_FALSE(http_cache_load(http_cache_path(*dir, example_url), example_url));
+}
@@ -1,5 +1,8 @@
 #include "http_loader.h"
 #include "curl_wrapper.h"
+#include "log.h"
+
+#include <future>
 
 namespace mavsdk {
 
@@ -116,8 +119,116 @@ bool HttpLoader::do_upload(
 
 bool HttpLoader::download_text_sync(const std::string& url, std::string& content)
 {
-    bool success = _curl_wrapper->download_text(url, content);
-    return success;
+    std::promise<std::pair<bool, std::string>> prom;
+    auto fut = prom.get_future();
+
+    download_text_async(url, [&prom](bool success, std::string downloaded) {
+        prom.set_value(std::make_pair(success, std::move(downloaded)));
+    });
+
+    auto result = fut.get();
+    content = std::move(result.second);
+    return result.first;
+}
+
+void HttpLoader::set_cache_directory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(_text_downloads->mutex);
+    _text_downloads->cache_directory = directory;
+}
+
+void HttpLoader::download_text_async(const std::string& url, TextCallback callback)
+{
+    std::string cache_path;
+    {
+        std::lock_guard<std::mutex> lock(_text_downloads->mutex);
+        auto& waiting = _text_downloads->waiting[url];
+        waiting.push_back(std::move(callback));
+        if (waiting.size() > 1) {
+            LogDebug() << "Sharing download of " << url;
+            return;
+        }
+        if (!_text_downloads->cache_directory.empty()) {
+            cache_path = http_cache_path(_text_downloads->cache_directory, url);
+        }
+    }
+
+    HttpRequest request;
+    request.url = url;
+
+    std::optional<HttpCacheEntry> cached;
+    if (!cache_path.empty()) {
+        cached = http_cache_load(cache_path, url);
+        if (cached) {
+            request.etag = cached->etag;
+            request.last_modified = cached->last_modified;
+        }
+    }
+
+    _curl_wrapper->fetch_async(
+        request,
+        [downloads = _text_downloads, url, cache_path, cached](HttpResponse response) {
+            finish_text_download(downloads, url, cache_path, cached, std::move(response));
+        });
+}
+
+void HttpLoader::finish_text_download(
+    const std::shared_ptr<TextDownloads>& downloads,
+    const std::string& url,
+    const std::string& cache_path,
+    const std::optional<HttpCacheEntry>& cached,
+    HttpResponse response)
+{
+    bool success = false;
+    std::string content;
+
+    if (response.curl_code == CURLE_OK && response.status_code == 304 && cached) {
+        LogDebug() << "Cached " << url << " is still valid";
+        success = true;
+        content = cached->body;
+
+    } else if (
+        response.curl_code == CURLE_OK &&
+        // Other protocols than HTTP have no status.
+        (response.status_code == 0 ||
+         (response.status_code >= 200 && response.status_code < 300))) {
+        success = true;
+        content = std::move(response.body);
+
+        // Without a validator we could never tell whether it is still valid.
+        if (!cache_path.empty() && (!response.etag.empty() || !response.last_modified.empty())) {
+            HttpCacheEntry entry;
+            entry.body = content;
+            entry.etag = std::move(response.etag);
+            entry.last_modified = std::move(response.last_modified);
+            http_cache_save(cache_path, url, entry);
+        }
+
+    } else if (response.curl_code != CURLE_OK && cached) {
+        // Better stale than nothing when offline.
+        LogWarn() << "Could not revalidate " << url << ", using cached copy";
+        success = true;
+        content = cached->body;
+
+    } else if (response.curl_code == CURLE_OK) {
+        LogErr() << "Error while downloading text, HTTP status: " << response.status_code;
+    }
+
+    std::vector<TextCallback> waiting;
+    {
+        std::lock_guard<std::mutex> lock(downloads->mutex);
+        auto it = downloads->waiting.find(url);
+        if (it != downloads->waiting.end()) {
+            waiting = std::move(it->second);
+            downloads->waiting.erase(it);
+        }
+    }
+
+    for (auto& callback : waiting) {
+        if (callback) {
+            callback(success, content);
+        }
+    }
 }
 
 } // namespace mavsdk
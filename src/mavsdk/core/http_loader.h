@@ -2,11 +2,17 @@
 
 #include <thread>
 #include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include "safe_queue.h"
 #include "curl_wrapper.h"
+#include "http_cache.h"
 
 namespace mavsdk {
 
@@ -24,8 +30,20 @@ public:
     void start();
     void stop();
 
+    using TextCallback = std::function<void(bool success, std::string content)>;
+
     bool download_sync(const std::string& url, const std::string& local_path);
     bool download_text_sync(const std::string& url, std::string& content);
+
+    // Text downloads run concurrently. Requests for a URL already being
+    // downloaded share the download, and with a cache directory set the
+    // responses are cached and revalidated using ETag and Last-Modified.
+    // The callback is called on a thread of the loader.
+    void download_text_async(const std::string& url, TextCallback callback);
+
+    // Empty, as by default, to not cache anything.
+    void set_cache_directory(const std::string& directory);
+
     void download_async(
         const std::string& url,
         const std::string& local_path,
@@ -122,6 +140,20 @@ private:
         progress_callback_t _progress_callback{};
     };
 
+    struct TextDownloads {
+        std::mutex mutex{};
+        std::string cache_directory{};
+        // Callbacks of everyone waiting, by URL being downloaded.
+        std::unordered_map<std::string, std::vector<TextCallback>> waiting{};
+    };
+
+    static void finish_text_download(
+        const std::shared_ptr<TextDownloads>& downloads,
+        const std::string& url,
+        const std::string& cache_path,
+        const std::optional<HttpCacheEntry>& cached,
+        HttpResponse response);
+
     static void work_thread(HttpLoader* self);
     static void do_item(
         const std::shared_ptr<WorkItem>& item, const std::shared_ptr<ICurlWrapper>& curl_wrapper);
@@ -133,6 +165,9 @@ private:
 
     std::shared_ptr<ICurlWrapper> _curl_wrapper;
 
+    // Shared with the fetches in flight which may outlive the loader.
+    std::shared_ptr<TextDownloads> _text_downloads{std::make_shared<TextDownloads>()};
+
     SafeQueue<std::shared_ptr<WorkItem>> _work_queue{};
     std::thread* _work_thread = nullptr;
 
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 namespace mavsdk::geometry {
 
 /**
@@ -55,6 +58,52 @@ public:
      */
     [[nodiscard]] GlobalCoordinate global_from_local(LocalCoordinate local_coordinate) const;
 
+    /**
+     * @brief Calculate local coordinates from many global coordinates at once.
+     *
+     * The results are the same as calling local_from_global() for each one.
+     *
+     * @param global_coordinates The global coordinates to project from.
+     * @param local_coordinates Where to write the results to, with room for count coordinates.
+     * @param count The number of coordinates.
+     */
+    void local_from_global(
+        const GlobalCoordinate* global_coordinates,
+        LocalCoordinate* local_coordinates,
+        std::size_t count) const;
+
+    /**
+     * @brief Calculate local coordinates from many global coordinates at once.
+     *
+     * @param global_coordinates The global coordinates to project from.
+     * @return The local coordinates, in the same order.
+     */
+    [[nodiscard]] std::vector<LocalCoordinate>
+    local_from_global(const std::vector<GlobalCoordinate>& global_coordinates) const;
+
+    /**
+     * @brief Calculate global coordinates from many local coordinates at once.
+     *
+     * The results are the same as calling global_from_local() for each one.
+     *
+     * @param local_coordinates The local coordinates to project from.
+     * @param global_coordinates Where to write the results to, with room for count coordinates.
+     * @param count The number of coordinates.
+     */
+    void global_from_local(
+        const LocalCoordinate* local_coordinates,
+        GlobalCoordinate* global_coordinates,
+        std::size_t count) const;
+
+    /**
+     * @brief Calculate global coordinates from many local coordinates at once.
+     *
+     * @param local_coordinates The local coordinates to project from.
+     * @return The global coordinates, in the same order.
+     */
+    [[nodiscard]] std::vector<GlobalCoordinate>
+    global_from_local(const std::vector<LocalCoordinate>& local_coordinates) const;
+
     /**
      * @brief Destructor.
      */
@@ -63,6 +112,9 @@ public:
 private:
     double _ref_lat_rad;
     double _ref_lon_rad;
+    // These only depend on the reference, so are only calculated once.
+    double _ref_sin_lat;
+    double _ref_cos_lat;
     static constexpr double world_radius_m{6371000.0};
 };
 
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+namespace mavsdk {
+
+template<typename... Args> class CallbackList;
+template<typename T> class BatchCallbackList;
+
+/**
+ * @brief A handle returned from a subscription which can be used to unsubscribe again.
+ *
+ * The template arguments match the arguments of the subscription's callback, so a
+ * handle from one kind of subscription can't be passed to another one by accident.
+ * Subscriptions with the same callback arguments share a handle type, but no two
+ * handles are the same, so passing one to the wrong unsubscribe has no effect.
+ */
+template<typename... Args> class Handle {
+public:
+    /**
+     * @brief Default constructor, the handle is not valid.
+     */
+    Handle() = default;
+
+    /**
+     * @brief Destructor, does not unsubscribe.
+     */
+    ~Handle() = default;
+
+    /**
+     * @brief Check whether the handle belongs to a subscription.
+     *
+     * @return `true` if the handle was returned by a subscription.
+     */
+    [[nodiscard]] bool valid() const { return _id != 0; }
+
+    /**
+     * @brief Equal operator to compare two handles.
+     *
+     * @return `true` if both handles refer to the same subscription.
+     */
+    bool operator==(const Handle& other) const { return _id == other._id; }
+
+    /**
+     * @brief Less than operator, so that handles can be stored in sorted containers.
+     *
+     * @return `true` if this handle sorts before the other one.
+     */
+    bool operator<(const Handle& other) const { return _id < other._id; }
+
+private:
+    explicit Handle(uint64_t id) : _id(id) {}
+
+    uint64_t _id{0};
+
+    friend class CallbackList<Args...>;
+    template<typename T> friend class BatchCallbackList;
+};
+
+} // namespace mavsdk
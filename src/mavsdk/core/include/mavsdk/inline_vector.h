@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+namespace mavsdk {
+
+/**
+ * @brief Vector with its elements stored inline, up to a fixed capacity.
+ *
+ * Used for arrays whose maximum size is fixed by MAVLink, such as covariance
+ * matrices or actuator outputs, so that converting a message and copying it
+ * into callbacks does not allocate.
+ *
+ * It behaves like a std::vector for reading, iterating and appending, and
+ * converts to and from one. Elements beyond the capacity are dropped.
+ */
+template<typename T, std::size_t Capacity> class InlineVector {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    InlineVector() = default;
+
+    /**
+     * @brief Constructor from a list of elements.
+     */
+    InlineVector(std::initializer_list<T> elements) { assign(elements.begin(), elements.end()); }
+
+    /**
+     * @brief Constructor from a std::vector.
+     */
+    InlineVector(const std::vector<T>& elements) // NOLINT(google-explicit-constructor)
+    {
+        assign(elements.begin(), elements.end());
+    }
+
+    /**
+     * @brief Conversion to a std::vector, e.g. for existing code.
+     */
+    operator std::vector<T>() const // NOLINT(google-explicit-constructor)
+    {
+        return std::vector<T>(begin(), end());
+    }
+
+    /**
+     * @brief Replaces the elements with the range from first to last.
+     */
+    template<typename InputIt> void assign(InputIt first, InputIt last)
+    {
+        _size = 0;
+        for (; first != last && _size < Capacity; ++first) {
+            _elements[_size++] = *first;
+        }
+    }
+
+    /**
+     * @brief Appends an element, it is dropped if the vector is full.
+     */
+    void push_back(const T& element)
+    {
+        if (_size < Capacity) {
+            _elements[_size++] = element;
+        }
+    }
+
+    /**
+     * @brief Resizes to at most the capacity, new elements are value-initialized.
+     */
+    void resize(size_type size)
+    {
+        size = std::min(size, Capacity);
+        for (size_type i = _size; i < size; ++i) {
+            _elements[i] = T{};
+        }
+        _size = size;
+    }
+
+    /**
+     * @brief Removes all elements.
+     */
+    void clear() { _size = 0; }
+
+    /**
+     * @brief Number of elements.
+     */
+    [[nodiscard]] size_type size() const { return _size; }
+
+    /**
+     * @brief Whether there are no elements.
+     */
+    [[nodiscard]] bool empty() const { return _size == 0; }
+
+    /**
+     * @brief Maximum number of elements.
+     */
+    [[nodiscard]] static constexpr size_type capacity() { return Capacity; }
+
+    /**
+     * @brief Element access, without bounds check.
+     */
+    reference operator[](size_type index) { return _elements[index]; }
+
+    /**
+     * @brief Element access, without bounds check.
+     */
+    const_reference operator[](size_type index) const { return _elements[index]; }
+
+    /**
+     * @brief First element.
+     */
+    reference front() { return _elements[0]; }
+
+    /**
+     * @brief First element.
+     */
+    const_reference front() const { return _elements[0]; }
+
+    /**
+     * @brief Last element.
+     */
+    reference back() { return _elements[_size - 1]; }
+
+    /**
+     * @brief Last element.
+     */
+    const_reference back() const { return _elements[_size - 1]; }
+
+    /**
+     * @brief Pointer to the elements.
+     */
+    T* data() { return _elements.data(); }
+
+    /**
+     * @brief Pointer to the elements.
+     */
+    const T* data() const { return _elements.data(); }
+
+    /**
+     * @brief Iterator to the first element.
+     */
+    iterator begin() { return _elements.data(); }
+
+    /**
+     * @brief Iterator past the last element.
+     */
+    iterator end() { return _elements.data() + _size; }
+
+    /**
+     * @brief Iterator to the first element.
+     */
+    const_iterator begin() const { return _elements.data(); }
+
+    /**
+     * @brief Iterator past the last element.
+     */
+    const_iterator end() const { return _elements.data() + _size; }
+
+    /**
+     * @brief Equal operator, compares the elements.
+     */
+    friend bool operator==(const InlineVector& lhs, const InlineVector& rhs)
+    {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    /**
+     * @brief Not equal operator, compares the elements.
+     */
+    friend bool operator!=(const InlineVector& lhs, const InlineVector& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    std::array<T, Capacity> _elements{};
+    size_type _size{0};
+};
+
+} // namespace mavsdk
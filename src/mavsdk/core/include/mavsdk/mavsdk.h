@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <vector>
@@ -20,6 +23,7 @@ enum class ForwardingOption {
 };
 
 class MavsdkImpl;
+class RuntimeImpl;
 
 /**
  * @brief This is the main class of MAVSDK (a MAVLink API Library).
@@ -39,17 +43,45 @@ public:
     static constexpr auto DEFAULT_TCP_REMOTE_IP = "127.0.0.1";
     /** @brief Default TCP remote port. */
     static constexpr int DEFAULT_TCP_REMOTE_PORT = 5760;
+    /** @brief Default TCP bind IP to listen for clients on (any local IP). */
+    static constexpr auto DEFAULT_TCP_SERVER_IP = "0.0.0.0";
     /** @brief Default serial baudrate. */
     static constexpr int DEFAULT_SERIAL_BAUDRATE = 57600;
 
     /** @brief Default internal timeout in seconds. */
     static constexpr double DEFAULT_TIMEOUT_S = 0.5;
 
+    /** @brief Default capacity of the user callback queue. */
+    static constexpr std::size_t DEFAULT_CALLBACK_QUEUE_CAPACITY = 100;
+
+    /** @brief Stack size of threads with the low-memory profile, see
+     * `Configuration::set_low_memory`. */
+    static constexpr std::size_t LOW_MEMORY_STACK_SIZE_BYTES = 256 * 1024;
+
+    /** @brief Images whose capture infos a camera keeps in memory with the
+     * low-memory profile. */
+    static constexpr uint32_t LOW_MEMORY_CAPTURE_INFO_WINDOW = 256;
+
+    class Configuration;
+    class Runtime;
+
     /**
      * @brief Constructor.
+     *
+     * Uses the configuration for a ground station.
      */
     Mavsdk();
 
+    /**
+     * @brief Constructor with a configuration.
+     *
+     * Some settings such as the callback queue capacity can only be set
+     * using this constructor.
+     *
+     * @param configuration Configuration to use.
+     */
+    explicit Mavsdk(Configuration configuration);
+
     /**
      * @brief Destructor.
      *
@@ -73,13 +105,32 @@ public:
      * Connection URL format should be:
      * - UDP:    udp://[host][:bind_port]
      * - TCP:    tcp://[host][:remote_port]
+     * - TCP server: tcpin://[bind_host][:bind_port]
      * - Serial: serial://dev_node[:baudrate]
+     * - Replay: replay://tlog_path or replay_fast://tlog_path
+     *
+     * A replay connection feeds the messages of a tlog, e.g. one captured
+     * with Configuration::set_capture_path, back in at their original timing,
+     * or with replay_fast as fast as possible. Messages from our own system
+     * ID are skipped and nothing is sent.
      *
      * For UDP, the host can be set to either:
      *   - zero IP: 0.0.0.0 -> behave like a server and listen for heartbeats.
      *   - some IP: 192.168.1.12 -> behave like a client, initiate connection
      *     and start sending heartbeats.
      *
+     * A TCP server listens on the bind port (defaults to 5760) and accepts any
+     * number of clients, such as several ground stations. Messages are sent
+     * to all of them, a client which doesn't keep up misses messages rather
+     * than holding up the others.
+     *
+     * For testing, all but a replay connection can emulate an impaired link
+     * in both directions, by appending e.g.
+     * "?emulate=rtt:300,jitter:20,loss:5,reorder:1,bw:57600,seed:2" to the
+     * URL: the round trip time and the jitter in ms, loss and reordering in
+     * percent and the bandwidth in bits per second. All of them are optional.
+     * The same seed loses, delays and reorders the same messages every run.
+     *
      * @param connection_url connection URL string.
      * @param forwarding_option message forwarding option (when multiple interfaces are used).
      * @return The result of adding the connection.
@@ -184,6 +235,76 @@ public:
                       provided */
         };
 
+        /**
+         * @brief What to do with a user callback when the callback queue is full.
+         */
+        enum class CallbackOverflowPolicy {
+            DropNewest, /**< @brief Drop the callback which is to be added. */
+            DropOldest, /**< @brief Drop the oldest callback in the queue to make space. */
+            Block, /**< @brief Block the calling MAVSDK thread until there is space. */
+        };
+
+        /**
+         * @brief Which user callbacks are guaranteed to be called in order
+         * when multiple callback threads are used.
+         */
+        enum class CallbackOrdering {
+            PerSystem, /**< @brief All callbacks of one system are called in order. */
+            PerSubscription, /**< @brief Only callbacks of the same subscription of one system
+                                are called in order. */
+        };
+
+        /**
+         * @brief How connections leading to the same systems are combined.
+         */
+        enum class LinkBonding {
+            Off, /**< @brief Every message received is handled, even if it arrived over
+                    several connections. */
+            AllLinks, /**< @brief Copies of messages arriving over several connections are
+                         dropped, and messages are sent over all connections to their target. */
+            BestLink, /**< @brief Copies are dropped, and messages are sent over the best
+                         connection to their target only. */
+            ByPriority, /**< @brief Copies are dropped, commands, missions and parameters are
+                           sent over all connections to their target, everything else over
+                           the best one only. */
+        };
+
+        /**
+         * @brief The threads MAVSDK runs, by what they are doing.
+         */
+        enum class ThreadRole {
+            Io, /**< @brief Reading from and writing to connections. */
+            Timer, /**< @brief Running timeouts and periodic work, e.g. heartbeats. */
+            Dispatch, /**< @brief Running the handlers of received messages. */
+            Callback, /**< @brief Calling user callbacks. */
+            Worker, /**< @brief Working through queued work such as parameters and missions. */
+        };
+
+        /**
+         * @brief Scheduling policy of a thread.
+         */
+        enum class SchedulingPolicy {
+            Default, /**< @brief Whatever the thread inherited, usually time-sharing. */
+            Fifo, /**< @brief Real-time, first in first out (SCHED_FIFO). */
+            RoundRobin, /**< @brief Real-time, round robin (SCHED_RR). */
+        };
+
+        /**
+         * @brief How the threads of one role are scheduled.
+         *
+         * Real-time policies usually need elevated privileges, e.g. CAP_SYS_NICE on
+         * Linux. If a setting can't be applied, a warning is logged and the thread runs
+         * with what it has.
+         */
+        struct ThreadSettings {
+            std::vector<unsigned> cpus{}; /**< @brief CPUs the threads may run on, empty for any.
+                                             Not supported on macOS and iOS. */
+            SchedulingPolicy policy{SchedulingPolicy::Default}; /**< @brief Scheduling policy. */
+            int priority{0}; /**< @brief Priority for the real-time policies. */
+            std::size_t stack_size_bytes{0}; /**< @brief Stack size of the threads, 0 for the
+                                                platform's default. Not supported on Windows. */
+        };
+
         /**
          * @brief Create new Configuration via manually configured
          * system and component ID.
@@ -244,11 +365,407 @@ public:
          */
         void set_usage_type(UsageType usage_type);
 
+        /**
+         * @brief Get the capacity of the user callback queue.
+         * @return maximum number of callbacks queued
+         */
+        std::size_t get_callback_queue_capacity() const;
+
+        /**
+         * @brief Set the capacity of the user callback queue.
+         *
+         * The capacity is rounded up to the next power of two. It only takes
+         * effect when passed to the Mavsdk constructor.
+         */
+        void set_callback_queue_capacity(std::size_t capacity);
+
+        /**
+         * @brief Get what happens when the user callback queue is full.
+         * @return overflow policy
+         */
+        CallbackOverflowPolicy get_callback_overflow_policy() const;
+
+        /**
+         * @brief Set what happens when the user callback queue is full.
+         *
+         * Note that `Block` stalls MAVSDK internals until user callbacks have
+         * caught up. A callback queued from within a user callback is never
+         * blocked but dropped instead.
+         */
+        void set_callback_overflow_policy(CallbackOverflowPolicy policy);
+
+        /**
+         * @brief Get the number of threads used to call user callbacks.
+         * @return number of callback threads
+         */
+        unsigned get_callback_threads() const;
+
+        /**
+         * @brief Set the number of threads used to call user callbacks.
+         *
+         * By default, one thread calls all user callbacks, one after the
+         * other. With more threads, callbacks are spread across them while the
+         * ordering set by `set_callback_ordering` is kept, so one slow callback
+         * does not hold up all others. Callbacks then need to be thread-safe
+         * with respect to each other.
+         *
+         * This only takes effect when passed to the Mavsdk constructor.
+         */
+        void set_callback_threads(unsigned num_threads);
+
+        /**
+         * @brief Get the ordering guarantee for user callbacks.
+         * @return callback ordering
+         */
+        CallbackOrdering get_callback_ordering() const;
+
+        /**
+         * @brief Set the ordering guarantee for user callbacks.
+         *
+         * This only matters if more than one callback thread is used and only
+         * takes effect when passed to the Mavsdk constructor.
+         */
+        void set_callback_ordering(CallbackOrdering ordering);
+
+        /**
+         * @brief Get the number of threads running the handlers of received messages.
+         * @return number of dispatch threads, 0 if messages are dispatched by the
+         * thread receiving them
+         */
+        unsigned get_dispatch_threads() const;
+
+        /**
+         * @brief Set the number of threads running the handlers of received messages.
+         *
+         * By default, connections only read and parse messages and pass them
+         * on to one dispatch thread, so slow message handling doesn't delay
+         * reading and lead to messages being dropped by the OS. Messages of
+         * one system are always handled by the same thread and in order.
+         *
+         * With 0, messages are handled by the thread of the connection
+         * receiving them.
+         *
+         * This only takes effect when passed to the Mavsdk constructor.
+         */
+        void set_dispatch_threads(unsigned num_threads);
+
+        /**
+         * @brief Get the directory where parameters of systems are cached.
+         * @return cache directory, empty if caching is disabled
+         */
+        std::string get_param_cache_directory() const;
+
+        /**
+         * @brief Set the directory where parameters of systems are cached.
+         *
+         * Once all parameters of a system have been downloaded, they are
+         * saved there by its UID. When all parameters are requested again,
+         * even after a restart, they are loaded from the cache if the
+         * system reports the same parameter hash, instead of downloading
+         * them again. This requires the autopilot to support the
+         * `_HASH_CHECK` parameter, as PX4 does.
+         *
+         * Parsed camera definitions are cached there as well, by the URI
+         * and version the camera reports, so they don't need to be
+         * downloaded and parsed again.
+         *
+         * So are the mission, geofence and rally points last uploaded or
+         * downloaded, which are then used for downloads as long as the
+         * autopilot reports the same opaque id for them.
+         *
+         * The directory needs to exist. Caching is disabled by default, or
+         * by setting an empty directory.
+         */
+        void set_param_cache_directory(std::string directory);
+
+        /**
+         * @brief Get whether serial connections schedule what they send.
+         * @return whether send scheduling is enabled
+         */
+        bool get_serial_send_scheduling() const;
+
+        /**
+         * @brief Set whether serial connections schedule what they send.
+         *
+         * Messages are then queued by priority, and sent no faster than the
+         * baudrate allows: first control messages such as heartbeats and
+         * setpoints, then commands and their acks, then telemetry, and bulk
+         * transfers such as FTP, logs and missions only use the capacity left.
+         * This keeps a saturated telemetry radio responsive. When a queue
+         * overflows, its oldest messages are dropped.
+         *
+         * Disabled by default, it only applies to serial connections added
+         * afterwards.
+         */
+        void set_serial_send_scheduling(bool enabled);
+
+        /**
+         * @brief Get whether serial connections are set up for low latency.
+         * @return whether low latency is enabled
+         */
+        bool get_serial_low_latency() const;
+
+        /**
+         * @brief Set whether serial connections are set up for low latency.
+         *
+         * USB-serial adapters hold back what they receive for up to 16 ms by
+         * default. With low latency, the driver's low latency flag is set, the
+         * latency timer of FTDI adapters is lowered to 1 ms and reads return
+         * whatever arrived right away. This costs more wakeups and USB traffic,
+         * but control loops get their messages within about a millisecond.
+         *
+         * Setting the latency timer usually needs write access to sysfs, if
+         * that fails, a warning is logged and the rest still applies.
+         *
+         * Disabled by default, it only applies to serial connections added
+         * afterwards, and only on Linux.
+         */
+        void set_serial_low_latency(bool enabled);
+
+        /**
+         * @brief Get how long serial and TCP connections hold back writes.
+         * @return delay in seconds, 0 if messages are written right away
+         */
+        double get_write_coalescing_delay_s() const;
+
+        /**
+         * @brief Set how long serial and TCP connections hold back writes.
+         *
+         * Messages sent within the delay are written together with one
+         * system call once the delay has passed or 1 KiB is buffered,
+         * whichever comes first. This saves a lot of overhead e.g. with
+         * USB-serial adapters at the cost of that much latency. Messages sent
+         * as a batch are always written together.
+         *
+         * Disabled by default, it only applies to connections added afterwards.
+         */
+        void set_write_coalescing_delay_s(double delay_s);
+
+        /**
+         * @brief Get how much serial and TCP connections queue to send.
+         * @return queue size in bytes, 0 if sending blocks the caller
+         */
+        std::size_t get_send_queue_bytes() const;
+
+        /**
+         * @brief Set how much serial and TCP connections queue to send.
+         *
+         * By default, sending writes to the port or socket right away, which
+         * blocks the calling thread while the link is saturated. With a send
+         * queue, messages are queued and written by a thread of the
+         * connection's own instead. Once the queue is full, messages are
+         * dropped rather than blocking, see `subscribe_send_congestion`.
+         *
+         * Serial connections with send scheduling don't block the caller
+         * either way and don't use the queue.
+         *
+         * Disabled by default, it only applies to connections added afterwards.
+         */
+        void set_send_queue_bytes(std::size_t bytes);
+
+        /**
+         * @brief Get whether TCP connections disable Nagle's algorithm.
+         * @return whether TCP_NODELAY is set
+         */
+        bool get_tcp_no_delay() const;
+
+        /**
+         * @brief Set whether TCP connections disable Nagle's algorithm.
+         *
+         * With TCP_NODELAY, small messages such as setpoints are sent right
+         * away instead of waiting for previous data to be acknowledged.
+         *
+         * Disabled by default, it only applies to connections added afterwards.
+         */
+        void set_tcp_no_delay(bool no_delay);
+
+        /**
+         * @brief Get the tlog everything received and sent is captured to.
+         * @return path of the tlog, empty if nothing is captured
+         */
+        std::string get_capture_path() const;
+
+        /**
+         * @brief Set a tlog to capture everything received and sent to.
+         *
+         * The tlog has the format QGroundControl and MAVProxy use as well,
+         * and can be replayed with a replay:// connection. An existing file
+         * is appended to.
+         *
+         * Disabled by default, it only applies to connections added afterwards.
+         */
+        void set_capture_path(std::string path);
+
+        /**
+         * @brief Get how connections leading to the same systems are combined.
+         * @return link bonding mode
+         */
+        LinkBonding get_link_bonding() const;
+
+        /**
+         * @brief Set how connections leading to the same systems are combined.
+         *
+         * With redundant links, such as LTE and a radio, each message arrives
+         * once per link. With bonding, only the first copy of a message is
+         * handled, recognized by its sequence number, so callbacks are not
+         * called twice and commands are not handled twice.
+         *
+         * The best connection is the one lagging the least behind the fastest
+         * one, with losses counting as extra lag, see `ConnectionStats`.
+         *
+         * Off by default. This only takes effect when passed to the Mavsdk
+         * constructor.
+         */
+        void set_link_bonding(LinkBonding link_bonding);
+
+        /**
+         * @brief Get how long messages requested from a system are reused.
+         * @return time in seconds, 0 if every request goes to the system
+         */
+        double get_request_message_cache_ttl_s() const;
+
+        /**
+         * @brief Set how long messages requested from a system are reused.
+         *
+         * Plugins ask for messages with MAV_CMD_REQUEST_MESSAGE, often for
+         * the same ones when a system connects. Requests for a message which
+         * is requested already always wait for the same answer. With a TTL,
+         * requests within that time after the answer arrived get it as well,
+         * without asking the system again, which saves traffic on slow links.
+         *
+         * Disabled by default, as a message may then be that much out of date.
+         */
+        void set_request_message_cache_ttl_s(double ttl_s);
+
+        /**
+         * @brief Get whether message latency statistics are collected.
+         * @return true if enabled
+         */
+        bool get_message_latency_stats() const;
+
+        /**
+         * @brief Set whether message latency statistics are collected.
+         *
+         * Enabled, every message handled and every user callback it leads to
+         * is timed, see `Mavsdk::message_latency_stats`. This costs a lock
+         * and a lookup per message and callback, so it is meant for finding
+         * out where latency comes from rather than to be left on.
+         *
+         * Disabled by default.
+         */
+        void set_message_latency_stats(bool enabled);
+
+        /**
+         * @brief Get the scheduling settings of the threads of a role.
+         * @return thread settings
+         */
+        ThreadSettings get_thread_settings(ThreadRole role) const;
+
+        /**
+         * @brief Set the scheduling settings of the threads of a role.
+         *
+         * By default, no thread is pinned and all use the default policy. For
+         * instance, the I/O and timer threads can be given a real-time priority
+         * and be pinned to a core which is kept free of other heavy work.
+         *
+         * The I/O thread on Linux is shared by all Mavsdk instances of the
+         * process, it takes the settings of the instance created last.
+         *
+         * This only takes effect when passed to the Mavsdk constructor.
+         */
+        void set_thread_settings(ThreadRole role, ThreadSettings settings);
+
+        /**
+         * @brief Get the prefix of the names of MAVSDK's threads.
+         * @return thread name prefix
+         */
+        std::string get_thread_name_prefix() const;
+
+        /**
+         * @brief Set the prefix of the names of MAVSDK's threads.
+         *
+         * Threads are named after their role, e.g. "mavsdk-io" or "mavsdk-cb0",
+         * so they can be told apart in tools like top or a debugger. Linux
+         * truncates names to 15 characters.
+         *
+         * This only takes effect when passed to the Mavsdk constructor.
+         */
+        void set_thread_name_prefix(std::string prefix);
+
+        /**
+         * @brief Get the runtime shared with other Mavsdk instances.
+         * @return runtime, nullptr if the instance runs its own threads
+         */
+        std::shared_ptr<Runtime> get_runtime() const;
+
+        /**
+         * @brief Set a runtime to share with other Mavsdk instances.
+         *
+         * Instead of starting its own timer, callback and worker threads,
+         * the instance then uses the runtime's. The number of callback
+         * threads and the thread settings of this configuration are ignored
+         * in favour of the ones the runtime was created with.
+         *
+         * This only takes effect when passed to the Mavsdk constructor.
+         */
+        void set_runtime(std::shared_ptr<Runtime> runtime);
+
+        /**
+         * @brief Get whether the low-memory profile is used.
+         * @return true if enabled
+         */
+        bool get_low_memory() const;
+
+        /**
+         * @brief Use the low-memory profile, for phones and small companion
+         * computers.
+         *
+         * Enabling it also changes these settings, which can still be
+         * changed afterwards:
+         * - threads get stacks of `LOW_MEMORY_STACK_SIZE_BYTES` instead of
+         *   the platform's default, often 8 MiB, unless a stack size was set
+         *   for their role,
+         * - user callbacks are called by one thread,
+         * - messages are handled by the thread receiving them, see
+         *   `set_dispatch_threads`.
+         *
+         * Furthermore, systems share a single work thread, and cameras keep
+         * the capture infos of the last `LOW_MEMORY_CAPTURE_INFO_WINDOW`
+         * images only, see `Camera::set_capture_info_retention`. Camera
+         * definitions built into the library are only copied out once a
+         * matching camera is found, either way.
+         *
+         * Several instances can additionally share their threads, see
+         * `set_runtime`.
+         *
+         * This only takes effect when passed to the Mavsdk constructor.
+         */
+        void set_low_memory(bool low_memory);
+
     private:
         uint8_t _system_id;
         uint8_t _component_id;
         bool _always_send_heartbeats;
         UsageType _usage_type;
+        std::size_t _callback_queue_capacity{DEFAULT_CALLBACK_QUEUE_CAPACITY};
+        CallbackOverflowPolicy _callback_overflow_policy{CallbackOverflowPolicy::DropNewest};
+        unsigned _callback_threads{1};
+        CallbackOrdering _callback_ordering{CallbackOrdering::PerSystem};
+        unsigned _dispatch_threads{1};
+        std::string _param_cache_directory{};
+        bool _serial_send_scheduling{false};
+        bool _serial_low_latency{false};
+        double _write_coalescing_delay_s{0.0};
+        bool _tcp_no_delay{false};
+        std::size_t _send_queue_bytes{0};
+        std::string _capture_path{};
+        LinkBonding _link_bonding{LinkBonding::Off};
+        double _request_message_cache_ttl_s{0.0};
+        bool _message_latency_stats{false};
+        std::array<ThreadSettings, 5> _thread_settings{};
+        std::string _thread_name_prefix{"mavsdk"};
+        std::shared_ptr<Runtime> _runtime{};
+        bool _low_memory{false};
 
         static Mavsdk::Configuration::UsageType usage_type_for_component(uint8_t component_id);
     };
@@ -274,6 +791,35 @@ public:
      */
     void set_timeout_s(double timeout_s);
 
+    /**
+     * @brief Secret key for MAVLink 2 message signing.
+     */
+    using SigningKey = std::array<uint8_t, 32>;
+
+    /**
+     * @brief Sign outgoing and verify incoming messages (MAVLink 2 message signing).
+     *
+     * All messages sent are signed with the key. Incoming messages are only
+     * accepted if they are signed with the same key and are not replayed, i.e.
+     * their timestamp is newer than the last one of the same sender on that
+     * connection. Messages dropped because of this are counted in
+     * `ConnectionStats::signature_errors`.
+     *
+     * Calling this again changes the key. The vehicles need to be set up with
+     * the same key, e.g. using the SETUP_SIGNING message.
+     *
+     * @param key The secret key shared with the vehicles.
+     * @param accept_unsigned Whether unsigned messages are accepted as well,
+     * e.g. while vehicles are moved over to signing. RADIO_STATUS is always
+     * accepted because radios can't sign it.
+     */
+    void enable_signing(const SigningKey& key, bool accept_unsigned = false);
+
+    /**
+     * @brief Stop signing outgoing and verifying incoming messages.
+     */
+    void disable_signing();
+
     /**
      * @brief Set system status of this MAVLink entity.
      *
@@ -300,6 +846,313 @@ public:
      */
     void subscribe_on_new_system(const NewSystemCallback& callback);
 
+    /**
+     * @brief Statistics of the queue of user callbacks.
+     *
+     * With multiple callback threads, these are summed up across all threads.
+     */
+    struct CallbackQueueStats {
+        std::size_t depth{0}; /**< @brief Number of callbacks currently queued. */
+        std::size_t max_depth{0}; /**< @brief Highest number of callbacks queued at once. */
+        uint64_t processed{0}; /**< @brief Number of callbacks called so far. */
+        uint64_t dropped{0}; /**< @brief Number of callbacks dropped because of overflow. */
+    };
+
+    /**
+     * @brief Get statistics of the queue of user callbacks.
+     *
+     * This can be used to check whether user callbacks are too slow to keep up.
+     *
+     * @return Current statistics.
+     */
+    CallbackQueueStats callback_queue_stats() const;
+
+    /**
+     * @brief Summary of a latency histogram.
+     *
+     * Percentiles are accurate to about 12.5%.
+     */
+    struct LatencyStats {
+        uint64_t count{0}; /**< @brief Number of samples recorded. */
+        uint64_t p50_ns{0}; /**< @brief Median in nanoseconds. */
+        uint64_t p99_ns{0}; /**< @brief 99th percentile in nanoseconds. */
+        uint64_t max_ns{0}; /**< @brief Maximum in nanoseconds. */
+    };
+
+    /**
+     * @brief Latency of the messages of one message ID on their way to the user callbacks.
+     *
+     * All latencies are measured from when the connection received the message.
+     */
+    struct MessageLatencyStats {
+        uint32_t message_id{0}; /**< @brief MAVLink message ID. */
+        LatencyStats dispatch{}; /**< @brief Until MAVSDK's own handlers are done. */
+        LatencyStats queue_wait{}; /**< @brief From queueing until a user callback starts. */
+        LatencyStats callback{}; /**< @brief Until a user callback starts. */
+    };
+
+    /**
+     * @brief Get latency statistics of the received messages, by message ID.
+     *
+     * This can be used to find out where latency spikes come from. Callbacks
+     * which can't be attributed to a received message are not included.
+     *
+     * Nothing is collected unless enabled with
+     * `Configuration::set_message_latency_stats`.
+     *
+     * @return Statistics for each message ID received so far, ordered by message ID.
+     */
+    std::vector<MessageLatencyStats> message_latency_stats() const;
+
+    /**
+     * @brief Reset the message latency statistics.
+     */
+    void reset_message_latency_stats();
+
+    /**
+     * @brief How long the user callbacks queued from one place in MAVSDK took to run.
+     */
+    struct CallbackDurationStats {
+        std::string filename{}; /**< @brief Source file the callback was queued from. */
+        int linenumber{0}; /**< @brief Line the callback was queued from. */
+        LatencyStats duration{}; /**< @brief Time the callbacks took to run. */
+    };
+
+    /**
+     * @brief Enable or disable recording how long user callbacks take to run.
+     *
+     * This is off by default, as it costs a little for every callback.
+     *
+     * @param enabled Whether to record the durations.
+     */
+    void enable_callback_duration_stats(bool enabled);
+
+    /**
+     * @brief Get how long user callbacks took to run, by the place they were queued from.
+     *
+     * @return Statistics for each place, ordered by file and line.
+     */
+    std::vector<CallbackDurationStats> callback_duration_stats() const;
+
+    /**
+     * @brief Reset the callback duration statistics.
+     */
+    void reset_callback_duration_stats();
+
+    /**
+     * @brief Start recording trace events, dropping those recorded before.
+     *
+     * Trace events follow single messages, commands, mission and FTP
+     * transfers and user callbacks through MAVSDK, so slow paths can be
+     * looked at one by one. The trace is shared by all Mavsdk instances,
+     * and each thread keeps its last few thousand events.
+     *
+     * Nothing is recorded if MAVSDK was built with MAVSDK_TRACING off.
+     */
+    void start_tracing();
+
+    /**
+     * @brief Stop recording trace events, keeping what was recorded.
+     */
+    void stop_tracing();
+
+    /**
+     * @brief Write the trace events recorded since tracing was started.
+     *
+     * The file is in the Trace Event Format (JSON) and can be opened with
+     * https://ui.perfetto.dev or chrome://tracing. Tracing does not need to
+     * be stopped first.
+     *
+     * @param path File to write, overwritten if it exists.
+     * @return true if the file was written.
+     */
+    bool write_trace(const std::string& path) const;
+
+    /**
+     * @brief Heap allocations done in one region of MAVSDK.
+     */
+    struct RegionAllocationStats {
+        std::string region{}; /**< @brief One of "receive", "dispatch", "callback", "send"
+                                 or "other". */
+        uint64_t allocations{0}; /**< @brief Number of allocations. */
+        uint64_t bytes{0}; /**< @brief Number of bytes allocated. */
+    };
+
+    /**
+     * @brief Heap allocations done by one thread.
+     */
+    struct ThreadAllocationStats {
+        uint32_t thread_number{0}; /**< @brief In the order the threads first allocated. */
+        std::vector<RegionAllocationStats> regions{}; /**< @brief Allocations per region. */
+    };
+
+    /**
+     * @brief Heap allocations since the start or the last reset.
+     */
+    struct AllocationStats {
+        bool enabled{false}; /**< @brief Whether allocations are counted at all. */
+        std::vector<RegionAllocationStats> regions{}; /**< @brief Allocations of all threads
+                                                         per region. */
+        std::vector<ThreadAllocationStats> threads{}; /**< @brief Allocations per thread. */
+    };
+
+    /**
+     * @brief Get the number of heap allocations on the way of messages.
+     *
+     * Allocations are counted by where they happen: receiving and parsing
+     * messages, dispatching them, calling user callbacks, and sending. Once
+     * warmed up, none of these should allocate per message. The counts are
+     * shared by all Mavsdk instances.
+     *
+     * Nothing is counted unless MAVSDK was built with
+     * MAVSDK_ALLOCATION_TRACKING on, as it replaces the global operator new.
+     *
+     * @return Allocations counted so far.
+     */
+    AllocationStats allocation_stats() const;
+
+    /**
+     * @brief Reset the allocation statistics.
+     */
+    void reset_allocation_stats();
+
+    /**
+     * @brief Throughput and loss of received messages.
+     *
+     * Rates are averaged over roughly the last second.
+     */
+    struct LinkStats {
+        uint64_t bytes_received{0}; /**< @brief Number of bytes received. */
+        double bytes_per_s{0.0}; /**< @brief Bytes received per second. */
+        uint64_t messages_received{0}; /**< @brief Number of messages received. */
+        double messages_per_s{0.0}; /**< @brief Messages received per second. */
+        uint64_t messages_lost{0}; /**< @brief Number of messages missing in the sequence. */
+        double loss_rate{0.0}; /**< @brief Share of messages lost, from 0 to 1. */
+    };
+
+    /**
+     * @brief Link statistics of one remote system on a connection.
+     *
+     * The bytes only count the messages of this system.
+     */
+    struct SystemLinkStats {
+        uint8_t system_id{0}; /**< @brief System ID of the remote system. */
+        LinkStats link{}; /**< @brief Statistics of the messages from this system. */
+    };
+
+    /**
+     * @brief Link statistics of one connection.
+     */
+    struct ConnectionStats {
+        std::size_t connection_index{0}; /**< @brief Index in the order connections were added. */
+        LinkStats link{}; /**< @brief Statistics of everything received on the connection. */
+        uint64_t crc_errors{0}; /**< @brief Number of frames with a bad checksum. */
+        uint64_t bad_lengths{0}; /**< @brief Number of frames with an invalid length. */
+        uint64_t parse_errors{0}; /**< @brief Number of frames rejected for other reasons. */
+        uint64_t signature_errors{0}; /**< @brief Messages dropped for their signature. */
+        uint64_t duplicates{0}; /**< @brief Messages dropped with link bonding, as they
+                                   arrived over another connection first. */
+        double lag_s{0.0}; /**< @brief With link bonding, how much later messages arrive
+                              than over the fastest connection, on average. */
+        LatencyStats read_to_dispatch{}; /**< @brief From reading a message off the
+                                            connection until MAVSDK took it over. */
+        std::size_t send_queued_bytes{0}; /**< @brief Bytes waiting in the send queue. */
+        uint64_t send_would_block{0}; /**< @brief Messages dropped as the send queue
+                                         was full. */
+        std::vector<SystemLinkStats> systems{}; /**< @brief Statistics per remote system. */
+    };
+
+    /**
+     * @brief Get link statistics of all connections.
+     *
+     * This is cheap enough to be polled regularly, e.g. to adapt message rates
+     * to the link quality.
+     *
+     * @return Statistics of each connection, in the order the connections were added.
+     */
+    std::vector<ConnectionStats> connection_stats() const;
+
+    /**
+     * @brief Change of the congestion of a connection's send queue.
+     */
+    struct SendCongestion {
+        std::size_t connection_index{0}; /**< @brief Index in the order connections were
+                                            added. */
+        bool congested{false}; /**< @brief Whether the send queue is congested. */
+        std::size_t queued_bytes{0}; /**< @brief Bytes waiting in the send queue. */
+    };
+
+    /**
+     * @brief Callback type for send congestion changes.
+     */
+    using SendCongestionCallback = std::function<void(SendCongestion)>;
+
+    /**
+     * @brief Get notified when the send queue of a connection gets congested or clears.
+     *
+     * A send queue counts as congested from when it is 3/4 full until it
+     * drained to 1/4, see `Configuration::set_send_queue_bytes`. Producers of
+     * high-rate messages such as setpoints can lower their rate meanwhile.
+     *
+     * @note Only one subscriber is possible at any time. On a second
+     * subscription, the previous one is overwritten. To unsubscribe, pass nullptr;
+     *
+     * @param callback Callback to subscribe.
+     */
+    void subscribe_send_congestion(const SendCongestionCallback& callback);
+
+    /**
+     * @brief Check whether the send queue of any connection is congested.
+     *
+     * This is cheap enough to be checked before every message sent.
+     *
+     * @return true if sending would likely drop messages or block.
+     */
+    bool is_send_congested() const;
+
+    /**
+     * @brief Threads shared by several Mavsdk instances of one process.
+     *
+     * Each Mavsdk instance starts a timer thread, callback threads and
+     * worker threads of its own. Tools which create many instances, e.g. one
+     * per vehicle, can create one runtime and set it in the configuration of
+     * each instance instead, see `Configuration::set_runtime`, so the number
+     * of threads and wakeups doesn't grow with the number of instances.
+     *
+     * Callbacks of the same instance keep the ordering set in their
+     * configuration, callbacks of different instances may run concurrently
+     * if the runtime has more than one callback thread.
+     *
+     * The runtime needs to outlive the instances using it, which is taken
+     * care of by them holding on to it.
+     */
+    class Runtime {
+    public:
+        /**
+         * @brief Constructor.
+         *
+         * The number of callback threads, the thread settings and the thread
+         * name prefix are taken from the configuration, everything else of it
+         * is not used.
+         *
+         * @param configuration Configuration to take the thread setup from.
+         */
+        explicit Runtime(const Configuration& configuration);
+
+        /**
+         * @brief Destructor.
+         */
+        ~Runtime();
+
+        // Non-copyable
+        Runtime(const Runtime&) = delete;
+        const Runtime& operator=(const Runtime&) = delete;
+
+    private:
+        friend class MavsdkImpl;
+        std::shared_ptr<RuntimeImpl> _impl{};
+    };
+
 private:
     /* @private. */
     std::shared_ptr<MavsdkImpl> _impl{};
@@ -0,0 +1,62 @@
+#pragma once
+
+namespace mavsdk {
+
+/**
+ * @brief Options to thin out updates of a subscription.
+ *
+ * Updates which are filtered out are dropped before they are queued for the
+ * callback, so a slow subscriber does not cost anything for the updates it
+ * doesn't want.
+ */
+struct SubscriptionOptions {
+    /**
+     * @brief Maximum rate at which the callback is called, 0 for no limit.
+     */
+    double max_rate_hz{0.0};
+
+    /**
+     * @brief Only pass on every n-th update, 1 to pass on all of them.
+     */
+    unsigned decimation{1};
+
+    /**
+     * @brief Latest value wins: while an update is still waiting to be
+     * delivered, newer updates replace it instead of being queued as well.
+     */
+    bool coalesce{false};
+
+    /**
+     * @brief Only pass on updates which differ from the last one passed on,
+     * e.g. for states such as armed or flight mode which are repeated with
+     * every heartbeat.
+     */
+    bool on_change{false};
+
+    /**
+     * @brief With on_change, still pass on an unchanged update once this long
+     * after the last one, 0 to never repeat it.
+     */
+    double keep_alive_s{0.0};
+};
+
+/**
+ * @brief Options for subscriptions delivering updates in batches.
+ *
+ * Samples are collected and handed to the callback together, so a high-rate
+ * stream costs one queued callback per batch instead of one per sample.
+ */
+struct BatchOptions {
+    /**
+     * @brief Deliver the batch once it holds this many samples.
+     */
+    unsigned max_samples{50};
+
+    /**
+     * @brief Deliver the batch at the latest this long after its first
+     * sample, 0 to only deliver full batches.
+     */
+    double max_latency_s{0.1};
+};
+
+} // namespace mavsdk
@@ -2,7 +2,11 @@
 
 #include <memory>
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <optional>
+#include <string>
 #include <vector>
 
 #include "deprecated.h"
@@ -139,6 +143,41 @@ public:
      */
     void subscribe_is_connected(IsConnectedCallback callback);
 
+    /**
+     * @brief Timing of one of the requests made when a system is connected.
+     */
+    struct StartupStep {
+        std::string name{}; /**< @brief What is requested, e.g. "autopilot version". */
+        double queued_s{0.0}; /**< @brief Time from connecting until the request was sent. */
+        double duration_s{0.0}; /**< @brief Time from sending the request until it was done. */
+        bool success{false}; /**< @brief False if it failed or timed out. */
+    };
+
+    /**
+     * @brief What happened between connecting and being ready.
+     */
+    struct Ready {
+        double time_to_ready_s{0.0}; /**< @brief Time from connecting until all steps were done. */
+        std::vector<StartupStep> steps{}; /**< @brief The steps done since connecting. */
+    };
+
+    /**
+     * @brief type for ready callback.
+     */
+    using ReadyCallback = std::function<void(const Ready&)>;
+
+    /**
+     * @brief Subscribe to callback to be called when the system is ready.
+     *
+     * Once connected, the core and the plugins request what they need from the system, e.g. the
+     * autopilot version or the gimbal protocol, a few at a time. The system is ready once all of
+     * these requests are done. Plugins created later make requests of their own, after which the
+     * callback is called again.
+     *
+     * @param callback Callback which will be called.
+     */
+    void subscribe_ready(ReadyCallback callback);
+
     /**
      * @brief Component Types
      */
@@ -175,6 +214,21 @@ public:
      */
     void enable_timesync();
 
+    /**
+     * @brief Convert a timestamp of the system to local monotonic time.
+     *
+     * This uses a model of the remote clock, offset and drift, which is estimated from the
+     * TIMESYNC round trips enabled with `enable_timesync()`. It takes a few seconds to sync.
+     *
+     * Remote timestamps are the time since boot as in the `time_usec` or `time_boot_ms` fields
+     * of MAVLink messages. Local time is `std::chrono::steady_clock`, the clock of the receive
+     * times in `Telemetry::Snapshot`.
+     *
+     * @param remote_us Timestamp of the system in microseconds.
+     * @return Local time in microseconds, empty while the clock model is not synced.
+     */
+    std::optional<uint64_t> to_local_time(uint64_t remote_us) const;
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
@@ -251,6 +305,97 @@ public:
      */
     AutopilotVersion get_autopilot_version_data();
 
+    /**
+     * @brief Approximate memory used for this system, by component.
+     *
+     * Object sizes plus what the larger containers have allocated. Mission transfer and FTP are
+     * only created once used, and count as 0 before.
+     */
+    struct MemoryStats {
+        std::size_t parameters_bytes{0}; /**< @brief Parameter client and server. */
+        std::size_t command_bytes{0}; /**< @brief Command sender and receiver. */
+        std::size_t mission_transfer_bytes{0}; /**< @brief Mission transfer, if used. */
+        std::size_t ftp_bytes{0}; /**< @brief MAVLink FTP, if used. */
+        std::size_t timesync_bytes{0}; /**< @brief Time synchronization. */
+        std::size_t ping_bytes{0}; /**< @brief Ping. */
+        std::size_t message_handler_bytes{0}; /**< @brief Registered message handlers. */
+        std::size_t other_bytes{0}; /**< @brief Everything else of the system. */
+        std::size_t total_bytes{0}; /**< @brief Sum of all of the above. */
+    };
+
+    /**
+     * @brief Get the approximate memory used for this system.
+     *
+     * @return Bytes by component.
+     */
+    MemoryStats memory_stats() const;
+
+    /**
+     * @brief Requests which plugins repeat in the background, e.g. until a component answers.
+     */
+    struct BackgroundRequestStats {
+        uint64_t requests{0}; /**< @brief Requests sent so far. */
+        double rate_hz{0.0}; /**< @brief Requests per second over the last minute. */
+    };
+
+    /**
+     * @brief Get how many requests plugins send in the background for this system.
+     *
+     * @return Number and current rate of the requests.
+     */
+    BackgroundRequestStats background_request_stats() const;
+
+    /**
+     * @brief Rate at which a message arrives from this system, and the rate requested.
+     */
+    struct MessageRate {
+        uint8_t component_id{0}; /**< @brief Component sending the message. */
+        uint32_t message_id{0}; /**< @brief MAVLink message ID. */
+        uint64_t messages{0}; /**< @brief Messages received so far. */
+        double rate_hz{0.0}; /**< @brief Smoothed rate, decaying once messages stop. */
+        double jitter_s{0.0}; /**< @brief Mean deviation of the time between messages. */
+        bool rate_requested{false}; /**< @brief Whether a rate was requested by MAVSDK. */
+        double requested_rate_hz{0.0}; /**< @brief Requested rate, 0 for the default rate
+                                          and negative for stopped. */
+    };
+
+    /**
+     * @brief Get the rates at which messages arrive, to compare with the requested rates.
+     *
+     * Rates are measured when the messages are received, before they are
+     * dispatched. This can be used to find out what the link actually
+     * delivers and to adjust the requested rates to it.
+     *
+     * @return Rates by component and message ID, ordered by those.
+     */
+    std::vector<MessageRate> message_rates() const;
+
+    /**
+     * @brief Time spent in the handlers of received messages of one plugin or part of MAVSDK.
+     */
+    struct MessageHandlerStats {
+        std::string owner{}; /**< @brief E.g. "TelemetryImpl", or "other" for the rest. */
+        uint64_t invocations{0}; /**< @brief Handlers called so far. */
+        double total_s{0.0}; /**< @brief Time spent in them, including decoding. */
+        double max_s{0.0}; /**< @brief Longest a single handler took. */
+    };
+
+    /**
+     * @brief Get how much time the handlers of received messages took, by owner.
+     *
+     * This can be used to find out which plugin slows down receiving when
+     * messages start to lag. Handlers are timed with the CPU's counter where
+     * available, so this is always on.
+     *
+     * @return Statistics for each owner with handlers called so far, ordered by name.
+     */
+    std::vector<MessageHandlerStats> message_handler_stats() const;
+
+    /**
+     * @brief Reset the message handler statistics.
+     */
+    void reset_message_handler_stats();
+
 private:
     std::shared_ptr<SystemImpl> system_impl() { return _system_impl; };
 
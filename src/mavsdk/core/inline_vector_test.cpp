@@ -0,0 +1,52 @@
+#include "inline_vector.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(InlineVector, AppendsUpToCapacity)
+{
+    InlineVector<float, 3> vector;
+    EXPECT_TRUE(vector.empty());
+
+    for (int i = 0; i < 5; ++i) {
+        vector.push_back(static_cast<float>(i));
+    }
+
+    ASSERT_EQ(vector.size(), 3);
+    EXPECT_FLOAT_EQ(vector.front(), 0.0f);
+    EXPECT_FLOAT_EQ(vector.back(), 2.0f);
+}
+
+TEST(InlineVector, IteratesOverElements)
+{
+    const InlineVector<int, 8> vector{1, 2, 3};
+
+    int sum = 0;
+    for (const auto element : vector) {
+        sum += element;
+    }
+    EXPECT_EQ(sum, 6);
+    EXPECT_EQ(vector.end() - vector.begin(), 3);
+}
+
+TEST(InlineVector, ComparesElementsOnly)
+{
+    InlineVector<int, 4> lhs{1, 2};
+    InlineVector<int, 4> rhs{1, 2, 3};
+    EXPECT_NE(lhs, rhs);
+
+    rhs.resize(2);
+    EXPECT_EQ(lhs, rhs);
+
+    rhs.clear();
+    EXPECT_TRUE(rhs.empty());
+}
+
+TEST(InlineVector, ConvertsToAndFromStdVector)
+{
+    const std::vector<float> original{0.5f, 0.25f};
+    const InlineVector<float, 21> vector = original;
+    const std::vector<float> converted = vector;
+
+    EXPECT_EQ(converted, original);
+}
@@ -0,0 +1,261 @@
+#include "io_reactor.h"
+
+#if defined(LINUX)
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "log.h"
+
+namespace mavsdk {
+
+IoReactor& IoReactor::instance()
+{
+    static IoReactor reactor;
+    return reactor;
+}
+
+IoReactor::IoReactor()
+{
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd == -1) {
+        LogErr() << "epoll_create1 failed: " << strerror(errno);
+    }
+
+    _wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (_wakeup_fd == -1) {
+        LogErr() << "eventfd failed: " << strerror(errno);
+    }
+
+    // Handle 0 is never handed out, so we use it for the wakeup fd.
+    struct epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.u64 = 0;
+    epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _wakeup_fd, &event);
+
+    _thread = std::thread(&IoReactor::run, this);
+}
+
+IoReactor::~IoReactor()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_exit = true;
+    }
+    wake_up();
+    _thread.join();
+
+    close(_wakeup_fd);
+    close(_epoll_fd);
+}
+
+IoReactor::Handle IoReactor::add_fd(int fd, unsigned events, FdCallback callback)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const Handle handle = _next_handle++;
+
+    struct epoll_event event {};
+    event.events = ((events & Readable) ? EPOLLIN : 0u) | ((events & Writable) ? EPOLLOUT : 0u);
+    event.data.u64 = handle;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        LogErr() << "epoll_ctl failed: " << strerror(errno);
+        return 0;
+    }
+
+    auto entry = std::make_shared<Entry>();
+    entry->fd = fd;
+    entry->fd_callback = std::move(callback);
+    _entries[handle] = std::move(entry);
+    return handle;
+}
+
+IoReactor::Handle IoReactor::add_timer(double delay_s, TimerCallback callback)
+{
+    Handle handle;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        handle = _next_handle++;
+
+        auto entry = std::make_shared<Entry>();
+        entry->timer_callback = std::move(callback);
+        entry->due = _time.steady_time_in_future(delay_s);
+        _entries[handle] = std::move(entry);
+    }
+
+    // The reactor might need to wake up earlier than planned.
+    wake_up();
+    return handle;
+}
+
+bool IoReactor::modify(Handle handle, unsigned events)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _entries.find(handle);
+    if (it == _entries.end() || it->second->fd == -1) {
+        return false;
+    }
+
+    struct epoll_event event {};
+    event.events = ((events & Readable) ? EPOLLIN : 0u) | ((events & Writable) ? EPOLLOUT : 0u);
+    event.data.u64 = handle;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, it->second->fd, &event) != 0) {
+        LogErr() << "epoll_ctl failed: " << strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+void IoReactor::remove(Handle handle)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto it = _entries.find(handle);
+    if (it != _entries.end()) {
+        if (it->second->fd != -1) {
+            epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, it->second->fd, nullptr);
+        }
+        _entries.erase(it);
+    }
+
+    if (std::this_thread::get_id() != _thread.get_id()) {
+        _not_running_cv.wait(lock, [&]() { return _running != handle; });
+    }
+}
+
+void IoReactor::wake_up()
+{
+    const uint64_t value = 1;
+    if (write(_wakeup_fd, &value, sizeof(value)) < 0) {
+        // Already signalled, nothing to do.
+    }
+}
+
+void IoReactor::run()
+{
+    std::vector<struct epoll_event> events(64);
+
+    while (true) {
+        const int timeout_ms = next_timeout_ms();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_should_exit) {
+                break;
+            }
+        }
+
+        const int num =
+            epoll_wait(_epoll_fd, events.data(), static_cast<int>(events.size()), timeout_ms);
+
+        if (num < 0 && errno != EINTR) {
+            LogErr() << "epoll_wait failed: " << strerror(errno);
+        }
+
+        for (int i = 0; i < num; ++i) {
+            const Handle handle = events[i].data.u64;
+            if (handle == 0) {
+                uint64_t value;
+                while (read(_wakeup_fd, &value, sizeof(value)) > 0) {
+                }
+                continue;
+            }
+
+            unsigned flags = 0;
+            if (events[i].events & EPOLLIN) {
+                flags |= Readable;
+            }
+            if (events[i].events & EPOLLOUT) {
+                flags |= Writable;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                flags |= Error;
+            }
+            run_entry(handle, flags);
+        }
+
+        run_due_timers();
+    }
+}
+
+int IoReactor::next_timeout_ms()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    bool any_timer = false;
+    dl_time_t next_due{};
+    for (const auto& [handle, entry] : _entries) {
+        if (entry->timer_callback && (!any_timer || entry->due < next_due)) {
+            next_due = entry->due;
+            any_timer = true;
+        }
+    }
+
+    if (!any_timer) {
+        return -1;
+    }
+
+    const double remaining_s = -_time.elapsed_since_s(next_due);
+    if (remaining_s <= 0.0) {
+        return 0;
+    }
+    return static_cast<int>(std::ceil(remaining_s * 1e3));
+}
+
+void IoReactor::run_entry(Handle handle, unsigned events)
+{
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(handle);
+        if (it == _entries.end()) {
+            // Removed in the meantime.
+            return;
+        }
+        entry = it->second;
+        _running = handle;
+    }
+
+    if (entry->fd_callback) {
+        entry->fd_callback(events);
+    } else if (entry->timer_callback) {
+        entry->timer_callback();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = 0;
+    }
+    _not_running_cv.notify_all();
+}
+
+void IoReactor::run_due_timers()
+{
+    std::vector<Handle> due_handles;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const dl_time_t now = _time.steady_time();
+        for (const auto& [handle, entry] : _entries) {
+            if (entry->timer_callback && entry->due <= now) {
+                due_handles.push_back(handle);
+            }
+        }
+    }
+
+    // Timers are one-shot.
+    std::sort(due_handles.begin(), due_handles.end());
+    for (const Handle handle : due_handles) {
+        run_entry(handle, 0);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.erase(handle);
+    }
+}
+
+} // namespace mavsdk
+
+#endif
@@ -0,0 +1,91 @@
+#pragma once
+
+#if defined(LINUX)
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include "mavsdk_time.h"
+
+namespace mavsdk {
+
+// One thread multiplexing the file descriptors of all connections using
+// epoll, so the number of threads stays the same no matter how many
+// connections are added. It also runs one-shot timers, e.g. for reconnects.
+//
+// Callbacks run on the reactor thread and need to return quickly, they must
+// never block.
+class IoReactor {
+public:
+    using Handle = uint64_t;
+    using FdCallback = std::function<void(unsigned events)>;
+    using TimerCallback = std::function<void()>;
+
+    enum Events : unsigned {
+        Readable = 1 << 0,
+        Writable = 1 << 1,
+        // Always reported, no need to ask for them.
+        Error = 1 << 2,
+    };
+
+    // Shared by all connections of the process, started on first use.
+    static IoReactor& instance();
+
+    // Returns 0 if the fd could not be added.
+    Handle add_fd(int fd, unsigned events, FdCallback callback);
+
+    Handle add_timer(double delay_s, TimerCallback callback);
+
+    // Changes the events an fd is watched for, e.g. to be told once a socket
+    // can take more data. Does not wait for the callback, so it is fine to
+    // call while holding a lock the callback takes.
+    bool modify(Handle handle, unsigned events);
+
+    // Once this returns, the callback is not running and is not called
+    // anymore. When called from within a callback, it only prevents
+    // further calls.
+    void remove(Handle handle);
+
+    // Non-copyable
+    IoReactor(const IoReactor&) = delete;
+    const IoReactor& operator=(const IoReactor&) = delete;
+
+private:
+    IoReactor();
+    ~IoReactor();
+
+    struct Entry {
+        int fd{-1};
+        FdCallback fd_callback{};
+        TimerCallback timer_callback{};
+        dl_time_t due{};
+    };
+
+    void run();
+    void wake_up();
+    int next_timeout_ms();
+    void run_entry(Handle handle, unsigned events);
+    void run_due_timers();
+
+    Time _time{};
+
+    int _epoll_fd{-1};
+    int _wakeup_fd{-1};
+
+    std::mutex _mutex{};
+    std::condition_variable _not_running_cv{};
+    std::unordered_map<Handle, std::shared_ptr<Entry>> _entries{};
+    Handle _next_handle{1};
+    Handle _running{0};
+    bool _should_exit{false};
+
+    std::thread _thread{};
+};
+
+} // namespace mavsdk
+
+#endif
@@ -0,0 +1,92 @@
+#if defined(LINUX)
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "io_reactor.h"
+
+using namespace mavsdk;
+
+TEST(IoReactor, CallsBackWhenReadable)
+{
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+
+    std::promise<char> prom;
+    auto fut = prom.get_future();
+
+    auto handle = IoReactor::instance().add_fd(fds[0], IoReactor::Readable, [&](unsigned events) {
+        EXPECT_TRUE(events & IoReactor::Readable);
+        char c;
+        ASSERT_EQ(read(fds[0], &c, 1), 1);
+        prom.set_value(c);
+    });
+    ASSERT_NE(handle, 0);
+
+    ASSERT_EQ(write(fds[1], "x", 1), 1);
+    ASSERT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    EXPECT_EQ(fut.get(), 'x');
+
+    IoReactor::instance().remove(handle);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(IoReactor, ModifyAddsWritable)
+{
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+
+    std::atomic<bool> writable{false};
+    auto handle = IoReactor::instance().add_fd(fds[1], IoReactor::Readable, [&](unsigned events) {
+        if (events & IoReactor::Writable) {
+            writable = true;
+        }
+    });
+    ASSERT_NE(handle, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(writable);
+
+    EXPECT_TRUE(IoReactor::instance().modify(handle, IoReactor::Writable));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_TRUE(writable);
+
+    IoReactor::instance().remove(handle);
+    EXPECT_FALSE(IoReactor::instance().modify(handle, IoReactor::Readable));
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(IoReactor, TimerFiresOnce)
+{
+    std::atomic<int> fired{0};
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+
+    IoReactor::instance().add_timer(0.01, [&]() {
+        if (++fired == 1) {
+            prom.set_value();
+        }
+    });
+
+    ASSERT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(fired, 1);
+}
+
+TEST(IoReactor, RemovedTimerDoesNotFire)
+{
+    std::atomic<bool> fired{false};
+
+    auto handle = IoReactor::instance().add_timer(0.05, [&]() { fired = true; });
+    IoReactor::instance().remove(handle);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(fired);
+}
+
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include "seqlock.h"
+
+namespace mavsdk {
+
+// Keeps the latest raw message and only converts it when it is asked for.
+//
+// Storing a message is a plain copy into a seqlock, so the receive path
+// neither converts nor allocates. The converted value is cached together
+// with the sequence number of the message it came from, so it is converted
+// at most once per message no matter how often it is read.
+template<typename Raw, typename T> class LazyDecoder {
+public:
+    using Convert = T (*)(const Raw&);
+
+    explicit LazyDecoder(Convert convert) : _convert(convert) {}
+
+    ~LazyDecoder() = default;
+
+    // Non-copyable
+    LazyDecoder(const LazyDecoder&) = delete;
+    const LazyDecoder& operator=(const LazyDecoder&) = delete;
+
+    void store(const Raw& raw)
+    {
+        _raw.update([&](Entry& entry) {
+            entry.raw = raw;
+            ++entry.sequence;
+        });
+    }
+
+    [[nodiscard]] T get() const
+    {
+        const Entry entry = _raw.load();
+
+        std::lock_guard<std::mutex> lock(_cache_mutex);
+        if (_cached_sequence != entry.sequence) {
+            _cached = _convert(entry.raw);
+            _cached_sequence = entry.sequence;
+        }
+        return _cached;
+    }
+
+    // Number of messages stored so far, 0 if none was stored yet.
+    [[nodiscard]] uint64_t sequence() const { return _raw.load().sequence; }
+
+private:
+    struct Entry {
+        Raw raw;
+        uint64_t sequence;
+    };
+
+    const Convert _convert;
+    Seqlock<Entry> _raw{Entry{Raw{}, 0}};
+
+    mutable std::mutex _cache_mutex{};
+    mutable T _cached{};
+    mutable uint64_t _cached_sequence{0};
+};
+
+} // namespace mavsdk
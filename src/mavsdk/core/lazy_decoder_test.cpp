@@ -0,0 +1,60 @@
+#include "lazy_decoder.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace mavsdk;
+
+namespace {
+struct RawValue {
+    int32_t value;
+};
+
+int conversions = 0;
+
+std::string convert(const RawValue& raw)
+{
+    ++conversions;
+    return std::to_string(raw.value);
+}
+} // namespace
+
+TEST(LazyDecoder, DefaultBeforeFirstStore)
+{
+    conversions = 0;
+    LazyDecoder<RawValue, std::string> decoder{convert};
+
+    EXPECT_EQ(decoder.sequence(), 0);
+    EXPECT_EQ(decoder.get(), "");
+    EXPECT_EQ(conversions, 0);
+}
+
+TEST(LazyDecoder, ConvertsOnlyWhenRead)
+{
+    conversions = 0;
+    LazyDecoder<RawValue, std::string> decoder{convert};
+
+    decoder.store(RawValue{1});
+    decoder.store(RawValue{2});
+    decoder.store(RawValue{3});
+    EXPECT_EQ(decoder.sequence(), 3);
+    EXPECT_EQ(conversions, 0);
+
+    EXPECT_EQ(decoder.get(), "3");
+    EXPECT_EQ(conversions, 1);
+}
+
+TEST(LazyDecoder, CachesPerMessage)
+{
+    conversions = 0;
+    LazyDecoder<RawValue, std::string> decoder{convert};
+
+    decoder.store(RawValue{42});
+    EXPECT_EQ(decoder.get(), "42");
+    EXPECT_EQ(decoder.get(), "42");
+    EXPECT_EQ(conversions, 1);
+
+    // The same value again is still a new message.
+    decoder.store(RawValue{42});
+    EXPECT_EQ(decoder.get(), "42");
+    EXPECT_EQ(conversions, 2);
+}
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
 #include <memory>
 #include <mutex>
 
@@ -7,25 +11,59 @@
 
 namespace mavsdk::mavsdk_server {
 
+// Creates the plugin for a system the first time it is used. One server can
+// serve several systems this way, each with its own plugin instance.
 template<typename Plugin> class LazyPlugin {
 public:
     explicit LazyPlugin(Mavsdk& mavsdk) : _mavsdk(mavsdk) {}
 
-    Plugin* maybe_plugin()
+    // A system_id of 0 selects the first discovered system. IDs outside of
+    // 0..255 never match a system.
+    //
+    // Once a plugin exists it is published through an atomic pointer, so the
+    // steady state is a single acquire load without locking or copying systems.
+    Plugin* maybe_plugin(int system_id = 0)
     {
+        if (system_id < 0 || system_id > 255) {
+            return nullptr;
+        }
+
+        auto& published = _published[system_id];
+        if (auto* plugin = published.load(std::memory_order_acquire)) {
+            return plugin;
+        }
+
         std::lock_guard<std::mutex> lock(_mutex);
-        if (_plugin == nullptr) {
-            if (_mavsdk.systems().empty()) {
-                return nullptr;
+        if (auto* plugin = published.load(std::memory_order_relaxed)) {
+            return plugin;
+        }
+
+        for (auto& system : _mavsdk.systems()) {
+            if (system_id == 0 || system->get_system_id() == system_id) {
+                auto* plugin = plugin_for(system);
+                published.store(plugin, std::memory_order_release);
+                return plugin;
             }
-            _plugin = std::make_unique<Plugin>(_mavsdk.systems()[0]);
         }
-        return _plugin.get();
+        return nullptr;
     }
 
 private:
+    // Assumes to have the lock for _mutex.
+    Plugin* plugin_for(const std::shared_ptr<System>& system)
+    {
+        auto& plugin = _plugins[system->get_system_id()];
+        if (plugin == nullptr) {
+            plugin = std::make_unique<Plugin>(system);
+            _published[system->get_system_id()].store(plugin.get(), std::memory_order_release);
+        }
+        return plugin.get();
+    }
+
     Mavsdk& _mavsdk;
-    std::unique_ptr<Plugin> _plugin{};
+    std::map<uint8_t, std::unique_ptr<Plugin>> _plugins{};
+    // Index 0 is the first discovered system, the others are system IDs.
+    std::array<std::atomic<Plugin*>, 256> _published{};
     std::mutex _mutex{};
 };
 
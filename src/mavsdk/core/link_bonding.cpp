@@ -0,0 +1,176 @@
+#include "link_bonding.h"
+#include "mavlink_include.h"
+#include "route_table.h"
+
+namespace mavsdk {
+
+namespace {
+
+// Weight of a new lag sample in the moving average.
+constexpr double LAG_SMOOTHING = 1.0 / 16.0;
+
+// A connection losing 10% of the messages is as bad as one lagging 100 ms.
+constexpr double LOSS_PENALTY_S = 1.0;
+
+bool is_valid(int route_index)
+{
+    return route_index >= 0 && route_index < RouteTable::MAX_ROUTE_INDICES;
+}
+
+} // namespace
+
+LinkBonding::LinkBonding(Mode mode) : _mode(mode) {}
+
+bool LinkBonding::accept(
+    uint8_t system_id, uint8_t component_id, uint8_t sequence, int route_index, uint64_t now_ns)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const auto key = static_cast<uint16_t>((system_id << 8) | component_id);
+    const auto slot = sequence % WINDOW_SIZE;
+
+    auto found = _windows.find(key);
+    if (found == _windows.end()) {
+        auto& window = _windows[key];
+        window.last_sequence = sequence;
+        window.seen = 1;
+        window.first_seen_ns[slot] = now_ns;
+        record_lag(route_index, 0);
+        return true;
+    }
+
+    auto& window = found->second;
+    const auto ahead = static_cast<int8_t>(static_cast<uint8_t>(sequence - window.last_sequence));
+
+    if (ahead > 0) {
+        // Newer than anything seen so far, the window moves on.
+        window.seen = (static_cast<unsigned>(ahead) < WINDOW_SIZE) ? (window.seen << ahead) : 0;
+        window.seen |= 1;
+        window.last_sequence = sequence;
+        window.first_seen_ns[slot] = now_ns;
+        record_lag(route_index, 0);
+        return true;
+    }
+
+    const auto behind = static_cast<unsigned>(-ahead);
+    if (behind >= WINDOW_SIZE) {
+        // Too far back to be a copy, the sender probably restarted.
+        window.seen = 1;
+        window.last_sequence = sequence;
+        window.first_seen_ns[slot] = now_ns;
+        record_lag(route_index, 0);
+        return true;
+    }
+
+    const uint64_t bit = 1ULL << behind;
+    if ((window.seen & bit) != 0) {
+        record_lag(route_index, now_ns - window.first_seen_ns[slot]);
+        if (is_valid(route_index)) {
+            _links[route_index].duplicates.fetch_add(1, std::memory_order_relaxed);
+        }
+        return false;
+    }
+
+    // Arrived out of order, but it's the first copy.
+    window.seen |= bit;
+    window.first_seen_ns[slot] = now_ns;
+    record_lag(route_index, 0);
+    return true;
+}
+
+void LinkBonding::record_lag(int route_index, uint64_t lag_ns)
+{
+    if (!is_valid(route_index)) {
+        return;
+    }
+
+    // Only called with the mutex held, so there is a single writer.
+    auto& lag_s = _links[route_index].lag_s;
+    const double sample_s = static_cast<double>(lag_ns) * 1e-9;
+    lag_s.store(lag_s.load() + (sample_s - lag_s.load()) * LAG_SMOOTHING);
+}
+
+uint64_t LinkBonding::routes_for_message(uint32_t message_id, uint64_t routes) const
+{
+    // Broadcasts, and systems reached over one connection only, have
+    // nothing to choose from.
+    if (routes == 0 || (routes & (routes - 1)) == 0) {
+        return routes;
+    }
+
+    switch (_mode) {
+        case Mode::BestLink:
+            break;
+        case Mode::ByPriority:
+            if (is_critical(message_id)) {
+                return routes;
+            }
+            break;
+        case Mode::Off:
+        case Mode::AllLinks:
+        default:
+            return routes;
+    }
+
+    int best = -1;
+    double best_score = 0.0;
+    for (int i = 0; i < RouteTable::MAX_ROUTE_INDICES; ++i) {
+        if ((routes & RouteTable::route_bit(i)) == 0) {
+            continue;
+        }
+        const double current_score = score(i);
+        if (best == -1 || current_score < best_score) {
+            best = i;
+            best_score = current_score;
+        }
+    }
+    return RouteTable::route_bit(best);
+}
+
+void LinkBonding::set_loss_rate(int route_index, double loss_rate)
+{
+    if (is_valid(route_index)) {
+        _links[route_index].loss_rate = loss_rate;
+    }
+}
+
+LinkBonding::Quality LinkBonding::quality(int route_index) const
+{
+    Quality quality{};
+    if (is_valid(route_index)) {
+        quality.duplicates = _links[route_index].duplicates;
+        quality.lag_s = _links[route_index].lag_s;
+    }
+    return quality;
+}
+
+double LinkBonding::score(int route_index) const
+{
+    const auto& link = _links[route_index];
+    return link.lag_s + link.loss_rate * LOSS_PENALTY_S;
+}
+
+bool LinkBonding::is_critical(uint32_t message_id)
+{
+    switch (message_id) {
+        case MAVLINK_MSG_ID_COMMAND_LONG:
+        case MAVLINK_MSG_ID_COMMAND_INT:
+        case MAVLINK_MSG_ID_COMMAND_ACK:
+        case MAVLINK_MSG_ID_COMMAND_CANCEL:
+        case MAVLINK_MSG_ID_SET_MODE:
+        case MAVLINK_MSG_ID_MISSION_COUNT:
+        case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+        case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+        case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+        case MAVLINK_MSG_ID_MISSION_ACK:
+        case MAVLINK_MSG_ID_MISSION_CLEAR_ALL:
+        case MAVLINK_MSG_ID_MISSION_SET_CURRENT:
+        case MAVLINK_MSG_ID_PARAM_SET:
+        case MAVLINK_MSG_ID_PARAM_EXT_SET:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include "mavsdk.h"
+
+namespace mavsdk {
+
+// Bonds connections which lead to the same systems, e.g. an LTE link and a
+// radio, into one.
+//
+// Received messages are de-duplicated by their sequence number: we keep a
+// sliding window of the last sequence numbers seen from each sender, and
+// only the first arrival of a sequence number is handled, whichever
+// connection it came over. How much later the copies arrive over the other
+// connections tells how far each connection lags behind the fastest one.
+//
+// Outgoing messages to a system going over several connections are sent
+// over the best one only, depending on the mode. The best connection is the
+// one with the lowest lag, with loss counting as extra lag.
+class LinkBonding {
+public:
+    using Mode = Mavsdk::Configuration::LinkBonding;
+
+    explicit LinkBonding(Mode mode);
+    ~LinkBonding() = default;
+
+    // Non-copyable
+    LinkBonding(const LinkBonding&) = delete;
+    const LinkBonding& operator=(const LinkBonding&) = delete;
+
+    // Returns false if the sequence number was seen from the sender already,
+    // i.e. the message is a copy of one received before.
+    bool accept(
+        uint8_t system_id,
+        uint8_t component_id,
+        uint8_t sequence,
+        int route_index,
+        uint64_t now_ns);
+
+    // Narrows the routes of an outgoing message down to the best one, unless
+    // the mode wants it to go over all of them. 0, meaning all connections,
+    // is kept as is.
+    [[nodiscard]] uint64_t routes_for_message(uint32_t message_id, uint64_t routes) const;
+
+    // Loss as worked out by the LinkStats of the connection.
+    void set_loss_rate(int route_index, double loss_rate);
+
+    struct Quality {
+        uint64_t duplicates{0};
+        double lag_s{0.0};
+    };
+
+    [[nodiscard]] Quality quality(int route_index) const;
+
+    // Messages whose loss is costly, which ByPriority sends over all connections.
+    static bool is_critical(uint32_t message_id);
+
+    // Sequence numbers which are further back are taken as the sender having
+    // restarted, rather than as a copy.
+    static constexpr unsigned WINDOW_SIZE = 64;
+
+private:
+    struct Window {
+        uint8_t last_sequence{0};
+        // Bit n is set if last_sequence - n was seen.
+        uint64_t seen{0};
+        // When the sequence numbers in the window were first seen, by sequence number.
+        std::array<uint64_t, WINDOW_SIZE> first_seen_ns{};
+    };
+
+    struct Link {
+        std::atomic<uint64_t> duplicates{0};
+        std::atomic<double> lag_s{0.0};
+        std::atomic<double> loss_rate{0.0};
+    };
+
+    void record_lag(int route_index, uint64_t lag_ns);
+    [[nodiscard]] double score(int route_index) const;
+
+    const Mode _mode;
+
+    std::mutex _mutex{};
+    std::unordered_map<uint16_t, Window> _windows{};
+
+    std::array<Link, 64> _links{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,125 @@
+#include "link_bonding.h"
+#include "mavlink_include.h"
+#include "route_table.h"
+
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+static constexpr uint64_t ms = 1000000ULL;
+
+TEST(LinkBonding, FirstArrivalWins)
+{
+    LinkBonding bonding(LinkBonding::Mode::BestLink);
+
+    EXPECT_TRUE(bonding.accept(1, 1, 10, 0, 100 * ms));
+    EXPECT_FALSE(bonding.accept(1, 1, 10, 1, 120 * ms));
+    EXPECT_TRUE(bonding.accept(1, 1, 11, 1, 130 * ms));
+    EXPECT_FALSE(bonding.accept(1, 1, 11, 0, 140 * ms));
+
+    // Other senders have their own sequence numbers.
+    EXPECT_TRUE(bonding.accept(1, 100, 10, 1, 150 * ms));
+    EXPECT_TRUE(bonding.accept(2, 1, 10, 1, 150 * ms));
+
+    EXPECT_EQ(bonding.quality(0).duplicates, 1u);
+    EXPECT_EQ(bonding.quality(1).duplicates, 1u);
+}
+
+TEST(LinkBonding, AcceptsOutOfOrderAndWrapAround)
+{
+    LinkBonding bonding(LinkBonding::Mode::BestLink);
+
+    EXPECT_TRUE(bonding.accept(1, 1, 250, 0, 0));
+    EXPECT_TRUE(bonding.accept(1, 1, 253, 0, 0));
+    EXPECT_TRUE(bonding.accept(1, 1, 2, 0, 0));
+    // Late, but not seen before.
+    EXPECT_TRUE(bonding.accept(1, 1, 251, 1, 0));
+    EXPECT_TRUE(bonding.accept(1, 1, 255, 1, 0));
+
+    EXPECT_FALSE(bonding.accept(1, 1, 250, 1, 0));
+    EXPECT_FALSE(bonding.accept(1, 1, 253, 1, 0));
+    EXPECT_FALSE(bonding.accept(1, 1, 2, 1, 0));
+}
+
+TEST(LinkBonding, SenderRestart)
+{
+    LinkBonding bonding(LinkBonding::Mode::BestLink);
+
+    EXPECT_TRUE(bonding.accept(1, 1, 200, 0, 0));
+    EXPECT_TRUE(bonding.accept(1, 1, 201, 0, 0));
+
+    // Way behind the window, so starting over rather than a copy.
+    EXPECT_TRUE(bonding.accept(1, 1, 0, 0, 0));
+    EXPECT_TRUE(bonding.accept(1, 1, 1, 0, 0));
+    EXPECT_FALSE(bonding.accept(1, 1, 1, 1, 0));
+}
+
+TEST(LinkBonding, MeasuresLag)
+{
+    LinkBonding bonding(LinkBonding::Mode::BestLink);
+
+    for (unsigned i = 0; i < 200; ++i) {
+        const auto sequence = static_cast<uint8_t>(i);
+        ASSERT_TRUE(bonding.accept(1, 1, sequence, 0, i * 10 * ms));
+        ASSERT_FALSE(bonding.accept(1, 1, sequence, 1, i * 10 * ms + 50 * ms));
+    }
+
+    EXPECT_NEAR(bonding.quality(0).lag_s, 0.0, 1e-9);
+    EXPECT_NEAR(bonding.quality(1).lag_s, 0.05, 0.001);
+    EXPECT_EQ(bonding.quality(0).duplicates, 0u);
+    EXPECT_EQ(bonding.quality(1).duplicates, 200u);
+}
+
+static void make_route_1_lag(LinkBonding& bonding)
+{
+    for (unsigned i = 0; i < 100; ++i) {
+        const auto sequence = static_cast<uint8_t>(i);
+        bonding.accept(1, 1, sequence, 0, i * 10 * ms);
+        bonding.accept(1, 1, sequence, 1, i * 10 * ms + 50 * ms);
+    }
+}
+
+TEST(LinkBonding, BestLinkPicksLowestLag)
+{
+    LinkBonding bonding(LinkBonding::Mode::BestLink);
+    make_route_1_lag(bonding);
+
+    const uint64_t both = RouteTable::route_bit(0) | RouteTable::route_bit(1);
+    EXPECT_EQ(
+        bonding.routes_for_message(MAVLINK_MSG_ID_HEARTBEAT, both), RouteTable::route_bit(0));
+    EXPECT_EQ(
+        bonding.routes_for_message(MAVLINK_MSG_ID_COMMAND_LONG, both), RouteTable::route_bit(0));
+
+    // Losing a lot of messages makes the faster connection the worse one.
+    bonding.set_loss_rate(0, 0.5);
+    EXPECT_EQ(
+        bonding.routes_for_message(MAVLINK_MSG_ID_HEARTBEAT, both), RouteTable::route_bit(1));
+
+    // Nothing to choose from.
+    EXPECT_EQ(bonding.routes_for_message(MAVLINK_MSG_ID_HEARTBEAT, 0), 0u);
+    EXPECT_EQ(
+        bonding.routes_for_message(MAVLINK_MSG_ID_HEARTBEAT, RouteTable::route_bit(0)),
+        RouteTable::route_bit(0));
+}
+
+TEST(LinkBonding, ByPrioritySendsCriticalOverAll)
+{
+    LinkBonding bonding(LinkBonding::Mode::ByPriority);
+    make_route_1_lag(bonding);
+
+    const uint64_t both = RouteTable::route_bit(0) | RouteTable::route_bit(1);
+    EXPECT_EQ(bonding.routes_for_message(MAVLINK_MSG_ID_COMMAND_LONG, both), both);
+    EXPECT_EQ(bonding.routes_for_message(MAVLINK_MSG_ID_MISSION_ITEM_INT, both), both);
+    EXPECT_EQ(
+        bonding.routes_for_message(MAVLINK_MSG_ID_HEARTBEAT, both), RouteTable::route_bit(0));
+}
+
+TEST(LinkBonding, AllLinksKeepsRoutes)
+{
+    LinkBonding bonding(LinkBonding::Mode::AllLinks);
+    make_route_1_lag(bonding);
+
+    const uint64_t both = RouteTable::route_bit(0) | RouteTable::route_bit(1);
+    EXPECT_EQ(bonding.routes_for_message(MAVLINK_MSG_ID_HEARTBEAT, both), both);
+    EXPECT_EQ(bonding.routes_for_message(MAVLINK_MSG_ID_COMMAND_LONG, both), both);
+}
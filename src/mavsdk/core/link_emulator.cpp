@@ -0,0 +1,199 @@
+#include "link_emulator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include "log.h"
+
+namespace mavsdk {
+
+namespace {
+
+// Held back at least this long, so a reordered message actually ends up
+// behind the next ones even on a link without latency.
+constexpr double MIN_REORDER_DELAY_S = 0.01;
+
+std::size_t index_of(LinkEmulator::Direction direction)
+{
+    return direction == LinkEmulator::Direction::Outgoing ? 0 : 1;
+}
+
+std::mt19937 seeded(uint32_t seed, std::size_t index)
+{
+    std::seed_seq seq{seed, static_cast<uint32_t>(index)};
+    return std::mt19937(seq);
+}
+
+} // namespace
+
+bool LinkEmulator::Config::active() const
+{
+    return rtt_s > 0.0 || jitter_s > 0.0 || loss_probability > 0.0 || reorder_probability > 0.0 ||
+           bytes_per_s > 0.0;
+}
+
+std::optional<LinkEmulator::Config> LinkEmulator::parse(const std::string& spec)
+{
+    Config config;
+
+    std::size_t start = 0;
+    while (start < spec.size()) {
+        auto end = spec.find(',', start);
+        if (end == std::string::npos) {
+            end = spec.size();
+        }
+        const std::string option = spec.substr(start, end - start);
+        start = end + 1;
+
+        const auto colon = option.find(':');
+        if (colon == std::string::npos) {
+            LogWarn() << "Link emulation option without value: " << option;
+            return std::nullopt;
+        }
+        const std::string key = option.substr(0, colon);
+        const std::string value_str = option.substr(colon + 1);
+
+        char* value_end = nullptr;
+        const double value = std::strtod(value_str.c_str(), &value_end);
+        if (value_str.empty() || *value_end != '\0' || !(value >= 0.0)) {
+            LogWarn() << "Invalid link emulation value: " << option;
+            return std::nullopt;
+        }
+
+        if (key == "rtt") {
+            config.rtt_s = value / 1000.0;
+        } else if (key == "jitter") {
+            config.jitter_s = value / 1000.0;
+        } else if (key == "loss" || key == "reorder") {
+            if (value > 100.0) {
+                LogWarn() << "Link emulation " << key << " can't be more than 100%";
+                return std::nullopt;
+            }
+            (key == "loss" ? config.loss_probability : config.reorder_probability) =
+                value / 100.0;
+        } else if (key == "bw") {
+            config.bytes_per_s = value / 8.0;
+        } else if (key == "seed") {
+            config.seed = static_cast<uint32_t>(value);
+        } else {
+            LogWarn() << "Unknown link emulation option: " << key;
+            return std::nullopt;
+        }
+    }
+
+    return config;
+}
+
+LinkEmulator::LinkEmulator(const Config& config, ThreadSetup thread_setup) :
+    _config(config),
+    _thread_setup(std::move(thread_setup)),
+    _links{Link{seeded(config.seed, 0)}, Link{seeded(config.seed, 1)}}
+{
+    _thread = std::make_unique<NativeThread>(
+        _thread_setup.settings.stack_size_bytes, [this]() { run(); });
+}
+
+LinkEmulator::~LinkEmulator()
+{
+    stop();
+}
+
+bool LinkEmulator::is_later(const Message& lhs, const Message& rhs)
+{
+    return lhs.due != rhs.due ? lhs.due > rhs.due : lhs.seq > rhs.seq;
+}
+
+void LinkEmulator::transmit(Direction direction, std::size_t bytes, UniqueFunction<void()> deliver)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_should_exit) {
+        return;
+    }
+
+    auto& link = _links[index_of(direction)];
+    const auto now = Clock::now();
+
+    // Drawn for every message, so what happens to one doesn't depend on
+    // what happened to the ones before.
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const bool lost = uniform(link.random) < _config.loss_probability;
+    const double jitter_s = _config.jitter_s * uniform(link.random);
+    const bool reordered = uniform(link.random) < _config.reorder_probability;
+
+    // A lost message took its time on the link all the same.
+    auto sent = now;
+    if (_config.bytes_per_s > 0.0) {
+        link.busy_until = std::max(link.busy_until, now) +
+                          std::chrono::duration_cast<Clock::duration>(
+                              std::chrono::duration<double>(double(bytes) / _config.bytes_per_s));
+        sent = link.busy_until;
+    }
+
+    if (lost) {
+        ++link.lost_count;
+        return;
+    }
+
+    double delay_s = _config.rtt_s / 2.0 + jitter_s;
+    if (reordered) {
+        delay_s += std::max(_config.rtt_s / 2.0, MIN_REORDER_DELAY_S);
+    }
+
+    _messages.push_back(Message{
+        sent + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(delay_s)),
+        _next_seq++,
+        std::move(deliver)});
+    std::push_heap(_messages.begin(), _messages.end(), is_later);
+    _cv.notify_one();
+}
+
+void LinkEmulator::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_exit = true;
+        _messages.clear();
+    }
+    _cv.notify_all();
+
+    // A delivery can end up stopping the connection, which can't wait for
+    // itself.
+    if (_thread && _thread->joinable() && _thread->get_id() != std::this_thread::get_id()) {
+        _thread->join();
+    }
+}
+
+uint64_t LinkEmulator::lost_count(Direction direction) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _links[index_of(direction)].lost_count;
+}
+
+void LinkEmulator::run()
+{
+    _thread_setup.apply();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_should_exit) {
+        if (_messages.empty()) {
+            _cv.wait(lock, [this]() { return _should_exit || !_messages.empty(); });
+            continue;
+        }
+
+        const auto due = _messages.front().due;
+        if (Clock::now() < due) {
+            _cv.wait_until(lock, due);
+            continue;
+        }
+
+        std::pop_heap(_messages.begin(), _messages.end(), is_later);
+        auto deliver = std::move(_messages.back().deliver);
+        _messages.pop_back();
+
+        lock.unlock();
+        deliver();
+        lock.lock();
+    }
+}
+
+} // namespace mavsdk
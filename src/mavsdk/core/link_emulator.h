@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include "native_thread.h"
+#include "thread_setup.h"
+#include "unique_function.h"
+
+namespace mavsdk {
+
+// Impairs what goes over a connection the way a bad link would, with
+// latency, jitter, loss, reordering and a bandwidth cap, so MAVSDK can be
+// tried against e.g. a telemetry radio at range without any extra tools on
+// the host, and on any platform.
+//
+// Each direction draws from a generator of its own, seeded from the seed,
+// so the same messages are lost, delayed and reordered on every run, no
+// matter what goes the other way.
+class LinkEmulator {
+public:
+    struct Config {
+        double rtt_s{0.0};
+        // Up to this much is added to the delay of each message.
+        double jitter_s{0.0};
+        double loss_probability{0.0};
+        // Probability of a message to be held back behind the next ones.
+        double reorder_probability{0.0};
+        // 0 for unlimited.
+        double bytes_per_s{0.0};
+        uint32_t seed{1};
+
+        [[nodiscard]] bool active() const;
+    };
+
+    enum class Direction { Outgoing, Incoming };
+
+    // Parses e.g. "rtt:300,jitter:20,loss:5,reorder:1,bw:57600,seed:2", with
+    // the round trip time and the jitter in ms, loss and reorder in percent
+    // and the bandwidth in bits per second. Returns nullopt if it is invalid.
+    static std::optional<Config> parse(const std::string& spec);
+
+    explicit LinkEmulator(const Config& config, ThreadSetup thread_setup = {});
+    ~LinkEmulator();
+
+    // Non-copyable
+    LinkEmulator(const LinkEmulator&) = delete;
+    const LinkEmulator& operator=(const LinkEmulator&) = delete;
+
+    // Calls deliver on the emulator's thread once the message made it over
+    // the link, or never if it was lost.
+    void transmit(Direction direction, std::size_t bytes, UniqueFunction<void()> deliver);
+
+    // Drops what is still on the way. Nothing is delivered once it returned,
+    // unless it is called from a delivery.
+    void stop();
+
+    // Number of messages lost so far.
+    [[nodiscard]] uint64_t lost_count(Direction direction) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Message {
+        Clock::time_point due;
+        uint64_t seq;
+        UniqueFunction<void()> deliver;
+    };
+
+    struct Link {
+        std::mt19937 random;
+        Clock::time_point busy_until{};
+        uint64_t lost_count{0};
+    };
+
+    static bool is_later(const Message& lhs, const Message& rhs);
+
+    void run();
+
+    const Config _config;
+    const ThreadSetup _thread_setup;
+
+    mutable std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::array<Link, 2> _links;
+    // A heap with the message due first on top.
+    std::vector<Message> _messages{};
+    uint64_t _next_seq{0};
+    bool _should_exit{false};
+
+    std::unique_ptr<NativeThread> _thread{};
+};
+
+} // namespace mavsdk
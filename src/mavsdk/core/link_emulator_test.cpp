@@ -0,0 +1,139 @@
+#include "link_emulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+using Direction = LinkEmulator::Direction;
+
+namespace {
+
+// Sends count messages one way and collects the indices in the order they arrive.
+std::vector<int>
+transmit_all(LinkEmulator& emulator, Direction direction, int count, std::size_t bytes = 20)
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<int> received;
+
+    for (int i = 0; i < count; ++i) {
+        emulator.transmit(direction, bytes, [&, i]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            received.push_back(i);
+            cv.notify_all();
+        });
+    }
+
+    const auto expected = static_cast<std::size_t>(count) - emulator.lost_count(direction);
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait_for(lock, std::chrono::seconds(5), [&]() { return received.size() >= expected; });
+    return received;
+}
+
+} // namespace
+
+TEST(LinkEmulator, Parses)
+{
+    const auto config = LinkEmulator::parse("rtt:300,jitter:20,loss:5,reorder:1,bw:57600,seed:3");
+    ASSERT_TRUE(config);
+    EXPECT_DOUBLE_EQ(config->rtt_s, 0.3);
+    EXPECT_DOUBLE_EQ(config->jitter_s, 0.02);
+    EXPECT_DOUBLE_EQ(config->loss_probability, 0.05);
+    EXPECT_DOUBLE_EQ(config->reorder_probability, 0.01);
+    EXPECT_DOUBLE_EQ(config->bytes_per_s, 7200.0);
+    EXPECT_EQ(config->seed, 3u);
+    EXPECT_TRUE(config->active());
+
+    const auto seed_only = LinkEmulator::parse("seed:3");
+    ASSERT_TRUE(seed_only);
+    EXPECT_FALSE(seed_only->active());
+
+    EXPECT_FALSE(LinkEmulator::parse("rtt"));
+    EXPECT_FALSE(LinkEmulator::parse("rtt:"));
+    EXPECT_FALSE(LinkEmulator::parse("rtt:fast"));
+    EXPECT_FALSE(LinkEmulator::parse("rtt:-5"));
+    EXPECT_FALSE(LinkEmulator::parse("loss:101"));
+    EXPECT_FALSE(LinkEmulator::parse("delay:100"));
+}
+
+TEST(LinkEmulator, DelaysByHalfTheRoundTrip)
+{
+    LinkEmulator::Config config;
+    config.rtt_s = 0.1;
+    LinkEmulator emulator(config);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto received = transmit_all(emulator, Direction::Outgoing, 3);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(received, (std::vector<int>{0, 1, 2}));
+    EXPECT_GE(elapsed, std::chrono::milliseconds(50));
+}
+
+TEST(LinkEmulator, LosesTheSameMessagesForTheSameSeed)
+{
+    LinkEmulator::Config config;
+    config.loss_probability = 0.3;
+    config.seed = 7;
+
+    LinkEmulator first(config);
+    LinkEmulator second(config);
+    const auto first_received = transmit_all(first, Direction::Incoming, 200);
+
+    // Whatever goes the other way doesn't change what is lost.
+    transmit_all(second, Direction::Outgoing, 50);
+    const auto second_received = transmit_all(second, Direction::Incoming, 200);
+
+    EXPECT_EQ(first_received, second_received);
+    EXPECT_GT(first.lost_count(Direction::Incoming), 30u);
+    EXPECT_LT(first.lost_count(Direction::Incoming), 90u);
+}
+
+TEST(LinkEmulator, Reorders)
+{
+    LinkEmulator::Config config;
+    config.reorder_probability = 0.5;
+    LinkEmulator emulator(config);
+
+    auto received = transmit_all(emulator, Direction::Outgoing, 20);
+    ASSERT_EQ(received.size(), 20u);
+    EXPECT_FALSE(std::is_sorted(received.begin(), received.end()));
+
+    std::sort(received.begin(), received.end());
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(received[i], i);
+    }
+}
+
+TEST(LinkEmulator, LimitsBandwidth)
+{
+    LinkEmulator::Config config;
+    config.bytes_per_s = 10000.0;
+    LinkEmulator emulator(config);
+
+    // 10 times 100 bytes take 100 ms.
+    const auto start = std::chrono::steady_clock::now();
+    const auto received = transmit_all(emulator, Direction::Outgoing, 10, 100);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(received.size(), 10u);
+    EXPECT_GE(elapsed, std::chrono::milliseconds(95));
+}
+
+TEST(LinkEmulator, DropsWhatIsOnTheWayWhenStopped)
+{
+    LinkEmulator::Config config;
+    config.rtt_s = 10.0;
+    LinkEmulator emulator(config);
+
+    bool delivered = false;
+    emulator.transmit(Direction::Outgoing, 20, [&]() { delivered = true; });
+    emulator.stop();
+    emulator.transmit(Direction::Outgoing, 20, [&]() { delivered = true; });
+
+    EXPECT_FALSE(delivered);
+}
@@ -0,0 +1,102 @@
+#include "link_stats.h"
+
+namespace mavsdk {
+
+void LinkStats::add_bytes(unsigned num_bytes)
+{
+    _total.bytes.fetch_add(num_bytes, std::memory_order_relaxed);
+}
+
+void LinkStats::add_message(
+    uint8_t system_id, uint8_t component_id, uint8_t sequence, unsigned length)
+{
+    auto& system = _systems[system_id];
+    system.bytes.fetch_add(length, std::memory_order_relaxed);
+    system.messages.fetch_add(1, std::memory_order_relaxed);
+    _total.messages.fetch_add(1, std::memory_order_relaxed);
+
+    const uint16_t sender = static_cast<uint16_t>((system_id << 8) | component_id);
+    const auto it = _last_sequences.find(sender);
+    if (it == _last_sequences.end()) {
+        _last_sequences.emplace(sender, sequence);
+        return;
+    }
+
+    // The sequence number wraps around, so the gap is modulo 256.
+    const auto lost = static_cast<uint8_t>(sequence - it->second - 1);
+    it->second = sequence;
+    if (lost > 0) {
+        system.lost.fetch_add(lost, std::memory_order_relaxed);
+        _total.lost.fetch_add(lost, std::memory_order_relaxed);
+    }
+}
+
+void LinkStats::update_rates(uint64_t now_ns)
+{
+    std::lock_guard<std::mutex> lock(_update_mutex);
+
+    if (_last_update_ns != 0 && now_ns > _last_update_ns) {
+        const double elapsed_s = static_cast<double>(now_ns - _last_update_ns) * 1e-9;
+        _total.update_rates(elapsed_s);
+        for (auto& system : _systems) {
+            system.update_rates(elapsed_s);
+        }
+    }
+    _last_update_ns = now_ns;
+}
+
+void LinkStats::Counters::update_rates(double elapsed_s)
+{
+    const uint64_t current_bytes = bytes.load(std::memory_order_relaxed);
+    const uint64_t current_messages = messages.load(std::memory_order_relaxed);
+    const uint64_t current_lost = lost.load(std::memory_order_relaxed);
+
+    const auto new_messages = static_cast<double>(current_messages - previous_messages);
+    const auto new_lost = static_cast<double>(current_lost - previous_lost);
+
+    bytes_per_s.store(
+        static_cast<double>(current_bytes - previous_bytes) / elapsed_s,
+        std::memory_order_relaxed);
+    messages_per_s.store(new_messages / elapsed_s, std::memory_order_relaxed);
+    loss_rate.store(
+        new_messages + new_lost > 0.0 ? new_lost / (new_messages + new_lost) : 0.0,
+        std::memory_order_relaxed);
+
+    previous_bytes = current_bytes;
+    previous_messages = current_messages;
+    previous_lost = current_lost;
+}
+
+Mavsdk::ConnectionStats LinkStats::stats() const
+{
+    Mavsdk::ConnectionStats stats;
+    fill(_total, stats.link);
+    stats.crc_errors = _crc_errors.load(std::memory_order_relaxed);
+    stats.bad_lengths = _bad_lengths.load(std::memory_order_relaxed);
+    stats.parse_errors = _parse_errors.load(std::memory_order_relaxed);
+    stats.signature_errors = _signature_errors.load(std::memory_order_relaxed);
+
+    for (unsigned system_id = 0; system_id < _systems.size(); ++system_id) {
+        const auto& system = _systems[system_id];
+        if (system.messages.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        Mavsdk::SystemLinkStats system_stats;
+        system_stats.system_id = static_cast<uint8_t>(system_id);
+        fill(system, system_stats.link);
+        stats.systems.push_back(system_stats);
+    }
+    return stats;
+}
+
+void LinkStats::fill(const Counters& counters, Mavsdk::LinkStats& link_stats)
+{
+    link_stats.bytes_received = counters.bytes.load(std::memory_order_relaxed);
+    link_stats.bytes_per_s = counters.bytes_per_s.load(std::memory_order_relaxed);
+    link_stats.messages_received = counters.messages.load(std::memory_order_relaxed);
+    link_stats.messages_per_s = counters.messages_per_s.load(std::memory_order_relaxed);
+    link_stats.messages_lost = counters.lost.load(std::memory_order_relaxed);
+    link_stats.loss_rate = counters.loss_rate.load(std::memory_order_relaxed);
+}
+
+} // namespace mavsdk
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include "mavsdk.h"
+
+namespace mavsdk {
+
+// Statistics of what is received over one connection, in total and per
+// remote system.
+//
+// The receive path only increments atomics, it is meant to be called from
+// the single thread receiving on the connection. Rates are worked out by
+// update_rates(), which is meant to be called periodically from another
+// thread, and can be read at any time without waiting for either.
+class LinkStats {
+public:
+    LinkStats() = default;
+    ~LinkStats() = default;
+
+    // Non-copyable
+    LinkStats(const LinkStats&) = delete;
+    const LinkStats& operator=(const LinkStats&) = delete;
+
+    void add_bytes(unsigned num_bytes);
+
+    // Counts a message of length bytes on the wire and keeps track of gaps in
+    // the sequence numbers of its sender.
+    void
+    add_message(uint8_t system_id, uint8_t component_id, uint8_t sequence, unsigned length);
+
+    void add_crc_error() { _crc_errors.fetch_add(1, std::memory_order_relaxed); }
+    void add_bad_length() { _bad_lengths.fetch_add(1, std::memory_order_relaxed); }
+    void add_parse_error() { _parse_errors.fetch_add(1, std::memory_order_relaxed); }
+    void add_signature_error() { _signature_errors.fetch_add(1, std::memory_order_relaxed); }
+
+    // Rates are averaged over the time since the previous call.
+    void update_rates(uint64_t now_ns);
+
+    [[nodiscard]] Mavsdk::ConnectionStats stats() const;
+
+private:
+    struct Counters {
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> messages{0};
+        std::atomic<uint64_t> lost{0};
+
+        std::atomic<double> bytes_per_s{0.0};
+        std::atomic<double> messages_per_s{0.0};
+        std::atomic<double> loss_rate{0.0};
+
+        // Only used by update_rates().
+        uint64_t previous_bytes{0};
+        uint64_t previous_messages{0};
+        uint64_t previous_lost{0};
+
+        void update_rates(double elapsed_s);
+    };
+
+    static void fill(const Counters& counters, Mavsdk::LinkStats& link_stats);
+
+    Counters _total{};
+    std::array<Counters, 256> _systems{};
+
+    std::atomic<uint64_t> _crc_errors{0};
+    std::atomic<uint64_t> _bad_lengths{0};
+    std::atomic<uint64_t> _parse_errors{0};
+    std::atomic<uint64_t> _signature_errors{0};
+
+    // Last sequence number by sender (system and component ID), only used
+    // by the receive path.
+    std::unordered_map<uint16_t, uint8_t> _last_sequences{};
+
+    std::mutex _update_mutex{};
+    uint64_t _last_update_ns{0};
+};
+
+} // namespace mavsdk
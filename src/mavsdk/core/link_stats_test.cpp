@@ -0,0 +1,90 @@
+#include "link_stats.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(LinkStats, CountsPerSystem)
+{
+    LinkStats link_stats;
+    link_stats.add_bytes(100);
+    link_stats.add_message(1, 1, 0, 30);
+    link_stats.add_message(1, 1, 1, 30);
+    link_stats.add_message(2, 1, 7, 40);
+
+    const auto stats = link_stats.stats();
+    EXPECT_EQ(stats.link.bytes_received, 100);
+    EXPECT_EQ(stats.link.messages_received, 3);
+    EXPECT_EQ(stats.link.messages_lost, 0);
+
+    ASSERT_EQ(stats.systems.size(), 2);
+    EXPECT_EQ(stats.systems[0].system_id, 1);
+    EXPECT_EQ(stats.systems[0].link.bytes_received, 60);
+    EXPECT_EQ(stats.systems[0].link.messages_received, 2);
+    EXPECT_EQ(stats.systems[1].system_id, 2);
+    EXPECT_EQ(stats.systems[1].link.bytes_received, 40);
+}
+
+TEST(LinkStats, CountsSequenceGapsPerSender)
+{
+    LinkStats link_stats;
+
+    // Two components of the same system count their sequence separately.
+    link_stats.add_message(1, 1, 10, 20);
+    link_stats.add_message(1, 2, 200, 20);
+    link_stats.add_message(1, 1, 11, 20);
+    link_stats.add_message(1, 2, 201, 20);
+    EXPECT_EQ(link_stats.stats().link.messages_lost, 0);
+
+    // Three missing.
+    link_stats.add_message(1, 1, 15, 20);
+    EXPECT_EQ(link_stats.stats().link.messages_lost, 3);
+
+    // Across the wrap around, two missing.
+    link_stats.add_message(1, 2, 255, 20);
+    link_stats.add_message(1, 2, 2, 20);
+    EXPECT_EQ(link_stats.stats().link.messages_lost, 3 + 53 + 2);
+    EXPECT_EQ(link_stats.stats().systems[0].link.messages_lost, 3 + 53 + 2);
+}
+
+TEST(LinkStats, RatesOverInterval)
+{
+    LinkStats link_stats;
+    link_stats.update_rates(1000000000);
+
+    link_stats.add_bytes(500);
+    for (uint8_t sequence = 0; sequence < 10; sequence += 2) {
+        link_stats.add_message(1, 1, sequence, 100);
+    }
+    link_stats.update_rates(1500000000);
+
+    auto stats = link_stats.stats();
+    EXPECT_DOUBLE_EQ(stats.link.bytes_per_s, 1000.0);
+    EXPECT_DOUBLE_EQ(stats.link.messages_per_s, 10.0);
+    // 5 received, 4 lost in between.
+    EXPECT_DOUBLE_EQ(stats.link.loss_rate, 4.0 / 9.0);
+    ASSERT_EQ(stats.systems.size(), 1);
+    EXPECT_DOUBLE_EQ(stats.systems[0].link.bytes_per_s, 1000.0);
+
+    // Nothing new arrived.
+    link_stats.update_rates(2500000000);
+    stats = link_stats.stats();
+    EXPECT_DOUBLE_EQ(stats.link.bytes_per_s, 0.0);
+    EXPECT_DOUBLE_EQ(stats.link.messages_per_s, 0.0);
+    EXPECT_DOUBLE_EQ(stats.link.loss_rate, 0.0);
+    EXPECT_EQ(stats.link.messages_received, 5);
+}
+
+TEST(LinkStats, CountsErrors)
+{
+    LinkStats link_stats;
+    link_stats.add_crc_error();
+    link_stats.add_crc_error();
+    link_stats.add_bad_length();
+    link_stats.add_parse_error();
+
+    const auto stats = link_stats.stats();
+    EXPECT_EQ(stats.crc_errors, 2);
+    EXPECT_EQ(stats.bad_lengths, 1);
+    EXPECT_EQ(stats.parse_errors, 1);
+    EXPECT_TRUE(stats.systems.empty());
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace mavsdk {
+
+// Bounded lock-free queue for multiple producers and consumers.
+//
+// Based on the bounded MPMC queue by Dmitry Vyukov:
+// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+//
+// Every cell carries a sequence number which tells producers and consumers
+// whether it is free to be written or ready to be read, so neither side ever
+// takes a lock. The capacity is rounded up to the next power of two.
+template<typename T> class LockFreeQueue {
+public:
+    explicit LockFreeQueue(std::size_t capacity) :
+        _capacity(round_up_to_power_of_two(capacity)),
+        _mask(_capacity - 1),
+        _cells(new Cell[_capacity])
+    {
+        for (std::size_t i = 0; i < _capacity; ++i) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~LockFreeQueue() = default;
+
+    // Non-copyable
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    const LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+    // The item is only moved from if it could be pushed.
+    bool try_push(T&& item)
+    {
+        Cell* cell;
+        std::size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &_cells[pos & _mask];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+            if (diff == 0) {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // Full.
+                return false;
+            } else {
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = std::move(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& item)
+    {
+        Cell* cell;
+        std::size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &_cells[pos & _mask];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+            if (diff == 0) {
+                if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // Empty.
+                return false;
+            } else {
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        item = std::move(cell->data);
+        cell->data = T{};
+        cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // This is only a snapshot and can be outdated by the time it is used.
+    [[nodiscard]] std::size_t size() const
+    {
+        const std::size_t dequeue_pos = _dequeue_pos.load(std::memory_order_acquire);
+        const std::size_t enqueue_pos = _enqueue_pos.load(std::memory_order_acquire);
+        return enqueue_pos >= dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+    }
+
+    [[nodiscard]] bool empty() const { return size() == 0; }
+
+    [[nodiscard]] std::size_t capacity() const { return _capacity; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence{0};
+        T data{};
+    };
+
+    static std::size_t round_up_to_power_of_two(std::size_t value)
+    {
+        std::size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const std::size_t _capacity;
+    const std::size_t _mask;
+    std::unique_ptr<Cell[]> _cells;
+
+    // Keep producer and consumer positions on separate cache lines.
+    alignas(64) std::atomic<std::size_t> _enqueue_pos{0};
+    alignas(64) std::atomic<std::size_t> _dequeue_pos{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,77 @@
+#include "lock_free_queue.h"
+
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(LockFreeQueue, FillAndEmpty)
+{
+    LockFreeQueue<int> queue{4};
+    EXPECT_EQ(queue.capacity(), 4);
+    EXPECT_TRUE(queue.empty());
+
+    for (int i = 0; i < 4; ++i) {
+        int value = i;
+        EXPECT_TRUE(queue.try_push(std::move(value)));
+    }
+    EXPECT_EQ(queue.size(), 4);
+
+    int too_many = 4;
+    EXPECT_FALSE(queue.try_push(std::move(too_many)));
+
+    int value;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.try_pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.try_pop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(LockFreeQueue, CapacityRoundedUp)
+{
+    LockFreeQueue<int> queue{100};
+    EXPECT_EQ(queue.capacity(), 128);
+}
+
+TEST(LockFreeQueue, MultipleProducers)
+{
+    LockFreeQueue<int> queue{1024};
+
+    constexpr int num_producers = 4;
+    constexpr int num_per_producer = 10000;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&queue, p]() {
+            for (int i = 0; i < num_per_producer; ++i) {
+                int value = p * num_per_producer + i;
+                while (!queue.try_push(std::move(value))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // Every producer's values need to arrive in order.
+    std::vector<int> last(num_producers, -1);
+    int num_received = 0;
+    while (num_received < num_producers * num_per_producer) {
+        int value;
+        if (!queue.try_pop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const int producer = value / num_per_producer;
+        EXPECT_GT(value, last[producer]);
+        last[producer] = value;
+        ++num_received;
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    EXPECT_TRUE(queue.empty());
+}
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <sstream>
+#include <utility>
+#include "async_log.h"
 #include "log_callback.h"
 
 #if defined(ANDROID)
@@ -20,10 +23,30 @@
 
 #define call_user_callback(...) call_user_callback_located(FILENAME, __LINE__, __VA_ARGS__)
 
-#define LogDebug() LogDebugDetailed(FILENAME, __LINE__)
-#define LogInfo() LogInfoDetailed(FILENAME, __LINE__)
-#define LogWarn() LogWarnDetailed(FILENAME, __LINE__)
-#define LogErr() LogErrDetailed(FILENAME, __LINE__)
+// Every call site gets a rate limit of its own.
+#define LOG_RATE_LIMIT() \
+    ([]() { \
+        static mavsdk::LogRateLimit rate_limit; \
+        return &rate_limit; \
+    }())
+
+// Levels below MAVSDK_LOG_MIN_LEVEL (see log::Level) are compiled out. The
+// arguments of a stripped call are not evaluated.
+#if !defined(MAVSDK_LOG_MIN_LEVEL)
+#define MAVSDK_LOG_MIN_LEVEL 0
+#endif
+
+// A loop running once or not at all, so it can't take the else of an if
+// around it.
+#define LOG_DETAILED(level, type) \
+    for (bool log_once_ = static_cast<int>(level) >= MAVSDK_LOG_MIN_LEVEL; log_once_; \
+         log_once_ = false) \
+    type(FILENAME, __LINE__, LOG_RATE_LIMIT())
+
+#define LogDebug() LOG_DETAILED(mavsdk::log::Level::Debug, mavsdk::LogDebugDetailed)
+#define LogInfo() LOG_DETAILED(mavsdk::log::Level::Info, mavsdk::LogInfoDetailed)
+#define LogWarn() LOG_DETAILED(mavsdk::log::Level::Warn, mavsdk::LogWarnDetailed)
+#define LogErr() LOG_DETAILED(mavsdk::log::Level::Err, mavsdk::LogErrDetailed)
 
 namespace mavsdk {
 
@@ -33,20 +56,32 @@ void set_color(Color color);
 
 class LogDetailed {
 public:
-    LogDetailed(const char* filename, int filenumber) :
+    LogDetailed(const char* filename, int filenumber, LogRateLimit* rate_limit = nullptr) :
         _s(),
         _caller_filename(filename),
-        _caller_filenumber(filenumber)
+        _caller_filenumber(filenumber),
+        _enabled(rate_limit == nullptr || rate_limit->allow(_suppressed))
     {}
 
     template<typename T> LogDetailed& operator<<(const T& x)
     {
-        _s << x;
+        // Don't even format what is suppressed.
+        if (_enabled) {
+            _s << x;
+        }
         return *this;
     }
 
     virtual ~LogDetailed()
     {
+        if (!_enabled) {
+            return;
+        }
+
+        if (_suppressed > 0) {
+            _s << " (" << _suppressed << " similar messages suppressed)";
+        }
+
         if (log::get_callback() &&
             log::get_callback()(_log_level, _s.str(), _caller_filename, _caller_filenumber)) {
             return;
@@ -71,52 +106,15 @@ public:
         (void)_caller_filename;
         (void)_caller_filenumber;
 #else
-
-        switch (_log_level) {
-            case log::Level::Debug:
-                set_color(Color::Green);
-                break;
-            case log::Level::Info:
-                set_color(Color::Blue);
-                break;
-            case log::Level::Warn:
-                set_color(Color::Yellow);
-                break;
-            case log::Level::Err:
-                set_color(Color::Red);
-                break;
-        }
-
-        // Time output taken from:
-        // https://stackoverflow.com/questions/16357999#answer-16358264
-        time_t rawtime;
-        time(&rawtime);
-        struct tm* timeinfo = localtime(&rawtime);
-        char time_buffer[10]{}; // We need 8 characters + \0
-        strftime(time_buffer, sizeof(time_buffer), "%I:%M:%S", timeinfo);
-        std::cout << "[" << time_buffer;
-
-        switch (_log_level) {
-            case log::Level::Debug:
-                std::cout << "|Debug] ";
-                break;
-            case log::Level::Info:
-                std::cout << "|Info ] ";
-                break;
-            case log::Level::Warn:
-                std::cout << "|Warn ] ";
-                break;
-            case log::Level::Err:
-                std::cout << "|Error] ";
-                break;
-        }
-
-        set_color(Color::Reset);
-
-        std::cout << _s.str();
-        std::cout << " (" << _caller_filename << ":" << std::dec << _caller_filenumber << ")";
-
-        std::cout << '\n';
+        // Written to the console by the log thread, so the caller never waits
+        // for it.
+        AsyncLog::Record record;
+        record.level = _log_level;
+        record.time = std::time(nullptr);
+        record.text = _s.str();
+        record.filename = _caller_filename;
+        record.line = _caller_filenumber;
+        AsyncLog::instance().push(std::move(record));
 #endif
     }
 
@@ -130,11 +128,14 @@ private:
     std::stringstream _s;
     const char* _caller_filename;
     int _caller_filenumber;
+    uint32_t _suppressed{0};
+    const bool _enabled;
 };
 
 class LogDebugDetailed : public LogDetailed {
 public:
-    LogDebugDetailed(const char* filename, int filenumber) : LogDetailed(filename, filenumber)
+    LogDebugDetailed(const char* filename, int filenumber, LogRateLimit* rate_limit = nullptr) :
+        LogDetailed(filename, filenumber, rate_limit)
     {
         _log_level = log::Level::Debug;
     }
@@ -142,7 +143,8 @@ public:
 
 class LogInfoDetailed : public LogDetailed {
 public:
-    LogInfoDetailed(const char* filename, int filenumber) : LogDetailed(filename, filenumber)
+    LogInfoDetailed(const char* filename, int filenumber, LogRateLimit* rate_limit = nullptr) :
+        LogDetailed(filename, filenumber, rate_limit)
     {
         _log_level = log::Level::Info;
     }
@@ -150,7 +152,8 @@ public:
 
 class LogWarnDetailed : public LogDetailed {
 public:
-    LogWarnDetailed(const char* filename, int filenumber) : LogDetailed(filename, filenumber)
+    LogWarnDetailed(const char* filename, int filenumber, LogRateLimit* rate_limit = nullptr) :
+        LogDetailed(filename, filenumber, rate_limit)
     {
         _log_level = log::Level::Warn;
     }
@@ -158,7 +161,8 @@ public:
 
 class LogErrDetailed : public LogDetailed {
 public:
-    LogErrDetailed(const char* filename, int filenumber) : LogDetailed(filename, filenumber)
+    LogErrDetailed(const char* filename, int filenumber, LogRateLimit* rate_limit = nullptr) :
+        LogDetailed(filename, filenumber, rate_limit)
     {
         _log_level = log::Level::Err;
     }
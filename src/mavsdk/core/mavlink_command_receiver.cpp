@@ -1,13 +1,111 @@
 #include "mavlink_command_receiver.h"
 #include "system_impl.h"
+#include <algorithm>
 #include <cmath>
 #include <future>
+#include <limits>
 #include <memory>
 
 namespace mavsdk {
 
-MavlinkCommandReceiver::MavlinkCommandReceiver(SystemImpl& system_impl) : _parent(system_impl)
+struct MavlinkCommandReceiver::PendingCommand::State {
+    std::shared_ptr<AckSender> sender;
+    uint16_t command{0};
+    uint8_t origin_system_id{0};
+    uint8_t origin_component_id{0};
+    // Guarded by the mutex of the sender.
+    uint8_t progress{0};
+    bool done{false};
+};
+
+struct MavlinkCommandReceiver::AckSender {
+    std::mutex mutex{};
+    // Reset once the receiver is gone, results arriving later are dropped.
+    SystemImpl* parent{nullptr};
+    std::vector<std::shared_ptr<PendingCommand::State>> pending{};
+
+    // These need the mutex to be held.
+    void send_ack(const PendingCommand::State& state, MAV_RESULT result, uint8_t progress);
+    void send_in_progress_acks();
+};
+
+void MavlinkCommandReceiver::AckSender::send_ack(
+    const PendingCommand::State& state, MAV_RESULT result, uint8_t progress)
+{
+    if (parent == nullptr) {
+        return;
+    }
+
+    mavlink_message_t message{};
+    mavlink_msg_command_ack_pack(
+        parent->get_own_system_id(),
+        parent->get_own_component_id(),
+        &message,
+        state.command,
+        result,
+        progress,
+        0,
+        state.origin_system_id,
+        state.origin_component_id);
+    parent->send_message(message);
+}
+
+void MavlinkCommandReceiver::AckSender::send_in_progress_acks()
+{
+    for (auto it = pending.begin(); it != pending.end();
+         /* no ++it */) {
+        auto& state = **it;
+        if (it->use_count() == 1) {
+            // The handler dropped the command without sending a result.
+            state.done = true;
+            send_ack(state, MAV_RESULT_FAILED, std::numeric_limits<uint8_t>::max());
+            it = pending.erase(it);
+        } else {
+            send_ack(state, MAV_RESULT_IN_PROGRESS, state.progress);
+            ++it;
+        }
+    }
+}
+
+void MavlinkCommandReceiver::PendingCommand::send_progress(uint8_t progress_percent) const
+{
+    if (!_state) {
+        return;
+    }
+
+    auto& sender = *_state->sender;
+    std::lock_guard<std::mutex> lock(sender.mutex);
+    if (_state->done) {
+        return;
+    }
+    _state->progress = std::min<uint8_t>(progress_percent, 100);
+    sender.send_ack(*_state, MAV_RESULT_IN_PROGRESS, _state->progress);
+}
+
+void MavlinkCommandReceiver::PendingCommand::send_result(MAV_RESULT result) const
+{
+    if (!_state) {
+        return;
+    }
+
+    auto& sender = *_state->sender;
+    std::lock_guard<std::mutex> lock(sender.mutex);
+    if (_state->done) {
+        return;
+    }
+    _state->done = true;
+    sender.pending.erase(
+        std::remove(sender.pending.begin(), sender.pending.end(), _state), sender.pending.end());
+    sender.send_ack(*_state, result, std::numeric_limits<uint8_t>::max());
+}
+
+MavlinkCommandReceiver::MavlinkCommandReceiver(SystemImpl& system_impl) :
+    _parent(system_impl),
+    _table(std::make_shared<const Table>()),
+    _ack_sender(std::make_shared<AckSender>())
 {
+    _ack_sender->parent = &_parent;
+
     _parent.register_mavlink_message_handler(
         MAVLINK_MSG_ID_COMMAND_LONG,
         [this](const mavlink_message_t& message) { receive_command_long(message); },
@@ -21,25 +119,26 @@ MavlinkCommandReceiver::MavlinkCommandReceiver(SystemImpl& system_impl) : _paren
 
 MavlinkCommandReceiver::~MavlinkCommandReceiver()
 {
-    unregister_all_mavlink_command_handlers(this);
-
     _parent.unregister_all_mavlink_message_handlers(this);
+
+    if (_in_progress_cookie != nullptr) {
+        _parent.remove_call_every(_in_progress_cookie);
+    }
+
+    std::lock_guard<std::mutex> lock(_ack_sender->mutex);
+    _ack_sender->parent = nullptr;
+    _ack_sender->pending.clear();
 }
 
 void MavlinkCommandReceiver::receive_command_int(const mavlink_message_t& message)
 {
     MavlinkCommandReceiver::CommandInt cmd(message);
 
-    std::lock_guard<std::mutex> lock(_mavlink_command_handler_table_mutex);
-
-    for (auto& handler : _mavlink_command_int_handler_table) {
-        if (handler.cmd_id == cmd.command) {
-            // The client side can pack a COMMAND_ACK as a response to receiving the command.
-            auto maybe_message = handler.callback(cmd);
-            if (maybe_message) {
-                _parent.send_message(maybe_message.value());
-            }
-        }
+    // We hold on to this table until we're done, even if it gets replaced
+    // in the meantime.
+    const auto table = std::atomic_load(&_table);
+    if (const auto* handlers = find_handlers(*table, cmd.command)) {
+        dispatch(cmd, handlers->int_entries);
     }
 }
 
@@ -47,88 +146,237 @@ void MavlinkCommandReceiver::receive_command_long(const mavlink_message_t& messa
 {
     MavlinkCommandReceiver::CommandLong cmd(message);
 
-    std::lock_guard<std::mutex> lock(_mavlink_command_handler_table_mutex);
+    // We hold on to this table until we're done, even if it gets replaced
+    // in the meantime.
+    const auto table = std::atomic_load(&_table);
+    if (const auto* handlers = find_handlers(*table, cmd.command)) {
+        dispatch(cmd, handlers->long_entries);
+    }
+}
 
-    for (auto& handler : _mavlink_command_long_handler_table) {
-        if (handler.cmd_id == cmd.command) {
+template<typename Command, typename Entry>
+void MavlinkCommandReceiver::dispatch(const Command& command, const std::vector<Entry>& entries)
+{
+    if (entries.empty()) {
+        return;
+    }
+
+    _dispatching_thread = std::this_thread::get_id();
+
+    std::shared_ptr<PendingCommand::State> pending;
+    bool pending_started = false;
+
+    for (const auto& entry : entries) {
+        if (entry.callback) {
             // The client side can pack a COMMAND_ACK as a response to receiving the command.
-            auto maybe_message = handler.callback(cmd);
+            auto maybe_message = entry.callback(command);
             if (maybe_message) {
                 _parent.send_message(maybe_message.value());
             }
+        } else if (entry.async_callback) {
+            if (!pending_started) {
+                pending = start_pending(command);
+                pending_started = true;
+            }
+            if (pending) {
+                entry.async_callback(command, PendingCommand{pending});
+            }
         }
     }
+
+    _dispatching_thread = std::thread::id{};
+}
+
+template<typename Command>
+std::shared_ptr<MavlinkCommandReceiver::PendingCommand::State>
+MavlinkCommandReceiver::start_pending(const Command& command)
+{
+    std::lock_guard<std::mutex> lock(_ack_sender->mutex);
+
+    for (const auto& state : _ack_sender->pending) {
+        if (state->command == command.command &&
+            state->origin_system_id == command.origin_system_id &&
+            state->origin_component_id == command.origin_component_id) {
+            // A retransmission because our ack got lost, it's still in progress.
+            _ack_sender->send_ack(*state, MAV_RESULT_IN_PROGRESS, state->progress);
+            return nullptr;
+        }
+    }
+
+    auto state = std::make_shared<PendingCommand::State>();
+    state->sender = _ack_sender;
+    state->command = command.command;
+    state->origin_system_id = command.origin_system_id;
+    state->origin_component_id = command.origin_component_id;
+
+    _ack_sender->pending.push_back(state);
+    _ack_sender->send_ack(*state, MAV_RESULT_IN_PROGRESS, 0);
+    return state;
+}
+
+const MavlinkCommandReceiver::Handlers*
+MavlinkCommandReceiver::find_handlers(const Table& table, uint16_t cmd_id)
+{
+    const auto& page = table[cmd_id / PAGE_SIZE];
+    return page ? &(*page)[cmd_id % PAGE_SIZE] : nullptr;
+}
+
+template<typename Modify>
+void MavlinkCommandReceiver::modify_handlers(uint16_t cmd_id, const Modify& modify)
+{
+    // Needs _table_mutex to be held.
+    auto new_table = std::make_shared<Table>(*std::atomic_load(&_table));
+    auto& page = (*new_table)[cmd_id / PAGE_SIZE];
+
+    auto new_page = page ? std::make_shared<Page>(*page) : std::make_shared<Page>();
+    modify((*new_page)[cmd_id % PAGE_SIZE]);
+
+    const bool page_empty =
+        std::all_of(new_page->begin(), new_page->end(), [](const Handlers& handlers) {
+            return handlers.int_entries.empty() && handlers.long_entries.empty();
+        });
+    page = page_empty ? nullptr : std::shared_ptr<const Page>(std::move(new_page));
+
+    publish_table(std::move(new_table));
+}
+
+void MavlinkCommandReceiver::publish_table(std::shared_ptr<const Table> new_table)
+{
+    auto old_table = std::atomic_exchange(&_table, std::move(new_table));
+
+    // After unregistering, the caller expects its handlers to no longer be
+    // called, e.g. because it is about to be destroyed. Therefore, we wait
+    // until no command is still dispatched through the old table, unless
+    // this is called from one of the handlers.
+    if (_dispatching_thread == std::this_thread::get_id()) {
+        return;
+    }
+    while (old_table.use_count() > 1) {
+        std::this_thread::yield();
+    }
+}
+
+void MavlinkCommandReceiver::start_in_progress_acks()
+{
+    // Needs _table_mutex to be held.
+    if (_in_progress_cookie != nullptr) {
+        return;
+    }
+
+    _parent.add_call_every(
+        [ack_sender = _ack_sender]() {
+            std::lock_guard<std::mutex> lock(ack_sender->mutex);
+            ack_sender->send_in_progress_acks();
+        },
+        IN_PROGRESS_INTERVAL_S,
+        &_in_progress_cookie);
 }
 
 void MavlinkCommandReceiver::register_mavlink_command_handler(
     uint16_t cmd_id, const MavlinkCommandIntHandler& callback, const void* cookie)
 {
-    std::lock_guard<std::mutex> lock(_mavlink_command_handler_table_mutex);
+    std::lock_guard<std::mutex> lock(_table_mutex);
 
-    MAVLinkCommandIntHandlerTableEntry entry = {cmd_id, callback, cookie};
-    _mavlink_command_int_handler_table.push_back(entry);
+    modify_handlers(cmd_id, [&](Handlers& handlers) {
+        handlers.int_entries.push_back(CommandIntEntry{callback, nullptr, cookie});
+    });
 }
 
 void MavlinkCommandReceiver::register_mavlink_command_handler(
     uint16_t cmd_id, const MavlinkCommandLongHandler& callback, const void* cookie)
 {
-    std::lock_guard<std::mutex> lock(_mavlink_command_handler_table_mutex);
+    std::lock_guard<std::mutex> lock(_table_mutex);
+
+    modify_handlers(cmd_id, [&](Handlers& handlers) {
+        handlers.long_entries.push_back(CommandLongEntry{callback, nullptr, cookie});
+    });
+}
+
+void MavlinkCommandReceiver::register_mavlink_command_handler_async(
+    uint16_t cmd_id, const MavlinkCommandIntAsyncHandler& callback, const void* cookie)
+{
+    std::lock_guard<std::mutex> lock(_table_mutex);
 
-    MAVLinkCommandLongHandlerTableEntry entry = {cmd_id, callback, cookie};
-    _mavlink_command_long_handler_table.push_back(entry);
+    start_in_progress_acks();
+    modify_handlers(cmd_id, [&](Handlers& handlers) {
+        handlers.int_entries.push_back(CommandIntEntry{nullptr, callback, cookie});
+    });
+}
+
+void MavlinkCommandReceiver::register_mavlink_command_handler_async(
+    uint16_t cmd_id, const MavlinkCommandLongAsyncHandler& callback, const void* cookie)
+{
+    std::lock_guard<std::mutex> lock(_table_mutex);
+
+    start_in_progress_acks();
+    modify_handlers(cmd_id, [&](Handlers& handlers) {
+        handlers.long_entries.push_back(CommandLongEntry{nullptr, callback, cookie});
+    });
 }
 
 void MavlinkCommandReceiver::unregister_mavlink_command_handler(uint16_t cmd_id, const void* cookie)
 {
-    std::lock_guard<std::mutex> lock(_mavlink_command_handler_table_mutex);
+    std::lock_guard<std::mutex> lock(_table_mutex);
 
-    // COMMAND_INT
-    for (auto it = _mavlink_command_int_handler_table.begin();
-         it != _mavlink_command_int_handler_table.end();
-         /* no ++it */) {
-        if (it->cmd_id == cmd_id && it->cookie == cookie) {
-            it = _mavlink_command_int_handler_table.erase(it);
-        } else {
-            ++it;
-        }
+    if (find_handlers(*std::atomic_load(&_table), cmd_id) == nullptr) {
+        return;
     }
 
-    // COMMAND_LONG
-    for (auto it = _mavlink_command_long_handler_table.begin();
-         it != _mavlink_command_long_handler_table.end();
-         /* no ++it */) {
-        if (it->cmd_id == cmd_id && it->cookie == cookie) {
-            it = _mavlink_command_long_handler_table.erase(it);
-        } else {
-            ++it;
-        }
-    }
+    modify_handlers(cmd_id, [&](Handlers& handlers) {
+        const auto has_cookie = [&](const auto& entry) { return entry.cookie == cookie; };
+        handlers.int_entries.erase(
+            std::remove_if(handlers.int_entries.begin(), handlers.int_entries.end(), has_cookie),
+            handlers.int_entries.end());
+        handlers.long_entries.erase(
+            std::remove_if(handlers.long_entries.begin(), handlers.long_entries.end(), has_cookie),
+            handlers.long_entries.end());
+    });
 }
 
 void MavlinkCommandReceiver::unregister_all_mavlink_command_handlers(const void* cookie)
 {
-    std::lock_guard<std::mutex> lock(_mavlink_command_handler_table_mutex);
+    std::lock_guard<std::mutex> lock(_table_mutex);
 
-    // COMMAND_INT
-    for (auto it = _mavlink_command_int_handler_table.begin();
-         it != _mavlink_command_int_handler_table.end();
-         /* no ++it */) {
-        if (it->cookie == cookie) {
-            it = _mavlink_command_int_handler_table.erase(it);
-        } else {
-            ++it;
+    const auto has_cookie = [&](const auto& entry) { return entry.cookie == cookie; };
+
+    auto new_table = std::make_shared<Table>(*std::atomic_load(&_table));
+    bool changed = false;
+
+    for (auto& page : *new_table) {
+        if (!page) {
+            continue;
         }
-    }
 
-    // COMMAND_LONG
-    for (auto it = _mavlink_command_long_handler_table.begin();
-         it != _mavlink_command_long_handler_table.end();
-         /* no ++it */) {
-        if (it->cookie == cookie) {
-            it = _mavlink_command_long_handler_table.erase(it);
-        } else {
-            ++it;
+        const bool page_has_cookie =
+            std::any_of(page->begin(), page->end(), [&](const Handlers& handlers) {
+                return std::any_of(
+                           handlers.int_entries.begin(), handlers.int_entries.end(), has_cookie) ||
+                       std::any_of(
+                           handlers.long_entries.begin(), handlers.long_entries.end(), has_cookie);
+            });
+        if (!page_has_cookie) {
+            continue;
+        }
+
+        auto new_page = std::make_shared<Page>(*page);
+        bool page_empty = true;
+        for (auto& handlers : *new_page) {
+            auto& int_entries = handlers.int_entries;
+            int_entries.erase(
+                std::remove_if(int_entries.begin(), int_entries.end(), has_cookie),
+                int_entries.end());
+            auto& long_entries = handlers.long_entries;
+            long_entries.erase(
+                std::remove_if(long_entries.begin(), long_entries.end(), has_cookie),
+                long_entries.end());
+            page_empty = page_empty && int_entries.empty() && long_entries.empty();
         }
+        page = page_empty ? nullptr : std::shared_ptr<const Page>(std::move(new_page));
+        changed = true;
+    }
+
+    if (changed) {
+        publish_table(std::move(new_table));
     }
 }
 
@@ -2,14 +2,19 @@
 
 #include "mavlink_include.h"
 #include "locked_queue.h"
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <functional>
 #include <mutex>
 #include <optional>
+#include <thread>
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
 namespace mavsdk {
 
@@ -101,6 +106,8 @@ public:
         }
     };
 
+    // The handler is called on the receive thread and the ack it returns is
+    // sent right away, so it needs to be quick.
     using MavlinkCommandIntHandler =
         std::function<std::optional<mavlink_message_t>(const CommandInt&)>;
     using MavlinkCommandLongHandler =
@@ -111,30 +118,102 @@ public:
     void register_mavlink_command_handler(
         uint16_t cmd_id, const MavlinkCommandLongHandler& callback, const void* cookie);
 
+    // Answers a command taken by an async handler, from any thread. Copies
+    // refer to the same command, and only its first result is sent.
+    class PendingCommand {
+    public:
+        PendingCommand() = default;
+        ~PendingCommand() = default;
+
+        // Sends IN_PROGRESS with the progress in percent.
+        void send_progress(uint8_t progress_percent) const;
+
+        // Sends the final ack.
+        void send_result(MAV_RESULT result) const;
+
+    private:
+        friend class MavlinkCommandReceiver;
+        struct State;
+        explicit PendingCommand(std::shared_ptr<State> state) : _state(std::move(state)) {}
+
+        std::shared_ptr<State> _state{};
+    };
+
+    // Async handlers are for commands which take longer. The command is acked
+    // with IN_PROGRESS straight away, and again regularly until the handler
+    // sends the result, so the sender does not time out. Retransmissions of
+    // a command still in progress are acked the same way instead of being
+    // handed to the handler again. The handler itself is still called on the
+    // receive thread and is meant to hand the work off.
+    using MavlinkCommandIntAsyncHandler = std::function<void(const CommandInt&, PendingCommand)>;
+    using MavlinkCommandLongAsyncHandler =
+        std::function<void(const CommandLong&, PendingCommand)>;
+
+    void register_mavlink_command_handler_async(
+        uint16_t cmd_id, const MavlinkCommandIntAsyncHandler& callback, const void* cookie);
+    void register_mavlink_command_handler_async(
+        uint16_t cmd_id, const MavlinkCommandLongAsyncHandler& callback, const void* cookie);
+
     void unregister_mavlink_command_handler(uint16_t cmd_id, const void* cookie);
     void unregister_all_mavlink_command_handlers(const void* cookie);
 
+    // Non-copyable
+    MavlinkCommandReceiver(const MavlinkCommandReceiver&) = delete;
+    const MavlinkCommandReceiver& operator=(const MavlinkCommandReceiver&) = delete;
+
 private:
     SystemImpl& _parent;
 
     void receive_command_int(const mavlink_message_t& message);
     void receive_command_long(const mavlink_message_t& message);
 
-    struct MAVLinkCommandIntHandlerTableEntry {
-        uint16_t cmd_id;
+    struct CommandIntEntry {
         MavlinkCommandIntHandler callback;
+        MavlinkCommandIntAsyncHandler async_callback;
         const void* cookie; // This is the identification to unregister.
     };
 
-    struct MAVLinkCommandLongHandlerTableEntry {
-        uint16_t cmd_id;
+    struct CommandLongEntry {
         MavlinkCommandLongHandler callback;
+        MavlinkCommandLongAsyncHandler async_callback;
         const void* cookie; // This is the identification to unregister.
     };
 
-    std::mutex _mavlink_command_handler_table_mutex{};
-    std::vector<MAVLinkCommandIntHandlerTableEntry> _mavlink_command_int_handler_table{};
-    std::vector<MAVLinkCommandLongHandlerTableEntry> _mavlink_command_long_handler_table{};
+    struct Handlers {
+        std::vector<CommandIntEntry> int_entries{};
+        std::vector<CommandLongEntry> long_entries{};
+    };
+
+    // Indexed by MAV_CMD. The IDs go up to 65535 but are clustered, so the
+    // table is split into pages which are only created once used.
+    //
+    // Like the message handler table, the table is never modified once
+    // published. Registering copies it, and the page which changes, and swaps
+    // the copy in, so receiving a command never takes a lock.
+    static constexpr std::size_t PAGE_SIZE = 256;
+    using Page = std::array<Handlers, PAGE_SIZE>;
+    using Table = std::array<std::shared_ptr<const Page>, 65536 / PAGE_SIZE>;
+
+    static const Handlers* find_handlers(const Table& table, uint16_t cmd_id);
+    template<typename Modify> void modify_handlers(uint16_t cmd_id, const Modify& modify);
+    void publish_table(std::shared_ptr<const Table> new_table);
+    void start_in_progress_acks();
+
+    template<typename Command, typename Entry>
+    void dispatch(const Command& command, const std::vector<Entry>& entries);
+
+    // Shared with the pending commands, which might outlive the receiver.
+    struct AckSender;
+    template<typename Command>
+    std::shared_ptr<PendingCommand::State> start_pending(const Command& command);
+
+    std::mutex _table_mutex{};
+    std::shared_ptr<const Table> _table;
+    std::atomic<std::thread::id> _dispatching_thread{};
+
+    static constexpr float IN_PROGRESS_INTERVAL_S = 0.5f;
+    std::shared_ptr<AckSender> _ack_sender;
+    void* _in_progress_cookie{nullptr};
 };
 
 } // namespace mavsdk
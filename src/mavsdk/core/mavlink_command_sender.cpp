@@ -1,7 +1,10 @@
 #include "mavlink_command_sender.h"
+#include "rtt_estimator.h"
+#include "sync_waiter.h"
 #include "system_impl.h"
+#include "trace.h"
+#include <algorithm>
 #include <cmath>
-#include <future>
 #include <memory>
 #include <unused.h>
 
@@ -30,42 +33,38 @@ MavlinkCommandSender::~MavlinkCommandSender()
 MavlinkCommandSender::Result
 MavlinkCommandSender::send_command(const MavlinkCommandSender::CommandInt& command)
 {
-    // We wrap the async call with a promise and future.
-    auto prom = std::make_shared<std::promise<Result>>();
-    auto res = prom->get_future();
+    // We wrap the async call with a waiter on our stack.
+    SyncWaiter<Result> waiter;
 
-    queue_command_async(command, [prom](Result result, float progress) {
+    queue_command_async(command, [&waiter](Result result, float progress) {
         UNUSED(progress);
-        // We can only fulfill the promise once in C++11.
-        // Therefore, we have to ignore the IN_PROGRESS state and wait
-        // for the final result.
+        // The waiter can only be completed once, so we have to ignore the
+        // IN_PROGRESS state and wait for the final result.
         if (result != Result::InProgress) {
-            prom->set_value(result);
+            waiter.complete(result);
         }
     });
 
     // Block now to wait for result.
-    return res.get();
+    return waiter.wait();
 }
 
 MavlinkCommandSender::Result
 MavlinkCommandSender::send_command(const MavlinkCommandSender::CommandLong& command)
 {
-    // We wrap the async call with a promise and future.
-    auto prom = std::make_shared<std::promise<Result>>();
-    auto res = prom->get_future();
+    // We wrap the async call with a waiter on our stack.
+    SyncWaiter<Result> waiter;
 
-    queue_command_async(command, [prom](Result result, float progress) {
+    queue_command_async(command, [&waiter](Result result, float progress) {
         UNUSED(progress);
-        // We can only fulfill the promise once in C++11.
-        // Therefore, we have to ignore the IN_PROGRESS state and wait
-        // for the final result.
+        // The waiter can only be completed once, so we have to ignore the
+        // IN_PROGRESS state and wait for the final result.
         if (result != Result::InProgress) {
-            prom->set_value(result);
+            waiter.complete(result);
         }
     });
 
-    return res.get();
+    return waiter.wait();
 }
 
 void MavlinkCommandSender::queue_command_async(
@@ -76,24 +75,13 @@ void MavlinkCommandSender::queue_command_async(
                    << (int)(command.target_system_id) << ", " << (int)(command.target_component_id);
     }
 
-    CommandIdentification identification = identification_from_command(command);
-
-    for (const auto& work : _work_queue) {
-        if (work->identification == identification) {
-            LogWarn() << "Dropping command " << static_cast<int>(identification.command)
-                      << " that is already being sent";
-            auto temp_callback = callback;
-            call_callback(temp_callback, Result::CommandDenied, NAN);
-            return;
-        }
-    }
-
-    auto new_work = std::make_shared<Work>();
+    auto new_work = make_pooled<Work>(_work_pool);
     new_work->timeout_s = _parent.timeout_s();
     new_work->command = command;
-    new_work->identification = identification;
+    new_work->identification = identification_from_command(command);
     new_work->callback = callback;
-    _work_queue.push_back(new_work);
+    MAVSDK_TRACE_INSTANT("command", "queue_command", command.command);
+    queue_work(new_work);
 }
 
 void MavlinkCommandSender::queue_command_async(
@@ -104,31 +92,50 @@ void MavlinkCommandSender::queue_command_async(
                    << (int)(command.target_system_id) << ", " << (int)(command.target_component_id);
     }
 
-    CommandIdentification identification = identification_from_command(command);
+    auto new_work = make_pooled<Work>(_work_pool);
+    new_work->timeout_s = _parent.timeout_s();
+    new_work->command = command;
+    new_work->identification = identification_from_command(command);
+    new_work->callback = callback;
+    MAVSDK_TRACE_INSTANT("command", "queue_command", command.command);
+    queue_work(new_work);
+}
+
+void MavlinkCommandSender::queue_work(const std::shared_ptr<Work>& new_work)
+{
+    WorkList to_send;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
 
-    for (const auto& work : _work_queue) {
-        if (work->identification == identification) {
-            LogWarn() << "Dropping command " << static_cast<int>(identification.command)
+        if (_works.find(new_work->identification) != _works.end()) {
+            LogWarn() << "Dropping command " << static_cast<int>(new_work->identification.command)
                       << " that is already being sent";
-            auto temp_callback = callback;
-            call_callback(temp_callback, Result::CommandDenied, NAN);
+            call_callback(std::move(new_work->callback), Result::CommandDenied, NAN);
             return;
         }
+        _works.emplace(new_work->identification, new_work);
+
+        auto& queue = _command_id_queues[new_work->identification.command];
+        if (is_blocked(queue, *new_work)) {
+            if (_command_debugging) {
+                LogDebug() << "Command " << static_cast<int>(new_work->identification.command)
+                           << " is already being sent, waiting...";
+            }
+            queue.waiting.push_back(new_work);
+        } else {
+            start_work_locked(queue, new_work, to_send);
+        }
     }
 
-    auto new_work = std::make_shared<Work>();
-    new_work->timeout_s = _parent.timeout_s();
-    new_work->command = command;
-    new_work->identification = identification;
-    new_work->callback = callback;
-    new_work->time_started = _parent.get_time().steady_time();
-    _work_queue.push_back(new_work);
+    // Sent right away instead of on the next work tick.
+    send_work(to_send);
 }
 
-void MavlinkCommandSender::receive_command_ack(mavlink_message_t message)
+void MavlinkCommandSender::receive_command_ack(const mavlink_message_t& message)
 {
     mavlink_command_ack_t command_ack;
     mavlink_msg_command_ack_decode(&message, &command_ack);
+    MAVSDK_TRACE_SCOPE("command", "receive_command_ack", command_ack.command);
 
     if ((command_ack.target_system && command_ack.target_system != _parent.get_own_system_id()) ||
         (command_ack.target_component &&
@@ -143,32 +150,37 @@ void MavlinkCommandSender::receive_command_ack(mavlink_message_t message)
         return;
     }
 
-    LockedQueue<Work>::Guard work_queue_guard(_work_queue);
-
-    for (auto it = _work_queue.begin(); it != _work_queue.end(); ++it) {
-        auto work = *it;
-
-        if (!work) {
-            LogErr() << "No work available! (should not happen #1)";
-            return;
+    CommandResultCallback temp_callback = nullptr;
+    std::pair<Result, float> temp_result{Result::UnknownError, NAN};
+    WorkList to_send;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        std::shared_ptr<Work> work;
+        auto queue_it = _command_id_queues.find(command_ack.command);
+        if (queue_it != _command_id_queues.end()) {
+            for (const auto& in_flight : queue_it->second.in_flight) {
+                if ((in_flight->identification.target_system_id == 0 ||
+                     in_flight->identification.target_system_id == message.sysid) &&
+                    (in_flight->identification.target_component_id == 0 ||
+                     in_flight->identification.target_component_id == message.compid)) {
+                    work = in_flight;
+                    break;
+                }
+            }
         }
 
-        if (work->identification.command != command_ack.command ||
-            (work->identification.target_system_id != 0 &&
-             work->identification.target_system_id != message.sysid) ||
-            (work->identification.target_component_id != 0 &&
-             work->identification.target_component_id != message.compid)) {
+        if (!work) {
             if (_command_debugging) {
-                LogDebug() << "Command ack for " << command_ack.command
-                           << " (from: " << std::to_string(message.sysid) << "/"
-                           << std::to_string(message.compid) << ")"
-                           << " does not match command " << work->identification.command
-                           << " (to: " << std::to_string(work->identification.target_system_id)
-                           << "/" << std::to_string(work->identification.target_component_id) << ")"
-                           << " after " << _parent.get_time().elapsed_since_s(work->time_started)
-                           << " s";
+                LogDebug() << "Received ack from " << static_cast<int>(message.sysid) << '/'
+                           << static_cast<int>(message.compid) << " for not-existing command: "
+                           << static_cast<int>(command_ack.command) << "! Ignoring...";
+            } else {
+                LogWarn() << "Received ack for not-existing command: "
+                          << static_cast<int>(command_ack.command) << "! Ignoring...";
             }
-            continue;
+            return;
         }
 
         if (_command_debugging) {
@@ -177,28 +189,31 @@ void MavlinkCommandSender::receive_command_ack(mavlink_message_t message)
                        << _parent.get_time().elapsed_since_s(work->time_started) << " s";
         }
 
-        CommandResultCallback temp_callback = work->callback;
-        std::pair<Result, float> temp_result{Result::UnknownError, NAN};
+        // Only the first ack of a command sent once tells the round trip time.
+        if (!work->acked && work->retransmissions == 0) {
+            _parent.add_rtt_sample(_parent.get_time().elapsed_since_s(work->time_started));
+        }
+        work->acked = true;
 
         switch (command_ack.result) {
             case MAV_RESULT_ACCEPTED:
                 _parent.unregister_timeout_handler(work->timeout_cookie);
                 temp_result = {Result::Success, 1.0f};
-                _work_queue.erase(it);
+                finish_work_locked(work, to_send);
                 break;
 
             case MAV_RESULT_DENIED:
                 LogWarn() << "command denied (" << work->identification.command << ").";
                 _parent.unregister_timeout_handler(work->timeout_cookie);
                 temp_result = {Result::CommandDenied, NAN};
-                _work_queue.erase(it);
+                finish_work_locked(work, to_send);
                 break;
 
             case MAV_RESULT_UNSUPPORTED:
                 LogWarn() << "command unsupported (" << work->identification.command << ").";
                 _parent.unregister_timeout_handler(work->timeout_cookie);
                 temp_result = {Result::Unsupported, NAN};
-                _work_queue.erase(it);
+                finish_work_locked(work, to_send);
                 break;
 
             case MAV_RESULT_TEMPORARILY_REJECTED:
@@ -206,13 +221,13 @@ void MavlinkCommandSender::receive_command_ack(mavlink_message_t message)
                           << ").";
                 _parent.unregister_timeout_handler(work->timeout_cookie);
                 temp_result = {Result::CommandDenied, NAN};
-                _work_queue.erase(it);
+                finish_work_locked(work, to_send);
                 break;
 
             case MAV_RESULT_FAILED:
                 _parent.unregister_timeout_handler(work->timeout_cookie);
                 temp_result = {Result::CommandDenied, NAN};
-                _work_queue.erase(it);
+                finish_work_locked(work, to_send);
                 break;
 
             case MAV_RESULT_IN_PROGRESS:
@@ -242,45 +257,44 @@ void MavlinkCommandSender::receive_command_ack(mavlink_message_t message)
                 break;
         }
 
-        if (temp_callback != nullptr) {
-            call_callback(temp_callback, temp_result.first, temp_result.second);
+        // Once done, the callback is not needed anymore and can be moved out.
+        if (_works.find(work->identification) == _works.end()) {
+            temp_callback = std::move(work->callback);
+        } else {
+            temp_callback = work->callback;
         }
-
-        return;
     }
 
-    if (_command_debugging) {
-        LogDebug() << "Received ack from " << static_cast<int>(message.sysid) << '/'
-                   << static_cast<int>(message.compid)
-                   << " for not-existing command: " << static_cast<int>(command_ack.command)
-                   << "! Ignoring...";
-    } else {
-        LogWarn() << "Received ack for not-existing command: "
-                  << static_cast<int>(command_ack.command) << "! Ignoring...";
+    if (temp_callback != nullptr) {
+        call_callback(std::move(temp_callback), temp_result.first, temp_result.second);
     }
+
+    // A command with the same ID might have been waiting for this one to be done.
+    send_work(to_send);
 }
 
 void MavlinkCommandSender::receive_timeout(const CommandIdentification& identification)
 {
-    bool found_command = false;
+    MAVSDK_TRACE_SCOPE("command", "receive_timeout", identification.command);
+
     CommandResultCallback temp_callback = nullptr;
     std::pair<Result, float> temp_result{Result::UnknownError, NAN};
-
-    LockedQueue<Work>::Guard work_queue_guard(_work_queue);
-
-    for (auto it = _work_queue.begin(); it != _work_queue.end(); ++it) {
-        auto work = *it;
-
-        if (!work) {
-            LogErr() << "No work available! (should not happen #2)";
+    std::optional<mavlink_message_t> maybe_retransmit;
+    CommandResultCallback retransmit_callback = nullptr;
+    uint16_t command_id = 0;
+    WorkList to_send;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto it = _works.find(identification);
+        if (it == _works.end()) {
+            LogWarn() << "Timeout for not-existing command: "
+                      << static_cast<int>(identification.command) << "! Ignoring...";
             return;
         }
-
-        if (work->identification != identification) {
-            continue;
-        }
-
-        found_command = true;
+        auto work = it->second;
+        command_id = work->identification.command;
 
         if (work->retries_to_do > 0) {
             // We're not sure the command arrived, let's retransmit.
@@ -289,97 +303,141 @@ void MavlinkCommandSender::receive_timeout(const CommandIdentification& identifi
                       << " s, retries to do: " << work->retries_to_do << "  ("
                       << work->identification.command << ").";
 
-            mavlink_message_t message = create_mavlink_message(work->command);
-            if (!_parent.send_message(message)) {
-                LogErr() << "connection send error in retransmit (" << work->identification.command
-                         << ").";
-                temp_callback = work->callback;
-                temp_result = {Result::ConnectionError, NAN};
-            }
+            maybe_retransmit = create_mavlink_message(work->command);
             --work->retries_to_do;
+            ++work->retransmissions;
             _parent.register_timeout_handler(
                 [this, identification = work->identification] { receive_timeout(identification); },
-                work->timeout_s,
+                RttEstimator::backoff_s(work->timeout_s, work->retransmissions),
                 &work->timeout_cookie);
 
+            // A failed send gets reported, we keep retrying nevertheless.
+            retransmit_callback = work->callback;
+
         } else {
             // We have tried retransmitting, giving up now.
             LogErr() << "Retrying failed (" << work->identification.command << ")";
 
-            temp_callback = work->callback;
+            temp_callback = std::move(work->callback);
             temp_result = {Result::ConnectionError, NAN};
-            _work_queue.erase(it);
-            break;
+            finish_work_locked(work, to_send);
         }
     }
 
-    if (temp_callback != nullptr) {
-        call_callback(temp_callback, temp_result.first, temp_result.second);
+    if (maybe_retransmit && !_parent.send_message(maybe_retransmit.value())) {
+        LogErr() << "connection send error in retransmit (" << command_id << ").";
+        temp_callback = retransmit_callback;
+        temp_result = {Result::ConnectionError, NAN};
     }
 
-    if (!found_command) {
-        LogWarn() << "Timeout for not-existing command: "
-                  << static_cast<int>(identification.command) << "! Ignoring...";
+    if (temp_callback != nullptr) {
+        call_callback(std::move(temp_callback), temp_result.first, temp_result.second);
     }
+
+    send_work(to_send);
 }
 
-void MavlinkCommandSender::do_work()
+bool MavlinkCommandSender::is_blocked(const CommandIdQueue& queue, const Work& work)
 {
-    LockedQueue<Work>::Guard work_queue_guard(_work_queue);
-
-    for (const auto& work : _work_queue) {
-        if (work->already_sent) {
+    // Check if command with same command ID is already being sent to
+    // the same target. An ack only carries the command ID, so we can
+    // only tell acks apart if they come from different components.
+    //
+    // Pipelined commands to the same target only wait for each other once
+    // there are too many in flight. Their acks are matched in the order the
+    // commands were sent, as the target handles them in that order.
+    const bool pipelined = is_pipelined(work.identification);
+    std::size_t pipelined_in_flight = 0;
+    for (const auto& in_flight : queue.in_flight) {
+        if (!targets_overlap(in_flight->identification, work.identification)) {
             continue;
         }
+        if (!pipelined || !is_pipelined(in_flight->identification) ||
+            ++pipelined_in_flight >= MAX_PIPELINED_IN_FLIGHT) {
+            return true;
+        }
+    }
+    return false;
+}
 
-        bool already_being_sent = false;
-        for (const auto& other_work : _work_queue) {
-            // Ignore itself:
-            if (other_work == work) {
-                continue;
-            }
+bool MavlinkCommandSender::is_pipelined(const CommandIdentification& identification)
+{
+    // Single image captures, told apart by their sequence number, so the
+    // trigger rate is limited by the camera rather than by the round trip.
+    return identification.command == MAV_CMD_IMAGE_START_CAPTURE &&
+           identification.maybe_param1 != 0;
+}
 
-            // Check if command with same command ID is already being sent.
-            if (other_work->already_sent &&
-                other_work->identification.command == work->identification.command) {
-                if (_command_debugging) {
-                    LogDebug() << "Command " << static_cast<int>(work->identification.command)
-                               << " is already being sent, waiting...";
-                }
-                already_being_sent = true;
-                break;
-            }
-        }
+void MavlinkCommandSender::start_work_locked(
+    CommandIdQueue& queue, const std::shared_ptr<Work>& work, WorkList& to_send)
+{
+    work->time_started = _parent.get_time().steady_time();
+    queue.in_flight.push_back(work);
 
-        if (already_being_sent) {
+    _parent.register_timeout_handler(
+        [this, identification = work->identification] { receive_timeout(identification); },
+        work->timeout_s,
+        &work->timeout_cookie);
+
+    to_send.push_back(work);
+}
+
+void MavlinkCommandSender::finish_work_locked(const std::shared_ptr<Work>& work, WorkList& to_send)
+{
+    _works.erase(work->identification);
+
+    auto queue_it = _command_id_queues.find(work->identification.command);
+    if (queue_it == _command_id_queues.end()) {
+        return;
+    }
+    auto& queue = queue_it->second;
+
+    queue.in_flight.erase(
+        std::remove(queue.in_flight.begin(), queue.in_flight.end(), work), queue.in_flight.end());
+
+    // Start whatever was waiting for this one, oldest first.
+    for (auto it = queue.waiting.begin(); it != queue.waiting.end();) {
+        if (is_blocked(queue, **it)) {
+            ++it;
             continue;
         }
+        start_work_locked(queue, *it, to_send);
+        it = queue.waiting.erase(it);
+    }
 
-        // LogDebug() << "sending it the first time (" << work->mavlink_command << ")";
-        work->time_started = _parent.get_time().steady_time();
+    if (queue.in_flight.empty() && queue.waiting.empty()) {
+        _command_id_queues.erase(queue_it);
+    }
+}
 
-        {
-            mavlink_message_t message = create_mavlink_message(work->command);
-            if (!_parent.send_message(message)) {
-                LogErr() << "connection send error (" << work->identification.command << ")";
-            } else {
-                if (_command_debugging) {
-                    LogDebug() << "Sent command " << static_cast<int>(work->identification.command);
-                }
+void MavlinkCommandSender::send_work(const WorkList& to_send)
+{
+    for (const auto& work : to_send) {
+        mavlink_message_t message = create_mavlink_message(work->command);
+        if (!_parent.send_message(message)) {
+            LogErr() << "connection send error (" << work->identification.command << ")";
+        } else {
+            if (_command_debugging) {
+                LogDebug() << "Sent command " << static_cast<int>(work->identification.command);
             }
         }
+    }
+}
 
-        work->already_sent = true;
+bool MavlinkCommandSender::targets_overlap(
+    const CommandIdentification& lhs, const CommandIdentification& rhs)
+{
+    // 0 is a wildcard for the target, so it overlaps with everything.
+    const auto overlap = [](uint8_t lhs_id, uint8_t rhs_id) {
+        return lhs_id == 0 || rhs_id == 0 || lhs_id == rhs_id;
+    };
 
-        _parent.register_timeout_handler(
-            [this, identification = work->identification] { receive_timeout(identification); },
-            work->timeout_s,
-            &work->timeout_cookie);
-    }
+    return overlap(lhs.target_system_id, rhs.target_system_id) &&
+           overlap(lhs.target_component_id, rhs.target_component_id);
 }
 
 void MavlinkCommandSender::call_callback(
-    const CommandResultCallback& callback, Result result, float progress)
+    CommandResultCallback callback, Result result, float progress)
 {
     if (!callback) {
         return;
@@ -387,9 +445,10 @@ void MavlinkCommandSender::call_callback(
 
     // It seems that we need to queue the callback on the thread pool otherwise
     // we lock ourselves out when we send a command in the callback receiving a command result.
-    auto temp_callback = callback;
-    _parent.call_user_callback(
-        [temp_callback, result, progress]() { temp_callback(result, progress); });
+    // Moved rather than copied, the lambda then fits the inline buffer of the queue.
+    _parent.call_user_callback([temp_callback = std::move(callback), result, progress]() {
+        temp_callback(result, progress);
+    });
 }
 
 mavlink_message_t MavlinkCommandSender::create_mavlink_message(const Command& command)
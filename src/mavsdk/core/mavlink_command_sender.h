@@ -1,16 +1,19 @@
 #pragma once
 
 #include "mavlink_include.h"
-#include "locked_queue.h"
 #include "mavsdk_time.h"
+#include "slab_pool.h"
 #include <cmath>
 #include <cstdint>
+#include <deque>
 #include <string>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
 namespace mavsdk {
 
@@ -76,10 +79,11 @@ public:
     void queue_command_async(const CommandInt& command, const CommandResultCallback& callback);
     void queue_command_async(const CommandLong& command, const CommandResultCallback& callback);
 
-    void do_work();
-
     static const int DEFAULT_COMPONENT_ID_AUTOPILOT = MAV_COMP_ID_AUTOPILOT1;
 
+    // How many single image captures can be in flight to the same camera.
+    static constexpr std::size_t MAX_PIPELINED_IN_FLIGHT = 8;
+
     // Non-copyable
     MavlinkCommandSender(const MavlinkCommandSender&) = delete;
     const MavlinkCommandSender& operator=(const MavlinkCommandSender&) = delete;
@@ -106,6 +110,18 @@ private:
         bool operator!=(const CommandIdentification& other) const { return !(*this == other); }
     };
 
+    struct CommandIdentificationHash {
+        std::size_t operator()(const CommandIdentification& identification) const
+        {
+            const uint64_t low = (static_cast<uint64_t>(identification.command) << 16) |
+                                 (static_cast<uint64_t>(identification.target_system_id) << 8) |
+                                 identification.target_component_id;
+            const uint64_t high = (static_cast<uint64_t>(identification.maybe_param1) << 32) |
+                                  identification.maybe_param2;
+            return std::hash<uint64_t>{}(low ^ (high * 0x9e3779b97f4a7c15ULL));
+        }
+    };
+
     struct Work {
         Command command;
         CommandIdentification identification{};
@@ -114,9 +130,20 @@ private:
         void* timeout_cookie = nullptr;
         double timeout_s{0.5};
         int retries_to_do{3};
-        bool already_sent{false};
+        int retransmissions{0};
+        bool acked{false};
+    };
+
+    // An ack only carries the command ID, so commands with the same ID are
+    // sent one at a time to overlapping targets, the others wait in order.
+    // Pipelined commands are the exception, see is_pipelined().
+    struct CommandIdQueue {
+        std::vector<std::shared_ptr<Work>> in_flight{};
+        std::deque<std::shared_ptr<Work>> waiting{};
     };
 
+    using WorkList = std::vector<std::shared_ptr<Work>>;
+
     template<typename CommandType>
     CommandIdentification identification_from_command(const CommandType& command)
     {
@@ -136,6 +163,14 @@ private:
                     }
                 }
             }
+        } else if (command.command == MAV_CMD_IMAGE_START_CAPTURE) {
+            // A single capture carries a sequence number, which tells
+            // captures apart, also for the camera when one is sent again.
+            if (command.params.maybe_param3 && command.params.maybe_param4 &&
+                std::lround(command.params.maybe_param3.value()) == 1) {
+                identification.maybe_param1 =
+                    static_cast<uint32_t>(std::lround(command.params.maybe_param4.value()));
+            }
         }
         identification.target_system_id = command.target_system_id;
         identification.target_component_id = command.target_component_id;
@@ -143,17 +178,38 @@ private:
         return identification;
     }
 
-    void receive_command_ack(mavlink_message_t message);
+    void queue_work(const std::shared_ptr<Work>& new_work);
+
+    void receive_command_ack(const mavlink_message_t& message);
     void receive_timeout(const CommandIdentification& identification);
 
-    void call_callback(const CommandResultCallback& callback, Result result, float progress);
+    // These need _mutex to be held, the work to send is appended to to_send.
+    static bool is_blocked(const CommandIdQueue& queue, const Work& work);
+    static bool is_pipelined(const CommandIdentification& identification);
+    void start_work_locked(
+        CommandIdQueue& queue, const std::shared_ptr<Work>& work, WorkList& to_send);
+    void finish_work_locked(const std::shared_ptr<Work>& work, WorkList& to_send);
+
+    void send_work(const WorkList& to_send);
+
+    static bool targets_overlap(const CommandIdentification& lhs, const CommandIdentification& rhs);
+
+    void call_callback(CommandResultCallback callback, Result result, float progress);
 
     mavlink_message_t create_mavlink_message(const Command& command);
 
     float maybe_reserved(const std::optional<float>& maybe_param) const;
 
     SystemImpl& _parent;
-    LockedQueue<Work> _work_queue{};
+
+    std::mutex _mutex{};
+    // All queued commands, whether sent already or not.
+    std::unordered_map<CommandIdentification, std::shared_ptr<Work>, CommandIdentificationHash>
+        _works{};
+    std::unordered_map<uint16_t, CommandIdQueue> _command_id_queues{};
+
+    // Commands come and go all the time, so their work items are recycled.
+    std::shared_ptr<SlabPool> _work_pool{make_shared_slab_pool<Work>(16)};
 
     bool _command_debugging{false};
 };
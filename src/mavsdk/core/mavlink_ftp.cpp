@@ -7,6 +7,7 @@
 #include "stackoverflow_unistd.h"
 #else
 #include <dirent.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 #include <fcntl.h>
@@ -18,24 +19,15 @@
 
 #include "crc32.h"
 #include "fs.h"
+#include "trace.h"
+#include "unused.h"
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
 
 namespace mavsdk {
 
-bool seq_lt(uint16_t a, uint16_t b)
-{
-    // From https://en.wikipedia.org/wiki/Serial_number_arithmetic
-    return (a < b && (b - a) < (std::numeric_limits<uint16_t>::max() / 2)) ||
-           (a > b && (a - b) > (std::numeric_limits<uint16_t>::max() / 2));
-}
-
-MavlinkFtp::MavlinkFtp(SystemImpl& system_impl) : _system_impl(system_impl)
-{
-    _system_impl.register_mavlink_message_handler(
-        MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL,
-        [this](const mavlink_message_t& message) { process_mavlink_ftp_message(message); },
-        this);
-}
+MavlinkFtp::MavlinkFtp(SystemImpl& system_impl) : _system_impl(system_impl) {}
 
 void MavlinkFtp::process_mavlink_ftp_message(const mavlink_message_t& msg)
 {
@@ -211,85 +203,192 @@ void MavlinkFtp::process_mavlink_ftp_message(const mavlink_message_t& msg)
             _get_target_component_id(),
             reinterpret_cast<const uint8_t*>(payload));
         _system_impl.send_message(_last_reply);
+    } else {
+        _send_burst();
     }
 }
 
 MavlinkFtp::~MavlinkFtp()
 {
     _system_impl.unregister_all_mavlink_request_message_handlers(this);
+
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
+    for (auto& session : _client_sessions) {
+        _stop_timer(*session);
+    }
 }
 
-void MavlinkFtp::_process_ack(PayloadHeader* payload)
+std::shared_ptr<MavlinkFtp::ClientSession> MavlinkFtp::_new_client_session()
 {
-    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    if (_client_sessions.size() >= max_client_sessions) {
+        return nullptr;
+    }
+    auto session = std::make_shared<ClientSession>();
+    session->id = ++_next_client_session_id;
+    _client_sessions.push_back(session);
+    return session;
+}
 
-    if (seq_lt(payload->seq_number, _seq_number)) {
-        // (payload->seq_number < _seq_number) with wrap around
-        // received an ack for a previous seq that we already considered done
-        return;
+void MavlinkFtp::_finish_client_session(ClientSession& session)
+{
+    _stop_timer(session);
+    session.op = CMD_NONE;
+    const bool held_server_session = session.session_valid;
+
+    _client_sessions.erase(
+        std::remove_if(
+            _client_sessions.begin(),
+            _client_sessions.end(),
+            [&](const std::shared_ptr<ClientSession>& other) { return other.get() == &session; }),
+        _client_sessions.end());
+
+    if (held_server_session) {
+        _retry_waiting_open();
     }
+}
 
-    if (_curr_op != payload->req_opcode) {
-        LogWarn() << "Received ACK not matching our current operation";
-        return;
+std::shared_ptr<MavlinkFtp::ClientSession>
+MavlinkFtp::_client_session_for(const PayloadHeader* payload)
+{
+    // The server replies with the sequence number of the request plus one.
+    const uint16_t request_seq_number = payload->seq_number - 1;
+
+    for (const auto& session : _client_sessions) {
+        if (session->op != payload->req_opcode || session->waiting_for_session) {
+            continue;
+        }
+
+        switch (session->op) {
+            case CMD_BURST_READ_FILE:
+                // Burst packets are numbered by the server, only the session tells them apart.
+                if (session->session == payload->session) {
+                    return session;
+                }
+                break;
+
+            case CMD_WRITE_FILE:
+                if (std::any_of(
+                        session->writes_in_flight.begin(),
+                        session->writes_in_flight.end(),
+                        [&](const WriteInFlight& write) {
+                            return write.payload.seq_number == request_seq_number;
+                        })) {
+                    return session;
+                }
+                break;
+
+            default:
+                if (session->seq_number == request_seq_number) {
+                    return session;
+                }
+                break;
+        }
     }
+    return nullptr;
+}
 
-    switch (_curr_op) {
-        case CMD_NONE:
-            LogWarn() << "Received ACK without active operation";
-            break;
+bool MavlinkFtp::_holds_server_session() const
+{
+    return std::any_of(
+        _client_sessions.begin(),
+        _client_sessions.end(),
+        [](const std::shared_ptr<ClientSession>& session) { return session->session_valid; });
+}
+
+void MavlinkFtp::_retry_waiting_open()
+{
+    for (const auto& session : _client_sessions) {
+        if (session->waiting_for_session) {
+            session->waiting_for_session = false;
+            _send_path_command(*session, 0);
+            return;
+        }
+    }
+}
 
+void MavlinkFtp::_process_ack(PayloadHeader* payload)
+{
+    MAVSDK_TRACE_SCOPE("ftp", "process_ack", payload->req_opcode);
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
+
+    const auto session = _client_session_for(payload);
+    if (!session) {
+        // E.g. an ack for a request we already considered done, or which
+        // is not ours.
+        return;
+    }
+
+    switch (session->op) {
         case CMD_OPEN_FILE_RO:
-            _curr_op = CMD_NONE;
-            _session_valid = true;
-            _session = payload->session;
-            _bytes_transferred = 0;
-            _file_size = *(reinterpret_cast<uint32_t*>(payload->data));
-            _call_op_progress_callback(_bytes_transferred, _file_size);
-            _read();
+            session->session_valid = true;
+            session->session = payload->session;
+            session->bytes_transferred = 0;
+            session->file_size = *(reinterpret_cast<uint32_t*>(payload->data));
+            if (session->memory_callback) {
+                session->buffer.reserve(session->file_size);
+            }
+            _call_op_progress_callback(*session, session->bytes_transferred, session->file_size);
+            _start_read(*session);
             break;
 
         case CMD_READ_FILE:
-            _ofstream.stream.write(reinterpret_cast<const char*>(payload->data), payload->size);
-            if (!_ofstream.stream) {
-                _session_result = ServerResult::ERR_FILE_IO_ERROR;
-                _end_read_session();
+            if (!_write_at(*session, payload->offset, payload->data, payload->size)) {
                 return;
             }
-            _bytes_transferred += payload->size;
-            _call_op_progress_callback(_bytes_transferred, _file_size);
-            _read();
+            session->bytes_transferred += payload->size;
+            if (!session->missing_ranges.empty()) {
+                if (payload->size == 0) {
+                    LogErr() << "FTP read returned no data at offset " << payload->offset;
+                    session->session_result = ServerResult::ERR_FAIL;
+                    _end_read_session(*session);
+                    return;
+                }
+                auto& range = session->missing_ranges.front();
+                range.first += payload->size;
+                if (range.first >= range.second) {
+                    session->missing_ranges.erase(session->missing_ranges.begin());
+                }
+            }
+            _call_op_progress_callback(*session, session->bytes_transferred, session->file_size);
+            _read(*session);
+            break;
+
+        case CMD_BURST_READ_FILE:
+            _process_burst_data(*session, payload);
             break;
 
         case CMD_OPEN_FILE_WO:
-            _curr_op = CMD_NONE;
-            _session_valid = true;
-            _session = payload->session;
-            _bytes_transferred = 0;
-            _call_op_progress_callback(_bytes_transferred, _file_size);
-            _write();
+            session->session_valid = true;
+            session->session = payload->session;
+            session->bytes_transferred = 0;
+            session->write_offset = 0;
+            session->writes_in_flight.clear();
+            session->write_window_limit = max_write_window;
+            _call_op_progress_callback(*session, session->bytes_transferred, session->file_size);
+            _write(*session);
             break;
 
         case CMD_WRITE_FILE:
-            _call_op_progress_callback(_bytes_transferred, _file_size);
-            _write();
+            _process_write_ack(*session, payload);
             break;
 
         case CMD_TERMINATE_SESSION:
-            _curr_op = CMD_NONE;
-            _session_valid = false;
-            _stop_timer();
-            _call_op_result_callback(_session_result);
+            _call_op_result_callback(*session, session->session_result);
+            _finish_client_session(*session);
             break;
 
         case CMD_RESET_SESSIONS:
-            _curr_op = CMD_NONE;
-            _session_valid = false;
-            _stop_timer();
-            _call_op_result_callback(_session_result);
+            _call_op_result_callback(*session, session->session_result);
+            _finish_client_session(*session);
+            // All sessions on the server are gone, including ones we might be waiting for.
+            _retry_waiting_open();
             break;
 
         case CMD_LIST_DIRECTORY: {
+            if (session->tree_listing) {
+                _process_tree_page(*session, payload);
+                break;
+            }
             bool added = false;
             uint8_t start = 0;
             for (uint8_t i = 0; i < payload->size; i++) {
@@ -297,129 +396,186 @@ void MavlinkFtp::_process_ack(PayloadHeader* payload)
                     std::string entry = std::string(reinterpret_cast<char*>(&payload->data[start]));
                     if (entry.length() > 0) {
                         added = true;
-                        _curr_directory_list.emplace_back(entry);
+                        session->directory_list.emplace_back(entry);
                     }
                     start = i + 1;
                 }
             }
             if (added) {
                 // Ask for next batch of file names
-                _list_directory(_curr_directory_list.size());
+                _list_directory(*session, session->directory_list.size());
             } else {
                 // We came to end - report entire list
-                _curr_op = CMD_NONE;
-                _stop_timer();
-                _call_dir_items_result_callback(ServerResult::SUCCESS, _curr_directory_list);
+                _call_dir_items_result_callback(
+                    *session, ServerResult::SUCCESS, session->directory_list);
+                _finish_client_session(*session);
             }
             break;
         }
 
         case CMD_CALC_FILE_CRC32: {
-            _curr_op = CMD_NONE;
             uint32_t checksum = *reinterpret_cast<uint32_t*>(payload->data);
-            _stop_timer();
-            _call_crc32_result_callback(ServerResult::SUCCESS, checksum);
+            _call_crc32_result_callback(*session, ServerResult::SUCCESS, checksum);
+            _finish_client_session(*session);
             break;
         }
 
         default:
-            _curr_op = CMD_NONE;
-            _stop_timer();
-            _call_op_result_callback(ServerResult::SUCCESS);
+            _call_op_result_callback(*session, ServerResult::SUCCESS);
+            _finish_client_session(*session);
             break;
     }
 }
 
 void MavlinkFtp::_process_nak(PayloadHeader* payload)
 {
-    if (payload != nullptr) {
-        ServerResult sr = static_cast<ServerResult>(payload->data[0]);
-        // PX4 Mavlink FTP returns "File doesn't exist" this way
-        if (sr == ServerResult::ERR_FAIL_ERRNO && payload->data[1] == ENOENT) {
-            sr = ServerResult::ERR_FAIL_FILE_DOES_NOT_EXIST;
-        }
-        _process_nak(sr);
+    MAVSDK_TRACE_SCOPE("ftp", "process_nak", payload->req_opcode);
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
+
+    const auto session = _client_session_for(payload);
+    if (!session) {
+        return;
+    }
+
+    if (session->op == CMD_WRITE_FILE &&
+        _retransmit_nacked_write(*session, payload->seq_number)) {
+        return;
+    }
+
+    ServerResult sr = static_cast<ServerResult>(payload->data[0]);
+    // PX4 Mavlink FTP returns "File doesn't exist" this way
+    if (sr == ServerResult::ERR_FAIL_ERRNO && payload->data[1] == ENOENT) {
+        sr = ServerResult::ERR_FAIL_FILE_DOES_NOT_EXIST;
     }
+    _process_nak(*session, sr);
 }
 
-void MavlinkFtp::_process_nak(ServerResult result)
+void MavlinkFtp::_process_nak(ClientSession& session, ServerResult result)
 {
-    std::lock_guard<std::mutex> lock(_curr_op_mutex);
-    switch (_curr_op) {
-        case CMD_NONE:
-            LogWarn() << "Received NAK without active operation";
-            break;
+    if ((session.op == CMD_OPEN_FILE_RO || session.op == CMD_OPEN_FILE_WO) &&
+        result == ServerResult::ERR_NO_SESSIONS_AVAILABLE && _holds_server_session()) {
+        // The server is out of sessions because of our other transfers, so
+        // we try again once one of them is done.
+        LogDebug() << "No FTP session available, waiting for another transfer to finish";
+        _stop_timer(session);
+        session.waiting_for_session = true;
+        return;
+    }
 
+    // After a timeout, there is no point in trying to close the session.
+    const bool terminate = session.session_valid && result != ServerResult::ERR_TIMEOUT;
+
+    switch (session.op) {
+        case CMD_BURST_READ_FILE:
+            if (result == ServerResult::ERR_UNKOWN_COMMAND || result == ServerResult::ERR_EOF) {
+                if (result == ServerResult::ERR_UNKOWN_COMMAND) {
+                    LogWarn() << "FTP server does not support burst reads, reading in chunks";
+                    _burst_support = BurstSupport::Unsupported;
+                }
+                // Whatever is left is read chunk by chunk, which also reports
+                // a file that is shorter than announced.
+                if (session.burst_offset < session.file_size) {
+                    session.missing_ranges.emplace_back(session.burst_offset, session.file_size);
+                }
+                _read(session);
+                return;
+            }
+            [[fallthrough]];
         case CMD_OPEN_FILE_RO:
         case CMD_READ_FILE:
-            _session_result = result;
-            if (_session_valid) {
+            session.session_result = result;
+            if (terminate) {
                 const bool delete_file = (result == ServerResult::ERR_FAIL_FILE_DOES_NOT_EXIST);
-                _end_read_session(delete_file);
+                _end_read_session(session, delete_file);
             } else {
-                _stop_timer();
-                _call_op_result_callback(_session_result);
+                _call_op_result_callback(session, session.session_result);
+                _finish_client_session(session);
             }
             break;
 
         case CMD_OPEN_FILE_WO:
         case CMD_WRITE_FILE:
-            _session_result = result;
-            if (_session_valid) {
-                _end_write_session();
+            session.session_result = result;
+            if (terminate) {
+                _end_write_session(session);
             } else {
-                _stop_timer();
-                _call_op_result_callback(_session_result);
+                _call_op_result_callback(session, session.session_result);
+                _finish_client_session(session);
             }
             break;
 
         case CMD_TERMINATE_SESSION:
-            _session_valid = false;
-            _stop_timer();
-            _call_op_result_callback(_session_result);
+            _call_op_result_callback(session, session.session_result);
+            _finish_client_session(session);
             break;
 
         case CMD_LIST_DIRECTORY:
-            _stop_timer();
-            if (!_curr_directory_list.empty()) {
-                _call_dir_items_result_callback(ServerResult::SUCCESS, _curr_directory_list);
+            if (session.tree_listing) {
+                _tree_page_failed(session, result);
+                break;
+            }
+            if (!session.directory_list.empty()) {
+                _call_dir_items_result_callback(
+                    session, ServerResult::SUCCESS, session.directory_list);
             } else {
-                _call_dir_items_result_callback(result, _curr_directory_list);
+                _call_dir_items_result_callback(session, result, session.directory_list);
             }
+            _finish_client_session(session);
             break;
 
         case CMD_CALC_FILE_CRC32:
-            _stop_timer();
-            _call_crc32_result_callback(result, 0);
+            _call_crc32_result_callback(session, result, 0);
+            _finish_client_session(session);
             break;
 
         default:
-            _stop_timer();
-            _call_op_result_callback(result);
+            _call_op_result_callback(session, result);
+            _finish_client_session(session);
             break;
     }
-    _curr_op = CMD_NONE;
 }
 
-void MavlinkFtp::_call_op_result_callback(ServerResult result)
+void MavlinkFtp::_call_op_result_callback(ClientSession& session, ServerResult result)
 {
-    if (_curr_op_result_callback) {
-        const auto temp_callback = _curr_op_result_callback;
+    if (session.memory_callback) {
+        const auto temp_callback = session.memory_callback;
+        std::vector<uint8_t> data;
+        if (result == ServerResult::SUCCESS) {
+            data = std::move(session.buffer);
+        }
+        _system_impl.call_user_callback([temp_callback, result, data = std::move(data)]() {
+            temp_callback(_translate(result), ProgressData{}, data);
+        });
+    } else if (session.stream_callback) {
+        if (result == ServerResult::SUCCESS) {
+            _hand_on_stream(session, true);
+        }
+        const auto temp_callback = session.stream_callback;
+        ProgressData progress;
+        progress.bytes_transferred = static_cast<uint32_t>(session.stream.next_offset());
+        progress.total_bytes = session.file_size;
+        _system_impl.call_user_callback([temp_callback, result, progress]() {
+            temp_callback(_translate(result), progress, {});
+        });
+    } else if (session.result_callback) {
+        const auto temp_callback = session.result_callback;
         _system_impl.call_user_callback(
             [temp_callback, result]() { temp_callback(_translate(result)); });
     }
 }
 
-void MavlinkFtp::_call_op_progress_callback(uint32_t bytes_read, uint32_t total_bytes)
+void MavlinkFtp::_call_op_progress_callback(
+    ClientSession& session, uint32_t bytes_read, uint32_t total_bytes)
 {
-    if (_curr_op_progress_callback) {
+    if (session.progress_callback) {
         // Slow callback down to only report ever 1%, otherwise we are slowing
         // everything down way too much.
-        int percentage = 100 * bytes_read / total_bytes;
-        if (_last_progress_percentage != percentage) {
-            _last_progress_percentage = percentage;
+        const int percentage =
+            total_bytes > 0 ? static_cast<int>(uint64_t{100} * bytes_read / total_bytes) : 100;
+        if (session.last_progress_percentage != percentage) {
+            session.last_progress_percentage = percentage;
 
-            const auto temp_callback = _curr_op_progress_callback;
+            const auto temp_callback = session.progress_callback;
             _system_impl.call_user_callback([temp_callback, bytes_read, total_bytes]() {
                 ProgressData progress;
                 progress.bytes_transferred = bytes_read;
@@ -430,19 +586,21 @@ void MavlinkFtp::_call_op_progress_callback(uint32_t bytes_read, uint32_t total_
     }
 }
 
-void MavlinkFtp::_call_dir_items_result_callback(ServerResult result, std::vector<std::string> list)
+void MavlinkFtp::_call_dir_items_result_callback(
+    const ClientSession& session, ServerResult result, std::vector<std::string> list)
 {
-    if (_curr_dir_items_result_callback) {
-        const auto temp_callback = _curr_dir_items_result_callback;
+    if (session.dir_items_callback) {
+        const auto temp_callback = session.dir_items_callback;
         _system_impl.call_user_callback(
             [temp_callback, result, list]() { temp_callback(_translate(result), list); });
     }
 }
 
-void MavlinkFtp::_call_crc32_result_callback(ServerResult result, uint32_t crc32)
+void MavlinkFtp::_call_crc32_result_callback(
+    const ClientSession& session, ServerResult result, uint32_t crc32)
 {
-    if (_current_crc32_result_callback) {
-        const auto temp_callback = _current_crc32_result_callback;
+    if (session.crc32_callback) {
+        const auto temp_callback = session.crc32_callback;
         _system_impl.call_user_callback(
             [temp_callback, result, crc32]() { temp_callback(_translate(result), crc32); });
     }
@@ -465,6 +623,8 @@ MavlinkFtp::ClientResult MavlinkFtp::_translate(ServerResult result)
             return ClientResult::Unsupported;
         case ServerResult::ERR_FAIL_FILE_DOES_NOT_EXIST:
             return ClientResult::FileDoesNotExist;
+        case ServerResult::ERR_NO_SESSIONS_AVAILABLE:
+            return ClientResult::Busy;
         default:
             return ClientResult::ProtocolError;
     }
@@ -472,27 +632,34 @@ MavlinkFtp::ClientResult MavlinkFtp::_translate(ServerResult result)
 
 void MavlinkFtp::reset_async(ResultCallback callback)
 {
-    std::lock_guard<std::mutex> lock(_curr_op_mutex);
-    if (_curr_op != CMD_NONE) {
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
+    const auto session = _new_client_session();
+    if (!session) {
         callback(ClientResult::Busy);
         return;
     }
 
     auto payload = PayloadHeader{};
-    payload.seq_number = _seq_number++;
-    payload.session = _session;
-    payload.opcode = _curr_op = CMD_RESET_SESSIONS;
+    payload.session = 0;
+    payload.opcode = session->op = CMD_RESET_SESSIONS;
     payload.offset = 0;
     payload.size = 0;
-    _curr_op_result_callback = callback;
-    _send_mavlink_ftp_message(payload);
+    session->result_callback = callback;
+    _send_mavlink_ftp_message(*session, payload);
 }
 
 void MavlinkFtp::download_async(
     const std::string& remote_path, const std::string& local_folder, DownloadCallback callback)
 {
-    std::lock_guard<std::mutex> lock(_curr_op_mutex);
-    if (_curr_op != CMD_NONE) {
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
+    if (remote_path.length() >= max_data_length) {
+        ProgressData empty{};
+        callback(ClientResult::InvalidParameter, empty);
+        return;
+    }
+
+    const auto session = _new_client_session();
+    if (!session) {
         ProgressData empty{};
         callback(ClientResult::Busy, empty);
         return;
@@ -500,141 +667,502 @@ void MavlinkFtp::download_async(
 
     std::string local_path = local_folder + path_separator + fs_filename(remote_path);
 
-    _ofstream.stream.open(local_path, std::fstream::trunc | std::fstream::binary);
-    _ofstream.path = local_path;
-    if (!_ofstream.stream) {
-        _end_read_session();
+    session->ofstream.stream.open(local_path, std::fstream::trunc | std::fstream::binary);
+    session->ofstream.path = local_path;
+    if (!session->ofstream.stream) {
+        _finish_client_session(*session);
         ProgressData empty{};
         callback(ClientResult::FileIoError, empty);
         return;
     }
 
-    _curr_op_progress_callback = callback;
-    _last_progress_percentage = -1;
-
-    const auto result_callback = [callback](ClientResult result) {
+    session->progress_callback = callback;
+    session->result_callback = [callback](ClientResult result) {
         ProgressData empty{};
         callback(result, empty);
     };
 
-    _generic_command_async(CMD_OPEN_FILE_RO, 0, remote_path, result_callback);
+    session->op = CMD_OPEN_FILE_RO;
+    session->path = remote_path;
+    _send_path_command(*session, 0);
+}
+
+void MavlinkFtp::download_to_memory_async(
+    const std::string& remote_path, DownloadToMemoryCallback callback)
+{
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
+    if (remote_path.length() >= max_data_length) {
+        callback(ClientResult::InvalidParameter, ProgressData{}, {});
+        return;
+    }
+
+    const auto session = _new_client_session();
+    if (!session) {
+        callback(ClientResult::Busy, ProgressData{}, {});
+        return;
+    }
+
+    session->memory_callback = callback;
+    session->progress_callback = [callback](ClientResult result, ProgressData progress) {
+        callback(result, progress, {});
+    };
+
+    session->op = CMD_OPEN_FILE_RO;
+    session->path = remote_path;
+    _send_path_command(*session, 0);
+}
+
+void MavlinkFtp::download_stream_async(
+    const std::string& remote_path, DownloadStreamCallback callback)
+{
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
+    if (remote_path.length() >= max_data_length) {
+        callback(ClientResult::InvalidParameter, ProgressData{}, {});
+        return;
+    }
+
+    const auto session = _new_client_session();
+    if (!session) {
+        callback(ClientResult::Busy, ProgressData{}, {});
+        return;
+    }
+
+    // The chunks tell the progress, so there are no separate progress updates.
+    session->stream_callback = callback;
+
+    session->op = CMD_OPEN_FILE_RO;
+    session->path = remote_path;
+    _send_path_command(*session, 0);
 }
 
-void MavlinkFtp::_end_read_session(bool delete_file)
+void MavlinkFtp::_hand_on_stream(ClientSession& session, bool all)
 {
-    _curr_op = CMD_NONE;
-    if (_ofstream.stream.is_open()) {
-        _ofstream.stream.close();
+    while (true) {
+        const auto ready = session.stream.ready_bytes();
+        // Short chunks only at the end.
+        if (ready == 0 || (ready < stream_chunk_size && !all &&
+                           session.stream.next_offset() + ready < session.file_size)) {
+            return;
+        }
+
+        auto chunk = session.stream.take(stream_chunk_size);
+
+        ProgressData progress;
+        progress.bytes_transferred = static_cast<uint32_t>(session.stream.next_offset());
+        progress.total_bytes = session.file_size;
+
+        // Once the callbacks have caught up, the reading carries on.
+        ++session.stream_chunks_queued;
+        _system_impl.call_user_callback([this,
+                                         weak_session = session.weak_from_this(),
+                                         temp_callback = session.stream_callback,
+                                         progress,
+                                         chunk = std::move(chunk)]() {
+            temp_callback(ClientResult::Next, progress, chunk);
+
+            if (const auto locked_session = weak_session.lock()) {
+                if (locked_session->stream_chunks_queued.fetch_sub(1) ==
+                    max_stream_chunks_queued) {
+                    _resume_stream(locked_session->id);
+                }
+            }
+        });
+    }
+}
+
+bool MavlinkFtp::_pause_stream_if_behind(ClientSession& session, bool in_burst)
+{
+    if (!session.stream_callback || session.stream_chunks_queued < max_stream_chunks_queued) {
+        return false;
+    }
+
+    // The server keeps the session open meanwhile.
+    _stop_timer(session);
+    session.stream_paused = true;
+    session.stream_paused_in_burst = in_burst;
+    return true;
+}
+
+void MavlinkFtp::_resume_stream(uint64_t session_id)
+{
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
+
+    const auto it = std::find_if(
+        _client_sessions.begin(),
+        _client_sessions.end(),
+        [&](const std::shared_ptr<ClientSession>& session) { return session->id == session_id; });
+    if (it == _client_sessions.end() || !(*it)->stream_paused) {
+        return;
+    }
+    const auto session = *it;
+
+    session->stream_paused = false;
+    if (session->stream_paused_in_burst) {
+        _burst_read(*session, session->burst_offset);
+    } else {
+        _read(*session);
+    }
+}
+
+void MavlinkFtp::_end_read_session(ClientSession& session, bool delete_file)
+{
+    if (session.ofstream.stream.is_open()) {
+        session.ofstream.stream.close();
 
         if (delete_file) {
-            fs_remove(_ofstream.path);
+            fs_remove(session.ofstream.path);
         }
     }
-    _terminate_session();
+    _terminate_session(session);
+}
+
+void MavlinkFtp::_start_read(ClientSession& session)
+{
+    if (_burst_support != BurstSupport::Unsupported && session.file_size > 0) {
+        _burst_read(session, 0);
+    } else {
+        _read(session);
+    }
 }
 
-void MavlinkFtp::_read()
+void MavlinkFtp::_read(ClientSession& session)
 {
-    if (_bytes_transferred >= _file_size) {
-        _session_result = ServerResult::SUCCESS;
-        _end_read_session();
+    auto payload = PayloadHeader{};
+
+    // Ranges missed during a burst are read first, otherwise we continue
+    // after what we have.
+    if (!session.missing_ranges.empty()) {
+        const auto& range = session.missing_ranges.front();
+        payload.offset = range.first;
+        payload.size = std::min(static_cast<uint32_t>(max_data_length), range.second - range.first);
+    } else if (session.bytes_transferred >= session.file_size) {
+        session.session_result = ServerResult::SUCCESS;
+        _end_read_session(session);
         return;
+    } else {
+        payload.offset = session.bytes_transferred;
+        payload.size = std::min(
+            static_cast<uint32_t>(max_data_length), session.file_size - session.bytes_transferred);
     }
 
+    if (_pause_stream_if_behind(session, false)) {
+        return;
+    }
+
+    payload.session = session.session;
+    payload.opcode = session.op = CMD_READ_FILE;
+    _send_mavlink_ftp_message(session, payload);
+}
+
+void MavlinkFtp::_burst_read(ClientSession& session, uint32_t offset)
+{
+    session.burst_offset = offset;
+    session.burst_received = false;
+
     auto payload = PayloadHeader{};
-    payload.seq_number = _seq_number++;
-    payload.session = _session;
-    payload.opcode = _curr_op = CMD_READ_FILE;
-    payload.offset = _bytes_transferred;
-    payload.size =
-        std::min(static_cast<uint32_t>(max_data_length), _file_size - _bytes_transferred);
-    _send_mavlink_ftp_message(payload);
+    payload.session = session.session;
+    payload.opcode = session.op = CMD_BURST_READ_FILE;
+    payload.offset = offset;
+    payload.size = 0;
+    _send_mavlink_ftp_message(session, payload);
+}
+
+void MavlinkFtp::_process_burst_data(ClientSession& session, PayloadHeader* payload)
+{
+    _burst_support = BurstSupport::Supported;
+    session.burst_received = true;
+    session.burst_retries = 0;
+    _reset_timer(session);
+
+    const uint32_t offset = payload->offset;
+
+    // Anything before the expected offset is a duplicate.
+    if (payload->size > 0 && offset >= session.burst_offset &&
+        offset + payload->size <= session.file_size) {
+        if (offset > session.burst_offset) {
+            session.missing_ranges.emplace_back(session.burst_offset, offset);
+        }
+        if (!_write_at(session, offset, payload->data, payload->size)) {
+            return;
+        }
+        session.bytes_transferred += payload->size;
+        session.burst_offset = offset + payload->size;
+        _call_op_progress_callback(session, session.bytes_transferred, session.file_size);
+    }
+
+    if (payload->burst_complete || session.burst_offset >= session.file_size) {
+        _burst_done(session);
+    }
+}
+
+void MavlinkFtp::_burst_done(ClientSession& session)
+{
+    if (session.burst_offset < session.file_size) {
+        if (_pause_stream_if_behind(session, true)) {
+            return;
+        }
+        // The server ended the burst early, continue where it stopped.
+        _burst_read(session, session.burst_offset);
+    } else {
+        // Re-request what we missed, if anything, and finish.
+        _read(session);
+    }
+}
+
+bool MavlinkFtp::_burst_timeout(ClientSession& session)
+{
+    if (session.burst_received) {
+        // The stream stalled, e.g. because the end of the burst got lost.
+        if (session.burst_retries >= _max_last_command_retries) {
+            return false;
+        }
+        ++session.burst_retries;
+        LogWarn() << "FTP burst stalled at offset " << session.burst_offset
+                  << ", retry: " << session.burst_retries;
+    } else if (_burst_support != BurstSupport::Unknown || session.retries < 1) {
+        // Just resend the request.
+        return false;
+    } else {
+        LogWarn() << "No response to FTP burst read, reading in chunks";
+        _burst_support = BurstSupport::Unsupported;
+        session.missing_ranges.emplace_back(session.burst_offset, session.file_size);
+    }
+
+    if (_burst_support == BurstSupport::Unsupported) {
+        _read(session);
+    } else {
+        _burst_read(session, session.burst_offset);
+    }
+    return true;
+}
+
+bool MavlinkFtp::_write_at(
+    ClientSession& session, uint32_t offset, const uint8_t* data, uint32_t size)
+{
+    if (session.memory_callback) {
+        // Unlike a file, the buffer is not allowed to grow beyond what was announced.
+        const uint64_t end = static_cast<uint64_t>(offset) + size;
+        if (end > session.file_size) {
+            LogErr() << "FTP read past the end of the file at offset " << offset;
+            session.session_result = ServerResult::ERR_FAIL;
+            _end_read_session(session);
+            return false;
+        }
+        if (end > session.buffer.size()) {
+            session.buffer.resize(end);
+        }
+        std::memcpy(session.buffer.data() + offset, data, size);
+        return true;
+    }
+
+    if (session.stream_callback) {
+        if (static_cast<uint64_t>(offset) + size > session.file_size) {
+            LogErr() << "FTP read past the end of the file at offset " << offset;
+            session.session_result = ServerResult::ERR_FAIL;
+            _end_read_session(session);
+            return false;
+        }
+        session.stream.add(offset, data, size);
+        _hand_on_stream(session, false);
+        return true;
+    }
+
+    session.ofstream.stream.seekp(offset);
+    session.ofstream.stream.write(reinterpret_cast<const char*>(data), size);
+    if (!session.ofstream.stream) {
+        session.session_result = ServerResult::ERR_FILE_IO_ERROR;
+        _end_read_session(session);
+        return false;
+    }
+    return true;
 }
 
 void MavlinkFtp::upload_async(
     const std::string& local_file_path, const std::string& remote_folder, UploadCallback callback)
 {
-    std::lock_guard<std::mutex> lock(_curr_op_mutex);
-    if (_curr_op != CMD_NONE) {
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
+    if (!fs_exists(local_file_path)) {
         ProgressData empty{};
-        callback(ClientResult::Busy, empty);
+        callback(ClientResult::FileDoesNotExist, empty);
         return;
     }
 
-    if (!fs_exists(local_file_path)) {
+    std::string local_path(local_file_path);
+    std::string remote_file_path = remote_folder + path_separator + fs_filename(local_path);
+    if (remote_file_path.length() >= max_data_length) {
         ProgressData empty{};
-        callback(ClientResult::FileDoesNotExist, empty);
+        callback(ClientResult::InvalidParameter, empty);
         return;
     }
 
-    _ifstream.open(local_file_path, std::fstream::binary);
-    if (!_ifstream) {
-        _end_write_session();
+    const auto session = _new_client_session();
+    if (!session) {
         ProgressData empty{};
-        callback(ClientResult::FileIoError, empty);
+        callback(ClientResult::Busy, empty);
         return;
     }
 
-    _file_size = fs_file_size(local_file_path);
-    _curr_op_progress_callback = callback;
-    _last_progress_percentage = -1;
-
-    std::string local_path(local_file_path);
-    std::string remote_file_path = remote_folder + path_separator + fs_filename(local_path);
+    session->ifstream.open(local_file_path, std::fstream::binary);
+    if (!session->ifstream) {
+        _finish_client_session(*session);
+        ProgressData empty{};
+        callback(ClientResult::FileIoError, empty);
+        return;
+    }
 
-    const auto result_callback = [callback](ClientResult result) {
+    session->file_size = fs_file_size(local_file_path);
+    session->progress_callback = callback;
+    session->result_callback = [callback](ClientResult result) {
         ProgressData empty{};
         callback(result, empty);
     };
 
-    _generic_command_async(CMD_OPEN_FILE_WO, 0, remote_file_path, result_callback);
+    session->op = CMD_OPEN_FILE_WO;
+    session->path = remote_file_path;
+    _send_path_command(*session, 0);
 }
 
-void MavlinkFtp::_end_write_session()
+void MavlinkFtp::_end_write_session(ClientSession& session)
 {
-    _curr_op = CMD_NONE;
-    if (_ifstream) {
-        _ifstream.close();
+    session.writes_in_flight.clear();
+    if (session.ifstream) {
+        session.ifstream.close();
     }
-    _terminate_session();
+    _terminate_session(session);
 }
 
-void MavlinkFtp::_write()
+void MavlinkFtp::_write(ClientSession& session)
 {
-    if (_bytes_transferred >= _file_size) {
-        _session_result = ServerResult::SUCCESS;
-        _end_write_session();
-        return;
+    // Keep as many writes in flight as the window allows, each one is
+    // acknowledged separately. The server writes at the given offset, so
+    // the order in which they arrive doesn't matter.
+    while (session.writes_in_flight.size() < _write_window_size(session) &&
+           session.write_offset < session.file_size) {
+        auto payload = PayloadHeader{};
+        payload.session = session.session;
+        payload.opcode = session.op = CMD_WRITE_FILE;
+        payload.offset = session.write_offset;
+        int bytes_read =
+            session.ifstream.readsome(reinterpret_cast<char*>(payload.data), max_data_length);
+        if (!session.ifstream || bytes_read <= 0) {
+            session.session_result = ServerResult::ERR_FILE_IO_ERROR;
+            _end_write_session(session);
+            return;
+        }
+        payload.size = bytes_read;
+        session.write_offset += bytes_read;
+
+        _send_mavlink_ftp_message(session, payload);
+        session.writes_in_flight.push_back(
+            WriteInFlight{payload, std::chrono::steady_clock::now()});
     }
 
-    auto payload = PayloadHeader{};
-    payload.seq_number = _seq_number++;
-    payload.session = _session;
-    payload.opcode = _curr_op = CMD_WRITE_FILE;
-    payload.offset = _bytes_transferred;
-    int bytes_read = _ifstream.readsome(reinterpret_cast<char*>(payload.data), max_data_length);
-    if (!_ifstream) {
-        _end_write_session();
-        _call_op_result_callback(ServerResult::ERR_FILE_IO_ERROR);
+    if (session.writes_in_flight.empty() && session.bytes_transferred >= session.file_size) {
+        session.session_result = ServerResult::SUCCESS;
+        _end_write_session(session);
+    }
+}
+
+void MavlinkFtp::_process_write_ack(ClientSession& session, PayloadHeader* payload)
+{
+    const uint16_t request_seq_number = payload->seq_number - 1;
+    const auto it = std::find_if(
+        session.writes_in_flight.begin(),
+        session.writes_in_flight.end(),
+        [&](const WriteInFlight& write) { return write.payload.seq_number == request_seq_number; });
+    if (it == session.writes_in_flight.end()) {
         return;
     }
-    payload.size = bytes_read;
-    _bytes_transferred += bytes_read;
-    _send_mavlink_ftp_message(payload);
+
+    // Only writes which were sent once tell the round trip time.
+    if (it->retries == 0) {
+        const double rtt_s =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - it->sent_time)
+                .count();
+        _write_rtt_s = (_write_rtt_s == 0.0) ? rtt_s : 0.875 * _write_rtt_s + 0.125 * rtt_s;
+    }
+
+    session.bytes_transferred += it->payload.size;
+    session.writes_in_flight.erase(it);
+    session.write_window_limit = std::min(session.write_window_limit + 1, max_write_window);
+
+    _reset_timer(session);
+    _call_op_progress_callback(session, session.bytes_transferred, session.file_size);
+    _write(session);
 }
 
-void MavlinkFtp::_terminate_session()
+bool MavlinkFtp::_retransmit_nacked_write(ClientSession& session, uint16_t seq_number)
 {
-    if (!_session_valid) {
+    const uint16_t request_seq_number = seq_number - 1;
+    const auto it = std::find_if(
+        session.writes_in_flight.begin(),
+        session.writes_in_flight.end(),
+        [&](const WriteInFlight& write) { return write.payload.seq_number == request_seq_number; });
+    if (it == session.writes_in_flight.end() || it->retries >= _max_last_command_retries) {
+        return false;
+    }
+
+    ++it->retries;
+    it->sent_time = std::chrono::steady_clock::now();
+    const uint32_t offset = it->payload.offset;
+    LogWarn() << "FTP write at offset " << offset << " rejected, retry: " << it->retries;
+    _resend_mavlink_ftp_message(it->payload);
+    return true;
+}
+
+bool MavlinkFtp::_write_timeout(ClientSession& session)
+{
+    if (session.writes_in_flight.empty() || session.retries >= _max_last_command_retries) {
+        return false;
+    }
+    session.retries++;
+
+    // Back off, the link might not keep up with the window.
+    session.write_window_limit = std::max<std::size_t>(1, session.write_window_limit / 2);
+
+    // Writes sent recently can still be acked in time, only resend the others.
+    const double retransmit_timeout_s = std::max(_command_timeout_s(), 2.0 * _write_rtt_s);
+    const auto now = std::chrono::steady_clock::now();
+
+    unsigned resent = 0;
+    for (auto& write : session.writes_in_flight) {
+        if (std::chrono::duration<double>(now - write.sent_time).count() < retransmit_timeout_s) {
+            continue;
+        }
+        ++write.retries;
+        write.sent_time = now;
+        _resend_mavlink_ftp_message(write.payload);
+        ++resent;
+    }
+
+    LogWarn() << "FTP write timeout, resent " << resent << " of "
+              << session.writes_in_flight.size() << " writes. Retry: " << session.retries;
+    _start_timer(session);
+    return true;
+}
+
+std::size_t MavlinkFtp::_write_window_size(const ClientSession& session) const
+{
+    // Enough writes to keep the link busy for one round trip. Until the
+    // first ack, the round trip time is unknown so we start with one.
+    const auto from_rtt = 1 + static_cast<std::size_t>(_write_rtt_s / write_interval_s);
+    return std::max<std::size_t>(
+        1, std::min({from_rtt, session.write_window_limit, max_write_window}));
+}
+
+void MavlinkFtp::_terminate_session(ClientSession& session)
+{
+    if (!session.session_valid) {
+        _call_op_result_callback(session, session.session_result);
+        _finish_client_session(session);
         return;
     }
     auto payload = PayloadHeader{};
-    payload.seq_number = _seq_number++;
-    payload.session = _session;
-    payload.opcode = _curr_op = CMD_TERMINATE_SESSION;
+    payload.session = session.session;
+    payload.opcode = session.op = CMD_TERMINATE_SESSION;
     payload.offset = 0;
     payload.size = 0;
-    _send_mavlink_ftp_message(payload);
+    _send_mavlink_ftp_message(session, payload);
 }
 
 std::pair<MavlinkFtp::ClientResult, std::vector<std::string>>
@@ -654,60 +1182,314 @@ MavlinkFtp::list_directory(const std::string& path)
 void MavlinkFtp::list_directory_async(
     const std::string& path, ListDirectoryCallback callback, uint32_t offset)
 {
-    std::lock_guard<std::mutex> lock(_curr_op_mutex);
-    if (_curr_op != CMD_NONE && offset == 0) {
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
+    if (path.length() >= max_data_length) {
+        callback(ClientResult::InvalidParameter, std::vector<std::string>());
+        return;
+    }
+
+    const auto session = _new_client_session();
+    if (!session) {
         callback(ClientResult::Busy, std::vector<std::string>());
         return;
     }
+
+    session->path = path;
+    session->dir_items_callback = callback;
+    _list_directory(*session, offset);
+}
+
+void MavlinkFtp::_list_directory(ClientSession& session, uint32_t offset)
+{
+    session.op = CMD_LIST_DIRECTORY;
+    _send_path_command(session, offset);
+}
+
+std::pair<MavlinkFtp::ClientResult, std::vector<MavlinkFtp::DirectoryEntry>>
+MavlinkFtp::list_directory_tree(const std::string& path, bool recursive)
+{
+    std::promise<std::pair<ClientResult, std::vector<DirectoryEntry>>> prom;
+    auto fut = prom.get_future();
+
+    list_directory_tree_async(
+        path,
+        [&prom](const ClientResult result, std::vector<DirectoryEntry> entries) {
+            prom.set_value(std::make_pair(result, std::move(entries)));
+        },
+        recursive);
+
+    return fut.get();
+}
+
+void MavlinkFtp::list_directory_tree_async(
+    const std::string& path, ListDirectoryTreeCallback callback, bool recursive)
+{
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
+    if (path.length() >= max_data_length) {
+        callback(ClientResult::InvalidParameter, std::vector<DirectoryEntry>());
+        return;
+    }
+
+    auto listing = std::make_shared<TreeListing>();
+    listing->root = path;
+    listing->recursive = recursive;
+    listing->callback = callback;
+    listing->directories.emplace_back();
+    _tree_listing_step(listing);
+}
+
+void MavlinkFtp::_request_tree_pages(const std::shared_ptr<TreeListing>& listing)
+{
+    if (listing->result != ServerResult::SUCCESS) {
+        return;
+    }
+
+    const auto in_flight = [](const DirectoryListing& dir, uint32_t offset) {
+        return std::find(dir.offsets_in_flight.begin(), dir.offsets_in_flight.end(), offset) !=
+               dir.offsets_in_flight.end();
+    };
+
+    // The next page of a directory can only be asked for exactly once the one
+    // before it arrived, as the number of entries in a page depends on their
+    // names. So these pages come first, and the rest of the requests go to
+    // pages further ahead, guessed from the size of the first one. A guess
+    // that is off leaves a gap, which is asked for next, or overlaps, which
+    // is sorted out by the index of the entries.
+    for (std::size_t i = 0;
+         i < listing->directories.size() && listing->in_flight < max_tree_list_requests;
+         ++i) {
+        const auto& dir = listing->directories[i];
+        if (dir.done || in_flight(dir, dir.complete_to)) {
+            continue;
+        }
+        if (!_request_tree_page(listing, i, dir.complete_to)) {
+            return;
+        }
+    }
+
+    for (std::size_t i = 0;
+         i < listing->directories.size() && listing->in_flight < max_tree_list_requests;
+         ++i) {
+        auto& dir = listing->directories[i];
+        while (listing->in_flight < max_tree_list_requests && !dir.done && dir.page_size > 0 &&
+               dir.offsets_in_flight.size() <= max_list_pages_ahead) {
+            auto offset = std::max(dir.requested_to, dir.complete_to);
+            while (dir.entries.count(offset) != 0 || in_flight(dir, offset)) {
+                ++offset;
+            }
+            if (dir.end && offset >= *dir.end) {
+                break;
+            }
+            if (!_request_tree_page(listing, i, offset)) {
+                return;
+            }
+        }
+    }
+}
+
+bool MavlinkFtp::_request_tree_page(
+    const std::shared_ptr<TreeListing>& listing, std::size_t directory, uint32_t offset)
+{
+    auto& dir = listing->directories[directory];
+
+    std::string path = listing->root;
+    if (!dir.path.empty()) {
+        if (!path.empty() && path.back() != '/') {
+            path += '/';
+        }
+        path += dir.path;
+    }
     if (path.length() >= max_data_length) {
-        callback(ClientResult::InvalidParameter, std::vector<std::string>());
+        LogWarn() << "FTP path too long to list: " << path;
+        listing->result = ServerResult::ERR_INVALID_DATA_SIZE;
+        return false;
+    }
+
+    const auto session = _new_client_session();
+    if (!session) {
+        return false;
+    }
+
+    session->path = path;
+    session->tree_listing = listing;
+    session->tree_directory = directory;
+    session->list_offset = offset;
+    dir.offsets_in_flight.push_back(offset);
+    dir.requested_to = std::max(dir.requested_to, offset + dir.page_size);
+    ++listing->in_flight;
+    _list_directory(*session, offset);
+    return true;
+}
+
+void MavlinkFtp::_process_tree_page(ClientSession& session, PayloadHeader* payload)
+{
+    const auto listing = session.tree_listing;
+    const auto directory = session.tree_directory;
+    const auto offset = session.list_offset;
+    _finish_client_session(session);
+
+    auto& dir = listing->directories[directory];
+    dir.offsets_in_flight.erase(
+        std::find(dir.offsets_in_flight.begin(), dir.offsets_in_flight.end(), offset));
+    --listing->in_flight;
+
+    // Entries count from the offset of the page, skipped ones included.
+    uint32_t index = offset;
+    uint8_t start = 0;
+    for (uint8_t i = 0; i < payload->size; i++) {
+        if (payload->data[i] == 0) {
+            std::string entry = std::string(reinterpret_cast<char*>(&payload->data[start]));
+            if (entry.length() > 0) {
+                dir.entries.emplace(index++, std::move(entry));
+            }
+            start = i + 1;
+        }
+    }
+
+    if (index == offset) {
+        dir.end = std::min(dir.end.value_or(offset), offset);
+    } else if (dir.page_size == 0) {
+        dir.page_size = index - offset;
+    }
+
+    while (dir.entries.count(dir.complete_to) != 0) {
+        ++dir.complete_to;
+    }
+    if (!dir.done && dir.end && dir.complete_to >= *dir.end) {
+        _tree_directory_done(*listing, directory);
+    }
+    _tree_listing_step(listing);
+}
+
+void MavlinkFtp::_tree_page_failed(ClientSession& session, ServerResult result)
+{
+    const auto listing = session.tree_listing;
+    const auto directory = session.tree_directory;
+    const auto offset = session.list_offset;
+    _finish_client_session(session);
+
+    auto& dir = listing->directories[directory];
+    dir.offsets_in_flight.erase(
+        std::find(dir.offsets_in_flight.begin(), dir.offsets_in_flight.end(), offset));
+    --listing->in_flight;
+
+    if (result == ServerResult::ERR_EOF) {
+        dir.end = std::min(dir.end.value_or(offset), offset);
+        if (!dir.done && dir.complete_to >= *dir.end) {
+            _tree_directory_done(*listing, directory);
+        }
+    } else if (listing->result == ServerResult::SUCCESS) {
+        listing->result = result;
+    }
+    _tree_listing_step(listing);
+}
+
+void MavlinkFtp::_tree_directory_done(TreeListing& listing, std::size_t directory)
+{
+    // Directories found are appended, so no references are kept across.
+    listing.directories[directory].done = true;
+    const auto entries = std::move(listing.directories[directory].entries);
+    listing.directories[directory].entries.clear();
+    const auto dir_path = listing.directories[directory].path;
+    const auto end = listing.directories[directory].end.value_or(0);
+
+    for (const auto& [index, entry] : entries) {
+        if (index >= end) {
+            break;
+        }
+        // Entries are "F<name>\t<size>" for files, "D<name>" for directories and
+        // "S" for skipped ones, some servers send the path relative to their root
+        // as name.
+        if (entry.size() < 2 || (entry[0] != 'F' && entry[0] != 'D')) {
+            continue;
+        }
+        const auto tab = entry.find('\t');
+        std::string name = entry.substr(1, tab == std::string::npos ? tab : tab - 1);
+        const auto slash = name.find_last_of('/');
+        if (slash != std::string::npos) {
+            name = name.substr(slash + 1);
+        }
+        if (name.empty() || name == "." || name == "..") {
+            continue;
+        }
+
+        DirectoryEntry found;
+        found.path = dir_path.empty() ? name : dir_path + "/" + name;
+        if (entry[0] == 'F') {
+            if (tab != std::string::npos) {
+                found.size_bytes =
+                    static_cast<uint32_t>(std::strtoul(entry.c_str() + tab + 1, nullptr, 10));
+            }
+        } else {
+            found.is_directory = true;
+            if (listing.recursive) {
+                DirectoryListing sub;
+                sub.path = found.path;
+                listing.directories.push_back(std::move(sub));
+            }
+        }
+        listing.found.push_back(std::move(found));
+    }
+}
+
+void MavlinkFtp::_tree_listing_step(const std::shared_ptr<TreeListing>& listing)
+{
+    _request_tree_pages(listing);
+    if (listing->in_flight > 0) {
         return;
     }
 
-    _last_path = path;
-    // TODOTODO
-    _curr_dir_items_result_callback = callback;
-    _list_directory(offset);
+    // Nothing in flight with directories left means there were no client
+    // sessions to list them.
+    auto result = listing->result;
+    if (result == ServerResult::SUCCESS &&
+        std::any_of(
+            listing->directories.begin(),
+            listing->directories.end(),
+            [](const DirectoryListing& dir) { return !dir.done; })) {
+        result = ServerResult::ERR_NO_SESSIONS_AVAILABLE;
+    }
+
+    auto found = std::move(listing->found);
+    std::sort(found.begin(), found.end(), [](const DirectoryEntry& lhs, const DirectoryEntry& rhs) {
+        return lhs.path < rhs.path;
+    });
+
+    const auto temp_callback = listing->callback;
+    _system_impl.call_user_callback([temp_callback, result, found = std::move(found)]() {
+        temp_callback(_translate(result), found);
+    });
 }
 
-void MavlinkFtp::_list_directory(uint32_t offset)
+void MavlinkFtp::_send_path_command(ClientSession& session, uint32_t offset)
 {
     auto payload = PayloadHeader{};
-    payload.seq_number = _seq_number++;
     payload.session = 0;
-    payload.opcode = _curr_op = CMD_LIST_DIRECTORY;
+    payload.opcode = session.op;
     payload.offset = offset;
-    strncpy(reinterpret_cast<char*>(payload.data), _last_path.c_str(), max_data_length - 1);
-    payload.size = _last_path.length() + 1;
-
-    if (offset == 0) {
-        _curr_directory_list.clear();
-    }
-    _send_mavlink_ftp_message(payload);
+    strncpy(reinterpret_cast<char*>(payload.data), session.path.c_str(), max_data_length - 1);
+    payload.size = session.path.length() + 1;
+    _send_mavlink_ftp_message(session, payload);
 }
 
 void MavlinkFtp::_generic_command_async(
     Opcode opcode, uint32_t offset, const std::string& path, ResultCallback callback)
 {
-    if (_curr_op != CMD_NONE) {
-        callback(ClientResult::Busy);
-        return;
-    }
     if (path.length() >= max_data_length) {
         callback(ClientResult::InvalidParameter);
         return;
     }
 
-    auto payload = PayloadHeader{};
-    payload.seq_number = _seq_number++;
-    payload.session = 0;
-    payload.opcode = _curr_op = opcode;
-    payload.offset = offset;
-    strncpy(reinterpret_cast<char*>(payload.data), path.c_str(), max_data_length - 1);
-    payload.size = path.length() + 1;
+    const auto session = _new_client_session();
+    if (!session) {
+        callback(ClientResult::Busy);
+        return;
+    }
 
-    _curr_op_result_callback = callback;
-    _send_mavlink_ftp_message(payload);
+    session->op = opcode;
+    session->path = path;
+    session->result_callback = callback;
+    _send_path_command(*session, offset);
 }
 
 MavlinkFtp::ClientResult MavlinkFtp::create_directory(const std::string& path)
@@ -722,7 +1504,7 @@ MavlinkFtp::ClientResult MavlinkFtp::create_directory(const std::string& path)
 
 void MavlinkFtp::create_directory_async(const std::string& path, ResultCallback callback)
 {
-    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
     _generic_command_async(CMD_CREATE_DIRECTORY, 0, path, callback);
 }
 
@@ -738,7 +1520,7 @@ MavlinkFtp::ClientResult MavlinkFtp::remove_directory(const std::string& path)
 
 void MavlinkFtp::remove_directory_async(const std::string& path, ResultCallback callback)
 {
-    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
     _generic_command_async(CMD_REMOVE_DIRECTORY, 0, path, callback);
 }
 
@@ -754,7 +1536,7 @@ MavlinkFtp::ClientResult MavlinkFtp::remove_file(const std::string& path)
 
 void MavlinkFtp::remove_file_async(const std::string& path, ResultCallback callback)
 {
-    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
     _generic_command_async(CMD_REMOVE_FILE, 0, path, callback);
 }
 
@@ -773,20 +1555,21 @@ MavlinkFtp::rename(const std::string& from_path, const std::string& to_path)
 void MavlinkFtp::rename_async(
     const std::string& from_path, const std::string& to_path, ResultCallback callback)
 {
-    std::lock_guard<std::mutex> lock(_curr_op_mutex);
-    if (_curr_op != CMD_NONE) {
-        callback(ClientResult::Busy);
-        return;
-    }
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
     if (from_path.length() + to_path.length() + 1 >= max_data_length) {
         callback(ClientResult::InvalidParameter);
         return;
     }
 
+    const auto session = _new_client_session();
+    if (!session) {
+        callback(ClientResult::Busy);
+        return;
+    }
+
     auto payload = PayloadHeader{};
-    payload.seq_number = _seq_number++;
     payload.session = 0;
-    payload.opcode = _curr_op = CMD_RENAME;
+    payload.opcode = session->op = CMD_RENAME;
     payload.offset = 0;
     strncpy(reinterpret_cast<char*>(payload.data), from_path.c_str(), max_data_length - 1);
     payload.size = from_path.length() + 1;
@@ -795,8 +1578,8 @@ void MavlinkFtp::rename_async(
         to_path.c_str(),
         max_data_length - payload.size);
     payload.size += to_path.length() + 1;
-    _curr_op_result_callback = callback;
-    _send_mavlink_ftp_message(payload);
+    session->result_callback = callback;
+    _send_mavlink_ftp_message(*session, payload);
 }
 
 std::pair<MavlinkFtp::ClientResult, bool>
@@ -848,88 +1631,130 @@ void MavlinkFtp::are_files_identical_async(
 
 void MavlinkFtp::_calc_file_crc32_async(const std::string& path, file_crc32_ResultCallback callback)
 {
-    std::lock_guard<std::mutex> lock(_curr_op_mutex);
-    if (_curr_op != CMD_NONE) {
-        callback(ClientResult::Busy, 0);
-        return;
-    }
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
     if (path.length() >= max_data_length) {
         callback(ClientResult::InvalidParameter, 0);
         return;
     }
 
-    auto payload = PayloadHeader{};
-    payload.seq_number = _seq_number++;
-    payload.session = 0;
-    payload.opcode = _curr_op = CMD_CALC_FILE_CRC32;
-    payload.offset = 0;
-    strncpy(reinterpret_cast<char*>(payload.data), path.c_str(), max_data_length - 1);
-    payload.size = path.length() + 1;
-    _current_crc32_result_callback = callback;
-    _send_mavlink_ftp_message(payload);
+    const auto session = _new_client_session();
+    if (!session) {
+        callback(ClientResult::Busy, 0);
+        return;
+    }
+
+    session->op = CMD_CALC_FILE_CRC32;
+    session->path = path;
+    session->crc32_callback = callback;
+    _send_path_command(*session, 0);
 }
 
-void MavlinkFtp::_send_mavlink_ftp_message(const PayloadHeader& payload)
+void MavlinkFtp::_send_mavlink_ftp_message(ClientSession& session, PayloadHeader& payload)
 {
+    MAVSDK_TRACE_INSTANT("ftp", "send", payload.opcode);
+
+    // Sequence numbers are shared by all sessions, so that each reply can
+    // be matched to its request.
+    payload.seq_number = _seq_number++;
+    session.seq_number = payload.seq_number;
+
     mavlink_msg_file_transfer_protocol_pack(
         _system_impl.get_own_system_id(),
         _system_impl.get_own_component_id(),
-        &_last_command,
+        &session.last_command,
         _network_id,
         _system_impl.get_system_id(),
         _get_target_component_id(),
         reinterpret_cast<const uint8_t*>(&payload));
-    _system_impl.send_message(_last_command);
+    _system_impl.send_message(session.last_command);
 
-    _reset_timer();
-    std::lock_guard<std::mutex> lock(_timer_mutex);
-    if (!_last_command_timer_running) {
-        _last_command_timer_running = true;
-        _system_impl.register_timeout_handler(
-            [this]() { _command_timeout(); },
-            static_cast<double>(_last_command_timeout) / 1000.0,
-            &_last_command_timeout_cookie);
+    _reset_timer(session);
+    if (!session.timer_running) {
+        _start_timer(session);
     }
 }
 
-void MavlinkFtp::_command_timeout()
+void MavlinkFtp::_resend_mavlink_ftp_message(const PayloadHeader& payload)
 {
-    if (_last_command_retries >= _max_last_command_retries) {
-        LogErr() << "Response timeout " << _curr_op;
-        {
-            std::lock_guard<std::mutex> lock(_timer_mutex);
-            _last_command_timer_running = false;
-            _session_result = ServerResult::ERR_TIMEOUT;
-            _session_valid = false;
-        }
-        _process_nak(ServerResult::ERR_TIMEOUT);
+    mavlink_message_t message;
+    mavlink_msg_file_transfer_protocol_pack(
+        _system_impl.get_own_system_id(),
+        _system_impl.get_own_component_id(),
+        &message,
+        _network_id,
+        _system_impl.get_system_id(),
+        _get_target_component_id(),
+        reinterpret_cast<const uint8_t*>(&payload));
+    _system_impl.send_message(message);
+}
+
+void MavlinkFtp::_start_timer(ClientSession& session)
+{
+    // The timeout looks the session up again, it might be finished by then.
+    const uint64_t session_id = session.id;
+    session.timer_running = true;
+    _system_impl.register_timeout_handler(
+        [this, session_id]() { _command_timeout(session_id); },
+        _command_timeout_s(),
+        &session.timeout_cookie);
+}
+
+double MavlinkFtp::_command_timeout_s() const
+{
+    return _system_impl.rtt_estimator().rto_s(static_cast<double>(_last_command_timeout) / 1000.0);
+}
+
+void MavlinkFtp::_command_timeout(uint64_t session_id)
+{
+    MAVSDK_TRACE_SCOPE("ftp", "command_timeout", session_id);
+    std::lock_guard<std::mutex> lock(_client_sessions_mutex);
+
+    const auto it = std::find_if(
+        _client_sessions.begin(),
+        _client_sessions.end(),
+        [&](const std::shared_ptr<ClientSession>& session) { return session->id == session_id; });
+    if (it == _client_sessions.end()) {
+        return;
+    }
+    const auto session = *it;
+
+    // The timer has fired, so the next request needs to start it again.
+    session->timer_running = false;
+
+    if (session->op == CMD_BURST_READ_FILE && _burst_timeout(*session)) {
+        return;
+    }
+    if (session->op == CMD_WRITE_FILE && _write_timeout(*session)) {
+        return;
+    }
+
+    if (session->retries >= _max_last_command_retries) {
+        LogErr() << "Response timeout " << static_cast<int>(session->op);
+        session->session_result = ServerResult::ERR_TIMEOUT;
+        _process_nak(*session, ServerResult::ERR_TIMEOUT);
     } else {
-        _last_command_retries++;
-        LogWarn() << "Response timeout. Retry: " << _last_command_retries;
-        _system_impl.send_message(_last_command);
-        _system_impl.register_timeout_handler(
-            [this]() { _command_timeout(); },
-            static_cast<double>(_last_command_timeout) / 1000.0,
-            &_last_command_timeout_cookie);
+        session->retries++;
+        LogWarn() << "Response timeout. Retry: " << session->retries;
+        _system_impl.send_message(session->last_command);
+        _start_timer(*session);
     }
 }
 
-void MavlinkFtp::_reset_timer()
+void MavlinkFtp::_reset_timer(ClientSession& session)
 {
-    _system_impl.refresh_timeout_handler(_last_command_timeout_cookie);
-    _last_command_retries = 0;
+    if (session.timer_running) {
+        _system_impl.refresh_timeout_handler(session.timeout_cookie);
+    }
+    session.retries = 0;
 }
 
-void MavlinkFtp::_stop_timer()
+void MavlinkFtp::_stop_timer(ClientSession& session)
 {
-    {
-        std::lock_guard<std::mutex> lock(_timer_mutex);
-        if (!_last_command_timer_running) {
-            return;
-        }
-        _last_command_timer_running = false;
+    if (!session.timer_running) {
+        return;
     }
-    _system_impl.unregister_timeout_handler(_last_command_timeout_cookie);
+    session.timer_running = false;
+    _system_impl.unregister_timeout_handler(session.timeout_cookie);
 }
 
 /// @brief Guarantees that the payload data is null terminated.
@@ -1034,12 +1859,51 @@ MavlinkFtp::ServerResult MavlinkFtp::_work_list(PayloadHeader* payload, bool lis
     return error_code;
 }
 
-MavlinkFtp::ServerResult MavlinkFtp::_work_open(PayloadHeader* payload, int oflag)
+MavlinkFtp::ServedFile::~ServedFile()
+{
+#if !defined(WINDOWS)
+    if (mapped != nullptr) {
+        munmap(mapped, mapped_size);
+    }
+#endif
+}
+
+bool MavlinkFtp::_server_session_open() const
+{
+    return _session_info.fd >= 0 || _session_info.served != nullptr;
+}
+
+void MavlinkFtp::_close_server_session()
 {
     if (_session_info.fd >= 0) {
+        close(_session_info.fd);
+        _session_info.fd = -1;
+    }
+    _session_info.served.reset();
+    _session_info.stream_download = false;
+}
+
+MavlinkFtp::ServerResult MavlinkFtp::_work_open(PayloadHeader* payload, int oflag)
+{
+    if (_server_session_open()) {
         return ServerResult::ERR_NO_SESSIONS_AVAILABLE;
     }
 
+    const bool read_only = (oflag & O_ACCMODE) == O_RDONLY;
+
+    auto memory_file = [payload, this]() -> std::shared_ptr<const ServedFile> {
+        std::lock_guard<std::mutex> lock(_tmp_files_mutex);
+        const auto it = _memory_files.find(_data_as_string(payload));
+        return (it != _memory_files.end()) ? it->second : nullptr;
+    }();
+
+    if (memory_file) {
+        if (!read_only) {
+            return ServerResult::ERR_FAIL_FILE_PROTECTED;
+        }
+        return _open_served(payload, std::move(memory_file));
+    }
+
     std::string path = [payload, this]() {
         std::lock_guard<std::mutex> lock(_tmp_files_mutex);
         const auto it = _tmp_files.find(_data_as_string(payload));
@@ -1061,11 +1925,19 @@ MavlinkFtp::ServerResult MavlinkFtp::_work_open(PayloadHeader* payload, int ofla
     // }
 
     // fail only if requested open for read
-    if ((oflag & O_ACCMODE) == O_RDONLY && !fs_exists(path)) {
+    if (read_only && !fs_exists(path)) {
         LogWarn() << "FTP: Open failed - file not found";
         return ServerResult::ERR_FAIL_FILE_DOES_NOT_EXIST;
     }
 
+    if (read_only) {
+        auto mapped_file = _map_file(path);
+        if (mapped_file) {
+            return _open_served(payload, std::move(mapped_file));
+        }
+        // Otherwise, e.g. for empty files, we read it as usual.
+    }
+
     uint32_t file_size = fs_file_size(path);
 
     // Set mode to 666 in case oflag has O_CREAT
@@ -1088,9 +1960,89 @@ MavlinkFtp::ServerResult MavlinkFtp::_work_open(PayloadHeader* payload, int ofla
     return ServerResult::SUCCESS;
 }
 
+MavlinkFtp::ServerResult
+MavlinkFtp::_open_served(PayloadHeader* payload, std::shared_ptr<const ServedFile> served)
+{
+    const uint32_t file_size = served->size;
+
+    _session_info.served = std::move(served);
+    _session_info.file_size = file_size;
+    _session_info.stream_download = false;
+
+    payload->session = 0;
+    payload->size = sizeof(uint32_t);
+    memcpy(payload->data, &file_size, payload->size);
+
+    return ServerResult::SUCCESS;
+}
+
+std::shared_ptr<const MavlinkFtp::ServedFile> MavlinkFtp::_map_file(const std::string& path)
+{
+#if defined(WINDOWS)
+    UNUSED(path);
+    return nullptr;
+#else
+    struct stat file_stat;
+    if (stat(path.c_str(), &file_stat) != 0 || !S_ISREG(file_stat.st_mode) ||
+        file_stat.st_size <= 0 || file_stat.st_size > UINT32_MAX) {
+        return nullptr;
+    }
+
+    // The same files tend to be downloaded over and over, e.g. by several
+    // ground stations, so we keep them mapped until they change.
+    const auto it = _mapped_files.find(path);
+    if (it != _mapped_files.end()) {
+        const auto& mapped_file = *it->second;
+        if (mapped_file.size == static_cast<uint32_t>(file_stat.st_size) &&
+            mapped_file.modified_s == static_cast<int64_t>(file_stat.st_mtime) &&
+            mapped_file.inode == static_cast<uint64_t>(file_stat.st_ino)) {
+            return it->second;
+        }
+        _mapped_files.erase(it);
+    }
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    const auto size = static_cast<std::size_t>(file_stat.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid without the file descriptor.
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+
+    auto mapped_file = std::make_shared<ServedFile>();
+    mapped_file->mapped = mapped;
+    mapped_file->mapped_size = size;
+    mapped_file->data = static_cast<const uint8_t*>(mapped);
+    mapped_file->size = static_cast<uint32_t>(size);
+    mapped_file->modified_s = static_cast<int64_t>(file_stat.st_mtime);
+    mapped_file->inode = static_cast<uint64_t>(file_stat.st_ino);
+
+    if (_mapped_files.size() >= max_mapped_files) {
+        // Make room by unmapping the ones not being served right now.
+        for (auto mapped_it = _mapped_files.begin(); mapped_it != _mapped_files.end();) {
+            if (mapped_it->second.use_count() == 1) {
+                mapped_it = _mapped_files.erase(mapped_it);
+            } else {
+                ++mapped_it;
+            }
+        }
+    }
+    if (_mapped_files.size() < max_mapped_files) {
+        _mapped_files.emplace(path, mapped_file);
+    }
+
+    return mapped_file;
+#endif
+}
+
 MavlinkFtp::ServerResult MavlinkFtp::_work_read(PayloadHeader* payload)
 {
-    if (payload->session != 0 || _session_info.fd < 0) {
+    if (payload->session != 0 || !_server_session_open()) {
         return ServerResult::ERR_INVALID_SESSION;
     }
 
@@ -1099,6 +2051,14 @@ MavlinkFtp::ServerResult MavlinkFtp::_work_read(PayloadHeader* payload)
         return ServerResult::ERR_EOF;
     }
 
+    if (_session_info.served) {
+        const auto bytes =
+            std::min<uint32_t>(max_data_length, _session_info.file_size - payload->offset);
+        memcpy(&payload->data[0], _session_info.served->data + payload->offset, bytes);
+        payload->size = static_cast<uint8_t>(bytes);
+        return ServerResult::SUCCESS;
+    }
+
     if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
         return ServerResult::ERR_FAIL;
     }
@@ -1117,10 +2077,14 @@ MavlinkFtp::ServerResult MavlinkFtp::_work_read(PayloadHeader* payload)
 
 MavlinkFtp::ServerResult MavlinkFtp::_work_burst(PayloadHeader* payload)
 {
-    if (payload->session != 0 && _session_info.fd < 0) {
+    if (payload->session != 0 && !_server_session_open()) {
         return ServerResult::ERR_INVALID_SESSION;
     }
 
+    if (payload->offset >= _session_info.file_size) {
+        return ServerResult::ERR_EOF;
+    }
+
     // Setup for streaming sends
     _session_info.stream_download = true;
     _session_info.stream_offset = payload->offset;
@@ -1131,6 +2095,61 @@ MavlinkFtp::ServerResult MavlinkFtp::_work_burst(PayloadHeader* payload)
     return ServerResult::SUCCESS;
 }
 
+void MavlinkFtp::_send_burst()
+{
+    // A burst is sent in one go, the client asks for the next one once it
+    // has got this one.
+    for (unsigned i = 0; i < max_burst_chunks && _session_info.stream_download; ++i) {
+        auto payload = PayloadHeader{};
+        payload.seq_number = _session_info.stream_seq_number++;
+        payload.session = 0;
+        payload.req_opcode = CMD_BURST_READ_FILE;
+        payload.offset = _session_info.stream_offset;
+
+        ssize_t bytes_read = -1;
+        if (_session_info.served) {
+            // Copied straight out of memory or the mapped pages.
+            bytes_read = 0;
+            if (payload.offset < _session_info.served->size) {
+                bytes_read = std::min<uint32_t>(
+                    max_data_length, _session_info.served->size - payload.offset);
+                memcpy(&payload.data[0], _session_info.served->data + payload.offset, bytes_read);
+            }
+        } else if (lseek(_session_info.fd, payload.offset, SEEK_SET) >= 0) {
+            bytes_read = ::read(_session_info.fd, &payload.data[0], max_data_length);
+        }
+
+        if (bytes_read <= 0) {
+            payload.opcode = RSP_NAK;
+            payload.size = 1;
+            payload.data[0] = (bytes_read == 0) ? ServerResult::ERR_EOF : ServerResult::ERR_FAIL;
+            _session_info.stream_download = false;
+        } else {
+            payload.opcode = RSP_ACK;
+            payload.size = static_cast<uint8_t>(bytes_read);
+            _session_info.stream_offset += static_cast<uint32_t>(bytes_read);
+            _session_info.stream_chunk_transmitted++;
+
+            if (_session_info.stream_offset >= _session_info.file_size ||
+                i + 1 == max_burst_chunks) {
+                payload.burst_complete = 1;
+                _session_info.stream_download = false;
+            }
+        }
+
+        mavlink_message_t message;
+        mavlink_msg_file_transfer_protocol_pack(
+            _system_impl.get_own_system_id(),
+            _system_impl.get_own_component_id(),
+            &message,
+            _network_id,
+            _session_info.stream_target_system_id,
+            _get_target_component_id(),
+            reinterpret_cast<const uint8_t*>(&payload));
+        _system_impl.send_message(message);
+    }
+}
+
 MavlinkFtp::ServerResult MavlinkFtp::_work_write(PayloadHeader* payload)
 {
     if (payload->session != 0 && _session_info.fd < 0) {
@@ -1157,13 +2176,11 @@ MavlinkFtp::ServerResult MavlinkFtp::_work_write(PayloadHeader* payload)
 
 MavlinkFtp::ServerResult MavlinkFtp::_work_terminate(PayloadHeader* payload)
 {
-    if (payload->session != 0 || _session_info.fd < 0) {
+    if (payload->session != 0 || !_server_session_open()) {
         return ServerResult::ERR_INVALID_SESSION;
     }
 
-    close(_session_info.fd);
-    _session_info.fd = -1;
-    _session_info.stream_download = false;
+    _close_server_session();
 
     payload->size = 0;
 
@@ -1172,11 +2189,7 @@ MavlinkFtp::ServerResult MavlinkFtp::_work_terminate(PayloadHeader* payload)
 
 MavlinkFtp::ServerResult MavlinkFtp::_work_reset(PayloadHeader* payload)
 {
-    if (_session_info.fd != -1) {
-        close(_session_info.fd);
-        _session_info.fd = -1;
-        _session_info.stream_download = false;
-    }
+    _close_server_session();
 
     payload->size = 0;
 
@@ -1275,8 +2288,32 @@ MavlinkFtp::ClientResult MavlinkFtp::_calc_local_file_crc32(const std::string& p
         return ClientResult::FileIoError;
     }
 
-    // Read whole file in buffer size chunks
     Crc32 checksum;
+
+#if !defined(WINDOWS)
+    // Large files are mapped rather than copied through a buffer.
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+        const auto size = static_cast<std::size_t>(file_stat.st_size);
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            madvise(mapped, size, MADV_SEQUENTIAL);
+            const auto* data = static_cast<const uint8_t*>(mapped);
+            constexpr std::size_t max_chunk = 1 << 30;
+            for (std::size_t offset = 0; offset < size;) {
+                const auto chunk = std::min(size - offset, max_chunk);
+                checksum.add(data + offset, static_cast<uint32_t>(chunk));
+                offset += chunk;
+            }
+            munmap(mapped, size);
+            close(fd);
+            csum = checksum.get();
+            return ClientResult::Success;
+        }
+    }
+#endif
+
+    // Read whole file in buffer size chunks
     char buffer[18392];
     ssize_t bytes_read;
     do {
@@ -1290,7 +2327,7 @@ MavlinkFtp::ClientResult MavlinkFtp::_calc_local_file_crc32(const std::string& p
         }
 
         checksum.add((uint8_t*)buffer, bytes_read);
-    } while (bytes_read == sizeof(buffer));
+    } while (bytes_read > 0);
 
     close(fd);
 
@@ -1344,6 +2381,7 @@ MavlinkFtp::ClientResult MavlinkFtp::set_target_compid(uint8_t component_id)
 {
     _target_component_id = component_id;
     _target_component_id_set = true;
+    _burst_support = BurstSupport::Unknown;
     return ClientResult::Success;
 }
 
@@ -1395,6 +2433,28 @@ MavlinkFtp::write_tmp_file(const std::string& path, const std::string& content)
     }
 }
 
+void MavlinkFtp::register_memory_file(const std::string& path, std::string content)
+{
+    if (content.size() > UINT32_MAX) {
+        LogWarn() << "File " << path << " too large to serve";
+        return;
+    }
+
+    auto memory_file = std::make_shared<ServedFile>();
+    memory_file->content = std::move(content);
+    memory_file->data = reinterpret_cast<const uint8_t*>(memory_file->content.data());
+    memory_file->size = static_cast<uint32_t>(memory_file->content.size());
+
+    std::lock_guard<std::mutex> lock(_tmp_files_mutex);
+    _memory_files[path] = std::move(memory_file);
+}
+
+void MavlinkFtp::unregister_memory_file(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(_tmp_files_mutex);
+    _memory_files.erase(path);
+}
+
 std::ostream& operator<<(std::ostream& str, MavlinkFtp::ClientResult const& result)
 {
     switch (result) {
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cinttypes>
 #include <functional>
 #include <fstream>
+#include <map>
+#include <memory>
 #include <unordered_map>
 #include <mutex>
 #include <optional>
@@ -11,6 +15,7 @@
 #include <vector>
 
 #include "mavlink_include.h"
+#include "stream_reassembly.h"
 
 // As found in
 // https://stackoverflow.com/questions/1537964#answer-3312896
@@ -29,6 +34,9 @@ public:
     explicit MavlinkFtp(SystemImpl& system_impl);
     ~MavlinkFtp();
 
+    // FILE_TRANSFER_PROTOCOL messages are routed here by SystemImpl.
+    void process_mavlink_ftp_message(const mavlink_message_t& msg);
+
     /**
      * @brief Possible results returned for FTP commands
      */
@@ -58,12 +66,25 @@ public:
     using ResultCallback = std::function<void(ClientResult)>;
     using UploadCallback = std::function<void(ClientResult, ProgressData)>;
     using DownloadCallback = std::function<void(ClientResult, ProgressData)>;
+    using DownloadToMemoryCallback =
+        std::function<void(ClientResult, ProgressData, const std::vector<uint8_t>&)>;
+    using DownloadStreamCallback = DownloadToMemoryCallback;
     using ListDirectoryCallback = std::function<void(ClientResult, std::vector<std::string>)>;
+
+    struct DirectoryEntry {
+        std::string path{}; ///< Relative to the listed directory, separated by '/'
+        bool is_directory{false};
+        uint32_t size_bytes{0}; ///< 0 for directories
+    };
+    using ListDirectoryTreeCallback =
+        std::function<void(ClientResult, std::vector<DirectoryEntry>)>;
     using AreFilesIdenticalCallback = std::function<void(ClientResult, bool)>;
 
     void send();
 
     std::pair<ClientResult, std::vector<std::string>> list_directory(const std::string& path);
+    std::pair<ClientResult, std::vector<DirectoryEntry>>
+    list_directory_tree(const std::string& path, bool recursive = true);
     ClientResult create_directory(const std::string& path);
     ClientResult remove_directory(const std::string& path);
     ClientResult remove_file(const std::string& path);
@@ -76,12 +97,31 @@ public:
         const std::string& remote_file_path,
         const std::string& local_folder,
         DownloadCallback callback);
+    // Like download_async but keeps the file in memory, it is passed along with the final
+    // result and is empty for progress updates and on failure.
+    void download_to_memory_async(
+        const std::string& remote_file_path, DownloadToMemoryCallback callback);
+    // Like download_async but hands the file on in order, in chunks of up to
+    // stream_chunk_size bytes with ClientResult::Next, instead of storing it.
+    // The final result comes with an empty chunk. Reading pauses while the
+    // callbacks fall behind by max_stream_chunks_queued chunks.
+    void
+    download_stream_async(const std::string& remote_file_path, DownloadStreamCallback callback);
+
+    static constexpr std::size_t stream_chunk_size = 64 * 1024;
+    static constexpr unsigned max_stream_chunks_queued = 4;
     void upload_async(
         const std::string& local_file_path,
         const std::string& remote_folder,
         UploadCallback callback);
     void list_directory_async(
         const std::string& path, ListDirectoryCallback callback, uint32_t offset = 0);
+    // Like list_directory_async but with the entries parsed, sorted by path, and,
+    // if recursive, the ones of all directories below as well. Several pages and
+    // directories are listed at a time instead of one page after the other. On
+    // failure, the entries found until then are passed along.
+    void list_directory_tree_async(
+        const std::string& path, ListDirectoryTreeCallback callback, bool recursive = true);
     void create_directory_async(const std::string& path, ResultCallback callback);
     void remove_directory_async(const std::string& path, ResultCallback callback);
     void remove_file_async(const std::string& path, ResultCallback callback);
@@ -99,6 +139,12 @@ public:
 
     std::optional<std::string> write_tmp_file(const std::string& path, const std::string& content);
 
+    // Serves content as a read-only file at path without writing it to disk,
+    // e.g. metadata downloaded by every ground station. Registering the same
+    // path again replaces it, sessions already open keep the old content.
+    void register_memory_file(const std::string& path, std::string content);
+    void unregister_memory_file(const std::string& path);
+
 private:
     SystemImpl& _system_impl;
 
@@ -174,8 +220,80 @@ private:
         sizeof(PayloadHeader) == sizeof(mavlink_file_transfer_protocol_t::payload),
         "PayloadHeader size is incorrect.");
 
+    /// @brief Number of chunks the server sends per burst before the client needs to ask again
+    static constexpr unsigned max_burst_chunks = 32;
+
+    /// @brief Most writes kept in flight during an upload
+    static constexpr std::size_t max_write_window = 16;
+
+    /// @brief Rough time to send one write, used to work out how many fit into a round trip
+    static constexpr double write_interval_s = 0.005;
+
+    /// @brief Most directory pages requested at a time by one tree listing
+    static constexpr std::size_t max_tree_list_requests = 4;
+
+    /// @brief Most pages of one directory requested ahead of the ones received
+    static constexpr std::size_t max_list_pages_ahead = 2;
+
+    /// @brief One directory of a tree listing
+    struct DirectoryListing {
+        std::string path{}; ///< Relative to the root of the listing
+        std::map<uint32_t, std::string> entries{}; ///< Raw entries by their index
+        uint32_t complete_to{0}; ///< All entries before it are there
+        std::optional<uint32_t> end{}; ///< Number of entries, once known
+        uint32_t page_size{0}; ///< Entries in the first page, to guess where the next start
+        uint32_t requested_to{0}; ///< Where the pages requested so far probably end
+        std::vector<uint32_t> offsets_in_flight{};
+        bool done{false};
+    };
+
+    /// @brief Directories listed for one list_directory_tree_async, in the order found
+    struct TreeListing {
+        std::string root{};
+        bool recursive{true};
+        ListDirectoryTreeCallback callback{};
+        std::vector<DirectoryListing> directories{};
+        std::vector<DirectoryEntry> found{};
+        std::size_t in_flight{0};
+        ServerResult result{ServerResult::SUCCESS};
+    };
+
+    struct WriteInFlight {
+        PayloadHeader payload;
+        std::chrono::steady_clock::time_point sent_time;
+        unsigned retries{0};
+    };
+
+    /// @brief Whether the server can send a file in bursts, only known after the first try
+    enum class BurstSupport {
+        Unknown,
+        Supported,
+        Unsupported,
+    };
+
+    /// @brief Contents of a file served read-only, from memory or mapped
+    struct ServedFile {
+        ServedFile() = default;
+        ~ServedFile();
+
+        // Non-copyable
+        ServedFile(const ServedFile&) = delete;
+        const ServedFile& operator=(const ServedFile&) = delete;
+
+        const uint8_t* data{nullptr};
+        uint32_t size{0};
+        std::string content{}; ///< Owns data for in-memory files
+        void* mapped{nullptr}; ///< Owns data for mapped files
+        std::size_t mapped_size{0};
+        // To tell whether a mapped file changed since it was mapped.
+        int64_t modified_s{0};
+        uint64_t inode{0};
+    };
+
     struct SessionInfo {
         int fd{-1};
+        /// Read from instead of fd, chunks are copied straight out of it
+        std::shared_ptr<const ServedFile> served{};
         uint32_t file_size{0};
         bool stream_download{false};
         uint32_t stream_offset{0};
@@ -189,66 +307,136 @@ private:
         std::string path;
     };
 
+    /// @brief State of one client operation, several of them can run at the same time
+    struct ClientSession : std::enable_shared_from_this<ClientSession> {
+        uint64_t id{0};
+        Opcode op{CMD_NONE};
+        uint16_t seq_number{0}; ///< Sequence number of the last request sent
+        mavlink_message_t last_command{};
+        void* timeout_cookie{nullptr};
+        bool timer_running{false};
+        uint32_t retries{0};
+
+        std::string path{};
+        bool session_valid{false};
+        uint8_t session{0}; ///< Session on the server, once the file is open
+        bool waiting_for_session{false}; ///< Open is retried once another session ends
+        ServerResult session_result{ServerResult::SUCCESS};
+        uint32_t bytes_transferred{0};
+        uint32_t file_size{0};
+        std::ifstream ifstream{};
+        OfstreamWithPath ofstream{};
+        std::vector<uint8_t> buffer{}; ///< Used instead of ofstream to download to memory
+        std::vector<std::string> directory_list{};
+        std::shared_ptr<TreeListing> tree_listing{}; ///< Set if the page is part of it
+        std::size_t tree_directory{0}; ///< Index into the directories of the tree listing
+        uint32_t list_offset{0};
+
+        uint32_t burst_offset{0}; ///< Offset expected next in the current burst
+        bool burst_received{false}; ///< Whether anything arrived since the burst was requested
+        uint32_t burst_retries{0};
+        /// Ranges [begin, end) missed during a burst, which are then read chunk by chunk
+        std::vector<std::pair<uint32_t, uint32_t>> missing_ranges{};
+
+        std::vector<WriteInFlight> writes_in_flight{}; ///< Oldest first
+        uint32_t write_offset{0}; ///< Offset of the next write to send
+        std::size_t write_window_limit{max_write_window}; ///< Lowered when writes time out
+
+        ResultCallback result_callback{};
+        // progress_callback is used for download_callback_t as well as upload_callback_t
+        DownloadCallback progress_callback{};
+        int last_progress_percentage{-1};
+        DownloadToMemoryCallback memory_callback{};
+        DownloadStreamCallback stream_callback{};
+        StreamReassembly stream{}; ///< Used instead of ofstream to download to a stream
+        std::atomic<unsigned> stream_chunks_queued{0}; ///< Handed on, not called back yet
+        bool stream_paused{false}; ///< Waiting for the callbacks to catch up
+        bool stream_paused_in_burst{false};
+        ListDirectoryCallback dir_items_callback{};
+        file_crc32_ResultCallback crc32_callback{};
+    };
+
+    static_assert(
+        std::is_same<DownloadCallback, UploadCallback>::value, "callback types don't match");
+
+    /// @brief Most client operations running at the same time
+    static constexpr std::size_t max_client_sessions = 8;
+
     struct SessionInfo _session_info {}; ///< Session info, fd=-1 for no active session
 
     uint8_t _network_id = 0;
     uint8_t _target_component_id = 0;
     bool _target_component_id_set{false};
-    Opcode _curr_op = CMD_NONE;
-    std::mutex _curr_op_mutex{};
-    mavlink_message_t _last_command{};
-    void* _last_command_timeout_cookie = nullptr;
-    bool _last_command_timer_running{false};
-    std::mutex _timer_mutex{};
     static constexpr uint32_t _last_command_timeout{200};
     uint32_t _max_last_command_retries{5};
-    uint32_t _last_command_retries = 0;
-    std::string _last_path{};
-    uint16_t _seq_number = 0;
-    std::ifstream _ifstream{};
-    OfstreamWithPath _ofstream{};
-    bool _session_valid = false;
-    uint8_t _session = 0;
-    ServerResult _session_result = ServerResult::SUCCESS;
-    uint32_t _bytes_transferred = 0;
-    uint32_t _file_size = 0;
-    std::vector<std::string> _curr_directory_list{};
-
-    ResultCallback _curr_op_result_callback{};
-    // _curr_op_progress_callback is used for download_callback_t as well as upload_callback_t
-    static_assert(
-        std::is_same<DownloadCallback, UploadCallback>::value, "callback types don't match");
-    DownloadCallback _curr_op_progress_callback{};
-    int _last_progress_percentage{-1};
 
-    ListDirectoryCallback _curr_dir_items_result_callback{};
+    std::mutex _client_sessions_mutex{};
+    std::vector<std::shared_ptr<ClientSession>> _client_sessions{};
+    uint64_t _next_client_session_id{0};
+    uint16_t _seq_number = 0; ///< Shared by all client sessions
 
-    file_crc32_ResultCallback _current_crc32_result_callback{};
+    BurstSupport _burst_support{BurstSupport::Unknown};
+    double _write_rtt_s{0.0}; ///< Smoothed round trip time of writes, 0 until measured
 
     void _calc_file_crc32_async(const std::string& path, file_crc32_ResultCallback callback);
     ClientResult _calc_local_file_crc32(const std::string& path, uint32_t& csum);
 
+    // All of the client functions below expect _client_sessions_mutex to be held.
+    std::shared_ptr<ClientSession> _new_client_session();
+    void _finish_client_session(ClientSession& session);
+    std::shared_ptr<ClientSession> _client_session_for(const PayloadHeader* payload);
+    [[nodiscard]] bool _holds_server_session() const;
+    void _retry_waiting_open();
+
     void _process_ack(PayloadHeader* payload);
     void _process_nak(PayloadHeader* payload);
-    void _process_nak(ServerResult result);
+    void _process_nak(ClientSession& session, ServerResult result);
     static ClientResult _translate(ServerResult result);
-    void _call_op_result_callback(ServerResult result);
-    void _call_op_progress_callback(uint32_t bytes_written, uint32_t total_bytes);
-    void _call_dir_items_result_callback(ServerResult result, std::vector<std::string> list);
-    void _call_crc32_result_callback(ServerResult result, uint32_t crc32);
+    void _call_op_result_callback(ClientSession& session, ServerResult result);
+    void _call_op_progress_callback(
+        ClientSession& session, uint32_t bytes_written, uint32_t total_bytes);
+    void _call_dir_items_result_callback(
+        const ClientSession& session, ServerResult result, std::vector<std::string> list);
+    void
+    _call_crc32_result_callback(const ClientSession& session, ServerResult result, uint32_t crc32);
     void _generic_command_async(
         Opcode opcode, uint32_t offset, const std::string& path, ResultCallback callback);
-    void _read();
-    void _write();
-    void _end_read_session(bool delete_file = false);
-    void _end_write_session();
-    void _terminate_session();
-    void _send_mavlink_ftp_message(const PayloadHeader& payload);
-
-    void _command_timeout();
-    void _reset_timer();
-    void _stop_timer();
-    void _list_directory(uint32_t offset);
+    void _send_path_command(ClientSession& session, uint32_t offset);
+    void _start_read(ClientSession& session);
+    void _read(ClientSession& session);
+    void _burst_read(ClientSession& session, uint32_t offset);
+    void _process_burst_data(ClientSession& session, PayloadHeader* payload);
+    void _burst_done(ClientSession& session);
+    bool _burst_timeout(ClientSession& session);
+    bool _write_at(ClientSession& session, uint32_t offset, const uint8_t* data, uint32_t size);
+    void _hand_on_stream(ClientSession& session, bool all);
+    bool _pause_stream_if_behind(ClientSession& session, bool in_burst);
+    void _resume_stream(uint64_t session_id);
+    void _write(ClientSession& session);
+    void _process_write_ack(ClientSession& session, PayloadHeader* payload);
+    bool _retransmit_nacked_write(ClientSession& session, uint16_t seq_number);
+    bool _write_timeout(ClientSession& session);
+    // Retransmission timeout of the system, _last_command_timeout until it is known.
+    double _command_timeout_s() const;
+    [[nodiscard]] std::size_t _write_window_size(const ClientSession& session) const;
+    void _end_read_session(ClientSession& session, bool delete_file = false);
+    void _end_write_session(ClientSession& session);
+    void _terminate_session(ClientSession& session);
+    void _send_mavlink_ftp_message(ClientSession& session, PayloadHeader& payload);
+    void _resend_mavlink_ftp_message(const PayloadHeader& payload);
+
+    void _start_timer(ClientSession& session);
+    void _command_timeout(uint64_t session_id);
+    void _reset_timer(ClientSession& session);
+    void _stop_timer(ClientSession& session);
+    void _list_directory(ClientSession& session, uint32_t offset);
+    void _request_tree_pages(const std::shared_ptr<TreeListing>& listing);
+    bool _request_tree_page(
+        const std::shared_ptr<TreeListing>& listing, std::size_t directory, uint32_t offset);
+    void _process_tree_page(ClientSession& session, PayloadHeader* payload);
+    void _tree_page_failed(ClientSession& session, ServerResult result);
+    void _tree_directory_done(TreeListing& listing, std::size_t directory);
+    void _tree_listing_step(const std::shared_ptr<TreeListing>& listing);
     uint8_t _get_target_component_id();
 
     // prepend a root directory to each file/dir access to avoid enumerating the full FS tree
@@ -258,8 +446,6 @@ private:
     uint16_t _last_reply_seq = 0;
     mavlink_message_t _last_reply{};
 
-    void process_mavlink_ftp_message(const mavlink_message_t& msg);
-
     std::string _data_as_string(PayloadHeader* payload);
     std::string _get_path(PayloadHeader* payload);
     std::string _get_path(const std::string& payload_path);
@@ -267,8 +453,13 @@ private:
 
     ServerResult _work_list(PayloadHeader* payload, bool list_hidden = false);
     ServerResult _work_open(PayloadHeader* payload, int oflag);
+    ServerResult _open_served(PayloadHeader* payload, std::shared_ptr<const ServedFile> served);
+    std::shared_ptr<const ServedFile> _map_file(const std::string& path);
+    [[nodiscard]] bool _server_session_open() const;
+    void _close_server_session();
     ServerResult _work_read(PayloadHeader* payload);
     ServerResult _work_burst(PayloadHeader* payload);
+    void _send_burst();
     ServerResult _work_write(PayloadHeader* payload);
     ServerResult _work_terminate(PayloadHeader* payload);
     ServerResult _work_reset(PayloadHeader* payload);
@@ -280,6 +471,11 @@ private:
 
     std::mutex _tmp_files_mutex{};
     std::unordered_map<std::string, std::string> _tmp_files{};
+    std::unordered_map<std::string, std::shared_ptr<const ServedFile>> _memory_files{};
+
+    /// @brief Files kept mapped between sessions, so downloading them again costs no file I/O
+    static constexpr std::size_t max_mapped_files = 16;
+    std::unordered_map<std::string, std::shared_ptr<const ServedFile>> _mapped_files{};
     std::string _tmp_dir{};
 };
 
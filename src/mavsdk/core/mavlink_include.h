@@ -10,4 +10,10 @@
 
 extern mavlink_status_t* mavlink_get_channel_status(uint8_t chan);
 
+// Replaces the binary search of the MAVLink helpers with a direct lookup, see
+// mavlink_msg_table.cpp. It is used for every frame parsed and signed.
+#define MAVLINK_GET_MSG_ENTRY
+
+extern const mavlink_msg_entry_t* mavlink_get_msg_entry(uint32_t msgid);
+
 #include "mavlink/v2.0/common/mavlink.h"
@@ -1,15 +1,41 @@
 #include <mutex>
+#include <thread>
 #include "mavlink_message_handler.h"
+#include "cycle_clock.h"
 
 namespace mavsdk {
 
+namespace {
+
+constexpr auto OTHER_OWNER = "other";
+
+} // namespace
+
+MAVLinkMessageHandler::MAVLinkMessageHandler(MessageIdFilter* filter) :
+    _table(std::make_shared<const Table>()),
+    _filter(filter)
+{
+    _counters.emplace(OTHER_OWNER, std::make_unique<Counters>());
+}
+
+MAVLinkMessageHandler::~MAVLinkMessageHandler()
+{
+    if (_filter == nullptr) {
+        return;
+    }
+
+    // Whatever is still registered is of no interest anymore.
+    for (const auto& [msg_id, entries] : *load_table()) {
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            _filter->remove(static_cast<uint16_t>(msg_id));
+        }
+    }
+}
+
 void MAVLinkMessageHandler::register_one(
     uint16_t msg_id, const Callback& callback, const void* cookie)
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-
-    Entry entry = {msg_id, {}, callback, cookie};
-    _table.push_back(entry);
+    register_one(msg_id, {}, callback, cookie);
 }
 
 void MAVLinkMessageHandler::register_one(
@@ -20,54 +46,172 @@ void MAVLinkMessageHandler::register_one(
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
+    auto new_table = std::make_shared<Table>(*load_table());
+
     Entry entry = {msg_id, component_id, callback, cookie};
-    _table.push_back(entry);
+    entry.counters = counters_of(cookie);
+    (*new_table)[msg_id].push_back(entry);
+
+    // Before publishing, so no message for it can be dropped anymore once the
+    // callback could be called.
+    if (_filter != nullptr) {
+        _filter->add(msg_id);
+    }
+
+    publish_table(std::move(new_table), false);
+}
+
+void MAVLinkMessageHandler::register_many(
+    const std::vector<uint16_t>& msg_ids, const Callback& callback, const void* cookie)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto new_table = std::make_shared<Table>(*load_table());
+
+    for (const auto msg_id : msg_ids) {
+        Entry entry = {msg_id, {}, callback, cookie};
+        entry.counters = counters_of(cookie);
+        (*new_table)[msg_id].push_back(entry);
+
+        if (_filter != nullptr) {
+            _filter->add(msg_id);
+        }
+    }
+
+    publish_table(std::move(new_table), false);
+}
+
+void MAVLinkMessageHandler::register_decoded(
+    uint16_t msg_id,
+    Decoder decoder,
+    DecodedCallback decoded_callback,
+    void* object,
+    const void* cookie)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto new_table = std::make_shared<Table>(*load_table());
+
+    Entry entry = {
+        msg_id, {}, nullptr, cookie, decoder, decoded_callback, object, counters_of(cookie)};
+    (*new_table)[msg_id].push_back(entry);
+
+    if (_filter != nullptr) {
+        _filter->add(msg_id);
+    }
+
+    publish_table(std::move(new_table), false);
 }
 
 void MAVLinkMessageHandler::unregister_one(uint16_t msg_id, const void* cookie)
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    for (auto it = _table.begin(); it != _table.end();
+    auto new_table = std::make_shared<Table>(*load_table());
+
+    auto found = new_table->find(msg_id);
+    if (found == new_table->end()) {
+        return;
+    }
+
+    auto& entries = found->second;
+    for (auto it = entries.begin(); it != entries.end();
          /* no ++it */) {
-        if (it->msg_id == msg_id && it->cookie == cookie) {
-            it = _table.erase(it);
+        if (it->cookie == cookie) {
+            it = entries.erase(it);
+            if (_filter != nullptr) {
+                _filter->remove(msg_id);
+            }
         } else {
             ++it;
         }
     }
+
+    if (entries.empty()) {
+        new_table->erase(found);
+    }
+
+    publish_table(std::move(new_table), true);
 }
 
 void MAVLinkMessageHandler::unregister_all(const void* cookie)
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    for (auto it = _table.begin(); it != _table.end();
-         /* no ++it */) {
-        if (it->cookie == cookie) {
-            it = _table.erase(it);
+    auto new_table = std::make_shared<Table>(*load_table());
+
+    for (auto found = new_table->begin(); found != new_table->end();
+         /* no ++found */) {
+        auto& entries = found->second;
+        for (auto it = entries.begin(); it != entries.end();
+             /* no ++it */) {
+            if (it->cookie == cookie) {
+                it = entries.erase(it);
+                if (_filter != nullptr) {
+                    _filter->remove(static_cast<uint16_t>(found->first));
+                }
+            } else {
+                ++it;
+            }
+        }
+
+        if (entries.empty()) {
+            found = new_table->erase(found);
         } else {
-            ++it;
+            ++found;
         }
     }
+
+    publish_table(std::move(new_table), true);
 }
 
 void MAVLinkMessageHandler::process_message(const mavlink_message_t& message)
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    std::lock_guard<std::mutex> lock(_dispatch_mutex);
+
+    // We hold on to this table until we're done, even if it gets replaced
+    // in the meantime.
+    const auto table = load_table();
 
 #if MESSAGE_DEBUGGING == 1
     bool forwarded = false;
 #endif
-    for (auto& entry : _table) {
-        if (entry.msg_id == message.msgid &&
-            (!entry.cmp_id.has_value() || entry.cmp_id == message.compid)) {
+
+    auto found = table->find(message.msgid);
+    if (found != table->end()) {
+        // Decoded handlers of the message ID all take the same struct, so it is
+        // decoded once for all of them.
+        alignas(std::max_align_t) uint8_t decoded[MAVLINK_MAX_PAYLOAD_LEN];
+        bool is_decoded = false;
+
+        for (auto& entry : found->second) {
+            if (!entry.cmp_id.has_value() || entry.cmp_id == message.compid) {
 #if MESSAGE_DEBUGGING == 1
-            LogDebug() << "Forwarding msg " << int(message.msgid) << " to "
-                       << size_t(entry->cookie);
-            forwarded = true;
+                LogDebug() << "Forwarding msg " << int(message.msgid) << " to "
+                           << size_t(entry.cookie);
+                forwarded = true;
 #endif
-            entry.callback(message);
+                const auto start = CycleClock::now();
+
+                if (entry.decoded_callback != nullptr) {
+                    if (!is_decoded) {
+                        entry.decoder(message, decoded);
+                        is_decoded = true;
+                    }
+                    entry.decoded_callback(entry.object, decoded);
+                } else {
+                    entry.callback(message);
+                }
+
+                const auto ticks = CycleClock::now() - start;
+                auto& counters = *entry.counters;
+                counters.invocations.fetch_add(1, std::memory_order_relaxed);
+                counters.total_ticks.fetch_add(ticks, std::memory_order_relaxed);
+                // Dispatching is serialized, so nothing else updates the maximum.
+                if (ticks > counters.max_ticks.load(std::memory_order_relaxed)) {
+                    counters.max_ticks.store(ticks, std::memory_order_relaxed);
+                }
+            }
         }
     }
 
@@ -83,11 +227,122 @@ void MAVLinkMessageHandler::update_component_id(
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    for (auto& entry : _table) {
-        if (entry.msg_id == msg_id && entry.cookie == cookie) {
+    auto new_table = std::make_shared<Table>(*load_table());
+
+    auto found = new_table->find(msg_id);
+    if (found == new_table->end()) {
+        return;
+    }
+
+    for (auto& entry : found->second) {
+        if (entry.cookie == cookie) {
             entry.cmp_id = component_id;
         }
     }
+
+    publish_table(std::move(new_table), false);
+}
+
+std::size_t MAVLinkMessageHandler::allocated_bytes() const
+{
+    const auto table = load_table();
+    if (!table) {
+        return 0;
+    }
+
+    using Node = Table::value_type;
+    std::size_t bytes = sizeof(Table) + table->bucket_count() * sizeof(void*);
+    for (const auto& pair : *table) {
+        bytes += sizeof(Node) + sizeof(void*) + pair.second.capacity() * sizeof(Entry);
+    }
+    return bytes;
+}
+
+void MAVLinkMessageHandler::set_owner_name(const void* cookie, const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto& counters = _counters[name];
+    if (!counters) {
+        counters = std::make_unique<Counters>();
+    }
+    _owners[cookie] = counters.get();
+
+    auto new_table = std::make_shared<Table>(*load_table());
+    bool changed = false;
+    for (auto& [msg_id, entries] : *new_table) {
+        for (auto& entry : entries) {
+            if (entry.cookie == cookie) {
+                entry.counters = counters.get();
+                changed = true;
+            }
+        }
+    }
+
+    if (changed) {
+        publish_table(std::move(new_table), false);
+    }
+}
+
+void MAVLinkMessageHandler::clear_owner_name(const void* cookie)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _owners.erase(cookie);
+}
+
+std::vector<MAVLinkMessageHandler::OwnerStats> MAVLinkMessageHandler::owner_stats() const
+{
+    std::vector<OwnerStats> stats;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& [name, counters] : _counters) {
+        const auto invocations = counters->invocations.load(std::memory_order_relaxed);
+        if (invocations == 0) {
+            continue;
+        }
+        stats.push_back(OwnerStats{
+            name,
+            invocations,
+            CycleClock::to_seconds(counters->total_ticks.load(std::memory_order_relaxed)),
+            CycleClock::to_seconds(counters->max_ticks.load(std::memory_order_relaxed))});
+    }
+    return stats;
+}
+
+void MAVLinkMessageHandler::reset_owner_stats()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& [name, counters] : _counters) {
+        counters->invocations.store(0, std::memory_order_relaxed);
+        counters->total_ticks.store(0, std::memory_order_relaxed);
+        counters->max_ticks.store(0, std::memory_order_relaxed);
+    }
+}
+
+MAVLinkMessageHandler::Counters* MAVLinkMessageHandler::counters_of(const void* cookie)
+{
+    const auto found = _owners.find(cookie);
+    return found != _owners.end() ? found->second : _counters[OTHER_OWNER].get();
+}
+
+std::shared_ptr<const MAVLinkMessageHandler::Table> MAVLinkMessageHandler::load_table() const
+{
+    return std::atomic_load(&_table);
+}
+
+void MAVLinkMessageHandler::publish_table(
+    std::shared_ptr<const Table> new_table, bool wait_for_dispatch)
+{
+    auto old_table = std::atomic_exchange(&_table, std::move(new_table));
+
+    if (wait_for_dispatch) {
+        // After unregistering, the caller expects its callbacks to no longer
+        // be called, e.g. because it is about to be destroyed. Therefore, we
+        // wait until no dispatch is still going through the old table.
+        while (old_table.use_count() > 1) {
+            std::this_thread::yield();
+        }
+    }
 }
 
 } // namespace mavsdk
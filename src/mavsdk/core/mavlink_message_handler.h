@@ -1,23 +1,50 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 #include <optional>
+#include <unordered_map>
 #include "mavlink_include.h"
+#include "mavlink_message_traits.h"
+#include "message_id_filter.h"
 
 namespace mavsdk {
 
 class MAVLinkMessageHandler {
 public:
+    // The filter, if any, is kept up to date with the message IDs registered.
+    explicit MAVLinkMessageHandler(MessageIdFilter* filter = nullptr);
+    ~MAVLinkMessageHandler();
+
     using Callback = std::function<void(const mavlink_message_t&)>;
 
+    // For handlers taking the decoded message, generated by register_decoded().
+    using Decoder = void (*)(const mavlink_message_t& message, void* decoded);
+    using DecodedCallback = void (*)(void* object, const void* decoded);
+
+    // What the handlers of one owner took, see set_owner_name().
+    struct Counters {
+        std::atomic<uint64_t> invocations{0};
+        std::atomic<uint64_t> total_ticks{0};
+        std::atomic<uint64_t> max_ticks{0};
+    };
+
     struct Entry {
         uint32_t msg_id;
         std::optional<uint8_t> cmp_id;
         Callback callback;
         const void* cookie; // This is the identification to unregister.
+        Decoder decoder{nullptr}; // Set instead of the callback for decoded handlers.
+        DecodedCallback decoded_callback{nullptr};
+        void* object{nullptr};
+        Counters* counters{nullptr}; // Of the owner of the cookie.
     };
 
     void register_one(uint16_t msg_id, const Callback& callback, const void* cookie);
@@ -26,14 +53,111 @@ public:
         std::optional<uint8_t> cmp_id,
         const Callback& callback,
         const void* cookie);
+    // The same callback for all of the IDs, published as one update of the table.
+    void register_many(
+        const std::vector<uint16_t>& msg_ids, const Callback& callback, const void* cookie);
+    // Registers a member function taking the decoded message, for example
+    // register_decoded<&TelemetryImpl::process_attitude>(this, this) for
+    //   void TelemetryImpl::process_attitude(const mavlink_attitude_t& attitude);
+    // The message ID follows from the type, see MavlinkMessageTraits. All
+    // handlers of a message ID registered like this share one decoding of each
+    // message, and are called directly rather than through a std::function.
+    template<auto Method, typename Object>
+    void register_decoded(Object* object, const void* cookie)
+    {
+        using Message = typename MethodTraits<decltype(Method)>::Message;
+        static_assert(sizeof(Message) <= MAVLINK_MAX_PAYLOAD_LEN, "Not a MAVLink message");
+        static_assert(alignof(Message) <= alignof(std::max_align_t), "Unexpected alignment");
+
+        register_decoded(
+            MavlinkMessageTraits<Message>::id,
+            &decode<Message>,
+            &call<Method, Object, Message>,
+            object,
+            cookie);
+    }
+    void register_decoded(
+        uint16_t msg_id,
+        Decoder decoder,
+        DecodedCallback decoded_callback,
+        void* object,
+        const void* cookie);
     void unregister_one(uint16_t msg_id, const void* cookie);
     void unregister_all(const void* cookie);
     void process_message(const mavlink_message_t& message);
     void update_component_id(uint16_t msg_id, uint8_t cmp_id, const void* cookie);
 
+    // Roughly what the current table has allocated.
+    std::size_t allocated_bytes() const;
+
+    // Attributes the handlers registered with the cookie to an owner, e.g. a
+    // plugin, so the time spent in them can be told apart from the others.
+    // Handlers registered with the cookie before are attributed to it as
+    // well. Handlers of cookies without a name count as "other".
+    void set_owner_name(const void* cookie, const std::string& name);
+    // For cookies which are about to go away, so the name isn't attributed to
+    // whatever gets the same address next.
+    void clear_owner_name(const void* cookie);
+
+    struct OwnerStats {
+        std::string owner{};
+        uint64_t invocations{0};
+        double total_s{0.0}; // Including decoding for decoded handlers.
+        double max_s{0.0};
+    };
+
+    // For the owners with handlers called so far, ordered by name.
+    std::vector<OwnerStats> owner_stats() const;
+    void reset_owner_stats();
+
+    // Non-copyable
+    MAVLinkMessageHandler(const MAVLinkMessageHandler&) = delete;
+    const MAVLinkMessageHandler& operator=(const MAVLinkMessageHandler&) = delete;
+
 private:
-    std::mutex _mutex{};
-    std::vector<Entry> _table{};
+    template<typename T> struct MethodTraits;
+    template<typename Object, typename MessageType>
+    struct MethodTraits<void (Object::*)(const MessageType&)> {
+        using Message = MessageType;
+    };
+
+    template<typename Message> static void decode(const mavlink_message_t& message, void* decoded)
+    {
+        MavlinkMessageTraits<Message>::decode(message, *static_cast<Message*>(decoded));
+    }
+
+    template<auto Method, typename Object, typename Message>
+    static void call(void* object, const void* decoded)
+    {
+        (static_cast<Object*>(object)->*Method)(*static_cast<const Message*>(decoded));
+    }
+
+    // The table is indexed by message ID and is never modified once published.
+    // Registering or unregistering copies it, modifies the copy, and then swaps
+    // it in. This way dispatching a message only needs to grab the current
+    // table and doesn't contend with registration.
+    using Table = std::unordered_map<uint32_t, std::vector<Entry>>;
+
+    std::shared_ptr<const Table> load_table() const;
+    Counters* counters_of(const void* cookie);
+    void publish_table(std::shared_ptr<const Table> new_table, bool wait_for_dispatch);
+
+    // Serializes modifications of the table.
+    mutable std::mutex _mutex{};
+
+    // Serializes dispatching so callbacks are never called concurrently,
+    // even when messages arrive on multiple connections. This is never taken
+    // when registering.
+    std::mutex _dispatch_mutex{};
+
+    std::shared_ptr<const Table> _table;
+
+    // Both guarded by _mutex. Counters are never removed, as entries of
+    // published tables point to them.
+    std::map<std::string, std::unique_ptr<Counters>> _counters{};
+    std::unordered_map<const void*, Counters*> _owners{};
+
+    MessageIdFilter* const _filter;
 };
 
 } // namespace mavsdk
@@ -0,0 +1,35 @@
+#include <benchmark/benchmark.h>
+#include "benchmark_helpers.h"
+#include "mavlink_message_handler.h"
+
+using namespace mavsdk;
+
+// One handler per message of the mix, like Telemetry registers them, and a
+// few more which never match, so the lookup doesn't get it too easy.
+static void MAVLinkMessageHandler_Dispatch(benchmark::State& state)
+{
+    const auto messages = px4_default_stream_mix(static_cast<unsigned>(state.range(0)));
+
+    MAVLinkMessageHandler handler;
+    uint64_t num_handled = 0;
+    const int cookie = 0;
+    for (const auto& stream : px4_default_streams()) {
+        handler.register_one(
+            static_cast<uint16_t>(stream.message_id),
+            [&num_handled](const mavlink_message_t&) { ++num_handled; },
+            &cookie);
+    }
+    for (uint16_t msg_id = 300; msg_id < 340; ++msg_id) {
+        handler.register_one(msg_id, [](const mavlink_message_t&) {}, &cookie);
+    }
+
+    for (auto _ : state) {
+        for (const auto& message : messages) {
+            handler.process_message(message);
+        }
+    }
+    benchmark::DoNotOptimize(num_handled);
+
+    count_messages(state, messages.size());
+}
+BENCHMARK(MAVLinkMessageHandler_Dispatch)->Apply(px4_stream_scales);
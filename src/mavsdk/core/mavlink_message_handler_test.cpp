@@ -0,0 +1,268 @@
+#include "mavlink_message_handler.h"
+#include <chrono>
+#include <thread>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+static mavlink_message_t make_message(uint32_t msg_id, uint8_t comp_id)
+{
+    mavlink_message_t message{};
+    message.msgid = msg_id;
+    message.compid = comp_id;
+    return message;
+}
+
+TEST(MAVLinkMessageHandler, DispatchByMessageId)
+{
+    MAVLinkMessageHandler handler{};
+
+    int heartbeats = 0;
+    int statustexts = 0;
+
+    const int cookie1 = 0;
+    const int cookie2 = 0;
+
+    handler.register_one(
+        MAVLINK_MSG_ID_HEARTBEAT, [&](const mavlink_message_t&) { ++heartbeats; }, &cookie1);
+    handler.register_one(
+        MAVLINK_MSG_ID_STATUSTEXT, [&](const mavlink_message_t&) { ++statustexts; }, &cookie2);
+
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT, 1));
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT, 1));
+    handler.process_message(make_message(MAVLINK_MSG_ID_STATUSTEXT, 1));
+    handler.process_message(make_message(MAVLINK_MSG_ID_ATTITUDE, 1));
+
+    EXPECT_EQ(heartbeats, 2);
+    EXPECT_EQ(statustexts, 1);
+
+    handler.unregister_one(MAVLINK_MSG_ID_HEARTBEAT, &cookie1);
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT, 1));
+    EXPECT_EQ(heartbeats, 2);
+
+    handler.unregister_all(&cookie2);
+    handler.process_message(make_message(MAVLINK_MSG_ID_STATUSTEXT, 1));
+    EXPECT_EQ(statustexts, 1);
+}
+
+TEST(MAVLinkMessageHandler, RegisterMany)
+{
+    MAVLinkMessageHandler handler{};
+
+    std::vector<uint32_t> received;
+    const int cookie = 0;
+
+    handler.register_many(
+        {MAVLINK_MSG_ID_HEARTBEAT, MAVLINK_MSG_ID_ATTITUDE},
+        [&](const mavlink_message_t& message) { received.push_back(message.msgid); },
+        &cookie);
+
+    handler.process_message(make_message(MAVLINK_MSG_ID_ATTITUDE, 1));
+    handler.process_message(make_message(MAVLINK_MSG_ID_STATUSTEXT, 1));
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT, 1));
+    EXPECT_EQ(
+        received, (std::vector<uint32_t>{MAVLINK_MSG_ID_ATTITUDE, MAVLINK_MSG_ID_HEARTBEAT}));
+
+    handler.unregister_all(&cookie);
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT, 1));
+    EXPECT_EQ(received.size(), 2u);
+}
+
+TEST(MAVLinkMessageHandler, FilterByComponentId)
+{
+    MAVLinkMessageHandler handler{};
+
+    int any = 0;
+    int only_camera = 0;
+
+    const int cookie1 = 0;
+    const int cookie2 = 0;
+
+    handler.register_one(
+        MAVLINK_MSG_ID_HEARTBEAT, [&](const mavlink_message_t&) { ++any; }, &cookie1);
+    handler.register_one(
+        MAVLINK_MSG_ID_HEARTBEAT,
+        MAV_COMP_ID_CAMERA,
+        [&](const mavlink_message_t&) { ++only_camera; },
+        &cookie2);
+
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT, MAV_COMP_ID_AUTOPILOT1));
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT, MAV_COMP_ID_CAMERA));
+    EXPECT_EQ(any, 2);
+    EXPECT_EQ(only_camera, 1);
+
+    handler.update_component_id(MAVLINK_MSG_ID_HEARTBEAT, MAV_COMP_ID_AUTOPILOT1, &cookie2);
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT, MAV_COMP_ID_AUTOPILOT1));
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT, MAV_COMP_ID_CAMERA));
+    EXPECT_EQ(any, 4);
+    EXPECT_EQ(only_camera, 2);
+}
+
+TEST(MAVLinkMessageHandler, RegisterWhileDispatching)
+{
+    MAVLinkMessageHandler handler{};
+
+    int first = 0;
+    int second = 0;
+
+    const int cookie = 0;
+
+    handler.register_one(
+        MAVLINK_MSG_ID_HEARTBEAT,
+        [&](const mavlink_message_t&) {
+            ++first;
+            if (first == 1) {
+                // This must not deadlock, and the new callback only applies to
+                // the next message.
+                handler.register_one(
+                    MAVLINK_MSG_ID_HEARTBEAT, [&](const mavlink_message_t&) { ++second; }, &cookie);
+            }
+        },
+        &cookie);
+
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT, 1));
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(second, 0);
+
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT, 1));
+    EXPECT_EQ(first, 2);
+    EXPECT_EQ(second, 1);
+}
+
+TEST(MAVLinkMessageHandler, KeepsFilterUpToDate)
+{
+    MessageIdFilter filter{};
+
+    {
+        MAVLinkMessageHandler handler{&filter};
+
+        const int cookie1 = 0;
+        const int cookie2 = 0;
+
+        handler.register_one(MAVLINK_MSG_ID_HEARTBEAT, [](const mavlink_message_t&) {}, &cookie1);
+        handler.register_one(MAVLINK_MSG_ID_HEARTBEAT, [](const mavlink_message_t&) {}, &cookie2);
+        handler.register_one(MAVLINK_MSG_ID_ATTITUDE, [](const mavlink_message_t&) {}, &cookie2);
+        handler.register_one(MAVLINK_MSG_ID_STATUSTEXT, [](const mavlink_message_t&) {}, &cookie1);
+        EXPECT_TRUE(filter.wants(MAVLINK_MSG_ID_HEARTBEAT));
+        EXPECT_TRUE(filter.wants(MAVLINK_MSG_ID_ATTITUDE));
+        EXPECT_TRUE(filter.wants(MAVLINK_MSG_ID_STATUSTEXT));
+        EXPECT_FALSE(filter.wants(MAVLINK_MSG_ID_GPS_RAW_INT));
+
+        handler.unregister_all(&cookie2);
+        EXPECT_TRUE(filter.wants(MAVLINK_MSG_ID_HEARTBEAT));
+        EXPECT_FALSE(filter.wants(MAVLINK_MSG_ID_ATTITUDE));
+
+        handler.unregister_one(MAVLINK_MSG_ID_HEARTBEAT, &cookie1);
+        EXPECT_FALSE(filter.wants(MAVLINK_MSG_ID_HEARTBEAT));
+        EXPECT_TRUE(filter.wants(MAVLINK_MSG_ID_STATUSTEXT));
+    }
+
+    // Whatever was left goes away with the handler.
+    EXPECT_FALSE(filter.wants(MAVLINK_MSG_ID_STATUSTEXT));
+}
+
+namespace {
+
+class AttitudeReceiver {
+public:
+    void process_attitude(const mavlink_attitude_t& attitude) { rolls.push_back(attitude.roll); }
+
+    std::vector<float> rolls;
+};
+
+mavlink_message_t make_attitude(float roll)
+{
+    mavlink_message_t message;
+    mavlink_msg_attitude_pack(1, 1, &message, 0, roll, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    return message;
+}
+
+} // namespace
+
+TEST(MAVLinkMessageHandler, DispatchDecoded)
+{
+    MessageIdFilter filter{};
+    MAVLinkMessageHandler handler{&filter};
+
+    AttitudeReceiver first;
+    AttitudeReceiver second;
+    int raw = 0;
+
+    handler.register_decoded<&AttitudeReceiver::process_attitude>(&first, &first);
+    handler.register_decoded<&AttitudeReceiver::process_attitude>(&second, &second);
+    handler.register_one(MAVLINK_MSG_ID_ATTITUDE, [&](const mavlink_message_t&) { ++raw; }, &raw);
+    EXPECT_TRUE(filter.wants(MAVLINK_MSG_ID_ATTITUDE));
+
+    handler.process_message(make_attitude(0.5f));
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT, 1));
+    handler.process_message(make_attitude(-0.25f));
+
+    EXPECT_EQ(first.rolls, (std::vector<float>{0.5f, -0.25f}));
+    EXPECT_EQ(second.rolls, first.rolls);
+    EXPECT_EQ(raw, 2);
+
+    handler.unregister_all(&first);
+    handler.process_message(make_attitude(1.0f));
+    EXPECT_EQ(first.rolls.size(), 2u);
+    EXPECT_EQ(second.rolls.size(), 3u);
+
+    handler.unregister_all(&second);
+    handler.unregister_all(&raw);
+    EXPECT_FALSE(filter.wants(MAVLINK_MSG_ID_ATTITUDE));
+}
+
+TEST(MAVLinkMessageHandler, CountsByOwner)
+{
+    MAVLinkMessageHandler handler{};
+
+    const int plugin = 0;
+    const int unnamed = 0;
+    const int named_later = 0;
+
+    handler.set_owner_name(&plugin, "TelemetryImpl");
+    handler.register_one(MAVLINK_MSG_ID_HEARTBEAT, [](const mavlink_message_t&) {}, &plugin);
+    handler.register_one(MAVLINK_MSG_ID_STATUSTEXT, [](const mavlink_message_t&) {}, &plugin);
+    handler.register_one(MAVLINK_MSG_ID_HEARTBEAT, [](const mavlink_message_t&) {}, &unnamed);
+    handler.register_one(MAVLINK_MSG_ID_ATTITUDE, [](const mavlink_message_t&) {}, &named_later);
+
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT, 1));
+    handler.process_message(make_message(MAVLINK_MSG_ID_STATUSTEXT, 1));
+
+    // Handlers already registered move over to the owner.
+    handler.set_owner_name(&named_later, "CameraImpl");
+    handler.process_message(make_message(MAVLINK_MSG_ID_ATTITUDE, 1));
+
+    const auto stats = handler.owner_stats();
+    ASSERT_EQ(stats.size(), 3u);
+    EXPECT_EQ(stats[0].owner, "CameraImpl");
+    EXPECT_EQ(stats[0].invocations, 1u);
+    EXPECT_EQ(stats[1].owner, "TelemetryImpl");
+    EXPECT_EQ(stats[1].invocations, 2u);
+    EXPECT_GE(stats[1].total_s, stats[1].max_s);
+    EXPECT_EQ(stats[2].owner, "other");
+    EXPECT_EQ(stats[2].invocations, 1u);
+
+    handler.reset_owner_stats();
+    EXPECT_TRUE(handler.owner_stats().empty());
+}
+
+TEST(MAVLinkMessageHandler, TimesHandlers)
+{
+    MAVLinkMessageHandler handler{};
+
+    const int cookie = 0;
+    handler.set_owner_name(&cookie, "MissionImpl");
+    handler.register_one(
+        MAVLINK_MSG_ID_HEARTBEAT,
+        [](const mavlink_message_t&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        },
+        &cookie);
+
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT, 1));
+
+    const auto stats = handler.owner_stats();
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_GT(stats[0].max_s, 0.015);
+    EXPECT_LT(stats[0].max_s, 1.0);
+}
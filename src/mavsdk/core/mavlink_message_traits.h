@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include "mavlink_include.h"
+
+namespace mavsdk {
+
+// Ties a decoded MAVLink message struct to its message ID and decode function,
+// so that handlers can be registered by the type they take, see
+// MAVLinkMessageHandler::register_decoded().
+template<typename Message> struct MavlinkMessageTraits;
+
+// Plugins can use this for further messages they want to receive decoded.
+#define MAVSDK_MAVLINK_MESSAGE_TRAITS(name, NAME)                                      \
+    template<> struct MavlinkMessageTraits<mavlink_##name##_t> {                       \
+        static constexpr uint16_t id = MAVLINK_MSG_ID_##NAME;                          \
+        static void decode(const mavlink_message_t& message, mavlink_##name##_t& out) \
+        {                                                                              \
+            mavlink_msg_##name##_decode(&message, &out);                               \
+        }                                                                              \
+    }
+
+MAVSDK_MAVLINK_MESSAGE_TRAITS(attitude, ATTITUDE);
+MAVSDK_MAVLINK_MESSAGE_TRAITS(attitude_quaternion, ATTITUDE_QUATERNION);
+MAVSDK_MAVLINK_MESSAGE_TRAITS(global_position_int, GLOBAL_POSITION_INT);
+MAVSDK_MAVLINK_MESSAGE_TRAITS(highres_imu, HIGHRES_IMU);
+MAVSDK_MAVLINK_MESSAGE_TRAITS(local_position_ned, LOCAL_POSITION_NED);
+MAVSDK_MAVLINK_MESSAGE_TRAITS(odometry, ODOMETRY);
+MAVSDK_MAVLINK_MESSAGE_TRAITS(raw_imu, RAW_IMU);
+MAVSDK_MAVLINK_MESSAGE_TRAITS(scaled_imu, SCALED_IMU);
+MAVSDK_MAVLINK_MESSAGE_TRAITS(scaled_pressure, SCALED_PRESSURE);
+MAVSDK_MAVLINK_MESSAGE_TRAITS(vfr_hud, VFR_HUD);
+
+} // namespace mavsdk
@@ -1,26 +1,53 @@
 #include <algorithm>
 #include "mavlink_mission_transfer.h"
 #include "log.h"
+#include "mission_cache.h"
+#include "trace.h"
 #include "unused.h"
 
+// The opaque ids identifying the items on a vehicle came with a later
+// version of the mission protocol, so they are only used if the MAVLink
+// headers already have them.
+#if MAVLINK_MSG_ID_MISSION_CURRENT_LEN >= 18 && MAVLINK_MSG_ID_MISSION_COUNT_LEN >= 9 && \
+    MAVLINK_MSG_ID_MISSION_ACK_LEN >= 8
+#define MISSION_OPAQUE_IDS 1
+#else
+#define MISSION_OPAQUE_IDS 0
+#endif
+
 namespace mavsdk {
 
 MAVLinkMissionTransfer::MAVLinkMissionTransfer(
     Sender& sender,
     MAVLinkMessageHandler& message_handler,
     TimeoutHandler& timeout_handler,
-    TimeoutSCallback timeout_s_callback) :
+    TimeoutSCallback timeout_s_callback,
+    ScheduleWorkCallback schedule_work_callback) :
     _sender(sender),
     _message_handler(message_handler),
     _timeout_handler(timeout_handler),
-    _timeout_s_callback(std::move(timeout_s_callback))
-{}
+    _timeout_s_callback(std::move(timeout_s_callback)),
+    _schedule_work_callback(std::move(schedule_work_callback))
+{
+#if MISSION_OPAQUE_IDS
+    _message_handler.register_one(
+        MAVLINK_MSG_ID_MISSION_CURRENT,
+        [this](const mavlink_message_t& message) { process_mission_current(message); },
+        this);
+#endif
+}
+
+MAVLinkMissionTransfer::~MAVLinkMissionTransfer()
+{
+    _message_handler.unregister_all(this);
+}
 
 std::weak_ptr<MAVLinkMissionTransfer::WorkItem> MAVLinkMissionTransfer::upload_items_async(
     uint8_t type,
     const std::vector<ItemInt>& items,
     const ResultCallback& callback,
-    const ProgressCallback& progress_callback)
+    const ProgressCallback& progress_callback,
+    std::shared_ptr<MissionUploadScheduler> scheduler)
 {
     if (!_int_messages_supported) {
         if (callback) {
@@ -30,7 +57,8 @@ std::weak_ptr<MAVLinkMissionTransfer::WorkItem> MAVLinkMissionTransfer::upload_i
         return {};
     }
 
-    auto ptr = std::make_shared<UploadWorkItem>(
+    auto ptr = make_pooled<UploadWorkItem>(
+        _work_pool,
         _sender,
         _message_handler,
         _timeout_handler,
@@ -39,12 +67,112 @@ std::weak_ptr<MAVLinkMissionTransfer::WorkItem> MAVLinkMissionTransfer::upload_i
         _timeout_s_callback(),
         callback,
         progress_callback);
+    ptr->set_store_callback(
+        [this](uint8_t store_type, uint32_t opaque_id, const std::vector<ItemInt>& stored_items) {
+            store_in_cache(store_type, opaque_id, stored_items);
+        });
+    ptr->set_scheduler(std::move(scheduler));
+
+    _work_queue.push_back(ptr);
+    schedule_work();
+
+    return std::weak_ptr<WorkItem>(ptr);
+}
+
+std::weak_ptr<MAVLinkMissionTransfer::WorkItem> MAVLinkMissionTransfer::upload_partial_items_async(
+    uint8_t type,
+    const std::vector<ItemInt>& items,
+    ItemRange range,
+    const ResultCallback& callback,
+    const ProgressCallback& progress_callback)
+{
+    if (!_int_messages_supported) {
+        if (callback) {
+            LogErr() << "Int messages are not supported.";
+            callback(Result::IntMessagesNotSupported);
+        }
+        return {};
+    }
+
+    auto ptr = make_pooled<UploadWorkItem>(
+        _work_pool,
+        _sender,
+        _message_handler,
+        _timeout_handler,
+        type,
+        items,
+        _timeout_s_callback(),
+        callback,
+        progress_callback,
+        range);
+    ptr->set_store_callback(
+        [this](uint8_t store_type, uint32_t opaque_id, const std::vector<ItemInt>& stored_items) {
+            store_in_cache(store_type, opaque_id, stored_items);
+        });
 
     _work_queue.push_back(ptr);
+    schedule_work();
 
     return std::weak_ptr<WorkItem>(ptr);
 }
 
+std::weak_ptr<MAVLinkMissionTransfer::UploadWorkItem>
+MAVLinkMissionTransfer::upload_streamed_items_async(
+    uint8_t type,
+    std::size_t count,
+    const ResultCallback& callback,
+    const ProgressCallback& progress_callback)
+{
+    if (!_int_messages_supported) {
+        if (callback) {
+            LogErr() << "Int messages are not supported.";
+            callback(Result::IntMessagesNotSupported);
+        }
+        return {};
+    }
+
+    auto ptr = make_pooled<UploadWorkItem>(
+        _work_pool,
+        _sender,
+        _message_handler,
+        _timeout_handler,
+        type,
+        std::vector<ItemInt>{},
+        _timeout_s_callback(),
+        callback,
+        progress_callback,
+        std::nullopt,
+        count);
+
+    _work_queue.push_back(ptr);
+    schedule_work();
+
+    return std::weak_ptr<UploadWorkItem>(ptr);
+}
+
+std::optional<std::vector<MAVLinkMissionTransfer::ItemRange>>
+MAVLinkMissionTransfer::changed_ranges(
+    const std::vector<ItemInt>& before, const std::vector<ItemInt>& after, std::size_t max_gap)
+{
+    if (before.size() != after.size()) {
+        return std::nullopt;
+    }
+
+    std::vector<ItemRange> ranges;
+    for (std::size_t i = 0; i < after.size(); ++i) {
+        if (before[i] == after[i]) {
+            continue;
+        }
+        const auto seq = static_cast<uint16_t>(i);
+        if (!ranges.empty() && i - ranges.back().last - 1 <= max_gap) {
+            ranges.back().last = seq;
+        } else {
+            ranges.push_back(ItemRange{seq, seq});
+        }
+    }
+    return ranges;
+}
+
 std::weak_ptr<MAVLinkMissionTransfer::WorkItem> MAVLinkMissionTransfer::download_items_async(
     uint8_t type, ResultAndItemsCallback callback, ProgressCallback progress_callback)
 {
@@ -56,7 +184,23 @@ std::weak_ptr<MAVLinkMissionTransfer::WorkItem> MAVLinkMissionTransfer::download
         return {};
     }
 
-    auto ptr = std::make_shared<DownloadWorkItem>(
+    // Anything queued before might still change the items on the vehicle.
+    if (is_idle()) {
+        if (auto items = items_from_cache(type)) {
+            LogDebug() << "Mission items of type " << static_cast<int>(type)
+                       << " unchanged, using cached ones";
+            if (progress_callback) {
+                progress_callback(1.0f);
+            }
+            if (callback) {
+                callback(Result::Success, std::move(*items));
+            }
+            return {};
+        }
+    }
+
+    auto ptr = make_pooled<DownloadWorkItem>(
+        _work_pool,
         _sender,
         _message_handler,
         _timeout_handler,
@@ -64,8 +208,13 @@ std::weak_ptr<MAVLinkMissionTransfer::WorkItem> MAVLinkMissionTransfer::download
         _timeout_s_callback(),
         callback,
         progress_callback);
+    ptr->set_store_callback(
+        [this](uint8_t store_type, uint32_t opaque_id, const std::vector<ItemInt>& stored_items) {
+            store_in_cache(store_type, opaque_id, stored_items);
+        });
 
     _work_queue.push_back(ptr);
+    schedule_work();
 
     return std::weak_ptr<WorkItem>(ptr);
 }
@@ -82,7 +231,8 @@ MAVLinkMissionTransfer::receive_incoming_items_async(
         return {};
     }
 
-    auto ptr = std::make_shared<ReceiveIncomingMission>(
+    auto ptr = make_pooled<ReceiveIncomingMission>(
+        _work_pool,
         _sender,
         _message_handler,
         _timeout_handler,
@@ -93,40 +243,86 @@ MAVLinkMissionTransfer::receive_incoming_items_async(
         target_component);
 
     _work_queue.push_back(ptr);
+    schedule_work();
 
     return std::weak_ptr<WorkItem>(ptr);
 }
 
 void MAVLinkMissionTransfer::clear_items_async(uint8_t type, ResultCallback callback)
 {
-    auto ptr = std::make_shared<ClearWorkItem>(
-        _sender, _message_handler, _timeout_handler, type, _timeout_s_callback(), callback);
+    clear_cache(type);
+
+    auto ptr = make_pooled<ClearWorkItem>(
+        _work_pool,
+        _sender,
+        _message_handler,
+        _timeout_handler,
+        type,
+        _timeout_s_callback(),
+        callback);
 
     _work_queue.push_back(ptr);
+    schedule_work();
 }
 
 void MAVLinkMissionTransfer::set_current_item_async(int current, ResultCallback callback)
 {
-    auto ptr = std::make_shared<SetCurrentWorkItem>(
-        _sender, _message_handler, _timeout_handler, current, _timeout_s_callback(), callback);
+    auto ptr = make_pooled<SetCurrentWorkItem>(
+        _work_pool,
+        _sender,
+        _message_handler,
+        _timeout_handler,
+        current,
+        _timeout_s_callback(),
+        callback);
 
     _work_queue.push_back(ptr);
+    schedule_work();
 }
 
 void MAVLinkMissionTransfer::do_work()
 {
     LockedQueue<WorkItem>::Guard work_queue_guard(_work_queue);
-    auto work = work_queue_guard.get_front();
 
-    if (!work) {
-        return;
+    // Transfers of different mission types are independent of each other and
+    // can run at the same time. Only items of the same type, or anything
+    // together with MAV_MISSION_TYPE_ALL, have to run in the order queued.
+    std::vector<uint8_t> busy_types;
+    const auto conflicts = [&busy_types](uint8_t type) {
+        return std::any_of(busy_types.begin(), busy_types.end(), [type](uint8_t busy_type) {
+            return busy_type == type || busy_type == MAV_MISSION_TYPE_ALL ||
+                   type == MAV_MISSION_TYPE_ALL;
+        });
+    };
+
+    bool removed_any = false;
+    for (auto it = _work_queue.begin(); it != _work_queue.end();) {
+        auto work = *it;
+
+        if (!work->has_started() && !conflicts(work->type())) {
+            work->start();
+        }
+
+        if (work->is_done()) {
+            it = _work_queue.erase(it);
+            removed_any = true;
+            continue;
+        }
+
+        busy_types.push_back(work->type());
+        ++it;
     }
 
-    if (!work->has_started()) {
-        work->start();
+    if (removed_any) {
+        // Next items can start right away.
+        schedule_work();
     }
-    if (work->is_done()) {
-        work_queue_guard.pop_front();
+}
+
+void MAVLinkMissionTransfer::schedule_work()
+{
+    if (_schedule_work_callback) {
+        _schedule_work_callback();
     }
 }
 
@@ -136,6 +332,98 @@ bool MAVLinkMissionTransfer::is_idle()
     return (work_queue_guard.get_front() == nullptr);
 }
 
+void MAVLinkMissionTransfer::set_cache_path_callback(CachePathCallback callback)
+{
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    _cache_path_callback = std::move(callback);
+}
+
+void MAVLinkMissionTransfer::process_mission_current(const mavlink_message_t& message)
+{
+#if MISSION_OPAQUE_IDS
+    mavlink_mission_current_t mission_current;
+    mavlink_msg_mission_current_decode(&message, &mission_current);
+
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    _cache[MAV_MISSION_TYPE_MISSION].vehicle_opaque_id = mission_current.mission_id;
+    _cache[MAV_MISSION_TYPE_FENCE].vehicle_opaque_id = mission_current.fence_id;
+    _cache[MAV_MISSION_TYPE_RALLY].vehicle_opaque_id = mission_current.rally_points_id;
+#else
+    UNUSED(message);
+#endif
+}
+
+void MAVLinkMissionTransfer::store_in_cache(
+    uint8_t type, uint32_t opaque_id, const std::vector<ItemInt>& items)
+{
+    // 0 means the vehicle doesn't know which items it has.
+    if (type >= _cache.size() || opaque_id == 0) {
+        return;
+    }
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(_cache_mutex);
+        // Only used once MISSION_CURRENT confirms the id, as it would
+        // also tell about changes made by anyone else.
+        auto& entry = _cache[type];
+        entry.opaque_id = opaque_id;
+        entry.items = items;
+        entry.loaded = true;
+        if (_cache_path_callback) {
+            path = _cache_path_callback(type);
+        }
+    }
+
+    if (!path.empty() && mission_cache_save(path, MissionCache{opaque_id, type, items})) {
+        LogDebug() << "Saved " << items.size() << " mission items to " << path;
+    }
+}
+
+std::optional<std::vector<MAVLinkMissionTransfer::ItemInt>>
+MAVLinkMissionTransfer::items_from_cache(uint8_t type)
+{
+    if (type >= _cache.size()) {
+        return std::nullopt;
+    }
+
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    auto& entry = _cache[type];
+    if (!entry.vehicle_opaque_id || *entry.vehicle_opaque_id == 0) {
+        return std::nullopt;
+    }
+
+    if (!entry.loaded) {
+        entry.loaded = true;
+        const auto path = _cache_path_callback ? _cache_path_callback(type) : std::string{};
+        if (!path.empty()) {
+            auto cache = mission_cache_load(path);
+            if (cache && cache->mission_type == type) {
+                entry.opaque_id = cache->opaque_id;
+                entry.items = std::move(cache->items);
+            }
+        }
+    }
+
+    if (entry.opaque_id != entry.vehicle_opaque_id) {
+        return std::nullopt;
+    }
+    return entry.items;
+}
+
+void MAVLinkMissionTransfer::clear_cache(uint8_t type)
+{
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    for (std::size_t i = 0; i < _cache.size(); ++i) {
+        if (type == i || type == MAV_MISSION_TYPE_ALL) {
+            // Not loaded from disk anymore either, it's outdated.
+            _cache[i].opaque_id.reset();
+            _cache[i].items.clear();
+            _cache[i].loaded = true;
+        }
+    }
+}
+
 MAVLinkMissionTransfer::WorkItem::WorkItem(
     Sender& sender,
     MAVLinkMessageHandler& message_handler,
@@ -163,6 +451,13 @@ bool MAVLinkMissionTransfer::WorkItem::is_done()
     return _done;
 }
 
+bool MAVLinkMissionTransfer::WorkItem::is_active_for(uint8_t mission_type) const
+{
+    // Items register their handlers when created, so queued ones and ones
+    // running in parallel for other mission types see the messages too.
+    return _started && !_done && (_type == MAV_MISSION_TYPE_ALL || mission_type == _type);
+}
+
 MAVLinkMissionTransfer::UploadWorkItem::UploadWorkItem(
     Sender& sender,
     MAVLinkMessageHandler& message_handler,
@@ -171,11 +466,15 @@ MAVLinkMissionTransfer::UploadWorkItem::UploadWorkItem(
     const std::vector<ItemInt>& items,
     double timeout_s,
     ResultCallback callback,
-    ProgressCallback progress_callback) :
+    ProgressCallback progress_callback,
+    std::optional<ItemRange> partial_range,
+    std::optional<std::size_t> streamed_count) :
     WorkItem(sender, message_handler, timeout_handler, type, timeout_s),
     _items(items),
     _callback(callback),
-    _progress_callback(progress_callback)
+    _progress_callback(progress_callback),
+    _partial_range(partial_range),
+    _streamed_count(streamed_count)
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
@@ -200,6 +499,9 @@ MAVLinkMissionTransfer::UploadWorkItem::~UploadWorkItem()
     std::lock_guard<std::mutex> lock(_mutex);
     _message_handler.unregister_all(this);
     _timeout_handler.remove(_cookie);
+    if (_scheduler) {
+        _scheduler->drop(this);
+    }
 }
 
 void MAVLinkMissionTransfer::UploadWorkItem::start()
@@ -207,6 +509,31 @@ void MAVLinkMissionTransfer::UploadWorkItem::start()
     std::lock_guard<std::mutex> lock(_mutex);
 
     _started = true;
+    if (_done) {
+        // Streamed items were wrong before we even started.
+        return;
+    }
+
+    if (_streamed_count) {
+        if (*_streamed_count == 0) {
+            callback_and_reset(Result::NoMissionAvailable);
+            return;
+        }
+        _first_sequence = 0;
+        _end_sequence = *_streamed_count;
+
+        update_progress(0.0f);
+
+        _retries_done = 0;
+        _step = Step::SendCount;
+        _timeout_handler.add([this]() { process_timeout(); }, _timeout_s, &_cookie);
+
+        _next_sequence = _first_sequence;
+
+        send_count();
+        return;
+    }
+
     if (_items.size() == 0) {
         callback_and_reset(Result::NoMissionAvailable);
         return;
@@ -236,17 +563,86 @@ void MAVLinkMissionTransfer::UploadWorkItem::start()
         return;
     }
 
+    if (_partial_range) {
+        if (_partial_range->first > _partial_range->last ||
+            _partial_range->last >= _items.size()) {
+            callback_and_reset(Result::InvalidSequence);
+            return;
+        }
+        _first_sequence = _partial_range->first;
+        _end_sequence = _partial_range->last + 1;
+    } else {
+        _first_sequence = 0;
+        _end_sequence = _items.size();
+    }
+
+    encode_items();
+
     update_progress(0.0f);
 
     _retries_done = 0;
     _step = Step::SendCount;
     _timeout_handler.add([this]() { process_timeout(); }, _timeout_s, &_cookie);
 
-    _next_sequence = 0;
+    _next_sequence = _first_sequence;
 
     send_count();
 }
 
+MAVLinkMissionTransfer::Result
+MAVLinkMissionTransfer::UploadWorkItem::add_items(const std::vector<ItemInt>& items)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_streamed_count) {
+        return Result::ProtocolError;
+    }
+    if (_done) {
+        return Result::Cancelled;
+    }
+
+    const auto fail = [this](Result result) {
+        if (_started) {
+            // Whatever the vehicle got so far is of no use.
+            _timeout_handler.remove(_cookie);
+            mavlink_message_t message;
+            mavlink_msg_mission_ack_pack(
+                _sender.get_own_system_id(),
+                _sender.get_own_component_id(),
+                &message,
+                _sender.get_system_id(),
+                MAV_COMP_ID_AUTOPILOT1,
+                MAV_MISSION_OPERATION_CANCELLED,
+                _type);
+            _sender.send_message(message);
+        }
+        callback_and_reset(result);
+        return result;
+    };
+
+    for (const auto& item : items) {
+        if (item.seq != _encoded_items.size() || item.seq >= *_streamed_count) {
+            return fail(Result::InvalidSequence);
+        }
+        if (item.mission_type != _type) {
+            return fail(Result::MissionTypeNotConsistent);
+        }
+        _streamed_currents += item.current;
+        if (_streamed_currents > 1 ||
+            (_encoded_items.size() + 1 == *_streamed_count && _streamed_currents != 1)) {
+            return fail(Result::CurrentInvalid);
+        }
+        _encoded_items.push_back(encode_item(item));
+    }
+
+    if (_waiting_for_items && _next_sequence < _encoded_items.size()) {
+        _waiting_for_items = false;
+        _timeout_handler.refresh(_cookie);
+        send_mission_item();
+    }
+    return Result::Success;
+}
+
 void MAVLinkMissionTransfer::UploadWorkItem::cancel()
 {
     std::lock_guard<std::mutex> lock(_mutex);
@@ -257,17 +653,40 @@ void MAVLinkMissionTransfer::UploadWorkItem::cancel()
 
 void MAVLinkMissionTransfer::UploadWorkItem::send_count()
 {
-    mavlink_message_t message;
-    mavlink_msg_mission_count_pack(
-        _sender.get_own_system_id(),
-        _sender.get_own_component_id(),
-        &message,
-        _sender.get_system_id(),
-        MAV_COMP_ID_AUTOPILOT1,
-        _items.size(),
-        _type);
+    Pack pack;
+    std::size_t bytes = MAVLINK_NUM_NON_PAYLOAD_BYTES;
+    if (_partial_range) {
+        // The vehicle answers this the same way as a count, just starting
+        // with the first item of the range.
+        pack = [&sender = _sender, range = *_partial_range, type = _type](
+                   mavlink_message_t& message) {
+            mavlink_msg_mission_write_partial_list_pack(
+                sender.get_own_system_id(),
+                sender.get_own_component_id(),
+                &message,
+                sender.get_system_id(),
+                MAV_COMP_ID_AUTOPILOT1,
+                range.first,
+                range.last,
+                type);
+        };
+        bytes += MAVLINK_MSG_ID_MISSION_WRITE_PARTIAL_LIST_LEN;
+    } else {
+        pack = [&sender = _sender, count = _end_sequence, type = _type](
+                   mavlink_message_t& message) {
+            mavlink_msg_mission_count_pack(
+                sender.get_own_system_id(),
+                sender.get_own_component_id(),
+                &message,
+                sender.get_system_id(),
+                MAV_COMP_ID_AUTOPILOT1,
+                count,
+                type);
+        };
+        bytes += MAVLINK_MSG_ID_MISSION_COUNT_LEN;
+    }
 
-    if (!_sender.send_message(message)) {
+    if (!send_scheduled(std::move(pack), bytes)) {
         _timeout_handler.remove(_cookie);
         callback_and_reset(Result::ConnectionError);
         return;
@@ -323,8 +742,14 @@ void MAVLinkMissionTransfer::UploadWorkItem::process_mission_request(
     } else {
         std::lock_guard<std::mutex> lock(_mutex);
 
+        mavlink_mission_request_t request;
+        mavlink_msg_mission_request_decode(&request_message, &request);
+
+        if (!is_active_for(request.mission_type)) {
+            return;
+        }
+
         // We only support int, so we nack this and thus tell the autopilot to use int.
-        UNUSED(request_message);
 
         mavlink_message_t message;
         mavlink_msg_mission_ack_pack(
@@ -348,11 +773,21 @@ void MAVLinkMissionTransfer::UploadWorkItem::process_mission_request(
 void MAVLinkMissionTransfer::UploadWorkItem::process_mission_request_int(
     const mavlink_message_t& message)
 {
+    MAVSDK_TRACE_SCOPE("mission", "upload_item_requested", message.msgid);
     std::lock_guard<std::mutex> lock(_mutex);
 
     mavlink_mission_request_int_t request_int;
     mavlink_msg_mission_request_int_decode(&message, &request_int);
 
+    if (!is_active_for(request_int.mission_type)) {
+        return;
+    }
+
+    if (request_int.seq < _first_sequence) {
+        LogWarn() << "mission_request_int: sequence before partial range";
+        return;
+    }
+
     _step = Step::SendItems;
 
     // LogDebug() << "Process mission_request_int, seq: " << request_int.seq
@@ -383,45 +818,72 @@ void MAVLinkMissionTransfer::UploadWorkItem::process_mission_request_int(
     _next_sequence = request_int.seq;
 
     // We add in a step for the final ack, so plus one.
-    update_progress(static_cast<float>(_next_sequence + 1) / static_cast<float>(_items.size() + 1));
+    update_progress(
+        static_cast<float>(_next_sequence - _first_sequence + 1) /
+        static_cast<float>(_end_sequence - _first_sequence + 1));
+
+    if (_next_sequence >= _encoded_items.size()) {
+        // Sent once add_items gets to it.
+        _waiting_for_items = true;
+        return;
+    }
 
     send_mission_item();
 }
 
+void MAVLinkMissionTransfer::UploadWorkItem::encode_items()
+{
+    _encoded_items.clear();
+    _encoded_items.reserve(_items.size());
+    for (const auto& item : _items) {
+        _encoded_items.push_back(encode_item(item));
+    }
+}
+
+mavlink_mission_item_int_t
+MAVLinkMissionTransfer::UploadWorkItem::encode_item(const ItemInt& item) const
+{
+    mavlink_mission_item_int_t encoded{};
+    encoded.target_system = _sender.get_system_id();
+    encoded.target_component = MAV_COMP_ID_AUTOPILOT1;
+    encoded.seq = item.seq;
+    encoded.frame = item.frame;
+    encoded.command = item.command;
+    encoded.current = item.current;
+    encoded.autocontinue = item.autocontinue;
+    encoded.param1 = item.param1;
+    encoded.param2 = item.param2;
+    encoded.param3 = item.param3;
+    encoded.param4 = item.param4;
+    encoded.x = item.x;
+    encoded.y = item.y;
+    encoded.z = item.z;
+    encoded.mission_type = _type;
+    return encoded;
+}
+
 void MAVLinkMissionTransfer::UploadWorkItem::send_mission_item()
 {
-    if (_next_sequence >= _items.size()) {
+    if (_next_sequence >= _encoded_items.size()) {
         LogErr() << "send_mission_item: sequence out of bounds";
         return;
     }
 
-    mavlink_message_t message;
-    mavlink_msg_mission_item_int_pack(
-        _sender.get_own_system_id(),
-        _sender.get_own_component_id(),
-        &message,
-        _sender.get_system_id(),
-        MAV_COMP_ID_AUTOPILOT1,
-        _next_sequence,
-        _items[_next_sequence].frame,
-        _items[_next_sequence].command,
-        _items[_next_sequence].current,
-        _items[_next_sequence].autocontinue,
-        _items[_next_sequence].param1,
-        _items[_next_sequence].param2,
-        _items[_next_sequence].param3,
-        _items[_next_sequence].param4,
-        _items[_next_sequence].x,
-        _items[_next_sequence].y,
-        _items[_next_sequence].z,
-        _type);
+    // Only the header and checksum are left to do, the sequence number of the
+    // frame has to be the current one.
+    auto pack = [&sender = _sender, item = _encoded_items[_next_sequence]](
+                    mavlink_message_t& message) {
+        mavlink_msg_mission_item_int_encode(
+            sender.get_own_system_id(), sender.get_own_component_id(), &message, &item);
+    };
 
     // LogDebug() << "Sending mission_item_int seq: " << _next_sequence
     //           << ", retry: " << _retries_done;
 
     ++_next_sequence;
 
-    if (!_sender.send_message(message)) {
+    if (!send_scheduled(
+            std::move(pack), MAVLINK_NUM_NON_PAYLOAD_BYTES + MAVLINK_MSG_ID_MISSION_ITEM_INT_LEN)) {
         _timeout_handler.remove(_cookie);
         callback_and_reset(Result::ConnectionError);
         return;
@@ -430,13 +892,39 @@ void MAVLinkMissionTransfer::UploadWorkItem::send_mission_item()
     ++_retries_done;
 }
 
+bool MAVLinkMissionTransfer::UploadWorkItem::send_scheduled(Pack pack, std::size_t bytes)
+{
+    if (!_scheduler) {
+        mavlink_message_t message;
+        pack(message);
+        return _sender.send_message(message);
+    }
+
+    // Anything sent before without an answer is a retry, the vehicle is
+    // already waiting for it. It is only packed when it goes out, so the
+    // sequence number of the frame is still the current one then, and
+    // nothing of this item is used as it might be gone by then.
+    const bool retry = _retries_done > 0;
+    return _scheduler->send(
+        this, bytes, retry, [&sender = _sender, pack = std::move(pack)]() mutable {
+            mavlink_message_t message;
+            pack(message);
+            return sender.send_message(message);
+        });
+}
+
 void MAVLinkMissionTransfer::UploadWorkItem::process_mission_ack(const mavlink_message_t& message)
 {
+    MAVSDK_TRACE_SCOPE("mission", "upload_ack", message.msgid);
     std::lock_guard<std::mutex> lock(_mutex);
 
     mavlink_mission_ack_t mission_ack;
     mavlink_msg_mission_ack_decode(&message, &mission_ack);
 
+    if (!is_active_for(mission_ack.mission_type)) {
+        return;
+    }
+
     // LogDebug() << "Received mission_ack type: " << static_cast<int>(mission_ack.type);
 
     _timeout_handler.remove(_cookie);
@@ -482,7 +970,10 @@ void MAVLinkMissionTransfer::UploadWorkItem::process_mission_ack(const mavlink_m
             return;
     }
 
-    if (_next_sequence == _items.size()) {
+    if (_next_sequence == _end_sequence) {
+#if MISSION_OPAQUE_IDS
+        _opaque_id = mission_ack.opaque_id;
+#endif
         update_progress(1.0f);
         callback_and_reset(Result::Success);
     } else {
@@ -492,6 +983,7 @@ void MAVLinkMissionTransfer::UploadWorkItem::process_mission_ack(const mavlink_m
 
 void MAVLinkMissionTransfer::UploadWorkItem::process_timeout()
 {
+    MAVSDK_TRACE_SCOPE("mission", "upload_timeout", 0);
     std::lock_guard<std::mutex> lock(_mutex);
 
     // LogDebug() << "Timeout triggered, retries: " << _retries_done;
@@ -519,6 +1011,14 @@ void MAVLinkMissionTransfer::UploadWorkItem::process_timeout()
 
 void MAVLinkMissionTransfer::UploadWorkItem::callback_and_reset(Result result)
 {
+    if (_scheduler) {
+        // Whatever is still queued is of no use anymore.
+        _scheduler->drop(this);
+    }
+    // Streamed items are not kept around, so there is nothing to store.
+    if (result == Result::Success && _store_callback && !_streamed_count) {
+        _store_callback(_type, _opaque_id, _items);
+    }
     if (_callback) {
         _callback(result);
     }
@@ -673,11 +1173,20 @@ void MAVLinkMissionTransfer::DownloadWorkItem::send_cancel_and_finish()
 void MAVLinkMissionTransfer::DownloadWorkItem::process_mission_count(
     const mavlink_message_t& message)
 {
+    MAVSDK_TRACE_SCOPE("mission", "download_count", message.msgid);
     std::lock_guard<std::mutex> lock(_mutex);
 
     mavlink_mission_count_t count;
     mavlink_msg_mission_count_decode(&message, &count);
 
+    if (!is_active_for(count.mission_type)) {
+        return;
+    }
+
+#if MISSION_OPAQUE_IDS
+    _opaque_id = count.opaque_id;
+#endif
+
     if (count.count == 0) {
         send_ack_and_finish();
         _timeout_handler.remove(_cookie);
@@ -695,13 +1204,18 @@ void MAVLinkMissionTransfer::DownloadWorkItem::process_mission_count(
 void MAVLinkMissionTransfer::DownloadWorkItem::process_mission_item_int(
     const mavlink_message_t& message)
 {
+    MAVSDK_TRACE_SCOPE("mission", "download_item", message.msgid);
     std::lock_guard<std::mutex> lock(_mutex);
 
-    _timeout_handler.refresh(_cookie);
-
     mavlink_mission_item_int_t item_int;
     mavlink_msg_mission_item_int_decode(&message, &item_int);
 
+    if (!is_active_for(item_int.mission_type)) {
+        return;
+    }
+
+    _timeout_handler.refresh(_cookie);
+
     _items.push_back(ItemInt{
         item_int.seq,
         item_int.frame,
@@ -732,6 +1246,7 @@ void MAVLinkMissionTransfer::DownloadWorkItem::process_mission_item_int(
 
 void MAVLinkMissionTransfer::DownloadWorkItem::process_timeout()
 {
+    MAVSDK_TRACE_SCOPE("mission", "download_timeout", 0);
     std::lock_guard<std::mutex> lock(_mutex);
 
     if (_retries_done >= retries) {
@@ -754,6 +1269,9 @@ void MAVLinkMissionTransfer::DownloadWorkItem::process_timeout()
 
 void MAVLinkMissionTransfer::DownloadWorkItem::callback_and_reset(Result result)
 {
+    if (result == Result::Success && _store_callback) {
+        _store_callback(_type, _opaque_id, _items);
+    }
     if (_callback) {
         _callback(result, _items);
     }
@@ -899,11 +1417,16 @@ void MAVLinkMissionTransfer::ReceiveIncomingMission::process_mission_item_int(
     const mavlink_message_t& message)
 {
     std::lock_guard<std::mutex> lock(_mutex);
-    _timeout_handler.refresh(_cookie);
 
     mavlink_mission_item_int_t item_int;
     mavlink_msg_mission_item_int_decode(&message, &item_int);
 
+    if (!is_active_for(item_int.mission_type)) {
+        return;
+    }
+
+    _timeout_handler.refresh(_cookie);
+
     _items.push_back(ItemInt{
         item_int.seq,
         item_int.frame,
@@ -1036,6 +1559,10 @@ void MAVLinkMissionTransfer::ClearWorkItem::process_mission_ack(const mavlink_me
     mavlink_mission_ack_t mission_ack;
     mavlink_msg_mission_ack_decode(&message, &mission_ack);
 
+    if (!is_active_for(mission_ack.mission_type)) {
+        return;
+    }
+
     _timeout_handler.remove(_cookie);
 
     switch (mission_ack.type) {
@@ -1176,6 +1703,11 @@ void MAVLinkMissionTransfer::SetCurrentWorkItem::process_mission_current(
     mavlink_mission_current_t mission_current;
     mavlink_msg_mission_current_decode(&message, &mission_current);
 
+    // MISSION_CURRENT is always about the mission itself.
+    if (!is_active_for(MAV_MISSION_TYPE_MISSION)) {
+        return;
+    }
+
     _timeout_handler.remove(_cookie);
 
     if (_current == mission_current.seq) {
@@ -1,16 +1,23 @@
 #pragma once
 
+#include <array>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <string>
 #include <vector>
 #include "mavlink_address.h"
 #include "mavlink_include.h"
 #include "mavlink_message_handler.h"
+#include "mission_upload_scheduler.h"
 #include "timeout_handler.h"
 #include "locked_queue.h"
+#include "slab_pool.h"
+#include "unique_function.h"
 
 namespace mavsdk {
 
@@ -68,18 +75,37 @@ public:
 
         bool operator==(const ItemInt& other) const
         {
+            // Unused params are NAN, which should still count as the same.
+            const auto same = [](float lhs, float rhs) {
+                return lhs == rhs || (std::isnan(lhs) && std::isnan(rhs));
+            };
             return (
                 seq == other.seq && frame == other.frame && command == other.command &&
                 current == other.current && autocontinue == other.autocontinue &&
-                param1 == other.param1 && param2 == other.param2 && param3 == other.param3 &&
-                param4 == other.param4 && x == other.x && y == other.y && z == other.z &&
-                mission_type == other.mission_type);
+                same(param1, other.param1) && same(param2, other.param2) &&
+                same(param3, other.param3) && same(param4, other.param4) && x == other.x &&
+                y == other.y && same(z, other.z) && mission_type == other.mission_type);
+        }
+    };
+
+    // Inclusive range of sequence numbers.
+    struct ItemRange {
+        uint16_t first;
+        uint16_t last;
+
+        bool operator==(const ItemRange& other) const
+        {
+            return first == other.first && last == other.last;
         }
     };
 
     using ResultCallback = std::function<void(Result result)>;
     using ResultAndItemsCallback = std::function<void(Result result, std::vector<ItemInt> items)>;
     using ProgressCallback = std::function<void(float progress)>;
+    // Called with the items on the vehicle after a transfer, along with the
+    // opaque id the vehicle reported for them.
+    using StoreCallback = std::function<void(
+        uint8_t type, uint32_t opaque_id, const std::vector<ItemInt>& items)>;
 
     class WorkItem {
     public:
@@ -94,6 +120,7 @@ public:
         virtual void cancel() = 0;
         bool has_started();
         bool is_done();
+        uint8_t type() const { return _type; }
 
         WorkItem(const WorkItem&) = delete;
         WorkItem(WorkItem&&) = delete;
@@ -101,6 +128,10 @@ public:
         WorkItem& operator=(WorkItem&&) = delete;
 
     protected:
+        // Whether a message for this mission type is meant for this item,
+        // needs to be called with _mutex held.
+        bool is_active_for(uint8_t mission_type) const;
+
         Sender& _sender;
         MAVLinkMessageHandler& _message_handler;
         TimeoutHandler& _timeout_handler;
@@ -121,12 +152,29 @@ public:
             const std::vector<ItemInt>& items,
             double timeout_s,
             ResultCallback callback,
-            ProgressCallback progress_callback);
+            ProgressCallback progress_callback,
+            std::optional<ItemRange> partial_range = std::nullopt,
+            std::optional<std::size_t> streamed_count = std::nullopt);
 
         ~UploadWorkItem() override;
         void start() override;
         void cancel() override;
 
+        // Only for uploads of streamed items, in order, can be called before
+        // the upload started. Anything wrong ends the upload.
+        Result add_items(const std::vector<ItemInt>& items);
+
+        // Needs to be set before the upload started.
+        void set_store_callback(StoreCallback callback) { _store_callback = std::move(callback); }
+
+        // Sends the count and items within the link budget shared with the
+        // other uploads of the scheduler. Needs to be set before the upload
+        // started.
+        void set_scheduler(std::shared_ptr<MissionUploadScheduler> scheduler)
+        {
+            _scheduler = std::move(scheduler);
+        }
+
         UploadWorkItem(const UploadWorkItem&) = delete;
         UploadWorkItem(UploadWorkItem&&) = delete;
         UploadWorkItem& operator=(const UploadWorkItem&) = delete;
@@ -134,7 +182,12 @@ public:
 
     private:
         void send_count();
+        void encode_items();
+        mavlink_mission_item_int_t encode_item(const ItemInt& item) const;
         void send_mission_item();
+        // Packs what is sent, possibly later on when scheduled.
+        using Pack = UniqueFunction<void(mavlink_message_t&)>;
+        bool send_scheduled(Pack pack, std::size_t bytes);
         void send_cancel_and_finish();
 
         void process_mission_request(const mavlink_message_t& message);
@@ -151,11 +204,27 @@ public:
         } _step{Step::SendCount};
 
         std::vector<ItemInt> _items{};
+        // The items as they go out, ready to be answered with as soon as
+        // they are requested.
+        std::vector<mavlink_mission_item_int_t> _encoded_items{};
         ResultCallback _callback{nullptr};
         ProgressCallback _progress_callback{nullptr};
         std::size_t _next_sequence{0};
         void* _cookie{nullptr};
         unsigned _retries_done{0};
+        // Items to write with MISSION_WRITE_PARTIAL_LIST, the whole list
+        // with MISSION_COUNT if not set.
+        std::optional<ItemRange> _partial_range{};
+        std::size_t _first_sequence{0};
+        std::size_t _end_sequence{0};
+        // Items announced with MISSION_COUNT but added later with add_items,
+        // so only the encoded ones are kept.
+        std::optional<std::size_t> _streamed_count{};
+        unsigned _streamed_currents{0};
+        bool _waiting_for_items{false};
+        StoreCallback _store_callback{nullptr};
+        uint32_t _opaque_id{0};
+        std::shared_ptr<MissionUploadScheduler> _scheduler{};
     };
 
     class ReceiveIncomingMission : public WorkItem {
@@ -218,6 +287,9 @@ public:
         void start() override;
         void cancel() override;
 
+        // Needs to be set before the download started.
+        void set_store_callback(StoreCallback callback) { _store_callback = std::move(callback); }
+
         DownloadWorkItem(const DownloadWorkItem&) = delete;
         DownloadWorkItem(DownloadWorkItem&&) = delete;
         DownloadWorkItem& operator=(const DownloadWorkItem&) = delete;
@@ -247,6 +319,8 @@ public:
         std::size_t _next_sequence{0};
         std::size_t _expected_count{0};
         unsigned _retries_done{0};
+        StoreCallback _store_callback{nullptr};
+        uint32_t _opaque_id{0};
     };
 
     class ClearWorkItem : public WorkItem {
@@ -314,21 +388,57 @@ public:
     static constexpr unsigned retries = 5;
 
     using TimeoutSCallback = std::function<double()>;
+    // Called whenever do_work() should be called again soon.
+    using ScheduleWorkCallback = std::function<void()>;
 
     explicit MAVLinkMissionTransfer(
         Sender& sender,
         MAVLinkMessageHandler& message_handler,
         TimeoutHandler& timeout_handler,
-        TimeoutSCallback get_timeout_s_callback);
+        TimeoutSCallback get_timeout_s_callback,
+        ScheduleWorkCallback schedule_work_callback = nullptr);
 
-    ~MAVLinkMissionTransfer() = default;
+    ~MAVLinkMissionTransfer();
 
+    // With a scheduler, the count and items go out within its link budget,
+    // see UploadWorkItem::set_scheduler().
     std::weak_ptr<WorkItem> upload_items_async(
         uint8_t type,
         const std::vector<ItemInt>& items,
         const ResultCallback& callback,
+        const ProgressCallback& progress_callback = nullptr,
+        std::shared_ptr<MissionUploadScheduler> scheduler = nullptr);
+
+    // Overwrites only the items in range with MISSION_WRITE_PARTIAL_LIST,
+    // the ones before and after it have to be on the vehicle already.
+    // `items` is the complete list as it should be afterwards and has to
+    // match the length of the one on the vehicle.
+    std::weak_ptr<WorkItem> upload_partial_items_async(
+        uint8_t type,
+        const std::vector<ItemInt>& items,
+        ItemRange range,
+        const ResultCallback& callback,
+        const ProgressCallback& progress_callback = nullptr);
+
+    // Announces count items to the vehicle right away, which are then added
+    // in order with UploadWorkItem::add_items as they become available. The
+    // vehicle requesting items not added yet just waits for them.
+    std::weak_ptr<UploadWorkItem> upload_streamed_items_async(
+        uint8_t type,
+        std::size_t count,
+        const ResultCallback& callback,
         const ProgressCallback& progress_callback = nullptr);
 
+    // Ranges of items that differ between two lists of the same length.
+    // Ranges with no more than max_gap unchanged items in between are merged
+    // since resending a few items is cheaper than another transfer. Returns
+    // nullopt if the lists differ in length so a partial upload can't be
+    // used, and an empty vector if they are the same.
+    static std::optional<std::vector<ItemRange>> changed_ranges(
+        const std::vector<ItemInt>& before,
+        const std::vector<ItemInt>& after,
+        std::size_t max_gap = 4);
+
     std::weak_ptr<WorkItem> download_items_async(
         uint8_t type,
         ResultAndItemsCallback callback,
@@ -350,6 +460,11 @@ public:
 
     void set_int_messages_supported(bool supported);
 
+    // Returns where the last items of a mission type transferred are kept
+    // across sessions, or an empty path to keep them in memory only.
+    using CachePathCallback = std::function<std::string(uint8_t type)>;
+    void set_cache_path_callback(CachePathCallback callback);
+
     // Non-copyable
     MAVLinkMissionTransfer(const MAVLinkMissionTransfer&) = delete;
     const MAVLinkMissionTransfer& operator=(const MAVLinkMissionTransfer&) = delete;
@@ -359,8 +474,36 @@ private:
     MAVLinkMessageHandler& _message_handler;
     TimeoutHandler& _timeout_handler;
     TimeoutSCallback _timeout_s_callback;
+    ScheduleWorkCallback _schedule_work_callback;
+
+    void schedule_work();
+
+    // Downloads are answered from the items last transferred as long as the
+    // vehicle reports the same opaque id for them as it did back then.
+    // Vehicles not reporting opaque ids always get the whole transfer.
+    struct CacheEntry {
+        std::optional<uint32_t> vehicle_opaque_id{};
+        std::optional<uint32_t> opaque_id{};
+        std::vector<ItemInt> items{};
+        bool loaded{false};
+    };
+
+    void process_mission_current(const mavlink_message_t& message);
+    void store_in_cache(uint8_t type, uint32_t opaque_id, const std::vector<ItemInt>& items);
+    std::optional<std::vector<ItemInt>> items_from_cache(uint8_t type);
+    void clear_cache(uint8_t type);
+
+    std::mutex _cache_mutex{};
+    std::array<CacheEntry, 3> _cache{};
+    CachePathCallback _cache_path_callback{nullptr};
 
     LockedQueue<WorkItem> _work_queue{};
+    std::shared_ptr<SlabPool> _work_pool{make_shared_slab_pool<
+        UploadWorkItem,
+        ReceiveIncomingMission,
+        DownloadWorkItem,
+        ClearWorkItem,
+        SetCurrentWorkItem>(2)};
 
     bool _int_messages_supported{true};
 };
@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <functional>
+#include <optional>
+#include <vector>
+#include "benchmark_helpers.h"
+#include "mavlink_mission_transfer.h"
+#include "mavsdk.h"
+#include "simulated_link.h"
+#include "virtual_time_executor.h"
+
+using namespace mavsdk;
+
+using Result = MAVLinkMissionTransfer::Result;
+using ItemInt = MAVLinkMissionTransfer::ItemInt;
+
+namespace {
+
+const MAVLinkAddress ground_address{245, MAV_COMP_ID_MISSIONPLANNER};
+const MAVLinkAddress vehicle_address{1, MAV_COMP_ID_AUTOPILOT1};
+
+constexpr uint16_t NUM_ITEMS = 200;
+
+std::vector<ItemInt> example_items()
+{
+    std::vector<ItemInt> items;
+    for (uint16_t i = 0; i < NUM_ITEMS; ++i) {
+        ItemInt item{};
+        item.seq = i;
+        item.frame = MAV_FRAME_GLOBAL_RELATIVE_ALT_INT;
+        item.command = MAV_CMD_NAV_WAYPOINT;
+        item.current = uint8_t(i == 0 ? 1 : 0);
+        item.autocontinue = 1;
+        item.x = 473977420 + i * 100;
+        item.y = 85455940 + i * 100;
+        item.z = 20.0f;
+        item.mission_type = MAV_MISSION_TYPE_MISSION;
+        items.push_back(item);
+    }
+    return items;
+}
+
+struct Transfer {
+    bool success{false};
+    double elapsed_s{0.0};
+    uint64_t messages_sent{0};
+};
+
+// Both ends run on virtual time, so a transfer over a slow lossy link takes
+// no longer to run than one over a perfect link.
+class Simulation {
+public:
+    explicit Simulation(const SimulatedLink::Config& config) :
+        _link(_executor, ground_address, vehicle_address, config),
+        _client(
+            _link.a(),
+            _link.a().message_handler(),
+            _executor.timeout_handler(),
+            [config]() { return Mavsdk::DEFAULT_TIMEOUT_S + 2.0 * config.latency_s; })
+    {
+        _executor.call_every_handler().add([this]() { _client.do_work(); }, 0.01, &_work_cookie);
+    }
+
+    ~Simulation() { _executor.call_every_handler().remove(_work_cookie); }
+
+    Transfer run_until(const std::function<bool()>& done)
+    {
+        Transfer transfer;
+        transfer.success = _executor.run_until(done, 3600.0);
+        transfer.elapsed_s = _executor.elapsed_s();
+        transfer.messages_sent = _link.a().messages_sent() + _link.b().messages_sent();
+        return transfer;
+    }
+
+    VirtualTimeExecutor& executor() { return _executor; }
+    SimulatedLink& link() { return _link; }
+    MAVLinkMissionTransfer& client() { return _client; }
+
+private:
+    FakeTime _time{};
+    VirtualTimeExecutor _executor{_time};
+    SimulatedLink _link;
+    MAVLinkMissionTransfer _client;
+    void* _work_cookie{nullptr};
+};
+
+Transfer simulate_upload(const SimulatedLink::Config& config, const std::vector<ItemInt>& items)
+{
+    Simulation simulation(config);
+
+    // The vehicle end is a mission transfer as well, which starts receiving
+    // once the count comes in.
+    MAVLinkMissionTransfer vehicle(
+        simulation.link().b(),
+        simulation.link().b().message_handler(),
+        simulation.executor().timeout_handler(),
+        [config]() { return Mavsdk::DEFAULT_TIMEOUT_S + 2.0 * config.latency_s; });
+    void* vehicle_cookie = nullptr;
+    simulation.executor().call_every_handler().add(
+        [&]() { vehicle.do_work(); }, 0.01, &vehicle_cookie);
+
+    bool received = false;
+    simulation.link().b().message_handler().register_one(
+        MAVLINK_MSG_ID_MISSION_COUNT,
+        [&](const mavlink_message_t& message) {
+            if (!vehicle.is_idle() || received) {
+                return;
+            }
+            mavlink_mission_count_t mission_count;
+            mavlink_msg_mission_count_decode(&message, &mission_count);
+            vehicle.receive_incoming_items_async(
+                mission_count.mission_type,
+                mission_count.count,
+                message.compid,
+                [&](Result result, const std::vector<ItemInt>&) {
+                    received = (result == Result::Success);
+                });
+        },
+        &received);
+
+    std::optional<Result> result;
+    simulation.client().upload_items_async(
+        MAV_MISSION_TYPE_MISSION, items, [&](Result new_result) { result = new_result; });
+
+    auto transfer = simulation.run_until([&]() { return result.has_value(); });
+    transfer.success = transfer.success && result == Result::Success && received;
+
+    simulation.link().b().message_handler().unregister_all(&received);
+    simulation.executor().call_every_handler().remove(vehicle_cookie);
+    return transfer;
+}
+
+Transfer simulate_download(const SimulatedLink::Config& config, const std::vector<ItemInt>& items)
+{
+    Simulation simulation(config);
+    auto& vehicle = simulation.link().b();
+
+    // The vehicle end just answers what it is asked, like an autopilot.
+    vehicle.message_handler().register_one(
+        MAVLINK_MSG_ID_MISSION_REQUEST_LIST,
+        [&](const mavlink_message_t& message) {
+            mavlink_message_t count;
+            mavlink_msg_mission_count_pack(
+                vehicle_address.system_id,
+                vehicle_address.component_id,
+                &count,
+                message.sysid,
+                message.compid,
+                static_cast<uint16_t>(items.size()),
+                MAV_MISSION_TYPE_MISSION);
+            vehicle.send_message(count);
+        },
+        &vehicle);
+
+    vehicle.message_handler().register_one(
+        MAVLINK_MSG_ID_MISSION_REQUEST_INT,
+        [&](const mavlink_message_t& message) {
+            mavlink_mission_request_int_t request;
+            mavlink_msg_mission_request_int_decode(&message, &request);
+            if (request.seq >= items.size()) {
+                return;
+            }
+            const auto& item = items[request.seq];
+            mavlink_message_t item_message;
+            mavlink_msg_mission_item_int_pack(
+                vehicle_address.system_id,
+                vehicle_address.component_id,
+                &item_message,
+                message.sysid,
+                message.compid,
+                item.seq,
+                item.frame,
+                item.command,
+                item.current,
+                item.autocontinue,
+                item.param1,
+                item.param2,
+                item.param3,
+                item.param4,
+                item.x,
+                item.y,
+                item.z,
+                item.mission_type);
+            vehicle.send_message(item_message);
+        },
+        &vehicle);
+
+    std::optional<Result> result;
+    std::vector<ItemInt> downloaded;
+    simulation.client().download_items_async(
+        MAV_MISSION_TYPE_MISSION, [&](Result new_result, std::vector<ItemInt> new_items) {
+            result = new_result;
+            downloaded = std::move(new_items);
+        });
+
+    auto transfer = simulation.run_until([&]() { return result.has_value(); });
+    transfer.success = transfer.success && result == Result::Success && downloaded == items;
+
+    vehicle.message_handler().unregister_all(&vehicle);
+    return transfer;
+}
+
+} // namespace
+
+// Uploading a mission, the vehicle requesting the items one by one.
+static void MissionTransfer_Upload(benchmark::State& state)
+{
+    const auto config = lossy_link_config(state);
+    const auto items = example_items();
+
+    Transfer transfer;
+    for (auto _ : state) {
+        transfer = simulate_upload(config, items);
+    }
+
+    // The count, a request and an item each, and the ack.
+    const uint64_t needed = 1 + 2 * items.size() + 1;
+    report_transfer(
+        state,
+        transfer.success,
+        transfer.elapsed_s,
+        transfer.messages_sent - std::min(transfer.messages_sent, needed),
+        items.size() * MAVLINK_MSG_ID_MISSION_ITEM_INT_LEN);
+}
+BENCHMARK(MissionTransfer_Upload)->Apply(lossy_links)->Unit(benchmark::kMillisecond);
+
+// Downloading a mission, requesting the items one by one.
+static void MissionTransfer_Download(benchmark::State& state)
+{
+    const auto config = lossy_link_config(state);
+    const auto items = example_items();
+
+    Transfer transfer;
+    for (auto _ : state) {
+        transfer = simulate_download(config, items);
+    }
+
+    // The list request and the count, a request and an item each, and the ack.
+    const uint64_t needed = 2 + 2 * items.size() + 1;
+    report_transfer(
+        state,
+        transfer.success,
+        transfer.elapsed_s,
+        transfer.messages_sent - std::min(transfer.messages_sent, needed),
+        items.size() * MAVLINK_MSG_ID_MISSION_ITEM_INT_LEN);
+}
+BENCHMARK(MissionTransfer_Download)->Apply(lossy_links)->Unit(benchmark::kMillisecond);
@@ -5,7 +5,9 @@
 
 #include "mavlink_mission_transfer.h"
 #include "mocks/sender_mock.h"
+#include "simulated_link.h"
 #include "unused.h"
+#include "virtual_time_executor.h"
 
 using namespace mavsdk;
 
@@ -937,6 +939,261 @@ TEST_F(MAVLinkMissionTransferTest, UploadMissionWithProgress)
     EXPECT_TRUE(mmt.is_idle());
 }
 
+bool is_correct_mission_write_partial_list(
+    uint8_t type, uint16_t first, uint16_t last, const mavlink_message_t& message)
+{
+    if (message.msgid != MAVLINK_MSG_ID_MISSION_WRITE_PARTIAL_LIST) {
+        return false;
+    }
+
+    mavlink_mission_write_partial_list_t partial_list;
+    mavlink_msg_mission_write_partial_list_decode(&message, &partial_list);
+    return (
+        message.sysid == own_address.system_id && message.compid == own_address.component_id &&
+        partial_list.target_system == target_address.system_id &&
+        partial_list.target_component == target_address.component_id &&
+        partial_list.start_index == first && partial_list.end_index == last &&
+        partial_list.mission_type == type);
+}
+
+TEST_F(MAVLinkMissionTransferTest, UploadPartialMissionSendsOnlyRange)
+{
+    std::vector<ItemInt> items;
+    for (uint16_t i = 0; i < 5; ++i) {
+        items.push_back(make_item(MAV_MISSION_TYPE_MISSION, i));
+    }
+
+    ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+
+    EXPECT_CALL(mock_sender, send_message(Truly([](const mavlink_message_t& message) {
+                    return is_correct_mission_write_partial_list(
+                        MAV_MISSION_TYPE_MISSION, 2, 3, message);
+                })));
+
+    mmt.upload_partial_items_async(
+        MAV_MISSION_TYPE_MISSION,
+        items,
+        MAVLinkMissionTransfer::ItemRange{2, 3},
+        [&prom](Result result) {
+            EXPECT_EQ(result, Result::Success);
+            ONCE_ONLY;
+            prom.set_value();
+        });
+    mmt.do_work();
+
+    // Items before the range are not ours to send.
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_the_same_mission_item_int(items[0], message);
+                })))
+        .Times(0);
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 0));
+
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_the_same_mission_item_int(items[2], message);
+                })));
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 2));
+
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_the_same_mission_item_int(items[3], message);
+                })));
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 3));
+
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
+TEST_F(MAVLinkMissionTransferTest, UploadPartialMissionComplainsAboutRangeOutOfBounds)
+{
+    std::vector<ItemInt> items;
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 0));
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 1));
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+
+    mmt.upload_partial_items_async(
+        MAV_MISSION_TYPE_MISSION,
+        items,
+        MAVLinkMissionTransfer::ItemRange{1, 2},
+        [&prom](Result result) {
+            EXPECT_EQ(result, Result::InvalidSequence);
+            ONCE_ONLY;
+            prom.set_value();
+        });
+    mmt.do_work();
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+}
+
+TEST_F(MAVLinkMissionTransferTest, UploadStreamedMissionWaitsForItems)
+{
+    std::vector<ItemInt> items;
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 0));
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 1));
+
+    ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+
+    EXPECT_CALL(mock_sender, send_message(Truly([](const mavlink_message_t& message) {
+                    return is_correct_mission_send_count(MAV_MISSION_TYPE_MISSION, 2, message);
+                })));
+
+    auto upload =
+        mmt.upload_streamed_items_async(MAV_MISSION_TYPE_MISSION, 2, [&prom](Result result) {
+            EXPECT_EQ(result, Result::Success);
+            ONCE_ONLY;
+            prom.set_value();
+        });
+    EXPECT_EQ(upload.lock()->add_items({items[0]}), Result::Success);
+    mmt.do_work();
+
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_the_same_mission_item_int(items[0], message);
+                })));
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 0));
+
+    // Not there yet, so it goes out once added.
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_the_same_mission_item_int(items[1], message);
+                })));
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 1));
+    EXPECT_EQ(upload.lock()->add_items({items[1]}), Result::Success);
+
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
+TEST_F(MAVLinkMissionTransferTest, UploadMissionWithSchedulerStaysWithinBudget)
+{
+    std::vector<ItemInt> items;
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 0));
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 1));
+
+    ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+    auto scheduler = std::make_shared<MissionUploadScheduler>(
+        MissionUploadScheduler::Config{100.0, 0.1, 0}, time);
+
+    // Another upload used up the budget.
+    const int other_upload = 0;
+    scheduler->send(&other_upload, 280, false, []() { return true; });
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+
+    EXPECT_CALL(mock_sender, send_message(_)).Times(0);
+    mmt.upload_items_async(
+        MAV_MISSION_TYPE_MISSION,
+        items,
+        [&prom](Result result) {
+            EXPECT_EQ(result, Result::Success);
+            ONCE_ONLY;
+            prom.set_value();
+        },
+        nullptr,
+        scheduler);
+    mmt.do_work();
+    EXPECT_EQ(scheduler->num_queued(), 1);
+
+    // A second of budget is enough for the count and one item.
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_correct_mission_send_count(
+                        MAV_MISSION_TYPE_MISSION, items.size(), message);
+                })));
+    time.sleep_for(std::chrono::seconds(1));
+    scheduler->pump();
+
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_the_same_mission_item_int(items[0], message);
+                })));
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 0));
+
+    // Has to wait for more budget.
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 1));
+    EXPECT_EQ(scheduler->num_queued(), 1);
+
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_the_same_mission_item_int(items[1], message);
+                })));
+    time.sleep_for(std::chrono::seconds(1));
+    scheduler->pump();
+
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    EXPECT_EQ(scheduler->num_queued(), 0);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
+TEST_F(MAVLinkMissionTransferTest, UploadStreamedMissionComplainsAboutWrongSequence)
+{
+    ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+
+    auto upload =
+        mmt.upload_streamed_items_async(MAV_MISSION_TYPE_MISSION, 2, [&prom](Result result) {
+            EXPECT_EQ(result, Result::InvalidSequence);
+            ONCE_ONLY;
+            prom.set_value();
+        });
+    mmt.do_work();
+
+    EXPECT_EQ(
+        upload.lock()->add_items({make_item(MAV_MISSION_TYPE_MISSION, 1)}),
+        Result::InvalidSequence);
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
+TEST(MAVLinkMissionTransferChangedRanges, FindsAndMergesRanges)
+{
+    using ItemRange = MAVLinkMissionTransfer::ItemRange;
+
+    std::vector<ItemInt> before;
+    for (uint16_t i = 0; i < 20; ++i) {
+        before.push_back(make_item(MAV_MISSION_TYPE_MISSION, i));
+    }
+
+    auto after = before;
+    EXPECT_EQ(
+        MAVLinkMissionTransfer::changed_ranges(before, after), std::vector<ItemRange>{});
+
+    after[3].x = 42;
+    after[5].y = 42;
+    after[15].z = 42.0f;
+    EXPECT_EQ(
+        MAVLinkMissionTransfer::changed_ranges(before, after),
+        (std::vector<ItemRange>{{3, 5}, {15, 15}}));
+    EXPECT_EQ(
+        MAVLinkMissionTransfer::changed_ranges(before, after, 0),
+        (std::vector<ItemRange>{{3, 3}, {5, 5}, {15, 15}}));
+
+    after.pop_back();
+    EXPECT_EQ(MAVLinkMissionTransfer::changed_ranges(before, after), std::nullopt);
+}
+
 TEST_F(MAVLinkMissionTransferTest, DownloadMissionSendsRequestList)
 {
     ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
@@ -1941,3 +2198,130 @@ TEST_F(MAVLinkMissionTransferTest, IntMessagesNotSupported)
     mmt.do_work();
     EXPECT_TRUE(mmt.is_idle());
 }
+
+struct SimulatedUpload {
+    std::optional<Result> result{};
+    std::vector<ItemInt> received_items{};
+    double elapsed_s{0.0};
+    uint64_t messages_sent{0};
+    uint64_t messages_lost{0};
+
+    bool operator==(const SimulatedUpload& other) const
+    {
+        return result == other.result && received_items == other.received_items &&
+               elapsed_s == other.elapsed_s && messages_sent == other.messages_sent &&
+               messages_lost == other.messages_lost;
+    }
+};
+
+// Uploads a mission from one mission transfer to another over a simulated
+// link, all on virtual time.
+static SimulatedUpload
+simulate_upload(const std::vector<ItemInt>& items, const SimulatedLink::Config& config)
+{
+    FakeTime time;
+    VirtualTimeExecutor executor(time);
+    SimulatedLink link(executor, own_address, target_address, config);
+
+    MAVLinkMissionTransfer client(
+        link.a(), link.a().message_handler(), executor.timeout_handler(), []() {
+            return timeout_s;
+        });
+    MAVLinkMissionTransfer server(
+        link.b(), link.b().message_handler(), executor.timeout_handler(), []() {
+            return timeout_s;
+        });
+
+    void* work_cookie = nullptr;
+    executor.call_every_handler().add(
+        [&]() {
+            client.do_work();
+            server.do_work();
+        },
+        0.01,
+        &work_cookie);
+
+    SimulatedUpload upload{};
+
+    // Like a vehicle, the server starts receiving once the count comes in.
+    link.b().message_handler().register_one(
+        MAVLINK_MSG_ID_MISSION_COUNT,
+        [&](const mavlink_message_t& message) {
+            if (!server.is_idle() || !upload.received_items.empty()) {
+                return;
+            }
+            mavlink_mission_count_t mission_count;
+            mavlink_msg_mission_count_decode(&message, &mission_count);
+            server.receive_incoming_items_async(
+                mission_count.mission_type,
+                mission_count.count,
+                message.compid,
+                [&](Result result, const std::vector<ItemInt>& received_items) {
+                    if (result == Result::Success) {
+                        upload.received_items = received_items;
+                    }
+                });
+        },
+        &upload);
+
+    client.upload_items_async(
+        MAV_MISSION_TYPE_MISSION, items, [&](Result result) { upload.result = result; });
+
+    executor.run_until([&]() { return upload.result.has_value(); }, 3600.0);
+
+    upload.elapsed_s = executor.elapsed_s();
+    upload.messages_sent = link.a().messages_sent() + link.b().messages_sent();
+    upload.messages_lost = link.messages_lost();
+
+    link.b().message_handler().unregister_all(&upload);
+    executor.call_every_handler().remove(work_cookie);
+    return upload;
+}
+
+static std::vector<ItemInt> make_items(uint16_t count)
+{
+    std::vector<ItemInt> items;
+    for (uint16_t i = 0; i < count; ++i) {
+        items.push_back(make_item(MAV_MISSION_TYPE_MISSION, i));
+    }
+    return items;
+}
+
+TEST(MAVLinkMissionTransferSimulation, UploadTakesRoundTripsOfVirtualTime)
+{
+    const auto items = make_items(100);
+
+    SimulatedLink::Config config;
+    config.latency_s = 0.2;
+    const auto upload = simulate_upload(items, config);
+
+    ASSERT_TRUE(upload.result.has_value());
+    EXPECT_EQ(upload.result.value(), Result::Success);
+    EXPECT_EQ(upload.received_items, items);
+
+    // Count, a request and an item each, and the ack, all one after the other.
+    const unsigned hops = 1 + 2 * items.size() + 1;
+    EXPECT_EQ(upload.messages_sent, hops);
+    EXPECT_NEAR(upload.elapsed_s, hops * config.latency_s, 0.1);
+}
+
+TEST(MAVLinkMissionTransferSimulation, LossyUploadIsRepeatable)
+{
+    const auto items = make_items(100);
+
+    SimulatedLink::Config config;
+    config.latency_s = 0.05;
+    config.jitter_s = 0.02;
+    config.loss_probability = 0.05;
+    config.seed = 7;
+
+    const auto first = simulate_upload(items, config);
+    const auto second = simulate_upload(items, config);
+
+    ASSERT_TRUE(first.result.has_value());
+    EXPECT_GT(first.messages_lost, 0u);
+    EXPECT_EQ(first, second);
+
+    config.seed = 8;
+    EXPECT_FALSE(simulate_upload(items, config) == first);
+}
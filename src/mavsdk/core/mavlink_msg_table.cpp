@@ -0,0 +1,102 @@
+#include "mavlink_include.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Lookup of the CRC extra, lengths and target offsets of a message ID.
+//
+// The helpers bundled with MAVLink do a binary search over the message table
+// of the dialect for this, on every frame. MAVLink 2 IDs have 24 bits, so a
+// flat table is out of the question, but the IDs are clustered: here the ID
+// is split into a page (the upper bits) and an index into the page (the lower
+// 8 bits). Only pages with messages in them are stored. Both levels are built
+// at compile time from the dialect's table, so a lookup is two array reads.
+
+namespace {
+
+constexpr mavlink_msg_entry_t entries[] = MAVLINK_MESSAGE_CRCS;
+constexpr std::size_t num_entries = sizeof(entries) / sizeof(entries[0]);
+
+constexpr unsigned page_bits = 8;
+constexpr std::size_t page_size = std::size_t(1) << page_bits;
+
+constexpr uint8_t no_page = 0xff;
+constexpr uint16_t no_entry = 0xffff;
+
+static_assert(num_entries < no_entry, "Too many messages for the lookup table");
+
+constexpr uint32_t max_msgid()
+{
+    uint32_t max = 0;
+    for (std::size_t i = 0; i < num_entries; ++i) {
+        max = entries[i].msgid > max ? entries[i].msgid : max;
+    }
+    return max;
+}
+
+constexpr std::size_t num_directory_entries = (max_msgid() >> page_bits) + 1;
+
+constexpr std::size_t count_pages()
+{
+    std::array<bool, num_directory_entries> used{};
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < num_entries; ++i) {
+        auto& page_used = used[entries[i].msgid >> page_bits];
+        if (!page_used) {
+            page_used = true;
+            ++count;
+        }
+    }
+    return count;
+}
+
+constexpr std::size_t num_pages = count_pages();
+
+static_assert(num_pages < no_page, "Too many pages for the lookup table");
+
+struct Table {
+    std::array<uint8_t, num_directory_entries> directory{};
+    std::array<std::array<uint16_t, page_size>, num_pages> pages{};
+};
+
+constexpr Table make_table()
+{
+    Table table{};
+    for (auto& page : table.directory) {
+        page = no_page;
+    }
+    for (auto& page : table.pages) {
+        for (auto& entry : page) {
+            entry = no_entry;
+        }
+    }
+
+    std::size_t next_page = 0;
+    for (std::size_t i = 0; i < num_entries; ++i) {
+        auto& page = table.directory[entries[i].msgid >> page_bits];
+        if (page == no_page) {
+            page = static_cast<uint8_t>(next_page++);
+        }
+        table.pages[page][entries[i].msgid & (page_size - 1)] = static_cast<uint16_t>(i);
+    }
+    return table;
+}
+
+constexpr Table table = make_table();
+
+} // namespace
+
+const mavlink_msg_entry_t* mavlink_get_msg_entry(uint32_t msgid)
+{
+    const uint32_t directory_index = msgid >> page_bits;
+    if (directory_index >= num_directory_entries) {
+        return nullptr;
+    }
+    const uint8_t page = table.directory[directory_index];
+    if (page == no_page) {
+        return nullptr;
+    }
+    const uint16_t entry = table.pages[page][msgid & (page_size - 1)];
+    return entry == no_entry ? nullptr : &entries[entry];
+}
@@ -0,0 +1,56 @@
+#include "mavlink_include.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+const mavlink_msg_entry_t* find_by_search(uint32_t msgid)
+{
+    static const mavlink_msg_entry_t entries[] = MAVLINK_MESSAGE_CRCS;
+    for (const auto& entry : entries) {
+        if (entry.msgid == msgid) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST(MavlinkMsgTable, FindsEveryMessageOfTheDialect)
+{
+    static const mavlink_msg_entry_t entries[] = MAVLINK_MESSAGE_CRCS;
+    for (const auto& expected : entries) {
+        const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(expected.msgid);
+        ASSERT_NE(entry, nullptr) << expected.msgid;
+        EXPECT_EQ(entry->msgid, expected.msgid);
+        EXPECT_EQ(entry->crc_extra, expected.crc_extra);
+        EXPECT_EQ(entry->min_msg_len, expected.min_msg_len);
+        EXPECT_EQ(entry->max_msg_len, expected.max_msg_len);
+        EXPECT_EQ(entry->flags, expected.flags);
+        EXPECT_EQ(entry->target_system_ofs, expected.target_system_ofs);
+        EXPECT_EQ(entry->target_component_ofs, expected.target_component_ofs);
+    }
+}
+
+TEST(MavlinkMsgTable, AgreesWithSearchForAllIds)
+{
+    // All of the first pages, and samples of the rest of the 24 bit range.
+    for (uint32_t msgid = 0; msgid < 0x10000; ++msgid) {
+        ASSERT_EQ(mavlink_get_msg_entry(msgid) != nullptr, find_by_search(msgid) != nullptr)
+            << msgid;
+    }
+    for (uint32_t msgid = 0x10000; msgid <= 0xffffff; msgid += 251) {
+        ASSERT_EQ(mavlink_get_msg_entry(msgid) != nullptr, find_by_search(msgid) != nullptr)
+            << msgid;
+    }
+    EXPECT_EQ(mavlink_get_msg_entry(0xffffff) != nullptr, find_by_search(0xffffff) != nullptr);
+}
+
+TEST(MavlinkMsgTable, KnowsCommonMessages)
+{
+    const mavlink_msg_entry_t* heartbeat = mavlink_get_msg_entry(MAVLINK_MSG_ID_HEARTBEAT);
+    ASSERT_NE(heartbeat, nullptr);
+    EXPECT_EQ(heartbeat->crc_extra, MAVLINK_MSG_ID_HEARTBEAT_CRC);
+    EXPECT_EQ(heartbeat->min_msg_len, MAVLINK_MSG_ID_HEARTBEAT_MIN_LEN);
+}
@@ -1,5 +1,9 @@
 #include "mavlink_parameters.h"
 #include "system_impl.h"
+#include "fs.h"
+#include "param_cache.h"
+#include "rtt_estimator.h"
+#include <algorithm>
 #include <cstring>
 #include <future>
 
@@ -52,11 +56,18 @@ MAVLinkParameters::MAVLinkParameters(SystemImpl& parent) : _parent(parent)
 MAVLinkParameters::~MAVLinkParameters()
 {
     _parent.unregister_all_mavlink_message_handlers(this);
+
+    std::lock_guard<std::mutex> lock(_server_list_mutex);
+    if (_server_list_cookie != nullptr) {
+        _parent.remove_call_every(_server_list_cookie);
+    }
 }
 
 void MAVLinkParameters::provide_server_param(const std::string& name, const ParamValue& value)
 {
-    _param_server_store.insert_or_assign(name, value);
+    if (!_param_server_store.set(name, value)) {
+        LogErr() << "Error: param name too long";
+    }
 }
 
 void MAVLinkParameters::set_param_async(
@@ -80,7 +91,7 @@ void MAVLinkParameters::set_param_async(
         return;
     }
 
-    auto new_work = std::make_shared<WorkItem>(_parent.timeout_s());
+    auto new_work = make_pooled<WorkItem>(_work_pool, _parent.timeout_s());
     new_work->type = WorkItem::Type::Set;
     new_work->set_param_callback = callback;
     new_work->param_name = name;
@@ -89,6 +100,7 @@ void MAVLinkParameters::set_param_async(
     new_work->cookie = cookie;
 
     _work_queue.push_back(new_work);
+    _parent.schedule_work();
 }
 
 MAVLinkParameters::Result
@@ -103,6 +115,181 @@ MAVLinkParameters::set_param(const std::string& name, const ParamValue& value, b
     return res.get();
 }
 
+void MAVLinkParameters::set_params_async(
+    const ParamStore& params, const set_param_callback_t& callback)
+{
+    set_params_async(params, [callback](Result result, const std::vector<Result>& /* results */) {
+        if (callback) {
+            callback(result);
+        }
+    });
+}
+
+void MAVLinkParameters::set_params_async(
+    const ParamStore& params, const set_params_callback_t& callback)
+{
+    auto batch = std::make_shared<SetParamsBatch>();
+    batch->callback = callback;
+    batch->results.resize(params.size(), Result::Success);
+    std::size_t index = 0;
+    for (const auto& entry : params) {
+        batch->pending.push_back(SetParamsBatch::Item{entry.name.str(), entry.value, index++});
+    }
+
+    std::unique_lock<std::mutex> lock(_set_params_mutex);
+    _set_params_batches.push_back(batch);
+    fill_set_params_window(*batch);
+    _parent.register_timeout_handler(
+        [this, batch] { set_params_timeout(batch); }, _parent.timeout_s(), &batch->timeout_cookie);
+    finish_set_params_if_done(lock, batch);
+}
+
+MAVLinkParameters::Result MAVLinkParameters::set_params(const ParamStore& params)
+{
+    auto prom = std::promise<Result>();
+    auto res = prom.get_future();
+
+    set_params_async(params, [&prom](Result result) { prom.set_value(result); });
+
+    return res.get();
+}
+
+void MAVLinkParameters::fail_set_params_item(
+    SetParamsBatch& batch, const SetParamsBatch::Item& item, Result result)
+{
+    batch.results[item.index] = result;
+    if (batch.result == Result::Success) {
+        batch.result = result;
+    }
+}
+
+bool MAVLinkParameters::send_param_set(const SetParamsBatch::Item& item)
+{
+    char param_id[PARAM_ID_LEN + 1] = {};
+    strncpy(param_id, item.name.c_str(), sizeof(param_id) - 1);
+
+    mavlink_message_t msg;
+    mavlink_msg_param_set_pack(
+        _parent.get_own_system_id(),
+        _parent.get_own_component_id(),
+        &msg,
+        _parent.get_system_id(),
+        _parent.get_autopilot_id(),
+        param_id,
+        item.value.get_4_float_bytes(),
+        item.value.get_mav_param_type());
+
+    return _parent.send_message(msg);
+}
+
+void MAVLinkParameters::fill_set_params_window(SetParamsBatch& batch)
+{
+    while (batch.in_flight.size() < SET_PARAMS_WINDOW && !batch.pending.empty()) {
+        auto item = std::move(batch.pending.front());
+        batch.pending.pop_front();
+
+        if (!send_param_set(item)) {
+            LogErr() << "Error: Send message failed (" << item.name << ")";
+            fail_set_params_item(batch, item, Result::ConnectionError);
+            continue;
+        }
+        batch.in_flight.push_back(std::move(item));
+    }
+}
+
+void MAVLinkParameters::set_params_timeout(const std::shared_ptr<SetParamsBatch>& batch)
+{
+    std::unique_lock<std::mutex> lock(_set_params_mutex);
+
+    if (std::find(_set_params_batches.begin(), _set_params_batches.end(), batch) ==
+        _set_params_batches.end()) {
+        return;
+    }
+
+    // Send again whatever has not been acknowledged, every param on its own
+    // until it runs out of retries.
+    auto it = batch->in_flight.begin();
+    while (it != batch->in_flight.end()) {
+        if (it->retries_left <= 0) {
+            LogErr() << "Error: Retrying failed set param timeout: " << it->name;
+            fail_set_params_item(*batch, *it, Result::Timeout);
+            it = batch->in_flight.erase(it);
+            continue;
+        }
+
+        --it->retries_left;
+        if (!send_param_set(*it)) {
+            LogErr() << "connection send error in retransmit (" << it->name << ").";
+            fail_set_params_item(*batch, *it, Result::ConnectionError);
+            it = batch->in_flight.erase(it);
+            continue;
+        }
+        ++it;
+    }
+
+    fill_set_params_window(*batch);
+    _parent.register_timeout_handler(
+        [this, batch] { set_params_timeout(batch); }, _parent.timeout_s(), &batch->timeout_cookie);
+    finish_set_params_if_done(lock, batch);
+}
+
+bool MAVLinkParameters::process_set_params_ack(const mavlink_param_value_t& param_value)
+{
+    std::unique_lock<std::mutex> lock(_set_params_mutex);
+
+    if (_set_params_batches.empty()) {
+        return false;
+    }
+
+    const auto name = extract_safe_param_id(param_value.param_id);
+
+    for (auto& batch : _set_params_batches) {
+        const auto it = std::find_if(
+            batch->in_flight.begin(), batch->in_flight.end(), [&name](const auto& item) {
+                return item.name == name;
+            });
+        if (it == batch->in_flight.end()) {
+            continue;
+        }
+
+        ParamValue value;
+        value.set_from_mavlink_param_value(param_value);
+        if (!value.is_same_type(it->value)) {
+            LogErr() << "Param types don't match for " << name;
+            fail_set_params_item(*batch, *it, Result::WrongType);
+        }
+        batch->in_flight.erase(it);
+
+        // Keep the batch going, its timeout only fires if nothing comes back.
+        fill_set_params_window(*batch);
+        _parent.refresh_timeout_handler(batch->timeout_cookie);
+
+        const auto batch_copy = batch;
+        finish_set_params_if_done(lock, batch_copy);
+        return true;
+    }
+
+    return false;
+}
+
+void MAVLinkParameters::finish_set_params_if_done(
+    std::unique_lock<std::mutex>& lock, const std::shared_ptr<SetParamsBatch>& batch)
+{
+    if (!batch->in_flight.empty() || !batch->pending.empty()) {
+        return;
+    }
+
+    _parent.unregister_timeout_handler(batch->timeout_cookie);
+    _set_params_batches.erase(
+        std::remove(_set_params_batches.begin(), _set_params_batches.end(), batch),
+        _set_params_batches.end());
+    lock.unlock();
+
+    if (batch->callback) {
+        batch->callback(batch->result, batch->results);
+    }
+}
+
 void MAVLinkParameters::get_param_async(
     const std::string& name,
     ParamValue value_type,
@@ -122,7 +309,7 @@ void MAVLinkParameters::get_param_async(
     }
 
     // Otherwise, push work onto queue.
-    auto new_work = std::make_shared<WorkItem>(_parent.timeout_s());
+    auto new_work = make_pooled<WorkItem>(_work_pool, _parent.timeout_s());
     new_work->type = WorkItem::Type::Get;
     new_work->get_param_callback = callback;
     new_work->param_name = name;
@@ -131,20 +318,38 @@ void MAVLinkParameters::get_param_async(
     new_work->cookie = cookie;
 
     _work_queue.push_back(new_work);
+    _parent.schedule_work();
 }
 
-std::map<std::string, MAVLinkParameters::ParamValue> MAVLinkParameters::retrieve_all_server_params()
+const MAVLinkParameters::ParamStore& MAVLinkParameters::retrieve_all_server_params() const
 {
     return _param_server_store;
 }
 
+std::size_t MAVLinkParameters::allocated_bytes()
+{
+    std::size_t bytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(_server_list_mutex);
+        bytes += _param_server_store.allocated_bytes();
+    }
+    {
+        std::lock_guard<std::mutex> lock(_all_param_mutex);
+        if (_all_param_store) {
+            bytes += sizeof(AllParameters) + _all_param_store->all_params.allocated_bytes() +
+                     _all_param_store->received.capacity() / 8 +
+                     _all_param_store->requested.capacity() * sizeof(uint16_t);
+        }
+    }
+    return bytes;
+}
+
 std::pair<MAVLinkParameters::Result, MAVLinkParameters::ParamValue>
 MAVLinkParameters::retrieve_server_param(const std::string& name, ParamValue value_type)
 {
-    if (_param_server_store.find(name) != _param_server_store.end()) {
-        auto value = _param_server_store.at(name);
-        if (value.is_same_type(value_type))
-            return {MAVLinkParameters::Result::Success, value};
+    if (const auto* value = _param_server_store.find(name)) {
+        if (value->is_same_type(value_type))
+            return {MAVLinkParameters::Result::Success, *value};
         else
             return {MAVLinkParameters::Result::WrongType, {}};
     }
@@ -169,14 +374,41 @@ MAVLinkParameters::get_param(const std::string& name, ParamValue value_type, boo
     return res.get();
 }
 
-void MAVLinkParameters::get_all_params_async(const get_all_params_callback_t& callback)
+void MAVLinkParameters::get_all_params_async(
+    const get_all_params_callback_t& callback,
+    const get_all_params_progress_callback_t& progress_callback)
 {
-    _all_param_store = std::make_shared<AllParameters>();
+    std::unique_lock<std::mutex> lock(_all_param_mutex);
 
+    if (_all_param_store) {
+        _parent.unregister_timeout_handler(_all_param_store->timeout_cookie);
+    }
+    _all_param_store = std::make_shared<AllParameters>();
     _all_param_store->callback = callback;
+    _all_param_store->progress_callback = progress_callback;
+    _all_param_store->checking_hash = !param_cache_path().empty();
+    _all_params_to_cache = nullptr;
 
-    mavlink_message_t msg;
+    const bool sent = _all_param_store->checking_hash ?
+                          send_param_read_request(HASH_CHECK_PARAM_ID, -1) :
+                          send_param_list_request();
 
+    if (!sent) {
+        _all_param_store = nullptr;
+        lock.unlock();
+        if (callback) {
+            callback(ParamStore{});
+        }
+        return;
+    }
+
+    _parent.register_timeout_handler(
+        [this] { all_params_timeout(); }, _parent.timeout_s(), &_all_param_store->timeout_cookie);
+}
+
+bool MAVLinkParameters::send_param_list_request()
+{
+    mavlink_message_t msg;
     mavlink_msg_param_request_list_pack(
         _parent.get_own_system_id(),
         _parent.get_own_component_id(),
@@ -186,23 +418,173 @@ void MAVLinkParameters::get_all_params_async(const get_all_params_callback_t& ca
 
     if (!_parent.send_message(msg)) {
         LogErr() << "Failed to send param list request!";
-        callback(std::map<std::string, ParamValue>{});
-        _all_param_store = nullptr;
+        return false;
     }
+    return true;
+}
 
-    _parent.register_timeout_handler(
-        [this] { receive_timeout(); }, _parent.timeout_s(), &_all_param_store->timeout_cookie);
+bool MAVLinkParameters::send_param_read_request(const char* name, int16_t index)
+{
+    mavlink_message_t msg;
+    mavlink_msg_param_request_read_pack(
+        _parent.get_own_system_id(),
+        _parent.get_own_component_id(),
+        &msg,
+        _parent.get_system_id(),
+        _parent.get_autopilot_id(),
+        name,
+        index);
+
+    if (!_parent.send_message(msg)) {
+        LogErr() << "Failed to send param read request!";
+        return false;
+    }
+    return true;
 }
 
-std::map<std::string, MAVLinkParameters::ParamValue> MAVLinkParameters::get_all_params()
+void MAVLinkParameters::request_missing_params(AllParameters& all_params)
 {
-    std::promise<std::map<std::string, ParamValue>> prom;
+    while (all_params.requested.size() < GAP_FILL_WINDOW &&
+           all_params.next_missing < all_params.received.size()) {
+        const auto index = all_params.next_missing++;
+        if (all_params.received[index]) {
+            continue;
+        }
+
+        if (!send_param_read_request("", static_cast<int16_t>(index))) {
+            // The timeout will try again.
+            --all_params.next_missing;
+            return;
+        }
+        all_params.requested.push_back(static_cast<uint16_t>(index));
+    }
+}
+
+void MAVLinkParameters::all_params_timeout()
+{
+    std::unique_lock<std::mutex> lock(_all_param_mutex);
+
+    auto all_params = _all_param_store;
+    if (!all_params) {
+        return;
+    }
+
+    if (all_params->checking_hash) {
+        // Most likely the autopilot doesn't support the hash.
+        LogDebug() << "No param hash received, downloading all params";
+        all_params->checking_hash = false;
+        if (send_param_list_request()) {
+            _parent.register_timeout_handler(
+                [this] { all_params_timeout(); },
+                _parent.timeout_s(),
+                &all_params->timeout_cookie);
+            return;
+        }
+
+    } else if (!all_params->received.empty() && --all_params->retries_left > 0) {
+        if (all_params->gap_filling) {
+            LogWarn() << "Requesting " << all_params->requested.size() << " params again";
+        } else {
+            LogDebug() << "Param list stalled, requesting "
+                       << all_params->received.size() - all_params->num_received
+                       << " missing params by index";
+            all_params->gap_filling = true;
+        }
+
+        // Whatever was requested and didn't arrive is requested again.
+        all_params->requested.clear();
+        all_params->next_missing = 0;
+        request_missing_params(*all_params);
+
+        _parent.register_timeout_handler(
+            [this] { all_params_timeout(); }, _parent.timeout_s(), &all_params->timeout_cookie);
+        return;
+    }
+
+    // Nothing has come in at all, or we have run out of patience.
+    _all_param_store = nullptr; // stop waiting, failed!
+    lock.unlock();
+    if (all_params->callback) {
+        all_params->callback(ParamStore{});
+    }
+}
+
+bool MAVLinkParameters::process_hash_check(std::unique_lock<std::mutex>& lock, uint32_t hash)
+{
+    auto all_params = _all_param_store;
+
+    if (all_params && all_params->checking_hash) {
+        _parent.unregister_timeout_handler(all_params->timeout_cookie);
+        all_params->checking_hash = false;
+
+        auto cache = param_cache_load(param_cache_path());
+        if (cache && cache->hash == hash) {
+            LogDebug() << "Param hash unchanged, using " << cache->params.size()
+                       << " cached params";
+            _all_param_store = nullptr;
+            lock.unlock();
+            if (all_params->progress_callback) {
+                all_params->progress_callback(1.0f);
+            }
+            notify_params_subscriptions(cache->params);
+            if (all_params->callback) {
+                all_params->callback(cache->params);
+            }
+            return true;
+        }
+
+        LogDebug() << "Param hash changed, downloading all params";
+        all_params->hash = hash;
+        // If this fails, the timeout gives up.
+        send_param_list_request();
+        _parent.register_timeout_handler(
+            [this] { all_params_timeout(); }, _parent.timeout_s(), &all_params->timeout_cookie);
+        return true;
+    }
+
+    if (all_params) {
+        // PX4 sends the hash after the list as well, so we get the most recent one.
+        all_params->hash = hash;
+        return true;
+    }
+
+    if (_all_params_to_cache) {
+        save_param_cache(*_all_params_to_cache, hash);
+        _all_params_to_cache = nullptr;
+        return true;
+    }
+
+    return false;
+}
+
+std::string MAVLinkParameters::param_cache_path() const
+{
+    const auto directory = _parent.get_param_cache_directory();
+    const auto uid = _parent.get_uid_string();
+    if (directory.empty() || uid.empty()) {
+        return {};
+    }
+    return directory + path_separator + uid + ".params";
+}
+
+void MAVLinkParameters::save_param_cache(const AllParameters& all_params, uint32_t hash)
+{
+    const auto path = param_cache_path();
+    if (path.empty()) {
+        return;
+    }
+
+    if (param_cache_save(path, ParamCache{hash, all_params.all_params})) {
+        LogDebug() << "Saved " << all_params.all_params.size() << " params to " << path;
+    }
+}
+
+MAVLinkParameters::ParamStore MAVLinkParameters::get_all_params()
+{
+    std::promise<ParamStore> prom;
     auto res = prom.get_future();
 
-    get_all_params_async(
-        [&prom](const std::map<std::string, MAVLinkParameters::ParamValue>& all_params) {
-            prom.set_value(all_params);
-        });
+    get_all_params_async([&prom](const ParamStore& all_params) { prom.set_value(all_params); });
 
     return res.get();
 }
@@ -225,26 +607,14 @@ void MAVLinkParameters::subscribe_param_changed(
     const MAVLinkParameters::ParamChangedCallback& callback,
     const void* cookie)
 {
-    std::lock_guard<std::mutex> lock(_param_changed_subscriptions_mutex);
-
     if (callback != nullptr) {
         ParamChangedSubscription subscription{};
-        subscription.param_name = name;
         subscription.callback = callback;
         subscription.cookie = cookie;
         subscription.any_type = true;
-        _param_changed_subscriptions.push_back(subscription);
-
+        add_param_changed_subscription(name, std::move(subscription));
     } else {
-        for (auto it = _param_changed_subscriptions.begin();
-             it != _param_changed_subscriptions.end();
-             /* ++it */) {
-            if (it->param_name == name && it->cookie == cookie) {
-                it = _param_changed_subscriptions.erase(it);
-            } else {
-                ++it;
-            }
-        }
+        remove_param_changed_subscription(name, cookie);
     }
 }
 
@@ -254,26 +624,70 @@ void MAVLinkParameters::subscribe_param_changed(
     const MAVLinkParameters::ParamChangedCallback& callback,
     const void* cookie)
 {
-    std::lock_guard<std::mutex> lock(_param_changed_subscriptions_mutex);
-
     if (callback != nullptr) {
         ParamChangedSubscription subscription{};
-        subscription.param_name = name;
         subscription.callback = callback;
         subscription.cookie = cookie;
         subscription.value_type = value_type;
-        _param_changed_subscriptions.push_back(subscription);
-
+        add_param_changed_subscription(name, std::move(subscription));
     } else {
-        for (auto it = _param_changed_subscriptions.begin();
-             it != _param_changed_subscriptions.end();
-             /* ++it */) {
-            if (it->param_name == name && it->cookie == cookie) {
-                it = _param_changed_subscriptions.erase(it);
-            } else {
-                ++it;
-            }
-        }
+        remove_param_changed_subscription(name, cookie);
+    }
+}
+
+void MAVLinkParameters::add_param_changed_subscription(
+    const std::string& name, ParamChangedSubscription subscription)
+{
+    const auto param_name = ParamName::from(name);
+    if (!param_name) {
+        LogErr() << "Param name too long to subscribe: " << name;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_param_changed_subscriptions_mutex);
+    _param_changed_subscriptions[*param_name].push_back(std::move(subscription));
+}
+
+void MAVLinkParameters::remove_param_changed_subscription(
+    const std::string& name, const void* cookie)
+{
+    const auto param_name = ParamName::from(name);
+    if (!param_name) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_param_changed_subscriptions_mutex);
+    auto it = _param_changed_subscriptions.find(*param_name);
+    if (it == _param_changed_subscriptions.end()) {
+        return;
+    }
+
+    auto& subscriptions = it->second;
+    subscriptions.erase(
+        std::remove_if(
+            subscriptions.begin(),
+            subscriptions.end(),
+            [cookie](const auto& subscription) { return subscription.cookie == cookie; }),
+        subscriptions.end());
+    if (subscriptions.empty()) {
+        _param_changed_subscriptions.erase(it);
+    }
+}
+
+void MAVLinkParameters::subscribe_params_changed(
+    const ParamsChangedCallback& callback, const void* cookie)
+{
+    std::lock_guard<std::mutex> lock(_param_changed_subscriptions_mutex);
+
+    _params_changed_subscriptions.erase(
+        std::remove_if(
+            _params_changed_subscriptions.begin(),
+            _params_changed_subscriptions.end(),
+            [cookie](const auto& subscription) { return subscription.cookie == cookie; }),
+        _params_changed_subscriptions.end());
+
+    if (callback != nullptr) {
+        _params_changed_subscriptions.push_back(ParamsChangedSubscription{callback, cookie});
     }
 }
 
@@ -328,11 +742,12 @@ void MAVLinkParameters::do_work()
                     work->set_param_callback(MAVLinkParameters::Result::ConnectionError);
                 }
                 work_queue_guard.pop_front();
+                _parent.schedule_work();
                 return;
             }
 
             work->already_requested = true;
-            // _last_request_time = _parent.get_time().steady_time();
+            work->time_started = _parent.get_time().steady_time();
 
             // We want to get notified if a timeout happens
             _parent.register_timeout_handler(
@@ -378,12 +793,12 @@ void MAVLinkParameters::do_work()
                         MAVLinkParameters::Result::ConnectionError, empty_param);
                 }
                 work_queue_guard.pop_front();
+                _parent.schedule_work();
                 return;
             }
 
             work->already_requested = true;
-
-            // _last_request_time = _parent.get_time().steady_time();
+            work->time_started = _parent.get_time().steady_time();
 
             // We want to get notified if a timeout happens
             _parent.register_timeout_handler(
@@ -419,11 +834,13 @@ void MAVLinkParameters::do_work()
             if (!_parent.send_message(work->mavlink_message)) {
                 LogErr() << "Error: Send message failed";
                 work_queue_guard.pop_front();
+                _parent.schedule_work();
                 return;
             }
 
             // As we're a server in this case we don't need any response
             work_queue_guard.pop_front();
+            _parent.schedule_work();
         } break;
 
         case WorkItem::Type::Ack: {
@@ -443,11 +860,13 @@ void MAVLinkParameters::do_work()
             if (!work->extended || !_parent.send_message(work->mavlink_message)) {
                 LogErr() << "Error: Send message failed";
                 work_queue_guard.pop_front();
+                _parent.schedule_work();
                 return;
             }
 
             // As we're a server in this case we don't need any response
             work_queue_guard.pop_front();
+            _parent.schedule_work();
         } break;
     }
 }
@@ -459,31 +878,102 @@ void MAVLinkParameters::process_param_value(const mavlink_message_t& message)
 
     // LogDebug() << "getting param value: " << extract_safe_param_id(param_value.param_id);
 
+    std::unique_lock<std::mutex> all_param_lock(_all_param_mutex);
+
+    if (param_value.param_type == MAV_PARAM_TYPE_UINT32 &&
+        extract_safe_param_id(param_value.param_id) == HASH_CHECK_PARAM_ID) {
+        const float raw_value = param_value.param_value;
+        uint32_t hash;
+        std::memcpy(&hash, &raw_value, sizeof(hash));
+        if (process_hash_check(all_param_lock, hash)) {
+            return;
+        }
+    }
+
     // check if we are looking for param list
-    if (_all_param_store) {
+    if (auto all_params = _all_param_store; all_params && !all_params->checking_hash) {
+        if (all_params->received.empty()) {
+            all_params->received.resize(param_value.param_count, false);
+            all_params->all_params.reserve(param_value.param_count);
+        }
+
+        const uint16_t index = param_value.param_index;
+        if (index >= all_params->received.size() || all_params->received[index]) {
+            // Out of range or a duplicate, e.g. a late answer to a request by index.
+            return;
+        }
+
         ParamValue value;
         value.set_from_mavlink_param_value(param_value);
+        all_params->all_params.set(extract_safe_param_id(param_value.param_id), value);
+        all_params->received[index] = true;
+        ++all_params->num_received;
+        all_params->retries_left = ALL_PARAMS_RETRIES;
+
+        const auto requested_it =
+            std::find(all_params->requested.begin(), all_params->requested.end(), index);
+        if (requested_it != all_params->requested.end()) {
+            all_params->requested.erase(requested_it);
+        }
 
-        std::string param_id = extract_safe_param_id(param_value.param_id);
+        const bool done = all_params->num_received == all_params->received.size();
+        const float progress = static_cast<float>(all_params->num_received) /
+                               static_cast<float>(all_params->received.size());
 
-        _all_param_store->all_params.insert(std::pair<std::string, ParamValue>(param_id, value));
+        _parent.unregister_timeout_handler(all_params->timeout_cookie);
 
-        if (param_value.param_index + 1 == param_value.param_count) {
-            _all_param_store->callback(_all_param_store->all_params);
+        if (done) {
             _all_param_store = nullptr;
+
+            if (!param_cache_path().empty()) {
+                if (all_params->hash) {
+                    save_param_cache(*all_params, *all_params->hash);
+                } else {
+                    // The cache is only any good with the hash.
+                    _all_params_to_cache = all_params;
+                    send_param_read_request(HASH_CHECK_PARAM_ID, -1);
+                }
+            }
         } else {
-            _parent.unregister_timeout_handler(_all_param_store->timeout_cookie);
+            // Once the end of the list has gone past, there is no point in
+            // waiting for the rest, it got lost.
+            if (index + 1 == param_value.param_count) {
+                all_params->gap_filling = true;
+            }
+            if (all_params->gap_filling) {
+                request_missing_params(*all_params);
+            }
 
             _parent.register_timeout_handler(
-                [this] { receive_timeout(); },
+                [this] { all_params_timeout(); },
                 _parent.timeout_s(),
-                &_all_param_store->timeout_cookie);
+                &all_params->timeout_cookie);
         }
+        all_param_lock.unlock();
 
+        if (all_params->progress_callback) {
+            all_params->progress_callback(progress);
+        }
+        if (done) {
+            notify_params_subscriptions(all_params->all_params);
+            if (all_params->callback) {
+                all_params->callback(all_params->all_params);
+            }
+        }
         return;
     }
+    all_param_lock.unlock();
 
-    notify_param_subscriptions(param_value);
+    if (const auto name = ParamName::from(
+            std::string_view(param_value.param_id, strnlen(param_value.param_id, PARAM_ID_LEN)))) {
+        ParamValue value;
+        value.set_from_mavlink_param_value(param_value);
+        notify_param_subscriptions(*name, value);
+    }
+
+    if (process_set_params_ack(param_value)) {
+        return;
+    }
 
     LockedQueue<WorkItem>::Guard work_queue_guard(_work_queue);
     auto work = work_queue_guard.get_front();
@@ -517,9 +1007,9 @@ void MAVLinkParameters::process_param_value(const mavlink_message_t& message)
                 }
             }
             _parent.unregister_timeout_handler(_timeout_cookie);
-            // LogDebug() << "time taken: " <<
-            // _parent.get_time().elapsed_since_s(_last_request_time);
+            add_rtt_sample(*work);
             work_queue_guard.pop_front();
+            _parent.schedule_work();
         } break;
         case WorkItem::Type::Set: {
             // We are done, inform caller and go back to idle
@@ -528,28 +1018,27 @@ void MAVLinkParameters::process_param_value(const mavlink_message_t& message)
             }
 
             _parent.unregister_timeout_handler(_timeout_cookie);
-            // LogDebug() << "time taken: " <<
-            // _parent.get_time().elapsed_since_s(_last_request_time);
+            add_rtt_sample(*work);
             work_queue_guard.pop_front();
+            _parent.schedule_work();
         } break;
         default:
             break;
     }
 }
 
-void MAVLinkParameters::notify_param_subscriptions(const mavlink_param_value_t& param_value)
+void MAVLinkParameters::notify_param_subscriptions(const ParamName& name, const ParamValue& value)
 {
     std::lock_guard<std::mutex> lock(_param_changed_subscriptions_mutex);
 
-    for (const auto& subscription : _param_changed_subscriptions) {
-        if (subscription.param_name != extract_safe_param_id(param_value.param_id)) {
-            continue;
-        }
+    const auto it = _param_changed_subscriptions.find(name);
+    if (it == _param_changed_subscriptions.end()) {
+        return;
+    }
 
-        ParamValue value;
-        value.set_from_mavlink_param_value(param_value);
+    for (const auto& subscription : it->second) {
         if (!subscription.any_type && !subscription.value_type.is_same_type(value)) {
-            LogErr() << "Received wrong param type in subscription for " << subscription.param_name;
+            LogErr() << "Received wrong param type in subscription for " << name.view();
             continue;
         }
 
@@ -557,6 +1046,29 @@ void MAVLinkParameters::notify_param_subscriptions(const mavlink_param_value_t&
     }
 }
 
+void MAVLinkParameters::notify_params_subscriptions(const ParamStore& params)
+{
+    std::lock_guard<std::mutex> lock(_param_changed_subscriptions_mutex);
+
+    for (const auto& subscription : _params_changed_subscriptions) {
+        subscription.callback(params);
+    }
+
+    // Only the params someone is interested in are looked up, rather than
+    // going through all of them.
+    for (const auto& [name, subscriptions] : _param_changed_subscriptions) {
+        const auto* value = params.find(name.view());
+        if (value == nullptr) {
+            continue;
+        }
+        for (const auto& subscription : subscriptions) {
+            if (subscription.any_type || subscription.value_type.is_same_type(*value)) {
+                subscription.callback(*value);
+            }
+        }
+    }
+}
+
 void MAVLinkParameters::process_param_ext_value(const mavlink_message_t& message)
 {
     // LogDebug() << "getting param ext value";
@@ -600,6 +1112,7 @@ void MAVLinkParameters::process_param_ext_value(const mavlink_message_t& message
             // LogDebug() << "time taken: " <<
             // _parent.get_time().elapsed_since_s(_last_request_time);
             work_queue_guard.pop_front();
+            _parent.schedule_work();
         } break;
 
         case WorkItem::Type::Set:
@@ -649,6 +1162,7 @@ void MAVLinkParameters::process_param_ext_ack(const mavlink_message_t& message)
                 // LogDebug() << "time taken: " <<
                 // _parent.get_time().elapsed_since_s(_last_request_time);
                 work_queue_guard.pop_front();
+                _parent.schedule_work();
 
             } else if (param_ext_ack.param_result == PARAM_ACK_IN_PROGRESS) {
                 // Reset timeout and wait again.
@@ -676,6 +1190,7 @@ void MAVLinkParameters::process_param_ext_ack(const mavlink_message_t& message)
                 // LogDebug() << "time taken: " <<
                 // _parent.get_time().elapsed_since_s(_last_request_time);
                 work_queue_guard.pop_front();
+                _parent.schedule_work();
             }
         } break;
         default:
@@ -692,33 +1207,22 @@ void MAVLinkParameters::process_param_ext_set(const mavlink_message_t& message)
     if (!safe_param_id.empty()) {
         LogDebug() << "Set Param Request: " << safe_param_id;
         // Use the ID
-        if (_param_server_store.find(safe_param_id) != _param_server_store.end()) {
+        if (auto* stored_value = _param_server_store.find(safe_param_id)) {
             ParamValue value{};
             if (!value.set_from_mavlink_param_ext_set(set_request)) {
                 LogWarn() << "Invalid Param Ext Set Request: " << safe_param_id;
                 return;
             }
-            _param_server_store.at(safe_param_id) = value;
-            auto new_work = std::make_shared<WorkItem>(_parent.timeout_s());
+            *stored_value = value;
+            auto new_work = make_pooled<WorkItem>(_work_pool, _parent.timeout_s());
             new_work->type = WorkItem::Type::Ack;
             new_work->param_name = safe_param_id;
-            new_work->param_value = _param_server_store.at(safe_param_id);
+            new_work->param_value = value;
             new_work->extended = true;
             _work_queue.push_back(new_work);
-            std::lock_guard<std::mutex> lock(_param_changed_subscriptions_mutex);
-
-            for (const auto& subscription : _param_changed_subscriptions) {
-                if (subscription.param_name != safe_param_id) {
-                    continue;
-                }
-
-                if (!subscription.any_type && !subscription.value_type.is_same_type(value)) {
-                    LogErr() << "Received wrong param type in subscription for "
-                             << subscription.param_name;
-                    continue;
-                }
-
-                subscription.callback(value);
+            _parent.schedule_work();
+            if (const auto name = ParamName::from(safe_param_id)) {
+                notify_param_subscriptions(*name, value);
             }
         } else {
             LogDebug() << "Missing Param: " << safe_param_id;
@@ -729,13 +1233,6 @@ void MAVLinkParameters::process_param_ext_set(const mavlink_message_t& message)
 }
 void MAVLinkParameters::receive_timeout()
 {
-    // first check if we are waiting for param list response
-    if (_all_param_store) {
-        std::lock_guard<std::mutex> lock(_all_param_mutex);
-        _all_param_store->callback(std::map<std::string, ParamValue>{});
-        _all_param_store = nullptr; // stop waiting, failed!
-        return;
-    }
     LockedQueue<WorkItem>::Guard work_queue_guard(_work_queue);
     auto work = work_queue_guard.get_front();
 
@@ -758,18 +1255,23 @@ void MAVLinkParameters::receive_timeout()
                 if (!_parent.send_message(work->mavlink_message)) {
                     LogErr() << "connection send error in retransmit (" << work->param_name << ").";
                     work_queue_guard.pop_front();
+                    _parent.schedule_work();
                     work->get_param_callback(
                         MAVLinkParameters::Result::ConnectionError, empty_value);
                 } else {
                     --work->retries_to_do;
+                    ++work->retries_done;
                     _parent.register_timeout_handler(
-                        [this] { receive_timeout(); }, work->timeout_s, &_timeout_cookie);
+                        [this] { receive_timeout(); },
+                        RttEstimator::backoff_s(work->timeout_s, work->retries_done),
+                        &_timeout_cookie);
                 }
             } else {
                 // We have tried retransmitting, giving up now.
                 LogErr() << "Error: Retrying failed get param busy timeout: " << work->param_name;
 
                 work_queue_guard.pop_front();
+                _parent.schedule_work();
 
                 work->get_param_callback(MAVLinkParameters::Result::Timeout, empty_value);
             }
@@ -782,17 +1284,22 @@ void MAVLinkParameters::receive_timeout()
                 if (!_parent.send_message(work->mavlink_message)) {
                     LogErr() << "connection send error in retransmit (" << work->param_name << ").";
                     work_queue_guard.pop_front();
+                    _parent.schedule_work();
                     work->set_param_callback(MAVLinkParameters::Result::ConnectionError);
                 } else {
                     --work->retries_to_do;
+                    ++work->retries_done;
                     _parent.register_timeout_handler(
-                        [this] { receive_timeout(); }, work->timeout_s, &_timeout_cookie);
+                        [this] { receive_timeout(); },
+                        RttEstimator::backoff_s(work->timeout_s, work->retries_done),
+                        &_timeout_cookie);
                 }
             } else {
                 // We have tried retransmitting, giving up now.
                 LogErr() << "Error: Retrying failed get param busy timeout: " << work->param_name;
 
                 work_queue_guard.pop_front();
+                _parent.schedule_work();
                 work->set_param_callback(MAVLinkParameters::Result::Timeout);
             }
         } break;
@@ -801,6 +1308,14 @@ void MAVLinkParameters::receive_timeout()
     }
 }
 
+void MAVLinkParameters::add_rtt_sample(const WorkItem& work)
+{
+    // The echo of a retransmitted request could belong to either transmission.
+    if (work.retries_done == 0) {
+        _parent.add_rtt_sample(_parent.get_time().elapsed_since_s(work.time_started));
+    }
+}
+
 std::string MAVLinkParameters::extract_safe_param_id(const char param_id[])
 {
     // The param_id field of the MAVLink struct has length 16 and is not 0 terminated.
@@ -825,30 +1340,18 @@ void MAVLinkParameters::process_param_set(const mavlink_message_t& message)
     if (!safe_param_id.empty()) {
         LogDebug() << "Set Param Request: " << safe_param_id;
         // Use the ID
-        if (_param_server_store.find(safe_param_id) != _param_server_store.end()) {
+        if (auto* stored_value = _param_server_store.find(safe_param_id)) {
             ParamValue value{};
             if (!value.set_from_mavlink_param_set(set_request)) {
                 LogWarn() << "Invalid Param Set Request: " << safe_param_id;
                 return;
             }
-            _param_server_store.at(safe_param_id) = value;
-            auto new_work = std::make_shared<WorkItem>(_parent.timeout_s());
-            new_work->type = WorkItem::Type::Value;
-            new_work->param_name = safe_param_id;
-            new_work->param_value = _param_server_store.at(safe_param_id);
-            new_work->extended = false;
-            _work_queue.push_back(new_work);
-            std::lock_guard<std::mutex> lock(_param_changed_subscriptions_mutex);
-            for (const auto& subscription : _param_changed_subscriptions) {
-                if (subscription.param_name != safe_param_id) {
-                    continue;
-                }
-                if (!subscription.any_type && !subscription.value_type.is_same_type(value)) {
-                    LogErr() << "Received wrong param type in subscription for "
-                             << subscription.param_name;
-                    continue;
-                }
-                subscription.callback(value);
+            *stored_value = value;
+            // Reply right away rather than through the work queue, so a client
+            // setting many params at once doesn't wait for our own requests.
+            send_server_param_value(*_param_server_store.index_of(safe_param_id));
+            if (const auto name = ParamName::from(safe_param_id)) {
+                notify_param_subscriptions(*name, value);
             }
         } else {
             LogDebug() << "Missing Param: " << safe_param_id;
@@ -863,23 +1366,7 @@ void MAVLinkParameters::process_param_request_read(const mavlink_message_t& mess
     mavlink_param_request_read_t read_request{};
     mavlink_msg_param_request_read_decode(&message, &read_request);
 
-    std::string param_id = extract_safe_param_id(read_request.param_id);
-
-    if (read_request.param_index == -1) {
-        auto safe_param_id = extract_safe_param_id(read_request.param_id);
-        LogDebug() << "Request Param " << safe_param_id;
-        // Use the ID
-        if (_param_server_store.find(safe_param_id) != _param_server_store.end()) {
-            auto new_work = std::make_shared<WorkItem>(_parent.timeout_s());
-            new_work->type = WorkItem::Type::Value;
-            new_work->param_name = safe_param_id;
-            new_work->param_value = _param_server_store.at(safe_param_id);
-            new_work->extended = false;
-            _work_queue.push_back(new_work);
-        } else {
-            LogDebug() << "Missing Param " << safe_param_id;
-        }
-    }
+    queue_server_param_value(read_request, false);
 }
 
 void MAVLinkParameters::process_param_request_list(const mavlink_message_t& message)
@@ -887,43 +1374,107 @@ void MAVLinkParameters::process_param_request_list(const mavlink_message_t& mess
     mavlink_param_request_list_t list_request{};
     mavlink_msg_param_request_list_decode(&message, &list_request);
 
-    auto idx = 0;
-    for (const auto& pair : _param_server_store) {
-        auto new_work = std::make_shared<WorkItem>(_parent.timeout_s());
-        new_work->type = WorkItem::Type::Value;
-        new_work->param_name = pair.first;
-        new_work->param_value = pair.second;
-        new_work->extended = false;
-        new_work->param_count = static_cast<int>(_param_server_store.size());
-        new_work->param_index = idx++;
-        _work_queue.push_back(new_work);
+    std::lock_guard<std::mutex> lock(_server_list_mutex);
+
+    // Another request while streaming starts over, the previous one was
+    // probably lost on the way.
+    _server_list_next_index = 0;
+
+    if (_server_list_cookie == nullptr) {
+        _parent.add_call_every(
+            [this]() { send_server_param_list_batch(); },
+            SERVER_LIST_INTERVAL_S,
+            &_server_list_cookie);
     }
 }
 
-void MAVLinkParameters::process_param_ext_request_read(const mavlink_message_t& message)
+void MAVLinkParameters::send_server_param_list_batch()
 {
-    mavlink_param_request_read_t read_request{};
-    mavlink_msg_param_request_read_decode(&message, &read_request);
+    std::lock_guard<std::mutex> lock(_server_list_mutex);
 
-    std::string param_id = extract_safe_param_id(read_request.param_id);
+    const auto end =
+        std::min(_server_list_next_index + SERVER_LIST_BATCH, _param_server_store.size());
+    for (; _server_list_next_index < end; ++_server_list_next_index) {
+        send_server_param_value(_server_list_next_index);
+    }
 
-    if (read_request.param_index == -1) {
-        auto safe_param_id = extract_safe_param_id(read_request.param_id);
-        LogDebug() << "Request Param " << safe_param_id;
-        // Use the ID
-        if (_param_server_store.find(safe_param_id) != _param_server_store.end()) {
-            auto new_work = std::make_shared<WorkItem>(_parent.timeout_s());
-            new_work->type = WorkItem::Type::Value;
-            new_work->param_name = safe_param_id;
-            new_work->param_value = _param_server_store.at(safe_param_id);
-            new_work->extended = true;
-            _work_queue.push_back(new_work);
-        } else {
-            LogDebug() << "Missing Param " << safe_param_id;
+    if (_server_list_next_index >= _param_server_store.size() && _server_list_cookie) {
+        _parent.remove_call_every(_server_list_cookie);
+        _server_list_cookie = nullptr;
+    }
+}
+
+void MAVLinkParameters::queue_server_param_value(
+    const mavlink_param_request_read_t& read_request, bool extended)
+{
+    // An index of -1 means the param is requested by name.
+    if (read_request.param_index != -1) {
+        if (read_request.param_index < 0 ||
+            static_cast<std::size_t>(read_request.param_index) >= _param_server_store.size()) {
+            LogDebug() << "Missing Param at index " << read_request.param_index;
+            return;
         }
+        queue_server_param_value(static_cast<std::size_t>(read_request.param_index), extended);
+        return;
+    }
+
+    auto safe_param_id = extract_safe_param_id(read_request.param_id);
+    LogDebug() << "Request Param " << safe_param_id;
+    const auto index = _param_server_store.index_of(safe_param_id);
+    if (!index) {
+        LogDebug() << "Missing Param " << safe_param_id;
+        return;
+    }
+    queue_server_param_value(*index, extended);
+}
+
+void MAVLinkParameters::send_server_param_value(std::size_t index)
+{
+    const auto& entry = _param_server_store.at(index);
+
+    char param_id[PARAM_ID_LEN + 1] = {};
+    const auto name = entry.name.view();
+    std::memcpy(param_id, name.data(), name.size());
+
+    mavlink_message_t msg;
+    mavlink_msg_param_value_pack(
+        _parent.get_own_system_id(),
+        _parent.get_own_component_id(),
+        &msg,
+        param_id,
+        entry.value.get_4_float_bytes(),
+        entry.value.get_mav_param_type(),
+        static_cast<uint16_t>(_param_server_store.size()),
+        static_cast<uint16_t>(index));
+
+    if (!_parent.send_message(msg)) {
+        LogErr() << "Error: Send message failed";
     }
 }
 
+void MAVLinkParameters::queue_server_param_value(std::size_t index, bool extended)
+{
+    const auto& entry = _param_server_store.at(index);
+
+    auto new_work = make_pooled<WorkItem>(_work_pool, _parent.timeout_s());
+    new_work->type = WorkItem::Type::Value;
+    new_work->param_name = entry.name.str();
+    new_work->param_value = entry.value;
+    new_work->extended = extended;
+    new_work->param_count = static_cast<int>(_param_server_store.size());
+    new_work->param_index = static_cast<int>(index);
+    _work_queue.push_back(new_work);
+    _parent.schedule_work();
+}
+
+void MAVLinkParameters::process_param_ext_request_read(const mavlink_message_t& message)
+{
+    mavlink_param_request_read_t read_request{};
+    mavlink_msg_param_request_read_decode(&message, &read_request);
+
+    queue_server_param_value(read_request, true);
+}
+
 bool MAVLinkParameters::ParamValue::set_from_mavlink_param_value(
     const mavlink_param_value_t& mavlink_value)
 {
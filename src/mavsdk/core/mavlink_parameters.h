@@ -3,13 +3,20 @@
 #include "log.h"
 #include "mavlink_include.h"
 #include "locked_queue.h"
+#include "mavsdk_time.h"
+#include "param_table.h"
+#include "slab_pool.h"
 #include <cstddef>
 #include <cstdint>
 #include <string>
 #include <functional>
 #include <cassert>
 #include <vector>
+#include <deque>
 #include <map>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 #include <variant>
 
 namespace mavsdk {
@@ -123,8 +130,25 @@ public:
         const void* cookie = nullptr,
         bool extended = false);
 
+    // Parameters by name and by index, iterating over it does not copy anything.
+    using ParamStore = ParamTable<ParamValue>;
+
+    // Sets all params, keeping several PARAM_SET in flight at once instead of
+    // waiting for each to be acknowledged. The result is Success only if all
+    // of them were set.
+    void set_params_async(const ParamStore& params, const set_param_callback_t& callback);
+    Result set_params(const ParamStore& params);
+
+    // Same, but also reports the result of each param, by index in the store.
+    typedef std::function<void(Result result, std::vector<Result> results)>
+        set_params_callback_t;
+    void set_params_async(const ParamStore& params, const set_params_callback_t& callback);
+
     void provide_server_param(const std::string& name, const ParamValue& value);
-    std::map<std::string, MAVLinkParameters::ParamValue> retrieve_all_server_params();
+    const ParamStore& retrieve_all_server_params() const;
+
+    // Roughly what the server params and a download in progress have allocated.
+    std::size_t allocated_bytes();
 
     std::pair<Result, ParamValue>
     retrieve_server_param(const std::string& name, ParamValue value_type);
@@ -138,10 +162,13 @@ public:
         const void* cookie,
         bool extended = false);
 
-    std::map<std::string, MAVLinkParameters::ParamValue> get_all_params();
-    typedef std::function<void(std::map<std::string, MAVLinkParameters::ParamValue>)>
-        get_all_params_callback_t;
-    void get_all_params_async(const get_all_params_callback_t& callback);
+    ParamStore get_all_params();
+    typedef std::function<void(const ParamStore&)> get_all_params_callback_t;
+    // Progress is the share of params received so far, from 0 to 1.
+    typedef std::function<void(float progress)> get_all_params_progress_callback_t;
+    void get_all_params_async(
+        const get_all_params_callback_t& callback,
+        const get_all_params_progress_callback_t& progress_callback = nullptr);
 
     using ParamChangedCallback = std::function<void(ParamValue value)>;
     void subscribe_param_changed(
@@ -153,6 +180,12 @@ public:
         const ParamChangedCallback& callback,
         const void* cookie);
 
+    // Called once with all params whenever the complete list was fetched,
+    // either downloaded or from the cache, instead of once per param. A
+    // nullptr callback unsubscribes.
+    using ParamsChangedCallback = std::function<void(const ParamStore& params)>;
+    void subscribe_params_changed(const ParamsChangedCallback& callback, const void* cookie);
+
     void cancel_all_param(const void* cookie);
 
     void do_work();
@@ -172,8 +205,12 @@ private:
     void process_param_ext_value(const mavlink_message_t& message);
     void process_param_ext_ack(const mavlink_message_t& message);
     void receive_timeout();
+    void all_params_timeout();
+    bool send_param_list_request();
+    bool send_param_read_request(const char* name, int16_t index);
 
-    void notify_param_subscriptions(const mavlink_param_value_t& param_value);
+    void notify_param_subscriptions(const ParamName& name, const ParamValue& value);
+    void notify_params_subscriptions(const ParamStore& params);
 
     static std::string extract_safe_param_id(const char param_id[]);
 
@@ -192,6 +229,7 @@ private:
         bool extended{false};
         int retries_done{0};
         bool already_requested{false};
+        dl_time_t time_started{};
         const void* cookie{nullptr};
         int retries_to_do{3};
         double timeout_s;
@@ -202,34 +240,125 @@ private:
         explicit WorkItem(double new_timeout_s) : timeout_s(new_timeout_s){};
     };
     LockedQueue<WorkItem> _work_queue{};
+    // Work items are recycled, fetching all params one by one creates plenty.
+    std::shared_ptr<SlabPool> _work_pool{make_shared_slab_pool<WorkItem>(16)};
+
+    void add_rtt_sample(const WorkItem& work);
 
     void* _timeout_cookie = nullptr;
 
     struct ParamChangedSubscription {
-        std::string param_name{};
         ParamChangedCallback callback{};
         ParamValue value_type{};
         bool any_type{false};
         const void* cookie{nullptr};
     };
 
+    void add_param_changed_subscription(
+        const std::string& name, ParamChangedSubscription subscription);
+    void remove_param_changed_subscription(const std::string& name, const void* cookie);
+
+    // Keyed by name, so a param coming in only reaches its own subscribers
+    // and everything else costs a single lookup.
     std::mutex _param_changed_subscriptions_mutex{};
-    std::vector<ParamChangedSubscription> _param_changed_subscriptions{};
+    std::unordered_map<ParamName, std::vector<ParamChangedSubscription>, ParamName::Hash>
+        _param_changed_subscriptions{};
+
+    struct ParamsChangedSubscription {
+        ParamsChangedCallback callback{};
+        const void* cookie{nullptr};
+    };
+    std::vector<ParamsChangedSubscription> _params_changed_subscriptions{};
+
+    // The list is streamed after PARAM_REQUEST_LIST. Whatever gets lost on
+    // the way is requested afterwards by index, a few at a time, instead of
+    // starting over.
+    static constexpr std::size_t GAP_FILL_WINDOW = 10;
+    // Timeouts in a row without receiving anything before giving up.
+    static constexpr int ALL_PARAMS_RETRIES = 5;
+    // Reported by PX4 with a hash over all its params.
+    static constexpr const char* HASH_CHECK_PARAM_ID = "_HASH_CHECK";
 
     struct AllParameters {
-        std::map<std::string, ParamValue> all_params{};
+        ParamStore all_params{};
         get_all_params_callback_t callback{nullptr};
+        get_all_params_progress_callback_t progress_callback{nullptr};
+        void* timeout_cookie{nullptr};
+        // By param_index, sized once param_count is known.
+        std::vector<bool> received{};
+        std::size_t num_received{0};
+        bool gap_filling{false};
+        // Indices requested by PARAM_REQUEST_READ which are not in yet.
+        std::vector<uint16_t> requested{};
+        // All indices below this are either received or requested.
+        std::size_t next_missing{0};
+        int retries_left{ALL_PARAMS_RETRIES};
+        // With a param cache, the hash is requested first, and the list only
+        // if it doesn't match the cache.
+        bool checking_hash{false};
+        std::optional<uint32_t> hash{};
+    };
+    void request_missing_params(AllParameters& all_params);
+
+    // At most this many params of a batch are set at the same time.
+    static constexpr std::size_t SET_PARAMS_WINDOW = 10;
+
+    struct SetParamsBatch {
+        struct Item {
+            std::string name{};
+            ParamValue value{};
+            std::size_t index{0};
+            int retries_left{3};
+        };
+        std::deque<Item> pending{};
+        std::vector<Item> in_flight{};
+        set_params_callback_t callback{nullptr};
+        // The first failure, if any.
+        Result result{Result::Success};
+        // By index in the store.
+        std::vector<Result> results{};
         void* timeout_cookie{nullptr};
     };
+    static void fail_set_params_item(
+        SetParamsBatch& batch, const SetParamsBatch::Item& item, Result result);
+    bool send_param_set(const SetParamsBatch::Item& item);
+    void fill_set_params_window(SetParamsBatch& batch);
+    void set_params_timeout(const std::shared_ptr<SetParamsBatch>& batch);
+    bool process_set_params_ack(const mavlink_param_value_t& param_value);
+    void finish_set_params_if_done(
+        std::unique_lock<std::mutex>& lock, const std::shared_ptr<SetParamsBatch>& batch);
+
+    std::mutex _set_params_mutex{};
+    std::vector<std::shared_ptr<SetParamsBatch>> _set_params_batches{};
+    bool process_hash_check(std::unique_lock<std::mutex>& lock, uint32_t hash);
+    std::string param_cache_path() const;
+    void save_param_cache(const AllParameters& all_params, uint32_t hash);
     std::shared_ptr<AllParameters> _all_param_store{nullptr};
+    // Downloaded params which are saved to the cache once the hash arrives.
+    std::shared_ptr<AllParameters> _all_params_to_cache{nullptr};
     std::mutex _all_param_mutex{};
 
     // dl_time_t _last_request_time = {};
 
-    std::map<std::string, ParamValue> _param_server_store;
+    ParamStore _param_server_store{};
     void process_param_request_read(const mavlink_message_t& message);
     void process_param_ext_request_read(const mavlink_message_t& message);
     void process_param_request_list(const mavlink_message_t& message);
+    void
+    queue_server_param_value(const mavlink_param_request_read_t& read_request, bool extended);
+    void queue_server_param_value(std::size_t index, bool extended);
+    void send_server_param_value(std::size_t index);
+
+    // The list is sent a batch per tick from a timer rather than queued as
+    // one work item per param, so it neither floods the link nor the work
+    // queue, however many params there are.
+    static constexpr float SERVER_LIST_INTERVAL_S = 0.02f;
+    static constexpr std::size_t SERVER_LIST_BATCH = 10;
+    void send_server_param_list_batch();
+
+    std::mutex _server_list_mutex{};
+    std::size_t _server_list_next_index{0};
+    void* _server_list_cookie{nullptr};
 };
 
 } // namespace mavsdk
@@ -1,10 +1,15 @@
 #include "mavlink_receiver.h"
+#include "allocation_tracker.h"
 #include "log.h"
+#include "message_latency.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <iomanip>
 
 namespace mavsdk {
 
-MAVLinkReceiver::MAVLinkReceiver(uint8_t channel) : _channel(channel)
+MAVLinkReceiver::MAVLinkReceiver(LinkStats* link_stats) : _link_stats(link_stats)
 {
     if (const char* env_p = std::getenv("MAVSDK_DROP_DEBUGGING")) {
         if (std::string(env_p) == "1") {
@@ -14,10 +19,16 @@ MAVLinkReceiver::MAVLinkReceiver(uint8_t channel) : _channel(channel)
     }
 }
 
-void MAVLinkReceiver::set_new_datagram(char* datagram, unsigned datagram_len)
+void MAVLinkReceiver::set_new_datagram(
+    char* datagram, unsigned datagram_len, uint64_t receive_time_ns)
 {
     _datagram = datagram;
     _datagram_len = datagram_len;
+    _datagram_time_ns = receive_time_ns != 0 ? receive_time_ns : MessageLatency::now_ns();
+
+    if (_link_stats) {
+        _link_stats->add_bytes(datagram_len);
+    }
 
     if (_drop_debugging_on) {
         _drop_stats.bytes_received += _datagram_len;
@@ -26,14 +37,47 @@ void MAVLinkReceiver::set_new_datagram(char* datagram, unsigned datagram_len)
 
 bool MAVLinkReceiver::parse_message()
 {
+    MAVSDK_ALLOCATION_REGION(Receive);
+
     // Note that one datagram can contain multiple mavlink messages.
-    for (unsigned i = 0; i < _datagram_len; ++i) {
-        if (mavlink_parse_char(_channel, _datagram[i], &_last_message, &_status) == 1) {
-            // Move the pointer to the datagram forward by the amount parsed.
-            _datagram += (i + 1);
-            // And decrease the length, so we don't overshoot in the next round.
-            _datagram_len -= (i + 1);
+    while (_datagram_len > 0) {
+        if (is_parser_idle()) {
+            // While idle, the parser throws away everything until it sees a
+            // start byte, so we can skip ahead to it directly.
+            const auto* begin = reinterpret_cast<const uint8_t*>(_datagram);
+            const auto* end = begin + _datagram_len;
+            const auto* stx = std::find_if(begin, end, [](uint8_t c) {
+                return c == MAVLINK_STX || c == MAVLINK_STX_MAVLINK1;
+            });
+            const auto skipped = static_cast<unsigned>(stx - begin);
+            _datagram += skipped;
+            _datagram_len -= skipped;
+
+            if (_datagram_len == 0) {
+                break;
+            }
+
+            if (parse_frame_in_bulk()) {
+                count_message();
+                if (_drop_debugging_on) {
+                    debug_drop_rate();
+                }
+                return true;
+            }
+        }
 
+        // Anything the bulk path can't take (MAVLink 1, signed or incomplete
+        // frames, or bad checksums) goes through the parser byte by byte until
+        // it is idle again.
+        const char c = _datagram[0];
+        ++_datagram;
+        --_datagram_len;
+
+        const uint8_t parse_state_before = _rx_status.parse_state;
+        const uint8_t parse_errors_before = _rx_status.parse_error;
+
+        if (parse_char(static_cast<uint8_t>(c)) == 1) {
+            count_message();
             if (_drop_debugging_on) {
                 debug_drop_rate();
             }
@@ -41,6 +85,10 @@ bool MAVLinkReceiver::parse_message()
             // We have parsed one message, let's return, so it can be handled.
             return true;
         }
+
+        if (_rx_status.parse_error != parse_errors_before) {
+            count_parse_error(parse_state_before);
+        }
     }
 
     // No (more) messages, let's give up.
@@ -49,6 +97,182 @@ bool MAVLinkReceiver::parse_message()
     return false;
 }
 
+void MAVLinkReceiver::count_message()
+{
+    if (!_link_stats) {
+        return;
+    }
+
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(_last_message.msgid);
+    if (entry && _last_message.len > entry->max_msg_len) {
+        _link_stats->add_bad_length();
+    }
+
+    unsigned length = _last_message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+    if (_last_message.incompat_flags & MAVLINK_IFLAG_SIGNED) {
+        length += MAVLINK_SIGNATURE_BLOCK_LEN;
+    }
+    _link_stats->add_message(_last_message.sysid, _last_message.compid, _last_message.seq, length);
+}
+
+void MAVLinkReceiver::count_parse_error(uint8_t parse_state_before)
+{
+    if (!_link_stats) {
+        return;
+    }
+
+    // The parser doesn't tell why it rejected a frame, but the state it was
+    // in before tells which check failed.
+    switch (parse_state_before) {
+        case MAVLINK_PARSE_STATE_GOT_CRC1:
+        case MAVLINK_PARSE_STATE_SIGNATURE_WAIT:
+            _link_stats->add_crc_error();
+            break;
+        case MAVLINK_PARSE_STATE_GOT_STX:
+        case MAVLINK_PARSE_STATE_GOT_MSGID1:
+        case MAVLINK_PARSE_STATE_GOT_MSGID3:
+            _link_stats->add_bad_length();
+            break;
+        default:
+            _link_stats->add_parse_error();
+            break;
+    }
+}
+
+bool MAVLinkReceiver::is_parser_idle() const
+{
+    const auto parse_state = _rx_status.parse_state;
+    return parse_state == MAVLINK_PARSE_STATE_IDLE || parse_state == MAVLINK_PARSE_STATE_UNINIT;
+}
+
+bool MAVLinkReceiver::parse_frame_in_bulk()
+{
+    // Takes a complete, unsigned MAVLink 2 frame at the start of the datagram
+    // in one go and leaves the message and status just like
+    // mavlink_parse_char would have. Everything else is left to the parser.
+    const auto* frame = reinterpret_cast<const uint8_t*>(_datagram);
+
+    if (_datagram_len < MAVLINK_NUM_HEADER_BYTES || frame[0] != MAVLINK_STX) {
+        return false;
+    }
+
+    const uint8_t payload_len = frame[1];
+    const uint8_t incompat_flags = frame[2];
+    if (incompat_flags != 0) {
+        return false;
+    }
+
+    const unsigned frame_len = MAVLINK_NUM_HEADER_BYTES + payload_len + MAVLINK_NUM_CHECKSUM_BYTES;
+    if (_datagram_len < frame_len) {
+        return false;
+    }
+
+    const uint32_t msgid = static_cast<uint32_t>(frame[7]) |
+                           (static_cast<uint32_t>(frame[8]) << 8) |
+                           (static_cast<uint32_t>(frame[9]) << 16);
+
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(msgid);
+    const uint8_t crc_extra = entry ? entry->crc_extra : 0;
+
+    // The checksum covers everything but the start byte, plus the CRC extra.
+    uint16_t crc = crc_x25(&frame[1], MAVLINK_CORE_HEADER_LEN + payload_len, X25_INIT_CRC);
+    crc = crc_x25(&crc_extra, 1, crc);
+
+    const uint8_t ck_a = frame[MAVLINK_NUM_HEADER_BYTES + payload_len];
+    const uint8_t ck_b = frame[MAVLINK_NUM_HEADER_BYTES + payload_len + 1];
+    if (ck_a != (crc & 0xFF) || ck_b != (crc >> 8)) {
+        // Let the parser count the error.
+        return false;
+    }
+
+    _last_message.magic = MAVLINK_STX;
+    _last_message.len = payload_len;
+    _last_message.incompat_flags = incompat_flags;
+    _last_message.compat_flags = frame[3];
+    _last_message.seq = frame[4];
+    _last_message.sysid = frame[5];
+    _last_message.compid = frame[6];
+    _last_message.msgid = msgid;
+    _last_message.checksum = crc;
+    _last_message.ck[0] = ck_a;
+    _last_message.ck[1] = ck_b;
+
+    auto* payload = reinterpret_cast<uint8_t*>(_MAV_PAYLOAD_NON_CONST(&_last_message));
+    std::memcpy(payload, &frame[MAVLINK_NUM_HEADER_BYTES], payload_len);
+    // Zero-fill truncated payloads, same as the parser.
+    if (entry && payload_len < entry->max_msg_len) {
+        std::memset(&payload[payload_len], 0, entry->max_msg_len - payload_len);
+    }
+
+    mavlink_status_t* status = &_rx_status;
+    status->msg_received = MAVLINK_FRAMING_OK;
+    status->parse_state = MAVLINK_PARSE_STATE_IDLE;
+    status->packet_idx = 0;
+    status->flags &= ~MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    status->current_rx_seq = _last_message.seq;
+    if (status->packet_rx_success_count == 0) {
+        status->packet_rx_drop_count = 0;
+    }
+    status->packet_rx_success_count++;
+
+    _status.parse_state = status->parse_state;
+    _status.packet_idx = status->packet_idx;
+    _status.current_rx_seq = status->current_rx_seq + 1;
+    _status.packet_rx_success_count = status->packet_rx_success_count;
+    _status.packet_rx_drop_count = status->parse_error;
+    _status.flags = status->flags;
+    status->parse_error = 0;
+
+    _datagram += frame_len;
+    _datagram_len -= frame_len;
+    return true;
+}
+
+uint8_t MAVLinkReceiver::parse_char(uint8_t c)
+{
+    // Same as mavlink_parse_char, but on our own buffer and status instead of
+    // the ones of a channel.
+    const uint8_t msg_received =
+        mavlink_frame_char_buffer(&_rx_buffer, &_rx_status, c, &_last_message, &_status);
+
+    if (msg_received == MAVLINK_FRAMING_BAD_CRC || msg_received == MAVLINK_FRAMING_BAD_SIGNATURE) {
+        // A bad checksum is treated as a parse error.
+        _rx_status.parse_error++;
+        _rx_status.msg_received = MAVLINK_FRAMING_INCOMPLETE;
+        _rx_status.parse_state = MAVLINK_PARSE_STATE_IDLE;
+        if (c == MAVLINK_STX) {
+            _rx_status.parse_state = MAVLINK_PARSE_STATE_GOT_STX;
+            _rx_buffer.len = 0;
+            mavlink_start_checksum(&_rx_buffer);
+        }
+        return 0;
+    }
+    return msg_received;
+}
+
+uint16_t MAVLinkReceiver::crc_x25(const uint8_t* data, unsigned len, uint16_t crc)
+{
+    // Table driven version of crc_accumulate (CRC-16/MCRF4XX) from MAVLink's
+    // checksum.h, so we don't need to go bit by bit for every byte.
+    static const auto table = []() {
+        std::array<uint16_t, 256> result{};
+        for (unsigned i = 0; i < 256; ++i) {
+            uint16_t value = static_cast<uint16_t>(i);
+            for (unsigned bit = 0; bit < 8; ++bit) {
+                value = (value & 1) ? static_cast<uint16_t>((value >> 1) ^ 0x8408) :
+                                      static_cast<uint16_t>(value >> 1);
+            }
+            result[i] = value;
+        }
+        return result;
+    }();
+
+    for (unsigned i = 0; i < len; ++i) {
+        crc = static_cast<uint16_t>((crc >> 8) ^ table[(crc ^ data[i]) & 0xFF]);
+    }
+    return crc;
+}
+
 void MAVLinkReceiver::debug_drop_rate()
 {
     if (_last_message.msgid == MAVLINK_MSG_ID_SYS_STATUS) {
@@ -1,22 +1,32 @@
 #pragma once
 
+#include "link_stats.h"
 #include "mavlink_include.h"
 #include "mavsdk_time.h"
 #include <cstdint>
 
 namespace mavsdk {
 
+// Parses the MAVLink stream of one connection.
+//
+// The parser state lives in the receiver rather than in one of MAVLink's
+// global channels, so there can be as many receivers as there are
+// connections, and receivers on different threads don't share anything.
 class MAVLinkReceiver {
 public:
-    explicit MAVLinkReceiver(uint8_t channel);
-
-    [[nodiscard]] uint8_t get_channel() const { return _channel; }
+    // If link_stats is set, everything received is counted there.
+    explicit MAVLinkReceiver(LinkStats* link_stats = nullptr);
 
     mavlink_message_t& get_last_message() { return _last_message; }
 
     mavlink_status_t& get_status() { return _status; }
 
-    void set_new_datagram(char* datagram, unsigned datagram_len);
+    // The receive time defaults to now, it only needs to be passed if the
+    // datagram was received earlier, e.g. as part of a batch.
+    void set_new_datagram(char* datagram, unsigned datagram_len, uint64_t receive_time_ns = 0);
+
+    // Monotonic time in nanoseconds at which the current datagram was received.
+    [[nodiscard]] uint64_t datagram_time_ns() const { return _datagram_time_ns; }
 
     bool parse_message();
 
@@ -29,11 +39,23 @@ public:
         uint64_t overall_bytes_total);
 
 private:
-    uint8_t _channel;
+    bool parse_frame_in_bulk();
+    uint8_t parse_char(uint8_t c);
+    void count_message();
+    void count_parse_error(uint8_t parse_state_before);
+    [[nodiscard]] bool is_parser_idle() const;
+    static uint16_t crc_x25(const uint8_t* data, unsigned len, uint16_t crc);
+
+    LinkStats* _link_stats;
     mavlink_message_t _last_message = {};
     mavlink_status_t _status = {};
+
+    // What mavlink_parse_char keeps per channel.
+    mavlink_message_t _rx_buffer = {};
+    mavlink_status_t _rx_status = {};
     char* _datagram = nullptr;
     unsigned _datagram_len = 0;
+    uint64_t _datagram_time_ns = 0;
 
     Time _time{};
 
@@ -0,0 +1,33 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include "benchmark_helpers.h"
+#include "mavlink_receiver.h"
+
+using namespace mavsdk;
+
+// Datagrams as big as PX4 sends them over UDP.
+static constexpr std::size_t datagram_size = 1200;
+
+static void MAVLinkReceiver_Parse(benchmark::State& state)
+{
+    const auto messages = px4_default_stream_mix(static_cast<unsigned>(state.range(0)));
+    auto bytes = serialize(messages);
+
+    MAVLinkReceiver receiver;
+
+    for (auto _ : state) {
+        std::size_t num_parsed = 0;
+        for (std::size_t offset = 0; offset < bytes.size(); offset += datagram_size) {
+            const auto length = std::min(datagram_size, bytes.size() - offset);
+            receiver.set_new_datagram(
+                reinterpret_cast<char*>(bytes.data() + offset), static_cast<unsigned>(length));
+            while (receiver.parse_message()) {
+                ++num_parsed;
+            }
+        }
+        benchmark::DoNotOptimize(num_parsed);
+    }
+
+    count_messages(state, messages.size());
+}
+BENCHMARK(MAVLinkReceiver_Parse)->Apply(px4_stream_scales);
@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+#include "mavlink_receiver.h"
+
+using namespace mavsdk;
+
+namespace {
+
+void append_message(std::vector<char>& stream, const mavlink_message_t& message)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t len = mavlink_msg_to_send_buffer(buffer, &message);
+    stream.insert(stream.end(), buffer, buffer + len);
+}
+
+std::vector<char> make_stream()
+{
+    std::vector<char> stream;
+    mavlink_message_t message;
+
+    mavlink_msg_heartbeat_pack(
+        1, 1, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+    append_message(stream, message);
+
+    mavlink_msg_param_value_pack(
+        1, 1, &message, "MPC_XY_VEL_MAX", 12.0f, MAV_PARAM_TYPE_REAL32, 1000, 42);
+    append_message(stream, message);
+
+    // Trailing zeros of the text get truncated in MAVLink 2.
+    mavlink_msg_statustext_pack(1, 1, &message, MAV_SEVERITY_INFO, "short", 0, 0);
+    append_message(stream, message);
+
+    // Some garbage in between, including start bytes.
+    const char garbage[] = {0x01, 0x02, char(MAVLINK_STX), 0x03, char(MAVLINK_STX_MAVLINK1), 0x04};
+    stream.insert(stream.end(), garbage, garbage + sizeof(garbage));
+
+    // A frame with a broken checksum.
+    mavlink_msg_heartbeat_pack(
+        1, 1, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+    const auto corrupt_start = stream.size();
+    append_message(stream, message);
+    stream[corrupt_start + MAVLINK_NUM_HEADER_BYTES] ^= 0x55;
+
+    mavlink_msg_statustext_pack(
+        2, 1, &message, MAV_SEVERITY_WARNING, "some longer text to fill the payload", 0, 0);
+    append_message(stream, message);
+
+    mavlink_msg_heartbeat_pack(
+        2, 1, &message, MAV_TYPE_GCS, MAV_AUTOPILOT_INVALID, 0, 0, MAV_STATE_ACTIVE);
+    append_message(stream, message);
+
+    return stream;
+}
+
+std::vector<mavlink_message_t> parse_char_by_char(uint8_t channel, const std::vector<char>& stream)
+{
+    std::vector<mavlink_message_t> messages;
+    mavlink_message_t message{};
+    mavlink_status_t status{};
+    for (const char c : stream) {
+        if (mavlink_parse_char(channel, c, &message, &status) == 1) {
+            messages.push_back(message);
+        }
+    }
+    return messages;
+}
+
+std::vector<mavlink_message_t> parse_with_receiver(std::vector<char> stream, std::size_t chunk_size)
+{
+    std::vector<mavlink_message_t> messages;
+    MAVLinkReceiver receiver;
+    for (std::size_t offset = 0; offset < stream.size(); offset += chunk_size) {
+        const auto len = std::min(chunk_size, stream.size() - offset);
+        receiver.set_new_datagram(&stream[offset], static_cast<unsigned>(len));
+        while (receiver.parse_message()) {
+            messages.push_back(receiver.get_last_message());
+        }
+    }
+    return messages;
+}
+
+void expect_same_messages(
+    const std::vector<mavlink_message_t>& expected, const std::vector<mavlink_message_t>& actual)
+{
+    ASSERT_EQ(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i].msgid, actual[i].msgid);
+        EXPECT_EQ(expected[i].sysid, actual[i].sysid);
+        EXPECT_EQ(expected[i].compid, actual[i].compid);
+        EXPECT_EQ(expected[i].seq, actual[i].seq);
+        EXPECT_EQ(expected[i].len, actual[i].len);
+        EXPECT_EQ(expected[i].checksum, actual[i].checksum);
+
+        const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(expected[i].msgid);
+        ASSERT_NE(entry, nullptr);
+        EXPECT_EQ(
+            std::memcmp(
+                _MAV_PAYLOAD(&expected[i]), _MAV_PAYLOAD(&actual[i]), entry->max_msg_len),
+            0);
+    }
+}
+
+} // namespace
+
+TEST(MAVLinkReceiver, BulkParsingMatchesParseChar)
+{
+    const auto stream = make_stream();
+
+    const auto expected = parse_char_by_char(MAVLINK_COMM_1, stream);
+    // Everything but the corrupt frame.
+    EXPECT_EQ(expected.size(), 5);
+
+    expect_same_messages(expected, parse_with_receiver(stream, stream.size()));
+}
+
+TEST(MAVLinkReceiver, FramesSplitAcrossDatagrams)
+{
+    const auto stream = make_stream();
+
+    const auto expected = parse_char_by_char(MAVLINK_COMM_1, stream);
+
+    for (const std::size_t chunk_size : {1, 7, 13, 64}) {
+        expect_same_messages(expected, parse_with_receiver(stream, chunk_size));
+    }
+}
+
+TEST(MAVLinkReceiver, ReceiversDontShareParserState)
+{
+    auto stream = make_stream();
+    const auto expected = parse_char_by_char(MAVLINK_COMM_1, stream);
+
+    // Way more receivers than MAVLink has channels, fed in turns with a few
+    // bytes each, so every one of them is in the middle of a frame.
+    constexpr std::size_t num_receivers = 100;
+    constexpr std::size_t chunk_size = 5;
+    std::vector<std::unique_ptr<MAVLinkReceiver>> receivers;
+    std::vector<std::vector<mavlink_message_t>> messages(num_receivers);
+    for (std::size_t i = 0; i < num_receivers; ++i) {
+        receivers.push_back(std::make_unique<MAVLinkReceiver>());
+    }
+
+    for (std::size_t offset = 0; offset < stream.size(); offset += chunk_size) {
+        const auto len = std::min(chunk_size, stream.size() - offset);
+        for (std::size_t i = 0; i < num_receivers; ++i) {
+            receivers[i]->set_new_datagram(&stream[offset], static_cast<unsigned>(len));
+            while (receivers[i]->parse_message()) {
+                messages[i].push_back(receivers[i]->get_last_message());
+            }
+        }
+    }
+
+    for (const auto& received : messages) {
+        expect_same_messages(expected, received);
+    }
+}
+
+TEST(MAVLinkReceiver, CountsLinkStats)
+{
+    auto stream = make_stream();
+
+    LinkStats link_stats;
+    MAVLinkReceiver receiver(&link_stats);
+    receiver.set_new_datagram(stream.data(), static_cast<unsigned>(stream.size()));
+    while (receiver.parse_message()) {}
+
+    const auto stats = link_stats.stats();
+    EXPECT_EQ(stats.link.bytes_received, stream.size());
+    EXPECT_EQ(stats.link.messages_received, 5);
+    EXPECT_GE(stats.crc_errors, 1);
+
+    ASSERT_EQ(stats.systems.size(), 2);
+    EXPECT_EQ(stats.systems[0].system_id, 1);
+    EXPECT_EQ(stats.systems[0].link.messages_received, 3);
+    EXPECT_EQ(stats.systems[1].system_id, 2);
+    EXPECT_EQ(stats.systems[1].link.messages_received, 2);
+}
@@ -0,0 +1,180 @@
+#include "mavlink_signing.h"
+#include "sha256.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace mavsdk {
+
+namespace {
+
+constexpr std::size_t TIMESTAMP_LEN = 6;
+constexpr std::size_t SIGNATURE_LEN = 6;
+
+uint64_t read_timestamp(const uint8_t* signature)
+{
+    // Little endian, right after the link ID.
+    uint64_t timestamp = 0;
+    for (std::size_t i = 0; i < TIMESTAMP_LEN; ++i) {
+        timestamp |= static_cast<uint64_t>(signature[1 + i]) << (8 * i);
+    }
+    return timestamp;
+}
+
+uint32_t stream_key(const mavlink_message_t& message)
+{
+    return (static_cast<uint32_t>(message.signature[0]) << 16) |
+           (static_cast<uint32_t>(message.sysid) << 8) | message.compid;
+}
+
+} // namespace
+
+MavlinkSigning::MavlinkSigning(const Key& key, bool accept_unsigned, uint64_t min_timestamp) :
+    _key(key),
+    _accept_unsigned(accept_unsigned),
+    _timestamp(std::max(timestamp_now(), min_timestamp))
+{}
+
+uint64_t MavlinkSigning::timestamp_now()
+{
+    // 1 January 2015 GMT in seconds since the Unix epoch.
+    constexpr uint64_t epoch_2015_s = 1420070400;
+
+    const auto since_unix_epoch = std::chrono::system_clock::now().time_since_epoch();
+    const auto ten_us = std::chrono::duration_cast<std::chrono::microseconds>(since_unix_epoch)
+                            .count() /
+                        10;
+    const auto offset = static_cast<int64_t>(epoch_2015_s * 100000);
+    return ten_us > offset ? static_cast<uint64_t>(ten_us - offset) : 0;
+}
+
+uint64_t MavlinkSigning::next_timestamp()
+{
+    // Strictly increasing, even if several messages are signed within 10 us.
+    const uint64_t now = timestamp_now();
+    uint64_t previous = _timestamp.load();
+    uint64_t next;
+    do {
+        next = std::max(now, previous + 1);
+    } while (!_timestamp.compare_exchange_weak(previous, next));
+    return next;
+}
+
+void MavlinkSigning::observe_timestamp(uint64_t timestamp)
+{
+    // If others are ahead of us, e.g. because our clock is off, we follow them.
+    uint64_t previous = _timestamp.load();
+    while (timestamp > previous && !_timestamp.compare_exchange_weak(previous, timestamp)) {
+    }
+}
+
+bool MavlinkSigning::sign(mavlink_message_t& message)
+{
+    if (message.magic != MAVLINK_STX) {
+        return false;
+    }
+
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(message.msgid);
+    if (entry == nullptr) {
+        return false;
+    }
+
+    // The flag is covered by the checksum, so that needs to be redone.
+    message.incompat_flags |= MAVLINK_IFLAG_SIGNED;
+
+    const uint8_t header[MAVLINK_CORE_HEADER_LEN] = {
+        message.len,
+        message.incompat_flags,
+        message.compat_flags,
+        message.seq,
+        message.sysid,
+        message.compid,
+        static_cast<uint8_t>(message.msgid & 0xff),
+        static_cast<uint8_t>((message.msgid >> 8) & 0xff),
+        static_cast<uint8_t>((message.msgid >> 16) & 0xff)};
+
+    uint16_t checksum = crc_calculate(header, sizeof(header));
+    crc_accumulate_buffer(&checksum, _MAV_PAYLOAD(&message), message.len);
+    crc_accumulate(entry->crc_extra, &checksum);
+    message.checksum = checksum;
+
+    const uint64_t timestamp = next_timestamp();
+    message.signature[0] = LINK_ID;
+    for (std::size_t i = 0; i < TIMESTAMP_LEN; ++i) {
+        message.signature[1 + i] = static_cast<uint8_t>(timestamp >> (8 * i));
+    }
+
+    compute_signature(message, _key, &message.signature[1 + TIMESTAMP_LEN]);
+    return true;
+}
+
+bool MavlinkSigning::verify(const mavlink_message_t& message, Streams& streams)
+{
+    if ((message.incompat_flags & MAVLINK_IFLAG_SIGNED) == 0 || message.magic != MAVLINK_STX) {
+        return _accept_unsigned || message.msgid == MAVLINK_MSG_ID_RADIO_STATUS;
+    }
+
+    uint8_t signature[SIGNATURE_LEN];
+    compute_signature(message, _key, signature);
+
+    // Compare all bytes, so the time taken doesn't tell how many matched.
+    uint8_t difference = 0;
+    for (std::size_t i = 0; i < SIGNATURE_LEN; ++i) {
+        difference |= signature[i] ^ message.signature[1 + TIMESTAMP_LEN + i];
+    }
+    if (difference != 0) {
+        return false;
+    }
+
+    // Only now that we know the message is genuine, its stream is looked at.
+    const uint64_t timestamp = read_timestamp(message.signature);
+    const auto it = streams._last_timestamps.find(stream_key(message));
+    if (it != streams._last_timestamps.end()) {
+        if (timestamp <= it->second) {
+            return false;
+        }
+        it->second = timestamp;
+    } else {
+        if (timestamp + MAX_NEW_STREAM_AGE < _timestamp.load() ||
+            streams._last_timestamps.size() >= Streams::MAX_STREAMS) {
+            return false;
+        }
+        streams._last_timestamps.emplace(stream_key(message), timestamp);
+    }
+
+    observe_timestamp(timestamp);
+    return true;
+}
+
+void MavlinkSigning::compute_signature(
+    const mavlink_message_t& message, const Key& key, uint8_t* out)
+{
+    // SHA-256 over key, header, payload, checksum, link ID and timestamp, of
+    // which the first 48 bits are the signature.
+    const uint8_t header[MAVLINK_CORE_HEADER_LEN + 1] = {
+        message.magic,
+        message.len,
+        message.incompat_flags,
+        message.compat_flags,
+        message.seq,
+        message.sysid,
+        message.compid,
+        static_cast<uint8_t>(message.msgid & 0xff),
+        static_cast<uint8_t>((message.msgid >> 8) & 0xff),
+        static_cast<uint8_t>((message.msgid >> 16) & 0xff)};
+    const uint8_t checksum[2] = {
+        static_cast<uint8_t>(message.checksum & 0xff), static_cast<uint8_t>(message.checksum >> 8)};
+
+    Sha256 sha256;
+    sha256.update(key.data(), key.size());
+    sha256.update(header, sizeof(header));
+    sha256.update(reinterpret_cast<const uint8_t*>(_MAV_PAYLOAD(&message)), message.len);
+    sha256.update(checksum, sizeof(checksum));
+    sha256.update(message.signature, 1 + TIMESTAMP_LEN);
+
+    const auto digest = sha256.finish();
+    std::memcpy(out, digest.data(), SIGNATURE_LEN);
+}
+
+} // namespace mavsdk
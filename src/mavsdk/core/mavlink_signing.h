@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include "mavlink_include.h"
+
+namespace mavsdk {
+
+// MAVLink 2 message signing.
+//
+// Outgoing messages are signed with the secret key and a timestamp that only
+// ever increases. Incoming messages are only accepted with a valid signature,
+// and only if their timestamp is newer than the last one seen from the same
+// stream (link ID, system and component ID), so recorded messages can't be
+// replayed. The last timestamps are kept per connection, see Streams.
+//
+// The signature is a SHA-256 over the key and the frame, see Sha256.
+class MavlinkSigning {
+public:
+    using Key = std::array<uint8_t, 32>;
+
+    // Link ID of all messages we sign. Our timestamp increases across all
+    // connections, so one stream is enough.
+    static constexpr uint8_t LINK_ID = 0;
+
+    // How far behind our timestamp a stream we haven't seen before can be.
+    static constexpr uint64_t MAX_NEW_STREAM_AGE = 60 * 100000; // 1 min in 10 us.
+
+    // The last timestamps by stream of one connection. Only to be used by the
+    // thread receiving on that connection.
+    class Streams {
+    public:
+        // More than enough for a few dozen systems, it limits the memory
+        // spoofed streams can take.
+        static constexpr std::size_t MAX_STREAMS = 1024;
+
+    private:
+        friend class MavlinkSigning;
+        std::unordered_map<uint32_t, uint64_t> _last_timestamps{};
+    };
+
+    // Unsigned messages are dropped unless accept_unsigned is set, except for
+    // RADIO_STATUS which radios inject into the stream and can't sign.
+    // Timestamps start at min_timestamp if that is later than now, so
+    // changing the key doesn't go back in time.
+    MavlinkSigning(const Key& key, bool accept_unsigned, uint64_t min_timestamp = 0);
+
+    // Signs a finalized message in place, so it's sent signed. MAVLink 1
+    // messages and messages unknown to the dialect can't be signed.
+    bool sign(mavlink_message_t& message);
+
+    // Whether the message should be accepted, and if so remembers its
+    // timestamp for its stream.
+    bool verify(const mavlink_message_t& message, Streams& streams);
+
+    [[nodiscard]] uint64_t timestamp() const { return _timestamp.load(); }
+
+    // Now in 10 us since 1 January 2015 GMT, as used by signing.
+    static uint64_t timestamp_now();
+
+private:
+    static void compute_signature(const mavlink_message_t& message, const Key& key, uint8_t* out);
+    uint64_t next_timestamp();
+    void observe_timestamp(uint64_t timestamp);
+
+    const Key _key;
+    const bool _accept_unsigned;
+    std::atomic<uint64_t> _timestamp;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,147 @@
+#include "mavlink_signing.h"
+#include "mavlink_receiver.h"
+
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+MavlinkSigning::Key test_key(uint8_t seed = 1)
+{
+    MavlinkSigning::Key key;
+    for (std::size_t i = 0; i < key.size(); ++i) {
+        key[i] = static_cast<uint8_t>(seed + i);
+    }
+    return key;
+}
+
+mavlink_message_t heartbeat()
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(1, MAV_COMP_ID_AUTOPILOT1, &message, MAV_TYPE_QUADROTOR, 0, 0, 0, 0);
+    return message;
+}
+
+// Serialized and parsed again, as it arrives on the other end.
+mavlink_message_t over_the_wire(const mavlink_message_t& message)
+{
+    std::vector<char> buffer(MAVLINK_MAX_PACKET_LEN);
+    buffer.resize(mavlink_msg_to_send_buffer(
+        reinterpret_cast<uint8_t*>(buffer.data()), const_cast<mavlink_message_t*>(&message)));
+
+    MAVLinkReceiver receiver;
+    receiver.set_new_datagram(buffer.data(), static_cast<unsigned>(buffer.size()));
+    EXPECT_TRUE(receiver.parse_message());
+    return receiver.get_last_message();
+}
+
+} // namespace
+
+TEST(MavlinkSigning, SignedMessageIsAccepted)
+{
+    MavlinkSigning sender(test_key(), false);
+    MavlinkSigning receiver(test_key(), false);
+    MavlinkSigning::Streams streams;
+
+    auto message = heartbeat();
+    ASSERT_TRUE(sender.sign(message));
+    EXPECT_TRUE(message.incompat_flags & MAVLINK_IFLAG_SIGNED);
+
+    EXPECT_TRUE(receiver.verify(over_the_wire(message), streams));
+}
+
+TEST(MavlinkSigning, MatchesMavlinkImplementation)
+{
+    MavlinkSigning sender(test_key(), false);
+    auto message = heartbeat();
+    ASSERT_TRUE(sender.sign(message));
+    const auto received = over_the_wire(message);
+
+    mavlink_signing_t signing{};
+    const auto key = test_key();
+    std::copy(key.begin(), key.end(), signing.secret_key);
+    mavlink_signing_streams_t signing_streams{};
+
+    EXPECT_TRUE(mavlink_signature_check(&signing, &signing_streams, &received));
+}
+
+TEST(MavlinkSigning, RejectsReplay)
+{
+    MavlinkSigning sender(test_key(), false);
+    MavlinkSigning receiver(test_key(), false);
+    MavlinkSigning::Streams streams;
+
+    auto first = heartbeat();
+    auto second = heartbeat();
+    ASSERT_TRUE(sender.sign(first));
+    ASSERT_TRUE(sender.sign(second));
+
+    EXPECT_TRUE(receiver.verify(first, streams));
+    EXPECT_TRUE(receiver.verify(second, streams));
+    EXPECT_FALSE(receiver.verify(first, streams));
+    EXPECT_FALSE(receiver.verify(second, streams));
+
+    // Another connection has its own streams.
+    MavlinkSigning::Streams other_streams;
+    EXPECT_TRUE(receiver.verify(second, other_streams));
+}
+
+TEST(MavlinkSigning, RejectsWrongKeyAndTampering)
+{
+    MavlinkSigning sender(test_key(1), false);
+    MavlinkSigning receiver(test_key(2), false);
+    MavlinkSigning::Streams streams;
+
+    auto message = heartbeat();
+    ASSERT_TRUE(sender.sign(message));
+    EXPECT_FALSE(receiver.verify(message, streams));
+
+    MavlinkSigning same_key_receiver(test_key(1), false);
+    message.seq++;
+    EXPECT_FALSE(same_key_receiver.verify(message, streams));
+}
+
+TEST(MavlinkSigning, RejectsOldNewStream)
+{
+    const MavlinkSigning::Key key = test_key();
+    MavlinkSigning sender(key, false);
+    const uint64_t ahead = MavlinkSigning::timestamp_now() + 2 * MavlinkSigning::MAX_NEW_STREAM_AGE;
+    MavlinkSigning receiver(key, false, ahead);
+    MavlinkSigning::Streams streams;
+
+    auto message = heartbeat();
+    ASSERT_TRUE(sender.sign(message));
+    EXPECT_FALSE(receiver.verify(message, streams));
+}
+
+TEST(MavlinkSigning, UnsignedMessages)
+{
+    MavlinkSigning strict(test_key(), false);
+    MavlinkSigning lenient(test_key(), true);
+    MavlinkSigning::Streams streams;
+
+    EXPECT_FALSE(strict.verify(heartbeat(), streams));
+    EXPECT_TRUE(lenient.verify(heartbeat(), streams));
+
+    mavlink_message_t radio_status;
+    mavlink_msg_radio_status_pack(51, 68, &radio_status, 200, 190, 80, 30, 20, 0, 0);
+    EXPECT_TRUE(strict.verify(radio_status, streams));
+}
+
+TEST(MavlinkSigning, TimestampsIncrease)
+{
+    MavlinkSigning signing(test_key(), false);
+    const uint64_t before = signing.timestamp();
+
+    auto first = heartbeat();
+    auto second = heartbeat();
+    ASSERT_TRUE(signing.sign(first));
+    ASSERT_TRUE(signing.sign(second));
+
+    EXPECT_GE(signing.timestamp(), before + 1);
+    EXPECT_NE(
+        std::vector<uint8_t>(first.signature + 1, first.signature + 7),
+        std::vector<uint8_t>(second.signature + 1, second.signature + 7));
+}
@@ -3,38 +3,91 @@
 
 namespace mavsdk {
 
-std::optional<MavlinkStatustextHandler::Statustext>
-MavlinkStatustextHandler::process(const mavlink_statustext_t& statustext)
+std::optional<MavlinkStatustextHandler::Statustext> MavlinkStatustextHandler::process(
+    const mavlink_statustext_t& statustext, uint8_t system_id, uint8_t component_id)
 {
     char text_with_null[sizeof(statustext.text) + 1]{};
     strncpy(text_with_null, statustext.text, sizeof(text_with_null) - 1);
     auto severity = static_cast<MAV_SEVERITY>(statustext.severity);
 
+    std::lock_guard<std::mutex> lock(_mutex);
+
     if (statustext.id > 0) {
-        if (statustext.id != _last_id) {
-            _temp_multi_str = "";
-            _last_chunk_seq = 0;
-            _last_id = statustext.id;
+        const auto now = _time.steady_time();
+
+        // Whatever didn't complete by now won't anymore.
+        for (auto it = _assemblies.begin(); it != _assemblies.end();) {
+            if (_time.elapsed_since_s(it->second.last_chunk_time) > ASSEMBLY_TIMEOUT_S) {
+                it = _assemblies.erase(it);
+            } else {
+                ++it;
+            }
         }
 
+        auto& assembly = _assemblies[{system_id, component_id, statustext.id}];
+        assembly.last_chunk_time = now;
+
         // We can recover from missing chunks in-between but not if the first or last one is lost.
-        if (_last_chunk_seq + 1 < statustext.chunk_seq) {
-            _temp_multi_str += "[ missing ... ]";
+        if (assembly.last_chunk_seq + 1 < statustext.chunk_seq) {
+            assembly.text += "[ missing ... ]";
         }
 
-        _last_chunk_seq = statustext.chunk_seq;
+        assembly.last_chunk_seq = statustext.chunk_seq;
 
-        _temp_multi_str += text_with_null;
+        assembly.text += text_with_null;
 
         if (strlen(text_with_null) == sizeof(statustext.text)) {
             // No zero termination yet, keep going.
             return std::nullopt;
-        } else {
-            return Statustext{_temp_multi_str, severity};
         }
+
+        auto text = std::move(assembly.text);
+        _assemblies.erase({system_id, component_id, statustext.id});
+        return coalesce(std::move(text), severity, system_id, component_id);
     }
 
-    return Statustext{text_with_null, severity};
+    return coalesce(text_with_null, severity, system_id, component_id);
+}
+
+std::optional<MavlinkStatustextHandler::Statustext> MavlinkStatustextHandler::coalesce(
+    std::string text, MAV_SEVERITY severity, uint8_t system_id, uint8_t component_id)
+{
+    const auto [it, inserted] = _recent.try_emplace(
+        {system_id, component_id, static_cast<uint8_t>(severity), text}, Recent{});
+    auto& recent = it->second;
+
+    if (!inserted && _time.elapsed_since_s(recent.window_start) < COALESCE_WINDOW_S) {
+        ++recent.coalesced;
+        return std::nullopt;
+    }
+
+    // If flush() wasn't called in time, the ones coalesced are reported with
+    // this one.
+    const uint32_t count = recent.coalesced + 1;
+    recent.window_start = _time.steady_time();
+    recent.coalesced = 0;
+    return Statustext{std::move(text), severity, count};
+}
+
+std::vector<MavlinkStatustextHandler::Statustext> MavlinkStatustextHandler::flush()
+{
+    std::vector<Statustext> flushed;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto it = _recent.begin(); it != _recent.end();) {
+        if (_time.elapsed_since_s(it->second.window_start) < COALESCE_WINDOW_S) {
+            ++it;
+            continue;
+        }
+        if (it->second.coalesced > 0) {
+            flushed.push_back(Statustext{
+                std::get<3>(it->first),
+                static_cast<MAV_SEVERITY>(std::get<2>(it->first)),
+                it->second.coalesced});
+        }
+        it = _recent.erase(it);
+    }
+    return flushed;
 }
 
 std::string MavlinkStatustextHandler::severity_str(MAV_SEVERITY severity)
@@ -1,29 +1,80 @@
 #pragma once
 
 #include "mavlink_include.h"
+#include "mavsdk_time.h"
+#include <cstdint>
+#include <map>
+#include <mutex>
 #include <string>
 #include <optional>
+#include <tuple>
+#include <vector>
 
 namespace mavsdk {
 
+// Reassembles statustexts sent in chunks, separately for each sender, and
+// coalesces floods of the same text.
+//
+// When a sensor fails, autopilots can send the same text many times a
+// second, from several components. The first one of a text is passed on
+// right away, identical ones from the same component within the window are
+// only counted, and reported as one with the count once the window is over.
+// This way, an error storm can't saturate the callbacks and hide the rest.
 class MavlinkStatustextHandler {
 public:
-    MavlinkStatustextHandler() = default;
+    MavlinkStatustextHandler() : _time(_own_time) {}
+    explicit MavlinkStatustextHandler(Time& time) : _time(time) {}
     ~MavlinkStatustextHandler() = default;
 
+    // Non-copyable
+    MavlinkStatustextHandler(const MavlinkStatustextHandler&) = delete;
+    const MavlinkStatustextHandler& operator=(const MavlinkStatustextHandler&) = delete;
+
+    static constexpr double COALESCE_WINDOW_S = 1.0;
+
     struct Statustext {
         std::string text;
         MAV_SEVERITY severity;
+        // How many identical texts this stands for, more than 1 if some
+        // were coalesced.
+        uint32_t count{1};
     };
 
-    std::optional<Statustext> process(const mavlink_statustext_t& statustext);
+    std::optional<Statustext> process(
+        const mavlink_statustext_t& statustext, uint8_t system_id = 0, uint8_t component_id = 0);
+
+    // Texts which were coalesced and whose window is over, to be called
+    // regularly.
+    std::vector<Statustext> flush();
 
     static std::string severity_str(MAV_SEVERITY severity);
 
 private:
-    std::string _temp_multi_str{};
-    uint16_t _last_id{0};
-    uint8_t _last_chunk_seq{0};
+    // Chunks of a long text which didn't complete within this long are dropped.
+    static constexpr double ASSEMBLY_TIMEOUT_S = 5.0;
+
+    struct Assembly {
+        std::string text{};
+        uint8_t last_chunk_seq{0};
+        dl_time_t last_chunk_time{};
+    };
+
+    struct Recent {
+        dl_time_t window_start{};
+        uint32_t coalesced{0};
+    };
+
+    std::optional<Statustext> coalesce(
+        std::string text, MAV_SEVERITY severity, uint8_t system_id, uint8_t component_id);
+
+    Time _own_time{};
+    Time& _time;
+
+    std::mutex _mutex{};
+    // By system ID, component ID and statustext ID.
+    std::map<std::tuple<uint8_t, uint8_t, uint16_t>, Assembly> _assemblies{};
+    // By system ID, component ID, severity and text.
+    std::map<std::tuple<uint8_t, uint8_t, uint8_t, std::string>, Recent> _recent{};
 };
 
 } // namespace mavsdk
@@ -260,6 +260,91 @@ TEST(MavlinkStatustextHandler, MultiStatustextConsecutive)
     }
 }
 
+TEST(MavlinkStatustextHandler, MultiStatustextFromSeveralComponents)
+{
+    MavlinkStatustextHandler handler;
+
+    // Both components use the same ID and interleave their chunks.
+    const auto make_chunk = [](const std::string& chunk, uint8_t chunk_seq) {
+        mavlink_statustext_t statustext{};
+        strncpy(statustext.text, chunk.c_str(), sizeof(statustext.text));
+        statustext.id = 7;
+        statustext.chunk_seq = chunk_seq;
+        return statustext;
+    };
+
+    const std::string first_a(sizeof(mavlink_statustext_t::text), 'a');
+    const std::string first_b(sizeof(mavlink_statustext_t::text), 'b');
+
+    EXPECT_FALSE(handler.process(make_chunk(first_a, 0), 1, 1));
+    EXPECT_FALSE(handler.process(make_chunk(first_b, 0), 1, 2));
+
+    const auto result_a = handler.process(make_chunk("end a", 1), 1, 1);
+    ASSERT_TRUE(result_a);
+    EXPECT_EQ(result_a.value().text, first_a + "end a");
+
+    const auto result_b = handler.process(make_chunk("end b", 1), 1, 2);
+    ASSERT_TRUE(result_b);
+    EXPECT_EQ(result_b.value().text, first_b + "end b");
+}
+
+TEST(MavlinkStatustextHandler, CoalescesFloods)
+{
+    FakeTime time;
+    MavlinkStatustextHandler handler{time};
+
+    mavlink_statustext_t statustext{};
+    strncpy(statustext.text, "Baro failure", sizeof(statustext.text) - 1);
+    statustext.severity = MAV_SEVERITY_CRITICAL;
+
+    // The first one goes through right away, the others within the window
+    // are only counted.
+    const auto first = handler.process(statustext, 1, 1);
+    ASSERT_TRUE(first);
+    EXPECT_EQ(first.value().count, 1u);
+    for (int i = 0; i < 10; ++i) {
+        time.sleep_for(std::chrono::milliseconds(50));
+        EXPECT_FALSE(handler.process(statustext, 1, 1));
+    }
+
+    // Another component with the same text isn't coalesced with it.
+    EXPECT_TRUE(handler.process(statustext, 1, 2));
+
+    EXPECT_TRUE(handler.flush().empty());
+    time.sleep_for(std::chrono::milliseconds(600));
+
+    const auto flushed = handler.flush();
+    ASSERT_EQ(flushed.size(), 1u);
+    EXPECT_EQ(flushed[0].text, "Baro failure");
+    EXPECT_EQ(flushed[0].severity, MAV_SEVERITY_CRITICAL);
+    EXPECT_EQ(flushed[0].count, 10u);
+
+    // Once the storm is over, the next one goes through again.
+    const auto next = handler.process(statustext, 1, 1);
+    ASSERT_TRUE(next);
+    EXPECT_EQ(next.value().count, 1u);
+}
+
+TEST(MavlinkStatustextHandler, ReportsCoalescedWithNextWithoutFlush)
+{
+    FakeTime time;
+    MavlinkStatustextHandler handler{time};
+
+    mavlink_statustext_t statustext{};
+    strncpy(statustext.text, "GPS glitch", sizeof(statustext.text) - 1);
+
+    ASSERT_TRUE(handler.process(statustext));
+    EXPECT_FALSE(handler.process(statustext));
+    EXPECT_FALSE(handler.process(statustext));
+
+    time.sleep_for(std::chrono::milliseconds(1100));
+
+    const auto result = handler.process(statustext);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value().count, 3u);
+    EXPECT_TRUE(handler.flush().empty());
+}
+
 #if defined(__GNUC__)
 #pragma GCC diagnostic pop
 #endif // defined(__GNUC__)
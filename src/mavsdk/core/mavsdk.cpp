@@ -1,12 +1,17 @@
 #include "mavsdk.h"
 
+#include "allocation_tracker.h"
 #include "mavsdk_impl.h"
+#include "runtime_impl.h"
+#include "trace.h"
 
 namespace mavsdk {
 
-Mavsdk::Mavsdk()
+Mavsdk::Mavsdk() : Mavsdk(Configuration{Configuration::UsageType::GroundStation}) {}
+
+Mavsdk::Mavsdk(Configuration configuration)
 {
-    _impl = std::make_shared<MavsdkImpl>();
+    _impl = std::make_shared<MavsdkImpl>(configuration);
 }
 
 Mavsdk::~Mavsdk() = default;
@@ -79,6 +84,108 @@ void Mavsdk::subscribe_on_new_system(const NewSystemCallback& callback)
     _impl->subscribe_on_new_system(callback);
 }
 
+Mavsdk::CallbackQueueStats Mavsdk::callback_queue_stats() const
+{
+    return _impl->callback_queue_stats();
+}
+
+std::vector<Mavsdk::MessageLatencyStats> Mavsdk::message_latency_stats() const
+{
+    return _impl->message_latency_stats();
+}
+
+void Mavsdk::reset_message_latency_stats()
+{
+    _impl->reset_message_latency_stats();
+}
+
+void Mavsdk::enable_callback_duration_stats(bool enabled)
+{
+    _impl->enable_callback_duration_stats(enabled);
+}
+
+std::vector<Mavsdk::CallbackDurationStats> Mavsdk::callback_duration_stats() const
+{
+    return _impl->callback_duration_stats();
+}
+
+void Mavsdk::reset_callback_duration_stats()
+{
+    _impl->reset_callback_duration_stats();
+}
+
+void Mavsdk::start_tracing()
+{
+    Trace::instance().start();
+}
+
+void Mavsdk::stop_tracing()
+{
+    Trace::instance().stop();
+}
+
+bool Mavsdk::write_trace(const std::string& path) const
+{
+    return Trace::instance().export_json(path);
+}
+
+Mavsdk::AllocationStats Mavsdk::allocation_stats() const
+{
+    const auto regions_of = [](const AllocationTracker::Counts& counts) {
+        std::vector<RegionAllocationStats> regions;
+        for (std::size_t i = 0; i < AllocationTracker::NUM_REGIONS; ++i) {
+            regions.push_back(RegionAllocationStats{
+                AllocationTracker::region_name(static_cast<AllocationRegion>(i)),
+                counts.allocations[i],
+                counts.bytes[i]});
+        }
+        return regions;
+    };
+
+    AllocationStats stats;
+    stats.enabled = AllocationTracker::enabled();
+    if (!stats.enabled) {
+        return stats;
+    }
+
+    stats.regions = regions_of(AllocationTracker::total());
+    for (const auto& thread : AllocationTracker::threads()) {
+        stats.threads.push_back(
+            ThreadAllocationStats{thread.thread_number, regions_of(thread.counts)});
+    }
+    return stats;
+}
+
+void Mavsdk::reset_allocation_stats()
+{
+    AllocationTracker::reset();
+}
+
+void Mavsdk::enable_signing(const SigningKey& key, bool accept_unsigned)
+{
+    _impl->enable_signing(key, accept_unsigned);
+}
+
+void Mavsdk::disable_signing()
+{
+    _impl->disable_signing();
+}
+
+std::vector<Mavsdk::ConnectionStats> Mavsdk::connection_stats() const
+{
+    return _impl->connection_stats();
+}
+
+void Mavsdk::subscribe_send_congestion(const SendCongestionCallback& callback)
+{
+    _impl->subscribe_send_congestion(callback);
+}
+
+bool Mavsdk::is_send_congested() const
+{
+    return _impl->is_send_congested();
+}
+
 Mavsdk::Configuration::Configuration(
     uint8_t system_id, uint8_t component_id, bool always_send_heartbeats) :
     _system_id(system_id),
@@ -177,4 +284,216 @@ void Mavsdk::Configuration::set_usage_type(Mavsdk::Configuration::UsageType usag
     _usage_type = usage_type;
 }
 
+std::size_t Mavsdk::Configuration::get_callback_queue_capacity() const
+{
+    return _callback_queue_capacity;
+}
+
+void Mavsdk::Configuration::set_callback_queue_capacity(std::size_t capacity)
+{
+    _callback_queue_capacity = capacity;
+}
+
+Mavsdk::Configuration::CallbackOverflowPolicy
+Mavsdk::Configuration::get_callback_overflow_policy() const
+{
+    return _callback_overflow_policy;
+}
+
+void Mavsdk::Configuration::set_callback_overflow_policy(CallbackOverflowPolicy policy)
+{
+    _callback_overflow_policy = policy;
+}
+
+unsigned Mavsdk::Configuration::get_callback_threads() const
+{
+    return _callback_threads;
+}
+
+void Mavsdk::Configuration::set_callback_threads(unsigned num_threads)
+{
+    _callback_threads = num_threads;
+}
+
+Mavsdk::Configuration::CallbackOrdering Mavsdk::Configuration::get_callback_ordering() const
+{
+    return _callback_ordering;
+}
+
+void Mavsdk::Configuration::set_callback_ordering(CallbackOrdering ordering)
+{
+    _callback_ordering = ordering;
+}
+
+unsigned Mavsdk::Configuration::get_dispatch_threads() const
+{
+    return _dispatch_threads;
+}
+
+void Mavsdk::Configuration::set_dispatch_threads(unsigned num_threads)
+{
+    _dispatch_threads = num_threads;
+}
+
+std::string Mavsdk::Configuration::get_param_cache_directory() const
+{
+    return _param_cache_directory;
+}
+
+void Mavsdk::Configuration::set_param_cache_directory(std::string directory)
+{
+    _param_cache_directory = std::move(directory);
+}
+
+bool Mavsdk::Configuration::get_serial_send_scheduling() const
+{
+    return _serial_send_scheduling;
+}
+
+void Mavsdk::Configuration::set_serial_send_scheduling(bool enabled)
+{
+    _serial_send_scheduling = enabled;
+}
+
+bool Mavsdk::Configuration::get_serial_low_latency() const
+{
+    return _serial_low_latency;
+}
+
+void Mavsdk::Configuration::set_serial_low_latency(bool enabled)
+{
+    _serial_low_latency = enabled;
+}
+
+double Mavsdk::Configuration::get_write_coalescing_delay_s() const
+{
+    return _write_coalescing_delay_s;
+}
+
+void Mavsdk::Configuration::set_write_coalescing_delay_s(double delay_s)
+{
+    _write_coalescing_delay_s = delay_s;
+}
+
+std::size_t Mavsdk::Configuration::get_send_queue_bytes() const
+{
+    return _send_queue_bytes;
+}
+
+void Mavsdk::Configuration::set_send_queue_bytes(std::size_t bytes)
+{
+    _send_queue_bytes = bytes;
+}
+
+bool Mavsdk::Configuration::get_tcp_no_delay() const
+{
+    return _tcp_no_delay;
+}
+
+void Mavsdk::Configuration::set_tcp_no_delay(bool no_delay)
+{
+    _tcp_no_delay = no_delay;
+}
+
+std::string Mavsdk::Configuration::get_capture_path() const
+{
+    return _capture_path;
+}
+
+void Mavsdk::Configuration::set_capture_path(std::string path)
+{
+    _capture_path = std::move(path);
+}
+
+Mavsdk::Configuration::LinkBonding Mavsdk::Configuration::get_link_bonding() const
+{
+    return _link_bonding;
+}
+
+void Mavsdk::Configuration::set_link_bonding(LinkBonding link_bonding)
+{
+    _link_bonding = link_bonding;
+}
+
+double Mavsdk::Configuration::get_request_message_cache_ttl_s() const
+{
+    return _request_message_cache_ttl_s;
+}
+
+void Mavsdk::Configuration::set_request_message_cache_ttl_s(double ttl_s)
+{
+    _request_message_cache_ttl_s = ttl_s;
+}
+
+bool Mavsdk::Configuration::get_message_latency_stats() const
+{
+    return _message_latency_stats;
+}
+
+void Mavsdk::Configuration::set_message_latency_stats(bool enabled)
+{
+    _message_latency_stats = enabled;
+}
+
+Mavsdk::Configuration::ThreadSettings
+Mavsdk::Configuration::get_thread_settings(ThreadRole role) const
+{
+    return _thread_settings[static_cast<std::size_t>(role)];
+}
+
+void Mavsdk::Configuration::set_thread_settings(ThreadRole role, ThreadSettings settings)
+{
+    _thread_settings[static_cast<std::size_t>(role)] = std::move(settings);
+}
+
+std::string Mavsdk::Configuration::get_thread_name_prefix() const
+{
+    return _thread_name_prefix;
+}
+
+void Mavsdk::Configuration::set_thread_name_prefix(std::string prefix)
+{
+    _thread_name_prefix = std::move(prefix);
+}
+
+std::shared_ptr<Mavsdk::Runtime> Mavsdk::Configuration::get_runtime() const
+{
+    return _runtime;
+}
+
+void Mavsdk::Configuration::set_runtime(std::shared_ptr<Runtime> runtime)
+{
+    _runtime = std::move(runtime);
+}
+
+bool Mavsdk::Configuration::get_low_memory() const
+{
+    return _low_memory;
+}
+
+void Mavsdk::Configuration::set_low_memory(bool low_memory)
+{
+    _low_memory = low_memory;
+    if (!low_memory) {
+        return;
+    }
+
+    for (auto& settings : _thread_settings) {
+        if (settings.stack_size_bytes == 0) {
+            settings.stack_size_bytes = LOW_MEMORY_STACK_SIZE_BYTES;
+        }
+    }
+    _callback_threads = 1;
+    _dispatch_threads = 0;
+}
+
+Mavsdk::Runtime::Runtime(const Configuration& configuration) :
+    _impl(std::make_shared<RuntimeImpl>(
+        configuration,
+        MavsdkImpl::num_system_work_threads(configuration),
+        MavsdkImpl::num_background_threads(configuration)))
+{}
+
+Mavsdk::Runtime::~Runtime() = default;
+
 } // namespace mavsdk
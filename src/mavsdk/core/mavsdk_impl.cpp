@@ -5,11 +5,19 @@
 
 #include "connection.h"
 #include "tcp_connection.h"
+#include "tcp_server_connection.h"
 #include "udp_connection.h"
 #include "system.h"
 #include "system_impl.h"
+#ifdef MAVSDK_WITH_HTTP
+#include "http_loader.h"
+#endif
 #include "serial_connection.h"
+#include "replay_connection.h"
+#include "allocation_tracker.h"
 #include "cli_arg.h"
+#include "io_reactor.h"
+#include "trace.h"
 #include "version.h"
 #include "unused.h"
 
@@ -23,10 +31,19 @@ mavlink_status_t* mavlink_get_channel_status(uint8_t chan)
 
 namespace mavsdk {
 
-MavsdkImpl::MavsdkImpl() : timeout_handler(_time), call_every_handler(_time)
+MavsdkImpl::MavsdkImpl(const Mavsdk::Configuration& configuration) :
+    timeout_handler(_time),
+    call_every_handler(_time),
+    periodic_messages(
+        call_every_handler, [this](mavlink_message_t& message) { return send_message(message); }),
+    _configuration(configuration)
 {
     LogInfo() << "MAVSDK version: " << mavsdk_version;
 
+    // New systems are discovered by their heartbeats, even before there is a
+    // system to handle them.
+    _message_id_filter.add(MAVLINK_MSG_ID_HEARTBEAT);
+
     if (const char* env_p = std::getenv("MAVSDK_CALLBACK_DEBUGGING")) {
         if (std::string(env_p) == "1") {
             LogDebug() << "Callback debugging is on.";
@@ -41,31 +58,183 @@ MavsdkImpl::MavsdkImpl() : timeout_handler(_time), call_every_handler(_time)
         }
     }
 
-    _work_thread = new std::thread(&MavsdkImpl::work_thread, this);
+    if (const auto runtime = _configuration.get_runtime()) {
+        _runtime = runtime->_impl;
+    }
+
+    _message_latency.set_enabled(_configuration.get_message_latency_stats());
+
+    if (_runtime) {
+        _system_work_pool = &_runtime->work_pool();
+    } else {
+        _own_system_work_pool = std::make_unique<ThreadPool>(
+            num_system_work_threads(_configuration),
+            ThreadSetup::for_role(
+                _configuration, Mavsdk::Configuration::ThreadRole::Worker, "work"));
+        _system_work_pool = _own_system_work_pool.get();
+    }
+
+    ThreadPool* background_pool = nullptr;
+    if (_runtime) {
+        background_pool = &_runtime->background_pool();
+    } else {
+        _own_background_pool = std::make_unique<ThreadPool>(
+            num_background_threads(_configuration),
+            ThreadSetup::for_role(
+                _configuration, Mavsdk::Configuration::ThreadRole::Worker, "bg"));
+        background_pool = _own_background_pool.get();
+    }
+    _background_work = std::make_unique<BackgroundWork>(
+        *background_pool, [this](BackgroundWork::Completion completion, const void* origin) {
+            call_user_callback_located(FILENAME, __LINE__, std::move(completion), origin);
+        });
+
+    // The work thread sleeps until the next timer is due, so it needs to be
+    // woken up when a new timer is added that might be due earlier.
+    if (_runtime) {
+        timeout_handler.set_wakeup_callback([this]() { _runtime->wake_timer(); });
+        call_every_handler.set_wakeup_callback([this]() { _runtime->wake_timer(); });
+        _runtime_timer_handle = _runtime->add_timer_work([this]() { return run_timers(); });
+    } else {
+        timeout_handler.set_wakeup_callback([this]() { wake_work_thread(); });
+        call_every_handler.set_wakeup_callback([this]() { wake_work_thread(); });
+
+        const auto timer_thread_setup = ThreadSetup::for_role(
+            _configuration, Mavsdk::Configuration::ThreadRole::Timer, "timer");
+        _work_thread = new NativeThread(
+            timer_thread_setup.settings.stack_size_bytes,
+            [this, timer_thread_setup]() { work_thread(timer_thread_setup); });
+    }
+
+    // With a runtime, there is a queue per thread of the runtime, as if we
+    // had as many callback threads of our own.
+    const unsigned num_callback_threads =
+        _runtime ? static_cast<unsigned>(_runtime->callback_executor().num_threads()) :
+                   std::max(1u, _configuration.get_callback_threads());
+    _callback_watchdog = std::make_unique<CallbackWatchdog>(num_callback_threads);
+    for (unsigned i = 0; i < num_callback_threads; ++i) {
+        _user_callback_queues.push_back(std::make_unique<UserCallbackQueue>(
+            _configuration.get_callback_queue_capacity(),
+            _configuration.get_callback_overflow_policy()));
+    }
+    if (_runtime) {
+        for (auto& queue : _user_callback_queues) {
+            _runtime_callback_handles.push_back(_runtime->callback_executor().attach(
+                *queue,
+                [this, &queue = *queue](std::vector<UserCallback>& batch, std::size_t index) {
+                    run_user_callbacks(queue, batch, index);
+                }));
+        }
+    } else {
+        const auto callback_thread_setup = ThreadSetup::for_role(
+            _configuration, Mavsdk::Configuration::ThreadRole::Callback, "cb");
+        for (std::size_t i = 0; i < _user_callback_queues.size(); ++i) {
+            _process_user_callbacks_threads.emplace_back(
+                callback_thread_setup.settings.stack_size_bytes,
+                [this,
+                 &queue = *_user_callback_queues[i],
+                 i,
+                 setup = callback_thread_setup.with_index(i)]() {
+                    process_user_callbacks_thread(queue, i, setup);
+                });
+        }
+    }
+
+#if defined(LINUX)
+    // The reactor serving the connections is shared by all instances, it
+    // takes on the setup of the one created last.
+    IoReactor::instance().add_timer(
+        0.0,
+        [setup = ThreadSetup::for_role(
+             _configuration, Mavsdk::Configuration::ThreadRole::Io, "io")]() { setup.apply(); });
+#endif
+
+    if (_configuration.get_always_send_heartbeats()) {
+        start_sending_heartbeats();
+    }
+
+    call_every_handler.add(
+        [this]() { update_link_stats_rates(); }, LINK_STATS_UPDATE_INTERVAL_S, &_link_stats_cookie);
+
+    call_every_handler.add(
+        [this]() { check_heartbeat_timeouts(); },
+        HEARTBEAT_CHECK_INTERVAL_S,
+        &_heartbeat_check_cookie);
+
+    call_every_handler.add(
+        [this]() { check_callback_watchdog(); },
+        CALLBACK_WATCHDOG_INTERVAL_S,
+        &_callback_watchdog_cookie);
 
-    _process_user_callbacks_thread =
-        new std::thread(&MavsdkImpl::process_user_callbacks_thread, this);
+    if (_configuration.get_link_bonding() != Mavsdk::Configuration::LinkBonding::Off) {
+        _link_bonding = std::make_unique<LinkBonding>(_configuration.get_link_bonding());
+    }
+
+    if (_configuration.get_dispatch_threads() > 0) {
+        _receive_pipeline = std::make_unique<ReceivePipeline>(
+            _configuration.get_dispatch_threads(),
+            RECEIVE_QUEUE_CAPACITY,
+            [this](const std::shared_ptr<mavlink_message_t>& message, uint64_t receive_time_ns) {
+                const MessageLatency::DispatchScope dispatch_scope{message->msgid, receive_time_ns};
+                const MessagePool::DispatchScope message_scope{message};
+                dispatch_to_system(*message);
+            },
+            ThreadSetup::for_role(
+                _configuration, Mavsdk::Configuration::ThreadRole::Dispatch, "disp"));
+    }
 }
 
 MavsdkImpl::~MavsdkImpl()
 {
-    call_every_handler.remove(_heartbeat_send_cookie);
+    periodic_messages.remove(_heartbeat_send_cookie);
+    call_every_handler.remove(_link_stats_cookie);
+    call_every_handler.remove(_heartbeat_check_cookie);
+    call_every_handler.remove(_callback_watchdog_cookie);
 
     _should_exit = true;
 
-    if (_process_user_callbacks_thread != nullptr) {
-        _user_callback_queue.stop();
-        _process_user_callbacks_thread->join();
-        delete _process_user_callbacks_thread;
-        _process_user_callbacks_thread = nullptr;
+    // Before the callback queues, dispatching still queues callbacks.
+    if (_receive_pipeline) {
+        _receive_pipeline->stop();
+    }
+
+    // The same goes for background work finishing.
+    _background_work->stop();
+
+    for (auto& queue : _user_callback_queues) {
+        queue->stop();
+    }
+    for (auto& thread : _process_user_callbacks_threads) {
+        thread.join();
+    }
+    for (const auto handle : _runtime_callback_handles) {
+        _runtime->callback_executor().detach(handle);
+    }
+
+    if (_runtime) {
+        _runtime->remove_timer_work(_runtime_timer_handle);
     }
 
     if (_work_thread != nullptr) {
+        wake_work_thread();
         _work_thread->join();
         delete _work_thread;
         _work_thread = nullptr;
     }
 
+    {
+        std::lock_guard<std::mutex> lock(_systems_mutex);
+        for (auto& entry : _system_table) {
+            entry.store(nullptr);
+        }
+    }
+
+    // Receive threads might still be dispatching to a system they looked up
+    // before, so we wait for them before the systems are destroyed.
+    while (_dispatches_in_flight.load() > 0) {
+        std::this_thread::yield();
+    }
+
     {
         std::lock_guard<std::mutex> lock(_systems_mutex);
         _systems.clear();
@@ -73,7 +242,15 @@ MavsdkImpl::~MavsdkImpl()
 
     {
         std::lock_guard<std::mutex> lock(_connections_mutex);
-        _connections.clear();
+        auto old_connections =
+            std::atomic_exchange(&_connections, std::make_shared<const Connections>());
+
+        // A receive thread might still be sending using the old snapshot. The
+        // connections need to be destroyed here and not by that thread, as
+        // destroying them joins it.
+        while (old_connections.use_count() > 1) {
+            std::this_thread::yield();
+        }
     }
 }
 
@@ -141,16 +318,22 @@ void MavsdkImpl::forward_message(mavlink_message_t& message, Connection* connect
         (message.msgid != MAVLINK_MSG_ID_HEARTBEAT || forward_heartbeats_enabled);
 
     if (!targeted_only_at_us && heartbeat_check_ok) {
-        std::lock_guard<std::mutex> lock(_connections_mutex);
+        const auto connections = std::atomic_load(&_connections);
+        const MavlinkFrame frame(message);
+        const uint64_t routes = routes_for(target_system_id, target_component_id);
 
         unsigned successful_emissions = 0;
-        for (auto& _connection : _connections) {
+        for (auto& _connection : *connections) {
             // Check whether the connection is not the one from which we received the message.
             // And also check if the connection was set to forward messages.
             if (_connection.get() == connection || !(*_connection).should_forward_messages()) {
                 continue;
             }
-            if ((*_connection).send_message(message)) {
+            if (routes != 0 && !_connection->is_on_routes(routes)) {
+                continue;
+            }
+            // Not captured again, it already was when it was received.
+            if ((*_connection).forward(frame)) {
                 successful_emissions++;
             }
         }
@@ -162,6 +345,8 @@ void MavsdkImpl::forward_message(mavlink_message_t& message, Connection* connect
 
 void MavsdkImpl::receive_message(mavlink_message_t& message, Connection* connection)
 {
+    MAVSDK_TRACE_SCOPE("mavlink", "receive_message", message.msgid);
+
     if (_message_logging_on) {
         LogDebug() << "Processing message " << message.msgid << " from "
                    << static_cast<int>(message.sysid) << "/" << static_cast<int>(message.compid);
@@ -177,15 +362,64 @@ void MavsdkImpl::receive_message(mavlink_message_t& message, Connection* connect
      * 2. At least 1 forwarding connection.
      * 3. At least 2 forwarding connections or current connection is not forwarding.
      */
-    if (_connections.size() > 1 && mavsdk::Connection::forwarding_connections_count() > 0 &&
-        (mavsdk::Connection::forwarding_connections_count() > 1 ||
-         !connection->should_forward_messages())) {
+    const bool should_forward = std::atomic_load(&_connections)->size() > 1 &&
+                                mavsdk::Connection::forwarding_connections_count() > 0 &&
+                                (mavsdk::Connection::forwarding_connections_count() > 1 ||
+                                 !connection->should_forward_messages());
+
+    // Nothing here would look at a message nobody has a handler for, so it
+    // is dropped before doing any work for it.
+    const bool is_wanted = _message_id_filter.wants(message.msgid);
+    if (!should_forward && !is_wanted) {
+        if (_message_logging_on) {
+            LogDebug() << "Dropping message " << message.msgid << " without any handler";
+        }
+        return;
+    }
+
+    // Before anything else acts on it, so unsigned or replayed messages can't create
+    // routes or systems, nor get forwarded.
+    if (const auto signing = std::atomic_load(&_signing)) {
+        if (!signing->verify(message, connection->signing_streams())) {
+            connection->link_stats().add_signature_error();
+            if (_message_logging_on) {
+                LogDebug() << "Dropping message " << message.msgid
+                           << " without valid signature";
+            }
+            return;
+        }
+    }
+
+    if (message.sysid != 0) {
+        const uint64_t now_ns = MessageLatency::now_ns();
+
+        // Every connection a system is seen on becomes a route, even if what
+        // arrives over it is only ever a copy.
+        _route_table.learn(message.sysid, message.compid, connection->route_index(), now_ns);
+
+        if (_link_bonding &&
+            !_link_bonding->accept(
+                message.sysid, message.compid, message.seq, connection->route_index(), now_ns)) {
+            if (_message_logging_on) {
+                LogDebug() << "Dropping copy of message " << message.msgid << " from "
+                           << static_cast<int>(message.sysid) << "/"
+                           << static_cast<int>(message.compid);
+            }
+            return;
+        }
+    }
+
+    if (should_forward) {
         if (_message_logging_on) {
             LogDebug() << "Forwarding message " << message.msgid << " from "
                        << static_cast<int>(message.sysid) << "/"
                        << static_cast<int>(message.compid);
         }
         forward_message(message, connection);
+
+        if (!is_wanted) {
+            return;
+        }
     }
 
     // Don't ever create a system with sysid 0.
@@ -212,74 +446,184 @@ void MavsdkImpl::receive_message(mavlink_message_t& message, Connection* connect
         return;
     }
 
-    std::lock_guard<std::mutex> lock(_systems_mutex);
-
-    // The only situation where we create a system with sysid 0 is when we initialize the connection
-    // to the remote.
-    if (_systems.size() == 1 && _systems[0].first == 0) {
-        LogDebug() << "New: System ID: " << static_cast<int>(message.sysid)
-                   << " Comp ID: " << static_cast<int>(message.compid);
-        _systems[0].first = message.sysid;
-        _systems[0].second->system_impl()->set_system_id(message.sysid);
+    if (_receive_pipeline) {
+        const auto* ingress = MessageLatency::current_ingress();
+        _receive_pipeline->push(
+            _message_pool.make(message), ingress ? ingress->time_ns : MessageLatency::now_ns());
+        return;
     }
 
-    bool found_system = false;
-    for (auto& system : _systems) {
-        if (system.first == message.sysid) {
-            system.second->system_impl()->add_new_component(message.compid);
-            found_system = true;
-            break;
-        }
+    dispatch_to_system(message);
+}
+
+void MavsdkImpl::dispatch_to_system(mavlink_message_t& message)
+{
+    MAVSDK_TRACE_SCOPE("mavlink", "dispatch_to_system", message.msgid);
+    MAVSDK_ALLOCATION_REGION(Dispatch);
+    MessageLatency::DispatchTimer dispatch_timer{_message_latency};
+
+    // While counted, the system can't be destroyed, see the destructor.
+    _dispatches_in_flight.fetch_add(1);
+
+    if (auto* system_impl = system_for(message.sysid, message.compid)) {
+        system_impl->add_new_component(message.compid);
+        system_impl->process_mavlink_message(message);
     }
 
-    if (!found_system) {
-        make_system_with_component(message.sysid, message.compid);
+    _dispatches_in_flight.fetch_sub(1);
+}
+
+SystemImpl* MavsdkImpl::system_for(uint8_t system_id, uint8_t component_id)
+{
+    // Once a system exists, this is all it takes for every further message.
+    if (auto* system_impl = _system_table[system_id].load()) {
+        return system_impl;
     }
 
+    std::lock_guard<std::mutex> lock(_systems_mutex);
+
     if (_should_exit) {
-        // Don't try to call at() if systems have already been destroyed
-        // in descructor.
-        return;
+        // Don't create any systems if they are about to be destroyed in the
+        // destructor.
+        return nullptr;
     }
 
-    for (auto& system : _systems) {
-        if (system.first == message.sysid) {
-            system.second->system_impl()->process_mavlink_message(message);
-            break;
-        }
+    // Another connection might have created it in the meantime.
+    if (auto* system_impl = _system_table[system_id].load()) {
+        return system_impl;
     }
+
+    // The only situation where we create a system with sysid 0 is when we initialize the connection
+    // to the remote.
+    if (_systems.size() == 1 && _systems[0].first == 0) {
+        LogDebug() << "New: System ID: " << static_cast<int>(system_id)
+                   << " Comp ID: " << static_cast<int>(component_id);
+        _systems[0].first = system_id;
+        _systems[0].second->system_impl()->set_system_id(system_id);
+        _system_table[system_id].store(_systems[0].second->system_impl().get());
+    } else {
+        make_system_with_component(system_id, component_id);
+    }
+
+    return _system_table[system_id].load();
 }
 
 bool MavsdkImpl::send_message(mavlink_message_t& message)
 {
+    MAVSDK_ALLOCATION_REGION(Send);
+
     if (_message_logging_on) {
         LogDebug() << "Sending message " << message.msgid << " from "
                    << static_cast<int>(message.sysid) << "/" << static_cast<int>(message.compid);
     }
 
-    std::lock_guard<std::mutex> lock(_connections_mutex);
+    const auto connections = std::atomic_load(&_connections);
 
-    if (_connections.empty()) {
+    if (connections->empty()) {
         // We obviously can't send any messages without a connection added, so
         // we silently ignore this.
         return true;
     }
 
-    uint8_t successful_emissions = 0;
-    for (auto& _connection : _connections) {
-        const uint8_t target_system_id = get_target_system_id(message);
+    if (const auto signing = std::atomic_load(&_signing)) {
+        signing->sign(message);
+    }
+
+    // Serialize only once, no matter over how many connections it goes out.
+    const MavlinkFrame frame(message);
+    const uint64_t routes = routes_for(message);
 
-        if (target_system_id != 0 && !(*_connection).has_system_id(target_system_id)) {
+    uint8_t successful_emissions = 0;
+    for (auto& _connection : *connections) {
+        if (routes != 0 && !_connection->is_on_routes(routes)) {
             continue;
         }
 
-        if ((*_connection).send_message(message)) {
+        if ((*_connection).send(frame)) {
             successful_emissions++;
         }
     }
 
     if (successful_emissions == 0) {
-        LogErr() << "Sending message failed";
+        // Dropped for congestion is reported with subscribe_send_congestion,
+        // logging each message would only add to the load.
+        if (!is_send_congested()) {
+            LogErr() << "Sending message failed";
+        }
+        return false;
+    }
+
+    return true;
+}
+
+bool MavsdkImpl::send_messages(std::vector<mavlink_message_t>& messages)
+{
+    return send_messages(messages.data(), messages.size());
+}
+
+bool MavsdkImpl::send_messages(mavlink_message_t* messages, std::size_t count)
+{
+    MAVSDK_ALLOCATION_REGION(Send);
+
+    if (_message_logging_on) {
+        for (std::size_t i = 0; i < count; ++i) {
+            LogDebug() << "Sending message " << messages[i].msgid << " from "
+                       << static_cast<int>(messages[i].sysid) << "/"
+                       << static_cast<int>(messages[i].compid);
+        }
+    }
+
+    const auto connections = std::atomic_load(&_connections);
+
+    if (connections->empty()) {
+        // We obviously can't send any messages without a connection added, so
+        // we silently ignore this.
+        return true;
+    }
+
+    const auto signing = std::atomic_load(&_signing);
+
+    std::vector<MavlinkFrame> frames;
+    std::vector<uint64_t> frame_routes;
+    frames.reserve(count);
+    frame_routes.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto& message = messages[i];
+        if (signing) {
+            signing->sign(message);
+        }
+        frames.emplace_back(message);
+        frame_routes.push_back(routes_for(message));
+    }
+
+    // Each connection gets all its frames in one go.
+    std::vector<uint8_t> emitted(frames.size(), 0);
+    std::vector<const MavlinkFrame*> connection_frames;
+    std::vector<std::size_t> indices;
+    connection_frames.reserve(frames.size());
+    indices.reserve(frames.size());
+    for (auto& connection : *connections) {
+        connection_frames.clear();
+        indices.clear();
+        for (std::size_t i = 0; i < frames.size(); ++i) {
+            if (frame_routes[i] != 0 && !connection->is_on_routes(frame_routes[i])) {
+                continue;
+            }
+            connection_frames.push_back(&frames[i]);
+            indices.push_back(i);
+        }
+
+        if (!connection_frames.empty() && connection->send(connection_frames)) {
+            for (const auto i : indices) {
+                emitted[i] = 1;
+            }
+        }
+    }
+
+    if (std::find(emitted.begin(), emitted.end(), 0) != emitted.end()) {
+        if (!is_send_congested()) {
+            LogErr() << "Sending messages failed";
+        }
         return false;
     }
 
@@ -294,16 +638,26 @@ ConnectionResult MavsdkImpl::add_any_connection(
         return ConnectionResult::ConnectionUrlInvalid;
     }
 
+    LinkEmulator::Config emulation{};
+    if (!cli_arg.get_emulation().empty()) {
+        const auto parsed = LinkEmulator::parse(cli_arg.get_emulation());
+        if (!parsed) {
+            return ConnectionResult::ConnectionUrlInvalid;
+        }
+        emulation = parsed.value();
+        LogWarn() << "Emulating an impaired link on " << connection_url;
+    }
+
     switch (cli_arg.get_protocol()) {
         case CliArg::Protocol::Udp: {
             int port = cli_arg.get_port() ? cli_arg.get_port() : Mavsdk::DEFAULT_UDP_PORT;
 
             if (cli_arg.get_path().empty() || cli_arg.get_path() == Mavsdk::DEFAULT_UDP_BIND_IP) {
                 std::string path = Mavsdk::DEFAULT_UDP_BIND_IP;
-                return add_udp_connection(path, port, forwarding_option);
+                return add_udp_connection(path, port, forwarding_option, emulation);
             } else {
                 std::string path = cli_arg.get_path();
-                return setup_udp_remote(path, port, forwarding_option);
+                return setup_udp_remote(path, port, forwarding_option, emulation);
             }
         }
 
@@ -316,7 +670,19 @@ ConnectionResult MavsdkImpl::add_any_connection(
             if (cli_arg.get_port()) {
                 port = cli_arg.get_port();
             }
-            return add_tcp_connection(path, port, forwarding_option);
+            return add_tcp_connection(path, port, forwarding_option, emulation);
+        }
+
+        case CliArg::Protocol::TcpIn: {
+            std::string path = Mavsdk::DEFAULT_TCP_SERVER_IP;
+            int port = Mavsdk::DEFAULT_TCP_REMOTE_PORT;
+            if (!cli_arg.get_path().empty()) {
+                path = cli_arg.get_path();
+            }
+            if (cli_arg.get_port()) {
+                port = cli_arg.get_port();
+            }
+            return add_tcp_server_connection(path, port, forwarding_option, emulation);
         }
 
         case CliArg::Protocol::Serial: {
@@ -326,16 +692,23 @@ ConnectionResult MavsdkImpl::add_any_connection(
             }
             bool flow_control = cli_arg.get_flow_control();
             return add_serial_connection(
-                cli_arg.get_path(), baudrate, flow_control, forwarding_option);
+                cli_arg.get_path(), baudrate, flow_control, forwarding_option, emulation);
         }
 
+        case CliArg::Protocol::Replay:
+            return add_replay_connection(
+                cli_arg.get_path(), cli_arg.get_fast_replay(), forwarding_option);
+
         default:
             return ConnectionResult::ConnectionError;
     }
 }
 
 ConnectionResult MavsdkImpl::add_udp_connection(
-    const std::string& local_ip, const int local_port, ForwardingOption forwarding_option)
+    const std::string& local_ip,
+    const int local_port,
+    ForwardingOption forwarding_option,
+    const LinkEmulator::Config& emulation)
 {
     auto new_conn = std::make_shared<UdpConnection>(
         [this](mavlink_message_t& message, Connection* connection) {
@@ -347,6 +720,11 @@ ConnectionResult MavsdkImpl::add_udp_connection(
     if (!new_conn) {
         return ConnectionResult::ConnectionError;
     }
+    new_conn->set_capture(capture_for_new_connection());
+    new_conn->set_thread_setup(
+        ThreadSetup::for_role(_configuration, Mavsdk::Configuration::ThreadRole::Io, "io"));
+    new_conn->set_link_emulation(emulation);
+    new_conn->set_route_index(next_route_index());
     ConnectionResult ret = new_conn->start();
     if (ret == ConnectionResult::Success) {
         add_connection(new_conn);
@@ -355,18 +733,27 @@ ConnectionResult MavsdkImpl::add_udp_connection(
 }
 
 ConnectionResult MavsdkImpl::setup_udp_remote(
-    const std::string& remote_ip, int remote_port, ForwardingOption forwarding_option)
+    const std::string& remote_ip,
+    int remote_port,
+    ForwardingOption forwarding_option,
+    const LinkEmulator::Config& emulation)
 {
     auto new_conn = std::make_shared<UdpConnection>(
         [this](mavlink_message_t& message, Connection* connection) {
             receive_message(message, connection);
         },
-        "0.0.0.0",
+        // An IPv6 socket is needed to reach an IPv6 remote.
+        (remote_ip.find(':') != std::string::npos) ? "::" : "0.0.0.0",
         0,
         forwarding_option);
     if (!new_conn) {
         return ConnectionResult::ConnectionError;
     }
+    new_conn->set_capture(capture_for_new_connection());
+    new_conn->set_thread_setup(
+        ThreadSetup::for_role(_configuration, Mavsdk::Configuration::ThreadRole::Io, "io"));
+    new_conn->set_link_emulation(emulation);
+    new_conn->set_route_index(next_route_index());
     ConnectionResult ret = new_conn->start();
     if (ret == ConnectionResult::Success) {
         new_conn->add_remote(remote_ip, remote_port);
@@ -378,7 +765,10 @@ ConnectionResult MavsdkImpl::setup_udp_remote(
 }
 
 ConnectionResult MavsdkImpl::add_tcp_connection(
-    const std::string& remote_ip, int remote_port, ForwardingOption forwarding_option)
+    const std::string& remote_ip,
+    int remote_port,
+    ForwardingOption forwarding_option,
+    const LinkEmulator::Config& emulation)
 {
     auto new_conn = std::make_shared<TcpConnection>(
         [this](mavlink_message_t& message, Connection* connection) {
@@ -390,6 +780,14 @@ ConnectionResult MavsdkImpl::add_tcp_connection(
     if (!new_conn) {
         return ConnectionResult::ConnectionError;
     }
+    new_conn->set_write_coalescing_delay_s(_configuration.get_write_coalescing_delay_s());
+    new_conn->set_no_delay(_configuration.get_tcp_no_delay());
+    set_up_send_queue(*new_conn);
+    new_conn->set_capture(capture_for_new_connection());
+    new_conn->set_thread_setup(
+        ThreadSetup::for_role(_configuration, Mavsdk::Configuration::ThreadRole::Io, "io"));
+    new_conn->set_link_emulation(emulation);
+    new_conn->set_route_index(next_route_index());
     ConnectionResult ret = new_conn->start();
     if (ret == ConnectionResult::Success) {
         add_connection(new_conn);
@@ -397,11 +795,50 @@ ConnectionResult MavsdkImpl::add_tcp_connection(
     return ret;
 }
 
+ConnectionResult MavsdkImpl::add_tcp_server_connection(
+    const std::string& local_ip,
+    int local_port,
+    ForwardingOption forwarding_option,
+    const LinkEmulator::Config& emulation)
+{
+    auto new_conn = std::make_shared<TcpServerConnection>(
+        [this](mavlink_message_t& message, Connection* connection) {
+            receive_message(message, connection);
+        },
+        local_ip,
+        local_port,
+        forwarding_option);
+    if (!new_conn) {
+        return ConnectionResult::ConnectionError;
+    }
+    new_conn->set_no_delay(_configuration.get_tcp_no_delay());
+    new_conn->set_capture(capture_for_new_connection());
+    new_conn->set_thread_setup(
+        ThreadSetup::for_role(_configuration, Mavsdk::Configuration::ThreadRole::Io, "io"));
+    new_conn->set_link_emulation(emulation);
+    new_conn->set_route_index(next_route_index());
+    ConnectionResult ret = new_conn->start();
+    if (ret == ConnectionResult::Success) {
+        add_connection(new_conn);
+    }
+    return ret;
+}
+
+void MavsdkImpl::set_up_send_queue(Connection& connection)
+{
+    connection.set_send_queue_bytes(_configuration.get_send_queue_bytes());
+    connection.set_congestion_callback(
+        [this, connection_ptr = &connection](bool congested, std::size_t queued_bytes) {
+            report_send_congestion(connection_ptr, congested, queued_bytes);
+        });
+}
+
 ConnectionResult MavsdkImpl::add_serial_connection(
     const std::string& dev_path,
     int baudrate,
     bool flow_control,
-    ForwardingOption forwarding_option)
+    ForwardingOption forwarding_option,
+    const LinkEmulator::Config& emulation)
 {
     auto new_conn = std::make_shared<SerialConnection>(
         [this](mavlink_message_t& message, Connection* connection) {
@@ -414,6 +851,15 @@ ConnectionResult MavsdkImpl::add_serial_connection(
     if (!new_conn) {
         return ConnectionResult::ConnectionError;
     }
+    new_conn->set_send_scheduling(_configuration.get_serial_send_scheduling());
+    new_conn->set_low_latency(_configuration.get_serial_low_latency());
+    set_up_send_queue(*new_conn);
+    new_conn->set_write_coalescing_delay_s(_configuration.get_write_coalescing_delay_s());
+    new_conn->set_capture(capture_for_new_connection());
+    new_conn->set_thread_setup(
+        ThreadSetup::for_role(_configuration, Mavsdk::Configuration::ThreadRole::Io, "io"));
+    new_conn->set_link_emulation(emulation);
+    new_conn->set_route_index(next_route_index());
     ConnectionResult ret = new_conn->start();
     if (ret == ConnectionResult::Success) {
         add_connection(new_conn);
@@ -421,10 +867,101 @@ ConnectionResult MavsdkImpl::add_serial_connection(
     return ret;
 }
 
+ConnectionResult MavsdkImpl::add_replay_connection(
+    const std::string& path, bool as_fast_as_possible, ForwardingOption forwarding_option)
+{
+    auto new_conn = std::make_shared<ReplayConnection>(
+        [this](mavlink_message_t& message, Connection* connection) {
+            receive_message(message, connection);
+        },
+        path,
+        as_fast_as_possible,
+        get_own_system_id(),
+        forwarding_option);
+    if (!new_conn) {
+        return ConnectionResult::ConnectionError;
+    }
+    // Not captured, that would just append the tlog to itself.
+    new_conn->set_route_index(next_route_index());
+    new_conn->set_thread_setup(
+        ThreadSetup::for_role(_configuration, Mavsdk::Configuration::ThreadRole::Io, "io"));
+    ConnectionResult ret = new_conn->start();
+    if (ret == ConnectionResult::Success) {
+        add_connection(new_conn);
+    }
+    return ret;
+}
+
+std::shared_ptr<TlogWriter> MavsdkImpl::capture_for_new_connection()
+{
+    std::lock_guard<std::mutex> lock(_capture_mutex);
+
+    const auto path = _configuration.get_capture_path();
+    if (path.empty()) {
+        return {};
+    }
+
+    if (_capture == nullptr || path != _capture_path) {
+        auto capture = std::make_shared<TlogWriter>();
+        if (!capture->open(path)) {
+            return {};
+        }
+        LogInfo() << "Capturing to " << path;
+        _capture = std::move(capture);
+        _capture_path = path;
+    }
+    return _capture;
+}
+
+void MavsdkImpl::enable_signing(const Mavsdk::SigningKey& key, bool accept_unsigned)
+{
+    // The timestamps carry on, so messages signed with the new key are
+    // never older than the ones before.
+    const auto previous = std::atomic_load(&_signing);
+    std::atomic_store(
+        &_signing,
+        std::make_shared<MavlinkSigning>(
+            key, accept_unsigned, previous ? previous->timestamp() + 1 : 0));
+}
+
+void MavsdkImpl::disable_signing()
+{
+    std::atomic_store(&_signing, std::shared_ptr<MavlinkSigning>{});
+}
+
+uint64_t MavsdkImpl::routes_for(uint8_t target_system_id, uint8_t target_component_id) const
+{
+    // Broadcasts, and targets we have not heard from (yet), go everywhere.
+    if (target_system_id == 0) {
+        return 0;
+    }
+    return _route_table.routes(target_system_id, target_component_id, MessageLatency::now_ns());
+}
+
+uint64_t MavsdkImpl::routes_for(const mavlink_message_t& message) const
+{
+    const uint64_t routes =
+        routes_for(get_target_system_id(message), get_target_component_id(message));
+    return _link_bonding ? _link_bonding->routes_for_message(message.msgid, routes) : routes;
+}
+
+int MavsdkImpl::next_route_index()
+{
+    const int route_index = _next_route_index++;
+    if (route_index >= RouteTable::MAX_ROUTE_INDICES) {
+        LogWarn() << "More than " << RouteTable::MAX_ROUTE_INDICES
+                  << " connections, messages to systems on the others are not routed";
+        return -1;
+    }
+    return route_index;
+}
+
 void MavsdkImpl::add_connection(const std::shared_ptr<Connection>& new_connection)
 {
     std::lock_guard<std::mutex> lock(_connections_mutex);
-    _connections.push_back(new_connection);
+    auto new_connections = std::make_shared<Connections>(*_connections);
+    new_connections->push_back(new_connection);
+    std::atomic_store(&_connections, std::shared_ptr<const Connections>(new_connections));
 }
 
 void MavsdkImpl::set_configuration(Mavsdk::Configuration new_configuration)
@@ -437,6 +974,45 @@ void MavsdkImpl::set_configuration(Mavsdk::Configuration new_configuration)
         _configuration.get_always_send_heartbeats() && !is_any_system_connected()) {
         stop_sending_heartbeats();
     }
+
+    if (new_configuration.get_callback_queue_capacity() !=
+            _configuration.get_callback_queue_capacity() ||
+        new_configuration.get_callback_threads() != _configuration.get_callback_threads() ||
+        new_configuration.get_callback_ordering() != _configuration.get_callback_ordering()) {
+        LogWarn() << "Callback queue capacity, threads, and ordering can only be set in Mavsdk "
+                     "constructor";
+        new_configuration.set_callback_queue_capacity(
+            _configuration.get_callback_queue_capacity());
+        new_configuration.set_callback_threads(_configuration.get_callback_threads());
+        new_configuration.set_callback_ordering(_configuration.get_callback_ordering());
+    }
+    if (new_configuration.get_dispatch_threads() != _configuration.get_dispatch_threads()) {
+        LogWarn() << "Dispatch threads can only be set in Mavsdk constructor";
+        new_configuration.set_dispatch_threads(_configuration.get_dispatch_threads());
+    }
+    if (new_configuration.get_link_bonding() != _configuration.get_link_bonding()) {
+        LogWarn() << "Link bonding can only be set in Mavsdk constructor";
+        new_configuration.set_link_bonding(_configuration.get_link_bonding());
+    }
+
+    // The threads are set up already, connections added later should be set
+    // up like the ones before.
+    new_configuration.set_thread_name_prefix(_configuration.get_thread_name_prefix());
+    new_configuration.set_runtime(_configuration.get_runtime());
+    using ThreadRole = Mavsdk::Configuration::ThreadRole;
+    for (const auto role :
+         {ThreadRole::Io,
+          ThreadRole::Timer,
+          ThreadRole::Dispatch,
+          ThreadRole::Callback,
+          ThreadRole::Worker}) {
+        new_configuration.set_thread_settings(role, _configuration.get_thread_settings(role));
+    }
+    for (auto& queue : _user_callback_queues) {
+        queue->set_overflow_policy(new_configuration.get_callback_overflow_policy());
+    }
+    _message_latency.set_enabled(new_configuration.get_message_latency_stats());
+
     _configuration = new_configuration;
 }
 
@@ -450,6 +1026,40 @@ uint8_t MavsdkImpl::get_own_component_id() const
     return _configuration.get_component_id();
 }
 
+std::string MavsdkImpl::get_param_cache_directory() const
+{
+    return _configuration.get_param_cache_directory();
+}
+
+double MavsdkImpl::get_request_message_cache_ttl_s() const
+{
+    return _configuration.get_request_message_cache_ttl_s();
+}
+
+bool MavsdkImpl::get_low_memory() const
+{
+    return _configuration.get_low_memory();
+}
+
+#ifdef MAVSDK_WITH_HTTP
+HttpLoader& MavsdkImpl::http_loader()
+{
+    if (_runtime) {
+        auto& http_loader = _runtime->http_loader();
+        http_loader.set_cache_directory(get_param_cache_directory());
+        return http_loader;
+    }
+
+    std::lock_guard<std::mutex> lock(_http_loader_mutex);
+    if (_http_loader == nullptr) {
+        _http_loader = std::make_shared<HttpLoader>();
+    }
+    // The configuration might have changed since.
+    _http_loader->set_cache_directory(get_param_cache_directory());
+    return *_http_loader;
+}
+#endif
+
 uint8_t MavsdkImpl::get_mav_type() const
 {
     switch (_configuration.get_usage_type()) {
@@ -496,6 +1106,11 @@ void MavsdkImpl::make_system_with_component(
     new_system->init(system_id, comp_id, always_connected);
 
     _systems.emplace_back(system_id, new_system);
+
+    // The placeholder for sysid 0 is only entered once it gets its real ID.
+    if (system_id != 0) {
+        _system_table[system_id].store(new_system->system_impl().get());
+    }
 }
 
 void MavsdkImpl::notify_on_discover()
@@ -534,103 +1149,361 @@ bool MavsdkImpl::is_any_system_connected() const
     });
 }
 
-void MavsdkImpl::work_thread()
+void MavsdkImpl::work_thread(const ThreadSetup& thread_setup)
 {
+    thread_setup.apply();
+
     while (!_should_exit) {
-        timeout_handler.run_once();
-        call_every_handler.run_once();
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const auto deadline = run_timers();
+
+        std::unique_lock<std::mutex> lock(_work_thread_mutex);
+
+        // Something was added while we were running the handlers, so we need
+        // to go around again before we can know the next deadline.
+        if (_work_thread_woken) {
+            _work_thread_woken = false;
+            continue;
+        }
+
+        // Nothing is scheduled, so we only wait to be woken up.
+        if (!deadline) {
+            _work_thread_cv.wait(lock, [this]() { return _work_thread_woken || _should_exit; });
+        } else {
+            _work_thread_cv.wait_until(
+                lock, deadline.value(), [this]() { return _work_thread_woken || _should_exit; });
+        }
+        _work_thread_woken = false;
+    }
+}
+
+std::optional<dl_time_t> MavsdkImpl::run_timers()
+{
+    timeout_handler.run_once();
+    call_every_handler.run_once();
+
+    const auto next_timeout = timeout_handler.next_deadline();
+    const auto next_call_every = call_every_handler.next_deadline();
+    if (next_timeout && next_call_every) {
+        return std::min(next_timeout.value(), next_call_every.value());
+    }
+    return next_timeout ? next_timeout : next_call_every;
+}
+
+void MavsdkImpl::wake_work_thread()
+{
+    {
+        std::lock_guard<std::mutex> lock(_work_thread_mutex);
+        _work_thread_woken = true;
     }
+    _work_thread_cv.notify_one();
 }
 
 void MavsdkImpl::call_user_callback_located(
-    const std::string& filename, const int linenumber, const std::function<void()>& func)
+    const char* filename, const int linenumber, UserCallbackFunction func, const void* origin)
 {
-    auto callback_size = _user_callback_queue.size();
-    if (callback_size == 10) {
-        LogWarn()
-            << "User callback queue too slow.\n"
-               "See: https://mavsdk.mavlink.io/main/en/cpp/troubleshooting.html#user_callbacks";
+    // A callback thread must never block on a full queue because it might be
+    // the one that needs to make space.
+    const auto this_thread_id = std::this_thread::get_id();
+    const bool may_block =
+        _runtime ? !_runtime->callback_executor().is_callback_thread() :
+                   std::none_of(
+                       _process_user_callbacks_threads.begin(),
+                       _process_user_callbacks_threads.end(),
+                       [&](const auto& thread) { return thread.get_id() == this_thread_id; });
+
+    UserCallback callback{std::move(func), filename, linenumber};
+    const auto* ingress = _message_latency.enabled() ? MessageLatency::current_ingress() : nullptr;
+    if (ingress != nullptr) {
+        callback.message_id = ingress->message_id;
+        callback.ingress_time_ns = ingress->time_ns;
+        callback.enqueue_time_ns = MessageLatency::now_ns();
+    }
+    callback.trace_flow_id = MAVSDK_TRACE_FLOW_START("callback", "queued");
 
-    } else if (callback_size == 99) {
-        LogErr()
-            << "User callback queue overflown\n"
-               "See: https://mavsdk.mavlink.io/main/en/cpp/troubleshooting.html#user_callbacks";
+    auto& queue = user_callback_queue_for(origin, filename, linenumber);
+    queue.enqueue(std::move(callback), may_block);
+}
 
-    } else if (callback_size == 100) {
-        return;
+UserCallbackQueue&
+MavsdkImpl::user_callback_queue_for(const void* origin, const char* filename, int linenumber)
+{
+    if (_user_callback_queues.size() == 1) {
+        return *_user_callback_queues.front();
+    }
+
+    std::size_t hash = std::hash<const void*>{}(origin);
+    if (_configuration.get_callback_ordering() ==
+        Mavsdk::Configuration::CallbackOrdering::PerSubscription) {
+        // The call site identifies the subscription. As the filename is
+        // always a string literal, comparing the pointer is enough.
+        hash ^= std::hash<const void*>{}(filename) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        hash ^= std::hash<int>{}(linenumber) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
+
+    return *_user_callback_queues[hash % _user_callback_queues.size()];
+}
+
+Mavsdk::CallbackQueueStats MavsdkImpl::callback_queue_stats() const
+{
+    Mavsdk::CallbackQueueStats total{};
+    for (const auto& queue : _user_callback_queues) {
+        const auto stats = queue->stats();
+        total.depth += stats.depth;
+        total.max_depth = std::max(total.max_depth, stats.max_depth);
+        total.processed += stats.processed;
+        total.dropped += stats.dropped;
+    }
+    return total;
+}
+
+std::vector<Mavsdk::MessageLatencyStats> MavsdkImpl::message_latency_stats() const
+{
+    return _message_latency.stats();
+}
+
+void MavsdkImpl::reset_message_latency_stats()
+{
+    _message_latency.reset();
+}
+
+std::vector<Mavsdk::ConnectionStats> MavsdkImpl::connection_stats() const
+{
+    const auto connections = std::atomic_load(&_connections);
+
+    std::vector<Mavsdk::ConnectionStats> result;
+    result.reserve(connections->size());
+    for (std::size_t i = 0; i < connections->size(); ++i) {
+        auto stats = (*connections)[i]->link_stats().stats();
+        stats.connection_index = i;
+        stats.read_to_dispatch = (*connections)[i]->read_to_dispatch_stats();
+        stats.send_queued_bytes = (*connections)[i]->send_queued_bytes();
+        stats.send_would_block = (*connections)[i]->send_would_block_count();
+        if (_link_bonding) {
+            const auto quality = _link_bonding->quality((*connections)[i]->route_index());
+            stats.duplicates = quality.duplicates;
+            stats.lag_s = quality.lag_s;
+        }
+        result.push_back(std::move(stats));
     }
+    return result;
+}
 
-    // We only need to keep track of filename and linenumber if we're actually debugging this.
-    UserCallback user_callback =
-        _callback_debugging ? UserCallback{func, filename, linenumber} : UserCallback{func};
+void MavsdkImpl::subscribe_send_congestion(const Mavsdk::SendCongestionCallback& callback)
+{
+    std::lock_guard<std::mutex> lock(_send_congestion_callback_mutex);
+    _send_congestion_callback = callback;
+}
 
-    _user_callback_queue.enqueue(user_callback);
+bool MavsdkImpl::is_send_congested() const
+{
+    const auto connections = std::atomic_load(&_connections);
+    return std::any_of(connections->cbegin(), connections->cend(), [](const auto& connection) {
+        return connection->send_congested();
+    });
+}
+
+void MavsdkImpl::report_send_congestion(
+    const Connection* connection, bool congested, std::size_t queued_bytes)
+{
+    const auto connections = std::atomic_load(&_connections);
+    const auto it = std::find_if(
+        connections->cbegin(), connections->cend(), [&](const auto& other) {
+            return other.get() == connection;
+        });
+
+    Mavsdk::SendCongestion send_congestion;
+    send_congestion.connection_index = static_cast<std::size_t>(it - connections->cbegin());
+    send_congestion.congested = congested;
+    send_congestion.queued_bytes = queued_bytes;
+
+    std::lock_guard<std::mutex> lock(_send_congestion_callback_mutex);
+    if (_send_congestion_callback) {
+        auto temp_callback = _send_congestion_callback;
+        call_user_callback([temp_callback, send_congestion]() { temp_callback(send_congestion); });
+    }
 }
 
-void MavsdkImpl::process_user_callbacks_thread()
+void MavsdkImpl::update_link_stats_rates()
 {
+    const uint64_t now_ns = MessageLatency::now_ns();
+    for (const auto& connection : *std::atomic_load(&_connections)) {
+        connection->link_stats().update_rates(now_ns);
+        if (_link_bonding) {
+            _link_bonding->set_loss_rate(
+                connection->route_index(), connection->link_stats().stats().link.loss_rate);
+        }
+    }
+}
+
+void MavsdkImpl::check_heartbeat_timeouts()
+{
+    // A system timing out takes the lock itself, so work on a copy.
+    std::vector<std::shared_ptr<System>> systems;
+    {
+        std::lock_guard<std::mutex> lock(_systems_mutex);
+        for (const auto& system : _systems) {
+            systems.push_back(system.second);
+        }
+    }
+
+    const uint64_t now_ns = MessageLatency::now_ns();
+    for (const auto& system : systems) {
+        system->system_impl()->check_heartbeat_timeout(now_ns);
+    }
+}
+
+void MavsdkImpl::process_user_callbacks_thread(
+    UserCallbackQueue& queue, std::size_t thread_index, const ThreadSetup& thread_setup)
+{
+    thread_setup.apply();
+
+    std::vector<UserCallback> batch;
+    batch.reserve(USER_CALLBACK_BATCH_SIZE);
+
     while (!_should_exit) {
-        auto callback = _user_callback_queue.dequeue();
-        if (!callback) {
+        batch.clear();
+        if (!queue.dequeue_batch(batch, USER_CALLBACK_BATCH_SIZE)) {
             continue;
         }
 
-        void* cookie{nullptr};
-
-        const double timeout_s = 1.0;
-        timeout_handler.add(
-            [&]() {
-                if (_callback_debugging) {
-                    LogWarn() << "Callback called from " << callback.value().filename << ":"
-                              << callback.value().linenumber << " took more than " << timeout_s
-                              << " second to run.";
-                    fflush(stdout);
-                    fflush(stderr);
-                    abort();
-                } else {
-                    LogWarn()
-                        << "Callback took more than " << timeout_s << " second to run.\n"
-                        << "See: https://mavsdk.mavlink.io/main/en/cpp/troubleshooting.html#user_callbacks";
-                }
-            },
-            timeout_s,
-            &cookie);
-        callback.value().func();
-        timeout_handler.remove(cookie);
+        run_user_callbacks(queue, batch, thread_index);
     }
 }
 
+void MavsdkImpl::run_user_callbacks(
+    UserCallbackQueue& queue, std::vector<UserCallback>& batch, std::size_t thread_index)
+{
+    for (auto& callback : batch) {
+        // Named after where it was queued from.
+        MAVSDK_TRACE_SCOPE("callback", callback.filename, callback.linenumber);
+        MAVSDK_TRACE_FLOW_END("callback", "queued", callback.trace_flow_id);
+        MAVSDK_ALLOCATION_REGION(Callback);
+
+        const auto start_ns = MessageLatency::now_ns();
+        if (callback.ingress_time_ns != 0) {
+            _message_latency.record_callback(
+                callback.message_id, callback.ingress_time_ns, callback.enqueue_time_ns, start_ns);
+        }
+        _callback_watchdog->begin(thread_index, callback.filename, callback.linenumber, start_ns);
+        callback.func();
+        _callback_watchdog->end(thread_index, MessageLatency::now_ns());
+    }
+
+    queue.count_processed(batch.size());
+}
+
+void MavsdkImpl::check_callback_watchdog()
+{
+    const auto timeout_ns = static_cast<uint64_t>(CALLBACK_TIMEOUT_S * 1e9);
+
+    for (const auto& stalled : _callback_watchdog->check(MessageLatency::now_ns(), timeout_ns)) {
+        if (_callback_debugging) {
+            LogWarn() << "Callback called from " << stalled.filename << ":" << stalled.linenumber
+                      << " took more than " << CALLBACK_TIMEOUT_S << " second to run.";
+            AsyncLog::instance().flush();
+            fflush(stdout);
+            fflush(stderr);
+            abort();
+        } else {
+            LogWarn()
+                << "Callback took more than " << CALLBACK_TIMEOUT_S << " second to run.\n"
+                << "See: https://mavsdk.mavlink.io/main/en/cpp/troubleshooting.html#user_callbacks";
+        }
+    }
+}
+
+void MavsdkImpl::enable_callback_duration_stats(bool enabled)
+{
+    _callback_watchdog->set_duration_stats_enabled(enabled);
+}
+
+std::vector<Mavsdk::CallbackDurationStats> MavsdkImpl::callback_duration_stats() const
+{
+    return _callback_watchdog->duration_stats();
+}
+
+void MavsdkImpl::reset_callback_duration_stats()
+{
+    _callback_watchdog->reset_duration_stats();
+}
+
 void MavsdkImpl::start_sending_heartbeats()
 {
     if (_heartbeat_send_cookie == nullptr) {
-        call_every_handler.add(
-            [this]() { send_heartbeat(); }, HEARTBEAT_SEND_INTERVAL_S, &_heartbeat_send_cookie);
+        // The fields hardly ever change, so it's only packed again when they do.
+        auto fields = heartbeat_fields();
+        periodic_messages.add(
+            make_heartbeat(fields),
+            HEARTBEAT_SEND_INTERVAL_S,
+            &_heartbeat_send_cookie,
+            [this, fields](mavlink_message_t& message) mutable {
+                const auto current = heartbeat_fields();
+                if (current != fields) {
+                    fields = current;
+                    message = make_heartbeat(fields);
+                }
+                return true;
+            });
     }
 }
 
 void MavsdkImpl::stop_sending_heartbeats()
 {
     if (!_configuration.get_always_send_heartbeats()) {
-        call_every_handler.remove(_heartbeat_send_cookie);
+        periodic_messages.remove(_heartbeat_send_cookie);
         _heartbeat_send_cookie = nullptr;
     }
 }
 
-void MavsdkImpl::send_heartbeat()
+MavsdkImpl::HeartbeatFields MavsdkImpl::heartbeat_fields()
+{
+    HeartbeatFields fields;
+    fields.system_id = get_own_system_id();
+    fields.component_id = get_own_component_id();
+    fields.type = get_mav_type();
+    fields.base_mode = fields.component_id == MAV_COMP_ID_AUTOPILOT1 ? _base_mode.load() : 0;
+    fields.custom_mode = fields.component_id == MAV_COMP_ID_AUTOPILOT1 ? _custom_mode.load() : 0;
+    fields.system_status = get_system_status();
+    return fields;
+}
+
+mavlink_message_t MavsdkImpl::make_heartbeat(const HeartbeatFields& fields)
 {
     mavlink_message_t message;
     mavlink_msg_heartbeat_pack(
-        get_own_system_id(),
-        get_own_component_id(),
+        fields.system_id,
+        fields.component_id,
         &message,
-        get_mav_type(),
-        get_own_component_id() == MAV_COMP_ID_AUTOPILOT1 ? MAV_AUTOPILOT_GENERIC :
-                                                           MAV_AUTOPILOT_INVALID,
-        get_own_component_id() == MAV_COMP_ID_AUTOPILOT1 ? _base_mode.load() : 0,
-        get_own_component_id() == MAV_COMP_ID_AUTOPILOT1 ? _custom_mode.load() : 0,
-        get_system_status());
-    send_message(message);
+        fields.type,
+        fields.component_id == MAV_COMP_ID_AUTOPILOT1 ? MAV_AUTOPILOT_GENERIC :
+                                                        MAV_AUTOPILOT_INVALID,
+        fields.base_mode,
+        fields.custom_mode,
+        fields.system_status);
+    return message;
+}
+
+std::size_t MavsdkImpl::num_system_work_threads(const Mavsdk::Configuration& configuration)
+{
+    // The work per system is mostly waiting for responses, so a few threads
+    // are plenty even for many systems.
+    if (configuration.get_low_memory()) {
+        return 1;
+    }
+    const unsigned hardware_threads = std::thread::hardware_concurrency();
+    return std::clamp(hardware_threads, 1u, 4u);
+}
+
+std::size_t MavsdkImpl::num_background_threads(const Mavsdk::Configuration& configuration)
+{
+    // Parsing is rare, but holds up a thread for a while. Two are enough to
+    // keep one definition from waiting for another, more would only compete
+    // with the threads handling messages.
+    if (configuration.get_low_memory()) {
+        return 1;
+    }
+    const unsigned hardware_threads = std::thread::hardware_concurrency();
+    return std::clamp(hardware_threads / 2, 1u, 2u);
 }
 
 uint8_t MavsdkImpl::get_target_system_id(const mavlink_message_t& message)
@@ -1,22 +1,39 @@
 #pragma once
 
+#include <array>
+#include <memory>
 #include <mutex>
 #include <utility>
 #include <vector>
 #include <atomic>
+#include <condition_variable>
 #include <thread>
 
+#include "background_work.h"
 #include "call_every_handler.h"
+#include "callback_watchdog.h"
 #include "connection.h"
+#include "link_bonding.h"
 #include "mavsdk.h"
 #include "mavlink_include.h"
 #include "mavlink_address.h"
-#include "safe_queue.h"
+#include "message_id_filter.h"
+#include "message_latency.h"
+#include "message_pool.h"
+#include "native_thread.h"
+#include "periodic_messages.h"
+#include "receive_pipeline.h"
+#include "runtime_impl.h"
 #include "system.h"
+#include "thread_pool.h"
+#include "thread_setup.h"
 #include "timeout_handler.h"
+#include "user_callback_queue.h"
 
 namespace mavsdk {
 
+class HttpLoader;
+
 class MavsdkImpl {
 public:
     /** @brief Default System ID for GCS configuration type. */
@@ -36,7 +53,7 @@ public:
     /** @brief Default Component ID for Camera configuration type. */
     static constexpr int DEFAULT_COMPONENT_ID_CAMERA = MAV_COMP_ID_CAMERA;
 
-    MavsdkImpl();
+    explicit MavsdkImpl(const Mavsdk::Configuration& configuration);
     ~MavsdkImpl();
     MavsdkImpl(const MavsdkImpl&) = delete;
     void operator=(const MavsdkImpl&) = delete;
@@ -46,20 +63,40 @@ public:
     void forward_message(mavlink_message_t& message, Connection* connection);
     void receive_message(mavlink_message_t& message, Connection* connection);
     bool send_message(mavlink_message_t& message);
+    bool send_messages(std::vector<mavlink_message_t>& messages);
+    bool send_messages(mavlink_message_t* messages, std::size_t count);
 
     ConnectionResult
     add_any_connection(const std::string& connection_url, ForwardingOption forwarding_option);
+    // Without an emulation config, the link isn't impaired.
     ConnectionResult add_udp_connection(
-        const std::string& local_ip, int local_port_number, ForwardingOption forwarding_option);
+        const std::string& local_ip,
+        int local_port_number,
+        ForwardingOption forwarding_option,
+        const LinkEmulator::Config& emulation = {});
     ConnectionResult add_tcp_connection(
-        const std::string& remote_ip, int remote_port, ForwardingOption forwarding_option);
+        const std::string& remote_ip,
+        int remote_port,
+        ForwardingOption forwarding_option,
+        const LinkEmulator::Config& emulation = {});
+    ConnectionResult add_tcp_server_connection(
+        const std::string& local_ip,
+        int local_port,
+        ForwardingOption forwarding_option,
+        const LinkEmulator::Config& emulation = {});
     ConnectionResult add_serial_connection(
         const std::string& dev_path,
         int baudrate,
         bool flow_control,
-        ForwardingOption forwarding_option);
+        ForwardingOption forwarding_option,
+        const LinkEmulator::Config& emulation = {});
     ConnectionResult setup_udp_remote(
-        const std::string& remote_ip, int remote_port, ForwardingOption forwarding_option);
+        const std::string& remote_ip,
+        int remote_port,
+        ForwardingOption forwarding_option,
+        const LinkEmulator::Config& emulation = {});
+    ConnectionResult add_replay_connection(
+        const std::string& path, bool as_fast_as_possible, ForwardingOption forwarding_option);
 
     std::vector<std::shared_ptr<System>> systems() const;
 
@@ -68,6 +105,14 @@ public:
     uint8_t get_own_system_id() const;
     uint8_t get_own_component_id() const;
     uint8_t get_mav_type() const;
+    std::string get_param_cache_directory() const;
+    double get_request_message_cache_ttl_s() const;
+    bool get_low_memory() const;
+
+    // Shared by all systems, so concurrent downloads of the same file are
+    // only done once. Responses are cached in the param cache directory.
+    // Only defined when built with MAVSDK_WITH_HTTP, see cmake/plugins.cmake.
+    HttpLoader& http_loader();
 
     void subscribe_on_new_system(const Mavsdk::NewSystemCallback& callback);
 
@@ -77,14 +122,57 @@ public:
     void start_sending_heartbeats();
     void stop_sending_heartbeats();
 
+    // The message IDs any system has handlers for, everything else is dropped
+    // on receipt.
+    MessageIdFilter& message_id_filter() { return _message_id_filter; }
+
+    // For handlers which hold on to a received message, see MessagePool::share().
+    MessagePool& message_pool() { return _message_pool; }
+
     TimeoutHandler timeout_handler;
     CallEveryHandler call_every_handler;
 
+    // Sent over all connections, like heartbeats.
+    PeriodicMessages periodic_messages;
+
+    // Shared by all systems to work through their queues (params, commands,
+    // mission transfers) instead of each system polling in its own thread.
+    ThreadPool& system_work_pool() { return *_system_work_pool; }
+
+    static std::size_t num_system_work_threads(const Mavsdk::Configuration& configuration);
+
+    // For CPU heavy tasks of plugins, see SystemImpl::run_in_background.
+    BackgroundWork& background_work() { return *_background_work; }
+
+    static std::size_t num_background_threads(const Mavsdk::Configuration& configuration);
+
+    // The origin is used to keep callbacks of the same system in order when
+    // multiple callback threads are used.
     void call_user_callback_located(
-        const std::string& filename, int linenumber, const std::function<void()>& func);
+        const char* filename,
+        int linenumber,
+        UserCallbackFunction func,
+        const void* origin = nullptr);
+
+    Mavsdk::CallbackQueueStats callback_queue_stats() const;
+
+    std::vector<Mavsdk::MessageLatencyStats> message_latency_stats() const;
+    void reset_message_latency_stats();
+
+    void enable_callback_duration_stats(bool enabled);
+    std::vector<Mavsdk::CallbackDurationStats> callback_duration_stats() const;
+    void reset_callback_duration_stats();
+
+    std::vector<Mavsdk::ConnectionStats> connection_stats() const;
+
+    void subscribe_send_congestion(const Mavsdk::SendCongestionCallback& callback);
+    bool is_send_congested() const;
 
     void set_timeout_s(double timeout_s) { _timeout_s = timeout_s; }
 
+    void enable_signing(const Mavsdk::SigningKey& key, bool accept_unsigned);
+    void disable_signing();
+
     double timeout_s() const { return _timeout_s; };
 
     void set_base_mode(uint8_t base_mode);
@@ -94,51 +182,143 @@ public:
     void set_system_status(uint8_t system_status);
     uint8_t get_system_status();
 
-private:
+    // 0 if the message has no target system or component.
+    static uint8_t get_target_system_id(const mavlink_message_t& message);
+    static uint8_t get_target_component_id(const mavlink_message_t& message);
+
+    // Connections are normally added with one of the add_*_connection() above,
+    // this is for connections which don't have a URL, like the benchmark ones.
     void add_connection(const std::shared_ptr<Connection>&);
+
+private:
     void make_system_with_component(
         uint8_t system_id, uint8_t component_id, bool always_connected = false);
 
-    void work_thread();
-    void process_user_callbacks_thread();
-
-    void send_heartbeat();
+    void work_thread(const ThreadSetup& thread_setup);
+    void wake_work_thread();
+    // Returns when the next timer is due, if any.
+    std::optional<dl_time_t> run_timers();
+    void process_user_callbacks_thread(
+        UserCallbackQueue& queue, std::size_t thread_index, const ThreadSetup& thread_setup);
+    void run_user_callbacks(
+        UserCallbackQueue& queue, std::vector<UserCallback>& batch, std::size_t thread_index);
+    void check_callback_watchdog();
+    UserCallbackQueue&
+    user_callback_queue_for(const void* origin, const char* filename, int linenumber);
+
+    void update_link_stats_rates();
+    // Called by the connection which sends, so it must not block.
+    void report_send_congestion(
+        const Connection* connection, bool congested, std::size_t queued_bytes);
+    void set_up_send_queue(Connection& connection);
+    void check_heartbeat_timeouts();
     bool is_any_system_connected() const;
 
-    static uint8_t get_target_system_id(const mavlink_message_t& message);
-    static uint8_t get_target_component_id(const mavlink_message_t& message);
+    // Runs the handlers of the system the message is from, on the receive
+    // thread or on a dispatch thread of the receive pipeline.
+    void dispatch_to_system(mavlink_message_t& message);
 
+    // Finds the system a message is from, creating it if needed. Needs to be
+    // called while counted in _dispatches_in_flight.
+    SystemImpl* system_for(uint8_t system_id, uint8_t component_id);
+
+    // Connections a message to the target should go out on, 0 meaning all of them.
+    uint64_t routes_for(uint8_t target_system_id, uint8_t target_component_id) const;
+    // The same for an outgoing message, narrowed down with link bonding.
+    uint64_t routes_for(const mavlink_message_t& message) const;
+    int next_route_index();
+
+    using Connections = std::vector<std::shared_ptr<Connection>>;
+
+    // Senders work on a snapshot of the connections, so they never wait for
+    // each other. The mutex only serializes adding connections.
     std::mutex _connections_mutex{};
-    std::vector<std::shared_ptr<Connection>> _connections{};
+    std::shared_ptr<const Connections> _connections{std::make_shared<const Connections>()};
+
+    // Set while signing is enabled. Like the connections, it's only replaced
+    // as a whole, so the send and receive paths can use it without a lock.
+    std::shared_ptr<MavlinkSigning> _signing{};
+
+    // The tlog new connections capture to, shared by all of them.
+    std::shared_ptr<TlogWriter> capture_for_new_connection();
+    std::mutex _capture_mutex{};
+    std::string _capture_path{};
+    std::shared_ptr<TlogWriter> _capture{};
+
+    RouteTable _route_table{};
+    std::atomic<int> _next_route_index{0};
+
+    // Unset if link bonding is off.
+    std::unique_ptr<LinkBonding> _link_bonding{};
+
+    // Needs to outlive the systems, their handlers update it when destroyed.
+    MessageIdFilter _message_id_filter{};
+
+    // A shared_ptr as HttpLoader is incomplete in builds without HTTP support.
+    std::mutex _http_loader_mutex{};
+    std::shared_ptr<HttpLoader> _http_loader{};
 
     mutable std::mutex _systems_mutex{};
 
     std::vector<std::pair<uint8_t, std::shared_ptr<System>>> _systems{};
 
+    // The systems in _systems indexed by system ID, so the receive path finds
+    // them without the mutex. Entries are only set once a system is created,
+    // and they are only cleared in the destructor. The systems are destroyed
+    // after that, once no dispatch is using them anymore.
+    std::array<std::atomic<SystemImpl*>, 256> _system_table{};
+    std::atomic<unsigned> _dispatches_in_flight{0};
+
     std::mutex _new_system_callback_mutex{};
     Mavsdk::NewSystemCallback _new_system_callback{nullptr};
 
+    std::mutex _send_congestion_callback_mutex{};
+    Mavsdk::SendCongestionCallback _send_congestion_callback{nullptr};
+
     Time _time{};
 
-    Mavsdk::Configuration _configuration{Mavsdk::Configuration::UsageType::GroundStation};
+    Mavsdk::Configuration _configuration;
 
-    struct UserCallback {
-        UserCallback() = default;
-        explicit UserCallback(std::function<void()> func_) : func(std::move(func_)) {}
-        UserCallback(std::function<void()> func_, std::string filename_, const int linenumber_) :
-            func(std::move(func_)),
-            filename(std::move(filename_)),
-            linenumber(linenumber_)
-        {}
+    // Set if the threads of a Mavsdk::Runtime are used instead of our own.
+    std::shared_ptr<RuntimeImpl> _runtime{};
+    uint64_t _runtime_timer_handle{0};
+    std::vector<uint64_t> _runtime_callback_handles{};
 
-        std::function<void()> func{};
-        std::string filename{};
-        int linenumber{};
-    };
+    std::unique_ptr<ThreadPool> _own_system_work_pool{};
+    ThreadPool* _system_work_pool{nullptr};
 
-    std::thread* _work_thread{nullptr};
-    std::thread* _process_user_callbacks_thread{nullptr};
-    SafeQueue<UserCallback> _user_callback_queue{};
+    std::unique_ptr<ThreadPool> _own_background_pool{};
+    std::unique_ptr<BackgroundWork> _background_work{};
+
+    NativeThread* _work_thread{nullptr};
+    std::mutex _work_thread_mutex{};
+    std::condition_variable _work_thread_cv{};
+    bool _work_thread_woken{false};
+
+    // There is one queue per callback thread. A callback always goes to the
+    // same queue for the same system (or subscription), so it keeps its order.
+    std::vector<std::unique_ptr<UserCallbackQueue>> _user_callback_queues{};
+    std::vector<NativeThread> _process_user_callbacks_threads{};
+
+    // Callbacks are taken off the queue in batches so we don't need to go
+    // back to the queue for every single callback.
+    static constexpr std::size_t USER_CALLBACK_BATCH_SIZE = 16;
+
+    MessageLatency _message_latency{};
+
+    // Buffers of received messages, they are handed from the receive
+    // threads to the receive pipeline and on by handle.
+    MessagePool _message_pool{};
+
+    // Unset if messages are dispatched by the receive threads.
+    std::unique_ptr<ReceivePipeline> _receive_pipeline{};
+    static constexpr std::size_t RECEIVE_QUEUE_CAPACITY = 1024;
+
+    // Warns about callbacks which block the callback thread.
+    static constexpr double CALLBACK_TIMEOUT_S = 1.0;
+    static constexpr double CALLBACK_WATCHDOG_INTERVAL_S = 0.25;
+    std::unique_ptr<CallbackWatchdog> _callback_watchdog{};
+    void* _callback_watchdog_cookie{nullptr};
 
     bool _message_logging_on{false};
     bool _callback_debugging{false};
@@ -148,6 +328,32 @@ private:
     static constexpr double HEARTBEAT_SEND_INTERVAL_S = 1.0;
     void* _heartbeat_send_cookie{nullptr};
 
+    struct HeartbeatFields {
+        uint8_t system_id{0};
+        uint8_t component_id{0};
+        uint8_t type{0};
+        uint8_t base_mode{0};
+        uint32_t custom_mode{0};
+        uint8_t system_status{0};
+
+        bool operator==(const HeartbeatFields& other) const
+        {
+            return system_id == other.system_id && component_id == other.component_id &&
+                   type == other.type && base_mode == other.base_mode &&
+                   custom_mode == other.custom_mode && system_status == other.system_status;
+        }
+        bool operator!=(const HeartbeatFields& other) const { return !(*this == other); }
+    };
+    HeartbeatFields heartbeat_fields();
+    static mavlink_message_t make_heartbeat(const HeartbeatFields& fields);
+
+    static constexpr double LINK_STATS_UPDATE_INTERVAL_S = 1.0;
+    void* _link_stats_cookie{nullptr};
+
+    // One check for all systems, so a heartbeat only needs to note the time.
+    static constexpr double HEARTBEAT_CHECK_INTERVAL_S = 0.5;
+    void* _heartbeat_check_cookie{nullptr};
+
     std::atomic<bool> _should_exit = {false};
 
     std::atomic<uint8_t> _base_mode = 0;
@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+#include "benchmark_helpers.h"
+#include "mavsdk_impl.h"
+#include "null_connection.h"
+
+using namespace mavsdk;
+
+namespace {
+
+std::vector<std::shared_ptr<NullConnection>>
+add_null_connections(MavsdkImpl& mavsdk_impl, int count, ForwardingOption forwarding_option)
+{
+    std::vector<std::shared_ptr<NullConnection>> connections;
+    for (int i = 0; i < count; ++i) {
+        auto connection = std::make_shared<NullConnection>(
+            [&mavsdk_impl](mavlink_message_t& message, Connection* from) {
+                mavsdk_impl.receive_message(message, from);
+            },
+            forwarding_option);
+        connection->start();
+        mavsdk_impl.add_connection(connection);
+        connections.push_back(connection);
+    }
+    return connections;
+}
+
+} // namespace
+
+// Forwarding a vehicle's streams from its connection to two others, e.g. a
+// ground station and a companion.
+static void MavsdkImpl_Route(benchmark::State& state)
+{
+    auto messages = px4_default_stream_mix(static_cast<unsigned>(state.range(0)));
+
+    MavsdkImpl mavsdk_impl{Mavsdk::Configuration{Mavsdk::Configuration::UsageType::GroundStation}};
+    const auto connections = add_null_connections(mavsdk_impl, 3, ForwardingOption::ForwardingOn);
+
+    for (auto _ : state) {
+        for (auto& message : messages) {
+            mavsdk_impl.forward_message(message, connections[0].get());
+        }
+    }
+
+    count_messages(state, messages.size());
+}
+BENCHMARK(MavsdkImpl_Route)->Apply(px4_stream_scales);
+
+// Sending the same message over more and more connections.
+static void MavsdkImpl_SendFanOut(benchmark::State& state)
+{
+    auto messages = px4_default_stream_mix(1, 245);
+
+    MavsdkImpl mavsdk_impl{Mavsdk::Configuration{Mavsdk::Configuration::UsageType::GroundStation}};
+    const auto connections = add_null_connections(
+        mavsdk_impl, static_cast<int>(state.range(0)), ForwardingOption::ForwardingOff);
+
+    for (auto _ : state) {
+        for (auto& message : messages) {
+            mavsdk_impl.send_message(message);
+        }
+    }
+
+    count_messages(state, messages.size());
+    state.counters["frames_sent"] = static_cast<double>(connections.back()->frames_sent());
+}
+BENCHMARK(MavsdkImpl_SendFanOut)->ArgName("connections")->Arg(1)->Arg(4)->Arg(16);
@@ -8,3 +8,50 @@ TEST(Mavsdk, version)
     Mavsdk mavsdk;
     ASSERT_GT(mavsdk.version().size(), 5);
 }
+
+TEST(Mavsdk, CallbackQueueConfiguration)
+{
+    Mavsdk::Configuration configuration{Mavsdk::Configuration::UsageType::GroundStation};
+    EXPECT_EQ(configuration.get_callback_queue_capacity(), Mavsdk::DEFAULT_CALLBACK_QUEUE_CAPACITY);
+    EXPECT_EQ(configuration.get_callback_threads(), 1);
+
+    configuration.set_callback_queue_capacity(256);
+    configuration.set_callback_overflow_policy(
+        Mavsdk::Configuration::CallbackOverflowPolicy::DropOldest);
+    configuration.set_callback_threads(4);
+    configuration.set_callback_ordering(Mavsdk::Configuration::CallbackOrdering::PerSubscription);
+
+    Mavsdk mavsdk{configuration};
+
+    const auto stats = mavsdk.callback_queue_stats();
+    EXPECT_EQ(stats.depth, 0);
+    EXPECT_EQ(stats.dropped, 0);
+}
+
+TEST(Mavsdk, LowMemoryConfiguration)
+{
+    using ThreadRole = Mavsdk::Configuration::ThreadRole;
+
+    Mavsdk::Configuration configuration{Mavsdk::Configuration::UsageType::GroundStation};
+    EXPECT_FALSE(configuration.get_low_memory());
+    EXPECT_EQ(configuration.get_thread_settings(ThreadRole::Io).stack_size_bytes, 0);
+
+    Mavsdk::Configuration::ThreadSettings callback_settings;
+    callback_settings.stack_size_bytes = 1024 * 1024;
+    configuration.set_thread_settings(ThreadRole::Callback, callback_settings);
+    configuration.set_callback_threads(4);
+
+    configuration.set_low_memory(true);
+    EXPECT_TRUE(configuration.get_low_memory());
+    EXPECT_EQ(configuration.get_callback_threads(), 1);
+    EXPECT_EQ(configuration.get_dispatch_threads(), 0);
+    EXPECT_EQ(
+        configuration.get_thread_settings(ThreadRole::Io).stack_size_bytes,
+        Mavsdk::LOW_MEMORY_STACK_SIZE_BYTES);
+    // A size set before is kept.
+    EXPECT_EQ(
+        configuration.get_thread_settings(ThreadRole::Callback).stack_size_bytes, 1024 * 1024);
+
+    Mavsdk mavsdk{configuration};
+    EXPECT_EQ(mavsdk.callback_queue_stats().depth, 0);
+}
@@ -51,12 +51,12 @@ double Time::elapsed_since_s(const dl_time_t& since)
 dl_time_t Time::steady_time_in_future(double duration_s)
 {
     auto now = steady_time();
-    return now + std::chrono::milliseconds(int64_t(duration_s * 1e3));
+    return now + std::chrono::microseconds(int64_t(duration_s * 1e6));
 }
 
 void Time::shift_steady_time_by(dl_time_t& time, double offset_s)
 {
-    time += std::chrono::milliseconds(int64_t(offset_s * 1e3));
+    time += std::chrono::microseconds(int64_t(offset_s * 1e6));
 }
 
 void Time::sleep_for(std::chrono::hours h)
@@ -136,6 +136,13 @@ void FakeTime::sleep_for(std::chrono::nanoseconds ns)
     add_overhead();
 }
 
+void FakeTime::advance_to(dl_time_t time)
+{
+    if (time > _current) {
+        _current = time;
+    }
+}
+
 void FakeTime::add_overhead()
 {
     _current += std::chrono::microseconds(50);
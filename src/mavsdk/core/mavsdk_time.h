@@ -43,6 +43,10 @@ public:
     void sleep_for(std::chrono::microseconds us) override;
     void sleep_for(std::chrono::nanoseconds ns) override;
 
+    // Moves the time to exactly the given point, without the overhead a
+    // sleep adds. Time never goes backwards, earlier points are ignored.
+    void advance_to(dl_time_t time);
+
 private:
     std::chrono::time_point<std::chrono::steady_clock, std::chrono::nanoseconds> _current{};
     void add_overhead();
@@ -0,0 +1,42 @@
+#include "message_id_filter.h"
+#include "log.h"
+
+namespace mavsdk {
+
+void MessageIdFilter::add(uint16_t message_id)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_counts[message_id]++ == 0) {
+        _bits[message_id / 64].fetch_or(1ULL << (message_id % 64), std::memory_order_release);
+    }
+}
+
+void MessageIdFilter::remove(uint16_t message_id)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto found = _counts.find(message_id);
+    if (found == _counts.end()) {
+        LogWarn() << "Removing message ID " << message_id << " which was never added";
+        return;
+    }
+
+    if (--found->second == 0) {
+        _counts.erase(found);
+        _bits[message_id / 64].fetch_and(~(1ULL << (message_id % 64)), std::memory_order_release);
+    }
+}
+
+void MessageIdFilter::add_all()
+{
+    _all.fetch_add(1, std::memory_order_release);
+}
+
+void MessageIdFilter::remove_all()
+{
+    unsigned all = _all.load(std::memory_order_relaxed);
+    while (all > 0 && !_all.compare_exchange_weak(all, all - 1, std::memory_order_release)) {}
+}
+
+} // namespace mavsdk
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace mavsdk {
+
+// The message IDs anyone is interested in, so messages nobody would look at
+// can be dropped right after parsing.
+//
+// Interest is counted, every handler adds its message ID and removes it again
+// when it goes away. The lookup on the receive path is a single bit test
+// without any lock, only changing the interest takes the mutex.
+//
+// Handlers can only be registered for 16 bit message IDs, so anything above is
+// only wanted while everything is.
+class MessageIdFilter {
+public:
+    MessageIdFilter() = default;
+    ~MessageIdFilter() = default;
+
+    // Non-copyable
+    MessageIdFilter(const MessageIdFilter&) = delete;
+    const MessageIdFilter& operator=(const MessageIdFilter&) = delete;
+
+    void add(uint16_t message_id);
+    void remove(uint16_t message_id);
+
+    // For users which need to see every message, e.g. to intercept them.
+    void add_all();
+    void remove_all();
+
+    [[nodiscard]] bool wants(uint32_t message_id) const
+    {
+        if (_all.load(std::memory_order_acquire) > 0) {
+            return true;
+        }
+        if (message_id >= MAX_MESSAGE_IDS) {
+            return false;
+        }
+        return (_bits[message_id / 64].load(std::memory_order_acquire) &
+                (1ULL << (message_id % 64))) != 0;
+    }
+
+private:
+    static constexpr uint32_t MAX_MESSAGE_IDS = 65536;
+
+    std::mutex _mutex{};
+    std::unordered_map<uint16_t, unsigned> _counts{};
+
+    std::array<std::atomic<uint64_t>, MAX_MESSAGE_IDS / 64> _bits{};
+    std::atomic<unsigned> _all{0};
+};
+
+} // namespace mavsdk
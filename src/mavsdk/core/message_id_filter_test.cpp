@@ -0,0 +1,57 @@
+#include "message_id_filter.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(MessageIdFilter, WantsNothingByDefault)
+{
+    MessageIdFilter filter;
+
+    EXPECT_FALSE(filter.wants(0));
+    EXPECT_FALSE(filter.wants(33));
+    EXPECT_FALSE(filter.wants(65535));
+    EXPECT_FALSE(filter.wants(70000));
+}
+
+TEST(MessageIdFilter, CountsInterest)
+{
+    MessageIdFilter filter;
+
+    filter.add(33);
+    filter.add(33);
+    filter.add(64);
+    EXPECT_TRUE(filter.wants(33));
+    EXPECT_TRUE(filter.wants(64));
+    EXPECT_FALSE(filter.wants(32));
+    EXPECT_FALSE(filter.wants(65));
+
+    filter.remove(33);
+    EXPECT_TRUE(filter.wants(33));
+    filter.remove(33);
+    EXPECT_FALSE(filter.wants(33));
+    EXPECT_TRUE(filter.wants(64));
+
+    // Removing more than was added must not underflow.
+    filter.remove(33);
+    filter.add(33);
+    EXPECT_TRUE(filter.wants(33));
+}
+
+TEST(MessageIdFilter, WantsEverythingWhileAllAdded)
+{
+    MessageIdFilter filter;
+
+    filter.add_all();
+    filter.add_all();
+    EXPECT_TRUE(filter.wants(33));
+    EXPECT_TRUE(filter.wants(70000));
+
+    filter.remove_all();
+    EXPECT_TRUE(filter.wants(70000));
+    filter.remove_all();
+    EXPECT_FALSE(filter.wants(33));
+    EXPECT_FALSE(filter.wants(70000));
+
+    filter.remove_all();
+    EXPECT_FALSE(filter.wants(33));
+}
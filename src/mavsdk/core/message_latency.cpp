@@ -0,0 +1,195 @@
+#include "message_latency.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace mavsdk {
+
+static thread_local const MessageLatency::Ingress* current_ingress_on_thread = nullptr;
+
+static unsigned highest_bit(uint64_t value)
+{
+    unsigned bit = 0;
+    for (unsigned shift = 32; shift > 0; shift /= 2) {
+        if ((value >> shift) != 0) {
+            value >>= shift;
+            bit += shift;
+        }
+    }
+    return bit;
+}
+
+static uint64_t elapsed_ns(uint64_t from_ns, uint64_t to_ns)
+{
+    return to_ns > from_ns ? to_ns - from_ns : 0;
+}
+
+void LatencyHistogram::record(uint64_t value_ns)
+{
+    ++_buckets[bucket_index(value_ns)];
+    ++_count;
+    _max_ns = std::max(_max_ns, value_ns);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for (std::size_t i = 0; i < NUM_BUCKETS; ++i) {
+        _buckets[i] += other._buckets[i];
+    }
+    _count += other._count;
+    _max_ns = std::max(_max_ns, other._max_ns);
+}
+
+uint64_t LatencyHistogram::percentile_ns(double percentile) const
+{
+    if (_count == 0) {
+        return 0;
+    }
+
+    const auto target = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(percentile * static_cast<double>(_count))));
+
+    uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < NUM_BUCKETS; ++i) {
+        cumulative += _buckets[i];
+        if (cumulative >= target) {
+            return std::min(bucket_upper_ns(i), _max_ns);
+        }
+    }
+    return _max_ns;
+}
+
+Mavsdk::LatencyStats LatencyHistogram::stats() const
+{
+    Mavsdk::LatencyStats stats;
+    stats.count = _count;
+    stats.p50_ns = percentile_ns(0.5);
+    stats.p99_ns = percentile_ns(0.99);
+    stats.max_ns = _max_ns;
+    return stats;
+}
+
+std::size_t LatencyHistogram::bucket_index(uint64_t value_ns)
+{
+    if (value_ns < SUB_BUCKETS) {
+        return static_cast<std::size_t>(value_ns);
+    }
+
+    // The highest bit selects the power of two, the bits right below it the
+    // bucket within it.
+    const unsigned exponent = highest_bit(value_ns);
+    const auto sub_bucket = (value_ns >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + static_cast<std::size_t>(sub_bucket);
+}
+
+uint64_t LatencyHistogram::bucket_upper_ns(std::size_t index)
+{
+    const std::size_t next = index + 1;
+    if (next >= NUM_BUCKETS) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+    if (next < SUB_BUCKETS) {
+        return next - 1;
+    }
+
+    const std::size_t group = next / SUB_BUCKETS;
+    const uint64_t sub_bucket = next % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub_bucket) << (group - 1)) - 1;
+}
+
+MessageLatency::DispatchScope::DispatchScope(uint32_t message_id, uint64_t time_ns) :
+    _ingress{message_id, time_ns},
+    _previous(current_ingress_on_thread)
+{
+    current_ingress_on_thread = &_ingress;
+}
+
+MessageLatency::DispatchScope::~DispatchScope()
+{
+    current_ingress_on_thread = _previous;
+}
+
+MessageLatency::DispatchTimer::~DispatchTimer()
+{
+    if (!_parent.enabled()) {
+        return;
+    }
+    if (const auto* ingress = current_ingress()) {
+        _parent.record_dispatch(ingress->message_id, ingress->time_ns, now_ns());
+    }
+}
+
+const MessageLatency::Ingress* MessageLatency::current_ingress()
+{
+    return current_ingress_on_thread;
+}
+
+uint64_t MessageLatency::now_ns()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+void MessageLatency::record_dispatch(
+    uint32_t message_id, uint64_t ingress_time_ns, uint64_t done_time_ns)
+{
+    if (!enabled()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    entry_for(message_id).dispatch.record(elapsed_ns(ingress_time_ns, done_time_ns));
+}
+
+void MessageLatency::record_callback(
+    uint32_t message_id, uint64_t ingress_time_ns, uint64_t enqueue_time_ns, uint64_t start_time_ns)
+{
+    if (!enabled()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& entry = entry_for(message_id);
+    entry.queue_wait.record(elapsed_ns(enqueue_time_ns, start_time_ns));
+    entry.callback.record(elapsed_ns(ingress_time_ns, start_time_ns));
+}
+
+std::vector<Mavsdk::MessageLatencyStats> MessageLatency::stats() const
+{
+    std::vector<Mavsdk::MessageLatencyStats> result;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        result.reserve(_entries.size());
+        for (const auto& pair : _entries) {
+            Mavsdk::MessageLatencyStats stats;
+            stats.message_id = pair.first;
+            stats.dispatch = pair.second->dispatch.stats();
+            stats.queue_wait = pair.second->queue_wait.stats();
+            stats.callback = pair.second->callback.stats();
+            result.push_back(stats);
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.message_id < rhs.message_id;
+    });
+    return result;
+}
+
+void MessageLatency::reset()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+}
+
+MessageLatency::Entry& MessageLatency::entry_for(uint32_t message_id)
+{
+    auto& entry = _entries[message_id];
+    if (!entry) {
+        entry = std::make_unique<Entry>();
+    }
+    return *entry;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "mavsdk.h"
+
+namespace mavsdk {
+
+// Histogram of durations in nanoseconds with logarithmic buckets.
+//
+// Each power of two is split into 8 buckets, so a percentile is off by at
+// most 12.5%, in exchange recording is a couple of integer operations and
+// the memory use is fixed.
+class LatencyHistogram {
+public:
+    LatencyHistogram() = default;
+    ~LatencyHistogram() = default;
+
+    void record(uint64_t value_ns);
+
+    // Adds the samples of the other histogram.
+    void merge(const LatencyHistogram& other);
+
+    [[nodiscard]] uint64_t count() const { return _count; }
+
+    [[nodiscard]] uint64_t max_ns() const { return _max_ns; }
+
+    // Upper end of the bucket the percentile falls into, at most the maximum.
+    [[nodiscard]] uint64_t percentile_ns(double percentile) const;
+
+    [[nodiscard]] Mavsdk::LatencyStats stats() const;
+
+private:
+    static constexpr unsigned SUB_BUCKET_BITS = 3;
+    static constexpr std::size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr std::size_t NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    static std::size_t bucket_index(uint64_t value_ns);
+    static uint64_t bucket_upper_ns(std::size_t index);
+
+    std::array<uint32_t, NUM_BUCKETS> _buckets{};
+    uint64_t _count{0};
+    uint64_t _max_ns{0};
+};
+
+// Latency of received messages on their way through MAVSDK, per message ID.
+//
+// A message is timestamped when the connection received it. The connection
+// marks it as the message currently dispatched on its thread, so that
+// anything which happens as a consequence of it, such as queueing a user
+// callback, can pick up the timestamp without it being passed around.
+//
+// Recording is off by default, when off it costs a relaxed load per message
+// and callback.
+class MessageLatency {
+public:
+    MessageLatency() = default;
+    ~MessageLatency() = default;
+
+    void set_enabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+
+    [[nodiscard]] bool enabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+    struct Ingress {
+        uint32_t message_id;
+        uint64_t time_ns;
+    };
+
+    // Marks a message as being dispatched on this thread while it exists.
+    class DispatchScope {
+    public:
+        DispatchScope(uint32_t message_id, uint64_t time_ns);
+        ~DispatchScope();
+
+        // Non-copyable
+        DispatchScope(const DispatchScope&) = delete;
+        const DispatchScope& operator=(const DispatchScope&) = delete;
+
+    private:
+        Ingress _ingress;
+        const Ingress* _previous;
+    };
+
+    // Records the dispatch time of the current message once it goes out of scope.
+    class DispatchTimer {
+    public:
+        explicit DispatchTimer(MessageLatency& parent) : _parent(parent) {}
+        ~DispatchTimer();
+
+        // Non-copyable
+        DispatchTimer(const DispatchTimer&) = delete;
+        const DispatchTimer& operator=(const DispatchTimer&) = delete;
+
+    private:
+        MessageLatency& _parent;
+    };
+
+    // Message dispatched on this thread, nullptr if there is none.
+    static const Ingress* current_ingress();
+
+    // Monotonic time used for all timestamps.
+    static uint64_t now_ns();
+
+    void record_dispatch(uint32_t message_id, uint64_t ingress_time_ns, uint64_t done_time_ns);
+    void record_callback(
+        uint32_t message_id,
+        uint64_t ingress_time_ns,
+        uint64_t enqueue_time_ns,
+        uint64_t start_time_ns);
+
+    [[nodiscard]] std::vector<Mavsdk::MessageLatencyStats> stats() const;
+
+    void reset();
+
+    // Non-copyable
+    MessageLatency(const MessageLatency&) = delete;
+    const MessageLatency& operator=(const MessageLatency&) = delete;
+
+private:
+    struct Entry {
+        LatencyHistogram dispatch{};
+        LatencyHistogram queue_wait{};
+        LatencyHistogram callback{};
+    };
+
+    Entry& entry_for(uint32_t message_id);
+
+    std::atomic<bool> _enabled{false};
+    mutable std::mutex _mutex{};
+    std::unordered_map<uint32_t, std::unique_ptr<Entry>> _entries{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,121 @@
+#include "message_latency.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(LatencyHistogram, EmptyHasNoSamples)
+{
+    LatencyHistogram histogram;
+
+    const auto stats = histogram.stats();
+    EXPECT_EQ(stats.count, 0);
+    EXPECT_EQ(stats.p50_ns, 0);
+    EXPECT_EQ(stats.p99_ns, 0);
+    EXPECT_EQ(stats.max_ns, 0);
+}
+
+TEST(LatencyHistogram, SmallValuesAreExact)
+{
+    LatencyHistogram histogram;
+    for (uint64_t i = 0; i < 8; ++i) {
+        histogram.record(i);
+    }
+
+    EXPECT_EQ(histogram.count(), 8);
+    EXPECT_EQ(histogram.percentile_ns(0.5), 3);
+    EXPECT_EQ(histogram.max_ns(), 7);
+}
+
+TEST(LatencyHistogram, PercentilesWithinBucketAccuracy)
+{
+    LatencyHistogram histogram;
+    // 1 to 1000 microseconds.
+    for (uint64_t i = 1; i <= 1000; ++i) {
+        histogram.record(i * 1000);
+    }
+
+    const auto stats = histogram.stats();
+    EXPECT_EQ(stats.count, 1000);
+    EXPECT_EQ(stats.max_ns, 1000000);
+    EXPECT_GE(stats.p50_ns, 500000);
+    EXPECT_LE(stats.p50_ns, 500000 * 1.125);
+    EXPECT_GE(stats.p99_ns, 990000);
+    EXPECT_LE(stats.p99_ns, 1000000);
+}
+
+TEST(LatencyHistogram, SpikeShowsInMaxOnly)
+{
+    LatencyHistogram histogram;
+    for (int i = 0; i < 999; ++i) {
+        histogram.record(100000);
+    }
+    histogram.record(20000000);
+
+    const auto stats = histogram.stats();
+    EXPECT_LE(stats.p99_ns, 100000 * 1.125);
+    EXPECT_EQ(stats.max_ns, 20000000);
+}
+
+TEST(MessageLatency, TracksCurrentIngress)
+{
+    EXPECT_EQ(MessageLatency::current_ingress(), nullptr);
+    {
+        const MessageLatency::DispatchScope outer{30, 1000};
+        ASSERT_NE(MessageLatency::current_ingress(), nullptr);
+        EXPECT_EQ(MessageLatency::current_ingress()->message_id, 30);
+        {
+            const MessageLatency::DispatchScope inner{31, 2000};
+            EXPECT_EQ(MessageLatency::current_ingress()->message_id, 31);
+            EXPECT_EQ(MessageLatency::current_ingress()->time_ns, 2000);
+        }
+        EXPECT_EQ(MessageLatency::current_ingress()->message_id, 30);
+    }
+    EXPECT_EQ(MessageLatency::current_ingress(), nullptr);
+}
+
+TEST(MessageLatency, RecordsPerMessageId)
+{
+    MessageLatency latency;
+    latency.set_enabled(true);
+
+    latency.record_dispatch(33, 1000, 3000);
+    latency.record_callback(33, 1000, 4000, 11000);
+    latency.record_callback(30, 1000, 2000, 2500);
+    {
+        const MessageLatency::DispatchScope scope{30, MessageLatency::now_ns()};
+        const MessageLatency::DispatchTimer timer{latency};
+    }
+
+    const auto stats = latency.stats();
+    ASSERT_EQ(stats.size(), 2);
+
+    EXPECT_EQ(stats[0].message_id, 30);
+    EXPECT_EQ(stats[0].dispatch.count, 1);
+    EXPECT_EQ(stats[0].callback.max_ns, 1500);
+    EXPECT_EQ(stats[0].queue_wait.max_ns, 500);
+
+    EXPECT_EQ(stats[1].message_id, 33);
+    EXPECT_EQ(stats[1].dispatch.max_ns, 2000);
+    EXPECT_EQ(stats[1].queue_wait.max_ns, 7000);
+    EXPECT_EQ(stats[1].callback.max_ns, 10000);
+
+    latency.reset();
+    EXPECT_TRUE(latency.stats().empty());
+}
+
+TEST(MessageLatency, RecordsNothingUnlessEnabled)
+{
+    MessageLatency latency;
+
+    latency.record_dispatch(33, 1000, 3000);
+    latency.record_callback(33, 1000, 4000, 11000);
+    {
+        const MessageLatency::DispatchScope scope{30, MessageLatency::now_ns()};
+        const MessageLatency::DispatchTimer timer{latency};
+    }
+    EXPECT_TRUE(latency.stats().empty());
+
+    latency.set_enabled(true);
+    latency.record_dispatch(33, 1000, 3000);
+    EXPECT_EQ(latency.stats().size(), 1);
+}
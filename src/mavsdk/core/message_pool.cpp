@@ -0,0 +1,39 @@
+#include "message_pool.h"
+
+namespace mavsdk {
+
+namespace {
+
+thread_local const std::shared_ptr<mavlink_message_t>* current_message_on_thread{nullptr};
+
+} // namespace
+
+MessagePool::MessagePool(std::size_t messages_per_slab) :
+    _pool(make_shared_slab_pool<mavlink_message_t>(messages_per_slab))
+{}
+
+MessagePool::DispatchScope::DispatchScope(const std::shared_ptr<mavlink_message_t>& message) :
+    _previous(current_message_on_thread)
+{
+    current_message_on_thread = &message;
+}
+
+MessagePool::DispatchScope::~DispatchScope()
+{
+    current_message_on_thread = _previous;
+}
+
+std::shared_ptr<mavlink_message_t> MessagePool::make(const mavlink_message_t& message)
+{
+    return make_pooled<mavlink_message_t>(_pool, message);
+}
+
+SharedMessage MessagePool::share(const mavlink_message_t& message)
+{
+    if (current_message_on_thread != nullptr && current_message_on_thread->get() == &message) {
+        return *current_message_on_thread;
+    }
+    return make(message);
+}
+
+} // namespace mavsdk
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include "mavlink_include.h"
+#include "slab_pool.h"
+
+namespace mavsdk {
+
+// Received message which can be held on to without copying it.
+using SharedMessage = std::shared_ptr<const mavlink_message_t>;
+
+// Ref-counted message buffers, so a received message is copied once and then
+// passed on by handle: from the receive thread to the dispatch thread, and
+// on to everyone who needs to keep it beyond its handler, such as queued
+// user callbacks.
+//
+// The buffers come from a SlabPool, once the pool has grown to the number of
+// messages in flight at peak, no buffer needs to be allocated anymore.
+class MessagePool {
+public:
+    explicit MessagePool(std::size_t messages_per_slab = 64);
+    ~MessagePool() = default;
+
+    // Marks the message as being dispatched on this thread while it exists.
+    class DispatchScope {
+    public:
+        explicit DispatchScope(const std::shared_ptr<mavlink_message_t>& message);
+        ~DispatchScope();
+
+        // Non-copyable
+        DispatchScope(const DispatchScope&) = delete;
+        const DispatchScope& operator=(const DispatchScope&) = delete;
+
+    private:
+        const std::shared_ptr<mavlink_message_t>* _previous;
+    };
+
+    // Copies the message into a new buffer. The buffer is mutable until it
+    // is shared, e.g. for the incoming intercept callback to change it.
+    std::shared_ptr<mavlink_message_t> make(const mavlink_message_t& message);
+
+    // The message as handle. If it is the one dispatched on this thread, its
+    // buffer is shared, otherwise it is copied into a new one.
+    SharedMessage share(const mavlink_message_t& message);
+
+    [[nodiscard]] std::size_t messages_in_use() const { return _pool->blocks_in_use(); }
+
+    // Non-copyable
+    MessagePool(const MessagePool&) = delete;
+    const MessagePool& operator=(const MessagePool&) = delete;
+
+private:
+    std::shared_ptr<SlabPool> _pool;
+};
+
+} // namespace mavsdk
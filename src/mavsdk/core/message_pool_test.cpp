@@ -0,0 +1,79 @@
+#include "message_pool.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(MessagePool, MakeCopiesIntoBuffer)
+{
+    MessagePool pool;
+
+    mavlink_message_t message{};
+    message.msgid = 42;
+    message.sysid = 7;
+
+    auto buffer = pool.make(message);
+    EXPECT_NE(buffer.get(), &message);
+    EXPECT_EQ(buffer->msgid, 42);
+    EXPECT_EQ(buffer->sysid, 7);
+    EXPECT_EQ(pool.messages_in_use(), 1);
+
+    buffer.reset();
+    EXPECT_EQ(pool.messages_in_use(), 0);
+}
+
+TEST(MessagePool, ShareReusesDispatchedBuffer)
+{
+    MessagePool pool;
+
+    mavlink_message_t message{};
+    message.msgid = 1;
+    const auto buffer = pool.make(message);
+
+    {
+        MessagePool::DispatchScope scope{buffer};
+
+        // Handlers get a reference into the buffer, holding on to it is free.
+        const auto first = pool.share(*buffer);
+        const auto second = pool.share(*buffer);
+        EXPECT_EQ(first.get(), buffer.get());
+        EXPECT_EQ(second.get(), buffer.get());
+        EXPECT_EQ(pool.messages_in_use(), 1);
+
+        // Anything else is copied.
+        const auto other = pool.share(message);
+        EXPECT_NE(other.get(), buffer.get());
+        EXPECT_EQ(pool.messages_in_use(), 2);
+    }
+
+    // Outside of the dispatch, it's copied as well.
+    const auto copy = pool.share(*buffer);
+    EXPECT_NE(copy.get(), buffer.get());
+}
+
+TEST(MessagePool, ScopesNest)
+{
+    MessagePool pool;
+
+    mavlink_message_t message{};
+    const auto outer = pool.make(message);
+    const auto inner = pool.make(message);
+
+    MessagePool::DispatchScope outer_scope{outer};
+    {
+        MessagePool::DispatchScope inner_scope{inner};
+        EXPECT_EQ(pool.share(*inner).get(), inner.get());
+    }
+    EXPECT_EQ(pool.share(*outer).get(), outer.get());
+}
+
+TEST(MessagePool, BuffersOutliveThePool)
+{
+    SharedMessage message;
+    {
+        MessagePool pool;
+        mavlink_message_t original{};
+        original.msgid = 3;
+        message = pool.make(original);
+    }
+    EXPECT_EQ(message->msgid, 3);
+}
@@ -0,0 +1,114 @@
+#include "message_rates.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mavsdk {
+
+static_assert(
+    (MessageRates::CAPACITY & (MessageRates::CAPACITY - 1)) == 0,
+    "Capacity needs to be a power of two");
+
+// Gains as for the interarrival jitter of RTP (RFC 3550), with the interval
+// following a bit faster, so a changed rate shows within a few messages.
+static constexpr double INTERVAL_GAIN = 1.0 / 8.0;
+static constexpr double JITTER_GAIN = 1.0 / 16.0;
+
+MessageRates::Entry* MessageRates::find_or_insert_locked(uint32_t key)
+{
+    std::size_t index = (key * 2654435761u) & (CAPACITY - 1);
+    for (std::size_t probe = 0; probe < CAPACITY; ++probe) {
+        Entry& entry = _entries[index];
+        if (!entry.used) {
+            entry.used = true;
+            entry.key = key;
+            return &entry;
+        }
+        if (entry.key == key) {
+            return &entry;
+        }
+        index = (index + 1) & (CAPACITY - 1);
+    }
+    return nullptr;
+}
+
+void MessageRates::add(uint8_t component_id, uint32_t message_id, uint64_t time_ns)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Entry* entry = find_or_insert_locked(key_for(component_id, message_id));
+    if (entry == nullptr) {
+        ++_untracked;
+        return;
+    }
+
+    if (entry->messages > 0 && time_ns > entry->last_ns) {
+        const auto interval_ns = static_cast<double>(time_ns - entry->last_ns);
+        if (entry->messages == 1) {
+            entry->interval_ns = interval_ns;
+        } else {
+            entry->jitter_ns += (std::abs(interval_ns - entry->interval_ns) - entry->jitter_ns) *
+                                JITTER_GAIN;
+            entry->interval_ns += (interval_ns - entry->interval_ns) * INTERVAL_GAIN;
+        }
+    }
+
+    entry->last_ns = std::max(entry->last_ns, time_ns);
+    ++entry->messages;
+}
+
+void MessageRates::set_requested(uint8_t component_id, uint32_t message_id, double rate_hz)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Entry* entry = find_or_insert_locked(key_for(component_id, message_id));
+    if (entry == nullptr) {
+        return;
+    }
+    entry->requested = true;
+    entry->requested_rate_hz = static_cast<float>(rate_hz);
+}
+
+std::vector<System::MessageRate> MessageRates::rates(uint64_t now_ns) const
+{
+    std::vector<System::MessageRate> result;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& entry : _entries) {
+        if (!entry.used) {
+            continue;
+        }
+
+        System::MessageRate rate{};
+        rate.component_id = static_cast<uint8_t>(entry.key >> 24);
+        rate.message_id = entry.key & 0xffffff;
+        rate.messages = entry.messages;
+        rate.rate_requested = entry.requested;
+        rate.requested_rate_hz = entry.requested_rate_hz;
+
+        if (entry.messages >= 2) {
+            // Once overdue, the time waited so far is the better estimate.
+            const double since_last_ns =
+                now_ns > entry.last_ns ? static_cast<double>(now_ns - entry.last_ns) : 0.0;
+            const double interval_ns = std::max(entry.interval_ns, since_last_ns);
+            rate.rate_hz = interval_ns > 0.0 ? 1e9 / interval_ns : 0.0;
+            rate.jitter_s = entry.jitter_ns * 1e-9;
+        }
+
+        result.push_back(rate);
+    }
+
+    std::sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.component_id != rhs.component_id ? lhs.component_id < rhs.component_id :
+                                                      lhs.message_id < rhs.message_id;
+    });
+    return result;
+}
+
+std::size_t MessageRates::untracked() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _untracked;
+}
+
+} // namespace mavsdk
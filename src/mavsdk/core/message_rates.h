@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "system.h"
+
+namespace mavsdk {
+
+// Rate and jitter of the messages received from one system, by component
+// and message ID, next to the rate requested with SET_MESSAGE_INTERVAL.
+//
+// The entries live in a fixed open-addressing table, so receiving a message
+// never allocates. Messages of further IDs are not tracked once it is full.
+class MessageRates {
+public:
+    // Plenty for the few dozen messages an autopilot and its peripherals send.
+    static constexpr std::size_t CAPACITY = 128;
+
+    MessageRates() = default;
+    ~MessageRates() = default;
+
+    // Non-copyable
+    MessageRates(const MessageRates&) = delete;
+    const MessageRates& operator=(const MessageRates&) = delete;
+
+    void add(uint8_t component_id, uint32_t message_id, uint64_t time_ns);
+
+    // 0 for the default rate, negative for stopped, as for SET_MESSAGE_INTERVAL.
+    void set_requested(uint8_t component_id, uint32_t message_id, double rate_hz);
+
+    // Ordered by component and message ID. A message that stopped coming in
+    // decays towards 0 Hz.
+    [[nodiscard]] std::vector<System::MessageRate> rates(uint64_t now_ns) const;
+
+    [[nodiscard]] std::size_t untracked() const;
+
+private:
+    struct Entry {
+        uint32_t key{0};
+        bool used{false};
+        bool requested{false};
+        float requested_rate_hz{0.0f};
+        uint64_t messages{0};
+        uint64_t last_ns{0};
+        // Smoothed inter-arrival time, and its mean deviation as jitter.
+        double interval_ns{0.0};
+        double jitter_ns{0.0};
+    };
+
+    static uint32_t key_for(uint8_t component_id, uint32_t message_id)
+    {
+        return (static_cast<uint32_t>(component_id) << 24) | (message_id & 0xffffff);
+    }
+
+    Entry* find_or_insert_locked(uint32_t key);
+
+    mutable std::mutex _mutex{};
+    std::array<Entry, CAPACITY> _entries{};
+    std::size_t _untracked{0};
+};
+
+} // namespace mavsdk
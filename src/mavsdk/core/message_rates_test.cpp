@@ -0,0 +1,100 @@
+#include "message_rates.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+static constexpr uint64_t MS = 1000000;
+
+TEST(MessageRates, EmptyHasNoRates)
+{
+    MessageRates rates;
+    EXPECT_TRUE(rates.rates(0).empty());
+}
+
+TEST(MessageRates, SteadyRateWithoutJitter)
+{
+    MessageRates rates;
+    // 50 Hz
+    for (uint64_t i = 0; i < 100; ++i) {
+        rates.add(1, 30, i * 20 * MS);
+    }
+
+    const auto result = rates.rates(99 * 20 * MS);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0].component_id, 1);
+    EXPECT_EQ(result[0].message_id, 30);
+    EXPECT_EQ(result[0].messages, 100);
+    EXPECT_NEAR(result[0].rate_hz, 50.0, 0.01);
+    EXPECT_NEAR(result[0].jitter_s, 0.0, 1e-9);
+    EXPECT_FALSE(result[0].rate_requested);
+}
+
+TEST(MessageRates, AlternatingIntervalsShowAsJitter)
+{
+    MessageRates rates;
+    uint64_t time_ns = 0;
+    for (int i = 0; i < 200; ++i) {
+        rates.add(1, 30, time_ns);
+        time_ns += (i % 2 == 0) ? 15 * MS : 25 * MS;
+    }
+
+    const auto result = rates.rates(time_ns - 15 * MS);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_NEAR(result[0].rate_hz, 50.0, 5.0);
+    EXPECT_GT(result[0].jitter_s, 0.003);
+    EXPECT_LT(result[0].jitter_s, 0.007);
+}
+
+TEST(MessageRates, RateDecaysWhenMessagesStop)
+{
+    MessageRates rates;
+    for (uint64_t i = 0; i < 10; ++i) {
+        rates.add(1, 30, i * 10 * MS);
+    }
+
+    const auto result = rates.rates(9 * 10 * MS + 1000 * MS);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_NEAR(result[0].rate_hz, 1.0, 0.01);
+}
+
+TEST(MessageRates, RequestedRateNextToActualRate)
+{
+    MessageRates rates;
+    rates.set_requested(1, 32, 10.0);
+    rates.add(1, 32, 0);
+    rates.add(1, 32, 200 * MS);
+    rates.add(1, 33, 0);
+
+    const auto result = rates.rates(200 * MS);
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_EQ(result[0].message_id, 32);
+    EXPECT_TRUE(result[0].rate_requested);
+    EXPECT_DOUBLE_EQ(result[0].requested_rate_hz, 10.0);
+    EXPECT_NEAR(result[0].rate_hz, 5.0, 0.01);
+    EXPECT_EQ(result[1].message_id, 33);
+    EXPECT_FALSE(result[1].rate_requested);
+    EXPECT_DOUBLE_EQ(result[1].rate_hz, 0.0);
+}
+
+TEST(MessageRates, ComponentsAreSeparate)
+{
+    MessageRates rates;
+    rates.add(100, 0, 0);
+    rates.add(1, 0, 0);
+
+    const auto result = rates.rates(0);
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_EQ(result[0].component_id, 1);
+    EXPECT_EQ(result[1].component_id, 100);
+}
+
+TEST(MessageRates, FullTableCountsUntracked)
+{
+    MessageRates rates;
+    for (uint32_t id = 0; id < MessageRates::CAPACITY + 5; ++id) {
+        rates.add(1, id, 0);
+    }
+
+    EXPECT_EQ(rates.rates(0).size(), MessageRates::CAPACITY);
+    EXPECT_EQ(rates.untracked(), 5);
+}
@@ -0,0 +1,115 @@
+#include "mission_cache.h"
+#include "cache_file.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mavsdk {
+
+// Bump the last char whenever the format changes, old caches are then just
+// ignored.
+static const std::vector<uint8_t> file_magic = {'M', 'M', 'C', '1'};
+static constexpr std::size_t header_len = 4 + 4 + 1 + 4;
+static constexpr std::size_t item_len = 2 + 1 + 2 + 1 + 1 + 4 * 4 + 4 + 4 + 4 + 1;
+
+static void put_float(std::vector<uint8_t>& buffer, float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    cache_put_uint(buffer, bits, 4);
+}
+
+static bool get_float(const std::vector<uint8_t>& buffer, std::size_t& pos, float& value)
+{
+    uint64_t bits;
+    if (!cache_get_uint(buffer, pos, 4, bits)) {
+        return false;
+    }
+    const auto raw = static_cast<uint32_t>(bits);
+    std::memcpy(&value, &raw, sizeof(value));
+    return true;
+}
+
+bool mission_cache_save(const std::string& path, const MissionCache& cache)
+{
+    std::vector<uint8_t> buffer;
+    buffer.reserve(header_len + cache.items.size() * item_len + 4);
+
+    buffer.insert(buffer.end(), file_magic.begin(), file_magic.end());
+    cache_put_uint(buffer, cache.opaque_id, 4);
+    cache_put_uint(buffer, cache.mission_type, 1);
+    cache_put_uint(buffer, cache.items.size(), 4);
+
+    for (const auto& item : cache.items) {
+        cache_put_uint(buffer, item.seq, 2);
+        cache_put_uint(buffer, item.frame, 1);
+        cache_put_uint(buffer, item.command, 2);
+        cache_put_uint(buffer, item.current, 1);
+        cache_put_uint(buffer, item.autocontinue, 1);
+        put_float(buffer, item.param1);
+        put_float(buffer, item.param2);
+        put_float(buffer, item.param3);
+        put_float(buffer, item.param4);
+        cache_put_uint(buffer, static_cast<uint32_t>(item.x), 4);
+        cache_put_uint(buffer, static_cast<uint32_t>(item.y), 4);
+        put_float(buffer, item.z);
+        cache_put_uint(buffer, item.mission_type, 1);
+    }
+
+    return cache_file_write(path, std::move(buffer));
+}
+
+std::optional<MissionCache> mission_cache_load(const std::string& path)
+{
+    const auto buffer = cache_file_read(path, file_magic);
+    if (!buffer || buffer->size() < header_len) {
+        return std::nullopt;
+    }
+
+    MissionCache cache;
+    std::size_t pos = file_magic.size();
+    uint64_t opaque_id;
+    uint64_t mission_type;
+    uint64_t count;
+    cache_get_uint(*buffer, pos, 4, opaque_id);
+    cache_get_uint(*buffer, pos, 1, mission_type);
+    cache_get_uint(*buffer, pos, 4, count);
+    cache.opaque_id = static_cast<uint32_t>(opaque_id);
+    cache.mission_type = static_cast<uint8_t>(mission_type);
+
+    // The CRC matched, so anything not adding up is a bug rather than a
+    // damaged file, but let's not trust it either way.
+    cache.items.reserve(
+        static_cast<std::size_t>(std::min<uint64_t>(count, buffer->size() / item_len)));
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t seq, frame, command, current, autocontinue, x, y, type;
+        MAVLinkMissionTransfer::ItemInt item{};
+        if (!cache_get_uint(*buffer, pos, 2, seq) || !cache_get_uint(*buffer, pos, 1, frame) ||
+            !cache_get_uint(*buffer, pos, 2, command) ||
+            !cache_get_uint(*buffer, pos, 1, current) ||
+            !cache_get_uint(*buffer, pos, 1, autocontinue) ||
+            !get_float(*buffer, pos, item.param1) || !get_float(*buffer, pos, item.param2) ||
+            !get_float(*buffer, pos, item.param3) || !get_float(*buffer, pos, item.param4) ||
+            !cache_get_uint(*buffer, pos, 4, x) || !cache_get_uint(*buffer, pos, 4, y) ||
+            !get_float(*buffer, pos, item.z) || !cache_get_uint(*buffer, pos, 1, type)) {
+            return std::nullopt;
+        }
+        item.seq = static_cast<uint16_t>(seq);
+        item.frame = static_cast<uint8_t>(frame);
+        item.command = static_cast<uint16_t>(command);
+        item.current = static_cast<uint8_t>(current);
+        item.autocontinue = static_cast<uint8_t>(autocontinue);
+        item.x = static_cast<int32_t>(static_cast<uint32_t>(x));
+        item.y = static_cast<int32_t>(static_cast<uint32_t>(y));
+        item.mission_type = static_cast<uint8_t>(type);
+        cache.items.push_back(item);
+    }
+
+    if (pos != buffer->size()) {
+        return std::nullopt;
+    }
+
+    return cache;
+}
+
+} // namespace mavsdk
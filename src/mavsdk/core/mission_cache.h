@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "mavlink_mission_transfer.h"
+
+namespace mavsdk {
+
+// The items of one mission type on a vehicle together with the opaque id
+// the vehicle reported for them, so they can be reused as long as the id
+// doesn't change.
+struct MissionCache {
+    uint32_t opaque_id{0};
+    uint8_t mission_type{0};
+    std::vector<MAVLinkMissionTransfer::ItemInt> items{};
+};
+
+// The file is binary, written with cache_file_write(): a small header with
+// the opaque id, the mission type and the number of items, then each item's
+// fields in little endian.
+bool mission_cache_save(const std::string& path, const MissionCache& cache);
+
+// Returns nullopt if there is no cache or it can't be used.
+std::optional<MissionCache> mission_cache_load(const std::string& path);
+
+} // namespace mavsdk
@@ -0,0 +1,100 @@
+#include "mission_cache.h"
+#include "fs.h"
+
+#include <cmath>
+#include <fstream>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+std::vector<MAVLinkMissionTransfer::ItemInt> example_items()
+{
+    return {
+        MAVLinkMissionTransfer::ItemInt{
+            0, 6, 16, 1, 1, 0.0f, 0.5f, NAN, NAN, 473977418, 85455939, 10.0f, 0},
+        MAVLinkMissionTransfer::ItemInt{
+            1, 6, 16, 0, 1, 1.0f, -2.5f, 3.0f, 90.0f, -473977418, -85455939, -1.5f, 0},
+        MAVLinkMissionTransfer::ItemInt{
+            2, 2, 20, 0, 0, NAN, NAN, NAN, NAN, 0, 0, NAN, 0},
+    };
+}
+} // namespace
+
+TEST(MissionCache, SaveAndLoad)
+{
+    const auto dir = create_tmp_directory("mavsdk-mission-cache-test");
+    ASSERT_TRUE(dir);
+    const auto path = *dir + path_separator + "cache.mission";
+
+    MissionCache cache;
+    cache.opaque_id = 0xdeadbeef;
+    cache.mission_type = 0;
+    cache.items = example_items();
+    ASSERT_TRUE(mission_cache_save(path, cache));
+
+    const auto loaded = mission_cache_load(path);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->opaque_id, 0xdeadbeef);
+    EXPECT_EQ(loaded->mission_type, 0);
+    EXPECT_EQ(loaded->items, cache.items);
+
+    fs_remove(path);
+}
+
+TEST(MissionCache, EmptyMission)
+{
+    const auto dir = create_tmp_directory("mavsdk-mission-cache-test");
+    ASSERT_TRUE(dir);
+    const auto path = *dir + path_separator + "empty.fence";
+
+    MissionCache cache;
+    cache.opaque_id = 42;
+    cache.mission_type = 1;
+    ASSERT_TRUE(mission_cache_save(path, cache));
+
+    const auto loaded = mission_cache_load(path);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->opaque_id, 42);
+    EXPECT_EQ(loaded->mission_type, 1);
+    EXPECT_TRUE(loaded->items.empty());
+
+    fs_remove(path);
+}
+
+TEST(MissionCache, MissingFile)
+{
+    EXPECT_FALSE(mission_cache_load("/this/does/not/exist.mission"));
+}
+
+TEST(MissionCache, RejectsCorruptFile)
+{
+    const auto dir = create_tmp_directory("mavsdk-mission-cache-test");
+    ASSERT_TRUE(dir);
+    const auto path = *dir + path_separator + "corrupt.mission";
+
+    MissionCache cache;
+    cache.opaque_id = 1;
+    cache.items = example_items();
+    ASSERT_TRUE(mission_cache_save(path, cache));
+
+    // Flip a bit in the middle of the file.
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(30);
+        char c;
+        file.get(c);
+        file.seekp(30);
+        file.put(static_cast<char>(c ^ 0x01));
+    }
+    EXPECT_FALSE(mission_cache_load(path));
+
+    // Truncated
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write("MMC1", 4);
+    }
+    EXPECT_FALSE(mission_cache_load(path));
+
+    fs_remove(path);
+}
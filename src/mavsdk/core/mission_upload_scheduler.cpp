@@ -0,0 +1,179 @@
+#include "mission_upload_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace mavsdk {
+
+// The largest MAVLink 2 frame, signed. The budget always allows one of them
+// to go out, however small it is.
+static constexpr double min_burst_bytes = 280.0;
+
+MissionUploadScheduler::MissionUploadScheduler(const Config& config, Time& time) :
+    _config(config),
+    _time(time)
+{
+    _max_tokens = std::max(_config.link_budget_bytes_s * _config.burst_s, min_burst_bytes);
+    _tokens = _max_tokens;
+    _last_refill = _time.steady_time();
+}
+
+void MissionUploadScheduler::add_upload(Start start)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _waiting.push_back(std::move(start));
+    }
+    start_waiting();
+}
+
+void MissionUploadScheduler::upload_done()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_running > 0) {
+            --_running;
+        }
+    }
+    start_waiting();
+}
+
+void MissionUploadScheduler::start_waiting()
+{
+    while (true) {
+        Start start;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_waiting.empty() || (_config.max_concurrent_uploads != 0 &&
+                                     _running >= _config.max_concurrent_uploads)) {
+                return;
+            }
+            start = std::move(_waiting.front());
+            _waiting.pop_front();
+            ++_running;
+        }
+        // The upload might be done right away and free its slot again.
+        start();
+    }
+}
+
+bool MissionUploadScheduler::send(const void* upload, std::size_t bytes, bool retry, Send send)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (replace_queued(upload, bytes, retry, send)) {
+            return true;
+        }
+
+        if (!unlimited()) {
+            refill();
+            if (!_retries.empty() || !_firsts.empty() || !take(bytes)) {
+                auto& queue = retry ? _retries : _firsts;
+                queue.push_back(Queued{upload, bytes, std::move(send)});
+                return true;
+            }
+        }
+    }
+
+    return send();
+}
+
+bool MissionUploadScheduler::replace_queued(
+    const void* upload, std::size_t bytes, bool retry, Send& send)
+{
+    const auto matches = [upload](const Queued& queued) { return queued.upload == upload; };
+
+    auto it = std::find_if(_retries.begin(), _retries.end(), matches);
+    if (it != _retries.end()) {
+        // Keeps its place, the vehicle only waits for the newer message.
+        it->bytes = bytes;
+        it->send = std::move(send);
+        return true;
+    }
+
+    it = std::find_if(_firsts.begin(), _firsts.end(), matches);
+    if (it == _firsts.end()) {
+        return false;
+    }
+    if (retry) {
+        _firsts.erase(it);
+        _retries.push_back(Queued{upload, bytes, std::move(send)});
+    } else {
+        it->bytes = bytes;
+        it->send = std::move(send);
+    }
+    return true;
+}
+
+void MissionUploadScheduler::drop(const void* upload)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto matches = [upload](const Queued& queued) { return queued.upload == upload; };
+    _retries.erase(std::remove_if(_retries.begin(), _retries.end(), matches), _retries.end());
+    _firsts.erase(std::remove_if(_firsts.begin(), _firsts.end(), matches), _firsts.end());
+}
+
+void MissionUploadScheduler::pump()
+{
+    std::vector<Send> due;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        refill();
+        while (!_retries.empty() || !_firsts.empty()) {
+            auto& queue = !_retries.empty() ? _retries : _firsts;
+            if (!take(queue.front().bytes)) {
+                break;
+            }
+            due.push_back(std::move(queue.front().send));
+            queue.pop_front();
+        }
+    }
+
+    // Sent without the lock held, so an upload can queue its next message.
+    for (auto& send : due) {
+        send();
+    }
+}
+
+void MissionUploadScheduler::refill()
+{
+    const auto now = _time.steady_time();
+    const double elapsed_s = std::chrono::duration<double>(now - _last_refill).count();
+    _last_refill = now;
+    if (elapsed_s > 0.0) {
+        _tokens = std::min(_tokens + elapsed_s * _config.link_budget_bytes_s, _max_tokens);
+    }
+}
+
+bool MissionUploadScheduler::take(std::size_t bytes)
+{
+    if (unlimited()) {
+        return true;
+    }
+    if (_tokens < static_cast<double>(bytes)) {
+        return false;
+    }
+    _tokens -= static_cast<double>(bytes);
+    return true;
+}
+
+std::size_t MissionUploadScheduler::num_running() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _running;
+}
+
+std::size_t MissionUploadScheduler::num_waiting() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _waiting.size();
+}
+
+std::size_t MissionUploadScheduler::num_queued() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _retries.size() + _firsts.size();
+}
+
+} // namespace mavsdk
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include "mavsdk_time.h"
+#include "unique_function.h"
+
+namespace mavsdk {
+
+// Shares one link between the mission uploads to many vehicles.
+//
+// Only so many uploads run at once, the others wait for a slot. The messages
+// of the ones running go out within a budget of bytes per second, and what
+// does not fit right away is queued. As the mission protocol answers one
+// request at a time, an upload has at most one message queued: a newer one,
+// e.g. the answer to a request repeated by the vehicle, takes the place of
+// the older one instead of adding to the traffic. Answers to repeated
+// requests and repeated counts go first, as the vehicle is already waiting
+// for them, all others take turns in the order they came in, so the
+// uploads progress side by side.
+class MissionUploadScheduler {
+public:
+    struct Config {
+        // Bytes per second for all uploads together, 0 for no limit.
+        double link_budget_bytes_s{0.0};
+        // What can go out back to back after a pause, in seconds of budget.
+        double burst_s{0.1};
+        // Uploads running at once, 0 for no limit.
+        unsigned max_concurrent_uploads{4};
+    };
+
+    // Returns false if the message could not be sent.
+    using Send = UniqueFunction<bool()>;
+    using Start = UniqueFunction<void()>;
+
+    MissionUploadScheduler(const Config& config, Time& time);
+    ~MissionUploadScheduler() = default;
+
+    // Starts the upload right away if there is a free slot, otherwise once
+    // one is freed with upload_done(). Called without any lock held.
+    void add_upload(Start start);
+    void upload_done();
+
+    // Sends right away if the budget allows and nothing is queued, in which
+    // case the result of send is returned. Otherwise it is queued for pump(),
+    // and a failure there is left to the timeouts of the upload.
+    bool send(const void* upload, std::size_t bytes, bool retry, Send send);
+
+    // Drops what an upload still has queued, needs to be called before the
+    // upload is gone.
+    void drop(const void* upload);
+
+    // Sends what is queued as far as the budget allows, to be called
+    // regularly while uploads are running.
+    void pump();
+
+    std::size_t num_running() const;
+    std::size_t num_waiting() const;
+    std::size_t num_queued() const;
+
+    // Non-copyable
+    MissionUploadScheduler(const MissionUploadScheduler&) = delete;
+    const MissionUploadScheduler& operator=(const MissionUploadScheduler&) = delete;
+
+private:
+    struct Queued {
+        const void* upload{nullptr};
+        std::size_t bytes{0};
+        Send send{};
+    };
+
+    bool unlimited() const { return _config.link_budget_bytes_s <= 0.0; }
+    void refill();
+    bool take(std::size_t bytes);
+    bool replace_queued(const void* upload, std::size_t bytes, bool retry, Send& send);
+    void start_waiting();
+
+    const Config _config;
+    Time& _time;
+
+    mutable std::mutex _mutex{};
+    double _tokens{0.0};
+    double _max_tokens{0.0};
+    dl_time_t _last_refill{};
+    std::deque<Queued> _retries{};
+    std::deque<Queued> _firsts{};
+    std::deque<Start> _waiting{};
+    std::size_t _running{0};
+};
+
+} // namespace mavsdk
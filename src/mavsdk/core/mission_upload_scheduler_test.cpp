@@ -0,0 +1,180 @@
+#include <chrono>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "mission_upload_scheduler.h"
+
+using namespace mavsdk;
+
+namespace {
+
+// Records what went out, in order.
+class Link {
+public:
+    MissionUploadScheduler::Send message(const std::string& name)
+    {
+        return [this, name]() {
+            sent.push_back(name);
+            return true;
+        };
+    }
+
+    std::vector<std::string> sent;
+};
+
+} // namespace
+
+TEST(MissionUploadScheduler, SendsRightAwayWithoutBudget)
+{
+    FakeTime time;
+    MissionUploadScheduler scheduler{MissionUploadScheduler::Config{0.0, 0.1, 0}, time};
+    Link link;
+
+    const int upload = 0;
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(scheduler.send(&upload, 60, false, link.message("item")));
+    }
+    EXPECT_EQ(link.sent.size(), 100);
+    EXPECT_EQ(scheduler.num_queued(), 0);
+}
+
+TEST(MissionUploadScheduler, ReturnsFailureOfImmediateSend)
+{
+    FakeTime time;
+    MissionUploadScheduler scheduler{MissionUploadScheduler::Config{}, time};
+
+    const int upload = 0;
+    EXPECT_FALSE(scheduler.send(&upload, 60, false, []() { return false; }));
+}
+
+TEST(MissionUploadScheduler, LimitsUploadsRunningAtOnce)
+{
+    FakeTime time;
+    MissionUploadScheduler scheduler{MissionUploadScheduler::Config{0.0, 0.1, 2}, time};
+
+    std::vector<int> started;
+    for (int i = 0; i < 5; ++i) {
+        scheduler.add_upload([&started, i]() { started.push_back(i); });
+    }
+    EXPECT_EQ(started, (std::vector<int>{0, 1}));
+    EXPECT_EQ(scheduler.num_running(), 2);
+    EXPECT_EQ(scheduler.num_waiting(), 3);
+
+    scheduler.upload_done();
+    EXPECT_EQ(started, (std::vector<int>{0, 1, 2}));
+
+    scheduler.upload_done();
+    scheduler.upload_done();
+    scheduler.upload_done();
+    EXPECT_EQ(started, (std::vector<int>{0, 1, 2, 3, 4}));
+    EXPECT_EQ(scheduler.num_running(), 1);
+    EXPECT_EQ(scheduler.num_waiting(), 0);
+}
+
+TEST(MissionUploadScheduler, UploadDoneRightAwayStartsNext)
+{
+    FakeTime time;
+    MissionUploadScheduler scheduler{MissionUploadScheduler::Config{0.0, 0.1, 1}, time};
+
+    int started = 0;
+    for (int i = 0; i < 3; ++i) {
+        scheduler.add_upload([&]() {
+            ++started;
+            // E.g. an empty mission, refused before anything is sent.
+            scheduler.upload_done();
+        });
+    }
+    EXPECT_EQ(started, 3);
+    EXPECT_EQ(scheduler.num_running(), 0);
+}
+
+TEST(MissionUploadScheduler, StaysWithinBudget)
+{
+    FakeTime time;
+    // 1000 bytes/s allows one 100 byte message each 100 ms, after a burst of
+    // the largest frame.
+    MissionUploadScheduler scheduler{MissionUploadScheduler::Config{1000.0, 0.1, 0}, time};
+    Link link;
+
+    const int upload1 = 0;
+    const int upload2 = 0;
+    const int upload3 = 0;
+    scheduler.send(&upload1, 100, false, link.message("1"));
+    scheduler.send(&upload2, 100, false, link.message("2"));
+    scheduler.send(&upload3, 100, false, link.message("3"));
+    EXPECT_EQ(link.sent, (std::vector<std::string>{"1", "2"}));
+    EXPECT_EQ(scheduler.num_queued(), 1);
+
+    scheduler.pump();
+    EXPECT_EQ(link.sent.size(), 2);
+
+    time.advance_to(time.steady_time() + std::chrono::milliseconds(100));
+    scheduler.pump();
+    EXPECT_EQ(link.sent, (std::vector<std::string>{"1", "2", "3"}));
+    EXPECT_EQ(scheduler.num_queued(), 0);
+}
+
+TEST(MissionUploadScheduler, InterleavesUploadsAndPrefersRetries)
+{
+    FakeTime time;
+    MissionUploadScheduler scheduler{MissionUploadScheduler::Config{1000.0, 0.1, 0}, time};
+    Link link;
+
+    const int upload1 = 0;
+    const int upload2 = 0;
+    const int upload3 = 0;
+
+    // Uses up the budget.
+    scheduler.send(&upload1, 280, false, link.message("1:0"));
+    ASSERT_EQ(link.sent.size(), 1);
+
+    scheduler.send(&upload1, 100, false, link.message("1:1"));
+    scheduler.send(&upload2, 100, false, link.message("2:0"));
+    scheduler.send(&upload3, 100, false, link.message("3:0"));
+    // Upload 2 did not get an answer in time, the vehicle asks again.
+    scheduler.send(&upload2, 100, true, link.message("2:0 again"));
+    EXPECT_EQ(scheduler.num_queued(), 3);
+
+    for (int i = 0; i < 3; ++i) {
+        time.advance_to(time.steady_time() + std::chrono::milliseconds(100));
+        scheduler.pump();
+    }
+    EXPECT_EQ(link.sent, (std::vector<std::string>{"1:0", "2:0 again", "1:1", "3:0"}));
+}
+
+TEST(MissionUploadScheduler, NewerMessageReplacesQueuedOne)
+{
+    FakeTime time;
+    MissionUploadScheduler scheduler{MissionUploadScheduler::Config{1000.0, 0.1, 0}, time};
+    Link link;
+
+    const int upload = 0;
+    scheduler.send(&upload, 280, false, link.message("count"));
+    scheduler.send(&upload, 100, true, link.message("count again"));
+    scheduler.send(&upload, 100, true, link.message("count once more"));
+    EXPECT_EQ(scheduler.num_queued(), 1);
+
+    time.advance_to(time.steady_time() + std::chrono::seconds(1));
+    scheduler.pump();
+    EXPECT_EQ(link.sent, (std::vector<std::string>{"count", "count once more"}));
+}
+
+TEST(MissionUploadScheduler, DropsQueuedOfFinishedUpload)
+{
+    FakeTime time;
+    MissionUploadScheduler scheduler{MissionUploadScheduler::Config{1000.0, 0.1, 0}, time};
+    Link link;
+
+    const int upload1 = 0;
+    const int upload2 = 0;
+    scheduler.send(&upload1, 280, false, link.message("1:0"));
+    scheduler.send(&upload1, 100, false, link.message("1:1"));
+    scheduler.send(&upload2, 100, false, link.message("2:0"));
+
+    scheduler.drop(&upload1);
+    EXPECT_EQ(scheduler.num_queued(), 1);
+
+    time.advance_to(time.steady_time() + std::chrono::seconds(1));
+    scheduler.pump();
+    EXPECT_EQ(link.sent, (std::vector<std::string>{"1:0", "2:0"}));
+}
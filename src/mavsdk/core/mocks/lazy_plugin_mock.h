@@ -7,6 +7,9 @@ namespace testing {
 template<typename Plugin> class MockLazyPlugin {
 public:
     MOCK_CONST_METHOD0(maybe_plugin, Plugin*()){};
+
+    // Tests don't care which system a call is routed to.
+    Plugin* maybe_plugin(int /* system_id */) const { return maybe_plugin(); }
 };
 
 } // namespace testing
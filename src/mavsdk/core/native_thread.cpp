@@ -0,0 +1,150 @@
+#include "native_thread.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <utility>
+
+#if !defined(WINDOWS)
+#include <climits>
+#include <unistd.h>
+#endif
+
+namespace mavsdk {
+
+#if !defined(WINDOWS)
+namespace {
+
+struct Start {
+    std::function<void()> func;
+    std::promise<std::thread::id> started;
+};
+
+std::size_t valid_stack_size(std::size_t stack_size_bytes)
+{
+    // PTHREAD_STACK_MIN is not a constant with newer glibc.
+    const auto min_size = static_cast<std::size_t>(PTHREAD_STACK_MIN);
+    const long page_size = sysconf(_SC_PAGESIZE);
+    const auto page = page_size > 0 ? static_cast<std::size_t>(page_size) : std::size_t{4096};
+
+    const auto size = std::max(stack_size_bytes, min_size);
+    // macOS only takes multiples of the page size.
+    return (size + page - 1) / page * page;
+}
+
+} // namespace
+#endif
+
+NativeThread::NativeThread(std::size_t stack_size_bytes, std::function<void()> func)
+{
+#if defined(WINDOWS)
+    (void)stack_size_bytes;
+    _thread = std::thread(std::move(func));
+    _id = _thread.get_id();
+#else
+    auto* start = new Start{std::move(func), {}};
+    auto started = start->started.get_future();
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (stack_size_bytes > 0) {
+        const int result = pthread_attr_setstacksize(&attr, valid_stack_size(stack_size_bytes));
+        if (result != 0) {
+            LogWarn() << "Could not set thread stack size to " << stack_size_bytes << ": "
+                      << strerror(result);
+        }
+    }
+    int result = pthread_create(&_thread, &attr, &NativeThread::run, start);
+    pthread_attr_destroy(&attr);
+
+    if (result != 0 && stack_size_bytes > 0) {
+        LogWarn() << "Could not start thread with stack size " << stack_size_bytes << ": "
+                  << strerror(result) << ", using the default";
+        result = pthread_create(&_thread, nullptr, &NativeThread::run, start);
+    }
+
+    if (result != 0) {
+        LogErr() << "Could not start thread: " << strerror(result);
+        delete start;
+        return;
+    }
+
+    _joinable = true;
+    // The id is only known once the thread runs, and callers may compare it
+    // right away.
+    _id = started.get();
+#endif
+}
+
+NativeThread::~NativeThread()
+{
+    if (joinable()) {
+        join();
+    }
+}
+
+NativeThread::NativeThread(NativeThread&& other) noexcept :
+#if defined(WINDOWS)
+    _thread(std::move(other._thread)),
+#else
+    _thread(other._thread),
+    _joinable(std::exchange(other._joinable, false)),
+#endif
+    _id(std::exchange(other._id, std::thread::id{}))
+{}
+
+NativeThread& NativeThread::operator=(NativeThread&& other) noexcept
+{
+    if (this != &other) {
+        if (joinable()) {
+            join();
+        }
+#if defined(WINDOWS)
+        _thread = std::move(other._thread);
+#else
+        _thread = other._thread;
+        _joinable = std::exchange(other._joinable, false);
+#endif
+        _id = std::exchange(other._id, std::thread::id{});
+    }
+    return *this;
+}
+
+bool NativeThread::joinable() const
+{
+#if defined(WINDOWS)
+    return _thread.joinable();
+#else
+    return _joinable;
+#endif
+}
+
+void NativeThread::join()
+{
+#if defined(WINDOWS)
+    _thread.join();
+#else
+    if (!_joinable) {
+        return;
+    }
+    pthread_join(_thread, nullptr);
+    _joinable = false;
+#endif
+    _id = std::thread::id{};
+}
+
+#if !defined(WINDOWS)
+void* NativeThread::run(void* arg)
+{
+    auto* start = static_cast<Start*>(arg);
+    auto func = std::move(start->func);
+    start->started.set_value(std::this_thread::get_id());
+    // The constructor only holds on to the future, which outlives the promise.
+    delete start;
+    func();
+    return nullptr;
+}
+#endif
+
+} // namespace mavsdk
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <thread>
+
+#if !defined(WINDOWS)
+#include <pthread.h>
+#endif
+
+namespace mavsdk {
+
+// Thread like std::thread, which can be given the size of its stack.
+//
+// Threads otherwise get the platform's default, e.g. 8 MiB of virtual memory
+// on Linux and 512 KiB on macOS and iOS, which adds up on small systems
+// with many threads. The size is rounded up to what the platform needs at
+// least. Not supported on Windows, where threads keep the default.
+//
+// Unlike std::thread, it joins when destroyed instead of terminating.
+class NativeThread {
+public:
+    NativeThread() = default;
+
+    // A stack size of 0 keeps the platform's default.
+    NativeThread(std::size_t stack_size_bytes, std::function<void()> func);
+    ~NativeThread();
+
+    NativeThread(NativeThread&& other) noexcept;
+    NativeThread& operator=(NativeThread&& other) noexcept;
+
+    // Non-copyable
+    NativeThread(const NativeThread&) = delete;
+    const NativeThread& operator=(const NativeThread&) = delete;
+
+    [[nodiscard]] bool joinable() const;
+    void join();
+
+    [[nodiscard]] std::thread::id get_id() const { return _id; }
+
+private:
+#if defined(WINDOWS)
+    std::thread _thread{};
+#else
+    static void* run(void* arg);
+
+    pthread_t _thread{};
+    bool _joinable{false};
+#endif
+    std::thread::id _id{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,63 @@
+#include "native_thread.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <utility>
+
+#if defined(LINUX)
+#include <pthread.h>
+#endif
+
+using namespace mavsdk;
+
+TEST(NativeThread, RunsAndJoins)
+{
+    std::atomic<bool> ran{false};
+    NativeThread thread(0, [&]() { ran = true; });
+    EXPECT_TRUE(thread.joinable());
+    thread.join();
+    EXPECT_FALSE(thread.joinable());
+    EXPECT_TRUE(ran);
+}
+
+TEST(NativeThread, KnowsIdOfThread)
+{
+    std::thread::id id_inside{};
+    NativeThread thread(0, [&]() { id_inside = std::this_thread::get_id(); });
+    const auto id = thread.get_id();
+    EXPECT_NE(id, std::this_thread::get_id());
+    thread.join();
+    EXPECT_EQ(id, id_inside);
+}
+
+TEST(NativeThread, MovesAndJoinsWhenDestroyed)
+{
+    std::atomic<int> runs{0};
+    {
+        NativeThread first(0, [&]() { ++runs; });
+        NativeThread second(std::move(first));
+        EXPECT_FALSE(first.joinable());
+        EXPECT_TRUE(second.joinable());
+
+        first = NativeThread(0, [&]() { ++runs; });
+        EXPECT_TRUE(first.joinable());
+    }
+    EXPECT_EQ(runs, 2);
+}
+
+#if defined(LINUX)
+TEST(NativeThread, UsesStackSize)
+{
+    std::size_t stack_size = 0;
+    NativeThread thread(256 * 1024, [&]() {
+        pthread_attr_t attr;
+        pthread_getattr_np(pthread_self(), &attr);
+        pthread_attr_getstacksize(&attr, &stack_size);
+        pthread_attr_destroy(&attr);
+    });
+    thread.join();
+
+    EXPECT_EQ(stack_size, 256 * 1024);
+}
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include "connection.h"
+
+namespace mavsdk {
+
+// Connection to nowhere for benchmarks: whatever is sent over it is only
+// counted, and what it receives is handed to it with receive().
+class NullConnection : public Connection {
+public:
+    explicit NullConnection(
+        receiver_callback_t receiver_callback,
+        ForwardingOption forwarding_option = ForwardingOption::ForwardingOff) :
+        Connection(std::move(receiver_callback), forwarding_option)
+    {}
+
+    ~NullConnection() override { stop(); }
+
+    ConnectionResult start() override
+    {
+        start_mavlink_receiver();
+        return ConnectionResult::Success;
+    }
+
+    ConnectionResult stop() override
+    {
+        stop_mavlink_receiver();
+        return ConnectionResult::Success;
+    }
+
+    bool send_frame(const MavlinkFrame& frame) override
+    {
+        _frames_sent.fetch_add(1, std::memory_order_relaxed);
+        _bytes_sent.fetch_add(frame.length, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Parses the bytes as if they had come in as one datagram.
+    void receive(uint8_t* data, unsigned length)
+    {
+        _mavlink_receiver->set_new_datagram(reinterpret_cast<char*>(data), length);
+        while (_mavlink_receiver->parse_message()) {
+            receive_message(_mavlink_receiver->get_last_message(), this);
+        }
+    }
+
+    uint64_t frames_sent() const { return _frames_sent; }
+    uint64_t bytes_sent() const { return _bytes_sent; }
+
+private:
+    std::atomic<uint64_t> _frames_sent{0};
+    std::atomic<uint64_t> _bytes_sent{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,68 @@
+#include "param_cache.h"
+#include "cache_file.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace mavsdk {
+
+// Bump the last char whenever the format changes, old caches are then just
+// ignored.
+static const std::vector<uint8_t> file_magic = {'M', 'P', 'C', '1'};
+static constexpr std::size_t header_len = 4 + 4 + 4;
+
+bool param_cache_save(const std::string& path, const ParamCache& cache)
+{
+    std::vector<uint8_t> buffer;
+    buffer.reserve(header_len + cache.params.size() * 24 + 4);
+
+    buffer.insert(buffer.end(), file_magic.begin(), file_magic.end());
+    cache_put_uint(buffer, cache.hash, 4);
+    cache_put_uint(buffer, cache.params.size(), 4);
+
+    for (const auto& entry : cache.params) {
+        const auto name = entry.name.view();
+        cache_put_uint(buffer, name.size(), 1);
+        buffer.insert(buffer.end(), name.begin(), name.end());
+        cache_put_param_value(buffer, entry.value);
+    }
+
+    return cache_file_write(path, std::move(buffer));
+}
+
+std::optional<ParamCache> param_cache_load(const std::string& path)
+{
+    const auto buffer = cache_file_read(path, file_magic);
+    if (!buffer || buffer->size() < header_len) {
+        return std::nullopt;
+    }
+
+    ParamCache cache;
+    std::size_t pos = file_magic.size();
+    uint64_t hash;
+    uint64_t count;
+    cache_get_uint(*buffer, pos, 4, hash);
+    cache_get_uint(*buffer, pos, 4, count);
+    cache.hash = static_cast<uint32_t>(hash);
+
+    // The CRC matched, so anything not adding up is a bug rather than a
+    // damaged file, but let's not trust it either way.
+    cache.params.reserve(static_cast<std::size_t>(std::min<uint64_t>(count, buffer->size())));
+    for (uint64_t i = 0; i < count; ++i) {
+        std::string name;
+        MAVLinkParameters::ParamValue value;
+        if (!cache_get_string(*buffer, pos, name, 1) ||
+            !cache_get_param_value(*buffer, pos, value) || !cache.params.set(name, value)) {
+            return std::nullopt;
+        }
+    }
+
+    if (pos != buffer->size()) {
+        return std::nullopt;
+    }
+
+    return cache;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include "mavlink_parameters.h"
+
+namespace mavsdk {
+
+// All params of one vehicle together with the hash the vehicle reported
+// for them, so they can be reused as long as the hash doesn't change.
+struct ParamCache {
+    uint32_t hash{0};
+    MAVLinkParameters::ParamStore params{};
+};
+
+// The file is binary: a small header with the hash and the number of params,
+// then for each param its name, type and value in little endian, and a CRC32
+// of everything before it at the end. It is written to a temporary file
+// first and then renamed, so an interrupted write never leaves a broken
+// cache behind.
+bool param_cache_save(const std::string& path, const ParamCache& cache);
+
+// Returns nullopt if there is no cache or it can't be used.
+std::optional<ParamCache> param_cache_load(const std::string& path);
+
+} // namespace mavsdk
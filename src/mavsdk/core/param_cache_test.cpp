@@ -0,0 +1,107 @@
+#include "param_cache.h"
+#include "fs.h"
+
+#include <fstream>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+MAVLinkParameters::ParamStore example_params()
+{
+    MAVLinkParameters::ParamStore params;
+    MAVLinkParameters::ParamValue value;
+
+    value.set<int32_t>(-4001);
+    params.set("SYS_AUTOSTART", value);
+    value.set<float>(12.5f);
+    params.set("MPC_XY_VEL_MAX", value);
+    value.set<uint8_t>(255);
+    params.set("CAM_CAP_FBACK", value);
+    value.set<double>(-0.125);
+    params.set("ABCDEFGHIJKLMNOP", value);
+    value.set<uint64_t>(0x0123456789abcdef);
+    params.set("U64", value);
+    return params;
+}
+} // namespace
+
+TEST(ParamCache, SaveAndLoad)
+{
+    const auto dir = create_tmp_directory("mavsdk-param-cache-test");
+    ASSERT_TRUE(dir);
+    const auto path = *dir + path_separator + "cache.params";
+
+    ParamCache cache;
+    cache.hash = 0xdeadbeef;
+    cache.params = example_params();
+    ASSERT_TRUE(param_cache_save(path, cache));
+
+    const auto loaded = param_cache_load(path);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->hash, 0xdeadbeef);
+    ASSERT_EQ(loaded->params.size(), cache.params.size());
+
+    for (std::size_t i = 0; i < cache.params.size(); ++i) {
+        const auto& expected = cache.params.at(i);
+        const auto& actual = loaded->params.at(i);
+        EXPECT_EQ(actual.name, expected.name);
+        EXPECT_EQ(actual.value._value, expected.value._value);
+    }
+
+    fs_remove(path);
+}
+
+TEST(ParamCache, EmptyStore)
+{
+    const auto dir = create_tmp_directory("mavsdk-param-cache-test");
+    ASSERT_TRUE(dir);
+    const auto path = *dir + path_separator + "empty.params";
+
+    ParamCache cache;
+    cache.hash = 42;
+    ASSERT_TRUE(param_cache_save(path, cache));
+
+    const auto loaded = param_cache_load(path);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->hash, 42);
+    EXPECT_TRUE(loaded->params.empty());
+
+    fs_remove(path);
+}
+
+TEST(ParamCache, MissingFile)
+{
+    EXPECT_FALSE(param_cache_load("/this/does/not/exist.params"));
+}
+
+TEST(ParamCache, RejectsCorruptFile)
+{
+    const auto dir = create_tmp_directory("mavsdk-param-cache-test");
+    ASSERT_TRUE(dir);
+    const auto path = *dir + path_separator + "corrupt.params";
+
+    ParamCache cache;
+    cache.params = example_params();
+    ASSERT_TRUE(param_cache_save(path, cache));
+
+    // Flip a bit in the middle of the file.
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(20);
+        char c;
+        file.get(c);
+        file.seekp(20);
+        file.put(static_cast<char>(c ^ 0x01));
+    }
+    EXPECT_FALSE(param_cache_load(path));
+
+    // Truncated
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write("MPC1", 4);
+    }
+    EXPECT_FALSE(param_cache_load(path));
+
+    fs_remove(path);
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace mavsdk {
+
+// Parameter name as used by MAVLink: up to 16 chars, stored inline so that
+// looking a name up or keeping it around never allocates.
+class ParamName {
+public:
+    static constexpr std::size_t MAX_LEN = 16;
+
+    ParamName() = default;
+
+    // Returns nullopt if the name is longer than MAX_LEN.
+    static std::optional<ParamName> from(std::string_view name)
+    {
+        if (name.size() > MAX_LEN) {
+            return std::nullopt;
+        }
+        ParamName result;
+        std::memcpy(result._chars.data(), name.data(), name.size());
+        result._len = static_cast<uint8_t>(name.size());
+        return result;
+    }
+
+    [[nodiscard]] std::string_view view() const { return {_chars.data(), _len}; }
+
+    [[nodiscard]] std::string str() const { return std::string{view()}; }
+
+    bool operator==(const ParamName& rhs) const { return view() == rhs.view(); }
+    bool operator!=(const ParamName& rhs) const { return !(*this == rhs); }
+
+    struct Hash {
+        std::size_t operator()(const ParamName& name) const
+        {
+            return std::hash<std::string_view>{}(name.view());
+        }
+    };
+
+private:
+    std::array<char, MAX_LEN> _chars{};
+    uint8_t _len{0};
+};
+
+// Flat table of parameters, addressable by name as well as by index.
+//
+// Entries are kept in one contiguous vector in the order they were first
+// added, so the index of a parameter never changes and is what is reported
+// as param_index over MAVLink. Names are interned as ParamName, the hash map
+// only maps them to the index of their entry.
+template<typename Value> class ParamTable {
+public:
+    struct Entry {
+        ParamName name{};
+        Value value{};
+    };
+
+    using const_iterator = typename std::vector<Entry>::const_iterator;
+
+    ParamTable() = default;
+    ~ParamTable() = default;
+
+    // Adds the parameter or replaces its value, returns false if the name is
+    // too long.
+    bool set(std::string_view name, const Value& value)
+    {
+        const auto maybe_name = ParamName::from(name);
+        if (!maybe_name) {
+            return false;
+        }
+
+        const auto it = _indices.find(*maybe_name);
+        if (it != _indices.end()) {
+            _entries[it->second].value = value;
+            return true;
+        }
+
+        _indices.emplace(*maybe_name, _entries.size());
+        _entries.push_back(Entry{*maybe_name, value});
+        return true;
+    }
+
+    [[nodiscard]] std::optional<std::size_t> index_of(std::string_view name) const
+    {
+        const auto maybe_name = ParamName::from(name);
+        if (!maybe_name) {
+            return std::nullopt;
+        }
+
+        const auto it = _indices.find(*maybe_name);
+        if (it == _indices.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    // Returns nullptr if there is no parameter with that name.
+    [[nodiscard]] const Value* find(std::string_view name) const
+    {
+        const auto index = index_of(name);
+        return index ? &_entries[*index].value : nullptr;
+    }
+
+    Value* find(std::string_view name)
+    {
+        const auto index = index_of(name);
+        return index ? &_entries[*index].value : nullptr;
+    }
+
+    [[nodiscard]] const Entry& at(std::size_t index) const { return _entries.at(index); }
+
+    [[nodiscard]] std::size_t size() const { return _entries.size(); }
+
+    [[nodiscard]] bool empty() const { return _entries.empty(); }
+
+    // Roughly what the vector and the hash map have allocated.
+    [[nodiscard]] std::size_t allocated_bytes() const
+    {
+        using Node = std::pair<const ParamName, std::size_t>;
+        return _entries.capacity() * sizeof(Entry) +
+               _indices.size() * (sizeof(Node) + sizeof(void*)) +
+               _indices.bucket_count() * sizeof(void*);
+    }
+
+    void reserve(std::size_t size)
+    {
+        _entries.reserve(size);
+        _indices.reserve(size);
+    }
+
+    void clear()
+    {
+        _entries.clear();
+        _indices.clear();
+    }
+
+    [[nodiscard]] const_iterator begin() const { return _entries.begin(); }
+    [[nodiscard]] const_iterator end() const { return _entries.end(); }
+
+private:
+    std::vector<Entry> _entries{};
+    std::unordered_map<ParamName, std::size_t, ParamName::Hash> _indices{};
+};
+
+} // namespace mavsdk
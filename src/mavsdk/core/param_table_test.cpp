@@ -0,0 +1,89 @@
+#include "param_table.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(ParamTable, SetAndFind)
+{
+    auto table = ParamTable<int>{};
+    EXPECT_TRUE(table.empty());
+
+    EXPECT_TRUE(table.set("SYS_AUTOSTART", 4001));
+    EXPECT_TRUE(table.set("MPC_XY_VEL_MAX", 12));
+    EXPECT_EQ(table.size(), 2);
+
+    ASSERT_NE(table.find("SYS_AUTOSTART"), nullptr);
+    EXPECT_EQ(*table.find("SYS_AUTOSTART"), 4001);
+    ASSERT_NE(table.find("MPC_XY_VEL_MAX"), nullptr);
+    EXPECT_EQ(*table.find("MPC_XY_VEL_MAX"), 12);
+    EXPECT_EQ(table.find("MPC_Z_VEL_MAX"), nullptr);
+}
+
+TEST(ParamTable, IndicesAreStable)
+{
+    auto table = ParamTable<int>{};
+    table.set("B", 1);
+    table.set("A", 2);
+    table.set("C", 3);
+
+    // Replacing a value keeps the entry where it was.
+    table.set("B", 42);
+    EXPECT_EQ(table.size(), 3);
+
+    EXPECT_EQ(table.index_of("B"), std::optional<std::size_t>{0});
+    EXPECT_EQ(table.index_of("A"), std::optional<std::size_t>{1});
+    EXPECT_EQ(table.index_of("C"), std::optional<std::size_t>{2});
+    EXPECT_EQ(table.index_of("D"), std::nullopt);
+
+    EXPECT_EQ(table.at(0).name.view(), "B");
+    EXPECT_EQ(table.at(0).value, 42);
+
+    std::vector<std::string> names;
+    for (const auto& entry : table) {
+        names.push_back(entry.name.str());
+    }
+    EXPECT_EQ(names, (std::vector<std::string>{"B", "A", "C"}));
+}
+
+TEST(ParamTable, NameLength)
+{
+    auto table = ParamTable<int>{};
+
+    // 16 chars is the maximum MAVLink can carry.
+    EXPECT_TRUE(table.set("ABCDEFGHIJKLMNOP", 1));
+    EXPECT_FALSE(table.set("ABCDEFGHIJKLMNOPQ", 2));
+    EXPECT_EQ(table.size(), 1);
+
+    EXPECT_EQ(table.find("ABCDEFGHIJKLMNOPQ"), nullptr);
+    ASSERT_NE(table.find("ABCDEFGHIJKLMNOP"), nullptr);
+    EXPECT_EQ(*table.find("ABCDEFGHIJKLMNOP"), 1);
+}
+
+TEST(ParamTable, Clear)
+{
+    auto table = ParamTable<int>{};
+    table.set("A", 1);
+    table.clear();
+
+    EXPECT_TRUE(table.empty());
+    EXPECT_EQ(table.find("A"), nullptr);
+
+    table.set("B", 2);
+    EXPECT_EQ(table.index_of("B"), std::optional<std::size_t>{0});
+}
+
+TEST(ParamTable, AllocatedBytesGrowWithEntries)
+{
+    auto table = ParamTable<int>{};
+    const auto empty_bytes = table.allocated_bytes();
+
+    table.set("A", 1);
+    const auto one_bytes = table.allocated_bytes();
+    EXPECT_GT(one_bytes, empty_bytes);
+    EXPECT_GE(one_bytes, sizeof(ParamTable<int>::Entry));
+
+    for (int i = 0; i < 100; ++i) {
+        table.set("P" + std::to_string(i), i);
+    }
+    EXPECT_GE(table.allocated_bytes(), 101 * sizeof(ParamTable<int>::Entry));
+}
@@ -0,0 +1,98 @@
+#include "periodic_messages.h"
+
+#include <utility>
+#include "log.h"
+
+namespace mavsdk {
+
+PeriodicMessages::PeriodicMessages(CallEveryHandler& call_every_handler, Sender sender) :
+    _call_every_handler(call_every_handler),
+    _sender(std::move(sender))
+{}
+
+PeriodicMessages::~PeriodicMessages()
+{
+    std::lock_guard<std::mutex> lock(_entries_mutex);
+    for (const auto& [cookie, entry] : _entries) {
+        _call_every_handler.remove(cookie);
+    }
+}
+
+void PeriodicMessages::add(
+    const mavlink_message_t& message, double interval_s, void** cookie, Update update)
+{
+    auto entry = std::make_shared<Entry>();
+    entry->message = message;
+    entry->update = std::move(update);
+
+    std::lock_guard<std::mutex> lock(_entries_mutex);
+    _call_every_handler.add([this, entry]() { send(*entry); }, interval_s, cookie);
+    _entries[*cookie] = std::move(entry);
+}
+
+void PeriodicMessages::add(const mavlink_message_t& message, double interval_s, void** cookie)
+{
+    add(message, interval_s, cookie, nullptr);
+}
+
+void PeriodicMessages::set_message(const mavlink_message_t& message, const void* cookie)
+{
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(_entries_mutex);
+        const auto found = _entries.find(cookie);
+        if (found == _entries.end()) {
+            LogWarn() << "Periodic message to set not found";
+            return;
+        }
+        entry = found->second;
+    }
+
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    entry->message = message;
+}
+
+void PeriodicMessages::change_interval(double interval_s, const void* cookie)
+{
+    _call_every_handler.change(interval_s, cookie);
+}
+
+void PeriodicMessages::remove(const void* cookie)
+{
+    std::lock_guard<std::mutex> lock(_entries_mutex);
+    _call_every_handler.remove(cookie);
+    _entries.erase(cookie);
+}
+
+void PeriodicMessages::finalize(mavlink_message_t& message)
+{
+    const mavlink_msg_entry_t* meta = mavlink_get_msg_entry(message.msgid);
+    if (meta == nullptr) {
+        LogErr() << "Unknown message ID " << message.msgid << " of periodic message";
+        return;
+    }
+
+    // Same channel as the pack functions use, so the sequence continues.
+    mavlink_finalize_message_chan(
+        &message,
+        message.sysid,
+        message.compid,
+        MAVLINK_COMM_0,
+        meta->min_msg_len,
+        meta->max_msg_len,
+        meta->crc_extra);
+}
+
+void PeriodicMessages::send(Entry& entry)
+{
+    std::lock_guard<std::mutex> lock(entry.mutex);
+
+    if (entry.update && !entry.update(entry.message)) {
+        return;
+    }
+
+    finalize(entry.message);
+    _sender(entry.message);
+}
+
+} // namespace mavsdk
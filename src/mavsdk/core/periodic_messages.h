@@ -0,0 +1,63 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "call_every_handler.h"
+#include "mavlink_include.h"
+
+namespace mavsdk {
+
+// Messages sent at a fixed rate, packed only once.
+//
+// Each message is kept packed as a template. When it is due, an optional
+// update hook can patch the fields which changed, then only the header, the
+// sequence number and the checksum are redone before it is sent. Traffic
+// whose fields rarely change, like heartbeats, doesn't need to be packed
+// again every time.
+class PeriodicMessages {
+public:
+    using Sender = std::function<bool(mavlink_message_t&)>;
+
+    // Called with the template right before it is sent. It may modify the
+    // payload, or pack the message anew. Returns false to skip this time.
+    using Update = std::function<bool(mavlink_message_t&)>;
+
+    PeriodicMessages(CallEveryHandler& call_every_handler, Sender sender);
+    ~PeriodicMessages();
+
+    // Non-copyable
+    PeriodicMessages(const PeriodicMessages&) = delete;
+    const PeriodicMessages& operator=(const PeriodicMessages&) = delete;
+
+    void add(const mavlink_message_t& message, double interval_s, void** cookie, Update update);
+    void add(const mavlink_message_t& message, double interval_s, void** cookie);
+
+    // Replaces the template, for changes not done by the update hook.
+    void set_message(const mavlink_message_t& message, const void* cookie);
+    void change_interval(double interval_s, const void* cookie);
+    void remove(const void* cookie);
+
+    // Redoes header, sequence number and checksum of a packed message whose
+    // payload was modified. Trailing zeros are trimmed again, so the payload
+    // needs to be complete up to the full length of the message.
+    static void finalize(mavlink_message_t& message);
+
+private:
+    struct Entry {
+        std::mutex mutex{};
+        mavlink_message_t message{};
+        Update update{nullptr};
+    };
+
+    void send(Entry& entry);
+
+    CallEveryHandler& _call_every_handler;
+    const Sender _sender;
+
+    std::mutex _entries_mutex{};
+    std::unordered_map<const void*, std::shared_ptr<Entry>> _entries{};
+};
+
+} // namespace mavsdk
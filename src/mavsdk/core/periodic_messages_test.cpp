@@ -0,0 +1,123 @@
+#include <chrono>
+#include <vector>
+#include <gtest/gtest.h>
+#include "call_every_handler.h"
+#include "periodic_messages.h"
+
+#ifdef FAKE_TIME
+#define Time FakeTime
+#endif
+
+using namespace mavsdk;
+
+namespace {
+
+mavlink_message_t make_heartbeat(uint8_t base_mode)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        1, MAV_COMP_ID_AUTOPILOT1, &message, MAV_TYPE_GCS, MAV_AUTOPILOT_INVALID, base_mode, 0, 0);
+    return message;
+}
+
+// Parses the message again from its serialized form, as a receiver would.
+bool parses(const mavlink_message_t& message)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t length = mavlink_msg_to_send_buffer(buffer, &message);
+
+    mavlink_message_t parsed;
+    mavlink_status_t status;
+    for (uint16_t i = 0; i < length; ++i) {
+        if (mavlink_parse_char(MAVLINK_COMM_1, buffer[i], &parsed, &status) ==
+            MAVLINK_FRAMING_OK) {
+            return parsed.msgid == message.msgid && parsed.seq == message.seq;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(PeriodicMessages, SendsWithFreshSequence)
+{
+    Time time{};
+    CallEveryHandler call_every_handler(time);
+
+    std::vector<mavlink_message_t> sent;
+    PeriodicMessages periodic_messages(call_every_handler, [&](mavlink_message_t& message) {
+        sent.push_back(message);
+        return true;
+    });
+
+    void* cookie = nullptr;
+    periodic_messages.add(make_heartbeat(0), 0.1, &cookie);
+
+    for (int i = 0; i < 3; ++i) {
+        call_every_handler.run_once();
+        time.sleep_for(std::chrono::milliseconds(100));
+    }
+
+    ASSERT_EQ(sent.size(), 3u);
+    for (std::size_t i = 0; i < sent.size(); ++i) {
+        EXPECT_TRUE(parses(sent[i]));
+        if (i > 0) {
+            EXPECT_EQ(static_cast<uint8_t>(sent[i - 1].seq + 1), sent[i].seq);
+        }
+    }
+
+    periodic_messages.remove(cookie);
+    time.sleep_for(std::chrono::milliseconds(100));
+    call_every_handler.run_once();
+    EXPECT_EQ(sent.size(), 3u);
+}
+
+TEST(PeriodicMessages, UpdateHookPatchesOrSkips)
+{
+    Time time{};
+    CallEveryHandler call_every_handler(time);
+
+    std::vector<mavlink_message_t> sent;
+    PeriodicMessages periodic_messages(call_every_handler, [&](mavlink_message_t& message) {
+        sent.push_back(message);
+        return true;
+    });
+
+    int calls = 0;
+    void* cookie = nullptr;
+    periodic_messages.add(make_heartbeat(0), 0.1, &cookie, [&](mavlink_message_t& message) {
+        ++calls;
+        if (calls == 2) {
+            return false;
+        }
+        message = make_heartbeat(static_cast<uint8_t>(calls));
+        return true;
+    });
+
+    for (int i = 0; i < 3; ++i) {
+        call_every_handler.run_once();
+        time.sleep_for(std::chrono::milliseconds(100));
+    }
+
+    EXPECT_EQ(calls, 3);
+    ASSERT_EQ(sent.size(), 2u);
+    EXPECT_EQ(mavlink_msg_heartbeat_get_base_mode(&sent[0]), 1);
+    EXPECT_EQ(mavlink_msg_heartbeat_get_base_mode(&sent[1]), 3);
+    EXPECT_TRUE(parses(sent[1]));
+
+    periodic_messages.set_message(make_heartbeat(42), cookie);
+}
+
+TEST(PeriodicMessages, FinalizeAfterPayloadChange)
+{
+    auto message = make_heartbeat(0);
+    const uint8_t seq = message.seq;
+
+    // Patch custom_mode, the first field of the payload, directly.
+    _mav_put_uint32_t(_MAV_PAYLOAD_NON_CONST(&message), 0, 1234);
+    PeriodicMessages::finalize(message);
+
+    EXPECT_EQ(mavlink_msg_heartbeat_get_custom_mode(&message), 1234u);
+    EXPECT_EQ(message.seq, static_cast<uint8_t>(seq + 1));
+    EXPECT_TRUE(parses(message));
+}
@@ -0,0 +1,117 @@
+#include "periodic_thread.h"
+#include "log.h"
+
+#if defined(LINUX)
+#include <pthread.h>
+#include <sched.h>
+#include <cstring>
+#endif
+
+namespace mavsdk {
+
+PeriodicThread::~PeriodicThread()
+{
+    stop();
+}
+
+void PeriodicThread::start(std::function<void()> func, double interval_s, int realtime_priority)
+{
+    stop();
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _func = std::move(func);
+        _interval = to_duration(interval_s);
+        _should_stop = false;
+        _interval_changed = false;
+    }
+
+    _thread = std::thread(&PeriodicThread::run, this);
+
+    if (realtime_priority > 0) {
+        set_realtime_priority(realtime_priority);
+    }
+}
+
+void PeriodicThread::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_stop = true;
+    }
+    _cv.notify_all();
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void PeriodicThread::set_interval(double interval_s)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _interval = to_duration(interval_s);
+        _interval_changed = true;
+    }
+    _cv.notify_all();
+}
+
+bool PeriodicThread::is_running() const
+{
+    return _thread.joinable();
+}
+
+void PeriodicThread::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    // Set up so that the first call is due right away.
+    auto last_time = std::chrono::steady_clock::now() - _interval;
+
+    while (!_should_stop) {
+        const auto deadline = last_time + _interval;
+        if (_cv.wait_until(
+                lock, deadline, [this]() { return _should_stop || _interval_changed; })) {
+            // Either we stop, or the deadline is worked out again with the new interval.
+            _interval_changed = false;
+            continue;
+        }
+
+        // The function is only replaced while the thread is not running, so
+        // it can be called without the lock.
+        lock.unlock();
+        _func();
+        lock.lock();
+
+        last_time = deadline;
+        const auto now = std::chrono::steady_clock::now();
+        if (last_time + _interval < now) {
+            // We have fallen behind by more than one interval. Instead of
+            // calling in a burst to catch up, we skip the missed calls.
+            last_time = now;
+        }
+    }
+}
+
+void PeriodicThread::set_realtime_priority(int realtime_priority)
+{
+#if defined(LINUX)
+    sched_param param{};
+    param.sched_priority = realtime_priority;
+    const int ret = pthread_setschedparam(_thread.native_handle(), SCHED_FIFO, &param);
+    if (ret != 0) {
+        LogWarn() << "Could not set real-time priority " << realtime_priority << ": "
+                  << strerror(ret);
+    }
+#else
+    LogWarn() << "Real-time priority " << realtime_priority << " not supported on this platform";
+#endif
+}
+
+std::chrono::steady_clock::duration PeriodicThread::to_duration(double interval_s)
+{
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(interval_s));
+}
+
+} // namespace mavsdk
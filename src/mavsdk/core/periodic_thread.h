@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace mavsdk {
+
+// Dedicated thread calling a function at a fixed rate.
+//
+// The calls are scheduled at absolute deadlines, so the rate does not drift
+// by however long the calls take. If the thread falls behind by more than
+// one interval, the missed calls are skipped instead of being made up in a
+// burst, same as in CallEveryHandler.
+class PeriodicThread {
+public:
+    PeriodicThread() = default;
+    ~PeriodicThread();
+
+    // The first call happens right away. With a realtime_priority above 0,
+    // the thread is scheduled with SCHED_FIFO at that priority, if the
+    // platform and the permissions of the process allow it.
+    void start(std::function<void()> func, double interval_s, int realtime_priority = 0);
+
+    // Waits for a call in progress to finish, so it must not be called from
+    // within the function itself.
+    void stop();
+
+    void set_interval(double interval_s);
+
+    [[nodiscard]] bool is_running() const;
+
+    // Non-copyable
+    PeriodicThread(const PeriodicThread&) = delete;
+    const PeriodicThread& operator=(const PeriodicThread&) = delete;
+
+private:
+    void run();
+    void set_realtime_priority(int realtime_priority);
+
+    static std::chrono::steady_clock::duration to_duration(double interval_s);
+
+    mutable std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::function<void()> _func{};
+    std::chrono::steady_clock::duration _interval{};
+    bool _should_stop{false};
+    bool _interval_changed{false};
+    std::thread _thread{};
+};
+
+} // namespace mavsdk
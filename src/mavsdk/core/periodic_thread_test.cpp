@@ -0,0 +1,78 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <gtest/gtest.h>
+#include "periodic_thread.h"
+
+using namespace mavsdk;
+
+TEST(PeriodicThread, CallsRightAwayAndPeriodically)
+{
+    std::atomic<int> counter{0};
+
+    PeriodicThread periodic_thread;
+    periodic_thread.start([&counter]() { ++counter; }, 0.01);
+    EXPECT_TRUE(periodic_thread.is_running());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_EQ(counter, 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    periodic_thread.stop();
+    EXPECT_FALSE(periodic_thread.is_running());
+
+    // Loaded CI machines are not very punctual, so only check that it's roughly right.
+    EXPECT_GE(counter, 10);
+    EXPECT_LE(counter, 22);
+
+    const int stopped_count = counter;
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_EQ(counter, stopped_count);
+}
+
+TEST(PeriodicThread, DoesNotDriftWithSlowCalls)
+{
+    std::atomic<int> counter{0};
+
+    PeriodicThread periodic_thread;
+    periodic_thread.start(
+        [&counter]() {
+            ++counter;
+            // Taking 60% of the interval must not stretch the interval.
+            std::this_thread::sleep_for(std::chrono::milliseconds(12));
+        },
+        0.02);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(405));
+    periodic_thread.stop();
+
+    // 21 calls without drift, 13 if the call time added to the interval.
+    EXPECT_GE(counter, 18);
+    EXPECT_LE(counter, 22);
+}
+
+TEST(PeriodicThread, ChangesInterval)
+{
+    std::atomic<int> counter{0};
+
+    PeriodicThread periodic_thread;
+    periodic_thread.start([&counter]() { ++counter; }, 10.0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(counter, 1);
+
+    periodic_thread.set_interval(0.01);
+    std::this_thread::sleep_for(std::chrono::milliseconds(105));
+    periodic_thread.stop();
+
+    EXPECT_GE(counter, 5);
+    EXPECT_LE(counter, 13);
+}
+
+TEST(PeriodicThread, StopWithoutStart)
+{
+    PeriodicThread periodic_thread;
+    EXPECT_FALSE(periodic_thread.is_running());
+    periodic_thread.stop();
+    EXPECT_FALSE(periodic_thread.is_running());
+}
@@ -65,6 +65,7 @@ void Ping::process_ping(const mavlink_message_t& message)
         }
 
         _last_ping_time_us = _system_impl.get_time().elapsed_us() - ping.time_usec;
+        _system_impl.add_rtt_sample(static_cast<double>(_last_ping_time_us) * 1e-6);
     }
 }
 
@@ -59,7 +59,23 @@ public:
     const PluginImplBase& operator=(const PluginImplBase&) = delete;
 
 protected:
+    // Registers a member function of the plugin taking the decoded message, e.g.
+    //   register_mavlink_message_handler<&TelemetryImpl::process_attitude>();
+    // for process_attitude(const mavlink_attitude_t&). It is unregistered with
+    // the other handlers by unregister_all_mavlink_message_handlers(this).
+    template<auto Method> void register_mavlink_message_handler()
+    {
+        _parent->register_mavlink_message_handler<Method>(plugin_of(Method), this);
+    }
+
     std::shared_ptr<SystemImpl> _parent;
+
+private:
+    template<typename Plugin, typename Message>
+    Plugin* plugin_of(void (Plugin::*)(const Message&))
+    {
+        return static_cast<Plugin*>(this);
+    }
 };
 
 } // namespace mavsdk
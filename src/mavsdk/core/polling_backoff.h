@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+
+namespace mavsdk {
+
+// Intervals for a request which is repeated until it is answered, doubling
+// each time up to a maximum, so a component which never answers costs less
+// and less bandwidth.
+class PollingBackoff {
+public:
+    PollingBackoff(double initial_interval_s, double max_interval_s) :
+        _initial_interval_s(initial_interval_s),
+        _max_interval_s(std::max(max_interval_s, initial_interval_s)),
+        _interval_s(initial_interval_s)
+    {}
+
+    ~PollingBackoff() = default;
+
+    [[nodiscard]] double interval_s() const { return _interval_s; }
+
+    // To be called after sending the request, returns the interval until the
+    // next one.
+    double backoff()
+    {
+        _interval_s = std::min(_interval_s * 2.0, _max_interval_s);
+        return _interval_s;
+    }
+
+    // Back to the initial interval, e.g. once the component is back.
+    void reset() { _interval_s = _initial_interval_s; }
+
+private:
+    const double _initial_interval_s;
+    const double _max_interval_s;
+    double _interval_s;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,33 @@
+#include "polling_backoff.h"
+
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(PollingBackoff, DoublesUpToMax)
+{
+    PollingBackoff backoff{1.0, 10.0};
+    EXPECT_DOUBLE_EQ(backoff.interval_s(), 1.0);
+    EXPECT_DOUBLE_EQ(backoff.backoff(), 2.0);
+    EXPECT_DOUBLE_EQ(backoff.backoff(), 4.0);
+    EXPECT_DOUBLE_EQ(backoff.backoff(), 8.0);
+    EXPECT_DOUBLE_EQ(backoff.backoff(), 10.0);
+    EXPECT_DOUBLE_EQ(backoff.backoff(), 10.0);
+    EXPECT_DOUBLE_EQ(backoff.interval_s(), 10.0);
+}
+
+TEST(PollingBackoff, Reset)
+{
+    PollingBackoff backoff{0.5, 30.0};
+    backoff.backoff();
+    backoff.backoff();
+    backoff.reset();
+    EXPECT_DOUBLE_EQ(backoff.interval_s(), 0.5);
+    EXPECT_DOUBLE_EQ(backoff.backoff(), 1.0);
+}
+
+TEST(PollingBackoff, MaxBelowInitial)
+{
+    PollingBackoff backoff{5.0, 1.0};
+    EXPECT_DOUBLE_EQ(backoff.backoff(), 5.0);
+}
@@ -0,0 +1,60 @@
+#include "rate_adaptation.h"
+
+#include <algorithm>
+
+namespace mavsdk {
+
+RateAdaptation::RateAdaptation(const Config& config) : _config(config) {}
+
+bool RateAdaptation::is_congested(const Sample& sample) const
+{
+    if (sample.send_congested || sample.loss_rate > _config.max_loss_rate) {
+        return true;
+    }
+
+    if (sample.rtt_s && _min_rtt_s &&
+        *sample.rtt_s > std::max(
+                            *_min_rtt_s * _config.max_rtt_factor,
+                            *_min_rtt_s + _config.min_rtt_increase_s)) {
+        return true;
+    }
+
+    return _config.link_bytes_per_s > 0.0 &&
+           sample.bytes_per_s > _config.link_bytes_per_s * (1.0 - _config.headroom);
+}
+
+double RateAdaptation::update(const Sample& sample, double now_s)
+{
+    // Checked against the lowest RTT before the sample, so the sample itself
+    // can't hide an increase.
+    const bool congested = is_congested(sample);
+    if (sample.rtt_s) {
+        _min_rtt_s = std::min(_min_rtt_s.value_or(*sample.rtt_s), *sample.rtt_s);
+    }
+
+    if (congested) {
+        _good_since_s.reset();
+        if (!_last_decrease_s || now_s - *_last_decrease_s >= _config.decrease_interval_s) {
+            _scale *= _config.decrease_factor;
+            _last_decrease_s = now_s;
+        }
+        return _scale;
+    }
+
+    if (!_good_since_s) {
+        _good_since_s = now_s;
+    } else if (now_s - *_good_since_s >= _config.hold_s && _scale < 1.0) {
+        _scale = std::min(1.0, _scale + _config.increase_step);
+        // The next step needs another good stretch again.
+        _good_since_s = now_s;
+    }
+    return _scale;
+}
+
+double RateAdaptation::rate_hz(double floor_hz, double ceiling_hz, double scale)
+{
+    scale = std::clamp(scale, 0.0, 1.0);
+    return floor_hz + (std::max(ceiling_hz, floor_hz) - floor_hz) * scale;
+}
+
+} // namespace mavsdk
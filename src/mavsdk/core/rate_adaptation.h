@@ -0,0 +1,62 @@
+#pragma once
+
+#include <optional>
+
+namespace mavsdk {
+
+// Decides how far message rates are scaled back to keep a link from
+// saturating, from its loss, round trip time and throughput.
+//
+// The scale goes from 0 (the floors of the rates) to 1 (their ceilings). On a
+// degraded link it is cut multiplicatively, and it only grows back in small
+// steps once the link stayed good for a while, as in TCP's congestion
+// control (AIMD). This reacts quickly to a radio fading out without
+// oscillating around the capacity of the link.
+class RateAdaptation {
+public:
+    struct Config {
+        double max_loss_rate{0.05}; ///< Loss above this is congestion
+        /// Congestion if the RTT is this much above the lowest one seen ...
+        double max_rtt_factor{2.0};
+        /// ... and at least this much, so a fast link doesn't trip on noise
+        double min_rtt_increase_s{0.1};
+        /// Capacity of the link, 0 if unknown, in which case throughput is not checked
+        double link_bytes_per_s{0.0};
+        /// Share of the capacity kept free for commands and other streams
+        double headroom{0.2};
+        double decrease_factor{0.5};
+        double increase_step{0.1};
+        /// A decrease needs this long to show in the statistics
+        double decrease_interval_s{2.0};
+        /// How long the link needs to be good before increasing again
+        double hold_s{5.0};
+    };
+
+    struct Sample {
+        double loss_rate{0.0};
+        std::optional<double> rtt_s{};
+        double bytes_per_s{0.0};
+        bool send_congested{false};
+    };
+
+    RateAdaptation() : RateAdaptation(Config{}) {}
+    explicit RateAdaptation(const Config& config);
+
+    // Returns the scale after the sample.
+    double update(const Sample& sample, double now_s);
+
+    [[nodiscard]] double scale() const { return _scale; }
+    [[nodiscard]] bool is_congested(const Sample& sample) const;
+
+    // The rate in between floor and ceiling for the given scale.
+    static double rate_hz(double floor_hz, double ceiling_hz, double scale);
+
+private:
+    Config _config;
+    double _scale{1.0};
+    std::optional<double> _min_rtt_s{};
+    std::optional<double> _last_decrease_s{};
+    std::optional<double> _good_since_s{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,88 @@
+#include "rate_adaptation.h"
+
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(RateAdaptation, StaysAtCeilingOnGoodLink)
+{
+    RateAdaptation adaptation;
+    for (int i = 0; i < 20; ++i) {
+        RateAdaptation::Sample sample;
+        sample.rtt_s = 0.05;
+        EXPECT_DOUBLE_EQ(adaptation.update(sample, i), 1.0);
+    }
+}
+
+TEST(RateAdaptation, BacksOffOnLossOncePerInterval)
+{
+    RateAdaptation adaptation;
+    RateAdaptation::Sample sample;
+    sample.loss_rate = 0.2;
+
+    EXPECT_DOUBLE_EQ(adaptation.update(sample, 0.0), 0.5);
+    // Too early for the statistics to show the last decrease.
+    EXPECT_DOUBLE_EQ(adaptation.update(sample, 1.0), 0.5);
+    EXPECT_DOUBLE_EQ(adaptation.update(sample, 2.0), 0.25);
+}
+
+TEST(RateAdaptation, BacksOffOnRisingRtt)
+{
+    RateAdaptation adaptation;
+    RateAdaptation::Sample sample;
+    sample.rtt_s = 0.1;
+    adaptation.update(sample, 0.0);
+
+    // Twice the RTT, but not by enough to be more than noise.
+    sample.rtt_s = 0.15;
+    EXPECT_DOUBLE_EQ(adaptation.update(sample, 1.0), 1.0);
+
+    sample.rtt_s = 0.5;
+    EXPECT_DOUBLE_EQ(adaptation.update(sample, 2.0), 0.5);
+}
+
+TEST(RateAdaptation, KeepsHeadroomOfLink)
+{
+    RateAdaptation::Config config;
+    config.link_bytes_per_s = 1000.0;
+    RateAdaptation adaptation(config);
+
+    RateAdaptation::Sample sample;
+    sample.bytes_per_s = 700.0;
+    EXPECT_DOUBLE_EQ(adaptation.update(sample, 0.0), 1.0);
+
+    sample.bytes_per_s = 900.0;
+    EXPECT_DOUBLE_EQ(adaptation.update(sample, 1.0), 0.5);
+}
+
+TEST(RateAdaptation, RecoversInStepsAfterHold)
+{
+    RateAdaptation adaptation;
+    RateAdaptation::Sample sample;
+    sample.send_congested = true;
+    adaptation.update(sample, 0.0);
+    ASSERT_DOUBLE_EQ(adaptation.scale(), 0.5);
+
+    sample.send_congested = false;
+    double now_s = 1.0;
+    for (; now_s < 6.0; now_s += 1.0) {
+        EXPECT_DOUBLE_EQ(adaptation.update(sample, now_s), 0.5);
+    }
+    EXPECT_DOUBLE_EQ(adaptation.update(sample, now_s), 0.6);
+
+    for (int i = 0; i < 100; ++i) {
+        now_s += 1.0;
+        adaptation.update(sample, now_s);
+    }
+    EXPECT_DOUBLE_EQ(adaptation.scale(), 1.0);
+}
+
+TEST(RateAdaptation, RateIsBetweenFloorAndCeiling)
+{
+    EXPECT_DOUBLE_EQ(RateAdaptation::rate_hz(1.0, 10.0, 0.0), 1.0);
+    EXPECT_DOUBLE_EQ(RateAdaptation::rate_hz(1.0, 10.0, 0.5), 5.5);
+    EXPECT_DOUBLE_EQ(RateAdaptation::rate_hz(1.0, 10.0, 1.0), 10.0);
+    EXPECT_DOUBLE_EQ(RateAdaptation::rate_hz(1.0, 10.0, 2.0), 10.0);
+    // A ceiling below the floor is the floor.
+    EXPECT_DOUBLE_EQ(RateAdaptation::rate_hz(5.0, 2.0, 1.0), 5.0);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace mavsdk {
+
+// A value which only becomes known at some point, typically once the vehicle
+// has answered. Blocking calls wait for it to be set, and async calls queue a
+// callback which is run as soon as it is, rather than polling for it.
+template<typename T> class ReadyValue {
+public:
+    ReadyValue() = default;
+    explicit ReadyValue(T value) : _value(std::move(value)) {}
+    ~ReadyValue() = default;
+
+    // Sets the value, wakes up everyone waiting, and runs the queued callbacks
+    // on the calling thread.
+    void set(T value)
+    {
+        std::vector<std::function<void(const T&)>> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _value = value;
+            callbacks.swap(_callbacks);
+        }
+        _cv.notify_all();
+
+        for (const auto& callback : callbacks) {
+            callback(value);
+        }
+    }
+
+    // Back to not known, callbacks queued from now on wait for the next set.
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _value.reset();
+    }
+
+    std::optional<T> get() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _value;
+    }
+
+    T wait() const
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this]() { return _value.has_value(); });
+        return _value.value();
+    }
+
+    // Runs the callback right away if the value is known, otherwise once it is.
+    void when_ready(std::function<void(const T&)> callback)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (!_value) {
+            _callbacks.push_back(std::move(callback));
+            return;
+        }
+        const T value = _value.value();
+        lock.unlock();
+        callback(value);
+    }
+
+    ReadyValue(const ReadyValue&) = delete;
+    const ReadyValue& operator=(const ReadyValue&) = delete;
+
+private:
+    mutable std::mutex _mutex{};
+    mutable std::condition_variable _cv{};
+    std::optional<T> _value{};
+    std::vector<std::function<void(const T&)>> _callbacks{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,86 @@
+#include "ready_value.h"
+
+#include <future>
+#include <thread>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(ReadyValue, NotSetByDefault)
+{
+    ReadyValue<int> ready_value{};
+    EXPECT_FALSE(ready_value.get().has_value());
+
+    ReadyValue<int> ready_value_set{42};
+    EXPECT_EQ(ready_value_set.get(), 42);
+    EXPECT_EQ(ready_value_set.wait(), 42);
+}
+
+TEST(ReadyValue, WaitReturnsOnceSet)
+{
+    ReadyValue<int> ready_value{};
+
+    auto fut = std::async(std::launch::async, [&]() { return ready_value.wait(); });
+    EXPECT_EQ(fut.wait_for(std::chrono::milliseconds(20)), std::future_status::timeout);
+
+    ready_value.set(7);
+    ASSERT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    EXPECT_EQ(fut.get(), 7);
+}
+
+TEST(ReadyValue, WhenReadyRunsOnSet)
+{
+    ReadyValue<int> ready_value{};
+
+    int calls = 0;
+    int last = 0;
+    ready_value.when_ready([&](const int& value) {
+        ++calls;
+        last = value;
+    });
+    ready_value.when_ready([&](const int& value) {
+        ++calls;
+        last = value;
+    });
+    EXPECT_EQ(calls, 0);
+
+    ready_value.set(3);
+    EXPECT_EQ(calls, 2);
+    EXPECT_EQ(last, 3);
+
+    // Queued callbacks only run once.
+    ready_value.set(4);
+    EXPECT_EQ(calls, 2);
+
+    // And it's run right away now that the value is known.
+    ready_value.when_ready([&](const int& value) {
+        ++calls;
+        last = value;
+    });
+    EXPECT_EQ(calls, 3);
+    EXPECT_EQ(last, 4);
+}
+
+TEST(ReadyValue, Reset)
+{
+    ReadyValue<int> ready_value{1};
+    ready_value.reset();
+    EXPECT_FALSE(ready_value.get().has_value());
+
+    bool called = false;
+    ready_value.when_ready([&](const int&) { called = true; });
+    EXPECT_FALSE(called);
+
+    ready_value.set(2);
+    EXPECT_TRUE(called);
+}
+
+TEST(ReadyValue, CallbackCanUseValue)
+{
+    // A callback asking for the value again must not deadlock.
+    ReadyValue<int> ready_value{};
+    int seen = 0;
+    ready_value.when_ready([&](const int&) { seen = ready_value.get().value_or(0); });
+    ready_value.set(5);
+    EXPECT_EQ(seen, 5);
+}
@@ -0,0 +1,104 @@
+#include "receive_pipeline.h"
+#include "log.h"
+
+#include <algorithm>
+
+namespace mavsdk {
+
+ReceivePipeline::ReceivePipeline(
+    unsigned num_threads, std::size_t capacity, Dispatch dispatch, ThreadSetup thread_setup) :
+    _dispatch(std::move(dispatch)),
+    _thread_setup(std::move(thread_setup))
+{
+    num_threads = std::max(1u, num_threads);
+    for (unsigned i = 0; i < num_threads; ++i) {
+        _shards.push_back(std::make_unique<Shard>(capacity));
+    }
+    for (std::size_t i = 0; i < _shards.size(); ++i) {
+        _shards[i]->thread = NativeThread(
+            _thread_setup.settings.stack_size_bytes,
+            [this, &shard = *_shards[i], i]() { dispatch_thread(shard, i); });
+    }
+}
+
+ReceivePipeline::~ReceivePipeline()
+{
+    stop();
+}
+
+bool ReceivePipeline::push(std::shared_ptr<mavlink_message_t> message, uint64_t receive_time_ns)
+{
+    if (_should_exit) {
+        return false;
+    }
+
+    auto& shard = *_shards[message->sysid % _shards.size()];
+
+    ReceivedMessage received{std::move(message), receive_time_ns};
+    if (!shard.queue.try_push(std::move(received))) {
+        ++_dropped;
+        if (!shard.overflowing.exchange(true)) {
+            LogWarn() << "Message handlers too slow, dropping received messages";
+        }
+        return false;
+    }
+    shard.overflowing = false;
+
+    // Make sure the push is visible before we check whether the dispatch
+    // thread is asleep, the dispatch thread does the opposite.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (shard.consumer_waiting) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.consumer_waiting = false;
+        shard.not_empty.notify_one();
+    }
+
+    return true;
+}
+
+void ReceivePipeline::stop()
+{
+    if (_should_exit.exchange(true)) {
+        return;
+    }
+
+    for (auto& shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->not_empty.notify_all();
+    }
+    for (auto& shard : _shards) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+}
+
+void ReceivePipeline::dispatch_thread(Shard& shard, std::size_t index)
+{
+    _thread_setup.with_index(index).apply();
+
+    ReceivedMessage received{};
+
+    while (!_should_exit) {
+        if (shard.queue.try_pop(received)) {
+            _dispatch(received.message, received.receive_time_ns);
+            // Back to the pool, unless someone still holds on to it.
+            received.message.reset();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        shard.consumer_waiting = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        // Something might have been pushed while we were getting ready to wait.
+        if (!shard.queue.empty()) {
+            shard.consumer_waiting = false;
+            continue;
+        }
+
+        shard.not_empty.wait(lock, [&]() { return !shard.consumer_waiting || _should_exit; });
+    }
+}
+
+} // namespace mavsdk
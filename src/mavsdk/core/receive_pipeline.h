@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "lock_free_queue.h"
+#include "mavlink_include.h"
+#include "native_thread.h"
+#include "thread_setup.h"
+
+namespace mavsdk {
+
+// Hands received messages over from the receive threads of the connections
+// to dispatch threads which run the message handlers, so a slow handler
+// doesn't hold up reading from the sockets.
+//
+// Messages are sharded by system ID, the messages of one system are
+// therefore all dispatched by the same thread, in the order they were
+// received. Messages are passed on by handle (see MessagePool), through a
+// bounded ring per shard. If a shard is full, the newest message is
+// dropped, just like the OS would drop it if it wasn't read in time.
+class ReceivePipeline {
+public:
+    using Dispatch = std::function<void(
+        const std::shared_ptr<mavlink_message_t>& message, uint64_t receive_time_ns)>;
+
+    ReceivePipeline(
+        unsigned num_threads,
+        std::size_t capacity,
+        Dispatch dispatch,
+        ThreadSetup thread_setup = {});
+    ~ReceivePipeline();
+
+    // Returns false if the message was dropped.
+    bool push(std::shared_ptr<mavlink_message_t> message, uint64_t receive_time_ns);
+
+    // Stops the dispatch threads, messages still queued are dropped.
+    void stop();
+
+    [[nodiscard]] unsigned num_threads() const { return static_cast<unsigned>(_shards.size()); }
+
+    [[nodiscard]] uint64_t dropped() const { return _dropped; }
+
+    // Non-copyable
+    ReceivePipeline(const ReceivePipeline&) = delete;
+    const ReceivePipeline& operator=(const ReceivePipeline&) = delete;
+
+private:
+    struct ReceivedMessage {
+        std::shared_ptr<mavlink_message_t> message{};
+        uint64_t receive_time_ns{0};
+    };
+
+    struct Shard {
+        explicit Shard(std::size_t capacity) : queue(capacity) {}
+
+        LockFreeQueue<ReceivedMessage> queue;
+        std::mutex mutex{};
+        std::condition_variable not_empty{};
+        std::atomic<bool> consumer_waiting{false};
+        std::atomic<bool> overflowing{false};
+        NativeThread thread{};
+    };
+
+    void dispatch_thread(Shard& shard, std::size_t index);
+
+    Dispatch _dispatch;
+    const ThreadSetup _thread_setup;
+    std::vector<std::unique_ptr<Shard>> _shards{};
+    std::atomic<bool> _should_exit{false};
+    std::atomic<uint64_t> _dropped{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,121 @@
+#include "receive_pipeline.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+using MessageHandle = std::shared_ptr<mavlink_message_t>;
+
+static MessageHandle make_message(uint8_t sysid, uint32_t seq)
+{
+    auto message = std::make_shared<mavlink_message_t>();
+    message->sysid = sysid;
+    message->seq = static_cast<uint8_t>(seq);
+    message->msgid = seq;
+    return message;
+}
+
+static bool wait_for(const std::function<bool()>& condition)
+{
+    for (int i = 0; i < 1000; ++i) {
+        if (condition()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+TEST(ReceivePipeline, DispatchesInOrderOnAnotherThread)
+{
+    std::mutex mutex;
+    std::vector<uint32_t> dispatched;
+    std::vector<uint64_t> receive_times;
+    std::thread::id dispatch_thread_id;
+
+    ReceivePipeline pipeline{1, 64, [&](const MessageHandle& message, uint64_t receive_time_ns) {
+                                 std::lock_guard<std::mutex> lock(mutex);
+                                 dispatched.push_back(message->msgid);
+                                 receive_times.push_back(receive_time_ns);
+                                 dispatch_thread_id = std::this_thread::get_id();
+                             }};
+
+    for (uint32_t i = 0; i < 50; ++i) {
+        EXPECT_TRUE(pipeline.push(make_message(1, i), 1000 + i));
+    }
+
+    ASSERT_TRUE(wait_for([&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return dispatched.size() == 50;
+    }));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (uint32_t i = 0; i < 50; ++i) {
+        EXPECT_EQ(dispatched[i], i);
+        EXPECT_EQ(receive_times[i], 1000 + i);
+    }
+    EXPECT_NE(dispatch_thread_id, std::this_thread::get_id());
+    EXPECT_EQ(pipeline.dropped(), 0);
+}
+
+TEST(ReceivePipeline, ShardsBySystemId)
+{
+    std::mutex mutex;
+    std::vector<std::thread::id> thread_ids(3);
+    std::atomic<int> count{0};
+
+    ReceivePipeline pipeline{2, 64, [&](const MessageHandle& message, uint64_t) {
+                                 std::lock_guard<std::mutex> lock(mutex);
+                                 thread_ids[message->sysid] = std::this_thread::get_id();
+                                 ++count;
+                             }};
+    EXPECT_EQ(pipeline.num_threads(), 2);
+
+    pipeline.push(make_message(1, 0), 0);
+    pipeline.push(make_message(2, 0), 0);
+
+    ASSERT_TRUE(wait_for([&]() { return count == 2; }));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_NE(thread_ids[1], thread_ids[2]);
+}
+
+TEST(ReceivePipeline, SlowHandlerDoesNotBlockPush)
+{
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic<bool> entered{false};
+    std::atomic<int> count{0};
+
+    ReceivePipeline pipeline{1, 4, [&](const MessageHandle&, uint64_t) {
+                                 entered = true;
+                                 released.wait();
+                                 ++count;
+                             }};
+
+    EXPECT_TRUE(pipeline.push(make_message(1, 0), 0));
+    ASSERT_TRUE(wait_for([&]() { return entered.load(); }));
+
+    // While the handler is stuck, the queue fills up and then drops.
+    for (uint32_t i = 1; i <= 4; ++i) {
+        EXPECT_TRUE(pipeline.push(make_message(1, i), 0));
+    }
+    EXPECT_FALSE(pipeline.push(make_message(1, 5), 0));
+    EXPECT_EQ(pipeline.dropped(), 1);
+
+    release.set_value();
+    ASSERT_TRUE(wait_for([&]() { return count == 5; }));
+}
+
+TEST(ReceivePipeline, StopRejectsMessages)
+{
+    ReceivePipeline pipeline{1, 4, [](const MessageHandle&, uint64_t) {}};
+    pipeline.stop();
+    EXPECT_FALSE(pipeline.push(make_message(1, 0), 0));
+}
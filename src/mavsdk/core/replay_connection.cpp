@@ -0,0 +1,125 @@
+#include "replay_connection.h"
+#include "log.h"
+#include "message_latency.h"
+
+#include <chrono>
+#include <utility>
+
+namespace mavsdk {
+
+ReplayConnection::ReplayConnection(
+    Connection::receiver_callback_t receiver_callback,
+    std::string path,
+    bool as_fast_as_possible,
+    uint8_t own_system_id,
+    ForwardingOption forwarding_option) :
+    Connection(std::move(receiver_callback), forwarding_option),
+    _path(std::move(path)),
+    _as_fast_as_possible(as_fast_as_possible),
+    _own_system_id(own_system_id)
+{}
+
+ReplayConnection::~ReplayConnection()
+{
+    // If no one explicitly called stop before, we should at least do it.
+    stop();
+}
+
+ConnectionResult ReplayConnection::start()
+{
+    if (!_reader.open(_path)) {
+        return ConnectionResult::ConnectionError;
+    }
+
+    if (!start_mavlink_receiver()) {
+        return ConnectionResult::ConnectionsExhausted;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_exit = false;
+    }
+    _done = false;
+    _replay_thread = std::make_unique<NativeThread>(
+        _thread_setup.settings.stack_size_bytes, [this]() { replay(); });
+
+    return ConnectionResult::Success;
+}
+
+ConnectionResult ReplayConnection::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_exit = true;
+    }
+    _cv.notify_all();
+
+    if (_replay_thread) {
+        _replay_thread->join();
+        _replay_thread.reset();
+    }
+
+    _reader.close();
+
+    // We need to stop this after stopping the replay, otherwise
+    // we will get stuck in replay().
+    stop_mavlink_receiver();
+
+    return ConnectionResult::Success;
+}
+
+bool ReplayConnection::send_frame(const MavlinkFrame& frame)
+{
+    // There is no one to send to.
+    (void)frame;
+    return true;
+}
+
+void ReplayConnection::replay()
+{
+    _thread_setup.apply();
+
+    using std::chrono::steady_clock;
+
+    TlogReader::Record record;
+    uint64_t first_time_us = 0;
+    steady_clock::time_point start{};
+    unsigned replayed = 0;
+
+    while (_reader.next(record)) {
+        if (!_as_fast_as_possible) {
+            if (replayed == 0) {
+                first_time_us = record.time_us;
+                start = steady_clock::now();
+            }
+
+            // A log can go back in time, e.g. when the clock was set, then
+            // the frame just goes right away.
+            const auto offset = std::chrono::microseconds(
+                record.time_us > first_time_us ? record.time_us - first_time_us : 0);
+
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (_cv.wait_until(lock, start + offset, [this]() { return _should_exit.load(); })) {
+                return;
+            }
+        } else if (_should_exit) {
+            return;
+        }
+
+        _mavlink_receiver->set_new_datagram(
+            reinterpret_cast<char*>(record.frame), record.length, MessageLatency::now_ns());
+        while (_mavlink_receiver->parse_message()) {
+            auto& message = _mavlink_receiver->get_last_message();
+            if (message.sysid == _own_system_id) {
+                continue;
+            }
+            receive_message(message, this);
+        }
+        ++replayed;
+    }
+
+    LogInfo() << "Replay of " << _path << " done after " << replayed << " frames";
+    _done = true;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "connection.h"
+#include "tlog.h"
+
+namespace mavsdk {
+
+// Feeds the frames of a tlog to MAVSDK as if they were just received, either
+// at their original timing or as fast as possible. This makes any captured
+// flight, or any load, reproducible without a vehicle.
+//
+// Frames from our own system ID are skipped, in a capture these are the ones
+// MAVSDK sent itself. Whatever is sent over the connection is dropped.
+class ReplayConnection : public Connection {
+public:
+    explicit ReplayConnection(
+        Connection::receiver_callback_t receiver_callback,
+        std::string path,
+        bool as_fast_as_possible,
+        uint8_t own_system_id,
+        ForwardingOption forwarding_option = ForwardingOption::ForwardingOff);
+    ~ReplayConnection() override;
+
+    ConnectionResult start() override;
+    ConnectionResult stop() override;
+
+    bool send_frame(const MavlinkFrame& frame) override;
+
+    // Whether the whole tlog was replayed.
+    bool is_done() const { return _done; }
+
+    // Non-copyable
+    ReplayConnection(const ReplayConnection&) = delete;
+    const ReplayConnection& operator=(const ReplayConnection&) = delete;
+
+private:
+    void replay();
+
+    const std::string _path;
+    const bool _as_fast_as_possible;
+    const uint8_t _own_system_id;
+
+    TlogReader _reader{};
+
+    // Only for waiting until a frame is due, set _should_exit under it.
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::atomic<bool> _should_exit{false};
+    std::atomic<bool> _done{false};
+    std::unique_ptr<NativeThread> _replay_thread{};
+};
+
+} // namespace mavsdk
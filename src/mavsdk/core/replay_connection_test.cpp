@@ -0,0 +1,124 @@
+#include "replay_connection.h"
+#include "tlog.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+constexpr uint8_t own_system_id = 245;
+
+// Heartbeats of system 1, 100 ms apart, with one we sent in between.
+std::string write_tlog(const char* name)
+{
+    const auto path = testing::TempDir() + name;
+    std::remove(path.c_str());
+
+    TlogWriter writer;
+    EXPECT_TRUE(writer.open(path));
+
+    const uint64_t start_us = 1600000000000000;
+    for (unsigned i = 0; i < 3; ++i) {
+        mavlink_message_t message;
+        mavlink_msg_heartbeat_pack(
+            1, MAV_COMP_ID_AUTOPILOT1, &message, MAV_TYPE_QUADROTOR, 0, 0, 0, 0);
+        MavlinkFrame frame(message);
+        writer.write(frame.buffer, frame.length, start_us + i * 100000);
+
+        mavlink_msg_heartbeat_pack(
+            own_system_id, MAV_COMP_ID_MISSIONPLANNER, &message, MAV_TYPE_GCS, 0, 0, 0, 0);
+        MavlinkFrame own_frame(message);
+        writer.write(own_frame.buffer, own_frame.length, start_us + i * 100000 + 10);
+    }
+    return path;
+}
+
+class Received {
+public:
+    void add(const mavlink_message_t& message)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _sysids.push_back(message.sysid);
+        _cv.notify_all();
+    }
+
+    bool wait_for(std::size_t count)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        return _cv.wait_for(
+            lock, std::chrono::seconds(2), [&]() { return _sysids.size() >= count; });
+    }
+
+    std::vector<uint8_t> sysids()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _sysids;
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::vector<uint8_t> _sysids;
+};
+
+} // namespace
+
+TEST(ReplayConnection, ReplaysAsFastAsPossible)
+{
+    const auto path = write_tlog("replay_connection_test_fast.tlog");
+
+    Received received;
+    ReplayConnection connection(
+        [&](mavlink_message_t& message, Connection*) { received.add(message); },
+        path,
+        true,
+        own_system_id);
+
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(connection.start(), ConnectionResult::Success);
+    ASSERT_TRUE(received.wait_for(3));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(150));
+
+    // Our own messages are skipped.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(received.sysids(), (std::vector<uint8_t>{1, 1, 1}));
+    EXPECT_TRUE(connection.is_done());
+
+    connection.stop();
+    std::remove(path.c_str());
+}
+
+TEST(ReplayConnection, ReplaysAtOriginalTiming)
+{
+    const auto path = write_tlog("replay_connection_test_timed.tlog");
+
+    Received received;
+    ReplayConnection connection(
+        [&](mavlink_message_t& message, Connection*) { received.add(message); },
+        path,
+        false,
+        own_system_id);
+
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(connection.start(), ConnectionResult::Success);
+    ASSERT_TRUE(received.wait_for(3));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(200));
+
+    connection.stop();
+    std::remove(path.c_str());
+}
+
+TEST(ReplayConnection, FailsWithoutTlog)
+{
+    ReplayConnection connection(
+        [](mavlink_message_t&, Connection*) {}, "/nonexistent/flight.tlog", true, own_system_id);
+    EXPECT_EQ(connection.start(), ConnectionResult::ConnectionError);
+}
@@ -1,8 +1,9 @@
-
 #include "log.h"
 #include "request_message.h"
 #include "system_impl.h"
 
+#include <algorithm>
+
 namespace mavsdk {
 
 RequestMessage::RequestMessage(
@@ -16,6 +17,13 @@ RequestMessage::RequestMessage(
     _timeout_handler(timeout_handler)
 {}
 
+bool RequestMessage::Key::answered_by(const mavlink_message_t& message) const
+{
+    // TODO: check if params are correct.
+    return message.msgid == message_id &&
+           (target_component == MAV_COMP_ID_ALL || message.compid == target_component);
+}
+
 void RequestMessage::request(
     uint32_t message_id, uint8_t target_component, RequestMessageCallback callback, uint32_t param2)
 {
@@ -27,43 +35,70 @@ void RequestMessage::request(
 
     // Cleanup previous requests.
     for (const auto id : _deferred_message_cleanup) {
-        _message_handler.unregister_one(id, this);
+        if (!waiting_for(id)) {
+            _message_handler.unregister_one(id, this);
+        }
     }
     _deferred_message_cleanup.clear();
 
-    // Respond with 'Busy' if already in progress.
-    for (auto& item : _work_items) {
-        if (item.message_id == message_id && item.param2 == param2) {
+    const Key key{message_id, target_component, param2};
+
+    // Answer right away if we got the message recently enough.
+    const double ttl_s = _system_impl.get_request_message_cache_ttl_s();
+    _cache.erase(
+        std::remove_if(
+            _cache.begin(),
+            _cache.end(),
+            [&](const CachedMessage& cached) {
+                return _time.elapsed_since_s(cached.received) > ttl_s;
+            }),
+        _cache.end());
+    for (const auto& cached : _cache) {
+        if (cached.key == key) {
+            const auto message = cached.message;
             lock.unlock();
-            callback(MavlinkCommandSender::Result::Busy, {});
+            callback(MavlinkCommandSender::Result::Success, message);
             return;
         }
     }
 
+    // Wait for the same answer if it's requested already.
+    auto it = find_work_item(key);
+    if (it != _work_items.end()) {
+        it->callbacks.push_back(std::move(callback));
+        return;
+    }
+
     // Otherwise, schedule it.
-    _work_items.emplace_back(WorkItem{message_id, target_component, callback, param2});
+    const bool registered = waiting_for(message_id);
+    _work_items.emplace_back(WorkItem{key, {std::move(callback)}});
 
     // Register for message
-    _message_handler.register_one(
-        message_id,
-        [this](const mavlink_message_t& message) { handle_any_message(message); },
-        this);
+    if (!registered) {
+        _message_handler.register_one(
+            message_id,
+            [this](const mavlink_message_t& message) { handle_any_message(message); },
+            this);
+    }
 
     // And send off command
-    send_request(message_id, target_component);
+    send_request(key);
 }
 
-void RequestMessage::send_request(uint32_t message_id, uint8_t target_component)
+void RequestMessage::send_request(const Key& key)
 {
     MavlinkCommandSender::CommandLong command_request_message{};
     command_request_message.command = MAV_CMD_REQUEST_MESSAGE;
     command_request_message.target_system_id = _system_impl.get_system_id();
-    command_request_message.target_component_id = target_component;
-    command_request_message.params.maybe_param1 = {static_cast<float>(message_id)};
+    command_request_message.target_component_id = key.target_component;
+    command_request_message.params.maybe_param1 = {static_cast<float>(key.message_id)};
+    if (key.param2 != 0) {
+        command_request_message.params.maybe_param2 = {static_cast<float>(key.param2)};
+    }
     _command_sender.queue_command_async(
-        command_request_message, [this, message_id](MavlinkCommandSender::Result result, float) {
+        command_request_message, [this, key](MavlinkCommandSender::Result result, float) {
             if (result != MavlinkCommandSender::Result::InProgress) {
-                handle_command_result(message_id, result);
+                handle_command_result(key, result);
             }
         });
 }
@@ -72,106 +107,129 @@ void RequestMessage::handle_any_message(const mavlink_message_t& message)
 {
     std::unique_lock<std::mutex> lock(_mutex);
 
-    for (auto it = _work_items.begin(); it != _work_items.end(); ++it) {
-        // Check if we're waiting for this message.
-        // TODO: check if params are correct.
-        if (it->message_id != message.msgid) {
+    // We have at least the message which is what we care about most, so we
+    // tell everyone waiting for it and call it a day. If we receive the result
+    // of the command later, we ignore it, and we fake the result to be
+    // successful anyway.
+    std::vector<RequestMessageCallback> callbacks;
+    for (auto it = _work_items.begin(); it != _work_items.end();) {
+        if (!it->key.answered_by(message)) {
+            ++it;
             continue;
         }
 
         _timeout_handler.remove(it->timeout_cookie);
-        // We have at least the message which is what we care about most, so we
-        // tell the user about it and call it a day. If we receive the result
-        // of the command later, we ignore it, and we fake the result to be successful
-        // anyway.
-        auto temp_callback = it->callback;
+        std::move(it->callbacks.begin(), it->callbacks.end(), std::back_inserter(callbacks));
+
+        if (_system_impl.get_request_message_cache_ttl_s() > 0.0) {
+            _cache.push_back(CachedMessage{it->key, message, _time.steady_time()});
+        }
+
         // We can now get rid of the entry now.
-        _work_items.erase(it);
-        // We have to clean up later outside this callback, otherwise we lock ourselves out.
-        _deferred_message_cleanup.push_back(message.msgid);
-        lock.unlock();
+        it = _work_items.erase(it);
+    }
 
-        temp_callback(MavlinkCommandSender::Result::Success, message);
+    if (callbacks.empty()) {
         return;
     }
+
+    // We have to clean up later outside this callback, otherwise we lock ourselves out.
+    _deferred_message_cleanup.push_back(message.msgid);
+    lock.unlock();
+
+    for (const auto& callback : callbacks) {
+        callback(MavlinkCommandSender::Result::Success, message);
+    }
 }
 
-void RequestMessage::handle_command_result(uint32_t message_id, MavlinkCommandSender::Result result)
+void RequestMessage::handle_command_result(const Key& key, MavlinkCommandSender::Result result)
 {
     std::unique_lock<std::mutex> lock(_mutex);
 
-    for (auto it = _work_items.begin(); it != _work_items.end(); ++it) {
-        // Check if we're waiting for this result
-        if (it->message_id != message_id) {
-            continue;
-        }
+    auto it = find_work_item(key);
+    if (it == _work_items.end()) {
+        return;
+    }
 
-        switch (result) {
-            case MavlinkCommandSender::Result::Success:
-                // This is promising, let's hope the message will actually arrive.
-                // We'll set a timeout in case we need to retry.
-                _timeout_handler.add(
-                    [this, message_id, target_component = it->target_component]() {
-                        handle_timeout(message_id, target_component);
-                    },
-                    1.0,
-                    &it->timeout_cookie);
-                return;
-
-            case MavlinkCommandSender::Result::NoSystem:
-                // FALLTHROUGH
-            case MavlinkCommandSender::Result::ConnectionError:
-                // FALLTHROUGH
-            case MavlinkCommandSender::Result::UnknownError:
-                // FALLTHROUGH
-            case MavlinkCommandSender::Result::Unsupported:
-                // FALLTHROUGH
-            case MavlinkCommandSender::Result::Timeout:
-                // FALLTHROUGH
-            case MavlinkCommandSender::Result::Busy:
-                // FALLTHROUGH
-            case MavlinkCommandSender::Result::CommandDenied: {
-                // It looks like this did not work, and we can report the error
-                // No need to try again.
-                auto temp_callback = it->callback;
-                _message_handler.unregister_one(it->message_id, this);
-                _work_items.erase(it);
-                lock.unlock();
-                temp_callback(result, {});
-                return;
-            }
+    switch (result) {
+        case MavlinkCommandSender::Result::Success:
+            // This is promising, let's hope the message will actually arrive.
+            // We'll set a timeout in case we need to retry.
+            _timeout_handler.add([this, key]() { handle_timeout(key); }, 1.0, &it->timeout_cookie);
+            return;
 
-            case MavlinkCommandSender::Result::InProgress:
-                // Should not happen, as it is already filtered out.
-                return;
+        case MavlinkCommandSender::Result::NoSystem:
+            // FALLTHROUGH
+        case MavlinkCommandSender::Result::ConnectionError:
+            // FALLTHROUGH
+        case MavlinkCommandSender::Result::UnknownError:
+            // FALLTHROUGH
+        case MavlinkCommandSender::Result::Unsupported:
+            // FALLTHROUGH
+        case MavlinkCommandSender::Result::Timeout:
+            // FALLTHROUGH
+        case MavlinkCommandSender::Result::Busy:
+            // FALLTHROUGH
+        case MavlinkCommandSender::Result::CommandDenied: {
+            // It looks like this did not work, and we can report the error
+            // No need to try again.
+            auto callbacks = std::move(it->callbacks);
+            _work_items.erase(it);
+            if (!waiting_for(key.message_id)) {
+                _message_handler.unregister_one(key.message_id, this);
+            }
+            lock.unlock();
+            for (const auto& callback : callbacks) {
+                callback(result, {});
+            }
+            return;
         }
+
+        case MavlinkCommandSender::Result::InProgress:
+            // Should not happen, as it is already filtered out.
+            return;
     }
 }
 
-void RequestMessage::handle_timeout(uint32_t message_id, uint8_t target_component)
+void RequestMessage::handle_timeout(const Key& key)
 {
     std::unique_lock<std::mutex> lock(_mutex);
 
-    for (auto it = _work_items.begin(); it != _work_items.end(); ++it) {
-        // Check if we're waiting for this result
-        if (it->message_id != message_id) {
-            continue;
-        }
+    auto it = find_work_item(key);
+    if (it == _work_items.end()) {
+        return;
+    }
 
-        if (it->retries > 2) {
-            // We have already retried, let's give up.
-            auto temp_callback = it->callback;
-            _message_handler.unregister_one(it->message_id, this);
-            _work_items.erase(it);
-            lock.unlock();
-            temp_callback(MavlinkCommandSender::Result::Timeout, {});
-            return;
-        } else {
-            send_request(message_id, target_component);
-            LogWarn() << "Requesting message again (retries: " << it->retries << ")";
-            it->retries += 1;
+    if (it->retries > 2) {
+        // We have already retried, let's give up.
+        auto callbacks = std::move(it->callbacks);
+        _work_items.erase(it);
+        if (!waiting_for(key.message_id)) {
+            _message_handler.unregister_one(key.message_id, this);
+        }
+        lock.unlock();
+        for (const auto& callback : callbacks) {
+            callback(MavlinkCommandSender::Result::Timeout, {});
         }
+    } else {
+        send_request(key);
+        LogWarn() << "Requesting message again (retries: " << it->retries << ")";
+        it->retries += 1;
     }
 }
 
+std::vector<RequestMessage::WorkItem>::iterator RequestMessage::find_work_item(const Key& key)
+{
+    return std::find_if(_work_items.begin(), _work_items.end(), [&](const WorkItem& item) {
+        return item.key == key;
+    });
+}
+
+bool RequestMessage::waiting_for(uint32_t message_id) const
+{
+    return std::any_of(_work_items.begin(), _work_items.end(), [&](const WorkItem& item) {
+        return item.key.message_id == message_id;
+    });
+}
+
 } // namespace mavsdk
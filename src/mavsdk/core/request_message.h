@@ -2,6 +2,7 @@
 
 #include "mavlink_command_sender.h"
 #include "mavlink_message_handler.h"
+#include "mavsdk_time.h"
 #include "timeout_handler.h"
 #include "mavlink_include.h"
 #include <functional>
@@ -13,6 +14,12 @@ namespace mavsdk {
 
 class SystemImpl;
 
+// Requests messages with MAV_CMD_REQUEST_MESSAGE.
+//
+// Requests for the same message, from the same component and with the same
+// parameter, share one request, and everyone waiting gets the answer. The
+// answers are kept for the TTL set in the configuration, requests within
+// that time are answered right away.
 class RequestMessage {
 public:
     RequestMessage(
@@ -32,28 +39,53 @@ public:
         uint32_t param2 = 0);
 
 private:
-    struct WorkItem {
+    struct Key {
         uint32_t message_id{0};
         uint8_t target_component{0};
-        RequestMessageCallback callback{};
         uint32_t param2{0};
+
+        bool operator==(const Key& other) const
+        {
+            return message_id == other.message_id && target_component == other.target_component &&
+                   param2 == other.param2;
+        }
+
+        // Whether the message can be the answer to a request with this key.
+        bool answered_by(const mavlink_message_t& message) const;
+    };
+
+    struct WorkItem {
+        Key key{};
+        std::vector<RequestMessageCallback> callbacks{};
         std::size_t retries{0};
         void* timeout_cookie{nullptr};
-        std::optional<MavlinkCommandSender::Result> maybe_result{};
     };
 
-    void send_request(uint32_t message_id, uint8_t target_component);
+    struct CachedMessage {
+        Key key{};
+        mavlink_message_t message{};
+        dl_time_t received{};
+    };
+
+    void send_request(const Key& key);
     void handle_any_message(const mavlink_message_t& message);
-    void handle_command_result(uint32_t message_id, MavlinkCommandSender::Result result);
-    void handle_timeout(uint32_t message_id, uint8_t target_component);
+    void handle_command_result(const Key& key, MavlinkCommandSender::Result result);
+    void handle_timeout(const Key& key);
+
+    // Expects _mutex to be held.
+    std::vector<WorkItem>::iterator find_work_item(const Key& key);
+    bool waiting_for(uint32_t message_id) const;
 
     SystemImpl& _system_impl;
     MavlinkCommandSender& _command_sender;
     MAVLinkMessageHandler& _message_handler;
     TimeoutHandler& _timeout_handler;
 
+    Time _time{};
+
     std::mutex _mutex{};
     std::vector<WorkItem> _work_items{};
+    std::vector<CachedMessage> _cache{};
     std::vector<int> _deferred_message_cleanup{};
 };
 
@@ -2,7 +2,10 @@
 
 #include <iterator>
 #include <cstddef>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <utility>
 
 // Inspired by:
 // https://codereview.stackexchange.com/questions/189380/example-of-adding-stl-iterator-support-to-custom-collection-class
@@ -22,14 +25,14 @@ public:
         if (_size < N) {
             ++_size;
         }
-        _index = (_index + 1) % N;
+        _index = wrap(_index + 1);
 
         _storage[_index] = value;
     }
 
-    T& operator[](int index) { return _storage[(_index + index + 1) % N]; }
+    T& operator[](int index) { return _storage[wrap(_index + index + 1)]; }
 
-    const T& operator[](int index) const { return _storage[(_index + index + 1) % N]; }
+    const T& operator[](int index) const { return _storage[wrap(_index + index + 1)]; }
 
     using iterator = RingbufferIterator<T, N>;
     using const_iterator = ConstRingbufferIterator<T, N>;
@@ -43,6 +46,16 @@ public:
     std::size_t size() const { return _size; }
 
 private:
+    // A power of two size wraps with a mask instead of a division.
+    static constexpr std::size_t wrap(std::size_t index)
+    {
+        if constexpr ((N & (N - 1)) == 0) {
+            return index & (N - 1);
+        } else {
+            return index % N;
+        }
+    }
+
     std::array<T, N> _storage{};
     std::size_t _index{0};
     std::size_t _size{0};
@@ -156,4 +169,114 @@ private:
     std::size_t _off;
 };
 
+// Lock-free ring buffer handing items from one producer thread to one
+// consumer thread, e.g. between pipeline stages.
+//
+// Unlike Ringbuffer, it is a queue: items are popped in the order they were
+// pushed, and pushing into a full buffer fails instead of overwriting the
+// oldest item. Head and tail are on cache lines of their own, and each side
+// keeps a copy of the other side's index, so it only touches the other
+// side's cache line once the copy says it is full or empty.
+//
+// N needs to be a power of two, so indices wrap with a mask.
+template<typename T, std::size_t N> class SpscRingbuffer {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "N needs to be a power of two");
+
+public:
+    SpscRingbuffer() = default;
+    ~SpscRingbuffer() = default;
+
+    // Non-copyable
+    SpscRingbuffer(const SpscRingbuffer&) = delete;
+    const SpscRingbuffer& operator=(const SpscRingbuffer&) = delete;
+
+    // Producer only. The item is only moved from if it could be pushed.
+    bool try_push(T&& item) { return push_with([&](T& slot) { slot = std::move(item); }); }
+    bool try_push(const T& item) { return push_with([&](T& slot) { slot = item; }); }
+
+    // Producer only. Pushes as many of the items as fit, returns how many.
+    std::size_t push(const T* items, std::size_t count)
+    {
+        const std::size_t head = _head.load(std::memory_order_relaxed);
+        count = std::min(count, free_for_producer(head, count));
+        for (std::size_t i = 0; i < count; ++i) {
+            _storage[(head + i) & MASK] = items[i];
+        }
+        _head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer only.
+    bool try_pop(T& item) { return pop(&item, 1) == 1; }
+
+    // Consumer only. Pops up to max_count items, returns how many.
+    std::size_t pop(T* items, std::size_t max_count)
+    {
+        const std::size_t tail = _tail.load(std::memory_order_relaxed);
+        const std::size_t count = std::min(max_count, available_for_consumer(tail, max_count));
+        for (std::size_t i = 0; i < count; ++i) {
+            items[i] = std::move(_storage[(tail + i) & MASK]);
+        }
+        _tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Only exact when called from the producer or the consumer while the
+    // other side is idle.
+    [[nodiscard]] std::size_t size_approx() const
+    {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] bool empty_approx() const { return size_approx() == 0; }
+
+    [[nodiscard]] static constexpr std::size_t capacity() { return N; }
+
+private:
+    static constexpr std::size_t MASK = N - 1;
+
+    template<typename Fill> bool push_with(Fill&& fill)
+    {
+        const std::size_t head = _head.load(std::memory_order_relaxed);
+        if (free_for_producer(head, 1) == 0) {
+            return false;
+        }
+        fill(_storage[head & MASK]);
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // At least wanted if that many are free according to the cached tail,
+    // otherwise what is actually free.
+    std::size_t free_for_producer(std::size_t head, std::size_t wanted)
+    {
+        std::size_t free = N - (head - _cached_tail);
+        if (free < wanted) {
+            _cached_tail = _tail.load(std::memory_order_acquire);
+            free = N - (head - _cached_tail);
+        }
+        return free;
+    }
+
+    std::size_t available_for_consumer(std::size_t tail, std::size_t wanted)
+    {
+        std::size_t available = _cached_head - tail;
+        if (available < wanted) {
+            _cached_head = _head.load(std::memory_order_acquire);
+            available = _cached_head - tail;
+        }
+        return available;
+    }
+
+    std::array<T, N> _storage{};
+
+    // Written by the producer, with its copy of the tail.
+    alignas(64) std::atomic<std::size_t> _head{0};
+    std::size_t _cached_tail{0};
+
+    // Written by the consumer, with its copy of the head.
+    alignas(64) std::atomic<std::size_t> _tail{0};
+    std::size_t _cached_head{0};
+};
+
 } // namespace mavsdk
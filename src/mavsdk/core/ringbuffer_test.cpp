@@ -1,4 +1,7 @@
 #include "ringbuffer.h"
+#include <memory>
+#include <thread>
+#include <vector>
 #include <gtest/gtest.h>
 
 using namespace mavsdk;
@@ -82,3 +85,116 @@ TEST(Ringbuffer, PushAndMutate)
         EXPECT_EQ(buf, expected[i++]);
     }
 }
+
+TEST(Ringbuffer, WrapsWithPowerOfTwoSize)
+{
+    auto buffer = Ringbuffer<int, 4>{};
+
+    for (int i = 0; i < 10; ++i) {
+        buffer.push(i);
+    }
+    EXPECT_EQ(buffer.size(), 4);
+
+    std::vector<int> expected{6, 7, 8, 9};
+    unsigned i = 0;
+    for (const auto& buf : buffer) {
+        EXPECT_EQ(buf, expected[i++]);
+    }
+}
+
+TEST(SpscRingbuffer, PushAndPopInOrder)
+{
+    SpscRingbuffer<int, 4> buffer;
+    EXPECT_TRUE(buffer.empty_approx());
+    EXPECT_EQ(buffer.capacity(), 4u);
+
+    EXPECT_TRUE(buffer.try_push(1));
+    EXPECT_TRUE(buffer.try_push(2));
+    EXPECT_EQ(buffer.size_approx(), 2u);
+
+    int value = 0;
+    EXPECT_TRUE(buffer.try_pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(buffer.try_pop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_FALSE(buffer.try_pop(value));
+}
+
+TEST(SpscRingbuffer, RefusesToOverwrite)
+{
+    SpscRingbuffer<int, 2> buffer;
+    EXPECT_TRUE(buffer.try_push(1));
+    EXPECT_TRUE(buffer.try_push(2));
+    EXPECT_FALSE(buffer.try_push(3));
+
+    int value = 0;
+    EXPECT_TRUE(buffer.try_pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(buffer.try_push(3));
+    EXPECT_TRUE(buffer.try_pop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_TRUE(buffer.try_pop(value));
+    EXPECT_EQ(value, 3);
+}
+
+TEST(SpscRingbuffer, PushesAndPopsBatches)
+{
+    SpscRingbuffer<int, 8> buffer;
+
+    const int items[] = {1, 2, 3, 4, 5, 6};
+    EXPECT_EQ(buffer.push(items, 6), 6u);
+    // Only what fits is pushed.
+    EXPECT_EQ(buffer.push(items, 6), 2u);
+
+    int popped[8] = {};
+    EXPECT_EQ(buffer.pop(popped, 5), 5u);
+    EXPECT_EQ(popped[4], 5);
+    EXPECT_EQ(buffer.pop(popped, 8), 3u);
+    EXPECT_EQ(popped[0], 6);
+    EXPECT_EQ(popped[1], 1);
+    EXPECT_EQ(popped[2], 2);
+    EXPECT_TRUE(buffer.empty_approx());
+}
+
+TEST(SpscRingbuffer, DoesntMoveFromWhatDidntFit)
+{
+    SpscRingbuffer<std::unique_ptr<int>, 1> buffer;
+    EXPECT_TRUE(buffer.try_push(std::make_unique<int>(1)));
+
+    auto second = std::make_unique<int>(2);
+    EXPECT_FALSE(buffer.try_push(std::move(second)));
+    ASSERT_NE(second, nullptr);
+
+    std::unique_ptr<int> value;
+    EXPECT_TRUE(buffer.try_pop(value));
+    EXPECT_EQ(*value, 1);
+}
+
+TEST(SpscRingbuffer, HandsOverBetweenThreads)
+{
+    constexpr int count = 100000;
+    SpscRingbuffer<int, 64> buffer;
+
+    std::thread producer([&]() {
+        for (int i = 0; i < count; ++i) {
+            while (!buffer.try_push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    int batch[16];
+    while (expected < count) {
+        const auto popped = buffer.pop(batch, 16);
+        for (std::size_t i = 0; i < popped; ++i) {
+            ASSERT_EQ(batch[i], expected++);
+        }
+        if (popped == 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+    EXPECT_TRUE(buffer.empty_approx());
+}
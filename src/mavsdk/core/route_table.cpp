@@ -0,0 +1,101 @@
+#include "route_table.h"
+
+namespace mavsdk {
+
+namespace {
+
+// Samples of other threads can be a bit older than the window start.
+uint64_t age_ns(uint64_t since_ns, uint64_t now_ns)
+{
+    return now_ns > since_ns ? now_ns - since_ns : 0;
+}
+
+} // namespace
+
+RouteTable::RouteTable(double expiry_s) : _expiry_ns(static_cast<uint64_t>(expiry_s * 1e9)) {}
+
+RouteTable::~RouteTable()
+{
+    for (auto& system : _systems) {
+        delete system.load();
+    }
+}
+
+void RouteTable::learn(
+    uint8_t system_id, uint8_t component_id, int route_index, uint64_t now_ns)
+{
+    const uint64_t bit = route_bit(route_index);
+    if (bit == 0) {
+        return;
+    }
+
+    SystemRoutes* system = _systems[system_id].load(std::memory_order_acquire);
+    if (system == nullptr) {
+        auto* new_system = new SystemRoutes();
+        if (_systems[system_id].compare_exchange_strong(
+                system, new_system, std::memory_order_acq_rel)) {
+            system = new_system;
+        } else {
+            // Another receive thread was faster.
+            delete new_system;
+        }
+    }
+
+    learn(system->system, bit, now_ns);
+    learn(system->components[component_id], bit, now_ns);
+}
+
+uint64_t RouteTable::routes(uint8_t system_id, uint8_t component_id, uint64_t now_ns) const
+{
+    const SystemRoutes* system = _systems[system_id].load(std::memory_order_acquire);
+    if (system == nullptr) {
+        return 0;
+    }
+
+    if (component_id != 0) {
+        const uint64_t component_routes = routes(system->components[component_id], now_ns);
+        if (component_routes != 0) {
+            return component_routes;
+        }
+    }
+    return routes(system->system, now_ns);
+}
+
+void RouteTable::learn(Route& route, uint64_t bit, uint64_t now_ns) const
+{
+    const uint64_t window_start_ns = route.window_start_ns.load(std::memory_order_relaxed);
+    const uint64_t window_age_ns = age_ns(window_start_ns, now_ns);
+
+    if (window_start_ns != 0 && window_age_ns < _expiry_ns) {
+        // The common case: seen a moment ago, maybe already on this connection.
+        if ((route.current.load(std::memory_order_relaxed) & bit) == 0) {
+            route.current.fetch_or(bit, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    // A new window, the connections of the last one only count for another period.
+    const bool last_window_adjacent = window_start_ns != 0 && window_age_ns < 2 * _expiry_ns;
+    route.previous.store(
+        last_window_adjacent ? route.current.load(std::memory_order_relaxed) : 0,
+        std::memory_order_relaxed);
+    route.current.store(bit, std::memory_order_relaxed);
+    route.window_start_ns.store(now_ns, std::memory_order_relaxed);
+}
+
+uint64_t RouteTable::routes(const Route& route, uint64_t now_ns) const
+{
+    const uint64_t window_start_ns = route.window_start_ns.load(std::memory_order_relaxed);
+    const uint64_t window_age_ns = age_ns(window_start_ns, now_ns);
+
+    if (window_start_ns == 0 || window_age_ns >= 2 * _expiry_ns) {
+        return 0;
+    }
+    if (window_age_ns >= _expiry_ns) {
+        return route.current.load(std::memory_order_relaxed);
+    }
+    return route.current.load(std::memory_order_relaxed) |
+           route.previous.load(std::memory_order_relaxed);
+}
+
+} // namespace mavsdk
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace mavsdk {
+
+// Which connections a system/component has been seen on, learned from the
+// messages received.
+//
+// Each connection gets a route index, so the connections of a route are one
+// 64 bit mask and a lookup is a couple of array accesses without any lock.
+// Routes expire: a connection which has not seen a component for between one
+// and two expiry periods is dropped from its route, so a system moving from
+// one link to another is eventually only reached over the new one.
+//
+// Learning and lookups happen concurrently on the receive threads and the
+// senders. Entries are atomics, a race while a route rotates can at worst
+// drop a connection until the next message over it.
+class RouteTable {
+public:
+    static constexpr int MAX_ROUTE_INDICES = 64;
+    static constexpr double DEFAULT_EXPIRY_S = 10.0;
+
+    explicit RouteTable(double expiry_s = DEFAULT_EXPIRY_S);
+    ~RouteTable();
+
+    // Non-copyable
+    RouteTable(const RouteTable&) = delete;
+    const RouteTable& operator=(const RouteTable&) = delete;
+
+    static uint64_t route_bit(int route_index)
+    {
+        return (route_index >= 0 && route_index < MAX_ROUTE_INDICES) ? (1ULL << route_index) : 0;
+    }
+
+    void learn(uint8_t system_id, uint8_t component_id, int route_index, uint64_t now_ns);
+
+    // Connections the component was seen on recently, component ID 0 meaning
+    // any component of the system. If the component was not seen on its own,
+    // the routes of its system are used. 0 if the system is unknown.
+    [[nodiscard]] uint64_t
+    routes(uint8_t system_id, uint8_t component_id, uint64_t now_ns) const;
+
+private:
+    struct Route {
+        std::atomic<uint64_t> current{0};
+        std::atomic<uint64_t> previous{0};
+        std::atomic<uint64_t> window_start_ns{0};
+    };
+
+    struct SystemRoutes {
+        Route system{};
+        std::array<Route, 256> components{};
+    };
+
+    void learn(Route& route, uint64_t bit, uint64_t now_ns) const;
+    uint64_t routes(const Route& route, uint64_t now_ns) const;
+
+    const uint64_t _expiry_ns;
+
+    // Only allocated for systems which were seen.
+    std::array<std::atomic<SystemRoutes*>, 256> _systems{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,79 @@
+#include "route_table.h"
+
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+static constexpr uint64_t s = 1000000000ULL;
+
+TEST(RouteTable, UnknownSystemHasNoRoutes)
+{
+    RouteTable table;
+    EXPECT_EQ(table.routes(1, 1, 1 * s), 0u);
+    EXPECT_EQ(table.routes(1, 0, 1 * s), 0u);
+}
+
+TEST(RouteTable, LearnsComponentAndSystem)
+{
+    RouteTable table;
+    table.learn(1, 1, 0, 1 * s);
+    table.learn(1, 100, 2, 1 * s);
+
+    EXPECT_EQ(table.routes(1, 1, 2 * s), RouteTable::route_bit(0));
+    EXPECT_EQ(table.routes(1, 100, 2 * s), RouteTable::route_bit(2));
+    // Any component of the system.
+    EXPECT_EQ(table.routes(1, 0, 2 * s), RouteTable::route_bit(0) | RouteTable::route_bit(2));
+    // Unseen component falls back to the system.
+    EXPECT_EQ(table.routes(1, 42, 2 * s), RouteTable::route_bit(0) | RouteTable::route_bit(2));
+    EXPECT_EQ(table.routes(2, 1, 2 * s), 0u);
+}
+
+TEST(RouteTable, SeenOnSeveralConnections)
+{
+    RouteTable table;
+    table.learn(1, 1, 0, 1 * s);
+    table.learn(1, 1, 1, 1 * s);
+
+    EXPECT_EQ(table.routes(1, 1, 1 * s), RouteTable::route_bit(0) | RouteTable::route_bit(1));
+}
+
+TEST(RouteTable, RoutesExpire)
+{
+    RouteTable table(10.0);
+    table.learn(1, 1, 0, 1 * s);
+
+    EXPECT_NE(table.routes(1, 1, 15 * s), 0u);
+    EXPECT_EQ(table.routes(1, 1, 25 * s), 0u);
+}
+
+TEST(RouteTable, MovedSystemDropsOldConnection)
+{
+    RouteTable table(10.0);
+    table.learn(1, 1, 0, 1 * s);
+
+    // From now on only seen on connection 1.
+    for (uint64_t t = 2; t < 40; ++t) {
+        table.learn(1, 1, 1, t * s);
+    }
+
+    EXPECT_EQ(table.routes(1, 1, 40 * s), RouteTable::route_bit(1));
+}
+
+TEST(RouteTable, KeepsConnectionsSeenInLastWindow)
+{
+    RouteTable table(10.0);
+    table.learn(1, 1, 0, 1 * s);
+    table.learn(1, 1, 1, 12 * s);
+
+    EXPECT_EQ(table.routes(1, 1, 13 * s), RouteTable::route_bit(0) | RouteTable::route_bit(1));
+}
+
+TEST(RouteTable, IgnoresInvalidRouteIndex)
+{
+    RouteTable table;
+    table.learn(1, 1, -1, 1 * s);
+    table.learn(1, 1, RouteTable::MAX_ROUTE_INDICES, 1 * s);
+
+    EXPECT_EQ(table.routes(1, 1, 1 * s), 0u);
+    EXPECT_EQ(RouteTable::route_bit(63), 1ULL << 63);
+}
@@ -0,0 +1,65 @@
+#include "rtt_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace mavsdk {
+
+void RttEstimator::add_sample(double rtt_s)
+{
+    if (!std::isfinite(rtt_s) || rtt_s < 0.0) {
+        return;
+    }
+
+    // A single absurd sample (e.g. a command which took long to execute)
+    // should not be able to push the timeout beyond the maximum on its own.
+    rtt_s = std::min(rtt_s, MAX_RTO_S);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_has_samples) {
+        _srtt_s = rtt_s;
+        _rttvar_s = rtt_s / 2.0;
+        _has_samples = true;
+        return;
+    }
+
+    _rttvar_s = (1.0 - BETA) * _rttvar_s + BETA * std::abs(_srtt_s - rtt_s);
+    _srtt_s = (1.0 - ALPHA) * _srtt_s + ALPHA * rtt_s;
+}
+
+double RttEstimator::rto_s(double fallback_s) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_has_samples) {
+        return fallback_s;
+    }
+
+    const double rto_s = _srtt_s + std::max(GRANULARITY_S, K * _rttvar_s);
+    return std::clamp(rto_s, MIN_RTO_S, MAX_RTO_S);
+}
+
+bool RttEstimator::has_samples() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _has_samples;
+}
+
+double RttEstimator::smoothed_rtt_s() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _srtt_s;
+}
+
+double RttEstimator::backoff_s(double rto_s, int retransmission)
+{
+    thread_local std::minstd_rand generator{std::random_device{}()};
+    std::uniform_real_distribution<double> jitter(1.0, 1.1);
+
+    const double backed_off_s = rto_s * std::pow(2.0, std::max(0, retransmission));
+    return std::min(backed_off_s, MAX_RTO_S) * jitter(generator);
+}
+
+} // namespace mavsdk
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <mutex>
+
+namespace mavsdk {
+
+// Round trip time estimate of a system, used as retransmission timeout of
+// the request/response protocols (commands, params, missions).
+//
+// This follows Jacobson/Karels as used by TCP (RFC 6298): the timeout is the
+// smoothed RTT plus four times its mean deviation, so a jittery link gets
+// more slack than a steady one with the same average.
+class RttEstimator {
+public:
+    RttEstimator() = default;
+    ~RttEstimator() = default;
+
+    // Non-copyable
+    RttEstimator(const RttEstimator&) = delete;
+    const RttEstimator& operator=(const RttEstimator&) = delete;
+
+    // Samples of retransmitted requests must not be added, as it is unclear
+    // which transmission the response belongs to (Karn's algorithm).
+    void add_sample(double rtt_s);
+
+    // The fallback is used until there is a first sample.
+    [[nodiscard]] double rto_s(double fallback_s) const;
+
+    [[nodiscard]] bool has_samples() const;
+    [[nodiscard]] double smoothed_rtt_s() const;
+
+    // Timeout for the given retransmission (0 being the first send): doubled
+    // with every retransmission and spread by up to 10% so that requests
+    // which timed out together don't all retransmit together.
+    static double backoff_s(double rto_s, int retransmission);
+
+    static constexpr double MIN_RTO_S = 0.05;
+    static constexpr double MAX_RTO_S = 10.0;
+
+private:
+    static constexpr double ALPHA = 1.0 / 8.0;
+    static constexpr double BETA = 1.0 / 4.0;
+    static constexpr double K = 4.0;
+    // Lower bound for the deviation term, roughly the timer resolution.
+    static constexpr double GRANULARITY_S = 0.01;
+
+    mutable std::mutex _mutex{};
+    bool _has_samples{false};
+    double _srtt_s{0.0};
+    double _rttvar_s{0.0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,85 @@
+#include "rtt_estimator.h"
+
+#include <cmath>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(RttEstimator, UsesFallbackWithoutSamples)
+{
+    RttEstimator estimator;
+    EXPECT_FALSE(estimator.has_samples());
+    EXPECT_DOUBLE_EQ(estimator.rto_s(0.5), 0.5);
+}
+
+TEST(RttEstimator, FirstSample)
+{
+    RttEstimator estimator;
+    estimator.add_sample(0.2);
+
+    EXPECT_TRUE(estimator.has_samples());
+    EXPECT_DOUBLE_EQ(estimator.smoothed_rtt_s(), 0.2);
+    // srtt + 4 * rtt / 2
+    EXPECT_DOUBLE_EQ(estimator.rto_s(0.5), 0.6);
+}
+
+TEST(RttEstimator, FollowsSlowLink)
+{
+    RttEstimator estimator;
+    for (int i = 0; i < 100; ++i) {
+        estimator.add_sample(0.6);
+    }
+
+    EXPECT_NEAR(estimator.smoothed_rtt_s(), 0.6, 1e-6);
+    EXPECT_GT(estimator.rto_s(0.5), 0.6);
+    EXPECT_LT(estimator.rto_s(0.5), 0.7);
+}
+
+TEST(RttEstimator, FastLinkIsClampedToMinimum)
+{
+    RttEstimator estimator;
+    for (int i = 0; i < 100; ++i) {
+        estimator.add_sample(0.002);
+    }
+
+    EXPECT_DOUBLE_EQ(estimator.rto_s(0.5), RttEstimator::MIN_RTO_S);
+}
+
+TEST(RttEstimator, JitterRaisesTimeout)
+{
+    RttEstimator steady;
+    RttEstimator jittery;
+    for (int i = 0; i < 100; ++i) {
+        steady.add_sample(0.2);
+        jittery.add_sample(i % 2 == 0 ? 0.1 : 0.3);
+    }
+
+    EXPECT_NEAR(jittery.smoothed_rtt_s(), 0.2, 0.02);
+    EXPECT_GT(jittery.rto_s(0.5), steady.rto_s(0.5) + 0.2);
+}
+
+TEST(RttEstimator, IgnoresInvalidSamples)
+{
+    RttEstimator estimator;
+    estimator.add_sample(-1.0);
+    estimator.add_sample(std::nan(""));
+    EXPECT_FALSE(estimator.has_samples());
+
+    estimator.add_sample(1000.0);
+    EXPECT_DOUBLE_EQ(estimator.rto_s(0.5), RttEstimator::MAX_RTO_S);
+}
+
+TEST(RttEstimator, BacksOffExponentiallyWithJitter)
+{
+    for (int i = 0; i < 20; ++i) {
+        const double first = RttEstimator::backoff_s(0.1, 0);
+        EXPECT_GE(first, 0.1);
+        EXPECT_LE(first, 0.11);
+
+        const double third = RttEstimator::backoff_s(0.1, 2);
+        EXPECT_GE(third, 0.4);
+        EXPECT_LE(third, 0.44);
+
+        EXPECT_LE(RttEstimator::backoff_s(1.0, 10), RttEstimator::MAX_RTO_S * 1.1);
+    }
+}
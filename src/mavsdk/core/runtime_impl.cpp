@@ -0,0 +1,143 @@
+#include "runtime_impl.h"
+
+#include <algorithm>
+
+#ifdef MAVSDK_WITH_HTTP
+#include "http_loader.h"
+#endif
+
+namespace mavsdk {
+
+RuntimeImpl::RuntimeImpl(
+    const Mavsdk::Configuration& configuration,
+    std::size_t num_work_threads,
+    std::size_t num_background_threads) :
+    _callback_executor(
+        std::max(1u, configuration.get_callback_threads()),
+        ThreadSetup::for_role(configuration, Mavsdk::Configuration::ThreadRole::Callback, "cb")),
+    _work_pool(
+        num_work_threads,
+        ThreadSetup::for_role(configuration, Mavsdk::Configuration::ThreadRole::Worker, "work")),
+    _background_pool(
+        num_background_threads,
+        ThreadSetup::for_role(configuration, Mavsdk::Configuration::ThreadRole::Worker, "bg"))
+{
+    auto timer_thread_setup =
+        ThreadSetup::for_role(configuration, Mavsdk::Configuration::ThreadRole::Timer, "timer");
+    const auto stack_size_bytes = timer_thread_setup.settings.stack_size_bytes;
+    _timer_thread = NativeThread(
+        stack_size_bytes,
+        [this, setup = std::move(timer_thread_setup)]() { timer_thread(setup); });
+}
+
+RuntimeImpl::~RuntimeImpl()
+{
+    {
+        std::lock_guard<std::mutex> lock(_timer_mutex);
+        _should_exit = true;
+    }
+    _timer_cv.notify_all();
+    _timer_thread.join();
+}
+
+uint64_t RuntimeImpl::add_timer_work(TimerWork work)
+{
+    auto entry = std::make_shared<TimerEntry>();
+    entry->work = std::move(work);
+
+    {
+        std::lock_guard<std::mutex> lock(_timer_mutex);
+        entry->handle = _next_timer_handle++;
+        _timer_entries.push_back(entry);
+        _timer_woken = true;
+    }
+    _timer_cv.notify_one();
+    return entry->handle;
+}
+
+void RuntimeImpl::remove_timer_work(uint64_t handle)
+{
+    std::unique_lock<std::mutex> lock(_timer_mutex);
+    const auto it =
+        std::find_if(_timer_entries.begin(), _timer_entries.end(), [&](const auto& entry) {
+            return entry->handle == handle;
+        });
+    if (it == _timer_entries.end()) {
+        return;
+    }
+
+    auto entry = *it;
+    entry->removed = true;
+    _timer_entries.erase(it);
+
+    if (std::this_thread::get_id() != _timer_thread.get_id()) {
+        _timer_idle_cv.wait(lock, [&]() { return !entry->running; });
+    }
+}
+
+void RuntimeImpl::wake_timer()
+{
+    {
+        std::lock_guard<std::mutex> lock(_timer_mutex);
+        _timer_woken = true;
+    }
+    _timer_cv.notify_one();
+}
+
+void RuntimeImpl::timer_thread(const ThreadSetup& thread_setup)
+{
+    thread_setup.apply();
+
+    std::vector<std::shared_ptr<TimerEntry>> entries;
+
+    std::unique_lock<std::mutex> lock(_timer_mutex);
+    while (!_should_exit) {
+        // Anything scheduled from now on wakes us up again.
+        _timer_woken = false;
+        entries = _timer_entries;
+
+        std::optional<dl_time_t> deadline;
+        for (const auto& entry : entries) {
+            if (entry->removed) {
+                continue;
+            }
+            entry->running = true;
+            lock.unlock();
+
+            const auto next = entry->work();
+
+            lock.lock();
+            entry->running = false;
+            _timer_idle_cv.notify_all();
+
+            if (next && (!deadline || next.value() < deadline.value())) {
+                deadline = next;
+            }
+        }
+        entries.clear();
+
+        if (_timer_woken) {
+            continue;
+        }
+
+        const auto woken = [this]() { return _timer_woken || _should_exit; };
+        if (deadline) {
+            _timer_cv.wait_until(lock, deadline.value(), woken);
+        } else {
+            _timer_cv.wait(lock, woken);
+        }
+    }
+}
+
+#ifdef MAVSDK_WITH_HTTP
+HttpLoader& RuntimeImpl::http_loader()
+{
+    std::lock_guard<std::mutex> lock(_http_loader_mutex);
+    if (_http_loader == nullptr) {
+        _http_loader = std::make_shared<HttpLoader>();
+    }
+    return *_http_loader;
+}
+#endif
+
+} // namespace mavsdk
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "callback_executor.h"
+#include "mavsdk.h"
+#include "mavsdk_time.h"
+#include "native_thread.h"
+#include "thread_pool.h"
+
+namespace mavsdk {
+
+class HttpLoader;
+
+// The threads of a Mavsdk::Runtime, used by several MavsdkImpl instances
+// instead of starting their own: one timer thread running the timeouts and
+// periodic calls of all of them, the callback threads, the workers for the
+// systems' queues and for background work, and the HTTP loader. The
+// IoReactor serving the connections is shared by all instances of the
+// process anyway.
+class RuntimeImpl {
+public:
+    RuntimeImpl(
+        const Mavsdk::Configuration& configuration,
+        std::size_t num_work_threads,
+        std::size_t num_background_threads = 1);
+    ~RuntimeImpl();
+
+    // Runs what is due for one instance and returns when it is due next,
+    // nothing if there is nothing scheduled.
+    using TimerWork = std::function<std::optional<dl_time_t>()>;
+
+    uint64_t add_timer_work(TimerWork work);
+
+    // Once this returns the work is not run anymore. If it is running, it is
+    // waited for, unless this is called from the timer thread.
+    void remove_timer_work(uint64_t handle);
+
+    // For when something was scheduled that might be due earlier.
+    void wake_timer();
+
+    CallbackExecutor& callback_executor() { return _callback_executor; }
+
+    ThreadPool& work_pool() { return _work_pool; }
+
+    ThreadPool& background_pool() { return _background_pool; }
+
+#ifdef MAVSDK_WITH_HTTP
+    HttpLoader& http_loader();
+#endif
+
+    // Non-copyable
+    RuntimeImpl(const RuntimeImpl&) = delete;
+    const RuntimeImpl& operator=(const RuntimeImpl&) = delete;
+
+private:
+    struct TimerEntry {
+        uint64_t handle{0};
+        TimerWork work{};
+        bool running{false};
+        bool removed{false};
+    };
+
+    void timer_thread(const ThreadSetup& thread_setup);
+
+    std::mutex _timer_mutex{};
+    std::condition_variable _timer_cv{};
+    std::condition_variable _timer_idle_cv{};
+    std::vector<std::shared_ptr<TimerEntry>> _timer_entries{};
+    uint64_t _next_timer_handle{1};
+    bool _timer_woken{false};
+    bool _should_exit{false};
+
+    CallbackExecutor _callback_executor;
+    ThreadPool _work_pool;
+    ThreadPool _background_pool;
+
+    std::mutex _http_loader_mutex{};
+    std::shared_ptr<HttpLoader> _http_loader{};
+
+    NativeThread _timer_thread{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,87 @@
+#include "runtime_impl.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+Mavsdk::Configuration configuration()
+{
+    return Mavsdk::Configuration{Mavsdk::Configuration::UsageType::GroundStation};
+}
+
+} // namespace
+
+TEST(RuntimeImpl, TimerWorkOfSeveralInstancesSharesOneThread)
+{
+    RuntimeImpl runtime{configuration(), 1};
+
+    std::atomic<int> first_runs{0};
+    std::atomic<int> second_runs{0};
+    std::promise<std::thread::id> first_thread;
+    std::promise<std::thread::id> second_thread;
+
+    const auto first = runtime.add_timer_work([&]() -> std::optional<dl_time_t> {
+        if (first_runs++ == 0) {
+            first_thread.set_value(std::this_thread::get_id());
+        }
+        return std::chrono::steady_clock::now() + std::chrono::milliseconds(5);
+    });
+    const auto second = runtime.add_timer_work([&]() -> std::optional<dl_time_t> {
+        if (second_runs++ == 0) {
+            second_thread.set_value(std::this_thread::get_id());
+        }
+        return std::chrono::steady_clock::now() + std::chrono::milliseconds(5);
+    });
+
+    EXPECT_EQ(first_thread.get_future().get(), second_thread.get_future().get());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    runtime.remove_timer_work(first);
+    runtime.remove_timer_work(second);
+
+    // Both are due every 5 ms, so they need to have run a few times.
+    EXPECT_GT(first_runs, 3);
+    EXPECT_GT(second_runs, 3);
+
+    const int first_runs_after_remove = first_runs;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(first_runs, first_runs_after_remove);
+}
+
+TEST(RuntimeImpl, WakeRunsWorkWithoutDeadline)
+{
+    RuntimeImpl runtime{configuration(), 1};
+
+    std::atomic<int> runs{0};
+    const auto handle = runtime.add_timer_work([&]() -> std::optional<dl_time_t> {
+        ++runs;
+        return {};
+    });
+
+    // Nothing is scheduled, so it only runs when added and when woken up.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const int runs_before_wake = runs;
+    EXPECT_GE(runs_before_wake, 1);
+
+    runtime.wake_timer();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(runs, runs_before_wake + 1);
+
+    runtime.remove_timer_work(handle);
+}
+
+TEST(RuntimeImpl, SharesWorkPool)
+{
+    RuntimeImpl runtime{configuration(), 2};
+    EXPECT_EQ(runtime.work_pool().num_threads(), 2);
+
+    std::promise<void> done;
+    runtime.work_pool().post([&]() { done.set_value(); });
+    EXPECT_EQ(done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+}
@@ -0,0 +1,128 @@
+#include "send_queue.h"
+
+#include <utility>
+
+namespace mavsdk {
+
+SendQueue::SendQueue(
+    WriteFunction write_function,
+    std::size_t capacity_bytes,
+    CongestionCallback congestion_callback,
+    ThreadSetup thread_setup) :
+    _write_function(std::move(write_function)),
+    _capacity_bytes(capacity_bytes),
+    _congestion_callback(std::move(congestion_callback)),
+    _thread_setup(std::move(thread_setup))
+{
+    _buffer.reserve(_capacity_bytes);
+    _thread = std::make_unique<NativeThread>(
+        _thread_setup.settings.stack_size_bytes, [this]() { run(); });
+}
+
+SendQueue::~SendQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_exit = true;
+    }
+    _cv.notify_all();
+    _thread->join();
+}
+
+SendQueue::Result SendQueue::push(const uint8_t* data, std::size_t length)
+{
+    Result result = Result::Queued;
+    bool changed;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const bool was_congested = _congested;
+        if (_buffer.size() + _writing_bytes + length > _capacity_bytes) {
+            _would_block_count.fetch_add(1, std::memory_order_relaxed);
+            // Full is congested no matter where the watermarks are.
+            _congested = true;
+            result = Result::WouldBlock;
+        } else {
+            const bool was_empty = _buffer.empty();
+            _buffer.insert(_buffer.end(), data, data + length);
+            update_congestion_locked();
+            if (was_empty) {
+                _cv.notify_one();
+            }
+        }
+        changed = was_congested != _congested;
+    }
+
+    if (changed) {
+        report_congestion();
+    }
+    return result;
+}
+
+std::size_t SendQueue::queued_bytes() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _buffer.size() + _writing_bytes;
+}
+
+void SendQueue::update_congestion_locked()
+{
+    const std::size_t queued = _buffer.size() + _writing_bytes;
+    if (!_congested && queued * 4 >= _capacity_bytes * 3) {
+        _congested = true;
+    } else if (_congested && queued * 4 <= _capacity_bytes) {
+        _congested = false;
+    }
+}
+
+void SendQueue::report_congestion()
+{
+    if (!_congestion_callback) {
+        return;
+    }
+
+    // The state might have changed back in the meantime, whoever gets here
+    // last reports what is current.
+    std::lock_guard<std::mutex> report_lock(_report_mutex);
+    const bool congested = _congested;
+    if (congested == _reported_congested) {
+        return;
+    }
+    _reported_congested = congested;
+    _congestion_callback(congested, queued_bytes());
+}
+
+void SendQueue::run()
+{
+    _thread_setup.apply();
+
+    std::vector<uint8_t> writing;
+    writing.reserve(_capacity_bytes);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _cv.wait(lock, [this]() { return _should_exit || !_buffer.empty(); });
+        if (_buffer.empty()) {
+            // Only once everything queued was written.
+            break;
+        }
+
+        writing.swap(_buffer);
+        _writing_bytes = writing.size();
+        lock.unlock();
+
+        _write_function(writing.data(), writing.size());
+        writing.clear();
+
+        lock.lock();
+        _writing_bytes = 0;
+        const bool was_congested = _congested;
+        update_congestion_locked();
+        if (was_congested != _congested) {
+            lock.unlock();
+            report_congestion();
+            lock.lock();
+        }
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "native_thread.h"
+#include "thread_setup.h"
+
+namespace mavsdk {
+
+// Decouples whoever sends from a stream which can block, such as a serial
+// port or a TCP socket under saturation. Data is queued and written by a
+// thread of its own, everything queued at that point goes out with one write.
+//
+// The queue is bounded: data which doesn't fit is refused rather than
+// blocking the caller, so high-rate producers can drop or degrade instead.
+// The queue counts as congested from when it is 3/4 full until it drained
+// to 1/4, so the state doesn't flap with every write.
+class SendQueue {
+public:
+    // Needs to write all of the data, returns false on failure.
+    using WriteFunction = std::function<bool(const uint8_t* data, std::size_t length)>;
+
+    // Called on the thread which caused the change, needs to return quickly.
+    using CongestionCallback = std::function<void(bool congested, std::size_t queued_bytes)>;
+
+    enum class Result { Queued, WouldBlock };
+
+    SendQueue(
+        WriteFunction write_function,
+        std::size_t capacity_bytes,
+        CongestionCallback congestion_callback = nullptr,
+        ThreadSetup thread_setup = {});
+
+    // Writes what is still queued.
+    ~SendQueue();
+
+    // Non-copyable
+    SendQueue(const SendQueue&) = delete;
+    const SendQueue& operator=(const SendQueue&) = delete;
+
+    Result push(const uint8_t* data, std::size_t length);
+
+    // Including what is being written at the moment.
+    [[nodiscard]] std::size_t queued_bytes() const;
+
+    [[nodiscard]] std::size_t capacity_bytes() const { return _capacity_bytes; }
+
+    [[nodiscard]] bool congested() const { return _congested; }
+
+    // Number of pushes refused as the queue was full.
+    [[nodiscard]] uint64_t would_block_count() const { return _would_block_count; }
+
+private:
+    void run();
+    void update_congestion_locked();
+    void report_congestion();
+
+    WriteFunction _write_function;
+    const std::size_t _capacity_bytes;
+    CongestionCallback _congestion_callback;
+    const ThreadSetup _thread_setup;
+
+    mutable std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::vector<uint8_t> _buffer{};
+    std::size_t _writing_bytes{0};
+    bool _should_exit{false};
+
+    std::atomic<bool> _congested{false};
+    std::atomic<uint64_t> _would_block_count{0};
+
+    // Reports are made one at a time, and only for actual changes.
+    std::mutex _report_mutex{};
+    bool _reported_congested{false};
+
+    std::unique_ptr<NativeThread> _thread{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,115 @@
+#include "send_queue.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+
+using namespace mavsdk;
+
+namespace {
+
+bool wait_for(const std::function<bool()>& condition)
+{
+    for (int i = 0; i < 100; ++i) {
+        if (condition()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(SendQueue, WritesInOrder)
+{
+    std::mutex mutex;
+    std::vector<uint8_t> written;
+
+    {
+        SendQueue queue(
+            [&](const uint8_t* data, std::size_t length) {
+                std::lock_guard<std::mutex> lock(mutex);
+                written.insert(written.end(), data, data + length);
+                return true;
+            },
+            1024);
+
+        for (uint8_t i = 0; i < 10; ++i) {
+            const uint8_t data[2] = {i, i};
+            EXPECT_EQ(queue.push(data, sizeof(data)), SendQueue::Result::Queued);
+        }
+    }
+
+    // Everything queued is written by the time the queue is gone.
+    ASSERT_EQ(written.size(), 20);
+    for (std::size_t i = 0; i < written.size(); ++i) {
+        EXPECT_EQ(written[i], i / 2);
+    }
+}
+
+TEST(SendQueue, FullQueueWouldBlock)
+{
+    std::promise<void> unblock;
+    auto unblocked = unblock.get_future().share();
+    std::atomic<std::size_t> written{0};
+
+    SendQueue queue(
+        [&](const uint8_t*, std::size_t length) {
+            unblocked.wait();
+            written += length;
+            return true;
+        },
+        100);
+
+    const uint8_t data[40]{};
+    // The first is being written, the next two wait, which fills the queue.
+    EXPECT_EQ(queue.push(data, sizeof(data)), SendQueue::Result::Queued);
+    ASSERT_TRUE(wait_for([&]() { return queue.queued_bytes() == 40; }));
+    EXPECT_EQ(queue.push(data, 30), SendQueue::Result::Queued);
+    EXPECT_EQ(queue.push(data, 30), SendQueue::Result::Queued);
+    EXPECT_EQ(queue.push(data, 1), SendQueue::Result::WouldBlock);
+    EXPECT_EQ(queue.queued_bytes(), 100);
+    EXPECT_EQ(queue.would_block_count(), 1);
+
+    unblock.set_value();
+    EXPECT_TRUE(wait_for([&]() { return written == 100; }));
+    EXPECT_EQ(queue.queued_bytes(), 0);
+}
+
+TEST(SendQueue, ReportsCongestionWithHysteresis)
+{
+    std::promise<void> unblock;
+    auto unblocked = unblock.get_future().share();
+
+    std::mutex mutex;
+    std::vector<bool> reports;
+
+    SendQueue queue(
+        [&](const uint8_t*, std::size_t) {
+            unblocked.wait();
+            return true;
+        },
+        100,
+        [&](bool congested, std::size_t) {
+            std::lock_guard<std::mutex> lock(mutex);
+            reports.push_back(congested);
+        });
+
+    const uint8_t data[10]{};
+    for (int i = 0; i < 7; ++i) {
+        queue.push(data, sizeof(data));
+    }
+    EXPECT_FALSE(queue.congested());
+
+    // 80 of 100 is past 3/4.
+    queue.push(data, sizeof(data));
+    EXPECT_TRUE(queue.congested());
+
+    unblock.set_value();
+    EXPECT_TRUE(wait_for([&]() { return !queue.congested(); }));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(reports, (std::vector<bool>{true, false}));
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+namespace mavsdk {
+
+// Sequence lock holding a single value of a trivially copyable type.
+//
+// Readers never take a lock: they copy the value and retry if a writer was
+// active in the meantime, which is detected by the sequence count being odd
+// or having changed. Writers are serialized by a mutex, so they never hold
+// up readers for longer than the copy itself.
+//
+// The value is stored as an array of atomic words, so a reader racing with a
+// writer never performs a data race, it only ends up discarding its copy.
+template<typename T> class Seqlock {
+    static_assert(std::is_trivially_copyable_v<T>, "Seqlock requires a trivially copyable type");
+
+public:
+    Seqlock() : Seqlock(T{}) {}
+
+    explicit Seqlock(const T& value) { write_words(value); }
+
+    ~Seqlock() = default;
+
+    // Non-copyable
+    Seqlock(const Seqlock&) = delete;
+    const Seqlock& operator=(const Seqlock&) = delete;
+
+    [[nodiscard]] T load() const
+    {
+        std::array<uint64_t, NUM_WORDS> words;
+        while (true) {
+            const uint64_t sequence = _sequence.load(std::memory_order_acquire);
+            if ((sequence & 1) != 0) {
+                // A write is in progress.
+                std::this_thread::yield();
+                continue;
+            }
+            for (std::size_t i = 0; i < NUM_WORDS; ++i) {
+                words[i] = _words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_sequence.load(std::memory_order_relaxed) == sequence) {
+                break;
+            }
+        }
+        return from_words(words);
+    }
+
+    void store(const T& value)
+    {
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        store_locked(value);
+    }
+
+    // Read-modify-write, the function is called with a reference to a copy
+    // of the current value which is then stored. Other writers are held off
+    // until it is done.
+    template<typename F> void update(F&& func)
+    {
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        std::array<uint64_t, NUM_WORDS> words;
+        for (std::size_t i = 0; i < NUM_WORDS; ++i) {
+            words[i] = _words[i].load(std::memory_order_relaxed);
+        }
+        T value = from_words(words);
+        func(value);
+        store_locked(value);
+    }
+
+private:
+    static constexpr std::size_t NUM_WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    static T from_words(const std::array<uint64_t, NUM_WORDS>& words)
+    {
+        T value;
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+    void store_locked(const T& value)
+    {
+        const uint64_t sequence = _sequence.load(std::memory_order_relaxed);
+        _sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        write_words(value);
+        _sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    void write_words(const T& value)
+    {
+        std::array<uint64_t, NUM_WORDS> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+        for (std::size_t i = 0; i < NUM_WORDS; ++i) {
+            _words[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    std::atomic<uint64_t> _sequence{0};
+    std::array<std::atomic<uint64_t>, NUM_WORDS> _words{};
+    std::mutex _write_mutex{};
+};
+
+} // namespace mavsdk
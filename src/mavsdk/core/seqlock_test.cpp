@@ -0,0 +1,101 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "seqlock.h"
+
+using namespace mavsdk;
+
+namespace {
+
+struct Sample {
+    uint32_t a{0};
+    uint32_t b{0};
+    double c{0.0};
+    uint8_t d{0};
+};
+
+} // namespace
+
+TEST(Seqlock, DefaultConstructed)
+{
+    Seqlock<Sample> seqlock;
+
+    const auto sample = seqlock.load();
+    EXPECT_EQ(sample.a, 0u);
+    EXPECT_EQ(sample.b, 0u);
+    EXPECT_EQ(sample.c, 0.0);
+    EXPECT_EQ(sample.d, 0u);
+}
+
+TEST(Seqlock, StoreAndLoad)
+{
+    Seqlock<Sample> seqlock;
+
+    seqlock.store(Sample{1, 2, 3.0, 4});
+
+    const auto sample = seqlock.load();
+    EXPECT_EQ(sample.a, 1u);
+    EXPECT_EQ(sample.b, 2u);
+    EXPECT_EQ(sample.c, 3.0);
+    EXPECT_EQ(sample.d, 4u);
+}
+
+TEST(Seqlock, Update)
+{
+    Seqlock<Sample> seqlock(Sample{1, 2, 3.0, 4});
+
+    seqlock.update([](Sample& sample) { sample.b = 42; });
+
+    const auto sample = seqlock.load();
+    EXPECT_EQ(sample.a, 1u);
+    EXPECT_EQ(sample.b, 42u);
+    EXPECT_EQ(sample.c, 3.0);
+    EXPECT_EQ(sample.d, 4u);
+}
+
+TEST(Seqlock, ReadersNeverSeeTornValues)
+{
+    Seqlock<Sample> seqlock;
+    std::atomic<bool> done{false};
+    std::atomic<unsigned> torn{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; ++i) {
+        readers.emplace_back([&]() {
+            while (!done) {
+                const auto sample = seqlock.load();
+                if (sample.a != sample.b || static_cast<double>(sample.a) != sample.c ||
+                    static_cast<uint8_t>(sample.a) != sample.d) {
+                    ++torn;
+                }
+            }
+        });
+    }
+
+    std::thread updater([&]() {
+        for (uint32_t i = 0; i < 20000; ++i) {
+            seqlock.update([](Sample& sample) {
+                const uint32_t next = sample.a + 1;
+                sample = Sample{next, next, static_cast<double>(next), static_cast<uint8_t>(next)};
+            });
+        }
+    });
+
+    for (uint32_t i = 0; i < 20000; ++i) {
+        seqlock.update([](Sample& sample) {
+            const uint32_t next = sample.a + 1;
+            sample = Sample{next, next, static_cast<double>(next), static_cast<uint8_t>(next)};
+        });
+    }
+
+    updater.join();
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(torn, 0u);
+    EXPECT_EQ(seqlock.load().a, 40000u);
+}
@@ -1,5 +1,10 @@
 #include "serial_connection.h"
+#include "io_reactor.h"
 #include "log.h"
+#include "unused.h"
+
+#include <algorithm>
+#include <chrono>
 
 #if defined(APPLE) || defined(LINUX)
 #include <unistd.h>
@@ -10,6 +15,14 @@
 #include <utility>
 #endif
 
+#if defined(LINUX)
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#endif
+
 namespace mavsdk {
 
 #ifndef WINDOWS
@@ -74,7 +87,28 @@ ConnectionResult SerialConnection::start()
         return ret;
     }
 
-    start_recv_thread();
+    _read_buffer.resize(read_buffer_size_for_baudrate(_baudrate));
+
+    _write_combiner = std::make_unique<WriteCombiner>(
+        [this](const uint8_t* data, std::size_t length) { return write_bytes(data, length); },
+        _write_coalescing_delay_s,
+        WriteCombiner::DEFAULT_FLUSH_BYTES,
+        _thread_setup);
+
+    start_receiving();
+
+    // Scheduled sends never block the caller anyway.
+    if (!_send_scheduling) {
+        start_send_queue(
+            [this](const uint8_t* data, std::size_t length) { return write_bytes(data, length); });
+    }
+
+    if (_send_scheduling) {
+        _tx_scheduler =
+            std::make_unique<TxScheduler>(TxScheduler::bytes_per_s_for_baudrate(_baudrate));
+        _send_thread = std::make_unique<NativeThread>(
+            _thread_setup.settings.stack_size_bytes, [this]() { send_scheduled(); });
+    }
 
     return ConnectionResult::Success;
 }
@@ -88,8 +122,8 @@ ConnectionResult SerialConnection::setup_port()
         LogErr() << "open failed: " << GET_ERROR();
         return ConnectionResult::ConnectionError;
     }
-    // We need to clear the O_NONBLOCK again because we can block while reading
-    // as we do it in a separate thread.
+    // We need to clear the O_NONBLOCK again because writes are expected to
+    // block. Reads only happen once data is available.
     if (fcntl(_fd, F_SETFL, 0) == -1) {
         LogErr() << "fcntl failed: " << GET_ERROR();
         return ConnectionResult::ConnectionError;
@@ -132,7 +166,8 @@ ConnectionResult SerialConnection::setup_port()
     tc.c_cflag |= CS8;
 
     tc.c_cc[VMIN] = 0; // We are ok with 0 bytes.
-    tc.c_cc[VTIME] = 10; // Timeout after 1 second.
+    // Timeout after 1 second, or with low latency return whatever is there.
+    tc.c_cc[VTIME] = _low_latency ? 0 : 10;
 
     if (_flow_control) {
         tc.c_cflag |= CRTSCTS;
@@ -171,6 +206,12 @@ ConnectionResult SerialConnection::setup_port()
     }
 #endif
 
+#if defined(LINUX)
+    if (_low_latency) {
+        apply_low_latency();
+    }
+#endif
+
 #if defined(WINDOWS)
     DCB dcb;
     SecureZeroMemory(&dcb, sizeof(DCB));
@@ -222,19 +263,120 @@ ConnectionResult SerialConnection::setup_port()
     return ConnectionResult::Success;
 }
 
-void SerialConnection::start_recv_thread()
+#if defined(LINUX)
+void SerialConnection::apply_low_latency()
+{
+    // Without the flag, the tty layer hands on received bytes from a work
+    // queue, which can add milliseconds.
+    struct serial_struct serial {};
+    if (ioctl(_fd, TIOCGSERIAL, &serial) == 0) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        if (ioctl(_fd, TIOCSSERIAL, &serial) != 0) {
+            LogWarn() << "Could not set low latency flag: " << GET_ERROR();
+        }
+    } else {
+        LogWarn() << "Could not get serial info for low latency: " << GET_ERROR();
+    }
+
+    // FTDI adapters only send what they received once 62 bytes are there or
+    // their latency timer ran out, which is 16 ms by default.
+    char resolved[PATH_MAX];
+    if (realpath(_serial_node.c_str(), resolved) == nullptr) {
+        return;
+    }
+    const std::string device(resolved);
+    const std::string name = device.substr(device.find_last_of('/') + 1);
+    const std::string latency_timer_path =
+        "/sys/bus/usb-serial/devices/" + name + "/latency_timer";
+
+    if (access(latency_timer_path.c_str(), F_OK) != 0) {
+        // Not an adapter with a latency timer.
+        return;
+    }
+
+    std::ofstream latency_timer(latency_timer_path);
+    latency_timer << "1";
+    latency_timer.close();
+    if (!latency_timer) {
+        LogWarn() << "Could not set latency timer, write 1 to " << latency_timer_path
+                  << " for low latency";
+    }
+}
+#endif
+
+std::size_t SerialConnection::read_buffer_size_for_baudrate(int baudrate)
 {
-    _recv_thread = std::make_unique<std::thread>(&SerialConnection::receive, this);
+    // 10 bits per byte with start and stop bit.
+    const auto bytes_in_10ms = static_cast<std::size_t>(std::max(baudrate, 0)) / 10 / 100;
+    return std::clamp<std::size_t>(bytes_in_10ms, 2048, 64 * 1024);
+}
+
+void SerialConnection::start_receiving()
+{
+#if defined(LINUX)
+    _reactor_handle = IoReactor::instance().add_fd(
+        _fd, IoReactor::Readable, [this](unsigned) { receive_available(); });
+#else
+#if defined(APPLE)
+    if (pipe(_wakeup_pipe) != 0) {
+        LogErr() << "pipe failed: " << GET_ERROR();
+    }
+#endif
+    _recv_thread = std::make_unique<NativeThread>(
+        _thread_setup.settings.stack_size_bytes, [this]() { receive(); });
+#endif
 }
 
 ConnectionResult SerialConnection::stop()
 {
+    stop_link_emulation();
+
     _should_exit = true;
 
+    if (_send_thread) {
+        {
+            // Taking the lock makes sure the send thread is either waiting
+            // or sees _should_exit before it would wait.
+            std::lock_guard<std::mutex> lock(_send_mutex);
+        }
+        _send_cv.notify_all();
+        _send_thread->join();
+        _send_thread.reset();
+    }
+
+#if defined(LINUX)
+    if (_reactor_handle != 0) {
+        IoReactor::instance().remove(_reactor_handle);
+        _reactor_handle = 0;
+    }
+#else
     if (_recv_thread) {
+        // Wakes up the receive thread instead of waiting for its next timeout.
+#if defined(APPLE)
+        if (_wakeup_pipe[1] >= 0) {
+            const char wakeup = 0;
+            const auto written = write(_wakeup_pipe[1], &wakeup, sizeof(wakeup));
+            UNUSED(written);
+        }
+#elif defined(WINDOWS)
+        CancelIoEx(_handle, nullptr);
+#endif
         _recv_thread->join();
         _recv_thread.reset();
     }
+#if defined(APPLE)
+    for (auto& fd : _wakeup_pipe) {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+#endif
+#endif
+
+    // Writes what is still queued or buffered while the port is still open.
+    stop_send_queue();
+    _write_combiner.reset();
 
 #if defined(LINUX) || defined(APPLE)
     close(_fd);
@@ -249,7 +391,7 @@ ConnectionResult SerialConnection::stop()
     return ConnectionResult::Success;
 }
 
-bool SerialConnection::send_message(const mavlink_message_t& message)
+bool SerialConnection::can_send() const
 {
     if (_serial_node.empty()) {
         LogErr() << "Dev Path unknown";
@@ -261,20 +403,121 @@ bool SerialConnection::send_message(const mavlink_message_t& message)
         return false;
     }
 
-    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-    uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+    return true;
+}
+
+bool SerialConnection::send_frame(const MavlinkFrame& frame)
+{
+    if (!can_send()) {
+        return false;
+    }
+
+    if (_tx_scheduler) {
+        {
+            std::lock_guard<std::mutex> lock(_send_mutex);
+            _tx_scheduler->push(frame);
+        }
+        _send_cv.notify_one();
+        return true;
+    }
+
+    if (_send_queue) {
+        return _send_queue->push(frame.buffer, frame.length) == SendQueue::Result::Queued;
+    }
+
+    if (!_write_combiner) {
+        return write_bytes(frame.buffer, frame.length);
+    }
+    return _write_combiner->write(frame.buffer, frame.length);
+}
+
+bool SerialConnection::send_frames(const std::vector<const MavlinkFrame*>& frames)
+{
+    if (!can_send()) {
+        return false;
+    }
+
+    if (_tx_scheduler) {
+        {
+            std::lock_guard<std::mutex> lock(_send_mutex);
+            for (const auto* frame : frames) {
+                _tx_scheduler->push(*frame);
+            }
+        }
+        _send_cv.notify_one();
+        return true;
+    }
+
+    // Queued frames are written together anyway.
+    if (_send_queue || !_write_combiner) {
+        return Connection::send_frames(frames);
+    }
+
+    // The whole batch goes out in as few writes as possible.
+    bool send_successful = true;
+    for (const auto* frame : frames) {
+        if (!_write_combiner->append(frame->buffer, frame->length)) {
+            send_successful = false;
+        }
+    }
+    if (!_write_combiner->flush()) {
+        send_successful = false;
+    }
+    return send_successful;
+}
+
+void SerialConnection::send_scheduled()
+{
+    _thread_setup.apply();
+
+    std::unique_lock<std::mutex> lock(_send_mutex);
+
+    // Frames the budget allows at once are appended and written together.
+    bool needs_flush = false;
 
+    while (!_should_exit) {
+        const double now_s = _time.elapsed_s();
+        auto frame = _tx_scheduler->pop(now_s);
+
+        if (!frame) {
+            if (needs_flush) {
+                needs_flush = false;
+                lock.unlock();
+                _write_combiner->flush();
+                lock.lock();
+                // More might have been queued in the meantime.
+                continue;
+            }
+
+            if (_tx_scheduler->empty()) {
+                _send_cv.wait(lock);
+            } else {
+                _send_cv.wait_for(
+                    lock, std::chrono::duration<double>(_tx_scheduler->delay_s(now_s)));
+            }
+            continue;
+        }
+
+        lock.unlock();
+        _write_combiner->append(frame->buffer, frame->length);
+        needs_flush = true;
+        lock.lock();
+    }
+}
+
+bool SerialConnection::write_bytes(const uint8_t* data, std::size_t length)
+{
     int send_len;
 #if defined(LINUX) || defined(APPLE)
-    send_len = static_cast<int>(write(_fd, buffer, buffer_len));
+    send_len = static_cast<int>(write(_fd, data, length));
 #else
-    if (!WriteFile(_handle, buffer, buffer_len, LPDWORD(&send_len), NULL)) {
+    if (!WriteFile(_handle, data, static_cast<DWORD>(length), LPDWORD(&send_len), NULL)) {
         LogErr() << "WriteFile failure: " << GET_ERROR();
         return false;
     }
 #endif
 
-    if (send_len != buffer_len) {
+    if (send_len != static_cast<int>(length)) {
         LogErr() << "write failure: " << GET_ERROR();
         return false;
     }
@@ -282,38 +525,75 @@ bool SerialConnection::send_message(const mavlink_message_t& message)
     return true;
 }
 
+#if defined(LINUX)
+void SerialConnection::receive_available()
+{
+    // The reactor only calls us once there is something to read, so this
+    // doesn't block.
+    const auto recv_len = read(_fd, _read_buffer.data(), _read_buffer.size());
+    if (recv_len < 0) {
+        if (errno != EAGAIN && errno != EINTR) {
+            LogErr() << "read failure: " << GET_ERROR();
+        }
+        return;
+    }
+    if (recv_len == 0) {
+        return;
+    }
+
+    // Timestamped right after the read, so the read to dispatch latency
+    // covers all of the parsing.
+    _mavlink_receiver->set_new_datagram(
+        _read_buffer.data(), static_cast<unsigned>(recv_len), MessageLatency::now_ns());
+    // Parse all mavlink messages in one data packet. Once exhausted, we'll exit while.
+    while (_mavlink_receiver->parse_message()) {
+        receive_message(_mavlink_receiver->get_last_message(), this);
+    }
+}
+#else
 void SerialConnection::receive()
 {
-    // Enough for MTU 1500 bytes.
-    char buffer[2048];
+    _thread_setup.apply();
+
+    char* buffer = _read_buffer.data();
+    const auto buffer_size = _read_buffer.size();
 
 #if defined(LINUX) || defined(APPLE)
-    struct pollfd fds[1];
+    struct pollfd fds[2];
     fds[0].fd = _fd;
     fds[0].events = POLLIN;
+    // Only there to be woken up by stop().
+    fds[1].fd = _wakeup_pipe[0];
+    fds[1].events = POLLIN;
 #endif
 
     while (!_should_exit) {
         int recv_len;
 #if defined(LINUX) || defined(APPLE)
-        int pollrc = poll(fds, 1, 1000);
+        int pollrc = poll(fds, 2, 1000);
+        if (_should_exit) {
+            break;
+        }
         if (pollrc == 0 || !(fds[0].revents & POLLIN)) {
             continue;
         } else if (pollrc == -1) {
             LogErr() << "read poll failure: " << GET_ERROR();
         }
         // We enter here if (fds[0].revents & POLLIN) == true
-        recv_len = static_cast<int>(read(_fd, buffer, sizeof(buffer)));
+        recv_len = static_cast<int>(read(_fd, buffer, buffer_size));
         if (recv_len < -1) {
             LogErr() << "read failure: " << GET_ERROR();
         }
 #else
-        if (!ReadFile(_handle, buffer, sizeof(buffer), LPDWORD(&recv_len), NULL)) {
-            LogErr() << "ReadFile failure: " << GET_ERROR();
+        if (!ReadFile(_handle, buffer, static_cast<DWORD>(buffer_size), LPDWORD(&recv_len), NULL)) {
+            // Cancelled by stop(), which is no failure.
+            if (!_should_exit) {
+                LogErr() << "ReadFile failure: " << GET_ERROR();
+            }
             continue;
         }
 #endif
-        if (recv_len > static_cast<int>(sizeof(buffer)) || recv_len == 0) {
+        if (recv_len > static_cast<int>(buffer_size) || recv_len <= 0) {
             continue;
         }
         _mavlink_receiver->set_new_datagram(buffer, recv_len);
@@ -324,6 +604,8 @@ void SerialConnection::receive()
     }
 }
 
+#endif
+
 #if defined(LINUX)
 int SerialConnection::define_from_baudrate(int baudrate)
 {
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <condition_variable>
 #include <mutex>
 #include <memory>
 #include <atomic>
 #include <thread>
+#include <vector>
 #include "connection.h"
+#include "mavsdk_time.h"
+#include "tx_scheduler.h"
+#include "write_combiner.h"
 
 #if defined(WINDOWS)
 #include "windows_include.h"
@@ -24,7 +29,24 @@ public:
     ConnectionResult stop() override;
     ~SerialConnection() override;
 
-    bool send_message(const mavlink_message_t& message) override;
+    bool send_frame(const MavlinkFrame& frame) override;
+    bool send_frames(const std::vector<const MavlinkFrame*>& frames) override;
+
+    // Frames written within the delay are combined into one write, see
+    // WriteCombiner. Needs to be set before start().
+    void set_write_coalescing_delay_s(double delay_s) { _write_coalescing_delay_s = delay_s; }
+
+    // Queues frames by priority and sends them at the rate of the baudrate,
+    // see TxScheduler. Needs to be set before start().
+    void set_send_scheduling(bool enabled) { _send_scheduling = enabled; }
+
+    // Sets the driver's low latency flag and the latency timer of FTDI
+    // adapters, and has reads return without waiting for more bytes. Only
+    // on Linux, needs to be set before start().
+    void set_low_latency(bool enabled) { _low_latency = enabled; }
+
+    // Enough to take in what arrives at the baudrate within 10 ms at once.
+    static std::size_t read_buffer_size_for_baudrate(int baudrate);
 
     // Non-copyable
     SerialConnection(const SerialConnection&) = delete;
@@ -32,11 +54,19 @@ public:
 
 private:
     ConnectionResult setup_port();
-    void start_recv_thread();
+    void start_receiving();
+    bool can_send() const;
+    bool write_bytes(const uint8_t* data, std::size_t length);
+    void send_scheduled();
+#if defined(LINUX)
+    void receive_available();
+#else
     void receive();
+#endif
 
 #if defined(LINUX)
     static int define_from_baudrate(int baudrate);
+    void apply_low_latency();
 #endif
 
     const std::string _serial_node;
@@ -50,8 +80,32 @@ private:
     HANDLE _handle;
 #endif
 
-    std::unique_ptr<std::thread> _recv_thread{};
+#if defined(LINUX)
+    // Connections are served by the shared IoReactor instead of a thread each.
+    uint64_t _reactor_handle{0};
+#else
+    std::unique_ptr<NativeThread> _recv_thread{};
+#endif
+#if defined(APPLE)
+    // Written to by stop() to wake up the receive thread right away.
+    int _wakeup_pipe[2]{-1, -1};
+#endif
     std::atomic_bool _should_exit{false};
+
+    bool _low_latency{false};
+    std::vector<char> _read_buffer{};
+
+    bool _send_scheduling{false};
+    // Only used with send scheduling, frames then go out on a thread of
+    // their own so a blocking write doesn't hold up whoever sends.
+    std::mutex _send_mutex{};
+    std::condition_variable _send_cv{};
+    std::unique_ptr<TxScheduler> _tx_scheduler{};
+    std::unique_ptr<NativeThread> _send_thread{};
+    Time _time{};
+
+    double _write_coalescing_delay_s{0.0};
+    std::unique_ptr<WriteCombiner> _write_combiner{};
 };
 
 } // namespace mavsdk
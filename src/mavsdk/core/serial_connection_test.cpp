@@ -0,0 +1,66 @@
+#if defined(LINUX)
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <gtest/gtest.h>
+#include "serial_connection.h"
+
+using namespace mavsdk;
+
+TEST(SerialConnection, ReadBufferSizedByBaudrate)
+{
+    EXPECT_EQ(SerialConnection::read_buffer_size_for_baudrate(57600), 2048);
+    EXPECT_EQ(SerialConnection::read_buffer_size_for_baudrate(4000000), 4000);
+    EXPECT_EQ(SerialConnection::read_buffer_size_for_baudrate(0), 2048);
+}
+
+TEST(SerialConnection, ReceivesWithLowLatency)
+{
+    // A pseudo terminal stands in for the serial port. It has no low
+    // latency flag to set, which only leads to a warning.
+    const int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_NE(master_fd, -1);
+    ASSERT_EQ(grantpt(master_fd), 0);
+    ASSERT_EQ(unlockpt(master_fd), 0);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    int received = 0;
+
+    SerialConnection connection(
+        [&](mavlink_message_t&, Connection*) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++received;
+            cv.notify_all();
+        },
+        ptsname(master_fd),
+        57600,
+        false);
+    connection.set_low_latency(true);
+    ASSERT_EQ(connection.start(), ConnectionResult::Success);
+
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(1, MAV_COMP_ID_AUTOPILOT1, &message, MAV_TYPE_QUADROTOR, 0, 0, 0, 0);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const auto length = mavlink_msg_to_send_buffer(buffer, &message);
+    ASSERT_EQ(write(master_fd, buffer, length), length);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        EXPECT_TRUE(cv.wait_for(lock, std::chrono::seconds(1), [&]() { return received == 1; }));
+    }
+
+    const auto stats = connection.read_to_dispatch_stats();
+    EXPECT_EQ(stats.count, 1);
+    EXPECT_GT(stats.max_ns, 0);
+
+    connection.stop();
+    close(master_fd);
+}
+
+#endif
@@ -0,0 +1,285 @@
+#include "sha256.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MAVSDK_SHA256_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(__aarch64__) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#define MAVSDK_SHA256_ARM 1
+#include <arm_neon.h>
+#endif
+
+namespace mavsdk {
+
+namespace {
+
+alignas(16) constexpr uint32_t k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+constexpr std::array<uint32_t, 8> initial_state = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+inline uint32_t rotr(uint32_t x, unsigned n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+void compress_portable(uint32_t* state, const uint8_t* blocks, std::size_t num)
+{
+    for (std::size_t block = 0; block < num; ++block, blocks += 64) {
+        uint32_t w[64];
+        for (unsigned i = 0; i < 16; ++i) {
+            w[i] = (static_cast<uint32_t>(blocks[4 * i]) << 24) |
+                   (static_cast<uint32_t>(blocks[4 * i + 1]) << 16) |
+                   (static_cast<uint32_t>(blocks[4 * i + 2]) << 8) |
+                   static_cast<uint32_t>(blocks[4 * i + 3]);
+        }
+        for (unsigned i = 16; i < 64; ++i) {
+            const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (unsigned i = 0; i < 64; ++i) {
+            const uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+            const uint32_t ch = (e & f) ^ (~e & g);
+            const uint32_t temp1 = h + s1 + ch + k[i] + w[i];
+            const uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+            const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            const uint32_t temp2 = s0 + maj;
+
+            h = g;
+            g = f;
+            f = e;
+            e = d + temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = temp1 + temp2;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if defined(MAVSDK_SHA256_X86)
+bool cpu_has_sha()
+{
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    const bool has_ssse3 = (ecx & (1u << 9)) != 0;
+    const bool has_sse41 = (ecx & (1u << 19)) != 0;
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    const bool has_sha = (ebx & (1u << 29)) != 0;
+
+    return has_ssse3 && has_sse41 && has_sha;
+}
+
+// The SHA instructions work on the state as ABEF and CDGH, and do two rounds
+// at a time, so each group of four message words takes two of them.
+__attribute__((target("sha,sse4.1,ssse3"))) void
+compress_x86(uint32_t* state, const uint8_t* blocks, std::size_t num)
+{
+    const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+    __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+    tmp = _mm_shuffle_epi32(tmp, 0xb1); // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1b); // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0); // CDGH
+
+    for (std::size_t block = 0; block < num; ++block, blocks += 64) {
+        const __m128i abef_save = state0;
+        const __m128i cdgh_save = state1;
+
+        // The last four groups of message words.
+        __m128i w[4];
+
+        for (unsigned i = 0; i < 16; ++i) {
+            if (i < 4) {
+                w[i] = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16 * i)),
+                    byte_swap);
+            } else {
+                __m128i next = _mm_sha256msg1_epu32(w[i % 4], w[(i + 1) % 4]);
+                next = _mm_add_epi32(next, _mm_alignr_epi8(w[(i + 3) % 4], w[(i + 2) % 4], 4));
+                w[i % 4] = _mm_sha256msg2_epu32(next, w[(i + 3) % 4]);
+            }
+
+            const __m128i round_constants =
+                _mm_load_si128(reinterpret_cast<const __m128i*>(&k[4 * i]));
+            __m128i message = _mm_add_epi32(w[i % 4], round_constants);
+            state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+            message = _mm_shuffle_epi32(message, 0x0e);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, message);
+        }
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1b); // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xb1); // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xf0); // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8); // HGFE
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+#endif
+
+#if defined(MAVSDK_SHA256_ARM)
+void compress_arm(uint32_t* state, const uint8_t* blocks, std::size_t num)
+{
+    uint32x4_t state0 = vld1q_u32(&state[0]);
+    uint32x4_t state1 = vld1q_u32(&state[4]);
+
+    for (std::size_t block = 0; block < num; ++block, blocks += 64) {
+        const uint32x4_t abcd_save = state0;
+        const uint32x4_t efgh_save = state1;
+
+        // The last four groups of message words.
+        uint32x4_t w[4];
+
+        for (unsigned i = 0; i < 16; ++i) {
+            if (i < 4) {
+                w[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + 16 * i)));
+            } else {
+                w[i % 4] = vsha256su1q_u32(
+                    vsha256su0q_u32(w[i % 4], w[(i + 1) % 4]), w[(i + 2) % 4], w[(i + 3) % 4]);
+            }
+
+            const uint32x4_t message = vaddq_u32(w[i % 4], vld1q_u32(&k[4 * i]));
+            const uint32x4_t abcd = state0;
+            state0 = vsha256hq_u32(state0, state1, message);
+            state1 = vsha256h2q_u32(state1, abcd, message);
+        }
+
+        state0 = vaddq_u32(state0, abcd_save);
+        state1 = vaddq_u32(state1, efgh_save);
+    }
+
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+}
+#endif
+
+using CompressFunction = void (*)(uint32_t* state, const uint8_t* blocks, std::size_t num);
+
+CompressFunction best_compress_function()
+{
+#if defined(MAVSDK_SHA256_X86)
+    static const bool has_sha = cpu_has_sha();
+    if (has_sha) {
+        return compress_x86;
+    }
+#elif defined(MAVSDK_SHA256_ARM)
+    return compress_arm;
+#endif
+    return compress_portable;
+}
+
+} // namespace
+
+Sha256::Sha256(bool allow_acceleration) :
+    _compress(allow_acceleration ? best_compress_function() : compress_portable),
+    _state(initial_state)
+{}
+
+void Sha256::update(const uint8_t* data, std::size_t length)
+{
+    _total_length += length;
+
+    if (_block_length > 0) {
+        const std::size_t missing = std::min(_block.size() - _block_length, length);
+        std::memcpy(_block.data() + _block_length, data, missing);
+        _block_length += missing;
+        data += missing;
+        length -= missing;
+
+        if (_block_length < _block.size()) {
+            return;
+        }
+        _compress(_state.data(), _block.data(), 1);
+        _block_length = 0;
+    }
+
+    // Whole blocks straight from the input, without copying.
+    const std::size_t num_blocks = length / 64;
+    if (num_blocks > 0) {
+        _compress(_state.data(), data, num_blocks);
+        data += num_blocks * 64;
+        length -= num_blocks * 64;
+    }
+
+    std::memcpy(_block.data(), data, length);
+    _block_length = length;
+}
+
+Sha256::Digest Sha256::finish()
+{
+    const uint64_t total_bits = _total_length * 8;
+
+    // A 1 bit, zeros, and the length in bits, up to the end of a block.
+    _block[_block_length++] = 0x80;
+    if (_block_length > 56) {
+        std::memset(_block.data() + _block_length, 0, _block.size() - _block_length);
+        _compress(_state.data(), _block.data(), 1);
+        _block_length = 0;
+    }
+    std::memset(_block.data() + _block_length, 0, 56 - _block_length);
+    for (unsigned i = 0; i < 8; ++i) {
+        _block[56 + i] = static_cast<uint8_t>(total_bits >> (56 - 8 * i));
+    }
+    _compress(_state.data(), _block.data(), 1);
+
+    Digest digest;
+    for (unsigned i = 0; i < 8; ++i) {
+        digest[4 * i] = static_cast<uint8_t>(_state[i] >> 24);
+        digest[4 * i + 1] = static_cast<uint8_t>(_state[i] >> 16);
+        digest[4 * i + 2] = static_cast<uint8_t>(_state[i] >> 8);
+        digest[4 * i + 3] = static_cast<uint8_t>(_state[i]);
+    }
+    return digest;
+}
+
+Sha256::Digest Sha256::hash(const uint8_t* data, std::size_t length)
+{
+    Sha256 sha256;
+    sha256.update(data, length);
+    return sha256.finish();
+}
+
+bool Sha256::is_accelerated()
+{
+    return best_compress_function() != compress_portable;
+}
+
+} // namespace mavsdk
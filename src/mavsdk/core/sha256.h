@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace mavsdk {
+
+// SHA-256, as needed for MAVLink 2 message signing.
+//
+// Blocks are compressed with the SHA extensions of x86 (SHA-NI) if the CPU
+// has them, or of ARMv8 if the compiler targets them, which is several times
+// faster than the portable implementation that is used otherwise.
+class Sha256 {
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    // The portable implementation can be forced, e.g. to compare both.
+    explicit Sha256(bool allow_acceleration = true);
+
+    void update(const uint8_t* data, std::size_t length);
+
+    // Pads and hashes what is left, the object can't be updated afterwards.
+    Digest finish();
+
+    static Digest hash(const uint8_t* data, std::size_t length);
+
+    // Whether the CPU instructions are used.
+    static bool is_accelerated();
+
+private:
+    void (*_compress)(uint32_t* state, const uint8_t* blocks, std::size_t num);
+    std::array<uint32_t, 8> _state;
+    std::array<uint8_t, 64> _block{};
+    std::size_t _block_length{0};
+    uint64_t _total_length{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,80 @@
+#include "sha256.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+std::string to_hex(const Sha256::Digest& digest)
+{
+    std::string hex;
+    char byte[3];
+    for (const auto value : digest) {
+        snprintf(byte, sizeof(byte), "%02x", value);
+        hex += byte;
+    }
+    return hex;
+}
+
+std::string hash_hex(const std::string& input, bool allow_acceleration)
+{
+    Sha256 sha256(allow_acceleration);
+    sha256.update(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+    return to_hex(sha256.finish());
+}
+
+} // namespace
+
+TEST(Sha256, KnownVectors)
+{
+    for (const bool allow_acceleration : {false, true}) {
+        EXPECT_EQ(
+            hash_hex("", allow_acceleration),
+            "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+        EXPECT_EQ(
+            hash_hex("abc", allow_acceleration),
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        EXPECT_EQ(
+            hash_hex(
+                "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", allow_acceleration),
+            "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+        EXPECT_EQ(
+            hash_hex(std::string(1000000, 'a'), allow_acceleration),
+            "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    }
+}
+
+TEST(Sha256, UpdatesInPieces)
+{
+    std::vector<uint8_t> data(300);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    const auto expected = Sha256::hash(data.data(), data.size());
+
+    for (std::size_t split : {1u, 31u, 64u, 65u, 200u}) {
+        Sha256 sha256;
+        sha256.update(data.data(), split);
+        sha256.update(data.data() + split, data.size() - split);
+        EXPECT_EQ(sha256.finish(), expected) << split;
+    }
+}
+
+TEST(Sha256, AcceleratedMatchesPortable)
+{
+    std::vector<uint8_t> data(307);
+    for (std::size_t length = 0; length <= data.size(); ++length) {
+        data[length % data.size()] = static_cast<uint8_t>(length * 13);
+
+        Sha256 portable(false);
+        portable.update(data.data(), length);
+        Sha256 accelerated(true);
+        accelerated.update(data.data(), length);
+        EXPECT_EQ(portable.finish(), accelerated.finish()) << length;
+    }
+}
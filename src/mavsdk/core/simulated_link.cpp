@@ -0,0 +1,90 @@
+#include "simulated_link.h"
+
+#include <algorithm>
+
+namespace mavsdk {
+
+SimulatedLink::Endpoint::Endpoint(
+    SimulatedLink& link, MAVLinkAddress own_address, MAVLinkAddress target_address) :
+    _link(link),
+    _own_address(own_address),
+    _target_address(target_address)
+{}
+
+bool SimulatedLink::Endpoint::send_message(mavlink_message_t& message)
+{
+    ++_messages_sent;
+    _link.transmit(*this, *_peer, message);
+    return true;
+}
+
+double SimulatedLink::Endpoint::busy_for_s() const
+{
+    return std::max(0.0, _busy_until_s - _link._executor.elapsed_s());
+}
+
+uint8_t SimulatedLink::Endpoint::get_own_system_id() const
+{
+    return _own_address.system_id;
+}
+
+uint8_t SimulatedLink::Endpoint::get_own_component_id() const
+{
+    return _own_address.component_id;
+}
+
+uint8_t SimulatedLink::Endpoint::get_system_id() const
+{
+    return _target_address.system_id;
+}
+
+Sender::Autopilot SimulatedLink::Endpoint::autopilot() const
+{
+    return Autopilot::Px4;
+}
+
+SimulatedLink::SimulatedLink(
+    VirtualTimeExecutor& executor,
+    MAVLinkAddress address_a,
+    MAVLinkAddress address_b,
+    Config config) :
+    _executor(executor),
+    _config(config),
+    _random(config.seed),
+    _a(*this, address_a, address_b),
+    _b(*this, address_b, address_a)
+{
+    _a._peer = &_b;
+    _b._peer = &_a;
+}
+
+void SimulatedLink::transmit(Endpoint& from, Endpoint& to, const mavlink_message_t& message)
+{
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+    const auto bytes = MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len;
+    from._bytes_sent += bytes;
+
+    // Time until the message is all on the wire.
+    double sending_s = 0.0;
+    if (_config.bytes_per_s > 0.0) {
+        const double now_s = _executor.elapsed_s();
+        from._busy_until_s =
+            std::max(from._busy_until_s, now_s) + double(bytes) / _config.bytes_per_s;
+        sending_s = from._busy_until_s - now_s;
+    }
+
+    if (distribution(_random) < _config.loss_probability) {
+        ++_messages_lost;
+        return;
+    }
+
+    const double delay_s =
+        sending_s + _config.latency_s + _config.jitter_s * distribution(_random);
+
+    // Delivered later even without latency, so that no handler is ever
+    // called from within a send.
+    _executor.post_in(delay_s, [&to, message]() { to._message_handler.process_message(message); });
+}
+
+} // namespace mavsdk
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+#include "mavlink_address.h"
+#include "mavlink_include.h"
+#include "mavlink_message_handler.h"
+#include "mavlink_mission_transfer.h"
+#include "virtual_time_executor.h"
+
+namespace mavsdk {
+
+// Two MAVLink endpoints connected by a simulated link on a
+// VirtualTimeExecutor.
+//
+// Each message is delivered to the other endpoint's message handler after
+// the latency, plus up to the jitter, unless it is lost. Losses and jitter
+// come from a seeded generator, so a run can be repeated exactly.
+//
+// With a bandwidth, each direction sends one message after the other, taking
+// as long as its bytes need on the wire, lost ones included. Messages sent
+// while the link is busy queue up behind the ones before.
+class SimulatedLink {
+public:
+    struct Config {
+        double latency_s{0.01};
+        double jitter_s{0.0};
+        double loss_probability{0.0};
+        uint32_t seed{1};
+        double bytes_per_s{0.0}; // 0 for unlimited.
+    };
+
+    class Endpoint : public Sender {
+    public:
+        Endpoint(
+            SimulatedLink& link, MAVLinkAddress own_address, MAVLinkAddress target_address);
+        ~Endpoint() override = default;
+
+        bool send_message(mavlink_message_t& message) override;
+        [[nodiscard]] uint8_t get_own_system_id() const override;
+        [[nodiscard]] uint8_t get_own_component_id() const override;
+        [[nodiscard]] uint8_t get_system_id() const override;
+        [[nodiscard]] Autopilot autopilot() const override;
+
+        MAVLinkMessageHandler& message_handler() { return _message_handler; }
+
+        [[nodiscard]] uint64_t messages_sent() const { return _messages_sent; }
+        [[nodiscard]] uint64_t bytes_sent() const { return _bytes_sent; }
+
+        // How long until a message sent now starts going out, 0 if the link
+        // is free. For senders which keep the link busy without queueing up.
+        [[nodiscard]] double busy_for_s() const;
+
+    private:
+        friend class SimulatedLink;
+
+        SimulatedLink& _link;
+        const MAVLinkAddress _own_address;
+        const MAVLinkAddress _target_address;
+        MAVLinkMessageHandler _message_handler{};
+        Endpoint* _peer{nullptr};
+        uint64_t _messages_sent{0};
+        uint64_t _bytes_sent{0};
+        double _busy_until_s{0.0};
+    };
+
+    SimulatedLink(
+        VirtualTimeExecutor& executor,
+        MAVLinkAddress address_a,
+        MAVLinkAddress address_b,
+        Config config);
+    ~SimulatedLink() = default;
+
+    Endpoint& a() { return _a; }
+    Endpoint& b() { return _b; }
+
+    [[nodiscard]] uint64_t messages_lost() const { return _messages_lost; }
+
+    // Non-copyable
+    SimulatedLink(const SimulatedLink&) = delete;
+    const SimulatedLink& operator=(const SimulatedLink&) = delete;
+
+private:
+    void transmit(Endpoint& from, Endpoint& to, const mavlink_message_t& message);
+
+    VirtualTimeExecutor& _executor;
+    const Config _config;
+    std::mt19937 _random;
+    Endpoint _a;
+    Endpoint _b;
+    uint64_t _messages_lost{0};
+};
+
+} // namespace mavsdk
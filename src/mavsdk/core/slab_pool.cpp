@@ -0,0 +1,80 @@
+#include "slab_pool.h"
+
+#include <algorithm>
+
+namespace mavsdk {
+
+namespace {
+
+std::size_t aligned_block_size(std::size_t block_size)
+{
+    constexpr std::size_t alignment = alignof(std::max_align_t);
+    block_size = std::max(block_size, sizeof(void*));
+    return (block_size + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+SlabPool::SlabPool(std::size_t block_size, std::size_t blocks_per_slab) :
+    _block_size(aligned_block_size(block_size)),
+    _blocks_per_slab(std::max<std::size_t>(blocks_per_slab, 1))
+{}
+
+SlabPool::~SlabPool() = default;
+
+void* SlabPool::allocate()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_free_list == nullptr) {
+        add_slab();
+    }
+
+    FreeBlock* block = _free_list;
+    _free_list = block->next;
+    ++_blocks_in_use;
+    return block;
+}
+
+void SlabPool::deallocate(void* block)
+{
+    if (block == nullptr) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto* free_block = static_cast<FreeBlock*>(block);
+    free_block->next = _free_list;
+    _free_list = free_block;
+    --_blocks_in_use;
+}
+
+std::size_t SlabPool::blocks_in_use() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _blocks_in_use;
+}
+
+std::size_t SlabPool::capacity() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _slabs.size() * _blocks_per_slab;
+}
+
+void SlabPool::add_slab()
+{
+    // new[] of unsigned char is aligned for any fundamental type, and the
+    // block size is a multiple of that alignment.
+    _slabs.emplace_back(new unsigned char[_block_size * _blocks_per_slab]);
+    unsigned char* slab = _slabs.back().get();
+
+    // Chained back to front, so blocks are handed out in address order.
+    for (std::size_t i = _blocks_per_slab; i > 0; --i) {
+        auto* block = reinterpret_cast<FreeBlock*>(slab + (i - 1) * _block_size);
+        block->next = _free_list;
+        _free_list = block;
+    }
+}
+
+} // namespace mavsdk
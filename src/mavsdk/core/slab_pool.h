@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mavsdk {
+
+// Pool of equally sized memory blocks, carved from slabs of fixed capacity.
+//
+// Freed blocks are kept in an intrusive free list and handed out again, so
+// once the pool has grown to the number of blocks in use at peak, allocating
+// and freeing doesn't touch the heap anymore. Slabs are only released when
+// the pool is destroyed.
+class SlabPool {
+public:
+    SlabPool(std::size_t block_size, std::size_t blocks_per_slab);
+    ~SlabPool();
+
+    // Non-copyable
+    SlabPool(const SlabPool&) = delete;
+    const SlabPool& operator=(const SlabPool&) = delete;
+
+    void* allocate();
+    void deallocate(void* block);
+
+    [[nodiscard]] std::size_t block_size() const { return _block_size; }
+
+    [[nodiscard]] std::size_t blocks_in_use() const;
+    [[nodiscard]] std::size_t capacity() const;
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    void add_slab();
+
+    const std::size_t _block_size;
+    const std::size_t _blocks_per_slab;
+
+    mutable std::mutex _mutex{};
+    std::vector<std::unique_ptr<unsigned char[]>> _slabs{};
+    FreeBlock* _free_list{nullptr};
+    std::size_t _blocks_in_use{0};
+};
+
+// Allocator drawing from a SlabPool, falling back to the heap for anything
+// which doesn't fit a block.
+//
+// Used with std::allocate_shared the control block and the object share one
+// pool block. Every allocator holds on to the pool, so objects may outlive
+// whoever created them.
+template<typename T> class PoolAllocator {
+public:
+    using value_type = T;
+
+    explicit PoolAllocator(std::shared_ptr<SlabPool> pool) : _pool(std::move(pool)) {}
+
+    template<typename U> PoolAllocator(const PoolAllocator<U>& other) : _pool(other.pool()) {}
+
+    T* allocate(std::size_t n)
+    {
+        if (fits(n)) {
+            return static_cast<T*>(_pool->allocate());
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t n)
+    {
+        if (fits(n)) {
+            _pool->deallocate(ptr);
+        } else {
+            ::operator delete(ptr);
+        }
+    }
+
+    [[nodiscard]] const std::shared_ptr<SlabPool>& pool() const { return _pool; }
+
+    template<typename U> bool operator==(const PoolAllocator<U>& other) const
+    {
+        return _pool == other.pool();
+    }
+
+    template<typename U> bool operator!=(const PoolAllocator<U>& other) const
+    {
+        return _pool != other.pool();
+    }
+
+private:
+    bool fits(std::size_t n) const
+    {
+        return n == 1 && sizeof(T) <= _pool->block_size() &&
+               alignof(T) <= alignof(std::max_align_t);
+    }
+
+    std::shared_ptr<SlabPool> _pool;
+};
+
+// Room for the control block of std::allocate_shared next to the object.
+static constexpr std::size_t SHARED_CONTROL_BLOCK_SIZE = 32;
+
+// Pool with blocks big enough for any of the given types.
+template<typename... Ts>
+std::shared_ptr<SlabPool> make_shared_slab_pool(std::size_t blocks_per_slab)
+{
+    std::size_t block_size = 0;
+    ((block_size = std::max(block_size, sizeof(Ts))), ...);
+    return std::make_shared<SlabPool>(block_size + SHARED_CONTROL_BLOCK_SIZE, blocks_per_slab);
+}
+
+template<typename T, typename... Args>
+std::shared_ptr<T> make_pooled(const std::shared_ptr<SlabPool>& pool, Args&&... args)
+{
+    return std::allocate_shared<T>(PoolAllocator<T>(pool), std::forward<Args>(args)...);
+}
+
+} // namespace mavsdk
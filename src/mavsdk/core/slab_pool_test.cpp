@@ -0,0 +1,88 @@
+#include "slab_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+
+TEST(SlabPool, ReusesFreedBlocks)
+{
+    SlabPool pool(24, 4);
+    EXPECT_EQ(pool.capacity(), 0u);
+
+    void* first = pool.allocate();
+    EXPECT_EQ(pool.capacity(), 4u);
+    EXPECT_EQ(pool.blocks_in_use(), 1u);
+
+    pool.deallocate(first);
+    EXPECT_EQ(pool.blocks_in_use(), 0u);
+
+    EXPECT_EQ(pool.allocate(), first);
+    pool.deallocate(first);
+}
+
+TEST(SlabPool, GrowsBySlab)
+{
+    SlabPool pool(16, 2);
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < 5; ++i) {
+        blocks.push_back(pool.allocate());
+    }
+    EXPECT_EQ(pool.blocks_in_use(), 5u);
+    EXPECT_EQ(pool.capacity(), 6u);
+
+    for (auto* block : blocks) {
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(block) % alignof(std::max_align_t), 0u);
+        pool.deallocate(block);
+    }
+    EXPECT_EQ(pool.blocks_in_use(), 0u);
+    EXPECT_EQ(pool.capacity(), 6u);
+}
+
+TEST(SlabPool, MakePooledSharesBlockWithControlBlock)
+{
+    struct Item {
+        std::string name;
+        std::function<void()> callback;
+    };
+
+    auto pool = make_shared_slab_pool<Item>(8);
+
+    for (int round = 0; round < 3; ++round) {
+        std::vector<std::shared_ptr<Item>> items;
+        for (int i = 0; i < 8; ++i) {
+            auto item = make_pooled<Item>(pool);
+            item->name = "item";
+            items.push_back(item);
+        }
+        EXPECT_EQ(pool->blocks_in_use(), 8u);
+        // Steady state: no more slabs after the first round.
+        EXPECT_EQ(pool->capacity(), 8u);
+    }
+    EXPECT_EQ(pool->blocks_in_use(), 0u);
+}
+
+TEST(SlabPool, OversizedObjectsFallBackToHeap)
+{
+    auto pool = std::make_shared<SlabPool>(16, 4);
+
+    auto big = make_pooled<std::array<char, 256>>(pool);
+    EXPECT_EQ(pool->blocks_in_use(), 0u);
+    big.reset();
+}
+
+TEST(SlabPool, ObjectsKeepPoolAlive)
+{
+    auto pool = make_shared_slab_pool<int>(4);
+    auto value = make_pooled<int>(pool, 42);
+
+    pool.reset();
+    EXPECT_EQ(*value, 42);
+    value.reset();
+}
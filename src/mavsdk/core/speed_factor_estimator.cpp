@@ -0,0 +1,60 @@
+#include "speed_factor_estimator.h"
+
+namespace mavsdk {
+
+void SpeedFactorEstimator::add_sample(uint32_t time_boot_ms, uint64_t receive_time_ns)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const uint64_t last_sample_ns = _last_sample_ns.load(std::memory_order_relaxed);
+    _last_sample_ns.store(receive_time_ns, std::memory_order_relaxed);
+
+    // A reboot starts the boot time over, which says nothing about the speed.
+    if (!_has_sample || time_boot_ms < _last_time_boot_ms) {
+        _has_sample = true;
+        _last_time_boot_ms = time_boot_ms;
+        return;
+    }
+
+    const Interval interval{
+        static_cast<double>(time_boot_ms - _last_time_boot_ms) * 1e-3,
+        static_cast<double>(receive_time_ns - last_sample_ns) * 1e-9};
+    _last_time_boot_ms = time_boot_ms;
+
+    // Keeping the sum over the window up to date, rather than adding it up
+    // for each query.
+    if (_count == WINDOW) {
+        _sum.simulated_s -= _intervals[_next].simulated_s;
+        _sum.real_s -= _intervals[_next].real_s;
+    } else {
+        ++_count;
+    }
+    _intervals[_next] = interval;
+    _sum.simulated_s += interval.simulated_s;
+    _sum.real_s += interval.real_s;
+    _next = (_next + 1) % WINDOW;
+}
+
+std::optional<double> SpeedFactorEstimator::speed_factor() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_count == 0 || _sum.real_s <= 0.0) {
+        return std::nullopt;
+    }
+    return _sum.simulated_s / _sum.real_s;
+}
+
+void SpeedFactorEstimator::reset()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _last_sample_ns.store(0, std::memory_order_relaxed);
+    _has_sample = false;
+    _last_time_boot_ms = 0;
+    _next = 0;
+    _count = 0;
+    _sum = {};
+}
+
+} // namespace mavsdk
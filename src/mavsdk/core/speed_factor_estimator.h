@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+namespace mavsdk {
+
+// Estimates the lockstep speed factor of a simulation, i.e. how much faster
+// than real time the vehicle's clock runs, from the boot time stamped on a
+// frequent message against the time it was received.
+//
+// Only one sample per SAMPLE_INTERVAL_NS is kept, and messages in between
+// return after comparing one timestamp, so the estimator can be fed from
+// the receive path at any rate. Samples are to be passed from one thread.
+class SpeedFactorEstimator {
+public:
+    static constexpr uint64_t SAMPLE_INTERVAL_NS = 100000000;
+    // The estimate is over the last 5 s.
+    static constexpr std::size_t WINDOW = 50;
+
+    SpeedFactorEstimator() = default;
+    ~SpeedFactorEstimator() = default;
+
+    // Non-copyable
+    SpeedFactorEstimator(const SpeedFactorEstimator&) = delete;
+    const SpeedFactorEstimator& operator=(const SpeedFactorEstimator&) = delete;
+
+    void sample(uint32_t time_boot_ms, uint64_t receive_time_ns)
+    {
+        if (receive_time_ns - _last_sample_ns.load(std::memory_order_relaxed) <
+            SAMPLE_INTERVAL_NS) {
+            return;
+        }
+        add_sample(time_boot_ms, receive_time_ns);
+    }
+
+    // Empty until two samples have been taken.
+    [[nodiscard]] std::optional<double> speed_factor() const;
+
+    // Forgets all samples, e.g. when no longer sampled for a while.
+    void reset();
+
+private:
+    struct Interval {
+        double simulated_s{0.0};
+        double real_s{0.0};
+    };
+
+    void add_sample(uint32_t time_boot_ms, uint64_t receive_time_ns);
+
+    std::atomic<uint64_t> _last_sample_ns{0};
+
+    mutable std::mutex _mutex{};
+    bool _has_sample{false};
+    uint32_t _last_time_boot_ms{0};
+    std::array<Interval, WINDOW> _intervals{};
+    std::size_t _next{0};
+    std::size_t _count{0};
+    Interval _sum{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,80 @@
+#include "speed_factor_estimator.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+static constexpr uint64_t MS = 1000000;
+
+TEST(SpeedFactorEstimator, EmptyUntilTwoSamples)
+{
+    SpeedFactorEstimator estimator;
+    EXPECT_FALSE(estimator.speed_factor());
+
+    estimator.sample(1000, 1000 * MS);
+    EXPECT_FALSE(estimator.speed_factor());
+}
+
+TEST(SpeedFactorEstimator, RealTime)
+{
+    SpeedFactorEstimator estimator;
+    // 250 Hz
+    for (uint32_t i = 1; i <= 1000; ++i) {
+        estimator.sample(i * 4, i * 4 * MS);
+    }
+
+    ASSERT_TRUE(estimator.speed_factor());
+    EXPECT_NEAR(estimator.speed_factor().value(), 1.0, 1e-9);
+}
+
+TEST(SpeedFactorEstimator, FasterThanRealTime)
+{
+    SpeedFactorEstimator estimator;
+    for (uint32_t i = 1; i <= 1000; ++i) {
+        estimator.sample(i * 12, i * 4 * MS);
+    }
+
+    ASSERT_TRUE(estimator.speed_factor());
+    EXPECT_NEAR(estimator.speed_factor().value(), 3.0, 1e-9);
+}
+
+TEST(SpeedFactorEstimator, FollowsChangedSpeedWithinWindow)
+{
+    SpeedFactorEstimator estimator;
+    uint32_t time_boot_ms = 0;
+    uint64_t time_ns = 0;
+    for (int i = 0; i < 100; ++i) {
+        time_boot_ms += 100;
+        time_ns += 100 * MS;
+        estimator.sample(time_boot_ms, time_ns);
+    }
+    for (std::size_t i = 0; i < SpeedFactorEstimator::WINDOW; ++i) {
+        time_boot_ms += 200;
+        time_ns += 100 * MS;
+        estimator.sample(time_boot_ms, time_ns);
+    }
+
+    ASSERT_TRUE(estimator.speed_factor());
+    EXPECT_NEAR(estimator.speed_factor().value(), 2.0, 1e-9);
+}
+
+TEST(SpeedFactorEstimator, RebootStartsOver)
+{
+    SpeedFactorEstimator estimator;
+    estimator.sample(100000, 100 * MS);
+    estimator.sample(100100, 200 * MS);
+    estimator.sample(100, 300 * MS);
+    estimator.sample(300, 400 * MS);
+
+    ASSERT_TRUE(estimator.speed_factor());
+    EXPECT_NEAR(estimator.speed_factor().value(), 1.5, 1e-9);
+}
+
+TEST(SpeedFactorEstimator, ResetForgetsSamples)
+{
+    SpeedFactorEstimator estimator;
+    estimator.sample(100, 100 * MS);
+    estimator.sample(200, 200 * MS);
+    estimator.reset();
+
+    EXPECT_FALSE(estimator.speed_factor());
+}
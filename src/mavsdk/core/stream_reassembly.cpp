@@ -0,0 +1,66 @@
+#include "stream_reassembly.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mavsdk {
+
+void StreamReassembly::add(uint64_t offset, const uint8_t* data, std::size_t size)
+{
+    uint64_t end = offset + size;
+    if (end <= _base) {
+        return;
+    }
+    if (offset < _base) {
+        data += _base - offset;
+        offset = _base;
+    }
+
+    if (end - _base > _bytes.size()) {
+        _bytes.resize(end - _base);
+    }
+    std::memcpy(_bytes.data() + (offset - _base), data, end - offset);
+
+    // Merge the new range with all the ones it touches.
+    auto it = std::lower_bound(
+        _ranges.begin(), _ranges.end(), offset, [](const auto& range, uint64_t value) {
+            return range.second < value;
+        });
+    auto last = it;
+    while (last != _ranges.end() && last->first <= end) {
+        offset = std::min(offset, last->first);
+        end = std::max(end, last->second);
+        ++last;
+    }
+    it = _ranges.erase(it, last);
+    _ranges.insert(it, {offset, end});
+}
+
+std::size_t StreamReassembly::ready_bytes() const
+{
+    if (_ranges.empty() || _ranges.front().first != _base) {
+        return 0;
+    }
+    return static_cast<std::size_t>(_ranges.front().second - _base);
+}
+
+std::vector<uint8_t> StreamReassembly::take(std::size_t max_bytes)
+{
+    const std::size_t count = std::min(max_bytes, ready_bytes());
+    if (count == 0) {
+        return {};
+    }
+
+    std::vector<uint8_t> taken(_bytes.begin(), _bytes.begin() + count);
+    _bytes.erase(_bytes.begin(), _bytes.begin() + count);
+
+    _base += count;
+    if (_ranges.front().second == _base) {
+        _ranges.erase(_ranges.begin());
+    } else {
+        _ranges.front().first = _base;
+    }
+    return taken;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace mavsdk {
+
+// Puts data arriving at any offset back in order, so it can be handed on as
+// soon as everything before it has arrived, without keeping the whole file.
+//
+// Only what arrived ahead of a hole is kept. Data before what was already
+// taken is a duplicate and ignored.
+class StreamReassembly {
+public:
+    StreamReassembly() = default;
+    ~StreamReassembly() = default;
+
+    void add(uint64_t offset, const uint8_t* data, std::size_t size);
+
+    // Bytes which can be taken, i.e. without a hole before them.
+    [[nodiscard]] std::size_t ready_bytes() const;
+
+    // Takes up to max_bytes of the ready bytes.
+    std::vector<uint8_t> take(std::size_t max_bytes);
+
+    // Offset of the first byte not taken yet.
+    [[nodiscard]] uint64_t next_offset() const { return _base; }
+
+    // Bytes kept, including the ones after holes.
+    [[nodiscard]] std::size_t buffered_bytes() const { return _bytes.size(); }
+
+private:
+    uint64_t _base{0}; // Offset of _bytes[0].
+    std::vector<uint8_t> _bytes{};
+    // Received [begin, end) ranges from _base on, sorted and merged.
+    std::vector<std::pair<uint64_t, uint64_t>> _ranges{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,100 @@
+#include "stream_reassembly.h"
+
+#include <numeric>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+std::vector<uint8_t> make_bytes(std::size_t size)
+{
+    std::vector<uint8_t> bytes(size);
+    std::iota(bytes.begin(), bytes.end(), 0);
+    return bytes;
+}
+
+} // namespace
+
+TEST(StreamReassembly, InOrder)
+{
+    const auto bytes = make_bytes(100);
+    StreamReassembly reassembly;
+
+    reassembly.add(0, bytes.data(), 40);
+    reassembly.add(40, bytes.data() + 40, 60);
+    EXPECT_EQ(reassembly.ready_bytes(), 100);
+
+    const auto first = reassembly.take(30);
+    EXPECT_EQ(first, std::vector<uint8_t>(bytes.begin(), bytes.begin() + 30));
+    EXPECT_EQ(reassembly.next_offset(), 30);
+    EXPECT_EQ(reassembly.ready_bytes(), 70);
+
+    const auto rest = reassembly.take(1000);
+    EXPECT_EQ(rest, std::vector<uint8_t>(bytes.begin() + 30, bytes.end()));
+    EXPECT_EQ(reassembly.ready_bytes(), 0);
+    EXPECT_EQ(reassembly.buffered_bytes(), 0);
+}
+
+TEST(StreamReassembly, HoldsBackAfterHole)
+{
+    const auto bytes = make_bytes(100);
+    StreamReassembly reassembly;
+
+    reassembly.add(0, bytes.data(), 20);
+    reassembly.add(50, bytes.data() + 50, 50);
+    EXPECT_EQ(reassembly.ready_bytes(), 20);
+    EXPECT_EQ(reassembly.take(100).size(), 20);
+    EXPECT_EQ(reassembly.ready_bytes(), 0);
+    EXPECT_TRUE(reassembly.take(100).empty());
+
+    // Filling the hole out of order.
+    reassembly.add(35, bytes.data() + 35, 15);
+    EXPECT_EQ(reassembly.ready_bytes(), 0);
+    reassembly.add(20, bytes.data() + 20, 15);
+    EXPECT_EQ(reassembly.ready_bytes(), 80);
+
+    EXPECT_EQ(reassembly.take(100), std::vector<uint8_t>(bytes.begin() + 20, bytes.end()));
+}
+
+TEST(StreamReassembly, IgnoresDuplicates)
+{
+    const auto bytes = make_bytes(60);
+    StreamReassembly reassembly;
+
+    reassembly.add(0, bytes.data(), 30);
+    reassembly.take(30);
+
+    // Entirely taken already.
+    reassembly.add(10, bytes.data() + 10, 20);
+    EXPECT_EQ(reassembly.ready_bytes(), 0);
+    EXPECT_EQ(reassembly.buffered_bytes(), 0);
+
+    // Partly taken already.
+    reassembly.add(20, bytes.data() + 20, 20);
+    EXPECT_EQ(reassembly.ready_bytes(), 10);
+
+    // Received twice.
+    reassembly.add(30, bytes.data() + 30, 30);
+    reassembly.add(45, bytes.data() + 45, 10);
+    EXPECT_EQ(reassembly.ready_bytes(), 30);
+    EXPECT_EQ(reassembly.take(100), std::vector<uint8_t>(bytes.begin() + 30, bytes.end()));
+}
+
+TEST(StreamReassembly, MergesManyRanges)
+{
+    const auto bytes = make_bytes(200);
+    StreamReassembly reassembly;
+
+    // Every other chunk of 10 first, then the ones between.
+    for (std::size_t offset = 10; offset < 200; offset += 20) {
+        reassembly.add(offset, bytes.data() + offset, 10);
+    }
+    EXPECT_EQ(reassembly.ready_bytes(), 0);
+    for (int offset = 180; offset >= 0; offset -= 20) {
+        reassembly.add(offset, bytes.data() + offset, 10);
+    }
+    EXPECT_EQ(reassembly.ready_bytes(), 200);
+    EXPECT_EQ(reassembly.take(200), bytes);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace mavsdk {
+
+// One-shot waiter for a sync call wrapping its async variant, e.g.:
+//
+//   SyncWaiter<Action::Result> waiter;
+//   arm_async(waiter.completion());
+//   return waiter.wait();
+//
+// Unlike a promise and future, it lives on the caller's stack, so a sync
+// call does not allocate any shared state. The async call has to complete
+// exactly once, and before wait() returns nothing may touch the waiter.
+//
+// The callback passed is a Completion, which async implementations can
+// recognise with completes_waiter() to call it right away on the
+// completing thread rather than queueing it for the user callback thread:
+// all it does is wake up the caller, so this saves a thread hop.
+template<typename T> class SyncWaiter {
+public:
+    struct Completion {
+        SyncWaiter* waiter;
+
+        void operator()(T value) const { waiter->complete(std::move(value)); }
+    };
+
+    SyncWaiter() = default;
+    ~SyncWaiter() = default;
+
+    // Non-copyable
+    SyncWaiter(const SyncWaiter&) = delete;
+    const SyncWaiter& operator=(const SyncWaiter&) = delete;
+
+    [[nodiscard]] Completion completion() { return Completion{this}; }
+
+    void complete(T value)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _value = std::move(value);
+        // Notified with the lock held, the waiter may be gone right after.
+        _cv.notify_one();
+    }
+
+    T wait()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this]() { return _value.has_value(); });
+        return std::move(_value.value());
+    }
+
+private:
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::optional<T> _value{};
+};
+
+// Whether the callback only completes a SyncWaiter and can be called on any
+// thread without ever blocking.
+template<typename T> bool completes_waiter(const std::function<void(T)>& callback)
+{
+    return callback.template target<typename SyncWaiter<T>::Completion>() != nullptr;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,40 @@
+#include "sync_waiter.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace mavsdk;
+
+TEST(SyncWaiter, ReturnsValueCompletedBeforeWait)
+{
+    SyncWaiter<int> waiter;
+    waiter.complete(42);
+    EXPECT_EQ(waiter.wait(), 42);
+}
+
+TEST(SyncWaiter, WakesUpOnCompletionFromOtherThread)
+{
+    SyncWaiter<std::pair<int, std::string>> waiter;
+    std::function<void(std::pair<int, std::string>)> callback = waiter.completion();
+
+    std::thread completing([&callback]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        callback({1, "done"});
+    });
+
+    const auto result = waiter.wait();
+    completing.join();
+    EXPECT_EQ(result.first, 1);
+    EXPECT_EQ(result.second, "done");
+}
+
+TEST(SyncWaiter, RecognisesCompletions)
+{
+    SyncWaiter<int> waiter;
+    const std::function<void(int)> completion = waiter.completion();
+    const std::function<void(int)> other = [](int) {};
+    const std::function<void(int)> empty{};
+
+    EXPECT_TRUE(completes_waiter(completion));
+    EXPECT_FALSE(completes_waiter(other));
+    EXPECT_FALSE(completes_waiter(empty));
+}
@@ -60,6 +60,11 @@ void System::subscribe_is_connected(IsConnectedCallback callback)
     return _system_impl->subscribe_is_connected(std::move(callback));
 }
 
+void System::subscribe_ready(ReadyCallback callback)
+{
+    return _system_impl->subscribe_ready(std::move(callback));
+}
+
 void System::register_component_discovered_callback(DiscoverCallback callback) const
 {
     return _system_impl->register_component_discovered_callback(std::move(callback));
@@ -75,6 +80,11 @@ void System::enable_timesync()
     _system_impl->enable_timesync();
 }
 
+std::optional<uint64_t> System::to_local_time(uint64_t remote_us) const
+{
+    return _system_impl->to_local_time_us(remote_us);
+}
+
 void System::add_capabilities(uint64_t add_capabilities)
 {
     _system_impl->add_capabilities(add_capabilities);
@@ -120,4 +130,29 @@ System::AutopilotVersion System::get_autopilot_version_data()
     return _system_impl->get_autopilot_version_data();
 }
 
+System::MemoryStats System::memory_stats() const
+{
+    return _system_impl->memory_stats();
+}
+
+System::BackgroundRequestStats System::background_request_stats() const
+{
+    return _system_impl->background_request_stats();
+}
+
+std::vector<System::MessageRate> System::message_rates() const
+{
+    return _system_impl->message_rates();
+}
+
+std::vector<System::MessageHandlerStats> System::message_handler_stats() const
+{
+    return _system_impl->message_handler_stats();
+}
+
+void System::reset_message_handler_stats()
+{
+    _system_impl->reset_message_handler_stats();
+}
+
 } // namespace mavsdk
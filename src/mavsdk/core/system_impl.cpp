@@ -2,18 +2,51 @@
 #include "mavsdk_impl.h"
 #include "mavlink_include.h"
 #include "system_impl.h"
+#include "message_latency.h"
 #include "plugin_impl_base.h"
 #include "px4_custom_mode.h"
+#include "sync_waiter.h"
+#include "trace.h"
 #include "ardupilot_custom_mode.h"
+#include "fs.h"
+#include <algorithm>
 #include <cstdlib>
 #include <functional>
-#include <future>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <typeinfo>
 #include <utility>
 
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
 namespace mavsdk {
 
+namespace {
+
+// The class name without namespace, e.g. "TelemetryImpl".
+std::string plugin_name(const PluginImplBase& plugin_impl)
+{
+    const char* type_name = typeid(plugin_impl).name();
+#if defined(__GNUG__)
+    int status = 0;
+    std::unique_ptr<char, void (*)(void*)> demangled(
+        abi::__cxa_demangle(type_name, nullptr, nullptr, &status), std::free);
+    std::string name = status == 0 ? demangled.get() : type_name;
+#else
+    std::string name = type_name;
+#endif
+    const auto colons = name.rfind("::");
+    return colons == std::string::npos ? name : name.substr(colons + 2);
+}
+
+} // namespace
+
 SystemImpl::SystemImpl(MavsdkImpl& parent) :
     Sender(),
+    _message_handler(&parent.message_id_filter()),
     _parent(parent),
     _params(*this),
     _command_sender(*this),
@@ -21,28 +54,44 @@ SystemImpl::SystemImpl(MavsdkImpl& parent) :
     _request_message_handler(*this),
     _timesync(*this),
     _ping(*this),
-    _mission_transfer(
-        *this, _message_handler, _parent.timeout_handler, [this]() { return timeout_s(); }),
     _request_message(*this, _command_sender, _message_handler, _parent.timeout_handler),
-    _mavlink_ftp(*this)
+    _connect_pipeline(_time, _parent.timeout_handler, MAX_CONNECT_REQUESTS_IN_FLIGHT)
 {
-    _system_thread = new std::thread(&SystemImpl::system_thread, this);
+    _message_handler.set_owner_name(this, "SystemImpl");
+    _message_handler.set_owner_name(&_params, "MAVLinkParameters");
+    _message_handler.set_owner_name(&_command_sender, "MavlinkCommandSender");
+    _message_handler.set_owner_name(&_command_receiver, "MavlinkCommandReceiver");
+    _message_handler.set_owner_name(&_timesync, "Timesync");
+    _message_handler.set_owner_name(&_ping, "Ping");
+
+    add_call_every([this]() { schedule_work(); }, WORK_TICK_INTERVAL_S, &_work_tick_cookie);
+
+    _connect_pipeline.set_ready_callback(
+        [this](const System::Ready& ready) { process_ready(ready); });
+
+    _connect_pipeline.add_step(
+        "autopilot version",
+        [this](ConnectPipeline::Done done) { request_autopilot_version(std::move(done)); },
+        this);
 }
 
 SystemImpl::~SystemImpl()
 {
-    _should_exit = true;
+    remove_call_every(_work_tick_cookie);
     _message_handler.unregister_all(this);
 
-    if (!_always_connected) {
-        unregister_timeout_handler(_heartbeat_timeout_cookie);
+    {
+        std::lock_guard<std::mutex> lock(_incoming_messages_intercept_mutex);
+        if (_incoming_messages_intercept_callback) {
+            _parent.message_id_filter().remove_all();
+        }
     }
 
-    if (_system_thread != nullptr) {
-        _system_thread->join();
-        delete _system_thread;
-        _system_thread = nullptr;
-    }
+    // Work already posted to the pool still holds this, so we have to wait
+    // for it to be done.
+    std::unique_lock<std::mutex> lock(_work_mutex);
+    _should_exit = true;
+    _work_cv.wait(lock, [this]() { return !_work_scheduled; });
 }
 
 void SystemImpl::init(uint8_t system_id, uint8_t comp_id, bool connected)
@@ -71,6 +120,15 @@ void SystemImpl::init(uint8_t system_id, uint8_t comp_id, bool connected)
         [this](const mavlink_message_t& message) { process_autopilot_version(message); },
         this);
 
+    // Incoming requests create FTP, so we can serve files without it being
+    // used locally.
+    _message_handler.register_one(
+        MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL,
+        [this](const mavlink_message_t& message) {
+            mavlink_ftp().process_mavlink_ftp_message(message);
+        },
+        this);
+
     register_mavlink_command_handler(
         MAV_CMD_REQUEST_AUTOPILOT_CAPABILITIES,
         [this](const MavlinkCommandReceiver::CommandLong& command) {
@@ -98,6 +156,19 @@ void SystemImpl::register_mavlink_message_handler(
     _message_handler.register_one(msg_id, cmp_id, callback, cookie);
 }
 
+void SystemImpl::register_mavlink_message_handlers(
+    const std::vector<uint16_t>& msg_ids,
+    const mavlink_message_handler_t& callback,
+    const void* cookie)
+{
+    _message_handler.register_many(msg_ids, callback, cookie);
+}
+
+SharedMessage SystemImpl::share_message(const mavlink_message_t& message)
+{
+    return _parent.message_pool().share(message);
+}
+
 void SystemImpl::unregister_mavlink_message_handler(uint16_t msg_id, const void* cookie)
 {
     _message_handler.unregister_one(msg_id, cookie);
@@ -117,7 +188,14 @@ void SystemImpl::update_componentid_messages_handler(
 void SystemImpl::register_timeout_handler(
     const std::function<void()>& callback, double duration_s, void** cookie)
 {
-    _parent.timeout_handler.add(callback, duration_s, cookie);
+    // Whatever timed out might have been blocking the next item in a queue.
+    _parent.timeout_handler.add(
+        [this, callback]() {
+            callback();
+            schedule_work();
+        },
+        duration_s,
+        cookie);
 }
 
 void SystemImpl::refresh_timeout_handler(const void* cookie)
@@ -132,7 +210,71 @@ void SystemImpl::unregister_timeout_handler(const void* cookie)
 
 double SystemImpl::timeout_s() const
 {
-    return _parent.timeout_s();
+    return _rtt_estimator.rto_s(_parent.timeout_s());
+}
+
+void SystemImpl::add_rtt_sample(double rtt_s)
+{
+    _rtt_estimator.add_sample(rtt_s);
+}
+
+RateAdaptation::Sample SystemImpl::link_sample() const
+{
+    RateAdaptation::Sample sample;
+
+    // With several connections, the one carrying most of the messages of this
+    // system is the one its streams saturate. Its throughput includes the other
+    // systems on it, as they share the capacity.
+    double messages_per_s = -1.0;
+    for (const auto& connection : _parent.connection_stats()) {
+        for (const auto& system : connection.systems) {
+            if (system.system_id != get_system_id() ||
+                system.link.messages_per_s <= messages_per_s) {
+                continue;
+            }
+            messages_per_s = system.link.messages_per_s;
+            sample.loss_rate = system.link.loss_rate;
+            sample.bytes_per_s = connection.link.bytes_per_s;
+        }
+    }
+
+    sample.send_congested = _parent.is_send_congested();
+    if (_rtt_estimator.has_samples()) {
+        sample.rtt_s = _rtt_estimator.smoothed_rtt_s();
+    }
+    return sample;
+}
+
+std::string SystemImpl::get_param_cache_directory() const
+{
+    return _parent.get_param_cache_directory();
+}
+
+double SystemImpl::get_request_message_cache_ttl_s() const
+{
+    return _parent.get_request_message_cache_ttl_s();
+}
+
+bool SystemImpl::get_low_memory() const
+{
+    return _parent.get_low_memory();
+}
+
+HttpLoader& SystemImpl::http_loader()
+{
+    return _parent.http_loader();
+}
+
+std::string SystemImpl::get_uid_string() const
+{
+    const uint64_t uid = _uid;
+    if (uid == 0) {
+        return {};
+    }
+
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0') << std::setw(16) << uid;
+    return ss.str();
 }
 
 void SystemImpl::enable_timesync()
@@ -140,6 +282,15 @@ void SystemImpl::enable_timesync()
     _timesync.enable();
 }
 
+std::optional<uint64_t> SystemImpl::to_local_time_us(uint64_t remote_us) const
+{
+    const auto local_ns = _clock_model.to_local_ns(static_cast<int64_t>(remote_us) * 1000);
+    if (!local_ns || local_ns.value() < 0) {
+        return std::nullopt;
+    }
+    return static_cast<uint64_t>(local_ns.value() / 1000);
+}
+
 void SystemImpl::enable_sending_autopilot_version()
 {
     _should_send_autopilot_version = true;
@@ -151,24 +302,107 @@ void SystemImpl::subscribe_is_connected(System::IsConnectedCallback callback)
     _is_connected_callback = std::move(callback);
 }
 
+void SystemImpl::subscribe_ready(System::ReadyCallback callback)
+{
+    std::lock_guard<std::mutex> lock(_connection_mutex);
+    _ready_callback = std::move(callback);
+}
+
+void SystemImpl::add_connect_step(
+    std::string name, ConnectPipeline::Start start, const void* cookie)
+{
+    _connect_pipeline.add_step(std::move(name), std::move(start), cookie);
+}
+
+void SystemImpl::remove_connect_steps(const void* cookie)
+{
+    _connect_pipeline.remove_steps(cookie);
+}
+
+void SystemImpl::process_ready(const System::Ready& ready)
+{
+    LogDebug() << "System ready after " << ready.time_to_ready_s << " s, "
+               << ready.steps.size() << " step(s)";
+
+    std::lock_guard<std::mutex> lock(_connection_mutex);
+    if (_ready_callback) {
+        const auto temp_callback = _ready_callback;
+        _parent.call_user_callback([temp_callback, ready]() { temp_callback(ready); });
+    }
+}
+
 void SystemImpl::process_mavlink_message(mavlink_message_t& message)
 {
+    MAVSDK_TRACE_SCOPE("system", "process_mavlink_message", message.msgid);
+
+    // Timed by when it was received, so waiting to be dispatched adds no jitter.
+    const auto* ingress = MessageLatency::current_ingress();
+    _message_rates.add(
+        message.compid,
+        message.msgid,
+        ingress != nullptr ? ingress->time_ns : MessageLatency::now_ns());
+
     // This is a low level interface where incoming messages can be tampered
     // with or even dropped.
-    if (_incoming_messages_intercept_callback) {
-        const bool keep = _incoming_messages_intercept_callback(message);
-        if (!keep) {
-            LogDebug() << "Dropped incoming message: " << int(message.msgid);
-            return;
+    {
+        std::lock_guard<std::mutex> lock(_incoming_messages_intercept_mutex);
+        if (_incoming_messages_intercept_callback) {
+            const bool keep = _incoming_messages_intercept_callback(message);
+            if (!keep) {
+                LogDebug() << "Dropped incoming message: " << int(message.msgid);
+                return;
+            }
         }
     }
 
     _message_handler.process_message(message);
+
+    // The message might have been the response some work was waiting for.
+    schedule_work();
+}
+
+void SystemImpl::add_periodic_message(
+    const mavlink_message_t& message,
+    double interval_s,
+    void** cookie,
+    PeriodicMessages::Update update)
+{
+    _parent.periodic_messages.add(
+        message,
+        interval_s,
+        cookie,
+        [this, update = std::move(update)](mavlink_message_t& periodic_message) {
+            if (update && !update(periodic_message)) {
+                return false;
+            }
+            return intercept_outgoing_message(periodic_message);
+        });
+}
+
+void SystemImpl::set_periodic_message(const mavlink_message_t& message, const void* cookie)
+{
+    _parent.periodic_messages.set_message(message, cookie);
+}
+
+void SystemImpl::change_periodic_message_interval(double interval_s, const void* cookie)
+{
+    _parent.periodic_messages.change_interval(interval_s, cookie);
+}
+
+void SystemImpl::remove_periodic_message(const void* cookie)
+{
+    _parent.periodic_messages.remove(cookie);
 }
 
 void SystemImpl::add_call_every(std::function<void()> callback, float interval_s, void** cookie)
 {
-    _parent.call_every_handler.add(std::move(callback), static_cast<double>(interval_s), cookie);
+    // Spread out by system, so many systems connecting at once don't all
+    // send in the same tick from then on.
+    _parent.call_every_handler.add(
+        std::move(callback),
+        static_cast<double>(interval_s),
+        cookie,
+        CallEveryHandler::Phase{reinterpret_cast<uintptr_t>(this)});
 }
 
 void SystemImpl::change_call_every(float interval_s, const void* cookie)
@@ -196,39 +430,56 @@ void SystemImpl::register_statustext_handler(
 void SystemImpl::unregister_statustext_handler(void* cookie)
 {
     std::lock_guard<std::mutex> lock(_statustext_handler_callbacks_mutex);
-    _statustext_handler_callbacks.erase(std::remove_if(
-        _statustext_handler_callbacks.begin(),
-        _statustext_handler_callbacks.end(),
-        [&](const auto& entry) { return entry.cookie == cookie; }));
+    _statustext_handler_callbacks.erase(
+        std::remove_if(
+            _statustext_handler_callbacks.begin(),
+            _statustext_handler_callbacks.end(),
+            [&](const auto& entry) { return entry.cookie == cookie; }),
+        _statustext_handler_callbacks.end());
 }
 
 void SystemImpl::process_heartbeat(const mavlink_message_t& message)
 {
+    _last_heartbeat_ns.store(MessageLatency::now_ns(), std::memory_order_relaxed);
+
     mavlink_heartbeat_t heartbeat;
     mavlink_msg_heartbeat_decode(&message, &heartbeat);
 
-    if (heartbeat.autopilot == MAV_AUTOPILOT_PX4) {
-        _autopilot = Autopilot::Px4;
-    } else if (heartbeat.autopilot == MAV_AUTOPILOT_ARDUPILOTMEGA) {
-        _autopilot = Autopilot::ArduPilot;
-    }
-    // This check only works if the MAV_TYPE::MAV_TYPE_ENUM_END is actually the
-    // last enumerator.
-    if (MAV_TYPE::MAV_TYPE_ENUM_END > heartbeat.type) {
-        _vehicle_type = static_cast<MAV_TYPE>(heartbeat.type);
-    } else {
-        LogErr() << "type received in HEARTBEAT was not recognized";
-    }
+    // Everything below only depends on these, and they hardly ever change
+    // from one heartbeat of a component to the next.
+    const uint64_t state = (static_cast<uint64_t>(message.compid) << 56) |
+                           (static_cast<uint64_t>(heartbeat.autopilot) << 48) |
+                           (static_cast<uint64_t>(heartbeat.type) << 40) |
+                           (static_cast<uint64_t>(heartbeat.base_mode) << 32) |
+                           heartbeat.custom_mode;
+
+    if (_last_heartbeat_state.exchange(state) != state) {
+        if (heartbeat.autopilot == MAV_AUTOPILOT_PX4) {
+            _autopilot = Autopilot::Px4;
+        } else if (heartbeat.autopilot == MAV_AUTOPILOT_ARDUPILOTMEGA) {
+            _autopilot = Autopilot::ArduPilot;
+        }
+        // This check only works if the MAV_TYPE::MAV_TYPE_ENUM_END is actually the
+        // last enumerator.
+        if (MAV_TYPE::MAV_TYPE_ENUM_END > heartbeat.type) {
+            _vehicle_type = static_cast<MAV_TYPE>(heartbeat.type);
+        } else {
+            LogErr() << "type received in HEARTBEAT was not recognized";
+        }
 
-    if (message.compid == MavlinkCommandSender::DEFAULT_COMPONENT_ID_AUTOPILOT) {
-        _armed = (heartbeat.base_mode & MAV_MODE_FLAG_SAFETY_ARMED) != 0;
-        _hitl_enabled = (heartbeat.base_mode & MAV_MODE_FLAG_HIL_ENABLED) != 0;
-    }
-    if (heartbeat.base_mode & MAV_MODE_FLAG_CUSTOM_MODE_ENABLED) {
-        _flight_mode = to_flight_mode_from_custom_mode(heartbeat.custom_mode);
+        if (message.compid == MavlinkCommandSender::DEFAULT_COMPONENT_ID_AUTOPILOT) {
+            _armed = (heartbeat.base_mode & MAV_MODE_FLAG_SAFETY_ARMED) != 0;
+            _hitl_enabled = (heartbeat.base_mode & MAV_MODE_FLAG_HIL_ENABLED) != 0;
+        }
+        if (heartbeat.base_mode & MAV_MODE_FLAG_CUSTOM_MODE_ENABLED) {
+            _flight_mode = to_flight_mode_from_custom_mode(heartbeat.custom_mode);
+        }
     }
 
-    set_connected();
+    // Staying connected only takes the timestamp above.
+    if (!_connected) {
+        set_connected();
+    }
 }
 
 void SystemImpl::process_statustext(const mavlink_message_t& message)
@@ -236,17 +487,24 @@ void SystemImpl::process_statustext(const mavlink_message_t& message)
     mavlink_statustext_t statustext;
     mavlink_msg_statustext_decode(&message, &statustext);
 
-    const auto maybe_result = _statustext_handler.process(statustext);
+    const auto maybe_result =
+        _statustext_handler.process(statustext, message.sysid, message.compid);
 
     if (maybe_result.has_value()) {
-        LogDebug() << "MAVLink: "
-                   << MavlinkStatustextHandler::severity_str(maybe_result.value().severity) << ": "
-                   << maybe_result.value().text;
+        call_statustext_handlers(maybe_result.value());
+    }
+}
 
-        std::lock_guard<std::mutex> lock(_statustext_handler_callbacks_mutex);
-        for (const auto& entry : _statustext_handler_callbacks) {
-            entry.callback(maybe_result.value());
-        }
+void SystemImpl::call_statustext_handlers(const MavlinkStatustextHandler::Statustext& statustext)
+{
+    LogDebug() << "MAVLink: " << MavlinkStatustextHandler::severity_str(statustext.severity)
+               << ": " << statustext.text
+               << (statustext.count > 1 ? " (" + std::to_string(statustext.count) + " times)" :
+                                          "");
+
+    std::lock_guard<std::mutex> lock(_statustext_handler_callbacks_mutex);
+    for (const auto& entry : _statustext_handler_callbacks) {
+        entry.callback(statustext);
     }
 }
 
@@ -255,8 +513,27 @@ void SystemImpl::process_autopilot_version(const mavlink_message_t& message)
     mavlink_autopilot_version_t autopilot_version;
     mavlink_msg_autopilot_version_decode(&message, &autopilot_version);
 
-    _mission_transfer.set_int_messages_supported(
-        autopilot_version.capabilities & MAV_PROTOCOL_CAPABILITY_MISSION_INT);
+    _uid = autopilot_version.uid;
+
+    _mission_int_supported =
+        (autopilot_version.capabilities & MAV_PROTOCOL_CAPABILITY_MISSION_INT) != 0;
+
+    std::lock_guard<std::mutex> lock(_lazy_components_mutex);
+    if (_mission_transfer) {
+        _mission_transfer->set_int_messages_supported(_mission_int_supported);
+    }
+}
+
+void SystemImpl::check_heartbeat_timeout(uint64_t now_ns)
+{
+    if (_always_connected || !_connected) {
+        return;
+    }
+
+    const auto last_heartbeat_ns = _last_heartbeat_ns.load(std::memory_order_relaxed);
+    if (now_ns > last_heartbeat_ns && now_ns - last_heartbeat_ns > HEARTBEAT_TIMEOUT_NS) {
+        heartbeats_timed_out();
+    }
 }
 
 void SystemImpl::heartbeats_timed_out()
@@ -265,31 +542,119 @@ void SystemImpl::heartbeats_timed_out()
     set_disconnected();
 }
 
-void SystemImpl::system_thread()
+void SystemImpl::schedule_work()
 {
-    dl_time_t last_ping_time{};
+    {
+        std::lock_guard<std::mutex> lock(_work_mutex);
+        if (_should_exit) {
+            return;
+        }
+        if (_work_scheduled) {
+            // Whoever is running it will go around once more.
+            _work_pending = true;
+            return;
+        }
+        _work_scheduled = true;
+    }
+
+    _parent.system_work_pool().post([this]() { run_work(); });
+}
 
+void SystemImpl::run_work()
+{
+    // Only one run per system at a time, so the work of one system stays in
+    // order even though the pool has multiple threads.
+    std::unique_lock<std::mutex> lock(_work_mutex);
     while (!_should_exit) {
-        _params.do_work();
-        _command_sender.do_work();
-        _timesync.do_work();
-        _mission_transfer.do_work();
-
-        if (_time.elapsed_since_s(last_ping_time) >= SystemImpl::_ping_interval_s) {
-            if (_connected) {
-                _ping.run_once();
-            }
-            last_ping_time = _time.steady_time();
+        _work_pending = false;
+        lock.unlock();
+        do_work();
+        lock.lock();
+        if (!_work_pending) {
+            break;
+        }
+    }
+    _work_scheduled = false;
+    _work_cv.notify_all();
+}
+
+void SystemImpl::queue_work(UniqueFunction<void()> task, const void* cookie)
+{
+    {
+        std::lock_guard<std::mutex> lock(_work_mutex);
+        if (_should_exit) {
+            return;
         }
+        _work_tasks.emplace_back(cookie, std::move(task));
+    }
+    schedule_work();
+}
 
-        if (_connected) {
-            // Work fairly fast if we're connected.
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+void SystemImpl::cancel_work(const void* cookie)
+{
+    std::unique_lock<std::mutex> lock(_work_mutex);
+    for (auto it = _work_tasks.begin(); it != _work_tasks.end();) {
+        if (it->first == cookie) {
+            it = _work_tasks.erase(it);
         } else {
-            // Be less aggressive when unconnected.
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            ++it;
         }
     }
+    _work_cv.wait(lock, [&]() { return _running_work_cookie != cookie; });
+}
+
+void SystemImpl::run_in_background(BackgroundWork::Task task, const void* cookie)
+{
+    _parent.background_work().post(std::move(task), cookie, this);
+}
+
+void SystemImpl::cancel_background(const void* cookie)
+{
+    _parent.background_work().cancel(cookie);
+}
+
+void SystemImpl::run_queued_work()
+{
+    std::unique_lock<std::mutex> lock(_work_mutex);
+    while (!_work_tasks.empty()) {
+        auto task = std::move(_work_tasks.front());
+        _work_tasks.pop_front();
+        _running_work_cookie = task.first;
+        lock.unlock();
+        task.second();
+        lock.lock();
+        _running_work_cookie = nullptr;
+        _work_cv.notify_all();
+    }
+}
+
+void SystemImpl::do_work()
+{
+    // Queued tasks first, in case they start transfers.
+    run_queued_work();
+
+    _params.do_work();
+    _timesync.do_work();
+
+    for (const auto& statustext : _statustext_handler.flush()) {
+        call_statustext_handlers(statustext);
+    }
+
+    MAVLinkMissionTransfer* mission_transfer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_lazy_components_mutex);
+        mission_transfer = _mission_transfer.get();
+    }
+    if (mission_transfer) {
+        mission_transfer->do_work();
+    }
+
+    if (_time.elapsed_since_s(_last_ping_time) >= SystemImpl::_ping_interval_s) {
+        if (_connected) {
+            _ping.run_once();
+        }
+        _last_ping_time = _time.steady_time();
+    }
 }
 
 std::optional<mavlink_message_t>
@@ -352,9 +717,16 @@ void SystemImpl::add_new_component(uint8_t component_id)
         return;
     }
 
+    auto& known = _known_components[component_id / 64];
+    const uint64_t bit = 1ULL << (component_id % 64);
+    if ((known.load(std::memory_order_acquire) & bit) != 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_component_discovered_callback_mutex);
     auto res_pair = _components.insert(component_id);
+    known.fetch_or(bit, std::memory_order_release);
     if (res_pair.second) {
-        std::lock_guard<std::mutex> lock(_component_discovered_callback_mutex);
         if (_component_discovered_callback != nullptr) {
             const System::ComponentType type = component_type(component_id);
             auto temp_callback = _component_discovered_callback;
@@ -493,20 +865,57 @@ mavlink_message_t SystemImpl::make_command_ack_message(
 
 bool SystemImpl::send_message(mavlink_message_t& message)
 {
-    // This is a low level interface where incoming messages can be tampered
+    if (!intercept_outgoing_message(message)) {
+        // We fake that everything was sent as instructed because
+        // a potential loss would happen later, and we would not be informed
+        // about it.
+        return true;
+    }
+
+    return _parent.send_message(message);
+}
+
+bool SystemImpl::intercept_outgoing_message(mavlink_message_t& message)
+{
+    return intercept_outgoing_messages(&message, 1) == 1;
+}
+
+std::size_t SystemImpl::intercept_outgoing_messages(mavlink_message_t* messages, std::size_t count)
+{
+    // This is a low level interface where outgoing messages can be tampered
     // with or even dropped.
-    if (_outgoing_messages_intercept_callback) {
-        const bool keep = _outgoing_messages_intercept_callback(message);
-        if (!keep) {
-            // We fake that everything was sent as instructed because
-            // a potential loss would happen later, and we would not be informed
-            // about it.
-            LogDebug() << "Dropped outgoing message: " << int(message.msgid);
-            return true;
+    const auto callback = std::atomic_load(&_outgoing_messages_intercept_callback);
+    if (callback == nullptr) {
+        return count;
+    }
+
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!(*callback)(messages[i])) {
+            LogDebug() << "Dropped outgoing message: " << int(messages[i].msgid);
+            continue;
         }
+        if (kept != i) {
+            messages[kept] = messages[i];
+        }
+        ++kept;
     }
+    return kept;
+}
 
-    return _parent.send_message(message);
+bool SystemImpl::send_messages(std::vector<mavlink_message_t>& messages)
+{
+    return _parent.send_messages(messages.data(), messages.size());
+}
+
+bool SystemImpl::send_messages(mavlink_message_t* messages, std::size_t count)
+{
+    return _parent.send_messages(messages, count);
+}
+
+bool SystemImpl::shares_connections_with(const SystemImpl& other) const
+{
+    return &_parent == &other._parent;
 }
 
 void SystemImpl::send_autopilot_version_request()
@@ -521,6 +930,27 @@ void SystemImpl::send_autopilot_version_request()
     send_command_async(command, nullptr);
 }
 
+void SystemImpl::request_autopilot_version(ConnectPipeline::Done done)
+{
+    if (!has_autopilot()) {
+        done(true);
+        return;
+    }
+
+    // The answer is handled by process_autopilot_version() like any other
+    // AUTOPILOT_VERSION, we only need to know when it arrived.
+    _request_message.request(
+        MAVLINK_MSG_ID_AUTOPILOT_VERSION,
+        get_autopilot_id(),
+        [this, done](MavlinkCommandSender::Result result, const mavlink_message_t&) {
+            if (result != MavlinkCommandSender::Result::Success) {
+                // Older autopilots might only know the deprecated command.
+                send_autopilot_version_request();
+            }
+            done(result == MavlinkCommandSender::Result::Success);
+        });
+}
+
 void SystemImpl::send_autopilot_version()
 {
     std::lock_guard<std::mutex> lock(_autopilot_version_mutex);
@@ -581,28 +1011,16 @@ void SystemImpl::set_connected()
             // Send a heartbeat back immediately.
             _parent.start_sending_heartbeats();
 
-            if (!_always_connected) {
-                register_timeout_handler(
-                    [this] { heartbeats_timed_out(); },
-                    HEARTBEAT_TIMEOUT_S,
-                    &_heartbeat_timeout_cookie);
-            }
             enable_needed = true;
 
             if (_is_connected_callback) {
                 const auto temp_callback = _is_connected_callback;
                 _parent.call_user_callback([temp_callback]() { temp_callback(true); });
             }
-
-        } else if (_connected && !_always_connected) {
-            refresh_timeout_handler(_heartbeat_timeout_cookie);
         }
-        // If not yet connected there is nothing to do/
     }
     if (enable_needed) {
-        if (has_autopilot()) {
-            send_autopilot_version_request();
-        }
+        _connect_pipeline.start();
 
         std::lock_guard<std::mutex> lock(_plugin_impls_mutex);
         for (auto plugin_impl : _plugin_impls) {
@@ -616,11 +1034,6 @@ void SystemImpl::set_disconnected()
     {
         std::lock_guard<std::mutex> lock(_connection_mutex);
 
-        // This might not be needed because this is probably called from the triggered
-        // timeout anyway, but it should also do no harm.
-        // unregister_timeout_handler(_heartbeat_timeout_cookie);
-        //_heartbeat_timeout_cookie = nullptr;
-
         _connected = false;
         _parent.notify_on_timeout();
         if (_is_connected_callback) {
@@ -630,6 +1043,7 @@ void SystemImpl::set_disconnected()
     }
 
     _parent.stop_sending_heartbeats();
+    _connect_pipeline.stop();
 
     {
         std::lock_guard<std::mutex> lock(_plugin_impls_mutex);
@@ -690,11 +1104,23 @@ MAVLinkParameters::Result SystemImpl::set_param_int(const std::string& name, int
     return _params.set_param(name, param_value, false);
 }
 
-std::map<std::string, MAVLinkParameters::ParamValue> SystemImpl::get_all_params()
+MAVLinkParameters::ParamStore SystemImpl::get_all_params()
 {
     return _params.get_all_params();
 }
 
+MAVLinkParameters::Result SystemImpl::set_params(const MAVLinkParameters::ParamStore& params)
+{
+    return _params.set_params(params);
+}
+
+void SystemImpl::set_params_async(
+    const MAVLinkParameters::ParamStore& params,
+    const MAVLinkParameters::set_params_callback_t& callback)
+{
+    _params.set_params_async(params, callback);
+}
+
 MAVLinkParameters::Result SystemImpl::set_param_ext_float(const std::string& name, float value)
 {
     MAVLinkParameters::ParamValue param_value;
@@ -775,15 +1201,14 @@ SystemImpl::retrieve_server_param_float(const std::string& name)
     return {res.first, res.second.get<float>()};
 }
 
-std::map<std::string, MAVLinkParameters::ParamValue> SystemImpl::retrieve_all_server_params()
+const MAVLinkParameters::ParamStore& SystemImpl::retrieve_all_server_params() const
 {
     return _params.retrieve_all_server_params();
 }
 
 std::pair<MAVLinkParameters::Result, float> SystemImpl::get_param_float(const std::string& name)
 {
-    auto prom = std::promise<std::pair<MAVLinkParameters::Result, float>>();
-    auto res = prom.get_future();
+    SyncWaiter<std::pair<MAVLinkParameters::Result, float>> waiter;
 
     MAVLinkParameters::ParamValue value_type;
     value_type.set<float>(0.0f);
@@ -791,22 +1216,21 @@ std::pair<MAVLinkParameters::Result, float> SystemImpl::get_param_float(const st
     _params.get_param_async(
         name,
         value_type,
-        [&prom](MAVLinkParameters::Result result, MAVLinkParameters::ParamValue param) {
+        [&waiter](MAVLinkParameters::Result result, MAVLinkParameters::ParamValue param) {
             float value = NAN;
             if (result == MAVLinkParameters::Result::Success) {
                 value = param.get<float>();
             }
-            prom.set_value(std::make_pair<>(result, value));
+            waiter.complete(std::make_pair<>(result, value));
         },
         this);
 
-    return res.get();
+    return waiter.wait();
 }
 
 std::pair<MAVLinkParameters::Result, int> SystemImpl::get_param_int(const std::string& name)
 {
-    auto prom = std::promise<std::pair<MAVLinkParameters::Result, int>>();
-    auto res = prom.get_future();
+    SyncWaiter<std::pair<MAVLinkParameters::Result, int>> waiter;
 
     MAVLinkParameters::ParamValue value_type;
     value_type.set<int32_t>(0);
@@ -814,22 +1238,21 @@ std::pair<MAVLinkParameters::Result, int> SystemImpl::get_param_int(const std::s
     _params.get_param_async(
         name,
         value_type,
-        [&prom](MAVLinkParameters::Result result, MAVLinkParameters::ParamValue param) {
+        [&waiter](MAVLinkParameters::Result result, MAVLinkParameters::ParamValue param) {
             int value = 0;
             if (result == MAVLinkParameters::Result::Success) {
                 value = param.get<int32_t>();
             }
-            prom.set_value(std::make_pair<>(result, value));
+            waiter.complete(std::make_pair<>(result, value));
         },
         this);
 
-    return res.get();
+    return waiter.wait();
 }
 
 std::pair<MAVLinkParameters::Result, float> SystemImpl::get_param_ext_float(const std::string& name)
 {
-    auto prom = std::promise<std::pair<MAVLinkParameters::Result, float>>();
-    auto res = prom.get_future();
+    SyncWaiter<std::pair<MAVLinkParameters::Result, float>> waiter;
 
     MAVLinkParameters::ParamValue value_type;
     value_type.set<float>(0.0f);
@@ -837,23 +1260,22 @@ std::pair<MAVLinkParameters::Result, float> SystemImpl::get_param_ext_float(cons
     _params.get_param_async(
         name,
         value_type,
-        [&prom](MAVLinkParameters::Result result, MAVLinkParameters::ParamValue param) {
+        [&waiter](MAVLinkParameters::Result result, MAVLinkParameters::ParamValue param) {
             float value = NAN;
             if (result == MAVLinkParameters::Result::Success) {
                 value = param.get<float>();
             }
-            prom.set_value(std::make_pair<>(result, value));
+            waiter.complete(std::make_pair<>(result, value));
         },
         this,
         true);
 
-    return res.get();
+    return waiter.wait();
 }
 
 std::pair<MAVLinkParameters::Result, int> SystemImpl::get_param_ext_int(const std::string& name)
 {
-    auto prom = std::promise<std::pair<MAVLinkParameters::Result, int>>();
-    auto res = prom.get_future();
+    SyncWaiter<std::pair<MAVLinkParameters::Result, int>> waiter;
 
     MAVLinkParameters::ParamValue value_type;
     value_type.set<int32_t>(0);
@@ -861,17 +1283,17 @@ std::pair<MAVLinkParameters::Result, int> SystemImpl::get_param_ext_int(const st
     _params.get_param_async(
         name,
         value_type,
-        [&prom](MAVLinkParameters::Result result, MAVLinkParameters::ParamValue param) {
+        [&waiter](MAVLinkParameters::Result result, MAVLinkParameters::ParamValue param) {
             int value = 0;
             if (result == MAVLinkParameters::Result::Success) {
                 value = param.get<int32_t>();
             }
-            prom.set_value(std::make_pair<>(result, value));
+            waiter.complete(std::make_pair<>(result, value));
         },
         this,
         true);
 
-    return res.get();
+    return waiter.wait();
 }
 
 void SystemImpl::get_param_float_async(
@@ -1474,6 +1896,7 @@ void SystemImpl::send_command_async(
 MavlinkCommandSender::Result
 SystemImpl::set_msg_rate(uint16_t message_id, double rate_hz, uint8_t component_id)
 {
+    _message_rates.set_requested(component_id, message_id, rate_hz);
     MavlinkCommandSender::CommandLong command =
         make_command_msg_rate(message_id, rate_hz, component_id);
     return send_command(command);
@@ -1485,6 +1908,7 @@ void SystemImpl::set_msg_rate_async(
     const CommandResultCallback& callback,
     uint8_t component_id)
 {
+    _message_rates.set_requested(component_id, message_id, rate_hz);
     MavlinkCommandSender::CommandLong command =
         make_command_msg_rate(message_id, rate_hz, component_id);
     send_command_async(command, callback);
@@ -1517,6 +1941,11 @@ void SystemImpl::register_plugin(PluginImplBase* plugin_impl)
 {
     assert(plugin_impl);
 
+    // Plugins register their handlers with themselves as the cookie, and the
+    // most derived object is what they pass as this.
+    _message_handler.set_owner_name(
+        dynamic_cast<const void*>(plugin_impl), plugin_name(*plugin_impl));
+
     plugin_impl->init();
 
     {
@@ -1537,6 +1966,8 @@ void SystemImpl::unregister_plugin(PluginImplBase* plugin_impl)
     plugin_impl->disable();
     plugin_impl->deinit();
 
+    _message_handler.clear_owner_name(dynamic_cast<const void*>(plugin_impl));
+
     // Remove first, so it won't get enabled/disabled anymore.
     {
         std::lock_guard<std::mutex> lock(_plugin_impls_mutex);
@@ -1548,9 +1979,9 @@ void SystemImpl::unregister_plugin(PluginImplBase* plugin_impl)
 }
 
 void SystemImpl::call_user_callback_located(
-    const std::string& filename, const int linenumber, const std::function<void()>& func)
+    const char* filename, const int linenumber, UserCallbackFunction func)
 {
-    _parent.call_user_callback_located(filename, linenumber, func);
+    _parent.call_user_callback_located(filename, linenumber, std::move(func), this);
 }
 
 void SystemImpl::param_changed(const std::string& name)
@@ -1560,6 +1991,13 @@ void SystemImpl::param_changed(const std::string& name)
     for (auto& callback : _param_changed_callbacks) {
         callback.second(name);
     }
+
+    const auto it = _param_changed_callbacks_by_name.find(name);
+    if (it != _param_changed_callbacks_by_name.end()) {
+        for (auto& callback : it->second) {
+            callback.second(name);
+        }
+    }
 }
 
 void SystemImpl::register_param_changed_handler(
@@ -1580,26 +2018,189 @@ void SystemImpl::register_param_changed_handler(
     _param_changed_callbacks[cookie] = callback;
 }
 
+void SystemImpl::register_param_changed_handler(
+    const std::string& name, const param_changed_callback_t& callback, const void* cookie)
+{
+    if (!callback || !cookie) {
+        LogErr() << "No callback for param_changed_handler supplied.";
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_param_changed_callbacks_mutex);
+
+    _param_changed_callbacks_by_name[name].emplace_back(cookie, callback);
+}
+
 void SystemImpl::unregister_param_changed_handler(const void* cookie)
 {
     std::lock_guard<std::mutex> lock(_param_changed_callbacks_mutex);
 
-    auto it = _param_changed_callbacks.find(cookie);
-    if (it == _param_changed_callbacks.end()) {
+    bool found = _param_changed_callbacks.erase(cookie) > 0;
+
+    for (auto it = _param_changed_callbacks_by_name.begin();
+         it != _param_changed_callbacks_by_name.end();
+         /* ++it */) {
+        auto& callbacks = it->second;
+        const auto size_before = callbacks.size();
+        callbacks.erase(
+            std::remove_if(
+                callbacks.begin(),
+                callbacks.end(),
+                [cookie](const auto& callback) { return callback.first == cookie; }),
+            callbacks.end());
+        found = found || callbacks.size() != size_before;
+        it = callbacks.empty() ? _param_changed_callbacks_by_name.erase(it) : std::next(it);
+    }
+
+    if (!found) {
         LogWarn() << "param_changed_handler for cookie not found";
-        return;
     }
-    _param_changed_callbacks.erase(it);
+}
+
+MAVLinkMissionTransfer& SystemImpl::mission_transfer()
+{
+    std::lock_guard<std::mutex> lock(_lazy_components_mutex);
+    if (!_mission_transfer) {
+        _mission_transfer = std::make_unique<MAVLinkMissionTransfer>(
+            *this,
+            _message_handler,
+            _parent.timeout_handler,
+            [this]() { return timeout_s(); },
+            [this]() { schedule_work(); });
+        _mission_transfer->set_int_messages_supported(_mission_int_supported);
+        _mission_transfer->set_cache_path_callback(
+            [this](uint8_t type) { return mission_cache_path(type); });
+    }
+    return *_mission_transfer;
+}
+
+std::string SystemImpl::mission_cache_path(uint8_t type) const
+{
+    const auto directory = get_param_cache_directory();
+    const auto uid = get_uid_string();
+    if (directory.empty() || uid.empty()) {
+        return {};
+    }
+
+    switch (type) {
+        case MAV_MISSION_TYPE_MISSION:
+            return directory + path_separator + uid + ".mission";
+        case MAV_MISSION_TYPE_FENCE:
+            return directory + path_separator + uid + ".fence";
+        case MAV_MISSION_TYPE_RALLY:
+            return directory + path_separator + uid + ".rally";
+        default:
+            return {};
+    }
+}
+
+MavlinkFtp& SystemImpl::mavlink_ftp()
+{
+    std::lock_guard<std::mutex> lock(_lazy_components_mutex);
+    if (!_mavlink_ftp) {
+        _mavlink_ftp = std::make_unique<MavlinkFtp>(*this);
+    }
+    return *_mavlink_ftp;
+}
+
+System::MemoryStats SystemImpl::memory_stats()
+{
+    System::MemoryStats stats{};
+    stats.parameters_bytes = sizeof(_params) + _params.allocated_bytes();
+    stats.command_bytes = sizeof(_command_sender) + sizeof(_command_receiver);
+    stats.timesync_bytes = sizeof(_timesync);
+    stats.ping_bytes = sizeof(_ping);
+    stats.message_handler_bytes = sizeof(_message_handler) + _message_handler.allocated_bytes();
+
+    {
+        std::lock_guard<std::mutex> lock(_lazy_components_mutex);
+        stats.mission_transfer_bytes = _mission_transfer ? sizeof(MAVLinkMissionTransfer) : 0;
+        stats.ftp_bytes = _mavlink_ftp ? sizeof(MavlinkFtp) : 0;
+    }
+
+    stats.other_bytes = sizeof(SystemImpl) - sizeof(_params) - sizeof(_command_sender) -
+                        sizeof(_command_receiver) - sizeof(_timesync) - sizeof(_ping) -
+                        sizeof(_message_handler);
+
+    stats.total_bytes = stats.parameters_bytes + stats.command_bytes + stats.timesync_bytes +
+                        stats.ping_bytes + stats.message_handler_bytes +
+                        stats.mission_transfer_bytes + stats.ftp_bytes + stats.other_bytes;
+    return stats;
+}
+
+void SystemImpl::count_background_request()
+{
+    std::lock_guard<std::mutex> lock(_background_requests_mutex);
+    ++_background_requests;
+    _background_request_times.push_back(_time.steady_time());
+    drop_old_background_requests();
+}
+
+System::BackgroundRequestStats SystemImpl::background_request_stats()
+{
+    std::lock_guard<std::mutex> lock(_background_requests_mutex);
+    drop_old_background_requests();
+
+    System::BackgroundRequestStats stats{};
+    stats.requests = _background_requests;
+    stats.rate_hz =
+        static_cast<double>(_background_request_times.size()) / BACKGROUND_REQUEST_WINDOW_S;
+    return stats;
+}
+
+std::vector<System::MessageRate> SystemImpl::message_rates() const
+{
+    return _message_rates.rates(MessageLatency::now_ns());
+}
+
+std::vector<System::MessageHandlerStats> SystemImpl::message_handler_stats() const
+{
+    std::vector<System::MessageHandlerStats> stats;
+    for (const auto& owner_stats : _message_handler.owner_stats()) {
+        stats.push_back(System::MessageHandlerStats{
+            owner_stats.owner,
+            owner_stats.invocations,
+            owner_stats.total_s,
+            owner_stats.max_s});
+    }
+    return stats;
+}
+
+void SystemImpl::reset_message_handler_stats()
+{
+    _message_handler.reset_owner_stats();
+}
+
+void SystemImpl::drop_old_background_requests()
+{
+    while (!_background_request_times.empty() &&
+           _time.elapsed_since_s(_background_request_times.front()) >
+               BACKGROUND_REQUEST_WINDOW_S) {
+        _background_request_times.pop_front();
+    }
 }
 
 void SystemImpl::intercept_incoming_messages(std::function<bool(mavlink_message_t&)> callback)
 {
+    std::lock_guard<std::mutex> lock(_incoming_messages_intercept_mutex);
+
+    // Intercepting means seeing every message, not only the handled ones.
+    if (callback && !_incoming_messages_intercept_callback) {
+        _parent.message_id_filter().add_all();
+    } else if (!callback && _incoming_messages_intercept_callback) {
+        _parent.message_id_filter().remove_all();
+    }
     _incoming_messages_intercept_callback = std::move(callback);
 }
 
 void SystemImpl::intercept_outgoing_messages(std::function<bool(mavlink_message_t&)> callback)
 {
-    _outgoing_messages_intercept_callback = std::move(callback);
+    std::shared_ptr<const std::function<bool(mavlink_message_t&)>> new_callback;
+    if (callback) {
+        new_callback =
+            std::make_shared<const std::function<bool(mavlink_message_t&)>>(std::move(callback));
+    }
+    std::atomic_store(&_outgoing_messages_intercept_callback, std::move(new_callback));
 }
 
 void SystemImpl::register_mavlink_command_handler(
@@ -1618,6 +2219,22 @@ void SystemImpl::register_mavlink_command_handler(
     _command_receiver.register_mavlink_command_handler(cmd_id, callback, cookie);
 }
 
+void SystemImpl::register_mavlink_command_handler_async(
+    uint16_t cmd_id,
+    const MavlinkCommandReceiver::MavlinkCommandIntAsyncHandler& callback,
+    const void* cookie)
+{
+    _command_receiver.register_mavlink_command_handler_async(cmd_id, callback, cookie);
+}
+
+void SystemImpl::register_mavlink_command_handler_async(
+    uint16_t cmd_id,
+    const MavlinkCommandReceiver::MavlinkCommandLongAsyncHandler& callback,
+    const void* cookie)
+{
+    _command_receiver.register_mavlink_command_handler_async(cmd_id, callback, cookie);
+}
+
 void SystemImpl::unregister_mavlink_command_handler(uint16_t cmd_id, const void* cookie)
 {
     _command_receiver.unregister_mavlink_command_handler(cmd_id, cookie);
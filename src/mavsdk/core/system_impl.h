@@ -1,5 +1,7 @@
 #pragma once
 
+#include "background_work.h"
+#include "connect_pipeline.h"
 #include "mavlink_address.h"
 #include "mavlink_include.h"
 #include "mavlink_parameters.h"
@@ -10,16 +12,27 @@
 #include "mavlink_mission_transfer.h"
 #include "mavlink_request_message_handler.h"
 #include "mavlink_statustext_handler.h"
+#include "message_pool.h"
+#include "message_rates.h"
 #include "request_message.h"
 #include "ardupilot_custom_mode.h"
+#include "periodic_messages.h"
 #include "ping.h"
+#include "clock_model.h"
+#include "rate_adaptation.h"
+#include "rtt_estimator.h"
 #include "timeout_handler.h"
 #include "safe_queue.h"
 #include "timesync.h"
 #include "system.h"
+#include "user_callback_queue.h"
+#include "unique_function.h"
+#include <array>
 #include <cstdint>
 #include <functional>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
@@ -29,6 +42,7 @@
 
 namespace mavsdk {
 
+class HttpLoader;
 class MavsdkImpl;
 class PluginImplBase;
 
@@ -63,6 +77,12 @@ public:
     void enable_sending_autopilot_version();
 
     void subscribe_is_connected(System::IsConnectedCallback callback);
+    void subscribe_ready(System::ReadyCallback callback);
+
+    // Requests to make once connected, which need to be answered before the
+    // system is ready, see ConnectPipeline. Plugins add these in init().
+    void add_connect_step(std::string name, ConnectPipeline::Start start, const void* cookie);
+    void remove_connect_steps(const void* cookie);
 
     void process_mavlink_message(mavlink_message_t& message);
 
@@ -76,17 +96,71 @@ public:
         const mavlink_message_handler_t& callback,
         const void* cookie);
 
+    void register_mavlink_message_handlers(
+        const std::vector<uint16_t>& msg_ids,
+        const mavlink_message_handler_t& callback,
+        const void* cookie);
+
+    // Takes a member function of object taking the decoded message, see
+    // MAVLinkMessageHandler::register_decoded().
+    template<auto Method, typename Object>
+    void register_mavlink_message_handler(Object* object, const void* cookie)
+    {
+        _message_handler.register_decoded<Method>(object, cookie);
+    }
+
     void unregister_mavlink_message_handler(uint16_t msg_id, const void* cookie);
     void unregister_all_mavlink_message_handlers(const void* cookie);
 
     void update_componentid_messages_handler(uint16_t msg_id, uint8_t cmp_id, const void* cookie);
 
+    // A received message to hold on to beyond its handler, e.g. to queue a
+    // user callback with it. While it's being dispatched, this shares the
+    // buffer it was received into instead of copying it.
+    SharedMessage share_message(const mavlink_message_t& message);
+
     void register_timeout_handler(
         const std::function<void()>& callback, double duration_s, void** cookie);
     void refresh_timeout_handler(const void* cookie);
     void unregister_timeout_handler(const void* cookie);
 
+    // Runs the queued work (params, commands, mission transfers) on the
+    // shared pool as soon as possible. Calls while the work is already
+    // scheduled or running are coalesced into one more run.
+    void schedule_work();
+
+    // Runs a task with the queued work, in the order queued, so plugins need
+    // no worker thread of their own. Tasks are not run on the thread receiving
+    // messages, so they can start mission transfers and the like.
+    void queue_work(UniqueFunction<void()> task, const void* cookie);
+
+    // Drops the tasks queued with the cookie and waits for the one running,
+    // if any. Must not be called from a task.
+    void cancel_work(const void* cookie);
+
+    // Runs a CPU heavy task, like parsing a downloaded file, on the shared
+    // background pool, see BackgroundWork. What the task returns is called
+    // with the user callbacks of this system.
+    void run_in_background(BackgroundWork::Task task, const void* cookie);
+
+    // Drops the background tasks and completions of the cookie and waits for
+    // the ones running. Must not be called from one of them.
+    void cancel_background(const void* cookie);
+
+    // The first call is within the interval or a second rather than right
+    // away, at an offset of its own for each system, see CallEveryHandler.
     void add_call_every(std::function<void()> callback, float interval_s, void** cookie);
+
+    // Sends a packed message periodically, see PeriodicMessages. The outgoing
+    // intercept callback sees it after the update hook, every time.
+    void add_periodic_message(
+        const mavlink_message_t& message,
+        double interval_s,
+        void** cookie,
+        PeriodicMessages::Update update = nullptr);
+    void set_periodic_message(const mavlink_message_t& message, const void* cookie);
+    void change_periodic_message_interval(double interval_s, const void* cookie);
+    void remove_periodic_message(const void* cookie);
     void change_call_every(float interval_s, const void* cookie);
     void reset_call_every(const void* cookie);
     void remove_call_every(const void* cookie);
@@ -101,6 +175,21 @@ public:
     make_command_ack_message(const MavlinkCommandReceiver::CommandInt& command, MAV_RESULT result);
     bool send_message(mavlink_message_t& message) override;
 
+    // Returns false if the outgoing message was dropped by an intercept callback.
+    bool intercept_outgoing_message(mavlink_message_t& message);
+
+    // The same for a batch, looking up the intercept callback only once. The
+    // messages kept are moved to the front, in order, and their number is
+    // returned.
+    std::size_t intercept_outgoing_messages(mavlink_message_t* messages, std::size_t count);
+
+    // Sends messages of several systems at once, as long as they share the
+    // connections with this one. The messages need to have been passed to
+    // intercept_outgoing_message() of their system already.
+    bool send_messages(std::vector<mavlink_message_t>& messages);
+    bool send_messages(mavlink_message_t* messages, std::size_t count);
+    bool shares_connections_with(const SystemImpl& other) const;
+
     Autopilot autopilot() const override { return _autopilot; };
 
     FlightMode to_flight_mode_from_custom_mode(uint32_t custom_mode);
@@ -159,7 +248,11 @@ public:
     MAVLinkParameters::Result set_param_int(const std::string& name, int32_t value);
     MAVLinkParameters::Result set_param_ext_float(const std::string& name, float value);
     MAVLinkParameters::Result set_param_ext_int(const std::string& name, int32_t value);
-    std::map<std::string, MAVLinkParameters::ParamValue> get_all_params();
+    MAVLinkParameters::ParamStore get_all_params();
+    MAVLinkParameters::Result set_params(const MAVLinkParameters::ParamStore& params);
+    void set_params_async(
+        const MAVLinkParameters::ParamStore& params,
+        const MAVLinkParameters::set_params_callback_t& callback);
 
     typedef std::function<void(MAVLinkParameters::Result result)> success_t;
     void set_param_float_async(
@@ -173,7 +266,7 @@ public:
 
     void provide_server_param_float(const std::string& name, float value);
     void provide_server_param_int(const std::string& name, int32_t value);
-    std::map<std::string, MAVLinkParameters::ParamValue> retrieve_all_server_params();
+    const MAVLinkParameters::ParamStore& retrieve_all_server_params() const;
 
     using SubscribeParamIntCallback = std::function<void(int)>;
     void subscribe_param_int(
@@ -270,10 +363,25 @@ public:
     typedef std::function<void(const std::string& name)> param_changed_callback_t;
     void
     register_param_changed_handler(const param_changed_callback_t& callback, const void* cookie);
+    // Only called for the param given, without comparing names for every
+    // other handler.
+    void register_param_changed_handler(
+        const std::string& name, const param_changed_callback_t& callback, const void* cookie);
     void unregister_param_changed_handler(const void* cookie);
 
+    // Called once with all params whenever the complete list was fetched.
+    void subscribe_params_changed(
+        const MAVLinkParameters::ParamsChangedCallback& callback, const void* cookie)
+    {
+        _params.subscribe_params_changed(callback, cookie);
+    }
+
     bool is_connected() const;
 
+    // Called regularly by MavsdkImpl for all systems, instead of every system
+    // having a timeout of its own to refresh on every heartbeat.
+    void check_heartbeat_timeout(uint64_t now_ns);
+
     Time& get_time() { return _time; };
     AutopilotTime& get_autopilot_time() { return _autopilot_time; };
 
@@ -283,15 +391,31 @@ public:
     void unregister_plugin(PluginImplBase* plugin_impl);
 
     void call_user_callback_located(
-        const std::string& filename, int linenumber, const std::function<void()>& func);
+        const char* filename, int linenumber, UserCallbackFunction func);
 
     void send_autopilot_version_request();
     void send_autopilot_version();
     void send_flight_information_request();
 
-    MAVLinkMissionTransfer& mission_transfer() { return _mission_transfer; };
+    // Mission transfer and FTP are created on first use, most systems never
+    // need them.
+    MAVLinkMissionTransfer& mission_transfer();
+    // Where the last mission, fence or rally points transferred are cached
+    // next to the params, empty if caching is disabled.
+    std::string mission_cache_path(uint8_t type) const;
+
+    MavlinkFtp& mavlink_ftp();
 
-    MavlinkFtp& mavlink_ftp() { return _mavlink_ftp; };
+    System::MemoryStats memory_stats();
+
+    // To be called by plugins for every request they repeat by themselves.
+    void count_background_request();
+    System::BackgroundRequestStats background_request_stats();
+
+    std::vector<System::MessageRate> message_rates() const;
+
+    std::vector<System::MessageHandlerStats> message_handler_stats() const;
+    void reset_message_handler_stats();
 
     RequestMessage& request_message() { return _request_message; };
 
@@ -310,6 +434,14 @@ public:
         uint16_t cmd_id,
         const MavlinkCommandReceiver::MavlinkCommandLongHandler& callback,
         const void* cookie);
+    void register_mavlink_command_handler_async(
+        uint16_t cmd_id,
+        const MavlinkCommandReceiver::MavlinkCommandIntAsyncHandler& callback,
+        const void* cookie);
+    void register_mavlink_command_handler_async(
+        uint16_t cmd_id,
+        const MavlinkCommandReceiver::MavlinkCommandLongAsyncHandler& callback,
+        const void* cookie);
     void unregister_mavlink_command_handler(uint16_t cmd_id, const void* cookie);
     void unregister_all_mavlink_command_handlers(const void* cookie);
 
@@ -320,8 +452,30 @@ public:
     void unregister_mavlink_request_message_handler(uint32_t message_id, const void* cookie);
     void unregister_all_mavlink_request_message_handlers(const void* cookie);
 
+    // Retransmission timeout for requests to this system, estimated from the
+    // round trip times seen, Mavsdk::timeout_s() until there are samples.
     double timeout_s() const;
 
+    // Round trip time of a request which was answered without retransmission.
+    void add_rtt_sample(double rtt_s);
+    const RttEstimator& rtt_estimator() const { return _rtt_estimator; }
+
+    // Quality of the link to this system, for RateAdaptation.
+    RateAdaptation::Sample link_sample() const;
+
+    // Maps the clock of this system to the local steady clock, from TIMESYNC.
+    ClockModel& clock_model() { return _clock_model; }
+    std::optional<uint64_t> to_local_time_us(uint64_t remote_us) const;
+
+    std::string get_param_cache_directory() const;
+    double get_request_message_cache_ttl_s() const;
+    bool get_low_memory() const;
+
+    HttpLoader& http_loader();
+
+    // Hex string of the UID reported by the autopilot, empty while unknown.
+    std::string get_uid_string() const;
+
     // Autopilot version data
     void add_capabilities(uint64_t capabilities);
     void set_flight_sw_version(uint32_t flight_sw_version);
@@ -343,7 +497,8 @@ private:
     static bool is_autopilot(uint8_t comp_id);
     static bool is_camera(uint8_t comp_id);
 
-    void request_autopilot_version();
+    void request_autopilot_version(ConnectPipeline::Done done);
+    void process_ready(const System::Ready& ready);
 
     void process_heartbeat(const mavlink_message_t& message);
     void process_autopilot_version(const mavlink_message_t& message);
@@ -358,7 +513,9 @@ private:
     static std::string component_name(uint8_t component_id);
     static System::ComponentType component_type(uint8_t component_id);
 
-    void system_thread();
+    void run_work();
+    void do_work();
+    void run_queued_work();
 
     std::pair<MavlinkCommandSender::Result, MavlinkCommandSender::CommandLong>
     make_command_flight_mode(FlightMode mode, uint8_t component_id);
@@ -395,9 +552,9 @@ private:
     AutopilotTime _autopilot_time{};
 
     // Needs to be before anything else because they can depend on it.
-    MAVLinkMessageHandler _message_handler{};
+    MAVLinkMessageHandler _message_handler;
 
-    MavlinkStatustextHandler _statustext_handler{};
+    MavlinkStatustextHandler _statustext_handler{_time};
 
     struct StatustextCallback {
         std::function<void(const MavlinkStatustextHandler::Statustext&)> callback;
@@ -405,6 +562,7 @@ private:
     };
     std::mutex _statustext_handler_callbacks_mutex{};
     std::vector<StatustextCallback> _statustext_handler_callbacks;
+    void call_statustext_handlers(const MavlinkStatustextHandler::Statustext& statustext);
 
     std::atomic<bool> _armed{false};
     std::atomic<bool> _hitl_enabled{false};
@@ -414,20 +572,40 @@ private:
 
     MavsdkImpl& _parent;
 
-    std::thread* _system_thread{nullptr};
-    std::atomic<bool> _should_exit{false};
+    std::mutex _work_mutex{};
+    std::condition_variable _work_cv{};
+    bool _work_scheduled{false};
+    bool _work_pending{false};
+    bool _should_exit{false};
+    void* _work_tick_cookie{nullptr};
+    std::deque<std::pair<const void*, UniqueFunction<void()>>> _work_tasks{};
+    const void* _running_work_cookie{nullptr};
+    dl_time_t _last_ping_time{};
+
+    // Most work is triggered by new requests, responses or timeouts. The
+    // tick catches everything else, e.g. sending pings and timesync.
+    static constexpr double WORK_TICK_INTERVAL_S = 1.0;
 
-    static constexpr double HEARTBEAT_TIMEOUT_S = 3.0;
+    static constexpr uint64_t HEARTBEAT_TIMEOUT_NS = 3000000000;
 
     std::mutex _connection_mutex{};
     std::atomic<bool> _connected{false};
     System::IsConnectedCallback _is_connected_callback{nullptr};
-    void* _heartbeat_timeout_cookie = nullptr;
+    System::ReadyCallback _ready_callback{nullptr};
+
+    // Monotonic time of the last heartbeat of any component, see MessageLatency::now_ns().
+    std::atomic<uint64_t> _last_heartbeat_ns{0};
+
+    // What the last heartbeat said, so repeated ones don't update anything.
+    std::atomic<uint64_t> _last_heartbeat_state{UINT64_MAX};
 
     std::atomic<bool> _autopilot_version_pending{false};
 
     static constexpr double _ping_interval_s = 5.0;
 
+    RttEstimator _rtt_estimator{};
+    ClockModel _clock_model{};
+
     MAVLinkParameters _params;
     MavlinkCommandSender _command_sender;
     MavlinkCommandReceiver _command_receiver;
@@ -436,9 +614,23 @@ private:
     Timesync _timesync;
     Ping _ping;
 
-    MAVLinkMissionTransfer _mission_transfer;
+    void drop_old_background_requests();
+    static constexpr double BACKGROUND_REQUEST_WINDOW_S = 60.0;
+    std::mutex _background_requests_mutex{};
+    uint64_t _background_requests{0};
+    std::deque<dl_time_t> _background_request_times{};
+
+    MessageRates _message_rates{};
+
+    std::mutex _lazy_components_mutex{};
+    std::unique_ptr<MAVLinkMissionTransfer> _mission_transfer{};
+    std::atomic<bool> _mission_int_supported{true};
     RequestMessage _request_message;
-    MavlinkFtp _mavlink_ftp;
+
+    // Don't send more requests at once than a slow link can take.
+    static constexpr std::size_t MAX_CONNECT_REQUESTS_IN_FLIGHT = 4;
+    ConnectPipeline _connect_pipeline;
+    std::unique_ptr<MavlinkFtp> _mavlink_ftp{};
 
     std::mutex _plugin_impls_mutex{};
     std::vector<PluginImplBase*> _plugin_impls{};
@@ -446,11 +638,21 @@ private:
     // We used set to maintain unique component ids
     std::unordered_set<uint8_t> _components{};
 
+    // The components which were added, checked for every message received
+    // without taking a lock.
+    std::array<std::atomic<uint64_t>, 4> _known_components{};
+
     std::mutex _param_changed_callbacks_mutex{};
     std::unordered_map<const void*, param_changed_callback_t> _param_changed_callbacks{};
+    std::unordered_map<std::string, std::vector<std::pair<const void*, param_changed_callback_t>>>
+        _param_changed_callbacks_by_name{};
 
+    // Messages can be received on multiple connections at the same time.
+    std::mutex _incoming_messages_intercept_mutex{};
     std::function<bool(mavlink_message_t&)> _incoming_messages_intercept_callback{nullptr};
-    std::function<bool(mavlink_message_t&)> _outgoing_messages_intercept_callback{nullptr};
+    // Swapped atomically, as it's looked up on every send from any thread.
+    std::shared_ptr<const std::function<bool(mavlink_message_t&)>>
+        _outgoing_messages_intercept_callback{};
 
     MAV_TYPE _vehicle_type{MAV_TYPE::MAV_TYPE_GENERIC};
 
@@ -462,6 +664,8 @@ private:
 
     std::atomic<bool> _should_send_autopilot_version{false};
 
+    std::atomic<uint64_t> _uid{0};
+
     std::mutex _mavlink_ftp_files_mutex{};
     std::unordered_map<std::string, std::string> _mavlink_ftp_files{};
 };
@@ -1,4 +1,5 @@
 #include "tcp_connection.h"
+#include "io_reactor.h"
 #include "log.h"
 
 #ifdef WINDOWS
@@ -10,6 +11,8 @@
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <netinet/tcp.h>
 #include <unistd.h> // for close()
 #endif
 
@@ -53,7 +56,16 @@ ConnectionResult TcpConnection::start()
         return ret;
     }
 
-    start_recv_thread();
+    _write_combiner = std::make_unique<WriteCombiner>(
+        [this](const uint8_t* data, std::size_t length) { return send_bytes(data, length); },
+        _write_coalescing_delay_s,
+        WriteCombiner::DEFAULT_FLUSH_BYTES,
+        _thread_setup);
+
+    start_send_queue(
+        [this](const uint8_t* data, std::size_t length) { return send_bytes(data, length); });
+
+    start_receiving();
 
     return ConnectionResult::Success;
 }
@@ -77,6 +89,8 @@ ConnectionResult TcpConnection::setup_port()
         return ConnectionResult::SocketError;
     }
 
+    apply_no_delay();
+
     struct sockaddr_in remote_addr {};
     remote_addr.sin_family = AF_INET;
     remote_addr.sin_port = htons(_remote_port_number);
@@ -93,14 +107,72 @@ ConnectionResult TcpConnection::setup_port()
     return ConnectionResult::Success;
 }
 
-void TcpConnection::start_recv_thread()
+void TcpConnection::apply_no_delay()
 {
-    _recv_thread = std::make_unique<std::thread>(&TcpConnection::receive, this);
+    if (!_no_delay) {
+        return;
+    }
+
+    const int enable = 1;
+    if (setsockopt(
+            _socket_fd,
+            IPPROTO_TCP,
+            TCP_NODELAY,
+            reinterpret_cast<const char*>(&enable),
+            sizeof(enable)) != 0) {
+        LogWarn() << "Could not set TCP_NODELAY: " << GET_ERROR(errno);
+    }
+}
+
+void TcpConnection::start_receiving()
+{
+#if defined(LINUX)
+    std::lock_guard<std::mutex> lock(_mutex);
+    _reactor_handle = IoReactor::instance().add_fd(
+        _socket_fd, IoReactor::Readable, [this](unsigned) { receive_available(); });
+#else
+    _recv_thread = std::make_unique<NativeThread>(
+        _thread_setup.settings.stack_size_bytes, [this]() { receive(); });
+#endif
 }
 
 ConnectionResult TcpConnection::stop()
 {
-    _should_exit = true;
+    stop_link_emulation();
+
+#if defined(LINUX)
+    {
+        uint64_t reactor_handle;
+        uint64_t reconnect_handle;
+        {
+            // Once _should_exit is set, the callbacks don't add anything new
+            // to the reactor.
+            std::lock_guard<std::mutex> lock(_mutex);
+            _should_exit = true;
+            reactor_handle = _reactor_handle;
+            reconnect_handle = _reconnect_handle;
+            _reactor_handle = 0;
+            _reconnect_handle = 0;
+        }
+        // This waits for callbacks still running, so we can't hold the lock.
+        if (reactor_handle != 0) {
+            IoReactor::instance().remove(reactor_handle);
+        }
+        if (reconnect_handle != 0) {
+            IoReactor::instance().remove(reconnect_handle);
+        }
+    }
+#else
+    {
+        std::lock_guard<std::mutex> lock(_exit_mutex);
+        _should_exit = true;
+    }
+    _exit_cv.notify_all();
+#endif
+
+    // Sends what is still queued or buffered while the socket is still open.
+    stop_send_queue();
+    _write_combiner.reset();
 
 #ifndef WINDOWS
     // This should interrupt a recv/recvfrom call.
@@ -116,10 +188,12 @@ ConnectionResult TcpConnection::stop()
     WSACleanup();
 #endif
 
+#if !defined(LINUX)
     if (_recv_thread) {
         _recv_thread->join();
         _recv_thread.reset();
     }
+#endif
 
     // We need to stop this after stopping the receive thread, otherwise
     // it can happen that we interfere with the parsing of a message.
@@ -128,7 +202,7 @@ ConnectionResult TcpConnection::stop()
     return ConnectionResult::Success;
 }
 
-bool TcpConnection::send_message(const mavlink_message_t& message)
+bool TcpConnection::can_send() const
 {
     if (!_is_ok) {
         return false;
@@ -144,6 +218,54 @@ bool TcpConnection::send_message(const mavlink_message_t& message)
         return false;
     }
 
+    return true;
+}
+
+bool TcpConnection::send_frame(const MavlinkFrame& frame)
+{
+    if (!can_send()) {
+        return false;
+    }
+
+    // TODO: remove this assert again
+    assert(frame.length <= MAVLINK_MAX_PACKET_LEN);
+
+    if (_send_queue) {
+        return _send_queue->push(frame.buffer, frame.length) == SendQueue::Result::Queued;
+    }
+
+    if (!_write_combiner) {
+        return send_bytes(frame.buffer, frame.length);
+    }
+    return _write_combiner->write(frame.buffer, frame.length);
+}
+
+bool TcpConnection::send_frames(const std::vector<const MavlinkFrame*>& frames)
+{
+    if (!can_send()) {
+        return false;
+    }
+
+    // Queued frames are written together anyway.
+    if (_send_queue || !_write_combiner) {
+        return Connection::send_frames(frames);
+    }
+
+    // The whole batch goes out in as few sends as possible.
+    bool send_successful = true;
+    for (const auto* frame : frames) {
+        if (!_write_combiner->append(frame->buffer, frame->length)) {
+            send_successful = false;
+        }
+    }
+    if (!_write_combiner->flush()) {
+        send_successful = false;
+    }
+    return send_successful;
+}
+
+bool TcpConnection::send_bytes(const uint8_t* data, std::size_t length)
+{
     struct sockaddr_in dest_addr {};
     dest_addr.sin_family = AF_INET;
 
@@ -151,12 +273,6 @@ bool TcpConnection::send_message(const mavlink_message_t& message)
 
     dest_addr.sin_port = htons(_remote_port_number);
 
-    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-    uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
-
-    // TODO: remove this assert again
-    assert(buffer_len <= MAVLINK_MAX_PACKET_LEN);
-
 #if !defined(MSG_NOSIGNAL)
     auto flags = 0;
 #else
@@ -165,13 +281,13 @@ bool TcpConnection::send_message(const mavlink_message_t& message)
 
     const auto send_len = sendto(
         _socket_fd,
-        reinterpret_cast<char*>(buffer),
-        buffer_len,
+        reinterpret_cast<const char*>(data),
+        length,
         flags,
         reinterpret_cast<const sockaddr*>(&dest_addr),
         sizeof(dest_addr));
 
-    if (send_len != buffer_len) {
+    if (send_len != static_cast<decltype(send_len)>(length)) {
         LogErr() << "sendto failure: " << GET_ERROR(errno);
         _is_ok = false;
         return false;
@@ -179,15 +295,135 @@ bool TcpConnection::send_message(const mavlink_message_t& message)
     return true;
 }
 
+#if defined(LINUX)
+void TcpConnection::receive_available()
+{
+    // Enough for MTU 1500 bytes.
+    char buffer[2048];
+
+    const auto recv_len = recv(_socket_fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+    if (recv_len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return;
+    }
+
+    if (recv_len <= 0) {
+        // The other side closed the connection or something went wrong.
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_should_exit) {
+            return;
+        }
+        LogErr() << "TCP receive error, trying to reconnect...";
+        _is_ok = false;
+        IoReactor::instance().remove(_reactor_handle);
+        _reactor_handle = 0;
+        close(_socket_fd);
+        reconnect();
+        return;
+    }
+
+    _mavlink_receiver->set_new_datagram(buffer, static_cast<int>(recv_len));
+
+    // Parse all mavlink messages in one data packet. Once exhausted, we'll exit while.
+    while (_mavlink_receiver->parse_message()) {
+        receive_message(_mavlink_receiver->get_last_message(), this);
+    }
+}
+
+void TcpConnection::reconnect()
+{
+    // Needs to be called with _mutex locked, on the reactor thread.
+    _reconnect_handle = 0;
+
+    struct sockaddr_in remote_addr {};
+    remote_addr.sin_family = AF_INET;
+    remote_addr.sin_port = htons(_remote_port_number);
+    remote_addr.sin_addr.s_addr = inet_addr(_remote_ip.c_str());
+
+    // Connect without blocking, so the reactor can carry on with the other
+    // connections in the meantime.
+    _socket_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (_socket_fd < 0) {
+        LogErr() << "socket error" << GET_ERROR(errno);
+        retry_reconnect_later();
+        return;
+    }
+
+    apply_no_delay();
+
+    const int result =
+        connect(_socket_fd, reinterpret_cast<sockaddr*>(&remote_addr), sizeof(remote_addr));
+    if (result == 0) {
+        connected();
+    } else if (errno == EINPROGRESS) {
+        _reactor_handle = IoReactor::instance().add_fd(
+            _socket_fd, IoReactor::Writable, [this](unsigned) { connect_done(); });
+    } else {
+        close(_socket_fd);
+        retry_reconnect_later();
+    }
+}
+
+void TcpConnection::connect_done()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_should_exit) {
+        return;
+    }
+
+    IoReactor::instance().remove(_reactor_handle);
+    _reactor_handle = 0;
+
+    int error = 0;
+    socklen_t error_len = sizeof(error);
+    if (getsockopt(_socket_fd, SOL_SOCKET, SO_ERROR, &error, &error_len) != 0 || error != 0) {
+        close(_socket_fd);
+        retry_reconnect_later();
+        return;
+    }
+
+    connected();
+}
+
+void TcpConnection::connected()
+{
+    // Needs to be called with _mutex locked. Sending expects a blocking socket.
+    const int flags = fcntl(_socket_fd, F_GETFL, 0);
+    fcntl(_socket_fd, F_SETFL, flags & ~O_NONBLOCK);
+
+    LogInfo() << "TCP reconnected";
+    _is_ok = true;
+    _reactor_handle = IoReactor::instance().add_fd(
+        _socket_fd, IoReactor::Readable, [this](unsigned) { receive_available(); });
+}
+
+void TcpConnection::retry_reconnect_later()
+{
+    // Needs to be called with _mutex locked.
+    _reconnect_handle = IoReactor::instance().add_timer(RECONNECT_INTERVAL_S, [this]() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_should_exit) {
+            reconnect();
+        }
+    });
+}
+#else
 void TcpConnection::receive()
 {
+    _thread_setup.apply();
+
     // Enough for MTU 1500 bytes.
     char buffer[2048];
 
     while (!_should_exit) {
         if (!_is_ok) {
             LogErr() << "TCP receive error, trying to reconnect...";
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+            std::unique_lock<std::mutex> lock(_exit_mutex);
+            if (_exit_cv.wait_for(
+                    lock, std::chrono::seconds(1), [this]() { return _should_exit.load(); })) {
+                break;
+            }
+            lock.unlock();
             setup_port();
         }
 
@@ -218,4 +454,6 @@ void TcpConnection::receive()
     }
 }
 
+#endif
+
 } // namespace mavsdk
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
 #include <mutex>
 #include <memory>
 #include <thread>
 #include "connection.h"
+#include "write_combiner.h"
 #include <sys/types.h>
 #ifndef WINDOWS
 #include <netdb.h>
@@ -28,7 +30,16 @@ public:
     ConnectionResult start() override;
     ConnectionResult stop() override;
 
-    bool send_message(const mavlink_message_t& message) override;
+    bool send_frame(const MavlinkFrame& frame) override;
+    bool send_frames(const std::vector<const MavlinkFrame*>& frames) override;
+
+    // Frames sent within the delay are combined into one send, see
+    // WriteCombiner. Needs to be set before start().
+    void set_write_coalescing_delay_s(double delay_s) { _write_coalescing_delay_s = delay_s; }
+
+    // Disables Nagle's algorithm, so small frames such as setpoints are not
+    // held back waiting for acks. Needs to be set before start().
+    void set_no_delay(bool no_delay) { _no_delay = no_delay; }
 
     // Non-copyable
     TcpConnection(const TcpConnection&) = delete;
@@ -36,8 +47,19 @@ public:
 
 private:
     ConnectionResult setup_port();
-    void start_recv_thread();
+    void apply_no_delay();
+    void start_receiving();
+    bool can_send() const;
+    bool send_bytes(const uint8_t* data, std::size_t length);
+#if defined(LINUX)
+    void receive_available();
+    void reconnect();
+    void connect_done();
+    void connected();
+    void retry_reconnect_later();
+#else
     void receive();
+#endif
 
     std::string _remote_ip = {};
     int _remote_port_number;
@@ -45,9 +67,23 @@ private:
     std::mutex _mutex = {};
     int _socket_fd = -1;
 
-    std::unique_ptr<std::thread> _recv_thread{};
+#if defined(LINUX)
+    // Connections are served by the shared IoReactor instead of a thread each.
+    uint64_t _reactor_handle{0};
+    uint64_t _reconnect_handle{0};
+    static constexpr double RECONNECT_INTERVAL_S = 1.0;
+#else
+    std::unique_ptr<NativeThread> _recv_thread{};
+    // Wakes up the receive thread waiting to reconnect when stopping.
+    std::mutex _exit_mutex{};
+    std::condition_variable _exit_cv{};
+#endif
     std::atomic_bool _should_exit;
     std::atomic_bool _is_ok{false};
+
+    double _write_coalescing_delay_s{0.0};
+    bool _no_delay{false};
+    std::unique_ptr<WriteCombiner> _write_combiner{};
 };
 
 } // namespace mavsdk
@@ -0,0 +1,388 @@
+#include "tcp_server_connection.h"
+#include "io_reactor.h"
+#include "log.h"
+
+#if defined(LINUX)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include <utility>
+
+namespace mavsdk {
+
+TcpServerConnection::TcpServerConnection(
+    Connection::receiver_callback_t receiver_callback,
+    std::string local_ip,
+    int local_port,
+    ForwardingOption forwarding_option) :
+    Connection(std::move(receiver_callback), forwarding_option),
+    _local_ip(std::move(local_ip)),
+    _local_port_number(local_port)
+{}
+
+TcpServerConnection::~TcpServerConnection()
+{
+    // If no one explicitly called stop before, we should at least do it.
+    stop();
+}
+
+std::size_t TcpServerConnection::clients_count() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _clients.size();
+}
+
+#if defined(LINUX)
+ConnectionResult TcpServerConnection::start()
+{
+    // The listening socket comes first, so nothing is left to clean up but
+    // the socket itself if it can't be set up.
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(_local_port_number);
+    if (inet_pton(AF_INET, _local_ip.c_str(), &addr.sin_addr) != 1) {
+        LogErr() << "Invalid IP to listen on: " << _local_ip;
+        return ConnectionResult::BindError;
+    }
+
+    _listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_listen_fd < 0) {
+        LogErr() << "socket error: " << strerror(errno);
+        return ConnectionResult::SocketError;
+    }
+
+    // So we can listen again right away after a restart.
+    const int enable = 1;
+    setsockopt(_listen_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    if (bind(_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        LogErr() << "bind error: " << strerror(errno);
+        close(_listen_fd);
+        _listen_fd = -1;
+        return ConnectionResult::BindError;
+    }
+
+    if (listen(_listen_fd, SOMAXCONN) != 0) {
+        LogErr() << "listen error: " << strerror(errno);
+        close(_listen_fd);
+        _listen_fd = -1;
+        return ConnectionResult::SocketError;
+    }
+
+    if (!start_mavlink_receiver()) {
+        close(_listen_fd);
+        _listen_fd = -1;
+        return ConnectionResult::ConnectionsExhausted;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _should_exit = false;
+    _listen_handle = IoReactor::instance().add_fd(
+        _listen_fd, IoReactor::Readable, [this](unsigned) { accept_clients(); });
+    if (_listen_handle == 0) {
+        close(_listen_fd);
+        _listen_fd = -1;
+        stop_mavlink_receiver();
+        return ConnectionResult::ConnectionError;
+    }
+
+    LogInfo() << "Waiting for TCP clients on " << _local_ip << ":" << _local_port_number;
+    return ConnectionResult::Success;
+}
+
+ConnectionResult TcpServerConnection::stop()
+{
+    stop_link_emulation();
+
+    uint64_t listen_handle;
+    std::map<uint64_t, std::shared_ptr<Client>> clients;
+    {
+        // Once _should_exit is set, the callbacks don't add or remove
+        // clients anymore.
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_exit = true;
+        listen_handle = _listen_handle;
+        _listen_handle = 0;
+        clients.swap(_clients);
+    }
+
+    // This waits for callbacks still running, so we can't hold the lock.
+    if (listen_handle != 0) {
+        IoReactor::instance().remove(listen_handle);
+    }
+    for (auto& [id, client] : clients) {
+        IoReactor::instance().remove(client->reactor_handle);
+        close(client->fd);
+    }
+
+    if (_listen_fd != -1) {
+        close(_listen_fd);
+        _listen_fd = -1;
+    }
+
+    stop_mavlink_receiver();
+
+    return ConnectionResult::Success;
+}
+
+bool TcpServerConnection::send_frame(const MavlinkFrame& frame)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_clients.empty()) {
+        return false;
+    }
+
+    bool send_successful = true;
+    for (auto& [id, client] : _clients) {
+        if (client->failed) {
+            send_successful = false;
+            continue;
+        }
+        append_locked(*client, frame.buffer, frame.length);
+        if (!flush_locked(*client)) {
+            send_successful = false;
+        }
+    }
+    return send_successful;
+}
+
+bool TcpServerConnection::send_frames(const std::vector<const MavlinkFrame*>& frames)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_clients.empty()) {
+        return false;
+    }
+
+    // The whole batch goes out to each client in as few sends as possible.
+    bool send_successful = true;
+    for (auto& [id, client] : _clients) {
+        if (client->failed) {
+            send_successful = false;
+            continue;
+        }
+        for (const auto* frame : frames) {
+            append_locked(*client, frame->buffer, frame->length);
+        }
+        if (!flush_locked(*client)) {
+            send_successful = false;
+        }
+    }
+    return send_successful;
+}
+
+void TcpServerConnection::append_locked(Client& client, const uint8_t* data, std::size_t length)
+{
+    // Only whole frames are dropped, so the stream stays parseable.
+    const std::size_t pending = client.send_buffer.size() - client.send_offset;
+    if (pending + length > _max_client_buffer_bytes) {
+        if (!client.warned_dropping) {
+            LogWarn() << "TCP client " << client.id << " does not keep up, dropping frames";
+            client.warned_dropping = true;
+        }
+        ++_dropped_frames;
+        return;
+    }
+
+    client.send_buffer.insert(client.send_buffer.end(), data, data + length);
+}
+
+bool TcpServerConnection::flush_locked(Client& client)
+{
+    while (client.send_offset < client.send_buffer.size()) {
+        const auto send_len = ::send(
+            client.fd,
+            client.send_buffer.data() + client.send_offset,
+            client.send_buffer.size() - client.send_offset,
+            MSG_DONTWAIT | MSG_NOSIGNAL);
+
+        if (send_len > 0) {
+            client.send_offset += static_cast<std::size_t>(send_len);
+            continue;
+        }
+        if (send_len < 0 && errno == EINTR) {
+            continue;
+        }
+        if (send_len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+
+        // The reactor sees the shutdown and removes the client.
+        LogErr() << "TCP send to client " << client.id << " failed: " << strerror(errno);
+        client.failed = true;
+        shutdown(client.fd, SHUT_RDWR);
+        return false;
+    }
+
+    const bool all_sent = client.send_offset == client.send_buffer.size();
+    if (all_sent) {
+        client.send_buffer.clear();
+        client.send_offset = 0;
+    } else if (client.send_offset > 0) {
+        client.send_buffer.erase(
+            client.send_buffer.begin(),
+            client.send_buffer.begin() + static_cast<std::ptrdiff_t>(client.send_offset));
+        client.send_offset = 0;
+    }
+
+    // Only while something is left over do we need to know when the
+    // socket can take more, otherwise it would report writable all the time.
+    if (all_sent == client.waiting_for_writable) {
+        client.waiting_for_writable = !all_sent;
+        IoReactor::instance().modify(
+            client.reactor_handle,
+            all_sent ? IoReactor::Readable : (IoReactor::Readable | IoReactor::Writable));
+    }
+    return true;
+}
+
+void TcpServerConnection::accept_clients()
+{
+    while (true) {
+        struct sockaddr_in addr {};
+        socklen_t addr_len = sizeof(addr);
+        const int fd = accept4(
+            _listen_fd,
+            reinterpret_cast<sockaddr*>(&addr),
+            &addr_len,
+            SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LogErr() << "accept error: " << strerror(errno);
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_should_exit) {
+            close(fd);
+            return;
+        }
+
+        if (_clients.size() >= MAX_CLIENTS) {
+            LogWarn() << "Too many TCP clients, rejecting " << inet_ntoa(addr.sin_addr);
+            close(fd);
+            continue;
+        }
+
+        if (_no_delay) {
+            const int enable = 1;
+            if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable)) != 0) {
+                LogWarn() << "Could not set TCP_NODELAY: " << strerror(errno);
+            }
+        }
+
+        auto client = std::make_shared<Client>();
+        client->id = _next_client_id++;
+        client->fd = fd;
+        // Each client sends a stream of its own, so it needs its own parser.
+        client->receiver = std::make_unique<MAVLinkReceiver>(&_link_stats);
+        client->reactor_handle = IoReactor::instance().add_fd(
+            fd, IoReactor::Readable, [this, client](unsigned events) {
+                client_ready(client, events);
+            });
+        if (client->reactor_handle == 0) {
+            close(fd);
+            continue;
+        }
+
+        LogInfo() << "TCP client " << client->id << " connected from "
+                  << inet_ntoa(addr.sin_addr) << ":" << ntohs(addr.sin_port);
+        _clients[client->id] = std::move(client);
+    }
+}
+
+void TcpServerConnection::client_ready(const std::shared_ptr<Client>& client, unsigned events)
+{
+    bool keep = (events & IoReactor::Error) == 0;
+
+    if (keep && (events & IoReactor::Readable)) {
+        keep = receive_available(*client);
+    }
+
+    if (keep && (events & IoReactor::Writable)) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        keep = !client->failed && flush_locked(*client);
+    }
+
+    if (!keep) {
+        remove_client(client);
+    }
+}
+
+bool TcpServerConnection::receive_available(Client& client)
+{
+    // Enough for MTU 1500 bytes.
+    char buffer[2048];
+
+    const auto recv_len = recv(client.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+    if (recv_len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return true;
+    }
+
+    if (recv_len <= 0) {
+        // The client closed the connection or something went wrong.
+        return false;
+    }
+
+    // Only the reactor thread uses the receiver, and we must not hold the
+    // lock here, the callback might send.
+    client.receiver->set_new_datagram(buffer, static_cast<unsigned>(recv_len));
+
+    // Parse all mavlink messages in one data packet. Once exhausted, we'll exit while.
+    while (client.receiver->parse_message()) {
+        receive_message(
+            client.receiver->get_last_message(), this, client.receiver->datagram_time_ns());
+    }
+    return true;
+}
+
+void TcpServerConnection::remove_client(const std::shared_ptr<Client>& client)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_should_exit || _clients.erase(client->id) == 0) {
+        // Already taken care of by stop().
+        return;
+    }
+
+    // Called on the reactor thread, so this doesn't wait.
+    IoReactor::instance().remove(client->reactor_handle);
+    close(client->fd);
+    LogInfo() << "TCP client " << client->id << " disconnected";
+}
+#else
+ConnectionResult TcpServerConnection::start()
+{
+    LogErr() << "Listening for TCP clients is only supported on Linux";
+    return ConnectionResult::NotImplemented;
+}
+
+ConnectionResult TcpServerConnection::stop()
+{
+    return ConnectionResult::Success;
+}
+
+bool TcpServerConnection::send_frame(const MavlinkFrame&)
+{
+    return false;
+}
+
+bool TcpServerConnection::send_frames(const std::vector<const MavlinkFrame*>&)
+{
+    return false;
+}
+#endif
+
+} // namespace mavsdk
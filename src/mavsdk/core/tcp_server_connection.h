@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "connection.h"
+
+namespace mavsdk {
+
+// Listens on a port and serves any number of TCP clients, e.g. several
+// ground stations and tools talking to a companion computer at once.
+//
+// All clients are served by the shared IoReactor. Clients never block the
+// sender: what a client can't take right away is buffered for it, and once
+// its buffer is full, further frames for that client are dropped, so one
+// slow client does not hold up the others.
+class TcpServerConnection : public Connection {
+public:
+    static constexpr std::size_t DEFAULT_MAX_CLIENT_BUFFER_BYTES = 64 * 1024;
+    static constexpr std::size_t MAX_CLIENTS = 32;
+
+    explicit TcpServerConnection(
+        Connection::receiver_callback_t receiver_callback,
+        std::string local_ip,
+        int local_port,
+        ForwardingOption forwarding_option = ForwardingOption::ForwardingOff);
+    ~TcpServerConnection() override;
+    ConnectionResult start() override;
+    ConnectionResult stop() override;
+
+    // Sent to all clients connected. Fails if there are none or if a
+    // client's socket failed, frames dropped for slow clients don't count.
+    bool send_frame(const MavlinkFrame& frame) override;
+    bool send_frames(const std::vector<const MavlinkFrame*>& frames) override;
+
+    // Disables Nagle's algorithm on the clients' sockets. Needs to be set
+    // before start().
+    void set_no_delay(bool no_delay) { _no_delay = no_delay; }
+
+    // How much is buffered for a client which doesn't keep up before frames
+    // for it are dropped. Needs to be set before start().
+    void set_max_client_buffer_bytes(std::size_t bytes) { _max_client_buffer_bytes = bytes; }
+
+    [[nodiscard]] std::size_t clients_count() const;
+
+    // Frames dropped for clients which didn't keep up, summed over all of them.
+    [[nodiscard]] uint64_t dropped_frames() const { return _dropped_frames; }
+
+    // Non-copyable
+    TcpServerConnection(const TcpServerConnection&) = delete;
+    const TcpServerConnection& operator=(const TcpServerConnection&) = delete;
+
+private:
+    struct Client {
+        uint64_t id{0};
+        int fd{-1};
+        uint64_t reactor_handle{0};
+        std::unique_ptr<MAVLinkReceiver> receiver{};
+
+        // Not sent yet, starting at send_offset.
+        std::vector<uint8_t> send_buffer{};
+        std::size_t send_offset{0};
+        bool waiting_for_writable{false};
+        bool warned_dropping{false};
+        bool failed{false};
+    };
+
+#if defined(LINUX)
+    void accept_clients();
+    void client_ready(const std::shared_ptr<Client>& client, unsigned events);
+    bool receive_available(Client& client);
+    void remove_client(const std::shared_ptr<Client>& client);
+    void append_locked(Client& client, const uint8_t* data, std::size_t length);
+    bool flush_locked(Client& client);
+#endif
+
+    std::string _local_ip;
+    int _local_port_number;
+
+    mutable std::mutex _mutex{};
+    int _listen_fd{-1};
+    uint64_t _listen_handle{0};
+    std::map<uint64_t, std::shared_ptr<Client>> _clients{};
+    uint64_t _next_client_id{1};
+    bool _should_exit{false};
+
+    bool _no_delay{false};
+    std::size_t _max_client_buffer_bytes{DEFAULT_MAX_CLIENT_BUFFER_BYTES};
+    std::atomic<uint64_t> _dropped_frames{0};
+};
+
+} // namespace mavsdk
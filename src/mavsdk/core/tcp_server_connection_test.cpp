@@ -0,0 +1,185 @@
+#if defined(LINUX)
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "tcp_server_connection.h"
+
+using namespace mavsdk;
+
+namespace {
+
+constexpr int local_port = 24581;
+
+// A ground station connecting to us.
+class Client {
+public:
+    explicit Client(int receive_buffer_bytes = 0)
+    {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (receive_buffer_bytes > 0) {
+            // Needs to be set before connecting to limit the window.
+            setsockopt(
+                _fd,
+                SOL_SOCKET,
+                SO_RCVBUF,
+                &receive_buffer_bytes,
+                sizeof(receive_buffer_bytes));
+        }
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(local_port);
+        _connected = connect(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+
+        timeval timeout{0, 200000};
+        setsockopt(_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    ~Client() { close(_fd); }
+
+    bool connected() const { return _connected; }
+
+    void send_heartbeat(uint8_t sysid)
+    {
+        mavlink_message_t message;
+        mavlink_msg_heartbeat_pack(
+            sysid, MAV_COMP_ID_AUTOPILOT1, &message, MAV_TYPE_QUADROTOR, 0, 0, 0, 0);
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const auto length = mavlink_msg_to_send_buffer(buffer, &message);
+        EXPECT_EQ(send(_fd, buffer, length, 0), length);
+    }
+
+    // Bytes received until nothing comes anymore.
+    std::size_t drain()
+    {
+        std::size_t total = 0;
+        uint8_t buffer[4096];
+        ssize_t len;
+        while ((len = recv(_fd, buffer, sizeof(buffer), 0)) > 0) {
+            total += static_cast<std::size_t>(len);
+        }
+        return total;
+    }
+
+private:
+    int _fd{-1};
+    bool _connected{false};
+};
+
+MavlinkFrame heartbeat_frame()
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        245, MAV_COMP_ID_MISSIONPLANNER, &message, MAV_TYPE_GCS, 0, 0, 0, 0);
+    return MavlinkFrame{message};
+}
+
+bool wait_for(const std::function<bool()>& condition)
+{
+    for (int i = 0; i < 100; ++i) {
+        if (condition()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(TcpServerConnection, ServesSeveralClients)
+{
+    std::atomic<int> received{0};
+    TcpServerConnection connection(
+        [&](mavlink_message_t&, Connection*) { ++received; }, "127.0.0.1", local_port);
+    ASSERT_EQ(connection.start(), ConnectionResult::Success);
+
+    EXPECT_FALSE(connection.send_frame(heartbeat_frame()));
+
+    auto first = std::make_unique<Client>();
+    Client second;
+    ASSERT_TRUE(first->connected());
+    ASSERT_TRUE(second.connected());
+    ASSERT_TRUE(wait_for([&]() { return connection.clients_count() == 2; }));
+
+    first->send_heartbeat(1);
+    second.send_heartbeat(2);
+    ASSERT_TRUE(wait_for([&]() { return received == 2; }));
+
+    const auto frame = heartbeat_frame();
+    EXPECT_TRUE(connection.send_frame(frame));
+    EXPECT_EQ(first->drain(), frame.length);
+    EXPECT_EQ(second.drain(), frame.length);
+
+    first.reset();
+    EXPECT_TRUE(wait_for([&]() { return connection.clients_count() == 1; }));
+
+    connection.stop();
+}
+
+TEST(TcpServerConnection, SlowClientDoesNotHoldUpOthers)
+{
+    TcpServerConnection connection([](mavlink_message_t&, Connection*) {}, "127.0.0.1", local_port);
+    connection.set_max_client_buffer_bytes(4096);
+    ASSERT_EQ(connection.start(), ConnectionResult::Success);
+
+    // Never reads anything.
+    Client slow(4096);
+    Client fast;
+    ASSERT_TRUE(slow.connected());
+    ASSERT_TRUE(fast.connected());
+    ASSERT_TRUE(wait_for([&]() { return connection.clients_count() == 2; }));
+
+    std::atomic<bool> done{false};
+    std::atomic<std::size_t> fast_received{0};
+    std::thread reader([&]() {
+        while (!done) {
+            fast_received += fast.drain();
+        }
+    });
+
+    const auto frame = heartbeat_frame();
+    std::size_t sent = 0;
+    while (connection.dropped_frames() == 0 && sent < 1000000) {
+        EXPECT_TRUE(connection.send_frame(frame));
+        ++sent;
+        if (sent % 100 == 0) {
+            // Give the fast client a chance to keep up.
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+    EXPECT_GT(connection.dropped_frames(), 0);
+
+    EXPECT_TRUE(wait_for([&]() { return fast_received == sent * frame.length; }));
+    done = true;
+    reader.join();
+
+    connection.stop();
+}
+
+TEST(TcpServerConnection, FailedStartCanBeRetried)
+{
+    TcpServerConnection first([](mavlink_message_t&, Connection*) {}, "127.0.0.1", local_port);
+    ASSERT_EQ(first.start(), ConnectionResult::Success);
+
+    TcpServerConnection second([](mavlink_message_t&, Connection*) {}, "127.0.0.1", local_port);
+    EXPECT_EQ(second.start(), ConnectionResult::BindError);
+    EXPECT_EQ(second.start(), ConnectionResult::BindError);
+
+    first.stop();
+    EXPECT_EQ(second.start(), ConnectionResult::Success);
+    second.stop();
+}
+
+#endif
@@ -0,0 +1,60 @@
+#include "thread_pool.h"
+
+namespace mavsdk {
+
+ThreadPool::ThreadPool(std::size_t num_threads, ThreadSetup thread_setup) :
+    _thread_setup(std::move(thread_setup))
+{
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+
+    _threads.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        _threads.emplace_back(_thread_setup.settings.stack_size_bytes, [this, i]() { worker(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_exit = true;
+    }
+    _cv.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::post(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.push_back(std::move(task));
+    }
+    _cv.notify_one();
+}
+
+void ThreadPool::worker(std::size_t index)
+{
+    _thread_setup.with_index(index).apply();
+
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait(lock, [this] { return _should_exit || !_tasks.empty(); });
+            if (_tasks.empty()) {
+                // We only get here when exiting.
+                return;
+            }
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace mavsdk
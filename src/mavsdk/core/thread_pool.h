@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "native_thread.h"
+#include "thread_setup.h"
+#include "unique_function.h"
+
+namespace mavsdk {
+
+// Fixed number of worker threads running queued tasks in FIFO order.
+//
+// Tasks posted from different threads may run concurrently, so anything
+// needing serialization has to take care of it itself (see
+// SystemImpl::schedule_work).
+class ThreadPool {
+public:
+    using Task = UniqueFunction<void()>;
+
+    // Each worker applies the setup with its index, see ThreadSetup::with_index().
+    explicit ThreadPool(std::size_t num_threads, ThreadSetup thread_setup = {});
+    ~ThreadPool();
+
+    // Tasks still queued when the pool is destructed are run before the
+    // workers exit.
+    void post(Task task);
+
+    [[nodiscard]] std::size_t num_threads() const { return _threads.size(); }
+
+    // Non-copyable
+    ThreadPool(const ThreadPool&) = delete;
+    const ThreadPool& operator=(const ThreadPool&) = delete;
+
+private:
+    void worker(std::size_t index);
+
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::deque<Task> _tasks{};
+    bool _should_exit{false};
+    const ThreadSetup _thread_setup;
+    std::vector<NativeThread> _threads{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,44 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <gtest/gtest.h>
+#include "thread_pool.h"
+
+using namespace mavsdk;
+
+TEST(ThreadPool, RunsPostedTask)
+{
+    ThreadPool pool(2);
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+
+    pool.post([&prom]() { prom.set_value(); });
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+}
+
+TEST(ThreadPool, RunsQueuedTasksBeforeExit)
+{
+    std::atomic<int> counter{0};
+
+    {
+        ThreadPool pool(3);
+        for (int i = 0; i < 1000; ++i) {
+            pool.post([&counter]() { ++counter; });
+        }
+    }
+
+    EXPECT_EQ(counter, 1000);
+}
+
+TEST(ThreadPool, AtLeastOneThread)
+{
+    ThreadPool pool(0);
+    EXPECT_EQ(pool.num_threads(), 1);
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    pool.post([&prom]() { prom.set_value(); });
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+}
@@ -0,0 +1,131 @@
+#include "thread_setup.h"
+#include "log.h"
+
+#if defined(WINDOWS)
+#include "windows_include.h"
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+namespace mavsdk {
+
+namespace {
+
+using SchedulingPolicy = Mavsdk::Configuration::SchedulingPolicy;
+
+void set_name(const std::string& name)
+{
+#if defined(LINUX)
+    // Longer names are rejected rather than truncated.
+    const std::string truncated = name.substr(0, 15);
+    pthread_setname_np(pthread_self(), truncated.c_str());
+#elif defined(APPLE)
+    pthread_setname_np(name.c_str());
+#else
+    // Naming threads needs Windows 10 APIs, we leave them unnamed.
+    (void)name;
+#endif
+}
+
+void set_cpus(const std::string& name, const std::vector<unsigned>& cpus)
+{
+#if defined(LINUX)
+    // sched_setaffinity with 0 applies to the calling thread only, unlike
+    // pthread_setaffinity_np it is available on Android as well.
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (const auto cpu : cpus) {
+        if (cpu >= CPU_SETSIZE) {
+            LogWarn() << "Ignoring CPU " << cpu << " for thread " << name;
+            continue;
+        }
+        CPU_SET(cpu, &cpu_set);
+    }
+    if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+        LogWarn() << "Could not pin thread " << name << ": " << strerror(errno);
+    }
+#elif defined(WINDOWS)
+    DWORD_PTR mask = 0;
+    for (const auto cpu : cpus) {
+        if (cpu >= sizeof(mask) * 8) {
+            LogWarn() << "Ignoring CPU " << cpu << " for thread " << name;
+            continue;
+        }
+        mask |= DWORD_PTR{1} << cpu;
+    }
+    if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0) {
+        LogWarn() << "Could not pin thread " << name << ": " << GetLastError();
+    }
+#else
+    // macOS only knows affinity tags as hints, threads can't be pinned.
+    (void)cpus;
+    LogWarn() << "Pinning threads is not supported, thread " << name << " is not pinned";
+#endif
+}
+
+void set_policy(const std::string& name, SchedulingPolicy policy, int priority)
+{
+#if defined(WINDOWS)
+    // Windows only has priorities, real-time policies get the highest one
+    // which doesn't starve the system.
+    (void)priority;
+    if (SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST) == 0) {
+        LogWarn() << "Could not set priority of thread " << name << ": " << GetLastError();
+    }
+#else
+    const int sched_policy = (policy == SchedulingPolicy::Fifo) ? SCHED_FIFO : SCHED_RR;
+
+    const int min_priority = sched_get_priority_min(sched_policy);
+    const int max_priority = sched_get_priority_max(sched_policy);
+    if (priority < min_priority || priority > max_priority) {
+        LogWarn() << "Priority " << priority << " of thread " << name << " is not within "
+                  << min_priority << " and " << max_priority << ", ignoring it";
+        return;
+    }
+
+    sched_param param{};
+    param.sched_priority = priority;
+    const int result = pthread_setschedparam(pthread_self(), sched_policy, &param);
+    if (result != 0) {
+        LogWarn() << "Could not set scheduling policy of thread " << name << ": "
+                  << strerror(result);
+    }
+#endif
+}
+
+} // namespace
+
+ThreadSetup ThreadSetup::for_role(
+    const Mavsdk::Configuration& configuration,
+    Mavsdk::Configuration::ThreadRole role,
+    const std::string& suffix)
+{
+    return {configuration.get_thread_name_prefix() + "-" + suffix,
+            configuration.get_thread_settings(role)};
+}
+
+ThreadSetup ThreadSetup::with_index(std::size_t index) const
+{
+    return {name + std::to_string(index), settings};
+}
+
+void ThreadSetup::apply() const
+{
+    if (!name.empty()) {
+        set_name(name);
+    }
+
+    if (!settings.cpus.empty()) {
+        set_cpus(name, settings.cpus);
+    }
+
+    if (settings.policy != SchedulingPolicy::Default) {
+        set_policy(name, settings.policy, settings.priority);
+    }
+}
+
+} // namespace mavsdk
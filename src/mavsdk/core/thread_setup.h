@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "mavsdk.h"
+
+namespace mavsdk {
+
+// Name and scheduling settings of a thread. They are handed to whoever starts
+// the thread, and the thread applies them to itself first thing, as not every
+// platform can name or pin another thread.
+struct ThreadSetup {
+    std::string name{};
+    Mavsdk::Configuration::ThreadSettings settings{};
+
+    // The setup configured for the role, named with the prefix and the suffix.
+    static ThreadSetup for_role(
+        const Mavsdk::Configuration& configuration,
+        Mavsdk::Configuration::ThreadRole role,
+        const std::string& suffix);
+
+    // The same, for one of several threads, e.g. "mavsdk-cb" becomes "mavsdk-cb1".
+    [[nodiscard]] ThreadSetup with_index(std::size_t index) const;
+
+    // Applies it to the calling thread. Without a name, the name is left as
+    // is. Whatever can't be applied is logged and skipped.
+    void apply() const;
+};
+
+} // namespace mavsdk
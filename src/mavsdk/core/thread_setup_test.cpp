@@ -0,0 +1,79 @@
+#include "thread_setup.h"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+#if defined(LINUX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace mavsdk;
+
+using ThreadRole = Mavsdk::Configuration::ThreadRole;
+
+TEST(ThreadSetup, ForRoleUsesPrefixAndSettings)
+{
+    Mavsdk::Configuration configuration{Mavsdk::Configuration::UsageType::GroundStation};
+    configuration.set_thread_name_prefix("gcs");
+
+    Mavsdk::Configuration::ThreadSettings settings;
+    settings.cpus = {1, 2};
+    settings.policy = Mavsdk::Configuration::SchedulingPolicy::Fifo;
+    settings.priority = 10;
+    configuration.set_thread_settings(ThreadRole::Io, settings);
+
+    const auto io = ThreadSetup::for_role(configuration, ThreadRole::Io, "io");
+    EXPECT_EQ(io.name, "gcs-io");
+    EXPECT_EQ(io.settings.cpus, (std::vector<unsigned>{1, 2}));
+    EXPECT_EQ(io.settings.policy, Mavsdk::Configuration::SchedulingPolicy::Fifo);
+    EXPECT_EQ(io.settings.priority, 10);
+
+    // Other roles are left alone.
+    const auto timer = ThreadSetup::for_role(configuration, ThreadRole::Timer, "timer");
+    EXPECT_EQ(timer.name, "gcs-timer");
+    EXPECT_TRUE(timer.settings.cpus.empty());
+    EXPECT_EQ(timer.settings.policy, Mavsdk::Configuration::SchedulingPolicy::Default);
+}
+
+TEST(ThreadSetup, WithIndexAppendsIndex)
+{
+    ThreadSetup setup{"mavsdk-cb", {}};
+    EXPECT_EQ(setup.with_index(0).name, "mavsdk-cb0");
+    EXPECT_EQ(setup.with_index(12).name, "mavsdk-cb12");
+}
+
+#if defined(LINUX)
+TEST(ThreadSetup, NamesThread)
+{
+    std::string name;
+    std::thread thread([&]() {
+        ThreadSetup{"mavsdk-a-very-long-name", {}}.apply();
+        char buffer[32]{};
+        pthread_getname_np(pthread_self(), buffer, sizeof(buffer));
+        name = buffer;
+    });
+    thread.join();
+
+    EXPECT_EQ(name, "mavsdk-a-very-l");
+}
+
+TEST(ThreadSetup, PinsThread)
+{
+    bool only_cpu_0 = false;
+    std::thread thread([&]() {
+        Mavsdk::Configuration::ThreadSettings settings;
+        settings.cpus = {0};
+        ThreadSetup{"mavsdk-pinned", settings}.apply();
+
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        sched_getaffinity(0, sizeof(cpu_set), &cpu_set);
+        only_cpu_0 = CPU_COUNT(&cpu_set) == 1 && CPU_ISSET(0, &cpu_set);
+    });
+    thread.join();
+
+    EXPECT_TRUE(only_cpu_0);
+}
+#endif
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace mavsdk {
+
+// History with a fixed capacity of timestamped values. Once it is full, the
+// oldest sample is overwritten.
+//
+// Timestamps and values are kept in separate arrays, so searching by time only
+// touches the densely packed timestamps. All storage is part of the object,
+// adding a sample never allocates.
+//
+// Samples need to be added in order of time, a sample older than the newest
+// one is dropped.
+template<typename T, std::size_t N> class TimeSeries {
+    static_assert(N > 1, "TimeSeries requires a capacity of at least 2");
+
+public:
+    TimeSeries() = default;
+    ~TimeSeries() = default;
+
+    bool push(uint64_t time_us, const T& value)
+    {
+        if (_size > 0 && time_us < time_at(_size - 1)) {
+            return false;
+        }
+
+        const std::size_t index = (_begin + _size) % N;
+        _times_us[index] = time_us;
+        _values[index] = value;
+
+        if (_size < N) {
+            ++_size;
+        } else {
+            _begin = (_begin + 1) % N;
+        }
+        return true;
+    }
+
+    void clear()
+    {
+        _begin = 0;
+        _size = 0;
+    }
+
+    [[nodiscard]] std::size_t size() const { return _size; }
+
+    [[nodiscard]] bool empty() const { return _size == 0; }
+
+    static constexpr std::size_t capacity() { return N; }
+
+    // All samples from start_time_us to end_time_us (inclusive), oldest first.
+    [[nodiscard]] std::vector<std::pair<uint64_t, T>>
+    between(uint64_t start_time_us, uint64_t end_time_us) const
+    {
+        std::vector<std::pair<uint64_t, T>> result;
+        for (std::size_t i = lower_bound(start_time_us); i < _size && time_at(i) <= end_time_us;
+             ++i) {
+            result.emplace_back(time_at(i), value_at(i));
+        }
+        return result;
+    }
+
+    // Value at the given time, interpolated between the two samples around it
+    // by calling interpolate(before, after, fraction). Empty if the time is
+    // before the oldest or after the newest sample.
+    template<typename Interpolate>
+    [[nodiscard]] std::optional<T> at(uint64_t time_us, const Interpolate& interpolate) const
+    {
+        if (_size == 0 || time_us < time_at(0) || time_us > time_at(_size - 1)) {
+            return std::nullopt;
+        }
+
+        const std::size_t after = lower_bound(time_us);
+        if (time_at(after) == time_us) {
+            return value_at(after);
+        }
+
+        // The oldest sample is before time_us, so after can't be the first one.
+        const std::size_t before = after - 1;
+        const double fraction = static_cast<double>(time_us - time_at(before)) /
+                                static_cast<double>(time_at(after) - time_at(before));
+        return interpolate(value_at(before), value_at(after), fraction);
+    }
+
+private:
+    [[nodiscard]] uint64_t time_at(std::size_t i) const { return _times_us[(_begin + i) % N]; }
+
+    [[nodiscard]] const T& value_at(std::size_t i) const { return _values[(_begin + i) % N]; }
+
+    // Index of the first sample not older than time_us, or size if there is none.
+    [[nodiscard]] std::size_t lower_bound(uint64_t time_us) const
+    {
+        std::size_t first = 0;
+        std::size_t count = _size;
+        while (count > 0) {
+            const std::size_t step = count / 2;
+            if (time_at(first + step) < time_us) {
+                first += step + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+        return first;
+    }
+
+    std::array<uint64_t, N> _times_us{};
+    std::array<T, N> _values{};
+    std::size_t _begin{0};
+    std::size_t _size{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,84 @@
+#include "time_series.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+double lerp(double before, double after, double fraction)
+{
+    return before + (after - before) * fraction;
+}
+} // namespace
+
+TEST(TimeSeries, PushAndQueryRange)
+{
+    auto series = TimeSeries<double, 4>{};
+    EXPECT_TRUE(series.empty());
+
+    EXPECT_TRUE(series.push(10, 1.0));
+    EXPECT_TRUE(series.push(20, 2.0));
+    EXPECT_TRUE(series.push(30, 3.0));
+    EXPECT_EQ(series.size(), 3);
+
+    auto samples = series.between(15, 30);
+    ASSERT_EQ(samples.size(), 2);
+    EXPECT_EQ(samples[0].first, 20);
+    EXPECT_DOUBLE_EQ(samples[0].second, 2.0);
+    EXPECT_EQ(samples[1].first, 30);
+    EXPECT_DOUBLE_EQ(samples[1].second, 3.0);
+
+    EXPECT_TRUE(series.between(31, 100).empty());
+    EXPECT_TRUE(series.between(30, 10).empty());
+    EXPECT_EQ(series.between(0, 100).size(), 3);
+}
+
+TEST(TimeSeries, OverwritesOldest)
+{
+    auto series = TimeSeries<double, 3>{};
+
+    for (uint64_t i = 1; i <= 5; ++i) {
+        series.push(i * 10, static_cast<double>(i));
+    }
+    EXPECT_EQ(series.size(), 3);
+
+    auto samples = series.between(0, 100);
+    ASSERT_EQ(samples.size(), 3);
+    EXPECT_EQ(samples[0].first, 30);
+    EXPECT_EQ(samples[1].first, 40);
+    EXPECT_EQ(samples[2].first, 50);
+
+    EXPECT_FALSE(series.at(20, lerp));
+    ASSERT_TRUE(series.at(30, lerp));
+    EXPECT_DOUBLE_EQ(series.at(30, lerp).value(), 3.0);
+}
+
+TEST(TimeSeries, Interpolates)
+{
+    auto series = TimeSeries<double, 8>{};
+    EXPECT_FALSE(series.at(0, lerp));
+
+    series.push(100, 1.0);
+    series.push(200, 3.0);
+
+    EXPECT_FALSE(series.at(99, lerp));
+    EXPECT_FALSE(series.at(201, lerp));
+    EXPECT_DOUBLE_EQ(series.at(100, lerp).value(), 1.0);
+    EXPECT_DOUBLE_EQ(series.at(150, lerp).value(), 2.0);
+    EXPECT_DOUBLE_EQ(series.at(175, lerp).value(), 2.5);
+    EXPECT_DOUBLE_EQ(series.at(200, lerp).value(), 3.0);
+}
+
+TEST(TimeSeries, DropsOutOfOrderAndClears)
+{
+    auto series = TimeSeries<double, 4>{};
+
+    EXPECT_TRUE(series.push(20, 2.0));
+    EXPECT_FALSE(series.push(10, 1.0));
+    EXPECT_TRUE(series.push(20, 2.5));
+    EXPECT_EQ(series.size(), 2);
+
+    series.clear();
+    EXPECT_TRUE(series.empty());
+    EXPECT_TRUE(series.push(10, 1.0));
+    EXPECT_EQ(series.size(), 1);
+}
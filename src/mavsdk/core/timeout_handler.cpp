@@ -1,4 +1,7 @@
 #include "timeout_handler.h"
+#include "log.h"
+
+#include <utility>
 
 namespace mavsdk {
 
@@ -6,21 +9,30 @@ TimeoutHandler::TimeoutHandler(Time& time) : _time(time) {}
 
 void TimeoutHandler::add(std::function<void()> callback, double duration_s, void** cookie)
 {
-    auto new_timeout = std::make_shared<Timeout>();
-    new_timeout->callback = callback;
-    new_timeout->time = _time.steady_time_in_future(duration_s);
-    new_timeout->duration_s = duration_s;
-
-    void* new_cookie = static_cast<void*>(new_timeout.get());
+    void* new_cookie;
 
     {
         std::lock_guard<std::mutex> lock(_timeouts_mutex);
-        _timeouts.insert(std::pair<void*, std::shared_ptr<Timeout>>(new_cookie, new_timeout));
+        new_cookie = _timeouts.insert(
+            _time.steady_time_in_future(duration_s), Timeout{std::move(callback), duration_s});
+    }
+
+    if (new_cookie == nullptr) {
+        LogErr() << "Too many timeouts";
     }
 
     if (cookie != nullptr) {
         *cookie = new_cookie;
     }
+
+    if (_wakeup_callback) {
+        _wakeup_callback();
+    }
+}
+
+void TimeoutHandler::set_wakeup_callback(std::function<void()> callback)
+{
+    _wakeup_callback = std::move(callback);
 }
 
 void TimeoutHandler::refresh(const void* cookie)
@@ -31,10 +43,11 @@ void TimeoutHandler::refresh(const void* cookie)
 
     std::lock_guard<std::mutex> lock(_timeouts_mutex);
 
-    auto it = _timeouts.find(const_cast<void*>(cookie));
-    if (it != _timeouts.end()) {
-        dl_time_t future_time = _time.steady_time_in_future(it->second->duration_s);
-        it->second->time = future_time;
+    auto timeout = _timeouts.find(cookie);
+    if (timeout != nullptr) {
+        // A refresh only ever moves the deadline later, so there is no need to
+        // wake up whoever is waiting for the next deadline.
+        _timeouts.update(cookie, _time.steady_time_in_future(timeout->duration_s));
     }
 }
 
@@ -45,47 +58,38 @@ void TimeoutHandler::remove(const void* cookie)
     }
 
     std::lock_guard<std::mutex> lock(_timeouts_mutex);
-
-    auto it = _timeouts.find(const_cast<void*>(cookie));
-    if (it != _timeouts.end()) {
-        _timeouts.erase(const_cast<void*>(cookie));
-        _iterator_invalidated = true;
-    }
+    _timeouts.remove(cookie);
 }
 
 void TimeoutHandler::run_once()
 {
-    _timeouts_mutex.lock();
+    std::unique_lock<std::mutex> lock(_timeouts_mutex);
 
     dl_time_t now = _time.steady_time();
 
-    for (auto it = _timeouts.begin(); it != _timeouts.end(); /* no ++it */) {
-        // If time is passed, call timeout callback.
-        if (it->second->time < now) {
-            if (it->second->callback) {
-                // Get a copy for the callback because we will remove it.
-                std::function<void()> callback = it->second->callback;
+    // The heap is ordered by time, so we only ever need to look at the top.
+    while (!_timeouts.empty() && _timeouts.next_due().value() < now) {
+        void* cookie = _timeouts.top();
 
-                // Self-destruct before calling to avoid locking issues.
-                _timeouts.erase(it++);
+        // Take the callback out because we will remove the timeout.
+        std::function<void()> callback = std::move(_timeouts.find(cookie)->callback);
 
-                // Unlock while we callback because it might in turn want to add timeouts.
-                _timeouts_mutex.unlock();
-                callback();
-                _timeouts_mutex.lock();
-            }
-
-        } else {
-            ++it;
-        }
+        // Self-destruct before calling to avoid locking issues.
+        _timeouts.remove(cookie);
 
-        // We start over if anyone has messed with this while we called the callback.
-        if (_iterator_invalidated) {
-            _iterator_invalidated = false;
-            it = _timeouts.begin();
+        if (callback) {
+            // Unlock while we callback because it might in turn want to add timeouts.
+            lock.unlock();
+            callback();
+            lock.lock();
         }
     }
-    _timeouts_mutex.unlock();
+}
+
+std::optional<dl_time_t> TimeoutHandler::next_deadline()
+{
+    std::lock_guard<std::mutex> lock(_timeouts_mutex);
+    return _timeouts.next_due();
 }
 
 } // namespace mavsdk
@@ -1,10 +1,10 @@
 #pragma once
 
 #include <mutex>
-#include <memory>
 #include <functional>
-#include <unordered_map>
+#include <optional>
 #include "mavsdk_time.h"
+#include "timer_heap.h"
 
 namespace mavsdk {
 
@@ -25,16 +25,25 @@ public:
 
     void run_once();
 
+    // Returns the earliest time at which a timeout is due, or nothing if
+    // there are no timeouts registered.
+    std::optional<dl_time_t> next_deadline();
+
+    // The wakeup callback is called (without any lock held) whenever a timeout
+    // is added, so that a thread waiting for the next deadline can re-evaluate.
+    // It needs to be set before the handler is used.
+    void set_wakeup_callback(std::function<void()> callback);
+
 private:
     struct Timeout {
         std::function<void()> callback{};
-        dl_time_t time{};
         double duration_s{0.0};
     };
 
-    std::unordered_map<void*, std::shared_ptr<Timeout>> _timeouts{};
+    TimerHeap<Timeout> _timeouts{};
     std::mutex _timeouts_mutex{};
-    bool _iterator_invalidated{false};
+
+    std::function<void()> _wakeup_callback{nullptr};
 
     Time& _time;
 };
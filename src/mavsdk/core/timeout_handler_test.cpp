@@ -169,3 +169,36 @@ TEST(TimeoutHandler, NextTimeoutRemovedDuringCallback)
     time.sleep_for(std::chrono::milliseconds(1000));
     th.run_once();
 }
+
+TEST(TimeoutHandler, NextDeadline)
+{
+    Time time{};
+    TimeoutHandler th(time);
+
+    int num_wakeups = 0;
+    th.set_wakeup_callback([&num_wakeups]() { ++num_wakeups; });
+
+    EXPECT_FALSE(th.next_deadline().has_value());
+
+    void* cookie1 = nullptr;
+    void* cookie2 = nullptr;
+    th.add([]() {}, 0.5, &cookie1);
+    th.add([]() {}, 0.2, &cookie2);
+    EXPECT_EQ(num_wakeups, 2);
+
+    auto deadline = th.next_deadline();
+    ASSERT_TRUE(deadline.has_value());
+    EXPECT_EQ(deadline.value(), time.steady_time_in_future(0.2));
+
+    th.remove(cookie2);
+    deadline = th.next_deadline();
+    ASSERT_TRUE(deadline.has_value());
+    EXPECT_EQ(deadline.value(), time.steady_time_in_future(0.5));
+
+    // Refreshing only postpones, so no wakeup is required.
+    th.refresh(cookie1);
+    EXPECT_EQ(num_wakeups, 2);
+
+    th.remove(cookie1);
+    EXPECT_FALSE(th.next_deadline().has_value());
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "mavsdk_time.h"
+
+namespace mavsdk {
+
+// Binary min-heap of timers ordered by their due time, backing TimeoutHandler
+// and CallEveryHandler.
+//
+// Entries live in a pool of slots which is reused once an entry is removed,
+// so adding and removing timers does not allocate once the pool has grown.
+// The cookie handed out encodes the slot index as well as a generation count,
+// so a stale cookie of a removed entry never matches the entry that reuses
+// its slot.
+//
+// The heap is not thread-safe, it needs to be protected by the owner.
+template<typename Payload> class TimerHeap {
+public:
+    TimerHeap() = default;
+    ~TimerHeap() = default;
+
+    // Returns nullptr if the pool is exhausted.
+    void* insert(dl_time_t due, Payload payload)
+    {
+        uint32_t index;
+        if (!_free.empty()) {
+            index = _free.back();
+            _free.pop_back();
+        } else {
+            if (_slots.size() >= MAX_SLOTS) {
+                return nullptr;
+            }
+            index = static_cast<uint32_t>(_slots.size());
+            _slots.emplace_back();
+        }
+
+        auto& slot = _slots[index];
+        slot.due = due;
+        slot.payload = std::move(payload);
+        slot.in_use = true;
+        slot.heap_pos = _heap.size();
+        _heap.push_back(index);
+        sift_up(slot.heap_pos);
+
+        return to_cookie(index, slot.generation);
+    }
+
+    // Returns nullptr if the cookie is unknown or stale. The pointer is only
+    // valid until the next insert.
+    Payload* find(const void* cookie)
+    {
+        auto slot = slot_for(cookie);
+        return slot ? &slot->payload : nullptr;
+    }
+
+    std::optional<dl_time_t> due(const void* cookie)
+    {
+        auto slot = slot_for(cookie);
+        if (slot == nullptr) {
+            return {};
+        }
+        return slot->due;
+    }
+
+    bool update(const void* cookie, dl_time_t due)
+    {
+        auto slot = slot_for(cookie);
+        if (slot == nullptr) {
+            return false;
+        }
+
+        const bool earlier = due < slot->due;
+        slot->due = due;
+        if (earlier) {
+            sift_up(slot->heap_pos);
+        } else {
+            sift_down(slot->heap_pos);
+        }
+        return true;
+    }
+
+    bool remove(const void* cookie)
+    {
+        auto slot = slot_for(cookie);
+        if (slot == nullptr) {
+            return false;
+        }
+
+        const std::size_t pos = slot->heap_pos;
+        const uint32_t index = _heap[pos];
+
+        swap_heap(pos, _heap.size() - 1);
+        _heap.pop_back();
+        if (pos < _heap.size()) {
+            sift_up(pos);
+            sift_down(pos);
+        }
+
+        slot->payload = Payload{};
+        slot->in_use = false;
+        ++slot->generation;
+        _free.push_back(index);
+        return true;
+    }
+
+    [[nodiscard]] bool empty() const { return _heap.empty(); }
+
+    [[nodiscard]] std::size_t size() const { return _heap.size(); }
+
+    // Cookie of the entry due first, or nullptr if empty.
+    void* top() const
+    {
+        if (_heap.empty()) {
+            return nullptr;
+        }
+        const uint32_t index = _heap.front();
+        return to_cookie(index, _slots[index].generation);
+    }
+
+    [[nodiscard]] std::optional<dl_time_t> next_due() const
+    {
+        if (_heap.empty()) {
+            return {};
+        }
+        return _slots[_heap.front()].due;
+    }
+
+private:
+    struct Slot {
+        dl_time_t due{};
+        Payload payload{};
+        uintptr_t generation{0};
+        std::size_t heap_pos{0};
+        bool in_use{false};
+    };
+
+    // The lower half of the cookie bits is used for the slot index (plus one,
+    // so a cookie is never nullptr), the upper half for the generation.
+    static constexpr unsigned INDEX_BITS = sizeof(uintptr_t) * 4;
+    static constexpr uintptr_t INDEX_MASK = (uintptr_t(1) << INDEX_BITS) - 1;
+    static constexpr std::size_t MAX_SLOTS = INDEX_MASK - 1;
+
+    static void* to_cookie(uint32_t index, uintptr_t generation)
+    {
+        return reinterpret_cast<void*>((generation << INDEX_BITS) | (uintptr_t(index) + 1));
+    }
+
+    Slot* slot_for(const void* cookie)
+    {
+        const auto value = reinterpret_cast<uintptr_t>(cookie);
+        if ((value & INDEX_MASK) == 0) {
+            return nullptr;
+        }
+        const std::size_t index = (value & INDEX_MASK) - 1;
+        if (index >= _slots.size()) {
+            return nullptr;
+        }
+        auto& slot = _slots[index];
+        const uintptr_t generation = value >> INDEX_BITS;
+        if (!slot.in_use || (slot.generation & (~uintptr_t(0) >> INDEX_BITS)) != generation) {
+            return nullptr;
+        }
+        return &slot;
+    }
+
+    bool less(std::size_t lhs, std::size_t rhs) const
+    {
+        return _slots[_heap[lhs]].due < _slots[_heap[rhs]].due;
+    }
+
+    void swap_heap(std::size_t lhs, std::size_t rhs)
+    {
+        std::swap(_heap[lhs], _heap[rhs]);
+        _slots[_heap[lhs]].heap_pos = lhs;
+        _slots[_heap[rhs]].heap_pos = rhs;
+    }
+
+    void sift_up(std::size_t pos)
+    {
+        while (pos > 0) {
+            const std::size_t parent = (pos - 1) / 2;
+            if (!less(pos, parent)) {
+                break;
+            }
+            swap_heap(pos, parent);
+            pos = parent;
+        }
+    }
+
+    void sift_down(std::size_t pos)
+    {
+        while (true) {
+            const std::size_t left = 2 * pos + 1;
+            const std::size_t right = left + 1;
+            std::size_t smallest = pos;
+            if (left < _heap.size() && less(left, smallest)) {
+                smallest = left;
+            }
+            if (right < _heap.size() && less(right, smallest)) {
+                smallest = right;
+            }
+            if (smallest == pos) {
+                break;
+            }
+            swap_heap(pos, smallest);
+            pos = smallest;
+        }
+    }
+
+    std::vector<Slot> _slots{};
+    std::vector<uint32_t> _free{};
+    std::vector<uint32_t> _heap{};
+};
+
+} // namespace mavsdk
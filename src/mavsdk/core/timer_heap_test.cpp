@@ -0,0 +1,82 @@
+#include "timer_heap.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(TimerHeap, OrderedByDueTime)
+{
+    TimerHeap<int> heap{};
+    const dl_time_t now{};
+
+    void* cookie3 = heap.insert(now + std::chrono::seconds(3), 3);
+    void* cookie1 = heap.insert(now + std::chrono::seconds(1), 1);
+    void* cookie2 = heap.insert(now + std::chrono::seconds(2), 2);
+    EXPECT_EQ(heap.size(), 3);
+
+    EXPECT_EQ(heap.top(), cookie1);
+    EXPECT_EQ(heap.next_due().value(), now + std::chrono::seconds(1));
+
+    // Postpone the first one to the end.
+    EXPECT_TRUE(heap.update(cookie1, now + std::chrono::seconds(4)));
+    EXPECT_EQ(heap.top(), cookie2);
+
+    EXPECT_TRUE(heap.remove(cookie2));
+    EXPECT_EQ(heap.top(), cookie3);
+    EXPECT_EQ(*heap.find(cookie3), 3);
+
+    EXPECT_TRUE(heap.remove(cookie3));
+    EXPECT_EQ(heap.top(), cookie1);
+
+    EXPECT_TRUE(heap.remove(cookie1));
+    EXPECT_TRUE(heap.empty());
+    EXPECT_EQ(heap.top(), nullptr);
+    EXPECT_FALSE(heap.next_due().has_value());
+}
+
+TEST(TimerHeap, StaleCookieIgnored)
+{
+    TimerHeap<int> heap{};
+    const dl_time_t now{};
+
+    void* old_cookie = heap.insert(now, 1);
+    EXPECT_TRUE(heap.remove(old_cookie));
+
+    // The slot gets reused but the cookie needs to be different.
+    void* new_cookie = heap.insert(now, 2);
+    EXPECT_NE(old_cookie, new_cookie);
+
+    EXPECT_EQ(heap.find(old_cookie), nullptr);
+    EXPECT_FALSE(heap.update(old_cookie, now));
+    EXPECT_FALSE(heap.remove(old_cookie));
+    EXPECT_EQ(*heap.find(new_cookie), 2);
+
+    EXPECT_EQ(heap.find(nullptr), nullptr);
+    EXPECT_FALSE(heap.remove(nullptr));
+}
+
+TEST(TimerHeap, ManyEntries)
+{
+    TimerHeap<int> heap{};
+    const dl_time_t now{};
+
+    std::vector<void*> cookies;
+    for (int i = 0; i < 100; ++i) {
+        // Insert in a scrambled order.
+        const int value = (i * 37) % 100;
+        cookies.push_back(heap.insert(now + std::chrono::milliseconds(value), value));
+    }
+
+    // Remove every other one from the middle.
+    for (unsigned i = 0; i < cookies.size(); i += 2) {
+        EXPECT_TRUE(heap.remove(cookies[i]));
+    }
+
+    int last_value = -1;
+    while (!heap.empty()) {
+        void* cookie = heap.top();
+        const int value = *heap.find(cookie);
+        EXPECT_GT(value, last_value);
+        last_value = value;
+        heap.remove(cookie);
+    }
+}
@@ -33,6 +33,8 @@ void Timesync::do_work()
             uint64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
                                   _parent.get_autopilot_time().now().time_since_epoch())
                                   .count();
+            _sent_steady_time_ns.store(steady_time_ns(), std::memory_order_relaxed);
+            _sent_ts1.store(now_ns, std::memory_order_release);
             send_timesync(0, now_ns);
         } else {
             _autopilot_timesync_acquired = false;
@@ -43,6 +45,8 @@ void Timesync::do_work()
 
 void Timesync::process_timesync(const mavlink_message_t& message)
 {
+    const int64_t receive_steady_time_ns = steady_time_ns();
+
     mavlink_timesync_t timesync{};
 
     mavlink_msg_timesync_decode(&message, &timesync);
@@ -55,6 +59,13 @@ void Timesync::process_timesync(const mavlink_message_t& message)
         // Send synced time to remote system
         send_timesync(now_ns, timesync.ts1);
     } else if (timesync.tc1 > 0) {
+        if (static_cast<uint64_t>(timesync.ts1) == _sent_ts1.load(std::memory_order_acquire)) {
+            _parent.clock_model().add_sample(
+                _sent_steady_time_ns.load(std::memory_order_relaxed),
+                timesync.tc1,
+                receive_steady_time_ns);
+        }
+
         // Time offset between this system and the remote system is calculated assuming RTT for
         // the timesync packet is roughly equal both ways.
         set_timesync_offset((timesync.tc1 * 2 - (timesync.ts1 + now_ns)) / 2, timesync.ts1);
@@ -74,6 +85,13 @@ void Timesync::send_timesync(uint64_t tc1, uint64_t ts1)
     _parent.send_message(message);
 }
 
+int64_t Timesync::steady_time_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               _parent.get_time().steady_time().time_since_epoch())
+        .count();
+}
+
 void Timesync::set_timesync_offset(int64_t offset_ns, uint64_t start_transfer_local_time_ns)
 {
     uint64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
@@ -84,6 +102,13 @@ void Timesync::set_timesync_offset(int64_t offset_ns, uint64_t start_transfer_lo
     // remote system
     uint64_t rtt_ns = now_ns - start_transfer_local_time_ns;
 
+    // The autopilot time might have been shifted in the meantime, so only
+    // plausible values are worth feeding into the retransmission timeout.
+    const double rtt_s = static_cast<double>(rtt_ns) * 1e-9;
+    if (rtt_s < RttEstimator::MAX_RTO_S) {
+        _parent.add_rtt_sample(rtt_s);
+    }
+
     if (rtt_ns < MAX_RTT_SAMPLE_MS * 1000000ULL) { // Only use samples with low RTT
 
         // Save time offset for other components to use
@@ -3,6 +3,9 @@
 #include "mavsdk_time.h"
 #include "mavlink_include.h"
 
+#include <atomic>
+#include <cstdint>
+
 namespace mavsdk {
 
 class SystemImpl;
@@ -24,10 +27,17 @@ private:
     void process_timesync(const mavlink_message_t& message);
     void send_timesync(uint64_t tc1, uint64_t ts1);
     void set_timesync_offset(int64_t offset_ns, uint64_t start_transfer_local_time_ns);
+    int64_t steady_time_ns();
 
-    static constexpr double TIMESYNC_SEND_INTERVAL_S = 5.0;
+    // Often enough for the clock model to sync within a few seconds.
+    static constexpr double TIMESYNC_SEND_INTERVAL_S = 1.0;
     dl_time_t _last_time{};
 
+    // The request in flight, to match the answer with its local send time.
+    // Sent from the work thread, answered on the receive thread.
+    std::atomic<uint64_t> _sent_ts1{0};
+    std::atomic<int64_t> _sent_steady_time_ns{0};
+
     static constexpr uint64_t MAX_CONS_HIGH_RTT = 5;
     static constexpr uint64_t MAX_RTT_SAMPLE_MS = 10;
     uint64_t _high_rtt_count{};
@@ -0,0 +1,161 @@
+#include "tlog.h"
+#include "log.h"
+
+#include <chrono>
+
+namespace mavsdk {
+
+namespace {
+
+// Magic, length, incompat flags, the rest of the header and the checksum.
+constexpr uint8_t MAGIC_V1 = 0xFE;
+constexpr uint8_t MAGIC_V2 = 0xFD;
+constexpr uint16_t NON_PAYLOAD_LENGTH_V1 = 8;
+constexpr uint16_t NON_PAYLOAD_LENGTH_V2 = 12;
+constexpr uint16_t SIGNATURE_LENGTH = 13;
+constexpr uint8_t INCOMPAT_FLAG_SIGNED = 0x01;
+
+constexpr std::size_t TIME_LENGTH = 8;
+
+} // namespace
+
+TlogWriter::~TlogWriter()
+{
+    close();
+}
+
+bool TlogWriter::open(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_file != nullptr) {
+        std::fclose(_file);
+    }
+
+    _file = std::fopen(path.c_str(), "ab");
+    if (_file == nullptr) {
+        LogErr() << "Could not open tlog " << path << " for writing";
+        return false;
+    }
+
+    // Writes mostly end up in the buffer, they are only flushed in bigger chunks.
+    std::setvbuf(_file, nullptr, _IOFBF, 64 * 1024);
+    return true;
+}
+
+void TlogWriter::close()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_file != nullptr) {
+        std::fclose(_file);
+        _file = nullptr;
+    }
+}
+
+void TlogWriter::write(const uint8_t* frame, std::size_t length, uint64_t time_us)
+{
+    uint8_t time[TIME_LENGTH];
+    for (std::size_t i = 0; i < TIME_LENGTH; ++i) {
+        time[i] = static_cast<uint8_t>(time_us >> (8 * (TIME_LENGTH - 1 - i)));
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_file == nullptr) {
+        return;
+    }
+
+    if (std::fwrite(time, 1, sizeof(time), _file) != sizeof(time) ||
+        std::fwrite(frame, 1, length, _file) != length) {
+        LogErr() << "Writing tlog failed, closing it";
+        std::fclose(_file);
+        _file = nullptr;
+    }
+}
+
+uint64_t TlogWriter::now_us()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+}
+
+TlogReader::~TlogReader()
+{
+    close();
+}
+
+bool TlogReader::open(const std::string& path)
+{
+    close();
+
+    _file = std::fopen(path.c_str(), "rb");
+    if (_file == nullptr) {
+        LogErr() << "Could not open tlog " << path;
+        return false;
+    }
+    return true;
+}
+
+void TlogReader::close()
+{
+    if (_file != nullptr) {
+        std::fclose(_file);
+        _file = nullptr;
+    }
+}
+
+bool TlogReader::next(Record& record)
+{
+    if (_file == nullptr) {
+        return false;
+    }
+
+    uint8_t time[TIME_LENGTH];
+    if (std::fread(time, 1, sizeof(time), _file) != sizeof(time)) {
+        return false;
+    }
+
+    record.time_us = 0;
+    for (std::size_t i = 0; i < TIME_LENGTH; ++i) {
+        record.time_us = (record.time_us << 8) | time[i];
+    }
+
+    // Enough to tell the length of any frame.
+    const std::size_t header_length = 3;
+    if (std::fread(record.frame, 1, header_length, _file) != header_length) {
+        return false;
+    }
+
+    record.length = frame_length(record.frame, header_length);
+    if (record.length == 0) {
+        LogWarn() << "Tlog is corrupt, stopping at a frame starting with "
+                  << static_cast<int>(record.frame[0]);
+        return false;
+    }
+
+    const std::size_t rest = record.length - header_length;
+    return std::fread(record.frame + header_length, 1, rest, _file) == rest;
+}
+
+uint16_t TlogReader::frame_length(const uint8_t* start, std::size_t available)
+{
+    if (available < 3) {
+        return 0;
+    }
+
+    const uint8_t payload_length = start[1];
+
+    switch (start[0]) {
+        case MAGIC_V1:
+            return NON_PAYLOAD_LENGTH_V1 + payload_length;
+        case MAGIC_V2:
+            return NON_PAYLOAD_LENGTH_V2 + payload_length +
+                   ((start[2] & INCOMPAT_FLAG_SIGNED) != 0 ? SIGNATURE_LENGTH : 0);
+        default:
+            return 0;
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include "mavlink_include.h"
+
+namespace mavsdk {
+
+// Telemetry logs (tlog) in the format QGroundControl, MAVProxy and pymavlink
+// use as well: each frame as it went over the link, preceded by the time in
+// microseconds since the epoch as a 64 bit big-endian integer.
+//
+// There is no header and no index, files are only ever appended to and are
+// read front to back, or mapped and walked through the same way.
+
+class TlogWriter {
+public:
+    TlogWriter() = default;
+    ~TlogWriter();
+
+    // Non-copyable
+    TlogWriter(const TlogWriter&) = delete;
+    const TlogWriter& operator=(const TlogWriter&) = delete;
+
+    // Appends to the file if it exists already.
+    bool open(const std::string& path);
+    void close();
+
+    // Can be called from any thread.
+    void write(const uint8_t* frame, std::size_t length, uint64_t time_us);
+
+    static uint64_t now_us();
+
+private:
+    std::mutex _mutex{};
+    std::FILE* _file{nullptr};
+};
+
+class TlogReader {
+public:
+    struct Record {
+        uint64_t time_us{0};
+        uint8_t frame[MAVLINK_MAX_PACKET_LEN]{};
+        uint16_t length{0};
+    };
+
+    TlogReader() = default;
+    ~TlogReader();
+
+    // Non-copyable
+    TlogReader(const TlogReader&) = delete;
+    const TlogReader& operator=(const TlogReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    // False at the end of the file, or where it is cut off or corrupt.
+    bool next(Record& record);
+
+    // Length of the frame starting with the first bytes given, including
+    // checksum and signature, 0 if it does not start like a frame.
+    static uint16_t frame_length(const uint8_t* start, std::size_t available);
+
+private:
+    std::FILE* _file{nullptr};
+};
+
+} // namespace mavsdk
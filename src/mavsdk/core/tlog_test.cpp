@@ -0,0 +1,109 @@
+#include "tlog.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+std::string temp_path(const char* name)
+{
+    return testing::TempDir() + name;
+}
+
+std::vector<uint8_t> make_frame(uint8_t magic, uint8_t payload_length, uint8_t incompat_flags)
+{
+    std::vector<uint8_t> frame(TlogReader::frame_length(
+        std::vector<uint8_t>{magic, payload_length, incompat_flags}.data(), 3));
+    for (std::size_t i = 0; i < frame.size(); ++i) {
+        frame[i] = static_cast<uint8_t>(i);
+    }
+    frame[0] = magic;
+    frame[1] = payload_length;
+    frame[2] = incompat_flags;
+    return frame;
+}
+
+} // namespace
+
+TEST(Tlog, FrameLength)
+{
+    const uint8_t v1[] = {0xFE, 9, 0};
+    EXPECT_EQ(TlogReader::frame_length(v1, sizeof(v1)), 17);
+
+    const uint8_t v2[] = {0xFD, 9, 0};
+    EXPECT_EQ(TlogReader::frame_length(v2, sizeof(v2)), 21);
+
+    const uint8_t v2_signed[] = {0xFD, 255, 0x01};
+    EXPECT_EQ(TlogReader::frame_length(v2_signed, sizeof(v2_signed)), MAVLINK_MAX_PACKET_LEN);
+
+    const uint8_t garbage[] = {0x42, 9, 0};
+    EXPECT_EQ(TlogReader::frame_length(garbage, sizeof(garbage)), 0);
+    EXPECT_EQ(TlogReader::frame_length(v2, 2), 0);
+}
+
+TEST(Tlog, WritesAndReadsBack)
+{
+    const auto path = temp_path("tlog_test_roundtrip.tlog");
+    std::remove(path.c_str());
+
+    const std::vector<std::vector<uint8_t>> frames{
+        make_frame(0xFE, 9, 0), make_frame(0xFD, 28, 0), make_frame(0xFD, 3, 0x01)};
+
+    {
+        TlogWriter writer;
+        ASSERT_TRUE(writer.open(path));
+        for (std::size_t i = 0; i < frames.size(); ++i) {
+            writer.write(frames[i].data(), frames[i].size(), 1600000000000000 + i * 1000);
+        }
+    }
+
+    // The time is big-endian, as other tools expect it.
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    uint8_t time[8];
+    ASSERT_EQ(std::fread(time, 1, sizeof(time), file), sizeof(time));
+    std::fclose(file);
+    EXPECT_EQ(time[0], 0x00);
+    EXPECT_EQ(time[1], 0x05);
+    EXPECT_EQ(time[2], 0xAF);
+    EXPECT_EQ(time[7], 0x00);
+
+    TlogReader reader;
+    ASSERT_TRUE(reader.open(path));
+    TlogReader::Record record;
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        ASSERT_TRUE(reader.next(record));
+        EXPECT_EQ(record.time_us, 1600000000000000 + i * 1000);
+        ASSERT_EQ(record.length, frames[i].size());
+        EXPECT_EQ(std::vector<uint8_t>(record.frame, record.frame + record.length), frames[i]);
+    }
+    EXPECT_FALSE(reader.next(record));
+
+    std::remove(path.c_str());
+}
+
+TEST(Tlog, StopsAtCutOffFrame)
+{
+    const auto path = temp_path("tlog_test_cut_off.tlog");
+    std::remove(path.c_str());
+
+    const auto frame = make_frame(0xFD, 28, 0);
+    {
+        TlogWriter writer;
+        ASSERT_TRUE(writer.open(path));
+        writer.write(frame.data(), frame.size(), 1);
+        writer.write(frame.data(), frame.size() / 2, 2);
+    }
+
+    TlogReader reader;
+    ASSERT_TRUE(reader.open(path));
+    TlogReader::Record record;
+    EXPECT_TRUE(reader.next(record));
+    EXPECT_FALSE(reader.next(record));
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,215 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace mavsdk {
+
+namespace {
+
+std::atomic<uint32_t> next_thread{1};
+
+void write_escaped(std::ostream& out, const char* text)
+{
+    for (const char* c = text; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\';
+        }
+        out << *c;
+    }
+}
+
+void write_us(std::ostream& out, uint64_t ns)
+{
+    out << ns / 1000 << '.' << std::setw(3) << std::setfill('0') << ns % 1000;
+}
+
+} // namespace
+
+Trace& Trace::instance()
+{
+    // Never destroyed, threads may still exit and give back their rings at exit.
+    static Trace* trace = new Trace();
+    return *trace;
+}
+
+Trace::RingHolder::~RingHolder()
+{
+    if (ring != nullptr) {
+        ring->in_use.store(false, std::memory_order_release);
+    }
+}
+
+void Trace::start()
+{
+    // Instead of clearing the rings under the writers, older events are skipped.
+    _start_ns.store(now_ns(), std::memory_order_relaxed);
+    _enabled.store(true, std::memory_order_relaxed);
+}
+
+void Trace::stop()
+{
+    _enabled.store(false, std::memory_order_relaxed);
+}
+
+Trace::Ring& Trace::ring_for_this_thread()
+{
+    thread_local RingHolder holder;
+    if (holder.ring != nullptr) {
+        return *holder.ring;
+    }
+
+    std::lock_guard<std::mutex> lock(_rings_mutex);
+    for (const auto& ring : _rings) {
+        bool in_use = false;
+        if (ring->in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire)) {
+            holder.ring = ring.get();
+            return *holder.ring;
+        }
+    }
+    _rings.push_back(std::make_unique<Ring>());
+    holder.ring = _rings.back().get();
+    return *holder.ring;
+}
+
+void Trace::record(Event event)
+{
+    thread_local const uint32_t this_thread = next_thread.fetch_add(1);
+    event.thread = this_thread;
+
+    Ring& ring = ring_for_this_thread();
+    const uint64_t index = ring.written.load(std::memory_order_relaxed);
+    Slot& slot = ring.slots[index % EVENTS_PER_THREAD];
+
+    std::array<uint64_t, NUM_WORDS> words{};
+    std::memcpy(words.data(), &event, sizeof(Event));
+
+    const uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t i = 0; i < NUM_WORDS; ++i) {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    ring.written.store(index + 1, std::memory_order_release);
+}
+
+void Trace::instant(const char* category, const char* name, uint64_t id)
+{
+    record({category, name, now_ns(), 0, id, 0, Phase::Instant});
+}
+
+uint64_t Trace::flow_start(const char* category, const char* name)
+{
+    const uint64_t flow_id = _next_flow_id.fetch_add(1, std::memory_order_relaxed);
+    record({category, name, now_ns(), 0, flow_id, 0, Phase::FlowStart});
+    return flow_id;
+}
+
+void Trace::flow_end(const char* category, const char* name, uint64_t flow_id)
+{
+    record({category, name, now_ns(), 0, flow_id, 0, Phase::FlowEnd});
+}
+
+std::vector<Trace::Event> Trace::events() const
+{
+    const uint64_t start_ns = _start_ns.load(std::memory_order_relaxed);
+
+    std::vector<Event> events;
+    std::lock_guard<std::mutex> lock(_rings_mutex);
+    for (const auto& ring : _rings) {
+        const uint64_t written = ring->written.load(std::memory_order_acquire);
+        const uint64_t first = written > EVENTS_PER_THREAD ? written - EVENTS_PER_THREAD : 0;
+
+        for (uint64_t index = first; index < written; ++index) {
+            const Slot& slot = ring->slots[index % EVENTS_PER_THREAD];
+            const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if ((sequence & 1) != 0) {
+                continue;
+            }
+            std::array<uint64_t, NUM_WORDS> words;
+            for (std::size_t i = 0; i < NUM_WORDS; ++i) {
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+                continue;
+            }
+
+            Event event;
+            std::memcpy(static_cast<void*>(&event), words.data(), sizeof(Event));
+            if (event.start_ns >= start_ns) {
+                events.push_back(event);
+            }
+        }
+    }
+
+    std::stable_sort(events.begin(), events.end(), [](const Event& lhs, const Event& rhs) {
+        return lhs.start_ns < rhs.start_ns;
+    });
+    return events;
+}
+
+std::string Trace::export_json() const
+{
+    const uint64_t start_ns = _start_ns.load(std::memory_order_relaxed);
+
+    std::ostringstream out;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto& event : events()) {
+        out << (first ? "\n" : ",\n");
+        first = false;
+
+        out << "{\"cat\":\"";
+        write_escaped(out, event.category);
+        out << "\",\"name\":\"";
+        write_escaped(out, event.name);
+        out << "\",\"pid\":1,\"tid\":" << event.thread << ",\"ts\":";
+        write_us(out, event.start_ns - start_ns);
+
+        switch (event.phase) {
+            case Phase::Complete:
+                out << ",\"ph\":\"X\",\"dur\":";
+                write_us(out, event.duration_ns);
+                out << ",\"args\":{\"id\":" << event.id << "}";
+                break;
+            case Phase::Instant:
+                out << ",\"ph\":\"i\",\"s\":\"t\",\"args\":{\"id\":" << event.id << "}";
+                break;
+            case Phase::FlowStart:
+                out << ",\"ph\":\"s\",\"id\":" << event.id;
+                break;
+            case Phase::FlowEnd:
+                // Bound to the event it is in, like the callback being run.
+                out << ",\"ph\":\"f\",\"bp\":\"e\",\"id\":" << event.id;
+                break;
+        }
+        out << "}";
+    }
+    out << "\n]}\n";
+    return out.str();
+}
+
+bool Trace::export_json(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file << export_json();
+    return static_cast<bool>(file);
+}
+
+uint64_t Trace::now_ns()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+} // namespace mavsdk
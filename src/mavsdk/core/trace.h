@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Trace points are compiled out with MAVSDK_TRACING=0. The arguments of a
+// removed trace point are not evaluated.
+#if !defined(MAVSDK_TRACING)
+#define MAVSDK_TRACING 1
+#endif
+
+#if MAVSDK_TRACING
+
+#define MAVSDK_TRACE_CONCAT_(a, b) a##b
+#define MAVSDK_TRACE_CONCAT(a, b) MAVSDK_TRACE_CONCAT_(a, b)
+
+// Records the rest of the enclosing block as one event.
+#define MAVSDK_TRACE_SCOPE(category, name, id) \
+    mavsdk::Trace::Scope MAVSDK_TRACE_CONCAT(trace_scope_, __LINE__)(category, name, id)
+
+#define MAVSDK_TRACE_INSTANT(category, name, id) \
+    do { \
+        if (mavsdk::Trace::enabled()) { \
+            mavsdk::Trace::instance().instant(category, name, id); \
+        } \
+    } while (false)
+
+// Links where something was handed on to where it is picked up again, like a
+// user callback queued on one thread and run on another. Start returns the
+// id to end the flow with, 0 if tracing is off.
+#define MAVSDK_TRACE_FLOW_START(category, name) \
+    (mavsdk::Trace::enabled() ? mavsdk::Trace::instance().flow_start(category, name) : \
+                                uint64_t{0})
+
+#define MAVSDK_TRACE_FLOW_END(category, name, flow_id) \
+    do { \
+        if ((flow_id) != 0 && mavsdk::Trace::enabled()) { \
+            mavsdk::Trace::instance().flow_end(category, name, flow_id); \
+        } \
+    } while (false)
+
+#else
+
+#define MAVSDK_TRACE_SCOPE(category, name, id) static_cast<void>(0)
+#define MAVSDK_TRACE_INSTANT(category, name, id) static_cast<void>(0)
+#define MAVSDK_TRACE_FLOW_START(category, name) uint64_t{0}
+#define MAVSDK_TRACE_FLOW_END(category, name, flow_id) static_cast<void>(0)
+
+#endif
+
+namespace mavsdk {
+
+// Records single events, like a message being dispatched or a user callback
+// running, to be looked at as a timeline in Perfetto or chrome://tracing.
+//
+// Each thread writes into a ring of its own, so recording never takes a lock
+// or waits for another thread. Once a ring is full, the oldest events of that
+// thread are overwritten. Exporting copies the rings without holding up the
+// writers, an event overwritten while being copied is skipped.
+//
+// Tracing is off until started, which leaves one relaxed load per trace
+// point.
+class Trace {
+public:
+    enum class Phase : uint8_t { Complete, Instant, FlowStart, FlowEnd };
+
+    struct Event {
+        // Both are string literals, so they are not copied.
+        const char* category{""};
+        const char* name{""};
+        uint64_t start_ns{0};
+        uint64_t duration_ns{0};
+        // Message ID, command, sequence or flow, depending on the trace point.
+        uint64_t id{0};
+        uint32_t thread{0};
+        Phase phase{Phase::Instant};
+    };
+
+    static constexpr std::size_t EVENTS_PER_THREAD = 4096;
+
+    // Non-copyable
+    Trace(const Trace&) = delete;
+    const Trace& operator=(const Trace&) = delete;
+
+    // The one the trace points record into.
+    static Trace& instance();
+
+    [[nodiscard]] static bool enabled() { return _enabled.load(std::memory_order_relaxed); }
+
+    // Drops what was recorded before.
+    void start();
+    void stop();
+
+    void record(Event event);
+    void instant(const char* category, const char* name, uint64_t id);
+    uint64_t flow_start(const char* category, const char* name);
+    void flow_end(const char* category, const char* name, uint64_t flow_id);
+
+    // Events recorded since the start, ordered by time.
+    [[nodiscard]] std::vector<Event> events() const;
+
+    // In the Trace Event Format read by Perfetto and chrome://tracing.
+    [[nodiscard]] std::string export_json() const;
+    bool export_json(const std::string& path) const;
+
+    static uint64_t now_ns();
+
+    class Scope {
+    public:
+        Scope(const char* category, const char* name, uint64_t id) :
+            _category(category),
+            _name(name),
+            _id(id),
+            _start_ns(enabled() ? now_ns() : 0)
+        {}
+
+        ~Scope()
+        {
+            if (_start_ns != 0 && enabled()) {
+                instance().record(
+                    {_category, _name, _start_ns, now_ns() - _start_ns, _id, 0, Phase::Complete});
+            }
+        }
+
+        // Non-copyable
+        Scope(const Scope&) = delete;
+        const Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* _category;
+        const char* _name;
+        uint64_t _id;
+        uint64_t _start_ns;
+    };
+
+private:
+    // There is only the one instance, as each thread keeps its ring.
+    Trace() = default;
+    ~Trace() = default;
+
+    static constexpr std::size_t NUM_WORDS = (sizeof(Event) + sizeof(uint64_t) - 1) / 8;
+
+    // Odd sequence while the event is written, as in Seqlock.
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::array<std::atomic<uint64_t>, NUM_WORDS> words{};
+    };
+
+    struct Ring {
+        std::array<Slot, EVENTS_PER_THREAD> slots{};
+        std::atomic<uint64_t> written{0};
+        // Handed to the next new thread once the one using it exited.
+        std::atomic<bool> in_use{true};
+    };
+
+    struct RingHolder {
+        ~RingHolder();
+        Ring* ring{nullptr};
+    };
+
+    Ring& ring_for_this_thread();
+
+    inline static std::atomic<bool> _enabled{false};
+
+    std::atomic<uint64_t> _start_ns{0};
+    std::atomic<uint64_t> _next_flow_id{1};
+
+    mutable std::mutex _rings_mutex{};
+    std::vector<std::unique_ptr<Ring>> _rings{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,101 @@
+#include "trace.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace mavsdk;
+
+TEST(Trace, NothingRecordedWhileStopped)
+{
+    auto& trace = Trace::instance();
+    trace.start();
+    trace.stop();
+
+    {
+        MAVSDK_TRACE_SCOPE("test", "scope", 1);
+        MAVSDK_TRACE_INSTANT("test", "instant", 2);
+    }
+
+    EXPECT_TRUE(trace.events().empty());
+}
+
+TEST(Trace, ScopeRecordsCompleteEvent)
+{
+    auto& trace = Trace::instance();
+    trace.start();
+    {
+        MAVSDK_TRACE_SCOPE("test", "scope", 42);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    trace.stop();
+
+    const auto events = trace.events();
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_STREQ(events[0].category, "test");
+    EXPECT_STREQ(events[0].name, "scope");
+    EXPECT_EQ(events[0].id, 42);
+    EXPECT_EQ(events[0].phase, Trace::Phase::Complete);
+    EXPECT_GE(events[0].duration_ns, 2000000);
+}
+
+TEST(Trace, StartDropsEarlierEvents)
+{
+    auto& trace = Trace::instance();
+    trace.start();
+    trace.instant("test", "before", 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    trace.start();
+    trace.instant("test", "after", 2);
+    trace.stop();
+
+    const auto events = trace.events();
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_EQ(events[0].id, 2);
+}
+
+TEST(Trace, FullRingOverwritesOldest)
+{
+    auto& trace = Trace::instance();
+    trace.start();
+    for (uint64_t i = 0; i < Trace::EVENTS_PER_THREAD + 10; ++i) {
+        trace.instant("test", "instant", i);
+    }
+    trace.stop();
+
+    const auto events = trace.events();
+    ASSERT_EQ(events.size(), Trace::EVENTS_PER_THREAD);
+    EXPECT_EQ(events.front().id, 10);
+    EXPECT_EQ(events.back().id, Trace::EVENTS_PER_THREAD + 9);
+}
+
+TEST(Trace, ThreadsRecordSeparately)
+{
+    auto& trace = Trace::instance();
+    trace.start();
+    std::thread first([&]() { trace.instant("test", "first", 1); });
+    first.join();
+    std::thread second([&]() { trace.instant("test", "second", 2); });
+    second.join();
+    trace.stop();
+
+    const auto events = trace.events();
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_NE(events[0].thread, events[1].thread);
+}
+
+TEST(Trace, ExportsFlowsAsJson)
+{
+    auto& trace = Trace::instance();
+    trace.start();
+    const auto flow_id = trace.flow_start("callback", "queued");
+    trace.flow_end("callback", "queued", flow_id);
+    trace.record(
+        {"callback", "run \"quoted\"", Trace::now_ns(), 1500, 7, 0, Trace::Phase::Complete});
+    trace.stop();
+
+    const auto json = trace.export_json();
+    EXPECT_NE(json.find("\"traceEvents\":["), std::string::npos);
+    EXPECT_NE(json.find("\"ph\":\"s\",\"id\":" + std::to_string(flow_id)), std::string::npos);
+    EXPECT_NE(json.find("\"ph\":\"f\",\"bp\":\"e\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"run \\\"quoted\\\"\""), std::string::npos);
+    EXPECT_NE(json.find("\"dur\":1.500"), std::string::npos);
+}
@@ -0,0 +1,133 @@
+#include "tx_scheduler.h"
+
+#include <algorithm>
+
+namespace mavsdk {
+
+TxScheduler::TxScheduler(double bytes_per_s, double burst_s, std::size_t max_queued_bytes) :
+    _bytes_per_s(bytes_per_s),
+    _burst_bytes(std::max(bytes_per_s * burst_s, static_cast<double>(MAVLINK_MAX_PACKET_LEN))),
+    _max_queued_bytes(max_queued_bytes),
+    _budget_bytes(_burst_bytes)
+{}
+
+TxScheduler::Priority TxScheduler::priority_for(uint32_t message_id)
+{
+    switch (message_id) {
+        // Without these in time, the vehicle drops out of offboard mode or
+        // considers the link lost.
+        case MAVLINK_MSG_ID_HEARTBEAT:
+        case MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED:
+        case MAVLINK_MSG_ID_SET_POSITION_TARGET_GLOBAL_INT:
+        case MAVLINK_MSG_ID_SET_ATTITUDE_TARGET:
+        case MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET:
+        case MAVLINK_MSG_ID_MANUAL_CONTROL:
+        case MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
+            return Priority::Control;
+
+        // Delaying these only causes retransmissions and timeouts.
+        case MAVLINK_MSG_ID_COMMAND_LONG:
+        case MAVLINK_MSG_ID_COMMAND_INT:
+        case MAVLINK_MSG_ID_COMMAND_ACK:
+        case MAVLINK_MSG_ID_COMMAND_CANCEL:
+        case MAVLINK_MSG_ID_PARAM_REQUEST_READ:
+        case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
+        case MAVLINK_MSG_ID_PARAM_SET:
+        case MAVLINK_MSG_ID_PARAM_VALUE:
+        case MAVLINK_MSG_ID_PARAM_EXT_REQUEST_READ:
+        case MAVLINK_MSG_ID_PARAM_EXT_REQUEST_LIST:
+        case MAVLINK_MSG_ID_PARAM_EXT_SET:
+        case MAVLINK_MSG_ID_PARAM_EXT_VALUE:
+        case MAVLINK_MSG_ID_PARAM_EXT_ACK:
+        case MAVLINK_MSG_ID_MISSION_ACK:
+        case MAVLINK_MSG_ID_TIMESYNC:
+            return Priority::Command;
+
+        // Transfers which can take whatever bandwidth is left.
+        case MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL:
+        case MAVLINK_MSG_ID_LOG_REQUEST_LIST:
+        case MAVLINK_MSG_ID_LOG_ENTRY:
+        case MAVLINK_MSG_ID_LOG_REQUEST_DATA:
+        case MAVLINK_MSG_ID_LOG_DATA:
+        case MAVLINK_MSG_ID_MISSION_COUNT:
+        case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+        case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+        case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+        case MAVLINK_MSG_ID_ENCAPSULATED_DATA:
+        case MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE:
+            return Priority::Bulk;
+
+        default:
+            return Priority::Telemetry;
+    }
+}
+
+void TxScheduler::push(const MavlinkFrame& frame)
+{
+    auto& queue = _queues[static_cast<std::size_t>(priority_for(frame.message_id))];
+
+    // The oldest frames are the least useful ones, e.g. a stale setpoint, and
+    // the protocols of the other classes retransmit anyway.
+    while (!queue.frames.empty() && queue.bytes + frame.length > _max_queued_bytes) {
+        queue.bytes -= queue.frames.front().length;
+        queue.frames.pop_front();
+        ++_dropped;
+    }
+
+    queue.frames.push_back(frame);
+    queue.bytes += frame.length;
+}
+
+std::optional<MavlinkFrame> TxScheduler::pop(double now_s)
+{
+    refill(now_s);
+
+    if (_budget_bytes < 0.0) {
+        return std::nullopt;
+    }
+
+    for (auto& queue : _queues) {
+        if (queue.frames.empty()) {
+            continue;
+        }
+        std::optional<MavlinkFrame> frame{queue.frames.front()};
+        queue.frames.pop_front();
+        queue.bytes -= frame->length;
+        _budget_bytes -= frame->length;
+        return frame;
+    }
+
+    return std::nullopt;
+}
+
+double TxScheduler::delay_s(double now_s) const
+{
+    if (!_refilled) {
+        return 0.0;
+    }
+
+    const double budget_bytes = std::min(
+        _burst_bytes, _budget_bytes + std::max(0.0, now_s - _last_refill_s) * _bytes_per_s);
+
+    return budget_bytes >= 0.0 ? 0.0 : -budget_bytes / _bytes_per_s;
+}
+
+bool TxScheduler::empty() const
+{
+    return std::all_of(
+        _queues.begin(), _queues.end(), [](const Queue& queue) { return queue.frames.empty(); });
+}
+
+void TxScheduler::refill(double now_s)
+{
+    if (_refilled && now_s > _last_refill_s) {
+        _budget_bytes =
+            std::min(_burst_bytes, _budget_bytes + (now_s - _last_refill_s) * _bytes_per_s);
+    }
+    if (!_refilled || now_s > _last_refill_s) {
+        _last_refill_s = now_s;
+        _refilled = true;
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include "connection.h"
+
+namespace mavsdk {
+
+// Decides in which order, and how fast, queued frames go out over a link of
+// limited bandwidth such as a telemetry radio.
+//
+// Frames are queued by priority class and always taken from the highest
+// class first, so bulk transfers (FTP, logs, missions) only get what is left
+// after control, command and telemetry traffic. The rate is limited by a
+// byte budget which refills with the bandwidth of the link, so frames queue
+// up here, where they can be reordered, rather than in the driver.
+//
+// Not thread-safe, the owner needs to serialize access.
+class TxScheduler {
+public:
+    enum class Priority { Control, Command, Telemetry, Bulk };
+    static constexpr std::size_t NUM_PRIORITIES = 4;
+
+    // Bytes a class can have queued before its oldest frames are dropped.
+    static constexpr std::size_t DEFAULT_MAX_QUEUED_BYTES = 4096;
+    // How long the link can be busy with what is sent at once.
+    static constexpr double DEFAULT_BURST_S = 0.05;
+
+    explicit TxScheduler(
+        double bytes_per_s,
+        double burst_s = DEFAULT_BURST_S,
+        std::size_t max_queued_bytes = DEFAULT_MAX_QUEUED_BYTES);
+
+    // A serial link with 8N1 framing carries 10 bits per byte.
+    static double bytes_per_s_for_baudrate(int baudrate) { return baudrate / 10.0; }
+
+    static Priority priority_for(uint32_t message_id);
+
+    void push(const MavlinkFrame& frame);
+
+    // Takes the next frame if the budget allows for one at now_s.
+    std::optional<MavlinkFrame> pop(double now_s);
+
+    // Seconds until pop returns the next frame, 0 if it can right away.
+    [[nodiscard]] double delay_s(double now_s) const;
+
+    [[nodiscard]] bool empty() const;
+
+    [[nodiscard]] uint64_t dropped() const { return _dropped; }
+
+private:
+    void refill(double now_s);
+
+    struct Queue {
+        std::deque<MavlinkFrame> frames{};
+        std::size_t bytes{0};
+    };
+
+    const double _bytes_per_s;
+    const double _burst_bytes;
+    const std::size_t _max_queued_bytes;
+
+    std::array<Queue, NUM_PRIORITIES> _queues{};
+
+    // Can go negative: a frame goes out as soon as the budget is not negative,
+    // so frames bigger than the burst are not stuck forever.
+    double _budget_bytes;
+    double _last_refill_s{0.0};
+    bool _refilled{false};
+
+    uint64_t _dropped{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,127 @@
+#include "tx_scheduler.h"
+
+#include <algorithm>
+#include <iterator>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+MavlinkFrame heartbeat()
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(245, MAV_COMP_ID_MISSIONPLANNER, &message, MAV_TYPE_GCS, 0, 0, 0, 0);
+    return MavlinkFrame(message);
+}
+
+MavlinkFrame attitude()
+{
+    mavlink_message_t message;
+    mavlink_msg_attitude_pack(1, MAV_COMP_ID_AUTOPILOT1, &message, 1, 0.1f, 0.2f, 0.3f, 0, 0, 0);
+    return MavlinkFrame(message);
+}
+
+MavlinkFrame ftp()
+{
+    // Not all zeros, so the payload is not truncated.
+    uint8_t payload[251];
+    std::fill(std::begin(payload), std::end(payload), 1);
+
+    mavlink_message_t message;
+    mavlink_msg_file_transfer_protocol_pack(
+        245, MAV_COMP_ID_MISSIONPLANNER, &message, 0, 1, 1, payload);
+    return MavlinkFrame(message);
+}
+
+} // namespace
+
+TEST(TxScheduler, HigherPrioritiesGoFirst)
+{
+    TxScheduler scheduler(100000.0);
+
+    scheduler.push(ftp());
+    scheduler.push(attitude());
+    scheduler.push(heartbeat());
+
+    auto first = scheduler.pop(0.0);
+    auto second = scheduler.pop(0.0);
+    auto third = scheduler.pop(0.0);
+    ASSERT_TRUE(first && second && third);
+    EXPECT_EQ(first->message_id, MAVLINK_MSG_ID_HEARTBEAT);
+    EXPECT_EQ(second->message_id, MAVLINK_MSG_ID_ATTITUDE);
+    EXPECT_EQ(third->message_id, MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL);
+
+    EXPECT_FALSE(scheduler.pop(0.0));
+    EXPECT_TRUE(scheduler.empty());
+}
+
+TEST(TxScheduler, LimitsRateToBudget)
+{
+    // The burst is at least one full frame.
+    TxScheduler scheduler(1000.0, 0.05);
+    const auto frame = ftp();
+
+    for (int i = 0; i < 3; ++i) {
+        scheduler.push(frame);
+    }
+
+    // One frame goes with the full budget, the next one as long as the
+    // budget is not negative yet.
+    EXPECT_TRUE(scheduler.pop(0.0));
+    EXPECT_TRUE(scheduler.pop(0.0));
+    EXPECT_FALSE(scheduler.pop(0.0));
+
+    const double budget_bytes = MAVLINK_MAX_PACKET_LEN - 2.0 * frame.length;
+    EXPECT_NEAR(scheduler.delay_s(0.0), -budget_bytes / 1000.0, 1e-9);
+    EXPECT_FALSE(scheduler.pop(0.1));
+    EXPECT_TRUE(scheduler.pop(0.3));
+    EXPECT_TRUE(scheduler.empty());
+}
+
+TEST(TxScheduler, ControlOvertakesQueuedBulk)
+{
+    TxScheduler scheduler(1000.0);
+
+    for (int i = 0; i < 5; ++i) {
+        scheduler.push(ftp());
+    }
+    EXPECT_TRUE(scheduler.pop(0.0));
+    EXPECT_TRUE(scheduler.pop(0.0));
+    EXPECT_FALSE(scheduler.pop(0.0));
+
+    scheduler.push(heartbeat());
+    const auto frame = scheduler.pop(1.0);
+    ASSERT_TRUE(frame);
+    EXPECT_EQ(frame->message_id, MAVLINK_MSG_ID_HEARTBEAT);
+}
+
+TEST(TxScheduler, DropsOldestOnOverflow)
+{
+    const auto frame = heartbeat();
+    TxScheduler scheduler(100000.0, TxScheduler::DEFAULT_BURST_S, 4 * frame.length);
+
+    for (int i = 0; i < 10; ++i) {
+        scheduler.push(frame);
+    }
+    EXPECT_EQ(scheduler.dropped(), 6u);
+
+    int popped = 0;
+    while (scheduler.pop(0.0)) {
+        ++popped;
+    }
+    EXPECT_EQ(popped, 4);
+}
+
+TEST(TxScheduler, ClassifiesMessages)
+{
+    EXPECT_EQ(
+        TxScheduler::priority_for(MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED),
+        TxScheduler::Priority::Control);
+    EXPECT_EQ(
+        TxScheduler::priority_for(MAVLINK_MSG_ID_COMMAND_ACK), TxScheduler::Priority::Command);
+    EXPECT_EQ(
+        TxScheduler::priority_for(MAVLINK_MSG_ID_GLOBAL_POSITION_INT),
+        TxScheduler::Priority::Telemetry);
+    EXPECT_EQ(TxScheduler::priority_for(MAVLINK_MSG_ID_LOG_DATA), TxScheduler::Priority::Bulk);
+}
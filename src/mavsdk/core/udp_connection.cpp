@@ -1,5 +1,7 @@
 #include "udp_connection.h"
+#include "io_reactor.h"
 #include "log.h"
+#include "message_latency.h"
 
 #ifdef WINDOWS
 #include <winsock2.h>
@@ -17,6 +19,8 @@
 #endif
 
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <utility>
 
 #ifdef WINDOWS
@@ -45,16 +49,16 @@ UdpConnection::~UdpConnection()
 
 ConnectionResult UdpConnection::start()
 {
-    if (!start_mavlink_receiver()) {
-        return ConnectionResult::ConnectionsExhausted;
-    }
+    // Parsers are created per remote as datagrams arrive.
+    _receivers.clear();
+    _last_remote_sysid = 0;
 
     ConnectionResult ret = setup_port();
     if (ret != ConnectionResult::Success) {
         return ret;
     }
 
-    start_recv_thread();
+    start_receiving();
 
     return ConnectionResult::Success;
 }
@@ -69,19 +73,42 @@ ConnectionResult UdpConnection::setup_port()
     }
 #endif
 
-    _socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    // Binding to an IPv6 address, e.g. "::" for all of them, gives a socket
+    // which takes IPv4 remotes as well.
+    _ipv6 = _local_ip.find(':') != std::string::npos;
+
+    _socket_fd = socket(_ipv6 ? AF_INET6 : AF_INET, SOCK_DGRAM, 0);
 
     if (_socket_fd < 0) {
         LogErr() << "socket error" << GET_ERROR(errno);
         return ConnectionResult::SocketError;
     }
 
-    struct sockaddr_in addr {};
-    addr.sin_family = AF_INET;
-    inet_pton(AF_INET, _local_ip.c_str(), &(addr.sin_addr));
-    addr.sin_port = htons(_local_port_number);
+    struct sockaddr_storage addr {};
+    socklen_t addr_len = 0;
+    if (_ipv6) {
+        const int v6only = 0;
+        setsockopt(
+            _socket_fd,
+            IPPROTO_IPV6,
+            IPV6_V6ONLY,
+            reinterpret_cast<const char*>(&v6only),
+            sizeof(v6only));
+
+        auto& addr6 = reinterpret_cast<struct sockaddr_in6&>(addr);
+        addr6.sin6_family = AF_INET6;
+        inet_pton(AF_INET6, _local_ip.c_str(), &(addr6.sin6_addr));
+        addr6.sin6_port = htons(_local_port_number);
+        addr_len = sizeof(addr6);
+    } else {
+        auto& addr4 = reinterpret_cast<struct sockaddr_in&>(addr);
+        addr4.sin_family = AF_INET;
+        inet_pton(AF_INET, _local_ip.c_str(), &(addr4.sin_addr));
+        addr4.sin_port = htons(_local_port_number);
+        addr_len = sizeof(addr4);
+    }
 
-    if (bind(_socket_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    if (bind(_socket_fd, reinterpret_cast<sockaddr*>(&addr), addr_len) != 0) {
         LogErr() << "bind error: " << GET_ERROR(errno);
         return ConnectionResult::BindError;
     }
@@ -89,15 +116,32 @@ ConnectionResult UdpConnection::setup_port()
     return ConnectionResult::Success;
 }
 
-void UdpConnection::start_recv_thread()
+void UdpConnection::start_receiving()
 {
-    _recv_thread = std::make_unique<std::thread>(&UdpConnection::receive, this);
+#if defined(LINUX)
+    _recv_buffers.resize(RECV_BATCH_SIZE * RECV_BUFFER_SIZE);
+    _reactor_handle = IoReactor::instance().add_fd(
+        _socket_fd, IoReactor::Readable, [this](unsigned) { receive_batch(); });
+#else
+    _recv_thread = std::make_unique<NativeThread>(
+        _thread_setup.settings.stack_size_bytes, [this]() { receive(); });
+#endif
 }
 
 ConnectionResult UdpConnection::stop()
 {
+    stop_link_emulation();
+
     _should_exit = true;
 
+#if defined(LINUX)
+    // After this the reactor doesn't call us anymore.
+    if (_reactor_handle != 0) {
+        IoReactor::instance().remove(_reactor_handle);
+        _reactor_handle = 0;
+    }
+#endif
+
 #ifndef WINDOWS
     // This should interrupt a recv/recvfrom call.
     shutdown(_socket_fd, SHUT_RDWR);
@@ -112,97 +156,334 @@ ConnectionResult UdpConnection::stop()
     WSACleanup();
 #endif
 
+#if !defined(LINUX)
     if (_recv_thread) {
         _recv_thread->join();
         _recv_thread.reset();
     }
+#endif
 
-    // We need to stop this after stopping the receive thread, otherwise
+    // We need to clear these after stopping the receive thread, otherwise
     // it can happen that we interfere with the parsing of a message.
-    stop_mavlink_receiver();
+    _receivers.clear();
 
     return ConnectionResult::Success;
 }
 
-bool UdpConnection::send_message(const mavlink_message_t& message)
+bool UdpConnection::send_frame(const MavlinkFrame& frame)
 {
-    std::lock_guard<std::mutex> lock(_remote_mutex);
+    const auto remotes = std::atomic_load(&_remotes);
 
-    if (_remotes.size() == 0) {
+    if (remotes->empty()) {
         LogErr() << "No known remotes";
         return false;
     }
 
-    // Send the message to all the remotes. A remote is a UDP endpoint
-    // identified by its <ip, port>. This means that if we have two
-    // systems on two different endpoints, then messages directed towards
-    // only one system will be sent to both remotes. The systems are
-    // then expected to ignore messages that are not directed to them.
+    std::vector<Datagram> datagrams;
+    add_datagrams(frame, *remotes, datagrams);
+
+#if defined(LINUX)
+    if (datagrams.size() > 1) {
+        return send_datagrams_batched(datagrams);
+    }
+#endif
+
     bool send_successful = true;
-    for (auto& remote : _remotes) {
-        struct sockaddr_in dest_addr {};
-        dest_addr.sin_family = AF_INET;
+    for (const auto& datagram : datagrams) {
+        if (!send_datagram(datagram)) {
+            send_successful = false;
+        }
+    }
 
-        inet_pton(AF_INET, remote.ip.c_str(), &dest_addr.sin_addr.s_addr);
-        dest_addr.sin_port = htons(remote.port_number);
+    return send_successful;
+}
 
-        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-        uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+void UdpConnection::add_datagrams(
+    const MavlinkFrame& frame,
+    const std::vector<Remote>& remotes,
+    std::vector<Datagram>& datagrams) const
+{
+    // A remote is a UDP endpoint identified by its <ip, port>. Messages for
+    // one system only go to the endpoint we hear that system on, so the
+    // traffic grows with the number of targets rather than with the number of
+    // remotes. Everything else, and messages for systems we haven't heard
+    // from yet, goes to all remotes, which are then expected to ignore
+    // messages that are not directed to them.
+    if (frame.target_system_id != 0) {
+        // The remote might have been added after the snapshot was taken.
+        const uint32_t index =
+            _system_remotes[frame.target_system_id].load(std::memory_order_relaxed);
+        if (index != 0 && index <= remotes.size()) {
+            datagrams.push_back({&frame, remotes[index - 1]});
+            return;
+        }
+    }
 
-        const auto send_len = sendto(
-            _socket_fd,
-            reinterpret_cast<char*>(buffer),
-            buffer_len,
-            0,
-            reinterpret_cast<const sockaddr*>(&dest_addr),
-            sizeof(dest_addr));
+    for (const auto& remote : remotes) {
+        datagrams.push_back({&frame, remote});
+    }
+}
 
-        if (send_len != buffer_len) {
-            LogErr() << "sendto failure: " << GET_ERROR(errno);
-            send_successful = false;
-            continue;
+bool UdpConnection::send_datagram(const Datagram& datagram)
+{
+    struct sockaddr_storage dest_addr {};
+    const auto dest_addr_len = datagram.remote.to_sockaddr(dest_addr, _ipv6);
+
+    const auto send_len = sendto(
+        _socket_fd,
+        reinterpret_cast<const char*>(datagram.frame->buffer),
+        datagram.frame->length,
+        0,
+        reinterpret_cast<const sockaddr*>(&dest_addr),
+        dest_addr_len);
+
+    if (send_len != datagram.frame->length) {
+        LogErr() << "sendto failure: " << GET_ERROR(errno);
+        return false;
+    }
+
+    return true;
+}
+
+#if defined(LINUX)
+bool UdpConnection::send_frames(const std::vector<const MavlinkFrame*>& frames)
+{
+    const auto remotes = std::atomic_load(&_remotes);
+
+    if (remotes->empty()) {
+        LogErr() << "No known remotes";
+        return false;
+    }
+
+    std::vector<Datagram> datagrams;
+    datagrams.reserve(frames.size());
+    for (const auto* frame : frames) {
+        add_datagrams(*frame, *remotes, datagrams);
+    }
+
+    return send_datagrams_batched(datagrams);
+}
+
+bool UdpConnection::send_datagrams_batched(const std::vector<Datagram>& datagrams)
+{
+    // One sendmmsg call covers SEND_BATCH_SIZE of the datagrams at a time.
+    std::array<struct iovec, SEND_BATCH_SIZE> iovs{};
+    std::array<struct sockaddr_storage, SEND_BATCH_SIZE> dest_addrs{};
+    std::array<struct mmsghdr, SEND_BATCH_SIZE> msgs{};
+
+    const std::size_t total = datagrams.size();
+
+    bool send_successful = true;
+    for (std::size_t offset = 0; offset < total; offset += SEND_BATCH_SIZE) {
+        const std::size_t num = std::min(SEND_BATCH_SIZE, total - offset);
+
+        for (std::size_t i = 0; i < num; ++i) {
+            const auto& datagram = datagrams[offset + i];
+
+            iovs[i].iov_base = const_cast<uint8_t*>(datagram.frame->buffer);
+            iovs[i].iov_len = datagram.frame->length;
+
+            msgs[i] = {};
+            msgs[i].msg_hdr.msg_name = &dest_addrs[i];
+            msgs[i].msg_hdr.msg_namelen = datagram.remote.to_sockaddr(dest_addrs[i], _ipv6);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        std::size_t sent = 0;
+        while (sent < num) {
+            const int result =
+                sendmmsg(_socket_fd, &msgs[sent], static_cast<unsigned>(num - sent), 0);
+            if (result <= 0) {
+                LogErr() << "sendmmsg failure: " << GET_ERROR(errno);
+                send_successful = false;
+                // Skip the one that failed and carry on with the rest.
+                ++sent;
+                continue;
+            }
+            sent += static_cast<std::size_t>(result);
         }
     }
 
     return send_successful;
 }
+#endif
 
 void UdpConnection::add_remote(const std::string& remote_ip, const int remote_port)
 {
-    add_remote_with_remote_sysid(remote_ip, remote_port, 0);
+    Remote remote;
+    struct in_addr address4 {};
+    struct in6_addr address6 {};
+    if (inet_pton(AF_INET, remote_ip.c_str(), &address4) == 1) {
+        remote.address[10] = 0xff;
+        remote.address[11] = 0xff;
+        std::memcpy(&remote.address[12], &address4, sizeof(address4));
+    } else if (inet_pton(AF_INET6, remote_ip.c_str(), &address6) == 1) {
+        std::memcpy(remote.address.data(), &address6, sizeof(address6));
+    } else {
+        LogErr() << "Invalid remote IP: " << remote_ip;
+        return;
+    }
+
+    if (!_ipv6 && !remote.is_ipv4()) {
+        LogErr() << "Remote IP " << remote_ip << " needs an IPv6 local IP";
+        return;
+    }
+
+    remote.port = htons(static_cast<uint16_t>(remote_port));
+    add_remote_with_remote_sysid(remote, 0);
 }
 
-void UdpConnection::add_remote_with_remote_sysid(
-    const std::string& remote_ip, const int remote_port, const uint8_t remote_sysid)
+void UdpConnection::add_remote_with_remote_sysid(const Remote& remote, const uint8_t remote_sysid)
 {
-    std::lock_guard<std::mutex> lock(_remote_mutex);
-    Remote new_remote;
-    new_remote.ip = remote_ip;
-    new_remote.port_number = remote_port;
+    if (remote_sysid != 0) {
+        // Usually the system is on the remote it was heard on last.
+        const auto remotes = std::atomic_load(&_remotes);
+        const uint32_t index = _system_remotes[remote_sysid].load(std::memory_order_relaxed);
+        if (index != 0 && index <= remotes->size() && (*remotes)[index - 1] == remote) {
+            return;
+        }
+    }
 
-    auto existing_remote =
-        std::find_if(_remotes.begin(), _remotes.end(), [&new_remote](Remote& remote) {
-            return remote == new_remote;
-        });
+    std::lock_guard<std::mutex> lock(_remote_mutex);
 
-    if (existing_remote == _remotes.end()) {
+    std::size_t index = 0;
+    const auto it = _remote_indices.find(remote);
+    if (it != _remote_indices.end()) {
+        index = it->second;
+    } else {
         // System with sysid 0 is a bit special: it is a placeholder for a connection initiated
         // by MAVSDK. As such, it should not be advertised as a newly discovered system.
         if (static_cast<int>(remote_sysid) != 0) {
-            LogInfo() << "New system on: " << new_remote.ip << ":" << new_remote.port_number
+            LogInfo() << "New system on: " << remote.to_string()
                       << " (with sysid: " << static_cast<int>(remote_sysid) << ")";
         }
-        _remotes.push_back(new_remote);
+
+        auto new_remotes = std::make_shared<std::vector<Remote>>(*_remotes);
+        new_remotes->push_back(remote);
+        index = new_remotes->size() - 1;
+        _remote_indices.emplace(remote, index);
+        std::atomic_store(&_remotes, std::shared_ptr<const std::vector<Remote>>(new_remotes));
+    }
+
+    if (remote_sysid != 0) {
+        // A system can come back on another port, e.g. after a restart, so
+        // this follows it to where it was heard last.
+        _system_remotes[remote_sysid].store(
+            static_cast<uint32_t>(index + 1), std::memory_order_relaxed);
+    }
+}
+
+bool UdpConnection::Remote::is_ipv4() const
+{
+    static constexpr std::array<uint8_t, 12> ipv4_prefix{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+    return std::equal(ipv4_prefix.begin(), ipv4_prefix.end(), address.begin());
+}
+
+std::string UdpConnection::Remote::to_string() const
+{
+    char ip[INET6_ADDRSTRLEN] = {};
+    if (is_ipv4()) {
+        inet_ntop(AF_INET, const_cast<uint8_t*>(&address[12]), ip, sizeof(ip));
+        return std::string(ip) + ":" + std::to_string(ntohs(port));
+    }
+    inet_ntop(AF_INET6, const_cast<uint8_t*>(address.data()), ip, sizeof(ip));
+    return "[" + std::string(ip) + "]:" + std::to_string(ntohs(port));
+}
+
+UdpConnection::Remote UdpConnection::Remote::from_sockaddr(const struct sockaddr_storage& addr)
+{
+    Remote remote;
+    if (addr.ss_family == AF_INET6) {
+        const auto& addr6 = reinterpret_cast<const struct sockaddr_in6&>(addr);
+        std::memcpy(remote.address.data(), &addr6.sin6_addr, sizeof(addr6.sin6_addr));
+        remote.port = addr6.sin6_port;
+    } else {
+        const auto& addr4 = reinterpret_cast<const struct sockaddr_in&>(addr);
+        remote.address[10] = 0xff;
+        remote.address[11] = 0xff;
+        std::memcpy(&remote.address[12], &addr4.sin_addr, sizeof(addr4.sin_addr));
+        remote.port = addr4.sin_port;
     }
+    return remote;
 }
 
+unsigned UdpConnection::Remote::to_sockaddr(struct sockaddr_storage& addr, bool ipv6) const
+{
+    addr = {};
+    if (ipv6) {
+        auto& addr6 = reinterpret_cast<struct sockaddr_in6&>(addr);
+        addr6.sin6_family = AF_INET6;
+        std::memcpy(&addr6.sin6_addr, address.data(), sizeof(addr6.sin6_addr));
+        addr6.sin6_port = port;
+        return sizeof(addr6);
+    }
+
+    auto& addr4 = reinterpret_cast<struct sockaddr_in&>(addr);
+    addr4.sin_family = AF_INET;
+    std::memcpy(&addr4.sin_addr, &address[12], sizeof(addr4.sin_addr));
+    addr4.sin_port = port;
+    return sizeof(addr4);
+}
+
+std::size_t UdpConnection::RemoteHash::operator()(const Remote& remote) const
+{
+    uint64_t high = 0;
+    uint64_t low = 0;
+    std::memcpy(&high, remote.address.data(), sizeof(high));
+    std::memcpy(&low, remote.address.data() + sizeof(high), sizeof(low));
+    return std::hash<uint64_t>{}(
+        high ^ (low * 0x9e3779b97f4a7c15ULL) ^ (static_cast<uint64_t>(remote.port) << 48));
+}
+
+#if defined(LINUX)
+void UdpConnection::receive_batch()
+{
+    // Fetch up to RECV_BATCH_SIZE datagrams per syscall. If there are more,
+    // the reactor calls us again right away.
+    std::array<struct sockaddr_storage, RECV_BATCH_SIZE> src_addrs{};
+    std::array<struct iovec, RECV_BATCH_SIZE> iovs{};
+    std::array<struct mmsghdr, RECV_BATCH_SIZE> msgs{};
+
+    for (std::size_t i = 0; i < RECV_BATCH_SIZE; ++i) {
+        iovs[i].iov_base = &_recv_buffers[i * RECV_BUFFER_SIZE];
+        iovs[i].iov_len = RECV_BUFFER_SIZE;
+        msgs[i].msg_hdr.msg_name = &src_addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(src_addrs[i]);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    const int num = recvmmsg(_socket_fd, msgs.data(), RECV_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+
+    if (num <= 0) {
+        return;
+    }
+
+    // All datagrams of the batch arrived by now, so time spent on the
+    // earlier ones counts towards the latency of the later ones.
+    const uint64_t receive_time_ns = MessageLatency::now_ns();
+
+    for (int i = 0; i < num; ++i) {
+        if (msgs[i].msg_len == 0) {
+            continue;
+        }
+        process_datagram(
+            &_recv_buffers[i * RECV_BUFFER_SIZE],
+            static_cast<int>(msgs[i].msg_len),
+            Remote::from_sockaddr(src_addrs[i]),
+            receive_time_ns);
+    }
+}
+#else
 void UdpConnection::receive()
 {
-    // Enough for MTU 1500 bytes.
-    char buffer[2048];
+    _thread_setup.apply();
+
+    char buffer[RECV_BUFFER_SIZE];
 
     while (!_should_exit) {
-        struct sockaddr_in src_addr = {};
+        struct sockaddr_storage src_addr = {};
         socklen_t src_addr_len = sizeof(src_addr);
         const auto recv_len = recvfrom(
             _socket_fd,
@@ -225,20 +506,40 @@ void UdpConnection::receive()
             continue;
         }
 
-        _mavlink_receiver->set_new_datagram(buffer, static_cast<int>(recv_len));
+        process_datagram(buffer, static_cast<int>(recv_len), Remote::from_sockaddr(src_addr));
+    }
+}
+#endif
 
-        // Parse all mavlink messages in one datagram. Once exhausted, we'll exit while.
-        while (_mavlink_receiver->parse_message()) {
-            const uint8_t sysid = _mavlink_receiver->get_last_message().sysid;
+void UdpConnection::process_datagram(
+    char* buffer, const int length, const Remote& remote, uint64_t receive_time_ns)
+{
+    auto& receiver = receiver_for(remote);
+    receiver.set_new_datagram(buffer, length, receive_time_ns);
+
+    // Parse all mavlink messages in one datagram. Once exhausted, we'll exit while.
+    while (receiver.parse_message()) {
+        const uint8_t sysid = receiver.get_last_message().sysid;
+
+        // Most messages come from the same system and remote as the one
+        // before, which then is known already.
+        if (sysid != 0 && (sysid != _last_remote_sysid || remote != _last_remote)) {
+            add_remote_with_remote_sysid(remote, sysid);
+            _last_remote = remote;
+            _last_remote_sysid = sysid;
+        }
 
-            if (sysid != 0) {
-                add_remote_with_remote_sysid(
-                    inet_ntoa(src_addr.sin_addr), ntohs(src_addr.sin_port), sysid);
-            }
+        receive_message(receiver.get_last_message(), this, receiver.datagram_time_ns());
+    }
+}
 
-            receive_message(_mavlink_receiver->get_last_message(), this);
-        }
+MAVLinkReceiver& UdpConnection::receiver_for(const Remote& remote)
+{
+    auto& receiver = _receivers[remote];
+    if (receiver == nullptr) {
+        receiver = std::make_unique<MAVLinkReceiver>(&_link_stats);
     }
+    return *receiver;
 }
 
 } // namespace mavsdk
@@ -5,10 +5,14 @@
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <array>
+#include <unordered_map>
 #include <vector>
 #include <cstdint>
 #include "connection.h"
 
+struct sockaddr_storage;
+
 namespace mavsdk {
 
 class UdpConnection : public Connection {
@@ -22,7 +26,10 @@ public:
     ConnectionResult start() override;
     ConnectionResult stop() override;
 
-    bool send_message(const mavlink_message_t& message) override;
+    bool send_frame(const MavlinkFrame& frame) override;
+#if defined(LINUX)
+    bool send_frames(const std::vector<const MavlinkFrame*>& frames) override;
+#endif
 
     void add_remote(const std::string& remote_ip, int remote_port);
 
@@ -32,30 +39,109 @@ public:
 
 private:
     ConnectionResult setup_port();
-    void start_recv_thread();
+    void start_receiving();
 
+#if defined(LINUX)
+    void receive_batch();
+#else
     void receive();
-
-    void add_remote_with_remote_sysid(
-        const std::string& remote_ip, int remote_port, uint8_t remote_sysid);
+#endif
 
     std::string _local_ip;
     int _local_port_number;
 
-    std::mutex _remote_mutex{};
     struct Remote {
-        std::string ip{};
-        int port_number{0};
+        // An IPv6 address, IPv4 addresses are mapped to IPv6 (::ffff:a.b.c.d),
+        // so both look the same whatever the family of the socket is. Both
+        // the address and the port are in network byte order.
+        std::array<uint8_t, 16> address{};
+        uint16_t port{0};
 
         bool operator==(const UdpConnection::Remote& other) const
         {
-            return ip == other.ip && port_number == other.port_number;
+            return address == other.address && port == other.port;
         }
+
+        bool operator!=(const UdpConnection::Remote& other) const { return !(*this == other); }
+
+        [[nodiscard]] bool is_ipv4() const;
+        [[nodiscard]] std::string to_string() const;
+
+        static Remote from_sockaddr(const struct sockaddr_storage& addr);
+        // Returns the length of the address for a socket of the given family.
+        unsigned to_sockaddr(struct sockaddr_storage& addr, bool ipv6) const;
+    };
+
+    struct RemoteHash {
+        std::size_t operator()(const Remote& remote) const;
+    };
+
+    void process_datagram(
+        char* buffer, int length, const Remote& remote, uint64_t receive_time_ns = 0);
+
+    void add_remote_with_remote_sysid(const Remote& remote, uint8_t remote_sysid);
+
+    struct Datagram {
+        const MavlinkFrame* frame;
+        Remote remote;
     };
-    std::vector<Remote> _remotes{};
+
+    // Adds the datagrams to send a frame: only to the remote its target
+    // system was last heard from, or to all remotes if the frame is not
+    // targeted or the target system is unknown.
+    void add_datagrams(
+        const MavlinkFrame& frame,
+        const std::vector<Remote>& remotes,
+        std::vector<Datagram>& datagrams) const;
+
+    bool send_datagram(const Datagram& datagram);
+
+    MAVLinkReceiver& receiver_for(const Remote& remote);
+
+    // Remotes are only ever added, so sending and receiving use a snapshot of
+    // the list and only adding a remote needs the mutex.
+    std::mutex _remote_mutex{};
+    std::shared_ptr<const std::vector<Remote>> _remotes{
+        std::make_shared<const std::vector<Remote>>()};
+    // Position of each remote in _remotes, to find it without going through
+    // all of them. Needs _remote_mutex.
+    std::unordered_map<Remote, std::size_t, RemoteHash> _remote_indices{};
+
+    // Position + 1 in _remotes of the remote each system ID was last heard
+    // from, 0 if unknown.
+    std::array<std::atomic<uint32_t>, 256> _system_remotes{};
+
+    // Each remote gets a parser of its own, so datagrams of different remotes
+    // arriving interleaved can't mix up each other's frames. Only used by the
+    // receive path.
+    std::unordered_map<Remote, std::unique_ptr<MAVLinkReceiver>, RemoteHash> _receivers{};
+
+    // The remote and system ID of the message received last, as most
+    // messages come from the same one as the message before. Only used by
+    // the receive path.
+    Remote _last_remote{};
+    uint8_t _last_remote_sysid{0};
+
+    // Whether the socket is IPv6, which then takes IPv4 remotes as well.
+    bool _ipv6{false};
+
+#if defined(LINUX)
+    bool send_datagrams_batched(const std::vector<Datagram>& datagrams);
+
+    static constexpr std::size_t SEND_BATCH_SIZE = 32;
+    static constexpr std::size_t RECV_BATCH_SIZE = 16;
+#endif
+    // Enough for MTU 1500 bytes.
+    static constexpr std::size_t RECV_BUFFER_SIZE = 2048;
 
     int _socket_fd{-1};
-    std::unique_ptr<std::thread> _recv_thread{};
+#if defined(LINUX)
+    // Connections are served by the shared IoReactor instead of a thread each.
+    uint64_t _reactor_handle{0};
+    std::vector<char> _recv_buffers{};
+#else
+    std::unique_ptr<NativeThread> _recv_thread{};
+#endif
     std::atomic_bool _should_exit{false};
 };
 
@@ -0,0 +1,205 @@
+#if !defined(WINDOWS)
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "udp_connection.h"
+
+using namespace mavsdk;
+
+namespace {
+
+constexpr int local_port = 24571;
+
+// A vehicle on a UDP endpoint of its own.
+class Peer {
+public:
+    explicit Peer(uint8_t sysid) : _sysid(sysid)
+    {
+        _fd = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+
+        timeval timeout{0, 200000};
+        setsockopt(_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    ~Peer() { close(_fd); }
+
+    void send(const uint8_t* data, std::size_t len)
+    {
+        sockaddr_in dest{};
+        dest.sin_family = AF_INET;
+        dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        dest.sin_port = htons(local_port);
+        sendto(_fd, data, len, 0, reinterpret_cast<sockaddr*>(&dest), sizeof(dest));
+    }
+
+    std::vector<uint8_t> heartbeat() const
+    {
+        mavlink_message_t message;
+        mavlink_msg_heartbeat_pack(
+            _sysid, MAV_COMP_ID_AUTOPILOT1, &message, MAV_TYPE_QUADROTOR, 0, 0, 0, 0);
+        std::vector<uint8_t> buffer(MAVLINK_MAX_PACKET_LEN);
+        buffer.resize(mavlink_msg_to_send_buffer(buffer.data(), &message));
+        return buffer;
+    }
+
+    void send_heartbeat()
+    {
+        const auto buffer = heartbeat();
+        send(buffer.data(), buffer.size());
+    }
+
+    // Number of datagrams received until nothing comes anymore.
+    int drain()
+    {
+        int count = 0;
+        uint8_t buffer[2048];
+        while (recv(_fd, buffer, sizeof(buffer), 0) > 0) {
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    uint8_t _sysid;
+    int _fd{-1};
+};
+
+class Received {
+public:
+    void add(const mavlink_message_t& message)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _sysids.push_back(message.sysid);
+        _cv.notify_all();
+    }
+
+    bool wait_for(std::size_t count)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        return _cv.wait_for(
+            lock, std::chrono::seconds(1), [&]() { return _sysids.size() >= count; });
+    }
+
+    std::vector<uint8_t> sysids()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _sysids;
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::vector<uint8_t> _sysids;
+};
+
+} // namespace
+
+TEST(UdpConnection, SendsTargetedMessagesOnlyToTheirRemote)
+{
+    Received received;
+    UdpConnection connection(
+        [&](mavlink_message_t& message, Connection*) { received.add(message); },
+        "127.0.0.1",
+        local_port);
+    ASSERT_EQ(connection.start(), ConnectionResult::Success);
+
+    Peer first(1);
+    Peer second(2);
+    first.send_heartbeat();
+    second.send_heartbeat();
+    ASSERT_TRUE(received.wait_for(2));
+
+    mavlink_message_t command;
+    mavlink_msg_command_long_pack(
+        245,
+        MAV_COMP_ID_MISSIONPLANNER,
+        &command,
+        2,
+        1,
+        MAV_CMD_REQUEST_MESSAGE,
+        0,
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f);
+    EXPECT_TRUE(connection.send_message(command));
+    EXPECT_EQ(first.drain(), 0);
+    EXPECT_EQ(second.drain(), 1);
+
+    // Not targeted at anyone, so it goes to everyone.
+    mavlink_message_t heartbeat;
+    mavlink_msg_heartbeat_pack(
+        245, MAV_COMP_ID_MISSIONPLANNER, &heartbeat, MAV_TYPE_GCS, 0, 0, 0, 0);
+    EXPECT_TRUE(connection.send_message(heartbeat));
+    EXPECT_EQ(first.drain(), 1);
+    EXPECT_EQ(second.drain(), 1);
+
+    connection.stop();
+}
+
+TEST(UdpConnection, TakesIpv4RemotesOnIpv6Socket)
+{
+    Received received;
+    UdpConnection connection(
+        [&](mavlink_message_t& message, Connection*) { received.add(message); }, "::", local_port);
+    ASSERT_EQ(connection.start(), ConnectionResult::Success);
+
+    Peer peer(1);
+    peer.send_heartbeat();
+    peer.send_heartbeat();
+    ASSERT_TRUE(received.wait_for(2));
+
+    mavlink_message_t heartbeat;
+    mavlink_msg_heartbeat_pack(
+        245, MAV_COMP_ID_MISSIONPLANNER, &heartbeat, MAV_TYPE_GCS, 0, 0, 0, 0);
+    EXPECT_TRUE(connection.send_message(heartbeat));
+    EXPECT_EQ(peer.drain(), 1);
+
+    connection.stop();
+}
+
+TEST(UdpConnection, ParsesInterleavedRemotesSeparately)
+{
+    Received received;
+    UdpConnection connection(
+        [&](mavlink_message_t& message, Connection*) { received.add(message); },
+        "127.0.0.1",
+        local_port);
+    ASSERT_EQ(connection.start(), ConnectionResult::Success);
+
+    Peer first(1);
+    Peer second(2);
+
+    // A frame split over two datagrams, with a frame of another remote in between.
+    const auto frame = first.heartbeat();
+    const std::size_t half = frame.size() / 2;
+    first.send(frame.data(), half);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    second.send_heartbeat();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    first.send(frame.data() + half, frame.size() - half);
+
+    ASSERT_TRUE(received.wait_for(2));
+    EXPECT_EQ(received.sysids(), (std::vector<uint8_t>{2, 1}));
+
+    connection.stop();
+}
+
+#endif
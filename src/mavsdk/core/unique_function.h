@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace mavsdk {
+
+template<typename Signature, std::size_t BufferSize = 64> class UniqueFunction;
+
+// Move-only replacement for std::function.
+//
+// Callables which fit into the internal buffer (and are nothrow move
+// constructible) are stored inline without any heap allocation. Bigger ones
+// fall back to the heap. As it is move-only, it can hold move-only callables,
+// and it is never copied by accident.
+template<typename R, typename... Args, std::size_t BufferSize>
+class UniqueFunction<R(Args...), BufferSize> {
+public:
+    UniqueFunction() = default;
+    UniqueFunction(std::nullptr_t) {}
+
+    template<
+        typename F,
+        typename = std::enable_if_t<
+            !std::is_same_v<std::decay_t<F>, UniqueFunction> &&
+            std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>>
+    UniqueFunction(F&& func)
+    {
+        using Stored = std::decay_t<F>;
+        if constexpr (fits_inline<Stored>()) {
+            new (&_buffer) Stored(std::forward<F>(func));
+            _ops = &inline_ops<Stored>;
+        } else {
+            new (&_buffer) Stored*(new Stored(std::forward<F>(func)));
+            _ops = &heap_ops<Stored>;
+        }
+    }
+
+    UniqueFunction(UniqueFunction&& other) noexcept { move_from(other); }
+
+    UniqueFunction& operator=(UniqueFunction&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            move_from(other);
+        }
+        return *this;
+    }
+
+    UniqueFunction& operator=(std::nullptr_t)
+    {
+        reset();
+        return *this;
+    }
+
+    ~UniqueFunction() { reset(); }
+
+    UniqueFunction(const UniqueFunction&) = delete;
+    UniqueFunction& operator=(const UniqueFunction&) = delete;
+
+    explicit operator bool() const { return _ops != nullptr; }
+
+    R operator()(Args... args) { return _ops->invoke(&_buffer, std::forward<Args>(args)...); }
+
+    void reset()
+    {
+        if (_ops != nullptr) {
+            _ops->destroy(&_buffer);
+            _ops = nullptr;
+        }
+    }
+
+    // Whether a callable of type F is stored without a heap allocation.
+    template<typename F> static constexpr bool fits_inline()
+    {
+        return sizeof(F) <= BufferSize && alignof(std::max_align_t) % alignof(F) == 0 &&
+               std::is_nothrow_move_constructible_v<F>;
+    }
+
+private:
+    struct Ops {
+        R (*invoke)(void* storage, Args&&... args);
+        void (*move)(void* dst, void* src);
+        void (*destroy)(void* storage);
+    };
+
+    using Buffer = std::aligned_storage_t<BufferSize, alignof(std::max_align_t)>;
+
+    template<typename F>
+    static constexpr Ops inline_ops{
+        [](void* storage, Args&&... args) -> R {
+            return (*static_cast<F*>(storage))(std::forward<Args>(args)...);
+        },
+        [](void* dst, void* src) {
+            new (dst) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        },
+        [](void* storage) { static_cast<F*>(storage)->~F(); }};
+
+    template<typename F>
+    static constexpr Ops heap_ops{
+        [](void* storage, Args&&... args) -> R {
+            return (**static_cast<F**>(storage))(std::forward<Args>(args)...);
+        },
+        [](void* dst, void* src) { new (dst) F*(*static_cast<F**>(src)); },
+        [](void* storage) { delete *static_cast<F**>(storage); }};
+
+    void move_from(UniqueFunction& other) noexcept
+    {
+        if (other._ops != nullptr) {
+            other._ops->move(&_buffer, &other._buffer);
+            _ops = other._ops;
+            other._ops = nullptr;
+        }
+    }
+
+    Buffer _buffer;
+    const Ops* _ops{nullptr};
+};
+
+} // namespace mavsdk
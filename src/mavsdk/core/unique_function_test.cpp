@@ -0,0 +1,66 @@
+#include "unique_function.h"
+
+#include <array>
+#include <memory>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(UniqueFunction, Empty)
+{
+    UniqueFunction<void()> func{};
+    EXPECT_FALSE(func);
+
+    UniqueFunction<void()> null_func = nullptr;
+    EXPECT_FALSE(null_func);
+}
+
+TEST(UniqueFunction, SmallCapture)
+{
+    int called = 0;
+    UniqueFunction<int(int)> func = [&called](int value) {
+        ++called;
+        return value * 2;
+    };
+    ASSERT_TRUE(func);
+    EXPECT_EQ(func(21), 42);
+    EXPECT_EQ(called, 1);
+}
+
+TEST(UniqueFunction, BigCaptureOnHeap)
+{
+    std::array<int, 100> big{};
+    big[99] = 7;
+    UniqueFunction<int()> func = [big]() { return big[99]; };
+    EXPECT_EQ(func(), 7);
+
+    UniqueFunction<int()> moved = std::move(func);
+    EXPECT_FALSE(func);
+    EXPECT_EQ(moved(), 7);
+}
+
+TEST(UniqueFunction, MoveOnlyCapture)
+{
+    auto value = std::make_unique<int>(5);
+    UniqueFunction<int()> func = [value = std::move(value)]() { return *value; };
+
+    UniqueFunction<int()> other{};
+    other = std::move(func);
+    EXPECT_FALSE(func);
+    EXPECT_EQ(other(), 5);
+}
+
+TEST(UniqueFunction, DestroysCapture)
+{
+    auto shared = std::make_shared<int>(1);
+    {
+        UniqueFunction<void()> func = [shared]() {};
+        EXPECT_EQ(shared.use_count(), 2);
+        func = nullptr;
+        EXPECT_EQ(shared.use_count(), 1);
+
+        func = [shared]() {};
+        EXPECT_EQ(shared.use_count(), 2);
+    }
+    EXPECT_EQ(shared.use_count(), 1);
+}
@@ -0,0 +1,167 @@
+#include "user_callback_queue.h"
+#include "log.h"
+
+namespace mavsdk {
+
+UserCallbackQueue::UserCallbackQueue(std::size_t capacity, OverflowPolicy overflow_policy) :
+    _queue(capacity),
+    _overflow_policy(overflow_policy)
+{}
+
+bool UserCallbackQueue::enqueue(UserCallback&& callback, bool may_block)
+{
+    if (_should_exit) {
+        return false;
+    }
+
+    while (!_queue.try_push(std::move(callback))) {
+        if (!handle_overflow(may_block)) {
+            ++_dropped;
+            if (!_overflowing.exchange(true)) {
+                LogErr()
+                    << "User callback queue overflown\n"
+                       "See: https://mavsdk.mavlink.io/main/en/cpp/troubleshooting.html#user_callbacks";
+            }
+            return false;
+        }
+    }
+    _overflowing = false;
+
+    update_max_depth();
+
+    if (_queue.size() == 10) {
+        LogWarn()
+            << "User callback queue too slow.\n"
+               "See: https://mavsdk.mavlink.io/main/en/cpp/troubleshooting.html#user_callbacks";
+    }
+
+    // Make sure the push is visible before we check whether the consumer is
+    // asleep, the consumer does the opposite.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_notify) {
+        _notify();
+    } else if (_consumer_waiting) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _consumer_waiting = false;
+        _not_empty.notify_one();
+    }
+
+    return true;
+}
+
+bool UserCallbackQueue::handle_overflow(bool may_block)
+{
+    switch (_overflow_policy.load()) {
+        case OverflowPolicy::DropOldest: {
+            UserCallback oldest;
+            if (_queue.try_pop(oldest)) {
+                ++_dropped;
+            }
+            // Try again, now that there should be space.
+            return true;
+        }
+
+        case OverflowPolicy::Block: {
+            // We can't wait for ourselves to make space.
+            if (!may_block || std::this_thread::get_id() == _consumer_thread_id.load()) {
+                return false;
+            }
+
+            std::unique_lock<std::mutex> lock(_mutex);
+            ++_producers_waiting;
+            _not_full.wait(lock, [this]() {
+                return _queue.size() < _queue.capacity() || _should_exit ||
+                       _overflow_policy != OverflowPolicy::Block;
+            });
+            --_producers_waiting;
+
+            // Try again unless we're shutting down.
+            return !_should_exit;
+        }
+
+        case OverflowPolicy::DropNewest:
+        default:
+            return false;
+    }
+}
+
+bool UserCallbackQueue::dequeue_batch(std::vector<UserCallback>& batch, std::size_t max_batch)
+{
+    _consumer_thread_id = std::this_thread::get_id();
+
+    while (!_should_exit) {
+        if (try_dequeue_batch(batch, max_batch)) {
+            return true;
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _consumer_waiting = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        // Something might have been pushed while we were getting ready to wait.
+        if (!_queue.empty()) {
+            _consumer_waiting = false;
+            continue;
+        }
+
+        _not_empty.wait(lock, [this]() { return !_consumer_waiting || _should_exit; });
+    }
+
+    return false;
+}
+
+bool UserCallbackQueue::try_dequeue_batch(std::vector<UserCallback>& batch, std::size_t max_batch)
+{
+    UserCallback callback;
+    while (batch.size() < max_batch && _queue.try_pop(callback)) {
+        batch.push_back(std::move(callback));
+    }
+
+    if (batch.empty()) {
+        return false;
+    }
+
+    if (_producers_waiting > 0) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _not_full.notify_all();
+    }
+    return true;
+}
+
+void UserCallbackQueue::stop()
+{
+    // This can be used if the wait needs to be interrupted, e.g.
+    // when trying to stop a worker thread.
+    std::lock_guard<std::mutex> lock(_mutex);
+    _should_exit = true;
+    _not_empty.notify_all();
+    _not_full.notify_all();
+}
+
+void UserCallbackQueue::set_overflow_policy(OverflowPolicy overflow_policy)
+{
+    _overflow_policy = overflow_policy;
+
+    // Anyone blocked needs to re-evaluate.
+    std::lock_guard<std::mutex> lock(_mutex);
+    _not_full.notify_all();
+}
+
+void UserCallbackQueue::update_max_depth()
+{
+    const std::size_t depth = _queue.size();
+    std::size_t max_depth = _max_depth.load();
+    while (depth > max_depth && !_max_depth.compare_exchange_weak(max_depth, depth)) {}
+}
+
+Mavsdk::CallbackQueueStats UserCallbackQueue::stats() const
+{
+    Mavsdk::CallbackQueueStats stats{};
+    stats.depth = _queue.size();
+    stats.max_depth = _max_depth;
+    stats.processed = _processed;
+    stats.dropped = _dropped;
+    return stats;
+}
+
+} // namespace mavsdk
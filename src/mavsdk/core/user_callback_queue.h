@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "lock_free_queue.h"
+#include "mavsdk.h"
+#include "unique_function.h"
+
+namespace mavsdk {
+
+using UserCallbackFunction = UniqueFunction<void()>;
+
+struct UserCallback {
+    UserCallback() = default;
+    explicit UserCallback(UserCallbackFunction func_) : func(std::move(func_)) {}
+    UserCallback(UserCallbackFunction func_, const char* filename_, const int linenumber_) :
+        func(std::move(func_)),
+        filename(filename_),
+        linenumber(linenumber_)
+    {}
+
+    UserCallbackFunction func{};
+    // This is always a string literal (see FILENAME), so we don't need to copy it.
+    const char* filename{""};
+    int linenumber{};
+
+    // Set if the callback was queued because of a received message.
+    uint32_t message_id{0};
+    uint64_t ingress_time_ns{0};
+    uint64_t enqueue_time_ns{0};
+
+    // Links queueing and running it in a trace, 0 if not traced.
+    uint64_t trace_flow_id{0};
+};
+
+// Bounded queue of user callbacks for multiple producers (any MAVSDK thread)
+// and one consumer (the thread calling the user callbacks).
+//
+// Enqueueing never takes a lock, except when the consumer needs to be woken
+// up because it went to sleep on an empty queue, or for the Block policy when
+// the queue is full.
+class UserCallbackQueue {
+public:
+    using OverflowPolicy = Mavsdk::Configuration::CallbackOverflowPolicy;
+
+    UserCallbackQueue(std::size_t capacity, OverflowPolicy overflow_policy);
+    ~UserCallbackQueue() = default;
+
+    // Returns false if the callback was dropped. With may_block set to false,
+    // the Block policy falls back to dropping the newest callback.
+    bool enqueue(UserCallback&& callback, bool may_block = true);
+
+    // Blocks until at least one callback is available, then moves up to
+    // max_batch callbacks into batch. Returns false once stopped.
+    bool dequeue_batch(std::vector<UserCallback>& batch, std::size_t max_batch);
+
+    // The same without waiting, returns false if nothing was available.
+    bool try_dequeue_batch(std::vector<UserCallback>& batch, std::size_t max_batch);
+
+    // For a queue served by a CallbackExecutor instead of a thread waiting in
+    // dequeue_batch(): called after every enqueue so the executor can wake a
+    // thread. Needs to be set before the queue is used.
+    void set_notify(std::function<void()> notify) { _notify = std::move(notify); }
+
+    [[nodiscard]] bool empty() const { return _queue.empty(); }
+
+    void stop();
+
+    void set_overflow_policy(OverflowPolicy overflow_policy);
+
+    void count_processed(std::size_t num) { _processed += num; }
+
+    [[nodiscard]] std::size_t capacity() const { return _queue.capacity(); }
+
+    [[nodiscard]] Mavsdk::CallbackQueueStats stats() const;
+
+    // Non-copyable
+    UserCallbackQueue(const UserCallbackQueue&) = delete;
+    const UserCallbackQueue& operator=(const UserCallbackQueue&) = delete;
+
+private:
+    bool handle_overflow(bool may_block);
+    void update_max_depth();
+
+    LockFreeQueue<UserCallback> _queue;
+    std::atomic<OverflowPolicy> _overflow_policy;
+
+    std::mutex _mutex{};
+    std::condition_variable _not_empty{};
+    std::condition_variable _not_full{};
+    std::atomic<bool> _consumer_waiting{false};
+    std::atomic<unsigned> _producers_waiting{0};
+    std::atomic<bool> _should_exit{false};
+    std::atomic<std::thread::id> _consumer_thread_id{};
+
+    std::atomic<std::size_t> _max_depth{0};
+    std::atomic<uint64_t> _processed{0};
+    std::atomic<uint64_t> _dropped{0};
+    std::atomic<bool> _overflowing{false};
+
+    std::function<void()> _notify{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,50 @@
+#include <benchmark/benchmark.h>
+#include <thread>
+#include <vector>
+#include "benchmark_helpers.h"
+#include "user_callback_queue.h"
+
+using namespace mavsdk;
+
+// One producer queueing a callback per message, and the consumer calling
+// them on a thread of its own, as MAVSDK does.
+static void UserCallbackQueue_EnqueueAndCall(benchmark::State& state)
+{
+    const auto num_callbacks = static_cast<uint64_t>(state.range(0));
+
+    UserCallbackQueue queue{
+        Mavsdk::DEFAULT_CALLBACK_QUEUE_CAPACITY,
+        Mavsdk::Configuration::CallbackOverflowPolicy::Block};
+
+    uint64_t num_called = 0;
+    std::thread consumer([&]() {
+        std::vector<UserCallback> batch;
+        while (queue.dequeue_batch(batch, 64)) {
+            for (auto& callback : batch) {
+                callback.func();
+            }
+            queue.count_processed(batch.size());
+            batch.clear();
+        }
+    });
+
+    uint64_t num_enqueued = 0;
+    for (auto _ : state) {
+        for (uint64_t i = 0; i < num_callbacks; ++i) {
+            queue.enqueue(UserCallback{[&num_called]() { ++num_called; }});
+        }
+        num_enqueued += num_callbacks;
+
+        // Only done once all of them were called.
+        while (queue.stats().processed < num_enqueued) {
+            std::this_thread::yield();
+        }
+    }
+
+    queue.stop();
+    consumer.join();
+    benchmark::DoNotOptimize(num_called);
+
+    count_messages(state, num_callbacks);
+}
+BENCHMARK(UserCallbackQueue_EnqueueAndCall)->Arg(1000)->Arg(100000)->UseRealTime();
@@ -0,0 +1,103 @@
+#include "user_callback_queue.h"
+
+#include <future>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+using OverflowPolicy = Mavsdk::Configuration::CallbackOverflowPolicy;
+
+static int drain(UserCallbackQueue& queue)
+{
+    std::vector<UserCallback> batch;
+    queue.dequeue_batch(batch, 100);
+    for (auto& callback : batch) {
+        callback.func();
+    }
+    return static_cast<int>(batch.size());
+}
+
+TEST(UserCallbackQueue, DropNewest)
+{
+    UserCallbackQueue queue{4, OverflowPolicy::DropNewest};
+
+    std::vector<int> called;
+    for (int i = 0; i < 6; ++i) {
+        queue.enqueue(UserCallback{[&called, i]() { called.push_back(i); }});
+    }
+
+    EXPECT_EQ(queue.stats().depth, 4);
+    EXPECT_EQ(queue.stats().dropped, 2);
+
+    EXPECT_EQ(drain(queue), 4);
+    EXPECT_EQ(called, (std::vector<int>{0, 1, 2, 3}));
+}
+
+TEST(UserCallbackQueue, DropOldest)
+{
+    UserCallbackQueue queue{4, OverflowPolicy::DropOldest};
+
+    std::vector<int> called;
+    for (int i = 0; i < 6; ++i) {
+        queue.enqueue(UserCallback{[&called, i]() { called.push_back(i); }});
+    }
+
+    EXPECT_EQ(queue.stats().dropped, 2);
+    EXPECT_EQ(queue.stats().max_depth, 4);
+
+    EXPECT_EQ(drain(queue), 4);
+    EXPECT_EQ(called, (std::vector<int>{2, 3, 4, 5}));
+}
+
+TEST(UserCallbackQueue, Block)
+{
+    UserCallbackQueue queue{2, OverflowPolicy::Block};
+
+    int called = 0;
+    queue.enqueue(UserCallback{[&called]() { ++called; }});
+    queue.enqueue(UserCallback{[&called]() { ++called; }});
+
+    auto blocked = std::async(std::launch::async, [&]() {
+        return queue.enqueue(UserCallback{[&called]() { ++called; }});
+    });
+
+    EXPECT_EQ(
+        blocked.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+
+    EXPECT_EQ(drain(queue), 2);
+    EXPECT_TRUE(blocked.get());
+    EXPECT_EQ(drain(queue), 1);
+
+    EXPECT_EQ(called, 3);
+    EXPECT_EQ(queue.stats().dropped, 0);
+}
+
+TEST(UserCallbackQueue, WakesUpConsumer)
+{
+    UserCallbackQueue queue{16, OverflowPolicy::DropNewest};
+
+    auto consumed = std::async(std::launch::async, [&]() { return drain(queue); });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.enqueue(UserCallback{[]() {}});
+
+    EXPECT_EQ(consumed.get(), 1);
+}
+
+TEST(UserCallbackQueue, StopWhileWaiting)
+{
+    UserCallbackQueue queue{16, OverflowPolicy::DropNewest};
+
+    auto consumed = std::async(std::launch::async, [&]() {
+        std::vector<UserCallback> batch;
+        return queue.dequeue_batch(batch, 10);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.stop();
+
+    EXPECT_FALSE(consumed.get());
+    EXPECT_FALSE(queue.enqueue(UserCallback{[]() {}}));
+}
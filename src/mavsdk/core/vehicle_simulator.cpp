@@ -0,0 +1,511 @@
+#include "vehicle_simulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+#if !defined(WINDOWS)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "benchmark_helpers.h"
+#include "log.h"
+
+namespace mavsdk {
+
+namespace {
+
+constexpr uint8_t component_id = MAV_COMP_ID_AUTOPILOT1;
+
+} // namespace
+
+VehicleSimulator::~VehicleSimulator()
+{
+    stop();
+}
+
+bool VehicleSimulator::start(
+    unsigned count, int ground_station_port, uint8_t first_system_id, float rate_scale)
+{
+#if defined(WINDOWS)
+    (void)count;
+    (void)ground_station_port;
+    (void)first_system_id;
+    (void)rate_scale;
+    LogErr() << "Vehicle simulator is not supported on Windows";
+    return false;
+#else
+    stop();
+
+    if (first_system_id == 0 || first_system_id + count - 1 > 254) {
+        LogErr() << "Only system IDs 1 to 254 can be simulated";
+        return false;
+    }
+
+    _ground_station_port = ground_station_port;
+    _rate_scale = rate_scale;
+
+    const auto& streams = px4_default_streams();
+    const double start_s = now_s();
+
+    for (unsigned i = 0; i < count; ++i) {
+        Vehicle vehicle;
+        vehicle.system_id = static_cast<uint8_t>(first_system_id + i);
+        vehicle.params = default_params();
+
+        vehicle.fd = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (vehicle.fd < 0 ||
+            bind(vehicle.fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            LogErr() << "Could not create socket of simulated vehicle: " << strerror(errno);
+            if (vehicle.fd >= 0) {
+                close(vehicle.fd);
+            }
+            stop();
+            return false;
+        }
+
+        // Spread the vehicles over the stream periods, real ones don't all
+        // start at the same time either.
+        const double phase = static_cast<double>(i) / count;
+        for (const auto& stream : streams) {
+            const double period_s = 1.0 / (static_cast<double>(stream.rate_hz) * _rate_scale);
+            vehicle.next_send_s.push_back(start_s + phase * period_s);
+        }
+
+        _vehicles.push_back(vehicle);
+    }
+
+    _should_exit = false;
+    _thread = std::thread(&VehicleSimulator::run, this);
+    return true;
+#endif
+}
+
+void VehicleSimulator::stop()
+{
+#if !defined(WINDOWS)
+    _should_exit = true;
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    for (auto& vehicle : _vehicles) {
+        close(vehicle.fd);
+    }
+    _vehicles.clear();
+#endif
+}
+
+void VehicleSimulator::run()
+{
+#if !defined(WINDOWS)
+    std::vector<pollfd> pfds;
+    for (const auto& vehicle : _vehicles) {
+        pfds.push_back({vehicle.fd, POLLIN, 0});
+    }
+
+    while (!_should_exit) {
+        // Short enough for the fastest streams to go out in time.
+        if (poll(pfds.data(), pfds.size(), 2) > 0) {
+            for (std::size_t i = 0; i < pfds.size(); ++i) {
+                if ((pfds[i].revents & POLLIN) != 0) {
+                    receive(_vehicles[i]);
+                }
+            }
+        }
+
+        const double now = now_s();
+        for (auto& vehicle : _vehicles) {
+            send_streams(vehicle, now);
+        }
+
+        timespec cpu_time{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time);
+        _cpu_time_ns = static_cast<uint64_t>(cpu_time.tv_sec) * 1000000000 +
+                       static_cast<uint64_t>(cpu_time.tv_nsec);
+    }
+#endif
+}
+
+void VehicleSimulator::send_streams(Vehicle& vehicle, double now)
+{
+    const auto& streams = px4_default_streams();
+    for (std::size_t i = 0; i < streams.size(); ++i) {
+        if (vehicle.next_send_s[i] > now) {
+            continue;
+        }
+        const double period_s = 1.0 / (static_cast<double>(streams[i].rate_hz) * _rate_scale);
+        // Skip what was missed rather than sending a burst to catch up.
+        vehicle.next_send_s[i] = std::max(vehicle.next_send_s[i] + period_s, now);
+
+        auto message = px4_stream_message(streams[i].message_id, vehicle.system_id);
+        send(vehicle, message);
+    }
+}
+
+void VehicleSimulator::receive(Vehicle& vehicle)
+{
+#if !defined(WINDOWS)
+    uint8_t buffer[2048];
+    ssize_t received;
+    while ((received = recv(vehicle.fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+        // Every datagram sent by MAVSDK consists of whole messages.
+        mavlink_message_t rx_buffer{};
+        mavlink_status_t rx_status{};
+        mavlink_message_t message;
+        mavlink_status_t status;
+        for (ssize_t i = 0; i < received; ++i) {
+            if (mavlink_frame_char_buffer(&rx_buffer, &rx_status, buffer[i], &message, &status) ==
+                MAVLINK_FRAMING_OK) {
+                handle(vehicle, message);
+            }
+        }
+    }
+#else
+    (void)vehicle;
+#endif
+}
+
+void VehicleSimulator::handle(Vehicle& vehicle, const mavlink_message_t& message)
+{
+    switch (message.msgid) {
+        case MAVLINK_MSG_ID_COMMAND_LONG: {
+            mavlink_command_long_t command_long;
+            mavlink_msg_command_long_decode(&message, &command_long);
+            if (command_long.target_system == vehicle.system_id) {
+                handle_command(vehicle, command_long.command, command_long.param1);
+            }
+        } break;
+        case MAVLINK_MSG_ID_COMMAND_INT: {
+            mavlink_command_int_t command_int;
+            mavlink_msg_command_int_decode(&message, &command_int);
+            if (command_int.target_system == vehicle.system_id) {
+                handle_command(vehicle, command_int.command, command_int.param1);
+            }
+        } break;
+        case MAVLINK_MSG_ID_PARAM_REQUEST_LIST: {
+            mavlink_param_request_list_t param_request_list;
+            mavlink_msg_param_request_list_decode(&message, &param_request_list);
+            if (param_request_list.target_system == vehicle.system_id) {
+                for (uint16_t i = 0; i < vehicle.params.size(); ++i) {
+                    send_param_value(vehicle, i);
+                }
+            }
+        } break;
+        case MAVLINK_MSG_ID_PARAM_REQUEST_READ:
+            handle_param_request_read(vehicle, message);
+            break;
+        case MAVLINK_MSG_ID_PARAM_SET:
+            handle_param_set(vehicle, message);
+            break;
+        case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+            handle_mission_request_list(vehicle, message);
+            break;
+        case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+            handle_mission_request_int(vehicle, message);
+            break;
+        case MAVLINK_MSG_ID_MISSION_COUNT:
+            handle_mission_count(vehicle, message);
+            break;
+        case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+            handle_mission_item_int(vehicle, message);
+            break;
+        case MAVLINK_MSG_ID_MISSION_CLEAR_ALL:
+            handle_mission_clear_all(vehicle, message);
+            break;
+        default:
+            break;
+    }
+}
+
+void VehicleSimulator::handle_command(Vehicle& vehicle, uint16_t command, float param1)
+{
+    mavlink_command_ack_t command_ack{};
+    command_ack.command = command;
+    command_ack.result = MAV_RESULT_ACCEPTED;
+    mavlink_message_t message;
+    mavlink_msg_command_ack_encode(vehicle.system_id, component_id, &message, &command_ack);
+    send(vehicle, message);
+
+    const bool autopilot_version_requested =
+        command == MAV_CMD_REQUEST_AUTOPILOT_CAPABILITIES ||
+        (command == MAV_CMD_REQUEST_MESSAGE &&
+         static_cast<uint32_t>(param1) == MAVLINK_MSG_ID_AUTOPILOT_VERSION);
+    if (autopilot_version_requested) {
+        send_autopilot_version(vehicle);
+    }
+}
+
+void VehicleSimulator::handle_param_request_read(
+    Vehicle& vehicle, const mavlink_message_t& message)
+{
+    mavlink_param_request_read_t param_request_read;
+    mavlink_msg_param_request_read_decode(&message, &param_request_read);
+    if (param_request_read.target_system != vehicle.system_id) {
+        return;
+    }
+
+    if (param_request_read.param_index >= 0) {
+        if (static_cast<std::size_t>(param_request_read.param_index) < vehicle.params.size()) {
+            send_param_value(vehicle, static_cast<uint16_t>(param_request_read.param_index));
+        }
+        return;
+    }
+
+    for (uint16_t i = 0; i < vehicle.params.size(); ++i) {
+        if (strncmp(vehicle.params[i].id, param_request_read.param_id, 16) == 0) {
+            send_param_value(vehicle, i);
+            return;
+        }
+    }
+}
+
+void VehicleSimulator::handle_param_set(Vehicle& vehicle, const mavlink_message_t& message)
+{
+    mavlink_param_set_t param_set;
+    mavlink_msg_param_set_decode(&message, &param_set);
+    if (param_set.target_system != vehicle.system_id) {
+        return;
+    }
+
+    for (uint16_t i = 0; i < vehicle.params.size(); ++i) {
+        if (strncmp(vehicle.params[i].id, param_set.param_id, 16) == 0) {
+            vehicle.params[i].value = param_set.param_value;
+            send_param_value(vehicle, i);
+            return;
+        }
+    }
+}
+
+void VehicleSimulator::handle_mission_request_list(
+    Vehicle& vehicle, const mavlink_message_t& message)
+{
+    mavlink_mission_request_list_t mission_request_list;
+    mavlink_msg_mission_request_list_decode(&message, &mission_request_list);
+    if (mission_request_list.target_system != vehicle.system_id) {
+        return;
+    }
+
+    mavlink_mission_count_t mission_count{};
+    mission_count.target_system = message.sysid;
+    mission_count.target_component = message.compid;
+    mission_count.count =
+        static_cast<uint16_t>(vehicle.missions[mission_request_list.mission_type].size());
+    mission_count.mission_type = mission_request_list.mission_type;
+    mavlink_message_t reply;
+    mavlink_msg_mission_count_encode(vehicle.system_id, component_id, &reply, &mission_count);
+    send(vehicle, reply);
+}
+
+void VehicleSimulator::handle_mission_request_int(
+    Vehicle& vehicle, const mavlink_message_t& message)
+{
+    mavlink_mission_request_int_t mission_request_int;
+    mavlink_msg_mission_request_int_decode(&message, &mission_request_int);
+    if (mission_request_int.target_system != vehicle.system_id) {
+        return;
+    }
+
+    const auto& items = vehicle.missions[mission_request_int.mission_type];
+    if (mission_request_int.seq >= items.size()) {
+        return;
+    }
+
+    auto item = items[mission_request_int.seq];
+    item.target_system = message.sysid;
+    item.target_component = message.compid;
+    mavlink_message_t reply;
+    mavlink_msg_mission_item_int_encode(vehicle.system_id, component_id, &reply, &item);
+    send(vehicle, reply);
+}
+
+void VehicleSimulator::handle_mission_count(Vehicle& vehicle, const mavlink_message_t& message)
+{
+    mavlink_mission_count_t mission_count;
+    mavlink_msg_mission_count_decode(&message, &mission_count);
+    if (mission_count.target_system != vehicle.system_id) {
+        return;
+    }
+
+    vehicle.upload_count = mission_count.count;
+    vehicle.upload_mission_type = mission_count.mission_type;
+    vehicle.missions[mission_count.mission_type].clear();
+
+    if (mission_count.count == 0) {
+        send_mission_ack(vehicle, message, mission_count.mission_type);
+    } else {
+        send_mission_request(vehicle, message, 0, mission_count.mission_type);
+    }
+}
+
+void VehicleSimulator::handle_mission_item_int(Vehicle& vehicle, const mavlink_message_t& message)
+{
+    mavlink_mission_item_int_t mission_item_int;
+    mavlink_msg_mission_item_int_decode(&message, &mission_item_int);
+    if (mission_item_int.target_system != vehicle.system_id ||
+        mission_item_int.mission_type != vehicle.upload_mission_type) {
+        return;
+    }
+
+    auto& items = vehicle.missions[vehicle.upload_mission_type];
+    if (mission_item_int.seq == items.size()) {
+        items.push_back(mission_item_int);
+    } else if (mission_item_int.seq + 1u != items.size()) {
+        // Neither the next item, nor the last one again because our answer got lost.
+        return;
+    }
+
+    if (items.size() < vehicle.upload_count) {
+        send_mission_request(
+            vehicle, message, static_cast<uint16_t>(items.size()), vehicle.upload_mission_type);
+    } else {
+        send_mission_ack(vehicle, message, vehicle.upload_mission_type);
+    }
+}
+
+void VehicleSimulator::handle_mission_clear_all(Vehicle& vehicle, const mavlink_message_t& message)
+{
+    mavlink_mission_clear_all_t mission_clear_all;
+    mavlink_msg_mission_clear_all_decode(&message, &mission_clear_all);
+    if (mission_clear_all.target_system != vehicle.system_id) {
+        return;
+    }
+
+    vehicle.missions[mission_clear_all.mission_type].clear();
+
+    send_mission_ack(vehicle, message, mission_clear_all.mission_type);
+}
+
+void VehicleSimulator::send_mission_request(
+    Vehicle& vehicle, const mavlink_message_t& request, uint16_t seq, uint8_t mission_type)
+{
+    mavlink_mission_request_int_t mission_request_int{};
+    mission_request_int.target_system = request.sysid;
+    mission_request_int.target_component = request.compid;
+    mission_request_int.seq = seq;
+    mission_request_int.mission_type = mission_type;
+    mavlink_message_t message;
+    mavlink_msg_mission_request_int_encode(
+        vehicle.system_id, component_id, &message, &mission_request_int);
+    send(vehicle, message);
+}
+
+void VehicleSimulator::send_mission_ack(
+    Vehicle& vehicle, const mavlink_message_t& request, uint8_t mission_type)
+{
+    mavlink_mission_ack_t mission_ack{};
+    mission_ack.target_system = request.sysid;
+    mission_ack.target_component = request.compid;
+    mission_ack.type = MAV_MISSION_ACCEPTED;
+    mission_ack.mission_type = mission_type;
+    mavlink_message_t message;
+    mavlink_msg_mission_ack_encode(vehicle.system_id, component_id, &message, &mission_ack);
+    send(vehicle, message);
+}
+
+void VehicleSimulator::send_param_value(Vehicle& vehicle, uint16_t index)
+{
+    const auto& param = vehicle.params[index];
+
+    mavlink_param_value_t param_value{};
+    std::memcpy(param_value.param_id, param.id, sizeof(param_value.param_id));
+    param_value.param_value = param.value;
+    param_value.param_type = param.type;
+    param_value.param_count = static_cast<uint16_t>(vehicle.params.size());
+    param_value.param_index = index;
+    mavlink_message_t message;
+    mavlink_msg_param_value_encode(vehicle.system_id, component_id, &message, &param_value);
+    send(vehicle, message);
+}
+
+void VehicleSimulator::send_autopilot_version(Vehicle& vehicle)
+{
+    mavlink_autopilot_version_t autopilot_version{};
+    autopilot_version.capabilities =
+        MAV_PROTOCOL_CAPABILITY_MISSION_INT | MAV_PROTOCOL_CAPABILITY_PARAM_FLOAT |
+        MAV_PROTOCOL_CAPABILITY_COMMAND_INT | MAV_PROTOCOL_CAPABILITY_MAVLINK2;
+    autopilot_version.uid = vehicle.system_id;
+    mavlink_message_t message;
+    mavlink_msg_autopilot_version_encode(
+        vehicle.system_id, component_id, &message, &autopilot_version);
+    send(vehicle, message);
+}
+
+void VehicleSimulator::send(Vehicle& vehicle, mavlink_message_t& message)
+{
+#if !defined(WINDOWS)
+    // Packing used MAVLink's global channel, every vehicle needs a sequence of its own.
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(message.msgid);
+    mavlink_finalize_message_buffer(
+        &message,
+        vehicle.system_id,
+        component_id,
+        &vehicle.status,
+        entry != nullptr ? entry->min_msg_len : message.len,
+        message.len,
+        entry != nullptr ? entry->crc_extra : 0);
+
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const auto length = mavlink_msg_to_send_buffer(buffer, &message);
+
+    sockaddr_in dest{};
+    dest.sin_family = AF_INET;
+    dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    dest.sin_port = htons(static_cast<uint16_t>(_ground_station_port));
+    if (sendto(vehicle.fd, buffer, length, 0, reinterpret_cast<sockaddr*>(&dest), sizeof(dest)) >
+        0) {
+        _messages_sent.fetch_add(1, std::memory_order_relaxed);
+    }
+#else
+    (void)vehicle;
+    (void)message;
+#endif
+}
+
+double VehicleSimulator::now_s()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+std::vector<VehicleSimulator::Param> VehicleSimulator::default_params()
+{
+    // A few of what PX4 has, enough for the parameter protocol to be exercised.
+    auto int_param = [](const char* id, int32_t value) {
+        Param param{};
+        std::memcpy(param.id, id, std::min(std::strlen(id), sizeof(param.id)));
+        // PX4 sends integers bytewise in the float.
+        std::memcpy(&param.value, &value, sizeof(value));
+        param.type = MAV_PARAM_TYPE_INT32;
+        return param;
+    };
+    auto float_param = [](const char* id, float value) {
+        Param param{};
+        std::memcpy(param.id, id, std::min(std::strlen(id), sizeof(param.id)));
+        param.value = value;
+        param.type = MAV_PARAM_TYPE_REAL32;
+        return param;
+    };
+
+    return {
+        int_param("CAL_ACC0_ID", 1310988),
+        int_param("CAL_GYRO0_ID", 1310988),
+        int_param("CAL_MAG0_ID", 197388),
+        int_param("COM_RC_IN_MODE", 1),
+        int_param("SYS_HITL", 0),
+        float_param("MIS_TAKEOFF_ALT", 2.5f),
+        float_param("MPC_XY_VEL_MAX", 12.0f),
+        float_param("MPC_Z_VEL_MAX_UP", 3.0f),
+        float_param("RTL_RETURN_ALT", 30.0f),
+        float_param("BAT1_V_CHARGED", 4.05f),
+    };
+}
+
+} // namespace mavsdk
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <thread>
+#include <vector>
+#include "mavlink_include.h"
+
+namespace mavsdk {
+
+// Vehicles simulated in-process for tests and benchmarks which need more
+// of them than SITL instances could be run.
+//
+// Every vehicle has a loopback UDP socket of its own, so MAVSDK sees it as a
+// separate remote. It sends a heartbeat and the PX4 default telemetry
+// streams to the ground station port, acknowledges commands, and answers
+// the parameter and mission protocols. One thread serves all vehicles.
+class VehicleSimulator {
+public:
+    VehicleSimulator() = default;
+    ~VehicleSimulator();
+
+    // Non-copyable
+    VehicleSimulator(const VehicleSimulator&) = delete;
+    const VehicleSimulator& operator=(const VehicleSimulator&) = delete;
+
+    // Starts count vehicles, with system IDs from first_system_id on, which
+    // send to the ground station listening on UDP port ground_station_port.
+    // The stream rates are multiplied by rate_scale.
+    bool start(
+        unsigned count,
+        int ground_station_port,
+        uint8_t first_system_id = 1,
+        float rate_scale = 1.0f);
+    void stop();
+
+    // Time the simulator thread spent on the CPU, so it can be told apart
+    // from what MAVSDK used in the same process.
+    [[nodiscard]] uint64_t cpu_time_ns() const { return _cpu_time_ns; }
+
+    [[nodiscard]] uint64_t messages_sent() const { return _messages_sent; }
+
+private:
+    struct Param {
+        char id[16];
+        float value;
+        uint8_t type;
+    };
+
+    struct Vehicle {
+        int fd{-1};
+        uint8_t system_id{0};
+        mavlink_status_t status{};
+        std::vector<double> next_send_s{};
+        std::vector<Param> params{};
+        std::map<uint8_t, std::vector<mavlink_mission_item_int_t>> missions{};
+        uint16_t upload_count{0};
+        uint8_t upload_mission_type{0};
+    };
+
+    void run();
+    void send_streams(Vehicle& vehicle, double now_s);
+    void receive(Vehicle& vehicle);
+    void handle(Vehicle& vehicle, const mavlink_message_t& message);
+    void handle_command(Vehicle& vehicle, uint16_t command, float param1);
+    void handle_param_request_read(Vehicle& vehicle, const mavlink_message_t& message);
+    void handle_param_set(Vehicle& vehicle, const mavlink_message_t& message);
+    void handle_mission_request_list(Vehicle& vehicle, const mavlink_message_t& message);
+    void handle_mission_request_int(Vehicle& vehicle, const mavlink_message_t& message);
+    void handle_mission_count(Vehicle& vehicle, const mavlink_message_t& message);
+    void handle_mission_item_int(Vehicle& vehicle, const mavlink_message_t& message);
+    void handle_mission_clear_all(Vehicle& vehicle, const mavlink_message_t& message);
+    void send_mission_request(
+        Vehicle& vehicle, const mavlink_message_t& request, uint16_t seq, uint8_t mission_type);
+    void send_mission_ack(Vehicle& vehicle, const mavlink_message_t& request, uint8_t mission_type);
+    void send_param_value(Vehicle& vehicle, uint16_t index);
+    void send_autopilot_version(Vehicle& vehicle);
+    void send(Vehicle& vehicle, mavlink_message_t& message);
+
+    static double now_s();
+    static std::vector<Param> default_params();
+
+    std::vector<Vehicle> _vehicles{};
+    int _ground_station_port{0};
+    float _rate_scale{1.0f};
+
+    std::atomic<bool> _should_exit{false};
+    std::atomic<uint64_t> _cpu_time_ns{0};
+    std::atomic<uint64_t> _messages_sent{0};
+    std::thread _thread{};
+};
+
+} // namespace mavsdk
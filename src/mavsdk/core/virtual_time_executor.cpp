@@ -0,0 +1,121 @@
+#include "virtual_time_executor.h"
+
+#include <algorithm>
+
+namespace mavsdk {
+
+// Timeouts and periodic calls run once their due time has passed, not when it
+// is reached, so time is always moved a little beyond.
+static constexpr std::chrono::microseconds TICK{1};
+
+VirtualTimeExecutor::VirtualTimeExecutor(FakeTime& time) :
+    _time(time),
+    _start_time(time.steady_time()),
+    _timeout_handler(time),
+    _call_every_handler(time)
+{}
+
+void VirtualTimeExecutor::post(UniqueFunction<void()> task)
+{
+    post_in(0.0, std::move(task));
+}
+
+void VirtualTimeExecutor::post_in(double delay_s, UniqueFunction<void()> task)
+{
+    dl_time_t due = _time.steady_time();
+    Time::shift_steady_time_by(due, std::max(0.0, delay_s));
+
+    _tasks.push_back(Task{due, _next_sequence++, std::move(task)});
+    std::push_heap(_tasks.begin(), _tasks.end(), is_later);
+}
+
+bool VirtualTimeExecutor::step()
+{
+    const auto due = next_due();
+    if (!due) {
+        return false;
+    }
+
+    _time.advance_to(due.value() + TICK);
+
+    run_due_tasks();
+    _timeout_handler.run_once();
+    _call_every_handler.run_once();
+    return true;
+}
+
+void VirtualTimeExecutor::run_for(double duration_s)
+{
+    dl_time_t end = _time.steady_time();
+    Time::shift_steady_time_by(end, duration_s);
+
+    for (auto due = next_due(); due && due.value() < end; due = next_due()) {
+        step();
+    }
+    _time.advance_to(end);
+}
+
+bool VirtualTimeExecutor::run_until(const std::function<bool()>& done, double timeout_s)
+{
+    dl_time_t end = _time.steady_time();
+    Time::shift_steady_time_by(end, timeout_s);
+
+    while (!done()) {
+        const auto due = next_due();
+        if (!due || due.value() >= end) {
+            _time.advance_to(end);
+            return done();
+        }
+        step();
+    }
+    return true;
+}
+
+double VirtualTimeExecutor::elapsed_s()
+{
+    return _time.elapsed_since_s(_start_time);
+}
+
+bool VirtualTimeExecutor::is_later(const Task& lhs, const Task& rhs)
+{
+    if (lhs.due != rhs.due) {
+        return lhs.due > rhs.due;
+    }
+    return lhs.sequence > rhs.sequence;
+}
+
+std::optional<dl_time_t> VirtualTimeExecutor::next_due()
+{
+    std::optional<dl_time_t> due;
+    const auto consider = [&due](std::optional<dl_time_t> time) {
+        if (time && (!due || time.value() < due.value())) {
+            due = time;
+        }
+    };
+
+    if (!_tasks.empty()) {
+        consider(_tasks.front().due);
+    }
+    consider(_timeout_handler.next_deadline());
+    consider(_call_every_handler.next_deadline());
+    return due;
+}
+
+void VirtualTimeExecutor::run_due_tasks()
+{
+    const dl_time_t now = _time.steady_time();
+
+    // Tasks posted while running get a later sequence number, so the ones
+    // posted for now run in the next step, after the handlers.
+    const uint64_t end_sequence = _next_sequence;
+
+    while (!_tasks.empty() && _tasks.front().due < now &&
+           _tasks.front().sequence < end_sequence) {
+        std::pop_heap(_tasks.begin(), _tasks.end(), is_later);
+        auto task = std::move(_tasks.back());
+        _tasks.pop_back();
+        task.function();
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "call_every_handler.h"
+#include "mavsdk_time.h"
+#include "timeout_handler.h"
+#include "unique_function.h"
+
+namespace mavsdk {
+
+// Single threaded, step driven executor on virtual time.
+//
+// Timeouts, periodic calls and posted tasks all run on the thread calling
+// step(), and instead of sleeping until the next of them is due, the
+// FakeTime is moved straight to it. Scenarios spanning hours of timeouts and
+// retries thus run as fast as the code under test allows, and the same
+// inputs always lead to the same events in the same order.
+//
+// Whatever is to run on virtual time needs to use the handlers and the time
+// of the executor.
+class VirtualTimeExecutor {
+public:
+    explicit VirtualTimeExecutor(FakeTime& time);
+    ~VirtualTimeExecutor() = default;
+
+    FakeTime& time() { return _time; }
+    TimeoutHandler& timeout_handler() { return _timeout_handler; }
+    CallEveryHandler& call_every_handler() { return _call_every_handler; }
+
+    // Tasks run in the order they are due, the ones due at the same time in
+    // the order they were posted.
+    void post(UniqueFunction<void()> task);
+    void post_in(double delay_s, UniqueFunction<void()> task);
+
+    // Moves the time to whatever is due next and runs everything due by
+    // then. Returns false if there is nothing left to run.
+    bool step();
+
+    // Runs everything due within the duration, the time has moved by it
+    // afterwards.
+    void run_for(double duration_s);
+
+    // Runs until done() returns true, checked before every step, or until
+    // the timeout has passed. Returns whether it is done.
+    bool run_until(const std::function<bool()>& done, double timeout_s);
+
+    // Virtual time since the executor was created.
+    double elapsed_s();
+
+    // Non-copyable
+    VirtualTimeExecutor(const VirtualTimeExecutor&) = delete;
+    const VirtualTimeExecutor& operator=(const VirtualTimeExecutor&) = delete;
+
+private:
+    struct Task {
+        dl_time_t due;
+        uint64_t sequence;
+        UniqueFunction<void()> function;
+    };
+
+    // For the heap, which keeps the greatest element on top.
+    static bool is_later(const Task& lhs, const Task& rhs);
+
+    std::optional<dl_time_t> next_due();
+    void run_due_tasks();
+
+    FakeTime& _time;
+    const dl_time_t _start_time;
+    TimeoutHandler _timeout_handler;
+    CallEveryHandler _call_every_handler;
+
+    std::vector<Task> _tasks{};
+    uint64_t _next_sequence{0};
+};
+
+} // namespace mavsdk
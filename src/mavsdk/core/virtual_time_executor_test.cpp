@@ -0,0 +1,87 @@
+#include "virtual_time_executor.h"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace mavsdk;
+
+TEST(VirtualTimeExecutor, TasksRunInOrderOfDueTime)
+{
+    FakeTime time;
+    VirtualTimeExecutor executor(time);
+
+    std::vector<int> order;
+    executor.post_in(2.0, [&]() { order.push_back(3); });
+    executor.post_in(1.0, [&]() { order.push_back(1); });
+    executor.post_in(1.0, [&]() { order.push_back(2); });
+    executor.post([&]() { order.push_back(0); });
+
+    while (executor.step()) {
+    }
+
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3}));
+    EXPECT_NEAR(executor.elapsed_s(), 2.0, 1e-3);
+}
+
+TEST(VirtualTimeExecutor, TasksCanPostTasks)
+{
+    FakeTime time;
+    VirtualTimeExecutor executor(time);
+
+    int count = 0;
+    std::function<void()> tick = [&]() {
+        if (++count < 1000) {
+            executor.post_in(1.0, [&]() { tick(); });
+        }
+    };
+    executor.post([&]() { tick(); });
+
+    EXPECT_TRUE(executor.run_until([&]() { return count == 1000; }, 2000.0));
+    EXPECT_NEAR(executor.elapsed_s(), 999.0, 1e-2);
+}
+
+TEST(VirtualTimeExecutor, TimeoutsRunOnVirtualTime)
+{
+    FakeTime time;
+    VirtualTimeExecutor executor(time);
+
+    bool timed_out = false;
+    void* cookie = nullptr;
+    executor.timeout_handler().add([&]() { timed_out = true; }, 3600.0, &cookie);
+
+    EXPECT_TRUE(executor.run_until([&]() { return timed_out; }, 7200.0));
+    EXPECT_NEAR(executor.elapsed_s(), 3600.0, 1e-3);
+}
+
+TEST(VirtualTimeExecutor, CallEveryRunsOnVirtualTime)
+{
+    FakeTime time;
+    VirtualTimeExecutor executor(time);
+
+    int count = 0;
+    void* cookie = nullptr;
+    executor.call_every_handler().add([&]() { ++count; }, 1.0, &cookie);
+
+    // Called straightaway, and then once a second.
+    executor.run_for(9.5);
+    EXPECT_EQ(count, 10);
+    EXPECT_NEAR(executor.elapsed_s(), 9.5, 1e-6);
+
+    executor.call_every_handler().remove(cookie);
+    EXPECT_FALSE(executor.step());
+}
+
+TEST(VirtualTimeExecutor, RunUntilGivesUpAfterTimeout)
+{
+    FakeTime time;
+    VirtualTimeExecutor executor(time);
+
+    bool ran = false;
+    executor.post_in(10.0, [&]() { ran = true; });
+
+    EXPECT_FALSE(executor.run_until([&]() { return ran; }, 5.0));
+    EXPECT_FALSE(ran);
+    EXPECT_NEAR(executor.elapsed_s(), 5.0, 1e-6);
+
+    EXPECT_TRUE(executor.run_until([&]() { return ran; }, 10.0));
+}
@@ -0,0 +1,123 @@
+#include "write_combiner.h"
+
+#include <utility>
+
+namespace mavsdk {
+
+WriteCombiner::WriteCombiner(
+    WriteFunction write_function,
+    double flush_delay_s,
+    std::size_t flush_bytes,
+    ThreadSetup thread_setup) :
+    _write_function(std::move(write_function)),
+    _flush_delay(std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(flush_delay_s > 0.0 ? flush_delay_s : 0.0))),
+    _flush_bytes(flush_bytes),
+    _thread_setup(std::move(thread_setup))
+{
+    _buffer.reserve(_flush_bytes);
+    _writing.reserve(_flush_bytes);
+
+    if (_flush_delay > Clock::duration::zero()) {
+        _thread = std::make_unique<NativeThread>(
+            _thread_setup.settings.stack_size_bytes, [this]() { run(); });
+    }
+}
+
+WriteCombiner::~WriteCombiner()
+{
+    if (_thread) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _should_exit = true;
+        }
+        _cv.notify_all();
+        _thread->join();
+    }
+
+    flush();
+}
+
+bool WriteCombiner::write(const uint8_t* data, std::size_t length)
+{
+    bool was_empty = false;
+    if (buffer(data, length, was_empty) || !_thread) {
+        return flush();
+    }
+
+    // Otherwise the thread is already waiting for the deadline.
+    if (was_empty) {
+        _cv.notify_one();
+    }
+    return true;
+}
+
+bool WriteCombiner::append(const uint8_t* data, std::size_t length)
+{
+    bool was_empty = false;
+    if (buffer(data, length, was_empty)) {
+        return flush();
+    }
+    return true;
+}
+
+bool WriteCombiner::buffer(const uint8_t* data, std::size_t length, bool& was_empty)
+{
+    // Returns whether the buffer is full and needs to be flushed.
+    std::lock_guard<std::mutex> lock(_mutex);
+    was_empty = _buffer.empty();
+    if (was_empty) {
+        _deadline = Clock::now() + _flush_delay;
+    }
+    _buffer.insert(_buffer.end(), data, data + length);
+    return _buffer.size() >= _flush_bytes;
+}
+
+bool WriteCombiner::flush()
+{
+    std::lock_guard<std::mutex> write_lock(_write_mutex);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_buffer.empty()) {
+            return true;
+        }
+        _buffer.swap(_writing);
+        ++_writes;
+    }
+
+    const bool success = _write_function(_writing.data(), _writing.size());
+    _writing.clear();
+    return success;
+}
+
+uint64_t WriteCombiner::writes() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _writes;
+}
+
+void WriteCombiner::run()
+{
+    _thread_setup.apply();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (!_should_exit) {
+        if (_buffer.empty()) {
+            _cv.wait(lock);
+            continue;
+        }
+
+        // Flushed in the meantime because the buffer got full, or stopping.
+        if (_cv.wait_until(
+                lock, _deadline, [this]() { return _should_exit || _buffer.empty(); })) {
+            continue;
+        }
+
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "native_thread.h"
+#include "thread_setup.h"
+
+namespace mavsdk {
+
+// Gathers small writes to a stream, such as a serial port or a TCP socket,
+// so frames sent close together go out with one syscall instead of one each.
+//
+// Data is written once flush_bytes are buffered, or flush_delay_s after the
+// first byte was buffered, whichever comes first. Without a delay, single
+// writes go out right away and only appended batches are combined. The
+// delayed flush runs on a thread of its own, which is only started if there
+// is a delay.
+class WriteCombiner {
+public:
+    // Needs to write all of the data, returns false on failure.
+    using WriteFunction = std::function<bool(const uint8_t* data, std::size_t length)>;
+
+    static constexpr std::size_t DEFAULT_FLUSH_BYTES = 1024;
+
+    WriteCombiner(
+        WriteFunction write_function,
+        double flush_delay_s,
+        std::size_t flush_bytes = DEFAULT_FLUSH_BYTES,
+        ThreadSetup thread_setup = {});
+
+    // Writes what is still buffered.
+    ~WriteCombiner();
+
+    // Non-copyable
+    WriteCombiner(const WriteCombiner&) = delete;
+    const WriteCombiner& operator=(const WriteCombiner&) = delete;
+
+    // Returns false if the data needed to be written right away and that
+    // failed. Failures of delayed writes are up to the write function to report.
+    bool write(const uint8_t* data, std::size_t length);
+
+    // Like write but to be followed by flush(), to combine a batch.
+    bool append(const uint8_t* data, std::size_t length);
+
+    bool flush();
+
+    // Number of writes done, for statistics.
+    [[nodiscard]] uint64_t writes() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    bool buffer(const uint8_t* data, std::size_t length, bool& was_empty);
+    void run();
+
+    WriteFunction _write_function;
+    const Clock::duration _flush_delay;
+    const std::size_t _flush_bytes;
+    const ThreadSetup _thread_setup;
+
+    // Held while writing, so buffers are written in the order they were filled.
+    std::mutex _write_mutex{};
+    std::vector<uint8_t> _writing{};
+
+    mutable std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::vector<uint8_t> _buffer{};
+    Clock::time_point _deadline{};
+    uint64_t _writes{0};
+    bool _should_exit{false};
+
+    std::unique_ptr<NativeThread> _thread{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,105 @@
+#include "write_combiner.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+class Writes {
+public:
+    WriteCombiner::WriteFunction function()
+    {
+        return [this](const uint8_t* data, std::size_t length) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _writes.emplace_back(data, data + length);
+            return true;
+        };
+    }
+
+    std::vector<std::vector<uint8_t>> get()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _writes;
+    }
+
+private:
+    std::mutex _mutex;
+    std::vector<std::vector<uint8_t>> _writes;
+};
+
+const uint8_t frame_a[] = {1, 2, 3};
+const uint8_t frame_b[] = {4, 5};
+
+} // namespace
+
+TEST(WriteCombiner, WritesRightAwayWithoutDelay)
+{
+    Writes writes;
+    WriteCombiner combiner(writes.function(), 0.0);
+
+    EXPECT_TRUE(combiner.write(frame_a, sizeof(frame_a)));
+    EXPECT_TRUE(combiner.write(frame_b, sizeof(frame_b)));
+
+    EXPECT_EQ(writes.get().size(), 2u);
+    EXPECT_EQ(combiner.writes(), 2u);
+}
+
+TEST(WriteCombiner, CombinesAppendedBatch)
+{
+    Writes writes;
+    WriteCombiner combiner(writes.function(), 0.0);
+
+    EXPECT_TRUE(combiner.append(frame_a, sizeof(frame_a)));
+    EXPECT_TRUE(combiner.append(frame_b, sizeof(frame_b)));
+    EXPECT_TRUE(writes.get().empty());
+
+    EXPECT_TRUE(combiner.flush());
+    ASSERT_EQ(writes.get().size(), 1u);
+    EXPECT_EQ(writes.get()[0], (std::vector<uint8_t>{1, 2, 3, 4, 5}));
+}
+
+TEST(WriteCombiner, FlushesAfterDelay)
+{
+    Writes writes;
+    WriteCombiner combiner(writes.function(), 0.02);
+
+    EXPECT_TRUE(combiner.write(frame_a, sizeof(frame_a)));
+    EXPECT_TRUE(combiner.write(frame_b, sizeof(frame_b)));
+    EXPECT_TRUE(writes.get().empty());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(writes.get().size(), 1u);
+    EXPECT_EQ(writes.get()[0], (std::vector<uint8_t>{1, 2, 3, 4, 5}));
+}
+
+TEST(WriteCombiner, FlushesWhenFull)
+{
+    Writes writes;
+    WriteCombiner combiner(writes.function(), 10.0, 5);
+
+    EXPECT_TRUE(combiner.write(frame_a, sizeof(frame_a)));
+    EXPECT_TRUE(writes.get().empty());
+    EXPECT_TRUE(combiner.write(frame_b, sizeof(frame_b)));
+    EXPECT_EQ(writes.get().size(), 1u);
+}
+
+TEST(WriteCombiner, FlushesOnDestruction)
+{
+    Writes writes;
+    {
+        WriteCombiner combiner(writes.function(), 10.0);
+        EXPECT_TRUE(combiner.write(frame_a, sizeof(frame_a)));
+    }
+    EXPECT_EQ(writes.get().size(), 1u);
+}
+
+TEST(WriteCombiner, ReportsFailedWrite)
+{
+    WriteCombiner combiner([](const uint8_t*, std::size_t) { return false; }, 0.0);
+    EXPECT_FALSE(combiner.write(frame_a, sizeof(frame_a)));
+}
@@ -318,4 +318,37 @@ std::ostream& operator<<(std::ostream& str, Action::OrbitYawBehavior const& orbi
     }
 }
 
+std::vector<ActionImpl*> Action::impls_of(const std::vector<Action*>& actions)
+{
+    std::vector<ActionImpl*> impls;
+    impls.reserve(actions.size());
+    for (auto* action : actions) {
+        impls.push_back(action->_impl.get());
+    }
+    return impls;
+}
+
+void Action::arm_fleet_async(
+    const std::vector<Action*>& actions, const FleetResultCallback& callback)
+{
+    ActionImpl::fleet_command_async(impls_of(actions), ActionImpl::FleetCommand::Arm, callback);
+}
+
+std::vector<Action::FleetResult> Action::arm_fleet(const std::vector<Action*>& actions)
+{
+    return ActionImpl::fleet_command(impls_of(actions), ActionImpl::FleetCommand::Arm);
+}
+
+void Action::takeoff_fleet_async(
+    const std::vector<Action*>& actions, const FleetResultCallback& callback)
+{
+    ActionImpl::fleet_command_async(
+        impls_of(actions), ActionImpl::FleetCommand::Takeoff, callback);
+}
+
+std::vector<Action::FleetResult> Action::takeoff_fleet(const std::vector<Action*>& actions)
+{
+    return ActionImpl::fleet_command(impls_of(actions), ActionImpl::FleetCommand::Takeoff);
+}
+
 } // namespace mavsdk
\ No newline at end of file
@@ -2,8 +2,10 @@
 #include "mavsdk_impl.h"
 #include "mavsdk_math.h"
 #include "px4_custom_mode.h"
+#include "sync_waiter.h"
 #include <cmath>
-#include <future>
+#include <mutex>
+#include <optional>
 
 namespace mavsdk {
 
@@ -53,92 +55,83 @@ void ActionImpl::disable() {}
 
 Action::Result ActionImpl::arm() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
-    arm_async([&prom](Action::Result result) { prom.set_value(result); });
+    arm_async(waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 Action::Result ActionImpl::disarm() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
-    disarm_async([&prom](Action::Result result) { prom.set_value(result); });
+    disarm_async(waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 Action::Result ActionImpl::terminate() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
-    terminate_async([&prom](Action::Result result) { prom.set_value(result); });
+    terminate_async(waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 Action::Result ActionImpl::kill() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
-    kill_async([&prom](Action::Result result) { prom.set_value(result); });
+    kill_async(waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 Action::Result ActionImpl::reboot() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
-    reboot_async([&prom](Action::Result result) { prom.set_value(result); });
+    reboot_async(waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 Action::Result ActionImpl::shutdown() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
-    shutdown_async([&prom](Action::Result result) { prom.set_value(result); });
+    shutdown_async(waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 Action::Result ActionImpl::takeoff() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
-    takeoff_async([&prom](Action::Result result) { prom.set_value(result); });
+    takeoff_async(waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 Action::Result ActionImpl::land() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
-    land_async([&prom](Action::Result result) { prom.set_value(result); });
+    land_async(waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 Action::Result ActionImpl::return_to_launch() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
-    return_to_launch_async([&prom](Action::Result result) { prom.set_value(result); });
+    return_to_launch_async(waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 Action::Result ActionImpl::goto_location(
@@ -147,15 +140,12 @@ Action::Result ActionImpl::goto_location(
     const float altitude_amsl_m,
     const float yaw_deg)
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
     goto_location_async(
-        latitude_deg, longitude_deg, altitude_amsl_m, yaw_deg, [&prom](Action::Result result) {
-            prom.set_value(result);
-        });
+        latitude_deg, longitude_deg, altitude_amsl_m, yaw_deg, waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 Action::Result ActionImpl::do_orbit(
@@ -166,8 +156,7 @@ Action::Result ActionImpl::do_orbit(
     const double longitude_deg,
     const double absolute_altitude_m)
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
     do_orbit_async(
         radius_m,
@@ -176,49 +165,45 @@ Action::Result ActionImpl::do_orbit(
         latitude_deg,
         longitude_deg,
         absolute_altitude_m,
-        [&prom](Action::Result result) { prom.set_value(result); });
+        waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 Action::Result ActionImpl::hold() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
-    hold_async([&prom](Action::Result result) { prom.set_value(result); });
+    hold_async(waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 Action::Result ActionImpl::set_actuator(const int index, const float value)
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
-    set_actuator_async(index, value, [&prom](Action::Result result) { prom.set_value(result); });
+    set_actuator_async(index, value, waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 Action::Result ActionImpl::transition_to_fixedwing() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
-    transition_to_fixedwing_async([&prom](Action::Result result) { prom.set_value(result); });
+    transition_to_fixedwing_async(waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 Action::Result ActionImpl::transition_to_multicopter() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
-    transition_to_multicopter_async([&prom](Action::Result result) { prom.set_value(result); });
+    transition_to_multicopter_async(waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 void ActionImpl::arm_async(const Action::ResultCallback& callback) const
@@ -246,6 +231,7 @@ void ActionImpl::arm_async(const Action::ResultCallback& callback) const
                     if (callback) {
                         callback(action_result);
                     }
+                    return;
                 }
                 send_arm_command();
             });
@@ -560,6 +546,145 @@ Action::Result ActionImpl::taking_off_allowed() const
     return Action::Result::Success;
 }
 
+Action::Result ActionImpl::prepare_fleet_command(
+    FleetCommand which, MavlinkCommandSender::CommandLong& command) const
+{
+    if (!_parent->is_connected()) {
+        return Action::Result::NoSystem;
+    }
+
+    command.target_component_id = _parent->get_autopilot_id();
+
+    switch (which) {
+        case FleetCommand::Arm:
+            // Unlike arm_async(), there is no time to switch to Hold first.
+            if (_parent->get_flight_mode() == SystemImpl::FlightMode::Mission ||
+                _parent->get_flight_mode() == SystemImpl::FlightMode::ReturnToLaunch) {
+                return Action::Result::CommandDenied;
+            }
+            command.command = MAV_CMD_COMPONENT_ARM_DISARM;
+            command.params.maybe_param1 = 1.0f; // arm
+            return Action::Result::Success;
+
+        case FleetCommand::Takeoff: {
+            const auto allowed = taking_off_allowed();
+            if (allowed != Action::Result::Success) {
+                return allowed;
+            }
+            command.command = MAV_CMD_NAV_TAKEOFF;
+            if (_parent->autopilot() == SystemImpl::Autopilot::ArduPilot) {
+                command.params.maybe_param7 = _takeoff_altitude;
+            }
+            return Action::Result::Success;
+        }
+    }
+
+    return Action::Result::Unknown;
+}
+
+void ActionImpl::fleet_command_async(
+    const std::vector<ActionImpl*>& impls,
+    FleetCommand which,
+    const Action::FleetResultCallback& callback)
+{
+    if (impls.empty()) {
+        if (callback) {
+            callback({});
+        }
+        return;
+    }
+
+    struct Fleet {
+        std::mutex mutex{};
+        std::vector<Action::FleetResult> results{};
+        std::size_t remaining{0};
+    };
+
+    auto fleet = std::make_shared<Fleet>();
+    fleet->results.resize(impls.size());
+    fleet->remaining = impls.size();
+
+    // Everything is decided before the first command goes out, so that
+    // they can be sent back to back.
+    std::vector<std::optional<MavlinkCommandSender::CommandLong>> commands(impls.size());
+    for (std::size_t i = 0; i < impls.size(); ++i) {
+        fleet->results[i].system_id = impls[i]->_parent->get_system_id();
+
+        MavlinkCommandSender::CommandLong command{};
+        const auto result = impls[i]->prepare_fleet_command(which, command);
+        if (result == Action::Result::Success) {
+            commands[i] = command;
+        } else {
+            fleet->results[i].result = result;
+        }
+    }
+
+    auto parent = impls.front()->_parent;
+    auto finish = [fleet, parent, callback](
+                      std::size_t index, Action::Result result, double latency_s) {
+        std::vector<Action::FleetResult> results;
+        {
+            std::lock_guard<std::mutex> lock(fleet->mutex);
+            fleet->results[index].result = result;
+            fleet->results[index].latency_s = latency_s;
+            if (--fleet->remaining != 0) {
+                return;
+            }
+            results = std::move(fleet->results);
+        }
+
+        if (completes_waiter(callback)) {
+            callback(std::move(results));
+        } else if (callback) {
+            auto temp_callback = callback;
+            parent->call_user_callback(
+                [temp_callback, results = std::move(results)]() { temp_callback(results); });
+        }
+    };
+
+    auto& time = parent->get_time();
+    const auto start = time.steady_time();
+
+    for (std::size_t i = 0; i < impls.size(); ++i) {
+        if (!commands[i]) {
+            continue;
+        }
+
+        const auto sent = time.steady_time();
+        {
+            std::lock_guard<std::mutex> lock(fleet->mutex);
+            fleet->results[i].send_offset_s = time.elapsed_since_s(start);
+        }
+
+        impls[i]->_parent->send_command_async(
+            commands[i].value(),
+            [finish, i, sent, &time](MavlinkCommandSender::Result result, float) {
+                // Only the final answer counts.
+                if (result == MavlinkCommandSender::Result::InProgress) {
+                    return;
+                }
+                finish(i, action_result_from_command_result(result), time.elapsed_since_s(sent));
+            });
+    }
+
+    for (std::size_t i = 0; i < impls.size(); ++i) {
+        if (!commands[i]) {
+            const auto result = fleet->results[i].result;
+            finish(i, result, 0.0);
+        }
+    }
+}
+
+std::vector<Action::FleetResult>
+ActionImpl::fleet_command(const std::vector<ActionImpl*>& impls, FleetCommand which)
+{
+    SyncWaiter<std::vector<Action::FleetResult>> waiter;
+
+    fleet_command_async(impls, which, waiter.completion());
+
+    return waiter.wait();
+}
+
 Action::Result ActionImpl::disarming_allowed() const
 {
     if (!_in_air_state_known) {
@@ -706,12 +831,11 @@ void ActionImpl::set_current_speed_async(float speed_m_s, const Action::ResultCa
 
 Action::Result ActionImpl::set_current_speed(float speed_m_s)
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Action::Result> waiter;
 
-    set_current_speed_async(speed_m_s, [&prom](Action::Result result) { prom.set_value(result); });
+    set_current_speed_async(speed_m_s, waiter.completion());
 
-    return fut.get();
+    return waiter.wait();
 }
 
 Action::Result ActionImpl::action_result_from_command_result(MavlinkCommandSender::Result result)
@@ -741,7 +865,10 @@ void ActionImpl::command_result_callback(
 {
     Action::Result action_result = action_result_from_command_result(command_result);
 
-    if (callback) {
+    // A sync call is woken up right away, there is no user code to run.
+    if (completes_waiter(callback)) {
+        callback(action_result);
+    } else if (callback) {
         auto temp_callback = callback;
         _parent->call_user_callback(
             [temp_callback, action_result]() { temp_callback(action_result); });
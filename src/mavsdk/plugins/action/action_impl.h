@@ -5,6 +5,7 @@
 #include "plugin_impl_base.h"
 #include <atomic>
 #include <cstdint>
+#include <vector>
 
 namespace mavsdk {
 
@@ -100,10 +101,24 @@ public:
     Action::Result set_return_to_launch_altitude(const float relative_altitude_m) const;
     std::pair<Action::Result, float> get_return_to_launch_altitude() const;
 
+    // Commands sent to several vehicles back to back, see Action::arm_fleet_async().
+    enum class FleetCommand { Arm, Takeoff };
+
+    static void fleet_command_async(
+        const std::vector<ActionImpl*>& impls,
+        FleetCommand which,
+        const Action::FleetResultCallback& callback);
+    static std::vector<Action::FleetResult>
+    fleet_command(const std::vector<ActionImpl*>& impls, FleetCommand which);
+
 private:
     Action::Result disarming_allowed() const;
     Action::Result taking_off_allowed() const;
 
+    // Decides from the state received before, the command is filled in if it can be sent.
+    Action::Result
+    prepare_fleet_command(FleetCommand which, MavlinkCommandSender::CommandLong& command) const;
+
     void process_extended_sys_state(const mavlink_message_t& message);
 
     static Action::Result action_result_from_command_result(MavlinkCommandSender::Result result);
@@ -103,6 +103,16 @@ public:
      */
     friend std::ostream& operator<<(std::ostream& str, Action::Result const& result);
 
+    /**
+     * @brief Result of a command sent to several vehicles at once.
+     */
+    struct FleetResult {
+        uint8_t system_id{0}; /**< @brief System ID of the vehicle. */
+        Result result{Result::Unknown}; /**< @brief Result for this vehicle. */
+        double send_offset_s{0.0}; /**< @brief Time from the call until the command was sent. */
+        double latency_s{0.0}; /**< @brief Time from sending the command until the answer. */
+    };
+
     /**
      * @brief Callback type for asynchronous Action calls.
      */
@@ -609,6 +619,54 @@ public:
      */
     Result set_current_speed(float speed_m_s) const;
 
+    /**
+     * @brief Callback type for the fleet calls, with one result per vehicle in the given order.
+     */
+    using FleetResultCallback = std::function<void(std::vector<FleetResult>)>;
+
+    /**
+     * @brief Send command to arm several vehicles at once.
+     *
+     * Whether each vehicle can be armed is decided from what it reported before, without asking
+     * it, and the commands are then sent back to back. Vehicles which are not connected, or which
+     * are flying a mission or returning to launch, are not sent anything and get an error result.
+     * The callback is called once all vehicles answered or timed out.
+     *
+     * This function is non-blocking. See 'arm_fleet' for the blocking counterpart.
+     */
+    static void
+    arm_fleet_async(const std::vector<Action*>& actions, const FleetResultCallback& callback);
+
+    /**
+     * @brief Send command to arm several vehicles at once.
+     *
+     * This function is blocking. See 'arm_fleet_async' for the non-blocking counterpart.
+     *
+     * @return Results, one per vehicle in the given order.
+     */
+    static std::vector<FleetResult> arm_fleet(const std::vector<Action*>& actions);
+
+    /**
+     * @brief Send command to take off and hover to several vehicles at once.
+     *
+     * Whether each vehicle can take off is decided from the landed state it reported before,
+     * without asking it, and the commands are then sent back to back. The callback is called once
+     * all vehicles answered or timed out.
+     *
+     * This function is non-blocking. See 'takeoff_fleet' for the blocking counterpart.
+     */
+    static void
+    takeoff_fleet_async(const std::vector<Action*>& actions, const FleetResultCallback& callback);
+
+    /**
+     * @brief Send command to take off and hover to several vehicles at once.
+     *
+     * This function is blocking. See 'takeoff_fleet_async' for the non-blocking counterpart.
+     *
+     * @return Results, one per vehicle in the given order.
+     */
+    static std::vector<FleetResult> takeoff_fleet(const std::vector<Action*>& actions);
+
     /**
      * @brief Copy constructor.
      */
@@ -620,6 +678,8 @@ public:
     const Action& operator=(const Action&) = delete;
 
 private:
+    static std::vector<ActionImpl*> impls_of(const std::vector<Action*>& actions);
+
     /** @private Underlying implementation, set at instantiation */
     std::unique_ptr<ActionImpl> _impl;
 };
@@ -23,18 +23,17 @@ CalibrationImpl::~CalibrationImpl()
     _parent->unregister_plugin(this);
 }
 
-void CalibrationImpl::init()
-{
-    _parent->register_statustext_handler(
-        [this](const MavlinkStatustextHandler::Statustext& statustext) {
-            receive_statustext(statustext);
-        },
-        this);
-}
+void CalibrationImpl::init() {}
 
 void CalibrationImpl::deinit()
 {
-    _parent->unregister_statustext_handler(this);
+    _parent->cancel_work(this);
+
+    std::lock_guard<std::mutex> lock(_statustext_mutex);
+    if (_statustext_registered) {
+        _parent->unregister_statustext_handler(this);
+        _statustext_registered = false;
+    }
 }
 
 void CalibrationImpl::enable() {}
@@ -43,11 +42,15 @@ void CalibrationImpl::disable() {}
 
 void CalibrationImpl::calibrate_gyro_async(const CalibrationCallback& callback)
 {
+    // Not with the lock held, it is taken when handling statustexts.
+    start_receiving_statustext();
+
     std::lock_guard<std::mutex> lock(_calibration_mutex);
 
     if (_parent->is_armed()) {
         Calibration::ProgressData progress_data;
         call_callback(callback, Calibration::Result::FailedArmed, progress_data);
+        stop_receiving_statustext_later();
         return;
     }
 
@@ -87,11 +90,15 @@ void CalibrationImpl::call_callback(
 
 void CalibrationImpl::calibrate_accelerometer_async(const CalibrationCallback& callback)
 {
+    // Not with the lock held, it is taken when handling statustexts.
+    start_receiving_statustext();
+
     std::lock_guard<std::mutex> lock(_calibration_mutex);
 
     if (_parent->is_armed()) {
         Calibration::ProgressData progress_data;
         call_callback(callback, Calibration::Result::FailedArmed, progress_data);
+        stop_receiving_statustext_later();
         return;
     }
 
@@ -120,11 +127,15 @@ void CalibrationImpl::calibrate_accelerometer_async(const CalibrationCallback& c
 
 void CalibrationImpl::calibrate_magnetometer_async(const CalibrationCallback& callback)
 {
+    // Not with the lock held, it is taken when handling statustexts.
+    start_receiving_statustext();
+
     std::lock_guard<std::mutex> lock(_calibration_mutex);
 
     if (_parent->is_armed()) {
         Calibration::ProgressData progress_data;
         call_callback(callback, Calibration::Result::FailedArmed, progress_data);
+        stop_receiving_statustext_later();
         return;
     }
 
@@ -153,11 +164,15 @@ void CalibrationImpl::calibrate_magnetometer_async(const CalibrationCallback& ca
 
 void CalibrationImpl::calibrate_level_horizon_async(const CalibrationCallback& callback)
 {
+    // Not with the lock held, it is taken when handling statustexts.
+    start_receiving_statustext();
+
     std::lock_guard<std::mutex> lock(_calibration_mutex);
 
     if (_parent->is_armed()) {
         Calibration::ProgressData progress_data;
         call_callback(callback, Calibration::Result::FailedArmed, progress_data);
+        stop_receiving_statustext_later();
         return;
     }
 
@@ -186,11 +201,15 @@ void CalibrationImpl::calibrate_level_horizon_async(const CalibrationCallback& c
 
 void CalibrationImpl::calibrate_gimbal_accelerometer_async(const CalibrationCallback& callback)
 {
+    // Not with the lock held, it is taken when handling statustexts.
+    start_receiving_statustext();
+
     std::lock_guard<std::mutex> lock(_calibration_mutex);
 
     if (_parent->is_armed()) {
         Calibration::ProgressData progress_data;
         call_callback(callback, Calibration::Result::FailedArmed, progress_data);
+        stop_receiving_statustext_later();
         return;
     }
 
@@ -309,6 +328,7 @@ void CalibrationImpl::command_result_callback(
             call_callback(_calibration_callback, timeout_result, Calibration::ProgressData());
             _calibration_callback = nullptr;
             _state = State::None;
+            stop_receiving_statustext_later();
             break;
         }
 
@@ -425,12 +445,52 @@ void CalibrationImpl::receive_statustext(const MavlinkStatustextHandler::Statust
         case CalibrationStatustextParser::Status::Cancelled:
             _calibration_callback = nullptr;
             _state = State::None;
+            stop_receiving_statustext_later();
             break;
         default:
             break;
     }
 }
 
+void CalibrationImpl::start_receiving_statustext()
+{
+    std::lock_guard<std::mutex> lock(_statustext_mutex);
+    if (_statustext_registered) {
+        return;
+    }
+
+    _parent->register_statustext_handler(
+        [this](const MavlinkStatustextHandler::Statustext& statustext) {
+            receive_statustext(statustext);
+        },
+        this);
+    _statustext_registered = true;
+}
+
+void CalibrationImpl::stop_receiving_statustext_later()
+{
+    // This is called from within the statustext handler, which can't be
+    // unregistered from there.
+    _parent->queue_work([this]() { stop_receiving_statustext(); }, this);
+}
+
+void CalibrationImpl::stop_receiving_statustext()
+{
+    std::lock_guard<std::mutex> lock(_statustext_mutex);
+    {
+        std::lock_guard<std::mutex> calibration_lock(_calibration_mutex);
+        if (_state != State::None) {
+            // The next calibration has started in the meantime.
+            return;
+        }
+    }
+
+    if (_statustext_registered) {
+        _parent->unregister_statustext_handler(this);
+        _statustext_registered = false;
+    }
+}
+
 void CalibrationImpl::report_started()
 {
     report_progress(0.0f);
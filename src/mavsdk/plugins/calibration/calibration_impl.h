@@ -38,6 +38,10 @@ private:
         const Calibration::Result& result,
         const Calibration::ProgressData progress_data);
 
+    // Statustexts are only looked at while a calibration is running.
+    void start_receiving_statustext();
+    void stop_receiving_statustext_later();
+    void stop_receiving_statustext();
     void receive_statustext(const MavlinkStatustextHandler::Statustext&);
 
     void command_result_callback(MavlinkCommandSender::Result command_result, float progress);
@@ -57,6 +61,9 @@ private:
 
     mutable std::mutex _calibration_mutex{};
 
+    std::mutex _statustext_mutex{};
+    bool _statustext_registered{false};
+
     bool _is_gyro_ok = false;
     bool _is_accelerometer_ok = false;
     bool _is_magnetometer_ok = false;
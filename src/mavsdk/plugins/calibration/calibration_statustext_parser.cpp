@@ -1,24 +1,85 @@
 #include "calibration_statustext_parser.h"
-#include "calibration_messages.h"
 #include "log.h"
 
+#include <algorithm>
+
 namespace mavsdk {
 
+// Longer messages are cut, they are meant to be shown to the user on one line.
+static constexpr std::size_t MAX_MESSAGE_LEN = 63;
+
+static bool consume(std::string_view& text, std::string_view token)
+{
+    if (text.substr(0, token.size()) != token) {
+        return false;
+    }
+    text.remove_prefix(token.size());
+    return true;
+}
+
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static std::string_view skip_spaces(std::string_view text)
+{
+    while (!text.empty() && is_space(text.front())) {
+        text.remove_prefix(1);
+    }
+    return text;
+}
+
+// Everything up to the end of the line.
+static std::string_view line_of(std::string_view text)
+{
+    return text.substr(0, std::min(text.find('\n'), MAX_MESSAGE_LEN));
+}
+
+static bool consume_int(std::string_view& text, int& value)
+{
+    text = skip_spaces(text);
+
+    bool negative = false;
+    if (!text.empty() && (text.front() == '-' || text.front() == '+')) {
+        negative = text.front() == '-';
+        text.remove_prefix(1);
+    }
+
+    std::size_t num_digits = 0;
+    long result = 0;
+    while (num_digits < text.size() && text[num_digits] >= '0' && text[num_digits] <= '9') {
+        // More digits than any valid value has are just not counted.
+        if (result < 1000000) {
+            result = result * 10 + (text[num_digits] - '0');
+        }
+        ++num_digits;
+    }
+
+    if (num_digits == 0) {
+        return false;
+    }
+
+    text.remove_prefix(num_digits);
+    value = static_cast<int>(negative ? -result : result);
+    return true;
+}
+
 CalibrationStatustextParser::CalibrationStatustextParser() {}
 
 CalibrationStatustextParser::~CalibrationStatustextParser() {}
 
-bool CalibrationStatustextParser::parse(const std::string& statustext)
+bool CalibrationStatustextParser::parse(std::string_view statustext)
 {
     // We do a quick check before doing more in-depth parsing.
-    if (!is_relevant(statustext)) {
+    if (!consume(statustext, "[cal] ")) {
         return false;
     }
 
     // We start with the most likely messages in order to reduce parsing efforts.
     // As soon as one check is successful, the condition is true and we can stop.
-    if (check_progress(statustext) || check_started(statustext) || check_done(statustext) ||
-        check_failed(statustext) || check_cancelled(statustext)) {
+    if (check_progress(statustext) || check_calibration(statustext) ||
+        check_side_progress(statustext)) {
         return true;
     }
 
@@ -36,109 +97,98 @@ void CalibrationStatustextParser::reset()
     _instruction_message.clear();
 }
 
-bool CalibrationStatustextParser::is_relevant(const std::string& statustext)
+bool CalibrationStatustextParser::check_calibration(std::string_view text)
 {
-    // This should be a quick check, so pre-processing without looking at the whole string.
-    static constexpr char CALIBRATION_PREFIX[] = "[cal] ";
-    return (statustext.compare(0, 6, CALIBRATION_PREFIX) == 0);
-}
-
-bool CalibrationStatustextParser::check_started(const std::string& statustext)
-{
-    static constexpr char CUSTOM_CAL_QGC_STARTED_MSG[] = "[cal] calibration started: %i %s";
+    if (!consume(text, "calibration ")) {
+        return false;
+    }
 
-    int version_stamp;
-    const int ret =
-        sscanf(statustext.c_str(), CUSTOM_CAL_QGC_STARTED_MSG, &version_stamp, _tmp_str);
+    if (consume(text, "started: ")) {
+        // "started: <version stamp> <sensor>"
+        int version_stamp;
+        if (!consume_int(text, version_stamp) || skip_spaces(text).empty()) {
+            return false;
+        }
 
-    if (ret == 2) {
         if (version_stamp == 2) {
             _status = Status::Started;
         } else {
             _status = Status::Failed;
-
-            std::stringstream error_stream{};
-            error_stream << "Unknown calibration version stamp: " << version_stamp;
-            _failed_message = error_stream.str();
+            _failed_message =
+                "Unknown calibration version stamp: " + std::to_string(version_stamp);
             LogErr() << _failed_message;
         }
         return true;
     }
 
-    return false;
-}
-
-bool CalibrationStatustextParser::check_done(const std::string& statustext)
-{
-    const int ret = sscanf(statustext.c_str(), CAL_QGC_DONE_MSG, _tmp_str);
-
-    if (ret == 1) {
+    if (consume(text, "done: ")) {
+        if (skip_spaces(text).empty()) {
+            return false;
+        }
         _status = Status::Done;
         return true;
     }
-    return false;
-}
 
-bool CalibrationStatustextParser::check_failed(const std::string& statustext)
-{
-    static constexpr char CUSTOM_CAL_QGC_FAILED_MSG[] = "[cal] calibration failed: %63[^\n]";
-
-    const int ret = sscanf(statustext.c_str(), CUSTOM_CAL_QGC_FAILED_MSG, _tmp_str);
-
-    if (ret == 1) {
+    if (consume(text, "failed: ")) {
+        const auto message = line_of(skip_spaces(text));
+        if (message.empty()) {
+            return false;
+        }
         _status = Status::Failed;
-        _failed_message = _tmp_str;
+        _failed_message.assign(message.data(), message.size());
         return true;
     }
-    return false;
-}
 
-bool CalibrationStatustextParser::check_cancelled(const std::string& statustext)
-{
-    if (statustext.compare(CAL_QGC_CANCELLED_MSG) == 0) {
+    if (text == "cancelled") {
         _status = Status::Cancelled;
         return true;
     }
+
     return false;
 }
 
-bool CalibrationStatustextParser::check_progress(const std::string& statustext)
+bool CalibrationStatustextParser::check_progress(std::string_view text)
 {
-    int progress_int;
-    int ret = sscanf(statustext.c_str(), CAL_QGC_PROGRESS_MSG, &progress_int);
+    // "progress <75>"
+    return consume(text, "progress <") && set_progress(text);
+}
 
-    if (ret == 1 && progress_int >= 0 && progress_int <= 100) {
-        _progress = float(progress_int) / 100;
-        _status = Status::Progress;
-        return true;
+bool CalibrationStatustextParser::check_side_progress(std::string_view text)
+{
+    // "right side calibration: progress <78>", as sent by the magnetometer calibration.
+    std::size_t side_len = 0;
+    while (side_len < text.size() && !is_space(text[side_len])) {
+        ++side_len;
     }
-
-    static constexpr char SPECIAL_MAG_CAL_QGC_PROGRESS_MSG[] =
-        "[cal] %s side calibration: progress <%u>";
-
-    ret = sscanf(statustext.c_str(), SPECIAL_MAG_CAL_QGC_PROGRESS_MSG, _tmp_str, &progress_int);
-
-    if (ret == 2 && progress_int >= 0 && progress_int <= 100) {
-        _progress = float(progress_int) / 100;
-        _status = Status::Progress;
-        return true;
+    if (side_len == 0) {
+        return false;
     }
+    text.remove_prefix(side_len);
 
-    return false;
+    return consume(text, " side calibration: progress <") && set_progress(text);
 }
 
-bool CalibrationStatustextParser::check_instruction(const std::string& statustext)
+void CalibrationStatustextParser::check_instruction(std::string_view text)
 {
-    static constexpr char CATCHALL[] = "[cal] %63[^\n]";
+    const auto message = line_of(skip_spaces(text));
+    if (message.empty()) {
+        return;
+    }
 
-    const int ret = sscanf(statustext.c_str(), CATCHALL, _tmp_str);
+    _status = Status::Instruction;
+    _instruction_message.assign(message.data(), message.size());
+}
 
-    if (ret == 1) {
-        _status = Status::Instruction;
-        _instruction_message = _tmp_str;
-        return true;
+bool CalibrationStatustextParser::set_progress(std::string_view text)
+{
+    int progress_int;
+    if (!consume_int(text, progress_int) || progress_int < 0 || progress_int > 100) {
+        return false;
     }
-    return false;
+
+    _progress = float(progress_int) / 100;
+    _status = Status::Progress;
+    return true;
 }
 
 } // namespace mavsdk
@@ -118,3 +118,52 @@ TEST(CalibrationStatustextParser, Instructions)
     EXPECT_EQ(parser.get_status(), CalibrationStatustextParser::Status::Instruction);
     EXPECT_STREQ(parser.get_instruction().c_str(), "down side result: [  0.0089  -0.4756 -10.43 ]");
 }
+
+TEST(CalibrationStatustextParser, UnknownVersionStamp)
+{
+    CalibrationStatustextParser parser;
+
+    EXPECT_TRUE(parser.parse("[cal] calibration started: 1 gyro"));
+    EXPECT_EQ(parser.get_status(), CalibrationStatustextParser::Status::Failed);
+    EXPECT_EQ(parser.get_failed_message(), "Unknown calibration version stamp: 1");
+}
+
+TEST(CalibrationStatustextParser, Done)
+{
+    CalibrationStatustextParser parser;
+
+    EXPECT_TRUE(parser.parse("[cal] calibration done: mag"));
+    EXPECT_EQ(parser.get_status(), CalibrationStatustextParser::Status::Done);
+}
+
+TEST(CalibrationStatustextParser, Malformed)
+{
+    CalibrationStatustextParser parser;
+
+    EXPECT_FALSE(parser.parse("[cal]"));
+    EXPECT_FALSE(parser.parse("cal] progress <10>"));
+    EXPECT_EQ(parser.get_status(), CalibrationStatustextParser::Status::None);
+
+    // Out of range progress is passed on as it is.
+    EXPECT_TRUE(parser.parse("[cal] progress <101>"));
+    EXPECT_EQ(parser.get_status(), CalibrationStatustextParser::Status::Instruction);
+    EXPECT_EQ(parser.get_instruction(), "progress <101>");
+
+    parser.reset();
+    EXPECT_TRUE(parser.parse("[cal] calibration started: gyro"));
+    EXPECT_EQ(parser.get_status(), CalibrationStatustextParser::Status::Instruction);
+}
+
+TEST(CalibrationStatustextParser, LongInstructionIsCut)
+{
+    CalibrationStatustextParser parser;
+
+    const std::string instruction(100, 'x');
+    EXPECT_TRUE(parser.parse("[cal] " + instruction + "\nsecond line"));
+    EXPECT_EQ(parser.get_status(), CalibrationStatustextParser::Status::Instruction);
+    EXPECT_EQ(parser.get_instruction(), instruction.substr(0, 63));
+
+    parser.reset();
+    EXPECT_TRUE(parser.parse("[cal] two\nlines"));
+    EXPECT_EQ(parser.get_instruction(), "two");
+}
@@ -583,4 +583,24 @@ std::ostream& operator<<(std::ostream& str, Camera::PhotosRange const& photos_ra
     }
 }
 
+void Camera::set_capture_info_retention(uint32_t window, std::string spill_path) const
+{
+    _impl->set_capture_info_retention(window, spill_path);
+}
+
+void Camera::subscribe_capture_info_recovery(CaptureInfoRecoveryCallback callback)
+{
+    _impl->subscribe_capture_info_recovery(callback);
+}
+
+void Camera::trigger_photo_async(const TriggerPhotoCallback callback)
+{
+    _impl->trigger_photo_async(callback);
+}
+
+void Camera::subscribe_status(StatusCallback callback, const SubscriptionOptions& options)
+{
+    _impl->subscribe_status(callback, options);
+}
+
 } // namespace mavsdk
\ No newline at end of file
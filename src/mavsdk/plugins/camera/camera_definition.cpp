@@ -1,9 +1,14 @@
 #include "log.h"
 #include "camera_definition.h"
+#include "cache_file.h"
 
 namespace mavsdk {
 
-CameraDefinition::CameraDefinition() {}
+// Bump the last char whenever the format changes, old caches are then just
+// ignored.
+static const std::vector<uint8_t> cache_magic = {'M', 'C', 'D', '1'};
+
+CameraDefinition::CameraDefinition() : _parsed(std::make_shared<Parsed>()) {}
 
 CameraDefinition::~CameraDefinition() {}
 
@@ -29,23 +34,258 @@ bool CameraDefinition::load_string(const std::string& content)
     return parse_xml();
 }
 
+bool CameraDefinition::save_cache(const std::string& path, const std::string& key) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<uint8_t> buffer(cache_magic);
+    cache_put_string(buffer, key);
+    cache_put_string(buffer, _parsed->model);
+    cache_put_string(buffer, _parsed->vendor);
+
+    cache_put_uint(buffer, _parsed->parameter_map.size(), 4);
+    for (const auto& [name, parameter] : _parsed->parameter_map) {
+        cache_put_string(buffer, name);
+        cache_put_string(buffer, parameter->description);
+        cache_put_uint(
+            buffer,
+            (parameter->is_control ? 1 : 0) | (parameter->is_readonly ? 2 : 0) |
+                (parameter->is_writeonly ? 4 : 0) | (parameter->is_range ? 8 : 0),
+            1);
+        cache_put_param_value(buffer, parameter->type);
+
+        cache_put_uint(buffer, parameter->updates.size(), 4);
+        for (const auto& update : parameter->updates) {
+            cache_put_string(buffer, update);
+        }
+
+        cache_put_uint(buffer, parameter->options.size(), 4);
+        for (const auto& option : parameter->options) {
+            put_option(buffer, *option);
+        }
+        put_option(buffer, parameter->default_option);
+    }
+
+    return cache_file_write(path, std::move(buffer));
+}
+
+bool CameraDefinition::load_cache(const std::string& path, const std::string& key)
+{
+    const auto buffer = cache_file_read(path, cache_magic);
+    if (!buffer) {
+        return false;
+    }
+
+    std::size_t pos = cache_magic.size();
+    std::string cached_key;
+    if (!cache_get_string(*buffer, pos, cached_key) || cached_key != key) {
+        LogDebug() << "Ignoring camera definition cache " << path << " for other definition";
+        return false;
+    }
+
+    // Fill it all in first, so nothing is changed if the cache turns out to
+    // be unusable after all.
+    std::string model;
+    std::string vendor;
+    uint64_t num_parameters;
+    if (!cache_get_string(*buffer, pos, model) || !cache_get_string(*buffer, pos, vendor) ||
+        !cache_get_uint(*buffer, pos, 4, num_parameters)) {
+        return false;
+    }
+
+    auto parsed = std::make_shared<Parsed>();
+    parsed->model = std::move(model);
+    parsed->vendor = std::move(vendor);
+    for (uint64_t i = 0; i < num_parameters; ++i) {
+        std::string name;
+        auto parameter = std::make_shared<Parameter>();
+        uint64_t flags;
+        uint64_t count;
+        if (!cache_get_string(*buffer, pos, name) ||
+            !cache_get_string(*buffer, pos, parameter->description) ||
+            !cache_get_uint(*buffer, pos, 1, flags) ||
+            !cache_get_param_value(*buffer, pos, parameter->type) ||
+            !cache_get_uint(*buffer, pos, 4, count)) {
+            return false;
+        }
+        parameter->is_control = (flags & 1) != 0;
+        parameter->is_readonly = (flags & 2) != 0;
+        parameter->is_writeonly = (flags & 4) != 0;
+        parameter->is_range = (flags & 8) != 0;
+
+        for (uint64_t j = 0; j < count; ++j) {
+            std::string update;
+            if (!cache_get_string(*buffer, pos, update)) {
+                return false;
+            }
+            parameter->updates.push_back(std::move(update));
+        }
+
+        if (!cache_get_uint(*buffer, pos, 4, count)) {
+            return false;
+        }
+        for (uint64_t j = 0; j < count; ++j) {
+            auto option = std::make_shared<Option>();
+            if (!get_option(*buffer, pos, *option)) {
+                return false;
+            }
+            parameter->options.push_back(std::move(option));
+        }
+        if (!get_option(*buffer, pos, parameter->default_option)) {
+            return false;
+        }
+
+        parsed->parameter_map[name] = std::move(parameter);
+    }
+
+    if (pos != buffer->size()) {
+        return false;
+    }
+
+    load_parsed(std::move(parsed));
+    return true;
+}
+
+std::shared_ptr<const CameraDefinition::Parsed> CameraDefinition::parsed() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    return _parsed;
+}
+
+void CameraDefinition::load_parsed(std::shared_ptr<const Parsed> parsed)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _parsed = std::move(parsed);
+
+    // Nothing is known about the current settings yet.
+    _current_settings.clear();
+    for (const auto& parameter : _parsed->parameter_map) {
+        InternalCurrentSetting empty_setting{};
+        empty_setting.needs_updating = true;
+        _current_settings[parameter.first] = empty_setting;
+    }
+}
+
+static std::mutex shared_mutex{};
+static std::unordered_map<std::string, std::weak_ptr<const CameraDefinition::Parsed>>
+    shared_parsed{};
+
+std::shared_ptr<const CameraDefinition::Parsed>
+CameraDefinition::find_shared(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(shared_mutex);
+
+    const auto it = shared_parsed.find(key);
+    if (it == shared_parsed.end()) {
+        return nullptr;
+    }
+
+    auto parsed = it->second.lock();
+    if (!parsed) {
+        shared_parsed.erase(it);
+    }
+    return parsed;
+}
+
+void CameraDefinition::share(const std::string& key, const std::shared_ptr<const Parsed>& parsed)
+{
+    std::lock_guard<std::mutex> lock(shared_mutex);
+
+    // Drop the ones nobody uses anymore while we're at it.
+    for (auto it = shared_parsed.begin(); it != shared_parsed.end();) {
+        if (it->second.expired()) {
+            it = shared_parsed.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    shared_parsed[key] = parsed;
+}
+
+void CameraDefinition::put_option(std::vector<uint8_t>& buffer, const Option& option)
+{
+    cache_put_string(buffer, option.name);
+    cache_put_param_value(buffer, option.value);
+
+    cache_put_uint(buffer, option.exclusions.size(), 4);
+    for (const auto& exclusion : option.exclusions) {
+        cache_put_string(buffer, exclusion);
+    }
+
+    cache_put_uint(buffer, option.parameter_ranges.size(), 4);
+    for (const auto& [param_name, range] : option.parameter_ranges) {
+        cache_put_string(buffer, param_name);
+        cache_put_uint(buffer, range.size(), 4);
+        for (const auto& [range_name, value] : range) {
+            cache_put_string(buffer, range_name);
+            cache_put_param_value(buffer, value);
+        }
+    }
+}
+
+bool CameraDefinition::get_option(
+    const std::vector<uint8_t>& buffer, std::size_t& pos, Option& option)
+{
+    uint64_t count;
+    if (!cache_get_string(buffer, pos, option.name) ||
+        !cache_get_param_value(buffer, pos, option.value) ||
+        !cache_get_uint(buffer, pos, 4, count)) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < count; ++i) {
+        std::string exclusion;
+        if (!cache_get_string(buffer, pos, exclusion)) {
+            return false;
+        }
+        option.exclusions.push_back(std::move(exclusion));
+    }
+
+    if (!cache_get_uint(buffer, pos, 4, count)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        std::string param_name;
+        uint64_t range_count;
+        if (!cache_get_string(buffer, pos, param_name) ||
+            !cache_get_uint(buffer, pos, 4, range_count)) {
+            return false;
+        }
+        auto& range = option.parameter_ranges[param_name];
+        for (uint64_t j = 0; j < range_count; ++j) {
+            std::string range_name;
+            MAVLinkParameters::ParamValue value;
+            if (!cache_get_string(buffer, pos, range_name) ||
+                !cache_get_param_value(buffer, pos, value)) {
+                return false;
+            }
+            range[range_name] = value;
+        }
+    }
+
+    return true;
+}
+
 std::string CameraDefinition::get_model() const
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    return _model;
+    return _parsed->model;
 }
 
 std::string CameraDefinition::get_vendor() const
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    return _vendor;
+    return _parsed->vendor;
 }
 
 bool CameraDefinition::parse_xml()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    auto parsed = std::make_shared<Parsed>();
 
     auto e_mavlinkcamera = _doc.FirstChildElement("mavlinkcamera");
     if (!e_mavlinkcamera) {
@@ -65,7 +305,7 @@ bool CameraDefinition::parse_xml()
         return false;
     }
 
-    _model = e_model->GetText();
+    parsed->model = e_model->GetText();
 
     auto e_vendor = e_definition->FirstChildElement("vendor");
     if (!e_vendor) {
@@ -73,7 +313,7 @@ bool CameraDefinition::parse_xml()
         return false;
     }
 
-    _vendor = e_vendor->GetText();
+    parsed->vendor = e_vendor->GetText();
 
     auto e_parameters = e_mavlinkcamera->FirstChildElement("parameters");
     if (!e_parameters) {
@@ -225,13 +465,13 @@ bool CameraDefinition::parse_xml()
             new_parameter->default_option = std::get<2>(maybe_range_options);
         }
 
-        _parameter_map[param_name] = new_parameter;
-
-        InternalCurrentSetting empty_setting{};
-        empty_setting.needs_updating = true;
-        _current_settings[param_name] = empty_setting;
+        parsed->parameter_map[param_name] = new_parameter;
     }
 
+    // Everything we need is in parsed now, no need to keep the document.
+    _doc.Clear();
+
+    load_parsed(std::move(parsed));
     return true;
 }
 
@@ -431,7 +671,7 @@ void CameraDefinition::assume_default_settings()
 
     _current_settings.clear();
 
-    for (const auto& parameter : _parameter_map) {
+    for (const auto& parameter : _parsed->parameter_map) {
         // if (parameter.second->is_range) {
 
         InternalCurrentSetting new_setting;
@@ -485,34 +725,15 @@ bool CameraDefinition::get_possible_settings_locked(
 {
     settings.clear();
 
-    // Find all exclusions
-    // TODO: use set instead of vector
-    std::vector<std::string> exclusions{};
-
-    for (const auto& parameter : _parameter_map) {
-        for (const auto& option : parameter.second->options) {
-            if (_current_settings[parameter.first].value == option->value) {
-                for (const auto& exclusion : option->exclusions) {
-                    // LogDebug() << "found exclusion for " << parameter.first
-                    //            << "(" << option->value << "): " << exclusion;
-                    exclusions.push_back(exclusion);
-                }
-            }
-        }
-    }
+    const auto exclusions = find_exclusions_locked(false);
 
     for (const auto& setting : _current_settings) {
-        bool excluded = false;
-        for (const auto& exclusion : exclusions) {
-            if (setting.first == exclusion) {
-                excluded = true;
-            }
-        }
-        if (!_parameter_map[setting.first]->is_control) {
+        const auto parameter = _parsed->parameter_map.find(setting.first);
+        if (parameter == _parsed->parameter_map.end() || !parameter->second->is_control) {
             continue;
         }
 
-        if (excluded) {
+        if (exclusions.count(setting.first) > 0) {
             continue;
         }
         settings[setting.first] = setting.second.value;
@@ -521,25 +742,58 @@ bool CameraDefinition::get_possible_settings_locked(
     return (settings.size() > 0);
 }
 
+std::unordered_set<std::string> CameraDefinition::find_exclusions_locked(bool known_only)
+{
+    std::unordered_set<std::string> exclusions{};
+
+    for (const auto& parameter : _parsed->parameter_map) {
+        const auto& current_setting = _current_settings[parameter.first];
+        if (known_only && current_setting.needs_updating) {
+            continue;
+        }
+        for (const auto& option : parameter.second->options) {
+            if (current_setting.value == option->value) {
+                exclusions.insert(option->exclusions.begin(), option->exclusions.end());
+            }
+        }
+    }
+
+    return exclusions;
+}
+
 bool CameraDefinition::set_setting(
     const std::string& name, const MAVLinkParameters::ParamValue& value)
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    if (_parameter_map.find(name) == _parameter_map.end()) {
+    return set_setting_locked(name, value, true);
+}
+
+bool CameraDefinition::set_reported_setting(
+    const std::string& name, const MAVLinkParameters::ParamValue& value)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    return set_setting_locked(name, value, false);
+}
+
+bool CameraDefinition::set_setting_locked(
+    const std::string& name, const MAVLinkParameters::ParamValue& value, bool is_change)
+{
+    if (_parsed->parameter_map.find(name) == _parsed->parameter_map.end()) {
         LogErr() << "Unknown setting to set: " << name;
         return false;
     }
 
     // For range params, we need to verify the range.
-    if (_parameter_map[name]->is_range) {
+    if (_parsed->parameter_map.at(name)->is_range) {
         // Check against the minimum
-        if (value < _parameter_map[name]->options[0]->value) {
+        if (value < _parsed->parameter_map.at(name)->options[0]->value) {
             LogErr() << "Chosen value smaller than minimum";
             return false;
         }
 
-        if (value > _parameter_map[name]->options[1]->value) {
+        if (value > _parsed->parameter_map.at(name)->options[1]->value) {
             LogErr() << "Chosen value bigger than maximum";
             return false;
         }
@@ -547,13 +801,21 @@ bool CameraDefinition::set_setting(
         // TODO: Check step as well, until now we have only seen steps of 1 in the wild though.
     }
 
-    _current_settings[name].value = value;
-    _current_settings[name].needs_updating = false;
+    auto& current_setting = _current_settings[name];
+    const bool has_changed = current_setting.needs_updating || !(current_setting.value == value);
+    current_setting.value = value;
+    current_setting.needs_updating = false;
+
+    // A value reported by the camera is what it has now, the params it updates
+    // are then just as current, and setting the same value again changes nothing.
+    if (!is_change || !has_changed) {
+        return true;
+    }
 
     // Some param changes cause other params to change, so they need to be updated.
     // The camera definition just keeps track of these params but the actual param fetching
     // needs to happen outside of this class.
-    for (const auto& update : _parameter_map[name]->updates) {
+    for (const auto& update : _parsed->parameter_map.at(name)->updates) {
         if (_current_settings.find(update) == _current_settings.end()) {
             // LogDebug() << "Update to '" << update << "' not understood.";
             continue;
@@ -588,12 +850,12 @@ bool CameraDefinition::get_option_value(
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    if (_parameter_map.find(param_name) == _parameter_map.end()) {
+    if (_parsed->parameter_map.find(param_name) == _parsed->parameter_map.end()) {
         LogErr() << "Unknown parameter to get option: " << param_name;
         return false;
     }
 
-    for (const auto& option : _parameter_map[param_name]->options) {
+    for (const auto& option : _parsed->parameter_map.at(param_name)->options) {
         if (option->value == option_value) {
             value = option->value;
             return true;
@@ -610,12 +872,12 @@ bool CameraDefinition::get_all_options(
 
     values.clear();
 
-    if (_parameter_map.find(name) == _parameter_map.end()) {
+    if (_parsed->parameter_map.find(name) == _parsed->parameter_map.end()) {
         LogErr() << "Unknown parameter to get all options";
         return false;
     }
 
-    for (const auto& option : _parameter_map[name]->options) {
+    for (const auto& option : _parsed->parameter_map.at(name)->options) {
         values.push_back(option->value);
     }
 
@@ -629,7 +891,7 @@ bool CameraDefinition::get_possible_options(
 
     values.clear();
 
-    if (_parameter_map.find(name) == _parameter_map.end()) {
+    if (_parsed->parameter_map.find(name) == _parsed->parameter_map.end()) {
         LogErr() << "Unknown parameter to get possible options";
         return false;
     }
@@ -645,41 +907,18 @@ bool CameraDefinition::get_possible_options(
 
     // Find all exclusions because excluded parameters need to be neglected for range
     // check below.
-    // TODO: use set instead of vector
-    std::vector<std::string> exclusions{};
-
-    for (const auto& parameter : _parameter_map) {
-        for (const auto& option : parameter.second->options) {
-            if (_current_settings[parameter.first].needs_updating) {
-                // LogWarn() << parameter.first << " needs updating";
-                continue;
-            }
-            if (_current_settings[parameter.first].value == option->value) {
-                for (const auto& exclusion : option->exclusions) {
-                    // LogDebug() << "found exclusion for " << parameter.first
-                    //            << "(" << option->value << "): " << exclusion;
-                    exclusions.push_back(exclusion);
-                }
-            }
-        }
-    }
+    const auto exclusions = find_exclusions_locked(true);
 
     // TODO: use set instead of vector for this
     std::vector<MAVLinkParameters::ParamValue> allowed_ranges{};
 
     // Check allowed ranges.
-    for (const auto& parameter : _parameter_map) {
+    for (const auto& parameter : _parsed->parameter_map) {
         if (!parameter.second->is_control) {
             continue;
         }
 
-        bool excluded = false;
-        for (const auto& exclusion : exclusions) {
-            if (parameter.first == exclusion) {
-                excluded = true;
-            }
-        }
-        if (excluded) {
+        if (exclusions.count(parameter.first) > 0) {
             continue;
         }
 
@@ -693,7 +932,7 @@ bool CameraDefinition::get_possible_options(
                 // Go through parameter ranges but only concerning the parameter that
                 // we're interested in..
                 if (option->parameter_ranges.find(name) != option->parameter_ranges.end()) {
-                    for (const auto& range : option->parameter_ranges[name]) {
+                    for (const auto& range : option->parameter_ranges.at(name)) {
                         allowed_ranges.push_back(range.second);
                     }
                 }
@@ -702,7 +941,7 @@ bool CameraDefinition::get_possible_options(
     }
 
     // Intersect
-    for (const auto& option : _parameter_map[name]->options) {
+    for (const auto& option : _parsed->parameter_map.at(name)->options) {
         bool option_allowed = false;
         for (const auto& allowed_range : allowed_ranges) {
             if (option->value == allowed_range) {
@@ -724,7 +963,26 @@ void CameraDefinition::get_unknown_params(
 
     params.clear();
 
-    for (const auto& parameter : _parameter_map) {
+    for (const auto& parameter : _parsed->parameter_map) {
+        if (_current_settings[parameter.first].needs_updating) {
+            params.push_back(std::make_pair<>(parameter.first, parameter.second->type));
+        }
+    }
+}
+
+void CameraDefinition::get_unknown_applicable_params(
+    std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>>& params)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    params.clear();
+
+    const auto exclusions = find_exclusions_locked(true);
+
+    for (const auto& parameter : _parsed->parameter_map) {
+        if (exclusions.count(parameter.first) > 0) {
+            continue;
+        }
         if (_current_settings[parameter.first].needs_updating) {
             params.push_back(std::make_pair<>(parameter.first, parameter.second->type));
         }
@@ -735,7 +993,7 @@ void CameraDefinition::set_all_params_unknown()
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    for (auto& parameter : _parameter_map) {
+    for (auto& parameter : _parsed->parameter_map) {
         _current_settings[parameter.first].needs_updating = true;
     }
 }
@@ -744,12 +1002,12 @@ bool CameraDefinition::is_setting_range(const std::string& name)
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    if (_parameter_map.find(name) == _parameter_map.end()) {
+    if (_parsed->parameter_map.find(name) == _parsed->parameter_map.end()) {
         LogWarn() << "Setting " << name << " not found.";
         return false;
     }
 
-    return _parameter_map[name]->is_range;
+    return _parsed->parameter_map.at(name)->is_range;
 }
 
 bool CameraDefinition::get_setting_str(const std::string& name, std::string& description)
@@ -758,12 +1016,12 @@ bool CameraDefinition::get_setting_str(const std::string& name, std::string& des
 
     description.clear();
 
-    if (_parameter_map.find(name) == _parameter_map.end()) {
+    if (_parsed->parameter_map.find(name) == _parsed->parameter_map.end()) {
         LogWarn() << "Setting " << name << " not found.";
         return false;
     }
 
-    description = _parameter_map[name]->description;
+    description = _parsed->parameter_map.at(name)->description;
     return true;
 }
 
@@ -774,12 +1032,12 @@ bool CameraDefinition::get_option_str(
 
     description.clear();
 
-    if (_parameter_map.find(setting_name) == _parameter_map.end()) {
+    if (_parsed->parameter_map.find(setting_name) == _parsed->parameter_map.end()) {
         LogWarn() << "Setting " << setting_name << " not found.";
         return false;
     }
 
-    for (const auto& option : _parameter_map[setting_name]->options) {
+    for (const auto& option : _parsed->parameter_map.at(setting_name)->options) {
         std::stringstream value_ss{};
         value_ss << option->value;
         if (option->value == option_name) {
@@ -5,6 +5,7 @@
 #include <vector>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
 #include <string>
 #include <tuple>
@@ -20,6 +21,26 @@ public:
     bool load_file(const std::string& filepath);
     bool load_string(const std::string& content);
 
+    // The parsed definition can be saved to a binary cache file and loaded
+    // from it again later, which is a lot quicker than parsing the XML. The
+    // key, e.g. the URI and version of the definition, is stored with it and
+    // loading fails unless it matches.
+    bool save_cache(const std::string& path, const std::string& key) const;
+    bool load_cache(const std::string& path, const std::string& key);
+
+    // Everything parsed from a definition. It doesn't change once loaded, so
+    // CameraDefinitions of the same camera model can share it and keep only
+    // their current settings to themselves.
+    struct Parsed;
+    std::shared_ptr<const Parsed> parsed() const;
+    void load_parsed(std::shared_ptr<const Parsed> parsed);
+
+    // Process-wide registry of parsed definitions, e.g. by vendor, model and
+    // version. It only holds weak references, a definition is gone as soon
+    // as the last CameraDefinition using it is.
+    static std::shared_ptr<const Parsed> find_shared(const std::string& key);
+    static void share(const std::string& key, const std::shared_ptr<const Parsed>& parsed);
+
     std::string get_vendor() const;
     std::string get_model() const;
 
@@ -30,7 +51,11 @@ public:
         MAVLinkParameters::ParamValue value;
     };
 
+    // Marks the params the setting updates as unknown if the value changes.
     bool set_setting(const std::string& name, const MAVLinkParameters::ParamValue& value);
+    // For values read back from the camera, which are current along with
+    // everything they update.
+    bool set_reported_setting(const std::string& name, const MAVLinkParameters::ParamValue& value);
     bool get_setting(const std::string& name, MAVLinkParameters::ParamValue& value);
     bool get_all_settings(std::unordered_map<std::string, MAVLinkParameters::ParamValue>& settings);
     bool
@@ -53,6 +78,11 @@ public:
 
     void
     get_unknown_params(std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>>& params);
+    // Like get_unknown_params() but without the params the known settings
+    // currently exclude, there is no point in fetching them until the
+    // settings excluding them change.
+    void get_unknown_applicable_params(
+        std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>>& params);
     void set_all_params_unknown();
 
     // Non-copyable
@@ -62,6 +92,9 @@ public:
 private:
     bool get_possible_settings_locked(
         std::unordered_map<std::string, MAVLinkParameters::ParamValue>& settings);
+    bool set_setting_locked(
+        const std::string& name, const MAVLinkParameters::ParamValue& value, bool is_change);
+    std::unordered_set<std::string> find_exclusions_locked(bool known_only);
 
     typedef std::unordered_map<std::string, MAVLinkParameters::ParamValue> parameter_range_t;
 
@@ -86,6 +119,9 @@ private:
 
     bool parse_xml();
 
+    static void put_option(std::vector<uint8_t>& buffer, const Option& option);
+    static bool get_option(const std::vector<uint8_t>& buffer, std::size_t& pos, Option& option);
+
     // Until we have std::optional we need to use std::pair to return something that might be
     // nothing.
     std::pair<bool, std::vector<std::shared_ptr<Option>>> parse_options(
@@ -103,7 +139,7 @@ private:
 
     tinyxml2::XMLDocument _doc{};
 
-    std::unordered_map<std::string, std::shared_ptr<Parameter>> _parameter_map{};
+    std::shared_ptr<const Parsed> _parsed;
 
     struct InternalCurrentSetting {
         MAVLinkParameters::ParamValue value{};
@@ -111,9 +147,12 @@ private:
     };
 
     std::unordered_map<std::string, InternalCurrentSetting> _current_settings{};
+};
 
-    std::string _model{};
-    std::string _vendor{};
+struct CameraDefinition::Parsed {
+    std::string model{};
+    std::string vendor{};
+    std::unordered_map<std::string, std::shared_ptr<const Parameter>> parameter_map{};
 };
 
 } // namespace mavsdk
@@ -1,4 +1,5 @@
 #include "camera_definition.h"
+#include "fs.h"
 #include "log.h"
 #include <gtest/gtest.h>
 #include <vector>
@@ -372,6 +373,71 @@ TEST(CameraDefinition, E90SettingsCauseUpdates)
     }
 }
 
+TEST(CameraDefinition, E90OnlyChangesCauseUpdates)
+{
+    // Run this from root.
+    CameraDefinition cd;
+    ASSERT_TRUE(cd.load_file(e90_unit_test_file));
+
+    cd.assume_default_settings();
+
+    std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> params;
+
+    // Setting what we already have changes nothing.
+    {
+        MAVLinkParameters::ParamValue value;
+        value.set<uint32_t>(1);
+        EXPECT_TRUE(cd.set_setting("CAM_MODE", value));
+    }
+    cd.get_unknown_params(params);
+    EXPECT_EQ(params.size(), 0);
+
+    // What the camera reports is current, along with what it updates.
+    {
+        MAVLinkParameters::ParamValue value;
+        value.set<uint32_t>(0);
+        EXPECT_TRUE(cd.set_reported_setting("CAM_MODE", value));
+    }
+    cd.get_unknown_params(params);
+    EXPECT_EQ(params.size(), 0);
+
+    {
+        MAVLinkParameters::ParamValue value;
+        value.set<uint32_t>(1);
+        EXPECT_TRUE(cd.set_setting("CAM_MODE", value));
+    }
+    cd.get_unknown_params(params);
+    EXPECT_EQ(params.size(), 4);
+}
+
+TEST(CameraDefinition, E90UnknownApplicableParams)
+{
+    // Run this from root.
+    CameraDefinition cd;
+    ASSERT_TRUE(cd.load_file(e90_unit_test_file));
+
+    cd.assume_default_settings();
+
+    {
+        MAVLinkParameters::ParamValue value;
+        value.set<uint32_t>(0);
+        EXPECT_TRUE(cd.set_setting("CAM_MODE", value));
+    }
+
+    // CAM_VIDRES needs updating but is excluded in photo mode.
+    std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> params;
+    cd.get_unknown_applicable_params(params);
+    EXPECT_EQ(params.size(), 3);
+    for (const auto& param : params) {
+        EXPECT_NE(param.first, "CAM_VIDRES");
+    }
+
+    // Once nothing is known, nothing is excluded either.
+    cd.set_all_params_unknown();
+    cd.get_unknown_applicable_params(params);
+    EXPECT_EQ(params.size(), 17);
+}
+
 TEST(CameraDefinition, E90OptionValues)
 {
     // Run this from root.
@@ -641,3 +707,150 @@ TEST(CameraDefinition, UVCCheckOptionHumanReadable)
     EXPECT_TRUE(cd.get_option_str("exp-priority", "1", description));
     EXPECT_STREQ(description.c_str(), "ON");
 }
+
+TEST(CameraDefinition, E90LoadFromCache)
+{
+    const auto dir = create_tmp_directory("mavsdk-camera-definition-test");
+    ASSERT_TRUE(dir);
+    const auto path = *dir + path_separator + "e90.cache";
+
+    {
+        CameraDefinition cd;
+        ASSERT_TRUE(cd.load_file(e90_unit_test_file));
+        ASSERT_TRUE(cd.save_cache(path, "e90 v1"));
+    }
+
+    CameraDefinition cd;
+    ASSERT_TRUE(cd.load_cache(path, "e90 v1"));
+    EXPECT_STREQ(cd.get_vendor().c_str(), "Yuneec");
+    EXPECT_STREQ(cd.get_model().c_str(), "E90");
+
+    // Nothing is known about the settings yet, same as after parsing.
+    std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> unknown_params{};
+    cd.get_unknown_params(unknown_params);
+    EXPECT_EQ(unknown_params.size(), 17);
+
+    cd.assume_default_settings();
+
+    {
+        std::unordered_map<std::string, MAVLinkParameters::ParamValue> settings{};
+        EXPECT_TRUE(cd.get_all_settings(settings));
+        EXPECT_EQ(settings.size(), 17);
+        EXPECT_EQ(settings["CAM_MODE"].get<uint32_t>(), 1);
+        EXPECT_FLOAT_EQ(settings["CAM_SHUTTERSPD"].get<float>(), 0.016666f);
+        EXPECT_EQ(settings["CAM_CUSTOMWB"].get<uint16_t>(), 5500);
+    }
+
+    {
+        MAVLinkParameters::ParamValue value;
+        value.set<uint32_t>(1);
+        EXPECT_TRUE(cd.set_setting("CAM_MODE", value));
+
+        std::unordered_map<std::string, MAVLinkParameters::ParamValue> settings{};
+        EXPECT_TRUE(cd.get_possible_settings(settings));
+        EXPECT_EQ(settings.size(), 6);
+    }
+
+    std::string description{};
+    EXPECT_TRUE(cd.get_setting_str("CAM_SHUTTERSPD", description));
+    EXPECT_STREQ(description.c_str(), "Shutter Speed");
+    EXPECT_TRUE(cd.get_option_str("CAM_WBMODE", "5", description));
+    EXPECT_STREQ(description.c_str(), "Cloudy");
+
+    fs_remove(path);
+}
+
+TEST(CameraDefinition, UVCLoadFromCache)
+{
+    const auto dir = create_tmp_directory("mavsdk-camera-definition-test");
+    ASSERT_TRUE(dir);
+    const auto path = *dir + path_separator + "uvc.cache";
+
+    {
+        CameraDefinition cd;
+        ASSERT_TRUE(cd.load_file(uvc_unit_test_file));
+        ASSERT_TRUE(cd.save_cache(path, "uvc"));
+    }
+
+    CameraDefinition cd;
+    ASSERT_TRUE(cd.load_cache(path, "uvc"));
+    cd.assume_default_settings();
+
+    EXPECT_TRUE(cd.is_setting_range("brightness"));
+    {
+        MAVLinkParameters::ParamValue value;
+        value.set<int32_t>(200);
+        EXPECT_TRUE(cd.set_setting("brightness", value));
+        value.set<int32_t>(-100);
+        EXPECT_FALSE(cd.set_setting("brightness", value));
+    }
+
+    std::string description{};
+    EXPECT_TRUE(cd.get_option_str("brightness", "225", description));
+    EXPECT_STREQ(description.c_str(), "max");
+
+    fs_remove(path);
+}
+
+TEST(CameraDefinition, CacheOfOtherDefinitionIgnored)
+{
+    const auto dir = create_tmp_directory("mavsdk-camera-definition-test");
+    ASSERT_TRUE(dir);
+    const auto path = *dir + path_separator + "e90.cache";
+
+    {
+        CameraDefinition cd;
+        ASSERT_TRUE(cd.load_file(e90_unit_test_file));
+        ASSERT_TRUE(cd.save_cache(path, "e90 v1"));
+    }
+
+    CameraDefinition cd;
+    EXPECT_FALSE(cd.load_cache(path, "e90 v2"));
+    EXPECT_FALSE(cd.load_cache(path + ".missing", "e90 v1"));
+    EXPECT_STREQ(cd.get_model().c_str(), "");
+
+    fs_remove(path);
+}
+
+TEST(CameraDefinition, E90SharedParsedDefinition)
+{
+    const std::string key{"Yuneec/E90/1"};
+    EXPECT_FALSE(CameraDefinition::find_shared(key));
+
+    auto first = std::make_unique<CameraDefinition>();
+    ASSERT_TRUE(first->load_file(e90_unit_test_file));
+    CameraDefinition::share(key, first->parsed());
+
+    auto second = std::make_unique<CameraDefinition>();
+    auto parsed = CameraDefinition::find_shared(key);
+    ASSERT_TRUE(parsed);
+    second->load_parsed(std::move(parsed));
+    EXPECT_STREQ(second->get_model().c_str(), "E90");
+
+    // The settings of each camera are still separate.
+    first->assume_default_settings();
+    {
+        std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> unknown_params{};
+        second->get_unknown_params(unknown_params);
+        EXPECT_EQ(unknown_params.size(), 17);
+    }
+
+    MAVLinkParameters::ParamValue value;
+    value.set<uint32_t>(0);
+    EXPECT_TRUE(first->set_setting("CAM_MODE", value));
+    second->assume_default_settings();
+    {
+        MAVLinkParameters::ParamValue first_mode;
+        MAVLinkParameters::ParamValue second_mode;
+        EXPECT_TRUE(first->get_setting("CAM_MODE", first_mode));
+        EXPECT_TRUE(second->get_setting("CAM_MODE", second_mode));
+        EXPECT_EQ(first_mode.get<uint32_t>(), 0);
+        EXPECT_EQ(second_mode.get<uint32_t>(), 1);
+    }
+
+    // Once the last camera using it is gone, the definition is freed.
+    first.reset();
+    EXPECT_TRUE(CameraDefinition::find_shared(key));
+    second.reset();
+    EXPECT_FALSE(CameraDefinition::find_shared(key));
+}
@@ -4,10 +4,15 @@
 #include "mavsdk_math.h"
 #include "http_loader.h"
 #include "camera_definition_files.h"
+#include "crc32.h"
+#include "fs.h"
 #include "unused.h"
 #include <functional>
 #include <cmath>
+#include <cstring>
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
 
 namespace mavsdk {
 
@@ -28,6 +33,10 @@ CameraImpl::~CameraImpl()
 
 void CameraImpl::init()
 {
+    if (_parent->get_low_memory()) {
+        set_capture_info_retention(Mavsdk::LOW_MEMORY_CAPTURE_INFO_WINDOW, "");
+    }
+
     _parent->register_mavlink_message_handler(
         MAVLINK_MSG_ID_CAMERA_CAPTURE_STATUS,
         [this](const mavlink_message_t& message) { process_camera_capture_status(message); },
@@ -79,6 +88,7 @@ void CameraImpl::init()
 
 void CameraImpl::deinit()
 {
+    _parent->cancel_background(this);
     _parent->remove_call_every(_request_missing_capture_info_cookie);
     _parent->remove_call_every(_check_connection_status_call_every_cookie);
     _parent->remove_call_every(_status.call_every_cookie);
@@ -87,7 +97,7 @@ void CameraImpl::deinit()
 
     {
         std::lock_guard<std::mutex> lock(_status.mutex);
-        _status.subscription_callback = nullptr;
+        _status.subscriptions.clear();
     }
 
     {
@@ -142,13 +152,12 @@ void CameraImpl::prepare_async(const Camera::ResultCallback& callback)
     if (_camera_definition) {
         _parent->call_user_callback([temp_callback]() { temp_callback(Camera::Result::Success); });
     } else {
-        _camera_definition_callback = [this, temp_callback](bool has_succeeded) {
+        _camera_definition_callback = [temp_callback](bool has_succeeded) {
             if (has_succeeded) {
                 temp_callback(Camera::Result::Success);
             } else {
                 temp_callback(Camera::Result::Error);
             }
-            _camera_definition_callback = nullptr;
         };
 
         if (_has_camera_definition_timed_out) {
@@ -177,6 +186,24 @@ void CameraImpl::enable()
     // FIXME: We check for the connection status manually because
     // we're not interested in the connection state of the autopilot
     // but only the camera.
+
+    // We're back after a connection loss, so whatever we're still missing is
+    // worth asking for again right away instead of after the backoff.
+    if (_camera_found) {
+        {
+            std::lock_guard<std::mutex> lock(_information.mutex);
+            if (!_information.complete) {
+                _information.backoff.reset();
+                _parent->change_call_every(
+                    static_cast<float>(_information.backoff.interval_s()),
+                    _camera_information_call_every_cookie);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(_flight_information.mutex);
+        _flight_information.backoff.reset();
+        _flight_information.next_request_s = 0.0;
+    }
 }
 
 void CameraImpl::manual_enable()
@@ -186,17 +213,34 @@ void CameraImpl::manual_enable()
     request_status();
     request_camera_information();
 
+    // We ask again, less and less often, until we have it.
+    float camera_information_interval_s;
+    {
+        std::lock_guard<std::mutex> lock(_information.mutex);
+        _information.complete = false;
+        _information.backoff.reset();
+        camera_information_interval_s = static_cast<float>(_information.backoff.interval_s());
+    }
     _parent->add_call_every(
-        [this]() { request_camera_information(); }, 10.0, &_camera_information_call_every_cookie);
+        [this]() { poll_camera_information(); },
+        camera_information_interval_s,
+        &_camera_information_call_every_cookie);
 
     // for backwards compatibility with Yuneec drones
     if (_parent->has_autopilot()) {
+        {
+            std::lock_guard<std::mutex> lock(_flight_information.mutex);
+            _flight_information.received = false;
+            _flight_information.was_armed = _parent->is_armed();
+            _flight_information.backoff.reset();
+            _flight_information.next_request_s =
+                _time.elapsed_s() + _flight_information.backoff.interval_s();
+        }
         request_flight_information();
 
+        // Only checks locally whether we need to ask.
         _parent->add_call_every(
-            [this]() { request_flight_information(); },
-            10.0,
-            &_flight_information_call_every_cookie);
+            [this]() { poll_flight_information(); }, 1.0, &_flight_information_call_every_cookie);
     }
 }
 
@@ -504,6 +548,42 @@ void CameraImpl::take_photo_async(const Camera::ResultCallback& callback)
         });
 }
 
+void CameraImpl::trigger_photo_async(const Camera::TriggerPhotoCallback& callback)
+{
+    std::lock_guard<std::mutex> lock(_capture.mutex);
+
+    // Each single capture has its own sequence number, so the command sender
+    // doesn't hold it back until the previous ones are acked.
+    auto cmd_take_photo = make_command_take_photo(0.f, 1.0f);
+    const int sequence = static_cast<int>(cmd_take_photo.params.maybe_param4.value());
+
+    {
+        std::lock_guard<std::mutex> capture_info_lock(_capture_info.mutex);
+        _capture_info.triggers.add(sequence, callback);
+    }
+
+    _parent->send_command_async(
+        cmd_take_photo, [this, sequence](MavlinkCommandSender::Result result, float) {
+            if (result == MavlinkCommandSender::Result::Success ||
+                result == MavlinkCommandSender::Result::InProgress) {
+                // Done once the image comes in.
+                return;
+            }
+
+            Camera::TriggerPhotoCallback temp_callback;
+            {
+                std::lock_guard<std::mutex> lock(_capture_info.mutex);
+                temp_callback = _capture_info.triggers.remove(sequence);
+            }
+            if (temp_callback) {
+                const auto camera_result = camera_result_from_command_result(result);
+                _parent->call_user_callback([temp_callback, camera_result]() {
+                    temp_callback(camera_result, Camera::CaptureInfo{});
+                });
+            }
+        });
+}
+
 void CameraImpl::start_photo_interval_async(
     float interval_s, const Camera::ResultCallback& callback)
 {
@@ -739,7 +819,9 @@ void CameraImpl::save_camera_mode(const float mavlink_camera_mode)
     // I am assuming here that in such a case, CAMERA_SETTINGS is
     // never sent by the camera.
     MAVLinkParameters::ParamValue value;
-    if (_camera_definition->get_setting("CAM_MODE", value)) {
+    const bool is_known = _camera_definition->get_setting("CAM_MODE", value);
+    const auto previous_value = value;
+    if (is_known) {
         if (value.is<uint8_t>()) {
             value.set<uint8_t>(static_cast<uint8_t>(mavlink_camera_mode));
         } else if (value.is<int8_t>()) {
@@ -765,6 +847,11 @@ void CameraImpl::save_camera_mode(const float mavlink_camera_mode)
         value.set<uint32_t>(static_cast<uint32_t>(mavlink_camera_mode));
     }
 
+    // CAMERA_SETTINGS keeps coming in, only a new mode changes anything.
+    if (is_known && previous_value == value) {
+        return;
+    }
+
     _camera_definition->set_setting("CAM_MODE", value);
     refresh_params();
 }
@@ -835,11 +922,15 @@ void CameraImpl::request_status()
     _parent->send_command_async(make_command_request_storage_info(), nullptr);
 }
 
-void CameraImpl::subscribe_status(const Camera::StatusCallback callback)
+void CameraImpl::subscribe_status(
+    const Camera::StatusCallback callback, const SubscriptionOptions& options)
 {
     std::lock_guard<std::mutex> lock(_status.mutex);
 
-    _status.subscription_callback = callback;
+    _status.subscriptions.clear();
+    if (callback) {
+        _status.subscriptions.subscribe(callback, options);
+    }
 
     if (callback) {
         if (_status.call_every_cookie == nullptr) {
@@ -864,6 +955,36 @@ void CameraImpl::subscribe_capture_info(Camera::CaptureInfoCallback callback)
     _capture_info.callback = callback;
 }
 
+void CameraImpl::subscribe_capture_info_recovery(Camera::CaptureInfoRecoveryCallback callback)
+{
+    std::lock_guard<std::mutex> lock(_capture_info.mutex);
+    _capture_info.recovery_callback = callback;
+    _capture_info.reported_recovered = 0;
+    _capture_info.reported_missing = 0;
+    notify_capture_info_recovery();
+}
+
+void CameraImpl::notify_capture_info_recovery()
+{
+    // Assumes to have the lock for _capture_info.mutex.
+
+    const auto recovered = static_cast<uint32_t>(_capture_info.store.recovered_count());
+    const auto missing = static_cast<uint32_t>(_capture_info.store.missing_count());
+
+    if (!_capture_info.recovery_callback ||
+        (recovered == _capture_info.reported_recovered &&
+         missing == _capture_info.reported_missing)) {
+        return;
+    }
+
+    _capture_info.reported_recovered = recovered;
+    _capture_info.reported_missing = missing;
+
+    const auto temp_callback = _capture_info.recovery_callback;
+    _parent->call_user_callback(
+        [temp_callback, recovered, missing]() { temp_callback(recovered, missing); });
+}
+
 void CameraImpl::process_camera_capture_status(const mavlink_message_t& message)
 {
     mavlink_camera_capture_status_t camera_capture_status;
@@ -959,71 +1080,78 @@ void CameraImpl::process_camera_image_captured(const mavlink_message_t& message)
         capture_info.is_success = (image_captured.capture_result == 1);
         capture_info.index = image_captured.image_index;
 
-        _status.photo_list.insert(std::make_pair(image_captured.image_index, capture_info));
-
-        _captured_request_cv.notify_all();
-
         std::lock_guard<std::mutex> lock(_capture_info.mutex);
-        // Notify user if a new image has been captured.
-        if (_capture_info.last_advertised_image_index < capture_info.index) {
-            if (_capture_info.callback) {
-                const auto temp_callback = _capture_info.callback;
-                _parent->call_user_callback(
-                    [temp_callback, capture_info]() { temp_callback(capture_info); });
-            }
 
-            if (_capture_info.last_advertised_image_index != -1) {
-                // Save captured indices that have been dropped to request later, however, don't
-                // do it from the very beginning as there might be many photos from a previous
-                // time that we don't want to request.
-                for (int i = _capture_info.last_advertised_image_index + 1; i < capture_info.index;
-                     ++i) {
-                    if (_capture_info.missing_image_retries.find(i) ==
-                        _capture_info.missing_image_retries.end()) {
-                        _capture_info.missing_image_retries[i] = 0;
-                    }
-                }
-            }
-
-            _capture_info.last_advertised_image_index = capture_info.index;
+        // Notify user if a new image has been captured, or one that was
+        // dropped before finally came in. Dropped ones are requested later
+        // by request_missing_capture_info().
+        const auto insert_result = _capture_info.store.insert(capture_info);
+        if (insert_result != CaptureInfoStore::InsertResult::Known && _capture_info.callback) {
+            const auto temp_callback = _capture_info.callback;
+            _parent->call_user_callback(
+                [temp_callback, capture_info]() { temp_callback(capture_info); });
         }
 
-        else if (auto it = _capture_info.missing_image_retries.find(capture_info.index);
-                 it != _capture_info.missing_image_retries.end()) {
-            if (_capture_info.callback) {
-                const auto temp_callback = _capture_info.callback;
-                _parent->call_user_callback(
-                    [temp_callback, capture_info]() { temp_callback(capture_info); });
-            }
-            _capture_info.missing_image_retries.erase(it);
+        Camera::TriggerPhotoCallback trigger_callback = nullptr;
+        if (insert_result == CaptureInfoStore::InsertResult::Latest) {
+            trigger_callback = _capture_info.triggers.take_latest(capture_info.index);
+        } else if (insert_result == CaptureInfoStore::InsertResult::Missing) {
+            trigger_callback = _capture_info.triggers.take_missing(capture_info.index);
+        }
+        if (trigger_callback) {
+            const auto trigger_result =
+                capture_info.is_success ? Camera::Result::Success : Camera::Result::Error;
+            _parent->call_user_callback([trigger_callback, trigger_result, capture_info]() {
+                trigger_callback(trigger_result, capture_info);
+            });
         }
+
+        notify_capture_info_recovery();
     }
+
+    _captured_request_cv.notify_all();
 }
 
 void CameraImpl::request_missing_capture_info()
 {
-    std::lock_guard<std::mutex> lock(_capture_info.mutex);
+    std::vector<int32_t> missing_indices;
+    {
+        std::lock_guard<std::mutex> lock(_capture_info.mutex);
 
-    for (auto it = _capture_info.missing_image_retries.begin();
-         it != _capture_info.missing_image_retries.end();
-         /* ++it */) {
-        if (it->second > 3) {
-            it = _capture_info.missing_image_retries.erase(it);
-        } else {
-            ++it;
+        if (_capture_info.requests_in_flight < MAX_CAPTURE_INFO_REQUESTS_IN_FLIGHT) {
+            missing_indices = _capture_info.store.next_missing(
+                MAX_CAPTURE_INFO_REQUESTS_IN_FLIGHT - _capture_info.requests_in_flight);
+            _capture_info.requests_in_flight += missing_indices.size();
         }
+
+        // Some might have been given up on.
+        notify_capture_info_recovery();
     }
 
-    if (!_capture_info.missing_image_retries.empty()) {
-        auto it_lowest_retries = std::min_element(
-            _capture_info.missing_image_retries.begin(), _capture_info.missing_image_retries.end());
+    // Only one REQUEST_MESSAGE can be in flight as acks only tell the command
+    // apart, not the image. By queuing a few, each one still goes out as soon
+    // as the previous one is acked instead of one per call.
+    for (const auto index : missing_indices) {
+        _parent->count_background_request();
         _parent->send_command_async(
-            CameraImpl::make_command_request_camera_image_captured(it_lowest_retries->first),
-            nullptr);
-        it_lowest_retries->second += 1;
+            CameraImpl::make_command_request_camera_image_captured(index),
+            [this](MavlinkCommandSender::Result result, float) {
+                if (result == MavlinkCommandSender::Result::InProgress) {
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(_capture_info.mutex);
+                --_capture_info.requests_in_flight;
+            });
     }
 }
 
+void CameraImpl::set_capture_info_retention(uint32_t window, const std::string& spill_path)
+{
+    std::lock_guard<std::mutex> lock(_capture_info.mutex);
+
+    _capture_info.store.configure(window, spill_path);
+}
+
 Camera::EulerAngle CameraImpl::to_euler_angle_from_quaternion(Camera::Quaternion quaternion)
 {
     auto& q = quaternion;
@@ -1090,75 +1218,263 @@ void CameraImpl::process_camera_information(const mavlink_message_t& message)
             [temp_callback, temp_information]() { temp_callback(temp_information); });
     }
 
+    if (camera_information.cam_definition_uri[0] == '\0' || _camera_definition) {
+        _information.complete = true;
+    }
+
     if (should_fetch_camera_definition(camera_information.cam_definition_uri)) {
         _is_fetching_camera_definition = true;
 
-        std::thread([this, camera_information]() {
-            std::string content{};
-            const auto has_succeeded = fetch_camera_definition(camera_information, content);
+        load_camera_definition(camera_information);
+    }
+}
 
-            if (has_succeeded) {
-                LogDebug() << "Successfully loaded camera definition";
+void CameraImpl::camera_definition_loaded(std::unique_ptr<CameraDefinition> camera_definition)
+{
+    if (camera_definition) {
+        LogDebug() << "Successfully loaded camera definition";
 
-                if (_camera_definition_callback) {
-                    _parent->call_user_callback([this]() { _camera_definition_callback(true); });
-                }
+        // Only set it once it is complete, it is used without lock.
+        _camera_definition = std::move(camera_definition);
 
-                _camera_definition.reset(new CameraDefinition());
-                _camera_definition->load_string(content);
-                refresh_params();
-            } else {
-                LogDebug() << "Failed to fetch camera definition!";
+        // Called without the lock held, the callback might well prepare again.
+        if (auto callback = take_camera_definition_callback()) {
+            callback(true);
+        }
 
-                if (++_camera_definition_fetch_count >= 3) {
-                    LogWarn() << "Giving up fetching the camera definition";
+        refresh_params();
+    } else {
+        LogDebug() << "Failed to fetch camera definition!";
 
-                    std::lock_guard<std::mutex> thread_lock(_information.mutex);
-                    _has_camera_definition_timed_out = true;
+        if (++_camera_definition_fetch_count >= 3) {
+            LogWarn() << "Giving up fetching the camera definition";
 
-                    if (_camera_definition_callback) {
-                        _parent->call_user_callback(
-                            [this]() { _camera_definition_callback(false); });
-                    }
-                }
+            {
+                std::lock_guard<std::mutex> lock(_information.mutex);
+                _has_camera_definition_timed_out = true;
+            }
+
+            if (auto callback = take_camera_definition_callback()) {
+                callback(false);
             }
+        }
+    }
 
-            std::lock_guard<std::mutex> thread_lock(_information.mutex);
-            _is_fetching_camera_definition = false;
-        }).detach();
+    std::lock_guard<std::mutex> lock(_information.mutex);
+    _is_fetching_camera_definition = false;
+    if (_camera_definition || _has_camera_definition_timed_out) {
+        _information.complete = true;
     }
 }
 
+CameraImpl::CameraDefinitionCallback CameraImpl::take_camera_definition_callback()
+{
+    std::lock_guard<std::mutex> lock(_information.mutex);
+    auto callback = std::move(_camera_definition_callback);
+    _camera_definition_callback = nullptr;
+    return callback;
+}
+
 bool CameraImpl::should_fetch_camera_definition(const std::string& uri) const
 {
     return !uri.empty() && !_camera_definition && !_is_fetching_camera_definition &&
            !_has_camera_definition_timed_out;
 }
 
-bool CameraImpl::fetch_camera_definition(
-    const mavlink_camera_information_t& camera_information, std::string& camera_definition_out)
+// Cameras of the same model, e.g. on all drones of a fleet, share the parsed
+// definition. When they connect at the same time, the first one to parse it
+// holds up the others until it is shared.
+static std::shared_ptr<std::mutex> lock_for_shared_key(const std::string& shared_key)
 {
-    auto download_succeeded =
-        download_definition_file(camera_information.cam_definition_uri, camera_definition_out);
+    static std::mutex loading_mutex{};
+    static std::unordered_map<std::string, std::shared_ptr<std::mutex>> loading{};
 
-    if (download_succeeded) {
-        return true;
+    std::lock_guard<std::mutex> lock(loading_mutex);
+    auto& entry = loading[shared_key];
+    if (!entry) {
+        entry = std::make_shared<std::mutex>();
     }
+    return entry;
+}
 
-    return load_stored_definition(camera_information, camera_definition_out);
+std::string
+CameraImpl::shared_definition_key(const mavlink_camera_information_t& camera_information)
+{
+    const auto vendor = reinterpret_cast<const char*>(camera_information.vendor_name);
+    const auto model = reinterpret_cast<const char*>(camera_information.model_name);
+    return std::string(vendor, strnlen(vendor, sizeof(camera_information.vendor_name))) + "/" +
+           std::string(model, strnlen(model, sizeof(camera_information.model_name))) + "/" +
+           std::to_string(camera_information.cam_definition_version);
 }
 
-bool CameraImpl::download_definition_file(
-    const std::string& uri, std::string& camera_definition_out)
+std::string
+CameraImpl::cached_definition_key(const mavlink_camera_information_t& camera_information)
 {
-    HttpLoader http_loader;
+    // A definition with the same URI and version is the same definition, so
+    // it doesn't need to be downloaded and parsed again.
+    return std::string(camera_information.cam_definition_uri) + " version " +
+           std::to_string(camera_information.cam_definition_version);
+}
+
+void CameraImpl::load_camera_definition(const mavlink_camera_information_t& camera_information)
+{
+    // Reading the cache and parsing can take a while, and many cameras might
+    // connect at once, so both are left to the background pool. The download
+    // in between is left to the HTTP loader, so it doesn't hold up a thread
+    // of the pool.
+    _parent->run_in_background(
+        [this, camera_information]() -> BackgroundWork::Completion {
+            auto camera_definition = find_camera_definition(camera_information);
+            if (!camera_definition) {
+                download_camera_definition(camera_information);
+                return nullptr;
+            }
+            return definition_loaded_completion(std::move(camera_definition));
+        },
+        this);
+}
+
+std::unique_ptr<CameraDefinition>
+CameraImpl::find_camera_definition(const mavlink_camera_information_t& camera_information)
+{
+    const auto shared_key = shared_definition_key(camera_information);
+    if (auto parsed = CameraDefinition::find_shared(shared_key)) {
+        LogDebug() << "Using camera definition of other " << shared_key;
+        auto camera_definition = std::make_unique<CameraDefinition>();
+        camera_definition->load_parsed(std::move(parsed));
+        return camera_definition;
+    }
+
+    auto camera_definition = load_cached_definition(cached_definition_key(camera_information));
+    if (camera_definition) {
+        LogDebug() << "Using cached camera definition for "
+                   << camera_information.cam_definition_uri;
+        CameraDefinition::share(shared_key, camera_definition->parsed());
+    }
+    return camera_definition;
+}
+
+void CameraImpl::download_camera_definition(const mavlink_camera_information_t& camera_information)
+{
+    const std::string uri = camera_information.cam_definition_uri;
     LogInfo() << "Downloading camera definition from: " << uri;
-    if (!http_loader.download_text_sync(uri, camera_definition_out)) {
-        LogErr() << "Failed to download camera definition.";
-        return false;
+
+    _parent->http_loader().download_text_async(
+        uri, [this, camera_information](bool success, std::string content) {
+            if (!success) {
+                LogErr() << "Failed to download camera definition.";
+            }
+            _parent->run_in_background(
+                [this, camera_information, success, content = std::move(content)]() mutable {
+                    auto camera_definition =
+                        parse_camera_definition(camera_information, success, std::move(content));
+                    return definition_loaded_completion(std::move(camera_definition));
+                },
+                this);
+        });
+}
+
+std::unique_ptr<CameraDefinition> CameraImpl::parse_camera_definition(
+    const mavlink_camera_information_t& camera_information, bool downloaded, std::string content)
+{
+    const auto shared_key = shared_definition_key(camera_information);
+    const auto key_mutex = lock_for_shared_key(shared_key);
+    std::lock_guard<std::mutex> key_lock(*key_mutex);
+
+    // Another camera of the same model might have parsed it in the meantime.
+    if (auto parsed = CameraDefinition::find_shared(shared_key)) {
+        LogDebug() << "Using camera definition of other " << shared_key;
+        auto camera_definition = std::make_unique<CameraDefinition>();
+        camera_definition->load_parsed(std::move(parsed));
+        return camera_definition;
+    }
+
+    // Without a download, the built-in definition of the model is used, if any.
+    std::unique_ptr<CameraDefinition> camera_definition;
+    if (downloaded) {
+        camera_definition = parse_definition(content, cached_definition_key(camera_information));
+    } else {
+        camera_definition = parse_stored_definition(camera_information);
+    }
+    if (camera_definition) {
+        CameraDefinition::share(shared_key, camera_definition->parsed());
+    }
+    return camera_definition;
+}
+
+std::unique_ptr<CameraDefinition>
+CameraImpl::parse_stored_definition(const mavlink_camera_information_t& camera_information)
+{
+    std::string content;
+    if (!load_stored_definition(camera_information, content)) {
+        return nullptr;
+    }
+
+    // The built-in definitions only change with mavsdk, so they are cached by
+    // their content rather than by the URI they stand in for.
+    Crc32 crc;
+    crc.add(
+        reinterpret_cast<const uint8_t*>(content.data()), static_cast<uint32_t>(content.size()));
+    const std::string stored_key = "stored " + std::to_string(crc.get()) + " " +
+                                   std::to_string(content.size());
+
+    if (auto camera_definition = load_cached_definition(stored_key)) {
+        return camera_definition;
+    }
+    return parse_definition(content, stored_key);
+}
+
+BackgroundWork::Completion
+CameraImpl::definition_loaded_completion(std::unique_ptr<CameraDefinition> camera_definition)
+{
+    return [this, camera_definition = std::move(camera_definition)]() mutable {
+        camera_definition_loaded(std::move(camera_definition));
+    };
+}
+
+std::unique_ptr<CameraDefinition> CameraImpl::load_cached_definition(const std::string& key)
+{
+    const auto path = definition_cache_path(key);
+    if (path.empty()) {
+        return nullptr;
+    }
+
+    auto camera_definition = std::make_unique<CameraDefinition>();
+    if (!camera_definition->load_cache(path, key)) {
+        return nullptr;
+    }
+    return camera_definition;
+}
+
+std::unique_ptr<CameraDefinition>
+CameraImpl::parse_definition(const std::string& content, const std::string& key)
+{
+    auto camera_definition = std::make_unique<CameraDefinition>();
+    if (!camera_definition->load_string(content)) {
+        LogErr() << "Could not parse camera definition";
+        return nullptr;
+    }
+
+    const auto path = definition_cache_path(key);
+    if (!path.empty()) {
+        camera_definition->save_cache(path, key);
+    }
+    return camera_definition;
+}
+
+std::string CameraImpl::definition_cache_path(const std::string& key) const
+{
+    const auto directory = _parent->get_param_cache_directory();
+    if (directory.empty()) {
+        return {};
     }
 
-    return true;
+    Crc32 crc;
+    crc.add(reinterpret_cast<const uint8_t*>(key.data()), static_cast<uint32_t>(key.size()));
+
+    std::stringstream file_name;
+    file_name << "camera-definition-" << std::hex << crc.get() << ".cache";
+    return directory + path_separator + file_name.str();
 }
 
 bool CameraImpl::load_stored_definition(
@@ -1263,6 +1579,11 @@ void CameraImpl::process_flight_information(const mavlink_message_t& message)
     mavlink_flight_information_t flight_information;
     mavlink_msg_flight_information_decode(&message, &flight_information);
 
+    {
+        std::lock_guard<std::mutex> lock(_flight_information.mutex);
+        _flight_information.received = true;
+    }
+
     std::stringstream folder_name_stream;
     {
         std::lock_guard<std::mutex> information_lock(_information.mutex);
@@ -1306,11 +1627,8 @@ void CameraImpl::check_status()
     std::lock_guard<std::mutex> lock(_status.mutex);
 
     if (_status.received_camera_capture_status && _status.received_storage_information) {
-        if (_status.subscription_callback) {
-            const auto temp_callback = _status.subscription_callback;
-            const auto temp_data = _status.data;
-            _parent->call_user_callback([temp_callback, temp_data]() { temp_callback(temp_data); });
-        }
+        _status.subscriptions.queue(
+            _status.data, [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
         _status.received_camera_capture_status = false;
         _status.received_storage_information = false;
@@ -1780,9 +2098,34 @@ void CameraImpl::refresh_params()
         return;
     }
 
+    // Only the params a change can have affected are unknown, see
+    // CameraDefinition::set_setting(), and excluded ones can wait until they
+    // are applicable again.
     std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> params;
-    _camera_definition->get_unknown_params(params);
-    if (params.size() == 0) {
+    _camera_definition->get_unknown_applicable_params(params);
+
+    std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> params_to_fetch;
+    {
+        std::lock_guard<std::mutex> lock(_refresh.mutex);
+
+        for (auto& param : params) {
+            if (_refresh.failed.count(param.first) == 0 &&
+                _refresh.in_flight.insert(param.first).second) {
+                params_to_fetch.push_back(std::move(param));
+            }
+        }
+
+        if (params_to_fetch.empty()) {
+            if (!_refresh.in_flight.empty()) {
+                // We notify once the params already being fetched are in.
+                return;
+            }
+            // Failed ones are tried again next time.
+            _refresh.failed.clear();
+        }
+    }
+
+    if (params_to_fetch.empty()) {
         // We're assuming that we changed one option and this did not cause
         // any other possible settings to change. However, we still would
         // like to notify the current settings with this one change.
@@ -1791,36 +2134,38 @@ void CameraImpl::refresh_params()
         return;
     }
 
-    unsigned count = 0;
-    for (const auto& param : params) {
+    for (const auto& param : params_to_fetch) {
         const std::string& param_name = param.first;
-        const MAVLinkParameters::ParamValue& param_value_type = param.second;
-        const bool is_last = (count == params.size() - 1);
         _parent->get_param_async(
             param_name,
-            param_value_type,
-            [param_name, is_last, this](
+            param.second,
+            [param_name, this](
                 MAVLinkParameters::Result result, MAVLinkParameters::ParamValue value) {
-                if (result != MAVLinkParameters::Result::Success) {
-                    return;
-                }
                 // We need to check again by the time this callback runs
-                if (!this->_camera_definition) {
-                    return;
+                if (result == MAVLinkParameters::Result::Success && this->_camera_definition) {
+                    this->_camera_definition->set_reported_setting(param_name, value);
                 }
 
-                if (!this->_camera_definition->set_setting(param_name, value)) {
-                    return;
+                bool is_last;
+                {
+                    std::lock_guard<std::mutex> lock(_refresh.mutex);
+                    _refresh.in_flight.erase(param_name);
+                    if (result != MAVLinkParameters::Result::Success) {
+                        _refresh.failed.insert(param_name);
+                    }
+                    is_last = _refresh.in_flight.empty();
                 }
 
                 if (is_last) {
-                    notify_current_settings();
-                    notify_possible_setting_options();
+                    // The new values can make other params applicable which
+                    // are then fetched before everything is notified at once.
+                    // We are holding the params lock here, so we need to
+                    // schedule this for later, same as in set_option_async().
+                    _parent->call_user_callback([this]() { refresh_params(); });
                 }
             },
             this,
             true);
-        ++count;
     }
 }
 
@@ -1864,6 +2209,53 @@ void CameraImpl::request_flight_information()
     _parent->send_command_async(command_flight_information, nullptr);
 }
 
+void CameraImpl::poll_camera_information()
+{
+    float interval_s;
+    {
+        std::lock_guard<std::mutex> lock(_information.mutex);
+        if (_information.complete) {
+            // Nothing left to ask for until the camera changes.
+            _parent->remove_call_every(_camera_information_call_every_cookie);
+            return;
+        }
+        interval_s = static_cast<float>(_information.backoff.backoff());
+    }
+
+    request_camera_information();
+    _parent->count_background_request();
+    _parent->change_call_every(interval_s, _camera_information_call_every_cookie);
+}
+
+void CameraImpl::poll_flight_information()
+{
+    {
+        std::lock_guard<std::mutex> lock(_flight_information.mutex);
+
+        const bool is_armed = _parent->is_armed();
+        if (is_armed != _flight_information.was_armed) {
+            _flight_information.was_armed = is_armed;
+            _flight_information.received = false;
+            _flight_information.backoff.reset();
+            _flight_information.next_request_s = 0.0;
+        }
+
+        if (_flight_information.received) {
+            return;
+        }
+
+        // If nothing comes back, it's probably not supported at all.
+        const double now_s = _time.elapsed_s();
+        if (now_s < _flight_information.next_request_s) {
+            return;
+        }
+        _flight_information.next_request_s = now_s + _flight_information.backoff.backoff();
+    }
+
+    request_flight_information();
+    _parent->count_background_request();
+}
+
 void CameraImpl::request_camera_information()
 {
     auto command_camera_info = make_command_request_camera_info();
@@ -1898,14 +2290,21 @@ void CameraImpl::format_storage_async(Camera::ResultCallback callback)
                 if (camera_result == Camera::Result::Success) {
                     {
                         std::lock_guard<std::mutex> status_lock(_status.mutex);
-                        _status.photo_list.clear();
                         _status.image_count = 0;
                         _status.image_count_at_connection = 0;
                     }
                     {
                         std::lock_guard<std::mutex> lock(_capture_info.mutex);
-                        _capture_info.last_advertised_image_index = -1;
-                        _capture_info.missing_image_retries.clear();
+                        _capture_info.store.clear();
+                        notify_capture_info_recovery();
+
+                        // Image indices start over, so the images can't be
+                        // matched to triggers sent before anymore.
+                        for (auto& trigger_callback : _capture_info.triggers.take_all()) {
+                            _parent->call_user_callback([trigger_callback]() {
+                                trigger_callback(Camera::Result::Error, Camera::CaptureInfo{});
+                            });
+                        }
                     }
                 }
 
@@ -1972,14 +2371,18 @@ void CameraImpl::list_photos_async(
     std::thread([this, start_index, callback]() {
         std::unique_lock<std::mutex> capture_request_lock(_captured_request_mutex);
 
+        const auto needs_fetching = [this](int index) {
+            std::lock_guard<std::mutex> lock(_capture_info.mutex);
+            return _capture_info.store.needs_fetching(index);
+        };
+
         for (int i = start_index; i < _status.image_count; i++) {
             // In case the vehicle sends capture info, but not those we are asking, we do not
             // want to loop infinitely. The safety_count is here to abort if this happens.
             auto safety_count = 0;
             const auto safety_count_boundary = 10;
 
-            while (_status.photo_list.find(i) == _status.photo_list.end() &&
-                   safety_count < safety_count_boundary) {
+            while (needs_fetching(i) && safety_count < safety_count_boundary) {
                 safety_count++;
 
                 auto request_try_number = 0;
@@ -2016,15 +2419,13 @@ void CameraImpl::list_photos_async(
         }
 
         std::vector<Camera::CaptureInfo> photo_list;
+        {
+            std::lock_guard<std::mutex> lock(_capture_info.mutex);
+            photo_list = _capture_info.store.photos(start_index);
+        }
         {
             std::lock_guard<std::mutex> status_lock(_status.mutex);
 
-            for (auto capture_info : _status.photo_list) {
-                if (capture_info.first >= start_index) {
-                    photo_list.push_back(capture_info.second);
-                }
-            }
-
             _status.is_fetching_photos = false;
 
             const auto temp_callback = callback;
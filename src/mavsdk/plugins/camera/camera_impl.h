@@ -1,11 +1,15 @@
 #pragma once
 
-#include <map>
+#include <unordered_set>
 
+#include "callback_list.h"
 #include "camera_definition.h"
+#include "capture_info_store.h"
+#include "capture_triggers.h"
 #include "mavlink_include.h"
 #include "plugins/camera/camera.h"
 #include "plugin_impl_base.h"
+#include "polling_backoff.h"
 #include "system.h"
 
 namespace mavsdk {
@@ -35,6 +39,7 @@ public:
 
     void prepare_async(const Camera::ResultCallback& callback);
     void take_photo_async(const Camera::ResultCallback& callback);
+    void trigger_photo_async(const Camera::TriggerPhotoCallback& callback);
     void start_photo_interval_async(float interval_s, const Camera::ResultCallback& callback);
     void stop_photo_interval_async(const Camera::ResultCallback& callback);
     void start_video_async(const Camera::ResultCallback& callback);
@@ -58,9 +63,12 @@ public:
     void subscribe_mode(const Camera::ModeCallback callback);
 
     void subscribe_capture_info(Camera::CaptureInfoCallback callback);
+    void subscribe_capture_info_recovery(Camera::CaptureInfoRecoveryCallback callback);
 
     Camera::Status status();
-    void subscribe_status(const Camera::StatusCallback callback);
+    void subscribe_status(
+        const Camera::StatusCallback callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
 
     Camera::Result set_setting(Camera::Setting setting);
     void set_setting_async(Camera::Setting setting, const Camera::ResultCallback callback);
@@ -83,6 +91,8 @@ public:
     void
     list_photos_async(Camera::PhotosRange photos_range, const Camera::ListPhotosCallback callback);
 
+    void set_capture_info_retention(uint32_t window, const std::string& spill_path);
+
     CameraImpl(const CameraImpl&) = delete;
     CameraImpl& operator=(const CameraImpl&) = delete;
 
@@ -143,9 +153,29 @@ private:
     void check_status();
 
     bool should_fetch_camera_definition(const std::string& uri) const;
-    bool fetch_camera_definition(
-        const mavlink_camera_information_t& camera_information, std::string& camera_definition_out);
-    bool download_definition_file(const std::string& uri, std::string& camera_definition_out);
+    void camera_definition_loaded(std::unique_ptr<CameraDefinition> camera_definition);
+    using CameraDefinitionCallback = std::function<void(bool)>;
+    CameraDefinitionCallback take_camera_definition_callback();
+    static std::string
+    shared_definition_key(const mavlink_camera_information_t& camera_information);
+    static std::string
+    cached_definition_key(const mavlink_camera_information_t& camera_information);
+    void load_camera_definition(const mavlink_camera_information_t& camera_information);
+    std::unique_ptr<CameraDefinition>
+    find_camera_definition(const mavlink_camera_information_t& camera_information);
+    void download_camera_definition(const mavlink_camera_information_t& camera_information);
+    std::unique_ptr<CameraDefinition> parse_camera_definition(
+        const mavlink_camera_information_t& camera_information,
+        bool downloaded,
+        std::string content);
+    std::unique_ptr<CameraDefinition>
+    parse_stored_definition(const mavlink_camera_information_t& camera_information);
+    BackgroundWork::Completion
+    definition_loaded_completion(std::unique_ptr<CameraDefinition> camera_definition);
+    std::unique_ptr<CameraDefinition> load_cached_definition(const std::string& key);
+    std::unique_ptr<CameraDefinition>
+    parse_definition(const std::string& content, const std::string& key);
+    std::string definition_cache_path(const std::string& key) const;
     bool
     load_stored_definition(const mavlink_camera_information_t&, std::string& camera_definition_out);
 
@@ -161,6 +191,9 @@ private:
     void* _check_connection_status_call_every_cookie{nullptr};
     void* _request_missing_capture_info_cookie{nullptr};
 
+    void poll_camera_information();
+    void poll_flight_information();
+
     void request_camera_settings();
     void request_camera_information();
     void request_video_stream_info();
@@ -189,12 +222,21 @@ private:
     MavlinkCommandSender::CommandLong make_command_request_video_stream_status();
 
     void request_missing_capture_info();
+    void notify_capture_info_recovery();
+
+    static constexpr std::size_t MAX_CAPTURE_INFO_REQUESTS_IN_FLIGHT = 8;
 
     std::unique_ptr<CameraDefinition> _camera_definition{};
+
+    struct {
+        std::mutex mutex{};
+        std::unordered_set<std::string> in_flight{};
+        std::unordered_set<std::string> failed{};
+    } _refresh{};
+
     bool _is_fetching_camera_definition{false};
     bool _has_camera_definition_timed_out{false};
     size_t _camera_definition_fetch_count{0};
-    using CameraDefinitionCallback = std::function<void(bool)>;
     CameraDefinitionCallback _camera_definition_callback{nullptr};
 
     std::atomic<size_t> _camera_id{0};
@@ -207,10 +249,9 @@ private:
         bool received_storage_information{false};
         int image_count{-1};
         int image_count_at_connection{-1};
-        std::map<int, Camera::CaptureInfo> photo_list;
         bool is_fetching_photos{false};
 
-        Camera::StatusCallback subscription_callback{nullptr};
+        CallbackList<Camera::Status> subscriptions{};
         void* call_every_cookie{nullptr};
     } _status{};
 
@@ -231,8 +272,12 @@ private:
     struct {
         std::mutex mutex{};
         Camera::CaptureInfoCallback callback{nullptr};
-        int last_advertised_image_index{-1};
-        std::map<int, int> missing_image_retries{};
+        CaptureInfoStore store{};
+        CaptureTriggers triggers{};
+        std::size_t requests_in_flight{0};
+        Camera::CaptureInfoRecoveryCallback recovery_callback{nullptr};
+        uint32_t reported_recovered{0};
+        uint32_t reported_missing{0};
     } _capture_info{};
 
     struct {
@@ -247,8 +292,22 @@ private:
         mutable std::mutex mutex{};
         Camera::Information data{};
         Camera::InformationCallback subscription_callback{nullptr};
+        // Set once we have the information and, if there is one, the camera definition.
+        bool complete{false};
+        PollingBackoff backoff{2.0, 60.0};
     } _information{};
 
+    // The flight ID only changes with arming, so we only ask for it then.
+    struct {
+        std::mutex mutex{};
+        bool received{false};
+        bool was_armed{false};
+        PollingBackoff backoff{1.0, 60.0};
+        double next_request_s{0.0};
+    } _flight_information{};
+
+    Time _time{};
+
     struct {
         std::mutex mutex{};
         Camera::CurrentSettingsCallback callback{nullptr};
@@ -0,0 +1,352 @@
+#include "capture_info_store.h"
+#include "cache_file.h"
+#include "fs.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <map>
+
+namespace mavsdk {
+
+static void put_float(std::vector<uint8_t>& buffer, float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    cache_put_uint(buffer, bits, sizeof(bits));
+}
+
+static bool get_float(const std::vector<uint8_t>& buffer, std::size_t& pos, float& value)
+{
+    uint64_t bits;
+    if (!cache_get_uint(buffer, pos, sizeof(value), bits)) {
+        return false;
+    }
+    const auto raw = static_cast<uint32_t>(bits);
+    std::memcpy(&value, &raw, sizeof(value));
+    return true;
+}
+
+static void put_double(std::vector<uint8_t>& buffer, double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    cache_put_uint(buffer, bits, sizeof(bits));
+}
+
+static bool get_double(const std::vector<uint8_t>& buffer, std::size_t& pos, double& value)
+{
+    uint64_t bits;
+    if (!cache_get_uint(buffer, pos, sizeof(value), bits)) {
+        return false;
+    }
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+static std::vector<uint8_t> encode(const Camera::CaptureInfo& capture_info)
+{
+    std::vector<uint8_t> record;
+    cache_put_uint(record, static_cast<uint32_t>(capture_info.index), 4);
+    cache_put_uint(record, capture_info.time_utc_us, 8);
+    cache_put_uint(record, capture_info.is_success ? 1 : 0, 1);
+    put_double(record, capture_info.position.latitude_deg);
+    put_double(record, capture_info.position.longitude_deg);
+    put_float(record, capture_info.position.absolute_altitude_m);
+    put_float(record, capture_info.position.relative_altitude_m);
+    put_float(record, capture_info.attitude_quaternion.w);
+    put_float(record, capture_info.attitude_quaternion.x);
+    put_float(record, capture_info.attitude_quaternion.y);
+    put_float(record, capture_info.attitude_quaternion.z);
+    put_float(record, capture_info.attitude_euler_angle.roll_deg);
+    put_float(record, capture_info.attitude_euler_angle.pitch_deg);
+    put_float(record, capture_info.attitude_euler_angle.yaw_deg);
+    cache_put_string(record, capture_info.file_url, 2);
+    return record;
+}
+
+static bool
+decode(const std::vector<uint8_t>& buffer, std::size_t& pos, Camera::CaptureInfo& capture_info)
+{
+    uint64_t index;
+    uint64_t is_success;
+    if (!cache_get_uint(buffer, pos, 4, index) ||
+        !cache_get_uint(buffer, pos, 8, capture_info.time_utc_us) ||
+        !cache_get_uint(buffer, pos, 1, is_success)) {
+        return false;
+    }
+    capture_info.index = static_cast<int32_t>(static_cast<uint32_t>(index));
+    capture_info.is_success = is_success != 0;
+
+    return get_double(buffer, pos, capture_info.position.latitude_deg) &&
+           get_double(buffer, pos, capture_info.position.longitude_deg) &&
+           get_float(buffer, pos, capture_info.position.absolute_altitude_m) &&
+           get_float(buffer, pos, capture_info.position.relative_altitude_m) &&
+           get_float(buffer, pos, capture_info.attitude_quaternion.w) &&
+           get_float(buffer, pos, capture_info.attitude_quaternion.x) &&
+           get_float(buffer, pos, capture_info.attitude_quaternion.y) &&
+           get_float(buffer, pos, capture_info.attitude_quaternion.z) &&
+           get_float(buffer, pos, capture_info.attitude_euler_angle.roll_deg) &&
+           get_float(buffer, pos, capture_info.attitude_euler_angle.pitch_deg) &&
+           get_float(buffer, pos, capture_info.attitude_euler_angle.yaw_deg) &&
+           cache_get_string(buffer, pos, capture_info.file_url, 2);
+}
+
+CaptureInfoStore::CaptureInfoStore(std::size_t window) :
+    _entries(std::max<std::size_t>(window, 1)),
+    _missing(_entries.size(), false),
+    _requests(_entries.size(), 0)
+{}
+
+void CaptureInfoStore::configure(std::size_t window, const std::string& spill_path)
+{
+    if (spill_path != _spill_path) {
+        _spill_file.close();
+        _spill_path = spill_path;
+    }
+
+    window = std::max<std::size_t>(window, 1);
+    if (window == _entries.size()) {
+        return;
+    }
+
+    const int32_t old_begin = window_begin();
+    auto old_entries = std::move(_entries);
+    auto old_missing = std::move(_missing);
+    auto old_requests = std::move(_requests);
+
+    _entries.assign(window, std::nullopt);
+    _missing.assign(window, false);
+    _requests.assign(window, 0);
+
+    for (int32_t index = old_begin; index < _end; ++index) {
+        const std::size_t old_slot = std::size_t(index) % old_entries.size();
+        if (index < window_begin()) {
+            if (old_entries[old_slot]) {
+                spill(*old_entries[old_slot]);
+            }
+            continue;
+        }
+        _entries[slot(index)] = std::move(old_entries[old_slot]);
+        _missing[slot(index)] = old_missing[old_slot];
+        _requests[slot(index)] = old_requests[old_slot];
+    }
+
+    _missing_count = std::count(_missing.begin(), _missing.end(), true);
+}
+
+CaptureInfoStore::InsertResult CaptureInfoStore::insert(const Camera::CaptureInfo& capture_info)
+{
+    const int32_t index = capture_info.index;
+    if (index < 0) {
+        return InsertResult::Known;
+    }
+
+    if (index >= _end) {
+        advance_to(index);
+        _entries[slot(index)] = capture_info;
+        return InsertResult::Latest;
+    }
+
+    if (index < window_begin()) {
+        // Too old to keep in memory, but still part of the flight.
+        spill(capture_info);
+        return InsertResult::Known;
+    }
+
+    const std::size_t i = slot(index);
+    const bool was_missing = _missing[i];
+    set_missing(i, false);
+    _entries[i] = capture_info;
+    if (!was_missing) {
+        return InsertResult::Known;
+    }
+    ++_recovered_count;
+    return InsertResult::Missing;
+}
+
+std::vector<int32_t> CaptureInfoStore::next_missing(std::size_t max_count)
+{
+    std::vector<int32_t> result;
+
+    // Requested ones go to the back again, so one pass at most.
+    for (std::size_t remaining = _missing_queue.size();
+         remaining > 0 && result.size() < max_count;
+         --remaining) {
+        const int32_t index = _missing_queue.front();
+        _missing_queue.pop_front();
+
+        if (index < window_begin() || !_missing[slot(index)]) {
+            continue;
+        }
+
+        auto& requests = _requests[slot(index)];
+        if (requests >= MAX_REQUESTS) {
+            set_missing(slot(index), false);
+            continue;
+        }
+
+        ++requests;
+        _missing_queue.push_back(index);
+        result.push_back(index);
+    }
+
+    return result;
+}
+
+bool CaptureInfoStore::needs_fetching(int32_t index) const
+{
+    if (index < window_begin()) {
+        return false;
+    }
+    if (index >= _end) {
+        return true;
+    }
+    return !_entries[slot(index)];
+}
+
+std::vector<Camera::CaptureInfo> CaptureInfoStore::photos(int32_t start_index) const
+{
+    // Images can be in the spill file more than once if they were sent
+    // again, the latest wins.
+    std::map<int32_t, Camera::CaptureInfo> sorted;
+    for (auto& capture_info : read_spill_file()) {
+        if (capture_info.index >= start_index) {
+            sorted[capture_info.index] = std::move(capture_info);
+        }
+    }
+
+    for (int32_t index = std::max(start_index, window_begin()); index < _end; ++index) {
+        if (const auto& entry = _entries[slot(index)]) {
+            sorted[index] = *entry;
+        }
+    }
+
+    std::vector<Camera::CaptureInfo> result;
+    result.reserve(sorted.size());
+    for (auto& entry : sorted) {
+        result.push_back(std::move(entry.second));
+    }
+    return result;
+}
+
+void CaptureInfoStore::clear()
+{
+    std::fill(_entries.begin(), _entries.end(), std::nullopt);
+    std::fill(_missing.begin(), _missing.end(), false);
+    std::fill(_requests.begin(), _requests.end(), 0);
+    _missing_queue.clear();
+    _missing_count = 0;
+    _recovered_count = 0;
+    _end = 0;
+
+    if (!_spill_path.empty()) {
+        _spill_file.close();
+        fs_remove(_spill_path);
+    }
+}
+
+int32_t CaptureInfoStore::window_begin() const
+{
+    return std::max<int32_t>(0, _end - static_cast<int32_t>(_entries.size()));
+}
+
+void CaptureInfoStore::advance_to(int32_t index)
+{
+    // Skipped images are only tracked once we know where we are, there might
+    // be many photos from a previous time that we don't want to request.
+    const bool track_missing = _end > 0;
+
+    // Only the slots for the new window need to be looked at, anything before
+    // is dropped in any case.
+    // The most recent images are the most useful ones, so they are requested
+    // first.
+    const int32_t first = std::max<int32_t>(_end, index + 1 - int32_t(_entries.size()));
+    for (int32_t i = first; i <= index; ++i) {
+        evict(slot(i));
+        if (track_missing && i < index) {
+            set_missing(slot(i), true);
+            _requests[slot(i)] = 0;
+            _missing_queue.push_front(i);
+        }
+    }
+
+    _end = index + 1;
+}
+
+void CaptureInfoStore::evict(std::size_t i)
+{
+    if (_entries[i]) {
+        spill(*_entries[i]);
+        _entries[i].reset();
+    }
+    set_missing(i, false);
+}
+
+void CaptureInfoStore::set_missing(std::size_t i, bool missing)
+{
+    if (_missing[i] != missing) {
+        _missing[i] = missing;
+        if (missing) {
+            ++_missing_count;
+        } else {
+            --_missing_count;
+        }
+    }
+}
+
+void CaptureInfoStore::spill(const Camera::CaptureInfo& capture_info)
+{
+    if (_spill_path.empty()) {
+        return;
+    }
+
+    if (!_spill_file.is_open()) {
+        _spill_file.open(_spill_path, std::ios::binary | std::ios::app);
+        if (!_spill_file) {
+            LogWarn() << "Could not open capture info spill file " << _spill_path;
+            _spill_path.clear();
+            return;
+        }
+    }
+
+    std::vector<uint8_t> buffer;
+    const auto record = encode(capture_info);
+    cache_put_uint(buffer, record.size(), 2);
+    buffer.insert(buffer.end(), record.begin(), record.end());
+
+    _spill_file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    _spill_file.flush();
+}
+
+std::vector<Camera::CaptureInfo> CaptureInfoStore::read_spill_file() const
+{
+    std::vector<Camera::CaptureInfo> result;
+    if (_spill_path.empty()) {
+        return result;
+    }
+
+    std::ifstream file(_spill_path, std::ios::binary);
+    if (!file) {
+        return result;
+    }
+    const std::vector<uint8_t> buffer(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // A record cut short by a crash is only at the very end and skipped.
+    std::size_t pos = 0;
+    uint64_t record_len;
+    while (cache_get_uint(buffer, pos, 2, record_len) && buffer.size() - pos >= record_len) {
+        const std::size_t record_end = pos + static_cast<std::size_t>(record_len);
+        Camera::CaptureInfo capture_info{};
+        if (decode(buffer, pos, capture_info) && pos == record_end) {
+            result.push_back(std::move(capture_info));
+        }
+        pos = record_end;
+    }
+
+    return result;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "plugins/camera/camera.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+
+// Keeps the capture infos of the most recent images by their index.
+//
+// Only a window of the last images is kept in memory, in a ring indexed by
+// image index, together with a bitmap of the images in it that were skipped
+// and still have to be requested. Images dropping out of the window can be
+// appended to a spill file, so the whole flight can still be listed, without
+// holding it all in memory.
+//
+// Not thread-safe, the caller needs to lock.
+class CaptureInfoStore {
+public:
+    static constexpr std::size_t DEFAULT_WINDOW = 4096;
+
+    // How often a skipped image is requested before giving up on it.
+    static constexpr uint8_t MAX_REQUESTS = 4;
+
+    enum class InsertResult {
+        Known, // Already there or too old to keep.
+        Latest, // Newer than any image before.
+        Missing, // One we have been missing.
+    };
+
+    explicit CaptureInfoStore(std::size_t window = DEFAULT_WINDOW);
+
+    // Changes the window and spill file, everything in memory is kept as far
+    // as it fits. An empty spill_path disables spilling.
+    void configure(std::size_t window, const std::string& spill_path);
+
+    InsertResult insert(const Camera::CaptureInfo& capture_info);
+
+    // Returns up to max_count skipped images to request, the most recent
+    // ones first, each one at most once. Calling it again carries on with
+    // the ones not returned yet, going round all of them in turn.
+    std::vector<int32_t> next_missing(std::size_t max_count = 1);
+
+    // Skipped images in the window still to come, and the ones that came
+    // in after all, since the last clear().
+    std::size_t missing_count() const { return _missing_count; }
+    std::size_t recovered_count() const { return _recovered_count; }
+
+    // False for images stored or too old for the window which are not
+    // requested anymore.
+    bool needs_fetching(int32_t index) const;
+
+    // All images from start_index on in order, including spilled ones.
+    std::vector<Camera::CaptureInfo> photos(int32_t start_index) const;
+
+    // Forgets everything including the spill file, e.g. after formatting.
+    void clear();
+
+    std::size_t window() const { return _entries.size(); }
+
+private:
+    std::size_t slot(int32_t index) const { return std::size_t(index) % _entries.size(); }
+    int32_t window_begin() const;
+    void advance_to(int32_t index);
+    void evict(std::size_t slot);
+    void set_missing(std::size_t slot, bool missing);
+    void spill(const Camera::CaptureInfo& capture_info);
+    std::vector<Camera::CaptureInfo> read_spill_file() const;
+
+    std::vector<std::optional<Camera::CaptureInfo>> _entries;
+    // Bitmap of slots of skipped images with their requests.
+    std::vector<bool> _missing;
+    std::vector<uint8_t> _requests;
+    std::deque<int32_t> _missing_queue{};
+    std::size_t _missing_count{0};
+    std::size_t _recovered_count{0};
+
+    // One past the highest index seen, 0 if none.
+    int32_t _end{0};
+
+    std::string _spill_path{};
+    std::ofstream _spill_file{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,188 @@
+#include "capture_info_store.h"
+#include "fs.h"
+
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+Camera::CaptureInfo capture_info_for(int32_t index)
+{
+    Camera::CaptureInfo capture_info{};
+    capture_info.index = index;
+    capture_info.is_success = true;
+    capture_info.time_utc_us = 1000000ull * index;
+    capture_info.position.latitude_deg = 47.0 + index * 1e-6;
+    capture_info.position.longitude_deg = 8.0 - index * 1e-6;
+    capture_info.position.relative_altitude_m = 50.5f;
+    capture_info.attitude_quaternion.w = 1.0f;
+    capture_info.file_url = "http://camera/" + std::to_string(index) + ".jpg";
+    return capture_info;
+}
+} // namespace
+
+TEST(CaptureInfoStore, InsertsInOrder)
+{
+    CaptureInfoStore store;
+
+    for (int32_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(store.insert(capture_info_for(i)), CaptureInfoStore::InsertResult::Latest);
+    }
+    EXPECT_EQ(store.insert(capture_info_for(3)), CaptureInfoStore::InsertResult::Known);
+
+    const auto photos = store.photos(0);
+    ASSERT_EQ(photos.size(), 10);
+    for (int32_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(photos[i].index, i);
+    }
+    EXPECT_EQ(store.photos(7).size(), 3);
+    EXPECT_TRUE(store.next_missing().empty());
+}
+
+TEST(CaptureInfoStore, FirstImageLeavesNoGaps)
+{
+    CaptureInfoStore store;
+
+    EXPECT_EQ(store.insert(capture_info_for(100)), CaptureInfoStore::InsertResult::Latest);
+    EXPECT_TRUE(store.next_missing().empty());
+    EXPECT_TRUE(store.needs_fetching(50));
+    EXPECT_FALSE(store.needs_fetching(100));
+}
+
+TEST(CaptureInfoStore, RequestsSkippedImages)
+{
+    CaptureInfoStore store;
+
+    store.insert(capture_info_for(0));
+    store.insert(capture_info_for(3));
+    EXPECT_EQ(store.missing_count(), 2);
+
+    // Most recent first.
+    EXPECT_EQ(store.next_missing(), std::vector<int32_t>{2});
+    EXPECT_EQ(store.next_missing(), std::vector<int32_t>{1});
+    EXPECT_EQ(store.next_missing(), std::vector<int32_t>{2});
+
+    EXPECT_EQ(store.insert(capture_info_for(1)), CaptureInfoStore::InsertResult::Missing);
+    EXPECT_EQ(store.insert(capture_info_for(1)), CaptureInfoStore::InsertResult::Known);
+    EXPECT_EQ(store.missing_count(), 1);
+    EXPECT_EQ(store.recovered_count(), 1);
+
+    // 2 was requested twice so far.
+    for (unsigned i = 2; i < CaptureInfoStore::MAX_REQUESTS; ++i) {
+        EXPECT_EQ(store.next_missing(), std::vector<int32_t>{2});
+    }
+    EXPECT_TRUE(store.next_missing().empty());
+    EXPECT_EQ(store.missing_count(), 0);
+
+    // Given up on, so it's nothing special anymore when it arrives.
+    EXPECT_EQ(store.insert(capture_info_for(2)), CaptureInfoStore::InsertResult::Known);
+}
+
+TEST(CaptureInfoStore, KeepsWindowOnly)
+{
+    CaptureInfoStore store(8);
+
+    for (int32_t i = 0; i < 100; ++i) {
+        store.insert(capture_info_for(i));
+    }
+
+    const auto photos = store.photos(0);
+    ASSERT_EQ(photos.size(), 8);
+    EXPECT_EQ(photos.front().index, 92);
+    EXPECT_EQ(photos.back().index, 99);
+
+    EXPECT_FALSE(store.needs_fetching(10));
+    EXPECT_FALSE(store.needs_fetching(95));
+    EXPECT_TRUE(store.needs_fetching(100));
+
+    // Skipped images falling out of the window are not requested anymore.
+    store.insert(capture_info_for(120));
+    EXPECT_EQ(store.missing_count(), 7);
+    for (int i = 0; i < 10; ++i) {
+        const auto missing = store.next_missing();
+        ASSERT_EQ(missing.size(), 1);
+        EXPECT_GE(missing.front(), 113);
+    }
+}
+
+TEST(CaptureInfoStore, RequestsBatchesNewestFirst)
+{
+    CaptureInfoStore store;
+
+    store.insert(capture_info_for(0));
+    store.insert(capture_info_for(10));
+    store.insert(capture_info_for(20));
+    EXPECT_EQ(store.missing_count(), 18);
+
+    EXPECT_EQ(store.next_missing(4), (std::vector<int32_t>{19, 18, 17, 16}));
+    EXPECT_EQ(store.next_missing(4), (std::vector<int32_t>{15, 14, 13, 12}));
+
+    // Never the same one twice in a batch.
+    const auto all = store.next_missing(100);
+    EXPECT_EQ(all.size(), 18);
+    EXPECT_EQ(all.front(), 11);
+
+    for (int32_t i = 1; i < 10; ++i) {
+        store.insert(capture_info_for(i));
+    }
+    EXPECT_EQ(store.missing_count(), 9);
+    EXPECT_EQ(store.recovered_count(), 9);
+
+    store.clear();
+    EXPECT_EQ(store.missing_count(), 0);
+    EXPECT_EQ(store.recovered_count(), 0);
+}
+
+TEST(CaptureInfoStore, SpillsToFile)
+{
+    const auto dir = create_tmp_directory("mavsdk-capture-info-store-test");
+    ASSERT_TRUE(dir);
+    const auto path = *dir + path_separator + "capture_info.spill";
+
+    CaptureInfoStore store;
+    store.configure(8, path);
+
+    for (int32_t i = 0; i < 100; ++i) {
+        store.insert(capture_info_for(i));
+    }
+
+    auto photos = store.photos(0);
+    ASSERT_EQ(photos.size(), 100);
+    for (int32_t i = 0; i < 100; ++i) {
+        const auto expected = capture_info_for(i);
+        EXPECT_EQ(photos[i].index, i);
+        EXPECT_EQ(photos[i].time_utc_us, expected.time_utc_us);
+        EXPECT_DOUBLE_EQ(photos[i].position.latitude_deg, expected.position.latitude_deg);
+        EXPECT_FLOAT_EQ(photos[i].position.relative_altitude_m, 50.5f);
+        EXPECT_EQ(photos[i].file_url, expected.file_url);
+    }
+    EXPECT_EQ(store.photos(50).size(), 50);
+
+    // An old image sent again replaces the spilled one.
+    auto again = capture_info_for(5);
+    again.file_url = "http://camera/again.jpg";
+    store.insert(again);
+    photos = store.photos(0);
+    ASSERT_EQ(photos.size(), 100);
+    EXPECT_EQ(photos[5].file_url, "http://camera/again.jpg");
+
+    store.clear();
+    EXPECT_TRUE(store.photos(0).empty());
+    EXPECT_FALSE(fs_exists(path));
+}
+
+TEST(CaptureInfoStore, ShrinksWindow)
+{
+    CaptureInfoStore store(16);
+
+    for (int32_t i = 0; i < 16; ++i) {
+        store.insert(capture_info_for(i));
+    }
+
+    store.configure(4, "");
+    EXPECT_EQ(store.window(), 4);
+
+    const auto photos = store.photos(0);
+    ASSERT_EQ(photos.size(), 4);
+    EXPECT_EQ(photos.front().index, 12);
+}
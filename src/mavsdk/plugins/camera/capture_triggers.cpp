@@ -0,0 +1,76 @@
+#include "capture_triggers.h"
+
+#include <algorithm>
+
+namespace mavsdk {
+
+void CaptureTriggers::add(int sequence, const Callback& callback)
+{
+    _waiting.push_back(Trigger{sequence, callback});
+}
+
+CaptureTriggers::Callback CaptureTriggers::remove(int sequence)
+{
+    auto it = std::find_if(_waiting.begin(), _waiting.end(), [sequence](const Trigger& trigger) {
+        return trigger.sequence == sequence;
+    });
+    if (it == _waiting.end()) {
+        return nullptr;
+    }
+
+    auto callback = std::move(it->callback);
+    _waiting.erase(it);
+    return callback;
+}
+
+CaptureTriggers::Callback CaptureTriggers::take_latest(int32_t index)
+{
+    // The images in between were taken for the oldest triggers, but their
+    // capture infos have not come in yet.
+    if (_latest_index) {
+        for (int32_t skipped = _latest_index.value() + 1; skipped < index && !_waiting.empty();
+             ++skipped) {
+            _skipped.emplace(skipped, std::move(_waiting.front().callback));
+            _waiting.pop_front();
+        }
+    }
+    _latest_index = index;
+
+    if (_waiting.empty()) {
+        return nullptr;
+    }
+
+    auto callback = std::move(_waiting.front().callback);
+    _waiting.pop_front();
+    return callback;
+}
+
+CaptureTriggers::Callback CaptureTriggers::take_missing(int32_t index)
+{
+    auto it = _skipped.find(index);
+    if (it == _skipped.end()) {
+        return nullptr;
+    }
+
+    auto callback = std::move(it->second);
+    _skipped.erase(it);
+    return callback;
+}
+
+std::deque<CaptureTriggers::Callback> CaptureTriggers::take_all()
+{
+    std::deque<Callback> callbacks;
+    for (auto& skipped : _skipped) {
+        callbacks.push_back(std::move(skipped.second));
+    }
+    for (auto& trigger : _waiting) {
+        callbacks.push_back(std::move(trigger.callback));
+    }
+
+    _skipped.clear();
+    _waiting.clear();
+    _latest_index.reset();
+    return callbacks;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "plugins/camera/camera.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+
+namespace mavsdk {
+
+// Matches the images coming in to the photo triggers waiting for them.
+//
+// Triggers are sent without waiting for the previous one to be acked, and
+// the camera takes the images in the order the triggers arrive, so each new
+// image belongs to the oldest trigger still waiting. If images are skipped,
+// e.g. their CAMERA_IMAGE_CAPTURED got lost, the triggers they belong to
+// are set aside by image index until those images are requested again.
+//
+// Not thread-safe, the caller needs to lock.
+class CaptureTriggers {
+public:
+    using Callback = Camera::TriggerPhotoCallback;
+
+    void add(int sequence, const Callback& callback);
+
+    // Takes out a trigger the camera did not accept, returns nullptr if it
+    // was already matched to an image.
+    Callback remove(int sequence);
+
+    // Returns the trigger the image belongs to, if any. Skipped images are
+    // only matched once they come in, as missing ones are.
+    Callback take_latest(int32_t index);
+    Callback take_missing(int32_t index);
+
+    // All triggers still waiting, e.g. once the camera storage is formatted.
+    std::deque<Callback> take_all();
+
+    [[nodiscard]] std::size_t waiting_count() const { return _waiting.size() + _skipped.size(); }
+
+private:
+    struct Trigger {
+        int sequence{0};
+        Callback callback{nullptr};
+    };
+
+    std::deque<Trigger> _waiting{};
+    std::map<int32_t, Callback> _skipped{};
+    std::optional<int32_t> _latest_index{};
+};
+
+} // namespace mavsdk
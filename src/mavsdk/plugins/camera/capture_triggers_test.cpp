@@ -0,0 +1,100 @@
+#include "capture_triggers.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+struct Results {
+    std::vector<int> sequences{};
+};
+
+CaptureTriggers::Callback callback_for(Results& results, int sequence)
+{
+    return [&results, sequence](Camera::Result, Camera::CaptureInfo) {
+        results.sequences.push_back(sequence);
+    };
+}
+} // namespace
+
+TEST(CaptureTriggers, MatchesImagesInOrder)
+{
+    CaptureTriggers triggers;
+    Results results;
+
+    for (int sequence = 1; sequence <= 3; ++sequence) {
+        triggers.add(sequence, callback_for(results, sequence));
+    }
+
+    for (int32_t index = 10; index < 13; ++index) {
+        auto callback = triggers.take_latest(index);
+        ASSERT_TRUE(callback);
+        callback(Camera::Result::Success, {});
+    }
+    EXPECT_EQ(results.sequences, (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(triggers.waiting_count(), 0);
+
+    EXPECT_FALSE(triggers.take_latest(13));
+}
+
+TEST(CaptureTriggers, RemovedTriggerIsNotMatched)
+{
+    CaptureTriggers triggers;
+    Results results;
+
+    triggers.add(1, callback_for(results, 1));
+    triggers.add(2, callback_for(results, 2));
+
+    EXPECT_TRUE(triggers.remove(1));
+    EXPECT_FALSE(triggers.remove(1));
+
+    auto callback = triggers.take_latest(0);
+    ASSERT_TRUE(callback);
+    callback(Camera::Result::Success, {});
+    EXPECT_EQ(results.sequences, (std::vector<int>{2}));
+}
+
+TEST(CaptureTriggers, SkippedImagesAreMatchedOnceRecovered)
+{
+    CaptureTriggers triggers;
+    Results results;
+
+    for (int sequence = 1; sequence <= 4; ++sequence) {
+        triggers.add(sequence, callback_for(results, sequence));
+    }
+
+    triggers.take_latest(0)(Camera::Result::Success, {});
+
+    // Images 1 and 2 got lost, 3 is for the fourth trigger.
+    triggers.take_latest(3)(Camera::Result::Success, {});
+    EXPECT_EQ(results.sequences, (std::vector<int>{1, 4}));
+    EXPECT_EQ(triggers.waiting_count(), 2);
+
+    EXPECT_FALSE(triggers.take_missing(5));
+    triggers.take_missing(2)(Camera::Result::Success, {});
+    triggers.take_missing(1)(Camera::Result::Success, {});
+    EXPECT_EQ(results.sequences, (std::vector<int>{1, 4, 3, 2}));
+    EXPECT_EQ(triggers.waiting_count(), 0);
+}
+
+TEST(CaptureTriggers, TakeAllStartsOver)
+{
+    CaptureTriggers triggers;
+    Results results;
+
+    triggers.add(1, callback_for(results, 1));
+    triggers.add(2, callback_for(results, 2));
+    triggers.add(3, callback_for(results, 3));
+    triggers.take_latest(5)(Camera::Result::Success, {});
+    triggers.add(4, callback_for(results, 4));
+    triggers.take_latest(7)(Camera::Result::Success, {});
+
+    EXPECT_EQ(triggers.take_all().size(), 2);
+    EXPECT_EQ(triggers.waiting_count(), 0);
+
+    // Indices start over, nothing is treated as skipped.
+    triggers.add(5, callback_for(results, 5));
+    triggers.take_latest(0)(Camera::Result::Success, {});
+    EXPECT_EQ(results.sequences, (std::vector<int>{1, 3, 5}));
+}
@@ -15,6 +15,8 @@
 
 #include "mavsdk/plugin_base.h"
 
+#include "mavsdk/subscription_options.h"
+
 namespace mavsdk {
 
 class System;
@@ -832,6 +834,63 @@ public:
      */
     Result select_camera(int32_t camera_id) const;
 
+    /**
+     * @brief Set how many capture infos are kept in memory.
+     *
+     * Only the capture infos of the last `window` images are kept (4096 by
+     * default), and only images missing in that window are requested again.
+     * Older capture infos are dropped unless `spill_path` is set, in which
+     * case they are appended to that file and still returned by 'list_photos'.
+     * This keeps memory bounded on long mapping flights.
+     *
+     * This function is blocking.
+     */
+    void set_capture_info_retention(uint32_t window, std::string spill_path) const;
+
+    /**
+     * @brief Callback type for subscribe_capture_info_recovery.
+     *
+     * Called with the number of images whose capture info was missed and
+     * came in on request since the last format, and the number still
+     * missing.
+     */
+    using CaptureInfoRecoveryCallback =
+        std::function<void(uint32_t recovered_count, uint32_t missing_count)>;
+
+    /**
+     * @brief Subscribe to the progress of requesting missed capture infos.
+     *
+     * Capture infos missed, e.g. during a link drop, are requested again, the
+     * most recent ones first. The recovered ones are reported by
+     * 'subscribe_capture_info' as they come in.
+     */
+    void subscribe_capture_info_recovery(CaptureInfoRecoveryCallback callback);
+
+    /**
+     * @brief Callback type for trigger_photo_async.
+     */
+    using TriggerPhotoCallback = std::function<void(Result, CaptureInfo)>;
+
+    /**
+     * @brief Take one photo without waiting for the photos triggered before.
+     *
+     * Triggers are sent right away, up to 8 at a time, so the photo rate is
+     * limited by the camera rather than by the round trip of the link. The
+     * callback is called with the capture info of the image taken for this
+     * trigger, or with the error if the camera did not accept it.
+     *
+     * Images are matched to triggers in the order they are taken, so no
+     * other photos should be taken at the same time, e.g. with an interval.
+     *
+     * This function is non-blocking.
+     */
+    void trigger_photo_async(const TriggerPhotoCallback callback);
+
+    /**
+     * @brief Subscribe to camera status updates, delivered as set in `options`.
+     */
+    void subscribe_status(StatusCallback callback, const SubscriptionOptions& options);
+
     /**
      * @brief Copy constructor.
      */
@@ -1,12 +1,43 @@
 #include "component_information_impl.h"
+#include "cache_file.h"
+#include "crc32.h"
 #include "fs.h"
+#include "http_loader.h"
+#include "xz_decoder.h"
 
+#include <algorithm>
+#include <memory>
+#include <sstream>
 #include <utility>
-#include <fstream>
 #include <json/json.h>
 
 namespace mavsdk {
 
+// Bump the last char whenever the format changes, old caches are then just
+// ignored.
+static const std::vector<uint8_t> cache_magic = {'M', 'C', 'M', '1'};
+
+static uint32_t crc_of(const std::vector<uint8_t>& data)
+{
+    Crc32 crc;
+    crc.add(data.data(), static_cast<uint32_t>(data.size()));
+    return crc.get();
+}
+
+static bool parse_json(const std::vector<uint8_t>& data, Json::Value& root)
+{
+    Json::CharReaderBuilder builder;
+    const std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    JSONCPP_STRING err;
+
+    const auto begin = reinterpret_cast<const char*>(data.data());
+    if (!reader->parse(begin, begin + data.size(), &root, &err)) {
+        LogErr() << "Parse error: " << err;
+        return false;
+    }
+    return true;
+}
+
 ComponentInformationImpl::ComponentInformationImpl(System& system) : PluginImplBase(system)
 {
     _parent->register_plugin(this);
@@ -23,18 +54,33 @@ ComponentInformationImpl::~ComponentInformationImpl()
     _parent->unregister_plugin(this);
 }
 
-void ComponentInformationImpl::init() {}
+void ComponentInformationImpl::init()
+{
+    _parent->add_connect_step(
+        "component information",
+        [this](ConnectPipeline::Done done) { request_component_information(std::move(done)); },
+        this);
+}
 
-void ComponentInformationImpl::deinit() {}
+void ComponentInformationImpl::deinit()
+{
+    _parent->remove_connect_steps(this);
+    _parent->cancel_background(this);
+}
+
+void ComponentInformationImpl::enable() {}
 
-void ComponentInformationImpl::enable()
+void ComponentInformationImpl::request_component_information(ConnectPipeline::Done done)
 {
     // TODO: iterate through components!
 
     _parent->request_message().request(
         MAVLINK_MSG_ID_COMPONENT_INFORMATION,
         MAV_COMP_ID_PATHPLANNER,
-        [this](auto&& result, auto&& message) { receive_component_information(result, message); });
+        [this, done](auto&& result, auto&& message) {
+            receive_component_information(result, message);
+            done(result == MavlinkCommandSender::Result::Success);
+        });
 }
 
 void ComponentInformationImpl::disable() {}
@@ -55,13 +101,36 @@ void ComponentInformationImpl::receive_component_information(
     const auto general_metadata_uri = std::string(component_information.general_metadata_uri);
 
     download_file_async(
-        general_metadata_uri, [this](std::string path) { parse_metadata_file(path); });
+        general_metadata_uri,
+        component_information.general_metadata_file_crc,
+        [this](const std::vector<uint8_t>& data) { return parse_metadata(data); });
 }
 
 void ComponentInformationImpl::download_file_async(
-    const std::string& uri, std::function<void(std::string path)> callback)
+    const std::string& uri, uint32_t crc, DataCallback callback)
 {
-    // TODO: check CRC
+    // Files are cached as they were served, which is what the CRC is of, and
+    // only decompressed to be parsed.
+    callback = [uri, callback = std::move(callback)](const std::vector<uint8_t>& data) {
+        if (!XzDecoder::is_xz(data)) {
+            return callback(data);
+        }
+        const auto decompressed = XzDecoder::decompress(data);
+        if (!decompressed) {
+            LogErr() << "Could not decompress " << uri;
+            return BackgroundWork::Completion{};
+        }
+        return callback(*decompressed);
+    };
+
+    if (crc != 0) {
+        if (auto data = load_cached_file(crc)) {
+            LogDebug() << "Using cached " << uri;
+            _parent->run_in_background(
+                [callback, data = std::move(*data)]() { return callback(data); }, this);
+            return;
+        }
+    }
 
     if (uri.empty()) {
         LogErr() << "No component information URI provided";
@@ -72,46 +141,148 @@ void ComponentInformationImpl::download_file_async(
 
         const auto path = uri.substr(strlen("mftp://"));
 
-        const auto maybe_tmp_path = create_tmp_directory("mavsdk-component-information-tmp-files");
-        const auto path_to_download = maybe_tmp_path ? maybe_tmp_path.value() : "./";
-
-        _parent->mavlink_ftp().download_async(
+        // The files are only parsed, so there is no need to store them.
+        _parent->mavlink_ftp().download_to_memory_async(
             path,
-            path_to_download,
-            [path_to_download, callback, path](
-                MavlinkFtp::ClientResult download_result, MavlinkFtp::ProgressData progress_data) {
+            [this, uri, crc, callback, path](
+                MavlinkFtp::ClientResult download_result,
+                MavlinkFtp::ProgressData progress_data,
+                const std::vector<uint8_t>& data) {
                 if (download_result == MavlinkFtp::ClientResult::Next) {
                     LogDebug() << "File download progress: " << progress_data.bytes_transferred
                                << '/' << progress_data.total_bytes;
                 } else {
                     LogDebug() << "File download ended with result " << download_result;
                     if (download_result == MavlinkFtp::ClientResult::Success) {
-                        LogDebug() << "Received file " << path_to_download + "/" + path;
-                        callback(path_to_download + "/" + path);
+                        LogDebug() << "Received file " << path << " (" << data.size()
+                                   << " bytes)";
+                        downloaded(uri, crc, data, callback);
                     }
                 }
             });
     } else if (uri.find("http://") == 0 || uri.find("https://") == 0) {
-        LogWarn() << "Download using http(s) not implemented yet";
+        LogDebug() << "Found http(s) URI, downloading file";
+
+        _parent->http_loader().download_text_async(
+            uri, [this, uri, crc, callback](bool success, std::string content) {
+                if (!success) {
+                    LogErr() << "Could not download " << uri;
+                    return;
+                }
+                downloaded(
+                    uri, crc, std::vector<uint8_t>(content.begin(), content.end()), callback);
+            });
     } else {
         LogWarn() << "Unknown URI protocol";
     }
 }
 
-void ComponentInformationImpl::parse_metadata_file(const std::string& path)
+void ComponentInformationImpl::downloaded(
+    const std::string& uri, uint32_t crc, std::vector<uint8_t> data, DataCallback callback)
+{
+    // Parsing can take a while, so it's done on the background pool rather
+    // than on the thread receiving the file or with the queued work.
+    _parent->run_in_background(
+        [this, uri, crc, data = std::move(data), callback]() {
+            if (crc != 0) {
+                if (crc_of(data) == crc) {
+                    save_cached_file(crc, data);
+                } else {
+                    LogWarn() << "CRC of " << uri << " does not match, not caching it";
+                }
+            }
+            return callback(data);
+        },
+        this);
+}
+
+std::string ComponentInformationImpl::cache_path(const std::string& prefix, uint32_t crc) const
+{
+    const auto directory = _parent->get_param_cache_directory();
+    if (directory.empty()) {
+        return {};
+    }
+
+    std::stringstream file_name;
+    file_name << prefix << std::hex << crc << ".cache";
+    return directory + path_separator + file_name.str();
+}
+
+std::optional<std::vector<uint8_t>> ComponentInformationImpl::load_cached_file(uint32_t crc) const
+{
+    const auto path = cache_path("component-metadata-", crc);
+    if (path.empty()) {
+        return std::nullopt;
+    }
+
+    auto buffer = cache_file_read(path, cache_magic);
+    if (!buffer) {
+        return std::nullopt;
+    }
+    buffer->erase(buffer->begin(), buffer->begin() + cache_magic.size());
+
+    if (crc_of(*buffer) != crc) {
+        LogWarn() << "Ignoring cache " << path << " with wrong CRC";
+        return std::nullopt;
+    }
+    return buffer;
+}
+
+void ComponentInformationImpl::save_cached_file(
+    uint32_t crc, const std::vector<uint8_t>& data) const
+{
+    const auto path = cache_path("component-metadata-", crc);
+    if (path.empty()) {
+        return;
+    }
+
+    std::vector<uint8_t> buffer;
+    buffer.reserve(cache_magic.size() + data.size() + 4);
+    buffer.insert(buffer.end(), cache_magic.begin(), cache_magic.end());
+    buffer.insert(buffer.end(), data.begin(), data.end());
+    cache_file_write(path, std::move(buffer));
+}
+
+std::optional<ParamMetadataIndex>
+ComponentInformationImpl::load_cached_param_metadata(uint32_t crc) const
+{
+    const auto path = cache_path("param-metadata-index-", crc);
+    if (path.empty()) {
+        return std::nullopt;
+    }
+
+    // The blob starts with its own magic, which is kept.
+    const std::vector<uint8_t> magic(
+        std::begin(ParamMetadataIndex::MAGIC), std::end(ParamMetadataIndex::MAGIC));
+    auto buffer = cache_file_read(path, magic);
+    if (!buffer) {
+        return std::nullopt;
+    }
+    return ParamMetadataIndex::from_blob(std::move(*buffer));
+}
+
+void ComponentInformationImpl::save_cached_param_metadata(
+    uint32_t crc, const ParamMetadataIndex& index) const
 {
-    std::ifstream f(path);
-    if (f.bad()) {
-        LogErr() << "Could not open json metadata file.";
+    const auto path = cache_path("param-metadata-index-", crc);
+    if (path.empty()) {
         return;
     }
+    cache_file_write(path, index.blob());
+}
 
+BackgroundWork::Completion
+ComponentInformationImpl::parse_metadata(const std::vector<uint8_t>& data)
+{
     Json::Value metadata;
-    f >> metadata;
+    if (!parse_json(data, metadata)) {
+        LogErr() << "Could not parse json metadata file.";
+        return {};
+    }
 
     if (!metadata.isMember("version")) {
         LogErr() << "version not found";
-        return;
+        return {};
     }
 
     if (metadata["version"].asInt() != 1) {
@@ -120,43 +291,59 @@ void ComponentInformationImpl::parse_metadata_file(const std::string& path)
 
     if (!metadata.isMember("metadataTypes")) {
         LogErr() << "metadataTypes not found";
-        return;
+        return {};
     }
 
+    std::optional<ParamMetadataIndex> cached_index;
+
     for (auto& metadata_type : metadata["metadataTypes"]) {
         if (!metadata_type.isMember("type")) {
             LogErr() << "type missing";
-            return;
+            break;
         }
         if (!metadata_type.isMember("uri")) {
             LogErr() << "uri missing";
-            return;
+            break;
         }
 
         if (metadata_type["type"].asInt() == COMP_METADATA_TYPE_PARAMETER) {
+            const auto crc = metadata_type.get("fileCrc", 0).asUInt();
+            if (crc != 0) {
+                if (auto index = load_cached_param_metadata(crc)) {
+                    LogDebug() << "Using cached parameter metadata index";
+                    cached_index = std::move(index);
+                    continue;
+                }
+            }
             download_file_async(
-                metadata_type["uri"].asString(), [this](const std::string& parameter_file_path) {
-                    LogDebug() << "Found parameter file at: " << parameter_file_path;
-                    parse_parameter_file(parameter_file_path);
+                metadata_type["uri"].asString(),
+                crc,
+                [this, crc](const std::vector<uint8_t>& parameter_data) {
+                    return parse_parameters(parameter_data, crc);
                 });
         }
     }
-}
 
-void ComponentInformationImpl::parse_parameter_file(const std::string& path)
-{
-    std::ifstream f(path);
-    if (f.bad()) {
-        LogErr() << "Could not open json parameter file.";
-        return;
+    if (!cached_index) {
+        return {};
     }
+    return [this, index = std::move(*cached_index)]() mutable {
+        use_param_metadata(std::move(index));
+    };
+}
 
+BackgroundWork::Completion
+ComponentInformationImpl::parse_parameters(const std::vector<uint8_t>& data, uint32_t crc)
+{
     Json::Value parameters;
-    f >> parameters;
+    if (!parse_json(data, parameters)) {
+        LogErr() << "Could not parse json parameter file.";
+        return {};
+    }
 
     if (!parameters.isMember("version")) {
         LogErr() << "version not found";
-        return;
+        return {};
     }
 
     if (parameters["version"].asInt() != 1) {
@@ -165,31 +352,49 @@ void ComponentInformationImpl::parse_parameter_file(const std::string& path)
 
     if (!parameters.isMember("parameters")) {
         LogErr() << "parameters not found";
-        return;
+        return {};
+    }
+
+    auto index = ParamMetadataIndex::from_json(parameters["parameters"]);
+    if (!index) {
+        return {};
+    }
+
+    if (crc != 0) {
+        save_cached_param_metadata(crc, *index);
     }
 
+    // Subscribes to the params, which is best not done from the pool.
+    return [this, index = std::move(*index)]() mutable { use_param_metadata(std::move(index)); };
+}
+
+void ComponentInformationImpl::use_param_metadata(ParamMetadataIndex index)
+{
     std::lock_guard<std::mutex> lock(_mutex);
+    _param_metadata = std::move(index);
     _float_params.clear();
 
-    for (auto& param : parameters["parameters"]) {
-        if (!param.isMember("type")) {
+    for (std::size_t i = 0; i < _param_metadata->size(); ++i) {
+        const auto param = _param_metadata->at(i);
+
+        if (param.type.empty()) {
             LogErr() << "type not found";
             return;
         }
 
-        if (param["type"].asString() == "Float") {
+        if (param.type == "Float") {
             _float_params.push_back(ComponentInformation::FloatParam{
-                param["name"].asString(),
-                param["shortDesc"].asString(),
-                param["longDesc"].asString(),
-                param["units"].asString(),
-                param["decimalPlaces"].asInt(),
+                std::string(param.name),
+                std::string(param.short_desc),
+                std::string(param.long_desc),
+                std::string(param.units),
+                param.decimal_places.value_or(0),
                 NAN,
-                param["default"].asFloat(),
-                param["min"].asFloat(),
-                param["max"].asFloat()});
+                param.default_value.value_or(0.0f),
+                param.min.value_or(0.0f),
+                param.max.value_or(0.0f)});
 
-            const auto name = param["name"].asString();
+            const auto name = std::string(param.name);
 
             _parent->get_param_float_async(
                 name,
@@ -202,11 +407,21 @@ void ComponentInformationImpl::parse_parameter_file(const std::string& path)
                 name, [this, name](float value) { param_update(name, value); }, this);
 
         } else {
-            LogWarn() << "Ignoring type " << param["type"].asString() << " for now.";
+            LogWarn() << "Ignoring type " << param.type << " for now.";
         }
     }
 }
 
+ComponentInformation::FloatParam*
+ComponentInformationImpl::find_float_param(const std::string& name)
+{
+    const auto found = std::lower_bound(
+        _float_params.begin(), _float_params.end(), name, [](const auto& param, const auto& key) {
+            return param.name < key;
+        });
+    return found != _float_params.end() && found->name == name ? &*found : nullptr;
+}
+
 void ComponentInformationImpl::get_float_param_result(
     const std::string& name, MAVLinkParameters::Result result, float value)
 {
@@ -216,11 +431,9 @@ void ComponentInformationImpl::get_float_param_result(
     }
 
     std::lock_guard<std::mutex> lock(_mutex);
-    for (auto& param : _float_params) {
-        if (param.name == name) {
-            param.start_value = value;
-            LogDebug() << "Received value " << value << " for " << name;
-        }
+    if (auto* param = find_float_param(name)) {
+        param->start_value = value;
+        LogDebug() << "Received value " << value << " for " << name;
     }
 }
 
@@ -228,11 +441,9 @@ void ComponentInformationImpl::param_update(const std::string& name, float new_v
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    for (auto& param : _float_params) {
-        if (param.name == name) {
-            param.start_value = new_value;
-            LogDebug() << "Received value " << new_value << " for " << name;
-        }
+    if (auto* param = find_float_param(name)) {
+        param->start_value = new_value;
+        LogDebug() << "Received value " << new_value << " for " << name;
     }
 
     const auto param_update = ComponentInformation::FloatParamUpdate{name, new_value};
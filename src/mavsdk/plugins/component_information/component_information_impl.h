@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
+#include <vector>
+
 #include "plugins/component_information/component_information.h"
+#include "param_metadata_index.h"
 #include "plugin_impl_base.h"
 
 namespace mavsdk {
@@ -23,13 +28,36 @@ public:
     void subscribe_float_param(ComponentInformation::FloatParamCallback callback);
 
 private:
+    void request_component_information(ConnectPipeline::Done done);
     void receive_component_information(
         MavlinkCommandSender::Result result, const mavlink_message_t& message);
 
-    void
-    download_file_async(const std::string& uri, std::function<void(std::string path)> callback);
-    void parse_metadata_file(const std::string& path);
-    void parse_parameter_file(const std::string& path);
+    // Called on the background pool, what it returns is called with the user
+    // callbacks, see SystemImpl::run_in_background.
+    using DataCallback =
+        std::function<BackgroundWork::Completion(const std::vector<uint8_t>& data)>;
+
+    // A CRC of 0 means it is unknown, so the file can't be cached.
+    void download_file_async(const std::string& uri, uint32_t crc, DataCallback callback);
+    void downloaded(
+        const std::string& uri, uint32_t crc, std::vector<uint8_t> data, DataCallback callback);
+
+    // The files are cached by their CRC, so a cached file is known to be
+    // current whenever the vehicle reports the same CRC again.
+    std::string cache_path(const std::string& prefix, uint32_t crc) const;
+    std::optional<std::vector<uint8_t>> load_cached_file(uint32_t crc) const;
+    void save_cached_file(uint32_t crc, const std::vector<uint8_t>& data) const;
+
+    // The index of the parameter metadata is cached by the CRC of the file it
+    // was built from, so the file doesn't even need to be loaded again.
+    std::optional<ParamMetadataIndex> load_cached_param_metadata(uint32_t crc) const;
+    void save_cached_param_metadata(uint32_t crc, const ParamMetadataIndex& index) const;
+
+    BackgroundWork::Completion parse_metadata(const std::vector<uint8_t>& data);
+    BackgroundWork::Completion parse_parameters(const std::vector<uint8_t>& data, uint32_t crc);
+    void use_param_metadata(ParamMetadataIndex index);
+    // Returns nullptr if there is no such float param, with the mutex held.
+    ComponentInformation::FloatParam* find_float_param(const std::string& name);
 
     void
     get_float_param_result(const std::string& name, MAVLinkParameters::Result result, float value);
@@ -37,6 +65,8 @@ private:
     void param_update(const std::string& name, float new_value);
 
     std::mutex _mutex{};
+    std::optional<ParamMetadataIndex> _param_metadata{};
+    // Sorted by name, as they come from the index.
     std::vector<ComponentInformation::FloatParam> _float_params{};
 
     ComponentInformation::FloatParamCallback _float_param_update_callback{};
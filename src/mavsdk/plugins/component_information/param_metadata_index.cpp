@@ -0,0 +1,360 @@
+#include "param_metadata_index.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <json/json.h>
+
+namespace mavsdk {
+
+namespace {
+
+// Record fields, by offset.
+constexpr std::size_t NAME = 0;
+constexpr std::size_t TYPE = 4;
+constexpr std::size_t SHORT_DESC = 8;
+constexpr std::size_t LONG_DESC = 12;
+constexpr std::size_t UNITS = 16;
+constexpr std::size_t FIRST_ENUM_VALUE = 20;
+constexpr std::size_t ENUM_VALUE_COUNT = 24;
+constexpr std::size_t DECIMAL_PLACES = 28;
+constexpr std::size_t FLAGS = 29;
+constexpr std::size_t MIN = 32;
+constexpr std::size_t MAX = 36;
+constexpr std::size_t DEFAULT_VALUE = 40;
+constexpr std::size_t INCREMENT = 44;
+
+enum Flags : uint8_t {
+    HAS_MIN = 1 << 0,
+    HAS_MAX = 1 << 1,
+    HAS_DEFAULT_VALUE = 1 << 2,
+    HAS_INCREMENT = 1 << 3,
+    HAS_DECIMAL_PLACES = 1 << 4,
+    REBOOT_REQUIRED = 1 << 5,
+};
+
+void put_u32(uint8_t* data, uint32_t value)
+{
+    for (std::size_t i = 0; i < 4; ++i) {
+        data[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint32_t get_u32(const uint8_t* data)
+{
+    uint32_t value = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+void put_u64(uint8_t* data, uint64_t value)
+{
+    put_u32(data, static_cast<uint32_t>(value));
+    put_u32(data + 4, static_cast<uint32_t>(value >> 32));
+}
+
+uint64_t get_u64(const uint8_t* data)
+{
+    return static_cast<uint64_t>(get_u32(data)) | static_cast<uint64_t>(get_u32(data + 4)) << 32;
+}
+
+void put_float(uint8_t* data, float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put_u32(data, bits);
+}
+
+float get_float(const uint8_t* data)
+{
+    const uint32_t bits = get_u32(data);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Each string is only stored once, the empty one at offset 0.
+class StringTable {
+public:
+    StringTable() { _strings.push_back('\0'); }
+
+    uint32_t intern(const std::string& value)
+    {
+        if (value.empty()) {
+            return 0;
+        }
+        const auto [it, inserted] =
+            _offsets.try_emplace(value, static_cast<uint32_t>(_strings.size()));
+        if (inserted) {
+            _strings.insert(_strings.end(), value.begin(), value.end());
+            _strings.push_back('\0');
+        }
+        return it->second;
+    }
+
+    [[nodiscard]] const std::vector<uint8_t>& strings() const { return _strings; }
+
+private:
+    std::vector<uint8_t> _strings{};
+    std::unordered_map<std::string, uint32_t> _offsets{};
+};
+
+} // namespace
+
+ParamMetadataIndex::ParamMetadataIndex(std::vector<uint8_t> blob) : _blob(std::move(blob))
+{
+    if (_blob.size() >= HEADER_SIZE) {
+        _count = get_u32(&_blob[4]);
+        _enum_count = get_u32(&_blob[8]);
+        _strings_size = get_u32(&_blob[12]);
+    }
+}
+
+std::optional<ParamMetadataIndex> ParamMetadataIndex::from_json(const Json::Value& parameters)
+{
+    if (!parameters.isArray()) {
+        LogErr() << "Parameter metadata is not an array";
+        return std::nullopt;
+    }
+
+    std::vector<const Json::Value*> sorted;
+    for (const auto& param : parameters) {
+        if (!param.isObject() || !param["name"].isString() || param["name"].asString().empty()) {
+            LogWarn() << "Ignoring parameter metadata without name";
+            continue;
+        }
+        sorted.push_back(&param);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const auto* lhs, const auto* rhs) {
+        return (*lhs)["name"].asString() < (*rhs)["name"].asString();
+    });
+    sorted.erase(
+        std::unique(
+            sorted.begin(),
+            sorted.end(),
+            [](const auto* lhs, const auto* rhs) {
+                if ((*lhs)["name"].asString() != (*rhs)["name"].asString()) {
+                    return false;
+                }
+                LogWarn() << "Ignoring duplicate parameter metadata of "
+                          << (*rhs)["name"].asString();
+                return true;
+            }),
+        sorted.end());
+
+    StringTable strings;
+    std::vector<uint8_t> records(sorted.size() * RECORD_SIZE);
+    std::vector<uint8_t> enum_values;
+
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+        const auto& param = *sorted[i];
+        uint8_t* record = &records[i * RECORD_SIZE];
+
+        const auto string_of = [&](const char* key) {
+            return param[key].isString() ? strings.intern(param[key].asString()) : 0;
+        };
+        put_u32(record + NAME, string_of("name"));
+        put_u32(record + TYPE, string_of("type"));
+        put_u32(record + SHORT_DESC, string_of("shortDesc"));
+        put_u32(record + LONG_DESC, string_of("longDesc"));
+        put_u32(record + UNITS, string_of("units"));
+
+        uint8_t flags = 0;
+        const auto put_number = [&](const char* key, std::size_t offset, Flags flag) {
+            if (param[key].isNumeric()) {
+                put_float(record + offset, param[key].asFloat());
+                flags |= flag;
+            }
+        };
+        put_number("min", MIN, HAS_MIN);
+        put_number("max", MAX, HAS_MAX);
+        put_number("default", DEFAULT_VALUE, HAS_DEFAULT_VALUE);
+        put_number("increment", INCREMENT, HAS_INCREMENT);
+
+        if (param["decimalPlaces"].isInt()) {
+            record[DECIMAL_PLACES] = static_cast<uint8_t>(
+                static_cast<int8_t>(std::clamp(param["decimalPlaces"].asInt(), -128, 127)));
+            flags |= HAS_DECIMAL_PLACES;
+        }
+        if (param["rebootRequired"].isBool() && param["rebootRequired"].asBool()) {
+            flags |= REBOOT_REQUIRED;
+        }
+        record[FLAGS] = flags;
+
+        const auto first_enum_value = enum_values.size() / ENUM_VALUE_SIZE;
+        for (const auto& value : param["values"]) {
+            if (!value.isObject() || !value["value"].isNumeric()) {
+                continue;
+            }
+            uint8_t entry[ENUM_VALUE_SIZE];
+            const double number = value["value"].asDouble();
+            uint64_t bits;
+            std::memcpy(&bits, &number, sizeof(bits));
+            put_u64(entry, bits);
+            put_u32(
+                entry + 8,
+                value["description"].isString() ?
+                    strings.intern(value["description"].asString()) :
+                    0);
+            enum_values.insert(enum_values.end(), entry, entry + ENUM_VALUE_SIZE);
+        }
+        put_u32(record + FIRST_ENUM_VALUE, static_cast<uint32_t>(first_enum_value));
+        put_u32(
+            record + ENUM_VALUE_COUNT,
+            static_cast<uint32_t>(enum_values.size() / ENUM_VALUE_SIZE - first_enum_value));
+    }
+
+    std::vector<uint8_t> blob(HEADER_SIZE);
+    std::copy(std::begin(MAGIC), std::end(MAGIC), blob.begin());
+    put_u32(&blob[4], static_cast<uint32_t>(sorted.size()));
+    put_u32(&blob[8], static_cast<uint32_t>(enum_values.size() / ENUM_VALUE_SIZE));
+    put_u32(&blob[12], static_cast<uint32_t>(strings.strings().size()));
+    blob.reserve(HEADER_SIZE + records.size() + enum_values.size() + strings.strings().size());
+    blob.insert(blob.end(), records.begin(), records.end());
+    blob.insert(blob.end(), enum_values.begin(), enum_values.end());
+    blob.insert(blob.end(), strings.strings().begin(), strings.strings().end());
+
+    return ParamMetadataIndex(std::move(blob));
+}
+
+std::optional<ParamMetadataIndex> ParamMetadataIndex::from_blob(std::vector<uint8_t> blob)
+{
+    ParamMetadataIndex index(std::move(blob));
+    if (!index.is_valid()) {
+        return std::nullopt;
+    }
+    return index;
+}
+
+bool ParamMetadataIndex::is_valid() const
+{
+    if (_blob.size() < HEADER_SIZE ||
+        !std::equal(std::begin(MAGIC), std::end(MAGIC), _blob.begin())) {
+        LogWarn() << "Unknown parameter metadata index format";
+        return false;
+    }
+
+    const uint64_t expected_size = HEADER_SIZE + uint64_t(_count) * RECORD_SIZE +
+                                   uint64_t(_enum_count) * ENUM_VALUE_SIZE + _strings_size;
+    if (_blob.size() != expected_size || _strings_size == 0 || _blob.back() != '\0') {
+        LogWarn() << "Parameter metadata index of wrong size";
+        return false;
+    }
+
+    // Checked once here, so lookups don't need to.
+    const auto string_valid = [&](uint32_t offset) { return offset < _strings_size; };
+    for (std::size_t i = 0; i < _count; ++i) {
+        const uint8_t* record = &_blob[record_offset(i)];
+        for (const auto field : {NAME, TYPE, SHORT_DESC, LONG_DESC, UNITS}) {
+            if (!string_valid(get_u32(record + field))) {
+                LogWarn() << "Parameter metadata index with invalid string";
+                return false;
+            }
+        }
+        const uint64_t first = get_u32(record + FIRST_ENUM_VALUE);
+        if (first + get_u32(record + ENUM_VALUE_COUNT) > _enum_count) {
+            LogWarn() << "Parameter metadata index with invalid enum values";
+            return false;
+        }
+        if (i > 0 && !(name_at(i - 1) < name_at(i))) {
+            LogWarn() << "Parameter metadata index not sorted";
+            return false;
+        }
+    }
+
+    const std::size_t enums_start = HEADER_SIZE + std::size_t(_count) * RECORD_SIZE;
+    for (std::size_t i = 0; i < _enum_count; ++i) {
+        if (!string_valid(get_u32(&_blob[enums_start + i * ENUM_VALUE_SIZE + 8]))) {
+            LogWarn() << "Parameter metadata index with invalid string";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::size_t ParamMetadataIndex::record_offset(std::size_t index) const
+{
+    return HEADER_SIZE + index * RECORD_SIZE;
+}
+
+std::string_view ParamMetadataIndex::string_at(uint32_t offset) const
+{
+    const std::size_t strings_start = _blob.size() - _strings_size;
+    return std::string_view(reinterpret_cast<const char*>(&_blob[strings_start + offset]));
+}
+
+std::string_view ParamMetadataIndex::name_at(std::size_t index) const
+{
+    return string_at(get_u32(&_blob[record_offset(index) + NAME]));
+}
+
+ParamMetadataIndex::Param ParamMetadataIndex::at(std::size_t index) const
+{
+    const uint8_t* record = &_blob[record_offset(index)];
+    const uint8_t flags = record[FLAGS];
+
+    Param param;
+    param.name = string_at(get_u32(record + NAME));
+    param.type = string_at(get_u32(record + TYPE));
+    param.short_desc = string_at(get_u32(record + SHORT_DESC));
+    param.long_desc = string_at(get_u32(record + LONG_DESC));
+    param.units = string_at(get_u32(record + UNITS));
+
+    if (flags & HAS_DECIMAL_PLACES) {
+        param.decimal_places = static_cast<int8_t>(record[DECIMAL_PLACES]);
+    }
+    if (flags & HAS_MIN) {
+        param.min = get_float(record + MIN);
+    }
+    if (flags & HAS_MAX) {
+        param.max = get_float(record + MAX);
+    }
+    if (flags & HAS_DEFAULT_VALUE) {
+        param.default_value = get_float(record + DEFAULT_VALUE);
+    }
+    if (flags & HAS_INCREMENT) {
+        param.increment = get_float(record + INCREMENT);
+    }
+    param.reboot_required = (flags & REBOOT_REQUIRED) != 0;
+
+    const std::size_t enums_start = HEADER_SIZE + std::size_t(_count) * RECORD_SIZE;
+    const auto first = get_u32(record + FIRST_ENUM_VALUE);
+    const auto count = get_u32(record + ENUM_VALUE_COUNT);
+    param.enum_values.reserve(count);
+    for (std::size_t i = first; i < first + count; ++i) {
+        const uint8_t* entry = &_blob[enums_start + i * ENUM_VALUE_SIZE];
+        const uint64_t bits = get_u64(entry);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        param.enum_values.push_back(EnumValue{value, string_at(get_u32(entry + 8))});
+    }
+
+    return param;
+}
+
+std::optional<ParamMetadataIndex::Param> ParamMetadataIndex::find(std::string_view name) const
+{
+    std::size_t low = 0;
+    std::size_t high = _count;
+    while (low < high) {
+        const std::size_t middle = low + (high - low) / 2;
+        if (name_at(middle) < name) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low == _count || name_at(low) != name) {
+        return std::nullopt;
+    }
+    return at(low);
+}
+
+} // namespace mavsdk
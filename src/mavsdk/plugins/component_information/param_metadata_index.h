@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace Json {
+class Value;
+}
+
+namespace mavsdk {
+
+// Compact, immutable index of the parameter metadata of a component.
+//
+// The parameter metadata JSON is large, and only a few fields of it are of
+// use once it is parsed. The index keeps these in one blob which is used as
+// it is, without parsing, so it can be cached and loaded in one read (or
+// mapped) on later connects:
+//
+// - A header with a magic and the sizes of the sections.
+// - Fixed size records, sorted by name, so a parameter is found with a
+//   binary search. Ranges are packed as floats with flags of which are set.
+// - Enum values of all parameters, each parameter refers to a slice.
+// - Interned strings, zero terminated, referred to by offset.
+//
+// Numbers are little endian.
+class ParamMetadataIndex {
+public:
+    static constexpr uint8_t MAGIC[4] = {'M', 'P', 'X', '1'};
+
+    struct EnumValue {
+        double value{0.0};
+        std::string_view description{};
+    };
+
+    // Views into the blob, only valid as long as the index.
+    struct Param {
+        std::string_view name{};
+        std::string_view type{}; // As in the JSON, e.g. "Float" or "Int32".
+        std::string_view short_desc{};
+        std::string_view long_desc{};
+        std::string_view units{};
+        std::optional<int> decimal_places{};
+        std::optional<float> min{};
+        std::optional<float> max{};
+        std::optional<float> default_value{};
+        std::optional<float> increment{};
+        bool reboot_required{false};
+        std::vector<EnumValue> enum_values{};
+    };
+
+    // From the "parameters" of a parameter metadata file. Returns nullopt if
+    // they are invalid.
+    static std::optional<ParamMetadataIndex> from_json(const Json::Value& parameters);
+
+    // From a blob as returned by blob(). Returns nullopt if it is invalid.
+    static std::optional<ParamMetadataIndex> from_blob(std::vector<uint8_t> blob);
+
+    [[nodiscard]] const std::vector<uint8_t>& blob() const { return _blob; }
+
+    [[nodiscard]] std::size_t size() const { return _count; }
+
+    // In the order of their names.
+    [[nodiscard]] Param at(std::size_t index) const;
+
+    [[nodiscard]] std::optional<Param> find(std::string_view name) const;
+
+private:
+    static constexpr std::size_t HEADER_SIZE = 16;
+    static constexpr std::size_t RECORD_SIZE = 48;
+    static constexpr std::size_t ENUM_VALUE_SIZE = 12;
+
+    explicit ParamMetadataIndex(std::vector<uint8_t> blob);
+
+    [[nodiscard]] bool is_valid() const;
+    [[nodiscard]] std::string_view string_at(uint32_t offset) const;
+    [[nodiscard]] std::string_view name_at(std::size_t index) const;
+    [[nodiscard]] std::size_t record_offset(std::size_t index) const;
+
+    std::vector<uint8_t> _blob;
+    uint32_t _count{0};
+    uint32_t _enum_count{0};
+    uint32_t _strings_size{0};
+};
+
+} // namespace mavsdk
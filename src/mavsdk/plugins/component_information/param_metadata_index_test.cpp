@@ -0,0 +1,173 @@
+#include "param_metadata_index.h"
+
+#include <string>
+#include <gtest/gtest.h>
+#include <json/json.h>
+
+using namespace mavsdk;
+
+namespace {
+
+const std::string parameters_json = R"([
+    {
+        "name": "MPC_XY_VEL_MAX",
+        "type": "Float",
+        "shortDesc": "Maximum horizontal velocity",
+        "longDesc": "Maximum horizontal velocity in position control mode.",
+        "units": "m/s",
+        "decimalPlaces": 1,
+        "default": 12.0,
+        "min": 0.0,
+        "max": 20.0,
+        "increment": 1.0
+    },
+    {
+        "name": "CAL_ACC0_ID",
+        "type": "Int32",
+        "shortDesc": "Accelerometer 0 calibration device ID",
+        "default": 0,
+        "rebootRequired": true
+    },
+    {
+        "name": "COM_RC_IN_MODE",
+        "type": "Int32",
+        "shortDesc": "RC control input mode",
+        "default": 3,
+        "values": [
+            {"value": 0, "description": "RC Transmitter only"},
+            {"value": 1, "description": "Joystick only"},
+            {"value": 3, "description": "RC and Joystick with fallback"}
+        ]
+    },
+    {
+        "name": "MPC_XY_VEL_MAX",
+        "type": "Float",
+        "shortDesc": "Duplicate"
+    },
+    {
+        "type": "Float",
+        "shortDesc": "Without name"
+    }
+])";
+
+std::optional<ParamMetadataIndex> make_index()
+{
+    Json::Value parameters;
+    Json::CharReaderBuilder builder;
+    const std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    JSONCPP_STRING err;
+    if (!reader->parse(
+            parameters_json.data(),
+            parameters_json.data() + parameters_json.size(),
+            &parameters,
+            &err)) {
+        return std::nullopt;
+    }
+    return ParamMetadataIndex::from_json(parameters);
+}
+
+} // namespace
+
+TEST(ParamMetadataIndex, FindsByName)
+{
+    const auto index = make_index();
+    ASSERT_TRUE(index);
+    EXPECT_EQ(index->size(), 3u);
+
+    const auto vel = index->find("MPC_XY_VEL_MAX");
+    ASSERT_TRUE(vel);
+    EXPECT_EQ(vel->name, "MPC_XY_VEL_MAX");
+    EXPECT_EQ(vel->type, "Float");
+    EXPECT_EQ(vel->short_desc, "Maximum horizontal velocity");
+    EXPECT_EQ(vel->units, "m/s");
+    EXPECT_EQ(vel->decimal_places, 1);
+    EXPECT_EQ(vel->min, 0.0f);
+    EXPECT_EQ(vel->max, 20.0f);
+    EXPECT_EQ(vel->default_value, 12.0f);
+    EXPECT_EQ(vel->increment, 1.0f);
+    EXPECT_FALSE(vel->reboot_required);
+    EXPECT_TRUE(vel->enum_values.empty());
+
+    const auto cal = index->find("CAL_ACC0_ID");
+    ASSERT_TRUE(cal);
+    EXPECT_TRUE(cal->reboot_required);
+    EXPECT_FALSE(cal->min);
+    EXPECT_FALSE(cal->decimal_places);
+    EXPECT_TRUE(cal->long_desc.empty());
+
+    const auto mode = index->find("COM_RC_IN_MODE");
+    ASSERT_TRUE(mode);
+    ASSERT_EQ(mode->enum_values.size(), 3u);
+    EXPECT_EQ(mode->enum_values[2].value, 3.0);
+    EXPECT_EQ(mode->enum_values[2].description, "RC and Joystick with fallback");
+
+    EXPECT_FALSE(index->find("MPC_XY_VEL"));
+    EXPECT_FALSE(index->find("ZZZ"));
+    EXPECT_FALSE(index->find(""));
+}
+
+TEST(ParamMetadataIndex, IsSortedByName)
+{
+    const auto index = make_index();
+    ASSERT_TRUE(index);
+    ASSERT_EQ(index->size(), 3u);
+    EXPECT_EQ(index->at(0).name, "CAL_ACC0_ID");
+    EXPECT_EQ(index->at(1).name, "COM_RC_IN_MODE");
+    EXPECT_EQ(index->at(2).name, "MPC_XY_VEL_MAX");
+}
+
+TEST(ParamMetadataIndex, LoadsFromBlob)
+{
+    const auto index = make_index();
+    ASSERT_TRUE(index);
+
+    const auto loaded = ParamMetadataIndex::from_blob(index->blob());
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->blob(), index->blob());
+
+    const auto mode = loaded->find("COM_RC_IN_MODE");
+    ASSERT_TRUE(mode);
+    EXPECT_EQ(mode->default_value, 3.0f);
+    EXPECT_EQ(mode->enum_values.size(), 3u);
+}
+
+TEST(ParamMetadataIndex, RejectsInvalidBlobs)
+{
+    const auto index = make_index();
+    ASSERT_TRUE(index);
+    const auto& blob = index->blob();
+
+    EXPECT_FALSE(ParamMetadataIndex::from_blob({}));
+
+    auto truncated = blob;
+    truncated.pop_back();
+    EXPECT_FALSE(ParamMetadataIndex::from_blob(truncated));
+
+    auto wrong_magic = blob;
+    wrong_magic[3] = '0';
+    EXPECT_FALSE(ParamMetadataIndex::from_blob(wrong_magic));
+
+    // The name of the first record pointing past the strings.
+    auto wrong_string = blob;
+    wrong_string[16 + 3] = 0xff;
+    EXPECT_FALSE(ParamMetadataIndex::from_blob(wrong_string));
+}
+
+TEST(ParamMetadataIndex, InternsStrings)
+{
+    Json::Value parameters(Json::arrayValue);
+    for (int i = 0; i < 100; ++i) {
+        Json::Value param;
+        param["name"] = "PARAM_" + std::to_string(i);
+        param["type"] = "Float";
+        param["units"] = "m/s";
+        param["shortDesc"] = "The same description for all of them";
+        parameters.append(param);
+    }
+
+    const auto index = ParamMetadataIndex::from_json(parameters);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(index->size(), 100u);
+    // Mostly the records, the shared strings are only there once.
+    EXPECT_LT(index->blob().size(), 100u * (48 + 10) + 100);
+}
@@ -0,0 +1,92 @@
+#include "xz_decoder.h"
+#include "log.h"
+
+#include <algorithm>
+#include <array>
+#include <lzma.h>
+
+namespace mavsdk {
+
+static constexpr std::array<uint8_t, 6> xz_magic = {0xfd, '7', 'z', 'X', 'Z', 0x00};
+
+struct XzDecoder::Stream {
+    lzma_stream lzma = LZMA_STREAM_INIT;
+};
+
+XzDecoder::XzDecoder() : _stream(std::make_unique<Stream>())
+{
+    const auto ret = lzma_stream_decoder(&_stream->lzma, MEMORY_LIMIT, 0);
+    if (ret != LZMA_OK) {
+        LogErr() << "Could not set up xz decoder: " << static_cast<int>(ret);
+        _result = Result::Error;
+    }
+}
+
+XzDecoder::~XzDecoder()
+{
+    lzma_end(&_stream->lzma);
+}
+
+XzDecoder::Result
+XzDecoder::feed(const uint8_t* data, std::size_t size, std::vector<uint8_t>& output)
+{
+    if (_result != Result::NeedMore) {
+        return _result;
+    }
+
+    auto& lzma = _stream->lzma;
+    lzma.next_in = data;
+    lzma.avail_in = size;
+
+    std::array<uint8_t, 16 * 1024> chunk{};
+    while (true) {
+        lzma.next_out = chunk.data();
+        lzma.avail_out = chunk.size();
+
+        const auto ret = lzma_code(&lzma, LZMA_RUN);
+        output.insert(output.end(), chunk.data(), lzma.next_out);
+
+        if (ret == LZMA_STREAM_END) {
+            _result = Result::Done;
+            break;
+        }
+        if (ret != LZMA_OK) {
+            LogErr() << "xz decoding failed: " << static_cast<int>(ret);
+            _result = Result::Error;
+            break;
+        }
+        if (lzma.avail_in == 0 && lzma.avail_out != 0) {
+            // All input used up and nothing more to flush out.
+            break;
+        }
+    }
+
+    lzma.next_in = nullptr;
+    lzma.avail_in = 0;
+    return _result;
+}
+
+bool XzDecoder::is_xz(const std::vector<uint8_t>& data)
+{
+    return data.size() >= xz_magic.size() &&
+           std::equal(xz_magic.begin(), xz_magic.end(), data.begin());
+}
+
+std::optional<std::vector<uint8_t>> XzDecoder::decompress(const std::vector<uint8_t>& data)
+{
+    XzDecoder decoder;
+    std::vector<uint8_t> output;
+    // Usually compressed about 5 to 10 times.
+    output.reserve(data.size() * 8);
+
+    const auto result = decoder.feed(data.data(), data.size(), output);
+    if (result != Result::Done) {
+        if (result == Result::NeedMore) {
+            LogErr() << "xz file is truncated";
+        }
+        return std::nullopt;
+    }
+    return output;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace mavsdk {
+
+// Decompresses .xz files, as PX4 serves its component metadata as .json.xz.
+//
+// The compressed data can be fed in pieces as it arrives, the output is
+// appended as far as it can be decoded so far.
+class XzDecoder {
+public:
+    XzDecoder();
+    ~XzDecoder();
+
+    // Non-copyable
+    XzDecoder(const XzDecoder&) = delete;
+    const XzDecoder& operator=(const XzDecoder&) = delete;
+
+    enum class Result {
+        NeedMore,
+        Done,
+        Error,
+    };
+
+    // Anything fed after the end of the stream is ignored.
+    Result feed(const uint8_t* data, std::size_t size, std::vector<uint8_t>& output);
+
+    // Checks for the magic bytes at the start of an .xz file.
+    static bool is_xz(const std::vector<uint8_t>& data);
+
+    // The whole file at once, nullopt if it is truncated or corrupt.
+    static std::optional<std::vector<uint8_t>> decompress(const std::vector<uint8_t>& data);
+
+    // Decoding needs more memory than this for very large dictionaries,
+    // which metadata files don't use.
+    static constexpr uint64_t MEMORY_LIMIT = 64 * 1024 * 1024;
+
+private:
+    struct Stream;
+    std::unique_ptr<Stream> _stream;
+    Result _result{Result::NeedMore};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,68 @@
+#include "xz_decoder.h"
+
+#include <string>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+const std::string json =
+    R"({"version": 1, "parameters": [{"name": "MPC_XY_VEL_MAX", "type": "Float"}]})";
+
+// The json above, compressed with xz.
+const std::vector<uint8_t> compressed = {
+    0xfd, 0x37, 0x7a, 0x58, 0x5a, 0x00, 0x00, 0x01, 0x69, 0x22, 0xde, 0x36, 0x02, 0x00, 0x21,
+    0x01, 0x16, 0x00, 0x00, 0x00, 0x74, 0x2f, 0xe5, 0xa3, 0xe0, 0x00, 0x4a, 0x00, 0x48, 0x5d,
+    0x00, 0x3d, 0x88, 0x8a, 0xc6, 0x94, 0x53, 0x90, 0x86, 0xa6, 0x63, 0x7d, 0x25, 0x34, 0x10,
+    0x3c, 0x1a, 0x3e, 0xf3, 0x97, 0xb9, 0x07, 0x34, 0x72, 0xf7, 0xfa, 0x5a, 0x05, 0x2b, 0xb7,
+    0xa0, 0x4e, 0x5e, 0x3a, 0x6f, 0x54, 0xdd, 0x1e, 0x3b, 0xb4, 0x11, 0x03, 0x2d, 0x55, 0x3f,
+    0xf3, 0x61, 0x81, 0xb0, 0x9c, 0x75, 0xf6, 0xd2, 0xde, 0x7f, 0xc3, 0x12, 0x3c, 0x42, 0x61,
+    0xf9, 0x11, 0xb9, 0x63, 0xbc, 0x0a, 0xaa, 0x28, 0xe3, 0xc1, 0xae, 0x4a, 0x00, 0x00, 0x46,
+    0x89, 0x9c, 0x72, 0x00, 0x01, 0x60, 0x4b, 0x94, 0x46, 0x75, 0xa4, 0x90, 0x42, 0x99, 0x0d,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x01, 0x59, 0x5a,
+};
+
+std::string as_string(const std::vector<uint8_t>& data)
+{
+    return std::string(data.begin(), data.end());
+}
+
+} // namespace
+
+TEST(XzDecoder, RecognizesXz)
+{
+    EXPECT_TRUE(XzDecoder::is_xz(compressed));
+    EXPECT_FALSE(XzDecoder::is_xz(std::vector<uint8_t>(json.begin(), json.end())));
+    EXPECT_FALSE(XzDecoder::is_xz({}));
+}
+
+TEST(XzDecoder, DecompressesWholeFile)
+{
+    const auto decompressed = XzDecoder::decompress(compressed);
+    ASSERT_TRUE(decompressed);
+    EXPECT_EQ(as_string(*decompressed), json);
+}
+
+TEST(XzDecoder, DecompressesByteByByte)
+{
+    XzDecoder decoder;
+    std::vector<uint8_t> output;
+
+    for (std::size_t i = 0; i + 1 < compressed.size(); ++i) {
+        ASSERT_EQ(decoder.feed(&compressed[i], 1, output), XzDecoder::Result::NeedMore);
+    }
+    EXPECT_EQ(decoder.feed(&compressed.back(), 1, output), XzDecoder::Result::Done);
+    EXPECT_EQ(as_string(output), json);
+}
+
+TEST(XzDecoder, RejectsTruncatedAndCorrupt)
+{
+    auto truncated = compressed;
+    truncated.resize(truncated.size() - 10);
+    EXPECT_FALSE(XzDecoder::decompress(truncated));
+
+    auto corrupt = compressed;
+    corrupt[40] ^= 0xff;
+    EXPECT_FALSE(XzDecoder::decompress(corrupt));
+}
@@ -2,6 +2,7 @@
 #include "mavlink_request_message_handler.h"
 #include <algorithm>
 #include <string>
+#include <utility>
 #include <json/json.h>
 
 namespace mavsdk {
@@ -126,8 +127,9 @@ void ComponentInformationServerImpl::update_json_files_with_lock()
     // std::cout << "parameter: " << parameter_file << '\n';
     // std::cout << "meta: " << meta_file << '\n';
 
-    _parent->mavlink_ftp().write_tmp_file("general.json", meta_file);
-    _parent->mavlink_ftp().write_tmp_file("parameter.json", parameter_file);
+    // Served from memory, every ground station downloads them.
+    _parent->mavlink_ftp().register_memory_file("general.json", std::move(meta_file));
+    _parent->mavlink_ftp().register_memory_file("parameter.json", std::move(parameter_file));
 }
 
 std::string ComponentInformationServerImpl::generate_parameter_file()
@@ -30,14 +30,14 @@ void FailureImpl::enable()
         [this](MAVLinkParameters::Result result, int32_t value) {
             if (result == MAVLinkParameters::Result::Success) {
                 if (value == 1) {
-                    _enabled = EnabledState::Enabled;
+                    _enabled.set(EnabledState::Enabled);
                 } else if (value == 0) {
-                    _enabled = EnabledState::Disabled;
+                    _enabled.set(EnabledState::Disabled);
                 } else {
-                    _enabled = EnabledState::Unknown;
+                    _enabled.set(EnabledState::Unknown);
                 }
             } else {
-                _enabled = EnabledState::Unknown;
+                _enabled.set(EnabledState::Unknown);
             }
         },
         this);
@@ -46,11 +46,11 @@ void FailureImpl::enable()
         param_name,
         [this](int value) {
             if (value == 1) {
-                _enabled = EnabledState::Enabled;
+                _enabled.set(EnabledState::Enabled);
             } else if (value == 0) {
-                _enabled = EnabledState::Disabled;
+                _enabled.set(EnabledState::Disabled);
             } else {
-                _enabled = EnabledState::Unknown;
+                _enabled.set(EnabledState::Unknown);
             }
         },
         this);
@@ -58,18 +58,14 @@ void FailureImpl::enable()
 
 void FailureImpl::disable()
 {
-    _enabled = EnabledState::Init;
+    _enabled.reset();
 }
 
 Failure::Result FailureImpl::inject(
     Failure::FailureUnit failure_unit, Failure::FailureType failure_type, int32_t instance)
 {
-    while (_enabled == EnabledState::Init) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    }
-
     // If the param is unknown we ignore it and try anyway.
-    if (_enabled == EnabledState::Disabled) {
+    if (_enabled.wait() == EnabledState::Disabled) {
         return Failure::Result::Disabled;
     }
 
@@ -2,6 +2,7 @@
 
 #include "plugins/failure/failure.h"
 #include "plugin_impl_base.h"
+#include "ready_value.h"
 
 namespace mavsdk {
 
@@ -25,13 +26,13 @@ private:
     failure_result_from_command_result(MavlinkCommandSender::Result command_result);
 
     enum class EnabledState {
-        Init,
         Enabled,
         Disabled,
         Unknown,
     };
 
-    std::atomic<EnabledState> _enabled{EnabledState::Unknown};
+    // Not set while we wait for the param after enabling.
+    ReadyValue<EnabledState> _enabled{EnabledState::Unknown};
     static float failure_unit_to_mavlink_enum(const Failure::FailureUnit& failure_unit);
     static float failure_type_to_mavlink_enum(const Failure::FailureType& failure_type);
 };
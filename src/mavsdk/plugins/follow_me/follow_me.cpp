@@ -153,4 +153,9 @@ std::ostream& operator<<(std::ostream& str, FollowMe::Result const& result)
     }
 }
 
+FollowMe::Result FollowMe::set_rate_target_location(double rate_hz) const
+{
+    return _impl->set_rate_target_location(rate_hz);
+}
+
 } // namespace mavsdk
\ No newline at end of file
@@ -7,15 +7,11 @@ namespace mavsdk {
 
 FollowMeImpl::FollowMeImpl(System& system) : PluginImplBase(system)
 {
-    // (Lat, Lon, Alt) => double, (vx, vy, vz) => float
-    _last_location = _target_location = FollowMe::TargetLocation{};
     _parent->register_plugin(this);
 }
 
 FollowMeImpl::FollowMeImpl(std::shared_ptr<System> system) : PluginImplBase(std::move(system))
 {
-    // (Lat, Lon, Alt) => double, (vx, vy, vz) => float
-    _last_location = _target_location = FollowMe::TargetLocation{};
     _parent->register_plugin(this);
 }
 
@@ -24,6 +20,7 @@ FollowMeImpl::~FollowMeImpl()
     if (_target_location_cookie) {
         _parent->remove_call_every(_target_location_cookie);
     }
+    _parent->cancel_work(this);
     _parent->unregister_plugin(this);
 }
 
@@ -78,6 +75,7 @@ void FollowMeImpl::enable()
 
 void FollowMeImpl::disable()
 {
+    std::lock_guard<std::mutex> lock(_mutex);
     stop_sending_target_location();
 }
 
@@ -142,33 +140,23 @@ FollowMe::Result FollowMeImpl::set_config(const FollowMe::Config& config)
 
 FollowMe::Result FollowMeImpl::set_target_location(const FollowMe::TargetLocation& location)
 {
-    bool schedule_now = false;
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _target_location = location;
-        // We're interested only in lat, long.
-        _estimation_capabilities |= (1 << static_cast<int>(EstimationCapabilities::POS));
-
-        if (_mode != Mode::ACTIVE) {
-            return FollowMe::Result::NotActive;
-        }
-        // If set already, reschedule it.
-        if (_target_location_cookie) {
-            _parent->reset_call_every(_target_location_cookie);
-            // We also need to send it right now.
-            schedule_now = true;
+    std::atomic_store(
+        &_latest_target,
+        std::make_shared<const TargetSample>(
+            TargetSample{location, _time.elapsed_since_s(_start_time)}));
 
-        } else {
-            // Register now for sending now and in the next cycle.
-            _parent->add_call_every(
-                [this]() { send_target_location(); }, SENDER_RATE, &_target_location_cookie);
-        }
+    if (_mode != Mode::ACTIVE) {
+        return FollowMe::Result::NotActive;
     }
 
-    if (schedule_now) {
-        send_target_location();
+    if (!_sending_target_location) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        start_sending_target_location();
     }
 
+    // Sent from the work thread, as soon as the rate allows.
+    schedule_send_target_location();
+
     return FollowMe::Result::Success;
 }
 
@@ -178,9 +166,24 @@ FollowMe::TargetLocation FollowMeImpl::get_last_location() const
     return _last_location;
 }
 
-bool FollowMeImpl::is_active() const
+FollowMe::Result FollowMeImpl::set_rate_target_location(double rate_hz)
 {
+    if (!(rate_hz > 0.0 && rate_hz <= MAX_SENDER_RATE_HZ)) {
+        LogErr() << debug_str << "Err: Target location rate must be in range (0.0 to "
+                 << MAX_SENDER_RATE_HZ << " Hz]";
+        return FollowMe::Result::SetConfigFailed;
+    }
+
     std::lock_guard<std::mutex> lock(_mutex);
+    _sender_interval_s = 1.0 / rate_hz;
+    if (_target_location_cookie) {
+        _parent->change_call_every(static_cast<float>(_sender_interval_s), _target_location_cookie);
+    }
+    return FollowMe::Result::Success;
+}
+
+bool FollowMeImpl::is_active() const
+{
     return _mode == Mode::ACTIVE;
 }
 
@@ -191,11 +194,9 @@ FollowMe::Result FollowMeImpl::start()
 
     if (result == FollowMe::Result::Success) {
         // If location was set before, lets send it to vehicle
-        std::lock_guard<std::mutex> lock(
-            _mutex); // locking is not necessary here but lets do it for integrity
-        if (is_target_location_set()) {
-            _parent->add_call_every(
-                [this]() { send_target_location(); }, SENDER_RATE, &_target_location_cookie);
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (std::atomic_load(&_latest_target)) {
+            start_sending_target_location();
         }
     }
     return result;
@@ -255,11 +256,30 @@ FollowMe::Result FollowMeImpl::to_follow_me_result(MavlinkCommandSender::Result
     }
 }
 
-bool FollowMeImpl::is_target_location_set() const
+void FollowMeImpl::start_sending_target_location()
 {
-    // If the target's latitude is NAN, we assume that location is not set.
     // We assume that mutex was acquired by the caller
-    return std::isfinite(_target_location.latitude_deg);
+    if (!_target_location_cookie) {
+        // Between new locations the timer sends the extrapolated location.
+        _parent->add_call_every(
+            [this]() { schedule_send_target_location(); },
+            static_cast<float>(_sender_interval_s),
+            &_target_location_cookie);
+        _sending_target_location = true;
+    }
+}
+
+void FollowMeImpl::schedule_send_target_location()
+{
+    // One queued send is enough, it picks up the latest location.
+    if (!_send_queued.exchange(true)) {
+        _parent->queue_work(
+            [this]() {
+                _send_queued = false;
+                send_target_location();
+            },
+            this);
+    }
 }
 
 void FollowMeImpl::send_target_location()
@@ -269,25 +289,50 @@ void FollowMeImpl::send_target_location()
         return;
     }
 
-    dl_time_t now = _time.steady_time();
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const auto latest = std::atomic_load(&_latest_target);
+    if (!latest) {
+        return;
+    }
+    if (latest != _estimated_target) {
+        _estimator.add(latest->location, latest->time_s);
+        _estimated_target = latest;
+    }
+
+    const double now_s = _time.elapsed_since_s(_start_time);
+
+    // Locations coming in faster than the rate wait for the timer, which
+    // then sends the latest one. A bit of slack allows for timer jitter.
+    if (_last_send_time_s && now_s - _last_send_time_s.value() < 0.9 * _sender_interval_s) {
+        return;
+    }
+
+    const auto estimate = _estimator.estimate(now_s);
+    if (!std::isfinite(estimate.location.latitude_deg)) {
+        return;
+    }
+
     // needed by http://mavlink.org/messages/common#FOLLOW_TARGET
-    uint64_t elapsed_msec =
-        static_cast<uint64_t>(_time.elapsed_since_s(now) * 1000); // milliseconds
+    const auto elapsed_msec = static_cast<uint64_t>(now_s * 1000); // milliseconds
 
-    std::lock_guard<std::mutex> lock(_mutex);
-    //   LogDebug() << debug_str <<  "Lat: " << _target_location.latitude_deg << " Lon: " <<
-    //   _target_location.longitude_deg <<
-    //	" Alt: " << _target_location.absolute_altitude_m;
-    const int32_t lat_int = int32_t(std::round(_target_location.latitude_deg * 1e7));
-    const int32_t lon_int = int32_t(std::round(_target_location.longitude_deg * 1e7));
-    const float alt = static_cast<float>(_target_location.absolute_altitude_m);
+    uint8_t estimation_capabilities = 1 << static_cast<int>(EstimationCapabilities::POS);
+    if (estimate.has_velocity) {
+        estimation_capabilities |= 1 << static_cast<int>(EstimationCapabilities::VEL);
+    }
+    if (estimate.has_acceleration) {
+        estimation_capabilities |= 1 << static_cast<int>(EstimationCapabilities::ACCEL);
+    }
+
+    const int32_t lat_int = int32_t(std::round(estimate.location.latitude_deg * 1e7));
+    const int32_t lon_int = int32_t(std::round(estimate.location.longitude_deg * 1e7));
+    const float alt = estimate.location.absolute_altitude_m;
 
     const float pos_std_dev[] = {NAN, NAN, NAN};
     const float vel[] = {
-        static_cast<float>(_target_location.velocity_x_m_s),
-        static_cast<float>(_target_location.velocity_y_m_s),
-        static_cast<float>(_target_location.velocity_z_m_s)};
-    const float accel_unknown[] = {NAN, NAN, NAN};
+        estimate.location.velocity_x_m_s,
+        estimate.location.velocity_y_m_s,
+        estimate.location.velocity_z_m_s};
     const float attitude_q_unknown[] = {1.f, NAN, NAN, NAN};
     const float rates_unknown[] = {NAN, NAN, NAN};
     uint64_t custom_state = 0;
@@ -298,12 +343,12 @@ void FollowMeImpl::send_target_location()
         _parent->get_own_component_id(),
         &msg,
         elapsed_msec,
-        _estimation_capabilities,
+        estimation_capabilities,
         lat_int,
         lon_int,
         alt,
         vel,
-        accel_unknown,
+        estimate.acceleration_m_s2,
         attitude_q_unknown,
         rates_unknown,
         pos_std_dev,
@@ -312,7 +357,12 @@ void FollowMeImpl::send_target_location()
     if (!_parent->send_message(msg)) {
         LogErr() << debug_str << "send_target_location() failed..";
     } else {
-        _last_location = _target_location;
+        _last_location = estimate.location;
+        _last_send_time_s = now_s;
+        // Just sent, so the timer only needs to step in if nothing new comes.
+        if (_target_location_cookie) {
+            _parent->reset_call_every(_target_location_cookie);
+        }
     }
 }
 
@@ -323,6 +373,10 @@ void FollowMeImpl::stop_sending_target_location()
         _parent->remove_call_every(_target_location_cookie);
         _target_location_cookie = nullptr;
     }
+    _sending_target_location = false;
+    _last_send_time_s.reset();
+    _estimator.reset();
+    _estimated_target.reset();
     _mode = Mode::NOT_ACTIVE;
 }
 
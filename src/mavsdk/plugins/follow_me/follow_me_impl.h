@@ -1,5 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <optional>
+
+#include "follow_target_estimator.h"
 #include "log.h"
 #include "mavlink_include.h"
 #include "plugins/follow_me/follow_me.h"
@@ -27,6 +32,8 @@ public:
     FollowMe::Result set_target_location(const FollowMe::TargetLocation& location);
     FollowMe::TargetLocation get_last_location() const;
 
+    FollowMe::Result set_rate_target_location(double rate_hz);
+
     bool is_active() const;
 
     FollowMe::Result start();
@@ -44,13 +51,20 @@ private:
     bool is_config_ok(const FollowMe::Config& config) const;
     FollowMe::Result to_follow_me_result(MavlinkCommandSender::Result result) const;
 
-    bool is_target_location_set() const;
+    struct TargetSample {
+        FollowMe::TargetLocation location;
+        double time_s;
+    };
+
+    void start_sending_target_location();
+    void schedule_send_target_location();
     void send_target_location();
     void stop_sending_target_location();
 
-    enum class EstimationCapabilities { POS, VEL };
+    enum class EstimationCapabilities { POS, VEL, ACCEL };
 
-    enum class Mode { NOT_ACTIVE, ACTIVE } _mode = Mode::NOT_ACTIVE;
+    enum class Mode { NOT_ACTIVE, ACTIVE };
+    std::atomic<Mode> _mode{Mode::NOT_ACTIVE};
 
     enum class ConfigParameter {
         NONE = 0,
@@ -83,16 +97,25 @@ private:
         return config_val == static_cast<config_val_t>(cfgp);
     }
 
+    // The latest target location is handed over with std::atomic_load/store,
+    // so set_target_location() never waits for the sender.
+    std::shared_ptr<const TargetSample> _latest_target{};
+    std::atomic<bool> _sending_target_location{false};
+    std::atomic<bool> _send_queued{false};
+
     mutable std::mutex _mutex{};
-    FollowMe::TargetLocation _target_location{}; // sent to vehicle
     FollowMe::TargetLocation _last_location{}; // sent to vehicle
     void* _target_location_cookie = nullptr;
+    double _sender_interval_s{1.0};
+    std::optional<double> _last_send_time_s{};
+    FollowTargetEstimator _estimator{};
+    std::shared_ptr<const TargetSample> _estimated_target{};
 
     Time _time{};
-    uint8_t _estimation_capabilities = 0; // sent to vehicle
+    const dl_time_t _start_time{_time.steady_time()};
     FollowMe::Config _config{}; // has FollowMe configuration settings
 
-    const float SENDER_RATE = 1.0f; // send location updates once in a second
+    constexpr static const double MAX_SENDER_RATE_HZ = 50.0;
 
     std::string debug_str = "FollowMe: ";
 };
@@ -0,0 +1,165 @@
+#include "follow_target_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace mavsdk {
+
+void FollowTargetEstimator::add(const FollowMe::TargetLocation& location, double time_s)
+{
+    if (!std::isfinite(location.latitude_deg) || !std::isfinite(location.longitude_deg)) {
+        return;
+    }
+
+    if (!_reference) {
+        _reference.emplace(geometry::CoordinateTransformation::GlobalCoordinate{
+            location.latitude_deg, location.longitude_deg});
+    }
+
+    // Locations from the past or from a clock jump would break the fit.
+    if (!_samples.empty() && time_s <= _samples.back().time_s) {
+        _samples.clear();
+    }
+
+    const auto local =
+        _reference->local_from_global({location.latitude_deg, location.longitude_deg});
+    _samples.push_back(
+        Sample{time_s, {local.north_m, local.east_m, -double(location.absolute_altitude_m)}});
+
+    while (_samples.size() > MAX_SAMPLES ||
+           time_s - _samples.front().time_s > MAX_SAMPLE_AGE_S) {
+        _samples.pop_front();
+    }
+
+    _last_location = location;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        _fits[axis] = fit_axis(axis);
+    }
+}
+
+void FollowTargetEstimator::reset()
+{
+    _reference.reset();
+    _samples.clear();
+    _last_location = FollowMe::TargetLocation{};
+    for (auto& fit : _fits) {
+        fit = Fit{};
+    }
+}
+
+FollowTargetEstimator::Fit FollowTargetEstimator::fit_axis(std::size_t axis) const
+{
+    // Times relative to the newest location, so the fit gives the motion at
+    // that point directly.
+    const double newest_s = _samples.back().time_s;
+
+    double s[5]{}; // sums of t^0 .. t^4
+    double sp[3]{}; // sums of p * t^0 .. p * t^2
+    for (const auto& sample : _samples) {
+        const double p = sample.position_m[axis];
+        if (!std::isfinite(p)) {
+            continue;
+        }
+        const double t = sample.time_s - newest_s;
+        double t_k = 1.0;
+        for (std::size_t k = 0; k < 5; ++k) {
+            s[k] += t_k;
+            if (k < 3) {
+                sp[k] += p * t_k;
+            }
+            t_k *= t;
+        }
+    }
+
+    Fit fit{};
+    const double n = s[0];
+    if (n < 2.0) {
+        return fit;
+    }
+
+    if (n >= 3.0) {
+        // Normal equations of p = c0 + c1 * t + c2 * t^2, solved with Cramer's rule.
+        const double det = s[0] * (s[2] * s[4] - s[3] * s[3]) -
+                           s[1] * (s[1] * s[4] - s[3] * s[2]) +
+                           s[2] * (s[1] * s[3] - s[2] * s[2]);
+        if (std::abs(det) > 1e-12) {
+            const double det_c1 = s[0] * (sp[1] * s[4] - s[3] * sp[2]) -
+                                  sp[0] * (s[1] * s[4] - s[3] * s[2]) +
+                                  s[2] * (s[1] * sp[2] - sp[1] * s[2]);
+            const double det_c2 = s[0] * (s[2] * sp[2] - sp[1] * s[3]) -
+                                  s[1] * (s[1] * sp[2] - sp[1] * s[2]) +
+                                  sp[0] * (s[1] * s[3] - s[2] * s[2]);
+            fit.has_velocity = true;
+            fit.has_acceleration = true;
+            fit.velocity_m_s = det_c1 / det;
+            fit.acceleration_m_s2 = 2.0 * det_c2 / det;
+            return fit;
+        }
+    }
+
+    // Straight line through the locations instead.
+    const double denominator = n * s[2] - s[1] * s[1];
+    if (std::abs(denominator) > 1e-12) {
+        fit.has_velocity = true;
+        fit.velocity_m_s = (n * sp[1] - s[1] * sp[0]) / denominator;
+    }
+    return fit;
+}
+
+FollowTargetEstimator::Estimate FollowTargetEstimator::estimate(double time_s) const
+{
+    Estimate estimate{};
+    if (!_reference || _samples.empty()) {
+        return estimate;
+    }
+
+    const float given_velocity[3] = {
+        _last_location.velocity_x_m_s,
+        _last_location.velocity_y_m_s,
+        _last_location.velocity_z_m_s};
+    const bool velocity_given = std::all_of(
+        std::begin(given_velocity), std::end(given_velocity), [](float v) {
+            return std::isfinite(v);
+        });
+
+    estimate.has_velocity = velocity_given || (_fits[0].has_velocity && _fits[1].has_velocity);
+    estimate.has_acceleration = _fits[0].has_acceleration && _fits[1].has_acceleration;
+
+    const double dt = std::clamp(time_s - _samples.back().time_s, 0.0, MAX_EXTRAPOLATION_S);
+
+    double position[3];
+    float velocity[3];
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        const auto& fit = _fits[axis];
+        const double acceleration = fit.has_acceleration ? fit.acceleration_m_s2 : 0.0;
+        double start_velocity = 0.0;
+        if (velocity_given) {
+            start_velocity = given_velocity[axis];
+        } else if (fit.has_velocity) {
+            start_velocity = fit.velocity_m_s;
+        }
+
+        position[axis] = _samples.back().position_m[axis];
+        if (estimate.has_velocity) {
+            position[axis] += start_velocity * dt + 0.5 * acceleration * dt * dt;
+        }
+
+        velocity[axis] = estimate.has_velocity ?
+                             static_cast<float>(start_velocity + acceleration * dt) :
+                             NAN;
+        estimate.acceleration_m_s2[axis] =
+            fit.has_acceleration ? static_cast<float>(fit.acceleration_m_s2) : NAN;
+    }
+
+    const auto global = _reference->global_from_local({position[0], position[1]});
+    estimate.location.latitude_deg = global.latitude_deg;
+    estimate.location.longitude_deg = global.longitude_deg;
+    estimate.location.absolute_altitude_m = static_cast<float>(-position[2]);
+    estimate.location.velocity_x_m_s = velocity[0];
+    estimate.location.velocity_y_m_s = velocity[1];
+    estimate.location.velocity_z_m_s = velocity[2];
+    return estimate;
+}
+
+} // namespace mavsdk
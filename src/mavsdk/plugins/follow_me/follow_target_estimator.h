@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+
+#include "geometry.h"
+#include "plugins/follow_me/follow_me.h"
+
+namespace mavsdk {
+
+// Estimates the motion of the follow target from its recent locations.
+//
+// Velocity and acceleration come from a least squares fit of a parabola
+// (or a line while there are only two locations) through the last few
+// locations in a local NED frame, which smooths over the noise of a single
+// update. Velocities given with the location take precedence over the
+// estimated ones.
+class FollowTargetEstimator {
+public:
+    struct Estimate {
+        // Position extrapolated to the requested time, with the velocity.
+        FollowMe::TargetLocation location{};
+        float acceleration_m_s2[3]{NAN, NAN, NAN}; // north, east, down
+        bool has_velocity{false};
+        bool has_acceleration{false};
+    };
+
+    void add(const FollowMe::TargetLocation& location, double time_s);
+    void reset();
+
+    [[nodiscard]] bool has_location() const { return _reference.has_value(); }
+    [[nodiscard]] Estimate estimate(double time_s) const;
+
+private:
+    struct Sample {
+        double time_s;
+        double position_m[3]; // north, east, down
+    };
+
+    struct Fit {
+        bool has_velocity{false};
+        bool has_acceleration{false};
+        double velocity_m_s{0.0};
+        double acceleration_m_s2{0.0};
+    };
+
+    Fit fit_axis(std::size_t axis) const;
+
+    // Enough to smooth a bit, few enough to follow changes of direction.
+    static constexpr std::size_t MAX_SAMPLES = 5;
+    // Older locations don't say much about how the target moves now.
+    static constexpr double MAX_SAMPLE_AGE_S = 2.0;
+    // Beyond that the target is more likely to have stopped than not.
+    static constexpr double MAX_EXTRAPOLATION_S = 1.0;
+
+    std::optional<geometry::CoordinateTransformation> _reference{};
+    std::deque<Sample> _samples{};
+    FollowMe::TargetLocation _last_location{};
+
+    Fit _fits[3]{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,130 @@
+#include "follow_target_estimator.h"
+#include "geometry.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace mavsdk;
+
+static constexpr double REF_LAT = 47.397742;
+static constexpr double REF_LON = 8.545594;
+
+static FollowMe::TargetLocation location_at(double north_m, double east_m, float altitude_m)
+{
+    geometry::CoordinateTransformation ct({REF_LAT, REF_LON});
+    const auto global = ct.global_from_local({north_m, east_m});
+
+    FollowMe::TargetLocation location{};
+    location.latitude_deg = global.latitude_deg;
+    location.longitude_deg = global.longitude_deg;
+    location.absolute_altitude_m = altitude_m;
+    return location;
+}
+
+static geometry::CoordinateTransformation::LocalCoordinate
+local_of(const FollowMe::TargetLocation& location)
+{
+    geometry::CoordinateTransformation ct({REF_LAT, REF_LON});
+    return ct.local_from_global({location.latitude_deg, location.longitude_deg});
+}
+
+TEST(FollowTargetEstimator, NoLocation)
+{
+    FollowTargetEstimator estimator;
+    EXPECT_FALSE(estimator.has_location());
+
+    const auto estimate = estimator.estimate(1.0);
+    EXPECT_TRUE(std::isnan(estimate.location.latitude_deg));
+    EXPECT_FALSE(estimate.has_velocity);
+    EXPECT_FALSE(estimate.has_acceleration);
+}
+
+TEST(FollowTargetEstimator, SingleLocationIsNotExtrapolated)
+{
+    FollowTargetEstimator estimator;
+    estimator.add(location_at(10.0, 20.0, 500.0f), 1.0);
+
+    const auto estimate = estimator.estimate(1.5);
+    EXPECT_FALSE(estimate.has_velocity);
+    EXPECT_TRUE(std::isnan(estimate.location.velocity_x_m_s));
+
+    const auto local = local_of(estimate.location);
+    EXPECT_NEAR(local.north_m, 10.0, 1e-3);
+    EXPECT_NEAR(local.east_m, 20.0, 1e-3);
+    EXPECT_FLOAT_EQ(estimate.location.absolute_altitude_m, 500.0f);
+}
+
+TEST(FollowTargetEstimator, ConstantVelocity)
+{
+    FollowTargetEstimator estimator;
+    for (int i = 0; i < 5; ++i) {
+        const double t = 0.1 * i;
+        estimator.add(location_at(5.0 * t, -3.0 * t, 500.0f + 1.0f * float(t)), t);
+    }
+
+    const auto estimate = estimator.estimate(0.6);
+    EXPECT_TRUE(estimate.has_velocity);
+    EXPECT_NEAR(estimate.location.velocity_x_m_s, 5.0, 1e-2);
+    EXPECT_NEAR(estimate.location.velocity_y_m_s, -3.0, 1e-2);
+    EXPECT_NEAR(estimate.location.velocity_z_m_s, -1.0, 1e-2);
+    EXPECT_NEAR(estimate.acceleration_m_s2[0], 0.0, 1e-1);
+
+    // Extrapolated 0.2 s past the last location.
+    const auto local = local_of(estimate.location);
+    EXPECT_NEAR(local.north_m, 3.0, 1e-2);
+    EXPECT_NEAR(local.east_m, -1.8, 1e-2);
+    EXPECT_NEAR(estimate.location.absolute_altitude_m, 500.6f, 1e-2);
+}
+
+TEST(FollowTargetEstimator, ConstantAcceleration)
+{
+    FollowTargetEstimator estimator;
+    for (int i = 0; i < 5; ++i) {
+        const double t = 0.1 * i;
+        estimator.add(location_at(0.5 * 2.0 * t * t, 0.0, 500.0f), t);
+    }
+
+    const auto estimate = estimator.estimate(0.4);
+    EXPECT_TRUE(estimate.has_acceleration);
+    EXPECT_NEAR(estimate.acceleration_m_s2[0], 2.0, 1e-2);
+    EXPECT_NEAR(estimate.location.velocity_x_m_s, 0.8, 1e-2);
+}
+
+TEST(FollowTargetEstimator, GivenVelocityIsUsed)
+{
+    FollowTargetEstimator estimator;
+    estimator.add(location_at(0.0, 0.0, 500.0f), 0.0);
+
+    auto location = location_at(1.0, 0.0, 500.0f);
+    location.velocity_x_m_s = 2.0f;
+    location.velocity_y_m_s = 0.0f;
+    location.velocity_z_m_s = 0.0f;
+    estimator.add(location, 1.0);
+
+    const auto estimate = estimator.estimate(1.5);
+    EXPECT_TRUE(estimate.has_velocity);
+    EXPECT_FLOAT_EQ(estimate.location.velocity_x_m_s, 2.0f);
+    EXPECT_NEAR(local_of(estimate.location).north_m, 2.0, 1e-2);
+}
+
+TEST(FollowTargetEstimator, ExtrapolationIsLimited)
+{
+    FollowTargetEstimator estimator;
+    estimator.add(location_at(0.0, 0.0, 500.0f), 0.0);
+    estimator.add(location_at(1.0, 0.0, 500.0f), 1.0);
+
+    // Not further than a second past the last location.
+    const auto estimate = estimator.estimate(10.0);
+    EXPECT_NEAR(local_of(estimate.location).north_m, 2.0, 1e-2);
+}
+
+TEST(FollowTargetEstimator, Reset)
+{
+    FollowTargetEstimator estimator;
+    estimator.add(location_at(0.0, 0.0, 500.0f), 0.0);
+    estimator.add(location_at(1.0, 0.0, 500.0f), 1.0);
+    estimator.reset();
+
+    EXPECT_FALSE(estimator.has_location());
+    EXPECT_FALSE(estimator.estimate(1.0).has_velocity);
+}
@@ -224,6 +224,20 @@ public:
      */
     Result stop() const;
 
+    /**
+     * @brief Set the rate at which the target location is sent to the vehicle.
+     *
+     * New locations are sent as they come in, but not faster than this rate,
+     * and between them the location is extrapolated from the motion of the
+     * target. Set it to the rate of the target's position sensor for the
+     * smoothest following. The default is 1 Hz, the maximum 50 Hz.
+     *
+     * This function is non-blocking.
+     *
+     * @return Result of request.
+     */
+    Result set_rate_target_location(double rate_hz) const;
+
     /**
      * @brief Copy constructor.
      */
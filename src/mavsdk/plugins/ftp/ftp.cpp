@@ -162,4 +162,40 @@ std::ostream& operator<<(std::ostream& str, Ftp::Result const& result)
     }
 }
 
+void Ftp::sync_directory_async(
+    std::string remote_dir, std::string local_dir, const SyncDirectoryCallback callback)
+{
+    _impl->sync_directory_async(remote_dir, local_dir, callback);
+}
+
+std::pair<Ftp::Result, Ftp::SyncDirectoryData>
+Ftp::sync_directory(std::string remote_dir, std::string local_dir) const
+{
+    return _impl->sync_directory(remote_dir, local_dir);
+}
+
+bool operator==(const Ftp::SyncDirectoryData& lhs, const Ftp::SyncDirectoryData& rhs)
+{
+    return (rhs.files_found == lhs.files_found) && (rhs.files_checked == lhs.files_checked) &&
+           (rhs.files_downloaded == lhs.files_downloaded) &&
+           (rhs.bytes_downloaded == lhs.bytes_downloaded);
+}
+
+std::ostream& operator<<(std::ostream& str, Ftp::SyncDirectoryData const& sync_directory_data)
+{
+    str << std::setprecision(15);
+    str << "sync_directory_data:" << '\n' << "{\n";
+    str << "    files_found: " << sync_directory_data.files_found << '\n';
+    str << "    files_checked: " << sync_directory_data.files_checked << '\n';
+    str << "    files_downloaded: " << sync_directory_data.files_downloaded << '\n';
+    str << "    bytes_downloaded: " << sync_directory_data.bytes_downloaded << '\n';
+    str << '}';
+    return str;
+}
+
+void Ftp::download_stream_async(std::string remote_file_path, DownloadStreamCallback callback)
+{
+    _impl->download_stream_async(remote_file_path, callback);
+}
+
 } // namespace mavsdk
\ No newline at end of file
@@ -1,4 +1,6 @@
+#include <cstdlib>
 #include <functional>
+#include <future>
 #include <iostream>
 
 #if defined(WINDOWS)
@@ -67,6 +69,22 @@ void FtpImpl::download_async(
         });
 }
 
+void FtpImpl::download_stream_async(
+    const std::string& remote_path, Ftp::DownloadStreamCallback callback)
+{
+    _parent->mavlink_ftp().download_stream_async(
+        remote_path,
+        [callback, this](
+            MavlinkFtp::ClientResult result,
+            MavlinkFtp::ProgressData progress_data,
+            const std::vector<uint8_t>& data) {
+            callback(
+                result_from_mavlink_ftp_result(result),
+                progress_data_from_mavlink_ftp_progress_data(progress_data),
+                data);
+        });
+}
+
 void FtpImpl::upload_async(
     const std::string& local_file_path,
     const std::string& remote_folder,
@@ -175,6 +193,205 @@ Ftp::Result FtpImpl::set_root_directory(const std::string& root_dir)
     return result_from_mavlink_ftp_result(_parent->mavlink_ftp().set_root_directory(root_dir));
 }
 
+static std::string join_remote_path(const std::string& dir, const std::string& name)
+{
+    if (!dir.empty() && dir.back() == '/') {
+        return dir + name;
+    }
+    return dir + "/" + name;
+}
+
+void FtpImpl::sync_directory_async(
+    const std::string& remote_dir,
+    const std::string& local_dir,
+    Ftp::SyncDirectoryCallback callback)
+{
+    if (!fs_exists(local_dir) && !fs_create_directory(local_dir)) {
+        _parent->call_user_callback([callback]() {
+            callback(Ftp::Result::FileIoError, Ftp::SyncDirectoryData{});
+        });
+        return;
+    }
+
+    auto sync = std::make_shared<DirectorySync>();
+    sync->callback = callback;
+    sync->pending.push_back(SyncTask{SyncTask::Kind::ListDirectory, remote_dir, local_dir});
+    sync_start_tasks(sync);
+}
+
+std::pair<Ftp::Result, Ftp::SyncDirectoryData>
+FtpImpl::sync_directory(const std::string& remote_dir, const std::string& local_dir)
+{
+    std::promise<std::pair<Ftp::Result, Ftp::SyncDirectoryData>> prom;
+    auto fut = prom.get_future();
+
+    sync_directory_async(
+        remote_dir, local_dir, [&prom](Ftp::Result result, Ftp::SyncDirectoryData data) {
+            if (result != Ftp::Result::Next) {
+                prom.set_value(std::make_pair(result, data));
+            }
+        });
+
+    return fut.get();
+}
+
+void FtpImpl::sync_start_tasks(const std::shared_ptr<DirectorySync>& sync)
+{
+    // The tasks are started without holding the lock because MavlinkFtp
+    // might call back right away, e.g. if it's busy.
+    std::vector<SyncTask> tasks;
+    {
+        std::lock_guard<std::mutex> lock(sync->mutex);
+        while (sync->active < max_parallel_sync_tasks && !sync->pending.empty()) {
+            tasks.push_back(std::move(sync->pending.front()));
+            sync->pending.pop_front();
+            ++sync->active;
+        }
+    }
+
+    for (const auto& task : tasks) {
+        if (task.kind == SyncTask::Kind::ListDirectory) {
+            sync_list_directory(sync, task);
+        } else {
+            sync_file(sync, task);
+        }
+    }
+}
+
+void FtpImpl::sync_list_directory(
+    const std::shared_ptr<DirectorySync>& sync, const SyncTask& task)
+{
+    // Not recursive, as the local directories are created as they are found.
+    _parent->mavlink_ftp().list_directory_tree_async(
+        task.remote_path,
+        [this, sync, task](
+            MavlinkFtp::ClientResult result, std::vector<MavlinkFtp::DirectoryEntry> entries) {
+            if (result != MavlinkFtp::ClientResult::Success) {
+                LogWarn() << "Could not list " << task.remote_path << ": " << result;
+                sync_task_done(sync, result_from_mavlink_ftp_result(result), false, false, 0);
+                return;
+            }
+
+            Ftp::Result list_result = Ftp::Result::Success;
+            std::vector<SyncTask> found;
+            for (const auto& entry : entries) {
+                const auto& name = entry.path;
+                if (!entry.is_directory) {
+                    found.push_back(SyncTask{
+                        SyncTask::Kind::File,
+                        join_remote_path(task.remote_path, name),
+                        task.local_dir,
+                        entry.size_bytes});
+
+                } else {
+                    const auto local_dir = task.local_dir + path_separator + name;
+                    if (!fs_exists(local_dir) && !fs_create_directory(local_dir)) {
+                        LogWarn() << "Could not create " << local_dir;
+                        list_result = Ftp::Result::FileIoError;
+                        continue;
+                    }
+                    found.push_back(SyncTask{
+                        SyncTask::Kind::ListDirectory,
+                        join_remote_path(task.remote_path, name),
+                        local_dir});
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(sync->mutex);
+                for (auto& found_task : found) {
+                    if (found_task.kind == SyncTask::Kind::File) {
+                        ++sync->data.files_found;
+                    }
+                    sync->pending.push_back(std::move(found_task));
+                }
+            }
+            sync_task_done(sync, list_result, false, false, 0);
+        },
+        false);
+}
+
+void FtpImpl::sync_file(const std::shared_ptr<DirectorySync>& sync, const SyncTask& task)
+{
+    const auto local_path = task.local_dir + path_separator + fs_filename(task.remote_path);
+
+    // A different size is enough to tell that it changed, only files of the
+    // same size are compared by CRC32.
+    if (!fs_exists(local_path) || fs_file_size(local_path) != task.size) {
+        sync_download(sync, task);
+        return;
+    }
+
+    _parent->mavlink_ftp().are_files_identical_async(
+        local_path,
+        task.remote_path,
+        [this, sync, task](MavlinkFtp::ClientResult result, bool identical) {
+            if (result != MavlinkFtp::ClientResult::Success) {
+                LogWarn() << "Could not compare " << task.remote_path << ": " << result;
+                sync_task_done(sync, result_from_mavlink_ftp_result(result), true, false, 0);
+            } else if (identical) {
+                sync_task_done(sync, Ftp::Result::Success, true, false, 0);
+            } else {
+                sync_download(sync, task);
+            }
+        });
+}
+
+void FtpImpl::sync_download(const std::shared_ptr<DirectorySync>& sync, const SyncTask& task)
+{
+    _parent->mavlink_ftp().download_async(
+        task.remote_path,
+        task.local_dir,
+        [this, sync, task](MavlinkFtp::ClientResult result, MavlinkFtp::ProgressData) {
+            if (result == MavlinkFtp::ClientResult::Next) {
+                return;
+            }
+            if (result != MavlinkFtp::ClientResult::Success) {
+                LogWarn() << "Could not download " << task.remote_path << ": " << result;
+                sync_task_done(sync, result_from_mavlink_ftp_result(result), true, false, 0);
+                return;
+            }
+            sync_task_done(sync, Ftp::Result::Success, true, true, task.size);
+        });
+}
+
+void FtpImpl::sync_task_done(
+    const std::shared_ptr<DirectorySync>& sync,
+    Ftp::Result result,
+    bool file_checked,
+    bool downloaded,
+    uint64_t bytes_downloaded)
+{
+    bool finished = false;
+    Ftp::Result final_result;
+    Ftp::SyncDirectoryData data;
+    {
+        std::lock_guard<std::mutex> lock(sync->mutex);
+        --sync->active;
+        if (file_checked) {
+            ++sync->data.files_checked;
+        }
+        if (downloaded) {
+            ++sync->data.files_downloaded;
+            sync->data.bytes_downloaded += bytes_downloaded;
+        }
+        if (result != Ftp::Result::Success && sync->result == Ftp::Result::Success) {
+            sync->result = result;
+        }
+        finished = sync->active == 0 && sync->pending.empty();
+        final_result = sync->result;
+        data = sync->data;
+    }
+
+    if (finished) {
+        sync->callback(final_result, data);
+        return;
+    }
+
+    sync->callback(Ftp::Result::Next, data);
+    sync_start_tasks(sync);
+}
+
 void FtpImpl::set_retries(uint32_t retries)
 {
     _parent->mavlink_ftp().set_retries(retries);
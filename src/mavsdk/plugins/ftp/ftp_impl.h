@@ -1,6 +1,8 @@
 #pragma once
 
+#include <deque>
 #include <fstream>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -46,6 +48,8 @@ public:
         const std::string& remote_file_path,
         const std::string& local_folder,
         Ftp::DownloadCallback callback);
+    void download_stream_async(
+        const std::string& remote_file_path, Ftp::DownloadStreamCallback callback);
     void upload_async(
         const std::string& local_file_path,
         const std::string& remote_folder,
@@ -61,6 +65,12 @@ public:
         const std::string& local_path,
         const std::string& remote_path,
         Ftp::AreFilesIdenticalCallback callback);
+    void sync_directory_async(
+        const std::string& remote_dir,
+        const std::string& local_dir,
+        Ftp::SyncDirectoryCallback callback);
+    std::pair<Ftp::Result, Ftp::SyncDirectoryData>
+    sync_directory(const std::string& remote_dir, const std::string& local_dir);
 
     void set_retries(uint32_t retries);
     Ftp::Result set_root_directory(const std::string& root_dir);
@@ -68,6 +78,36 @@ public:
     Ftp::Result set_target_compid(uint8_t component_id);
 
 private:
+    struct SyncTask {
+        enum class Kind { ListDirectory, File } kind;
+        std::string remote_path;
+        std::string local_dir;
+        uint32_t size{0}; ///< Remote file size, only for files
+    };
+
+    struct DirectorySync {
+        std::mutex mutex{};
+        Ftp::SyncDirectoryCallback callback{};
+        std::deque<SyncTask> pending{};
+        unsigned active{0};
+        Ftp::SyncDirectoryData data{};
+        Ftp::Result result{Ftp::Result::Success}; ///< First error, if any
+    };
+
+    // Each of these is its own FTP session, they run in parallel up to this many.
+    static constexpr unsigned max_parallel_sync_tasks = 4;
+
+    void sync_start_tasks(const std::shared_ptr<DirectorySync>& sync);
+    void sync_list_directory(const std::shared_ptr<DirectorySync>& sync, const SyncTask& task);
+    void sync_file(const std::shared_ptr<DirectorySync>& sync, const SyncTask& task);
+    void sync_download(const std::shared_ptr<DirectorySync>& sync, const SyncTask& task);
+    void sync_task_done(
+        const std::shared_ptr<DirectorySync>& sync,
+        Ftp::Result result,
+        bool file_checked,
+        bool downloaded,
+        uint64_t bytes_downloaded);
+
     Ftp::Result result_from_mavlink_ftp_result(MavlinkFtp::ClientResult result);
     Ftp::ProgressData
     progress_data_from_mavlink_ftp_progress_data(MavlinkFtp::ProgressData progress_data);
@@ -104,6 +104,31 @@ public:
      */
     friend std::ostream& operator<<(std::ostream& str, Ftp::Result const& result);
 
+    /**
+     * @brief Progress of a directory sync.
+     */
+    struct SyncDirectoryData {
+        uint32_t files_found{}; /**< @brief The number of remote files found so far. */
+        uint32_t files_checked{}; /**< @brief The number of files compared or downloaded. */
+        uint32_t files_downloaded{}; /**< @brief The number of new or changed files downloaded. */
+        uint64_t bytes_downloaded{}; /**< @brief The number of bytes downloaded. */
+    };
+
+    /**
+     * @brief Equal operator to compare two `Ftp::SyncDirectoryData` objects.
+     *
+     * @return `true` if items are equal.
+     */
+    friend bool operator==(const Ftp::SyncDirectoryData& lhs, const Ftp::SyncDirectoryData& rhs);
+
+    /**
+     * @brief Stream operator to print information about a `Ftp::SyncDirectoryData`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream&
+    operator<<(std::ostream& str, Ftp::SyncDirectoryData const& sync_directory_data);
+
     /**
      * @brief Callback type for asynchronous Ftp calls.
      */
@@ -277,6 +302,46 @@ public:
      */
     uint32_t get_our_compid() const;
 
+    /**
+     * @brief Callback type for sync_directory_async.
+     */
+    using SyncDirectoryCallback = std::function<void(Result, SyncDirectoryData)>;
+
+    /**
+     * @brief Mirrors a remote directory, including subdirectories, into a local directory.
+     *
+     * Only files which are missing locally, or differ in size or CRC32, are downloaded.
+     * Several files are transferred at the same time. Progress is reported with `Result::Next`.
+     *
+     * This function is non-blocking. See 'sync_directory' for the blocking counterpart.
+     */
+    void sync_directory_async(
+        std::string remote_dir, std::string local_dir, const SyncDirectoryCallback callback);
+
+    /**
+     * @brief Mirrors a remote directory, including subdirectories, into a local directory.
+     *
+     * This function is blocking. See 'sync_directory_async' for the non-blocking counterpart.
+     *
+     * @return Result of request.
+     */
+    std::pair<Result, SyncDirectoryData>
+    sync_directory(std::string remote_dir, std::string local_dir) const;
+
+    /**
+     * @brief Callback type for download_stream_async.
+     */
+    using DownloadStreamCallback =
+        std::function<void(Result, ProgressData, const std::vector<uint8_t>&)>;
+
+    /**
+     * @brief Downloads a file and hands it on in chunks instead of storing it.
+     *
+     * The chunks come in order with `Result::Next`, the final result with an empty chunk.
+     * Reading from the vehicle pauses while the callback falls behind.
+     */
+    void download_stream_async(std::string remote_file_path, DownloadStreamCallback callback);
+
     /**
      * @brief Copy constructor.
      */
@@ -113,4 +113,28 @@ std::ostream& operator<<(std::ostream& str, Geofence::Result const& result)
     }
 }
 
+Geofence::FenceCheck Geofence::check_position(Point point) const
+{
+    return _impl->check_position(point);
+}
+
+void Geofence::subscribe_breach(double approach_distance_m, BreachCallback callback)
+{
+    _impl->subscribe_breach(approach_distance_m, callback);
+}
+
+std::ostream& operator<<(std::ostream& str, Geofence::BreachState const& breach_state)
+{
+    switch (breach_state) {
+        case Geofence::BreachState::Clear:
+            return str << "Clear";
+        case Geofence::BreachState::Approaching:
+            return str << "Approaching";
+        case Geofence::BreachState::Breached:
+            return str << "Breached";
+        default:
+            return str << "Unknown";
+    }
+}
+
 } // namespace mavsdk
\ No newline at end of file
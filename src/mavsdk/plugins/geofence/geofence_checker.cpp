@@ -0,0 +1,316 @@
+#include "geofence_checker.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mavsdk {
+
+// Enough cells for a few edges per cell, without the grid getting huge for
+// fences with long thin polygons.
+static constexpr double CELLS_PER_EDGE = 4.0;
+static constexpr std::size_t MAX_CELLS = 1 << 20;
+
+GeofenceChecker::GeofenceChecker(const std::vector<Geofence::Polygon>& polygons)
+{
+    for (const auto& polygon : polygons) {
+        if (polygon.points.size() < 3) {
+            LogWarn() << "Ignoring geofence polygon with less than 3 points";
+            continue;
+        }
+
+        if (!_projection) {
+            _projection.emplace(geometry::CoordinateTransformation::GlobalCoordinate{
+                polygon.points[0].latitude_deg, polygon.points[0].longitude_deg});
+        }
+
+        std::vector<Vec> points;
+        points.reserve(polygon.points.size());
+        for (const auto& point : polygon.points) {
+            const auto local =
+                _projection->local_from_global({point.latitude_deg, point.longitude_deg});
+            points.push_back(Vec{local.east_m, local.north_m});
+        }
+
+        add_region(points, polygon.fence_type);
+    }
+
+    build_grid();
+}
+
+void GeofenceChecker::add_region(
+    const std::vector<Vec>& points, Geofence::Polygon::FenceType fence_type)
+{
+    Region region;
+    region.fence_type = fence_type;
+    region.min = points[0];
+    region.max = points[0];
+
+    const auto first_edge = static_cast<uint32_t>(_edges.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        const auto& a = points[i];
+        const auto& b = points[(i + 1) % points.size()];
+        _edges.push_back(Edge{a, b});
+
+        region.min = Vec{std::min(region.min.x, a.x), std::min(region.min.y, a.y)};
+        region.max = Vec{std::max(region.max.x, a.x), std::max(region.max.y, a.y)};
+        region.ys.push_back(a.y);
+    }
+    const auto end_edge = static_cast<uint32_t>(_edges.size());
+
+    std::sort(region.ys.begin(), region.ys.end());
+    region.ys.erase(std::unique(region.ys.begin(), region.ys.end()), region.ys.end());
+
+    // Horizontal edges never span a slab, so they are left out, which is
+    // what counting crossings needs anyway.
+    region.slabs.resize(region.ys.size() - 1);
+    for (std::size_t i = 0; i + 1 < region.ys.size(); ++i) {
+        const double bottom = region.ys[i];
+        const double top = region.ys[i + 1];
+        const double middle = (bottom + top) / 2.0;
+
+        auto& slab_edges = region.slabs[i].edges;
+        for (uint32_t e = first_edge; e < end_edge; ++e) {
+            const auto& edge = _edges[e];
+            if (std::min(edge.a.y, edge.b.y) <= bottom && std::max(edge.a.y, edge.b.y) >= top) {
+                slab_edges.push_back(e);
+            }
+        }
+
+        std::sort(slab_edges.begin(), slab_edges.end(), [&](uint32_t lhs, uint32_t rhs) {
+            return x_at(_edges[lhs], middle) < x_at(_edges[rhs], middle);
+        });
+    }
+
+    if (fence_type == Geofence::Polygon::FenceType::Inclusion) {
+        _has_inclusion = true;
+    }
+    _regions.push_back(std::move(region));
+}
+
+void GeofenceChecker::build_grid()
+{
+    if (_regions.empty()) {
+        return;
+    }
+
+    Vec max = _regions[0].max;
+    _grid_min = _regions[0].min;
+    for (const auto& region : _regions) {
+        _grid_min = Vec{std::min(_grid_min.x, region.min.x), std::min(_grid_min.y, region.min.y)};
+        max = Vec{std::max(max.x, region.max.x), std::max(max.y, region.max.y)};
+    }
+
+    const double width = max.x - _grid_min.x;
+    const double height = max.y - _grid_min.y;
+    const double cells_per_side =
+        std::ceil(std::sqrt(CELLS_PER_EDGE * static_cast<double>(_edges.size())));
+    _cell_size_m = std::max(1.0, std::max(width, height) / cells_per_side);
+
+    _columns = static_cast<std::size_t>(width / _cell_size_m) + 1;
+    _rows = static_cast<std::size_t>(height / _cell_size_m) + 1;
+    while (_columns * _rows > MAX_CELLS) {
+        _cell_size_m *= 2.0;
+        _columns = static_cast<std::size_t>(width / _cell_size_m) + 1;
+        _rows = static_cast<std::size_t>(height / _cell_size_m) + 1;
+    }
+    _cells.resize(_columns * _rows);
+
+    const auto column_of = [this](double x) {
+        const auto column =
+            static_cast<std::size_t>(std::max(0.0, (x - _grid_min.x) / _cell_size_m));
+        return std::min(_columns - 1, column);
+    };
+    const auto row_of = [this](double y) {
+        const auto row = static_cast<std::size_t>(std::max(0.0, (y - _grid_min.y) / _cell_size_m));
+        return std::min(_rows - 1, row);
+    };
+
+    // Everything goes into all the cells its bounding box touches.
+    for (uint32_t e = 0; e < _edges.size(); ++e) {
+        const auto& edge = _edges[e];
+        for (auto row = row_of(std::min(edge.a.y, edge.b.y));
+             row <= row_of(std::max(edge.a.y, edge.b.y));
+             ++row) {
+            for (auto column = column_of(std::min(edge.a.x, edge.b.x));
+                 column <= column_of(std::max(edge.a.x, edge.b.x));
+                 ++column) {
+                _cells[cell_index(column, row)].edges.push_back(e);
+            }
+        }
+    }
+
+    for (uint32_t r = 0; r < _regions.size(); ++r) {
+        const auto& region = _regions[r];
+        for (auto row = row_of(region.min.y); row <= row_of(region.max.y); ++row) {
+            for (auto column = column_of(region.min.x); column <= column_of(region.max.x);
+                 ++column) {
+                _cells[cell_index(column, row)].regions.push_back(r);
+            }
+        }
+    }
+}
+
+Geofence::FenceCheck GeofenceChecker::check(const Geofence::Point& point) const
+{
+    Geofence::FenceCheck result{};
+    if (_regions.empty()) {
+        return result;
+    }
+
+    const auto local = _projection->local_from_global({point.latitude_deg, point.longitude_deg});
+    const Vec p{local.east_m, local.north_m};
+
+    bool inside_inclusion = false;
+    bool inside_exclusion = false;
+
+    const double column = std::floor((p.x - _grid_min.x) / _cell_size_m);
+    const double row = std::floor((p.y - _grid_min.y) / _cell_size_m);
+
+    // Outside of the grid is outside of all polygons.
+    if (column >= 0.0 && row >= 0.0 && column < static_cast<double>(_columns) &&
+        row < static_cast<double>(_rows)) {
+        const auto& cell =
+            _cells[cell_index(static_cast<std::size_t>(column), static_cast<std::size_t>(row))];
+        for (const auto r : cell.regions) {
+            const auto& region = _regions[r];
+            if (!contains(region, p)) {
+                continue;
+            }
+            if (region.fence_type == Geofence::Polygon::FenceType::Inclusion) {
+                inside_inclusion = true;
+            } else {
+                inside_exclusion = true;
+            }
+        }
+    }
+
+    result.is_breached = inside_exclusion || (_has_inclusion && !inside_inclusion);
+    result.distance_to_boundary_m = distance_to_boundary(p);
+    return result;
+}
+
+bool GeofenceChecker::contains(const Region& region, const Vec& point) const
+{
+    if (point.x < region.min.x || point.x > region.max.x || point.y < region.min.y ||
+        point.y >= region.max.y) {
+        return false;
+    }
+
+    const auto above = std::upper_bound(region.ys.begin(), region.ys.end(), point.y);
+    if (above == region.ys.begin() || above == region.ys.end()) {
+        return false;
+    }
+    const auto& slab = region.slabs[std::distance(region.ys.begin(), above) - 1];
+
+    // The edges in a slab don't cross, so they stay sorted at any height in it.
+    const auto crossings = std::partition_point(
+        slab.edges.begin(), slab.edges.end(), [&](uint32_t e) {
+            return x_at(_edges[e], point.y) < point.x;
+        });
+
+    return (std::distance(slab.edges.begin(), crossings) % 2) == 1;
+}
+
+double GeofenceChecker::distance_to_boundary(const Vec& point) const
+{
+    const auto clamp_index = [](double index, std::size_t size) {
+        return static_cast<long>(std::min(std::max(index, 0.0), static_cast<double>(size - 1)));
+    };
+    const long center_column =
+        clamp_index(std::floor((point.x - _grid_min.x) / _cell_size_m), _columns);
+    const long center_row = clamp_index(std::floor((point.y - _grid_min.y) / _cell_size_m), _rows);
+
+    const auto columns = static_cast<long>(_columns);
+    const auto rows = static_cast<long>(_rows);
+
+    double best = std::numeric_limits<double>::infinity();
+
+    const auto visit = [&](long column, long row) {
+        if (column < 0 || row < 0 || column >= columns || row >= rows) {
+            return;
+        }
+        const auto& cell =
+            _cells[cell_index(static_cast<std::size_t>(column), static_cast<std::size_t>(row))];
+        for (const auto e : cell.edges) {
+            best = std::min(best, distance(_edges[e], point));
+        }
+    };
+
+    // Look at rings of cells around the point until nothing outside of them
+    // can be closer than what was found.
+    for (long ring = 0;; ++ring) {
+        for (long column = center_column - ring; column <= center_column + ring; ++column) {
+            visit(column, center_row - ring);
+            if (ring > 0) {
+                visit(column, center_row + ring);
+            }
+        }
+        for (long row = center_row - ring + 1; row <= center_row + ring - 1; ++row) {
+            visit(center_column - ring, row);
+            visit(center_column + ring, row);
+        }
+
+        const bool left_done = center_column - ring <= 0;
+        const bool right_done = center_column + ring >= columns - 1;
+        const bool bottom_done = center_row - ring <= 0;
+        const bool top_done = center_row + ring >= rows - 1;
+        if (left_done && right_done && bottom_done && top_done) {
+            break;
+        }
+
+        // The closest cell not looked at yet, sides with nothing beyond don't count.
+        const double left = _grid_min.x + static_cast<double>(center_column - ring) * _cell_size_m;
+        const double right =
+            _grid_min.x + static_cast<double>(center_column + ring + 1) * _cell_size_m;
+        const double bottom = _grid_min.y + static_cast<double>(center_row - ring) * _cell_size_m;
+        const double top = _grid_min.y + static_cast<double>(center_row + ring + 1) * _cell_size_m;
+
+        double bound = std::numeric_limits<double>::infinity();
+        if (!left_done) {
+            bound = std::min(bound, std::max(0.0, point.x - left));
+        }
+        if (!right_done) {
+            bound = std::min(bound, std::max(0.0, right - point.x));
+        }
+        if (!bottom_done) {
+            bound = std::min(bound, std::max(0.0, point.y - bottom));
+        }
+        if (!top_done) {
+            bound = std::min(bound, std::max(0.0, top - point.y));
+        }
+
+        if (best <= bound) {
+            break;
+        }
+    }
+
+    return best;
+}
+
+double GeofenceChecker::x_at(const Edge& edge, double y)
+{
+    if (edge.a.y == edge.b.y) {
+        return std::min(edge.a.x, edge.b.x);
+    }
+    const double t = (y - edge.a.y) / (edge.b.y - edge.a.y);
+    return edge.a.x + t * (edge.b.x - edge.a.x);
+}
+
+double GeofenceChecker::distance(const Edge& edge, const Vec& point)
+{
+    const double dx = edge.b.x - edge.a.x;
+    const double dy = edge.b.y - edge.a.y;
+    const double length_squared = dx * dx + dy * dy;
+
+    double t = 0.0;
+    if (length_squared > 0.0) {
+        t = ((point.x - edge.a.x) * dx + (point.y - edge.a.y) * dy) / length_squared;
+        t = std::min(1.0, std::max(0.0, t));
+    }
+
+    return std::hypot(point.x - (edge.a.x + t * dx), point.y - (edge.a.y + t * dy));
+}
+
+} // namespace mavsdk
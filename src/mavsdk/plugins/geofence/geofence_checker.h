@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "geometry.h"
+#include "plugins/geofence/geofence.h"
+
+namespace mavsdk {
+
+// Checks positions against geofence polygons locally.
+//
+// The polygons are projected to a plane around their first point and
+// prepared once. Each polygon is cut into horizontal slabs at its vertices,
+// within which its edges don't cross and can be kept sorted, so that whether
+// a point is inside takes two binary searches. The edges of all polygons are
+// also put into a grid, so the closest one is found by only looking at the
+// cells around the point.
+//
+// Polygons are expected to be simple, i.e. not to intersect themselves.
+class GeofenceChecker {
+public:
+    explicit GeofenceChecker(const std::vector<Geofence::Polygon>& polygons);
+    ~GeofenceChecker() = default;
+
+    [[nodiscard]] Geofence::FenceCheck check(const Geofence::Point& point) const;
+
+    // Non-copyable
+    GeofenceChecker(const GeofenceChecker&) = delete;
+    const GeofenceChecker& operator=(const GeofenceChecker&) = delete;
+
+private:
+    struct Vec {
+        double x; // east
+        double y; // north
+    };
+
+    struct Edge {
+        Vec a;
+        Vec b;
+    };
+
+    struct Slab {
+        // Indices into _edges, sorted from west to east.
+        std::vector<uint32_t> edges{};
+    };
+
+    struct Region {
+        Geofence::Polygon::FenceType fence_type{};
+        Vec min{};
+        Vec max{};
+        // Slab i is between ys[i] and ys[i + 1].
+        std::vector<double> ys{};
+        std::vector<Slab> slabs{};
+    };
+
+    struct Cell {
+        std::vector<uint32_t> edges{};
+        std::vector<uint32_t> regions{};
+    };
+
+    void add_region(const std::vector<Vec>& points, Geofence::Polygon::FenceType fence_type);
+    void build_grid();
+
+    [[nodiscard]] bool contains(const Region& region, const Vec& point) const;
+    [[nodiscard]] double distance_to_boundary(const Vec& point) const;
+
+    [[nodiscard]] std::size_t cell_index(std::size_t column, std::size_t row) const
+    {
+        return row * _columns + column;
+    }
+
+    static double x_at(const Edge& edge, double y);
+    static double distance(const Edge& edge, const Vec& point);
+
+    std::optional<geometry::CoordinateTransformation> _projection{};
+
+    std::vector<Edge> _edges{};
+    std::vector<Region> _regions{};
+    bool _has_inclusion{false};
+
+    Vec _grid_min{};
+    double _cell_size_m{1.0};
+    std::size_t _columns{0};
+    std::size_t _rows{0};
+    std::vector<Cell> _cells{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,139 @@
+#include "geofence_checker.h"
+#include "geometry.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace mavsdk;
+
+static constexpr double REF_LAT = 47.397742;
+static constexpr double REF_LON = 8.545594;
+
+// Polygon from local offsets in meters around the reference.
+static Geofence::Polygon
+polygon_from_local(const std::vector<std::pair<double, double>>& north_east, bool inclusion)
+{
+    geometry::CoordinateTransformation ct({REF_LAT, REF_LON});
+
+    Geofence::Polygon polygon;
+    polygon.fence_type = inclusion ? Geofence::Polygon::FenceType::Inclusion :
+                                     Geofence::Polygon::FenceType::Exclusion;
+    for (const auto& offset : north_east) {
+        const auto global = ct.global_from_local({offset.first, offset.second});
+        polygon.points.push_back(Geofence::Point{global.latitude_deg, global.longitude_deg});
+    }
+    return polygon;
+}
+
+static Geofence::Point point_from_local(double north_m, double east_m)
+{
+    geometry::CoordinateTransformation ct({REF_LAT, REF_LON});
+    const auto global = ct.global_from_local({north_m, east_m});
+    return Geofence::Point{global.latitude_deg, global.longitude_deg};
+}
+
+TEST(GeofenceChecker, NoPolygons)
+{
+    GeofenceChecker checker({});
+    const auto result = checker.check(point_from_local(0.0, 0.0));
+    EXPECT_FALSE(result.is_breached);
+    EXPECT_TRUE(std::isnan(result.distance_to_boundary_m));
+}
+
+TEST(GeofenceChecker, Inclusion)
+{
+    GeofenceChecker checker(
+        {polygon_from_local({{0.0, 0.0}, {100.0, 0.0}, {100.0, 100.0}, {0.0, 100.0}}, true)});
+
+    auto result = checker.check(point_from_local(50.0, 40.0));
+    EXPECT_FALSE(result.is_breached);
+    EXPECT_NEAR(result.distance_to_boundary_m, 40.0, 0.1);
+
+    result = checker.check(point_from_local(150.0, 50.0));
+    EXPECT_TRUE(result.is_breached);
+    EXPECT_NEAR(result.distance_to_boundary_m, 50.0, 0.1);
+
+    result = checker.check(point_from_local(-30.0, -40.0));
+    EXPECT_TRUE(result.is_breached);
+    EXPECT_NEAR(result.distance_to_boundary_m, 50.0, 0.1);
+}
+
+TEST(GeofenceChecker, ExclusionInsideInclusion)
+{
+    GeofenceChecker checker(
+        {polygon_from_local({{0.0, 0.0}, {100.0, 0.0}, {100.0, 100.0}, {0.0, 100.0}}, true),
+         polygon_from_local({{40.0, 40.0}, {60.0, 40.0}, {60.0, 60.0}, {40.0, 60.0}}, false)});
+
+    EXPECT_TRUE(checker.check(point_from_local(50.0, 50.0)).is_breached);
+    EXPECT_FALSE(checker.check(point_from_local(20.0, 50.0)).is_breached);
+    EXPECT_NEAR(checker.check(point_from_local(30.0, 50.0)).distance_to_boundary_m, 10.0, 0.1);
+}
+
+TEST(GeofenceChecker, OnlyExclusion)
+{
+    GeofenceChecker checker(
+        {polygon_from_local({{0.0, 0.0}, {10.0, 0.0}, {10.0, 10.0}, {0.0, 10.0}}, false)});
+
+    EXPECT_TRUE(checker.check(point_from_local(5.0, 5.0)).is_breached);
+    EXPECT_FALSE(checker.check(point_from_local(50.0, 50.0)).is_breached);
+}
+
+TEST(GeofenceChecker, Concave)
+{
+    // A "U" opening to the north.
+    GeofenceChecker checker({polygon_from_local(
+        {{0.0, 0.0},
+         {100.0, 0.0},
+         {100.0, 30.0},
+         {20.0, 30.0},
+         {20.0, 70.0},
+         {100.0, 70.0},
+         {100.0, 100.0},
+         {0.0, 100.0}},
+        true)});
+
+    EXPECT_FALSE(checker.check(point_from_local(50.0, 15.0)).is_breached);
+    EXPECT_FALSE(checker.check(point_from_local(50.0, 85.0)).is_breached);
+    EXPECT_FALSE(checker.check(point_from_local(10.0, 50.0)).is_breached);
+    EXPECT_TRUE(checker.check(point_from_local(50.0, 50.0)).is_breached);
+    EXPECT_NEAR(checker.check(point_from_local(50.0, 50.0)).distance_to_boundary_m, 20.0, 0.1);
+}
+
+TEST(GeofenceChecker, DistanceMatchesBruteForce)
+{
+    // A star shaped polygon with many edges of varying length.
+    std::vector<std::pair<double, double>> points;
+    const int num_points = 200;
+    for (int i = 0; i < num_points; ++i) {
+        const double angle = 2.0 * M_PI * i / num_points;
+        const double radius = (i % 2 == 0) ? 500.0 : 200.0 + 10.0 * (i % 7);
+        points.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+    }
+    GeofenceChecker checker({polygon_from_local(points, true)});
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(-700.0, 700.0);
+
+    for (int i = 0; i < 500; ++i) {
+        const double north = distribution(generator);
+        const double east = distribution(generator);
+
+        double expected = std::numeric_limits<double>::infinity();
+        for (std::size_t j = 0; j < points.size(); ++j) {
+            const auto& a = points[j];
+            const auto& b = points[(j + 1) % points.size()];
+            const double dn = b.first - a.first;
+            const double de = b.second - a.second;
+            double t = ((north - a.first) * dn + (east - a.second) * de) / (dn * dn + de * de);
+            t = std::min(1.0, std::max(0.0, t));
+            expected =
+                std::min(expected, std::hypot(north - a.first - t * dn, east - a.second - t * de));
+        }
+
+        // The projection round trip costs a little precision.
+        EXPECT_NEAR(
+            checker.check(point_from_local(north, east)).distance_to_boundary_m, expected, 0.05);
+    }
+}
@@ -19,9 +19,15 @@ GeofenceImpl::~GeofenceImpl()
     _parent->unregister_plugin(this);
 }
 
-void GeofenceImpl::init() {}
+void GeofenceImpl::init()
+{
+    register_mavlink_message_handler<&GeofenceImpl::process_global_position_int>();
+}
 
-void GeofenceImpl::deinit() {}
+void GeofenceImpl::deinit()
+{
+    _parent->unregister_all_mavlink_message_handlers(this);
+}
 
 void GeofenceImpl::enable() {}
 
@@ -43,9 +49,17 @@ void GeofenceImpl::upload_geofence_async(
     // later in the MAVLinkMissionTransfer constructor.
     const auto items = assemble_items(polygons);
 
+    // Prepared now, so it matches what is uploaded, and only used once the upload succeeded.
+    auto checker = std::make_shared<const GeofenceChecker>(polygons);
+
     _parent->mission_transfer().upload_items_async(
-        MAV_MISSION_TYPE_FENCE, items, [this, callback](MAVLinkMissionTransfer::Result result) {
+        MAV_MISSION_TYPE_FENCE,
+        items,
+        [this, callback, checker](MAVLinkMissionTransfer::Result result) {
             auto converted_result = convert_result(result);
+            if (converted_result == Geofence::Result::Success) {
+                set_checker(checker);
+            }
             _parent->call_user_callback(
                 [callback, converted_result]() { callback(converted_result); });
         });
@@ -65,6 +79,9 @@ void GeofenceImpl::clear_geofence_async(const Geofence::ResultCallback& callback
     _parent->mission_transfer().clear_items_async(
         MAV_MISSION_TYPE_FENCE, [this, callback](MAVLinkMissionTransfer::Result result) {
             auto converted_result = convert_result(result);
+            if (converted_result == Geofence::Result::Success) {
+                set_checker(nullptr);
+            }
             _parent->call_user_callback([callback, converted_result]() {
                 if (callback) {
                     callback(converted_result);
@@ -73,6 +90,79 @@ void GeofenceImpl::clear_geofence_async(const Geofence::ResultCallback& callback
         });
 }
 
+Geofence::FenceCheck GeofenceImpl::check_position(Geofence::Point point) const
+{
+    std::shared_ptr<const GeofenceChecker> checker;
+    {
+        std::lock_guard<std::mutex> lock(_checker_mutex);
+        checker = _checker;
+    }
+
+    if (!checker) {
+        return Geofence::FenceCheck{};
+    }
+    return checker->check(point);
+}
+
+void GeofenceImpl::subscribe_breach(double approach_distance_m, Geofence::BreachCallback callback)
+{
+    std::lock_guard<std::mutex> lock(_breach.mutex);
+    _breach.approach_distance_m = approach_distance_m;
+    _breach.callback = std::move(callback);
+    _breach.last_state.reset();
+}
+
+void GeofenceImpl::set_checker(std::shared_ptr<const GeofenceChecker> checker)
+{
+    {
+        std::lock_guard<std::mutex> lock(_checker_mutex);
+        _checker = std::move(checker);
+    }
+
+    // A new fence is reported from scratch.
+    std::lock_guard<std::mutex> lock(_breach.mutex);
+    _breach.last_state.reset();
+}
+
+void GeofenceImpl::process_global_position_int(
+    const mavlink_global_position_int_t& global_position_int)
+{
+    std::shared_ptr<const GeofenceChecker> checker;
+    {
+        std::lock_guard<std::mutex> lock(_checker_mutex);
+        checker = _checker;
+    }
+
+    if (!checker) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_breach.mutex);
+    if (!_breach.callback) {
+        return;
+    }
+
+    const auto check = checker->check(Geofence::Point{
+        global_position_int.lat * 1e-7, global_position_int.lon * 1e-7});
+
+    Geofence::BreachState state;
+    if (check.is_breached) {
+        state = Geofence::BreachState::Breached;
+    } else if (check.distance_to_boundary_m < _breach.approach_distance_m) {
+        state = Geofence::BreachState::Approaching;
+    } else {
+        state = Geofence::BreachState::Clear;
+    }
+
+    if (_breach.last_state && _breach.last_state.value() == state) {
+        return;
+    }
+    _breach.last_state = state;
+
+    const auto temp_callback = _breach.callback;
+    _parent->call_user_callback([temp_callback, state, check]() { temp_callback(state, check); });
+}
+
 std::vector<MAVLinkMissionTransfer::ItemInt>
 GeofenceImpl::assemble_items(const std::vector<Geofence::Polygon>& polygons)
 {
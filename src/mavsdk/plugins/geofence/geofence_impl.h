@@ -3,9 +3,12 @@
 #include <memory>
 #include <map>
 #include <atomic>
+#include <mutex>
+#include <optional>
 
 #include "mavlink_include.h"
 #include "plugins/geofence/geofence.h"
+#include "geofence_checker.h"
 #include "plugin_impl_base.h"
 #include "system.h"
 
@@ -32,6 +35,10 @@ public:
 
     void clear_geofence_async(const Geofence::ResultCallback& callback);
 
+    Geofence::FenceCheck check_position(Geofence::Point point) const;
+
+    void subscribe_breach(double approach_distance_m, Geofence::BreachCallback callback);
+
     // Non-copyable
     GeofenceImpl(const GeofenceImpl&) = delete;
     const GeofenceImpl& operator=(const GeofenceImpl&) = delete;
@@ -41,6 +48,21 @@ private:
     assemble_items(const std::vector<Geofence::Polygon>& polygons);
 
     static Geofence::Result convert_result(MAVLinkMissionTransfer::Result result);
+
+    void process_global_position_int(const mavlink_global_position_int_t& global_position_int);
+
+    void set_checker(std::shared_ptr<const GeofenceChecker> checker);
+
+    // The checker for the fence last uploaded, or nothing if none is on the vehicle.
+    mutable std::mutex _checker_mutex{};
+    std::shared_ptr<const GeofenceChecker> _checker{};
+
+    struct {
+        std::mutex mutex{};
+        double approach_distance_m{0.0};
+        Geofence::BreachCallback callback{nullptr};
+        std::optional<Geofence::BreachState> last_state{};
+    } _breach{};
 };
 
 } // namespace mavsdk
@@ -137,6 +137,34 @@ public:
      */
     friend std::ostream& operator<<(std::ostream& str, Geofence::Result const& result);
 
+    /**
+     * @brief Where a position is with respect to the geofence.
+     */
+    struct FenceCheck {
+        bool is_breached{false}; /**< @brief Outside of all inclusion polygons (if there are
+                                    any) or inside an exclusion polygon. */
+        double distance_to_boundary_m{
+            std::numeric_limits<double>::quiet_NaN()}; /**< @brief Horizontal distance to the
+                                                          closest polygon edge, NaN without
+                                                          geofence. */
+    };
+
+    /**
+     * @brief Breach states reported by subscribe_breach.
+     */
+    enum class BreachState {
+        Clear, /**< @brief Further away from the boundary than the approach distance. */
+        Approaching, /**< @brief Closer to the boundary than the approach distance. */
+        Breached, /**< @brief Outside of the allowed area. */
+    };
+
+    /**
+     * @brief Stream operator to print information about a `Geofence::BreachState`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream& operator<<(std::ostream& str, Geofence::BreachState const& breach_state);
+
     /**
      * @brief Callback type for asynchronous Geofence calls.
      */
@@ -180,6 +208,33 @@ public:
      */
     Result clear_geofence() const;
 
+    /**
+     * @brief Check a position against the geofence last uploaded, without asking the vehicle.
+     *
+     * The polygons are prepared when they are uploaded so that this is cheap enough to be done
+     * for the positions of many vehicles at telemetry rate.
+     *
+     * @param point The position to check, e.g. of another vehicle.
+     * @return Where the position is with respect to the geofence.
+     */
+    FenceCheck check_position(Point point) const;
+
+    /**
+     * @brief Callback type for subscribe_breach.
+     */
+    using BreachCallback = std::function<void(BreachState, FenceCheck)>;
+
+    /**
+     * @brief Subscribe to changes of the vehicle's position with respect to the geofence.
+     *
+     * Each position the vehicle reports is checked against the geofence last uploaded, and the
+     * callback is called whenever the breach state changes.
+     *
+     * @param approach_distance_m Distance to the boundary below which the vehicle is approaching.
+     * @param callback Callback to call, nullptr to unsubscribe.
+     */
+    void subscribe_breach(double approach_distance_m, BreachCallback callback);
+
     /**
      * @brief Copy constructor.
      */
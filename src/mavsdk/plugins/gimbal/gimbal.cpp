@@ -162,4 +162,25 @@ std::ostream& operator<<(std::ostream& str, Gimbal::ControlMode const& control_m
     }
 }
 
+Gimbal::Result
+Gimbal::stream_pitch_rate_and_yaw_rate(float pitch_rate_deg_s, float yaw_rate_deg_s) const
+{
+    return _impl->stream_pitch_rate_and_yaw_rate(pitch_rate_deg_s, yaw_rate_deg_s);
+}
+
+Gimbal::Result Gimbal::set_setpoint_stream_rate(double rate_hz) const
+{
+    return _impl->set_setpoint_stream_rate(rate_hz);
+}
+
+Gimbal::Result Gimbal::stop_setpoint_stream() const
+{
+    return _impl->stop_setpoint_stream();
+}
+
+void Gimbal::subscribe_control(ControlCallback callback, const SubscriptionOptions& options)
+{
+    _impl->subscribe_control(callback, options);
+}
+
 } // namespace mavsdk
\ No newline at end of file
@@ -1,10 +1,8 @@
 #include "gimbal_impl.h"
 #include "gimbal_protocol_v1.h"
 #include "gimbal_protocol_v2.h"
-#include <chrono>
 #include <cmath>
 #include <functional>
-#include <thread>
 
 namespace mavsdk {
 
@@ -29,14 +27,42 @@ void GimbalImpl::init()
         MAVLINK_MSG_ID_GIMBAL_MANAGER_INFORMATION,
         [this](const mavlink_message_t& message) { process_gimbal_manager_information(message); },
         this);
+
+    // The protocol is detected on connect, along with what the other plugins request.
+    _parent->add_connect_step(
+        "gimbal protocol",
+        [this](ConnectPipeline::Done done) { detect_protocol(std::move(done)); },
+        this);
 }
 
-void GimbalImpl::deinit() {}
+void GimbalImpl::deinit()
+{
+    _parent->remove_connect_steps(this);
+    stop_setpoint_stream();
+}
 
-void GimbalImpl::enable()
+void GimbalImpl::enable() {}
+
+void GimbalImpl::detect_protocol(ConnectPipeline::Done done)
 {
-    _parent->register_timeout_handler(
-        [this]() { receive_protocol_timeout(); }, 1.0, &_protocol_cookie);
+    std::optional<GimbalManager> detected;
+    {
+        std::lock_guard<std::mutex> lock(_protocol.mutex);
+        _protocol.connect_done = std::move(done);
+        detected = _protocol.detected;
+        if (!detected) {
+            _parent->register_timeout_handler(
+                [this]() { receive_protocol_timeout(); }, 1.0, &_protocol.cookie);
+        }
+    }
+
+    if (detected) {
+        LogDebug() << "Using Gimbal Version 2 of component " << static_cast<int>(detected->compid)
+                   << " found before";
+        set_protocol(std::make_unique<GimbalProtocolV2>(
+            *_parent, detected->information, detected->sysid, detected->compid));
+        return;
+    }
 
     MavlinkCommandSender::CommandLong command{};
     command.command = MAV_CMD_REQUEST_MESSAGE;
@@ -47,16 +73,34 @@ void GimbalImpl::enable()
 
 void GimbalImpl::disable()
 {
-    _gimbal_protocol.reset(nullptr);
+    void* cookie;
+    {
+        std::lock_guard<std::mutex> lock(_protocol.mutex);
+        cookie = _protocol.cookie;
+        _protocol.cookie = nullptr;
+        _protocol.gimbal_protocol.reset(nullptr);
+        _protocol.connect_done = nullptr;
+    }
+    if (cookie != nullptr) {
+        _parent->unregister_timeout_handler(cookie);
+    }
 }
 
 void GimbalImpl::receive_protocol_timeout()
 {
+    {
+        std::lock_guard<std::mutex> lock(_protocol.mutex);
+        if (_protocol.cookie == nullptr) {
+            // Version 2 was discovered in the meantime.
+            return;
+        }
+        _protocol.cookie = nullptr;
+    }
+
     // We did not receive a GIMBAL_MANAGER_INFORMATION in time, so we have to
     // assume Version2 is not available.
     LogDebug() << "Falling back to Gimbal Version 1";
-    _gimbal_protocol.reset(new GimbalProtocolV1(*_parent));
-    _protocol_cookie = nullptr;
+    set_protocol(std::make_unique<GimbalProtocolV1>(*_parent));
 }
 
 void GimbalImpl::process_gimbal_manager_information(const mavlink_message_t& message)
@@ -64,121 +108,241 @@ void GimbalImpl::process_gimbal_manager_information(const mavlink_message_t& mes
     mavlink_gimbal_manager_information_t gimbal_manager_information;
     mavlink_msg_gimbal_manager_information_decode(&message, &gimbal_manager_information);
 
-    if (_protocol_cookie != nullptr) {
-        LogDebug() << "Using Gimbal Version 2 as gimbal manager information for gimbal device "
-                   << static_cast<int>(gimbal_manager_information.gimbal_device_id)
-                   << " was discovered";
+    void* cookie;
+    {
+        std::lock_guard<std::mutex> lock(_protocol.mutex);
+        cookie = _protocol.cookie;
+        if (cookie == nullptr) {
+            return;
+        }
+        _protocol.cookie = nullptr;
+        _protocol.detected =
+            GimbalManager{gimbal_manager_information, message.sysid, message.compid};
+    }
+
+    LogDebug() << "Using Gimbal Version 2 as gimbal manager information for gimbal device "
+               << static_cast<int>(gimbal_manager_information.gimbal_device_id)
+               << " was discovered";
 
-        _parent->unregister_timeout_handler(_protocol_cookie);
-        _protocol_cookie = nullptr;
-        _gimbal_protocol.reset(new GimbalProtocolV2(
-            *_parent, gimbal_manager_information, message.sysid, message.compid));
+    _parent->unregister_timeout_handler(cookie);
+    set_protocol(std::make_unique<GimbalProtocolV2>(
+        *_parent, gimbal_manager_information, message.sysid, message.compid));
+}
+
+void GimbalImpl::set_protocol(std::unique_ptr<GimbalProtocolBase> gimbal_protocol)
+{
+    ConnectPipeline::Done done;
+
+    // The queued calls are run before the protocol is made available so that
+    // calls made meanwhile can't overtake them.
+    while (true) {
+        std::vector<std::function<void(GimbalProtocolBase&)>> pending;
+        {
+            std::lock_guard<std::mutex> lock(_protocol.mutex);
+            if (_protocol.pending.empty()) {
+                _protocol.gimbal_protocol = std::move(gimbal_protocol);
+                done = std::move(_protocol.connect_done);
+                _protocol.connect_done = nullptr;
+                break;
+            }
+            pending.swap(_protocol.pending);
+        }
+
+        for (auto& call : pending) {
+            call(*gimbal_protocol);
+        }
+    }
+    _protocol.cv.notify_all();
+
+    if (done) {
+        done(true);
     }
 }
 
 Gimbal::Result GimbalImpl::set_pitch_and_yaw(float pitch_deg, float yaw_deg)
 {
-    wait_for_protocol();
-
-    return _gimbal_protocol->set_pitch_and_yaw(pitch_deg, yaw_deg);
+    return wait_for_protocol().set_pitch_and_yaw(pitch_deg, yaw_deg);
 }
 
 void GimbalImpl::set_pitch_and_yaw_async(
     float pitch_deg, float yaw_deg, Gimbal::ResultCallback callback)
 {
-    wait_for_protocol_async(
-        [=]() { _gimbal_protocol->set_pitch_and_yaw_async(pitch_deg, yaw_deg, callback); });
+    wait_for_protocol_async([=](GimbalProtocolBase& protocol) {
+        protocol.set_pitch_and_yaw_async(pitch_deg, yaw_deg, callback);
+    });
 }
 
 Gimbal::Result GimbalImpl::set_pitch_rate_and_yaw_rate(float pitch_rate_deg_s, float yaw_rate_deg_s)
 {
-    wait_for_protocol();
-
-    return _gimbal_protocol->set_pitch_rate_and_yaw_rate(pitch_rate_deg_s, yaw_rate_deg_s);
+    return wait_for_protocol().set_pitch_rate_and_yaw_rate(pitch_rate_deg_s, yaw_rate_deg_s);
 }
 
 void GimbalImpl::set_pitch_rate_and_yaw_rate_async(
     float pitch_rate_deg_s, float yaw_rate_deg_s, Gimbal::ResultCallback callback)
 {
-    wait_for_protocol_async([=]() {
-        _gimbal_protocol->set_pitch_rate_and_yaw_rate_async(
-            pitch_rate_deg_s, yaw_rate_deg_s, callback);
+    wait_for_protocol_async([=](GimbalProtocolBase& protocol) {
+        protocol.set_pitch_rate_and_yaw_rate_async(pitch_rate_deg_s, yaw_rate_deg_s, callback);
     });
 }
 
+Gimbal::Result
+GimbalImpl::stream_pitch_rate_and_yaw_rate(float pitch_rate_deg_s, float yaw_rate_deg_s)
+{
+    {
+        std::lock_guard<std::mutex> lock(_stream.mutex);
+        _stream.pitch_rate_deg_s = pitch_rate_deg_s;
+        _stream.yaw_rate_deg_s = yaw_rate_deg_s;
+
+        // While streaming, the latest rates are picked up by the next periodic send.
+        if (_stream.active) {
+            return Gimbal::Result::Success;
+        }
+        _stream.active = true;
+        _parent->add_call_every(
+            [this]() { send_stream_setpoint(); },
+            static_cast<float>(1.0 / _stream.rate_hz),
+            &_stream.cookie);
+    }
+
+    // Send the first one right away to reduce latency.
+    const auto result = send_stream_setpoint();
+    if (result == Gimbal::Result::Unsupported) {
+        stop_setpoint_stream();
+    }
+    return result;
+}
+
+Gimbal::Result GimbalImpl::set_setpoint_stream_rate(double rate_hz)
+{
+    if (!(rate_hz > 0.0)) {
+        LogErr() << "Invalid gimbal setpoint stream rate: " << rate_hz;
+        return Gimbal::Result::Error;
+    }
+
+    std::lock_guard<std::mutex> lock(_stream.mutex);
+    _stream.rate_hz = rate_hz;
+    if (_stream.active) {
+        _parent->change_call_every(static_cast<float>(1.0 / rate_hz), _stream.cookie);
+    }
+    return Gimbal::Result::Success;
+}
+
+Gimbal::Result GimbalImpl::stop_setpoint_stream()
+{
+    void* cookie;
+    {
+        std::lock_guard<std::mutex> lock(_stream.mutex);
+        if (!_stream.active) {
+            return Gimbal::Result::Success;
+        }
+        _stream.active = false;
+        cookie = _stream.cookie;
+        _stream.cookie = nullptr;
+    }
+    _parent->remove_call_every(cookie);
+    return Gimbal::Result::Success;
+}
+
+Gimbal::Result GimbalImpl::send_stream_setpoint()
+{
+    float pitch_rate_deg_s;
+    float yaw_rate_deg_s;
+    {
+        std::lock_guard<std::mutex> lock(_stream.mutex);
+        pitch_rate_deg_s = _stream.pitch_rate_deg_s;
+        yaw_rate_deg_s = _stream.yaw_rate_deg_s;
+    }
+
+    // This must not wait for the protocol detection. Until then there is no
+    // way to send the setpoints anyway.
+    std::lock_guard<std::mutex> lock(_protocol.mutex);
+    if (_protocol.gimbal_protocol == nullptr) {
+        return Gimbal::Result::Success;
+    }
+    return _protocol.gimbal_protocol->set_pitch_rate_and_yaw_rate(pitch_rate_deg_s, yaw_rate_deg_s);
+}
+
 Gimbal::Result GimbalImpl::set_mode(const Gimbal::GimbalMode gimbal_mode)
 {
-    wait_for_protocol();
-    return _gimbal_protocol->set_mode(gimbal_mode);
+    return wait_for_protocol().set_mode(gimbal_mode);
 }
 
 void GimbalImpl::set_mode_async(
     const Gimbal::GimbalMode gimbal_mode, Gimbal::ResultCallback callback)
 {
-    wait_for_protocol_async([=]() { _gimbal_protocol->set_mode_async(gimbal_mode, callback); });
+    wait_for_protocol_async([=](GimbalProtocolBase& protocol) {
+        protocol.set_mode_async(gimbal_mode, callback);
+    });
 }
 
 Gimbal::Result
 GimbalImpl::set_roi_location(double latitude_deg, double longitude_deg, float altitude_m)
 {
-    wait_for_protocol();
-    return _gimbal_protocol->set_roi_location(latitude_deg, longitude_deg, altitude_m);
+    return wait_for_protocol().set_roi_location(latitude_deg, longitude_deg, altitude_m);
 }
 
 void GimbalImpl::set_roi_location_async(
     double latitude_deg, double longitude_deg, float altitude_m, Gimbal::ResultCallback callback)
 {
-    wait_for_protocol_async([=]() {
-        _gimbal_protocol->set_roi_location_async(latitude_deg, longitude_deg, altitude_m, callback);
+    wait_for_protocol_async([=](GimbalProtocolBase& protocol) {
+        protocol.set_roi_location_async(latitude_deg, longitude_deg, altitude_m, callback);
     });
 }
 
 Gimbal::Result GimbalImpl::take_control(Gimbal::ControlMode control_mode)
 {
-    wait_for_protocol();
-    return _gimbal_protocol->take_control(control_mode);
+    return wait_for_protocol().take_control(control_mode);
 }
 
 void GimbalImpl::take_control_async(
     Gimbal::ControlMode control_mode, Gimbal::ResultCallback callback)
 {
     wait_for_protocol_async(
-        [=]() { _gimbal_protocol->take_control_async(control_mode, callback); });
+        [=](GimbalProtocolBase& protocol) { protocol.take_control_async(control_mode, callback); });
 }
 
 Gimbal::Result GimbalImpl::release_control()
 {
-    wait_for_protocol();
-    return _gimbal_protocol->release_control();
+    return wait_for_protocol().release_control();
 }
 
 void GimbalImpl::release_control_async(Gimbal::ResultCallback callback)
 {
-    wait_for_protocol_async([=]() { _gimbal_protocol->release_control_async(callback); });
+    wait_for_protocol_async(
+        [=](GimbalProtocolBase& protocol) { protocol.release_control_async(callback); });
 }
 
 Gimbal::ControlStatus GimbalImpl::control()
 {
-    wait_for_protocol();
-    return _gimbal_protocol->control();
+    return wait_for_protocol().control();
 }
 
-void GimbalImpl::subscribe_control(Gimbal::ControlCallback callback)
+void GimbalImpl::subscribe_control(
+    Gimbal::ControlCallback callback, const SubscriptionOptions& options)
 {
-    wait_for_protocol_async([=]() { _gimbal_protocol->control_async(callback); });
+    wait_for_protocol_async(
+        [=](GimbalProtocolBase& protocol) { protocol.control_async(callback, options); });
 }
 
-void GimbalImpl::wait_for_protocol()
+GimbalProtocolBase& GimbalImpl::wait_for_protocol()
 {
-    while (_gimbal_protocol == nullptr) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
+    std::unique_lock<std::mutex> lock(_protocol.mutex);
+    _protocol.cv.wait(lock, [this]() { return _protocol.gimbal_protocol != nullptr; });
+    return *_protocol.gimbal_protocol;
 }
 
-void GimbalImpl::wait_for_protocol_async(std::function<void()> callback)
+void GimbalImpl::wait_for_protocol_async(std::function<void(GimbalProtocolBase&)> callback)
 {
-    wait_for_protocol();
-    callback();
+    GimbalProtocolBase* protocol;
+    {
+        std::lock_guard<std::mutex> lock(_protocol.mutex);
+        protocol = _protocol.gimbal_protocol.get();
+        if (protocol == nullptr) {
+            _protocol.pending.push_back(std::move(callback));
+            return;
+        }
+    }
+    callback(*protocol);
 }
 
 void GimbalImpl::receive_command_result(
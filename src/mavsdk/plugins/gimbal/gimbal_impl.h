@@ -4,6 +4,12 @@
 #include "gimbal_protocol_base.h"
 #include "plugin_impl_base.h"
 #include "system.h"
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 namespace mavsdk {
 
@@ -27,6 +33,10 @@ public:
     void set_pitch_rate_and_yaw_rate_async(
         float pitch_rate_deg_s, float yaw_rate_deg_s, Gimbal::ResultCallback callback);
 
+    Gimbal::Result stream_pitch_rate_and_yaw_rate(float pitch_rate_deg_s, float yaw_rate_deg_s);
+    Gimbal::Result set_setpoint_stream_rate(double rate_hz);
+    Gimbal::Result stop_setpoint_stream();
+
     Gimbal::Result set_mode(const Gimbal::GimbalMode gimbal_mode);
     void set_mode_async(const Gimbal::GimbalMode gimbal_mode, Gimbal::ResultCallback callback);
 
@@ -44,7 +54,9 @@ public:
     void release_control_async(Gimbal::ResultCallback callback);
 
     Gimbal::ControlStatus control();
-    void subscribe_control(Gimbal::ControlCallback callback);
+    void subscribe_control(
+        Gimbal::ControlCallback callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
 
     static Gimbal::Result
     gimbal_result_from_command_result(MavlinkCommandSender::Result command_result);
@@ -57,13 +69,41 @@ public:
     const GimbalImpl& operator=(const GimbalImpl&) = delete;
 
 private:
-    std::unique_ptr<GimbalProtocolBase> _gimbal_protocol{nullptr};
-
-    void* _protocol_cookie{nullptr};
-
-    void wait_for_protocol();
-    void wait_for_protocol_async(std::function<void()> callback);
+    struct GimbalManager {
+        mavlink_gimbal_manager_information_t information{};
+        uint8_t sysid{0};
+        uint8_t compid{0};
+    };
+
+    struct {
+        std::mutex mutex{};
+        std::condition_variable cv{};
+        std::unique_ptr<GimbalProtocolBase> gimbal_protocol{nullptr};
+        // Calls made before the protocol was detected, run once it is.
+        std::vector<std::function<void(GimbalProtocolBase&)>> pending{};
+        // Gimbal manager found before, reused when the plugin is enabled again.
+        std::optional<GimbalManager> detected{};
+        void* cookie{nullptr};
+        // Tells the connect pipeline once the protocol is known.
+        ConnectPipeline::Done connect_done{nullptr};
+    } _protocol{};
+
+    // Setpoints streamed without acknowledgement, separate from the commands above.
+    struct {
+        std::mutex mutex{};
+        bool active{false};
+        float pitch_rate_deg_s{0.0f};
+        float yaw_rate_deg_s{0.0f};
+        double rate_hz{50.0};
+        void* cookie{nullptr};
+    } _stream{};
+
+    GimbalProtocolBase& wait_for_protocol();
+    void wait_for_protocol_async(std::function<void(GimbalProtocolBase&)> callback);
+    void set_protocol(std::unique_ptr<GimbalProtocolBase> gimbal_protocol);
+    void detect_protocol(ConnectPipeline::Done done);
     void receive_protocol_timeout();
+    Gimbal::Result send_stream_setpoint();
     void process_gimbal_manager_information(const mavlink_message_t& message);
 };
 
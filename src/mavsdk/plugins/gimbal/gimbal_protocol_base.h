@@ -1,6 +1,7 @@
 #pragma once
 
 #include "plugins/gimbal/gimbal.h"
+#include "callback_list.h"
 #include "plugin_impl_base.h"
 #include "system_impl.h"
 
@@ -41,7 +42,8 @@ public:
     virtual void release_control_async(Gimbal::ResultCallback callback) = 0;
 
     virtual Gimbal::ControlStatus control() = 0;
-    virtual void control_async(Gimbal::ControlCallback callback) = 0;
+    virtual void
+    control_async(Gimbal::ControlCallback callback, const SubscriptionOptions& options) = 0;
 
 protected:
     SystemImpl& _system_impl;
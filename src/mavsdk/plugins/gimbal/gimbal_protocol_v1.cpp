@@ -196,17 +196,23 @@ Gimbal::ControlStatus GimbalProtocolV1::control()
     return _current_control_status;
 }
 
-void GimbalProtocolV1::control_async(Gimbal::ControlCallback callback)
+void GimbalProtocolV1::control_async(
+    Gimbal::ControlCallback callback, const SubscriptionOptions& options)
 {
-    _control_callback = callback;
+    _control_subscriptions.clear();
+    if (callback) {
+        _control_subscriptions.subscribe(callback, options);
+    }
     _control_thread_cv.notify_one();
 
-    std::thread([this, &callback]() {
+    std::thread([this]() {
         std::unique_lock<std::mutex> lock(_control_thread_mutex);
 
-        while (_control_callback) {
-            _system_impl.call_user_callback(
-                [this, callback]() { callback(_current_control_status); });
+        // There are no updates from the gimbal, the status is repeated.
+        while (!_control_subscriptions.empty()) {
+            _control_subscriptions.queue(_current_control_status, [this](auto func) {
+                _system_impl.call_user_callback(std::move(func));
+            });
             _control_thread_cv.wait_for(lock, std::chrono::seconds(1));
         }
     }).detach();
@@ -43,13 +43,14 @@ public:
     void release_control_async(Gimbal::ResultCallback callback) override;
 
     Gimbal::ControlStatus control() override;
-    void control_async(Gimbal::ControlCallback callback) override;
+    void control_async(
+        Gimbal::ControlCallback callback, const SubscriptionOptions& options) override;
 
 private:
     static float to_float_gimbal_mode(const Gimbal::GimbalMode gimbal_mode);
 
     Gimbal::ControlStatus _current_control_status{Gimbal::ControlMode::None, 0, 0, 0, 0};
-    Gimbal::ControlCallback _control_callback;
+    CallbackList<Gimbal::ControlStatus> _control_subscriptions{};
 
     std::condition_variable _control_thread_cv;
     std::mutex _control_thread_mutex;
@@ -45,12 +45,9 @@ void GimbalProtocolV2::process_gimbal_manager_status(const mavlink_message_t& me
     _current_control_status.sysid_secondary_control = secondary_control_sysid;
     _current_control_status.compid_secondary_control = secondary_control_compid;
 
-    if (_control_callback) {
-        auto temp_status = _current_control_status;
-        auto temp_callback = _control_callback;
-        _system_impl.call_user_callback(
-            [temp_callback, temp_status]() { temp_callback(temp_status); });
-    }
+    _control_subscriptions.queue(_current_control_status, [this](auto func) {
+        _system_impl.call_user_callback(std::move(func));
+    });
 }
 
 Gimbal::Result GimbalProtocolV2::set_pitch_and_yaw(float pitch_deg, float yaw_deg)
@@ -260,16 +257,11 @@ void GimbalProtocolV2::release_control_async(Gimbal::ResultCallback callback)
 
 Gimbal::ControlStatus GimbalProtocolV2::control()
 {
-    auto prom = std::promise<Gimbal::ControlStatus>();
-    auto fut = prom.get_future();
-
-    control_async(
-        [&prom](Gimbal::ControlStatus control_status) { prom.set_value(control_status); });
-
-    return fut.get();
+    return _current_control_status;
 }
 
-void GimbalProtocolV2::control_async(Gimbal::ControlCallback callback)
+void GimbalProtocolV2::control_async(
+    Gimbal::ControlCallback callback, const SubscriptionOptions& options)
 {
     if (!_is_mavlink_manager_status_registered) {
         _is_mavlink_manager_status_registered = true;
@@ -280,8 +272,16 @@ void GimbalProtocolV2::control_async(Gimbal::ControlCallback callback)
             this);
     }
 
-    _control_callback = callback;
-    _system_impl.call_user_callback([this, callback]() { callback(_current_control_status); });
+    _control_subscriptions.clear();
+    if (!callback) {
+        return;
+    }
+    _control_subscriptions.subscribe(callback, options);
+
+    // The current status right away, after that with every update.
+    _control_subscriptions.queue(_current_control_status, [this](auto func) {
+        _system_impl.call_user_callback(std::move(func));
+    });
 }
 
 } // namespace mavsdk
@@ -44,7 +44,8 @@ public:
     void release_control_async(Gimbal::ResultCallback callback) override;
 
     Gimbal::ControlStatus control() override;
-    void control_async(Gimbal::ControlCallback callback) override;
+    void control_async(
+        Gimbal::ControlCallback callback, const SubscriptionOptions& options) override;
 
 private:
     void set_gimbal_information(const mavlink_gimbal_manager_information_t& information);
@@ -57,7 +58,7 @@ private:
     Gimbal::GimbalMode _gimbal_mode{Gimbal::GimbalMode::YawFollow};
 
     Gimbal::ControlStatus _current_control_status{Gimbal::ControlMode::None, 0, 0, 0, 0};
-    Gimbal::ControlCallback _control_callback;
+    CallbackList<Gimbal::ControlStatus> _control_subscriptions{};
 
     bool _is_mavlink_manager_status_registered = false;
 };
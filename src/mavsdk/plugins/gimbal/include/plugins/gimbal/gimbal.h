@@ -15,6 +15,8 @@
 
 #include "mavsdk/plugin_base.h"
 
+#include "mavsdk/subscription_options.h"
+
 namespace mavsdk {
 
 class System;
@@ -319,6 +321,39 @@ public:
      */
     ControlStatus control() const;
 
+    /**
+     * @brief Stream gimbal angular rates around pitch and yaw axes.
+     *
+     * This sets the angular rates which are sent to the gimbal periodically, at the
+     * rate set using `set_setpoint_stream_rate`, until `stop_setpoint_stream` is called.
+     * Only the latest rates are sent and nothing is acknowledged, which makes this
+     * suitable to be called at high rates, e.g. for target tracking.
+     *
+     * This function is non-blocking.
+     *
+     * @return Result of request.
+     */
+    Result stream_pitch_rate_and_yaw_rate(float pitch_rate_deg_s, float yaw_rate_deg_s) const;
+
+    /**
+     * @brief Set the rate at which streamed setpoints are sent (default 50 Hz).
+     *
+     * @return Result of request.
+     */
+    Result set_setpoint_stream_rate(double rate_hz) const;
+
+    /**
+     * @brief Stop streaming setpoints.
+     *
+     * @return Result of request.
+     */
+    Result stop_setpoint_stream() const;
+
+    /**
+     * @brief Subscribe to control status updates, delivered as set in `options`.
+     */
+    void subscribe_control(ControlCallback callback, const SubscriptionOptions& options);
+
     /**
      * @brief Copy constructor.
      */
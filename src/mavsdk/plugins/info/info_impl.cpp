@@ -1,7 +1,7 @@
 #include <functional>
 #include <cstring>
-#include <numeric>
 #include "info_impl.h"
+#include "message_latency.h"
 #include "system.h"
 
 namespace mavsdk {
@@ -32,11 +32,6 @@ void InfoImpl::init()
         MAVLINK_MSG_ID_FLIGHT_INFORMATION,
         [this](const mavlink_message_t& message) { process_flight_information(message); },
         this);
-
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_ATTITUDE,
-        [this](const mavlink_message_t& message) { process_attitude(message); },
-        this);
 }
 
 void InfoImpl::deinit()
@@ -51,12 +46,23 @@ void InfoImpl::enable()
     _parent->send_autopilot_version_request();
     _parent->send_flight_information_request();
 
-    // We're going to retry until we have the version.
-    _parent->add_call_every([this]() { request_version_again(); }, 1.0f, &_call_every_cookie);
+    // We're going to retry until we have the version, less and less often.
+    _version_backoff.reset();
+    _parent->add_call_every(
+        [this]() { request_version_again(); },
+        static_cast<float>(_version_backoff.interval_s()),
+        &_call_every_cookie);
 
-    // We're going to periodically ask for the flight information
+    // We're going to periodically check whether we need the flight information
+    _flight_info_backoff.reset();
+    _next_flight_info_request_s = _time.elapsed_s() + _flight_info_backoff.interval_s();
     _parent->add_call_every(
-        [this]() { request_flight_information(); }, 1.0f, &_flight_info_call_every_cookie);
+        [this]() {
+            request_flight_information();
+            stop_speed_factor_if_unused();
+        },
+        1.0f,
+        &_flight_info_call_every_cookie);
 }
 
 void InfoImpl::disable()
@@ -69,6 +75,15 @@ void InfoImpl::disable()
         _information_received = false;
         _flight_information_received = false;
     }
+
+    {
+        std::lock_guard<std::mutex> lock(_speed_factor_mutex);
+        if (_speed_factor_active) {
+            _parent->unregister_mavlink_message_handler(MAVLINK_MSG_ID_ATTITUDE, this);
+            _speed_factor_active = false;
+        }
+    }
+    _speed_factor.reset();
 }
 
 void InfoImpl::request_version_again()
@@ -82,6 +97,8 @@ void InfoImpl::request_version_again()
     }
 
     _parent->send_autopilot_version_request();
+    _parent->count_background_request();
+    _parent->change_call_every(static_cast<float>(_version_backoff.backoff()), _call_every_cookie);
 }
 
 void InfoImpl::request_flight_information()
@@ -89,11 +106,28 @@ void InfoImpl::request_flight_information()
     // We will request new flight information from the autopilot only if
     // we go from an armed to disarmed state or if we haven't received any
     // information yet
-    if ((_was_armed && !_parent->is_armed()) || !_flight_information_received) {
+    const bool is_armed = _parent->is_armed();
+    const bool disarmed = _was_armed && !is_armed;
+    _was_armed = is_armed;
+
+    if (disarmed) {
         _parent->send_flight_information_request();
+        _parent->count_background_request();
+        return;
+    }
+
+    if (_flight_information_received) {
+        return;
     }
 
-    _was_armed = _parent->is_armed();
+    // If the autopilot doesn't answer, it probably doesn't support it.
+    const double now_s = _time.elapsed_s();
+    if (now_s < _next_flight_info_request_s) {
+        return;
+    }
+    _parent->send_flight_information_request();
+    _parent->count_background_request();
+    _next_flight_info_request_s = now_s + _flight_info_backoff.backoff();
 }
 
 void InfoImpl::process_autopilot_version(const mavlink_message_t& message)
@@ -246,39 +280,51 @@ void InfoImpl::process_attitude(const mavlink_message_t& message)
 {
     // We use the attitude message to estimate the lockstep speed factor
     // because it's common to be sent, arrives at high rate, and contains
-    // the timestamp field.
-    mavlink_attitude_t attitude;
-    mavlink_msg_attitude_decode(&message, &attitude);
-
-    std::lock_guard<std::mutex> lock(_mutex);
+    // the timestamp field. Only the timestamp is read, and most messages
+    // are skipped by the estimator, so this stays cheap at any rate.
+    const auto* ingress = MessageLatency::current_ingress();
+    _speed_factor.sample(
+        mavlink_msg_attitude_get_time_boot_ms(&message),
+        ingress ? ingress->time_ns : MessageLatency::now_ns());
+}
 
-    if (_last_time_boot_ms != 0) {
-        _speed_factor_measurements.push(SpeedFactorMeasurement{
-            static_cast<double>(attitude.time_boot_ms - _last_time_boot_ms) * 1e-3,
-            _time.elapsed_since_s(_last_time_attitude_arrived)});
+void InfoImpl::stop_speed_factor_if_unused()
+{
+    {
+        std::lock_guard<std::mutex> lock(_speed_factor_mutex);
+        if (!_speed_factor_active ||
+            _time.elapsed_s() - _speed_factor_last_query_s < SPEED_FACTOR_UNUSED_S) {
+            return;
+        }
+        _parent->unregister_mavlink_message_handler(MAVLINK_MSG_ID_ATTITUDE, this);
+        _speed_factor_active = false;
     }
-
-    _last_time_boot_ms = attitude.time_boot_ms;
-    _last_time_attitude_arrived = _time.steady_time();
+    _speed_factor.reset();
 }
 
-std::pair<Info::Result, double> InfoImpl::get_speed_factor() const
+std::pair<Info::Result, double> InfoImpl::get_speed_factor()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    {
+        std::lock_guard<std::mutex> lock(_speed_factor_mutex);
+        _speed_factor_last_query_s = _time.elapsed_s();
+        if (!_speed_factor_active) {
+            // Sampling starts with the first query, which is too early to
+            // have an estimate.
+            _parent->register_mavlink_message_handler(
+                MAVLINK_MSG_ID_ATTITUDE,
+                [this](const mavlink_message_t& message) { process_attitude(message); },
+                this);
+            _speed_factor_active = true;
+            return std::make_pair<>(Info::Result::InformationNotReceivedYet, NAN);
+        }
+    }
 
-    if (_speed_factor_measurements.size() == 0) {
+    const auto speed_factor = _speed_factor.speed_factor();
+    if (!speed_factor) {
         return std::make_pair<>(Info::Result::InformationNotReceivedYet, NAN);
     }
 
-    const auto sum = std::accumulate(
-        _speed_factor_measurements.begin(),
-        _speed_factor_measurements.end(),
-        SpeedFactorMeasurement{},
-        [](SpeedFactorMeasurement a, SpeedFactorMeasurement b) { return a + b; });
-
-    const double speed_factor = sum.simulated_duration_s / sum.real_time_s;
-
-    return std::make_pair<>(Info::Result::Success, speed_factor);
+    return std::make_pair<>(Info::Result::Success, speed_factor.value());
 }
 
 } // namespace mavsdk
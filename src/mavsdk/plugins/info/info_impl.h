@@ -5,7 +5,8 @@
 #include "mavlink_include.h"
 #include "plugins/info/info.h"
 #include "plugin_impl_base.h"
-#include "ringbuffer.h"
+#include "polling_backoff.h"
+#include "speed_factor_estimator.h"
 
 namespace mavsdk {
 
@@ -25,7 +26,8 @@ public:
     std::pair<Info::Result, Info::Version> get_version() const;
     std::pair<Info::Result, Info::Product> get_product() const;
     std::pair<Info::Result, Info::FlightInfo> get_flight_information() const;
-    std::pair<Info::Result, double> get_speed_factor() const;
+    // Not const, the first query starts the sampling.
+    std::pair<Info::Result, double> get_speed_factor();
 
     InfoImpl(const InfoImpl&) = delete;
     InfoImpl& operator=(const InfoImpl&) = delete;
@@ -37,6 +39,7 @@ private:
     void process_autopilot_version(const mavlink_message_t& message);
     void process_flight_information(const mavlink_message_t& message);
     void process_attitude(const mavlink_message_t& message);
+    void stop_speed_factor_if_unused();
 
     mutable std::mutex _mutex{};
 
@@ -51,22 +54,19 @@ private:
     void* _call_every_cookie{nullptr};
     void* _flight_info_call_every_cookie{nullptr};
 
-    struct SpeedFactorMeasurement {
-        double simulated_duration_s{0.0};
-        double real_time_s{0.0};
+    // Only touched from enable() and the call_every callbacks.
+    PollingBackoff _version_backoff{1.0, 30.0};
+    PollingBackoff _flight_info_backoff{1.0, 30.0};
+    double _next_flight_info_request_s{0.0};
 
-        SpeedFactorMeasurement operator+(SpeedFactorMeasurement& rhs) const
-        {
-            return {
-                this->simulated_duration_s + rhs.simulated_duration_s,
-                this->real_time_s + rhs.real_time_s};
-        }
-    };
-    Ringbuffer<SpeedFactorMeasurement, 50> _speed_factor_measurements;
+    // ATTITUDE is only sampled while the speed factor is asked for.
+    static constexpr double SPEED_FACTOR_UNUSED_S = 5.0;
+    SpeedFactorEstimator _speed_factor{};
+    std::mutex _speed_factor_mutex{};
+    bool _speed_factor_active{false};
+    double _speed_factor_last_query_s{0.0};
 
     Time _time{};
-    dl_time_t _last_time_attitude_arrived{};
-    uint32_t _last_time_boot_ms{0};
 
     static const std::string vendor_id_str(uint16_t vendor_id);
     static const std::string product_id_str(uint16_t product_id);
@@ -160,6 +160,38 @@ public:
      */
     void download_log_file_async(Entry entry, std::string path, DownloadLogFileCallback callback);
 
+    /**
+     * @brief Callback type for download_log_files_async.
+     */
+    using DownloadLogFilesCallback = std::function<void(Result, ProgressData)>;
+
+    /**
+     * @brief Download several log files into a directory.
+     *
+     * The logs are downloaded one after the other, each one requested as soon as the one
+     * before is complete. The files are named after the log id and date. Logs already
+     * downloaded completely are skipped and interrupted downloads are resumed.
+     *
+     * The progress reported is the one of the whole batch. Success is reported once all logs
+     * are downloaded, and the batch stops at the first error.
+     */
+    void download_log_files_async(
+        std::vector<Entry> entries, std::string dir, DownloadLogFilesCallback callback);
+
+    /**
+     * @brief Callback type for download_log_file_stream_async.
+     */
+    using DownloadLogFileStreamCallback =
+        std::function<void(Result, ProgressData, const std::vector<uint8_t>&)>;
+
+    /**
+     * @brief Download log file and hand it on in parts instead of writing it to a file.
+     *
+     * The parts come in order with `Result::Next`, the final result with an empty part.
+     * Requesting more data from the vehicle pauses while the callback falls behind.
+     */
+    void download_log_file_stream_async(Entry entry, DownloadLogFileStreamCallback callback);
+
     /**
      * @brief Copy constructor.
      */
@@ -0,0 +1,243 @@
+#include "log_data_transfer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mavsdk {
+
+LogDataTransfer::LogDataTransfer(uint32_t size, bool buffer_parts) :
+    _size(size),
+    _buffer_parts(buffer_parts)
+{}
+
+std::optional<LogDataTransfer::Request> LogDataTransfer::start(double now_s)
+{
+    if (_size == 0) {
+        return std::nullopt;
+    }
+
+    start_part(0, now_s);
+    return request_chunks(0, _chunks_received.size(), now_s);
+}
+
+std::optional<LogDataTransfer::Request> LogDataTransfer::resume(
+    uint32_t bytes_completed, const std::vector<bool>& chunks_received, double now_s)
+{
+    if (bytes_completed >= _size) {
+        _bytes_completed = _size;
+        return std::nullopt;
+    }
+
+    // Parts always start on a chunk boundary, anything else doesn't come from
+    // us and the chunks can't be trusted.
+    const bool aligned = bytes_completed % CHUNK_LEN == 0;
+    bytes_completed -= bytes_completed % CHUNK_LEN;
+    _bytes_completed = bytes_completed;
+
+    start_part(bytes_completed, now_s);
+    if (aligned && chunks_received.size() > _chunks_received.size()) {
+        append_part(chunks_received.size() - _chunks_received.size());
+    }
+
+    const auto num_known =
+        aligned ? std::min(chunks_received.size(), _chunks_received.size()) : 0;
+    std::copy(
+        chunks_received.begin(), chunks_received.begin() + num_known, _chunks_received.begin());
+
+    // Nothing is requested yet, so nothing is counted as lost.
+    _request_first = 0;
+    _request_end = 0;
+    return next_request(now_s);
+}
+
+LogDataTransfer::DataResult
+LogDataTransfer::add_data(uint32_t ofs, const uint8_t* data, std::size_t count, double now_s)
+{
+    if (ofs < _part_start || ofs >= _part_start + _part_len ||
+        (ofs - _part_start) % CHUNK_LEN != 0) {
+        return DataResult::Ignored;
+    }
+
+    const std::size_t pos = ofs - _part_start;
+
+    // Every chunk is full apart from the very last one of the file.
+    if (count != std::min(CHUNK_LEN, _part_len - pos)) {
+        return DataResult::Ignored;
+    }
+
+    if (_buffer_parts) {
+        std::memcpy(&_bytes[pos], data, count);
+    }
+
+    if (!_request_answered) {
+        _request_answered = true;
+        const double round_trip_s = now_s - _request_sent_s;
+        _round_trip_s =
+            (_round_trip_s > 0.0) ? 0.8 * _round_trip_s + 0.2 * round_trip_s : round_trip_s;
+    }
+
+    const std::size_t index = pos / CHUNK_LEN;
+    _chunks_received[index] = true;
+
+    return (index + 1 == _request_end) ? DataResult::RequestServed : DataResult::Stored;
+}
+
+std::optional<LogDataTransfer::Request> LogDataTransfer::next_request(double now_s)
+{
+    if (_part_len == 0) {
+        return std::nullopt;
+    }
+
+    _chunks_lost += static_cast<unsigned>(std::count(
+        _chunks_received.begin() + _request_first, _chunks_received.begin() + _request_end, false));
+
+    const auto holes = missing_ranges(_chunks_received);
+    if (!holes.empty()) {
+        const auto max_gap = static_cast<std::size_t>(_round_trip_s * _chunks_per_s);
+
+        auto [first, end] = holes.front();
+        auto next_hole = holes.begin() + 1;
+        while (next_hole != holes.end() && next_hole->first - end <= max_gap) {
+            end = next_hole->second;
+            ++next_hole;
+        }
+
+        // If all that is left is the end of the part, we might as well get
+        // the next part with the same request.
+        const bool only_tail_missing =
+            next_hole == holes.end() && end == _chunks_received.size();
+        if (only_tail_missing && _part_start + _part_len < _size &&
+            _chunks_received.size() + _part_chunks <= 2 * MAX_PART_CHUNKS) {
+            append_part(_part_chunks);
+            end = _chunks_received.size();
+        }
+
+        return request_chunks(first, end, now_s);
+    }
+
+    // A part found complete when resuming tells nothing about the link.
+    const double part_duration_s = now_s - _part_started_s;
+    if (_chunks_requested > 0) {
+        if (part_duration_s > 0.0 && _chunks_requested > _chunks_lost) {
+            _chunks_per_s = double(_chunks_requested - _chunks_lost) / part_duration_s;
+        }
+        _part_chunks =
+            adapt_part_chunks(_part_chunks, _chunks_requested, _chunks_lost, part_duration_s);
+    }
+
+    const std::size_t next_part_start = _part_start + _part_len;
+    _bytes_completed = static_cast<uint32_t>(next_part_start);
+    _part_completed = true;
+
+    if (_completed.empty()) {
+        _completed.swap(_bytes);
+    } else {
+        _completed.insert(_completed.end(), _bytes.begin(), _bytes.end());
+    }
+
+    if (next_part_start == _size) {
+        _part_len = 0;
+        _bytes.clear();
+        _chunks_received.clear();
+        _request_first = 0;
+        _request_end = 0;
+        return std::nullopt;
+    }
+
+    start_part(next_part_start, now_s);
+    return request_chunks(0, _chunks_received.size(), now_s);
+}
+
+bool LogDataTransfer::take_completed_part(std::vector<uint8_t>& part)
+{
+    if (!_part_completed) {
+        return false;
+    }
+
+    part.clear();
+    part.swap(_completed);
+    _part_completed = false;
+    return true;
+}
+
+std::vector<std::pair<std::size_t, std::size_t>>
+LogDataTransfer::missing_ranges(const std::vector<bool>& chunks_received)
+{
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+
+    auto it = std::find(chunks_received.begin(), chunks_received.end(), false);
+    while (it != chunks_received.end()) {
+        const auto range_end = std::find(it, chunks_received.end(), true);
+        ranges.emplace_back(
+            std::distance(chunks_received.begin(), it),
+            std::distance(chunks_received.begin(), range_end));
+        it = std::find(range_end, chunks_received.end(), false);
+    }
+
+    return ranges;
+}
+
+unsigned LogDataTransfer::adapt_part_chunks(
+    unsigned current, unsigned requested, unsigned lost, double duration_s)
+{
+    unsigned next = current;
+
+    if (lost * 10 > requested) {
+        // More than 10% lost, we are probably asking for too much at once.
+        next = current / 2;
+    } else if (lost * 20 <= requested) {
+        next = current * 2;
+    }
+
+    if (duration_s > 0.0 && requested > lost) {
+        const double chunks_per_s = double(requested - lost) / duration_s;
+        next = static_cast<unsigned>(
+            std::min(double(next), chunks_per_s * TARGET_PART_DURATION_S));
+    }
+
+    return std::clamp(next, MIN_PART_CHUNKS, MAX_PART_CHUNKS);
+}
+
+void LogDataTransfer::start_part(std::size_t start, double now_s)
+{
+    _part_start = start;
+    _part_len = 0;
+    _bytes.clear();
+    _chunks_received.clear();
+    _part_started_s = now_s;
+    _chunks_requested = 0;
+    _chunks_lost = 0;
+
+    append_part(_part_chunks);
+}
+
+void LogDataTransfer::append_part(std::size_t chunks)
+{
+    // Parts always end on a chunk boundary unless they end with the file.
+    const std::size_t end =
+        std::min(_part_start + _part_len + chunks * CHUNK_LEN, std::size_t(_size));
+
+    _part_len = end - _part_start;
+    if (_buffer_parts) {
+        _bytes.resize(_part_len);
+    }
+    _chunks_received.resize((_part_len + CHUNK_LEN - 1) / CHUNK_LEN, false);
+}
+
+LogDataTransfer::Request
+LogDataTransfer::request_chunks(std::size_t first, std::size_t end, double now_s)
+{
+    _request_first = first;
+    _request_end = end;
+    _request_sent_s = now_s;
+    _request_answered = false;
+    _chunks_requested += static_cast<unsigned>(end - first);
+
+    const std::size_t last_byte = std::min(end * CHUNK_LEN, _part_len);
+
+    return Request{
+        static_cast<uint32_t>(_part_start + first * CHUNK_LEN),
+        static_cast<uint32_t>(last_byte - first * CHUNK_LEN)};
+}
+
+} // namespace mavsdk
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace mavsdk {
+
+// Book-keeping for downloading one log file with LOG_REQUEST_DATA.
+//
+// The file is fetched in parts. Each part is requested at once and then
+// checked for holes which are requested again until the part is complete.
+// Holes closer together than what the vehicle sends during a round trip are
+// requested at once, as getting the few chunks between them again is faster
+// than waiting for another request to come through.
+//
+// Autopilots only serve one request at a time and a new request replaces the
+// previous one, so the next part can't just be requested ahead. Instead, if
+// the only hole left runs up to the end of the part, it is requested together
+// with the next part, so the vehicle keeps sending while the current part
+// completes.
+//
+// The part size adapts to the link: it grows while parts come in with little
+// loss, shrinks when too much gets lost, and is kept to roughly a second worth
+// of data so progress is still reported regularly on slow links.
+//
+// This class knows nothing about MAVLink, files or clocks, it just tells the
+// caller what to request and when a part is ready to be written. Times are
+// passed in as seconds since any point in time.
+class LogDataTransfer {
+public:
+    // Same as MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN.
+    static constexpr std::size_t CHUNK_LEN = 90;
+
+    static constexpr unsigned MIN_PART_CHUNKS = 32;
+    static constexpr unsigned INITIAL_PART_CHUNKS = 512;
+    static constexpr unsigned MAX_PART_CHUNKS = 4096;
+    static constexpr double TARGET_PART_DURATION_S = 1.0;
+
+    struct Request {
+        uint32_t ofs;
+        uint32_t count;
+
+        bool operator==(const Request& other) const
+        {
+            return ofs == other.ofs && count == other.count;
+        }
+    };
+
+    enum class DataResult {
+        Ignored, // Not part of what we are waiting for.
+        Stored, // Keep waiting.
+        RequestServed, // The end of the last request arrived, call next_request().
+    };
+
+    // Without buffer_parts the data is not kept here and the caller has to
+    // store every chunk add_data() doesn't ignore right away, e.g. straight
+    // into the file at its offset.
+    explicit LogDataTransfer(uint32_t size, bool buffer_parts = true);
+
+    // Returns the request for the first part, nullopt if there is nothing
+    // to download.
+    std::optional<Request> start(double now_s);
+
+    // Like start() but for a download that was interrupted before, with all
+    // bytes before bytes_completed and the chunks after it marked in
+    // chunks_received already in the file. Only works without buffer_parts.
+    std::optional<Request>
+    resume(uint32_t bytes_completed, const std::vector<bool>& chunks_received, double now_s);
+
+    DataResult add_data(uint32_t ofs, const uint8_t* data, std::size_t count, double now_s);
+
+    // Call when the last request was served or timed out. Returns what to
+    // request next, nullopt once everything has been received.
+    std::optional<Request> next_request(double now_s);
+
+    // Moves a completed part into part, returns false if there is none.
+    // Without buffer_parts, part is left empty and the return value just
+    // tells that more of the file is complete.
+    bool take_completed_part(std::vector<uint8_t>& part);
+
+    // Bytes of the completed parts.
+    uint32_t bytes_completed() const { return _bytes_completed; }
+    bool finished() const { return _bytes_completed == _size && !_part_completed; }
+
+    unsigned part_chunks() const { return _part_chunks; }
+
+    // The chunks after bytes_completed() received so far, which is what
+    // resume() needs to carry on later.
+    const std::vector<bool>& chunks_received() const { return _chunks_received; }
+
+    // Returns the [first, end) ranges of chunks not received yet.
+    static std::vector<std::pair<std::size_t, std::size_t>>
+    missing_ranges(const std::vector<bool>& chunks_received);
+
+    // Part size in chunks to use after a part of requested chunks of which
+    // lost ones had to be requested again took duration_s.
+    static unsigned
+    adapt_part_chunks(unsigned current, unsigned requested, unsigned lost, double duration_s);
+
+private:
+    void start_part(std::size_t start, double now_s);
+    void append_part(std::size_t chunks);
+    Request request_chunks(std::size_t first, std::size_t end, double now_s);
+
+    const uint32_t _size;
+    const bool _buffer_parts;
+
+    unsigned _part_chunks{INITIAL_PART_CHUNKS};
+
+    std::size_t _part_start{0};
+    std::size_t _part_len{0};
+    std::vector<uint8_t> _bytes{};
+    // One bit per chunk, std::vector<bool> is packed.
+    std::vector<bool> _chunks_received{};
+    double _part_started_s{0.0};
+    unsigned _chunks_requested{0};
+    unsigned _chunks_lost{0};
+
+    // The chunks of the last request.
+    std::size_t _request_first{0};
+    std::size_t _request_end{0};
+    double _request_sent_s{0.0};
+    bool _request_answered{false};
+
+    // What we know about the link so far.
+    double _round_trip_s{0.0};
+    double _chunks_per_s{0.0};
+
+    std::vector<uint8_t> _completed{};
+    bool _part_completed{false};
+    uint32_t _bytes_completed{0};
+};
+
+} // namespace mavsdk
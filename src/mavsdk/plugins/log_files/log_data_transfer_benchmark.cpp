@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <functional>
+#include <optional>
+#include <vector>
+#include "benchmark_helpers.h"
+#include "log_data_transfer.h"
+#include "simulated_link.h"
+#include "virtual_time_executor.h"
+
+using namespace mavsdk;
+
+namespace {
+
+const MAVLinkAddress ground_address{245, MAV_COMP_ID_MISSIONPLANNER};
+const MAVLinkAddress vehicle_address{1, MAV_COMP_ID_AUTOPILOT1};
+
+constexpr uint16_t LOG_ID = 1;
+constexpr uint32_t LOG_SIZE = 1024 * 1024;
+
+// The same as the plugin waits for data before asking again.
+constexpr double DATA_TIMEOUT_S = 0.1;
+
+// How fast the vehicle sends on a link without a bandwidth limit, roughly
+// what PX4 manages over UDP.
+constexpr double VEHICLE_BYTES_PER_S = 1.0e6;
+
+struct Download {
+    bool success{false};
+    double elapsed_s{0.0};
+    uint64_t chunks_sent{0};
+};
+
+// The vehicle end serves one request at a time, as fast as the link takes
+// it, and a new request replaces the one being served, like on autopilots.
+class Vehicle {
+public:
+    Vehicle(VirtualTimeExecutor& executor, SimulatedLink::Endpoint& endpoint) :
+        _executor(executor),
+        _endpoint(endpoint)
+    {
+        _endpoint.message_handler().register_one(
+            MAVLINK_MSG_ID_LOG_REQUEST_DATA,
+            [this](const mavlink_message_t& message) {
+                mavlink_log_request_data_t request;
+                mavlink_msg_log_request_data_decode(&message, &request);
+                _ofs = request.ofs;
+                _end = std::min(LOG_SIZE, request.ofs + std::min(request.count, LOG_SIZE));
+                if (!_sending) {
+                    _sending = true;
+                    send_next();
+                }
+            },
+            this);
+    }
+
+    ~Vehicle() { _endpoint.message_handler().unregister_all(this); }
+
+    [[nodiscard]] uint64_t chunks_sent() const { return _chunks_sent; }
+
+    // Non-copyable
+    Vehicle(const Vehicle&) = delete;
+    const Vehicle& operator=(const Vehicle&) = delete;
+
+private:
+    void send_next()
+    {
+        if (_ofs >= _end) {
+            _sending = false;
+            return;
+        }
+
+        const auto count =
+            static_cast<uint8_t>(std::min<uint32_t>(_end - _ofs, LogDataTransfer::CHUNK_LEN));
+        uint8_t data[LogDataTransfer::CHUNK_LEN]{};
+
+        mavlink_message_t message;
+        mavlink_msg_log_data_pack(
+            vehicle_address.system_id,
+            vehicle_address.component_id,
+            &message,
+            LOG_ID,
+            _ofs,
+            count,
+            data);
+        _endpoint.send_message(message);
+        ++_chunks_sent;
+        _ofs += count;
+
+        const double busy_for_s = _endpoint.busy_for_s();
+        const double next_in_s = busy_for_s > 0.0 ?
+                                     busy_for_s :
+                                     double(MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len) /
+                                         VEHICLE_BYTES_PER_S;
+        _executor.post_in(next_in_s, [this]() { send_next(); });
+    }
+
+    VirtualTimeExecutor& _executor;
+    SimulatedLink::Endpoint& _endpoint;
+    uint32_t _ofs{0};
+    uint32_t _end{0};
+    bool _sending{false};
+    uint64_t _chunks_sent{0};
+};
+
+// Drives a LogDataTransfer the way the plugin does, on virtual time.
+Download simulate_download(const SimulatedLink::Config& config)
+{
+    FakeTime time;
+    VirtualTimeExecutor executor(time);
+    SimulatedLink link(executor, ground_address, vehicle_address, config);
+    Vehicle vehicle(executor, link.b());
+
+    // The data goes straight to the file in the plugin, so isn't kept here
+    // either.
+    LogDataTransfer transfer(LOG_SIZE, false);
+    std::vector<uint8_t> part;
+
+    auto request = [&](std::optional<LogDataTransfer::Request> next) {
+        while (transfer.take_completed_part(part)) {}
+        if (!next) {
+            return;
+        }
+        mavlink_message_t message;
+        mavlink_msg_log_request_data_pack(
+            ground_address.system_id,
+            ground_address.component_id,
+            &message,
+            vehicle_address.system_id,
+            vehicle_address.component_id,
+            LOG_ID,
+            next->ofs,
+            next->count);
+        link.a().send_message(message);
+    };
+
+    void* timeout_cookie = nullptr;
+    std::function<void()> data_timeout = [&]() {
+        executor.timeout_handler().add(data_timeout, DATA_TIMEOUT_S, &timeout_cookie);
+        request(transfer.next_request(executor.elapsed_s()));
+    };
+
+    link.a().message_handler().register_one(
+        MAVLINK_MSG_ID_LOG_DATA,
+        [&](const mavlink_message_t& message) {
+            mavlink_log_data_t log_data;
+            mavlink_msg_log_data_decode(&message, &log_data);
+            executor.timeout_handler().refresh(timeout_cookie);
+            const auto now_s = executor.elapsed_s();
+            switch (transfer.add_data(log_data.ofs, log_data.data, log_data.count, now_s)) {
+                case LogDataTransfer::DataResult::RequestServed:
+                    request(transfer.next_request(now_s));
+                    break;
+                case LogDataTransfer::DataResult::Stored:
+                    while (transfer.take_completed_part(part)) {}
+                    break;
+                case LogDataTransfer::DataResult::Ignored:
+                    break;
+            }
+        },
+        &transfer);
+
+    executor.timeout_handler().add(data_timeout, DATA_TIMEOUT_S, &timeout_cookie);
+    request(transfer.start(executor.elapsed_s()));
+
+    Download download;
+    download.success = executor.run_until([&]() { return transfer.finished(); }, 3600.0);
+    download.elapsed_s = executor.elapsed_s();
+    download.chunks_sent = vehicle.chunks_sent();
+
+    executor.timeout_handler().remove(timeout_cookie);
+    link.a().message_handler().unregister_all(&transfer);
+    return download;
+}
+
+} // namespace
+
+// Downloading a log with LOG_REQUEST_DATA, the vehicle streaming the parts
+// requested and the holes requested again.
+static void LogDataTransfer_Download(benchmark::State& state)
+{
+    const auto config = lossy_link_config(state);
+
+    Download download;
+    for (auto _ : state) {
+        download = simulate_download(config);
+    }
+
+    const uint64_t needed =
+        (LOG_SIZE + LogDataTransfer::CHUNK_LEN - 1) / LogDataTransfer::CHUNK_LEN;
+    report_transfer(
+        state,
+        download.success,
+        download.elapsed_s,
+        download.chunks_sent - std::min(download.chunks_sent, needed),
+        LOG_SIZE);
+}
+BENCHMARK(LogDataTransfer_Download)->Apply(lossy_links)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,400 @@
+#include "log_data_transfer.h"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <queue>
+
+using namespace mavsdk;
+
+namespace {
+
+std::vector<uint8_t> example_log(std::size_t size)
+{
+    std::vector<uint8_t> log(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        log[i] = static_cast<uint8_t>((i * 7) % 251);
+    }
+    return log;
+}
+
+// Serves a request completely apart from the chunks not wanted.
+LogDataTransfer::DataResult serve(
+    LogDataTransfer& transfer,
+    const std::vector<uint8_t>& log,
+    LogDataTransfer::Request request,
+    const std::vector<uint32_t>& dropped_ofs = {})
+{
+    auto result = LogDataTransfer::DataResult::Stored;
+    for (uint32_t ofs = request.ofs; ofs < request.ofs + request.count;
+         ofs += LogDataTransfer::CHUNK_LEN) {
+        if (std::find(dropped_ofs.begin(), dropped_ofs.end(), ofs) != dropped_ofs.end()) {
+            continue;
+        }
+        const auto count = std::min<std::size_t>(
+            LogDataTransfer::CHUNK_LEN, request.ofs + request.count - ofs);
+        result = transfer.add_data(ofs, &log[ofs], count, 0.0);
+    }
+    return result;
+}
+
+// A vehicle sending at a fixed rate over a link with latency and random
+// loss. As on real autopilots, a new request replaces the one being served.
+struct SimulatedLink {
+    double bytes_per_s;
+    double latency_s;
+    double loss;
+};
+
+struct SimulationResult {
+    double duration_s;
+    unsigned num_requests;
+    bool complete;
+};
+
+SimulationResult simulate(const SimulatedLink& link, const std::vector<uint8_t>& log)
+{
+    constexpr double timeout_s = 0.1;
+    const double chunk_s = double(LogDataTransfer::CHUNK_LEN) / link.bytes_per_s;
+
+    struct Event {
+        double time_s;
+        bool is_request;
+        LogDataTransfer::Request request;
+        bool operator>(const Event& other) const { return time_s > other.time_s; }
+    };
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+
+    uint32_t rng = 12345;
+    auto lost = [&]() {
+        rng = rng * 1103515245 + 12345;
+        return double((rng >> 8) & 0xffff) / 65536.0 < link.loss;
+    };
+
+    LogDataTransfer transfer(static_cast<uint32_t>(log.size()));
+    std::vector<uint8_t> received;
+    std::vector<uint8_t> part;
+    SimulationResult result{0.0, 0, false};
+
+    double now_s = 0.0;
+    double last_activity_s = 0.0;
+    auto send_request = [&](std::optional<LogDataTransfer::Request> request) {
+        while (transfer.take_completed_part(part)) {
+            received.insert(received.end(), part.begin(), part.end());
+        }
+        if (request) {
+            events.push(Event{now_s + link.latency_s / 2.0, true, *request});
+            ++result.num_requests;
+        }
+        last_activity_s = now_s;
+    };
+
+    send_request(transfer.start(now_s));
+
+    // What the vehicle has left to send and when it sends the next chunk.
+    LogDataTransfer::Request serving{0, 0};
+    double next_chunk_s = 0.0;
+
+    while (!transfer.finished() && now_s < 3600.0) {
+        const double timeout_at_s = last_activity_s + timeout_s;
+        const double event_at_s = events.empty() ? timeout_at_s : events.top().time_s;
+        const double chunk_at_s = (serving.count > 0) ? next_chunk_s : timeout_at_s;
+
+        if (chunk_at_s <= event_at_s && chunk_at_s < timeout_at_s) {
+            now_s = chunk_at_s;
+            const auto count =
+                std::min<uint32_t>(serving.count, uint32_t(LogDataTransfer::CHUNK_LEN));
+            if (!lost()) {
+                LogDataTransfer::Request chunk{serving.ofs, count};
+                events.push(Event{now_s + link.latency_s / 2.0, false, chunk});
+            }
+            serving.ofs += count;
+            serving.count -= count;
+            next_chunk_s = now_s + chunk_s;
+
+        } else if (event_at_s < timeout_at_s) {
+            now_s = event_at_s;
+            const auto event = events.top();
+            events.pop();
+            if (event.is_request) {
+                serving = event.request;
+                next_chunk_s = std::max(next_chunk_s, now_s);
+            } else {
+                last_activity_s = now_s;
+                const auto data_result = transfer.add_data(
+                    event.request.ofs, &log[event.request.ofs], event.request.count, now_s);
+                if (data_result == LogDataTransfer::DataResult::RequestServed) {
+                    send_request(transfer.next_request(now_s));
+                }
+            }
+
+        } else {
+            now_s = timeout_at_s;
+            send_request(transfer.next_request(now_s));
+        }
+    }
+
+    result.duration_s = now_s;
+    result.complete = transfer.finished() && received == log;
+    return result;
+}
+
+} // namespace
+
+TEST(LogDataTransfer, FindsMissingRanges)
+{
+    EXPECT_TRUE(LogDataTransfer::missing_ranges({}).empty());
+    EXPECT_TRUE(LogDataTransfer::missing_ranges({true, true}).empty());
+
+    using Ranges = std::vector<std::pair<std::size_t, std::size_t>>;
+    EXPECT_EQ(LogDataTransfer::missing_ranges({false, false}), (Ranges{{0, 2}}));
+    EXPECT_EQ(
+        LogDataTransfer::missing_ranges({true, false, false, true, false, true, false}),
+        (Ranges{{1, 3}, {4, 5}, {6, 7}}));
+}
+
+TEST(LogDataTransfer, AdaptsPartSize)
+{
+    // Grows with little loss and shrinks with too much loss.
+    EXPECT_EQ(LogDataTransfer::adapt_part_chunks(512, 512, 0, 0.1), 1024u);
+    EXPECT_EQ(LogDataTransfer::adapt_part_chunks(512, 520, 8, 0.1), 1024u);
+    EXPECT_EQ(LogDataTransfer::adapt_part_chunks(512, 600, 40, 0.1), 512u);
+    EXPECT_EQ(LogDataTransfer::adapt_part_chunks(512, 600, 88, 0.1), 256u);
+
+    // Stays within bounds.
+    EXPECT_EQ(
+        LogDataTransfer::adapt_part_chunks(LogDataTransfer::MAX_PART_CHUNKS, 4096, 0, 0.1),
+        LogDataTransfer::MAX_PART_CHUNKS);
+    EXPECT_EQ(
+        LogDataTransfer::adapt_part_chunks(LogDataTransfer::MIN_PART_CHUNKS, 64, 32, 0.1),
+        LogDataTransfer::MIN_PART_CHUNKS);
+
+    // A slow link gets parts of about a second.
+    EXPECT_EQ(LogDataTransfer::adapt_part_chunks(512, 512, 0, 8.0), 64u);
+}
+
+TEST(LogDataTransfer, DownloadsWithoutLoss)
+{
+    const auto log = example_log(100000);
+    LogDataTransfer transfer(static_cast<uint32_t>(log.size()));
+
+    auto request = transfer.start(0.0);
+    ASSERT_TRUE(request);
+    EXPECT_EQ(
+        *request,
+        (LogDataTransfer::Request{
+            0, LogDataTransfer::INITIAL_PART_CHUNKS * LogDataTransfer::CHUNK_LEN}));
+
+    std::vector<uint8_t> received;
+    std::vector<uint8_t> part;
+    double now_s = 0.0;
+    while (request) {
+        EXPECT_EQ(serve(transfer, log, *request), LogDataTransfer::DataResult::RequestServed);
+        now_s += 0.01;
+        request = transfer.next_request(now_s);
+        while (transfer.take_completed_part(part)) {
+            received.insert(received.end(), part.begin(), part.end());
+        }
+    }
+
+    EXPECT_TRUE(transfer.finished());
+    EXPECT_EQ(transfer.bytes_completed(), log.size());
+    EXPECT_EQ(received, log);
+}
+
+TEST(LogDataTransfer, LeavesDataToCallerWithoutBuffering)
+{
+    const auto log = example_log(100000);
+    LogDataTransfer transfer(static_cast<uint32_t>(log.size()), false);
+
+    // Chunks go straight to their place, even when arriving backwards.
+    std::vector<uint8_t> file(log.size());
+    std::vector<uint8_t> part;
+    unsigned num_parts = 0;
+    double now_s = 0.0;
+
+    auto request = transfer.start(now_s);
+    while (request) {
+        std::vector<uint32_t> chunk_offsets;
+        for (uint32_t ofs = request->ofs; ofs < request->ofs + request->count;
+             ofs += LogDataTransfer::CHUNK_LEN) {
+            chunk_offsets.push_back(ofs);
+        }
+        for (auto it = chunk_offsets.rbegin(); it != chunk_offsets.rend(); ++it) {
+            const auto ofs = *it;
+            const auto count = std::min<std::size_t>(
+                LogDataTransfer::CHUNK_LEN, request->ofs + request->count - ofs);
+            if (transfer.add_data(ofs, &log[ofs], count, now_s) !=
+                LogDataTransfer::DataResult::Ignored) {
+                std::copy(&log[ofs], &log[ofs] + count, &file[ofs]);
+            }
+        }
+        now_s += 0.01;
+        request = transfer.next_request(now_s);
+        while (transfer.take_completed_part(part)) {
+            EXPECT_TRUE(part.empty());
+            ++num_parts;
+        }
+    }
+
+    EXPECT_GT(num_parts, 0u);
+    EXPECT_TRUE(transfer.finished());
+    EXPECT_EQ(file, log);
+}
+
+TEST(LogDataTransfer, ResumesWithMissingChunksOnly)
+{
+    constexpr auto chunk_len = LogDataTransfer::CHUNK_LEN;
+    const auto log = example_log(LogDataTransfer::INITIAL_PART_CHUNKS * chunk_len * 3);
+
+    std::vector<bool> chunks_received;
+    uint32_t bytes_completed;
+    {
+        LogDataTransfer transfer(static_cast<uint32_t>(log.size()), false);
+        auto request = transfer.start(0.0);
+        ASSERT_TRUE(request);
+        serve(transfer, log, *request);
+        request = transfer.next_request(0.1);
+        ASSERT_TRUE(request);
+
+        // The link drops after the first few chunks of the second part.
+        for (uint32_t i = 0; i < 5; ++i) {
+            const auto ofs = request->ofs + i * chunk_len;
+            transfer.add_data(ofs, &log[ofs], chunk_len, 0.2);
+        }
+        bytes_completed = transfer.bytes_completed();
+        chunks_received = transfer.chunks_received();
+    }
+
+    EXPECT_EQ(bytes_completed, LogDataTransfer::INITIAL_PART_CHUNKS * chunk_len);
+
+    LogDataTransfer transfer(static_cast<uint32_t>(log.size()), false);
+    auto request = transfer.resume(bytes_completed, chunks_received, 0.0);
+    ASSERT_TRUE(request);
+    EXPECT_EQ(request->ofs, bytes_completed + 5 * chunk_len);
+    EXPECT_EQ(serve(transfer, log, *request), LogDataTransfer::DataResult::RequestServed);
+
+    while ((request = transfer.next_request(1.0))) {
+        serve(transfer, log, *request);
+    }
+    EXPECT_EQ(transfer.bytes_completed(), log.size());
+}
+
+TEST(LogDataTransfer, ResumesFinishedDownload)
+{
+    LogDataTransfer transfer(1000, false);
+    EXPECT_FALSE(transfer.resume(1000, {}, 0.0));
+    EXPECT_TRUE(transfer.finished());
+}
+
+TEST(LogDataTransfer, RequestsOnlyHoles)
+{
+    constexpr auto chunk_len = LogDataTransfer::CHUNK_LEN;
+    const auto log = example_log(LogDataTransfer::INITIAL_PART_CHUNKS * chunk_len);
+    LogDataTransfer transfer(static_cast<uint32_t>(log.size()));
+
+    auto request = transfer.start(0.0);
+    ASSERT_TRUE(request);
+
+    serve(transfer, log, *request, {chunk_len * 3, chunk_len * 4, chunk_len * 10});
+
+    request = transfer.next_request(0.1);
+    ASSERT_TRUE(request);
+    EXPECT_EQ(*request, (LogDataTransfer::Request{chunk_len * 3, chunk_len * 2}));
+    EXPECT_EQ(serve(transfer, log, *request), LogDataTransfer::DataResult::RequestServed);
+
+    request = transfer.next_request(0.2);
+    ASSERT_TRUE(request);
+    EXPECT_EQ(*request, (LogDataTransfer::Request{chunk_len * 10, chunk_len}));
+    EXPECT_EQ(serve(transfer, log, *request), LogDataTransfer::DataResult::RequestServed);
+
+    EXPECT_FALSE(transfer.next_request(0.3));
+    std::vector<uint8_t> part;
+    ASSERT_TRUE(transfer.take_completed_part(part));
+    EXPECT_EQ(part, log);
+    EXPECT_TRUE(transfer.finished());
+}
+
+TEST(LogDataTransfer, RequestsMissingTailTogetherWithNextPart)
+{
+    constexpr auto chunk_len = LogDataTransfer::CHUNK_LEN;
+    constexpr auto part_len = LogDataTransfer::INITIAL_PART_CHUNKS * chunk_len;
+    const auto log = example_log(part_len * 3);
+    LogDataTransfer transfer(static_cast<uint32_t>(log.size()));
+
+    auto request = transfer.start(0.0);
+    ASSERT_TRUE(request);
+
+    // The last two chunks never arrive, so we get there by timeout.
+    EXPECT_EQ(
+        serve(transfer, log, *request, {part_len - 2 * chunk_len, part_len - chunk_len}),
+        LogDataTransfer::DataResult::Stored);
+
+    request = transfer.next_request(0.1);
+    ASSERT_TRUE(request);
+    EXPECT_EQ(
+        *request,
+        (LogDataTransfer::Request{
+            uint32_t(part_len - 2 * chunk_len), uint32_t(2 * chunk_len + part_len)}));
+    EXPECT_EQ(serve(transfer, log, *request), LogDataTransfer::DataResult::RequestServed);
+
+    request = transfer.next_request(0.2);
+    ASSERT_TRUE(request);
+    EXPECT_EQ(request->ofs, 2 * part_len);
+
+    std::vector<uint8_t> part;
+    ASSERT_TRUE(transfer.take_completed_part(part));
+    EXPECT_EQ(part, std::vector<uint8_t>(log.begin(), log.begin() + 2 * part_len));
+}
+
+TEST(LogDataTransfer, IgnoresUnexpectedData)
+{
+    const auto log = example_log(1000);
+    LogDataTransfer transfer(static_cast<uint32_t>(log.size()));
+    ASSERT_TRUE(transfer.start(0.0));
+
+    EXPECT_EQ(transfer.add_data(1000, log.data(), 10, 0.0), LogDataTransfer::DataResult::Ignored);
+    EXPECT_EQ(transfer.add_data(45, log.data(), 90, 0.0), LogDataTransfer::DataResult::Ignored);
+    EXPECT_EQ(transfer.add_data(0, log.data(), 50, 0.0), LogDataTransfer::DataResult::Ignored);
+    EXPECT_EQ(transfer.add_data(0, log.data(), 90, 0.0), LogDataTransfer::DataResult::Stored);
+    // The last chunk is shorter.
+    EXPECT_EQ(
+        transfer.add_data(990, &log[990], 10, 0.0), LogDataTransfer::DataResult::RequestServed);
+}
+
+TEST(LogDataTransfer, NothingToDownload)
+{
+    LogDataTransfer transfer(0);
+    EXPECT_FALSE(transfer.start(0.0));
+    EXPECT_TRUE(transfer.finished());
+}
+
+TEST(LogDataTransfer, SimulatedLinkThroughput)
+{
+    const auto log = example_log(5 * 1024 * 1024);
+
+    const SimulatedLink links[] = {
+        {1.0e6, 0.002, 0.0}, // Local SITL
+        {1.0e6, 0.002, 0.02},
+        {200.0e3, 0.02, 0.05}, // WiFi
+        {10.0e3, 0.1, 0.01}, // Telemetry radio
+    };
+
+    for (const auto& link : links) {
+        // Don't spend ages on the slow link.
+        const auto size = link.bytes_per_s < 100.0e3 ? log.size() / 64 : log.size();
+        const std::vector<uint8_t> data(log.begin(), log.begin() + size);
+
+        const auto result = simulate(link, data);
+        EXPECT_TRUE(result.complete);
+
+        const double mb_s = double(size) / result.duration_s / 1.0e6;
+
+        // Without loss we should get almost all of the link. With loss the
+        // round trips for the holes cost, as only one request can be
+        // served at a time.
+        const double expected = (link.loss == 0.0) ? 0.9 : 0.3;
+        EXPECT_GT(mb_s, expected * link.bytes_per_s / 1.0e6)
+            << "link " << link.bytes_per_s / 1.0e6 << " MB/s, " << link.latency_s * 1000.0
+            << " ms, " << link.loss * 100.0 << "% loss, " << result.num_requests << " requests";
+    }
+}
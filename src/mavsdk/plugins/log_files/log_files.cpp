@@ -91,4 +91,15 @@ std::ostream& operator<<(std::ostream& str, LogFiles::Result const& result)
     }
 }
 
+void LogFiles::download_log_files_async(
+    std::vector<Entry> entries, std::string dir, DownloadLogFilesCallback callback)
+{
+    _impl->download_log_files_async(entries, dir, callback);
+}
+
+void LogFiles::download_log_file_stream_async(Entry entry, DownloadLogFileStreamCallback callback)
+{
+    _impl->download_log_file_stream_async(entry, callback);
+}
+
 } // namespace mavsdk
\ No newline at end of file
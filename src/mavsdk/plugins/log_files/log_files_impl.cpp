@@ -1,14 +1,26 @@
 #include "log_files_impl.h"
 #include "mavsdk_impl.h"
 #include "filesystem_include.h"
+#include "fs.h"
+#include "unused.h"
 
 #include <algorithm>
+#include <cerrno>
 #include <cmath>
-#include <ctime>
 #include <cstring>
+#include <ctime>
+
+#if !defined(WINDOWS)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace mavsdk {
 
+static_assert(
+    LogDataTransfer::CHUNK_LEN == MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN,
+    "Chunks need to match LOG_DATA");
+
 LogFilesImpl::LogFilesImpl(System& system) : PluginImplBase(system)
 {
     _parent->register_plugin(this);
@@ -50,6 +62,10 @@ void LogFilesImpl::deinit()
     {
         std::lock_guard<std::mutex> lock(_data.mutex);
         _parent->unregister_timeout_handler(_data.cookie);
+        if (_data.transfer) {
+            save_resume_info();
+        }
+        finish_logfile();
     }
     _parent->unregister_all_mavlink_message_handlers(this);
 }
@@ -155,7 +171,34 @@ void LogFilesImpl::process_log_entry(const mavlink_message_t& message)
         std::lock_guard<std::mutex> lock(_entries.mutex);
         _entries.entry_map[new_entry.id] = new_entry;
         _entries.max_list_id = log_entry.num_logs;
-        _parent->refresh_timeout_handler(_entries.cookie);
+
+        // No need to wait for the timeout once we have everything.
+        if (_entries.entry_map.size() == _entries.max_list_id) {
+            _parent->unregister_timeout_handler(_entries.cookie);
+            finish_entries();
+        } else {
+            _parent->refresh_timeout_handler(_entries.cookie);
+        }
+    }
+}
+
+void LogFilesImpl::finish_entries()
+{
+    // Assumes to have the lock for _entries.mutex.
+
+    LogDebug() << "Received all entries";
+    // Copy map entries into list to return;
+    std::vector<LogFiles::Entry> entry_list{};
+    for (unsigned i = 0; i < _entries.max_list_id; ++i) {
+        entry_list.push_back(_entries.entry_map[i]);
+    }
+    if (_entries.callback) {
+        const auto tmp_callback = _entries.callback;
+        _parent->call_user_callback([tmp_callback, entry_list]() {
+            tmp_callback(LogFiles::Result::Success, entry_list);
+        });
+        // Entries arriving late must not report the list again.
+        _entries.callback = nullptr;
     }
 }
 
@@ -165,18 +208,7 @@ void LogFilesImpl::list_timeout()
     if (_entries.entry_map.size() == 0) {
         LogWarn() << "No entries received";
     } else if (_entries.entry_map.size() == _entries.max_list_id) {
-        LogDebug() << "Received all entries";
-        // Copy map entries into list to return;
-        std::vector<LogFiles::Entry> entry_list{};
-        for (unsigned i = 0; i < _entries.max_list_id; ++i) {
-            entry_list.push_back(_entries.entry_map[i]);
-        }
-        if (_entries.callback) {
-            const auto tmp_callback = _entries.callback;
-            _parent->call_user_callback([tmp_callback, entry_list]() {
-                tmp_callback(LogFiles::Result::Success, entry_list);
-            });
-        }
+        finish_entries();
     } else {
         if (_entries.retries > 3) {
             LogWarn() << "Too many log entry retries, giving up.";
@@ -205,7 +237,7 @@ void LogFilesImpl::list_timeout()
 void LogFilesImpl::download_log_file_async(
     LogFiles::Entry entry, const std::string& file_path, LogFiles::DownloadLogFileCallback callback)
 {
-    unsigned bytes_to_get;
+    LogFiles::Entry stored_entry;
     {
         std::lock_guard<std::mutex> lock(_entries.mutex);
 
@@ -223,85 +255,288 @@ void LogFilesImpl::download_log_file_async(
             return;
         }
 
-        bytes_to_get = _entries.entry_map[entry.id].size_bytes;
+        stored_entry = it->second;
     }
+    std::lock_guard<std::mutex> lock(_data.mutex);
+    start_download(stored_entry, file_path, callback);
+}
 
+void LogFilesImpl::download_log_file_stream_async(
+    LogFiles::Entry entry, LogFiles::DownloadLogFileStreamCallback callback)
+{
+    const auto report_error = [this, callback](LogFiles::Result result) {
+        if (callback) {
+            _parent->call_user_callback([callback, result]() {
+                LogFiles::ProgressData progress;
+                progress.progress = NAN;
+                callback(result, progress, {});
+            });
+        }
+    };
+
+    LogFiles::Entry stored_entry;
     {
-        std::lock_guard<std::mutex> lock(_data.mutex);
+        std::lock_guard<std::mutex> lock(_entries.mutex);
 
-        if (is_directory(file_path)) {
-            if (callback) {
-                const auto tmp_callback = callback;
-                _parent->call_user_callback([tmp_callback]() {
-                    LogFiles::ProgressData progress;
-                    progress.progress = NAN;
-                    LogErr()
-                        << "Invalid path! The path must point to an unexisting file, and it points to a directory!";
-                    tmp_callback(LogFiles::Result::InvalidArgument, progress);
-                });
-            }
+        auto it = _entries.entry_map.find(entry.id);
+        if (it == _entries.entry_map.end()) {
+            LogErr() << "Log entry id " << entry.id << " not found";
+            report_error(LogFiles::Result::InvalidArgument);
             return;
         }
 
-        if (file_exists(file_path)) {
-            if (callback) {
-                const auto tmp_callback = callback;
-                _parent->call_user_callback([tmp_callback]() {
-                    LogFiles::ProgressData progress;
-                    progress.progress = NAN;
-                    LogErr() << "Target log file already exists!";
-                    tmp_callback(LogFiles::Result::InvalidArgument, progress);
-                });
+        stored_entry = it->second;
+    }
+
+    std::lock_guard<std::mutex> lock(_data.mutex);
+    if (_data.transfer) {
+        LogErr() << "Log download already in progress";
+        report_error(LogFiles::Result::InvalidArgument);
+        return;
+    }
+
+    _data.id = stored_entry.id;
+    _data.stream_callback = callback;
+    _data.time_started = _time.steady_time();
+    _data.bytes_to_get = stored_entry.size_bytes;
+    _data.transfer.emplace(stored_entry.size_bytes, true);
+    _data.date = stored_entry.date;
+
+    _parent->register_timeout_handler(
+        [this]() { LogFilesImpl::data_timeout(); }, DATA_TIMEOUT_S, &_data.cookie);
+
+    continue_download(_data.transfer->start(0.0));
+}
+
+void LogFilesImpl::download_log_files_async(
+    std::vector<LogFiles::Entry> entries,
+    const std::string& dir,
+    LogFiles::DownloadLogFilesCallback callback)
+{
+    auto report_invalid = [this, callback]() {
+        if (callback) {
+            const auto tmp_callback = callback;
+            _parent->call_user_callback([tmp_callback]() {
+                LogFiles::ProgressData progress;
+                progress.progress = NAN;
+                tmp_callback(LogFiles::Result::InvalidArgument, progress);
+            });
+        }
+    };
+
+    if (entries.empty() || !is_directory(dir)) {
+        LogErr() << "Log files need to go into an existing directory";
+        report_invalid();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_entries.mutex);
+
+        for (auto& entry : entries) {
+            auto it = _entries.entry_map.find(entry.id);
+            if (it == _entries.entry_map.end()) {
+                LogErr() << "Log entry id " << entry.id << " not found";
+                report_invalid();
+                return;
             }
-            return;
+            entry = it->second;
         }
+    }
 
-        if (!start_logfile(file_path)) {
-            if (callback) {
-                const auto tmp_callback = callback;
-                _parent->call_user_callback([tmp_callback]() {
+    std::lock_guard<std::mutex> lock(_data.mutex);
+
+    if (_data.transfer || !_data.queue.empty()) {
+        LogErr() << "Log download already in progress";
+        report_invalid();
+        return;
+    }
+
+    _data.queue.assign(entries.begin(), entries.end());
+    _data.queue_dir = dir;
+    _data.queue_bytes_total = 0;
+    for (const auto& entry : entries) {
+        _data.queue_bytes_total += entry.size_bytes;
+    }
+    _data.queue_bytes_done = 0;
+    _data.queue_callback = callback;
+
+    start_next_queued_download();
+}
+
+void LogFilesImpl::start_next_queued_download()
+{
+    // Assumes to have the lock for _data.mutex.
+
+    while (!_data.queue.empty()) {
+        const auto entry = _data.queue.front();
+        _data.queue.pop_front();
+
+        const bool is_last = _data.queue.empty();
+        const auto path = _data.queue_dir + path_separator + log_file_name(entry);
+        const uint64_t bytes_before = _data.queue_bytes_done;
+        const uint64_t bytes_total = _data.queue_bytes_total;
+        _data.queue_bytes_done += entry.size_bytes;
+
+        const auto batch_progress = [bytes_before, bytes_total, entry](float file_progress) {
+            if (bytes_total == 0) {
+                return 1.0f;
+            }
+            return float(
+                (double(bytes_before) + double(file_progress) * double(entry.size_bytes)) /
+                double(bytes_total));
+        };
+
+        const auto queue_callback = _data.queue_callback;
+
+        // Logs downloaded completely before are not downloaded again.
+        if (file_exists(path) && !file_exists(log_resume_path(path)) &&
+            fs_file_size(path) == entry.size_bytes) {
+            LogDebug() << "Log " << entry.id << " is already in " << path;
+            if (queue_callback) {
+                const float progress_so_far = batch_progress(1.0f);
+                _parent->call_user_callback([queue_callback, progress_so_far, is_last]() {
                     LogFiles::ProgressData progress;
-                    progress.progress = NAN;
-                    tmp_callback(LogFiles::Result::FileOpenFailed, progress);
+                    progress.progress = progress_so_far;
+                    queue_callback(
+                        is_last ? LogFiles::Result::Success : LogFiles::Result::Next, progress);
                 });
             }
+            continue;
+        }
+
+        auto file_callback = [queue_callback, batch_progress, is_last](
+                                 LogFiles::Result result, LogFiles::ProgressData progress) {
+            if (!queue_callback) {
+                return;
+            }
+            if (result == LogFiles::Result::Next) {
+                progress.progress = batch_progress(progress.progress);
+            } else if (result == LogFiles::Result::Success) {
+                progress.progress = batch_progress(1.0f);
+                if (!is_last) {
+                    result = LogFiles::Result::Next;
+                }
+            }
+            queue_callback(result, progress);
+        };
+
+        if (start_download(entry, path, file_callback)) {
             return;
         }
 
-        _data.id = entry.id;
-        _data.callback = callback;
-        _data.time_started = _time.steady_time();
-        _data.bytes_to_get = bytes_to_get;
-        _data.part_start = 0;
-        const auto part_size = determine_part_end() - _data.part_start;
-        _data.bytes.resize(part_size);
-        _data.chunks_received.resize(
-            part_size / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN +
-            ((part_size % MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN) != 0));
+        // The error has been reported already, the rest is not downloaded.
+        _data.queue.clear();
+        _data.queue_callback = nullptr;
+    }
+}
 
-        _parent->register_timeout_handler(
-            [this]() { LogFilesImpl::data_timeout(); }, DATA_TIMEOUT_S, &_data.cookie);
+std::string LogFilesImpl::log_file_name(const LogFiles::Entry& entry) const
+{
+    // Colons are not allowed in file names on Windows.
+    std::string date = entry.date;
+    std::replace(date.begin(), date.end(), ':', '-');
 
-        request_log_data(_data.id, _data.part_start, _data.bytes.size());
+    const char* extension =
+        (_parent->autopilot() == SystemImpl::Autopilot::ArduPilot) ? ".bin" : ".ulg";
 
-        if (_data.callback) {
-            const auto tmp_callback = _data.callback;
+    return "log-" + std::to_string(entry.id) + "-" + date + extension;
+}
+
+bool LogFilesImpl::start_download(
+    const LogFiles::Entry& entry,
+    const std::string& file_path,
+    LogFiles::DownloadLogFileCallback callback)
+{
+    // Assumes to have the lock for _data.mutex.
+
+    const unsigned bytes_to_get = entry.size_bytes;
+
+    if (is_directory(file_path)) {
+        if (callback) {
+            const auto tmp_callback = callback;
             _parent->call_user_callback([tmp_callback]() {
                 LogFiles::ProgressData progress;
-                progress.progress = 0.0f;
-                tmp_callback(LogFiles::Result::Next, progress);
+                progress.progress = NAN;
+                LogErr()
+                    << "Invalid path! The path must point to an unexisting file, and it points to a directory!";
+                tmp_callback(LogFiles::Result::InvalidArgument, progress);
             });
         }
+        return false;
     }
-}
 
-std::size_t LogFilesImpl::determine_part_end()
-{
-    // Assumes to have the lock for _data.mutex.
+    std::optional<LogResumeInfo> resume_info;
+    if (file_exists(file_path)) {
+        resume_info = load_resume_info(file_path, entry);
+    }
+
+    if (file_exists(file_path) && !resume_info) {
+        if (callback) {
+            const auto tmp_callback = callback;
+            _parent->call_user_callback([tmp_callback]() {
+                LogFiles::ProgressData progress;
+                progress.progress = NAN;
+                LogErr() << "Target log file already exists!";
+                tmp_callback(LogFiles::Result::InvalidArgument, progress);
+            });
+        }
+        return false;
+    }
 
-    return std::min(
-        _data.part_start + PART_SIZE * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN,
-        std::size_t(_data.bytes_to_get));
+    if (!start_logfile(file_path, bytes_to_get, resume_info.has_value())) {
+        if (callback) {
+            const auto tmp_callback = callback;
+            _parent->call_user_callback([tmp_callback]() {
+                LogFiles::ProgressData progress;
+                progress.progress = NAN;
+                tmp_callback(LogFiles::Result::FileOpenFailed, progress);
+            });
+        }
+        return false;
+    }
+
+    _data.id = entry.id;
+    _data.callback = callback;
+    _data.time_started = _time.steady_time();
+    _data.bytes_to_get = bytes_to_get;
+    _data.transfer.emplace(bytes_to_get, _data.fd < 0);
+    _data.date = entry.date;
+    _data.resume_path = (_data.fd >= 0) ? log_resume_path(file_path) : std::string{};
+
+    _parent->register_timeout_handler(
+        [this]() { LogFilesImpl::data_timeout(); }, DATA_TIMEOUT_S, &_data.cookie);
+
+    std::optional<LogDataTransfer::Request> request;
+    float progress_so_far = 0.0f;
+    if (resume_info && _data.fd >= 0) {
+        LogInfo() << "Resuming download of log " << _data.id << " at "
+                  << resume_info->bytes_completed << " B";
+        request = _data.transfer->resume(
+            resume_info->bytes_completed, resume_info->chunks_received, 0.0);
+        if (bytes_to_get > 0) {
+            progress_so_far = float(resume_info->bytes_completed) / float(bytes_to_get);
+        }
+    } else {
+        if (resume_info) {
+            // The file could only be opened to be written from scratch.
+            fs_remove(log_resume_path(file_path));
+        }
+        request = _data.transfer->start(0.0);
+        save_resume_info();
+    }
+
+    if (_data.callback) {
+        const auto tmp_callback = _data.callback;
+        _parent->call_user_callback([tmp_callback, progress_so_far]() {
+            LogFiles::ProgressData progress;
+            progress.progress = progress_so_far;
+            tmp_callback(LogFiles::Result::Next, progress);
+        });
+    }
+
+    continue_download(request);
+    return true;
 }
 
 void LogFilesImpl::process_log_data(const mavlink_message_t& message)
@@ -320,6 +555,10 @@ void LogFilesImpl::process_log_data(const mavlink_message_t& message)
 
     std::lock_guard<std::mutex> lock(_data.mutex);
 
+    if (!_data.transfer) {
+        return;
+    }
+
     _parent->refresh_timeout_handler(_data.cookie);
 
     if (log_data.count > MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN) {
@@ -327,21 +566,20 @@ void LogFilesImpl::process_log_data(const mavlink_message_t& message)
         return;
     }
 
-    if (log_data.ofs < _data.part_start ||
-        log_data.ofs + log_data.count > _data.part_start + _data.bytes.size()) {
-        LogErr() << "Ignoring wrong offset";
-        return;
-    }
-
-    std::memcpy(&_data.bytes[log_data.ofs - _data.part_start], log_data.data, log_data.count);
-    _data.chunks_received[(log_data.ofs - _data.part_start) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN] =
-        true;
-
-    if (log_data.ofs + log_data.count - _data.part_start == _data.bytes.size() ||
-        _data.rerequesting) {
-        // We received last message of this part.
-        _data.rerequesting = true;
-        check_part();
+    const double now_s = _time.elapsed_since_s(_data.time_started);
+
+    switch (_data.transfer->add_data(log_data.ofs, log_data.data, log_data.count, now_s)) {
+        case LogDataTransfer::DataResult::Ignored:
+            // Data of requests we replaced can still arrive, so this is normal.
+            LogDebug() << "Ignoring data at offset " << log_data.ofs;
+            break;
+        case LogDataTransfer::DataResult::Stored:
+            write_chunk_to_disk(log_data.ofs, log_data.data, log_data.count);
+            break;
+        case LogDataTransfer::DataResult::RequestServed:
+            write_chunk_to_disk(log_data.ofs, log_data.data, log_data.count);
+            continue_download(_data.transfer->next_request(now_s));
+            break;
     }
 }
 
@@ -360,65 +598,121 @@ void LogFilesImpl::report_progress(unsigned transferred, unsigned total)
     }
 }
 
-void LogFilesImpl::check_part()
+void LogFilesImpl::continue_download(std::optional<LogDataTransfer::Request> request)
 {
     // Assumes to have the lock for _data.mutex.
 
-    auto first_missing =
-        std::find(_data.chunks_received.begin(), _data.chunks_received.end(), false);
-    if (first_missing != _data.chunks_received.end()) {
-        auto first_missing_index = std::distance(_data.chunks_received.begin(), first_missing);
+    // Get the vehicle going again before we spend time writing to disk.
+    if (request) {
+        if (_data.stream_callback && _stream_parts_queued >= MAX_STREAM_PARTS_QUEUED) {
+            _data.paused_request = request;
+            _data.stream_paused = true;
+        } else {
+            request_log_data(_data.id, request->ofs, request->count);
+        }
+    }
 
-        auto first_not_missing = std::find(first_missing, _data.chunks_received.end(), true);
+    if (_data.transfer->take_completed_part(_data.part)) {
+        if (_data.stream_callback) {
+            hand_on_part();
+        } else {
+            write_part_to_disk();
+        }
 
-        auto first_not_missing_index =
-            std::distance(_data.chunks_received.begin(), first_not_missing);
+        const auto bytes_completed = _data.transfer->bytes_completed();
+        report_progress(bytes_completed, _data.bytes_to_get);
 
-        request_log_data(
-            _data.id,
-            _data.part_start + first_missing_index * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN,
-            (first_not_missing_index - first_missing_index) * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-    } else {
-        _data.rerequesting = false;
+        const float kib_s = float(bytes_completed) /
+                            float(_time.elapsed_since_s(_data.time_started)) / 1024.0f;
 
-        write_part_to_disk();
+        LogDebug() << bytes_completed << " B of " << _data.bytes_to_get << " B (" << kib_s
+                   << " kiB/s, parts of " << _data.transfer->part_chunks() << " chunks)";
 
-        report_progress(_data.part_start + _data.bytes.size(), _data.bytes_to_get);
+        if (!_data.transfer->finished()) {
+            save_resume_info();
+        }
+    }
 
-        const float kib_s = float(_data.part_start + _data.bytes.size()) /
-                            float(_time.elapsed_since_s(_data.time_started)) / 1024.0f;
+    if (_data.transfer->finished()) {
+        _parent->unregister_timeout_handler(_data.cookie);
+
+        finish_logfile();
 
-        LogDebug() << _data.part_start + _data.bytes.size() << " B of " << _data.bytes_to_get
-                   << " B (" << kib_s << " kiB/s)";
+        const bool write_failed = _data.write_failed;
+        if (!_data.resume_path.empty() && !write_failed) {
+            fs_remove(_data.resume_path);
+        }
 
-        if (_data.part_start + _data.bytes.size() == _data.bytes_to_get) {
-            _parent->unregister_timeout_handler(_data.cookie);
+        if (_data.callback) {
+            const auto tmp_callback = _data.callback;
+            const auto result =
+                write_failed ? LogFiles::Result::FileOpenFailed : LogFiles::Result::Success;
+            _parent->call_user_callback([tmp_callback, result]() {
+                LogFiles::ProgressData progress_data;
+                progress_data.progress = 1.0f;
+                tmp_callback(result, progress_data);
+            });
+        }
 
-            finish_logfile();
+        if (_data.stream_callback) {
+            const auto tmp_callback = _data.stream_callback;
+            _parent->call_user_callback([tmp_callback]() {
+                LogFiles::ProgressData progress_data;
+                progress_data.progress = 1.0f;
+                tmp_callback(LogFiles::Result::Success, progress_data, {});
+            });
+        }
 
-            if (_data.callback) {
-                const auto tmp_callback = _data.callback;
-                _parent->call_user_callback([tmp_callback]() {
-                    LogFiles::ProgressData progress_data;
-                    progress_data.progress = 1.0f;
-                    tmp_callback(LogFiles::Result::Success, progress_data);
-                });
-            }
+        reset_data();
 
-            reset_data();
+        // Keep the link busy with the next log right away.
+        if (write_failed) {
+            _data.queue.clear();
+            _data.queue_callback = nullptr;
         } else {
-            _data.part_start = _data.part_start + _data.bytes.size();
+            start_next_queued_download();
+        }
+    }
+}
 
-            const auto part_size = determine_part_end() - _data.part_start;
-            _data.bytes.resize(part_size);
-            _data.chunks_received.resize(
-                part_size / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN +
-                ((part_size % MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN) != 0));
-            std::fill(_data.chunks_received.begin(), _data.chunks_received.end(), false);
+void LogFilesImpl::hand_on_part()
+{
+    // Assumes to have the lock for _data.mutex.
+
+    // Only called with a part, so there is something to get.
+    LogFiles::ProgressData progress_data;
+    progress_data.progress =
+        float(_data.transfer->bytes_completed()) / float(_data.bytes_to_get);
 
-            request_log_data(_data.id, _data.part_start, _data.bytes.size());
+    ++_stream_parts_queued;
+    _parent->call_user_callback([this,
+                                 tmp_callback = _data.stream_callback,
+                                 progress_data,
+                                 part = std::move(_data.part)]() {
+        tmp_callback(LogFiles::Result::Next, progress_data, part);
+
+        if (_stream_parts_queued.fetch_sub(1) == MAX_STREAM_PARTS_QUEUED) {
+            resume_stream();
         }
+    });
+    _data.part = {};
+}
+
+void LogFilesImpl::resume_stream()
+{
+    std::lock_guard<std::mutex> lock(_data.mutex);
+    if (!_data.stream_paused) {
+        return;
+    }
+
+    _data.stream_paused = false;
+    if (_data.transfer && _data.paused_request) {
+        // The round trip measured for it includes the pause, but as that only
+        // makes the part smaller for a bit, it's not worth tracking.
+        request_log_data(_data.id, _data.paused_request->ofs, _data.paused_request->count);
+        _parent->refresh_timeout_handler(_data.cookie);
     }
+    _data.paused_request.reset();
 }
 
 void LogFilesImpl::request_log_data(unsigned id, unsigned start, unsigned count)
@@ -441,10 +735,17 @@ void LogFilesImpl::data_timeout()
 {
     {
         std::lock_guard<std::mutex> lock(_data.mutex);
+        if (!_data.transfer) {
+            return;
+        }
         _parent->register_timeout_handler(
             [this]() { LogFilesImpl::data_timeout(); }, DATA_TIMEOUT_S, &_data.cookie);
-        _data.rerequesting = true;
-        check_part();
+        if (_data.stream_paused) {
+            // Nothing is missing, we just didn't ask yet.
+            return;
+        }
+        continue_download(
+            _data.transfer->next_request(_time.elapsed_since_s(_data.time_started)));
     }
 }
 
@@ -462,28 +763,130 @@ bool LogFilesImpl::file_exists(const std::string& path) const
     return fs::exists(file_path, ignored);
 }
 
-bool LogFilesImpl::start_logfile(const std::string& path)
+std::optional<LogResumeInfo>
+LogFilesImpl::load_resume_info(const std::string& path, const LogFiles::Entry& entry) const
+{
+    auto info = log_resume_load(log_resume_path(path));
+    if (!info) {
+        return std::nullopt;
+    }
+
+    // The ids are reused once logs are deleted on the vehicle.
+    if (info->id != entry.id || info->size_bytes != entry.size_bytes ||
+        info->date != entry.date || fs_file_size(path) != entry.size_bytes) {
+        LogWarn() << "Partial download " << path << " is of a different log";
+        return std::nullopt;
+    }
+
+    return info;
+}
+
+void LogFilesImpl::save_resume_info()
+{
+    // Assumes to have the lock for _data.mutex.
+
+    if (_data.resume_path.empty() || _data.write_failed) {
+        return;
+    }
+
+    LogResumeInfo info;
+    info.id = _data.id;
+    info.size_bytes = _data.bytes_to_get;
+    info.date = _data.date;
+    info.bytes_completed = _data.transfer->bytes_completed();
+    info.chunks_received = _data.transfer->chunks_received();
+    log_resume_save(_data.resume_path, info);
+}
+
+bool LogFilesImpl::start_logfile(const std::string& path, unsigned size, bool resume)
 {
     // Assumes to have the lock for _data.mutex.
     // Assumes that the path is valid and points to a file (not a directory)
 
-    _data.file.open(path, std::ios::out | std::ios::binary);
+    _data.write_failed = false;
+
+#if !defined(WINDOWS)
+    // With the file at its full size upfront, every chunk can be written to
+    // its place as it arrives, without going through a buffer for the part.
+    const int flags = resume ? O_WRONLY : (O_WRONLY | O_CREAT | O_TRUNC);
+    _data.fd = ::open(path.c_str(), flags, 0644);
+    if (_data.fd < 0) {
+        return false;
+    }
+    if (::ftruncate(_data.fd, static_cast<off_t>(size)) == 0) {
+        return true;
+    }
+    LogWarn() << "Could not preallocate log file, writing it in parts instead";
+    ::close(_data.fd);
+    _data.fd = -1;
+#else
+    UNUSED(size);
+    UNUSED(resume);
+#endif
+
+    _data.file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
 
     return ((_data.file.rdstate() & std::ofstream::failbit) == 0);
 }
 
+void LogFilesImpl::write_chunk_to_disk(uint32_t ofs, const uint8_t* data, std::size_t count)
+{
+    // Assumes to have the lock for _data.mutex.
+
+#if !defined(WINDOWS)
+    if (_data.fd < 0) {
+        return;
+    }
+
+    while (count > 0) {
+        const auto written = ::pwrite(_data.fd, data, count, static_cast<off_t>(ofs));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (!_data.write_failed) {
+                LogErr() << "Could not write to log file: " << strerror(errno);
+                _data.write_failed = true;
+            }
+            return;
+        }
+        data += written;
+        ofs += static_cast<uint32_t>(written);
+        count -= static_cast<std::size_t>(written);
+    }
+#else
+    UNUSED(ofs);
+    UNUSED(data);
+    UNUSED(count);
+#endif
+}
+
 void LogFilesImpl::write_part_to_disk()
 {
     // Assumes to have the lock for _data.mutex.
 
-    _data.file.write(reinterpret_cast<char*>(_data.bytes.data()), _data.bytes.size());
+    // The chunks have been written already.
+    if (_data.fd >= 0) {
+        return;
+    }
+
+    _data.file.write(reinterpret_cast<char*>(_data.part.data()), _data.part.size());
 }
 
 void LogFilesImpl::finish_logfile()
 {
     // Assumes to have the lock for _data.mutex.
 
-    _data.file.close();
+#if !defined(WINDOWS)
+    if (_data.fd >= 0) {
+        ::close(_data.fd);
+        _data.fd = -1;
+    }
+#endif
+
+    if (_data.file.is_open()) {
+        _data.file.close();
+    }
 }
 
 void LogFilesImpl::reset_data()
@@ -491,13 +894,14 @@ void LogFilesImpl::reset_data()
     // Assumes to have the lock for _data.mutex.
     _data.id = 0;
     _data.bytes_to_get = 0;
-    _data.bytes.clear();
-    _data.chunks_received.clear();
-    _data.part_start = 0;
-    _data.retries = 0;
-    _data.rerequesting = false;
-    _data.last_ofs_rerequested = -1;
+    _data.transfer.reset();
+    _data.part.clear();
+    _data.resume_path.clear();
+    _data.date.clear();
     _data.callback = nullptr;
+    _data.stream_callback = nullptr;
+    _data.paused_request.reset();
+    _data.stream_paused = false;
 }
 
 } // namespace mavsdk
@@ -1,10 +1,15 @@
 #pragma once
 
 #include "mavlink_include.h"
+#include "log_data_transfer.h"
+#include "log_resume.h"
 #include "plugins/log_files/log_files.h"
 #include "plugin_impl_base.h"
 #include "system.h"
+#include <atomic>
+#include <deque>
 #include <fstream>
+#include <optional>
 
 namespace mavsdk {
 
@@ -28,31 +33,52 @@ public:
         const std::string& file_path,
         LogFiles::DownloadLogFileCallback callback);
 
+    void download_log_file_stream_async(
+        LogFiles::Entry entry, LogFiles::DownloadLogFileStreamCallback callback);
+
+    void download_log_files_async(
+        std::vector<LogFiles::Entry> entries,
+        const std::string& dir,
+        LogFiles::DownloadLogFilesCallback callback);
+
 private:
     void request_end();
 
     void process_log_entry(const mavlink_message_t& message);
     void process_log_data(const mavlink_message_t& message);
     void list_timeout();
+    void finish_entries();
 
     void request_list_entry(int entry_id);
 
-    void check_part();
+    bool start_download(
+        const LogFiles::Entry& entry,
+        const std::string& file_path,
+        LogFiles::DownloadLogFileCallback callback);
+    void start_next_queued_download();
+    void hand_on_part();
+    void resume_stream();
+    std::string log_file_name(const LogFiles::Entry& entry) const;
+    void continue_download(std::optional<LogDataTransfer::Request> request);
     void request_log_data(unsigned id, unsigned start, unsigned count);
     void data_timeout();
 
     bool is_directory(const std::string& path) const;
     bool file_exists(const std::string& path) const;
-    bool start_logfile(const std::string& path);
+    std::optional<LogResumeInfo>
+    load_resume_info(const std::string& path, const LogFiles::Entry& entry) const;
+    void save_resume_info();
+    bool start_logfile(const std::string& path, unsigned size, bool resume);
+    void write_chunk_to_disk(uint32_t ofs, const uint8_t* data, std::size_t count);
     void write_part_to_disk();
     void finish_logfile();
     void report_progress(unsigned transferred, unsigned total);
 
-    std::size_t determine_part_end();
     void reset_data();
 
     static constexpr double LIST_TIMEOUT_S = 0.2;
     static constexpr double DATA_TIMEOUT_S = 0.1;
+    static constexpr unsigned MAX_STREAM_PARTS_QUEUED = 2;
 
     Time _time{};
 
@@ -65,31 +91,49 @@ private:
         void* cookie{nullptr};
     } _entries{};
 
-    // We download data in parts of 512 * 90 bytes.
+    // We download data in parts, see LogDataTransfer for how they are sized.
     // If we request the whole file at once we get too much data at once and
     // can't keep up (at least for PX4 SITL). Also, we need to keep track of
-    // way too many parts which makes the progress and re-transmission
+    // way too many chunks which makes the progress and re-transmission
     // calculation too expensive.
     //
     // This is very much inspired from how QGroundControl does it.
-    static constexpr unsigned PART_SIZE = 512;
-    // A part refers to the
-
     struct {
         std::mutex mutex{};
         void* cookie{nullptr};
         unsigned id{0};
         unsigned bytes_to_get{0};
-        std::vector<uint8_t> bytes{};
-        std::vector<bool> chunks_received{};
-        std::size_t part_start{0};
-        unsigned retries{0};
-        bool rerequesting{false};
-        int last_ofs_rerequested{-1};
+        std::optional<LogDataTransfer> transfer{};
+        std::vector<uint8_t> part{};
+        // Where possible, chunks are written straight to their offset in the
+        // file using fd, otherwise complete parts are written to file.
+        int fd{-1};
+        bool write_failed{false};
+        // Only with chunks written straight to file can we record what is
+        // there and resume later.
+        std::string resume_path{};
+        std::string date{};
+
+        // Downloads of download_log_files_async still to do, each one is
+        // started right when the one before completes.
+        std::deque<LogFiles::Entry> queue{};
+        std::string queue_dir{};
+        uint64_t queue_bytes_total{0};
+        uint64_t queue_bytes_done{0};
+        LogFiles::DownloadLogFilesCallback queue_callback{nullptr};
         dl_time_t time_started{};
         std::ofstream file{};
         LogFiles::DownloadLogFileCallback callback{nullptr};
+
+        // Instead of a file, download_log_file_stream_async hands the parts
+        // on. The next request waits while the callback is behind.
+        LogFiles::DownloadLogFileStreamCallback stream_callback{nullptr};
+        std::optional<LogDataTransfer::Request> paused_request{};
+        bool stream_paused{false};
     } _data{};
+
+    // Parts handed on but not called back yet, also of downloads finished since.
+    std::atomic<unsigned> _stream_parts_queued{0};
 };
 
 } // namespace mavsdk
@@ -0,0 +1,152 @@
+#include "log_resume.h"
+#include "crc32.h"
+#include "fs.h"
+#include "log.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace mavsdk {
+
+// Bump the last char whenever the format changes, old files are then just
+// ignored and the download starts over.
+static constexpr char file_magic[4] = {'M', 'L', 'R', '1'};
+static constexpr std::size_t crc_len = 4;
+
+static void put_uint(std::vector<uint8_t>& buffer, uint32_t value)
+{
+    for (std::size_t i = 0; i < 4; ++i) {
+        buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+static bool get_uint(const std::vector<uint8_t>& buffer, std::size_t& pos, uint32_t& value)
+{
+    if (buffer.size() - pos < 4) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(buffer[pos++]) << (8 * i);
+    }
+    return true;
+}
+
+static uint32_t checksum(const std::vector<uint8_t>& buffer, std::size_t len)
+{
+    Crc32 crc;
+    crc.add(buffer.data(), static_cast<uint32_t>(len));
+    return crc.get();
+}
+
+std::string log_resume_path(const std::string& log_path)
+{
+    return log_path + ".resume";
+}
+
+bool log_resume_save(const std::string& path, const LogResumeInfo& info)
+{
+    std::vector<uint8_t> buffer;
+    buffer.reserve(
+        sizeof(file_magic) + 6 * 4 + info.date.size() + info.chunks_received.size() / 8 + 1 +
+        crc_len);
+
+    buffer.insert(buffer.end(), std::begin(file_magic), std::end(file_magic));
+    put_uint(buffer, info.id);
+    put_uint(buffer, info.size_bytes);
+    put_uint(buffer, static_cast<uint32_t>(info.date.size()));
+    buffer.insert(buffer.end(), info.date.begin(), info.date.end());
+    put_uint(buffer, info.bytes_completed);
+    put_uint(buffer, static_cast<uint32_t>(info.chunks_received.size()));
+
+    uint8_t bits = 0;
+    for (std::size_t i = 0; i < info.chunks_received.size(); ++i) {
+        if (info.chunks_received[i]) {
+            bits |= static_cast<uint8_t>(1 << (i % 8));
+        }
+        if (i % 8 == 7) {
+            buffer.push_back(bits);
+            bits = 0;
+        }
+    }
+    if (info.chunks_received.size() % 8 != 0) {
+        buffer.push_back(bits);
+    }
+
+    put_uint(buffer, checksum(buffer, buffer.size()));
+
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            LogWarn() << "Could not write log resume info " << tmp_path;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        if (!file) {
+            LogWarn() << "Could not write log resume info " << tmp_path;
+            fs_remove(tmp_path);
+            return false;
+        }
+    }
+
+    if (!fs_rename(tmp_path, path)) {
+        LogWarn() << "Could not move log resume info to " << path;
+        fs_remove(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+std::optional<LogResumeInfo> log_resume_load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+
+    std::vector<uint8_t> buffer(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (buffer.size() < sizeof(file_magic) + crc_len ||
+        std::memcmp(buffer.data(), file_magic, sizeof(file_magic)) != 0) {
+        LogDebug() << "Ignoring log resume info " << path << " of unknown format";
+        return std::nullopt;
+    }
+
+    const std::size_t payload_len = buffer.size() - crc_len;
+    std::size_t pos = payload_len;
+    uint32_t crc;
+    get_uint(buffer, pos, crc);
+    if (crc != checksum(buffer, payload_len)) {
+        LogWarn() << "Ignoring corrupt log resume info " << path;
+        return std::nullopt;
+    }
+    buffer.resize(payload_len);
+
+    LogResumeInfo info;
+    pos = sizeof(file_magic);
+    uint32_t date_len;
+    if (!get_uint(buffer, pos, info.id) || !get_uint(buffer, pos, info.size_bytes) ||
+        !get_uint(buffer, pos, date_len) || buffer.size() - pos < date_len) {
+        return std::nullopt;
+    }
+    info.date.assign(reinterpret_cast<const char*>(buffer.data() + pos), date_len);
+    pos += date_len;
+
+    uint32_t num_chunks;
+    if (!get_uint(buffer, pos, info.bytes_completed) || !get_uint(buffer, pos, num_chunks) ||
+        buffer.size() - pos != (std::size_t(num_chunks) + 7) / 8) {
+        return std::nullopt;
+    }
+
+    info.chunks_received.resize(num_chunks);
+    for (std::size_t i = 0; i < num_chunks; ++i) {
+        info.chunks_received[i] = (buffer[pos + i / 8] & (1 << (i % 8))) != 0;
+    }
+
+    return info;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+
+// What is needed to carry on with an interrupted log download. It is kept
+// in a small file next to the partial log file.
+struct LogResumeInfo {
+    // Together these identify the log on the vehicle.
+    uint32_t id{0};
+    uint32_t size_bytes{0};
+    std::string date{};
+
+    // Everything before bytes_completed is in the file, and the chunks after
+    // it that are marked.
+    uint32_t bytes_completed{0};
+    std::vector<bool> chunks_received{};
+};
+
+std::string log_resume_path(const std::string& log_path);
+
+// The file is binary: the fields in little endian with the chunks packed
+// into bits, and a CRC32 of everything before it at the end. Like the
+// param cache, it is written to a temporary file first and then renamed.
+bool log_resume_save(const std::string& path, const LogResumeInfo& info);
+
+// Returns nullopt if there is no file or it can't be used.
+std::optional<LogResumeInfo> log_resume_load(const std::string& path);
+
+} // namespace mavsdk
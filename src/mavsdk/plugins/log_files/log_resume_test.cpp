@@ -0,0 +1,93 @@
+#include "log_resume.h"
+#include "fs.h"
+
+#include <fstream>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+LogResumeInfo example_info()
+{
+    LogResumeInfo info;
+    info.id = 7;
+    info.size_bytes = 123456789;
+    info.date = "2026-10-14T12:34:56Z";
+    info.bytes_completed = 46080;
+    info.chunks_received = {true, true, false, true, false, false, false, false, true, true, true};
+    return info;
+}
+} // namespace
+
+TEST(LogResume, SaveAndLoad)
+{
+    const auto dir = create_tmp_directory("mavsdk-log-resume-test");
+    ASSERT_TRUE(dir);
+    const auto path = log_resume_path(*dir + path_separator + "log.ulg");
+
+    const auto info = example_info();
+    ASSERT_TRUE(log_resume_save(path, info));
+
+    const auto loaded = log_resume_load(path);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->id, info.id);
+    EXPECT_EQ(loaded->size_bytes, info.size_bytes);
+    EXPECT_EQ(loaded->date, info.date);
+    EXPECT_EQ(loaded->bytes_completed, info.bytes_completed);
+    EXPECT_EQ(loaded->chunks_received, info.chunks_received);
+
+    fs_remove(path);
+}
+
+TEST(LogResume, NoChunks)
+{
+    const auto dir = create_tmp_directory("mavsdk-log-resume-test");
+    ASSERT_TRUE(dir);
+    const auto path = log_resume_path(*dir + path_separator + "empty.ulg");
+
+    auto info = example_info();
+    info.chunks_received.clear();
+    info.date.clear();
+    ASSERT_TRUE(log_resume_save(path, info));
+
+    const auto loaded = log_resume_load(path);
+    ASSERT_TRUE(loaded);
+    EXPECT_TRUE(loaded->date.empty());
+    EXPECT_TRUE(loaded->chunks_received.empty());
+
+    fs_remove(path);
+}
+
+TEST(LogResume, MissingFile)
+{
+    EXPECT_FALSE(log_resume_load("/this/does/not/exist.ulg.resume"));
+}
+
+TEST(LogResume, RejectsCorruptFile)
+{
+    const auto dir = create_tmp_directory("mavsdk-log-resume-test");
+    ASSERT_TRUE(dir);
+    const auto path = log_resume_path(*dir + path_separator + "corrupt.ulg");
+
+    ASSERT_TRUE(log_resume_save(path, example_info()));
+
+    // Flip a bit in the middle of the file.
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(10);
+        char c;
+        file.get(c);
+        file.seekp(10);
+        file.put(static_cast<char>(c ^ 0x01));
+    }
+    EXPECT_FALSE(log_resume_load(path));
+
+    // Truncated
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write("MLR1", 4);
+    }
+    EXPECT_FALSE(log_resume_load(path));
+
+    fs_remove(path);
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "mavsdk/plugin_base.h"
+
+namespace mavsdk {
+
+class System;
+class LoggingImpl;
+
+/**
+ * @brief The Logging class streams the ULog log of the vehicle while it is
+ * being recorded.
+ *
+ * PX4 sends the log as it is written with LOGGING_DATA and
+ * LOGGING_DATA_ACKED, and the plugin writes it to a file. Lost data is cut
+ * out, so the file can still be read, with dropouts marking the gaps.
+ */
+class Logging : public PluginBase {
+public:
+    /**
+     * @brief Constructor. Creates the plugin for a specific System.
+     *
+     * The plugin is typically created as shown below:
+     *
+     *     ```cpp
+     *     auto logging = Logging(system);
+     *     ```
+     *
+     * @param system The specific system associated with this plugin.
+     */
+    explicit Logging(System& system); // deprecated
+
+    /**
+     * @brief Constructor. Creates the plugin for a specific System.
+     *
+     * The plugin is typically created as shown below:
+     *
+     *     ```cpp
+     *     auto logging = Logging(system);
+     *     ```
+     *
+     * @param system The specific system associated with this plugin.
+     */
+    explicit Logging(std::shared_ptr<System> system); // new
+
+    /**
+     * @brief Destructor (internal use only).
+     */
+    ~Logging();
+
+    /**
+     * @brief Possible results returned for requests.
+     */
+    enum class Result {
+        Unknown, /**< @brief Unknown error. */
+        Success, /**< @brief Success. */
+        NoSystem, /**< @brief No system connected. */
+        ConnectionError, /**< @brief Connection error. */
+        Busy, /**< @brief Already streaming a log. */
+        CommandDenied, /**< @brief The vehicle denied the request. */
+        Timeout, /**< @brief A timeout happened. */
+        FileOpenFailed, /**< @brief The file could not be opened. */
+    };
+
+    /**
+     * @brief Stream operator to print information about a `Logging::Result`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream& operator<<(std::ostream& str, Logging::Result const& result);
+
+    /**
+     * @brief Callback type for asynchronous Logging calls.
+     */
+    using ResultCallback = std::function<void(Result)>;
+
+    /**
+     * @brief Statistics of the log being streamed, or the last one.
+     */
+    struct Stats {
+        uint64_t bytes_written{0}; /**< @brief Bytes written to the file so far. */
+        uint64_t packets_received{0}; /**< @brief Packets received. */
+        uint64_t packets_lost{0}; /**< @brief Packets which never arrived. */
+        uint64_t duplicates{0}; /**< @brief Packets received more than once. */
+    };
+
+    /**
+     * @brief Start logging on the vehicle and stream the log to a file.
+     *
+     * The file is overwritten if it exists.
+     *
+     * This function is non-blocking. See 'start_logging' for the blocking counterpart.
+     */
+    void start_logging_async(const std::string& file_path, const ResultCallback& callback);
+
+    /**
+     * @brief Start logging on the vehicle and stream the log to a file.
+     *
+     * This function is blocking. See 'start_logging_async' for the non-blocking counterpart.
+     *
+     * @return Result of request.
+     */
+    Result start_logging(const std::string& file_path) const;
+
+    /**
+     * @brief Stop logging on the vehicle, and finish the file.
+     *
+     * This can also be used to stop logging which was not started by us.
+     * The file is complete by the time the result is reported.
+     *
+     * This function is non-blocking. See 'stop_logging' for the blocking counterpart.
+     */
+    void stop_logging_async(const ResultCallback& callback);
+
+    /**
+     * @brief Stop logging on the vehicle, and finish the file.
+     *
+     * This function is blocking. See 'stop_logging_async' for the non-blocking counterpart.
+     *
+     * @return Result of request.
+     */
+    Result stop_logging() const;
+
+    /**
+     * @brief Get statistics of the log being streamed.
+     *
+     * @return The statistics.
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Copy constructor (object is not copyable).
+     */
+    Logging(const Logging&) = delete;
+
+    /**
+     * @brief Equality operator (object is not copyable).
+     */
+    const Logging& operator=(const Logging&) = delete;
+
+private:
+    /** @private Underlying implementation, set at instantiation */
+    std::unique_ptr<LoggingImpl> _impl;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,64 @@
+#include "plugins/logging/logging.h"
+#include "logging_impl.h"
+
+namespace mavsdk {
+
+Logging::Logging(System& system) : PluginBase(), _impl{std::make_unique<LoggingImpl>(system)} {}
+
+Logging::Logging(std::shared_ptr<System> system) :
+    PluginBase(),
+    _impl{std::make_unique<LoggingImpl>(system)}
+{}
+
+Logging::~Logging() {}
+
+void Logging::start_logging_async(const std::string& file_path, const ResultCallback& callback)
+{
+    _impl->start_logging_async(file_path, callback);
+}
+
+Logging::Result Logging::start_logging(const std::string& file_path) const
+{
+    return _impl->start_logging(file_path);
+}
+
+void Logging::stop_logging_async(const ResultCallback& callback)
+{
+    _impl->stop_logging_async(callback);
+}
+
+Logging::Result Logging::stop_logging() const
+{
+    return _impl->stop_logging();
+}
+
+Logging::Stats Logging::stats() const
+{
+    return _impl->stats();
+}
+
+std::ostream& operator<<(std::ostream& str, Logging::Result const& result)
+{
+    switch (result) {
+        case Logging::Result::Unknown:
+            return str << "Unknown";
+        case Logging::Result::Success:
+            return str << "Success";
+        case Logging::Result::NoSystem:
+            return str << "No System";
+        case Logging::Result::ConnectionError:
+            return str << "Connection Error";
+        case Logging::Result::Busy:
+            return str << "Busy";
+        case Logging::Result::CommandDenied:
+            return str << "Command Denied";
+        case Logging::Result::Timeout:
+            return str << "Timeout";
+        case Logging::Result::FileOpenFailed:
+            return str << "File Open Failed";
+        default:
+            return str << "Unknown";
+    }
+}
+
+} // namespace mavsdk
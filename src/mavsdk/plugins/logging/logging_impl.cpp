@@ -0,0 +1,360 @@
+#include "logging_impl.h"
+
+#include <algorithm>
+#include <future>
+
+namespace mavsdk {
+
+LoggingImpl::LoggingImpl(System& system) : PluginImplBase(system)
+{
+    _parent->register_plugin(this);
+}
+
+LoggingImpl::LoggingImpl(std::shared_ptr<System> system) : PluginImplBase(std::move(system))
+{
+    _parent->register_plugin(this);
+}
+
+LoggingImpl::~LoggingImpl()
+{
+    _parent->unregister_plugin(this);
+}
+
+void LoggingImpl::init()
+{
+    // Handled right on the thread receiving them, there is no user callback
+    // involved on the way to the file.
+    _parent->register_mavlink_message_handler(
+        MAVLINK_MSG_ID_LOGGING_DATA,
+        [this](const mavlink_message_t& message) { process_logging_data(message); },
+        this);
+
+    _parent->register_mavlink_message_handler(
+        MAVLINK_MSG_ID_LOGGING_DATA_ACKED,
+        [this](const mavlink_message_t& message) { process_logging_data_acked(message); },
+        this);
+}
+
+void LoggingImpl::deinit()
+{
+    _parent->unregister_all_mavlink_message_handlers(this);
+
+    bool was_streaming;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        was_streaming = _stream.has_value();
+    }
+    if (was_streaming) {
+        MavlinkCommandSender::CommandLong command{};
+        command.command = MAV_CMD_LOGGING_STOP;
+        command.target_component_id = _parent->get_autopilot_id();
+        _parent->send_command_async(command, [](MavlinkCommandSender::Result, float) {});
+    }
+
+    // Whatever is still queued is written here instead.
+    _parent->cancel_work(this);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stream) {
+            _full_buffers.emplace_back();
+            _stream->take_buffer(_full_buffers.back());
+            _stream.reset();
+        }
+    }
+    write_queued_buffers();
+
+    std::lock_guard<std::mutex> file_lock(_file_mutex);
+    if (_file.is_open()) {
+        _file.close();
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _file_in_use = false;
+}
+
+void LoggingImpl::enable() {}
+
+void LoggingImpl::disable() {}
+
+Logging::Result LoggingImpl::start_logging(const std::string& file_path)
+{
+    std::promise<Logging::Result> prom;
+    auto fut = prom.get_future();
+
+    start_logging_async(file_path, [&prom](Logging::Result result) { prom.set_value(result); });
+    return fut.get();
+}
+
+void LoggingImpl::start_logging_async(
+    const std::string& file_path, const Logging::ResultCallback& callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_file_in_use) {
+            report_result(callback, Logging::Result::Busy);
+            return;
+        }
+        _file_in_use = true;
+    }
+
+    bool opened;
+    {
+        // The file mutex is never taken while holding the other one.
+        std::lock_guard<std::mutex> file_lock(_file_mutex);
+        _file.open(file_path, std::ios::binary | std::ios::trunc);
+        opened = _file.is_open();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!opened) {
+            _file_in_use = false;
+        } else {
+            _stream.emplace();
+            _stats = {};
+            _bytes_written = 0;
+        }
+    }
+
+    if (!opened) {
+        LogErr() << "Could not open " << file_path;
+        report_result(callback, Logging::Result::FileOpenFailed);
+        return;
+    }
+
+    MavlinkCommandSender::CommandLong command{};
+    command.command = MAV_CMD_LOGGING_START;
+    command.params.maybe_param1 = 0.0f; // ULog
+    command.target_component_id = _parent->get_autopilot_id();
+
+    _parent->send_command_async(
+        command, [this, callback](MavlinkCommandSender::Result command_result, float) {
+            if (command_result == MavlinkCommandSender::Result::InProgress) {
+                return;
+            }
+            const auto result = logging_result_from_command_result(command_result);
+            if (result != Logging::Result::Success) {
+                finish_stream();
+            }
+            report_result(callback, result);
+        });
+}
+
+Logging::Result LoggingImpl::stop_logging()
+{
+    std::promise<Logging::Result> prom;
+    auto fut = prom.get_future();
+
+    stop_logging_async([&prom](Logging::Result result) { prom.set_value(result); });
+    return fut.get();
+}
+
+void LoggingImpl::stop_logging_async(const Logging::ResultCallback& callback)
+{
+    MavlinkCommandSender::CommandLong command{};
+    command.command = MAV_CMD_LOGGING_STOP;
+    command.target_component_id = _parent->get_autopilot_id();
+
+    _parent->send_command_async(
+        command, [this, callback](MavlinkCommandSender::Result command_result, float) {
+            if (command_result == MavlinkCommandSender::Result::InProgress) {
+                return;
+            }
+            // Whatever the vehicle says, what we have is kept.
+            finish_stream();
+
+            // Reported once the file is written and closed.
+            const auto result = logging_result_from_command_result(command_result);
+            _parent->queue_work(
+                [this, callback, result]() { report_result(callback, result); }, this);
+        });
+}
+
+Logging::Stats LoggingImpl::stats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto stats = _stats;
+    if (_stream) {
+        stats.packets_received = _stream->packets_received();
+        stats.packets_lost = _stream->packets_lost();
+        stats.duplicates = _stream->duplicates();
+    }
+    stats.bytes_written = _bytes_written;
+    return stats;
+}
+
+void LoggingImpl::process_logging_data(const mavlink_message_t& message)
+{
+    mavlink_logging_data_t logging_data;
+    mavlink_msg_logging_data_decode(&message, &logging_data);
+
+    if (logging_data.target_system != _parent->get_own_system_id()) {
+        return;
+    }
+
+    add_data(
+        logging_data.sequence,
+        logging_data.data,
+        logging_data.length,
+        logging_data.first_message_offset);
+}
+
+void LoggingImpl::process_logging_data_acked(const mavlink_message_t& message)
+{
+    mavlink_logging_data_acked_t logging_data;
+    mavlink_msg_logging_data_acked_decode(&message, &logging_data);
+
+    if (logging_data.target_system != _parent->get_own_system_id()) {
+        return;
+    }
+
+    // The logger waits for the ack before it sends anything else, so it goes
+    // out first. Duplicates are acked again, as our ack was probably lost.
+    send_ack(logging_data.sequence);
+
+    add_data(
+        logging_data.sequence,
+        logging_data.data,
+        logging_data.length,
+        logging_data.first_message_offset);
+}
+
+void LoggingImpl::add_data(
+    uint16_t sequence, const uint8_t* data, uint8_t length, uint8_t first_message_offset)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_stream) {
+        return;
+    }
+
+    const auto result = _stream->add(
+        sequence,
+        data,
+        std::min<std::size_t>(length, MAVLINK_MSG_LOGGING_DATA_FIELD_DATA_LEN),
+        first_message_offset,
+        _time.elapsed_s());
+
+    if (result == UlogStream::AddResult::BufferFull) {
+        if (_spare_buffers.empty()) {
+            _full_buffers.emplace_back();
+        } else {
+            _full_buffers.push_back(std::move(_spare_buffers.back()));
+            _spare_buffers.pop_back();
+        }
+        _stream->take_buffer(_full_buffers.back());
+        queue_write(false);
+    }
+}
+
+void LoggingImpl::send_ack(uint16_t sequence)
+{
+    mavlink_message_t message;
+    mavlink_msg_logging_ack_pack(
+        _parent->get_own_system_id(),
+        _parent->get_own_component_id(),
+        &message,
+        _parent->get_system_id(),
+        _parent->get_autopilot_id(),
+        sequence);
+    _parent->send_message(message);
+}
+
+void LoggingImpl::finish_stream()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_stream) {
+        return;
+    }
+
+    _full_buffers.emplace_back();
+    _stream->take_buffer(_full_buffers.back());
+
+    _stats.packets_received = _stream->packets_received();
+    _stats.packets_lost = _stream->packets_lost();
+    _stats.duplicates = _stream->duplicates();
+    _stream.reset();
+
+    queue_write(true);
+}
+
+void LoggingImpl::queue_write(bool close_after)
+{
+    _parent->queue_work(
+        [this, close_after]() {
+            write_queued_buffers();
+            if (close_after) {
+                {
+                    std::lock_guard<std::mutex> file_lock(_file_mutex);
+                    _file.close();
+                }
+                std::lock_guard<std::mutex> lock(_mutex);
+                _file_in_use = false;
+            }
+        },
+        this);
+}
+
+void LoggingImpl::write_queued_buffers()
+{
+    std::lock_guard<std::mutex> file_lock(_file_mutex);
+
+    while (true) {
+        std::vector<uint8_t> buffer;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_full_buffers.empty()) {
+                return;
+            }
+            buffer = std::move(_full_buffers.front());
+            _full_buffers.pop_front();
+        }
+
+        // A few hundred KB in one go, rather than each packet on its own.
+        if (_file.is_open() && !buffer.empty()) {
+            _file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+            if (!_file) {
+                LogErr() << "Writing log failed";
+            } else {
+                _bytes_written += buffer.size();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        // Two are enough to keep receiving while one is written.
+        if (_spare_buffers.size() < 2) {
+            _spare_buffers.push_back(std::move(buffer));
+        }
+    }
+}
+
+void LoggingImpl::report_result(const Logging::ResultCallback& callback, Logging::Result result)
+{
+    if (callback == nullptr) {
+        return;
+    }
+
+    _parent->call_user_callback([callback, result]() { callback(result); });
+}
+
+Logging::Result
+LoggingImpl::logging_result_from_command_result(MavlinkCommandSender::Result result)
+{
+    switch (result) {
+        case MavlinkCommandSender::Result::Success:
+            return Logging::Result::Success;
+        case MavlinkCommandSender::Result::NoSystem:
+            return Logging::Result::NoSystem;
+        case MavlinkCommandSender::Result::ConnectionError:
+            return Logging::Result::ConnectionError;
+        case MavlinkCommandSender::Result::Busy:
+            return Logging::Result::Busy;
+        case MavlinkCommandSender::Result::CommandDenied:
+        case MavlinkCommandSender::Result::Unsupported:
+            return Logging::Result::CommandDenied;
+        case MavlinkCommandSender::Result::Timeout:
+            return Logging::Result::Timeout;
+        default:
+            return Logging::Result::Unknown;
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include "plugins/logging/logging.h"
+#include "plugin_impl_base.h"
+#include "system.h"
+#include "ulog_stream.h"
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace mavsdk {
+
+class LoggingImpl : public PluginImplBase {
+public:
+    explicit LoggingImpl(System& system);
+    explicit LoggingImpl(std::shared_ptr<System> system);
+    ~LoggingImpl() override;
+
+    void init() override;
+    void deinit() override;
+
+    void enable() override;
+    void disable() override;
+
+    Logging::Result start_logging(const std::string& file_path);
+    void start_logging_async(const std::string& file_path, const Logging::ResultCallback& callback);
+
+    Logging::Result stop_logging();
+    void stop_logging_async(const Logging::ResultCallback& callback);
+
+    Logging::Stats stats() const;
+
+private:
+    void process_logging_data(const mavlink_message_t& message);
+    void process_logging_data_acked(const mavlink_message_t& message);
+    void add_data(
+        uint16_t sequence, const uint8_t* data, uint8_t length, uint8_t first_message_offset);
+    void send_ack(uint16_t sequence);
+
+    // Ends the streaming, the rest is written and the file is closed with the
+    // queued work.
+    void finish_stream();
+    void queue_write(bool close_after);
+    void write_queued_buffers();
+
+    void report_result(const Logging::ResultCallback& callback, Logging::Result result);
+    static Logging::Result logging_result_from_command_result(MavlinkCommandSender::Result result);
+
+    Time _time{};
+
+    // Held by the thread receiving the log, so it's only ever held briefly to
+    // keep the acks going out promptly.
+    mutable std::mutex _mutex{};
+    std::optional<UlogStream> _stream{};
+    Logging::Stats _stats{};
+    // Full buffers waiting to be written, and written ones to be used again.
+    std::deque<std::vector<uint8_t>> _full_buffers{};
+    std::vector<std::vector<uint8_t>> _spare_buffers{};
+    // Set from opening the file until it is closed, which is after the stream
+    // has ended.
+    bool _file_in_use{false};
+
+    // The file is only written with the queued work, so it never holds up
+    // receiving.
+    std::mutex _file_mutex{};
+    std::ofstream _file{};
+    std::atomic<uint64_t> _bytes_written{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,126 @@
+#include "ulog_stream.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mavsdk {
+
+UlogStream::UlogStream(std::size_t buffer_size) : _buffer_size(buffer_size)
+{
+    _buffer.reserve(_buffer_size);
+}
+
+UlogStream::AddResult UlogStream::add(
+    uint16_t sequence,
+    const uint8_t* data,
+    std::size_t length,
+    uint8_t first_message_offset,
+    double now_s)
+{
+    if (!_started) {
+        _started = true;
+        _next_sequence = sequence;
+    }
+
+    const auto ahead = static_cast<int16_t>(static_cast<uint16_t>(sequence - _next_sequence));
+    if (ahead < 0) {
+        ++_duplicates;
+        return AddResult::Duplicate;
+    }
+
+    if (ahead > 0) {
+        _packets_lost += static_cast<uint64_t>(ahead);
+
+        // The rest of the message cut short is gone.
+        _buffer.resize(_complete_len);
+        _header_len = 0;
+        _message_missing = 0;
+
+        if (!_resyncing) {
+            _resyncing = true;
+            _gap_started_s = _last_packet_s;
+        }
+    }
+
+    _next_sequence = static_cast<uint16_t>(sequence + 1);
+    _last_packet_s = now_s;
+    ++_packets_received;
+
+    std::size_t offset = 0;
+    if (_resyncing) {
+        if (first_message_offset == NO_MESSAGE_START || first_message_offset >= length) {
+            return AddResult::Added;
+        }
+        offset = first_message_offset;
+        _resyncing = false;
+        // Should the gap have been in the file header, it's too late for it.
+        _file_header_missing = 0;
+        append_dropout(now_s - _gap_started_s);
+    }
+
+    append(data + offset, length - offset);
+
+    return (_complete_len >= _buffer_size) ? AddResult::BufferFull : AddResult::Added;
+}
+
+void UlogStream::append(const uint8_t* data, std::size_t length)
+{
+    while (length > 0) {
+        std::size_t count;
+        if (_file_header_missing > 0) {
+            count = std::min(length, _file_header_missing);
+            _file_header_missing -= count;
+        } else if (_header_len < _header.size()) {
+            count = 1;
+            _header[_header_len++] = *data;
+            if (_header_len == _header.size()) {
+                _message_missing = _header[0] | (_header[1] << 8);
+            }
+        } else {
+            count = std::min(length, _message_missing);
+            _message_missing -= count;
+        }
+
+        _buffer.insert(_buffer.end(), data, data + count);
+        data += count;
+        length -= count;
+
+        if (_header_len == _header.size() && _message_missing == 0) {
+            _header_len = 0;
+        }
+        if (_file_header_missing == 0 && _header_len == 0) {
+            _complete_len = _buffer.size();
+        }
+    }
+}
+
+void UlogStream::append_dropout(double duration_s)
+{
+    const auto duration_ms =
+        static_cast<uint16_t>(std::min(std::max(std::round(duration_s * 1e3), 0.0), 65535.0));
+
+    // msg_size 2, msg_type 'O', duration in ms.
+    const uint8_t dropout[] = {
+        2,
+        0,
+        'O',
+        static_cast<uint8_t>(duration_ms & 0xff),
+        static_cast<uint8_t>(duration_ms >> 8)};
+
+    _buffer.insert(_buffer.end(), std::begin(dropout), std::end(dropout));
+    _complete_len = _buffer.size();
+}
+
+void UlogStream::take_buffer(std::vector<uint8_t>& buffer)
+{
+    buffer.clear();
+    buffer.swap(_buffer);
+
+    // Keep the message coming in, and don't grow the buffer while doing so.
+    _buffer.reserve(_buffer_size);
+    _buffer.insert(_buffer.end(), buffer.begin() + _complete_len, buffer.end());
+    buffer.resize(_complete_len);
+    _complete_len = 0;
+}
+
+} // namespace mavsdk
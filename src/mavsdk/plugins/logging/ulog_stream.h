@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mavsdk {
+
+// Puts the ULog file back together from what PX4 streams with LOGGING_DATA
+// and LOGGING_DATA_ACKED.
+//
+// The stream is followed message by message, only complete ULog messages
+// are passed on, so the file stays readable when data is lost. If packets
+// went missing, which the sequence numbers tell, the message cut short is
+// dropped, and the stream picks up again at the first message starting in a
+// later packet, with a dropout message in between to mark the gap. Packets
+// arriving again, as they do if an ack got lost, are ignored.
+//
+// Complete messages are collected in a buffer, which is meant to be taken
+// and written to disk in one go once it is full.
+//
+// This class knows nothing about MAVLink, files or clocks. Times are passed
+// in as seconds since any point in time.
+class UlogStream {
+public:
+    static constexpr std::size_t DEFAULT_BUFFER_SIZE = 256 * 1024;
+
+    // The file starts with a header rather than a message.
+    static constexpr std::size_t FILE_HEADER_LEN = 16;
+
+    // Same as LOGGING_DATA, no message starts in the packet.
+    static constexpr uint8_t NO_MESSAGE_START = 255;
+
+    explicit UlogStream(std::size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+    enum class AddResult {
+        Added,
+        BufferFull, // Call take_buffer().
+        Duplicate,
+    };
+
+    AddResult add(
+        uint16_t sequence,
+        const uint8_t* data,
+        std::size_t length,
+        uint8_t first_message_offset,
+        double now_s);
+
+    // Moves the complete messages buffered into buffer. Whatever buffer held
+    // is dropped, its memory is used for the next messages.
+    void take_buffer(std::vector<uint8_t>& buffer);
+
+    uint64_t packets_received() const { return _packets_received; }
+    uint64_t packets_lost() const { return _packets_lost; }
+    uint64_t duplicates() const { return _duplicates; }
+
+private:
+    void append(const uint8_t* data, std::size_t length);
+    void append_dropout(double duration_s);
+
+    const std::size_t _buffer_size;
+    std::vector<uint8_t> _buffer{};
+
+    bool _started{false};
+    uint16_t _next_sequence{0};
+    double _last_packet_s{0.0};
+
+    std::size_t _file_header_missing{FILE_HEADER_LEN};
+
+    // Bytes at the start of the buffer which make up complete messages, the
+    // rest is the message currently coming in.
+    std::size_t _complete_len{0};
+    std::array<uint8_t, 3> _header{};
+    std::size_t _header_len{0};
+    std::size_t _message_missing{0};
+
+    // Set after a gap, until a message starts again.
+    bool _resyncing{false};
+    double _gap_started_s{0.0};
+
+    uint64_t _packets_received{0};
+    uint64_t _packets_lost{0};
+    uint64_t _duplicates{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,170 @@
+#include "ulog_stream.h"
+
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+std::vector<uint8_t> file_header()
+{
+    std::vector<uint8_t> header = {'U', 'L', 'o', 'g', 0x01, 0x12, 0x35, 0x01};
+    header.resize(UlogStream::FILE_HEADER_LEN, 0);
+    return header;
+}
+
+std::vector<uint8_t> message(char type, std::size_t payload_len, uint8_t fill)
+{
+    std::vector<uint8_t> result = {
+        static_cast<uint8_t>(payload_len & 0xff),
+        static_cast<uint8_t>(payload_len >> 8),
+        static_cast<uint8_t>(type)};
+    result.resize(3 + payload_len, fill);
+    return result;
+}
+
+void append(std::vector<uint8_t>& to, const std::vector<uint8_t>& data)
+{
+    to.insert(to.end(), data.begin(), data.end());
+}
+
+UlogStream::AddResult add(
+    UlogStream& stream,
+    uint16_t sequence,
+    const std::vector<uint8_t>& data,
+    uint8_t first_message_offset = 0,
+    double now_s = 0.0)
+{
+    return stream.add(sequence, data.data(), data.size(), first_message_offset, now_s);
+}
+
+} // namespace
+
+TEST(UlogStream, PassesCompleteMessagesOn)
+{
+    UlogStream stream;
+
+    std::vector<uint8_t> expected = file_header();
+    append(expected, message('D', 10, 1));
+    append(expected, message('D', 300, 2));
+
+    // Split up in packets of 100 bytes.
+    uint16_t sequence = 0;
+    for (std::size_t i = 0; i < expected.size(); i += 100) {
+        const auto end = std::min(i + 100, expected.size());
+        const std::vector<uint8_t> packet(expected.begin() + i, expected.begin() + end);
+        EXPECT_EQ(add(stream, sequence++, packet), UlogStream::AddResult::Added);
+    }
+
+    std::vector<uint8_t> buffer;
+    stream.take_buffer(buffer);
+    EXPECT_EQ(buffer, expected);
+    EXPECT_EQ(stream.packets_received(), sequence);
+    EXPECT_EQ(stream.packets_lost(), 0u);
+}
+
+TEST(UlogStream, KeepsIncompleteMessageBuffered)
+{
+    UlogStream stream;
+
+    std::vector<uint8_t> data = file_header();
+    append(data, message('D', 10, 1));
+    const auto second = message('D', 20, 2);
+    append(data, std::vector<uint8_t>(second.begin(), second.begin() + 5));
+    add(stream, 0, data);
+
+    std::vector<uint8_t> buffer;
+    stream.take_buffer(buffer);
+    EXPECT_EQ(buffer.size(), UlogStream::FILE_HEADER_LEN + 13);
+
+    add(stream, 1, std::vector<uint8_t>(second.begin() + 5, second.end()));
+    stream.take_buffer(buffer);
+    EXPECT_EQ(buffer, second);
+}
+
+TEST(UlogStream, IgnoresDuplicates)
+{
+    UlogStream stream;
+
+    auto data = file_header();
+    add(stream, 7, data);
+    const auto first = message('D', 10, 1);
+    EXPECT_EQ(add(stream, 8, first), UlogStream::AddResult::Added);
+    EXPECT_EQ(add(stream, 8, first), UlogStream::AddResult::Duplicate);
+    EXPECT_EQ(add(stream, 7, data), UlogStream::AddResult::Duplicate);
+    EXPECT_EQ(stream.duplicates(), 2u);
+
+    append(data, first);
+    std::vector<uint8_t> buffer;
+    stream.take_buffer(buffer);
+    EXPECT_EQ(buffer, data);
+}
+
+TEST(UlogStream, DropsMessageCutShortByGap)
+{
+    UlogStream stream;
+
+    std::vector<uint8_t> expected = file_header();
+    append(expected, message('D', 10, 1));
+
+    const auto cut = message('D', 200, 2);
+    auto packet = expected;
+    append(packet, std::vector<uint8_t>(cut.begin(), cut.begin() + 50));
+    add(stream, 65534, packet, 0, 1.0);
+
+    // 65535 and 0 are lost, 1 has the end of another message, and then one
+    // starting at offset 20.
+    const auto next = message('D', 30, 3);
+    packet.assign(20, 9);
+    append(packet, next);
+    add(stream, 1, packet, 20, 1.5);
+
+    EXPECT_EQ(stream.packets_lost(), 2u);
+
+    // Dropout of 500 ms.
+    append(expected, {2, 0, 'O', 0xf4, 0x01});
+    append(expected, next);
+
+    std::vector<uint8_t> buffer;
+    stream.take_buffer(buffer);
+    EXPECT_EQ(buffer, expected);
+}
+
+TEST(UlogStream, WaitsForMessageStartAfterGap)
+{
+    UlogStream stream;
+    add(stream, 0, file_header());
+
+    // Lost 1, and no message starts in 2.
+    add(stream, 2, std::vector<uint8_t>(50, 9), UlogStream::NO_MESSAGE_START);
+    // No gap any more, but still no message start.
+    add(stream, 3, std::vector<uint8_t>(50, 9), UlogStream::NO_MESSAGE_START);
+
+    const auto next = message('D', 4, 3);
+    add(stream, 4, next, 0);
+
+    auto expected = file_header();
+    append(expected, {2, 0, 'O', 0, 0});
+    append(expected, next);
+
+    std::vector<uint8_t> buffer;
+    stream.take_buffer(buffer);
+    EXPECT_EQ(buffer, expected);
+}
+
+TEST(UlogStream, ReportsFullBuffer)
+{
+    UlogStream stream(1000);
+    add(stream, 0, file_header());
+
+    uint16_t sequence = 1;
+    while (add(stream, sequence, message('D', 100, 1)) == UlogStream::AddResult::Added) {
+        ++sequence;
+    }
+    EXPECT_EQ(sequence, 10);
+
+    std::vector<uint8_t> buffer;
+    stream.take_buffer(buffer);
+    EXPECT_EQ(buffer.size(), UlogStream::FILE_HEADER_LEN + 10 * 103);
+    EXPECT_EQ(add(stream, sequence + 1, message('D', 100, 1)), UlogStream::AddResult::Added);
+}
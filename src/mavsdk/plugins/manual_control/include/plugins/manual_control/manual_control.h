@@ -142,6 +142,36 @@ public:
      */
     Result set_manual_control_input(float x, float y, float z, float r) const;
 
+    /**
+     * @brief Send manual control input at a fixed rate.
+     *
+     * While streaming, set_manual_control_input only stores the latest input
+     * without blocking, and it is sent from a periodic sender at the given
+     * rate, independent of how often the input is set.
+     *
+     * With a keep-alive interval greater than 0, an input identical to the one
+     * sent last is only repeated at that interval, to save link bandwidth.
+     * It has to be short enough not to trigger RC loss.
+     *
+     * Calling it again while streaming changes the rate and interval.
+     *
+     * This function is non-blocking.
+     *
+     * @return Result of request.
+     */
+    Result start_streaming(double rate_hz, double keep_alive_interval_s = 0.0) const;
+
+    /**
+     * @brief Stop sending manual control input from the periodic sender.
+     *
+     * Input set afterwards is sent right away again.
+     *
+     * This function is non-blocking.
+     *
+     * @return Result of request.
+     */
+    Result stop_streaming() const;
+
     /**
      * @brief Copy constructor.
      */
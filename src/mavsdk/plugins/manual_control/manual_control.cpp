@@ -74,4 +74,15 @@ std::ostream& operator<<(std::ostream& str, ManualControl::Result const& result)
     }
 }
 
+ManualControl::Result
+ManualControl::start_streaming(double rate_hz, double keep_alive_interval_s) const
+{
+    return _impl->start_streaming(rate_hz, keep_alive_interval_s);
+}
+
+ManualControl::Result ManualControl::stop_streaming() const
+{
+    return _impl->stop_streaming();
+}
+
 } // namespace mavsdk
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "manual_control_impl.h"
+#include "log.h"
 #include <future>
 
 namespace mavsdk {
@@ -21,7 +22,10 @@ ManualControlImpl::~ManualControlImpl()
 
 void ManualControlImpl::init() {}
 
-void ManualControlImpl::deinit() {}
+void ManualControlImpl::deinit()
+{
+    stop_streaming();
+}
 
 void ManualControlImpl::enable() {}
 
@@ -96,10 +100,97 @@ ManualControlImpl::set_manual_control_input(float x, float y, float z, float r)
         return ManualControl::Result::InputOutOfRange;
     }
 
-    if (_input == Input::NotSet) {
+    const auto packed_input = pack_input(x, y, z, r);
+
+    if (_streaming) {
+        // Picked up by the sender at the next tick.
+        _latest_input = packed_input;
         _input = Input::Set;
+        return ManualControl::Result::Success;
+    }
+
+    _input = Input::Set;
+
+    return send_input(packed_input) ? ManualControl::Result::Success :
+                                      ManualControl::Result::ConnectionError;
+}
+
+ManualControl::Result
+ManualControlImpl::start_streaming(double rate_hz, double keep_alive_interval_s)
+{
+    if (!(rate_hz > 0.0 && rate_hz <= MAX_STREAM_RATE_HZ) || keep_alive_interval_s < 0.0) {
+        LogErr() << "Manual control stream rate must be in range (0 to " << MAX_STREAM_RATE_HZ
+                 << " Hz], keep-alive interval not negative";
+        return ManualControl::Result::InputOutOfRange;
+    }
+
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+    _keep_alive_interval_s = keep_alive_interval_s;
+    _last_sent_input.reset();
+
+    if (_stream_cookie != nullptr) {
+        _parent->change_call_every(static_cast<float>(1.0 / rate_hz), _stream_cookie);
+    } else {
+        _parent->add_call_every(
+            [this]() { send_streamed_input(); },
+            static_cast<float>(1.0 / rate_hz),
+            &_stream_cookie);
+    }
+    _streaming = true;
+
+    return ManualControl::Result::Success;
+}
+
+ManualControl::Result ManualControlImpl::stop_streaming()
+{
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+    _streaming = false;
+    if (_stream_cookie != nullptr) {
+        _parent->remove_call_every(_stream_cookie);
+        _stream_cookie = nullptr;
     }
 
+    return ManualControl::Result::Success;
+}
+
+void ManualControlImpl::send_streamed_input()
+{
+    if (_input == Input::NotSet) {
+        return;
+    }
+
+    const uint64_t packed_input = _latest_input;
+
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+
+    // An input the vehicle already has only needs repeating now and then, so
+    // it doesn't trigger RC loss.
+    if (_keep_alive_interval_s > 0.0 && _last_sent_input &&
+        _last_sent_input.value() == packed_input &&
+        _parent->get_time().elapsed_since_s(_last_sent_time) < _keep_alive_interval_s) {
+        return;
+    }
+
+    if (send_input(packed_input)) {
+        _last_sent_input = packed_input;
+        _last_sent_time = _parent->get_time().steady_time();
+    }
+}
+
+uint64_t ManualControlImpl::pack_input(float x, float y, float z, float r)
+{
+    const auto axis = [](float value) {
+        return static_cast<uint64_t>(static_cast<uint16_t>(static_cast<int16_t>(value * 1000)));
+    };
+    return axis(x) | (axis(y) << 16) | (axis(z) << 32) | (axis(r) << 48);
+}
+
+bool ManualControlImpl::send_input(uint64_t packed_input)
+{
+    const auto axis = [packed_input](unsigned index) {
+        return static_cast<int16_t>(static_cast<uint16_t>(packed_input >> (16 * index)));
+    };
+
     // No buttons/extensions supported yet.
     const uint16_t buttons = 0;
     const uint16_t buttons2 = 0;
@@ -113,17 +204,16 @@ ManualControlImpl::set_manual_control_input(float x, float y, float z, float r)
         _parent->get_own_component_id(),
         &message,
         _parent->get_system_id(),
-        static_cast<int16_t>(x * 1000),
-        static_cast<int16_t>(y * 1000),
-        static_cast<int16_t>(z * 1000),
-        static_cast<int16_t>(r * 1000),
+        axis(0),
+        axis(1),
+        axis(2),
+        axis(3),
         buttons,
         buttons2,
         enabled_extensions,
         pitch_only_axis,
         roll_only_axis);
-    return _parent->send_message(message) ? ManualControl::Result::Success :
-                                            ManualControl::Result::ConnectionError;
+    return _parent->send_message(message);
 }
 
 ManualControl::Result
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
 #include "plugins/manual_control/manual_control.h"
 #include "plugin_impl_base.h"
 
@@ -27,13 +32,34 @@ public:
 
     ManualControl::Result set_manual_control_input(float x, float y, float z, float r);
 
+    ManualControl::Result start_streaming(double rate_hz, double keep_alive_interval_s);
+    ManualControl::Result stop_streaming();
+
 private:
     ManualControl::Result
     manual_control_result_from_command_result(MavlinkCommandSender::Result result);
     void command_result_callback(
         MavlinkCommandSender::Result command_result, const ManualControl::ResultCallback& callback);
 
-    enum class Input { NotSet, Set } _input{Input::NotSet};
+    // The four axes as sent, scaled to int16, packed into one word so the
+    // latest input can be handed to the sender atomically.
+    static uint64_t pack_input(float x, float y, float z, float r);
+    bool send_input(uint64_t packed_input);
+    void send_streamed_input();
+
+    enum class Input { NotSet, Set };
+    std::atomic<Input> _input{Input::NotSet};
+
+    std::atomic<uint64_t> _latest_input{0};
+    std::atomic<bool> _streaming{false};
+
+    std::mutex _stream_mutex{};
+    void* _stream_cookie{nullptr};
+    double _keep_alive_interval_s{0.0};
+    std::optional<uint64_t> _last_sent_input{};
+    dl_time_t _last_sent_time{};
+
+    static constexpr double MAX_STREAM_RATE_HZ = 100.0;
 };
 
 } // namespace mavsdk
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <functional>
+#include <vector>
 
 // This plugin provides/includes the mavlink 2.0 header files.
 #include "mavlink_include.h"
@@ -81,6 +83,30 @@ public:
      */
     Result send_message(mavlink_message_t& message);
 
+    /**
+     * @brief Send several messages at once.
+     *
+     * The messages are handed to the connections in one go rather than one by one. Messages
+     * dropped by the outgoing intercept callback are removed from the vector.
+     *
+     * @return result of the request.
+     */
+    Result send_messages(std::vector<mavlink_message_t>& messages);
+
+    /**
+     * @brief Send several messages at once, without the need for a vector.
+     *
+     * The outgoing intercept callback is looked up once for the whole batch, and the messages
+     * are handed to the connections in one go. Messages dropped by the intercept callback
+     * are not sent, the ones sent are moved to the front of the array, in order.
+     *
+     * @param messages Pointer to the first message.
+     * @param count Number of messages.
+     *
+     * @return result of the request.
+     */
+    Result send_messages(mavlink_message_t* messages, std::size_t count);
+
     /**
      * @brief Type for MAVLink command_long.
      */
@@ -145,6 +171,37 @@ public:
     void subscribe_message_async(
         uint16_t message_id, std::function<void(const mavlink_message_t&)> callback);
 
+    /**
+     * @brief Shared immutable message, as handed out by `subscribe_messages_async`.
+     */
+    using MessagePtr = std::shared_ptr<const mavlink_message_t>;
+
+    /**
+     * @brief Callback type for `subscribe_messages_async`.
+     */
+    using MessagesCallback = std::function<void(const std::vector<MessagePtr>&)>;
+
+    /**
+     * @brief Subscribe to a set of messages using their message IDs.
+     *
+     * Each message received is copied once into a ref-counted buffer, which the callback can
+     * keep for as long as it likes without copying it again.
+     *
+     * Messages which arrive while the previous ones are still waiting to be handed to the
+     * callback are added to them, so the callback is called with a batch of messages, in the
+     * order they were received. A subscriber which keeps up gets a batch per message, one
+     * which falls behind gets fewer and bigger batches.
+     *
+     * Subscribing again replaces the previous subscription. To stop the subscription, call
+     * this method with `nullptr` as the callback. This subscription is independent of the ones
+     * done with `subscribe_message_async`.
+     *
+     * @param message_ids The MAVLink message IDs.
+     * @param callback Callback to be called with the messages received.
+     */
+    void subscribe_messages_async(
+        const std::vector<uint16_t>& message_ids, MessagesCallback callback);
+
     /**
      * @brief Get our own system ID.
      *
@@ -20,6 +20,18 @@ MavlinkPassthrough::Result MavlinkPassthrough::send_message(mavlink_message_t& m
     return _impl->send_message(message);
 }
 
+MavlinkPassthrough::Result
+MavlinkPassthrough::send_messages(std::vector<mavlink_message_t>& messages)
+{
+    return _impl->send_messages(messages);
+}
+
+MavlinkPassthrough::Result
+MavlinkPassthrough::send_messages(mavlink_message_t* messages, std::size_t count)
+{
+    return _impl->send_messages(messages, count);
+}
+
 MavlinkPassthrough::Result MavlinkPassthrough::send_command_int(const CommandInt& command)
 {
     return _impl->send_command_int(command);
@@ -36,6 +48,12 @@ void MavlinkPassthrough::subscribe_message_async(
     _impl->subscribe_message_async(message_id, callback);
 }
 
+void MavlinkPassthrough::subscribe_messages_async(
+    const std::vector<uint16_t>& message_ids, MessagesCallback callback)
+{
+    _impl->subscribe_messages_async(message_ids, std::move(callback));
+}
+
 std::ostream& operator<<(std::ostream& str, MavlinkPassthrough::Result const& result)
 {
     switch (result) {
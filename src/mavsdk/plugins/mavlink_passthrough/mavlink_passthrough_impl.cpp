@@ -27,6 +27,7 @@ void MavlinkPassthroughImpl::deinit()
     _parent->intercept_incoming_messages(nullptr);
     _parent->intercept_outgoing_messages(nullptr);
     _parent->unregister_all_mavlink_message_handlers(this);
+    subscribe_messages_async({}, nullptr);
 }
 
 void MavlinkPassthroughImpl::enable() {}
@@ -41,6 +42,32 @@ MavlinkPassthrough::Result MavlinkPassthroughImpl::send_message(mavlink_message_
     return MavlinkPassthrough::Result::Success;
 }
 
+MavlinkPassthrough::Result
+MavlinkPassthroughImpl::send_messages(std::vector<mavlink_message_t>& messages)
+{
+    messages.resize(_parent->intercept_outgoing_messages(messages.data(), messages.size()));
+    return send_kept_messages(messages.data(), messages.size());
+}
+
+MavlinkPassthrough::Result
+MavlinkPassthroughImpl::send_messages(mavlink_message_t* messages, std::size_t count)
+{
+    return send_kept_messages(messages, _parent->intercept_outgoing_messages(messages, count));
+}
+
+MavlinkPassthrough::Result
+MavlinkPassthroughImpl::send_kept_messages(mavlink_message_t* messages, std::size_t count)
+{
+    if (count == 0) {
+        return MavlinkPassthrough::Result::Success;
+    }
+
+    if (!_parent->send_messages(messages, count)) {
+        return MavlinkPassthrough::Result::ConnectionError;
+    }
+    return MavlinkPassthrough::Result::Success;
+}
+
 MavlinkPassthrough::Result
 MavlinkPassthroughImpl::send_command_long(const MavlinkPassthrough::CommandLong& command)
 {
@@ -118,12 +145,90 @@ void MavlinkPassthroughImpl::subscribe_message_async(
         _parent->register_mavlink_message_handler(
             message_id,
             [this, temp_callback](const mavlink_message_t& message) {
-                _parent->call_user_callback([temp_callback, message]() { temp_callback(message); });
+                _parent->call_user_callback(
+                    [temp_callback, shared_message = _parent->share_message(message)]() {
+                        temp_callback(*shared_message);
+                    });
             },
             this);
     }
 }
 
+void MavlinkPassthroughImpl::subscribe_messages_async(
+    const std::vector<uint16_t>& message_ids, MavlinkPassthrough::MessagesCallback callback)
+{
+    std::lock_guard<std::mutex> lock(_messages_subscription_mutex);
+
+    if (_messages_subscription != nullptr) {
+        _parent->unregister_all_mavlink_message_handlers(&_messages_subscription);
+        // Anything still queued for it is not wanted anymore.
+        _messages_subscription->active = false;
+        _messages_subscription.reset();
+    }
+
+    if (callback == nullptr || message_ids.empty()) {
+        return;
+    }
+
+    _messages_subscription = std::make_shared<MessagesSubscription>(std::move(callback));
+    _parent->register_mavlink_message_handlers(
+        message_ids,
+        [this, subscription = _messages_subscription](const mavlink_message_t& message) {
+            queue_message(subscription, message);
+        },
+        &_messages_subscription);
+}
+
+void MavlinkPassthroughImpl::queue_message(
+    const std::shared_ptr<MessagesSubscription>& subscription, const mavlink_message_t& message)
+{
+    // At most one copy of the message, from here on it is shared.
+    auto shared_message = _parent->share_message(message);
+
+    bool queue_delivery;
+    {
+        std::lock_guard<std::mutex> lock(subscription->mutex);
+        subscription->pending.push_back(std::move(shared_message));
+        queue_delivery = !subscription->delivery_queued;
+        subscription->delivery_queued = true;
+    }
+
+    if (queue_delivery) {
+        _parent->call_user_callback(Delivery(subscription));
+    }
+}
+
+MavlinkPassthroughImpl::Delivery::Delivery(std::shared_ptr<MessagesSubscription> subscription) :
+    _subscription(std::move(subscription))
+{}
+
+MavlinkPassthroughImpl::Delivery::~Delivery()
+{
+    if (_subscription != nullptr) {
+        std::lock_guard<std::mutex> lock(_subscription->mutex);
+        _subscription->delivery_queued = false;
+    }
+}
+
+void MavlinkPassthroughImpl::Delivery::operator()()
+{
+    const auto subscription = std::move(_subscription);
+    if (subscription == nullptr) {
+        return;
+    }
+
+    std::vector<MavlinkPassthrough::MessagePtr> messages;
+    {
+        std::lock_guard<std::mutex> lock(subscription->mutex);
+        messages.swap(subscription->pending);
+        subscription->delivery_queued = false;
+    }
+
+    if (subscription->active && !messages.empty()) {
+        subscription->callback(messages);
+    }
+}
+
 uint8_t MavlinkPassthroughImpl::get_our_sysid() const
 {
     return _parent->get_own_system_id();
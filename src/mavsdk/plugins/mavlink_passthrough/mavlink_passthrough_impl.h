@@ -1,6 +1,9 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 #include "mavlink_include.h"
 #include "plugins/mavlink_passthrough/mavlink_passthrough.h"
@@ -21,11 +24,15 @@ public:
     void disable() override;
 
     MavlinkPassthrough::Result send_message(mavlink_message_t& message);
+    MavlinkPassthrough::Result send_messages(std::vector<mavlink_message_t>& messages);
+    MavlinkPassthrough::Result send_messages(mavlink_message_t* messages, std::size_t count);
     MavlinkPassthrough::Result send_command_long(const MavlinkPassthrough::CommandLong& command);
     MavlinkPassthrough::Result send_command_int(const MavlinkPassthrough::CommandInt& command);
 
     void subscribe_message_async(
         uint16_t message_id, std::function<void(const mavlink_message_t&)> callback);
+    void subscribe_messages_async(
+        const std::vector<uint16_t>& message_ids, MavlinkPassthrough::MessagesCallback callback);
 
     uint8_t get_our_sysid() const;
     uint8_t get_our_compid() const;
@@ -38,6 +45,51 @@ public:
 private:
     static MavlinkPassthrough::Result
     to_mavlink_passthrough_result_from_mavlink_commands_result(MavlinkCommandSender::Result result);
+
+    // Sends what is left after the intercept callback.
+    MavlinkPassthrough::Result send_kept_messages(mavlink_message_t* messages, std::size_t count);
+
+    // Messages received for subscribe_messages_async, waiting to be handed on.
+    struct MessagesSubscription {
+        explicit MessagesSubscription(MavlinkPassthrough::MessagesCallback callback_) :
+            callback(std::move(callback_))
+        {}
+
+        const MavlinkPassthrough::MessagesCallback callback;
+        std::atomic<bool> active{true};
+
+        std::mutex mutex{};
+        std::vector<MavlinkPassthrough::MessagePtr> pending{};
+        bool delivery_queued{false};
+    };
+
+    // Queued on the user callback queue to hand on what is pending. If the
+    // queue drops it, it clears delivery_queued when destroyed, so the next
+    // message queues another one.
+    class Delivery {
+    public:
+        explicit Delivery(std::shared_ptr<MessagesSubscription> subscription);
+        ~Delivery();
+
+        Delivery(Delivery&&) noexcept = default;
+        Delivery& operator=(Delivery&&) noexcept = default;
+
+        // Non-copyable
+        Delivery(const Delivery&) = delete;
+        const Delivery& operator=(const Delivery&) = delete;
+
+        void operator()();
+
+    private:
+        std::shared_ptr<MessagesSubscription> _subscription;
+    };
+
+    void queue_message(
+        const std::shared_ptr<MessagesSubscription>& subscription,
+        const mavlink_message_t& message);
+
+    std::mutex _messages_subscription_mutex{};
+    std::shared_ptr<MessagesSubscription> _messages_subscription{};
 };
 
 } // namespace mavsdk
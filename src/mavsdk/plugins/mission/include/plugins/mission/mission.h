@@ -15,6 +15,8 @@
 
 #include "mavsdk/plugin_base.h"
 
+#include "mavsdk/subscription_options.h"
+
 namespace mavsdk {
 
 class System;
@@ -488,6 +490,12 @@ public:
      */
     Result set_return_to_launch_after_mission(bool enable) const;
 
+    /**
+     * @brief Subscribe to mission progress updates, delivered as set in `options`.
+     */
+    void subscribe_mission_progress(
+        MissionProgressCallback callback, const SubscriptionOptions& options);
+
     /**
      * @brief Copy constructor.
      */
@@ -306,4 +306,10 @@ operator<<(std::ostream& str, Mission::ProgressDataOrMission const& progress_dat
     return str;
 }
 
+void Mission::subscribe_mission_progress(
+    MissionProgressCallback callback, const SubscriptionOptions& options)
+{
+    _impl->subscribe_mission_progress(callback, options);
+}
+
 } // namespace mavsdk
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "mission_impl.h"
+#include "sync_waiter.h"
 #include "system.h"
 #include "unused.h"
 #include <algorithm>
@@ -57,7 +58,7 @@ void MissionImpl::enable()
 void MissionImpl::disable()
 {
     reset_mission_progress();
-    _gimbal_protocol = GimbalProtocol::Unknown;
+    _gimbal_protocol.reset();
 }
 
 void MissionImpl::deinit()
@@ -72,8 +73,7 @@ void MissionImpl::reset_mission_progress()
     std::lock_guard<std::mutex> lock(_mission_data.mutex);
     _mission_data.last_current_mavlink_mission_item = -1;
     _mission_data.last_reached_mavlink_mission_item = -1;
-    _mission_data.last_current_reported_mission_item = -1;
-    _mission_data.last_total_reported_mission_item = -1;
+    _mission_data.mission_progress_subscriptions.reset_changes();
 }
 
 void MissionImpl::process_mission_current(const mavlink_message_t& message)
@@ -101,38 +101,30 @@ void MissionImpl::process_gimbal_manager_information(const mavlink_message_t& me
     UNUSED(message);
     if (_gimbal_protocol_cookie != nullptr) {
         LogDebug() << "Using gimbal protocol v2";
-        _gimbal_protocol = GimbalProtocol::V2;
+        _gimbal_protocol.set(GimbalProtocol::V2);
         _parent->unregister_timeout_handler(_gimbal_protocol_cookie);
     }
 }
 
-void MissionImpl::wait_for_protocol()
-{
-    while (_gimbal_protocol == GimbalProtocol::Unknown) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-}
-
 void MissionImpl::wait_for_protocol_async(std::function<void()> callback)
 {
-    wait_for_protocol();
-    callback();
+    // Instead of blocking the caller, the upload starts once the protocol is known.
+    _gimbal_protocol.when_ready([callback](const GimbalProtocol&) { callback(); });
 }
 
 void MissionImpl::receive_protocol_timeout()
 {
     LogDebug() << "Falling back to gimbal protocol v1";
-    _gimbal_protocol = GimbalProtocol::V1;
+    _gimbal_protocol.set(GimbalProtocol::V1);
     _gimbal_protocol_cookie = nullptr;
 }
 
 Mission::Result MissionImpl::upload_mission(const Mission::MissionPlan& mission_plan)
 {
-    auto prom = std::promise<Mission::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Mission::Result> waiter;
 
-    upload_mission_async(mission_plan, [&prom](Mission::Result result) { prom.set_value(result); });
-    return fut.get();
+    upload_mission_async(mission_plan, waiter.completion());
+    return waiter.wait();
 }
 
 void MissionImpl::upload_mission_async(
@@ -156,12 +148,7 @@ void MissionImpl::upload_mission_async(
             MAV_MISSION_TYPE_MISSION,
             int_items,
             [this, callback](MAVLinkMissionTransfer::Result result) {
-                auto converted_result = convert_result(result);
-                _parent->call_user_callback([callback, converted_result]() {
-                    if (callback) {
-                        callback(converted_result);
-                    }
-                });
+                report_result(callback, convert_result(result));
             });
     });
 }
@@ -219,14 +206,13 @@ Mission::Result MissionImpl::cancel_mission_upload() const
 
 std::pair<Mission::Result, Mission::MissionPlan> MissionImpl::download_mission()
 {
-    auto prom = std::promise<std::pair<Mission::Result, Mission::MissionPlan>>();
-    auto fut = prom.get_future();
+    SyncWaiter<std::pair<Mission::Result, Mission::MissionPlan>> waiter;
 
     download_mission_async(
-        [&prom](Mission::Result result, const Mission::MissionPlan& mission_plan) {
-            prom.set_value(std::make_pair<>(result, mission_plan));
+        [&waiter](Mission::Result result, const Mission::MissionPlan& mission_plan) {
+            waiter.complete(std::make_pair<>(result, mission_plan));
         });
-    return fut.get();
+    return waiter.wait();
 }
 
 void MissionImpl::download_mission_async(const Mission::DownloadMissionCallback& callback)
@@ -355,237 +341,304 @@ float MissionImpl::acceptance_radius(const MissionItem& item)
 std::vector<MAVLinkMissionTransfer::ItemInt>
 MissionImpl::convert_to_int_items(const std::vector<MissionItem>& mission_items)
 {
+    std::lock_guard<std::mutex> lock(_conversion_cache.mutex);
+
+    const auto gimbal_protocol = _gimbal_protocol.get().value_or(GimbalProtocol::Unknown);
+    if (gimbal_protocol != _conversion_cache.gimbal_protocol ||
+        _enable_absolute_gimbal_yaw_angle != _conversion_cache.absolute_gimbal_yaw_angle) {
+        // These change what the items are converted to.
+        _conversion_cache.items.clear();
+        _conversion_cache.gimbal_protocol = gimbal_protocol;
+        _conversion_cache.absolute_gimbal_yaw_angle = _enable_absolute_gimbal_yaw_angle;
+    }
+    auto& cached_items = _conversion_cache.items;
+    if (cached_items.size() > mission_items.size()) {
+        cached_items.erase(cached_items.begin() + mission_items.size(), cached_items.end());
+    }
+
     std::vector<MAVLinkMissionTransfer::ItemInt> int_items;
+    auto& indices = _mission_data.mavlink_mission_item_to_mission_item_indices;
+    auto& ranges = _mission_data.mission_item_to_mavlink_mission_item_ranges;
+    indices.clear();
+    ranges.clear();
+    ranges.reserve(mission_items.size());
+
+    ConversionState state{};
+    for (std::size_t item_i = 0; item_i < mission_items.size(); ++item_i) {
+        const auto& item = mission_items[item_i];
+
+        // An item only needs to be converted again if it changed or if what
+        // came before it left a different state behind.
+        if (item_i == cached_items.size()) {
+            cached_items.emplace_back();
+        }
+        auto& cached = cached_items[item_i];
+        if (!cached.valid || !(cached.state_before == state) ||
+            !same_mission_item(cached.item, item)) {
+            cached.item = item;
+            cached.state_before = state;
+            cached.int_items.clear();
+            convert_mission_item(item, gimbal_protocol, state, cached.int_items);
+            cached.state_after = state;
+            cached.valid = true;
+        }
+        state = cached.state_after;
 
-    bool last_position_valid = false; // This flag is to protect us from using an invalid x/y.
+        const auto begin = int_items.size();
+        for (auto int_item : cached.int_items) {
+            // Current is the 0th waypoint
+            int_item.current = ((int_items.size() == 0) ? 1 : 0);
+            int_item.seq = static_cast<uint16_t>(int_items.size());
+            int_items.push_back(int_item);
+            indices.push_back(static_cast<int>(item_i));
+        }
+        ranges.emplace_back(begin, int_items.size());
+    }
 
-    unsigned item_i = 0;
-    _mission_data.mavlink_mission_item_to_mission_item_indices.clear();
-    _mission_data.gimbal_v2_in_control = false;
+    // The last items below still belong to the last mission item.
+    const int last_item_i = static_cast<int>(mission_items.size()) - 1;
 
-    for (const auto& item : mission_items) {
-        if (has_valid_position(item)) {
-            // Current is the 0th waypoint
-            const uint8_t current = ((int_items.size() == 0) ? 1 : 0);
+    if (state.gimbal_v2_in_control) {
+        release_gimbal_control_v2(int_items);
+        indices.push_back(last_item_i);
+    }
 
-            const int32_t x = int32_t(std::round(item.latitude_deg * 1e7));
-            const int32_t y = int32_t(std::round(item.longitude_deg * 1e7));
-            const float z = item.relative_altitude_m;
+    if (_enable_return_to_launch_after_mission) {
+        MAVLinkMissionTransfer::ItemInt next_item{
+            static_cast<uint16_t>(int_items.size()),
+            MAV_FRAME_MISSION,
+            MAV_CMD_NAV_RETURN_TO_LAUNCH,
+            0, // current
+            1, // autocontinue
+            NAN, // loiter time in seconds
+            NAN, // empty
+            NAN, // radius around waypoint in meters ?
+            NAN, // loiter at center of waypoint
+            0,
+            0,
+            0,
+            MAV_MISSION_TYPE_MISSION};
 
-            MAVLinkMissionTransfer::ItemInt next_item{
-                static_cast<uint16_t>(int_items.size()),
-                static_cast<uint8_t>(MAV_FRAME_GLOBAL_RELATIVE_ALT_INT),
-                static_cast<uint8_t>(MAV_CMD_NAV_WAYPOINT),
-                current,
-                1, // autocontinue
-                hold_time(item),
-                acceptance_radius(item),
-                0.0f,
-                item.yaw_deg,
-                x,
-                y,
-                z,
-                MAV_MISSION_TYPE_MISSION};
+        indices.push_back(last_item_i);
+        int_items.push_back(next_item);
+    }
 
-            last_position_valid = true; // because we checked has_valid_position
+    if (!ranges.empty()) {
+        ranges.back().second = int_items.size();
+    }
+    return int_items;
+}
 
-            _mission_data.mavlink_mission_item_to_mission_item_indices.push_back(item_i);
-            int_items.push_back(next_item);
-        }
+void MissionImpl::convert_mission_item(
+    const MissionItem& item,
+    GimbalProtocol gimbal_protocol,
+    ConversionState& state,
+    std::vector<MAVLinkMissionTransfer::ItemInt>& int_items)
+{
+    // The sequence numbers and current flags set here are only relative to
+    // this item, they are fixed up once all items are put together.
+    if (has_valid_position(item)) {
+        // Current is the 0th waypoint
+        const uint8_t current = ((int_items.size() == 0) ? 1 : 0);
 
-        if (std::isfinite(item.speed_m_s)) {
-            // The speed has changed, we need to add a speed command.
+        const int32_t x = int32_t(std::round(item.latitude_deg * 1e7));
+        const int32_t y = int32_t(std::round(item.longitude_deg * 1e7));
+        const float z = item.relative_altitude_m;
 
-            // Current is the 0th waypoint
-            uint8_t current = ((int_items.size() == 0) ? 1 : 0);
+        MAVLinkMissionTransfer::ItemInt next_item{
+            static_cast<uint16_t>(int_items.size()),
+            static_cast<uint8_t>(MAV_FRAME_GLOBAL_RELATIVE_ALT_INT),
+            static_cast<uint8_t>(MAV_CMD_NAV_WAYPOINT),
+            current,
+            1, // autocontinue
+            hold_time(item),
+            acceptance_radius(item),
+            0.0f,
+            item.yaw_deg,
+            x,
+            y,
+            z,
+            MAV_MISSION_TYPE_MISSION};
 
-            uint8_t autocontinue = 1;
+        state.last_position_valid = true; // because we checked has_valid_position
 
-            MAVLinkMissionTransfer::ItemInt next_item{
-                static_cast<uint16_t>(int_items.size()),
-                MAV_FRAME_MISSION,
-                MAV_CMD_DO_CHANGE_SPEED,
-                current,
-                autocontinue,
-                1.0f, // ground speed
-                item.speed_m_s,
-                -1.0f, // no throttle change
-                0.0f, // absolute
-                0,
-                0,
-                NAN,
-                MAV_MISSION_TYPE_MISSION};
+        int_items.push_back(next_item);
+    }
 
-            _mission_data.mavlink_mission_item_to_mission_item_indices.push_back(item_i);
-            int_items.push_back(next_item);
-        }
+    if (std::isfinite(item.speed_m_s)) {
+        // The speed has changed, we need to add a speed command.
 
-        if (std::isfinite(item.gimbal_yaw_deg) || std::isfinite(item.gimbal_pitch_deg)) {
-            const auto temp_gimbal_protocol = _gimbal_protocol.load();
-            switch (temp_gimbal_protocol) {
-                case GimbalProtocol::V1:
-                    add_gimbal_items_v1(
-                        int_items, item_i, item.gimbal_pitch_deg, item.gimbal_yaw_deg);
-                    break;
+        // Current is the 0th waypoint
+        uint8_t current = ((int_items.size() == 0) ? 1 : 0);
 
-                case GimbalProtocol::V2:
-                    if (!_mission_data.gimbal_v2_in_control) {
-                        acquire_gimbal_control_v2(int_items, item_i);
-                        _mission_data.gimbal_v2_in_control = true;
-                    }
-                    add_gimbal_items_v2(
-                        int_items, item_i, item.gimbal_pitch_deg, item.gimbal_yaw_deg);
-                    break;
-                case GimbalProtocol::Unknown:
-                    // This should not happen because we wait until we know the protocol version.
-                    LogErr() << "Unknown gimbal protocol, skipping gimbal commands.";
-                    break;
-            }
-        }
+        uint8_t autocontinue = 1;
+
+        MAVLinkMissionTransfer::ItemInt next_item{
+            static_cast<uint16_t>(int_items.size()),
+            MAV_FRAME_MISSION,
+            MAV_CMD_DO_CHANGE_SPEED,
+            current,
+            autocontinue,
+            1.0f, // ground speed
+            item.speed_m_s,
+            -1.0f, // no throttle change
+            0.0f, // absolute
+            0,
+            0,
+            NAN,
+            MAV_MISSION_TYPE_MISSION};
 
-        // A loiter time of NAN is ignored but also a loiter time of 0 doesn't
-        // make any sense and should be discarded.
-        if (std::isfinite(item.loiter_time_s) && item.loiter_time_s > 0.0f) {
-            if (!last_position_valid) {
-                // In the case where we get a delay without a previous position, we will have to
-                // ignore it.
-                LogErr() << "Can't set camera action delay without previous position set.";
+        int_items.push_back(next_item);
+    }
 
-            } else {
-                // Current is the 0th waypoint
-                uint8_t current = ((int_items.size() == 0) ? 1 : 0);
-
-                uint8_t autocontinue = 1;
-
-                MAVLinkMissionTransfer::ItemInt next_item{
-                    static_cast<uint16_t>(int_items.size()),
-                    MAV_FRAME_MISSION,
-                    MAV_CMD_NAV_DELAY,
-                    current,
-                    autocontinue,
-                    item.loiter_time_s, // loiter time in seconds
-                    -1, // no specified hour
-                    -1, // no specified minute
-                    -1, // no specified second
-                    0,
-                    0,
-                    0,
-                    MAV_MISSION_TYPE_MISSION};
-
-                _mission_data.mavlink_mission_item_to_mission_item_indices.push_back(item_i);
-                int_items.push_back(next_item);
-            }
+    if (std::isfinite(item.gimbal_yaw_deg) || std::isfinite(item.gimbal_pitch_deg)) {
+        switch (gimbal_protocol) {
+            case GimbalProtocol::V1:
+                add_gimbal_items_v1(int_items, item.gimbal_pitch_deg, item.gimbal_yaw_deg);
+                break;
 
-            if (item.is_fly_through) {
-                LogWarn() << "Conflicting options set: fly_through=true and loiter_time>0.";
-            }
+            case GimbalProtocol::V2:
+                if (!state.gimbal_v2_in_control) {
+                    acquire_gimbal_control_v2(int_items);
+                    state.gimbal_v2_in_control = true;
+                }
+                add_gimbal_items_v2(int_items, item.gimbal_pitch_deg, item.gimbal_yaw_deg);
+                break;
+            case GimbalProtocol::Unknown:
+                // This should not happen because we wait until we know the protocol version.
+                LogErr() << "Unknown gimbal protocol, skipping gimbal commands.";
+                break;
         }
+    }
 
-        if (item.camera_action != CameraAction::None) {
+    // A loiter time of NAN is ignored but also a loiter time of 0 doesn't
+    // make any sense and should be discarded.
+    if (std::isfinite(item.loiter_time_s) && item.loiter_time_s > 0.0f) {
+        if (!state.last_position_valid) {
+            // In the case where we get a delay without a previous position, we will have to
+            // ignore it.
+            LogErr() << "Can't set camera action delay without previous position set.";
+
+        } else {
             // Current is the 0th waypoint
             uint8_t current = ((int_items.size() == 0) ? 1 : 0);
-            uint8_t autocontinue = 1;
 
-            uint16_t command = 0;
-            float param1 = NAN;
-            float param2 = NAN;
-            float param3 = NAN;
-            switch (item.camera_action) {
-                case CameraAction::TakePhoto:
-                    command = MAV_CMD_IMAGE_START_CAPTURE;
-                    param1 = 0.0f; // all camera IDs
-                    param2 = 0.0f; // no duration, take only one picture
-                    param3 = 1.0f; // only take one picture
-                    break;
-                case CameraAction::StartPhotoInterval:
-                    command = MAV_CMD_IMAGE_START_CAPTURE;
-                    param1 = 0.0f; // all camera IDs
-                    param2 = item.camera_photo_interval_s;
-                    param3 = 0.0f; // unlimited photos
-                    break;
-                case CameraAction::StopPhotoInterval:
-                    command = MAV_CMD_IMAGE_STOP_CAPTURE;
-                    param1 = 0.0f; // all camera IDs
-                    break;
-                case CameraAction::StartVideo:
-                    command = MAV_CMD_VIDEO_START_CAPTURE;
-                    param1 = 0.0f; // all camera IDs
-                    break;
-                case CameraAction::StopVideo:
-                    command = MAV_CMD_VIDEO_STOP_CAPTURE;
-                    param1 = 0.0f; // all camera IDs
-                    break;
-                case CameraAction::StartPhotoDistance:
-                    command = MAV_CMD_DO_SET_CAM_TRIGG_DIST;
-                    if (std::isfinite(item.camera_photo_distance_m)) {
-                        LogErr() << "No photo distance specified";
-                    }
-                    param1 = item.camera_photo_distance_m; // enable with distance
-                    param2 = 0.0f; // ignore
-                    param3 = 1.0f; // trigger
-                    break;
-                case CameraAction::StopPhotoDistance:
-                    command = MAV_CMD_DO_SET_CAM_TRIGG_DIST;
-                    param1 = 0.0f; // stop
-                    param2 = 0.0f; // ignore
-                    param3 = 0.0f; // no trigger
-                    break;
-                default:
-                    LogErr() << "Camera action not supported";
-                    break;
-            }
+            uint8_t autocontinue = 1;
 
             MAVLinkMissionTransfer::ItemInt next_item{
                 static_cast<uint16_t>(int_items.size()),
                 MAV_FRAME_MISSION,
-                command,
+                MAV_CMD_NAV_DELAY,
                 current,
                 autocontinue,
-                param1,
-                param2,
-                param3,
-                NAN,
+                item.loiter_time_s, // loiter time in seconds
+                -1, // no specified hour
+                -1, // no specified minute
+                -1, // no specified second
+                0,
                 0,
                 0,
-                NAN,
                 MAV_MISSION_TYPE_MISSION};
 
-            _mission_data.mavlink_mission_item_to_mission_item_indices.push_back(item_i);
             int_items.push_back(next_item);
         }
 
-        ++item_i;
+        if (item.is_fly_through) {
+            LogWarn() << "Conflicting options set: fly_through=true and loiter_time>0.";
+        }
     }
 
-    // We need to decrement the item_i again because it was increased in the loop above
-    // but the last items below still belong to the last mission item.
-    --item_i;
+    if (item.camera_action != CameraAction::None) {
+        // Current is the 0th waypoint
+        uint8_t current = ((int_items.size() == 0) ? 1 : 0);
+        uint8_t autocontinue = 1;
 
-    if (_mission_data.gimbal_v2_in_control) {
-        release_gimbal_control_v2(int_items, item_i);
-        _mission_data.gimbal_v2_in_control = false;
-    }
+        uint16_t command = 0;
+        float param1 = NAN;
+        float param2 = NAN;
+        float param3 = NAN;
+        switch (item.camera_action) {
+            case CameraAction::TakePhoto:
+                command = MAV_CMD_IMAGE_START_CAPTURE;
+                param1 = 0.0f; // all camera IDs
+                param2 = 0.0f; // no duration, take only one picture
+                param3 = 1.0f; // only take one picture
+                break;
+            case CameraAction::StartPhotoInterval:
+                command = MAV_CMD_IMAGE_START_CAPTURE;
+                param1 = 0.0f; // all camera IDs
+                param2 = item.camera_photo_interval_s;
+                param3 = 0.0f; // unlimited photos
+                break;
+            case CameraAction::StopPhotoInterval:
+                command = MAV_CMD_IMAGE_STOP_CAPTURE;
+                param1 = 0.0f; // all camera IDs
+                break;
+            case CameraAction::StartVideo:
+                command = MAV_CMD_VIDEO_START_CAPTURE;
+                param1 = 0.0f; // all camera IDs
+                break;
+            case CameraAction::StopVideo:
+                command = MAV_CMD_VIDEO_STOP_CAPTURE;
+                param1 = 0.0f; // all camera IDs
+                break;
+            case CameraAction::StartPhotoDistance:
+                command = MAV_CMD_DO_SET_CAM_TRIGG_DIST;
+                if (std::isfinite(item.camera_photo_distance_m)) {
+                    LogErr() << "No photo distance specified";
+                }
+                param1 = item.camera_photo_distance_m; // enable with distance
+                param2 = 0.0f; // ignore
+                param3 = 1.0f; // trigger
+                break;
+            case CameraAction::StopPhotoDistance:
+                command = MAV_CMD_DO_SET_CAM_TRIGG_DIST;
+                param1 = 0.0f; // stop
+                param2 = 0.0f; // ignore
+                param3 = 0.0f; // no trigger
+                break;
+            default:
+                LogErr() << "Camera action not supported";
+                break;
+        }
 
-    if (_enable_return_to_launch_after_mission) {
         MAVLinkMissionTransfer::ItemInt next_item{
             static_cast<uint16_t>(int_items.size()),
             MAV_FRAME_MISSION,
-            MAV_CMD_NAV_RETURN_TO_LAUNCH,
-            0, // current
-            1, // autocontinue
-            NAN, // loiter time in seconds
-            NAN, // empty
-            NAN, // radius around waypoint in meters ?
-            NAN, // loiter at center of waypoint
-            0,
+            command,
+            current,
+            autocontinue,
+            param1,
+            param2,
+            param3,
+            NAN,
             0,
             0,
+            NAN,
             MAV_MISSION_TYPE_MISSION};
 
-        _mission_data.mavlink_mission_item_to_mission_item_indices.push_back(item_i);
         int_items.push_back(next_item);
     }
-    return int_items;
+
+}
+
+bool MissionImpl::same_mission_item(const MissionItem& lhs, const MissionItem& rhs)
+{
+    // Unlike operator== this has to be exact, positions that are almost the
+    // same can still be rounded to different ints.
+    const auto same = [](auto a, auto b) { return a == b || (std::isnan(a) && std::isnan(b)); };
+
+    return same(lhs.latitude_deg, rhs.latitude_deg) &&
+           same(lhs.longitude_deg, rhs.longitude_deg) &&
+           same(lhs.relative_altitude_m, rhs.relative_altitude_m) &&
+           same(lhs.speed_m_s, rhs.speed_m_s) && lhs.is_fly_through == rhs.is_fly_through &&
+           same(lhs.gimbal_pitch_deg, rhs.gimbal_pitch_deg) &&
+           same(lhs.gimbal_yaw_deg, rhs.gimbal_yaw_deg) &&
+           lhs.camera_action == rhs.camera_action && same(lhs.loiter_time_s, rhs.loiter_time_s) &&
+           same(lhs.camera_photo_interval_s, rhs.camera_photo_interval_s) &&
+           same(lhs.acceptance_radius_m, rhs.acceptance_radius_m) &&
+           same(lhs.yaw_deg, rhs.yaw_deg) &&
+           same(lhs.camera_photo_distance_m, rhs.camera_photo_distance_m);
 }
 
 std::pair<Mission::Result, Mission::MissionPlan> MissionImpl::convert_to_result_and_mission_items(
@@ -599,6 +652,17 @@ std::pair<Mission::Result, Mission::MissionPlan> MissionImpl::convert_to_result_
         return result_pair;
     }
 
+    std::lock_guard<std::mutex> lock(_conversion_cache.mutex);
+
+    if (_conversion_cache.downloaded && _conversion_cache.downloaded->int_items == int_items) {
+        const auto& downloaded = _conversion_cache.downloaded.value();
+        _mission_data.mavlink_mission_item_to_mission_item_indices =
+            downloaded.mavlink_mission_item_to_mission_item_indices;
+        _enable_return_to_launch_after_mission = downloaded.enable_return_to_launch_after_mission;
+        _enable_absolute_gimbal_yaw_angle = downloaded.enable_absolute_gimbal_yaw_angle;
+        return downloaded.result_pair;
+    }
+
     _mission_data.mavlink_mission_item_to_mission_item_indices.clear();
 
     Mission::DownloadMissionCallback callback;
@@ -752,16 +816,23 @@ std::pair<Mission::Result, Mission::MissionPlan> MissionImpl::convert_to_result_
         // Don't forget to add last mission item.
         result_pair.second.mission_items.push_back(new_mission_item);
     }
+
+    _conversion_cache.downloaded = DownloadedMission{
+        int_items,
+        result_pair,
+        _mission_data.mavlink_mission_item_to_mission_item_indices,
+        _enable_return_to_launch_after_mission,
+        _enable_absolute_gimbal_yaw_angle};
+
     return result_pair;
 }
 
 Mission::Result MissionImpl::start_mission()
 {
-    auto prom = std::promise<Mission::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Mission::Result> waiter;
 
-    start_mission_async([&prom](Mission::Result result) { prom.set_value(result); });
-    return fut.get();
+    start_mission_async(waiter.completion());
+    return waiter.wait();
 }
 
 void MissionImpl::start_mission_async(const Mission::ResultCallback& callback)
@@ -775,11 +846,10 @@ void MissionImpl::start_mission_async(const Mission::ResultCallback& callback)
 
 Mission::Result MissionImpl::pause_mission()
 {
-    auto prom = std::promise<Mission::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Mission::Result> waiter;
 
-    pause_mission_async([&prom](Mission::Result result) { prom.set_value(result); });
-    return fut.get();
+    pause_mission_async(waiter.completion());
+    return waiter.wait();
 }
 
 void MissionImpl::pause_mission_async(const Mission::ResultCallback& callback)
@@ -793,12 +863,22 @@ void MissionImpl::pause_mission_async(const Mission::ResultCallback& callback)
 void MissionImpl::report_flight_mode_change(
     Mission::ResultCallback callback, MavlinkCommandSender::Result result)
 {
+    report_result(callback, command_result_to_mission_result(result));
+}
+
+void MissionImpl::report_result(const Mission::ResultCallback& callback, Mission::Result result)
+{
+    // A sync call is woken up right away, there is no user code to run.
+    if (completes_waiter(callback)) {
+        callback(result);
+        return;
+    }
+
     if (!callback) {
         return;
     }
 
-    _parent->call_user_callback(
-        [callback, result]() { callback(command_result_to_mission_result(result)); });
+    _parent->call_user_callback([callback, result]() { callback(result); });
 }
 
 Mission::Result MissionImpl::command_result_to_mission_result(MavlinkCommandSender::Result result)
@@ -827,11 +907,10 @@ Mission::Result MissionImpl::command_result_to_mission_result(MavlinkCommandSend
 
 Mission::Result MissionImpl::clear_mission()
 {
-    auto prom = std::promise<Mission::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Mission::Result> waiter;
 
-    clear_mission_async([&prom](Mission::Result result) { prom.set_value(result); });
-    return fut.get();
+    clear_mission_async(waiter.completion());
+    return waiter.wait();
 }
 
 void MissionImpl::clear_mission_async(const Mission::ResultCallback& callback)
@@ -840,23 +919,17 @@ void MissionImpl::clear_mission_async(const Mission::ResultCallback& callback)
 
     _parent->mission_transfer().clear_items_async(
         MAV_MISSION_TYPE_MISSION, [this, callback](MAVLinkMissionTransfer::Result result) {
-            auto converted_result = convert_result(result);
-            _parent->call_user_callback([callback, converted_result]() {
-                if (callback) {
-                    callback(converted_result);
-                }
-            });
+            report_result(callback, convert_result(result));
         });
 }
 
 Mission::Result MissionImpl::set_current_mission_item(int current)
 {
-    auto prom = std::promise<Mission::Result>();
-    auto fut = prom.get_future();
+    SyncWaiter<Mission::Result> waiter;
 
     set_current_mission_item_async(
-        current, [&prom](Mission::Result result) { prom.set_value(result); });
-    return fut.get();
+        current, waiter.completion());
+    return waiter.wait();
 }
 
 void MissionImpl::set_current_mission_item_async(
@@ -888,53 +961,32 @@ void MissionImpl::set_current_mission_item_async(
                 return;
             }
         });
+        return;
     }
 
     _parent->mission_transfer().set_current_item_async(
         mavlink_index, [this, callback](MAVLinkMissionTransfer::Result result) {
-            auto converted_result = convert_result(result);
-            _parent->call_user_callback([callback, converted_result]() {
-                if (callback) {
-                    callback(converted_result);
-                }
-            });
+            report_result(callback, convert_result(result));
         });
 }
 
 void MissionImpl::report_progress_locked()
 {
-    const auto temp_callback = _mission_data.mission_progress_callback;
-    if (temp_callback == nullptr) {
+    if (_mission_data.mission_progress_subscriptions.empty()) {
         return;
     }
 
-    int current = current_mission_item_locked();
-    int total = total_mission_items_locked();
+    Mission::MissionProgress mission_progress;
+    mission_progress.current = current_mission_item_locked();
+    mission_progress.total = total_mission_items_locked();
 
     // Do not report -1 as a current mission item
-    if (current == -1) {
+    if (mission_progress.current == -1) {
         return;
     }
 
-    bool should_report = false;
-    if (_mission_data.last_current_reported_mission_item != current) {
-        _mission_data.last_current_reported_mission_item = current;
-        should_report = true;
-    }
-    if (_mission_data.last_total_reported_mission_item != total) {
-        _mission_data.last_total_reported_mission_item = total;
-        should_report = true;
-    }
-
-    if (should_report) {
-        _parent->call_user_callback([temp_callback, current, total]() {
-            LogDebug() << "current: " << current << ", total: " << total;
-            Mission::MissionProgress mission_progress;
-            mission_progress.current = current;
-            mission_progress.total = total;
-            temp_callback(mission_progress);
-        });
-    }
+    _mission_data.mission_progress_subscriptions.queue(
+        mission_progress, [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
 std::pair<Mission::Result, bool> MissionImpl::is_mission_finished() const
@@ -1020,10 +1072,16 @@ Mission::MissionProgress MissionImpl::mission_progress()
     return mission_progress;
 }
 
-void MissionImpl::subscribe_mission_progress(Mission::MissionProgressCallback callback)
+void MissionImpl::subscribe_mission_progress(
+    Mission::MissionProgressCallback callback, const SubscriptionOptions& options)
 {
     std::lock_guard<std::mutex> lock(_mission_data.mutex);
-    _mission_data.mission_progress_callback = callback;
+    _mission_data.mission_progress_subscriptions.clear();
+    if (callback) {
+        auto change_only = options;
+        change_only.on_change = true;
+        _mission_data.mission_progress_subscriptions.subscribe(callback, change_only);
+    }
 }
 
 Mission::Result MissionImpl::convert_result(MAVLinkMissionTransfer::Result result)
@@ -1065,10 +1123,7 @@ Mission::Result MissionImpl::convert_result(MAVLinkMissionTransfer::Result resul
 }
 
 void MissionImpl::add_gimbal_items_v1(
-    std::vector<MAVLinkMissionTransfer::ItemInt>& int_items,
-    unsigned item_i,
-    float pitch_deg,
-    float yaw_deg)
+    std::vector<MAVLinkMissionTransfer::ItemInt>& int_items, float pitch_deg, float yaw_deg)
 {
     if (_enable_absolute_gimbal_yaw_angle) {
         // We need to configure the gimbal to use an absolute angle.
@@ -1094,7 +1149,6 @@ void MissionImpl::add_gimbal_items_v1(
             2.0f, // eventually this is the correct flag to set absolute yaw angle.
             MAV_MISSION_TYPE_MISSION};
 
-        _mission_data.mavlink_mission_item_to_mission_item_indices.push_back(item_i);
         int_items.push_back(next_item);
     }
 
@@ -1120,15 +1174,11 @@ void MissionImpl::add_gimbal_items_v1(
         MAV_MOUNT_MODE_MAVLINK_TARGETING,
         MAV_MISSION_TYPE_MISSION};
 
-    _mission_data.mavlink_mission_item_to_mission_item_indices.push_back(item_i);
     int_items.push_back(next_item);
 }
 
 void MissionImpl::add_gimbal_items_v2(
-    std::vector<MAVLinkMissionTransfer::ItemInt>& int_items,
-    unsigned item_i,
-    float pitch_deg,
-    float yaw_deg)
+    std::vector<MAVLinkMissionTransfer::ItemInt>& int_items, float pitch_deg, float yaw_deg)
 {
     uint8_t current = ((int_items.size() == 0) ? 1 : 0);
 
@@ -1160,12 +1210,11 @@ void MissionImpl::add_gimbal_items_v2(
         0, // all devices
         MAV_MISSION_TYPE_MISSION};
 
-    _mission_data.mavlink_mission_item_to_mission_item_indices.push_back(item_i);
     int_items.push_back(next_item);
 }
 
 void MissionImpl::acquire_gimbal_control_v2(
-    std::vector<MAVLinkMissionTransfer::ItemInt>& int_items, unsigned item_i)
+    std::vector<MAVLinkMissionTransfer::ItemInt>& int_items)
 {
     uint8_t current = ((int_items.size() == 0) ? 1 : 0);
 
@@ -1186,12 +1235,11 @@ void MissionImpl::acquire_gimbal_control_v2(
         0, // all devices
         MAV_MISSION_TYPE_MISSION};
 
-    _mission_data.mavlink_mission_item_to_mission_item_indices.push_back(item_i);
     int_items.push_back(next_item);
 }
 
 void MissionImpl::release_gimbal_control_v2(
-    std::vector<MAVLinkMissionTransfer::ItemInt>& int_items, unsigned item_i)
+    std::vector<MAVLinkMissionTransfer::ItemInt>& int_items)
 {
     uint8_t current = ((int_items.size() == 0) ? 1 : 0);
 
@@ -1212,7 +1260,6 @@ void MissionImpl::release_gimbal_control_v2(
         0, // all devices
         MAV_MISSION_TYPE_MISSION};
 
-    _mission_data.mavlink_mission_item_to_mission_item_indices.push_back(item_i);
     int_items.push_back(next_item);
 }
 
@@ -1,15 +1,18 @@
 #pragma once
 
-#include <atomic>
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <utility>
 
+#include "callback_list.h"
 #include "mavlink_include.h"
 #include "plugins/mission/mission.h"
 #include "plugin_impl_base.h"
 #include "system.h"
 #include "mavlink_mission_transfer.h"
+#include "ready_value.h"
 
 namespace mavsdk {
 
@@ -64,7 +67,9 @@ public:
     int total_mission_items() const;
 
     Mission::MissionProgress mission_progress();
-    void subscribe_mission_progress(Mission::MissionProgressCallback callback);
+    void subscribe_mission_progress(
+        Mission::MissionProgressCallback callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
 
     // Non-copyable
     MissionImpl(const MissionImpl&) = delete;
@@ -79,13 +84,25 @@ private:
     void process_mission_item_reached(const mavlink_message_t& message);
     void process_gimbal_manager_information(const mavlink_message_t& message);
     void receive_protocol_timeout();
-    void wait_for_protocol();
     void wait_for_protocol_async(std::function<void()> callback);
 
     static bool has_valid_position(const Mission::MissionItem& item);
     static float hold_time(const Mission::MissionItem& item);
     static float acceptance_radius(const Mission::MissionItem& item);
 
+    // Where converting an item to MAVLink items depends on the ones before it.
+    struct ConversionState {
+        // This flag is to protect us from using an invalid x/y.
+        bool last_position_valid{false};
+        bool gimbal_v2_in_control{false};
+
+        bool operator==(const ConversionState& other) const
+        {
+            return last_position_valid == other.last_position_valid &&
+                   gimbal_v2_in_control == other.gimbal_v2_in_control;
+        }
+    };
+
     std::vector<MAVLinkMissionTransfer::ItemInt>
     convert_to_int_items(const std::vector<Mission::MissionItem>& mission_items);
 
@@ -94,6 +111,7 @@ private:
 
     void report_flight_mode_change(
         Mission::ResultCallback callback, MavlinkCommandSender::Result result);
+    void report_result(const Mission::ResultCallback& callback, Mission::Result result);
     static Mission::Result command_result_to_mission_result(MavlinkCommandSender::Result result);
 
     // FIXME: make static
@@ -104,33 +122,28 @@ private:
     static Mission::Result convert_result(MAVLinkMissionTransfer::Result result);
 
     void add_gimbal_items_v1(
-        std::vector<MAVLinkMissionTransfer::ItemInt>& int_items,
-        unsigned item_i,
-        float pitch_deg,
-        float yaw_deg);
+        std::vector<MAVLinkMissionTransfer::ItemInt>& int_items, float pitch_deg, float yaw_deg);
     void add_gimbal_items_v2(
-        std::vector<MAVLinkMissionTransfer::ItemInt>& int_items,
-        unsigned item_i,
-        float pitch_deg,
-        float yaw_deg);
+        std::vector<MAVLinkMissionTransfer::ItemInt>& int_items, float pitch_deg, float yaw_deg);
 
-    void acquire_gimbal_control_v2(
-        std::vector<MAVLinkMissionTransfer::ItemInt>& int_items, unsigned item_i);
+    void acquire_gimbal_control_v2(std::vector<MAVLinkMissionTransfer::ItemInt>& int_items);
 
-    void release_gimbal_control_v2(
-        std::vector<MAVLinkMissionTransfer::ItemInt>& int_items, unsigned item_i);
+    void release_gimbal_control_v2(std::vector<MAVLinkMissionTransfer::ItemInt>& int_items);
 
     struct MissionData {
         mutable std::mutex mutex{};
         int last_current_mavlink_mission_item{-1};
         int last_reached_mavlink_mission_item{-1};
         std::vector<int> mavlink_mission_item_to_mission_item_indices{};
-        Mission::MissionProgressCallback mission_progress_callback{nullptr};
-        int last_current_reported_mission_item{-1};
-        int last_total_reported_mission_item{-1};
+        // The [begin, end) range of MAVLink mission items each mission item
+        // was converted to on the last upload.
+        std::vector<std::pair<std::size_t, std::size_t>>
+            mission_item_to_mavlink_mission_item_ranges{};
+        // Always only passing on changes, the progress is reported with
+        // every MISSION_CURRENT.
+        CallbackList<Mission::MissionProgress> mission_progress_subscriptions{};
         std::weak_ptr<MAVLinkMissionTransfer::WorkItem> last_upload{};
         std::weak_ptr<MAVLinkMissionTransfer::WorkItem> last_download{};
-        bool gimbal_v2_in_control{false};
     } _mission_data{};
 
     void* _timeout_cookie{nullptr};
@@ -143,7 +156,43 @@ private:
 
     void* _gimbal_protocol_cookie{nullptr};
     enum class GimbalProtocol { Unknown, V1, V2 };
-    std::atomic<GimbalProtocol> _gimbal_protocol{GimbalProtocol::Unknown};
+    // Not set until we know which protocol the gimbal speaks.
+    ReadyValue<GimbalProtocol> _gimbal_protocol{};
+
+    void convert_mission_item(
+        const Mission::MissionItem& item,
+        GimbalProtocol gimbal_protocol,
+        ConversionState& state,
+        std::vector<MAVLinkMissionTransfer::ItemInt>& int_items);
+    static bool same_mission_item(const Mission::MissionItem& lhs, const Mission::MissionItem& rhs);
+
+    // Planners tend to upload the same mission over and over with only a few
+    // changes, so the conversion of each item is kept and only redone for
+    // the ones that changed. The same goes for downloading the same mission
+    // again.
+    struct ConvertedItem {
+        bool valid{false};
+        Mission::MissionItem item{};
+        ConversionState state_before{};
+        ConversionState state_after{};
+        std::vector<MAVLinkMissionTransfer::ItemInt> int_items{};
+    };
+
+    struct DownloadedMission {
+        std::vector<MAVLinkMissionTransfer::ItemInt> int_items{};
+        std::pair<Mission::Result, Mission::MissionPlan> result_pair{};
+        std::vector<int> mavlink_mission_item_to_mission_item_indices{};
+        bool enable_return_to_launch_after_mission{false};
+        bool enable_absolute_gimbal_yaw_angle{false};
+    };
+
+    struct {
+        std::mutex mutex{};
+        GimbalProtocol gimbal_protocol{GimbalProtocol::Unknown};
+        bool absolute_gimbal_yaw_angle{false};
+        std::vector<ConvertedItem> items{};
+        std::optional<DownloadedMission> downloaded{};
+    } _conversion_cache{};
 };
 
 } // namespace mavsdk
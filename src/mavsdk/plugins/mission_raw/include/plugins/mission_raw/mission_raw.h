@@ -168,6 +168,42 @@ public:
      */
     friend std::ostream& operator<<(std::ostream& str, MissionRaw::Result const& result);
 
+    /**
+     * @brief Mission to upload to one vehicle of a fleet.
+     */
+    struct FleetUpload {
+        MissionRaw* mission_raw{nullptr}; /**< @brief Plugin of the vehicle to upload to. */
+        std::vector<MissionItem> mission_items{}; /**< @brief Mission items for the vehicle. */
+    };
+
+    /**
+     * @brief How the uploads to a fleet share the link.
+     */
+    struct FleetUploadOptions {
+        double link_budget_bytes_s{
+            0.0}; /**< @brief Bytes per second for all uploads together, 0 for no limit. */
+        uint32_t max_concurrent_uploads{8}; /**< @brief Uploads running at once, 0 for no limit. */
+    };
+
+    /**
+     * @brief Progress of the uploads to a fleet.
+     */
+    struct FleetUploadProgress {
+        uint32_t uploads_total{0}; /**< @brief Number of vehicles uploaded to. */
+        uint32_t uploads_done{0}; /**< @brief Number of vehicles with a result. */
+        float progress{0.0f}; /**< @brief Progress of all items together, from 0 to 1. */
+    };
+
+    /**
+     * @brief Result of the upload to one vehicle of a fleet.
+     */
+    struct FleetUploadResult {
+        uint8_t system_id{0}; /**< @brief System ID of the vehicle. */
+        Result result{Result::Unknown}; /**< @brief Result for this vehicle. */
+        double start_offset_s{0.0}; /**< @brief Time from the call until the upload started. */
+        double duration_s{0.0}; /**< @brief Time from the start of the upload until the result. */
+    };
+
     /**
      * @brief Callback type for asynchronous MissionRaw calls.
      */
@@ -371,6 +407,156 @@ public:
     std::pair<Result, MissionRaw::MissionImportData>
     import_qgroundcontrol_mission(std::string qgc_plan_path) const;
 
+    /**
+     * @brief Upload only the raw mission items that changed (asynchronous).
+     *
+     * The items are compared against the last mission known to be on the
+     * drone, from the last download or upload, and only the changed ranges
+     * are sent. If the number of items changed, no mission is known yet, or
+     * the drone rejects partial writes, the whole mission is uploaded
+     * instead. This assumes the mission was not changed by anyone else in
+     * the meantime.
+     *
+     * This function is non-blocking. See 'upload_mission_diff' for the blocking counterpart.
+     */
+    void upload_mission_diff_async(
+        std::vector<MissionItem> mission_items, const ResultCallback callback);
+
+    /**
+     * @brief Upload only the raw mission items that changed.
+     *
+     * The items are compared against the last mission known to be on the
+     * drone, from the last download or upload, and only the changed ranges
+     * are sent. If the number of items changed, no mission is known yet, or
+     * the drone rejects partial writes, the whole mission is uploaded
+     * instead. This assumes the mission was not changed by anyone else in
+     * the meantime.
+     *
+     * This function is blocking. See 'upload_mission_diff_async' for the non-blocking
+     * counterpart.
+     *
+     * @return Result of request.
+     */
+    Result upload_mission_diff(std::vector<MissionItem> mission_items) const;
+
+    /**
+     * @brief Import a QGroundControl mission in JSON .plan format from a string.
+     *
+     * Supported:
+     * - Waypoints
+     * - Survey
+     * Not supported:
+     * - Structure Scan
+     *
+     * This function is blocking. See 'import_qgroundcontrol_mission_from_string_async' for the
+     * non-blocking counterpart.
+     *
+     * @return Result of request.
+     */
+    std::pair<Result, MissionRaw::MissionImportData>
+    import_qgroundcontrol_mission_from_string(const std::string& qgc_plan) const;
+
+    /**
+     * @brief Start uploading a raw mission while its items are still coming in (asynchronous).
+     *
+     * Only the number of items has to be known to start. The items are then added in order
+     * with 'add_mission_stream_items', and the drone receives each one as soon as it is added
+     * and requested, so very large missions never have to be held as a whole.
+     *
+     * The callback reports the result of the whole upload.
+     *
+     * This function is non-blocking.
+     */
+    void
+    upload_mission_stream_async(uint32_t mission_items_count, const ResultCallback callback);
+
+    /**
+     * @brief Add the next raw mission items of the upload started with
+     * 'upload_mission_stream_async'.
+     *
+     * Items out of order, of another mission type, or with other than exactly one current item
+     * in total end the upload.
+     *
+     * This function is blocking.
+     *
+     * @return Result of request.
+     */
+    Result add_mission_stream_items(std::vector<MissionItem> mission_items) const;
+
+    /**
+     * @brief Callback type for import_qgroundcontrol_mission_async.
+     */
+    using ImportQgroundcontrolMissionCallback =
+        std::function<void(Result, MissionRaw::MissionImportData)>;
+
+    /**
+     * @brief Import a QGroundControl missions in JSON .plan format (asynchronous).
+     *
+     * The plan is read and parsed on a background thread, so a big plan does
+     * not hold up the caller.
+     *
+     * This function is non-blocking. See 'import_qgroundcontrol_mission' for the blocking
+     * counterpart.
+     */
+    void import_qgroundcontrol_mission_async(
+        std::string qgc_plan_path, const ImportQgroundcontrolMissionCallback callback);
+
+    /**
+     * @brief Import a QGroundControl mission in JSON .plan format from a string (asynchronous).
+     *
+     * The plan is parsed on a background thread, so a big plan does not hold
+     * up the caller.
+     *
+     * This function is non-blocking. See 'import_qgroundcontrol_mission_from_string' for the
+     * blocking counterpart.
+     */
+    void import_qgroundcontrol_mission_from_string_async(
+        std::string qgc_plan, const ImportQgroundcontrolMissionCallback callback);
+
+    /**
+     * @brief Callback type for the progress of upload_mission_fleet_async.
+     */
+    using FleetUploadProgressCallback = std::function<void(FleetUploadProgress)>;
+
+    /**
+     * @brief Callback type for upload_mission_fleet_async, with one result per vehicle in the
+     * given order.
+     */
+    using FleetUploadResultCallback = std::function<void(std::vector<FleetUploadResult>)>;
+
+    /**
+     * @brief Upload a different mission to each of several vehicles sharing a link.
+     *
+     * Only so many uploads run at once, and the mission messages of all of them go out within
+     * the link budget, rather than each upload retrying on its own while they all compete for
+     * the link. Answers the vehicles are waiting for again go first, the others take turns, so
+     * the uploads progress side by side. The vehicles must have been uploaded to one at a time
+     * before, an upload already running to one of them ends with 'Result::Busy'.
+     *
+     * The progress callback is called as the uploads progress, the callback once all vehicles
+     * have a result. The plugins need to be kept around until then.
+     *
+     * This function is non-blocking. See 'upload_mission_fleet' for the blocking counterpart.
+     */
+    static void upload_mission_fleet_async(
+        const std::vector<FleetUpload>& uploads,
+        const FleetUploadOptions& options,
+        const FleetUploadProgressCallback& progress_callback,
+        const FleetUploadResultCallback& callback);
+
+    /**
+     * @brief Upload a different mission to each of several vehicles sharing a link.
+     *
+     * This function is blocking. See 'upload_mission_fleet_async' for the non-blocking
+     * counterpart.
+     *
+     * @return Results, one per vehicle in the given order.
+     */
+    static std::vector<FleetUploadResult> upload_mission_fleet(
+        const std::vector<FleetUpload>& uploads,
+        const FleetUploadOptions& options,
+        const FleetUploadProgressCallback& progress_callback = nullptr);
+
     /**
      * @brief Copy constructor.
      */
@@ -382,6 +568,8 @@ public:
     const MissionRaw& operator=(const MissionRaw&) = delete;
 
 private:
+    static std::vector<MissionRawImpl*> impls_of(const std::vector<FleetUpload>& uploads);
+
     /** @private Underlying implementation, set at instantiation */
     std::unique_ptr<MissionRawImpl> _impl;
 };
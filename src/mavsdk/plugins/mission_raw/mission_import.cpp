@@ -1,99 +1,436 @@
 #include "log.h"
 #include "mission_import.h"
 #include "mavlink_include.h"
+#include <array>
+#include <clocale> // for `std::localeconv`
 #include <cmath> // for `std::round`
-#include <sstream> // for `std::stringstream`
+#include <cstdlib> // for `std::strtod`
+#include <optional>
+#include <streambuf>
 
 namespace mavsdk {
 
-std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
-MissionImport::parse_json(const std::string& raw_json)
-{
-    Json::CharReaderBuilder builder;
-    const std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
-    Json::Value root;
-    JSONCPP_STRING err;
+// Minimal pull parser for JSON reading straight from a stream buffer.
+//
+// Objects and arrays are walked with callbacks which have to consume the
+// value of each member or element, anything not needed can be skipped
+// without being stored.
+class JsonReader {
+public:
+    struct Scalar {
+        enum class Type { Null, Bool, Number, String } type{Type::Null};
+        bool boolean{false};
+        double number{0.0};
+        std::string string{};
+
+        [[nodiscard]] bool is_null() const { return type == Type::Null; }
+        [[nodiscard]] bool is_string(const char* str) const
+        {
+            return type == Type::String && string == str;
+        }
+        [[nodiscard]] std::optional<double> as_double() const
+        {
+            switch (type) {
+                case Type::Bool:
+                    return boolean ? 1.0 : 0.0;
+                case Type::Number:
+                    return number;
+                default:
+                    return std::nullopt;
+            }
+        }
+    };
 
-    if (!reader->parse(raw_json.c_str(), raw_json.c_str() + raw_json.length(), &root, &err)) {
-        LogErr() << "Parse error: " << err;
-        return {MissionRaw::Result::FailedToParseQgcPlan, {}};
+    explicit JsonReader(std::streambuf& buffer) : _buffer(buffer) {}
+
+    // Returns the next char after whitespace without consuming it, or 0 at the end.
+    char peek_token()
+    {
+        while (true) {
+            const auto c = _buffer.sgetc();
+            if (c == std::char_traits<char>::eof()) {
+                return 0;
+            }
+            if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+                return static_cast<char>(c);
+            }
+            bump();
+        }
     }
 
-    if (!check_overall_version(root)) {
-        return {MissionRaw::Result::FailedToParseQgcPlan, {}};
+    // on_member(key) is called for each member and has to read its value.
+    template<typename OnMember> bool read_object(OnMember&& on_member)
+    {
+        if (!expect('{', "expected object")) {
+            return false;
+        }
+        if (peek_token() == '}') {
+            bump();
+            return true;
+        }
+        std::string key;
+        while (true) {
+            if (peek_token() != '"' || !read_string(key)) {
+                return fail("expected member name");
+            }
+            if (!expect(':', "expected ':'")) {
+                return false;
+            }
+            if (!on_member(key)) {
+                return false;
+            }
+            const auto c = peek_token();
+            bump();
+            if (c == '}') {
+                return true;
+            }
+            if (c != ',') {
+                return fail("expected ',' or '}'");
+            }
+        }
     }
 
-    auto maybe_mission_items = import_mission(root);
-    if (!maybe_mission_items.has_value()) {
-        return {MissionRaw::Result::FailedToParseQgcPlan, {}};
+    // on_element() is called for each element and has to read it.
+    template<typename OnElement> bool read_array(OnElement&& on_element)
+    {
+        if (!expect('[', "expected array")) {
+            return false;
+        }
+        if (peek_token() == ']') {
+            bump();
+            return true;
+        }
+        while (true) {
+            if (!on_element()) {
+                return false;
+            }
+            const auto c = peek_token();
+            bump();
+            if (c == ']') {
+                return true;
+            }
+            if (c != ',') {
+                return fail("expected ',' or ']'");
+            }
+        }
     }
 
-    MissionRaw::MissionImportData import_data;
-    import_data.mission_items = maybe_mission_items.value();
-    return {MissionRaw::Result::Success, import_data};
-}
+    bool read_scalar(Scalar& scalar)
+    {
+        switch (peek_token()) {
+            case '"':
+                scalar.type = Scalar::Type::String;
+                return read_string(scalar.string);
+            case 'n':
+                scalar.type = Scalar::Type::Null;
+                return read_literal("null");
+            case 't':
+                scalar.type = Scalar::Type::Bool;
+                scalar.boolean = true;
+                return read_literal("true");
+            case 'f':
+                scalar.type = Scalar::Type::Bool;
+                scalar.boolean = false;
+                return read_literal("false");
+            default:
+                scalar.type = Scalar::Type::Number;
+                return read_number(scalar.number);
+        }
+    }
 
-bool MissionImport::check_overall_version(const Json::Value& root)
-{
-    const auto supported_overall_version = 1;
-    const auto overall_version = root["version"];
-    if (overall_version.empty() || overall_version.asInt() != supported_overall_version) {
-        LogErr() << "Overall .plan version not supported, found version: " << overall_version
-                 << ", supported: " << supported_overall_version;
+    bool skip_value()
+    {
+        const auto c = peek_token();
+        if (c != '{' && c != '[') {
+            Scalar ignored;
+            return read_scalar(ignored);
+        }
+
+        if (_depth >= max_depth) {
+            return fail("nested too deeply");
+        }
+        ++_depth;
+        const bool success = (c == '{') ?
+                                 read_object([this](const std::string&) { return skip_value(); }) :
+                                 read_array([this]() { return skip_value(); });
+        --_depth;
+        return success;
+    }
+
+    bool fail(const char* what)
+    {
+        if (!_failed) {
+            LogErr() << "Parse error at offset " << _offset << ": " << what;
+            _failed = true;
+        }
         return false;
     }
 
-    return true;
-}
+private:
+    static constexpr unsigned max_depth = 256;
 
-std::optional<std::vector<MissionRaw::MissionItem>>
-MissionImport::import_mission(const Json::Value& root)
-{
-    // We need a mission part.
-    const auto mission = root["mission"];
-    if (mission.empty()) {
-        LogErr() << "No mission found in .plan.";
-        return std::nullopt;
+    void bump()
+    {
+        _buffer.sbumpc();
+        ++_offset;
     }
 
-    // Check the mission version.
-    const auto supported_mission_version = 2;
-    const auto mission_version = mission["version"];
-    if (mission_version.empty() || mission_version.asInt() != supported_mission_version) {
-        LogErr() << "mission version for .plan not supported, found version: "
-                 << mission_version.asInt() << ", supported: " << supported_mission_version;
-        return std::nullopt;
+    bool expect(char c, const char* what)
+    {
+        if (peek_token() != c) {
+            return fail(what);
+        }
+        bump();
+        return true;
     }
 
-    std::vector<MissionRaw::MissionItem> mission_items;
+    bool read_literal(const char* literal)
+    {
+        for (const char* p = literal; *p != '\0'; ++p) {
+            if (_buffer.sgetc() != *p) {
+                return fail("invalid literal");
+            }
+            bump();
+        }
+        return true;
+    }
 
-    // Go through items
-    for (const auto& json_item : mission["items"]) {
-        const auto type = json_item["type"];
+    bool read_number(double& number)
+    {
+        // Long enough for any double, longer ones are not worth supporting.
+        std::array<char, 64> chars{};
+        std::size_t len = 0;
+        while (true) {
+            const auto c = _buffer.sgetc();
+            if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' ||
+                  c == 'E')) {
+                break;
+            }
+            if (len == chars.size() - 1) {
+                return fail("number too long");
+            }
+            // strtod uses the decimal point of the current locale.
+            chars[len++] = (c == '.') ? *std::localeconv()->decimal_point : static_cast<char>(c);
+            bump();
+        }
+        if (len == 0) {
+            return fail("expected value");
+        }
 
-        if (!type.isNull() && type.asString() == "SimpleItem") {
-            const auto maybe_item = import_simple_mission_item(json_item);
-            if (maybe_item.has_value()) {
-                mission_items.push_back(maybe_item.value());
-            } else {
-                return std::nullopt;
+        char* end = nullptr;
+        number = std::strtod(chars.data(), &end);
+        if (end != chars.data() + len) {
+            return fail("invalid number");
+        }
+        return true;
+    }
+
+    bool read_string(std::string& str)
+    {
+        str.clear();
+        bump(); // opening quote
+        while (true) {
+            const auto c = _buffer.sbumpc();
+            ++_offset;
+            if (c == std::char_traits<char>::eof()) {
+                return fail("unterminated string");
+            }
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                str.push_back(static_cast<char>(c));
+                continue;
             }
 
-        } else if (!type.isNull() && type.asString() == "ComplexItem") {
-            const auto maybe_items = import_complex_mission_items(json_item);
-            if (maybe_items.has_value()) {
-                mission_items.insert(
-                    mission_items.end(), maybe_items.value().begin(), maybe_items.value().end());
+            const auto escaped = _buffer.sbumpc();
+            ++_offset;
+            switch (escaped) {
+                case '"':
+                case '\\':
+                case '/':
+                    str.push_back(static_cast<char>(escaped));
+                    break;
+                case 'b':
+                    str.push_back('\b');
+                    break;
+                case 'f':
+                    str.push_back('\f');
+                    break;
+                case 'n':
+                    str.push_back('\n');
+                    break;
+                case 'r':
+                    str.push_back('\r');
+                    break;
+                case 't':
+                    str.push_back('\t');
+                    break;
+                case 'u':
+                    if (!read_unicode_escape(str)) {
+                        return false;
+                    }
+                    break;
+                default:
+                    return fail("invalid escape");
+            }
+        }
+    }
+
+    bool read_hex4(uint32_t& value)
+    {
+        value = 0;
+        for (unsigned i = 0; i < 4; ++i) {
+            const auto c = _buffer.sbumpc();
+            ++_offset;
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= static_cast<uint32_t>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                value |= static_cast<uint32_t>(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                value |= static_cast<uint32_t>(c - 'A' + 10);
             } else {
-                return std::nullopt;
+                return fail("invalid unicode escape");
+            }
+        }
+        return true;
+    }
+
+    bool read_unicode_escape(std::string& str)
+    {
+        uint32_t code_point;
+        if (!read_hex4(code_point)) {
+            return false;
+        }
+
+        if (code_point >= 0xd800 && code_point <= 0xdbff) {
+            // High surrogate, the low one has to follow.
+            uint32_t low;
+            if (_buffer.sbumpc() != '\\' || _buffer.sbumpc() != 'u' || !read_hex4(low) ||
+                low < 0xdc00 || low > 0xdfff) {
+                return fail("invalid surrogate pair");
             }
+            _offset += 2;
+            code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+        }
 
+        if (code_point < 0x80) {
+            str.push_back(static_cast<char>(code_point));
+        } else if (code_point < 0x800) {
+            str.push_back(static_cast<char>(0xc0 | (code_point >> 6)));
+            str.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+        } else if (code_point < 0x10000) {
+            str.push_back(static_cast<char>(0xe0 | (code_point >> 12)));
+            str.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+            str.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
         } else {
-            LogErr() << "Type " << type.asString() << " not understood.";
-            return std::nullopt;
+            str.push_back(static_cast<char>(0xf0 | (code_point >> 18)));
+            str.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3f)));
+            str.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+            str.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+        }
+        return true;
+    }
+
+    std::streambuf& _buffer;
+    std::size_t _offset{0};
+    unsigned _depth{0};
+    bool _failed{false};
+};
+
+// Read-only stream buffer on top of memory we don't own.
+class MemoryStreambuf : public std::streambuf {
+public:
+    MemoryStreambuf(const char* data, std::size_t len)
+    {
+        // The buffer is never written to, the get area just isn't const.
+        auto* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + len);
+    }
+};
+
+// The fields of a mission item we care about, the members of a .plan item
+// can come in any order so they are collected first.
+struct MissionImport::ItemFields {
+    JsonReader::Scalar type{};
+    JsonReader::Scalar command{};
+    JsonReader::Scalar auto_continue{};
+    JsonReader::Scalar frame{};
+    bool has_params{false};
+    bool params_is_array{false};
+    // Missing params stay null.
+    std::array<JsonReader::Scalar, 7> params{};
+
+    JsonReader::Scalar complex_item_type{};
+    JsonReader::Scalar version{};
+    bool has_transect_style_complex_item{false};
+    bool has_survey_items{false};
+};
+
+std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
+MissionImport::parse_json(const std::string& raw_json)
+{
+    return parse_json(raw_json.data(), raw_json.size());
+}
+
+std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
+MissionImport::parse_json(const char* data, std::size_t len)
+{
+    MemoryStreambuf buffer(data, len);
+    return parse_plan(buffer, len);
+}
+
+std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
+MissionImport::parse_json(std::istream& input, std::size_t size_hint)
+{
+    if (input.rdbuf() == nullptr) {
+        return {MissionRaw::Result::FailedToParseQgcPlan, {}};
+    }
+    return parse_plan(*input.rdbuf(), size_hint);
+}
+
+std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
+MissionImport::parse_plan(std::streambuf& buffer, std::size_t size_hint)
+{
+    JsonReader reader(buffer);
+    JsonReader::Scalar overall_version;
+    bool has_mission = false;
+
+    MissionRaw::MissionImportData import_data;
+    // Even minified, an item in a .plan takes more than a hundred bytes.
+    import_data.mission_items.reserve(size_hint / 128);
+
+    const bool parsed = reader.read_object([&](const std::string& key) {
+        if (key == "version") {
+            return reader.read_scalar(overall_version);
         }
+        if (key == "mission" && reader.peek_token() == '{') {
+            has_mission = true;
+            return import_mission(reader, import_data.mission_items);
+        }
+        return reader.skip_value();
+    });
+    if (!parsed) {
+        return {MissionRaw::Result::FailedToParseQgcPlan, {}};
+    }
+
+    const auto supported_overall_version = 1;
+    const auto maybe_overall_version = overall_version.as_double();
+    if (!maybe_overall_version ||
+        static_cast<int>(maybe_overall_version.value()) != supported_overall_version) {
+        LogErr() << "Overall .plan version not supported, supported: "
+                 << supported_overall_version;
+        return {MissionRaw::Result::FailedToParseQgcPlan, {}};
     }
 
+    if (!has_mission) {
+        LogErr() << "No mission found in .plan.";
+        return {MissionRaw::Result::FailedToParseQgcPlan, {}};
+    }
+
+    auto& mission_items = import_data.mission_items;
+
     // Mark first item as current
     if (mission_items.size() > 0) {
         mission_items[0].current = 1;
@@ -106,116 +443,240 @@ MissionImport::import_mission(const Json::Value& root)
     }
 
     // Returning an empty vector is ok here if there were really no mission items.
-    return {mission_items};
+    return {MissionRaw::Result::Success, import_data};
 }
 
-std::optional<MissionRaw::MissionItem>
-MissionImport::import_simple_mission_item(const Json::Value& json_item)
+bool MissionImport::import_mission(
+    JsonReader& reader, std::vector<MissionRaw::MissionItem>& mission_items)
 {
-    if (json_item["command"].empty() || json_item["autoContinue"].empty() ||
-        json_item["frame"].empty() || json_item["params"].empty()) {
+    JsonReader::Scalar mission_version;
+    bool empty = true;
+
+    const bool parsed = reader.read_object([&](const std::string& key) {
+        empty = false;
+        if (key == "version") {
+            return reader.read_scalar(mission_version);
+        }
+        if (key == "items" && reader.peek_token() == '[') {
+            return reader.read_array([&]() { return import_item(reader, mission_items); });
+        }
+        return reader.skip_value();
+    });
+    if (!parsed) {
+        return false;
+    }
+
+    if (empty) {
+        LogErr() << "No mission found in .plan.";
+        return false;
+    }
+
+    // Check the mission version.
+    const auto supported_mission_version = 2;
+    const auto maybe_mission_version = mission_version.as_double();
+    const int found_version =
+        maybe_mission_version ? static_cast<int>(maybe_mission_version.value()) : 0;
+    if (found_version != supported_mission_version) {
+        LogErr() << "mission version for .plan not supported, found version: " << found_version
+                 << ", supported: " << supported_mission_version;
+        return false;
+    }
+
+    return true;
+}
+
+bool MissionImport::import_item(
+    JsonReader& reader, std::vector<MissionRaw::MissionItem>& mission_items)
+{
+    // Survey items are added as they are read, they are only dropped again if
+    // this turns out not to be a survey after all.
+    const auto num_items_before = mission_items.size();
+
+    ItemFields fields;
+    if (!read_item_fields(reader, fields, &mission_items)) {
+        return false;
+    }
+
+    if (fields.type.is_string("SimpleItem")) {
+        mission_items.resize(num_items_before);
+        MissionRaw::MissionItem item{};
+        if (!to_simple_mission_item(fields, item)) {
+            return false;
+        }
+        mission_items.push_back(item);
+        return true;
+    }
+
+    if (fields.type.is_string("ComplexItem")) {
+        return check_complex_mission_item(fields);
+    }
+
+    LogErr() << "Type " << fields.type.string << " not understood.";
+    return false;
+}
+
+bool MissionImport::read_item_fields(
+    JsonReader& reader, ItemFields& fields, std::vector<MissionRaw::MissionItem>* survey_items)
+{
+    if (reader.peek_token() != '{') {
+        return reader.fail("expected mission item");
+    }
+
+    return reader.read_object([&](const std::string& key) {
+        if (key == "type") {
+            return reader.read_scalar(fields.type);
+        }
+        if (key == "command") {
+            return reader.read_scalar(fields.command);
+        }
+        if (key == "autoContinue") {
+            return reader.read_scalar(fields.auto_continue);
+        }
+        if (key == "frame") {
+            return reader.read_scalar(fields.frame);
+        }
+        if (key == "complexItemType") {
+            return reader.read_scalar(fields.complex_item_type);
+        }
+        if (key == "version") {
+            return reader.read_scalar(fields.version);
+        }
+
+        if (key == "params") {
+            const auto c = reader.peek_token();
+            if (c != '[') {
+                // Anything but null is there, it's just not an array.
+                fields.has_params = (c != 'n');
+                return reader.skip_value();
+            }
+            std::size_t i = 0;
+            const bool parsed = reader.read_array([&]() {
+                return (i < fields.params.size()) ? reader.read_scalar(fields.params[i++]) :
+                                                    reader.skip_value();
+            });
+            fields.has_params = (i > 0);
+            fields.params_is_array = true;
+            return parsed;
+        }
+
+        if (key == "TransectStyleComplexItem" && survey_items != nullptr &&
+            reader.peek_token() == '{') {
+            bool empty = true;
+            const bool parsed = reader.read_object([&](const std::string& transect_key) {
+                empty = false;
+                if (transect_key != "Items" || reader.peek_token() != '[') {
+                    return reader.skip_value();
+                }
+                return reader.read_array([&]() {
+                    fields.has_survey_items = true;
+                    if (reader.peek_token() != '{') {
+                        return reader.skip_value();
+                    }
+                    ItemFields subitem_fields;
+                    if (!read_item_fields(reader, subitem_fields, nullptr)) {
+                        return false;
+                    }
+                    MissionRaw::MissionItem item{};
+                    if (to_simple_mission_item(subitem_fields, item)) {
+                        survey_items->push_back(item);
+                    }
+                    return true;
+                });
+            });
+            fields.has_transect_style_complex_item = !empty;
+            return parsed;
+        }
+
+        return reader.skip_value();
+    });
+}
+
+bool MissionImport::to_simple_mission_item(
+    const ItemFields& fields, MissionRaw::MissionItem& item)
+{
+    if (fields.command.is_null() || fields.auto_continue.is_null() || fields.frame.is_null() ||
+        !fields.has_params) {
         LogErr() << "Missing mission item field.";
-        return std::nullopt;
+        return false;
     }
 
-    if (!json_item["params"].isArray()) {
+    if (!fields.params_is_array) {
         LogErr() << "No param array found.";
-        return std::nullopt;
+        return false;
+    }
+
+    const auto command = fields.command.as_double();
+    const auto auto_continue = fields.auto_continue.as_double();
+    const auto frame = fields.frame.as_double();
+    if (!command || !auto_continue || !frame) {
+        LogErr() << "Invalid mission item field.";
+        return false;
     }
 
-    MissionRaw::MissionItem item{};
-    item.command = json_item["command"].asInt();
-    item.autocontinue = json_item["autoContinue"].asBool() ? 1 : 0;
-    item.frame = json_item["frame"].asInt();
+    item.command = static_cast<uint32_t>(command.value());
+    item.autocontinue = (auto_continue.value() != 0.0) ? 1 : 0;
+    item.frame = static_cast<uint32_t>(frame.value());
     item.mission_type = MAV_MISSION_TYPE_MISSION;
 
-    const auto set_float = [](const Json::Value& val) {
-        return val.isNull() ? NAN : val.asFloat();
+    const auto set_float = [](const JsonReader::Scalar& val) {
+        const auto value = val.as_double();
+        return value ? static_cast<float>(value.value()) : NAN;
     };
 
-    const auto set_int32 = [](const Json::Value& val) {
-        return static_cast<int32_t>(val.isNull() ? 0 : (std::round(val.asDouble() * 1e7)));
+    const auto set_int32 = [](const JsonReader::Scalar& val) {
+        const auto value = val.as_double();
+        return static_cast<int32_t>(value ? std::round(value.value() * 1e7) : 0);
     };
 
-    for (unsigned i = 0; i < 7; ++i) {
-        switch (i) {
-            case 0:
-                item.param1 = set_float(json_item["params"][i]);
-                break;
-            case 1:
-                item.param2 = set_float(json_item["params"][i]);
-                break;
-            case 2:
-                item.param3 = set_float(json_item["params"][i]);
-                break;
-            case 3:
-                item.param4 = set_float(json_item["params"][i]);
-                break;
-            case 4:
-                item.x = set_int32(json_item["params"][i]);
-                break;
-            case 5:
-                item.y = set_int32(json_item["params"][i]);
-                break;
-            case 6:
-                item.z = set_float(json_item["params"][i]);
-                break;
-            default:
-                // should never happen
-                break;
-        }
-    }
+    item.param1 = set_float(fields.params[0]);
+    item.param2 = set_float(fields.params[1]);
+    item.param3 = set_float(fields.params[2]);
+    item.param4 = set_float(fields.params[3]);
+    item.x = set_int32(fields.params[4]);
+    item.y = set_int32(fields.params[5]);
+    item.z = set_float(fields.params[6]);
 
-    return {item};
+    return true;
 }
 
-std::optional<std::vector<MissionRaw::MissionItem>>
-MissionImport::import_complex_mission_items(const Json::Value& json_item)
+bool MissionImport::check_complex_mission_item(const ItemFields& fields)
 {
-    if (json_item["complexItemType"].empty()) {
+    if (fields.complex_item_type.is_null()) {
         LogErr() << "Could not determine complexItemType";
-        return std::nullopt;
+        return false;
     }
 
-    if (json_item["complexItemType"] != "survey") {
-        LogErr() << "complexItemType: " << json_item["complexItemType"] << " not supported";
-        return std::nullopt;
+    if (!fields.complex_item_type.is_string("survey")) {
+        LogErr() << "complexItemType: " << fields.complex_item_type.string << " not supported";
+        return false;
     }
 
-    if (json_item["version"].empty()) {
+    if (fields.version.is_null()) {
         LogErr() << "version of complexItem not found";
-        return std::nullopt;
+        return false;
     }
 
     const int supported_complex_item_version = 5;
-    const int found_version = json_item["version"].asInt();
-    if (found_version != 5) {
+    const auto maybe_version = fields.version.as_double();
+    const int found_version = maybe_version ? static_cast<int>(maybe_version.value()) : 0;
+    if (found_version != supported_complex_item_version) {
         LogErr() << "version of complexItem not supported, found version: " << found_version
                  << ", supported: " << supported_complex_item_version;
-        return std::nullopt;
+        return false;
     }
 
-    if (json_item["TransectStyleComplexItem"].empty()) {
+    if (!fields.has_transect_style_complex_item) {
         LogErr() << "TransectStyleComplexItem not found";
-        return std::nullopt;
+        return false;
     }
 
-    // These are Items (capitalized!) inside the  TransectStyleComplexItem.
-    if (json_item["TransectStyleComplexItem"]["Items"].empty() ||
-        !json_item["TransectStyleComplexItem"]["Items"].isArray()) {
+    // These are Items (capitalized!) inside the TransectStyleComplexItem.
+    if (!fields.has_survey_items) {
         LogErr() << "No survey items found";
-        return std::nullopt;
-    }
-
-    std::vector<MissionRaw::MissionItem> mission_items;
-    for (const auto& json_item_subitem : json_item["TransectStyleComplexItem"]["Items"]) {
-        const auto maybe_item = import_simple_mission_item(json_item_subitem);
-        if (maybe_item.has_value()) {
-            mission_items.push_back(maybe_item.value());
-        }
+        return false;
     }
 
-    return {mission_items};
+    return true;
 }
 
 } // namespace mavsdk
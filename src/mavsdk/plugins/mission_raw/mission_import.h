@@ -1,26 +1,49 @@
 #pragma once
 
 #include "plugins/mission_raw/mission_raw.h"
-#include <optional>
+#include <cstddef>
+#include <istream>
 #include <string>
 #include <utility>
-#include <json/json.h>
+#include <vector>
 
 namespace mavsdk {
 
+class JsonReader;
+
+// Imports QGroundControl .plan files.
+//
+// The plan is parsed as it is read and items are added to the result as soon
+// as they are complete, so no JSON document of the whole plan is ever built
+// and memory use only depends on the number of mission items.
 class MissionImport {
 public:
     static std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
     parse_json(const std::string& raw_json);
 
+    static std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
+    parse_json(const char* data, std::size_t len);
+
+    // size_hint is the expected size of the plan in bytes, used to reserve
+    // space for the items upfront. It can be 0 if unknown.
+    static std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
+    parse_json(std::istream& input, std::size_t size_hint = 0);
+
 private:
-    static bool check_overall_version(const Json::Value& root);
-    static std::optional<std::vector<MissionRaw::MissionItem>>
-    import_mission(const Json::Value& root);
-    static std::optional<MissionRaw::MissionItem>
-    import_simple_mission_item(const Json::Value& json_item);
-    static std::optional<std::vector<MissionRaw::MissionItem>>
-    import_complex_mission_items(const Json::Value& json_item);
+    struct ItemFields;
+
+    static std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
+    parse_plan(std::streambuf& buffer, std::size_t size_hint);
+    static bool
+    import_mission(JsonReader& reader, std::vector<MissionRaw::MissionItem>& mission_items);
+    static bool
+    import_item(JsonReader& reader, std::vector<MissionRaw::MissionItem>& mission_items);
+    static bool read_item_fields(
+        JsonReader& reader,
+        ItemFields& fields,
+        std::vector<MissionRaw::MissionItem>* survey_items);
+    static bool to_simple_mission_item(const ItemFields& fields, MissionRaw::MissionItem& item);
+    static bool check_complex_mission_item(const ItemFields& fields);
 };
 
 } // namespace mavsdk
@@ -396,3 +396,70 @@ TEST(MissionRaw, ImportSamplePlanWithComplexMissionSurveyMissingItems)
     EXPECT_EQ(result_pair.second.geofence_items.size(), 0);
     EXPECT_EQ(result_pair.second.rally_items.size(), 0);
 }
+
+TEST(MissionRaw, ImportSamplePlanFromStreamSameAsFromString)
+{
+    std::ifstream file(path_prefix("qgroundcontrol_sample_with_survey.plan"));
+    ASSERT_TRUE(file);
+
+    std::stringstream buf;
+    buf << file.rdbuf();
+    const auto from_string = MissionImport::parse_json(buf.str());
+    EXPECT_EQ(from_string.first, MissionRaw::Result::Success);
+
+    file.clear();
+    file.seekg(0);
+    const auto from_stream = MissionImport::parse_json(file);
+    EXPECT_EQ(from_stream.first, MissionRaw::Result::Success);
+
+    // NAN params never compare equal, so only compare what we can.
+    ASSERT_EQ(from_stream.second.mission_items.size(), from_string.second.mission_items.size());
+    for (std::size_t i = 0; i < from_stream.second.mission_items.size(); ++i) {
+        const auto& lhs = from_stream.second.mission_items[i];
+        const auto& rhs = from_string.second.mission_items[i];
+        EXPECT_EQ(lhs.seq, rhs.seq);
+        EXPECT_EQ(lhs.command, rhs.command);
+        EXPECT_EQ(lhs.x, rhs.x);
+        EXPECT_EQ(lhs.y, rhs.y);
+    }
+}
+
+TEST(MissionRaw, ImportPlanWithMembersInAnyOrder)
+{
+    const std::string plan = R"({
+        "mission": {
+            "items": [
+                {"type": "SimpleItem", "params": [15, 0, 0, null, 47.3977507, 8.5456075, 50],
+                 "frame": 3, "command": 22, "autoContinue": true, "doJumpId": 1,
+                 "comment": "escaped \"quote\" and é"}
+            ],
+            "version": 2
+        },
+        "version": 1
+    })";
+
+    const auto result_pair = MissionImport::parse_json(plan.data(), plan.size());
+    ASSERT_EQ(result_pair.first, MissionRaw::Result::Success);
+    ASSERT_EQ(result_pair.second.mission_items.size(), 1);
+
+    const auto& item = result_pair.second.mission_items[0];
+    EXPECT_EQ(item.seq, 0);
+    EXPECT_EQ(item.current, 1);
+    EXPECT_EQ(item.command, MAV_CMD_NAV_TAKEOFF);
+    EXPECT_EQ(item.frame, MAV_FRAME_GLOBAL_RELATIVE_ALT);
+    EXPECT_EQ(item.autocontinue, 1);
+    EXPECT_EQ(item.param1, 15.0f);
+    EXPECT_TRUE(std::isnan(item.param4));
+    EXPECT_EQ(item.x, 473977507);
+    EXPECT_EQ(item.y, 85456075);
+    EXPECT_EQ(item.z, 50.0f);
+}
+
+TEST(MissionRaw, ImportBrokenPlan)
+{
+    const std::string plan = R"({"mission": {"items": [{"type": "SimpleItem", "params": [)";
+
+    const auto result_pair = MissionImport::parse_json(plan);
+    EXPECT_EQ(result_pair.first, MissionRaw::Result::FailedToParseQgcPlan);
+    EXPECT_EQ(result_pair.second.mission_items.size(), 0);
+}
@@ -237,4 +237,74 @@ std::ostream& operator<<(std::ostream& str, MissionRaw::Result const& result)
     }
 }
 
+void MissionRaw::upload_mission_diff_async(
+    std::vector<MissionItem> mission_items, const ResultCallback callback)
+{
+    _impl->upload_mission_diff_async(mission_items, callback);
+}
+
+MissionRaw::Result MissionRaw::upload_mission_diff(std::vector<MissionItem> mission_items) const
+{
+    return _impl->upload_mission_diff(mission_items);
+}
+
+std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
+MissionRaw::import_qgroundcontrol_mission_from_string(const std::string& qgc_plan) const
+{
+    return _impl->import_qgroundcontrol_mission_from_string(qgc_plan);
+}
+
+void MissionRaw::upload_mission_stream_async(
+    uint32_t mission_items_count, const ResultCallback callback)
+{
+    _impl->upload_mission_stream_async(mission_items_count, callback);
+}
+
+MissionRaw::Result
+MissionRaw::add_mission_stream_items(std::vector<MissionItem> mission_items) const
+{
+    return _impl->add_mission_stream_items(mission_items);
+}
+
+void MissionRaw::import_qgroundcontrol_mission_async(
+    std::string qgc_plan_path, const ImportQgroundcontrolMissionCallback callback)
+{
+    _impl->import_qgroundcontrol_mission_async(std::move(qgc_plan_path), callback);
+}
+
+void MissionRaw::import_qgroundcontrol_mission_from_string_async(
+    std::string qgc_plan, const ImportQgroundcontrolMissionCallback callback)
+{
+    _impl->import_qgroundcontrol_mission_from_string_async(std::move(qgc_plan), callback);
+}
+
+void MissionRaw::upload_mission_fleet_async(
+    const std::vector<FleetUpload>& uploads,
+    const FleetUploadOptions& options,
+    const FleetUploadProgressCallback& progress_callback,
+    const FleetUploadResultCallback& callback)
+{
+    MissionRawImpl::upload_mission_fleet_async(
+        impls_of(uploads), uploads, options, progress_callback, callback);
+}
+
+std::vector<MissionRaw::FleetUploadResult> MissionRaw::upload_mission_fleet(
+    const std::vector<FleetUpload>& uploads,
+    const FleetUploadOptions& options,
+    const FleetUploadProgressCallback& progress_callback)
+{
+    return MissionRawImpl::upload_mission_fleet(
+        impls_of(uploads), uploads, options, progress_callback);
+}
+
+std::vector<MissionRawImpl*> MissionRaw::impls_of(const std::vector<FleetUpload>& uploads)
+{
+    std::vector<MissionRawImpl*> impls;
+    impls.reserve(uploads.size());
+    for (const auto& upload : uploads) {
+        impls.push_back(upload.mission_raw->_impl.get());
+    }
+    return impls;
+}
+
 } // namespace mavsdk
\ No newline at end of file
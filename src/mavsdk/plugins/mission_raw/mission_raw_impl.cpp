@@ -1,15 +1,22 @@
 #include "mission_raw_impl.h"
 #include "mission_import.h"
+#include "sync_waiter.h"
 #include "system.h"
 
 #include <fstream> // for `std::ifstream`
-#include <sstream> // for `std::stringstream`
 
 namespace mavsdk {
 
 // This is an empty item that can be sent to ArduPilot to mimic clearing of mission.
 constexpr MissionRaw::MissionItem empty_item{0, 3, 16, 1};
 
+// For uploads to a fleet: what of the link budget can go out back to back,
+// how often queued messages are sent, and by how much the progress of all
+// has to go up to be reported again.
+constexpr double fleet_burst_s = 0.1;
+constexpr float fleet_pump_interval_s = 0.01f;
+constexpr float fleet_progress_step = 0.01f;
+
 MissionRawImpl::MissionRawImpl(System& system) : PluginImplBase(system)
 {
     _parent->register_plugin(this);
@@ -52,6 +59,7 @@ void MissionRawImpl::disable()
 
 void MissionRawImpl::deinit()
 {
+    _parent->cancel_background(this);
     _parent->unregister_all_mavlink_message_handlers(this);
 }
 
@@ -142,20 +150,372 @@ void MissionRawImpl::upload_mission_async(
 
     reset_mission_progress();
 
-    const auto int_items = convert_to_int_items(mission_raw);
+    upload_int_items(convert_to_int_items(mission_raw), callback);
+}
+
+void MissionRawImpl::upload_mission_scheduled_async(
+    const std::vector<MissionRaw::MissionItem>& mission_raw,
+    std::shared_ptr<MissionUploadScheduler> scheduler,
+    const MAVLinkMissionTransfer::ProgressCallback& progress_callback,
+    const MissionRaw::ResultCallback& callback)
+{
+    if (_last_upload.lock()) {
+        _parent->call_user_callback([callback]() {
+            if (callback) {
+                callback(MissionRaw::Result::Busy);
+            }
+        });
+        return;
+    }
+
+    reset_mission_progress();
+
+    upload_int_items(
+        convert_to_int_items(mission_raw), callback, progress_callback, std::move(scheduler));
+}
+
+void MissionRawImpl::upload_mission_fleet_async(
+    const std::vector<MissionRawImpl*>& impls,
+    const std::vector<MissionRaw::FleetUpload>& uploads,
+    const MissionRaw::FleetUploadOptions& options,
+    const MissionRaw::FleetUploadProgressCallback& progress_callback,
+    const MissionRaw::FleetUploadResultCallback& callback)
+{
+    if (impls.empty()) {
+        if (callback) {
+            callback({});
+        }
+        return;
+    }
+
+    struct Fleet {
+        std::mutex mutex{};
+        std::vector<MissionRaw::FleetUploadResult> results{};
+        std::vector<float> progress{};
+        std::vector<std::size_t> num_items{};
+        std::size_t total_items{0};
+        std::size_t remaining{0};
+        float last_reported{0.0f};
+        void* pump_cookie{nullptr};
+    };
+
+    auto fleet = std::make_shared<Fleet>();
+    fleet->results.resize(impls.size());
+    fleet->progress.resize(impls.size(), 0.0f);
+    fleet->remaining = impls.size();
+    for (std::size_t i = 0; i < impls.size(); ++i) {
+        fleet->results[i].system_id = impls[i]->_parent->get_system_id();
+        fleet->num_items.push_back(uploads[i].mission_items.size());
+        fleet->total_items += uploads[i].mission_items.size();
+    }
+
+    auto parent = impls.front()->_parent;
+    auto& time = parent->get_time();
+    const auto start = time.steady_time();
+
+    auto scheduler = std::make_shared<MissionUploadScheduler>(
+        MissionUploadScheduler::Config{
+            options.link_budget_bytes_s, fleet_burst_s, options.max_concurrent_uploads},
+        time);
+
+    // Reported whenever all together got another step further, or an upload
+    // is done, instead of with every item of every vehicle.
+    const auto report_progress = [fleet, parent, progress_callback](bool force) {
+        if (!progress_callback) {
+            return;
+        }
+        MissionRaw::FleetUploadProgress progress;
+        {
+            std::lock_guard<std::mutex> lock(fleet->mutex);
+            float done_items = 0.0f;
+            for (std::size_t i = 0; i < fleet->progress.size(); ++i) {
+                done_items += fleet->progress[i] * static_cast<float>(fleet->num_items[i]);
+            }
+            const auto total = fleet->progress.size();
+            progress.uploads_total = static_cast<uint32_t>(total);
+            progress.uploads_done = static_cast<uint32_t>(total - fleet->remaining);
+            progress.progress = fleet->total_items > 0 ?
+                                    done_items / static_cast<float>(fleet->total_items) :
+                                    static_cast<float>(progress.uploads_done) /
+                                        static_cast<float>(progress.uploads_total);
+            if (!force && progress.progress < fleet->last_reported + fleet_progress_step) {
+                return;
+            }
+            fleet->last_reported = progress.progress;
+        }
+        auto temp_callback = progress_callback;
+        parent->call_user_callback([temp_callback, progress]() { temp_callback(progress); });
+    };
+
+    auto finish = [fleet, parent, scheduler, callback, report_progress, &time](
+                      std::size_t index, MissionRaw::Result result, dl_time_t started) {
+        std::vector<MissionRaw::FleetUploadResult> results;
+        bool all_done = false;
+        {
+            std::lock_guard<std::mutex> lock(fleet->mutex);
+            fleet->results[index].result = result;
+            fleet->results[index].duration_s = time.elapsed_since_s(started);
+            fleet->progress[index] = 1.0f;
+            all_done = --fleet->remaining == 0;
+            if (all_done) {
+                results = std::move(fleet->results);
+            }
+        }
+
+        // Frees the slot for the next one waiting.
+        scheduler->upload_done();
+        report_progress(true);
+
+        if (!all_done) {
+            return;
+        }
+        parent->remove_call_every(fleet->pump_cookie);
+
+        if (completes_waiter(callback)) {
+            callback(std::move(results));
+        } else if (callback) {
+            auto temp_callback = callback;
+            parent->call_user_callback(
+                [temp_callback, results = std::move(results)]() { temp_callback(results); });
+        }
+    };
+
+    // Queued messages are sent as the budget allows on every tick.
+    parent->add_call_every(
+        [scheduler]() { scheduler->pump(); }, fleet_pump_interval_s, &fleet->pump_cookie);
+
+    for (std::size_t i = 0; i < impls.size(); ++i) {
+        scheduler->add_upload([fleet,
+                               scheduler,
+                               report_progress,
+                               finish,
+                               i,
+                               start,
+                               &time,
+                               impl = impls[i],
+                               items = uploads[i].mission_items]() {
+            const auto started = time.steady_time();
+            {
+                std::lock_guard<std::mutex> lock(fleet->mutex);
+                fleet->results[i].start_offset_s = time.elapsed_since_s(start);
+            }
+            impl->upload_mission_scheduled_async(
+                items,
+                scheduler,
+                [fleet, report_progress, i](float progress) {
+                    {
+                        std::lock_guard<std::mutex> lock(fleet->mutex);
+                        fleet->progress[i] = progress;
+                    }
+                    report_progress(false);
+                },
+                [finish, i, started](MissionRaw::Result result) { finish(i, result, started); });
+        });
+    }
+}
 
+std::vector<MissionRaw::FleetUploadResult> MissionRawImpl::upload_mission_fleet(
+    const std::vector<MissionRawImpl*>& impls,
+    const std::vector<MissionRaw::FleetUpload>& uploads,
+    const MissionRaw::FleetUploadOptions& options,
+    const MissionRaw::FleetUploadProgressCallback& progress_callback)
+{
+    SyncWaiter<std::vector<MissionRaw::FleetUploadResult>> waiter;
+
+    upload_mission_fleet_async(impls, uploads, options, progress_callback, waiter.completion());
+
+    return waiter.wait();
+}
+
+void MissionRawImpl::upload_int_items(
+    const std::vector<MAVLinkMissionTransfer::ItemInt>& int_items,
+    const MissionRaw::ResultCallback& callback,
+    const MAVLinkMissionTransfer::ProgressCallback& progress_callback,
+    std::shared_ptr<MissionUploadScheduler> scheduler)
+{
     _last_upload = _parent->mission_transfer().upload_items_async(
         MAV_MISSION_TYPE_MISSION,
         int_items,
         [this, callback, int_items](MAVLinkMissionTransfer::Result result) {
+            // A failed upload can leave anything behind.
+            set_vehicle_mission(
+                result == MAVLinkMissionTransfer::Result::Success ?
+                    std::optional<std::vector<MAVLinkMissionTransfer::ItemInt>>{int_items} :
+                    std::nullopt);
+
             auto converted_result = convert_result(result);
-            auto converted_items = convert_items(int_items);
-            _parent->call_user_callback([callback, converted_result, converted_items]() {
+            _parent->call_user_callback([callback, converted_result]() {
                 if (callback) {
                     callback(converted_result);
                 }
             });
+        },
+        progress_callback,
+        std::move(scheduler));
+}
+
+MissionRaw::Result
+MissionRawImpl::upload_mission_diff(std::vector<MissionRaw::MissionItem> mission_items)
+{
+    auto prom = std::promise<MissionRaw::Result>();
+    auto fut = prom.get_future();
+
+    upload_mission_diff_async(
+        mission_items, [&prom](MissionRaw::Result result) { prom.set_value(result); });
+    return fut.get();
+}
+
+void MissionRawImpl::upload_mission_diff_async(
+    const std::vector<MissionRaw::MissionItem>& mission_raw,
+    const MissionRaw::ResultCallback& callback)
+{
+    if (_last_upload.lock()) {
+        _parent->call_user_callback([callback]() {
+            if (callback) {
+                callback(MissionRaw::Result::Busy);
+            }
         });
+        return;
+    }
+
+    reset_mission_progress();
+
+    const auto int_items = convert_to_int_items(mission_raw);
+
+    std::optional<std::vector<MAVLinkMissionTransfer::ItemRange>> ranges;
+    {
+        std::lock_guard<std::mutex> lock(_vehicle_mission.mutex);
+        if (_vehicle_mission.items) {
+            ranges = MAVLinkMissionTransfer::changed_ranges(*_vehicle_mission.items, int_items);
+        }
+    }
+
+    if (!ranges) {
+        upload_int_items(int_items, callback);
+        return;
+    }
+
+    if (ranges->empty()) {
+        _parent->call_user_callback([callback]() {
+            if (callback) {
+                callback(MissionRaw::Result::Success);
+            }
+        });
+        return;
+    }
+
+    upload_int_item_ranges(int_items, *ranges, 0, callback);
+}
+
+void MissionRawImpl::upload_int_item_ranges(
+    const std::vector<MAVLinkMissionTransfer::ItemInt>& int_items,
+    const std::vector<MAVLinkMissionTransfer::ItemRange>& ranges,
+    std::size_t index,
+    const MissionRaw::ResultCallback& callback)
+{
+    _last_upload = _parent->mission_transfer().upload_partial_items_async(
+        MAV_MISSION_TYPE_MISSION,
+        int_items,
+        ranges[index],
+        [this, int_items, ranges, index, callback](MAVLinkMissionTransfer::Result result) {
+            if (result == MAVLinkMissionTransfer::Result::Success &&
+                index + 1 == ranges.size()) {
+                set_vehicle_mission(int_items);
+                _parent->call_user_callback([callback]() {
+                    if (callback) {
+                        callback(MissionRaw::Result::Success);
+                    }
+                });
+                return;
+            }
+
+            // Some ranges might have been written already.
+            set_vehicle_mission(std::nullopt);
+
+            if (result == MAVLinkMissionTransfer::Result::Cancelled ||
+                result == MAVLinkMissionTransfer::Result::ConnectionError) {
+                auto converted_result = convert_result(result);
+                _parent->call_user_callback([callback, converted_result]() {
+                    if (callback) {
+                        callback(converted_result);
+                    }
+                });
+                return;
+            }
+
+            if (result != MAVLinkMissionTransfer::Result::Success) {
+                LogWarn() << "Partial mission upload failed (" << static_cast<int>(result)
+                          << "), uploading whole mission";
+            }
+
+            // We are called from within the mission transfer, so the next
+            // upload is queued from the callback thread instead.
+            _parent->call_user_callback([this, int_items, ranges, index, callback, result]() {
+                if (result == MAVLinkMissionTransfer::Result::Success) {
+                    upload_int_item_ranges(int_items, ranges, index + 1, callback);
+                } else {
+                    upload_int_items(int_items, callback);
+                }
+            });
+        });
+}
+
+void MissionRawImpl::upload_mission_stream_async(
+    uint32_t mission_items_count, const MissionRaw::ResultCallback& callback)
+{
+    if (_last_upload.lock()) {
+        _parent->call_user_callback([callback]() {
+            if (callback) {
+                callback(MissionRaw::Result::Busy);
+            }
+        });
+        return;
+    }
+
+    reset_mission_progress();
+    {
+        std::lock_guard<std::mutex> lock(_mission_progress.mutex);
+        _mission_progress.last.total = mission_items_count;
+    }
+
+    _stream_upload = _parent->mission_transfer().upload_streamed_items_async(
+        MAV_MISSION_TYPE_MISSION,
+        mission_items_count,
+        [this, callback](MAVLinkMissionTransfer::Result result) {
+            // The items are not kept, so the next diff upload sends everything.
+            set_vehicle_mission(std::nullopt);
+
+            auto converted_result = convert_result(result);
+            _parent->call_user_callback([callback, converted_result]() {
+                if (callback) {
+                    callback(converted_result);
+                }
+            });
+        });
+    _last_upload = _stream_upload.lock();
+}
+
+MissionRaw::Result
+MissionRawImpl::add_mission_stream_items(const std::vector<MissionRaw::MissionItem>& mission_items)
+{
+    auto ptr = _stream_upload.lock();
+    if (!ptr) {
+        return MissionRaw::Result::Error;
+    }
+    // Not convert_to_int_items, the total is known from the start.
+    std::vector<MAVLinkMissionTransfer::ItemInt> int_items;
+    int_items.reserve(mission_items.size());
+    for (const auto& item : mission_items) {
+        int_items.push_back(convert_mission_raw(item));
+    }
+    return convert_result(ptr->add_items(int_items));
+}
+
+void MissionRawImpl::set_vehicle_mission(
+    std::optional<std::vector<MAVLinkMissionTransfer::ItemInt>> items)
+{
+    std::lock_guard<std::mutex> lock(_vehicle_mission.mutex);
+    _vehicle_mission.items = std::move(items);
 }
 
 MissionRaw::Result MissionRawImpl::cancel_mission_upload()
@@ -199,6 +559,9 @@ void MissionRawImpl::download_mission_async(const MissionRaw::DownloadMissionCal
         [this, callback](
             MAVLinkMissionTransfer::Result result,
             std::vector<MAVLinkMissionTransfer::ItemInt> items) {
+            if (result == MAVLinkMissionTransfer::Result::Success) {
+                set_vehicle_mission(items);
+            }
             auto converted_result = convert_result(result);
             auto converted_items = convert_items(items);
             _parent->call_user_callback([callback, converted_result, converted_items]() {
@@ -376,6 +739,7 @@ MissionRaw::Result MissionRawImpl::clear_mission()
 void MissionRawImpl::clear_mission_async(const MissionRaw::ResultCallback& callback)
 {
     reset_mission_progress();
+    set_vehicle_mission(std::nullopt);
 
     // For ArduPilot to clear a mission we need to upload an empty mission.
     if (_parent->autopilot() == SystemImpl::Autopilot::ArduPilot) {
@@ -475,17 +839,55 @@ void MissionRawImpl::subscribe_mission_changed(MissionRaw::MissionChangedCallbac
 std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
 MissionRawImpl::import_qgroundcontrol_mission(std::string qgc_plan_path)
 {
-    std::ifstream file(qgc_plan_path);
+    std::ifstream file(qgc_plan_path, std::ios::binary | std::ios::ate);
     if (!file) {
         return std::make_pair<MissionRaw::Result, MissionRaw::MissionImportData>(
             MissionRaw::Result::FailedToOpenQgcPlan, {});
     }
 
-    std::stringstream buf;
-    buf << file.rdbuf();
-    file.close();
+    // The plan is parsed while it is read, the size only helps to allocate.
+    const auto size = file.tellg();
+    file.seekg(0);
+
+    return MissionImport::parse_json(file, size > 0 ? static_cast<std::size_t>(size) : 0);
+}
+
+std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
+MissionRawImpl::import_qgroundcontrol_mission_from_string(const std::string& qgc_plan)
+{
+    return MissionImport::parse_json(qgc_plan);
+}
+
+void MissionRawImpl::import_qgroundcontrol_mission_async(
+    std::string qgc_plan_path, const MissionRaw::ImportQgroundcontrolMissionCallback& callback)
+{
+    _parent->run_in_background(
+        [this, qgc_plan_path = std::move(qgc_plan_path), callback]() {
+            auto result = import_qgroundcontrol_mission(qgc_plan_path);
+            return deliver_import_result(std::move(result), callback);
+        },
+        this);
+}
 
-    return MissionImport::parse_json(buf.str());
+void MissionRawImpl::import_qgroundcontrol_mission_from_string_async(
+    std::string qgc_plan, const MissionRaw::ImportQgroundcontrolMissionCallback& callback)
+{
+    _parent->run_in_background(
+        [this, qgc_plan = std::move(qgc_plan), callback]() {
+            auto result = import_qgroundcontrol_mission_from_string(qgc_plan);
+            return deliver_import_result(std::move(result), callback);
+        },
+        this);
+}
+
+BackgroundWork::Completion MissionRawImpl::deliver_import_result(
+    std::pair<MissionRaw::Result, MissionRaw::MissionImportData> result,
+    const MissionRaw::ImportQgroundcontrolMissionCallback& callback)
+{
+    if (!callback) {
+        return {};
+    }
+    return [callback, result = std::move(result)]() { callback(result.first, result.second); };
 }
 
 MissionRaw::Result MissionRawImpl::convert_result(MAVLinkMissionTransfer::Result result)
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <mutex>
+#include <optional>
 
 #include "mavlink_include.h"
+#include "mission_upload_scheduler.h"
 #include "plugins/mission_raw/mission_raw.h"
 #include "plugin_impl_base.h"
 #include "system.h"
@@ -31,6 +33,30 @@ public:
         const MissionRaw::ResultCallback& callback);
     MissionRaw::Result cancel_mission_upload();
 
+    MissionRaw::Result upload_mission_diff(std::vector<MissionRaw::MissionItem> mission_items);
+    void upload_mission_diff_async(
+        const std::vector<MissionRaw::MissionItem>& mission_raw,
+        const MissionRaw::ResultCallback& callback);
+
+    void upload_mission_stream_async(
+        uint32_t mission_items_count, const MissionRaw::ResultCallback& callback);
+    MissionRaw::Result
+    add_mission_stream_items(const std::vector<MissionRaw::MissionItem>& mission_items);
+
+    // Uploads to several vehicles within a link budget shared by all of them,
+    // see MissionRaw::upload_mission_fleet_async().
+    static void upload_mission_fleet_async(
+        const std::vector<MissionRawImpl*>& impls,
+        const std::vector<MissionRaw::FleetUpload>& uploads,
+        const MissionRaw::FleetUploadOptions& options,
+        const MissionRaw::FleetUploadProgressCallback& progress_callback,
+        const MissionRaw::FleetUploadResultCallback& callback);
+    static std::vector<MissionRaw::FleetUploadResult> upload_mission_fleet(
+        const std::vector<MissionRawImpl*>& impls,
+        const std::vector<MissionRaw::FleetUpload>& uploads,
+        const MissionRaw::FleetUploadOptions& options,
+        const MissionRaw::FleetUploadProgressCallback& progress_callback);
+
     void subscribe_mission_changed(MissionRaw::MissionChangedCallback callback);
 
     MissionRaw::Result start_mission();
@@ -52,13 +78,17 @@ public:
     std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
     import_qgroundcontrol_mission(std::string qgc_plan_path);
 
-#if 0
+    std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
+    import_qgroundcontrol_mission_from_string(const std::string& qgc_plan);
+
+    // Parsed on the background pool, the callback is called with the user
+    // callbacks.
     void import_qgroundcontrol_mission_async(
-        std::string qgc_plan_path, const MissionRaw::ImportQgroundcontrolMissionCallback callback);
+        std::string qgc_plan_path,
+        const MissionRaw::ImportQgroundcontrolMissionCallback& callback);
 
-    static std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
-    import_qgroundcontrol_mission(const std::string& qgc_plan_path);
-#endif
+    void import_qgroundcontrol_mission_from_string_async(
+        std::string qgc_plan, const MissionRaw::ImportQgroundcontrolMissionCallback& callback);
 
     MissionRawImpl(const MissionRawImpl&) = delete;
     const MissionRawImpl& operator=(const MissionRawImpl&) = delete;
@@ -66,6 +96,23 @@ public:
 private:
     void reset_mission_progress();
 
+    void upload_int_items(
+        const std::vector<MAVLinkMissionTransfer::ItemInt>& int_items,
+        const MissionRaw::ResultCallback& callback,
+        const MAVLinkMissionTransfer::ProgressCallback& progress_callback = nullptr,
+        std::shared_ptr<MissionUploadScheduler> scheduler = nullptr);
+    void upload_mission_scheduled_async(
+        const std::vector<MissionRaw::MissionItem>& mission_raw,
+        std::shared_ptr<MissionUploadScheduler> scheduler,
+        const MAVLinkMissionTransfer::ProgressCallback& progress_callback,
+        const MissionRaw::ResultCallback& callback);
+    void upload_int_item_ranges(
+        const std::vector<MAVLinkMissionTransfer::ItemInt>& int_items,
+        const std::vector<MAVLinkMissionTransfer::ItemRange>& ranges,
+        std::size_t index,
+        const MissionRaw::ResultCallback& callback);
+    void set_vehicle_mission(std::optional<std::vector<MAVLinkMissionTransfer::ItemInt>> items);
+
     void process_mission_ack(const mavlink_message_t& message);
     void process_mission_current(const mavlink_message_t& message);
     void process_mission_item_reached(const mavlink_message_t& message);
@@ -83,6 +130,10 @@ private:
     convert_mission_raw(const MissionRaw::MissionItem transfer_mission_raw);
 
     static MissionRaw::Result convert_result(MAVLinkMissionTransfer::Result result);
+
+    static BackgroundWork::Completion deliver_import_result(
+        std::pair<MissionRaw::Result, MissionRaw::MissionImportData> result,
+        const MissionRaw::ImportQgroundcontrolMissionCallback& callback);
     MissionRaw::MissionItem static convert_item(
         const MAVLinkMissionTransfer::ItemInt& transfer_item);
     std::vector<MissionRaw::MissionItem>
@@ -91,6 +142,7 @@ private:
     // TODO: check if these need a mutex as well.
     std::weak_ptr<MAVLinkMissionTransfer::WorkItem> _last_upload{};
     std::weak_ptr<MAVLinkMissionTransfer::WorkItem> _last_download{};
+    std::weak_ptr<MAVLinkMissionTransfer::UploadWorkItem> _stream_upload{};
 
     struct {
         std::mutex mutex{};
@@ -104,6 +156,12 @@ private:
         std::mutex mutex{};
         MissionRaw::MissionChangedCallback callback{nullptr};
     } _mission_changed{};
+
+    // What we last know to be on the vehicle, to only upload what changed.
+    struct {
+        std::mutex mutex{};
+        std::optional<std::vector<MAVLinkMissionTransfer::ItemInt>> items{};
+    } _vehicle_mission{};
 };
 
 } // namespace mavsdk
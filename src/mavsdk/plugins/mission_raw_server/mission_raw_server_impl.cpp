@@ -130,20 +130,6 @@ void MissionRawServerImpl::init()
 {
     _parent->add_capabilities(MAV_PROTOCOL_CAPABILITY_MISSION_INT);
 
-    _thread_mission = std::thread([this] {
-        while (!_stop_work_thread) {
-            std::unique_lock<std::mutex> lock(_work_mutex);
-            if (!_work_queue.empty()) {
-                auto task = _work_queue.front();
-                _work_queue.pop();
-                lock.unlock();
-                task();
-            } else {
-                _wait_for_new_task.wait(lock);
-            }
-        }
-    });
-
     // Handle Initiate Upload
     _parent->register_mavlink_message_handler(
         MAVLINK_MSG_ID_MISSION_COUNT,
@@ -157,39 +143,45 @@ void MissionRawServerImpl::init()
             _mission_count = count.count;
 
             // We need to queue this on a different thread or it will deadlock
-            add_task([this]() {
-                // Mission Upload Inbound
-                if (_last_download.lock()) {
-                    _parent->call_user_callback([this]() {
-                        if (_incoming_mission_callback) {
-                            MissionRawServer::MissionPlan mission_plan{};
-                            _incoming_mission_callback(
-                                MissionRawServer::Result::Busy, mission_plan);
-                        }
-                    });
-                    return;
-                }
-
-                _last_download = _parent->mission_transfer().receive_incoming_items_async(
-                    MAV_MISSION_TYPE_MISSION,
-                    _mission_count,
-                    _target_component,
-                    [this](
-                        MAVLinkMissionTransfer::Result result,
-                        std::vector<MAVLinkMissionTransfer::ItemInt> items) {
-                        _current_mission = items;
-                        auto converted_result = convert_result(result);
-                        auto converted_items = convert_items(items);
-                        _parent->call_user_callback([this, converted_result, converted_items]() {
+            _parent->queue_work(
+                [this]() {
+                    // Mission Upload Inbound
+                    if (_last_download.lock()) {
+                        _parent->call_user_callback([this]() {
                             if (_incoming_mission_callback) {
-                                _incoming_mission_callback(converted_result, {converted_items});
+                                MissionRawServer::MissionPlan mission_plan{};
+                                _incoming_mission_callback(
+                                    MissionRawServer::Result::Busy, mission_plan);
                             }
+                        });
+                        return;
+                    }
 
-                            _mission_completed = false;
-                            set_current_seq(0);
+                    _last_download = _parent->mission_transfer().receive_incoming_items_async(
+                        MAV_MISSION_TYPE_MISSION,
+                        _mission_count,
+                        _target_component,
+                        [this](
+                            MAVLinkMissionTransfer::Result result,
+                            std::vector<MAVLinkMissionTransfer::ItemInt> items) {
+                            auto converted_result = convert_result(result);
+                            MissionRawServer::MissionPlan mission_plan{convert_items(items)};
+                            _current_mission = std::move(items);
+                            _parent->call_user_callback(
+                                [this,
+                                 converted_result,
+                                 mission_plan = std::move(mission_plan)]() mutable {
+                                    if (_incoming_mission_callback) {
+                                        _incoming_mission_callback(
+                                            converted_result, std::move(mission_plan));
+                                    }
+
+                                    _mission_completed = false;
+                                    set_current_seq(0);
+                                });
                         });
-                    });
-            });
+                },
+                this);
         },
         this);
 
@@ -264,9 +256,8 @@ void MissionRawServerImpl::init()
 
 void MissionRawServerImpl::deinit()
 {
-    _stop_work_thread = true;
-    _wait_for_new_task.notify_all();
-    _thread_mission.join();
+    _parent->unregister_all_mavlink_message_handlers(this);
+    _parent->cancel_work(this);
 }
 
 void MissionRawServerImpl::enable() {}
@@ -13,6 +13,7 @@
 #include <utility>
 #include <vector>
 
+#include "mavsdk/inline_vector.h"
 #include "mavsdk/plugin_base.h"
 
 namespace mavsdk {
@@ -160,7 +161,7 @@ public:
      * Needs to be 21 entries or 1 entry with NaN if unknown.
      */
     struct Covariance {
-        std::vector<float> covariance_matrix{}; /**< @brief The covariance matrix */
+        InlineVector<float, 21> covariance_matrix{}; /**< @brief The covariance matrix */
     };
 
     /**
@@ -331,6 +332,27 @@ public:
      */
     friend std::ostream& operator<<(std::ostream& str, Mocap::Result const& result);
 
+    /**
+     * @brief Summary of a latency histogram.
+     *
+     * Percentiles are accurate to about 12.5%.
+     */
+    struct LatencyStats {
+        uint64_t count{0}; /**< @brief Number of samples recorded. */
+        uint64_t p50_ns{0}; /**< @brief Median in nanoseconds. */
+        uint64_t p99_ns{0}; /**< @brief 99th percentile in nanoseconds. */
+        uint64_t max_ns{0}; /**< @brief Maximum in nanoseconds. */
+    };
+
+    /**
+     * @brief Statistics of the mocap messages sent.
+     */
+    struct SendStats {
+        LatencyStats send{}; /**< @brief From calling a set function until it is sent. */
+        LatencyStats sample_age{}; /**< @brief From the time_usec of a sample until it is sent. */
+        uint64_t failed{0}; /**< @brief Number of messages which could not be sent. */
+    };
+
     /**
      * @brief Callback type for asynchronous Mocap calls.
      */
@@ -363,6 +385,21 @@ public:
      */
     Result set_odometry(Odometry odometry) const;
 
+    /**
+     * @brief Get statistics of the mocap messages sent.
+     *
+     * The sample age is only recorded for samples with time_usec set, and
+     * requires the clock of the mocap system to be in sync with this one.
+     *
+     * @return Current statistics.
+     */
+    SendStats send_stats() const;
+
+    /**
+     * @brief Reset the statistics of the mocap messages sent.
+     */
+    void reset_send_stats() const;
+
     /**
      * @brief Copy constructor.
      */
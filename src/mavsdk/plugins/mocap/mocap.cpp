@@ -256,4 +256,14 @@ std::ostream& operator<<(std::ostream& str, Mocap::Result const& result)
     }
 }
 
+Mocap::SendStats Mocap::send_stats() const
+{
+    return _impl->send_stats();
+}
+
+void Mocap::reset_send_stats() const
+{
+    _impl->reset_send_stats();
+}
+
 } // namespace mavsdk
\ No newline at end of file
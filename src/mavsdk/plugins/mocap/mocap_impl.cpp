@@ -1,8 +1,10 @@
 #include "mocap_impl.h"
 #include "system.h"
 #include "px4_custom_mode.h"
-#include <array>
+#include <algorithm>
+#include <cmath>
 #include <ctime>
+#include <iterator>
 
 namespace mavsdk {
 
@@ -16,11 +18,13 @@ void MocapImpl::disable() {}
 
 MocapImpl::MocapImpl(System& system) : PluginImplBase(system)
 {
+    fill_templates();
     _parent->register_plugin(this);
 }
 
 MocapImpl::MocapImpl(std::shared_ptr<System> system) : PluginImplBase(std::move(system))
 {
+    fill_templates();
     _parent->register_plugin(this);
 }
 
@@ -58,185 +62,180 @@ Mocap::Result MocapImpl::set_odometry(const Mocap::Odometry& odometry)
     return send_odometry(odometry);
 }
 
+uint64_t MocapImpl::autopilot_time_usec(uint64_t time_usec)
+{
+    const auto autopilot_time =
+        (time_usec == 0) ?
+            _parent->get_autopilot_time().now() :
+            _parent->get_autopilot_time().time_in(
+                dl_system_time_t(std::chrono::microseconds(time_usec)));
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(autopilot_time.time_since_epoch())
+        .count();
+}
+
+bool MocapImpl::copy_covariance(const Mocap::Covariance& covariance, float (&out)[21])
+{
+    // The covariance matrix needs to have length 21 or 1 with the one entry set to NaN.
+
+    if (covariance.covariance_matrix.size() == 21) {
+        std::copy(covariance.covariance_matrix.begin(), covariance.covariance_matrix.end(), out);
+        return true;
+    }
+
+    if (covariance.covariance_matrix.size() == 1 && std::isnan(covariance.covariance_matrix[0])) {
+        std::fill(std::begin(out), std::end(out), 0.0f);
+        out[0] = NAN;
+        return true;
+    }
+
+    return false;
+}
+
+void MocapImpl::fill_templates()
+{
+    // Only the fields below never change, everything else is updated in place.
+    _lane.vision_position_estimate.reset_counter = 0; // FIXME: reset_counter not set
+
+    _lane.odometry.child_frame_id = static_cast<uint8_t>(MAV_FRAME_BODY_FRD);
+    _lane.odometry.reset_counter = 0;
+    _lane.odometry.estimator_type = MAV_ESTIMATOR_TYPE_MOCAP;
+}
+
+// Assumes to have the lock for _lane.mutex.
+Mocap::Result MocapImpl::send_lane_message(uint64_t start_ns, uint64_t sample_time_usec)
+{
+    const bool sent = _parent->send_message(_lane.message);
+
+    const uint64_t done_ns = MessageLatency::now_ns();
+    _lane.send.record(done_ns - start_ns);
+
+    if (sample_time_usec != 0) {
+        const auto now_usec = std::chrono::duration_cast<std::chrono::microseconds>(
+                                  _time.system_time().time_since_epoch())
+                                  .count();
+        // Clocks of a mocap system are not always in sync, ignore samples from the future.
+        if (static_cast<uint64_t>(now_usec) >= sample_time_usec) {
+            _lane.sample_age.record((static_cast<uint64_t>(now_usec) - sample_time_usec) * 1000);
+        }
+    }
+
+    if (!sent) {
+        ++_lane.failed;
+        return Mocap::Result::ConnectionError;
+    }
+    return Mocap::Result::Success;
+}
+
 Mocap::Result MocapImpl::send_vision_position_estimate(
     const Mocap::VisionPositionEstimate& vision_position_estimate)
 {
-    const uint64_t autopilot_time_usec =
-        (!vision_position_estimate.time_usec) ?
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                _parent->get_autopilot_time().now().time_since_epoch())
-                .count() :
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                _parent->get_autopilot_time()
-                    .time_in(dl_system_time_t(
-                        std::chrono::microseconds(vision_position_estimate.time_usec)))
-                    .time_since_epoch())
-                .count();
-
-    std::array<float, 21> covariance{};
+    const uint64_t start_ns = MessageLatency::now_ns();
 
-    // The covariance matrix needs to have length 21 or 1 with the one entry set to NaN.
+    std::lock_guard<std::mutex> lock(_lane.mutex);
+    auto& estimate = _lane.vision_position_estimate;
 
-    if (vision_position_estimate.pose_covariance.covariance_matrix.size() == 21) {
-        std::copy(
-            vision_position_estimate.pose_covariance.covariance_matrix.begin(),
-            vision_position_estimate.pose_covariance.covariance_matrix.end(),
-            covariance.begin());
-    } else if (
-        vision_position_estimate.pose_covariance.covariance_matrix.size() == 1 &&
-        std::isnan(vision_position_estimate.pose_covariance.covariance_matrix[0])) {
-        covariance[0] = NAN;
-    } else {
+    if (!copy_covariance(vision_position_estimate.pose_covariance, estimate.covariance)) {
         return Mocap::Result::InvalidRequestData;
     }
 
-    mavlink_message_t message;
-    mavlink_msg_vision_position_estimate_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &message,
-        autopilot_time_usec,
-        vision_position_estimate.position_body.x_m,
-        vision_position_estimate.position_body.y_m,
-        vision_position_estimate.position_body.z_m,
-        vision_position_estimate.angle_body.roll_rad,
-        vision_position_estimate.angle_body.pitch_rad,
-        vision_position_estimate.angle_body.yaw_rad,
-        covariance.data(),
-        0); // FIXME: reset_counter not set
-
-    return _parent->send_message(message) ? Mocap::Result::Success : Mocap::Result::ConnectionError;
+    estimate.usec = autopilot_time_usec(vision_position_estimate.time_usec);
+    estimate.x = vision_position_estimate.position_body.x_m;
+    estimate.y = vision_position_estimate.position_body.y_m;
+    estimate.z = vision_position_estimate.position_body.z_m;
+    estimate.roll = vision_position_estimate.angle_body.roll_rad;
+    estimate.pitch = vision_position_estimate.angle_body.pitch_rad;
+    estimate.yaw = vision_position_estimate.angle_body.yaw_rad;
+
+    mavlink_msg_vision_position_estimate_encode(
+        _parent->get_own_system_id(), _parent->get_own_component_id(), &_lane.message, &estimate);
+
+    return send_lane_message(start_ns, vision_position_estimate.time_usec);
 }
 
 Mocap::Result
 MocapImpl::send_attitude_position_mocap(const Mocap::AttitudePositionMocap& attitude_position_mocap)
 {
-    const uint64_t autopilot_time_usec =
-        (!attitude_position_mocap.time_usec) ?
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                _parent->get_autopilot_time().now().time_since_epoch())
-                .count() :
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                _parent->get_autopilot_time()
-                    .time_in(dl_system_time_t(
-                        std::chrono::microseconds(attitude_position_mocap.time_usec)))
-                    .time_since_epoch())
-                .count();
-
-    mavlink_message_t message;
-
-    std::array<float, 4> q{};
-    q[0] = attitude_position_mocap.q.w;
-    q[1] = attitude_position_mocap.q.x;
-    q[2] = attitude_position_mocap.q.y;
-    q[3] = attitude_position_mocap.q.z;
-
-    std::array<float, 21> covariance{};
+    const uint64_t start_ns = MessageLatency::now_ns();
 
-    // The covariance matrix needs to have length 21 or 1 with the one entry set to NaN.
+    std::lock_guard<std::mutex> lock(_lane.mutex);
+    auto& mocap = _lane.att_pos_mocap;
 
-    if (attitude_position_mocap.pose_covariance.covariance_matrix.size() == 21) {
-        std::copy(
-            attitude_position_mocap.pose_covariance.covariance_matrix.begin(),
-            attitude_position_mocap.pose_covariance.covariance_matrix.end(),
-            covariance.begin());
-    } else if (
-        attitude_position_mocap.pose_covariance.covariance_matrix.size() == 1 &&
-        std::isnan(attitude_position_mocap.pose_covariance.covariance_matrix[0])) {
-        covariance[0] = NAN;
-    } else {
+    if (!copy_covariance(attitude_position_mocap.pose_covariance, mocap.covariance)) {
         return Mocap::Result::InvalidRequestData;
     }
 
-    mavlink_msg_att_pos_mocap_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &message,
-        autopilot_time_usec,
-        q.data(),
-        attitude_position_mocap.position_body.x_m,
-        attitude_position_mocap.position_body.y_m,
-        attitude_position_mocap.position_body.z_m,
-        covariance.data());
-
-    return _parent->send_message(message) ? Mocap::Result::Success : Mocap::Result::ConnectionError;
+    mocap.time_usec = autopilot_time_usec(attitude_position_mocap.time_usec);
+    mocap.q[0] = attitude_position_mocap.q.w;
+    mocap.q[1] = attitude_position_mocap.q.x;
+    mocap.q[2] = attitude_position_mocap.q.y;
+    mocap.q[3] = attitude_position_mocap.q.z;
+    mocap.x = attitude_position_mocap.position_body.x_m;
+    mocap.y = attitude_position_mocap.position_body.y_m;
+    mocap.z = attitude_position_mocap.position_body.z_m;
+
+    mavlink_msg_att_pos_mocap_encode(
+        _parent->get_own_system_id(), _parent->get_own_component_id(), &_lane.message, &mocap);
+
+    return send_lane_message(start_ns, attitude_position_mocap.time_usec);
 }
 
 Mocap::Result MocapImpl::send_odometry(const Mocap::Odometry& odometry)
 {
-    const uint64_t autopilot_time_usec =
-        (!odometry.time_usec) ?
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                _parent->get_autopilot_time().now().time_since_epoch())
-                .count() :
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                _parent->get_autopilot_time()
-                    .time_in(dl_system_time_t(std::chrono::microseconds(odometry.time_usec)))
-                    .time_since_epoch())
-                .count();
-
-    mavlink_message_t message;
-
-    std::array<float, 4> q{};
-    q[0] = odometry.q.w;
-    q[1] = odometry.q.x;
-    q[2] = odometry.q.y;
-    q[3] = odometry.q.z;
-
-    std::array<float, 21> pose_covariance{};
-    std::array<float, 21> velocity_covariance{};
+    const uint64_t start_ns = MessageLatency::now_ns();
 
-    // The covariance matrix needs to have length 21 or 1 with the one entry set to NaN.
+    std::lock_guard<std::mutex> lock(_lane.mutex);
+    auto& message = _lane.odometry;
 
-    if (odometry.pose_covariance.covariance_matrix.size() == 21) {
-        std::copy(
-            odometry.pose_covariance.covariance_matrix.begin(),
-            odometry.pose_covariance.covariance_matrix.end(),
-            pose_covariance.begin());
-    } else if (
-        odometry.pose_covariance.covariance_matrix.size() == 1 &&
-        std::isnan(odometry.pose_covariance.covariance_matrix[0])) {
-        pose_covariance[0] = NAN;
-    } else {
+    if (!copy_covariance(odometry.pose_covariance, message.pose_covariance) ||
+        !copy_covariance(odometry.velocity_covariance, message.velocity_covariance)) {
         return Mocap::Result::InvalidRequestData;
     }
 
-    if (odometry.velocity_covariance.covariance_matrix.size() == 21) {
-        std::copy(
-            odometry.velocity_covariance.covariance_matrix.begin(),
-            odometry.velocity_covariance.covariance_matrix.end(),
-            velocity_covariance.begin());
-    } else if (
-        odometry.velocity_covariance.covariance_matrix.size() == 1 &&
-        std::isnan(odometry.velocity_covariance.covariance_matrix[0])) {
-        velocity_covariance[0] = NAN;
-    } else {
-        return Mocap::Result::InvalidRequestData;
-    }
+    message.time_usec = autopilot_time_usec(odometry.time_usec);
+    message.frame_id = static_cast<uint8_t>(odometry.frame_id);
+    message.x = odometry.position_body.x_m;
+    message.y = odometry.position_body.y_m;
+    message.z = odometry.position_body.z_m;
+    message.q[0] = odometry.q.w;
+    message.q[1] = odometry.q.x;
+    message.q[2] = odometry.q.y;
+    message.q[3] = odometry.q.z;
+    message.vx = odometry.speed_body.x_m_s;
+    message.vy = odometry.speed_body.y_m_s;
+    message.vz = odometry.speed_body.z_m_s;
+    message.rollspeed = odometry.angular_velocity_body.roll_rad_s;
+    message.pitchspeed = odometry.angular_velocity_body.pitch_rad_s;
+    message.yawspeed = odometry.angular_velocity_body.yaw_rad_s;
+
+    mavlink_msg_odometry_encode(
+        _parent->get_own_system_id(), _parent->get_own_component_id(), &_lane.message, &message);
+
+    return send_lane_message(start_ns, odometry.time_usec);
+}
 
-    mavlink_msg_odometry_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &message,
-        autopilot_time_usec,
-        static_cast<uint8_t>(odometry.frame_id),
-        static_cast<uint8_t>(MAV_FRAME_BODY_FRD),
-        odometry.position_body.x_m,
-        odometry.position_body.y_m,
-        odometry.position_body.z_m,
-        q.data(),
-        odometry.speed_body.x_m_s,
-        odometry.speed_body.y_m_s,
-        odometry.speed_body.z_m_s,
-        odometry.angular_velocity_body.roll_rad_s,
-        odometry.angular_velocity_body.pitch_rad_s,
-        odometry.angular_velocity_body.yaw_rad_s,
-        pose_covariance.data(),
-        velocity_covariance.data(),
-        0,
-        MAV_ESTIMATOR_TYPE_MOCAP);
-
-    return _parent->send_message(message) ? Mocap::Result::Success : Mocap::Result::ConnectionError;
+Mocap::SendStats MocapImpl::send_stats() const
+{
+    std::lock_guard<std::mutex> lock(_lane.mutex);
+
+    const auto convert = [](const LatencyHistogram& histogram) {
+        const auto stats = histogram.stats();
+        return Mocap::LatencyStats{stats.count, stats.p50_ns, stats.p99_ns, stats.max_ns};
+    };
+
+    Mocap::SendStats stats{};
+    stats.send = convert(_lane.send);
+    stats.sample_age = convert(_lane.sample_age);
+    stats.failed = _lane.failed;
+    return stats;
+}
+
+void MocapImpl::reset_send_stats()
+{
+    std::lock_guard<std::mutex> lock(_lane.mutex);
+    _lane.send = {};
+    _lane.sample_age = {};
+    _lane.failed = 0;
 }
 
 } // namespace mavsdk
@@ -2,8 +2,11 @@
 
 #include "plugins/mocap/mocap.h"
 #include "mavlink_include.h"
+#include "mavsdk_time.h"
+#include "message_latency.h"
 #include "plugin_impl_base.h"
 #include "system.h"
+#include <mutex>
 
 namespace mavsdk {
 
@@ -27,6 +30,9 @@ public:
     set_attitude_position_mocap(const Mocap::AttitudePositionMocap& attitude_position_mocap);
     Mocap::Result set_odometry(const Mocap::Odometry& odometry);
 
+    Mocap::SendStats send_stats() const;
+    void reset_send_stats();
+
     MocapImpl(const MocapImpl&) = delete;
     MocapImpl& operator=(const MocapImpl&) = delete;
 
@@ -36,5 +42,25 @@ private:
     Mocap::Result
     send_attitude_position_mocap(const Mocap::AttitudePositionMocap& attitude_position_mocap);
     Mocap::Result send_odometry(const Mocap::Odometry& odometry);
+
+    uint64_t autopilot_time_usec(uint64_t time_usec);
+    static bool copy_covariance(const Mocap::Covariance& covariance, float (&out)[21]);
+    void fill_templates();
+    Mocap::Result send_lane_message(uint64_t start_ns, uint64_t sample_time_usec);
+
+    // Mocap samples come at hundreds of Hz, so the messages are kept around
+    // and only the fields which change are written for every sample.
+    struct {
+        mutable std::mutex mutex{};
+        mavlink_vision_position_estimate_t vision_position_estimate{};
+        mavlink_att_pos_mocap_t att_pos_mocap{};
+        mavlink_odometry_t odometry{};
+        mavlink_message_t message{};
+        LatencyHistogram send{};
+        LatencyHistogram sample_age{};
+        uint64_t failed{0};
+    } _lane{};
+
+    Time _time{};
 };
 } // namespace mavsdk
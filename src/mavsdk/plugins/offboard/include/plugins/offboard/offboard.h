@@ -350,6 +350,48 @@ public:
      */
     friend std::ostream& operator<<(std::ostream& str, Offboard::Result const& result);
 
+    /**
+     * @brief How setpoints are sent.
+     */
+    struct SenderConfig {
+        double rate_hz{20.0}; /**< @brief Rate at which the latest setpoint is sent, in Hz. */
+        bool dedicated_thread{false}; /**< @brief Send at exactly rate_hz from a thread. */
+        int realtime_priority{0}; /**< @brief SCHED_FIFO priority of the thread, 0 for none. */
+    };
+
+    /**
+     * @brief Position setpoint for one vehicle of a fleet.
+     */
+    struct FleetPositionNed {
+        Offboard* offboard{nullptr}; /**< @brief Offboard plugin of the vehicle. */
+        PositionNedYaw position_ned_yaw{}; /**< @brief Position setpoint for the vehicle. */
+    };
+
+    /**
+     * @brief Distribution of latencies.
+     */
+    struct LatencyStats {
+        uint64_t count{0}; /**< @brief Number of samples recorded. */
+        uint64_t p50_ns{0}; /**< @brief Median in nanoseconds. */
+        uint64_t p90_ns{0}; /**< @brief 90th percentile in nanoseconds. */
+        uint64_t p99_ns{0}; /**< @brief 99th percentile in nanoseconds. */
+        uint64_t max_ns{0}; /**< @brief Maximum in nanoseconds. */
+    };
+
+    /**
+     * @brief Measured latency of offboard control, see enable_latency_measurement.
+     */
+    struct ControlLatency {
+        uint64_t setpoints{0}; /**< @brief Setpoints measured, repeated ones not counted. */
+        uint64_t matched{0}; /**< @brief Setpoints the autopilot reported back. */
+        uint64_t missed{0}; /**< @brief Setpoints replaced before they were reported back. */
+        LatencyStats round_trip{}; /**< @brief From setting a setpoint until it arrived
+                                      back as the autopilot's target. */
+        LatencyStats to_autopilot{}; /**< @brief From setting a setpoint until the autopilot
+                                        reported it, by the timesync clock model. Empty
+                                        until timesync is synced. */
+    };
+
     /**
      * @brief Callback type for asynchronous Offboard calls.
      */
@@ -489,6 +531,66 @@ public:
      */
     Result set_acceleration_ned(AccelerationNed acceleration_ned) const;
 
+    /**
+     * @brief Configure how setpoints are sent.
+     *
+     * By default, the latest setpoint is sent at 20 Hz from MAVSDK's timer
+     * thread and additionally every time it is set. With a dedicated thread,
+     * setting a setpoint only hands it over, and the thread sends the latest
+     * one at exactly the configured rate.
+     *
+     * This function is blocking.
+     *
+     * @return Result of request.
+     */
+    Result set_sender_config(SenderConfig sender_config) const;
+
+    /**
+     * @brief Set the position in NED coordinates and yaw for many vehicles at once.
+     *
+     * This does the same as calling `set_position_ned` on each of the plugins,
+     * except that all messages are packed in one pass and handed to each
+     * connection at once. On Linux, UDP connections send them with as few
+     * system calls as possible.
+     *
+     * @return Result of request, Success if all setpoints were sent.
+     */
+    static Result set_position_ned_fleet(const std::vector<FleetPositionNed>& setpoints);
+
+    /**
+     * @brief Measure the latency of offboard control.
+     *
+     * Every position, velocity and acceleration setpoint in NED that is set is
+     * timestamped when its set function is called, and matched with the
+     * POSITION_TARGET_LOCAL_NED the autopilot sends once it uses it. This
+     * covers the whole path, through MAVSDK's send path, the link and the
+     * autopilot, and back. The autopilot is asked to send that message at
+     * target_rate_hz, which is the resolution of the measurement.
+     *
+     * Only setpoints which differ from the one before can be matched, so the
+     * setpoints should change, e.g. slightly on every call.
+     *
+     * This function is blocking.
+     *
+     * @return Result of asking for the target message.
+     */
+    Result enable_latency_measurement(double target_rate_hz = 50.0) const;
+
+    /**
+     * @brief Stop measuring, the target message goes back to its default rate.
+     */
+    void disable_latency_measurement() const;
+
+    /**
+     * @brief Get the latencies measured so far.
+     */
+    ControlLatency latency_measurement() const;
+
+    /**
+     * @brief Start the measurement over.
+     */
+    void reset_latency_measurement() const;
+
     /**
      * @brief Copy constructor.
      */
@@ -336,4 +336,42 @@ std::ostream& operator<<(std::ostream& str, Offboard::Result const& result)
     }
 }
 
+Offboard::Result Offboard::set_sender_config(SenderConfig sender_config) const
+{
+    return _impl->set_sender_config(sender_config);
+}
+
+Offboard::Result Offboard::set_position_ned_fleet(const std::vector<FleetPositionNed>& setpoints)
+{
+    std::vector<std::pair<OffboardImpl*, PositionNedYaw>> impl_setpoints;
+    impl_setpoints.reserve(setpoints.size());
+    for (const auto& setpoint : setpoints) {
+        if (setpoint.offboard == nullptr) {
+            return Result::Unknown;
+        }
+        impl_setpoints.emplace_back(setpoint.offboard->_impl.get(), setpoint.position_ned_yaw);
+    }
+    return OffboardImpl::set_position_ned_fleet(impl_setpoints);
+}
+
+Offboard::Result Offboard::enable_latency_measurement(double target_rate_hz) const
+{
+    return _impl->enable_latency_measurement(target_rate_hz);
+}
+
+void Offboard::disable_latency_measurement() const
+{
+    _impl->disable_latency_measurement();
+}
+
+Offboard::ControlLatency Offboard::latency_measurement() const
+{
+    return _impl->latency_measurement();
+}
+
+void Offboard::reset_latency_measurement() const
+{
+    _impl->reset_latency_measurement();
+}
+
 } // namespace mavsdk
\ No newline at end of file
@@ -1,5 +1,5 @@
+#include <chrono>
 #include <cmath>
-#include <utility>
 #include "mavsdk_math.h"
 #include "offboard_impl.h"
 #include "mavsdk_impl.h"
@@ -28,6 +28,11 @@ void OffboardImpl::init()
         MAVLINK_MSG_ID_HEARTBEAT,
         [this](const mavlink_message_t& message) { process_heartbeat(message); },
         this);
+
+    _parent->register_mavlink_message_handler(
+        MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED,
+        [this](const mavlink_message_t& message) { process_position_target_local_ned(message); },
+        this);
 }
 
 void OffboardImpl::deinit()
@@ -109,10 +114,173 @@ void OffboardImpl::stop_async(Offboard::ResultCallback callback)
 
 bool OffboardImpl::is_active()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
     return (_mode != Mode::NotActive);
 }
 
+Offboard::Result OffboardImpl::set_sender_config(Offboard::SenderConfig sender_config)
+{
+    if (!(sender_config.rate_hz > 0.0)) {
+        LogErr() << "Invalid offboard setpoint rate: " << sender_config.rate_hz;
+        return Offboard::Result::Unknown;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _sender_config = sender_config;
+
+    if (_mode != Mode::NotActive) {
+        // Restart sending the current setpoint the new way.
+        stop_sender();
+        start_sender();
+    }
+    return Offboard::Result::Success;
+}
+
+Offboard::Result OffboardImpl::enable_latency_measurement(double target_rate_hz)
+{
+    _latency_measurement_enabled = true;
+    return offboard_result_from_command_result(
+        _parent->set_msg_rate(MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED, target_rate_hz));
+}
+
+void OffboardImpl::disable_latency_measurement()
+{
+    _latency_measurement_enabled = false;
+    _parent->set_msg_rate_async(MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED, 0.0, nullptr);
+}
+
+Offboard::ControlLatency OffboardImpl::latency_measurement() const
+{
+    return _setpoint_latency.stats();
+}
+
+void OffboardImpl::reset_latency_measurement()
+{
+    _setpoint_latency.reset();
+}
+
+void OffboardImpl::measure_setpoint(
+    SetpointLatency::Field field, const SetpointLatency::Values& values)
+{
+    if (_latency_measurement_enabled) {
+        _setpoint_latency.add_setpoint(field, values, steady_time_ns());
+    }
+}
+
+uint64_t OffboardImpl::steady_time_ns() const
+{
+    // The clock the timesync clock model maps the autopilot's time to.
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     _parent->get_time().steady_time().time_since_epoch())
+                                     .count());
+}
+
+void OffboardImpl::process_position_target_local_ned(const mavlink_message_t& message)
+{
+    if (!_latency_measurement_enabled) {
+        return;
+    }
+
+    const auto receive_ns = steady_time_ns();
+
+    mavlink_position_target_local_ned_t position_target;
+    mavlink_msg_position_target_local_ned_decode(&message, &position_target);
+
+    SetpointLatency::Target target;
+    target.position = {position_target.x, position_target.y, position_target.z};
+    target.velocity = {position_target.vx, position_target.vy, position_target.vz};
+    target.acceleration = {position_target.afx, position_target.afy, position_target.afz};
+
+    std::optional<uint64_t> autopilot_ns;
+    if (const auto local_us =
+            _parent->to_local_time_us(static_cast<uint64_t>(position_target.time_boot_ms) * 1000)) {
+        autopilot_ns = *local_us * 1000;
+    }
+
+    _setpoint_latency.add_target(target, receive_ns, autopilot_ns);
+}
+
+bool OffboardImpl::use_setpoint(Mode mode)
+{
+    // The dedicated thread picks up the latest setpoint by itself, so just
+    // updating it doesn't need the lock.
+    if (_sender_thread_active && _mode == mode) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    const bool was_active = (_mode != Mode::NotActive);
+    _mode = mode;
+
+    if (!was_active) {
+        // We automatically send setpoints from now on.
+        start_sender();
+    } else if (_call_every_cookie != nullptr) {
+        // We're already sending setpoints. Since the setpoint changes, let's
+        // reschedule the next call, so we don't send setpoints too often.
+        _parent->reset_call_every(_call_every_cookie);
+    }
+
+    // The dedicated thread sends at exactly its rate, otherwise we also send
+    // right now to reduce latency.
+    return !_sender_config.dedicated_thread;
+}
+
+void OffboardImpl::start_sender()
+{
+    // We assume that we already acquired the mutex in this function.
+
+    const double interval_s = 1.0 / _sender_config.rate_hz;
+    if (_sender_config.dedicated_thread) {
+        _sender_thread_active = true;
+        _sender_thread.start(
+            [this]() { send_setpoint(); }, interval_s, _sender_config.realtime_priority);
+    } else {
+        _parent->add_call_every(
+            [this]() { send_setpoint(); }, static_cast<float>(interval_s), &_call_every_cookie);
+    }
+}
+
+void OffboardImpl::stop_sender()
+{
+    // We assume that we already acquired the mutex in this function.
+
+    if (_call_every_cookie != nullptr) {
+        _parent->remove_call_every(_call_every_cookie);
+        _call_every_cookie = nullptr;
+    }
+    if (_sender_thread_active) {
+        _sender_thread_active = false;
+        _sender_thread.stop();
+    }
+}
+
+Offboard::Result OffboardImpl::send_setpoint()
+{
+    switch (_mode.load()) {
+        case Mode::PositionNed:
+            return send_position_ned();
+        case Mode::PositionGlobalAltRel:
+            return send_position_global();
+        case Mode::VelocityNed:
+            return send_velocity_ned();
+        case Mode::PositionVelocityNed:
+            return send_position_velocity_ned();
+        case Mode::AccelerationNed:
+            return send_acceleration_ned();
+        case Mode::VelocityBody:
+            return send_velocity_body();
+        case Mode::Attitude:
+            return send_attitude();
+        case Mode::AttitudeRate:
+            return send_attitude_rate();
+        case Mode::ActuatorControl:
+            return send_actuator_control();
+        case Mode::NotActive:
+        default:
+            return Offboard::Result::Success;
+    }
+}
+
 void OffboardImpl::receive_command_result(
     MavlinkCommandSender::Result result, const Offboard::ResultCallback& callback)
 {
@@ -124,82 +292,39 @@ void OffboardImpl::receive_command_result(
 
 Offboard::Result OffboardImpl::set_position_ned(Offboard::PositionNedYaw position_ned_yaw)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _position_ned_yaw = position_ned_yaw;
+    measure_setpoint(
+        SetpointLatency::Field::Position,
+        {position_ned_yaw.north_m, position_ned_yaw.east_m, position_ned_yaw.down_m});
+    _position_ned_yaw.store(position_ned_yaw);
 
-        if (_mode != Mode::PositionNed) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send Ned setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_position_ned(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::PositionNed;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
+    if (!use_setpoint(Mode::PositionNed)) {
+        return Offboard::Result::Success;
     }
-
     // also send it right now to reduce latency
     return send_position_ned();
 }
 
-Offboard::Result OffboardImpl::set_position_global(Offboard::PositionGlobalYaw position_global_yaw)
+Offboard::Result
+OffboardImpl::set_position_global(Offboard::PositionGlobalYaw position_global_yaw)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _position_global_yaw = position_global_yaw;
+    _position_global_yaw.store(position_global_yaw);
 
-        if (_mode != Mode::PositionGlobalAltRel) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send Global setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_position_global(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::PositionGlobalAltRel;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
+    if (!use_setpoint(Mode::PositionGlobalAltRel)) {
+        return Offboard::Result::Success;
     }
-
     // also send it right now to reduce latency
     return send_position_global();
 }
 
 Offboard::Result OffboardImpl::set_velocity_ned(Offboard::VelocityNedYaw velocity_ned_yaw)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _velocity_ned_yaw = velocity_ned_yaw;
+    measure_setpoint(
+        SetpointLatency::Field::Velocity,
+        {velocity_ned_yaw.north_m_s, velocity_ned_yaw.east_m_s, velocity_ned_yaw.down_m_s});
+    _velocity_ned_yaw.store(velocity_ned_yaw);
 
-        if (_mode != Mode::VelocityNed) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send Ned setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_velocity_ned(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::VelocityNed;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
+    if (!use_setpoint(Mode::VelocityNed)) {
+        return Offboard::Result::Success;
     }
     // also send it right now to reduce latency
     return send_velocity_ned();
@@ -208,57 +333,28 @@ Offboard::Result OffboardImpl::set_velocity_ned(Offboard::VelocityNedYaw velocit
 Offboard::Result OffboardImpl::set_position_velocity_ned(
     Offboard::PositionNedYaw position_ned_yaw, Offboard::VelocityNedYaw velocity_ned_yaw)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _position_ned_yaw = position_ned_yaw;
-        _velocity_ned_yaw = velocity_ned_yaw;
-
-        if (_mode != Mode::PositionVelocityNed) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send Ned setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_position_velocity_ned(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::PositionVelocityNed;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
-    }
+    measure_setpoint(
+        SetpointLatency::Field::Position,
+        {position_ned_yaw.north_m, position_ned_yaw.east_m, position_ned_yaw.down_m});
+    _position_velocity_ned.store({position_ned_yaw, velocity_ned_yaw});
 
+    if (!use_setpoint(Mode::PositionVelocityNed)) {
+        return Offboard::Result::Success;
+    }
     // also send it right now to reduce latency
     return send_position_velocity_ned();
 }
 
 Offboard::Result OffboardImpl::set_acceleration_ned(Offboard::AccelerationNed acceleration_ned)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _acceleration_ned = acceleration_ned;
+    measure_setpoint(
+        SetpointLatency::Field::Acceleration,
+        {acceleration_ned.north_m_s2, acceleration_ned.east_m_s2, acceleration_ned.down_m_s2});
+    _acceleration_ned.store(acceleration_ned);
 
-        if (_mode != Mode::AccelerationNed) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send Ned setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_acceleration_ned(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::AccelerationNed;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
+    if (!use_setpoint(Mode::AccelerationNed)) {
+        return Offboard::Result::Success;
     }
-
     // also send it right now to reduce latency
     return send_acceleration_ned();
 }
@@ -266,84 +362,33 @@ Offboard::Result OffboardImpl::set_acceleration_ned(Offboard::AccelerationNed ac
 Offboard::Result
 OffboardImpl::set_velocity_body(Offboard::VelocityBodyYawspeed velocity_body_yawspeed)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _velocity_body_yawspeed = velocity_body_yawspeed;
+    _velocity_body_yawspeed.store(velocity_body_yawspeed);
 
-        if (_mode != Mode::VelocityBody) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send body setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_velocity_body(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::VelocityBody;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
+    if (!use_setpoint(Mode::VelocityBody)) {
+        return Offboard::Result::Success;
     }
-
     // also send it right now to reduce latency
     return send_velocity_body();
 }
 
 Offboard::Result OffboardImpl::set_attitude(Offboard::Attitude attitude)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _attitude = attitude;
+    _attitude.store(attitude);
 
-        if (_mode != Mode::Attitude) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send body setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_attitude(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::Attitude;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
+    if (!use_setpoint(Mode::Attitude)) {
+        return Offboard::Result::Success;
     }
-
     // also send it right now to reduce latency
     return send_attitude();
 }
 
 Offboard::Result OffboardImpl::set_attitude_rate(Offboard::AttitudeRate attitude_rate)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _attitude_rate = attitude_rate;
+    _attitude_rate.store(attitude_rate);
 
-        if (_mode != Mode::AttitudeRate) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send body setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_attitude_rate(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::AttitudeRate;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
+    if (!use_setpoint(Mode::AttitudeRate)) {
+        return Offboard::Result::Success;
     }
-
     // also send it right now to reduce latency
     return send_attitude_rate();
 }
@@ -351,32 +396,26 @@ Offboard::Result OffboardImpl::set_attitude_rate(Offboard::AttitudeRate attitude
 Offboard::Result OffboardImpl::set_actuator_control(Offboard::ActuatorControl actuator_control)
 {
     {
-        std::lock_guard<std::mutex> lock(_mutex);
+        std::lock_guard<std::mutex> lock(_actuator_control_mutex);
         _actuator_control = actuator_control;
-
-        if (_mode != Mode::ActuatorControl) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send motor rate values from now on.
-            _parent->add_call_every(
-                [this]() { send_actuator_control(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::ActuatorControl;
-        } else {
-            // We're already sending these kind of values. Since the value changes, let's
-            // reschedule the next call, so we don't send values too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
     }
 
+    if (!use_setpoint(Mode::ActuatorControl)) {
+        return Offboard::Result::Success;
+    }
     // also send it right now to reduce latency
     return send_actuator_control();
 }
 
 Offboard::Result OffboardImpl::send_position_ned()
+{
+    auto message = position_ned_message(_position_ned_yaw.load());
+    return _parent->send_message(message) ? Offboard::Result::Success :
+                                            Offboard::Result::ConnectionError;
+}
+
+mavlink_message_t
+OffboardImpl::position_ned_message(const Offboard::PositionNedYaw& position_ned_yaw)
 {
     const static uint16_t IGNORE_VX = (1 << 3);
     const static uint16_t IGNORE_VY = (1 << 4);
@@ -386,11 +425,6 @@ Offboard::Result OffboardImpl::send_position_ned()
     const static uint16_t IGNORE_AZ = (1 << 8);
     const static uint16_t IGNORE_YAW_RATE = (1 << 11);
 
-    const auto position_ned_yaw = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _position_ned_yaw;
-    }();
-
     mavlink_message_t message;
     mavlink_msg_set_position_target_local_ned_pack(
         _parent->get_own_system_id(),
@@ -412,8 +446,53 @@ Offboard::Result OffboardImpl::send_position_ned()
         0.0f, // afz
         to_rad_from_deg(position_ned_yaw.yaw_deg), // yaw
         0.0f); // yaw_rate
-    return _parent->send_message(message) ? Offboard::Result::Success :
-                                            Offboard::Result::ConnectionError;
+    return message;
+}
+
+Offboard::Result OffboardImpl::set_position_ned_fleet(
+    const std::vector<std::pair<OffboardImpl*, Offboard::PositionNedYaw>>& setpoints)
+{
+    // Everything is packed first, so that all messages sharing connections
+    // can then be handed to them at once.
+    std::vector<std::pair<OffboardImpl*, mavlink_message_t>> outgoing;
+    outgoing.reserve(setpoints.size());
+    for (const auto& [impl, position_ned_yaw] : setpoints) {
+        impl->measure_setpoint(
+            SetpointLatency::Field::Position,
+            {position_ned_yaw.north_m, position_ned_yaw.east_m, position_ned_yaw.down_m});
+        impl->_position_ned_yaw.store(position_ned_yaw);
+        if (!impl->use_setpoint(Mode::PositionNed)) {
+            continue;
+        }
+        auto message = impl->position_ned_message(position_ned_yaw);
+        if (impl->_parent->intercept_outgoing_message(message)) {
+            outgoing.emplace_back(impl, message);
+        }
+    }
+
+    bool success = true;
+    std::vector<mavlink_message_t> messages;
+    messages.reserve(outgoing.size());
+    std::vector<bool> done(outgoing.size(), false);
+    for (std::size_t i = 0; i < outgoing.size(); ++i) {
+        if (done[i]) {
+            continue;
+        }
+        // Usually all systems share the connections, so this is only one pass.
+        messages.clear();
+        auto& parent = *outgoing[i].first->_parent;
+        for (std::size_t j = i; j < outgoing.size(); ++j) {
+            if (!done[j] && outgoing[j].first->_parent->shares_connections_with(parent)) {
+                messages.push_back(outgoing[j].second);
+                done[j] = true;
+            }
+        }
+        if (!parent.send_messages(messages)) {
+            success = false;
+        }
+    }
+
+    return success ? Offboard::Result::Success : Offboard::Result::ConnectionError;
 }
 
 Offboard::Result OffboardImpl::send_position_global()
@@ -426,10 +505,7 @@ Offboard::Result OffboardImpl::send_position_global()
     const static uint16_t IGNORE_AZ = (1 << 8);
     const static uint16_t IGNORE_YAW_RATE = (1 << 11);
 
-    const auto position_global_yaw = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _position_global_yaw;
-    }();
+    const auto position_global_yaw = _position_global_yaw.load();
 
     MAV_FRAME frame;
     switch (position_global_yaw.altitude_type) {
@@ -482,10 +558,7 @@ Offboard::Result OffboardImpl::send_velocity_ned()
     const static uint16_t IGNORE_AZ = (1 << 8);
     const static uint16_t IGNORE_YAW_RATE = (1 << 11);
 
-    const auto velocity_ned_yaw = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _velocity_ned_yaw;
-    }();
+    const auto velocity_ned_yaw = _velocity_ned_yaw.load();
 
     mavlink_message_t message;
     mavlink_msg_set_position_target_local_ned_pack(
@@ -519,10 +592,7 @@ Offboard::Result OffboardImpl::send_position_velocity_ned()
     const static uint16_t IGNORE_AZ = (1 << 8);
     const static uint16_t IGNORE_YAW_RATE = (1 << 11);
 
-    const auto position_and_velocity = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return std::make_pair<>(_position_ned_yaw, _velocity_ned_yaw);
-    }();
+    const auto position_and_velocity = _position_velocity_ned.load();
 
     mavlink_message_t message;
     mavlink_msg_set_position_target_local_ned_pack(
@@ -534,16 +604,16 @@ Offboard::Result OffboardImpl::send_position_velocity_ned()
         _parent->get_autopilot_id(),
         MAV_FRAME_LOCAL_NED,
         IGNORE_AX | IGNORE_AY | IGNORE_AZ | IGNORE_YAW_RATE,
-        position_and_velocity.first.north_m,
-        position_and_velocity.first.east_m,
-        position_and_velocity.first.down_m,
-        position_and_velocity.second.north_m_s,
-        position_and_velocity.second.east_m_s,
-        position_and_velocity.second.down_m_s,
+        position_and_velocity.position.north_m,
+        position_and_velocity.position.east_m,
+        position_and_velocity.position.down_m,
+        position_and_velocity.velocity.north_m_s,
+        position_and_velocity.velocity.east_m_s,
+        position_and_velocity.velocity.down_m_s,
         0.0f, // afx
         0.0f, // afy
         0.0f, // afz
-        to_rad_from_deg(position_and_velocity.first.yaw_deg), // yaw
+        to_rad_from_deg(position_and_velocity.position.yaw_deg), // yaw
         0.0f); // yaw_rate
     return _parent->send_message(message) ? Offboard::Result::Success :
                                             Offboard::Result::ConnectionError;
@@ -560,10 +630,7 @@ Offboard::Result OffboardImpl::send_acceleration_ned()
     const static uint16_t IGNORE_YAW = (1 << 10);
     const static uint16_t IGNORE_YAW_RATE = (1 << 11);
 
-    const auto acceleration_ned = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _acceleration_ned;
-    }();
+    const auto acceleration_ned = _acceleration_ned.load();
 
     mavlink_message_t message;
     mavlink_msg_set_position_target_local_ned_pack(
@@ -601,10 +668,7 @@ Offboard::Result OffboardImpl::send_velocity_body()
     const static uint16_t IGNORE_AZ = (1 << 8);
     const static uint16_t IGNORE_YAW = (1 << 10);
 
-    const auto velocity_body_yawspeed = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _velocity_body_yawspeed;
-    }();
+    const auto velocity_body_yawspeed = _velocity_body_yawspeed.load();
 
     mavlink_message_t message;
     mavlink_msg_set_position_target_local_ned_pack(
@@ -637,12 +701,9 @@ Offboard::Result OffboardImpl::send_attitude()
     const static uint8_t IGNORE_BODY_PITCH_RATE = (1 << 1);
     const static uint8_t IGNORE_BODY_YAW_RATE = (1 << 2);
 
-    const auto attitude = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _attitude;
-    }();
+    const auto attitude = _attitude.load();
 
-    const float thrust = _attitude.thrust_value;
+    const float thrust = attitude.thrust_value;
     const float roll = to_rad_from_deg(attitude.roll_deg);
     const float pitch = to_rad_from_deg(attitude.pitch_deg);
     const float yaw = to_rad_from_deg(attitude.yaw_deg);
@@ -686,10 +747,7 @@ Offboard::Result OffboardImpl::send_attitude_rate()
 {
     const static uint8_t IGNORE_ATTITUDE = (1 << 7);
 
-    const auto attitude_rate = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _attitude_rate;
-    }();
+    const auto attitude_rate = _attitude_rate.load();
 
     const float thrust_body[3] = {0.0f, 0.0f, 0.0f};
 
@@ -706,7 +764,7 @@ Offboard::Result OffboardImpl::send_attitude_rate()
         to_rad_from_deg(attitude_rate.roll_deg_s),
         to_rad_from_deg(attitude_rate.pitch_deg_s),
         to_rad_from_deg(attitude_rate.yaw_deg_s),
-        _attitude_rate.thrust_value,
+        attitude_rate.thrust_value,
         thrust_body);
     return _parent->send_message(message) ? Offboard::Result::Success :
                                             Offboard::Result::ConnectionError;
@@ -732,7 +790,7 @@ OffboardImpl::send_actuator_control_message(const float* controls, uint8_t group
 Offboard::Result OffboardImpl::send_actuator_control()
 {
     Offboard::ActuatorControl actuator_control = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
+        std::lock_guard<std::mutex> lock(_actuator_control_mutex);
         return _actuator_control;
     }();
 
@@ -793,10 +851,7 @@ void OffboardImpl::stop_sending_setpoints()
 {
     // We assume that we already acquired the mutex in this function.
 
-    if (_call_every_cookie != nullptr) {
-        _parent->remove_call_every(_call_every_cookie);
-        _call_every_cookie = nullptr;
-    }
+    stop_sender();
     _mode = Mode::NotActive;
 }
 
@@ -1,10 +1,16 @@
 #pragma once
 
+#include <atomic>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 #include "mavlink_include.h"
+#include "periodic_thread.h"
 #include "plugins/offboard/offboard.h"
 #include "plugin_impl_base.h"
+#include "seqlock.h"
+#include "setpoint_latency.h"
 #include "system.h"
 
 namespace mavsdk {
@@ -40,11 +46,22 @@ public:
     Offboard::Result set_attitude_rate(Offboard::AttitudeRate attitude_rate);
     Offboard::Result set_actuator_control(Offboard::ActuatorControl actuator_control);
 
+    Offboard::Result set_sender_config(Offboard::SenderConfig sender_config);
+
+    Offboard::Result enable_latency_measurement(double target_rate_hz);
+    void disable_latency_measurement();
+    Offboard::ControlLatency latency_measurement() const;
+    void reset_latency_measurement();
+
+    static Offboard::Result set_position_ned_fleet(
+        const std::vector<std::pair<OffboardImpl*, Offboard::PositionNedYaw>>& setpoints);
+
     OffboardImpl(const OffboardImpl&);
     OffboardImpl& operator=(const OffboardImpl&) = delete;
 
 private:
     Offboard::Result send_position_ned();
+    mavlink_message_t position_ned_message(const Offboard::PositionNedYaw& position_ned_yaw);
     Offboard::Result send_position_global();
     Offboard::Result send_velocity_ned();
     Offboard::Result send_position_velocity_ned();
@@ -56,6 +73,9 @@ private:
     Offboard::Result send_actuator_control_message(const float* controls, uint8_t group_number = 0);
 
     void process_heartbeat(const mavlink_message_t& message);
+    void process_position_target_local_ned(const mavlink_message_t& message);
+    void measure_setpoint(SetpointLatency::Field field, const SetpointLatency::Values& values);
+    uint64_t steady_time_ns() const;
     void receive_command_result(
         MavlinkCommandSender::Result result, const Offboard::ResultCallback& callback);
 
@@ -66,6 +86,8 @@ private:
 
     Time _time{};
 
+    // Guards the mode changes and the sender, the setpoints themselves are
+    // handed over in seqlocks, so the sender never needs to take it.
     mutable std::mutex _mutex{};
     enum class Mode {
         NotActive,
@@ -79,20 +101,42 @@ private:
         Attitude,
         AttitudeRate,
         ActuatorControl
-    } _mode = Mode::NotActive;
-    Offboard::PositionNedYaw _position_ned_yaw{};
-    Offboard::PositionGlobalYaw _position_global_yaw{};
-    Offboard::VelocityNedYaw _velocity_ned_yaw{};
-    Offboard::AccelerationNed _acceleration_ned{};
-    Offboard::VelocityBodyYawspeed _velocity_body_yawspeed{};
-    Offboard::Attitude _attitude{};
-    Offboard::AttitudeRate _attitude_rate{};
+    };
+    std::atomic<Mode> _mode{Mode::NotActive};
+
+    // Returns whether the setpoint should also be sent right away.
+    bool use_setpoint(Mode mode);
+    void start_sender();
+    void stop_sender();
+    Offboard::Result send_setpoint();
+
+    struct PositionVelocityNed {
+        Offboard::PositionNedYaw position;
+        Offboard::VelocityNedYaw velocity;
+    };
+
+    Seqlock<Offboard::PositionNedYaw> _position_ned_yaw{};
+    Seqlock<Offboard::PositionGlobalYaw> _position_global_yaw{};
+    Seqlock<Offboard::VelocityNedYaw> _velocity_ned_yaw{};
+    Seqlock<PositionVelocityNed> _position_velocity_ned{};
+    Seqlock<Offboard::AccelerationNed> _acceleration_ned{};
+    Seqlock<Offboard::VelocityBodyYawspeed> _velocity_body_yawspeed{};
+    Seqlock<Offboard::Attitude> _attitude{};
+    Seqlock<Offboard::AttitudeRate> _attitude_rate{};
+
+    // The actuator controls are not trivially copyable, so they need a lock of their own.
+    std::mutex _actuator_control_mutex{};
     Offboard::ActuatorControl _actuator_control{};
+
     dl_time_t _last_started{};
 
+    Offboard::SenderConfig _sender_config{};
     void* _call_every_cookie = nullptr;
+    PeriodicThread _sender_thread{};
+    std::atomic<bool> _sender_thread_active{false};
 
-    const float SEND_INTERVAL_S = 0.05f;
+    std::atomic<bool> _latency_measurement_enabled{false};
+    SetpointLatency _setpoint_latency{};
 };
 
 } // namespace mavsdk
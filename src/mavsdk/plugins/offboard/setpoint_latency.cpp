@@ -0,0 +1,116 @@
+#include "setpoint_latency.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace mavsdk {
+
+void SetpointLatency::add_setpoint(Field field, const Values& values, uint64_t set_ns)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const std::optional<Setpoint> previous =
+        _pending.empty() ? _last_matched : std::optional<Setpoint>(_pending.back());
+    if (previous && previous->field == field && same_values(previous->values, values)) {
+        return;
+    }
+
+    ++_setpoints;
+    _pending.push_back(Setpoint{field, values, set_ns});
+    if (_pending.size() > MAX_PENDING) {
+        _pending.pop_front();
+        ++_missed;
+    }
+}
+
+void SetpointLatency::add_target(
+    const Target& target, uint64_t receive_ns, std::optional<uint64_t> autopilot_ns)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (auto it = _pending.rbegin(); it != _pending.rend(); ++it) {
+        if (!matches(*it, target)) {
+            continue;
+        }
+
+        if (receive_ns >= it->set_ns) {
+            _round_trip.record(receive_ns - it->set_ns);
+        }
+        // Off if the clock model is, in which case it can even end up before.
+        if (autopilot_ns && *autopilot_ns >= it->set_ns) {
+            _to_autopilot.record(*autopilot_ns - it->set_ns);
+        }
+        ++_matched;
+
+        // The ones before it are not going to be reported anymore.
+        const auto older = static_cast<std::size_t>(std::distance(it, _pending.rend()) - 1);
+        _missed += older;
+        _last_matched = *it;
+        _pending.erase(_pending.begin(), _pending.begin() + older + 1);
+        return;
+    }
+}
+
+Offboard::ControlLatency SetpointLatency::stats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Offboard::ControlLatency stats;
+    stats.setpoints = _setpoints;
+    stats.matched = _matched;
+    stats.missed = _missed;
+    stats.round_trip = to_stats(_round_trip);
+    stats.to_autopilot = to_stats(_to_autopilot);
+    return stats;
+}
+
+void SetpointLatency::reset()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _pending.clear();
+    _last_matched.reset();
+    _round_trip = {};
+    _to_autopilot = {};
+    _setpoints = 0;
+    _matched = 0;
+    _missed = 0;
+}
+
+bool SetpointLatency::matches(const Setpoint& setpoint, const Target& target)
+{
+    switch (setpoint.field) {
+        case Field::Position:
+            return same_values(setpoint.values, target.position);
+        case Field::Velocity:
+            return same_values(setpoint.values, target.velocity);
+        case Field::Acceleration:
+            return same_values(setpoint.values, target.acceleration);
+    }
+    return false;
+}
+
+bool SetpointLatency::same_values(const Values& lhs, const Values& rhs)
+{
+    // The autopilot passes the floats on as they are, the tolerance only
+    // covers conversions on the way, e.g. through doubles.
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        if (!(std::abs(lhs[i] - rhs[i]) <= 1e-4f * std::max(1.0f, std::abs(lhs[i])))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Offboard::LatencyStats SetpointLatency::to_stats(const LatencyHistogram& histogram)
+{
+    Offboard::LatencyStats stats;
+    stats.count = histogram.count();
+    stats.p50_ns = histogram.percentile_ns(0.5);
+    stats.p90_ns = histogram.percentile_ns(0.9);
+    stats.p99_ns = histogram.percentile_ns(0.99);
+    stats.max_ns = histogram.max_ns();
+    return stats;
+}
+
+} // namespace mavsdk
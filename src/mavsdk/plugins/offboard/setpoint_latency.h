@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+#include "message_latency.h"
+#include "plugins/offboard/offboard.h"
+
+namespace mavsdk {
+
+// Latency of offboard control, from setting a setpoint until the autopilot
+// reports it back as its target in POSITION_TARGET_LOCAL_NED.
+//
+// Setpoints carry no ID the autopilot would echo, so the values themselves
+// are the tag: a target is matched to the newest setpoint with the same
+// values. A setpoint equal to the one before can't be told apart from it and
+// is not measured. Older setpoints which were never reported back, because a
+// newer one replaced them first, count as missed.
+class SetpointLatency {
+public:
+    enum class Field { Position, Velocity, Acceleration };
+    using Values = std::array<float, 3>;
+
+    struct Target {
+        Values position{};
+        Values velocity{};
+        Values acceleration{};
+    };
+
+    // Setpoints waiting for their target, oldest are dropped beyond that.
+    static constexpr std::size_t MAX_PENDING = 32;
+
+    void add_setpoint(Field field, const Values& values, uint64_t set_ns);
+
+    // The autopilot's time of the target is passed in local time, if the
+    // clock model is synced.
+    void
+    add_target(const Target& target, uint64_t receive_ns, std::optional<uint64_t> autopilot_ns);
+
+    [[nodiscard]] Offboard::ControlLatency stats() const;
+
+    void reset();
+
+private:
+    struct Setpoint {
+        Field field{Field::Position};
+        Values values{};
+        uint64_t set_ns{0};
+    };
+
+    static bool matches(const Setpoint& setpoint, const Target& target);
+    static bool same_values(const Values& lhs, const Values& rhs);
+    static Offboard::LatencyStats to_stats(const LatencyHistogram& histogram);
+
+    mutable std::mutex _mutex{};
+    std::deque<Setpoint> _pending{};
+    std::optional<Setpoint> _last_matched{};
+    LatencyHistogram _round_trip{};
+    LatencyHistogram _to_autopilot{};
+    uint64_t _setpoints{0};
+    uint64_t _matched{0};
+    uint64_t _missed{0};
+};
+
+} // namespace mavsdk
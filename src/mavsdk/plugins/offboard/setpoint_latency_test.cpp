@@ -0,0 +1,100 @@
+#include "setpoint_latency.h"
+
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+SetpointLatency::Target velocity_target(float north, float east, float down)
+{
+    SetpointLatency::Target target;
+    target.velocity = {north, east, down};
+    return target;
+}
+
+} // namespace
+
+TEST(SetpointLatency, MatchesTargetWithSameValues)
+{
+    SetpointLatency latency;
+    latency.add_setpoint(SetpointLatency::Field::Velocity, {1.0f, 2.0f, 0.5f}, 1000000);
+
+    // Still the old target, the setpoint is not in use yet.
+    latency.add_target(velocity_target(0.0f, 0.0f, 0.0f), 2000000, std::nullopt);
+    EXPECT_EQ(latency.stats().matched, 0u);
+
+    latency.add_target(velocity_target(1.0f, 2.0f, 0.5f), 21000000, 11000000);
+
+    const auto stats = latency.stats();
+    EXPECT_EQ(stats.setpoints, 1u);
+    EXPECT_EQ(stats.matched, 1u);
+    EXPECT_EQ(stats.missed, 0u);
+    ASSERT_EQ(stats.round_trip.count, 1u);
+    // Within the 12.5% of the histogram's buckets.
+    EXPECT_NEAR(double(stats.round_trip.max_ns), 20e6, 20e6 * 0.125);
+    ASSERT_EQ(stats.to_autopilot.count, 1u);
+    EXPECT_NEAR(double(stats.to_autopilot.max_ns), 10e6, 10e6 * 0.125);
+}
+
+TEST(SetpointLatency, RepeatedTargetIsOnlyMatchedOnce)
+{
+    SetpointLatency latency;
+    latency.add_setpoint(SetpointLatency::Field::Velocity, {1.0f, 0.0f, 0.0f}, 0);
+    latency.add_target(velocity_target(1.0f, 0.0f, 0.0f), 1000, std::nullopt);
+    latency.add_target(velocity_target(1.0f, 0.0f, 0.0f), 2000, std::nullopt);
+
+    // Can't be told apart from the one before.
+    latency.add_setpoint(SetpointLatency::Field::Velocity, {1.0f, 0.0f, 0.0f}, 3000);
+    latency.add_target(velocity_target(1.0f, 0.0f, 0.0f), 4000, std::nullopt);
+
+    const auto stats = latency.stats();
+    EXPECT_EQ(stats.setpoints, 1u);
+    EXPECT_EQ(stats.matched, 1u);
+}
+
+TEST(SetpointLatency, ReplacedSetpointsAreMissed)
+{
+    SetpointLatency latency;
+    latency.add_setpoint(SetpointLatency::Field::Velocity, {1.0f, 0.0f, 0.0f}, 0);
+    latency.add_setpoint(SetpointLatency::Field::Velocity, {2.0f, 0.0f, 0.0f}, 1000);
+    latency.add_setpoint(SetpointLatency::Field::Velocity, {3.0f, 0.0f, 0.0f}, 2000);
+
+    latency.add_target(velocity_target(2.0f, 0.0f, 0.0f), 5000, std::nullopt);
+    auto stats = latency.stats();
+    EXPECT_EQ(stats.matched, 1u);
+    EXPECT_EQ(stats.missed, 1u);
+    EXPECT_EQ(stats.round_trip.max_ns, 4000u);
+
+    latency.add_target(velocity_target(3.0f, 0.0f, 0.0f), 6000, std::nullopt);
+    stats = latency.stats();
+    EXPECT_EQ(stats.matched, 2u);
+    EXPECT_EQ(stats.missed, 1u);
+}
+
+TEST(SetpointLatency, MatchesOnlyTheSameField)
+{
+    SetpointLatency latency;
+    latency.add_setpoint(SetpointLatency::Field::Position, {1.0f, 2.0f, -3.0f}, 0);
+    latency.add_target(velocity_target(1.0f, 2.0f, -3.0f), 1000, std::nullopt);
+    EXPECT_EQ(latency.stats().matched, 0u);
+
+    SetpointLatency::Target target;
+    target.position = {1.0f, 2.0f, -3.0f};
+    latency.add_target(target, 2000, std::nullopt);
+    EXPECT_EQ(latency.stats().matched, 1u);
+}
+
+TEST(SetpointLatency, DropsOldestBeyondMaxPending)
+{
+    SetpointLatency latency;
+    for (std::size_t i = 0; i < SetpointLatency::MAX_PENDING + 2; ++i) {
+        latency.add_setpoint(
+            SetpointLatency::Field::Velocity, {static_cast<float>(i), 0.0f, 0.0f}, i);
+    }
+    EXPECT_EQ(latency.stats().missed, 2u);
+
+    latency.reset();
+    EXPECT_EQ(latency.stats().setpoints, 0u);
+    EXPECT_EQ(latency.stats().missed, 0u);
+}
@@ -202,6 +202,36 @@ public:
      */
     Param::AllParams get_all_params() const;
 
+    /**
+     * @brief Set several int and float parameters at once.
+     *
+     * The parameters are set in parallel rather than one after the other,
+     * which is much faster for many of them.
+     *
+     * This function is blocking.
+     *
+     * @return Result of request, only `SUCCESS` if all parameters were set.
+     */
+    Result set_params(AllParams all_params) const;
+
+    /**
+     * @brief Callback type for set_params_async.
+     *
+     * Besides the overall result, there is one result per parameter: the int
+     * parameters first, then the float parameters, each in the order given.
+     */
+    using SetParamsCallback = std::function<void(Result, std::vector<Result>)>;
+
+    /**
+     * @brief Set several int and float parameters at once.
+     *
+     * Like set_params, but a parameter with an invalid name does not stop the
+     * others from being set.
+     *
+     * This function is non-blocking. See 'set_params' for the blocking counterpart.
+     */
+    void set_params_async(AllParams all_params, const SetParamsCallback& callback) const;
+
     /**
      * @brief Copy constructor.
      */
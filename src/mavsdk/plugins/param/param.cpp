@@ -123,4 +123,14 @@ std::ostream& operator<<(std::ostream& str, Param::Result const& result)
     }
 }
 
+Param::Result Param::set_params(AllParams all_params) const
+{
+    return _impl->set_params(all_params);
+}
+
+void Param::set_params_async(AllParams all_params, const SetParamsCallback& callback) const
+{
+    _impl->set_params_async(all_params, callback);
+}
+
 } // namespace mavsdk
\ No newline at end of file
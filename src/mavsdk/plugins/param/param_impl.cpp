@@ -53,20 +53,20 @@ Param::Result ParamImpl::set_param_float(const std::string& name, float value)
 
 Param::AllParams ParamImpl::get_all_params()
 {
-    auto tmp = _parent->get_all_params();
+    const auto all_params = _parent->get_all_params();
 
     Param::AllParams res{};
 
-    for (auto const& parampair : tmp) {
-        if (parampair.second.is<float>()) {
+    for (auto const& entry : all_params) {
+        if (entry.value.is<float>()) {
             Param::FloatParam tmp_param;
-            tmp_param.name = parampair.first;
-            tmp_param.value = parampair.second.get<float>();
+            tmp_param.name = entry.name.str();
+            tmp_param.value = entry.value.get<float>();
             res.float_params.push_back(tmp_param);
-        } else if (parampair.second.is<int32_t>()) {
+        } else if (entry.value.is<int32_t>()) {
             Param::IntParam tmp_param;
-            tmp_param.name = parampair.first;
-            tmp_param.value = parampair.second.get<int32_t>();
+            tmp_param.name = entry.name.str();
+            tmp_param.value = entry.value.get<int32_t>();
             res.int_params.push_back(tmp_param);
         }
     }
@@ -74,6 +74,79 @@ Param::AllParams ParamImpl::get_all_params()
     return res;
 }
 
+Param::Result ParamImpl::set_params(const Param::AllParams& all_params)
+{
+    MAVLinkParameters::ParamStore params;
+    params.reserve(all_params.int_params.size() + all_params.float_params.size());
+
+    MAVLinkParameters::ParamValue value;
+    for (const auto& param : all_params.int_params) {
+        value.set<int32_t>(param.value);
+        if (!params.set(param.name, value)) {
+            return Param::Result::ParamNameTooLong;
+        }
+    }
+    for (const auto& param : all_params.float_params) {
+        value.set<float>(param.value);
+        if (!params.set(param.name, value)) {
+            return Param::Result::ParamNameTooLong;
+        }
+    }
+
+    return result_from_mavlink_parameters_result(_parent->set_params(params));
+}
+
+void ParamImpl::set_params_async(
+    const Param::AllParams& all_params, const Param::SetParamsCallback& callback)
+{
+    MAVLinkParameters::ParamStore params;
+    params.reserve(all_params.int_params.size() + all_params.float_params.size());
+
+    // Names which don't fit are left out of the store and reported on their own.
+    std::vector<std::string> names;
+    names.reserve(all_params.int_params.size() + all_params.float_params.size());
+
+    MAVLinkParameters::ParamValue value;
+    for (const auto& param : all_params.int_params) {
+        value.set<int32_t>(param.value);
+        params.set(param.name, value);
+        names.push_back(param.name);
+    }
+    for (const auto& param : all_params.float_params) {
+        value.set<float>(param.value);
+        params.set(param.name, value);
+        names.push_back(param.name);
+    }
+
+    _parent->set_params_async(
+        params,
+        [this, callback, params, names = std::move(names)](
+            MAVLinkParameters::Result result, std::vector<MAVLinkParameters::Result> results) {
+            auto overall = result_from_mavlink_parameters_result(result);
+
+            std::vector<Param::Result> param_results;
+            param_results.reserve(names.size());
+            for (const auto& name : names) {
+                const auto index = params.index_of(name);
+                if (!index) {
+                    param_results.push_back(Param::Result::ParamNameTooLong);
+                    if (overall == Param::Result::Success) {
+                        overall = Param::Result::ParamNameTooLong;
+                    }
+                    continue;
+                }
+                param_results.push_back(result_from_mavlink_parameters_result(results[*index]));
+            }
+
+            if (callback) {
+                _parent->call_user_callback(
+                    [callback, overall, param_results = std::move(param_results)]() {
+                        callback(overall, param_results);
+                    });
+            }
+        });
+}
+
 Param::Result ParamImpl::result_from_mavlink_parameters_result(MAVLinkParameters::Result result)
 {
     switch (result) {
@@ -30,6 +30,11 @@ public:
 
     Param::AllParams get_all_params();
 
+    Param::Result set_params(const Param::AllParams& all_params);
+
+    void set_params_async(
+        const Param::AllParams& all_params, const Param::SetParamsCallback& callback);
+
 private:
     static Param::Result result_from_mavlink_parameters_result(MAVLinkParameters::Result result);
 };
@@ -61,20 +61,20 @@ ParamServer::Result ParamServerImpl::provide_param_float(std::string name, float
 
 ParamServer::AllParams ParamServerImpl::retrieve_all_params() const
 {
-    auto tmp = _parent->retrieve_all_server_params();
+    const auto& all_params = _parent->retrieve_all_server_params();
 
     ParamServer::AllParams res{};
 
-    for (auto const& parampair : tmp) {
-        if (parampair.second.is<float>()) {
+    for (auto const& entry : all_params) {
+        if (entry.value.is<float>()) {
             ParamServer::FloatParam tmp_param;
-            tmp_param.name = parampair.first;
-            tmp_param.value = parampair.second.get<float>();
+            tmp_param.name = entry.name.str();
+            tmp_param.value = entry.value.get<float>();
             res.float_params.push_back(tmp_param);
-        } else if (parampair.second.is<int32_t>()) {
+        } else if (entry.value.is<int32_t>()) {
             ParamServer::IntParam tmp_param;
-            tmp_param.name = parampair.first;
-            tmp_param.value = parampair.second.get<int32_t>();
+            tmp_param.name = entry.name.str();
+            tmp_param.value = entry.value.get<int32_t>();
             res.int_params.push_back(tmp_param);
         }
     }
@@ -0,0 +1,127 @@
+#include "rtcm_pacer.h"
+
+#include <algorithm>
+
+namespace mavsdk {
+
+void RtcmPacer::set_rate(double bytes_per_s)
+{
+    _bytes_per_s = std::max(bytes_per_s, 0.0);
+    _budget_bytes = std::min(_budget_bytes, max_budget_bytes());
+}
+
+void RtcmPacer::push(std::string data, double now_s)
+{
+    const auto type = message_type(data);
+
+    // A newer message of the same type supersedes the one still waiting,
+    // e.g. observations of an older epoch or the station position.
+    if (type) {
+        const auto it = std::find_if(_queue.begin(), _queue.end(), [&type](const Queued& queued) {
+            return queued.type == type;
+        });
+        if (it != _queue.end()) {
+            _queued_bytes -= wire_bytes(it->data.size());
+            _queue.erase(it);
+            ++_dropped;
+        }
+    }
+
+    _queued_bytes += wire_bytes(data.size());
+    _queue.push_back(Queued{std::move(data), type, now_s});
+
+    // Whatever can't go out within the maximum age is dropped, oldest first.
+    if (_bytes_per_s > 0.0) {
+        while (_queue.size() > 1 && _queued_bytes > _bytes_per_s * _max_age_s) {
+            _queued_bytes -= wire_bytes(_queue.front().data.size());
+            _queue.pop_front();
+            ++_dropped;
+        }
+    }
+}
+
+std::vector<std::string> RtcmPacer::pop_ready(double now_s)
+{
+    refill(now_s);
+
+    std::vector<std::string> ready;
+    while (!_queue.empty()) {
+        auto& front = _queue.front();
+        const auto bytes = wire_bytes(front.data.size());
+
+        if (now_s - front.queued_s > _max_age_s) {
+            _queued_bytes -= bytes;
+            _queue.pop_front();
+            ++_dropped;
+            continue;
+        }
+
+        if (_bytes_per_s > 0.0) {
+            if (static_cast<double>(bytes) > _budget_bytes) {
+                break;
+            }
+            _budget_bytes -= static_cast<double>(bytes);
+        }
+
+        _queued_bytes -= bytes;
+        ready.push_back(std::move(front.data));
+        _queue.pop_front();
+    }
+    return ready;
+}
+
+std::optional<double> RtcmPacer::next_ready_in_s(double now_s) const
+{
+    if (_queue.empty()) {
+        return std::nullopt;
+    }
+    if (_bytes_per_s <= 0.0) {
+        return 0.0;
+    }
+
+    const double elapsed_s = _refilled_s ? std::max(now_s - _refilled_s.value(), 0.0) : 0.0;
+    const double budget_bytes =
+        std::min(_budget_bytes + elapsed_s * _bytes_per_s, max_budget_bytes());
+    const auto missing_bytes =
+        static_cast<double>(wire_bytes(_queue.front().data.size())) - budget_bytes;
+    return std::max(missing_bytes / _bytes_per_s, 0.0);
+}
+
+std::size_t RtcmPacer::wire_bytes(std::size_t size)
+{
+    // A message of a multiple of the fragment size ends with an empty fragment.
+    const std::size_t fragments = (size / FRAGMENT_DATA_BYTES) + 1;
+    return size + fragments * FRAGMENT_OVERHEAD_BYTES;
+}
+
+std::optional<uint16_t> RtcmPacer::message_type(const std::string& data)
+{
+    // Preamble, 6 reserved bits and 10 bits of length, then the 12 bits of
+    // the message type.
+    if (data.size() < 5 || static_cast<uint8_t>(data[0]) != 0xD3) {
+        return std::nullopt;
+    }
+    return static_cast<uint16_t>(
+        (static_cast<uint8_t>(data[3]) << 4) | (static_cast<uint8_t>(data[4]) >> 4));
+}
+
+void RtcmPacer::refill(double now_s)
+{
+    if (_refilled_s) {
+        const double elapsed_s = std::max(now_s - _refilled_s.value(), 0.0);
+        _budget_bytes = std::min(_budget_bytes + elapsed_s * _bytes_per_s, max_budget_bytes());
+    } else {
+        _budget_bytes = max_budget_bytes();
+    }
+    _refilled_s = now_s;
+}
+
+double RtcmPacer::max_budget_bytes() const
+{
+    // A quarter second of bursting, but at least one message of the largest
+    // size, which could never go out otherwise.
+    return std::max(
+        _bytes_per_s * 0.25, static_cast<double>(wire_bytes(4 * FRAGMENT_DATA_BYTES - 1)));
+}
+
+} // namespace mavsdk
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+
+// Queues RTCM messages to fit the rate of the radio link.
+//
+// Messages go out as the budget allows, which refills at the configured
+// rate. When the link can't keep up, stale corrections are dropped rather
+// than delayed: a queued message is replaced by a newer one of the same
+// RTCM message type, and messages waiting for longer than the maximum age
+// are dropped, as are the oldest ones once the queue is full.
+//
+// Not thread-safe, the caller needs to lock.
+class RtcmPacer {
+public:
+    // Bytes on the wire per GPS_RTCM_DATA fragment apart from the data:
+    // the MAVLink 2 header and checksum, flags and length.
+    static constexpr std::size_t FRAGMENT_OVERHEAD_BYTES = 14;
+    static constexpr std::size_t FRAGMENT_DATA_BYTES = 180;
+    static constexpr double DEFAULT_MAX_AGE_S = 2.0;
+
+    // A rate of 0 means unlimited.
+    void set_rate(double bytes_per_s);
+    [[nodiscard]] double rate() const { return _bytes_per_s; }
+
+    void set_max_age(double max_age_s) { _max_age_s = max_age_s; }
+
+    void push(std::string data, double now_s);
+
+    // Takes the messages which fit into the budget now, oldest first.
+    std::vector<std::string> pop_ready(double now_s);
+
+    // How long until the next message fits, if one is waiting.
+    [[nodiscard]] std::optional<double> next_ready_in_s(double now_s) const;
+
+    [[nodiscard]] std::size_t queued_count() const { return _queue.size(); }
+    [[nodiscard]] uint64_t dropped_count() const { return _dropped; }
+
+    // Bytes a message takes on the wire once fragmented.
+    static std::size_t wire_bytes(std::size_t size);
+
+    // The RTCM 3 message type, if data starts with an RTCM 3 frame.
+    static std::optional<uint16_t> message_type(const std::string& data);
+
+private:
+    struct Queued {
+        std::string data{};
+        std::optional<uint16_t> type{};
+        double queued_s{0.0};
+    };
+
+    void refill(double now_s);
+    [[nodiscard]] double max_budget_bytes() const;
+
+    std::deque<Queued> _queue{};
+    std::size_t _queued_bytes{0};
+
+    double _bytes_per_s{0.0};
+    double _max_age_s{DEFAULT_MAX_AGE_S};
+    double _budget_bytes{0.0};
+    std::optional<double> _refilled_s{};
+    uint64_t _dropped{0};
+};
+
+} // namespace mavsdk
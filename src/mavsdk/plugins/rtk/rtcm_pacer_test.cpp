@@ -0,0 +1,117 @@
+#include "rtcm_pacer.h"
+
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+// An RTCM 3 frame of the given type, padded to size.
+std::string rtcm_frame(uint16_t type, std::size_t size = 100, char fill = 0)
+{
+    std::string frame(size, fill);
+    frame[0] = static_cast<char>(0xD3);
+    frame[1] = 0;
+    frame[2] = static_cast<char>(size - 6);
+    frame[3] = static_cast<char>(type >> 4);
+    frame[4] = static_cast<char>((type & 0xf) << 4);
+    return frame;
+}
+} // namespace
+
+TEST(RtcmPacer, ParsesMessageType)
+{
+    EXPECT_EQ(RtcmPacer::message_type(rtcm_frame(1005)), 1005);
+    EXPECT_EQ(RtcmPacer::message_type(rtcm_frame(1077)), 1077);
+    EXPECT_FALSE(RtcmPacer::message_type("not rtcm"));
+    EXPECT_FALSE(RtcmPacer::message_type(std::string(3, static_cast<char>(0xD3))));
+}
+
+TEST(RtcmPacer, WireBytesCountFragments)
+{
+    EXPECT_EQ(RtcmPacer::wire_bytes(10), 10 + RtcmPacer::FRAGMENT_OVERHEAD_BYTES);
+    EXPECT_EQ(RtcmPacer::wire_bytes(180), 180 + 2 * RtcmPacer::FRAGMENT_OVERHEAD_BYTES);
+    EXPECT_EQ(RtcmPacer::wire_bytes(500), 500 + 3 * RtcmPacer::FRAGMENT_OVERHEAD_BYTES);
+}
+
+TEST(RtcmPacer, UnlimitedSendsEverything)
+{
+    RtcmPacer pacer;
+    pacer.push(rtcm_frame(1074), 0.0);
+    pacer.push(rtcm_frame(1084), 0.0);
+    pacer.push(rtcm_frame(1094), 0.0);
+
+    EXPECT_EQ(pacer.pop_ready(0.0).size(), 3);
+    EXPECT_EQ(pacer.queued_count(), 0);
+    EXPECT_FALSE(pacer.next_ready_in_s(0.0));
+}
+
+TEST(RtcmPacer, KeepsToRate)
+{
+    RtcmPacer pacer;
+    pacer.set_rate(10000.0);
+
+    // 20 messages of 500 bytes are about a second worth.
+    for (int i = 0; i < 20; ++i) {
+        pacer.push(std::string(500, static_cast<char>(i)), 0.0);
+    }
+
+    std::size_t sent_bytes = 0;
+    for (const auto& data : pacer.pop_ready(0.0)) {
+        sent_bytes += RtcmPacer::wire_bytes(data.size());
+    }
+    EXPECT_LE(static_cast<double>(sent_bytes), 2500.0);
+    EXPECT_GT(pacer.queued_count(), 0);
+
+    const auto next_s = pacer.next_ready_in_s(0.0);
+    ASSERT_TRUE(next_s);
+    EXPECT_GT(next_s.value(), 0.0);
+    EXPECT_TRUE(pacer.pop_ready(next_s.value() * 0.5).empty());
+    EXPECT_EQ(pacer.pop_ready(next_s.value()).size(), 1);
+
+    for (const auto& data : pacer.pop_ready(0.5)) {
+        sent_bytes += RtcmPacer::wire_bytes(data.size());
+    }
+    EXPECT_LE(static_cast<double>(sent_bytes), 2500.0 + 0.5 * 10000.0);
+}
+
+TEST(RtcmPacer, NewerMessageOfSameTypeReplacesQueuedOne)
+{
+    RtcmPacer pacer;
+    pacer.set_rate(100.0);
+
+    // The budget only allows the first one to go out right away.
+    pacer.push(rtcm_frame(1074, 700, 'a'), 0.0);
+    EXPECT_EQ(pacer.pop_ready(0.0).size(), 1);
+
+    pacer.push(rtcm_frame(1005, 30, 'a'), 0.1);
+    pacer.push(rtcm_frame(1074, 100, 'a'), 0.1);
+    pacer.push(rtcm_frame(1074, 100, 'b'), 0.2);
+    EXPECT_EQ(pacer.queued_count(), 2);
+    EXPECT_EQ(pacer.dropped_count(), 1);
+
+    const auto ready = pacer.pop_ready(1.9);
+    ASSERT_EQ(ready.size(), 2);
+    EXPECT_EQ(RtcmPacer::message_type(ready[0]), 1005);
+    EXPECT_EQ(ready[1].back(), 'b');
+}
+
+TEST(RtcmPacer, StaleMessagesAreDropped)
+{
+    RtcmPacer pacer;
+    pacer.set_rate(100.0);
+    pacer.set_max_age(1.0);
+
+    pacer.push(rtcm_frame(1074, 700), 0.0);
+    EXPECT_EQ(pacer.pop_ready(0.0).size(), 1);
+
+    // Too much to go out within a second, the oldest ones are dropped.
+    pacer.push(rtcm_frame(1084, 60), 0.0);
+    pacer.push(rtcm_frame(1094, 60), 0.0);
+    pacer.push(rtcm_frame(1124, 60), 0.0);
+    EXPECT_LT(pacer.queued_count(), 3);
+
+    // And the others once they are too old.
+    EXPECT_TRUE(pacer.pop_ready(1.5).empty());
+    EXPECT_EQ(pacer.queued_count(), 0);
+    EXPECT_EQ(pacer.dropped_count(), 3);
+}
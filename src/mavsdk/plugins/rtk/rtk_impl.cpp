@@ -0,0 +1,128 @@
+#include "rtk_impl.h"
+#include "log.h"
+#include "system_impl.h"
+
+#include <algorithm>
+#include <array>
+
+namespace mavsdk {
+
+RtkImpl::RtkImpl(System& system) : PluginImplBase(system)
+{
+    _parent->register_plugin(this);
+}
+
+RtkImpl::RtkImpl(std::shared_ptr<System> system) : PluginImplBase(std::move(system))
+{
+    _parent->register_plugin(this);
+}
+
+RtkImpl::~RtkImpl()
+{
+    _parent->unregister_plugin(this);
+}
+
+void RtkImpl::init() {}
+
+void RtkImpl::deinit()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_send_cookie != nullptr) {
+        _parent->unregister_timeout_handler(_send_cookie);
+        _send_cookie = nullptr;
+    }
+}
+
+void RtkImpl::enable() {}
+
+void RtkImpl::disable() {}
+
+Rtk::Result RtkImpl::send_rtcm_data(const Rtk::RtcmData& rtcm_data)
+{
+    // The last fragment needs to be shorter than a full one to tell the end.
+    if (rtcm_data.data.size() >= MAX_FRAGMENTS * MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN) {
+        return Rtk::Result::TooLong;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _pacer.push(rtcm_data.data, _time.elapsed_s());
+    return send_ready_locked();
+}
+
+void RtkImpl::set_rate_limit(double bytes_per_s)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _pacer.set_rate(bytes_per_s);
+    send_ready_locked();
+}
+
+Rtk::Result RtkImpl::send_ready_locked()
+{
+    const double now_s = _time.elapsed_s();
+
+    _messages.clear();
+    for (const auto& data : _pacer.pop_ready(now_s)) {
+        add_fragments_locked(data);
+    }
+
+    // GPS_RTCM_DATA is not targeted, so this goes out once per connection
+    // and reaches every vehicle, no matter which system this plugin is for.
+    bool sent = true;
+    if (!_messages.empty()) {
+        sent = _parent->send_messages(_messages);
+    }
+
+    // Whatever didn't fit into the budget goes out once it does.
+    const auto next_s = _pacer.next_ready_in_s(now_s);
+    if (next_s && _send_cookie == nullptr) {
+        _parent->register_timeout_handler(
+            [this]() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _send_cookie = nullptr;
+                send_ready_locked();
+            },
+            next_s.value(),
+            &_send_cookie);
+    }
+
+    return sent ? Rtk::Result::Success : Rtk::Result::ConnectionError;
+}
+
+void RtkImpl::add_fragments_locked(const std::string& data)
+{
+    constexpr std::size_t fragment_length = MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN;
+
+    // If the data doesn't fit into one message, it is split into fragments,
+    // with an empty one at the end if the last one is full. All fragments
+    // carry the same sequence ID so they can be put back together.
+    const std::size_t num_fragments = data.size() / fragment_length + 1;
+    const bool is_fragmented = num_fragments > 1;
+
+    for (std::size_t i = 0; i < num_fragments; ++i) {
+        const std::size_t offset = i * fragment_length;
+        const auto length = static_cast<uint8_t>(std::min(fragment_length, data.size() - offset));
+
+        uint8_t flags = is_fragmented ? 1 : 0;
+        flags |= static_cast<uint8_t>((i & 0x3) << 1);
+        flags |= static_cast<uint8_t>((_sequence & 0x1f) << 3);
+
+        std::array<uint8_t, fragment_length> fragment{};
+        std::copy(data.begin() + offset, data.begin() + offset + length, fragment.begin());
+
+        mavlink_message_t message;
+        mavlink_msg_gps_rtcm_data_pack(
+            _parent->get_own_system_id(),
+            _parent->get_own_component_id(),
+            &message,
+            flags,
+            length,
+            fragment.data());
+        _messages.push_back(message);
+    }
+
+    ++_sequence;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "mavlink_include.h"
+#include "mavsdk_time.h"
+#include "plugins/rtk/rtk.h"
+#include "plugin_impl_base.h"
+#include "rtcm_pacer.h"
+#include "system.h"
+
+namespace mavsdk {
+
+class RtkImpl : public PluginImplBase {
+public:
+    explicit RtkImpl(System& system);
+    explicit RtkImpl(std::shared_ptr<System> system);
+    ~RtkImpl() override;
+
+    void init() override;
+    void deinit() override;
+
+    void enable() override;
+    void disable() override;
+
+    Rtk::Result send_rtcm_data(const Rtk::RtcmData& rtcm_data);
+    void set_rate_limit(double bytes_per_s);
+
+    // Non-copyable
+    RtkImpl(const RtkImpl&) = delete;
+    const RtkImpl& operator=(const RtkImpl&) = delete;
+
+private:
+    // Both expect _mutex to be held.
+    Rtk::Result send_ready_locked();
+    void add_fragments_locked(const std::string& data);
+
+    static constexpr std::size_t MAX_FRAGMENTS = 4;
+
+    std::mutex _mutex{};
+    RtcmPacer _pacer{};
+    // Messages ready to go out, kept to reuse their storage.
+    std::vector<mavlink_message_t> _messages{};
+    uint8_t _sequence{0};
+    void* _send_cookie{nullptr};
+    Time _time{};
+};
+
+} // namespace mavsdk
@@ -104,6 +104,28 @@ public:
      */
     void subscribe_receive(ReceiveCallback callback);
 
+    /**
+     * @brief Send raw bytes to the shell, as typed.
+     *
+     * Unlike send(), nothing is appended, so this can be used to pass key presses through, e.g.
+     * to bridge the shell to a terminal.
+     *
+     * @return Result of request.
+     */
+    Result send_bytes(const std::vector<uint8_t>& data) const;
+
+    /**
+     * @brief Callback type for subscribe_receive_bytes.
+     */
+    using ReceiveBytesCallback = std::function<void(std::vector<uint8_t>)>;
+
+    /**
+     * @brief Receive the raw output of the shell, including control characters.
+     *
+     * Output arriving in quick succession is passed on in chunks rather than message by message.
+     */
+    void subscribe_receive_bytes(ReceiveBytesCallback callback);
+
     /**
      * @brief Copy constructor.
      */
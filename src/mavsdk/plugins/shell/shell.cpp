@@ -48,4 +48,14 @@ std::ostream& operator<<(std::ostream& str, Shell::Result const& result)
     }
 }
 
+Shell::Result Shell::send_bytes(const std::vector<uint8_t>& data) const
+{
+    return _impl->send_bytes(data);
+}
+
+void Shell::subscribe_receive_bytes(ReceiveBytesCallback callback)
+{
+    _impl->subscribe_receive_bytes(callback);
+}
+
 } // namespace mavsdk
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "shell_impl.h"
 #include "system.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace mavsdk {
 
 void ShellImpl::init()
@@ -14,6 +17,13 @@ void ShellImpl::init()
 void ShellImpl::deinit()
 {
     _parent->unregister_all_mavlink_message_handlers(this);
+
+    std::lock_guard<std::mutex> lock(_receive.mutex);
+    if (_receive.flush_scheduled) {
+        _parent->unregister_timeout_handler(_receive.flush_cookie);
+        _receive.flush_scheduled = false;
+        _receive.flush_cookie = nullptr;
+    }
 }
 
 void ShellImpl::enable() {}
@@ -37,16 +47,21 @@ ShellImpl::~ShellImpl()
 
 Shell::Result ShellImpl::send(std::string command)
 {
-    if (!_parent->is_connected()) {
-        return Shell::Result::NoSystem;
-    }
-
     // In case a newline at the end of the command is missing, we add it here.
-    if (command.back() != '\n') {
+    if (command.empty() || command.back() != '\n') {
         command.append(1, '\n');
     }
 
-    if (!send_command_message(command)) {
+    return send_bytes(std::vector<uint8_t>(command.begin(), command.end()));
+}
+
+Shell::Result ShellImpl::send_bytes(const std::vector<uint8_t>& data)
+{
+    if (!_parent->is_connected()) {
+        return Shell::Result::NoSystem;
+    }
+
+    if (!send_data(data.data(), data.size())) {
         return Shell::Result::ConnectionError;
     }
 
@@ -57,57 +72,62 @@ void ShellImpl::subscribe_receive(Shell::ReceiveCallback callback)
 {
     std::lock_guard<std::mutex> lock(_receive.mutex);
     _receive.callback = callback;
+    _receive.text.clear();
 }
 
-bool ShellImpl::send_command_message(std::string command)
+void ShellImpl::subscribe_receive_bytes(Shell::ReceiveBytesCallback callback)
 {
-    mavlink_message_t message;
+    std::lock_guard<std::mutex> lock(_receive.mutex);
+    _receive.bytes_callback = callback;
+    _receive.bytes.clear();
+}
+
+bool ShellImpl::send_data(const uint8_t* data, std::size_t len)
+{
+    uint8_t flags = 0;
+    {
+        // We only ask for a reponse if we have subscribed to a response.
+        std::lock_guard<std::mutex> lock(_receive.mutex);
+        if (_receive.callback != nullptr || _receive.bytes_callback != nullptr) {
+            flags |= SERIAL_CONTROL_FLAG_RESPOND;
+        }
+    }
+
+    // SERIAL_CONTROL is not acknowledged, so there is nothing to wait for
+    // between frames. All frames go out in one batch, which is one pass
+    // through the outgoing intercept and the connections rather than one
+    // each.
+    std::vector<mavlink_message_t> messages;
+    messages.reserve(len / MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN + 1);
+
+    std::size_t pos = 0;
+    do {
+        const auto count =
+            std::min<std::size_t>(len - pos, MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN);
+        const bool last = pos + count == len;
 
-    while (command.length() > MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN) {
+        uint8_t frame[MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN]{};
+        memcpy(frame, data + pos, count);
+
+        mavlink_message_t message;
         mavlink_msg_serial_control_pack(
             _parent->get_own_system_id(),
             _parent->get_own_component_id(),
             &message,
             static_cast<uint8_t>(SERIAL_CONTROL_DEV::SERIAL_CONTROL_DEV_SHELL),
-            0,
+            last ? flags : 0,
             timeout_ms,
             0,
-            static_cast<uint8_t>(MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN),
-            reinterpret_cast<const uint8_t*>(command.c_str()),
+            static_cast<uint8_t>(count),
+            frame,
             _parent->get_system_id(),
             _parent->get_autopilot_id());
-        command.erase(0, MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN);
-        if (!_parent->send_message(message)) {
-            return false;
-        }
-    }
+        messages.push_back(message);
 
-    uint8_t flags = 0;
-    {
-        // We only ask for a reponse if we have subscribed to a response.
-        std::lock_guard<std::mutex> lock(_receive.mutex);
-        if (_receive.callback != nullptr) {
-            flags |= SERIAL_CONTROL_FLAG_RESPOND;
-        }
-    }
+        pos += count;
+    } while (pos < len);
 
-    uint8_t data[MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN]{};
-    memcpy(data, command.c_str(), command.length());
-
-    mavlink_msg_serial_control_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &message,
-        static_cast<uint8_t>(SERIAL_CONTROL_DEV::SERIAL_CONTROL_DEV_SHELL),
-        flags,
-        timeout_ms,
-        0,
-        static_cast<uint8_t>(command.length()),
-        data,
-        _parent->get_system_id(),
-        _parent->get_autopilot_id());
-
-    return _parent->send_message(message);
+    return _parent->send_messages(messages);
 }
 
 void ShellImpl::process_shell_message(const mavlink_message_t& message)
@@ -115,27 +135,67 @@ void ShellImpl::process_shell_message(const mavlink_message_t& message)
     mavlink_serial_control_t serial_control;
     mavlink_msg_serial_control_decode(&message, &serial_control);
 
-    // This adds an additional byte for the null termination.
-    char str_copy[sizeof(serial_control.data) + 1]{0};
-
     const auto len =
         std::min(static_cast<std::size_t>(serial_control.count), sizeof(serial_control.data));
 
-    memcpy(str_copy, serial_control.data, len);
+    std::lock_guard<std::mutex> lock(_receive.mutex);
 
-    std::string response(str_copy);
+    if (_receive.bytes_callback) {
+        _receive.bytes.insert(
+            _receive.bytes.end(), serial_control.data, serial_control.data + len);
+    }
 
-    // For the NuttShell (nsh>) we see these characters being sent but we're not sure
-    // what they are for, so we're removing them for now.
-    auto index = response.find({32, 27, '[', 'K'});
-    if (index != std::string::npos) {
-        response.erase(index, 4);
+    if (_receive.callback) {
+        // The text ends at the first null, if any.
+        const auto* begin = reinterpret_cast<const char*>(serial_control.data);
+        std::string response(begin, std::find(begin, begin + len, '\0'));
+
+        // For the NuttShell (nsh>) we see these characters being sent but we're not sure
+        // what they are for, so we're removing them for now.
+        auto index = response.find({32, 27, '[', 'K'});
+        if (index != std::string::npos) {
+            response.erase(index, 4);
+        }
+
+        _receive.text += response;
     }
 
+    if (_receive.text.size() >= RECEIVE_CHUNK_SIZE ||
+        _receive.bytes.size() >= RECEIVE_CHUNK_SIZE) {
+        // A scheduled flush is left in place, it then finds less or nothing
+        // to do.
+        flush_received_locked();
+    } else if (!_receive.flush_scheduled && (!_receive.text.empty() || !_receive.bytes.empty())) {
+        _receive.flush_scheduled = true;
+        _parent->register_timeout_handler(
+            [this]() { flush_received(); }, RECEIVE_LATENCY_S, &_receive.flush_cookie);
+    }
+}
+
+void ShellImpl::flush_received()
+{
     std::lock_guard<std::mutex> lock(_receive.mutex);
-    if (_receive.callback) {
-        const auto temp_callback = _receive.callback;
-        _parent->call_user_callback([temp_callback, response]() { temp_callback(response); });
+    _receive.flush_scheduled = false;
+    _receive.flush_cookie = nullptr;
+    flush_received_locked();
+}
+
+void ShellImpl::flush_received_locked()
+{
+    if (_receive.callback && !_receive.text.empty()) {
+        _parent->call_user_callback(
+            [callback = _receive.callback, text = std::move(_receive.text)]() mutable {
+                callback(std::move(text));
+            });
+        _receive.text.clear();
+    }
+
+    if (_receive.bytes_callback && !_receive.bytes.empty()) {
+        _parent->call_user_callback(
+            [callback = _receive.bytes_callback, bytes = std::move(_receive.bytes)]() mutable {
+                callback(std::move(bytes));
+            });
+        _receive.bytes.clear();
     }
 }
 
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <mutex>
+#include <string>
+#include <vector>
 
 #include "plugins/shell/shell.h"
 #include "mavlink_include.h"
@@ -25,19 +29,33 @@ public:
 
     Shell::Result send(std::string command);
     void subscribe_receive(Shell::ReceiveCallback callback);
+    Shell::Result send_bytes(const std::vector<uint8_t>& data);
+    void subscribe_receive_bytes(Shell::ReceiveBytesCallback callback);
 
     ShellImpl(const ShellImpl&) = delete;
     ShellImpl& operator=(const ShellImpl&) = delete;
 
 private:
-    bool send_command_message(std::string command);
+    bool send_data(const uint8_t* data, std::size_t len);
     void process_shell_message(const mavlink_message_t& message);
+    void flush_received();
+    void flush_received_locked();
 
     static constexpr uint16_t timeout_ms = 1000;
 
+    // Received output is collected until there is this much of it, or until
+    // the latency since the first byte collected is reached.
+    static constexpr std::size_t RECEIVE_CHUNK_SIZE = 1024;
+    static constexpr double RECEIVE_LATENCY_S = 0.02;
+
     struct {
         std::mutex mutex{};
         Shell::ReceiveCallback callback{nullptr};
+        Shell::ReceiveBytesCallback bytes_callback{nullptr};
+        std::string text{};
+        std::vector<uint8_t> bytes{};
+        bool flush_scheduled{false};
+        void* flush_cookie{nullptr};
     } _receive{};
 };
 } // namespace mavsdk
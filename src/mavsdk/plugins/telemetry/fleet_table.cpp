@@ -0,0 +1,290 @@
+#include "fleet_table.h"
+#include "geometry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace mavsdk {
+
+FleetTable& FleetTable::instance()
+{
+    static FleetTable table;
+    return table;
+}
+
+template<typename F> void FleetTable::write(std::size_t row, F&& func)
+{
+    auto& generation = _generations[row];
+    uint64_t current = generation.load(std::memory_order_relaxed);
+    while (true) {
+        if ((current & 1) != 0) {
+            // Another decoder of this vehicle is writing.
+            std::this_thread::yield();
+            current = generation.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (generation.compare_exchange_weak(
+                current, current + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    func();
+    generation.store(current + 2, std::memory_order_release);
+}
+
+std::optional<std::size_t> FleetTable::add(uint8_t system_id)
+{
+    std::lock_guard<std::mutex> lock(_rows_mutex);
+
+    for (std::size_t row = 0; row < CAPACITY; ++row) {
+        if (_used[row].load(std::memory_order_relaxed)) {
+            continue;
+        }
+
+        write(row, [&]() {
+            _system_ids[row].store(system_id, std::memory_order_relaxed);
+            _latitude_deg[row].store(double(NAN), std::memory_order_relaxed);
+            _longitude_deg[row].store(double(NAN), std::memory_order_relaxed);
+            _absolute_altitude_m[row].store(float(NAN), std::memory_order_relaxed);
+            _relative_altitude_m[row].store(float(NAN), std::memory_order_relaxed);
+            _roll_deg[row].store(float(NAN), std::memory_order_relaxed);
+            _pitch_deg[row].store(float(NAN), std::memory_order_relaxed);
+            _yaw_deg[row].store(float(NAN), std::memory_order_relaxed);
+            _attitude_timestamp_us[row].store(0, std::memory_order_relaxed);
+            _battery_id[row].store(0, std::memory_order_relaxed);
+            _battery_voltage_v[row].store(float(NAN), std::memory_order_relaxed);
+            _battery_remaining_percent[row].store(float(NAN), std::memory_order_relaxed);
+            _flight_modes[row].store(Telemetry::FlightMode::Unknown, std::memory_order_relaxed);
+        });
+        _used[row].store(true, std::memory_order_release);
+
+        if (_rows_end.load(std::memory_order_relaxed) <= row) {
+            _rows_end.store(row + 1, std::memory_order_release);
+        }
+        return row;
+    }
+    return std::nullopt;
+}
+
+void FleetTable::remove(std::size_t row)
+{
+    std::lock_guard<std::mutex> lock(_rows_mutex);
+    _used[row].store(false, std::memory_order_release);
+}
+
+void FleetTable::set_position(std::size_t row, const Telemetry::Position& position)
+{
+    write(row, [&]() {
+        _latitude_deg[row].store(position.latitude_deg, std::memory_order_relaxed);
+        _longitude_deg[row].store(position.longitude_deg, std::memory_order_relaxed);
+        _absolute_altitude_m[row].store(position.absolute_altitude_m, std::memory_order_relaxed);
+        _relative_altitude_m[row].store(position.relative_altitude_m, std::memory_order_relaxed);
+    });
+}
+
+void FleetTable::set_attitude_euler(std::size_t row, const Telemetry::EulerAngle& attitude_euler)
+{
+    write(row, [&]() {
+        _roll_deg[row].store(attitude_euler.roll_deg, std::memory_order_relaxed);
+        _pitch_deg[row].store(attitude_euler.pitch_deg, std::memory_order_relaxed);
+        _yaw_deg[row].store(attitude_euler.yaw_deg, std::memory_order_relaxed);
+        _attitude_timestamp_us[row].store(attitude_euler.timestamp_us, std::memory_order_relaxed);
+    });
+}
+
+void FleetTable::set_battery(std::size_t row, const Telemetry::Battery& battery)
+{
+    write(row, [&]() {
+        _battery_id[row].store(battery.id, std::memory_order_relaxed);
+        _battery_voltage_v[row].store(battery.voltage_v, std::memory_order_relaxed);
+        _battery_remaining_percent[row].store(
+            battery.remaining_percent, std::memory_order_relaxed);
+    });
+}
+
+void FleetTable::set_flight_mode(std::size_t row, Telemetry::FlightMode flight_mode)
+{
+    write(row, [&]() { _flight_modes[row].store(flight_mode, std::memory_order_relaxed); });
+}
+
+void FleetTable::snapshot(Telemetry::FleetSnapshot& snapshot) const
+{
+    snapshot.system_ids.clear();
+    snapshot.generations.clear();
+    snapshot.positions.clear();
+    snapshot.attitudes_euler.clear();
+    snapshot.batteries.clear();
+    snapshot.flight_modes.clear();
+
+    const std::size_t rows_end = _rows_end.load(std::memory_order_acquire);
+    for (std::size_t row = 0; row < rows_end; ++row) {
+        if (!_used[row].load(std::memory_order_acquire)) {
+            continue;
+        }
+
+        uint8_t system_id;
+        Telemetry::Position position;
+        Telemetry::EulerAngle attitude_euler;
+        Telemetry::Battery battery;
+        Telemetry::FlightMode flight_mode;
+        uint64_t generation;
+
+        while (true) {
+            generation = _generations[row].load(std::memory_order_acquire);
+            if ((generation & 1) != 0) {
+                // A write is in progress.
+                std::this_thread::yield();
+                continue;
+            }
+            system_id = _system_ids[row].load(std::memory_order_relaxed);
+            position.latitude_deg = _latitude_deg[row].load(std::memory_order_relaxed);
+            position.longitude_deg = _longitude_deg[row].load(std::memory_order_relaxed);
+            position.absolute_altitude_m =
+                _absolute_altitude_m[row].load(std::memory_order_relaxed);
+            position.relative_altitude_m =
+                _relative_altitude_m[row].load(std::memory_order_relaxed);
+            attitude_euler.roll_deg = _roll_deg[row].load(std::memory_order_relaxed);
+            attitude_euler.pitch_deg = _pitch_deg[row].load(std::memory_order_relaxed);
+            attitude_euler.yaw_deg = _yaw_deg[row].load(std::memory_order_relaxed);
+            attitude_euler.timestamp_us =
+                _attitude_timestamp_us[row].load(std::memory_order_relaxed);
+            battery.id = _battery_id[row].load(std::memory_order_relaxed);
+            battery.voltage_v = _battery_voltage_v[row].load(std::memory_order_relaxed);
+            battery.remaining_percent =
+                _battery_remaining_percent[row].load(std::memory_order_relaxed);
+            flight_mode = _flight_modes[row].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_generations[row].load(std::memory_order_relaxed) == generation) {
+                break;
+            }
+        }
+
+        snapshot.system_ids.push_back(system_id);
+        snapshot.generations.push_back(generation / 2);
+        snapshot.positions.push_back(position);
+        snapshot.attitudes_euler.push_back(attitude_euler);
+        snapshot.batteries.push_back(battery);
+        snapshot.flight_modes.push_back(flight_mode);
+    }
+}
+
+namespace {
+struct GridEntry {
+    uint64_t cell;
+    std::size_t index;
+    double north_m;
+    double east_m;
+};
+
+int32_t cell_coordinate(double position_m, double cell_size_m)
+{
+    const double cell = std::floor(position_m / cell_size_m);
+    return static_cast<int32_t>(std::clamp(
+        cell,
+        static_cast<double>(std::numeric_limits<int32_t>::min()),
+        static_cast<double>(std::numeric_limits<int32_t>::max())));
+}
+
+uint64_t cell_key(int64_t north, int64_t east)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(north)) << 32) |
+           static_cast<uint32_t>(east);
+}
+} // namespace
+
+void FleetTable::pairs_within(
+    const Telemetry::FleetSnapshot& snapshot,
+    double distance_m,
+    std::vector<Telemetry::FleetPair>& pairs)
+{
+    pairs.clear();
+    if (!(distance_m > 0.0)) {
+        return;
+    }
+
+    const auto& positions = snapshot.positions;
+    const auto has_position = [](const Telemetry::Position& position) {
+        return std::isfinite(position.latitude_deg) && std::isfinite(position.longitude_deg);
+    };
+
+    const auto reference = std::find_if(positions.begin(), positions.end(), has_position);
+    if (reference == positions.end()) {
+        return;
+    }
+
+    // A local projection is good enough for vehicles close enough to each
+    // other to matter, the ones far apart end up in distant cells anyway.
+    const geometry::CoordinateTransformation transformation(
+        {reference->latitude_deg, reference->longitude_deg});
+
+    // Kept around so repeated queries don't allocate.
+    static thread_local std::vector<GridEntry> grid;
+    grid.clear();
+
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        if (!has_position(positions[i])) {
+            continue;
+        }
+        const auto local = transformation.local_from_global(
+            {positions[i].latitude_deg, positions[i].longitude_deg});
+        grid.push_back(GridEntry{
+            cell_key(
+                cell_coordinate(local.north_m, distance_m),
+                cell_coordinate(local.east_m, distance_m)),
+            i,
+            local.north_m,
+            local.east_m});
+    }
+
+    std::sort(grid.begin(), grid.end(), [](const GridEntry& lhs, const GridEntry& rhs) {
+        return lhs.cell < rhs.cell;
+    });
+
+    for (const auto& entry : grid) {
+        const auto north = static_cast<int32_t>(entry.cell >> 32);
+        const auto east = static_cast<int32_t>(entry.cell & 0xffffffff);
+
+        for (int64_t d_north = -1; d_north <= 1; ++d_north) {
+            for (int64_t d_east = -1; d_east <= 1; ++d_east) {
+                const auto key = cell_key(north + d_north, east + d_east);
+                const auto range = std::equal_range(
+                    grid.begin(),
+                    grid.end(),
+                    GridEntry{key, 0, 0.0, 0.0},
+                    [](const GridEntry& lhs, const GridEntry& rhs) {
+                        return lhs.cell < rhs.cell;
+                    });
+
+                for (auto other = range.first; other != range.second; ++other) {
+                    // Each pair only once.
+                    if (other->index <= entry.index) {
+                        continue;
+                    }
+                    const double altitude_a = positions[entry.index].absolute_altitude_m;
+                    const double altitude_b = positions[other->index].absolute_altitude_m;
+                    const double d_up = (std::isfinite(altitude_a) && std::isfinite(altitude_b)) ?
+                                            altitude_b - altitude_a :
+                                            0.0;
+                    const double distance = std::sqrt(
+                        (other->north_m - entry.north_m) * (other->north_m - entry.north_m) +
+                        (other->east_m - entry.east_m) * (other->east_m - entry.east_m) +
+                        d_up * d_up);
+                    if (distance < distance_m) {
+                        pairs.push_back(
+                            Telemetry::FleetPair{entry.index, other->index, distance});
+                    }
+                }
+            }
+        }
+    }
+
+    std::sort(pairs.begin(), pairs.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first_index != rhs.first_index ? lhs.first_index < rhs.first_index :
+                                                    lhs.second_index < rhs.second_index;
+    });
+}
+
+} // namespace mavsdk
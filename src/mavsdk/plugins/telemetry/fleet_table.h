@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "plugins/telemetry/telemetry.h"
+
+namespace mavsdk {
+
+// Core fields of all vehicles with a Telemetry plugin, one row per vehicle,
+// with each field in a contiguous array across all rows, so a ground
+// station showing a whole fleet can read it in one go instead of asking
+// every plugin for every field.
+//
+// Each row has its own generation count, which works as a sequence lock:
+// it is odd while the row is written, and readers copy the row without
+// taking a lock and retry if the count changed in the meantime. Writers of
+// the same row, the decoders of one vehicle, are serialized on it.
+class FleetTable {
+public:
+    static constexpr std::size_t CAPACITY = 256;
+
+    static FleetTable& instance();
+
+    FleetTable() = default;
+    ~FleetTable() = default;
+
+    // Non-copyable
+    FleetTable(const FleetTable&) = delete;
+    const FleetTable& operator=(const FleetTable&) = delete;
+
+    // Returns the row for a vehicle, or nullopt if the table is full.
+    std::optional<std::size_t> add(uint8_t system_id);
+    void remove(std::size_t row);
+
+    void set_position(std::size_t row, const Telemetry::Position& position);
+    void set_attitude_euler(std::size_t row, const Telemetry::EulerAngle& attitude_euler);
+    void set_battery(std::size_t row, const Telemetry::Battery& battery);
+    void set_flight_mode(std::size_t row, Telemetry::FlightMode flight_mode);
+
+    // Replaces what is in snapshot, reusing its storage.
+    void snapshot(Telemetry::FleetSnapshot& snapshot) const;
+
+    // All pairs of vehicles in the snapshot closer than distance_m to each
+    // other, using a grid of cells as large as the distance so only
+    // vehicles in neighbouring cells are compared. Vehicles without a
+    // position are left out.
+    static void pairs_within(
+        const Telemetry::FleetSnapshot& snapshot,
+        double distance_m,
+        std::vector<Telemetry::FleetPair>& pairs);
+
+private:
+    template<typename F> void write(std::size_t row, F&& func);
+
+    std::array<std::atomic<uint64_t>, CAPACITY> _generations{};
+    std::array<std::atomic<bool>, CAPACITY> _used{};
+    std::array<std::atomic<uint8_t>, CAPACITY> _system_ids{};
+
+    std::array<std::atomic<double>, CAPACITY> _latitude_deg{};
+    std::array<std::atomic<double>, CAPACITY> _longitude_deg{};
+    std::array<std::atomic<float>, CAPACITY> _absolute_altitude_m{};
+    std::array<std::atomic<float>, CAPACITY> _relative_altitude_m{};
+
+    std::array<std::atomic<float>, CAPACITY> _roll_deg{};
+    std::array<std::atomic<float>, CAPACITY> _pitch_deg{};
+    std::array<std::atomic<float>, CAPACITY> _yaw_deg{};
+    std::array<std::atomic<uint64_t>, CAPACITY> _attitude_timestamp_us{};
+
+    std::array<std::atomic<uint32_t>, CAPACITY> _battery_id{};
+    std::array<std::atomic<float>, CAPACITY> _battery_voltage_v{};
+    std::array<std::atomic<float>, CAPACITY> _battery_remaining_percent{};
+
+    std::array<std::atomic<Telemetry::FlightMode>, CAPACITY> _flight_modes{};
+
+    // One past the last row ever used, so snapshots don't scan all rows.
+    std::atomic<std::size_t> _rows_end{0};
+    std::mutex _rows_mutex{};
+};
+
+} // namespace mavsdk
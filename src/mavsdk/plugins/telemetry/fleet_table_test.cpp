@@ -0,0 +1,154 @@
+#include "fleet_table.h"
+
+#include <atomic>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace mavsdk;
+
+TEST(FleetTable, SnapshotHasAllVehicles)
+{
+    FleetTable table;
+    const auto row_a = table.add(1);
+    const auto row_b = table.add(2);
+    ASSERT_TRUE(row_a);
+    ASSERT_TRUE(row_b);
+
+    Telemetry::Position position;
+    position.latitude_deg = 47.39;
+    position.longitude_deg = 8.54;
+    position.absolute_altitude_m = 500.0f;
+    position.relative_altitude_m = 10.0f;
+    table.set_position(*row_b, position);
+    table.set_flight_mode(*row_b, Telemetry::FlightMode::Hold);
+
+    Telemetry::FleetSnapshot snapshot;
+    table.snapshot(snapshot);
+    ASSERT_EQ(snapshot.system_ids.size(), 2);
+    EXPECT_EQ(snapshot.system_ids[0], 1);
+    EXPECT_EQ(snapshot.system_ids[1], 2);
+    EXPECT_TRUE(std::isnan(snapshot.positions[0].latitude_deg));
+    EXPECT_EQ(snapshot.flight_modes[0], Telemetry::FlightMode::Unknown);
+    EXPECT_DOUBLE_EQ(snapshot.positions[1].latitude_deg, 47.39);
+    EXPECT_FLOAT_EQ(snapshot.positions[1].relative_altitude_m, 10.0f);
+    EXPECT_EQ(snapshot.flight_modes[1], Telemetry::FlightMode::Hold);
+    EXPECT_LT(snapshot.generations[0], snapshot.generations[1]);
+}
+
+TEST(FleetTable, GenerationCountsUpdates)
+{
+    FleetTable table;
+    const auto row = table.add(1);
+    ASSERT_TRUE(row);
+
+    Telemetry::FleetSnapshot snapshot;
+    table.snapshot(snapshot);
+    const auto before = snapshot.generations.at(0);
+
+    table.set_battery(*row, Telemetry::Battery{0, 12.0f, 0.5f});
+    table.set_attitude_euler(*row, Telemetry::EulerAngle{1.0f, 2.0f, 3.0f, 42});
+    table.snapshot(snapshot);
+    EXPECT_EQ(snapshot.generations.at(0), before + 2);
+    EXPECT_FLOAT_EQ(snapshot.batteries.at(0).voltage_v, 12.0f);
+    EXPECT_FLOAT_EQ(snapshot.attitudes_euler.at(0).yaw_deg, 3.0f);
+    EXPECT_EQ(snapshot.attitudes_euler.at(0).timestamp_us, 42);
+}
+
+TEST(FleetTable, RemovedRowsAreReused)
+{
+    FleetTable table;
+    const auto row_a = table.add(1);
+    const auto row_b = table.add(2);
+    ASSERT_TRUE(row_a);
+    ASSERT_TRUE(row_b);
+
+    table.remove(*row_a);
+    Telemetry::FleetSnapshot snapshot;
+    table.snapshot(snapshot);
+    ASSERT_EQ(snapshot.system_ids.size(), 1);
+    EXPECT_EQ(snapshot.system_ids[0], 2);
+
+    const auto row_c = table.add(3);
+    ASSERT_TRUE(row_c);
+    EXPECT_EQ(*row_c, *row_a);
+}
+
+TEST(FleetTable, FullTable)
+{
+    FleetTable table;
+    for (std::size_t i = 0; i < FleetTable::CAPACITY; ++i) {
+        ASSERT_TRUE(table.add(static_cast<uint8_t>(i)));
+    }
+    EXPECT_FALSE(table.add(0));
+}
+
+TEST(FleetTable, PairsWithin)
+{
+    Telemetry::FleetSnapshot snapshot;
+    const auto add = [&](double north_m, double east_m, float altitude_m) {
+        Telemetry::Position position;
+        // Roughly metres at this latitude, close enough for the test.
+        position.latitude_deg = 47.0 + north_m / 111195.0;
+        position.longitude_deg = 8.0 + east_m / (111195.0 * std::cos(47.0 * M_PI / 180.0));
+        position.absolute_altitude_m = altitude_m;
+        snapshot.positions.push_back(position);
+    };
+    add(0.0, 0.0, 500.0f);
+    add(3.0, 4.0, 500.0f); // 5 m from the first
+    add(1000.0, 0.0, 500.0f); // far away
+    add(0.0, 0.0, 520.0f); // right above the first
+    snapshot.positions.push_back(Telemetry::Position{}); // no position
+    add(1003.0, 0.0, 500.0f); // 3 m from the far one
+
+    std::vector<Telemetry::FleetPair> pairs;
+    FleetTable::pairs_within(snapshot, 10.0, pairs);
+    ASSERT_EQ(pairs.size(), 2);
+    EXPECT_EQ(pairs[0].first_index, 0);
+    EXPECT_EQ(pairs[0].second_index, 1);
+    EXPECT_NEAR(pairs[0].distance_m, 5.0, 0.1);
+    EXPECT_EQ(pairs[1].first_index, 2);
+    EXPECT_EQ(pairs[1].second_index, 5);
+    EXPECT_NEAR(pairs[1].distance_m, 3.0, 0.1);
+
+    FleetTable::pairs_within(snapshot, 25.0, pairs);
+    ASSERT_EQ(pairs.size(), 4);
+    EXPECT_EQ(pairs[1].first_index, 0);
+    EXPECT_EQ(pairs[1].second_index, 3);
+    EXPECT_NEAR(pairs[1].distance_m, 20.0, 0.1);
+    EXPECT_EQ(pairs[2].first_index, 1);
+    EXPECT_EQ(pairs[2].second_index, 3);
+}
+
+TEST(FleetTable, SnapshotIsConsistentWhileWritten)
+{
+    FleetTable table;
+    const auto row = table.add(1);
+    ASSERT_TRUE(row);
+
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        for (int i = 0; i < 20000; ++i) {
+            const double value = i;
+            Telemetry::Position position;
+            position.latitude_deg = value;
+            position.longitude_deg = value;
+            position.absolute_altitude_m = static_cast<float>(value);
+            position.relative_altitude_m = static_cast<float>(value);
+            table.set_position(*row, position);
+        }
+        done = true;
+    });
+
+    Telemetry::FleetSnapshot snapshot;
+    while (!done) {
+        table.snapshot(snapshot);
+        ASSERT_EQ(snapshot.positions.size(), 1);
+        const auto& position = snapshot.positions[0];
+        if (!std::isnan(position.latitude_deg)) {
+            EXPECT_EQ(position.latitude_deg, position.longitude_deg);
+            EXPECT_EQ(static_cast<float>(position.latitude_deg), position.relative_altitude_m);
+        }
+    }
+    writer.join();
+}
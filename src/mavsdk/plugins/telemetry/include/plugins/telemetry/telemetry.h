@@ -13,7 +13,12 @@
 #include <utility>
 #include <vector>
 
+#include "mavsdk/handle.h"
+#include "mavsdk/inline_vector.h"
 #include "mavsdk/plugin_base.h"
+#include "mavsdk/subscription_options.h"
+
+#include <optional>
 
 namespace mavsdk {
 
@@ -474,7 +479,7 @@ public:
     struct ActuatorControlTarget {
         int32_t group{0}; /**< @brief An actuator control group is e.g. 'attitude' for the core
                              flight controls, or 'gimbal' for a payload. */
-        std::vector<float>
+        InlineVector<float, 8>
             controls{}; /**< @brief Controls normed from -1 to 1, where 0 is neutral position. */
     };
 
@@ -499,7 +504,7 @@ public:
      */
     struct ActuatorOutputStatus {
         uint32_t active{0}; /**< @brief Active outputs */
-        std::vector<float> actuator{}; /**< @brief Servo/motor output values */
+        InlineVector<float, 32> actuator{}; /**< @brief Servo/motor output values */
     };
 
     /**
@@ -526,7 +531,7 @@ public:
      * Set first to NaN if unknown.
      */
     struct Covariance {
-        std::vector<float>
+        InlineVector<float, 21>
             covariance_matrix{}; /**< @brief Representation of a covariance matrix. */
     };
 
@@ -976,6 +981,237 @@ public:
      */
     friend std::ostream& operator<<(std::ostream& str, Telemetry::Result const& result);
 
+    /**
+     * @brief Fields of a `Telemetry::Snapshot`, to be combined into a bitmask.
+     */
+    struct SnapshotField {
+        static constexpr uint32_t Position = 1 << 0; /**< @brief Global position. */
+        static constexpr uint32_t Heading = 1 << 1; /**< @brief Heading. */
+        static constexpr uint32_t VelocityNed = 1 << 2; /**< @brief Velocity in NED. */
+        static constexpr uint32_t PositionVelocityNed =
+            1 << 3; /**< @brief Local position and velocity NED. */
+        static constexpr uint32_t AttitudeQuaternion = 1 << 4; /**< @brief Attitude. */
+        static constexpr uint32_t AttitudeAngularVelocityBody =
+            1 << 5; /**< @brief Angular velocity. */
+        static constexpr uint32_t Imu = 1 << 6; /**< @brief IMU (HIGHRES_IMU). */
+        static constexpr uint32_t ScaledImu = 1 << 7; /**< @brief Scaled IMU. */
+        static constexpr uint32_t RawImu = 1 << 8; /**< @brief Raw IMU. */
+        static constexpr uint32_t GroundTruth = 1 << 9; /**< @brief Ground truth. */
+        static constexpr uint32_t All = (1 << 10) - 1; /**< @brief All fields. */
+    };
+
+    /**
+     * @brief Set of telemetry fields which were all read at the same point in time.
+     *
+     * Each field comes with the time it was received at, in microseconds of the
+     * monotonic clock, so fields from different messages can be aligned.
+     *
+     * Once the vehicle clock is synced using `System::enable_timesync()`, position,
+     * velocity, attitude and IMU carry the time they were sampled at on the vehicle
+     * instead, mapped to the same clock with `System::to_local_time()`.
+     */
+    struct Snapshot {
+        uint32_t fields{}; /**< @brief Fields contained (bitmask of `SnapshotField`), fields never
+                              received are not set */
+        Position position{}; /**< @brief Global position */
+        uint64_t position_receive_time_us{}; /**< @brief Receive time of position */
+        Heading heading{}; /**< @brief Heading */
+        uint64_t heading_receive_time_us{}; /**< @brief Receive time of heading */
+        VelocityNed velocity_ned{}; /**< @brief Velocity in NED */
+        uint64_t velocity_ned_receive_time_us{}; /**< @brief Receive time of velocity NED */
+        PositionVelocityNed position_velocity_ned{}; /**< @brief Local position and velocity */
+        uint64_t position_velocity_ned_receive_time_us{}; /**< @brief Receive time of position
+                                                             velocity NED */
+        Quaternion attitude_quaternion{}; /**< @brief Attitude as quaternion */
+        uint64_t attitude_quaternion_receive_time_us{}; /**< @brief Receive time of attitude */
+        AngularVelocityBody attitude_angular_velocity_body{}; /**< @brief Angular velocity */
+        uint64_t attitude_angular_velocity_body_receive_time_us{}; /**< @brief Receive time of
+                                                                      angular velocity */
+        Imu imu{}; /**< @brief IMU (HIGHRES_IMU) */
+        uint64_t imu_receive_time_us{}; /**< @brief Receive time of IMU */
+        Imu scaled_imu{}; /**< @brief Scaled IMU */
+        uint64_t scaled_imu_receive_time_us{}; /**< @brief Receive time of scaled IMU */
+        Imu raw_imu{}; /**< @brief Raw IMU */
+        uint64_t raw_imu_receive_time_us{}; /**< @brief Receive time of raw IMU */
+        GroundTruth ground_truth{}; /**< @brief Ground truth */
+        uint64_t ground_truth_receive_time_us{}; /**< @brief Receive time of ground truth */
+    };
+
+    /**
+     * @brief Equal operator to compare two `Telemetry::Snapshot` objects.
+     *
+     * @return `true` if items are equal.
+     */
+    friend bool operator==(const Telemetry::Snapshot& lhs, const Telemetry::Snapshot& rhs);
+
+    /**
+     * @brief Stream operator to print information about a `Telemetry::Snapshot`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream& operator<<(std::ostream& str, Telemetry::Snapshot const& snapshot);
+
+    /**
+     * @brief Telemetry topics whose update rate can be set, one for each `set_rate_*` function.
+     */
+    enum class RateTopic {
+        Position, /**< @brief See set_rate_position. */
+        Home, /**< @brief See set_rate_home. */
+        InAir, /**< @brief See set_rate_in_air. */
+        LandedState, /**< @brief See set_rate_landed_state. */
+        VtolState, /**< @brief See set_rate_vtol_state. */
+        Attitude, /**< @brief See set_rate_attitude. */
+        CameraAttitude, /**< @brief See set_rate_camera_attitude. */
+        VelocityNed, /**< @brief See set_rate_velocity_ned. */
+        GpsInfo, /**< @brief See set_rate_gps_info. */
+        Battery, /**< @brief See set_rate_battery. */
+        RcStatus, /**< @brief See set_rate_rc_status. */
+        ActuatorControlTarget, /**< @brief See set_rate_actuator_control_target. */
+        ActuatorOutputStatus, /**< @brief See set_rate_actuator_output_status. */
+        Odometry, /**< @brief See set_rate_odometry. */
+        PositionVelocityNed, /**< @brief See set_rate_position_velocity_ned. */
+        GroundTruth, /**< @brief See set_rate_ground_truth. */
+        FixedwingMetrics, /**< @brief See set_rate_fixedwing_metrics. */
+        Imu, /**< @brief See set_rate_imu. */
+        ScaledImu, /**< @brief See set_rate_scaled_imu. */
+        RawImu, /**< @brief See set_rate_raw_imu. */
+        UnixEpochTime, /**< @brief See set_rate_unix_epoch_time. */
+        DistanceSensor, /**< @brief See set_rate_distance_sensor. */
+    };
+
+    /**
+     * @brief Stream operator to print information about a `Telemetry::RateTopic`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream& operator<<(std::ostream& str, Telemetry::RateTopic const& rate_topic);
+
+    /**
+     * @brief Requested rate for one topic, used by set_rates.
+     */
+    struct RateRequest {
+        RateTopic topic{}; /**< @brief Topic to set the rate for */
+        double rate_hz{}; /**< @brief The requested rate (in Hertz) */
+    };
+
+    /**
+     * @brief Equal operator to compare two `Telemetry::RateRequest` objects.
+     *
+     * @return `true` if items are equal.
+     */
+    friend bool operator==(const Telemetry::RateRequest& lhs, const Telemetry::RateRequest& rhs);
+
+    /**
+     * @brief Stream operator to print information about a `Telemetry::RateRequest`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream& operator<<(std::ostream& str, Telemetry::RateRequest const& rate_request);
+
+    /**
+     * @brief Telemetry topics which can keep a history of their samples.
+     */
+    enum class HistoryTopic {
+        Position, /**< @brief Global position. */
+        AttitudeQuaternion, /**< @brief Attitude as quaternion. */
+        VelocityNed, /**< @brief Velocity in NED. */
+        Imu, /**< @brief IMU (HIGHRES_IMU). */
+    };
+
+    /**
+     * @brief Stream operator to print information about a `Telemetry::HistoryTopic`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream&
+    operator<<(std::ostream& str, Telemetry::HistoryTopic const& history_topic);
+
+    /**
+     * @brief Callback type for set_rates_async, with the result of each request.
+     */
+    using SetRatesCallback = std::function<void(Result, std::vector<Result>)>;
+
+    /**
+     * @brief Core fields of all vehicles with a Telemetry plugin, as read by `fleet_snapshot`.
+     *
+     * There is one entry per vehicle at the same index in each vector. Fields a vehicle did
+     * not report yet are NAN, or `FlightMode::Unknown`.
+     */
+    struct FleetSnapshot {
+        std::vector<uint8_t> system_ids{}; /**< @brief System ID of each vehicle */
+        std::vector<uint64_t> generations{}; /**< @brief Number of updates of each vehicle, to
+                                                tell which changed since the last snapshot */
+        std::vector<Position> positions{}; /**< @brief Global position of each vehicle */
+        std::vector<EulerAngle> attitudes_euler{}; /**< @brief Attitude of each vehicle */
+        std::vector<Battery> batteries{}; /**< @brief Battery last reported by each vehicle */
+        std::vector<FlightMode> flight_modes{}; /**< @brief Flight mode of each vehicle */
+    };
+
+    /**
+     * @brief Two vehicles close to each other, as found by `fleet_pairs_within`.
+     */
+    struct FleetPair {
+        std::size_t first_index{0}; /**< @brief Index of the first vehicle in the snapshot */
+        std::size_t second_index{0}; /**< @brief Index of the second vehicle in the snapshot, always
+                                        larger than the first one */
+        double distance_m{0.0}; /**< @brief Distance between them in metres, including altitude */
+    };
+
+    /**
+     * @brief Range a topic's rate is adapted in, used by enable_rate_adaptation.
+     */
+    struct AdaptiveRate {
+        RateTopic topic{}; /**< @brief Topic to adapt the rate of */
+        double min_rate_hz{}; /**< @brief Rate on a congested link (in Hertz) */
+        double max_rate_hz{}; /**< @brief Rate on a good link (in Hertz) */
+    };
+
+    /**
+     * @brief Equal operator to compare two `Telemetry::AdaptiveRate` objects.
+     *
+     * @return `true` if items are equal.
+     */
+    friend bool operator==(const Telemetry::AdaptiveRate& lhs, const Telemetry::AdaptiveRate& rhs);
+
+    /**
+     * @brief Stream operator to print information about a `Telemetry::AdaptiveRate`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream&
+    operator<<(std::ostream& str, Telemetry::AdaptiveRate const& adaptive_rate);
+
+    /**
+     * @brief Configuration of the rate adaptation.
+     */
+    struct RateAdaptationConfig {
+        std::vector<AdaptiveRate> rates{}; /**< @brief Topics to adapt, all others keep
+                                              their rates */
+        double max_loss_rate{0.05}; /**< @brief Share of lost messages, from 0 to 1, above
+                                       which the link counts as congested */
+        double max_rtt_factor{2.0}; /**< @brief How many times the lowest round trip time
+                                       seen the current one may be */
+        double link_bytes_per_s{0.0}; /**< @brief Capacity of the link from the vehicle,
+                                         0 if unknown */
+        double headroom{0.2}; /**< @brief Share of the capacity kept free, from 0 to 1 */
+    };
+
+    /**
+     * @brief Equal operator to compare two `Telemetry::RateAdaptationConfig` objects.
+     *
+     * @return `true` if items are equal.
+     */
+    friend bool operator==(
+        const Telemetry::RateAdaptationConfig& lhs, const Telemetry::RateAdaptationConfig& rhs);
+
+    /**
+     * @brief Stream operator to print information about a `Telemetry::RateAdaptationConfig`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream&
+    operator<<(std::ostream& str, Telemetry::RateAdaptationConfig const& rate_adaptation_config);
+
     /**
      * @brief Callback type for asynchronous Telemetry calls.
      */
@@ -987,10 +1223,22 @@ public:
 
     using PositionCallback = std::function<void(Position)>;
 
+    /**
+     * @brief Handle type for subscribe_position.
+     */
+    using PositionHandle = Handle<Position>;
+
     /**
      * @brief Subscribe to 'position' updates.
      */
-    void subscribe_position(PositionCallback callback);
+    PositionHandle subscribe_position(
+        const PositionCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_position
+     */
+    void unsubscribe_position(PositionHandle handle);
 
     /**
      * @brief Poll for 'Position' (blocking).
@@ -1005,10 +1253,21 @@ public:
 
     using HomeCallback = std::function<void(Position)>;
 
+    /**
+     * @brief Handle type for subscribe_home.
+     */
+    using HomeHandle = Handle<Position>;
+
     /**
      * @brief Subscribe to 'home position' updates.
      */
-    void subscribe_home(HomeCallback callback);
+    HomeHandle subscribe_home(
+        const HomeCallback& callback, const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_home
+     */
+    void unsubscribe_home(HomeHandle handle);
 
     /**
      * @brief Poll for 'Position' (blocking).
@@ -1023,10 +1282,21 @@ public:
 
     using InAirCallback = std::function<void(bool)>;
 
+    /**
+     * @brief Handle type for subscribe_in_air.
+     */
+    using InAirHandle = Handle<bool>;
+
     /**
      * @brief Subscribe to in-air updates.
      */
-    void subscribe_in_air(InAirCallback callback);
+    InAirHandle subscribe_in_air(
+        const InAirCallback& callback, const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_in_air
+     */
+    void unsubscribe_in_air(InAirHandle handle);
 
     /**
      * @brief Poll for 'bool' (blocking).
@@ -1041,10 +1311,22 @@ public:
 
     using LandedStateCallback = std::function<void(LandedState)>;
 
+    /**
+     * @brief Handle type for subscribe_landed_state.
+     */
+    using LandedStateHandle = Handle<LandedState>;
+
     /**
      * @brief Subscribe to landed state updates
      */
-    void subscribe_landed_state(LandedStateCallback callback);
+    LandedStateHandle subscribe_landed_state(
+        const LandedStateCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_landed_state
+     */
+    void unsubscribe_landed_state(LandedStateHandle handle);
 
     /**
      * @brief Poll for 'LandedState' (blocking).
@@ -1059,10 +1341,21 @@ public:
 
     using ArmedCallback = std::function<void(bool)>;
 
+    /**
+     * @brief Handle type for subscribe_armed.
+     */
+    using ArmedHandle = Handle<bool>;
+
     /**
      * @brief Subscribe to armed updates.
      */
-    void subscribe_armed(ArmedCallback callback);
+    ArmedHandle subscribe_armed(
+        const ArmedCallback& callback, const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_armed
+     */
+    void unsubscribe_armed(ArmedHandle handle);
 
     /**
      * @brief Poll for 'bool' (blocking).
@@ -1077,10 +1370,22 @@ public:
 
     using VtolStateCallback = std::function<void(VtolState)>;
 
+    /**
+     * @brief Handle type for subscribe_vtol_state.
+     */
+    using VtolStateHandle = Handle<VtolState>;
+
     /**
      * @brief subscribe to vtol state Updates
      */
-    void subscribe_vtol_state(VtolStateCallback callback);
+    VtolStateHandle subscribe_vtol_state(
+        const VtolStateCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_vtol_state
+     */
+    void unsubscribe_vtol_state(VtolStateHandle handle);
 
     /**
      * @brief Poll for 'VtolState' (blocking).
@@ -1095,10 +1400,22 @@ public:
 
     using AttitudeQuaternionCallback = std::function<void(Quaternion)>;
 
+    /**
+     * @brief Handle type for subscribe_attitude_quaternion.
+     */
+    using AttitudeQuaternionHandle = Handle<Quaternion>;
+
     /**
      * @brief Subscribe to 'attitude' updates (quaternion).
      */
-    void subscribe_attitude_quaternion(AttitudeQuaternionCallback callback);
+    AttitudeQuaternionHandle subscribe_attitude_quaternion(
+        const AttitudeQuaternionCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_attitude_quaternion
+     */
+    void unsubscribe_attitude_quaternion(AttitudeQuaternionHandle handle);
 
     /**
      * @brief Poll for 'Quaternion' (blocking).
@@ -1113,10 +1430,22 @@ public:
 
     using AttitudeEulerCallback = std::function<void(EulerAngle)>;
 
+    /**
+     * @brief Handle type for subscribe_attitude_euler.
+     */
+    using AttitudeEulerHandle = Handle<EulerAngle>;
+
     /**
      * @brief Subscribe to 'attitude' updates (Euler).
      */
-    void subscribe_attitude_euler(AttitudeEulerCallback callback);
+    AttitudeEulerHandle subscribe_attitude_euler(
+        const AttitudeEulerCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_attitude_euler
+     */
+    void unsubscribe_attitude_euler(AttitudeEulerHandle handle);
 
     /**
      * @brief Poll for 'EulerAngle' (blocking).
@@ -1131,10 +1460,22 @@ public:
 
     using AttitudeAngularVelocityBodyCallback = std::function<void(AngularVelocityBody)>;
 
+    /**
+     * @brief Handle type for subscribe_attitude_angular_velocity_body.
+     */
+    using AttitudeAngularVelocityBodyHandle = Handle<AngularVelocityBody>;
+
     /**
      * @brief Subscribe to 'attitude' updates (angular velocity)
      */
-    void subscribe_attitude_angular_velocity_body(AttitudeAngularVelocityBodyCallback callback);
+    AttitudeAngularVelocityBodyHandle subscribe_attitude_angular_velocity_body(
+        const AttitudeAngularVelocityBodyCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_attitude_angular_velocity_body
+     */
+    void unsubscribe_attitude_angular_velocity_body(AttitudeAngularVelocityBodyHandle handle);
 
     /**
      * @brief Poll for 'AngularVelocityBody' (blocking).
@@ -1149,10 +1490,22 @@ public:
 
     using CameraAttitudeQuaternionCallback = std::function<void(Quaternion)>;
 
+    /**
+     * @brief Handle type for subscribe_camera_attitude_quaternion.
+     */
+    using CameraAttitudeQuaternionHandle = Handle<Quaternion>;
+
     /**
      * @brief Subscribe to 'camera attitude' updates (quaternion).
      */
-    void subscribe_camera_attitude_quaternion(CameraAttitudeQuaternionCallback callback);
+    CameraAttitudeQuaternionHandle subscribe_camera_attitude_quaternion(
+        const CameraAttitudeQuaternionCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_camera_attitude_quaternion
+     */
+    void unsubscribe_camera_attitude_quaternion(CameraAttitudeQuaternionHandle handle);
 
     /**
      * @brief Poll for 'Quaternion' (blocking).
@@ -1167,10 +1520,22 @@ public:
 
     using CameraAttitudeEulerCallback = std::function<void(EulerAngle)>;
 
+    /**
+     * @brief Handle type for subscribe_camera_attitude_euler.
+     */
+    using CameraAttitudeEulerHandle = Handle<EulerAngle>;
+
     /**
      * @brief Subscribe to 'camera attitude' updates (Euler).
      */
-    void subscribe_camera_attitude_euler(CameraAttitudeEulerCallback callback);
+    CameraAttitudeEulerHandle subscribe_camera_attitude_euler(
+        const CameraAttitudeEulerCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_camera_attitude_euler
+     */
+    void unsubscribe_camera_attitude_euler(CameraAttitudeEulerHandle handle);
 
     /**
      * @brief Poll for 'EulerAngle' (blocking).
@@ -1185,10 +1550,22 @@ public:
 
     using VelocityNedCallback = std::function<void(VelocityNed)>;
 
+    /**
+     * @brief Handle type for subscribe_velocity_ned.
+     */
+    using VelocityNedHandle = Handle<VelocityNed>;
+
     /**
      * @brief Subscribe to 'ground speed' updates (NED).
      */
-    void subscribe_velocity_ned(VelocityNedCallback callback);
+    VelocityNedHandle subscribe_velocity_ned(
+        const VelocityNedCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_velocity_ned
+     */
+    void unsubscribe_velocity_ned(VelocityNedHandle handle);
 
     /**
      * @brief Poll for 'VelocityNed' (blocking).
@@ -1203,10 +1580,22 @@ public:
 
     using GpsInfoCallback = std::function<void(GpsInfo)>;
 
+    /**
+     * @brief Handle type for subscribe_gps_info.
+     */
+    using GpsInfoHandle = Handle<GpsInfo>;
+
     /**
      * @brief Subscribe to 'GPS info' updates.
      */
-    void subscribe_gps_info(GpsInfoCallback callback);
+    GpsInfoHandle subscribe_gps_info(
+        const GpsInfoCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_gps_info
+     */
+    void unsubscribe_gps_info(GpsInfoHandle handle);
 
     /**
      * @brief Poll for 'GpsInfo' (blocking).
@@ -1221,10 +1610,21 @@ public:
 
     using RawGpsCallback = std::function<void(RawGps)>;
 
+    /**
+     * @brief Handle type for subscribe_raw_gps.
+     */
+    using RawGpsHandle = Handle<RawGps>;
+
     /**
      * @brief Subscribe to 'Raw GPS' updates.
      */
-    void subscribe_raw_gps(RawGpsCallback callback);
+    RawGpsHandle subscribe_raw_gps(
+        const RawGpsCallback& callback, const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_raw_gps
+     */
+    void unsubscribe_raw_gps(RawGpsHandle handle);
 
     /**
      * @brief Poll for 'RawGps' (blocking).
@@ -1239,10 +1639,22 @@ public:
 
     using BatteryCallback = std::function<void(Battery)>;
 
+    /**
+     * @brief Handle type for subscribe_battery.
+     */
+    using BatteryHandle = Handle<Battery>;
+
     /**
      * @brief Subscribe to 'battery' updates.
      */
-    void subscribe_battery(BatteryCallback callback);
+    BatteryHandle subscribe_battery(
+        const BatteryCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_battery
+     */
+    void unsubscribe_battery(BatteryHandle handle);
 
     /**
      * @brief Poll for 'Battery' (blocking).
@@ -1257,10 +1669,22 @@ public:
 
     using FlightModeCallback = std::function<void(FlightMode)>;
 
+    /**
+     * @brief Handle type for subscribe_flight_mode.
+     */
+    using FlightModeHandle = Handle<FlightMode>;
+
     /**
      * @brief Subscribe to 'flight mode' updates.
      */
-    void subscribe_flight_mode(FlightModeCallback callback);
+    FlightModeHandle subscribe_flight_mode(
+        const FlightModeCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_flight_mode
+     */
+    void unsubscribe_flight_mode(FlightModeHandle handle);
 
     /**
      * @brief Poll for 'FlightMode' (blocking).
@@ -1275,10 +1699,21 @@ public:
 
     using HealthCallback = std::function<void(Health)>;
 
+    /**
+     * @brief Handle type for subscribe_health.
+     */
+    using HealthHandle = Handle<Health>;
+
     /**
      * @brief Subscribe to 'health' updates.
      */
-    void subscribe_health(HealthCallback callback);
+    HealthHandle subscribe_health(
+        const HealthCallback& callback, const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_health
+     */
+    void unsubscribe_health(HealthHandle handle);
 
     /**
      * @brief Poll for 'Health' (blocking).
@@ -1293,10 +1728,22 @@ public:
 
     using RcStatusCallback = std::function<void(RcStatus)>;
 
+    /**
+     * @brief Handle type for subscribe_rc_status.
+     */
+    using RcStatusHandle = Handle<RcStatus>;
+
     /**
      * @brief Subscribe to 'RC status' updates.
      */
-    void subscribe_rc_status(RcStatusCallback callback);
+    RcStatusHandle subscribe_rc_status(
+        const RcStatusCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_rc_status
+     */
+    void unsubscribe_rc_status(RcStatusHandle handle);
 
     /**
      * @brief Poll for 'RcStatus' (blocking).
@@ -1311,10 +1758,22 @@ public:
 
     using StatusTextCallback = std::function<void(StatusText)>;
 
+    /**
+     * @brief Handle type for subscribe_status_text.
+     */
+    using StatusTextHandle = Handle<StatusText>;
+
     /**
      * @brief Subscribe to 'status text' updates.
      */
-    void subscribe_status_text(StatusTextCallback callback);
+    StatusTextHandle subscribe_status_text(
+        const StatusTextCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_status_text
+     */
+    void unsubscribe_status_text(StatusTextHandle handle);
 
     /**
      * @brief Poll for 'StatusText' (blocking).
@@ -1329,10 +1788,22 @@ public:
 
     using ActuatorControlTargetCallback = std::function<void(ActuatorControlTarget)>;
 
+    /**
+     * @brief Handle type for subscribe_actuator_control_target.
+     */
+    using ActuatorControlTargetHandle = Handle<ActuatorControlTarget>;
+
     /**
      * @brief Subscribe to 'actuator control target' updates.
      */
-    void subscribe_actuator_control_target(ActuatorControlTargetCallback callback);
+    ActuatorControlTargetHandle subscribe_actuator_control_target(
+        const ActuatorControlTargetCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_actuator_control_target
+     */
+    void unsubscribe_actuator_control_target(ActuatorControlTargetHandle handle);
 
     /**
      * @brief Poll for 'ActuatorControlTarget' (blocking).
@@ -1347,10 +1818,22 @@ public:
 
     using ActuatorOutputStatusCallback = std::function<void(ActuatorOutputStatus)>;
 
+    /**
+     * @brief Handle type for subscribe_actuator_output_status.
+     */
+    using ActuatorOutputStatusHandle = Handle<ActuatorOutputStatus>;
+
     /**
      * @brief Subscribe to 'actuator output status' updates.
      */
-    void subscribe_actuator_output_status(ActuatorOutputStatusCallback callback);
+    ActuatorOutputStatusHandle subscribe_actuator_output_status(
+        const ActuatorOutputStatusCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_actuator_output_status
+     */
+    void unsubscribe_actuator_output_status(ActuatorOutputStatusHandle handle);
 
     /**
      * @brief Poll for 'ActuatorOutputStatus' (blocking).
@@ -1365,10 +1848,22 @@ public:
 
     using OdometryCallback = std::function<void(Odometry)>;
 
+    /**
+     * @brief Handle type for subscribe_odometry.
+     */
+    using OdometryHandle = Handle<Odometry>;
+
     /**
      * @brief Subscribe to 'odometry' updates.
      */
-    void subscribe_odometry(OdometryCallback callback);
+    OdometryHandle subscribe_odometry(
+        const OdometryCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_odometry
+     */
+    void unsubscribe_odometry(OdometryHandle handle);
 
     /**
      * @brief Poll for 'Odometry' (blocking).
@@ -1383,10 +1878,22 @@ public:
 
     using PositionVelocityNedCallback = std::function<void(PositionVelocityNed)>;
 
+    /**
+     * @brief Handle type for subscribe_position_velocity_ned.
+     */
+    using PositionVelocityNedHandle = Handle<PositionVelocityNed>;
+
     /**
      * @brief Subscribe to 'position velocity' updates.
      */
-    void subscribe_position_velocity_ned(PositionVelocityNedCallback callback);
+    PositionVelocityNedHandle subscribe_position_velocity_ned(
+        const PositionVelocityNedCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_position_velocity_ned
+     */
+    void unsubscribe_position_velocity_ned(PositionVelocityNedHandle handle);
 
     /**
      * @brief Poll for 'PositionVelocityNed' (blocking).
@@ -1401,10 +1908,22 @@ public:
 
     using GroundTruthCallback = std::function<void(GroundTruth)>;
 
+    /**
+     * @brief Handle type for subscribe_ground_truth.
+     */
+    using GroundTruthHandle = Handle<GroundTruth>;
+
     /**
      * @brief Subscribe to 'ground truth' updates.
      */
-    void subscribe_ground_truth(GroundTruthCallback callback);
+    GroundTruthHandle subscribe_ground_truth(
+        const GroundTruthCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_ground_truth
+     */
+    void unsubscribe_ground_truth(GroundTruthHandle handle);
 
     /**
      * @brief Poll for 'GroundTruth' (blocking).
@@ -1419,10 +1938,22 @@ public:
 
     using FixedwingMetricsCallback = std::function<void(FixedwingMetrics)>;
 
+    /**
+     * @brief Handle type for subscribe_fixedwing_metrics.
+     */
+    using FixedwingMetricsHandle = Handle<FixedwingMetrics>;
+
     /**
      * @brief Subscribe to 'fixedwing metrics' updates.
      */
-    void subscribe_fixedwing_metrics(FixedwingMetricsCallback callback);
+    FixedwingMetricsHandle subscribe_fixedwing_metrics(
+        const FixedwingMetricsCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_fixedwing_metrics
+     */
+    void unsubscribe_fixedwing_metrics(FixedwingMetricsHandle handle);
 
     /**
      * @brief Poll for 'FixedwingMetrics' (blocking).
@@ -1437,10 +1968,21 @@ public:
 
     using ImuCallback = std::function<void(Imu)>;
 
+    /**
+     * @brief Handle type for subscribe_imu.
+     */
+    using ImuHandle = Handle<Imu>;
+
     /**
      * @brief Subscribe to 'IMU' updates (in SI units in NED body frame).
      */
-    void subscribe_imu(ImuCallback callback);
+    ImuHandle subscribe_imu(
+        const ImuCallback& callback, const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_imu
+     */
+    void unsubscribe_imu(ImuHandle handle);
 
     /**
      * @brief Poll for 'Imu' (blocking).
@@ -1455,10 +1997,22 @@ public:
 
     using ScaledImuCallback = std::function<void(Imu)>;
 
+    /**
+     * @brief Handle type for subscribe_scaled_imu.
+     */
+    using ScaledImuHandle = Handle<Imu>;
+
     /**
      * @brief Subscribe to 'Scaled IMU' updates.
      */
-    void subscribe_scaled_imu(ScaledImuCallback callback);
+    ScaledImuHandle subscribe_scaled_imu(
+        const ScaledImuCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_scaled_imu
+     */
+    void unsubscribe_scaled_imu(ScaledImuHandle handle);
 
     /**
      * @brief Poll for 'Imu' (blocking).
@@ -1473,10 +2027,21 @@ public:
 
     using RawImuCallback = std::function<void(Imu)>;
 
+    /**
+     * @brief Handle type for subscribe_raw_imu.
+     */
+    using RawImuHandle = Handle<Imu>;
+
     /**
      * @brief Subscribe to 'Raw IMU' updates.
      */
-    void subscribe_raw_imu(RawImuCallback callback);
+    RawImuHandle subscribe_raw_imu(
+        const RawImuCallback& callback, const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_raw_imu
+     */
+    void unsubscribe_raw_imu(RawImuHandle handle);
 
     /**
      * @brief Poll for 'Imu' (blocking).
@@ -1491,10 +2056,22 @@ public:
 
     using HealthAllOkCallback = std::function<void(bool)>;
 
+    /**
+     * @brief Handle type for subscribe_health_all_ok.
+     */
+    using HealthAllOkHandle = Handle<bool>;
+
     /**
      * @brief Subscribe to 'HealthAllOk' updates.
      */
-    void subscribe_health_all_ok(HealthAllOkCallback callback);
+    HealthAllOkHandle subscribe_health_all_ok(
+        const HealthAllOkCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_health_all_ok
+     */
+    void unsubscribe_health_all_ok(HealthAllOkHandle handle);
 
     /**
      * @brief Poll for 'bool' (blocking).
@@ -1509,10 +2086,22 @@ public:
 
     using UnixEpochTimeCallback = std::function<void(uint64_t)>;
 
+    /**
+     * @brief Handle type for subscribe_unix_epoch_time.
+     */
+    using UnixEpochTimeHandle = Handle<uint64_t>;
+
     /**
      * @brief Subscribe to 'unix epoch time' updates.
      */
-    void subscribe_unix_epoch_time(UnixEpochTimeCallback callback);
+    UnixEpochTimeHandle subscribe_unix_epoch_time(
+        const UnixEpochTimeCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_unix_epoch_time
+     */
+    void unsubscribe_unix_epoch_time(UnixEpochTimeHandle handle);
 
     /**
      * @brief Poll for 'uint64_t' (blocking).
@@ -1527,10 +2116,22 @@ public:
 
     using DistanceSensorCallback = std::function<void(DistanceSensor)>;
 
+    /**
+     * @brief Handle type for subscribe_distance_sensor.
+     */
+    using DistanceSensorHandle = Handle<DistanceSensor>;
+
     /**
      * @brief Subscribe to 'Distance Sensor' updates.
      */
-    void subscribe_distance_sensor(DistanceSensorCallback callback);
+    DistanceSensorHandle subscribe_distance_sensor(
+        const DistanceSensorCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_distance_sensor
+     */
+    void unsubscribe_distance_sensor(DistanceSensorHandle handle);
 
     /**
      * @brief Poll for 'DistanceSensor' (blocking).
@@ -1545,10 +2146,22 @@ public:
 
     using ScaledPressureCallback = std::function<void(ScaledPressure)>;
 
+    /**
+     * @brief Handle type for subscribe_scaled_pressure.
+     */
+    using ScaledPressureHandle = Handle<ScaledPressure>;
+
     /**
      * @brief Subscribe to 'Scaled Pressure' updates.
      */
-    void subscribe_scaled_pressure(ScaledPressureCallback callback);
+    ScaledPressureHandle subscribe_scaled_pressure(
+        const ScaledPressureCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_scaled_pressure
+     */
+    void unsubscribe_scaled_pressure(ScaledPressureHandle handle);
 
     /**
      * @brief Poll for 'ScaledPressure' (blocking).
@@ -1563,10 +2176,22 @@ public:
 
     using HeadingCallback = std::function<void(Heading)>;
 
+    /**
+     * @brief Handle type for subscribe_heading.
+     */
+    using HeadingHandle = Handle<Heading>;
+
     /**
      * @brief Subscribe to 'Heading' updates.
      */
-    void subscribe_heading(HeadingCallback callback);
+    HeadingHandle subscribe_heading(
+        const HeadingCallback& callback,
+        const SubscriptionOptions& options = SubscriptionOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_heading
+     */
+    void unsubscribe_heading(HeadingHandle handle);
 
     /**
      * @brief Poll for 'Heading' (blocking).
@@ -1962,6 +2587,257 @@ public:
      */
     std::pair<Result, Telemetry::GpsGlobalOrigin> get_gps_global_origin() const;
 
+    /**
+     * @brief Poll for a consistent set of fields (non-blocking, lock-free).
+     *
+     * All fields are read together, so none of them can be updated in between.
+     *
+     * @param fields Fields to read, bitmask of `SnapshotField`.
+     * @return Snapshot of the requested fields.
+     */
+    Snapshot snapshot(uint32_t fields = SnapshotField::All) const;
+
+    /**
+     * @brief Set the rates of several topics at once.
+     *
+     * Topics which are served by the same MAVLink message (e.g. in air, landed state and VTOL
+     * state) are merged into one request using the highest of their rates, and all requests
+     * are queued at once instead of one after the other.
+     *
+     * The callback is called once all requests are done. The result is Success if all of them
+     * succeeded, otherwise the result of the first one that failed. The results of the single
+     * requests are passed along in the order of the requests; merged requests share the result
+     * of their message.
+     *
+     * This function is non-blocking. See 'set_rates' for the blocking counterpart.
+     */
+    void set_rates_async(std::vector<RateRequest> rate_requests, const SetRatesCallback callback);
+
+    /**
+     * @brief Set the rates of several topics at once.
+     *
+     * This function is blocking. See 'set_rates_async' for the non-blocking counterpart.
+     *
+     * @return Result of request.
+     */
+    Result set_rates(std::vector<RateRequest> rate_requests) const;
+
+    /**
+     * @brief Enable or disable recording the history of a topic.
+     *
+     * The storage for the history is allocated when it is enabled, so recording samples
+     * never allocates. Disabling it discards all recorded samples.
+     *
+     * @param topic Topic to record.
+     * @param enabled Whether to record the topic.
+     */
+    void set_history_enabled(HistoryTopic topic, bool enabled);
+
+    /**
+     * @brief Get the recorded position samples received in a time range, oldest first.
+     *
+     * Times are receive times in microseconds of the monotonic clock, as in `Snapshot`.
+     * The history needs to be enabled using set_history_enabled.
+     *
+     * @param start_time_us Start of the range (inclusive).
+     * @param end_time_us End of the range (inclusive).
+     * @return Pairs of receive time and sample.
+     */
+    std::vector<std::pair<uint64_t, Position>>
+    position_history(uint64_t start_time_us, uint64_t end_time_us) const;
+
+    /**
+     * @brief Get the position at a point in time, interpolated between the recorded samples.
+     *
+     * @param time_us Receive time in microseconds of the monotonic clock.
+     * @return The interpolated sample, empty if the time is not covered by the history.
+     */
+    std::optional<Position> position_at(uint64_t time_us) const;
+
+    /**
+     * @brief Get the recorded attitude samples received in a time range, oldest first.
+     *
+     * Times are receive times in microseconds of the monotonic clock, as in `Snapshot`.
+     * The history needs to be enabled using set_history_enabled.
+     *
+     * @param start_time_us Start of the range (inclusive).
+     * @param end_time_us End of the range (inclusive).
+     * @return Pairs of receive time and sample.
+     */
+    std::vector<std::pair<uint64_t, Quaternion>>
+    attitude_quaternion_history(uint64_t start_time_us, uint64_t end_time_us) const;
+
+    /**
+     * @brief Get the attitude at a point in time, interpolated between the recorded samples.
+     *
+     * @param time_us Receive time in microseconds of the monotonic clock.
+     * @return The interpolated sample, empty if the time is not covered by the history.
+     */
+    std::optional<Quaternion> attitude_quaternion_at(uint64_t time_us) const;
+
+    /**
+     * @brief Get the recorded velocity samples received in a time range, oldest first.
+     *
+     * Times are receive times in microseconds of the monotonic clock, as in `Snapshot`.
+     * The history needs to be enabled using set_history_enabled.
+     *
+     * @param start_time_us Start of the range (inclusive).
+     * @param end_time_us End of the range (inclusive).
+     * @return Pairs of receive time and sample.
+     */
+    std::vector<std::pair<uint64_t, VelocityNed>>
+    velocity_ned_history(uint64_t start_time_us, uint64_t end_time_us) const;
+
+    /**
+     * @brief Get the velocity at a point in time, interpolated between the recorded samples.
+     *
+     * @param time_us Receive time in microseconds of the monotonic clock.
+     * @return The interpolated sample, empty if the time is not covered by the history.
+     */
+    std::optional<VelocityNed> velocity_ned_at(uint64_t time_us) const;
+
+    /**
+     * @brief Get the recorded IMU samples received in a time range, oldest first.
+     *
+     * Times are receive times in microseconds of the monotonic clock, as in `Snapshot`.
+     * The history needs to be enabled using set_history_enabled.
+     *
+     * @param start_time_us Start of the range (inclusive).
+     * @param end_time_us End of the range (inclusive).
+     * @return Pairs of receive time and sample.
+     */
+    std::vector<std::pair<uint64_t, Imu>>
+    imu_history(uint64_t start_time_us, uint64_t end_time_us) const;
+
+    /**
+     * @brief Get the IMU at a point in time, interpolated between the recorded samples.
+     *
+     * @param time_us Receive time in microseconds of the monotonic clock.
+     * @return The interpolated sample, empty if the time is not covered by the history.
+     */
+    std::optional<Imu> imu_at(uint64_t time_us) const;
+
+    /**
+     * @brief Get the recorded attitude samples received in a time range as Euler angles.
+     *
+     * This uses the attitude quaternion history, converted all at once.
+     *
+     * @param start_time_us Start of the range (inclusive).
+     * @param end_time_us End of the range (inclusive).
+     * @return Pairs of receive time and sample.
+     */
+    std::vector<std::pair<uint64_t, EulerAngle>>
+    attitude_euler_history(uint64_t start_time_us, uint64_t end_time_us) const;
+
+    /**
+     * @brief Callback type for subscribe_imu_batch, subscribe_scaled_imu_batch and
+     * subscribe_raw_imu_batch.
+     */
+    using ImuBatchCallback = std::function<void(const std::vector<Imu>&)>;
+
+    /**
+     * @brief Handle type for subscribe_imu_batch, subscribe_scaled_imu_batch and
+     * subscribe_raw_imu_batch.
+     */
+    using ImuBatchHandle = Handle<std::vector<Imu>>;
+
+    /**
+     * @brief Subscribe to 'IMU' updates, delivered in batches.
+     *
+     * Each sample keeps its own timestamp. At a few hundred Hz this uses far
+     * fewer callbacks than subscribe_imu.
+     */
+    ImuBatchHandle subscribe_imu_batch(
+        const ImuBatchCallback& callback, const BatchOptions& options = BatchOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_imu_batch
+     */
+    void unsubscribe_imu_batch(ImuBatchHandle handle);
+
+    /**
+     * @brief Subscribe to 'Scaled IMU' updates, delivered in batches.
+     */
+    ImuBatchHandle subscribe_scaled_imu_batch(
+        const ImuBatchCallback& callback, const BatchOptions& options = BatchOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_scaled_imu_batch
+     */
+    void unsubscribe_scaled_imu_batch(ImuBatchHandle handle);
+
+    /**
+     * @brief Subscribe to 'Raw IMU' updates, delivered in batches.
+     */
+    ImuBatchHandle subscribe_raw_imu_batch(
+        const ImuBatchCallback& callback, const BatchOptions& options = BatchOptions{});
+
+    /**
+     * @brief Unsubscribe from subscribe_raw_imu_batch
+     */
+    void unsubscribe_raw_imu_batch(ImuBatchHandle handle);
+
+    /**
+     * @brief Poll for the core fields of all vehicles at once (non-blocking, lock-free).
+     *
+     * This covers every vehicle for which a Telemetry plugin exists, so a ground station
+     * showing a fleet does not need to ask each plugin for each field. The fields of each
+     * vehicle are read together, so none of them can be updated in between.
+     *
+     * The vectors of the snapshot are replaced, their storage is reused, so passing the
+     * same snapshot every time does not allocate once it has grown to the fleet size.
+     *
+     * @param snapshot Snapshot to fill.
+     */
+    static void fleet_snapshot(FleetSnapshot& snapshot);
+
+    /**
+     * @brief Find all pairs of vehicles in a fleet snapshot closer than a distance.
+     *
+     * Vehicles are sorted into a grid first, so only neighbours are compared. Vehicles
+     * without a position are left out.
+     *
+     * @param snapshot Snapshot from `fleet_snapshot`.
+     * @param distance_m Distance in metres, including altitude.
+     * @param pairs Pairs found, ordered by index, replacing its content.
+     */
+    static void fleet_pairs_within(
+        const FleetSnapshot& snapshot, double distance_m, std::vector<FleetPair>& pairs);
+
+    /**
+     * @brief Adapt the rates of some topics to the quality of the link.
+     *
+     * Once a second, the loss and throughput of the messages from the vehicle
+     * and the round trip time to it are checked. If the link is congested, the
+     * rates are cut towards their minimum, and once it has been good for a
+     * while, they are raised back towards their maximum in small steps. The
+     * rates start at their maximum, and only change when the link does.
+     *
+     * Topics which are not configured, e.g. the ones needed for control, keep
+     * their rates, and the headroom keeps space on the link for them and for
+     * commands. The configured topics should not be set otherwise while this
+     * is enabled.
+     *
+     * Calling this again replaces the configuration.
+     *
+     * @return Success, or Unsupported if a topic can't be set or a range is
+     * invalid.
+     */
+    Result enable_rate_adaptation(RateAdaptationConfig config) const;
+
+    /**
+     * @brief Stop adapting rates, the configured topics go back to their maximum rate.
+     */
+    void disable_rate_adaptation() const;
+
+    /**
+     * @brief Get how far the adapted rates are from their minimum.
+     *
+     * @return From 0 (all at their minimum) to 1 (all at their maximum), 1 as
+     * well if rate adaptation is not enabled.
+     */
+    double rate_adaptation_scale() const;
+
     /**
      * @brief Copy constructor.
      */
@@ -1,6 +1,8 @@
 #include "mavsdk_math.h"
 #include "math_conversions.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 
 namespace mavsdk {
 
@@ -40,4 +42,233 @@ Telemetry::Quaternion to_quaternion_from_euler_angle(Telemetry::EulerAngle euler
     return quaternion;
 }
 
+std::array<float, 3>
+rotate_vector_by_quaternion(Telemetry::Quaternion quaternion, std::array<float, 3> vector)
+{
+    rotate_vectors_by_quaternions(&quaternion, &vector, &vector, 1);
+    return vector;
+}
+
+// The approximations below only use arithmetic and selects between values
+// that have already been computed, so they can be inlined into the batched
+// loops and vectorized. For that, this file is built without errno and
+// floating-point trap semantics, see CMakeLists.txt.
+
+static constexpr float PI_F = static_cast<float>(PI);
+
+// atan for 0 <= value <= 1, as in Cephes' atanf: reduced to at most
+// tan(pi/8) and then a short polynomial, accurate to about 1e-7 rad.
+static inline float atan_unit(float value)
+{
+    const bool reduce = value > 0.41421356f;
+    const float reduced = (value - 1.0f) / (value + 1.0f);
+    const float t = reduce ? reduced : value;
+    const float offset = reduce ? 0.25f * PI_F : 0.0f;
+    const float z = t * t;
+    return offset + t +
+           t * z *
+               (((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z -
+                3.33329491539e-1f);
+}
+
+static inline float atan2_approx(float y, float x)
+{
+    const float abs_x = std::fabs(x);
+    const float abs_y = std::fabs(y);
+    const bool swap = abs_y > abs_x;
+    const float max_value = swap ? abs_y : abs_x;
+    const float min_value = swap ? abs_x : abs_y;
+    const float divisor = max_value > 0.0f ? max_value : 1.0f;
+
+    const float angle = atan_unit(min_value / divisor);
+    const float first_octant = swap ? 0.5f * PI_F - angle : angle;
+    const float half_plane = x < 0.0f ? PI_F - first_octant : first_octant;
+    return y < 0.0f ? -half_plane : half_plane;
+}
+
+static inline float asin_approx(float value)
+{
+    const float upper = value > 1.0f ? 1.0f : value;
+    const float clamped = upper < -1.0f ? -1.0f : upper;
+    return atan2_approx(clamped, std::sqrt(1.0f - clamped * clamped));
+}
+
+// Sine and cosine for |angle| <= pi.
+static inline void sin_cos_approx(float angle, float& sin_out, float& cos_out)
+{
+    // Mirror into [-pi/2, pi/2] where the series converges quickly, the
+    // cosine changes sign when mirrored, the sine doesn't.
+    const float mirrored = (angle < 0.0f ? -PI_F : PI_F) - angle;
+    const bool mirror = std::fabs(angle) > 0.5f * PI_F;
+    const float reduced = mirror ? mirrored : angle;
+    const float cos_sign = mirror ? -1.0f : 1.0f;
+
+    const float a = reduced * reduced;
+    sin_out = reduced *
+              (1.0f + a * (-1.0f / 6.0f +
+                           a * (1.0f / 120.0f +
+                                a * (-1.0f / 5040.0f +
+                                     a * (1.0f / 362880.0f + a * (-1.0f / 39916800.0f))))));
+    cos_out = cos_sign *
+              (1.0f + a * (-1.0f / 2.0f +
+                           a * (1.0f / 24.0f +
+                                a * (-1.0f / 720.0f +
+                                     a * (1.0f / 40320.0f +
+                                          a * (-1.0f / 3628800.0f + a * (1.0f / 479001600.0f)))))));
+}
+
+// Wraps an angle to [-pi, pi], rounding without a call to std::round.
+static inline float wrap_pi(float angle)
+{
+    constexpr float round_magic = 12582912.0f; // 1.5 * 2^23
+    const float turns = angle * (0.5f / PI_F);
+    const float rounded = (turns + round_magic) - round_magic;
+    return angle - rounded * (2.0f * PI_F);
+}
+
+// The public types interleave floats with a 64 bit timestamp, which compilers
+// won't vectorize. So the batched functions copy blocks of elements into
+// plain float arrays, convert those, and copy the results back.
+static constexpr std::size_t BLOCK_SIZE = 16;
+
+void to_euler_angles_from_quaternions(
+    const Telemetry::Quaternion* quaternions,
+    Telemetry::EulerAngle* euler_angles,
+    std::size_t count)
+{
+    constexpr float rad_to_deg = static_cast<float>(180.0 / PI);
+
+    for (std::size_t start = 0; start < count; start += BLOCK_SIZE) {
+        const std::size_t size = std::min(BLOCK_SIZE, count - start);
+
+        float w[BLOCK_SIZE]{};
+        float x[BLOCK_SIZE]{};
+        float y[BLOCK_SIZE]{};
+        float z[BLOCK_SIZE]{};
+        for (std::size_t i = 0; i < size; ++i) {
+            w[i] = quaternions[start + i].w;
+            x[i] = quaternions[start + i].x;
+            y[i] = quaternions[start + i].y;
+            z[i] = quaternions[start + i].z;
+        }
+
+        float roll[BLOCK_SIZE];
+        float pitch[BLOCK_SIZE];
+        float yaw[BLOCK_SIZE];
+        for (std::size_t i = 0; i < BLOCK_SIZE; ++i) {
+            roll[i] = rad_to_deg * atan2_approx(
+                                       2.0f * (w[i] * x[i] + y[i] * z[i]),
+                                       1.0f - 2.0f * (x[i] * x[i] + y[i] * y[i]));
+            pitch[i] = rad_to_deg * asin_approx(2.0f * (w[i] * y[i] - z[i] * x[i]));
+            yaw[i] = rad_to_deg * atan2_approx(
+                                      2.0f * (w[i] * z[i] + x[i] * y[i]),
+                                      1.0f - 2.0f * (y[i] * y[i] + z[i] * z[i]));
+        }
+
+        for (std::size_t i = 0; i < size; ++i) {
+            euler_angles[start + i].roll_deg = roll[i];
+            euler_angles[start + i].pitch_deg = pitch[i];
+            euler_angles[start + i].yaw_deg = yaw[i];
+            euler_angles[start + i].timestamp_us = quaternions[start + i].timestamp_us;
+        }
+    }
+}
+
+void to_quaternions_from_euler_angles(
+    const Telemetry::EulerAngle* euler_angles,
+    Telemetry::Quaternion* quaternions,
+    std::size_t count)
+{
+    constexpr float deg_to_half_rad = static_cast<float>(PI / 360.0);
+
+    for (std::size_t start = 0; start < count; start += BLOCK_SIZE) {
+        const std::size_t size = std::min(BLOCK_SIZE, count - start);
+
+        float roll[BLOCK_SIZE]{};
+        float pitch[BLOCK_SIZE]{};
+        float yaw[BLOCK_SIZE]{};
+        for (std::size_t i = 0; i < size; ++i) {
+            roll[i] = euler_angles[start + i].roll_deg;
+            pitch[i] = euler_angles[start + i].pitch_deg;
+            yaw[i] = euler_angles[start + i].yaw_deg;
+        }
+
+        float w[BLOCK_SIZE];
+        float x[BLOCK_SIZE];
+        float y[BLOCK_SIZE];
+        float z[BLOCK_SIZE];
+        for (std::size_t i = 0; i < BLOCK_SIZE; ++i) {
+            float sin_phi_2;
+            float cos_phi_2;
+            sin_cos_approx(wrap_pi(roll[i] * deg_to_half_rad), sin_phi_2, cos_phi_2);
+            float sin_theta_2;
+            float cos_theta_2;
+            sin_cos_approx(wrap_pi(pitch[i] * deg_to_half_rad), sin_theta_2, cos_theta_2);
+            float sin_psi_2;
+            float cos_psi_2;
+            sin_cos_approx(wrap_pi(yaw[i] * deg_to_half_rad), sin_psi_2, cos_psi_2);
+
+            w[i] = cos_phi_2 * cos_theta_2 * cos_psi_2 + sin_phi_2 * sin_theta_2 * sin_psi_2;
+            x[i] = sin_phi_2 * cos_theta_2 * cos_psi_2 - cos_phi_2 * sin_theta_2 * sin_psi_2;
+            y[i] = cos_phi_2 * sin_theta_2 * cos_psi_2 + sin_phi_2 * cos_theta_2 * sin_psi_2;
+            z[i] = cos_phi_2 * cos_theta_2 * sin_psi_2 - sin_phi_2 * sin_theta_2 * cos_psi_2;
+        }
+
+        for (std::size_t i = 0; i < size; ++i) {
+            quaternions[start + i].w = w[i];
+            quaternions[start + i].x = x[i];
+            quaternions[start + i].y = y[i];
+            quaternions[start + i].z = z[i];
+            quaternions[start + i].timestamp_us = euler_angles[start + i].timestamp_us;
+        }
+    }
+}
+
+void rotate_vectors_by_quaternions(
+    const Telemetry::Quaternion* quaternions,
+    const std::array<float, 3>* vectors,
+    std::array<float, 3>* rotated,
+    std::size_t count)
+{
+    for (std::size_t start = 0; start < count; start += BLOCK_SIZE) {
+        const std::size_t size = std::min(BLOCK_SIZE, count - start);
+
+        float qw[BLOCK_SIZE]{};
+        float qx[BLOCK_SIZE]{};
+        float qy[BLOCK_SIZE]{};
+        float qz[BLOCK_SIZE]{};
+        float vx[BLOCK_SIZE]{};
+        float vy[BLOCK_SIZE]{};
+        float vz[BLOCK_SIZE]{};
+        for (std::size_t i = 0; i < size; ++i) {
+            qw[i] = quaternions[start + i].w;
+            qx[i] = quaternions[start + i].x;
+            qy[i] = quaternions[start + i].y;
+            qz[i] = quaternions[start + i].z;
+            vx[i] = vectors[start + i][0];
+            vy[i] = vectors[start + i][1];
+            vz[i] = vectors[start + i][2];
+        }
+
+        float rx[BLOCK_SIZE];
+        float ry[BLOCK_SIZE];
+        float rz[BLOCK_SIZE];
+        for (std::size_t i = 0; i < BLOCK_SIZE; ++i) {
+            // v' = v + w * t + q_vec x t, with t = 2 * (q_vec x v)
+            const float tx = 2.0f * (qy[i] * vz[i] - qz[i] * vy[i]);
+            const float ty = 2.0f * (qz[i] * vx[i] - qx[i] * vz[i]);
+            const float tz = 2.0f * (qx[i] * vy[i] - qy[i] * vx[i]);
+
+            rx[i] = vx[i] + qw[i] * tx + (qy[i] * tz - qz[i] * ty);
+            ry[i] = vy[i] + qw[i] * ty + (qz[i] * tx - qx[i] * tz);
+            rz[i] = vz[i] + qw[i] * tz + (qx[i] * ty - qy[i] * tx);
+        }
+
+        // Written back last, so rotating in place works.
+        for (std::size_t i = 0; i < size; ++i) {
+            rotated[start + i] = {rx[i], ry[i], rz[i]};
+        }
+    }
+}
+
 } // namespace mavsdk
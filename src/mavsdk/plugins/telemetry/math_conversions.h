@@ -1,10 +1,33 @@
 #pragma once
 
 #include "plugins/telemetry/telemetry.h"
+#include <array>
+#include <cstddef>
 
 namespace mavsdk {
 
 Telemetry::EulerAngle to_euler_angle_from_quaternion(Telemetry::Quaternion quaternion);
 Telemetry::Quaternion to_quaternion_from_euler_angle(Telemetry::EulerAngle euler_angle);
+std::array<float, 3>
+rotate_vector_by_quaternion(Telemetry::Quaternion quaternion, std::array<float, 3> vector);
+
+// Batched versions of the above, converting count elements at once.
+//
+// The loops don't call into libm and don't branch, so the compiler can
+// vectorize them. Trigonometric functions are replaced by polynomial
+// approximations accurate to about 1e-6 rad.
+void to_euler_angles_from_quaternions(
+    const Telemetry::Quaternion* quaternions,
+    Telemetry::EulerAngle* euler_angles,
+    std::size_t count);
+void to_quaternions_from_euler_angles(
+    const Telemetry::EulerAngle* euler_angles,
+    Telemetry::Quaternion* quaternions,
+    std::size_t count);
+void rotate_vectors_by_quaternions(
+    const Telemetry::Quaternion* quaternions,
+    const std::array<float, 3>* vectors,
+    std::array<float, 3>* rotated,
+    std::size_t count);
 
 } // namespace mavsdk
@@ -1,5 +1,7 @@
 #include "math_conversions.h"
 #include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
 #include "mavlink_include.h"
 #include "mavsdk_math.h"
 
@@ -111,3 +113,121 @@ TEST(MathConversions, QuaternionToEulerAndBackSomeCase)
     EXPECT_NEAR(q2.y, q2_mavlink[2], 0.01f);
     EXPECT_NEAR(q2.z, q2_mavlink[3], 0.01f);
 }
+
+TEST(MathConversions, BatchedQuaternionToEulerMatchesScalar)
+{
+    std::vector<Telemetry::Quaternion> quaternions;
+    for (float w = -1.0f; w <= 1.0f; w += 0.25f) {
+        for (float x = -1.0f; x <= 1.0f; x += 0.25f) {
+            for (float y = -1.0f; y <= 1.0f; y += 0.5f) {
+                for (float z = -1.0f; z <= 1.0f; z += 0.5f) {
+                    const float norm = std::sqrt(w * w + x * x + y * y + z * z);
+                    if (norm < 0.1f) {
+                        continue;
+                    }
+                    Telemetry::Quaternion q;
+                    q.w = w / norm;
+                    q.x = x / norm;
+                    q.y = y / norm;
+                    q.z = z / norm;
+                    q.timestamp_us = quaternions.size();
+                    quaternions.push_back(q);
+                }
+            }
+        }
+    }
+
+    std::vector<Telemetry::EulerAngle> euler_angles(quaternions.size());
+    to_euler_angles_from_quaternions(
+        quaternions.data(), euler_angles.data(), quaternions.size());
+
+    // Angles close to +-180 degrees can come out on either side.
+    auto angle_difference = [](float lhs, float rhs) {
+        const float difference = std::fabs(lhs - rhs);
+        return difference > 180.0f ? 360.0f - difference : difference;
+    };
+
+    for (std::size_t i = 0; i < quaternions.size(); ++i) {
+        const Telemetry::EulerAngle expected = to_euler_angle_from_quaternion(quaternions[i]);
+        EXPECT_NEAR(angle_difference(euler_angles[i].roll_deg, expected.roll_deg), 0.0f, 1e-3f);
+        EXPECT_NEAR(euler_angles[i].pitch_deg, expected.pitch_deg, 1e-3f);
+        EXPECT_NEAR(angle_difference(euler_angles[i].yaw_deg, expected.yaw_deg), 0.0f, 1e-3f);
+        EXPECT_EQ(euler_angles[i].timestamp_us, expected.timestamp_us);
+    }
+}
+
+TEST(MathConversions, BatchedEulerToQuaternionMatchesScalar)
+{
+    std::vector<Telemetry::EulerAngle> euler_angles;
+    for (float roll = -180.0f; roll <= 180.0f; roll += 30.0f) {
+        for (float pitch = -90.0f; pitch <= 90.0f; pitch += 15.0f) {
+            for (float yaw = -360.0f; yaw <= 360.0f; yaw += 45.0f) {
+                Telemetry::EulerAngle euler_angle;
+                euler_angle.roll_deg = roll;
+                euler_angle.pitch_deg = pitch;
+                euler_angle.yaw_deg = yaw;
+                euler_angle.timestamp_us = euler_angles.size();
+                euler_angles.push_back(euler_angle);
+            }
+        }
+    }
+
+    std::vector<Telemetry::Quaternion> quaternions(euler_angles.size());
+    to_quaternions_from_euler_angles(
+        euler_angles.data(), quaternions.data(), euler_angles.size());
+
+    for (std::size_t i = 0; i < euler_angles.size(); ++i) {
+        const Telemetry::Quaternion expected = to_quaternion_from_euler_angle(euler_angles[i]);
+        EXPECT_NEAR(quaternions[i].w, expected.w, 1e-5f);
+        EXPECT_NEAR(quaternions[i].x, expected.x, 1e-5f);
+        EXPECT_NEAR(quaternions[i].y, expected.y, 1e-5f);
+        EXPECT_NEAR(quaternions[i].z, expected.z, 1e-5f);
+        EXPECT_EQ(quaternions[i].timestamp_us, expected.timestamp_us);
+    }
+}
+
+TEST(MathConversions, BatchedBaseCaseIsExact)
+{
+    Telemetry::Quaternion q1;
+    q1.w = 1.0f;
+    q1.x = 0.0f;
+    q1.y = 0.0f;
+    q1.z = 0.0f;
+    q1.timestamp_us = 4242;
+
+    Telemetry::EulerAngle e;
+    to_euler_angles_from_quaternions(&q1, &e, 1);
+    EXPECT_FLOAT_EQ(e.roll_deg, 0.0f);
+    EXPECT_FLOAT_EQ(e.pitch_deg, 0.0f);
+    EXPECT_FLOAT_EQ(e.yaw_deg, 0.0f);
+
+    Telemetry::Quaternion q2;
+    to_quaternions_from_euler_angles(&e, &q2, 1);
+    EXPECT_EQ(q1, q2);
+}
+
+TEST(MathConversions, RotateVectorByQuaternion)
+{
+    Telemetry::EulerAngle yaw_90;
+    yaw_90.roll_deg = 0.0f;
+    yaw_90.pitch_deg = 0.0f;
+    yaw_90.yaw_deg = 90.0f;
+    const Telemetry::Quaternion q = to_quaternion_from_euler_angle(yaw_90);
+
+    // Forward becomes right (east) when yawed by 90 degrees.
+    const auto rotated = rotate_vector_by_quaternion(q, {1.0f, 0.0f, 0.0f});
+    EXPECT_NEAR(rotated[0], 0.0f, 1e-6f);
+    EXPECT_NEAR(rotated[1], 1.0f, 1e-6f);
+    EXPECT_NEAR(rotated[2], 0.0f, 1e-6f);
+
+    // The batched version in place over more than one block.
+    std::vector<Telemetry::Quaternion> quaternions(37, q);
+    std::vector<std::array<float, 3>> vectors(37, {0.0f, 2.0f, 3.0f});
+    rotate_vectors_by_quaternions(
+        quaternions.data(), vectors.data(), vectors.data(), vectors.size());
+    for (const auto& vector : vectors) {
+        EXPECT_NEAR(vector[0], -2.0f, 1e-5f);
+        EXPECT_NEAR(vector[1], 0.0f, 1e-5f);
+        EXPECT_NEAR(vector[2], 3.0f, 1e-5f);
+    }
+}
@@ -7,46 +7,116 @@ namespace testing {
 
 class MockTelemetry {
 public:
-    MOCK_CONST_METHOD1(subscribe_position, void(Telemetry::PositionCallback)){};
-    MOCK_CONST_METHOD1(subscribe_health, void(Telemetry::HealthCallback)){};
-    MOCK_CONST_METHOD1(subscribe_heading, void(Telemetry::HeadingCallback)){};
-    MOCK_CONST_METHOD1(subscribe_home, void(Telemetry::PositionCallback)){};
-    MOCK_CONST_METHOD1(subscribe_in_air, void(Telemetry::InAirCallback)){};
-    MOCK_CONST_METHOD1(subscribe_status_text, void(Telemetry::StatusTextCallback)){};
-    MOCK_CONST_METHOD1(subscribe_armed, void(Telemetry::ArmedCallback)){};
-    MOCK_CONST_METHOD1(subscribe_gps_info, void(Telemetry::GpsInfoCallback)){};
-    MOCK_CONST_METHOD1(subscribe_raw_gps, void(Telemetry::RawGpsCallback)){};
-    MOCK_CONST_METHOD1(subscribe_battery, void(Telemetry::BatteryCallback)){};
-    MOCK_CONST_METHOD1(subscribe_flight_mode, void(Telemetry::FlightModeCallback)){};
-    MOCK_CONST_METHOD1(subscribe_landed_state, void(Telemetry::LandedStateCallback)){};
-    MOCK_CONST_METHOD1(
-        subscribe_attitude_quaternion, void(Telemetry::AttitudeQuaternionCallback)){};
+    MOCK_CONST_METHOD1(
+        subscribe_position, Telemetry::PositionHandle(Telemetry::PositionCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_position, void(Telemetry::PositionHandle)){};
+    MOCK_CONST_METHOD1(subscribe_health, Telemetry::HealthHandle(Telemetry::HealthCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_health, void(Telemetry::HealthHandle)){};
+    MOCK_CONST_METHOD1(subscribe_heading, Telemetry::HeadingHandle(Telemetry::HeadingCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_heading, void(Telemetry::HeadingHandle)){};
+    MOCK_CONST_METHOD1(subscribe_home, Telemetry::HomeHandle(Telemetry::PositionCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_home, void(Telemetry::HomeHandle)){};
+    MOCK_CONST_METHOD1(subscribe_in_air, Telemetry::InAirHandle(Telemetry::InAirCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_in_air, void(Telemetry::InAirHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_status_text, Telemetry::StatusTextHandle(Telemetry::StatusTextCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_status_text, void(Telemetry::StatusTextHandle)){};
+    MOCK_CONST_METHOD1(subscribe_armed, Telemetry::ArmedHandle(Telemetry::ArmedCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_armed, void(Telemetry::ArmedHandle)){};
+    MOCK_CONST_METHOD1(subscribe_gps_info, Telemetry::GpsInfoHandle(Telemetry::GpsInfoCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_gps_info, void(Telemetry::GpsInfoHandle)){};
+    MOCK_CONST_METHOD1(subscribe_raw_gps, Telemetry::RawGpsHandle(Telemetry::RawGpsCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_raw_gps, void(Telemetry::RawGpsHandle)){};
+    MOCK_CONST_METHOD1(subscribe_battery, Telemetry::BatteryHandle(Telemetry::BatteryCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_battery, void(Telemetry::BatteryHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_flight_mode, Telemetry::FlightModeHandle(Telemetry::FlightModeCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_flight_mode, void(Telemetry::FlightModeHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_landed_state, Telemetry::LandedStateHandle(Telemetry::LandedStateCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_landed_state, void(Telemetry::LandedStateHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_attitude_quaternion,
+        Telemetry::AttitudeQuaternionHandle(Telemetry::AttitudeQuaternionCallback)){};
+    MOCK_CONST_METHOD1(
+        unsubscribe_attitude_quaternion, void(Telemetry::AttitudeQuaternionHandle)){};
     MOCK_CONST_METHOD1(
         subscribe_attitude_angular_velocity_body,
-        void(Telemetry::AttitudeAngularVelocityBodyCallback)){};
-    MOCK_CONST_METHOD1(subscribe_attitude_euler, void(Telemetry::AttitudeEulerCallback)){};
-    MOCK_CONST_METHOD1(
-        subscribe_camera_attitude_quaternion, void(Telemetry::AttitudeQuaternionCallback)){};
-    MOCK_CONST_METHOD1(subscribe_camera_attitude_euler, void(Telemetry::AttitudeEulerCallback)){};
-    MOCK_CONST_METHOD1(subscribe_velocity_ned, void(Telemetry::VelocityNedCallback)){};
-    MOCK_CONST_METHOD1(subscribe_rc_status, void(Telemetry::RcStatusCallback)){};
-    MOCK_CONST_METHOD1(
-        subscribe_actuator_control_target, void(Telemetry::ActuatorControlTargetCallback)){};
-    MOCK_CONST_METHOD1(
-        subscribe_actuator_output_status, void(Telemetry::ActuatorOutputStatusCallback)){};
-    MOCK_CONST_METHOD1(subscribe_odometry, void(Telemetry::OdometryCallback)){};
-    MOCK_CONST_METHOD1(subscribe_distance_sensor, void(Telemetry::DistanceSensorCallback)){};
-    MOCK_CONST_METHOD1(subscribe_scaled_pressure, void(Telemetry::ScaledPressureCallback)){};
-    MOCK_CONST_METHOD1(
-        subscribe_position_velocity_ned, void(Telemetry::PositionVelocityNedCallback)){};
-    MOCK_CONST_METHOD1(subscribe_ground_truth, void(Telemetry::GroundTruthCallback)){};
-    MOCK_CONST_METHOD1(subscribe_fixedwing_metrics, void(Telemetry::FixedwingMetricsCallback)){};
-    MOCK_CONST_METHOD1(subscribe_imu, void(Telemetry::ImuCallback)){};
-    MOCK_CONST_METHOD1(subscribe_scaled_imu, void(Telemetry::ScaledImuCallback)){};
-    MOCK_CONST_METHOD1(subscribe_raw_imu, void(Telemetry::RawImuCallback)){};
-    MOCK_CONST_METHOD1(subscribe_health_all_ok, void(Telemetry::HealthAllOkCallback)){};
-    MOCK_CONST_METHOD1(subscribe_unix_epoch_time, void(Telemetry::UnixEpochTimeCallback)){};
-    MOCK_CONST_METHOD1(subscribe_vtol_state, void(Telemetry::VtolStateCallback)){};
+        Telemetry::AttitudeAngularVelocityBodyHandle(
+            Telemetry::AttitudeAngularVelocityBodyCallback)){};
+    MOCK_CONST_METHOD1(
+        unsubscribe_attitude_angular_velocity_body,
+        void(Telemetry::AttitudeAngularVelocityBodyHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_attitude_euler,
+        Telemetry::AttitudeEulerHandle(Telemetry::AttitudeEulerCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_attitude_euler, void(Telemetry::AttitudeEulerHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_camera_attitude_quaternion,
+        Telemetry::CameraAttitudeQuaternionHandle(Telemetry::AttitudeQuaternionCallback)){};
+    MOCK_CONST_METHOD1(
+        unsubscribe_camera_attitude_quaternion, void(Telemetry::CameraAttitudeQuaternionHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_camera_attitude_euler,
+        Telemetry::CameraAttitudeEulerHandle(Telemetry::AttitudeEulerCallback)){};
+    MOCK_CONST_METHOD1(
+        unsubscribe_camera_attitude_euler, void(Telemetry::CameraAttitudeEulerHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_velocity_ned, Telemetry::VelocityNedHandle(Telemetry::VelocityNedCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_velocity_ned, void(Telemetry::VelocityNedHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_rc_status, Telemetry::RcStatusHandle(Telemetry::RcStatusCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_rc_status, void(Telemetry::RcStatusHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_actuator_control_target,
+        Telemetry::ActuatorControlTargetHandle(Telemetry::ActuatorControlTargetCallback)){};
+    MOCK_CONST_METHOD1(
+        unsubscribe_actuator_control_target, void(Telemetry::ActuatorControlTargetHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_actuator_output_status,
+        Telemetry::ActuatorOutputStatusHandle(Telemetry::ActuatorOutputStatusCallback)){};
+    MOCK_CONST_METHOD1(
+        unsubscribe_actuator_output_status, void(Telemetry::ActuatorOutputStatusHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_odometry, Telemetry::OdometryHandle(Telemetry::OdometryCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_odometry, void(Telemetry::OdometryHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_distance_sensor,
+        Telemetry::DistanceSensorHandle(Telemetry::DistanceSensorCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_distance_sensor, void(Telemetry::DistanceSensorHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_scaled_pressure,
+        Telemetry::ScaledPressureHandle(Telemetry::ScaledPressureCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_scaled_pressure, void(Telemetry::ScaledPressureHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_position_velocity_ned,
+        Telemetry::PositionVelocityNedHandle(Telemetry::PositionVelocityNedCallback)){};
+    MOCK_CONST_METHOD1(
+        unsubscribe_position_velocity_ned, void(Telemetry::PositionVelocityNedHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_ground_truth, Telemetry::GroundTruthHandle(Telemetry::GroundTruthCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_ground_truth, void(Telemetry::GroundTruthHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_fixedwing_metrics,
+        Telemetry::FixedwingMetricsHandle(Telemetry::FixedwingMetricsCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_fixedwing_metrics, void(Telemetry::FixedwingMetricsHandle)){};
+    MOCK_CONST_METHOD1(subscribe_imu, Telemetry::ImuHandle(Telemetry::ImuCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_imu, void(Telemetry::ImuHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_scaled_imu, Telemetry::ScaledImuHandle(Telemetry::ScaledImuCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_scaled_imu, void(Telemetry::ScaledImuHandle)){};
+    MOCK_CONST_METHOD1(subscribe_raw_imu, Telemetry::RawImuHandle(Telemetry::RawImuCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_raw_imu, void(Telemetry::RawImuHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_health_all_ok, Telemetry::HealthAllOkHandle(Telemetry::HealthAllOkCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_health_all_ok, void(Telemetry::HealthAllOkHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_unix_epoch_time,
+        Telemetry::UnixEpochTimeHandle(Telemetry::UnixEpochTimeCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_unix_epoch_time, void(Telemetry::UnixEpochTimeHandle)){};
+    MOCK_CONST_METHOD1(
+        subscribe_vtol_state, Telemetry::VtolStateHandle(Telemetry::VtolStateCallback)){};
+    MOCK_CONST_METHOD1(unsubscribe_vtol_state, void(Telemetry::VtolStateHandle)){};
 
     MOCK_METHOD1(set_rate_position, Telemetry::Result(double)){};
     MOCK_METHOD1(set_rate_home, Telemetry::Result(double)){};
@@ -49,9 +49,15 @@ Telemetry::Telemetry(std::shared_ptr<System> system) :
 
 Telemetry::~Telemetry() {}
 
-void Telemetry::subscribe_position(PositionCallback callback)
+Telemetry::PositionHandle Telemetry::subscribe_position(
+    const PositionCallback& callback, const SubscriptionOptions& options)
 {
-    _impl->subscribe_position(callback);
+    return _impl->subscribe_position(callback, options);
+}
+
+void Telemetry::unsubscribe_position(PositionHandle handle)
+{
+    _impl->unsubscribe_position(handle);
 }
 
 Telemetry::Position Telemetry::position() const
@@ -59,9 +65,15 @@ Telemetry::Position Telemetry::position() const
     return _impl->position();
 }
 
-void Telemetry::subscribe_home(HomeCallback callback)
+Telemetry::HomeHandle Telemetry::subscribe_home(
+    const HomeCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_home(callback, options);
+}
+
+void Telemetry::unsubscribe_home(HomeHandle handle)
 {
-    _impl->subscribe_home(callback);
+    _impl->unsubscribe_home(handle);
 }
 
 Telemetry::Position Telemetry::home() const
@@ -69,9 +81,15 @@ Telemetry::Position Telemetry::home() const
     return _impl->home();
 }
 
-void Telemetry::subscribe_in_air(InAirCallback callback)
+Telemetry::InAirHandle Telemetry::subscribe_in_air(
+    const InAirCallback& callback, const SubscriptionOptions& options)
 {
-    _impl->subscribe_in_air(callback);
+    return _impl->subscribe_in_air(callback, options);
+}
+
+void Telemetry::unsubscribe_in_air(InAirHandle handle)
+{
+    _impl->unsubscribe_in_air(handle);
 }
 
 bool Telemetry::in_air() const
@@ -79,9 +97,15 @@ bool Telemetry::in_air() const
     return _impl->in_air();
 }
 
-void Telemetry::subscribe_landed_state(LandedStateCallback callback)
+Telemetry::LandedStateHandle Telemetry::subscribe_landed_state(
+    const LandedStateCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_landed_state(callback, options);
+}
+
+void Telemetry::unsubscribe_landed_state(LandedStateHandle handle)
 {
-    _impl->subscribe_landed_state(callback);
+    _impl->unsubscribe_landed_state(handle);
 }
 
 Telemetry::LandedState Telemetry::landed_state() const
@@ -89,9 +113,15 @@ Telemetry::LandedState Telemetry::landed_state() const
     return _impl->landed_state();
 }
 
-void Telemetry::subscribe_armed(ArmedCallback callback)
+Telemetry::ArmedHandle Telemetry::subscribe_armed(
+    const ArmedCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_armed(callback, options);
+}
+
+void Telemetry::unsubscribe_armed(ArmedHandle handle)
 {
-    _impl->subscribe_armed(callback);
+    _impl->unsubscribe_armed(handle);
 }
 
 bool Telemetry::armed() const
@@ -99,9 +129,15 @@ bool Telemetry::armed() const
     return _impl->armed();
 }
 
-void Telemetry::subscribe_vtol_state(VtolStateCallback callback)
+Telemetry::VtolStateHandle Telemetry::subscribe_vtol_state(
+    const VtolStateCallback& callback, const SubscriptionOptions& options)
 {
-    _impl->subscribe_vtol_state(callback);
+    return _impl->subscribe_vtol_state(callback, options);
+}
+
+void Telemetry::unsubscribe_vtol_state(VtolStateHandle handle)
+{
+    _impl->unsubscribe_vtol_state(handle);
 }
 
 Telemetry::VtolState Telemetry::vtol_state() const
@@ -109,9 +145,15 @@ Telemetry::VtolState Telemetry::vtol_state() const
     return _impl->vtol_state();
 }
 
-void Telemetry::subscribe_attitude_quaternion(AttitudeQuaternionCallback callback)
+Telemetry::AttitudeQuaternionHandle Telemetry::subscribe_attitude_quaternion(
+    const AttitudeQuaternionCallback& callback, const SubscriptionOptions& options)
 {
-    _impl->subscribe_attitude_quaternion(callback);
+    return _impl->subscribe_attitude_quaternion(callback, options);
+}
+
+void Telemetry::unsubscribe_attitude_quaternion(AttitudeQuaternionHandle handle)
+{
+    _impl->unsubscribe_attitude_quaternion(handle);
 }
 
 Telemetry::Quaternion Telemetry::attitude_quaternion() const
@@ -119,9 +161,15 @@ Telemetry::Quaternion Telemetry::attitude_quaternion() const
     return _impl->attitude_quaternion();
 }
 
-void Telemetry::subscribe_attitude_euler(AttitudeEulerCallback callback)
+Telemetry::AttitudeEulerHandle Telemetry::subscribe_attitude_euler(
+    const AttitudeEulerCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_attitude_euler(callback, options);
+}
+
+void Telemetry::unsubscribe_attitude_euler(AttitudeEulerHandle handle)
 {
-    _impl->subscribe_attitude_euler(callback);
+    _impl->unsubscribe_attitude_euler(handle);
 }
 
 Telemetry::EulerAngle Telemetry::attitude_euler() const
@@ -129,10 +177,15 @@ Telemetry::EulerAngle Telemetry::attitude_euler() const
     return _impl->attitude_euler();
 }
 
-void Telemetry::subscribe_attitude_angular_velocity_body(
-    AttitudeAngularVelocityBodyCallback callback)
+Telemetry::AttitudeAngularVelocityBodyHandle Telemetry::subscribe_attitude_angular_velocity_body(
+    const AttitudeAngularVelocityBodyCallback& callback, const SubscriptionOptions& options)
 {
-    _impl->subscribe_attitude_angular_velocity_body(callback);
+    return _impl->subscribe_attitude_angular_velocity_body(callback, options);
+}
+
+void Telemetry::unsubscribe_attitude_angular_velocity_body(AttitudeAngularVelocityBodyHandle handle)
+{
+    _impl->unsubscribe_attitude_angular_velocity_body(handle);
 }
 
 Telemetry::AngularVelocityBody Telemetry::attitude_angular_velocity_body() const
@@ -140,9 +193,15 @@ Telemetry::AngularVelocityBody Telemetry::attitude_angular_velocity_body() const
     return _impl->attitude_angular_velocity_body();
 }
 
-void Telemetry::subscribe_camera_attitude_quaternion(CameraAttitudeQuaternionCallback callback)
+Telemetry::CameraAttitudeQuaternionHandle Telemetry::subscribe_camera_attitude_quaternion(
+    const CameraAttitudeQuaternionCallback& callback, const SubscriptionOptions& options)
 {
-    _impl->subscribe_camera_attitude_quaternion(callback);
+    return _impl->subscribe_camera_attitude_quaternion(callback, options);
+}
+
+void Telemetry::unsubscribe_camera_attitude_quaternion(CameraAttitudeQuaternionHandle handle)
+{
+    _impl->unsubscribe_camera_attitude_quaternion(handle);
 }
 
 Telemetry::Quaternion Telemetry::camera_attitude_quaternion() const
@@ -150,9 +209,15 @@ Telemetry::Quaternion Telemetry::camera_attitude_quaternion() const
     return _impl->camera_attitude_quaternion();
 }
 
-void Telemetry::subscribe_camera_attitude_euler(CameraAttitudeEulerCallback callback)
+Telemetry::CameraAttitudeEulerHandle Telemetry::subscribe_camera_attitude_euler(
+    const CameraAttitudeEulerCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_camera_attitude_euler(callback, options);
+}
+
+void Telemetry::unsubscribe_camera_attitude_euler(CameraAttitudeEulerHandle handle)
 {
-    _impl->subscribe_camera_attitude_euler(callback);
+    _impl->unsubscribe_camera_attitude_euler(handle);
 }
 
 Telemetry::EulerAngle Telemetry::camera_attitude_euler() const
@@ -160,9 +225,15 @@ Telemetry::EulerAngle Telemetry::camera_attitude_euler() const
     return _impl->camera_attitude_euler();
 }
 
-void Telemetry::subscribe_velocity_ned(VelocityNedCallback callback)
+Telemetry::VelocityNedHandle Telemetry::subscribe_velocity_ned(
+    const VelocityNedCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_velocity_ned(callback, options);
+}
+
+void Telemetry::unsubscribe_velocity_ned(VelocityNedHandle handle)
 {
-    _impl->subscribe_velocity_ned(callback);
+    _impl->unsubscribe_velocity_ned(handle);
 }
 
 Telemetry::VelocityNed Telemetry::velocity_ned() const
@@ -170,9 +241,15 @@ Telemetry::VelocityNed Telemetry::velocity_ned() const
     return _impl->velocity_ned();
 }
 
-void Telemetry::subscribe_gps_info(GpsInfoCallback callback)
+Telemetry::GpsInfoHandle Telemetry::subscribe_gps_info(
+    const GpsInfoCallback& callback, const SubscriptionOptions& options)
 {
-    _impl->subscribe_gps_info(callback);
+    return _impl->subscribe_gps_info(callback, options);
+}
+
+void Telemetry::unsubscribe_gps_info(GpsInfoHandle handle)
+{
+    _impl->unsubscribe_gps_info(handle);
 }
 
 Telemetry::GpsInfo Telemetry::gps_info() const
@@ -180,9 +257,15 @@ Telemetry::GpsInfo Telemetry::gps_info() const
     return _impl->gps_info();
 }
 
-void Telemetry::subscribe_raw_gps(RawGpsCallback callback)
+Telemetry::RawGpsHandle Telemetry::subscribe_raw_gps(
+    const RawGpsCallback& callback, const SubscriptionOptions& options)
 {
-    _impl->subscribe_raw_gps(callback);
+    return _impl->subscribe_raw_gps(callback, options);
+}
+
+void Telemetry::unsubscribe_raw_gps(RawGpsHandle handle)
+{
+    _impl->unsubscribe_raw_gps(handle);
 }
 
 Telemetry::RawGps Telemetry::raw_gps() const
@@ -190,9 +273,15 @@ Telemetry::RawGps Telemetry::raw_gps() const
     return _impl->raw_gps();
 }
 
-void Telemetry::subscribe_battery(BatteryCallback callback)
+Telemetry::BatteryHandle Telemetry::subscribe_battery(
+    const BatteryCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_battery(callback, options);
+}
+
+void Telemetry::unsubscribe_battery(BatteryHandle handle)
 {
-    _impl->subscribe_battery(callback);
+    _impl->unsubscribe_battery(handle);
 }
 
 Telemetry::Battery Telemetry::battery() const
@@ -200,9 +289,15 @@ Telemetry::Battery Telemetry::battery() const
     return _impl->battery();
 }
 
-void Telemetry::subscribe_flight_mode(FlightModeCallback callback)
+Telemetry::FlightModeHandle Telemetry::subscribe_flight_mode(
+    const FlightModeCallback& callback, const SubscriptionOptions& options)
 {
-    _impl->subscribe_flight_mode(callback);
+    return _impl->subscribe_flight_mode(callback, options);
+}
+
+void Telemetry::unsubscribe_flight_mode(FlightModeHandle handle)
+{
+    _impl->unsubscribe_flight_mode(handle);
 }
 
 Telemetry::FlightMode Telemetry::flight_mode() const
@@ -210,9 +305,15 @@ Telemetry::FlightMode Telemetry::flight_mode() const
     return _impl->flight_mode();
 }
 
-void Telemetry::subscribe_health(HealthCallback callback)
+Telemetry::HealthHandle Telemetry::subscribe_health(
+    const HealthCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_health(callback, options);
+}
+
+void Telemetry::unsubscribe_health(HealthHandle handle)
 {
-    _impl->subscribe_health(callback);
+    _impl->unsubscribe_health(handle);
 }
 
 Telemetry::Health Telemetry::health() const
@@ -220,9 +321,15 @@ Telemetry::Health Telemetry::health() const
     return _impl->health();
 }
 
-void Telemetry::subscribe_rc_status(RcStatusCallback callback)
+Telemetry::RcStatusHandle Telemetry::subscribe_rc_status(
+    const RcStatusCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_rc_status(callback, options);
+}
+
+void Telemetry::unsubscribe_rc_status(RcStatusHandle handle)
 {
-    _impl->subscribe_rc_status(callback);
+    _impl->unsubscribe_rc_status(handle);
 }
 
 Telemetry::RcStatus Telemetry::rc_status() const
@@ -230,9 +337,15 @@ Telemetry::RcStatus Telemetry::rc_status() const
     return _impl->rc_status();
 }
 
-void Telemetry::subscribe_status_text(StatusTextCallback callback)
+Telemetry::StatusTextHandle Telemetry::subscribe_status_text(
+    const StatusTextCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_status_text(callback, options);
+}
+
+void Telemetry::unsubscribe_status_text(StatusTextHandle handle)
 {
-    _impl->subscribe_status_text(callback);
+    _impl->unsubscribe_status_text(handle);
 }
 
 Telemetry::StatusText Telemetry::status_text() const
@@ -240,9 +353,15 @@ Telemetry::StatusText Telemetry::status_text() const
     return _impl->status_text();
 }
 
-void Telemetry::subscribe_actuator_control_target(ActuatorControlTargetCallback callback)
+Telemetry::ActuatorControlTargetHandle Telemetry::subscribe_actuator_control_target(
+    const ActuatorControlTargetCallback& callback, const SubscriptionOptions& options)
 {
-    _impl->subscribe_actuator_control_target(callback);
+    return _impl->subscribe_actuator_control_target(callback, options);
+}
+
+void Telemetry::unsubscribe_actuator_control_target(ActuatorControlTargetHandle handle)
+{
+    _impl->unsubscribe_actuator_control_target(handle);
 }
 
 Telemetry::ActuatorControlTarget Telemetry::actuator_control_target() const
@@ -250,9 +369,15 @@ Telemetry::ActuatorControlTarget Telemetry::actuator_control_target() const
     return _impl->actuator_control_target();
 }
 
-void Telemetry::subscribe_actuator_output_status(ActuatorOutputStatusCallback callback)
+Telemetry::ActuatorOutputStatusHandle Telemetry::subscribe_actuator_output_status(
+    const ActuatorOutputStatusCallback& callback, const SubscriptionOptions& options)
 {
-    _impl->subscribe_actuator_output_status(callback);
+    return _impl->subscribe_actuator_output_status(callback, options);
+}
+
+void Telemetry::unsubscribe_actuator_output_status(ActuatorOutputStatusHandle handle)
+{
+    _impl->unsubscribe_actuator_output_status(handle);
 }
 
 Telemetry::ActuatorOutputStatus Telemetry::actuator_output_status() const
@@ -260,9 +385,15 @@ Telemetry::ActuatorOutputStatus Telemetry::actuator_output_status() const
     return _impl->actuator_output_status();
 }
 
-void Telemetry::subscribe_odometry(OdometryCallback callback)
+Telemetry::OdometryHandle Telemetry::subscribe_odometry(
+    const OdometryCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_odometry(callback, options);
+}
+
+void Telemetry::unsubscribe_odometry(OdometryHandle handle)
 {
-    _impl->subscribe_odometry(callback);
+    _impl->unsubscribe_odometry(handle);
 }
 
 Telemetry::Odometry Telemetry::odometry() const
@@ -270,9 +401,15 @@ Telemetry::Odometry Telemetry::odometry() const
     return _impl->odometry();
 }
 
-void Telemetry::subscribe_position_velocity_ned(PositionVelocityNedCallback callback)
+Telemetry::PositionVelocityNedHandle Telemetry::subscribe_position_velocity_ned(
+    const PositionVelocityNedCallback& callback, const SubscriptionOptions& options)
 {
-    _impl->subscribe_position_velocity_ned(callback);
+    return _impl->subscribe_position_velocity_ned(callback, options);
+}
+
+void Telemetry::unsubscribe_position_velocity_ned(PositionVelocityNedHandle handle)
+{
+    _impl->unsubscribe_position_velocity_ned(handle);
 }
 
 Telemetry::PositionVelocityNed Telemetry::position_velocity_ned() const
@@ -280,9 +417,15 @@ Telemetry::PositionVelocityNed Telemetry::position_velocity_ned() const
     return _impl->position_velocity_ned();
 }
 
-void Telemetry::subscribe_ground_truth(GroundTruthCallback callback)
+Telemetry::GroundTruthHandle Telemetry::subscribe_ground_truth(
+    const GroundTruthCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_ground_truth(callback, options);
+}
+
+void Telemetry::unsubscribe_ground_truth(GroundTruthHandle handle)
 {
-    _impl->subscribe_ground_truth(callback);
+    _impl->unsubscribe_ground_truth(handle);
 }
 
 Telemetry::GroundTruth Telemetry::ground_truth() const
@@ -290,9 +433,15 @@ Telemetry::GroundTruth Telemetry::ground_truth() const
     return _impl->ground_truth();
 }
 
-void Telemetry::subscribe_fixedwing_metrics(FixedwingMetricsCallback callback)
+Telemetry::FixedwingMetricsHandle Telemetry::subscribe_fixedwing_metrics(
+    const FixedwingMetricsCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_fixedwing_metrics(callback, options);
+}
+
+void Telemetry::unsubscribe_fixedwing_metrics(FixedwingMetricsHandle handle)
 {
-    _impl->subscribe_fixedwing_metrics(callback);
+    _impl->unsubscribe_fixedwing_metrics(handle);
 }
 
 Telemetry::FixedwingMetrics Telemetry::fixedwing_metrics() const
@@ -300,9 +449,15 @@ Telemetry::FixedwingMetrics Telemetry::fixedwing_metrics() const
     return _impl->fixedwing_metrics();
 }
 
-void Telemetry::subscribe_imu(ImuCallback callback)
+Telemetry::ImuHandle Telemetry::subscribe_imu(
+    const ImuCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_imu(callback, options);
+}
+
+void Telemetry::unsubscribe_imu(ImuHandle handle)
 {
-    _impl->subscribe_imu(callback);
+    _impl->unsubscribe_imu(handle);
 }
 
 Telemetry::Imu Telemetry::imu() const
@@ -310,9 +465,15 @@ Telemetry::Imu Telemetry::imu() const
     return _impl->imu();
 }
 
-void Telemetry::subscribe_scaled_imu(ScaledImuCallback callback)
+Telemetry::ScaledImuHandle Telemetry::subscribe_scaled_imu(
+    const ScaledImuCallback& callback, const SubscriptionOptions& options)
 {
-    _impl->subscribe_scaled_imu(callback);
+    return _impl->subscribe_scaled_imu(callback, options);
+}
+
+void Telemetry::unsubscribe_scaled_imu(ScaledImuHandle handle)
+{
+    _impl->unsubscribe_scaled_imu(handle);
 }
 
 Telemetry::Imu Telemetry::scaled_imu() const
@@ -320,9 +481,15 @@ Telemetry::Imu Telemetry::scaled_imu() const
     return _impl->scaled_imu();
 }
 
-void Telemetry::subscribe_raw_imu(RawImuCallback callback)
+Telemetry::RawImuHandle Telemetry::subscribe_raw_imu(
+    const RawImuCallback& callback, const SubscriptionOptions& options)
 {
-    _impl->subscribe_raw_imu(callback);
+    return _impl->subscribe_raw_imu(callback, options);
+}
+
+void Telemetry::unsubscribe_raw_imu(RawImuHandle handle)
+{
+    _impl->unsubscribe_raw_imu(handle);
 }
 
 Telemetry::Imu Telemetry::raw_imu() const
@@ -330,9 +497,15 @@ Telemetry::Imu Telemetry::raw_imu() const
     return _impl->raw_imu();
 }
 
-void Telemetry::subscribe_health_all_ok(HealthAllOkCallback callback)
+Telemetry::HealthAllOkHandle Telemetry::subscribe_health_all_ok(
+    const HealthAllOkCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_health_all_ok(callback, options);
+}
+
+void Telemetry::unsubscribe_health_all_ok(HealthAllOkHandle handle)
 {
-    _impl->subscribe_health_all_ok(callback);
+    _impl->unsubscribe_health_all_ok(handle);
 }
 
 bool Telemetry::health_all_ok() const
@@ -340,9 +513,15 @@ bool Telemetry::health_all_ok() const
     return _impl->health_all_ok();
 }
 
-void Telemetry::subscribe_unix_epoch_time(UnixEpochTimeCallback callback)
+Telemetry::UnixEpochTimeHandle Telemetry::subscribe_unix_epoch_time(
+    const UnixEpochTimeCallback& callback, const SubscriptionOptions& options)
 {
-    _impl->subscribe_unix_epoch_time(callback);
+    return _impl->subscribe_unix_epoch_time(callback, options);
+}
+
+void Telemetry::unsubscribe_unix_epoch_time(UnixEpochTimeHandle handle)
+{
+    _impl->unsubscribe_unix_epoch_time(handle);
 }
 
 uint64_t Telemetry::unix_epoch_time() const
@@ -350,9 +529,15 @@ uint64_t Telemetry::unix_epoch_time() const
     return _impl->unix_epoch_time();
 }
 
-void Telemetry::subscribe_distance_sensor(DistanceSensorCallback callback)
+Telemetry::DistanceSensorHandle Telemetry::subscribe_distance_sensor(
+    const DistanceSensorCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_distance_sensor(callback, options);
+}
+
+void Telemetry::unsubscribe_distance_sensor(DistanceSensorHandle handle)
 {
-    _impl->subscribe_distance_sensor(callback);
+    _impl->unsubscribe_distance_sensor(handle);
 }
 
 Telemetry::DistanceSensor Telemetry::distance_sensor() const
@@ -360,9 +545,15 @@ Telemetry::DistanceSensor Telemetry::distance_sensor() const
     return _impl->distance_sensor();
 }
 
-void Telemetry::subscribe_scaled_pressure(ScaledPressureCallback callback)
+Telemetry::ScaledPressureHandle Telemetry::subscribe_scaled_pressure(
+    const ScaledPressureCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_scaled_pressure(callback, options);
+}
+
+void Telemetry::unsubscribe_scaled_pressure(ScaledPressureHandle handle)
 {
-    _impl->subscribe_scaled_pressure(callback);
+    _impl->unsubscribe_scaled_pressure(handle);
 }
 
 Telemetry::ScaledPressure Telemetry::scaled_pressure() const
@@ -370,9 +561,15 @@ Telemetry::ScaledPressure Telemetry::scaled_pressure() const
     return _impl->scaled_pressure();
 }
 
-void Telemetry::subscribe_heading(HeadingCallback callback)
+Telemetry::HeadingHandle Telemetry::subscribe_heading(
+    const HeadingCallback& callback, const SubscriptionOptions& options)
+{
+    return _impl->subscribe_heading(callback, options);
+}
+
+void Telemetry::unsubscribe_heading(HeadingHandle handle)
 {
-    _impl->subscribe_heading(callback);
+    _impl->unsubscribe_heading(handle);
 }
 
 Telemetry::Heading Telemetry::heading() const
@@ -1407,4 +1604,332 @@ std::ostream& operator<<(std::ostream& str, Telemetry::VtolState const& vtol_sta
     }
 }
 
+Telemetry::Snapshot Telemetry::snapshot(uint32_t fields) const
+{
+    return _impl->snapshot(fields);
+}
+
+bool operator==(const Telemetry::Snapshot& lhs, const Telemetry::Snapshot& rhs)
+{
+    return (rhs.fields == lhs.fields) &&
+           (rhs.position == lhs.position) &&
+           (rhs.position_receive_time_us == lhs.position_receive_time_us) &&
+           (rhs.heading == lhs.heading) &&
+           (rhs.heading_receive_time_us == lhs.heading_receive_time_us) &&
+           (rhs.velocity_ned == lhs.velocity_ned) &&
+           (rhs.velocity_ned_receive_time_us == lhs.velocity_ned_receive_time_us) &&
+           (rhs.position_velocity_ned == lhs.position_velocity_ned) &&
+           (rhs.position_velocity_ned_receive_time_us ==
+            lhs.position_velocity_ned_receive_time_us) &&
+           (rhs.attitude_quaternion == lhs.attitude_quaternion) &&
+           (rhs.attitude_quaternion_receive_time_us == lhs.attitude_quaternion_receive_time_us) &&
+           (rhs.attitude_angular_velocity_body == lhs.attitude_angular_velocity_body) &&
+           (rhs.attitude_angular_velocity_body_receive_time_us ==
+            lhs.attitude_angular_velocity_body_receive_time_us) &&
+           (rhs.imu == lhs.imu) &&
+           (rhs.imu_receive_time_us == lhs.imu_receive_time_us) &&
+           (rhs.scaled_imu == lhs.scaled_imu) &&
+           (rhs.scaled_imu_receive_time_us == lhs.scaled_imu_receive_time_us) &&
+           (rhs.raw_imu == lhs.raw_imu) &&
+           (rhs.raw_imu_receive_time_us == lhs.raw_imu_receive_time_us) &&
+           (rhs.ground_truth == lhs.ground_truth) &&
+           (rhs.ground_truth_receive_time_us == lhs.ground_truth_receive_time_us);
+}
+
+std::ostream& operator<<(std::ostream& str, Telemetry::Snapshot const& snapshot)
+{
+    str << std::setprecision(15);
+    str << "snapshot:" << '\n' << "{\n";
+    str << "    fields: " << snapshot.fields << '\n';
+    str << "    position: " << snapshot.position << '\n';
+    str << "    position_receive_time_us: " << snapshot.position_receive_time_us << '\n';
+    str << "    heading: " << snapshot.heading << '\n';
+    str << "    heading_receive_time_us: " << snapshot.heading_receive_time_us << '\n';
+    str << "    velocity_ned: " << snapshot.velocity_ned << '\n';
+    str << "    velocity_ned_receive_time_us: " << snapshot.velocity_ned_receive_time_us << '\n';
+    str << "    position_velocity_ned: " << snapshot.position_velocity_ned << '\n';
+    str << "    position_velocity_ned_receive_time_us: "
+        << snapshot.position_velocity_ned_receive_time_us << '\n';
+    str << "    attitude_quaternion: " << snapshot.attitude_quaternion << '\n';
+    str << "    attitude_quaternion_receive_time_us: "
+        << snapshot.attitude_quaternion_receive_time_us << '\n';
+    str << "    attitude_angular_velocity_body: "
+        << snapshot.attitude_angular_velocity_body << '\n';
+    str << "    attitude_angular_velocity_body_receive_time_us: "
+        << snapshot.attitude_angular_velocity_body_receive_time_us << '\n';
+    str << "    imu: " << snapshot.imu << '\n';
+    str << "    imu_receive_time_us: " << snapshot.imu_receive_time_us << '\n';
+    str << "    scaled_imu: " << snapshot.scaled_imu << '\n';
+    str << "    scaled_imu_receive_time_us: " << snapshot.scaled_imu_receive_time_us << '\n';
+    str << "    raw_imu: " << snapshot.raw_imu << '\n';
+    str << "    raw_imu_receive_time_us: " << snapshot.raw_imu_receive_time_us << '\n';
+    str << "    ground_truth: " << snapshot.ground_truth << '\n';
+    str << "    ground_truth_receive_time_us: " << snapshot.ground_truth_receive_time_us << '\n';
+    str << '}';
+    return str;
+}
+
+void Telemetry::set_rates_async(
+    std::vector<RateRequest> rate_requests, const SetRatesCallback callback)
+{
+    _impl->set_rates_async(rate_requests, callback);
+}
+
+Telemetry::Result Telemetry::set_rates(std::vector<RateRequest> rate_requests) const
+{
+    return _impl->set_rates(rate_requests);
+}
+
+std::ostream& operator<<(std::ostream& str, Telemetry::RateTopic const& rate_topic)
+{
+    switch (rate_topic) {
+        case Telemetry::RateTopic::Position:
+            return str << "Position";
+        case Telemetry::RateTopic::Home:
+            return str << "Home";
+        case Telemetry::RateTopic::InAir:
+            return str << "In Air";
+        case Telemetry::RateTopic::LandedState:
+            return str << "Landed State";
+        case Telemetry::RateTopic::VtolState:
+            return str << "Vtol State";
+        case Telemetry::RateTopic::Attitude:
+            return str << "Attitude";
+        case Telemetry::RateTopic::CameraAttitude:
+            return str << "Camera Attitude";
+        case Telemetry::RateTopic::VelocityNed:
+            return str << "Velocity Ned";
+        case Telemetry::RateTopic::GpsInfo:
+            return str << "Gps Info";
+        case Telemetry::RateTopic::Battery:
+            return str << "Battery";
+        case Telemetry::RateTopic::RcStatus:
+            return str << "Rc Status";
+        case Telemetry::RateTopic::ActuatorControlTarget:
+            return str << "Actuator Control Target";
+        case Telemetry::RateTopic::ActuatorOutputStatus:
+            return str << "Actuator Output Status";
+        case Telemetry::RateTopic::Odometry:
+            return str << "Odometry";
+        case Telemetry::RateTopic::PositionVelocityNed:
+            return str << "Position Velocity Ned";
+        case Telemetry::RateTopic::GroundTruth:
+            return str << "Ground Truth";
+        case Telemetry::RateTopic::FixedwingMetrics:
+            return str << "Fixedwing Metrics";
+        case Telemetry::RateTopic::Imu:
+            return str << "Imu";
+        case Telemetry::RateTopic::ScaledImu:
+            return str << "Scaled Imu";
+        case Telemetry::RateTopic::RawImu:
+            return str << "Raw Imu";
+        case Telemetry::RateTopic::UnixEpochTime:
+            return str << "Unix Epoch Time";
+        case Telemetry::RateTopic::DistanceSensor:
+            return str << "Distance Sensor";
+        default:
+            return str << "Unknown";
+    }
+}
+
+bool operator==(const Telemetry::RateRequest& lhs, const Telemetry::RateRequest& rhs)
+{
+    return (rhs.topic == lhs.topic) &&
+           ((std::isnan(rhs.rate_hz) && std::isnan(lhs.rate_hz)) || rhs.rate_hz == lhs.rate_hz);
+}
+
+std::ostream& operator<<(std::ostream& str, Telemetry::RateRequest const& rate_request)
+{
+    str << std::setprecision(15);
+    str << "rate_request:" << '\n' << "{\n";
+    str << "    topic: " << rate_request.topic << '\n';
+    str << "    rate_hz: " << rate_request.rate_hz << '\n';
+    str << '}';
+    return str;
+}
+
+void Telemetry::set_history_enabled(HistoryTopic topic, bool enabled)
+{
+    _impl->set_history_enabled(topic, enabled);
+}
+
+std::vector<std::pair<uint64_t, Telemetry::Position>>
+Telemetry::position_history(uint64_t start_time_us, uint64_t end_time_us) const
+{
+    return _impl->position_history(start_time_us, end_time_us);
+}
+
+std::optional<Telemetry::Position> Telemetry::position_at(uint64_t time_us) const
+{
+    return _impl->position_at(time_us);
+}
+
+std::vector<std::pair<uint64_t, Telemetry::Quaternion>>
+Telemetry::attitude_quaternion_history(uint64_t start_time_us, uint64_t end_time_us) const
+{
+    return _impl->attitude_quaternion_history(start_time_us, end_time_us);
+}
+
+std::optional<Telemetry::Quaternion> Telemetry::attitude_quaternion_at(uint64_t time_us) const
+{
+    return _impl->attitude_quaternion_at(time_us);
+}
+
+std::vector<std::pair<uint64_t, Telemetry::VelocityNed>>
+Telemetry::velocity_ned_history(uint64_t start_time_us, uint64_t end_time_us) const
+{
+    return _impl->velocity_ned_history(start_time_us, end_time_us);
+}
+
+std::optional<Telemetry::VelocityNed> Telemetry::velocity_ned_at(uint64_t time_us) const
+{
+    return _impl->velocity_ned_at(time_us);
+}
+
+std::vector<std::pair<uint64_t, Telemetry::Imu>>
+Telemetry::imu_history(uint64_t start_time_us, uint64_t end_time_us) const
+{
+    return _impl->imu_history(start_time_us, end_time_us);
+}
+
+std::optional<Telemetry::Imu> Telemetry::imu_at(uint64_t time_us) const
+{
+    return _impl->imu_at(time_us);
+}
+
+std::ostream& operator<<(std::ostream& str, Telemetry::HistoryTopic const& history_topic)
+{
+    switch (history_topic) {
+        case Telemetry::HistoryTopic::Position:
+            return str << "Position";
+        case Telemetry::HistoryTopic::AttitudeQuaternion:
+            return str << "Attitude Quaternion";
+        case Telemetry::HistoryTopic::VelocityNed:
+            return str << "Velocity Ned";
+        case Telemetry::HistoryTopic::Imu:
+            return str << "Imu";
+        default:
+            return str << "Unknown";
+    }
+}
+
+std::vector<std::pair<uint64_t, Telemetry::EulerAngle>>
+Telemetry::attitude_euler_history(uint64_t start_time_us, uint64_t end_time_us) const
+{
+    return _impl->attitude_euler_history(start_time_us, end_time_us);
+}
+
+Telemetry::ImuBatchHandle
+Telemetry::subscribe_imu_batch(const ImuBatchCallback& callback, const BatchOptions& options)
+{
+    return _impl->subscribe_imu_batch(callback, options);
+}
+
+void Telemetry::unsubscribe_imu_batch(ImuBatchHandle handle)
+{
+    _impl->unsubscribe_imu_batch(handle);
+}
+
+Telemetry::ImuBatchHandle
+Telemetry::subscribe_scaled_imu_batch(const ImuBatchCallback& callback, const BatchOptions& options)
+{
+    return _impl->subscribe_scaled_imu_batch(callback, options);
+}
+
+void Telemetry::unsubscribe_scaled_imu_batch(ImuBatchHandle handle)
+{
+    _impl->unsubscribe_scaled_imu_batch(handle);
+}
+
+Telemetry::ImuBatchHandle
+Telemetry::subscribe_raw_imu_batch(const ImuBatchCallback& callback, const BatchOptions& options)
+{
+    return _impl->subscribe_raw_imu_batch(callback, options);
+}
+
+void Telemetry::unsubscribe_raw_imu_batch(ImuBatchHandle handle)
+{
+    _impl->unsubscribe_raw_imu_batch(handle);
+}
+
+void Telemetry::fleet_snapshot(FleetSnapshot& snapshot)
+{
+    FleetTable::instance().snapshot(snapshot);
+}
+
+void Telemetry::fleet_pairs_within(
+    const FleetSnapshot& snapshot, double distance_m, std::vector<FleetPair>& pairs)
+{
+    FleetTable::pairs_within(snapshot, distance_m, pairs);
+}
+
+Telemetry::Result Telemetry::enable_rate_adaptation(RateAdaptationConfig config) const
+{
+    return _impl->enable_rate_adaptation(config);
+}
+
+void Telemetry::disable_rate_adaptation() const
+{
+    _impl->disable_rate_adaptation();
+}
+
+double Telemetry::rate_adaptation_scale() const
+{
+    return _impl->rate_adaptation_scale();
+}
+
+bool operator==(const Telemetry::AdaptiveRate& lhs, const Telemetry::AdaptiveRate& rhs)
+{
+    return (rhs.topic == lhs.topic) &&
+           ((std::isnan(rhs.min_rate_hz) && std::isnan(lhs.min_rate_hz)) ||
+            rhs.min_rate_hz == lhs.min_rate_hz) &&
+           ((std::isnan(rhs.max_rate_hz) && std::isnan(lhs.max_rate_hz)) ||
+            rhs.max_rate_hz == lhs.max_rate_hz);
+}
+
+std::ostream& operator<<(std::ostream& str, Telemetry::AdaptiveRate const& adaptive_rate)
+{
+    str << std::setprecision(15);
+    str << "adaptive_rate:" << '\n' << "{\n";
+    str << "    topic: " << adaptive_rate.topic << '\n';
+    str << "    min_rate_hz: " << adaptive_rate.min_rate_hz << '\n';
+    str << "    max_rate_hz: " << adaptive_rate.max_rate_hz << '\n';
+    str << '}';
+    return str;
+}
+
+bool operator==(
+    const Telemetry::RateAdaptationConfig& lhs, const Telemetry::RateAdaptationConfig& rhs)
+{
+    return (rhs.rates == lhs.rates) &&
+           ((std::isnan(rhs.max_loss_rate) && std::isnan(lhs.max_loss_rate)) ||
+            rhs.max_loss_rate == lhs.max_loss_rate) &&
+           ((std::isnan(rhs.max_rtt_factor) && std::isnan(lhs.max_rtt_factor)) ||
+            rhs.max_rtt_factor == lhs.max_rtt_factor) &&
+           ((std::isnan(rhs.link_bytes_per_s) && std::isnan(lhs.link_bytes_per_s)) ||
+            rhs.link_bytes_per_s == lhs.link_bytes_per_s) &&
+           ((std::isnan(rhs.headroom) && std::isnan(lhs.headroom)) ||
+            rhs.headroom == lhs.headroom);
+}
+
+std::ostream&
+operator<<(std::ostream& str, Telemetry::RateAdaptationConfig const& rate_adaptation_config)
+{
+    str << std::setprecision(15);
+    str << "rate_adaptation_config:" << '\n' << "{\n";
+    str << "    rates: [";
+    for (auto it = rate_adaptation_config.rates.begin();
+         it != rate_adaptation_config.rates.end();
+         ++it) {
+        str << *it;
+        str << (it + 1 != rate_adaptation_config.rates.end() ? ", " : "]\n");
+    }
+    str << "    max_loss_rate: " << rate_adaptation_config.max_loss_rate << '\n';
+    str << "    max_rtt_factor: " << rate_adaptation_config.max_rtt_factor << '\n';
+    str << "    link_bytes_per_s: " << rate_adaptation_config.link_bytes_per_s << '\n';
+    str << "    headroom: " << rate_adaptation_config.headroom << '\n';
+    str << '}';
+    return str;
+}
+
 } // namespace mavsdk
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "allocation_tracker.h"
+#include "mavsdk_impl.h"
+#include "null_connection.h"
+#include "plugins/telemetry/telemetry.h"
+
+using namespace mavsdk;
+
+namespace {
+
+void append(std::vector<uint8_t>& bytes, const mavlink_message_t& message)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const auto length = mavlink_msg_to_send_buffer(buffer, &message);
+    bytes.insert(bytes.end(), buffer, buffer + length);
+}
+
+// What a PX4 autopilot sends for the subscriptions below.
+std::vector<uint8_t> make_stream()
+{
+    std::vector<uint8_t> bytes;
+    mavlink_message_t message;
+
+    mavlink_heartbeat_t heartbeat{};
+    heartbeat.type = MAV_TYPE_QUADROTOR;
+    heartbeat.autopilot = MAV_AUTOPILOT_PX4;
+    heartbeat.system_status = MAV_STATE_ACTIVE;
+    mavlink_msg_heartbeat_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &heartbeat);
+    append(bytes, message);
+
+    for (uint32_t i = 0; i < 10; ++i) {
+        mavlink_global_position_int_t global_position_int{};
+        global_position_int.time_boot_ms = 1000 + i * 20;
+        global_position_int.lat = 473977418;
+        global_position_int.lon = 85455939;
+        global_position_int.alt = 488000;
+        global_position_int.relative_alt = 10000;
+        mavlink_msg_global_position_int_encode(
+            1, MAV_COMP_ID_AUTOPILOT1, &message, &global_position_int);
+        append(bytes, message);
+
+        mavlink_attitude_t attitude{};
+        attitude.time_boot_ms = 1000 + i * 20;
+        attitude.roll = 0.1f;
+        attitude.pitch = -0.05f;
+        attitude.yaw = 1.5f;
+        mavlink_msg_attitude_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &attitude);
+        append(bytes, message);
+    }
+
+    return bytes;
+}
+
+} // namespace
+
+// Receiving, dispatching and decoding telemetry, and queueing the user
+// callbacks for it, must not allocate anything once the system is known and
+// the subscriptions are set up.
+TEST(TelemetryAllocation, ZeroAllocationsPerMessageAfterWarmUp)
+{
+    if (!AllocationTracker::enabled()) {
+        GTEST_SKIP() << "Built without MAVSDK_ALLOCATION_TRACKING";
+    }
+
+    auto bytes = make_stream();
+
+    // Outlives MavsdkImpl, which calls whatever callbacks are still queued.
+    std::atomic<uint64_t> num_callbacks{0};
+
+    // Dispatched right away, so receiving and dispatching is all on this thread.
+    Mavsdk::Configuration configuration{Mavsdk::Configuration::UsageType::GroundStation};
+    configuration.set_dispatch_threads(0);
+    MavsdkImpl mavsdk_impl{configuration};
+    auto connection = std::make_shared<NullConnection>(
+        [&mavsdk_impl](mavlink_message_t& message, Connection* from) {
+            mavsdk_impl.receive_message(message, from);
+        });
+    connection->start();
+    mavsdk_impl.add_connection(connection);
+
+    // The first heartbeat creates the system.
+    connection->receive(bytes.data(), static_cast<unsigned>(bytes.size()));
+    const auto systems = mavsdk_impl.systems();
+    ASSERT_FALSE(systems.empty());
+
+    Telemetry telemetry{systems.front()};
+    telemetry.subscribe_position([&](Telemetry::Position) { ++num_callbacks; });
+    telemetry.subscribe_attitude_euler([&](Telemetry::EulerAngle) { ++num_callbacks; });
+
+    // Anything set up the first time a message is seen is set up by now.
+    for (unsigned i = 0; i < 10; ++i) {
+        connection->receive(bytes.data(), static_cast<unsigned>(bytes.size()));
+    }
+
+    const auto before = AllocationTracker::this_thread();
+    const auto callbacks_before = AllocationTracker::total();
+    for (unsigned i = 0; i < 100; ++i) {
+        connection->receive(bytes.data(), static_cast<unsigned>(bytes.size()));
+    }
+    const auto after = AllocationTracker::this_thread();
+
+    for (int i = 0; i < 1000 && mavsdk_impl.callback_queue_stats().depth > 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const auto callbacks_after = AllocationTracker::total();
+
+    EXPECT_GT(num_callbacks, 0);
+    for (const auto region :
+         {AllocationRegion::Receive, AllocationRegion::Dispatch, AllocationRegion::Other}) {
+        EXPECT_EQ(after.allocations_in(region), before.allocations_in(region))
+            << AllocationTracker::region_name(region);
+    }
+    EXPECT_EQ(
+        callbacks_after.allocations_in(AllocationRegion::Callback),
+        callbacks_before.allocations_in(AllocationRegion::Callback));
+}
@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include "benchmark_helpers.h"
+#include "mavsdk_impl.h"
+#include "null_connection.h"
+#include "plugins/telemetry/telemetry.h"
+
+using namespace mavsdk;
+
+// The whole receive path of a ground station: parsing the PX4 default
+// streams, dispatching them to Telemetry, decoding them there, and queueing
+// the user callbacks of a few typical subscriptions.
+static void Telemetry_ReceiveAndDecode(benchmark::State& state)
+{
+    const auto messages = px4_default_stream_mix(static_cast<unsigned>(state.range(0)));
+    auto bytes = serialize(messages);
+
+    // Outlives MavsdkImpl, which calls whatever callbacks are still queued.
+    std::atomic<uint64_t> num_callbacks{0};
+
+    // Dispatched right away, so it's all measured on this thread.
+    Mavsdk::Configuration configuration{Mavsdk::Configuration::UsageType::GroundStation};
+    configuration.set_dispatch_threads(0);
+    MavsdkImpl mavsdk_impl{configuration};
+    auto connection = std::make_shared<NullConnection>(
+        [&mavsdk_impl](mavlink_message_t& message, Connection* from) {
+            mavsdk_impl.receive_message(message, from);
+        });
+    connection->start();
+    mavsdk_impl.add_connection(connection);
+
+    // The first heartbeat creates the system.
+    connection->receive(bytes.data(), static_cast<unsigned>(bytes.size()));
+    const auto systems = mavsdk_impl.systems();
+    if (systems.empty()) {
+        state.SkipWithError("No system discovered");
+        return;
+    }
+
+    Telemetry telemetry{systems.front()};
+    telemetry.subscribe_position([&](Telemetry::Position) { ++num_callbacks; });
+    telemetry.subscribe_attitude_euler([&](Telemetry::EulerAngle) { ++num_callbacks; });
+    telemetry.subscribe_battery([&](Telemetry::Battery) { ++num_callbacks; });
+    telemetry.subscribe_gps_info([&](Telemetry::GpsInfo) { ++num_callbacks; });
+
+    constexpr std::size_t datagram_size = 1200;
+    for (auto _ : state) {
+        for (std::size_t offset = 0; offset < bytes.size(); offset += datagram_size) {
+            const auto length = std::min(datagram_size, bytes.size() - offset);
+            connection->receive(bytes.data() + offset, static_cast<unsigned>(length));
+        }
+    }
+
+    count_messages(state, messages.size());
+    state.counters["callbacks"] = static_cast<double>(num_callbacks.load());
+}
+BENCHMARK(Telemetry_ReceiveAndDecode)->Apply(px4_stream_scales)->UseRealTime();
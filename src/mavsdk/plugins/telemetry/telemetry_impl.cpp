@@ -2,6 +2,8 @@
 #include "system.h"
 #include "math_conversions.h"
 #include "mavsdk_math.h"
+#include "sync_waiter.h"
+#include <algorithm>
 #include <cmath>
 #include <functional>
 #include <string>
@@ -11,6 +13,97 @@
 
 namespace mavsdk {
 
+template<typename T> static T lerp(T before, T after, double fraction)
+{
+    return static_cast<T>(before + (after - before) * fraction);
+}
+
+static uint64_t lerp_timestamp(uint64_t before, uint64_t after, double fraction)
+{
+    return after >= before ? before + static_cast<uint64_t>((after - before) * fraction) :
+                             before - static_cast<uint64_t>((before - after) * fraction);
+}
+
+static Telemetry::Position interpolate_position(
+    const Telemetry::Position& before, const Telemetry::Position& after, double fraction)
+{
+    // Linear in degrees is fine for the short time between two samples.
+    Telemetry::Position position;
+    position.latitude_deg = lerp(before.latitude_deg, after.latitude_deg, fraction);
+    position.longitude_deg = lerp(before.longitude_deg, after.longitude_deg, fraction);
+    position.absolute_altitude_m =
+        lerp(before.absolute_altitude_m, after.absolute_altitude_m, fraction);
+    position.relative_altitude_m =
+        lerp(before.relative_altitude_m, after.relative_altitude_m, fraction);
+    return position;
+}
+
+static Telemetry::Quaternion interpolate_quaternion(
+    const Telemetry::Quaternion& before, const Telemetry::Quaternion& after, double fraction)
+{
+    // Normalized linear interpolation, taking the shorter way around.
+    const float dot =
+        before.w * after.w + before.x * after.x + before.y * after.y + before.z * after.z;
+    const float sign = dot < 0.0f ? -1.0f : 1.0f;
+
+    Telemetry::Quaternion quaternion;
+    quaternion.w = lerp(before.w, sign * after.w, fraction);
+    quaternion.x = lerp(before.x, sign * after.x, fraction);
+    quaternion.y = lerp(before.y, sign * after.y, fraction);
+    quaternion.z = lerp(before.z, sign * after.z, fraction);
+
+    const float norm = std::sqrt(
+        quaternion.w * quaternion.w + quaternion.x * quaternion.x + quaternion.y * quaternion.y +
+        quaternion.z * quaternion.z);
+    if (norm > 0.0f) {
+        quaternion.w /= norm;
+        quaternion.x /= norm;
+        quaternion.y /= norm;
+        quaternion.z /= norm;
+    }
+    quaternion.timestamp_us = lerp_timestamp(before.timestamp_us, after.timestamp_us, fraction);
+    return quaternion;
+}
+
+static Telemetry::VelocityNed interpolate_velocity_ned(
+    const Telemetry::VelocityNed& before, const Telemetry::VelocityNed& after, double fraction)
+{
+    Telemetry::VelocityNed velocity_ned;
+    velocity_ned.north_m_s = lerp(before.north_m_s, after.north_m_s, fraction);
+    velocity_ned.east_m_s = lerp(before.east_m_s, after.east_m_s, fraction);
+    velocity_ned.down_m_s = lerp(before.down_m_s, after.down_m_s, fraction);
+    return velocity_ned;
+}
+
+static Telemetry::Imu interpolate_imu(
+    const Telemetry::Imu& before, const Telemetry::Imu& after, double fraction)
+{
+    Telemetry::Imu imu;
+    imu.acceleration_frd.forward_m_s2 = lerp(
+        before.acceleration_frd.forward_m_s2, after.acceleration_frd.forward_m_s2, fraction);
+    imu.acceleration_frd.right_m_s2 =
+        lerp(before.acceleration_frd.right_m_s2, after.acceleration_frd.right_m_s2, fraction);
+    imu.acceleration_frd.down_m_s2 =
+        lerp(before.acceleration_frd.down_m_s2, after.acceleration_frd.down_m_s2, fraction);
+    imu.angular_velocity_frd.forward_rad_s = lerp(
+        before.angular_velocity_frd.forward_rad_s,
+        after.angular_velocity_frd.forward_rad_s,
+        fraction);
+    imu.angular_velocity_frd.right_rad_s = lerp(
+        before.angular_velocity_frd.right_rad_s, after.angular_velocity_frd.right_rad_s, fraction);
+    imu.angular_velocity_frd.down_rad_s = lerp(
+        before.angular_velocity_frd.down_rad_s, after.angular_velocity_frd.down_rad_s, fraction);
+    imu.magnetic_field_frd.forward_gauss = lerp(
+        before.magnetic_field_frd.forward_gauss, after.magnetic_field_frd.forward_gauss, fraction);
+    imu.magnetic_field_frd.right_gauss = lerp(
+        before.magnetic_field_frd.right_gauss, after.magnetic_field_frd.right_gauss, fraction);
+    imu.magnetic_field_frd.down_gauss = lerp(
+        before.magnetic_field_frd.down_gauss, after.magnetic_field_frd.down_gauss, fraction);
+    imu.temperature_degc = lerp(before.temperature_degc, after.temperature_degc, fraction);
+    imu.timestamp_us = lerp_timestamp(before.timestamp_us, after.timestamp_us, fraction);
+    return imu;
+}
+
 TelemetryImpl::TelemetryImpl(System& system) : PluginImplBase(system)
 {
     _parent->register_plugin(this);
@@ -28,30 +121,25 @@ TelemetryImpl::~TelemetryImpl()
 
 void TelemetryImpl::init()
 {
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_LOCAL_POSITION_NED,
-        [this](const mavlink_message_t& message) { process_position_velocity_ned(message); },
-        this);
+    if (!_fleet_row) {
+        _fleet_row = FleetTable::instance().add(_parent->get_system_id());
+        if (!_fleet_row) {
+            LogWarn() << "Fleet table full, vehicle left out of fleet snapshots";
+        }
+    }
 
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
-        [this](const mavlink_message_t& message) { process_global_position_int(message); },
-        this);
+    register_mavlink_message_handler<&TelemetryImpl::process_position_velocity_ned>();
+
+    register_mavlink_message_handler<&TelemetryImpl::process_global_position_int>();
 
     _parent->register_mavlink_message_handler(
         MAVLINK_MSG_ID_HOME_POSITION,
         [this](const mavlink_message_t& message) { process_home_position(message); },
         this);
 
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_ATTITUDE,
-        [this](const mavlink_message_t& message) { process_attitude(message); },
-        this);
+    register_mavlink_message_handler<&TelemetryImpl::process_attitude>();
 
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_ATTITUDE_QUATERNION,
-        [this](const mavlink_message_t& message) { process_attitude_quaternion(message); },
-        this);
+    register_mavlink_message_handler<&TelemetryImpl::process_attitude_quaternion>();
 
     _parent->register_mavlink_message_handler(
         MAVLINK_MSG_ID_MOUNT_ORIENTATION,
@@ -105,53 +193,51 @@ void TelemetryImpl::init()
         [this](const mavlink_message_t& message) { process_actuator_output_status(message); },
         this);
 
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_ODOMETRY,
-        [this](const mavlink_message_t& message) { process_odometry(message); },
-        this);
+    register_mavlink_message_handler<&TelemetryImpl::process_odometry>();
 
     _parent->register_mavlink_message_handler(
         MAVLINK_MSG_ID_DISTANCE_SENSOR,
         [this](const mavlink_message_t& message) { process_distance_sensor(message); },
         this);
 
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_SCALED_PRESSURE,
-        [this](const mavlink_message_t& message) { process_scaled_pressure(message); },
-        this);
+    register_mavlink_message_handler<&TelemetryImpl::process_scaled_pressure>();
 
     _parent->register_mavlink_message_handler(
         MAVLINK_MSG_ID_UTM_GLOBAL_POSITION,
         [this](const mavlink_message_t& message) { process_unix_epoch_time(message); },
         this);
 
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_HIGHRES_IMU,
-        [this](const mavlink_message_t& message) { process_imu_reading_ned(message); },
-        this);
+    register_mavlink_message_handler<&TelemetryImpl::process_imu_reading_ned>();
 
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_SCALED_IMU,
-        [this](const mavlink_message_t& message) { process_scaled_imu(message); },
-        this);
+    register_mavlink_message_handler<&TelemetryImpl::process_scaled_imu>();
 
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_RAW_IMU,
-        [this](const mavlink_message_t& message) { process_raw_imu(message); },
-        this);
+    register_mavlink_message_handler<&TelemetryImpl::process_raw_imu>();
 
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_VFR_HUD,
-        [this](const mavlink_message_t& message) { process_fixedwing_metrics(message); },
-        this);
+    register_mavlink_message_handler<&TelemetryImpl::process_fixedwing_metrics>();
 
     _parent->register_mavlink_message_handler(
         MAVLINK_MSG_ID_HIL_STATE_QUATERNION,
         [this](const mavlink_message_t& message) { process_ground_truth(message); },
         this);
 
-    _parent->register_param_changed_handler(
-        [this](const std::string& name) { process_parameter_update(name); }, this);
+    // Calibration params of ArduPilot and PX4, as handled in process_parameter_update().
+    for (const char* name :
+         {"INS_GYROFFS_X",
+          "INS_GYROFFS_Y",
+          "INS_GYROFFS_Z",
+          "INS_ACCOFFS_X",
+          "INS_ACCOFFS_Y",
+          "INS_ACCOFFS_Z",
+          "COMPASS_OFS_X",
+          "COMPASS_OFS_Y",
+          "COMPASS_OFS_Z",
+          "CAL_GYRO0_ID",
+          "CAL_ACC0_ID",
+          "CAL_MAG0_ID",
+          "SYS_HITL"}) {
+        _parent->register_param_changed_handler(
+            name, [this](const std::string& changed) { process_parameter_update(changed); }, this);
+    }
 
     _parent->register_statustext_handler(
         [this](const MavlinkStatustextHandler::Statustext& statustext) {
@@ -163,12 +249,19 @@ void TelemetryImpl::init()
 void TelemetryImpl::deinit()
 {
     _parent->remove_call_every(_calibration_cookie);
+    _parent->remove_call_every(_imu_batch_cookie);
+    _parent->remove_call_every(_rate_adaptation_cookie);
     _parent->unregister_statustext_handler(this);
     _parent->unregister_timeout_handler(_gps_raw_timeout_cookie);
     _parent->unregister_timeout_handler(_unix_epoch_timeout_cookie);
     _parent->unregister_param_changed_handler(this);
     _parent->unregister_all_mavlink_message_handlers(this);
 
+    if (_fleet_row) {
+        FleetTable::instance().remove(*_fleet_row);
+        _fleet_row.reset();
+    }
+
     _has_received_gyro_calibration = false;
     _has_received_accel_calibration = false;
     _has_received_mag_calibration = false;
@@ -191,6 +284,12 @@ void TelemetryImpl::enable()
     //        For now, we just do the same as QGC does.
 
     _parent->add_call_every([this]() { check_calibration(); }, 5.0, &_calibration_cookie);
+
+    // Hands out what's left of the batches once the IMU stream stops.
+    _parent->add_call_every([this]() { flush_imu_batches(); }, 0.05f, &_imu_batch_cookie);
+
+    _parent->add_call_every(
+        [this]() { update_rate_adaptation(); }, 1.0f, &_rate_adaptation_cookie);
 }
 
 void TelemetryImpl::disable() {}
@@ -592,6 +691,54 @@ TelemetryImpl::telemetry_result_from_command_result(MavlinkCommandSender::Result
     }
 }
 
+uint16_t TelemetryImpl::message_id_from_rate_topic(Telemetry::RateTopic rate_topic)
+{
+    switch (rate_topic) {
+        case Telemetry::RateTopic::Position:
+        case Telemetry::RateTopic::VelocityNed:
+            return MAVLINK_MSG_ID_GLOBAL_POSITION_INT;
+        case Telemetry::RateTopic::Home:
+            return MAVLINK_MSG_ID_HOME_POSITION;
+        case Telemetry::RateTopic::InAir:
+        case Telemetry::RateTopic::LandedState:
+        case Telemetry::RateTopic::VtolState:
+            return MAVLINK_MSG_ID_EXTENDED_SYS_STATE;
+        case Telemetry::RateTopic::Attitude:
+            return MAVLINK_MSG_ID_ATTITUDE_QUATERNION;
+        case Telemetry::RateTopic::CameraAttitude:
+            return MAVLINK_MSG_ID_MOUNT_ORIENTATION;
+        case Telemetry::RateTopic::GpsInfo:
+            return MAVLINK_MSG_ID_GPS_RAW_INT;
+        case Telemetry::RateTopic::Battery:
+            return MAVLINK_MSG_ID_SYS_STATUS;
+        case Telemetry::RateTopic::RcStatus:
+            return MAVLINK_MSG_ID_RC_CHANNELS;
+        case Telemetry::RateTopic::ActuatorControlTarget:
+            return MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET;
+        case Telemetry::RateTopic::ActuatorOutputStatus:
+            return MAVLINK_MSG_ID_ACTUATOR_OUTPUT_STATUS;
+        case Telemetry::RateTopic::Odometry:
+            return MAVLINK_MSG_ID_ODOMETRY;
+        case Telemetry::RateTopic::PositionVelocityNed:
+            return MAVLINK_MSG_ID_LOCAL_POSITION_NED;
+        case Telemetry::RateTopic::GroundTruth:
+            return MAVLINK_MSG_ID_HIL_STATE_QUATERNION;
+        case Telemetry::RateTopic::FixedwingMetrics:
+            return MAVLINK_MSG_ID_VFR_HUD;
+        case Telemetry::RateTopic::Imu:
+            return MAVLINK_MSG_ID_HIGHRES_IMU;
+        case Telemetry::RateTopic::ScaledImu:
+            return MAVLINK_MSG_ID_SCALED_IMU;
+        case Telemetry::RateTopic::RawImu:
+            return MAVLINK_MSG_ID_RAW_IMU;
+        case Telemetry::RateTopic::UnixEpochTime:
+            return MAVLINK_MSG_ID_UTM_GLOBAL_POSITION;
+        case Telemetry::RateTopic::DistanceSensor:
+            return MAVLINK_MSG_ID_DISTANCE_SENSOR;
+    }
+    return 0;
+}
+
 void TelemetryImpl::command_result_callback(
     MavlinkCommandSender::Result command_result, const Telemetry::ResultCallback& callback)
 {
@@ -600,11 +747,9 @@ void TelemetryImpl::command_result_callback(
     callback(action_result);
 }
 
-void TelemetryImpl::process_position_velocity_ned(const mavlink_message_t& message)
+void TelemetryImpl::process_position_velocity_ned(
+    const mavlink_local_position_ned_t& local_position)
 {
-    mavlink_local_position_ned_t local_position;
-    mavlink_msg_local_position_ned_decode(&message, &local_position);
-
     Telemetry::PositionVelocityNed position_velocity;
     position_velocity.position.north_m = local_position.x;
     position_velocity.position.east_m = local_position.y;
@@ -615,64 +760,47 @@ void TelemetryImpl::process_position_velocity_ned(const mavlink_message_t& messa
 
     set_position_velocity_ned(position_velocity);
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_position_velocity_ned_subscription) {
-        auto callback = _position_velocity_ned_subscription;
-        auto arg = position_velocity_ned();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _position_velocity_ned_subscriptions.queue(
+        position_velocity_ned(),
+        [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
     set_health_local_position(true);
 }
 
-void TelemetryImpl::process_global_position_int(const mavlink_message_t& message)
+void TelemetryImpl::process_global_position_int(
+    const mavlink_global_position_int_t& global_position_int)
 {
-    mavlink_global_position_int_t global_position_int;
-    mavlink_msg_global_position_int_decode(&message, &global_position_int);
+    Telemetry::Position position;
+    position.latitude_deg = global_position_int.lat * 1e-7;
+    position.longitude_deg = global_position_int.lon * 1e-7;
+    position.absolute_altitude_m = global_position_int.alt * 1e-3f;
+    position.relative_altitude_m = global_position_int.relative_alt * 1e-3f;
 
-    {
-        Telemetry::Position position;
-        position.latitude_deg = global_position_int.lat * 1e-7;
-        position.longitude_deg = global_position_int.lon * 1e-7;
-        position.absolute_altitude_m = global_position_int.alt * 1e-3f;
-        position.relative_altitude_m = global_position_int.relative_alt * 1e-3f;
-        set_position(position);
-    }
+    Telemetry::VelocityNed velocity;
+    velocity.north_m_s = global_position_int.vx * 1e-2f;
+    velocity.east_m_s = global_position_int.vy * 1e-2f;
+    velocity.down_m_s = global_position_int.vz * 1e-2f;
 
-    {
-        Telemetry::VelocityNed velocity;
-        velocity.north_m_s = global_position_int.vx * 1e-2f;
-        velocity.east_m_s = global_position_int.vy * 1e-2f;
-        velocity.down_m_s = global_position_int.vz * 1e-2f;
-        set_velocity_ned(velocity);
-    }
+    Telemetry::Heading heading;
+    heading.heading_deg = (global_position_int.hdg != std::numeric_limits<uint16_t>::max()) ?
+                              static_cast<double>(global_position_int.hdg) * 1e-2 :
+                              static_cast<double>(NAN);
 
-    {
-        Telemetry::Heading heading;
-        heading.heading_deg = (global_position_int.hdg != std::numeric_limits<uint16_t>::max()) ?
-                                  static_cast<double>(global_position_int.hdg) * 1e-2 :
-                                  static_cast<double>(NAN);
-        set_heading(heading);
-    }
+    set_global_position(
+        position,
+        velocity,
+        heading,
+        sample_time_us(static_cast<uint64_t>(global_position_int.time_boot_ms) * 1000));
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_position_subscription) {
-        auto callback = _position_subscription;
-        auto arg = position();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    // Hand on what we just decoded rather than reading it back from the snapshot.
+    _position_subscriptions.queue(
+        position, [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
-    if (_velocity_ned_subscription) {
-        auto callback = _velocity_ned_subscription;
-        auto arg = velocity_ned();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _velocity_ned_subscriptions.queue(
+        velocity, [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
-    if (_heading_subscription) {
-        auto callback = _heading_subscription;
-        auto arg = heading();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _heading_subscriptions.queue(
+        heading, [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
 void TelemetryImpl::process_home_position(const mavlink_message_t& message)
@@ -689,19 +817,12 @@ void TelemetryImpl::process_home_position(const mavlink_message_t& message)
 
     set_health_home_position(true);
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_home_position_subscription) {
-        auto callback = _home_position_subscription;
-        auto arg = home();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _home_position_subscriptions.queue(
+        home(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
-void TelemetryImpl::process_attitude(const mavlink_message_t& message)
+void TelemetryImpl::process_attitude(const mavlink_attitude_t& attitude)
 {
-    mavlink_attitude_t attitude;
-    mavlink_msg_attitude_decode(&message, &attitude);
-
     Telemetry::EulerAngle euler_angle;
     euler_angle.roll_deg = to_deg_from_rad(attitude.roll);
     euler_angle.pitch_deg = to_deg_from_rad(attitude.pitch);
@@ -715,33 +836,22 @@ void TelemetryImpl::process_attitude(const mavlink_message_t& message)
     set_attitude_angular_velocity_body(angular_velocity_body);
 
     auto quaternion = mavsdk::to_quaternion_from_euler_angle(euler_angle);
-    set_attitude_quaternion(quaternion);
+    set_attitude_quaternion(quaternion, sample_time_us(euler_angle.timestamp_us));
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_attitude_quaternion_angle_subscription) {
-        auto callback = _attitude_quaternion_angle_subscription;
-        auto arg = attitude_quaternion();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _attitude_quaternion_angle_subscriptions.queue(
+        attitude_quaternion(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
-    if (_attitude_euler_angle_subscription) {
-        auto callback = _attitude_euler_angle_subscription;
-        auto arg = attitude_euler();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _attitude_euler_angle_subscriptions.queue(
+        attitude_euler(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
-    if (_attitude_angular_velocity_body_subscription) {
-        auto callback = _attitude_angular_velocity_body_subscription;
-        auto arg = attitude_angular_velocity_body();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _attitude_angular_velocity_body_subscriptions.queue(
+        attitude_angular_velocity_body(),
+        [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
-void TelemetryImpl::process_attitude_quaternion(const mavlink_message_t& message)
+void TelemetryImpl::process_attitude_quaternion(
+    const mavlink_attitude_quaternion_t& mavlink_attitude_quaternion)
 {
-    mavlink_attitude_quaternion_t mavlink_attitude_quaternion;
-    mavlink_msg_attitude_quaternion_decode(&message, &mavlink_attitude_quaternion);
-
     Telemetry::Quaternion quaternion;
     quaternion.w = mavlink_attitude_quaternion.q1;
     quaternion.x = mavlink_attitude_quaternion.q2;
@@ -755,28 +865,19 @@ void TelemetryImpl::process_attitude_quaternion(const mavlink_message_t& message
     angular_velocity_body.pitch_rad_s = mavlink_attitude_quaternion.pitchspeed;
     angular_velocity_body.yaw_rad_s = mavlink_attitude_quaternion.yawspeed;
 
-    set_attitude_quaternion(quaternion);
+    set_attitude_quaternion(quaternion, sample_time_us(quaternion.timestamp_us));
 
     set_attitude_angular_velocity_body(angular_velocity_body);
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_attitude_quaternion_angle_subscription) {
-        auto callback = _attitude_quaternion_angle_subscription;
-        auto arg = attitude_quaternion();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _attitude_quaternion_angle_subscriptions.queue(
+        attitude_quaternion(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
-    if (_attitude_euler_angle_subscription) {
-        auto callback = _attitude_euler_angle_subscription;
-        auto arg = attitude_euler();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _attitude_euler_angle_subscriptions.queue(
+        attitude_euler(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
-    if (_attitude_angular_velocity_body_subscription) {
-        auto callback = _attitude_angular_velocity_body_subscription;
-        auto arg = attitude_angular_velocity_body();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _attitude_angular_velocity_body_subscriptions.queue(
+        attitude_angular_velocity_body(),
+        [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
 void TelemetryImpl::process_mount_orientation(const mavlink_message_t& message)
@@ -792,18 +893,13 @@ void TelemetryImpl::process_mount_orientation(const mavlink_message_t& message)
 
     set_camera_attitude_euler_angle(euler_angle);
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_camera_attitude_quaternion_subscription) {
-        auto callback = _camera_attitude_quaternion_subscription;
-        auto arg = camera_attitude_quaternion();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _camera_attitude_quaternion_subscriptions.queue(
+        camera_attitude_quaternion(),
+        [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
-    if (_camera_attitude_euler_angle_subscription) {
-        auto callback = _camera_attitude_euler_angle_subscription;
-        auto arg = camera_attitude_euler();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _camera_attitude_euler_angle_subscriptions.queue(
+        camera_attitude_euler(),
+        [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
 void TelemetryImpl::process_gimbal_device_attitude_status(const mavlink_message_t& message)
@@ -824,24 +920,17 @@ void TelemetryImpl::process_gimbal_device_attitude_status(const mavlink_message_
 
     set_camera_attitude_euler_angle(euler_angle);
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_camera_attitude_quaternion_subscription) {
-        auto callback = _camera_attitude_quaternion_subscription;
-        auto arg = camera_attitude_quaternion();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _camera_attitude_quaternion_subscriptions.queue(
+        camera_attitude_quaternion(),
+        [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
-    if (_camera_attitude_euler_angle_subscription) {
-        auto callback = _camera_attitude_euler_angle_subscription;
-        auto arg = camera_attitude_euler();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _camera_attitude_euler_angle_subscriptions.queue(
+        camera_attitude_euler(),
+        [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
-void TelemetryImpl::process_imu_reading_ned(const mavlink_message_t& message)
+void TelemetryImpl::process_imu_reading_ned(const mavlink_highres_imu_t& highres_imu)
 {
-    mavlink_highres_imu_t highres_imu;
-    mavlink_msg_highres_imu_decode(&message, &highres_imu);
     Telemetry::Imu new_imu;
     new_imu.acceleration_frd.forward_m_s2 = highres_imu.xacc;
     new_imu.acceleration_frd.right_m_s2 = highres_imu.yacc;
@@ -855,20 +944,17 @@ void TelemetryImpl::process_imu_reading_ned(const mavlink_message_t& message)
     new_imu.temperature_degc = highres_imu.temperature;
     new_imu.timestamp_us = highres_imu.time_usec;
 
-    set_imu_reading_ned(new_imu);
+    set_imu_reading_ned(new_imu, sample_time_us(new_imu.timestamp_us));
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_imu_reading_ned_subscription) {
-        auto callback = _imu_reading_ned_subscription;
-        auto arg = imu();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _imu_reading_ned_subscriptions.queue(
+        new_imu, [this](auto func) { _parent->call_user_callback(std::move(func)); });
+
+    _imu_batch_subscriptions.queue(
+        new_imu, [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
-void TelemetryImpl::process_scaled_imu(const mavlink_message_t& message)
+void TelemetryImpl::process_scaled_imu(const mavlink_scaled_imu_t& scaled_imu_reading)
 {
-    mavlink_scaled_imu_t scaled_imu_reading;
-    mavlink_msg_scaled_imu_decode(&message, &scaled_imu_reading);
     Telemetry::Imu new_imu;
     new_imu.acceleration_frd.forward_m_s2 = scaled_imu_reading.xacc;
     new_imu.acceleration_frd.right_m_s2 = scaled_imu_reading.yacc;
@@ -884,18 +970,15 @@ void TelemetryImpl::process_scaled_imu(const mavlink_message_t& message)
 
     set_scaled_imu(new_imu);
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_scaled_imu_subscription) {
-        auto callback = _scaled_imu_subscription;
-        auto arg = scaled_imu();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _scaled_imu_subscriptions.queue(
+        scaled_imu(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
+
+    _scaled_imu_batch_subscriptions.queue(
+        new_imu, [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
-void TelemetryImpl::process_raw_imu(const mavlink_message_t& message)
+void TelemetryImpl::process_raw_imu(const mavlink_raw_imu_t& raw_imu_reading)
 {
-    mavlink_raw_imu_t raw_imu_reading;
-    mavlink_msg_raw_imu_decode(&message, &raw_imu_reading);
     Telemetry::Imu new_imu;
     new_imu.acceleration_frd.forward_m_s2 = raw_imu_reading.xacc;
     new_imu.acceleration_frd.right_m_s2 = raw_imu_reading.yacc;
@@ -911,12 +994,11 @@ void TelemetryImpl::process_raw_imu(const mavlink_message_t& message)
 
     set_raw_imu(new_imu);
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_raw_imu_subscription) {
-        auto callback = _raw_imu_subscription;
-        auto arg = raw_imu();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _raw_imu_subscriptions.queue(
+        raw_imu(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
+
+    _raw_imu_batch_subscriptions.queue(
+        new_imu, [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
 void TelemetryImpl::process_gps_raw_int(const mavlink_message_t& message)
@@ -983,19 +1065,10 @@ void TelemetryImpl::process_gps_raw_int(const mavlink_message_t& message)
 
     set_health_global_position(gps_ok);
 
-    {
-        std::lock_guard<std::mutex> lock(_subscription_mutex);
-        if (_gps_info_subscription) {
-            auto callback = _gps_info_subscription;
-            auto arg = gps_info();
-            _parent->call_user_callback([callback, arg]() { callback(arg); });
-        }
-        if (_raw_gps_subscription) {
-            auto callback = _raw_gps_subscription;
-            auto arg = raw_gps();
-            _parent->call_user_callback([callback, arg]() { callback(arg); });
-        }
-    }
+    _gps_info_subscriptions.queue(
+        gps_info(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
+    _raw_gps_subscriptions.queue(
+        raw_gps(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
     _parent->refresh_timeout_handler(_gps_raw_timeout_cookie);
 }
@@ -1012,12 +1085,8 @@ void TelemetryImpl::process_ground_truth(const mavlink_message_t& message)
 
     set_ground_truth(new_ground_truth);
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_ground_truth_subscription) {
-        auto callback = _ground_truth_subscription;
-        auto arg = ground_truth();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _ground_truth_subscriptions.queue(
+        ground_truth(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
 void TelemetryImpl::process_extended_sys_state(const mavlink_message_t& message)
@@ -1033,18 +1102,11 @@ void TelemetryImpl::process_extended_sys_state(const mavlink_message_t& message)
         set_vtol_state(vtol_state);
     }
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_landed_state_subscription) {
-        auto callback = _landed_state_subscription;
-        auto arg = landed_state();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _landed_state_subscriptions.queue(
+        landed_state(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
-    if (_votl_state_subscription) {
-        auto callback = _votl_state_subscription;
-        auto arg = vtol_state();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _vtol_state_subscriptions.queue(
+        vtol_state(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
     if (extended_sys_state.landed_state == MAV_LANDED_STATE_IN_AIR ||
         extended_sys_state.landed_state == MAV_LANDED_STATE_TAKEOFF ||
@@ -1055,17 +1117,11 @@ void TelemetryImpl::process_extended_sys_state(const mavlink_message_t& message)
     }
     // If landed_state is undefined, we use what we have received last.
 
-    if (_in_air_subscription) {
-        auto callback = _in_air_subscription;
-        auto arg = in_air();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _in_air_subscriptions.queue(
+        in_air(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
-void TelemetryImpl::process_fixedwing_metrics(const mavlink_message_t& message)
+void TelemetryImpl::process_fixedwing_metrics(const mavlink_vfr_hud_t& vfr_hud)
 {
-    mavlink_vfr_hud_t vfr_hud;
-    mavlink_msg_vfr_hud_decode(&message, &vfr_hud);
-
     Telemetry::FixedwingMetrics new_fixedwing_metrics;
     new_fixedwing_metrics.airspeed_m_s = vfr_hud.airspeed;
     new_fixedwing_metrics.throttle_percentage = vfr_hud.throttle * 1e-2f;
@@ -1073,12 +1129,8 @@ void TelemetryImpl::process_fixedwing_metrics(const mavlink_message_t& message)
 
     set_fixedwing_metrics(new_fixedwing_metrics);
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_fixedwing_metrics_subscription) {
-        auto callback = _fixedwing_metrics_subscription;
-        auto arg = fixedwing_metrics();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _fixedwing_metrics_subscriptions.queue(
+        fixedwing_metrics(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
 void TelemetryImpl::process_sys_status(const mavlink_message_t& message)
@@ -1094,14 +1146,8 @@ void TelemetryImpl::process_sys_status(const mavlink_message_t& message)
 
         set_battery(new_battery);
 
-        {
-            std::lock_guard<std::mutex> lock(_subscription_mutex);
-            if (_battery_subscription) {
-                auto callback = _battery_subscription;
-                auto arg = battery();
-                _parent->call_user_callback([callback, arg]() { callback(arg); });
-            }
-        }
+        _battery_subscriptions.queue(
+            battery(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
     }
 
     const bool rc_ok =
@@ -1130,22 +1176,13 @@ void TelemetryImpl::process_sys_status(const mavlink_message_t& message)
         // If the flag is not supported yet, we fall back to the param.
     }
 
-    {
-        std::lock_guard<std::mutex> lock(_subscription_mutex);
-        if (_rc_status_subscription) {
-            auto callback = _rc_status_subscription;
-            auto arg = rc_status();
-            _parent->call_user_callback([callback, arg]() { callback(arg); });
-        }
-    }
+    _rc_status_subscriptions.queue(
+        rc_status(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
     const bool armable = sys_status.onboard_control_sensors_health & MAV_SYS_STATUS_PREARM_CHECK;
 
     set_health_armable(armable);
-    if (_health_all_ok_subscription) {
-        auto callback = _health_all_ok_subscription;
-        auto arg = health_all_ok();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _health_all_ok_subscriptions.queue(
+        health_all_ok(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
 void TelemetryImpl::process_battery_status(const mavlink_message_t& message)
@@ -1168,14 +1205,8 @@ void TelemetryImpl::process_battery_status(const mavlink_message_t& message)
 
     set_battery(new_battery);
 
-    {
-        std::lock_guard<std::mutex> lock(_subscription_mutex);
-        if (_battery_subscription) {
-            auto callback = _battery_subscription;
-            auto arg = battery();
-            _parent->call_user_callback([callback, arg]() { callback(arg); });
-        }
-    }
+    _battery_subscriptions.queue(
+        battery(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
 void TelemetryImpl::process_heartbeat(const mavlink_message_t& message)
@@ -1189,32 +1220,24 @@ void TelemetryImpl::process_heartbeat(const mavlink_message_t& message)
 
     set_armed(((heartbeat.base_mode & MAV_MODE_FLAG_SAFETY_ARMED) ? true : false));
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_armed_subscription) {
-        auto callback = _armed_subscription;
-        auto arg = armed();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _armed_subscriptions.queue(
+        armed(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
-    if (_flight_mode_subscription) {
-        auto callback = _flight_mode_subscription;
-        // The flight mode is already parsed in SystemImpl, so we can take it
-        // from there.  This assumes that SystemImpl gets called first because
-        // it's earlier in the callback list.
-        auto arg = telemetry_flight_mode_from_flight_mode(_parent->get_flight_mode());
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    // The flight mode is already parsed in SystemImpl, so we can take it
+    // from there.  This assumes that SystemImpl gets called first because
+    // it's earlier in the callback list.
+    const auto current_flight_mode =
+        telemetry_flight_mode_from_flight_mode(_parent->get_flight_mode());
+    if (_fleet_row) {
+        FleetTable::instance().set_flight_mode(*_fleet_row, current_flight_mode);
     }
+    _flight_mode_subscriptions.queue(
+        current_flight_mode, [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
-    if (_health_subscription) {
-        auto callback = _health_subscription;
-        auto arg = health();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
-    if (_health_all_ok_subscription) {
-        auto callback = _health_all_ok_subscription;
-        auto arg = health_all_ok();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _health_subscriptions.queue(
+        health(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
+    _health_all_ok_subscriptions.queue(
+        health_all_ok(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
 void TelemetryImpl::receive_statustext(const MavlinkStatustextHandler::Statustext& statustext)
@@ -1253,15 +1276,14 @@ void TelemetryImpl::receive_statustext(const MavlinkStatustextHandler::Statustex
     }
 
     new_status_text.text = statustext.text;
+    if (statustext.count > 1) {
+        new_status_text.text += " (" + std::to_string(statustext.count) + " times)";
+    }
 
     set_status_text(new_status_text);
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_status_text_subscription) {
-        auto callback = _status_text_subscription;
-        auto arg = status_text();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _status_text_subscriptions.queue(
+        status_text(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
 void TelemetryImpl::process_rc_channels(const mavlink_message_t& message)
@@ -1272,20 +1294,12 @@ void TelemetryImpl::process_rc_channels(const mavlink_message_t& message)
     if (rc_channels.rssi != std::numeric_limits<uint8_t>::max()) {
         set_rc_status(std::nullopt, {rc_channels.rssi});
 
-        std::lock_guard<std::mutex> lock(_subscription_mutex);
-        if (_rc_status_subscription) {
-            auto callback = _rc_status_subscription;
-            auto arg = rc_status();
-            _parent->call_user_callback([callback, arg]() { callback(arg); });
-        }
+        _rc_status_subscriptions.queue(
+            rc_status(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
     }
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_rc_status_subscription) {
-        auto callback = _rc_status_subscription;
-        auto arg = rc_status();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _rc_status_subscriptions.queue(
+        rc_status(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
     _parent->refresh_timeout_handler(_rc_channels_timeout_cookie);
 }
@@ -1297,12 +1311,8 @@ void TelemetryImpl::process_unix_epoch_time(const mavlink_message_t& message)
 
     set_unix_epoch_time_us(utm_global_position.time);
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_unix_epoch_time_subscription) {
-        auto callback = _unix_epoch_time_subscription;
-        auto arg = unix_epoch_time();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _unix_epoch_time_subscriptions.queue(
+        unix_epoch_time(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 
     _parent->refresh_timeout_handler(_unix_epoch_timeout_cookie);
 }
@@ -1312,23 +1322,20 @@ void TelemetryImpl::process_actuator_control_target(const mavlink_message_t& mes
     mavlink_set_actuator_control_target_t target;
     mavlink_msg_set_actuator_control_target_decode(&message, &target);
 
-    uint32_t group = target.group_mlx;
-    std::vector<float> controls;
+    Telemetry::ActuatorControlTarget actuator_control_target{};
+    actuator_control_target.group = target.group_mlx;
 
     const unsigned control_size = sizeof(target.controls) / sizeof(target.controls[0]);
     // Can't use std::copy because target is packed.
     for (std::size_t i = 0; i < control_size; ++i) {
-        controls.push_back(target.controls[i]);
+        actuator_control_target.controls.push_back(target.controls[i]);
     }
 
-    set_actuator_control_target(group, controls);
+    set_actuator_control_target(actuator_control_target);
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_actuator_control_target_subscription) {
-        auto callback = _actuator_control_target_subscription;
-        auto arg = actuator_control_target();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _actuator_control_target_subscriptions.queue(
+        actuator_control_target(),
+        [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
 void TelemetryImpl::process_actuator_output_status(const mavlink_message_t& message)
@@ -1336,30 +1343,36 @@ void TelemetryImpl::process_actuator_output_status(const mavlink_message_t& mess
     mavlink_actuator_output_status_t status;
     mavlink_msg_actuator_output_status_decode(&message, &status);
 
-    uint32_t active = status.active;
-    std::vector<float> actuators;
+    Telemetry::ActuatorOutputStatus actuator_output_status{};
+    actuator_output_status.active = status.active;
 
     const unsigned actuators_size = sizeof(status.actuator) / sizeof(status.actuator[0]);
     // Can't use std::copy because status is packed.
     for (std::size_t i = 0; i < actuators_size; ++i) {
-        actuators.push_back(status.actuator[i]);
+        actuator_output_status.actuator.push_back(status.actuator[i]);
     }
 
-    set_actuator_output_status(active, actuators);
+    set_actuator_output_status(actuator_output_status);
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_actuator_output_status_subscription) {
-        auto callback = _actuator_output_status_subscription;
-        auto arg = actuator_output_status();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _actuator_output_status_subscriptions.queue(
+        actuator_output_status(),
+        [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
-void TelemetryImpl::process_odometry(const mavlink_message_t& message)
+void TelemetryImpl::process_odometry(const mavlink_odometry_t& odometry_msg)
 {
-    mavlink_odometry_t odometry_msg;
-    mavlink_msg_odometry_decode(&message, &odometry_msg);
+    // Converting includes copying the covariances, so it is only done once
+    // someone asks for it.
+    _odometry.store(odometry_msg);
 
+    if (!_odometry_subscriptions.empty()) {
+        _odometry_subscriptions.queue(
+            _odometry.get(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
+    }
+}
+
+Telemetry::Odometry TelemetryImpl::odometry_from_mavlink(const mavlink_odometry_t& odometry_msg)
+{
     Telemetry::Odometry odometry_struct{};
 
     odometry_struct.time_usec = odometry_msg.time_usec;
@@ -1398,14 +1411,7 @@ void TelemetryImpl::process_odometry(const mavlink_message_t& message)
             odometry_msg.velocity_covariance[i]);
     }
 
-    set_odometry(odometry_struct);
-
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_odometry_subscription) {
-        auto callback = _odometry_subscription;
-        auto arg = odometry();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    return odometry_struct;
 }
 
 void TelemetryImpl::process_distance_sensor(const mavlink_message_t& message)
@@ -1421,19 +1427,12 @@ void TelemetryImpl::process_distance_sensor(const mavlink_message_t& message)
 
     set_distance_sensor(distance_sensor_struct);
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_distance_sensor_subscription) {
-        auto callback = _distance_sensor_subscription;
-        auto arg = distance_sensor();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _distance_sensor_subscriptions.queue(
+        distance_sensor(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
-void TelemetryImpl::process_scaled_pressure(const mavlink_message_t& message)
+void TelemetryImpl::process_scaled_pressure(const mavlink_scaled_pressure_t& scaled_pressure_msg)
 {
-    mavlink_scaled_pressure_t scaled_pressure_msg;
-    mavlink_msg_scaled_pressure_decode(&message, &scaled_pressure_msg);
-
     Telemetry::ScaledPressure scaled_pressure_struct{};
 
     scaled_pressure_struct.timestamp_us =
@@ -1447,12 +1446,8 @@ void TelemetryImpl::process_scaled_pressure(const mavlink_message_t& message)
 
     set_scaled_pressure(scaled_pressure_struct);
 
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    if (_scaled_pressure_subscription) {
-        auto callback = _scaled_pressure_subscription;
-        auto arg = scaled_pressure();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
-    }
+    _scaled_pressure_subscriptions.queue(
+        scaled_pressure(), [this](auto func) { _parent->call_user_callback(std::move(func)); });
 }
 
 Telemetry::LandedState
@@ -1717,50 +1712,255 @@ void TelemetryImpl::receive_unix_epoch_timeout()
 
 Telemetry::PositionVelocityNed TelemetryImpl::position_velocity_ned() const
 {
-    std::lock_guard<std::mutex> lock(_position_velocity_ned_mutex);
-    return _position_velocity_ned;
+    return _snapshot.load().position_velocity_ned;
 }
 
 void TelemetryImpl::set_position_velocity_ned(Telemetry::PositionVelocityNed position_velocity_ned)
 {
-    std::lock_guard<std::mutex> lock(_position_velocity_ned_mutex);
-    _position_velocity_ned = position_velocity_ned;
+    update_snapshot(
+        &Telemetry::Snapshot::position_velocity_ned,
+        &Telemetry::Snapshot::position_velocity_ned_receive_time_us,
+        Telemetry::SnapshotField::PositionVelocityNed,
+        position_velocity_ned);
 }
 
 Telemetry::Position TelemetryImpl::position() const
 {
-    std::lock_guard<std::mutex> lock(_position_mutex);
-    return _position;
+    return _snapshot.load().position;
 }
 
-void TelemetryImpl::set_position(Telemetry::Position position)
+void TelemetryImpl::set_global_position(
+    Telemetry::Position position,
+    Telemetry::VelocityNed velocity_ned,
+    Telemetry::Heading heading,
+    uint64_t time_us)
 {
-    std::lock_guard<std::mutex> lock(_position_mutex);
-    _position = position;
+    // All three come from the same message, so they are written at once.
+    const uint64_t receive_time_us = time_us;
+
+    _snapshot.update([&](Telemetry::Snapshot& snapshot) {
+        snapshot.position = position;
+        snapshot.position_receive_time_us = receive_time_us;
+        snapshot.velocity_ned = velocity_ned;
+        snapshot.velocity_ned_receive_time_us = receive_time_us;
+        snapshot.heading = heading;
+        snapshot.heading_receive_time_us = receive_time_us;
+        snapshot.fields |= Telemetry::SnapshotField::Position |
+                           Telemetry::SnapshotField::VelocityNed |
+                           Telemetry::SnapshotField::Heading;
+    });
+
+    _position_history.record(receive_time_us, position);
+    _velocity_ned_history.record(receive_time_us, velocity_ned);
+
+    if (_fleet_row) {
+        FleetTable::instance().set_position(*_fleet_row, position);
+    }
 }
 
 Telemetry::Heading TelemetryImpl::heading() const
 {
-    std::lock_guard<std::mutex> lock(_heading_mutex);
-    return _heading;
+    return _snapshot.load().heading;
+}
+
+Telemetry::Snapshot TelemetryImpl::snapshot(uint32_t fields) const
+{
+    const auto current = _snapshot.load();
+
+    Telemetry::Snapshot result{};
+    result.fields = current.fields & fields;
+
+    auto select = [&](uint32_t field, auto member, uint64_t Telemetry::Snapshot::*receive_time_us) {
+        if ((result.fields & field) != 0) {
+            result.*member = current.*member;
+            result.*receive_time_us = current.*receive_time_us;
+        }
+    };
+
+    select(
+        Telemetry::SnapshotField::Position,
+        &Telemetry::Snapshot::position,
+        &Telemetry::Snapshot::position_receive_time_us);
+    select(
+        Telemetry::SnapshotField::Heading,
+        &Telemetry::Snapshot::heading,
+        &Telemetry::Snapshot::heading_receive_time_us);
+    select(
+        Telemetry::SnapshotField::VelocityNed,
+        &Telemetry::Snapshot::velocity_ned,
+        &Telemetry::Snapshot::velocity_ned_receive_time_us);
+    select(
+        Telemetry::SnapshotField::PositionVelocityNed,
+        &Telemetry::Snapshot::position_velocity_ned,
+        &Telemetry::Snapshot::position_velocity_ned_receive_time_us);
+    select(
+        Telemetry::SnapshotField::AttitudeQuaternion,
+        &Telemetry::Snapshot::attitude_quaternion,
+        &Telemetry::Snapshot::attitude_quaternion_receive_time_us);
+    select(
+        Telemetry::SnapshotField::AttitudeAngularVelocityBody,
+        &Telemetry::Snapshot::attitude_angular_velocity_body,
+        &Telemetry::Snapshot::attitude_angular_velocity_body_receive_time_us);
+    select(
+        Telemetry::SnapshotField::Imu,
+        &Telemetry::Snapshot::imu,
+        &Telemetry::Snapshot::imu_receive_time_us);
+    select(
+        Telemetry::SnapshotField::ScaledImu,
+        &Telemetry::Snapshot::scaled_imu,
+        &Telemetry::Snapshot::scaled_imu_receive_time_us);
+    select(
+        Telemetry::SnapshotField::RawImu,
+        &Telemetry::Snapshot::raw_imu,
+        &Telemetry::Snapshot::raw_imu_receive_time_us);
+    select(
+        Telemetry::SnapshotField::GroundTruth,
+        &Telemetry::Snapshot::ground_truth,
+        &Telemetry::Snapshot::ground_truth_receive_time_us);
+
+    return result;
+}
+
+void TelemetryImpl::set_history_enabled(Telemetry::HistoryTopic topic, bool enabled)
+{
+    switch (topic) {
+        case Telemetry::HistoryTopic::Position:
+            _position_history.set_enabled(enabled);
+            break;
+        case Telemetry::HistoryTopic::AttitudeQuaternion:
+            _attitude_quaternion_history.set_enabled(enabled);
+            break;
+        case Telemetry::HistoryTopic::VelocityNed:
+            _velocity_ned_history.set_enabled(enabled);
+            break;
+        case Telemetry::HistoryTopic::Imu:
+            _imu_history.set_enabled(enabled);
+            break;
+    }
+}
+
+std::vector<std::pair<uint64_t, Telemetry::Position>>
+TelemetryImpl::position_history(uint64_t start_time_us, uint64_t end_time_us) const
+{
+    return _position_history.between(start_time_us, end_time_us);
+}
+
+std::optional<Telemetry::Position> TelemetryImpl::position_at(uint64_t time_us) const
+{
+    return _position_history.at(time_us, interpolate_position);
+}
+
+std::vector<std::pair<uint64_t, Telemetry::Quaternion>>
+TelemetryImpl::attitude_quaternion_history(uint64_t start_time_us, uint64_t end_time_us) const
+{
+    return _attitude_quaternion_history.between(start_time_us, end_time_us);
+}
+
+std::optional<Telemetry::Quaternion> TelemetryImpl::attitude_quaternion_at(uint64_t time_us) const
+{
+    return _attitude_quaternion_history.at(time_us, interpolate_quaternion);
+}
+
+std::vector<std::pair<uint64_t, Telemetry::EulerAngle>>
+TelemetryImpl::attitude_euler_history(uint64_t start_time_us, uint64_t end_time_us) const
+{
+    const auto samples = _attitude_quaternion_history.between(start_time_us, end_time_us);
+
+    std::vector<Telemetry::Quaternion> quaternions;
+    quaternions.reserve(samples.size());
+    for (const auto& sample : samples) {
+        quaternions.push_back(sample.second);
+    }
+
+    std::vector<Telemetry::EulerAngle> euler_angles(quaternions.size());
+    to_euler_angles_from_quaternions(quaternions.data(), euler_angles.data(), quaternions.size());
+
+    std::vector<std::pair<uint64_t, Telemetry::EulerAngle>> result;
+    result.reserve(samples.size());
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        result.emplace_back(samples[i].first, euler_angles[i]);
+    }
+    return result;
 }
 
-void TelemetryImpl::set_heading(Telemetry::Heading heading)
+std::vector<std::pair<uint64_t, Telemetry::VelocityNed>>
+TelemetryImpl::velocity_ned_history(uint64_t start_time_us, uint64_t end_time_us) const
 {
-    std::lock_guard<std::mutex> lock(_heading_mutex);
-    _heading = heading;
+    return _velocity_ned_history.between(start_time_us, end_time_us);
+}
+
+std::optional<Telemetry::VelocityNed> TelemetryImpl::velocity_ned_at(uint64_t time_us) const
+{
+    return _velocity_ned_history.at(time_us, interpolate_velocity_ned);
+}
+
+std::vector<std::pair<uint64_t, Telemetry::Imu>>
+TelemetryImpl::imu_history(uint64_t start_time_us, uint64_t end_time_us) const
+{
+    return _imu_history.between(start_time_us, end_time_us);
+}
+
+std::optional<Telemetry::Imu> TelemetryImpl::imu_at(uint64_t time_us) const
+{
+    return _imu_history.at(time_us, interpolate_imu);
+}
+
+template<typename T>
+uint64_t TelemetryImpl::update_snapshot(
+    T Telemetry::Snapshot::*field,
+    uint64_t Telemetry::Snapshot::*receive_time_us,
+    uint32_t snapshot_field,
+    const T& value)
+{
+    const uint64_t now_us = steady_time_us();
+    update_snapshot(field, receive_time_us, snapshot_field, value, now_us);
+    return now_us;
+}
+
+template<typename T>
+void TelemetryImpl::update_snapshot(
+    T Telemetry::Snapshot::*field,
+    uint64_t Telemetry::Snapshot::*receive_time_us,
+    uint32_t snapshot_field,
+    const T& value,
+    uint64_t time_us)
+{
+    _snapshot.update([&](Telemetry::Snapshot& snapshot) {
+        snapshot.*field = value;
+        snapshot.*receive_time_us = time_us;
+        snapshot.fields |= snapshot_field;
+    });
+}
+
+uint64_t TelemetryImpl::steady_time_us()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            _time.steady_time().time_since_epoch())
+            .count());
+}
+
+uint64_t TelemetryImpl::sample_time_us(uint64_t remote_us)
+{
+    const uint64_t now_us = steady_time_us();
+
+    const auto local_us = _parent->to_local_time_us(remote_us);
+    if (!local_us || local_us.value() + MAX_SAMPLE_AGE_US < now_us) {
+        return now_us;
+    }
+
+    // It can't have been taken after it arrived, that's just the error of the estimate.
+    return std::min(local_us.value(), now_us);
 }
 
 Telemetry::Position TelemetryImpl::home() const
 {
-    std::lock_guard<std::mutex> lock(_home_position_mutex);
-    return _home_position;
+    return _home_position.load();
 }
 
 void TelemetryImpl::set_home_position(Telemetry::Position home_position)
 {
-    std::lock_guard<std::mutex> lock(_home_position_mutex);
-    _home_position = home_position;
+    _home_position.store(home_position);
 }
 
 bool TelemetryImpl::armed() const
@@ -1797,164 +1997,171 @@ void TelemetryImpl::set_armed(bool armed_new)
 
 Telemetry::Quaternion TelemetryImpl::attitude_quaternion() const
 {
-    std::lock_guard<std::mutex> lock(_attitude_quaternion_mutex);
-    return _attitude_quaternion;
+    return _snapshot.load().attitude_quaternion;
 }
 
 Telemetry::AngularVelocityBody TelemetryImpl::attitude_angular_velocity_body() const
 {
-    std::lock_guard<std::mutex> lock(_attitude_angular_velocity_body_mutex);
-    return _attitude_angular_velocity_body;
+    return _snapshot.load().attitude_angular_velocity_body;
 }
 
 Telemetry::GroundTruth TelemetryImpl::ground_truth() const
 {
-    std::lock_guard<std::mutex> lock(_ground_truth_mutex);
-    return _ground_truth;
+    return _snapshot.load().ground_truth;
 }
 
 Telemetry::FixedwingMetrics TelemetryImpl::fixedwing_metrics() const
 {
-    std::lock_guard<std::mutex> lock(_fixedwing_metrics_mutex);
-    return _fixedwing_metrics;
+    return _fixedwing_metrics.load();
 }
 
 Telemetry::EulerAngle TelemetryImpl::attitude_euler() const
 {
-    std::lock_guard<std::mutex> lock(_attitude_quaternion_mutex);
-    Telemetry::EulerAngle euler = to_euler_angle_from_quaternion(_attitude_quaternion);
+    Telemetry::EulerAngle euler =
+        to_euler_angle_from_quaternion(_snapshot.load().attitude_quaternion);
 
     return euler;
 }
 
-void TelemetryImpl::set_attitude_quaternion(Telemetry::Quaternion quaternion)
+void TelemetryImpl::set_attitude_quaternion(Telemetry::Quaternion quaternion, uint64_t time_us)
 {
-    std::lock_guard<std::mutex> lock(_attitude_quaternion_mutex);
-    _attitude_quaternion = quaternion;
+    update_snapshot(
+        &Telemetry::Snapshot::attitude_quaternion,
+        &Telemetry::Snapshot::attitude_quaternion_receive_time_us,
+        Telemetry::SnapshotField::AttitudeQuaternion,
+        quaternion,
+        time_us);
+    _attitude_quaternion_history.record(time_us, quaternion);
+
+    if (_fleet_row) {
+        FleetTable::instance().set_attitude_euler(
+            *_fleet_row, to_euler_angle_from_quaternion(quaternion));
+    }
 }
 
 void TelemetryImpl::set_attitude_angular_velocity_body(
     Telemetry::AngularVelocityBody angular_velocity_body)
 {
-    std::lock_guard<std::mutex> lock(_attitude_quaternion_mutex);
-    _attitude_angular_velocity_body = angular_velocity_body;
+    update_snapshot(
+        &Telemetry::Snapshot::attitude_angular_velocity_body,
+        &Telemetry::Snapshot::attitude_angular_velocity_body_receive_time_us,
+        Telemetry::SnapshotField::AttitudeAngularVelocityBody,
+        angular_velocity_body);
 }
 
 void TelemetryImpl::set_ground_truth(Telemetry::GroundTruth ground_truth)
 {
-    std::lock_guard<std::mutex> lock(_ground_truth_mutex);
-    _ground_truth = ground_truth;
+    update_snapshot(
+        &Telemetry::Snapshot::ground_truth,
+        &Telemetry::Snapshot::ground_truth_receive_time_us,
+        Telemetry::SnapshotField::GroundTruth,
+        ground_truth);
 }
 
 void TelemetryImpl::set_fixedwing_metrics(Telemetry::FixedwingMetrics fixedwing_metrics)
 {
-    std::lock_guard<std::mutex> lock(_fixedwing_metrics_mutex);
-    _fixedwing_metrics = fixedwing_metrics;
+    _fixedwing_metrics.store(fixedwing_metrics);
 }
 
 Telemetry::Quaternion TelemetryImpl::camera_attitude_quaternion() const
 {
-    std::lock_guard<std::mutex> lock(_camera_attitude_euler_angle_mutex);
-    Telemetry::Quaternion quaternion = to_quaternion_from_euler_angle(_camera_attitude_euler_angle);
+    Telemetry::Quaternion quaternion =
+        to_quaternion_from_euler_angle(_camera_attitude_euler_angle.load());
 
     return quaternion;
 }
 
 Telemetry::EulerAngle TelemetryImpl::camera_attitude_euler() const
 {
-    std::lock_guard<std::mutex> lock(_camera_attitude_euler_angle_mutex);
-
-    return _camera_attitude_euler_angle;
+    return _camera_attitude_euler_angle.load();
 }
 
 void TelemetryImpl::set_camera_attitude_euler_angle(Telemetry::EulerAngle euler_angle)
 {
-    std::lock_guard<std::mutex> lock(_camera_attitude_euler_angle_mutex);
-    _camera_attitude_euler_angle = euler_angle;
+    _camera_attitude_euler_angle.store(euler_angle);
 }
 
 Telemetry::VelocityNed TelemetryImpl::velocity_ned() const
 {
-    std::lock_guard<std::mutex> lock(_velocity_ned_mutex);
-    return _velocity_ned;
-}
-
-void TelemetryImpl::set_velocity_ned(Telemetry::VelocityNed velocity_ned)
-{
-    std::lock_guard<std::mutex> lock(_velocity_ned_mutex);
-    _velocity_ned = velocity_ned;
+    return _snapshot.load().velocity_ned;
 }
 
 Telemetry::Imu TelemetryImpl::imu() const
 {
-    std::lock_guard<std::mutex> lock(_imu_reading_ned_mutex);
-    return _imu_reading_ned;
+    return _snapshot.load().imu;
 }
 
-void TelemetryImpl::set_imu_reading_ned(Telemetry::Imu imu_reading_ned)
+void TelemetryImpl::set_imu_reading_ned(Telemetry::Imu imu_reading_ned, uint64_t time_us)
 {
-    std::lock_guard<std::mutex> lock(_imu_reading_ned_mutex);
-    _imu_reading_ned = imu_reading_ned;
+    update_snapshot(
+        &Telemetry::Snapshot::imu,
+        &Telemetry::Snapshot::imu_receive_time_us,
+        Telemetry::SnapshotField::Imu,
+        imu_reading_ned,
+        time_us);
+    _imu_history.record(time_us, imu_reading_ned);
 }
 
 Telemetry::Imu TelemetryImpl::scaled_imu() const
 {
-    std::lock_guard<std::mutex> lock(_scaled_imu_mutex);
-    return _scaled_imu;
+    return _snapshot.load().scaled_imu;
 }
 
 void TelemetryImpl::set_scaled_imu(Telemetry::Imu scaled_imu)
 {
-    std::lock_guard<std::mutex> lock(_scaled_imu_mutex);
-    _scaled_imu = scaled_imu;
+    update_snapshot(
+        &Telemetry::Snapshot::scaled_imu,
+        &Telemetry::Snapshot::scaled_imu_receive_time_us,
+        Telemetry::SnapshotField::ScaledImu,
+        scaled_imu);
 }
 
 Telemetry::Imu TelemetryImpl::raw_imu() const
 {
-    std::lock_guard<std::mutex> lock(_raw_imu_mutex);
-    return _raw_imu;
+    return _snapshot.load().raw_imu;
 }
 
 void TelemetryImpl::set_raw_imu(Telemetry::Imu raw_imu)
 {
-    std::lock_guard<std::mutex> lock(_raw_imu_mutex);
-    _raw_imu = raw_imu;
+    update_snapshot(
+        &Telemetry::Snapshot::raw_imu,
+        &Telemetry::Snapshot::raw_imu_receive_time_us,
+        Telemetry::SnapshotField::RawImu,
+        raw_imu);
 }
 
 Telemetry::GpsInfo TelemetryImpl::gps_info() const
 {
-    std::lock_guard<std::mutex> lock(_gps_info_mutex);
-    return _gps_info;
+    return _gps_info.load();
 }
 
 void TelemetryImpl::set_gps_info(Telemetry::GpsInfo gps_info)
 {
-    std::lock_guard<std::mutex> lock(_gps_info_mutex);
-    _gps_info = gps_info;
+    _gps_info.store(gps_info);
 }
 
 Telemetry::RawGps TelemetryImpl::raw_gps() const
 {
-    std::lock_guard<std::mutex> lock(_raw_gps_mutex);
-    return _raw_gps;
+    return _raw_gps.load();
 }
 
 void TelemetryImpl::set_raw_gps(Telemetry::RawGps raw_gps)
 {
-    std::lock_guard<std::mutex> lock(_raw_gps_mutex);
-    _raw_gps = raw_gps;
+    _raw_gps.store(raw_gps);
 }
 
 Telemetry::Battery TelemetryImpl::battery() const
 {
-    std::lock_guard<std::mutex> lock(_battery_mutex);
-    return _battery;
+    return _battery.load();
 }
 
 void TelemetryImpl::set_battery(Telemetry::Battery battery)
 {
-    std::lock_guard<std::mutex> lock(_battery_mutex);
-    _battery = battery;
+    _battery.store(battery);
+
+    if (_fleet_row) {
+        FleetTable::instance().set_battery(*_fleet_row, battery);
+    }
 }
 
 Telemetry::FlightMode TelemetryImpl::flight_mode() const
@@ -1964,16 +2171,15 @@ Telemetry::FlightMode TelemetryImpl::flight_mode() const
 
 Telemetry::Health TelemetryImpl::health() const
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    return _health;
+    return _health.load();
 }
 
 bool TelemetryImpl::health_all_ok() const
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    if (_health.is_gyrometer_calibration_ok && _health.is_accelerometer_calibration_ok &&
-        _health.is_magnetometer_calibration_ok && _health.is_local_position_ok &&
-        _health.is_global_position_ok && _health.is_home_position_ok) {
+    const auto health = _health.load();
+    if (health.is_gyrometer_calibration_ok && health.is_accelerometer_calibration_ok &&
+        health.is_magnetometer_calibration_ok && health.is_local_position_ok &&
+        health.is_global_position_ok && health.is_home_position_ok) {
         return true;
     } else {
         return false;
@@ -1982,13 +2188,11 @@ bool TelemetryImpl::health_all_ok() const
 
 Telemetry::RcStatus TelemetryImpl::rc_status() const
 {
-    std::lock_guard<std::mutex> lock(_rc_status_mutex);
-    return _rc_status;
+    return _rc_status.load();
 }
 
 uint64_t TelemetryImpl::unix_epoch_time() const
 {
-    std::lock_guard<std::mutex> lock(_unix_epoch_time_mutex);
     return _unix_epoch_time_us;
 }
 
@@ -2006,350 +2210,681 @@ Telemetry::ActuatorOutputStatus TelemetryImpl::actuator_output_status() const
 
 Telemetry::Odometry TelemetryImpl::odometry() const
 {
-    std::lock_guard<std::mutex> lock(_odometry_mutex);
-    return _odometry;
+    return _odometry.get();
 }
 
 Telemetry::DistanceSensor TelemetryImpl::distance_sensor() const
 {
-    std::lock_guard<std::mutex> lock(_distance_sensor_mutex);
-    return _distance_sensor;
+    return _distance_sensor.load();
 }
 
 Telemetry::ScaledPressure TelemetryImpl::scaled_pressure() const
 {
-    std::lock_guard<std::mutex> lock(_scaled_pressure_mutex);
-    return _scaled_pressure;
+    return _scaled_pressure.load();
 }
 
 void TelemetryImpl::set_health_local_position(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.is_local_position_ok = ok;
+    _health.update([&](Telemetry::Health& health) { health.is_local_position_ok = ok; });
 }
 
 void TelemetryImpl::set_health_global_position(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.is_global_position_ok = ok;
+    _health.update([&](Telemetry::Health& health) { health.is_global_position_ok = ok; });
 }
 
 void TelemetryImpl::set_health_home_position(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.is_home_position_ok = ok;
+    _health.update([&](Telemetry::Health& health) { health.is_home_position_ok = ok; });
 }
 
 void TelemetryImpl::set_health_gyrometer_calibration(bool ok)
 {
     _has_received_gyro_calibration = true;
 
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.is_gyrometer_calibration_ok = (ok || _hitl_enabled);
+    _health.update([&](Telemetry::Health& health) {
+        health.is_gyrometer_calibration_ok = (ok || _hitl_enabled);
+    });
 }
 
 void TelemetryImpl::set_health_accelerometer_calibration(bool ok)
 {
     _has_received_accel_calibration = true;
 
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.is_accelerometer_calibration_ok = (ok || _hitl_enabled);
+    _health.update([&](Telemetry::Health& health) {
+        health.is_accelerometer_calibration_ok = (ok || _hitl_enabled);
+    });
 }
 
 void TelemetryImpl::set_health_magnetometer_calibration(bool ok)
 {
     _has_received_mag_calibration = true;
 
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.is_magnetometer_calibration_ok = (ok || _hitl_enabled);
+    _health.update([&](Telemetry::Health& health) {
+        health.is_magnetometer_calibration_ok = (ok || _hitl_enabled);
+    });
 }
 
 void TelemetryImpl::set_health_armable(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.is_armable = ok;
+    _health.update([&](Telemetry::Health& health) { health.is_armable = ok; });
 }
 
 Telemetry::VtolState TelemetryImpl::vtol_state() const
 {
-    std::lock_guard<std::mutex> lock(_vtol_state_mutex);
-    return _vtol_state;
+    return _vtol_state.load();
 }
 
 void TelemetryImpl::set_vtol_state(Telemetry::VtolState vtol_state)
 {
-    std::lock_guard<std::mutex> lock(_vtol_state_mutex);
-    _vtol_state = vtol_state;
+    _vtol_state.store(vtol_state);
 }
 
 Telemetry::LandedState TelemetryImpl::landed_state() const
 {
-    std::lock_guard<std::mutex> lock(_landed_state_mutex);
-    return _landed_state;
+    return _landed_state.load();
 }
 
 void TelemetryImpl::set_landed_state(Telemetry::LandedState landed_state)
 {
-    std::lock_guard<std::mutex> lock(_landed_state_mutex);
-    _landed_state = landed_state;
+    _landed_state.store(landed_state);
 }
 
 void TelemetryImpl::set_rc_status(
     std::optional<bool> maybe_available, std::optional<float> maybe_signal_strength_percent)
 {
-    std::lock_guard<std::mutex> lock(_rc_status_mutex);
-
-    if (maybe_available) {
-        _rc_status.is_available = maybe_available.value();
-        if (maybe_available.value()) {
-            _rc_status.was_available_once = true;
+    _rc_status.update([&](Telemetry::RcStatus& rc_status) {
+        if (maybe_available) {
+            rc_status.is_available = maybe_available.value();
+            if (maybe_available.value()) {
+                rc_status.was_available_once = true;
+            }
         }
-    }
 
-    if (maybe_signal_strength_percent) {
-        _rc_status.signal_strength_percent = maybe_signal_strength_percent.value();
-    }
+        if (maybe_signal_strength_percent) {
+            rc_status.signal_strength_percent = maybe_signal_strength_percent.value();
+        }
+    });
 }
 
 void TelemetryImpl::set_unix_epoch_time_us(uint64_t time_us)
 {
-    std::lock_guard<std::mutex> lock(_unix_epoch_time_mutex);
     _unix_epoch_time_us = time_us;
 }
 
-void TelemetryImpl::set_actuator_control_target(uint8_t group, const std::vector<float>& controls)
+void TelemetryImpl::set_actuator_control_target(const Telemetry::ActuatorControlTarget& target)
 {
     std::lock_guard<std::mutex> lock(_actuator_control_target_mutex);
-    _actuator_control_target.group = group;
-    _actuator_control_target.controls = controls;
+    _actuator_control_target = target;
 }
 
-void TelemetryImpl::set_actuator_output_status(uint32_t active, const std::vector<float>& actuators)
+void TelemetryImpl::set_actuator_output_status(const Telemetry::ActuatorOutputStatus& status)
 {
     std::lock_guard<std::mutex> lock(_actuator_output_status_mutex);
-    _actuator_output_status.active = active;
-    _actuator_output_status.actuator = actuators;
+    _actuator_output_status = status;
 }
 
-void TelemetryImpl::set_odometry(Telemetry::Odometry& odometry)
+void TelemetryImpl::set_distance_sensor(Telemetry::DistanceSensor& distance_sensor)
 {
-    std::lock_guard<std::mutex> lock(_odometry_mutex);
-    _odometry = odometry;
+    _distance_sensor.store(distance_sensor);
 }
 
-void TelemetryImpl::set_distance_sensor(Telemetry::DistanceSensor& distance_sensor)
+void TelemetryImpl::set_scaled_pressure(Telemetry::ScaledPressure& scaled_pressure)
 {
-    std::lock_guard<std::mutex> lock(_distance_sensor_mutex);
-    _distance_sensor = distance_sensor;
+    _scaled_pressure.store(scaled_pressure);
 }
 
-void TelemetryImpl::set_scaled_pressure(Telemetry::ScaledPressure& scaled_pressure)
+Telemetry::PositionVelocityNedHandle TelemetryImpl::subscribe_position_velocity_ned(
+    const Telemetry::PositionVelocityNedCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_scaled_pressure_mutex);
-    _scaled_pressure = scaled_pressure;
+    if (!callback) {
+        _position_velocity_ned_subscriptions.clear();
+        return {};
+    }
+    return _position_velocity_ned_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_position_velocity_ned(
-    Telemetry::PositionVelocityNedCallback& callback)
+void TelemetryImpl::unsubscribe_position_velocity_ned(Telemetry::PositionVelocityNedHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _position_velocity_ned_subscription = callback;
+    _position_velocity_ned_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_position(Telemetry::PositionCallback& callback)
+Telemetry::PositionHandle TelemetryImpl::subscribe_position(
+    const Telemetry::PositionCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _position_subscription = callback;
+    if (!callback) {
+        _position_subscriptions.clear();
+        return {};
+    }
+    return _position_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_home(Telemetry::PositionCallback& callback)
+void TelemetryImpl::unsubscribe_position(Telemetry::PositionHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _home_position_subscription = callback;
+    _position_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_in_air(Telemetry::InAirCallback& callback)
+Telemetry::HomeHandle TelemetryImpl::subscribe_home(
+    const Telemetry::HomeCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _in_air_subscription = callback;
+    if (!callback) {
+        _home_position_subscriptions.clear();
+        return {};
+    }
+    return _home_position_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_status_text(Telemetry::StatusTextCallback& callback)
+void TelemetryImpl::unsubscribe_home(Telemetry::HomeHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _status_text_subscription = callback;
+    _home_position_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_armed(Telemetry::ArmedCallback& callback)
+Telemetry::InAirHandle TelemetryImpl::subscribe_in_air(
+    const Telemetry::InAirCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _armed_subscription = callback;
+    if (!callback) {
+        _in_air_subscriptions.clear();
+        return {};
+    }
+    return _in_air_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_attitude_quaternion(Telemetry::AttitudeQuaternionCallback& callback)
+void TelemetryImpl::unsubscribe_in_air(Telemetry::InAirHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _attitude_quaternion_angle_subscription = callback;
+    _in_air_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_attitude_euler(Telemetry::AttitudeEulerCallback& callback)
+Telemetry::StatusTextHandle TelemetryImpl::subscribe_status_text(
+    const Telemetry::StatusTextCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _attitude_euler_angle_subscription = callback;
+    if (!callback) {
+        _status_text_subscriptions.clear();
+        return {};
+    }
+    return _status_text_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_attitude_angular_velocity_body(
-    Telemetry::AttitudeAngularVelocityBodyCallback& callback)
+void TelemetryImpl::unsubscribe_status_text(Telemetry::StatusTextHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _attitude_angular_velocity_body_subscription = callback;
+    _status_text_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_fixedwing_metrics(Telemetry::FixedwingMetricsCallback& callback)
+Telemetry::ArmedHandle TelemetryImpl::subscribe_armed(
+    const Telemetry::ArmedCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _fixedwing_metrics_subscription = callback;
+    if (!callback) {
+        _armed_subscriptions.clear();
+        return {};
+    }
+    return _armed_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_ground_truth(Telemetry::GroundTruthCallback& callback)
+void TelemetryImpl::unsubscribe_armed(Telemetry::ArmedHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _ground_truth_subscription = callback;
+    _armed_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_camera_attitude_quaternion(
-    Telemetry::AttitudeQuaternionCallback& callback)
+Telemetry::AttitudeQuaternionHandle TelemetryImpl::subscribe_attitude_quaternion(
+    const Telemetry::AttitudeQuaternionCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _camera_attitude_quaternion_subscription = callback;
+    if (!callback) {
+        _attitude_quaternion_angle_subscriptions.clear();
+        return {};
+    }
+    return _attitude_quaternion_angle_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_camera_attitude_euler(Telemetry::AttitudeEulerCallback& callback)
+void TelemetryImpl::unsubscribe_attitude_quaternion(Telemetry::AttitudeQuaternionHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _camera_attitude_euler_angle_subscription = callback;
+    _attitude_quaternion_angle_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_velocity_ned(Telemetry::VelocityNedCallback& callback)
+Telemetry::AttitudeEulerHandle TelemetryImpl::subscribe_attitude_euler(
+    const Telemetry::AttitudeEulerCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _velocity_ned_subscription = callback;
+    if (!callback) {
+        _attitude_euler_angle_subscriptions.clear();
+        return {};
+    }
+    return _attitude_euler_angle_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_imu(Telemetry::ImuCallback& callback)
+void TelemetryImpl::unsubscribe_attitude_euler(Telemetry::AttitudeEulerHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _imu_reading_ned_subscription = callback;
+    _attitude_euler_angle_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_scaled_imu(Telemetry::ScaledImuCallback& callback)
+Telemetry::AttitudeAngularVelocityBodyHandle
+TelemetryImpl::subscribe_attitude_angular_velocity_body(
+    const Telemetry::AttitudeAngularVelocityBodyCallback& callback,
+    const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _scaled_imu_subscription = callback;
+    if (!callback) {
+        _attitude_angular_velocity_body_subscriptions.clear();
+        return {};
+    }
+    return _attitude_angular_velocity_body_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_raw_imu(Telemetry::RawImuCallback& callback)
+void TelemetryImpl::unsubscribe_attitude_angular_velocity_body(
+    Telemetry::AttitudeAngularVelocityBodyHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _raw_imu_subscription = callback;
+    _attitude_angular_velocity_body_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_gps_info(Telemetry::GpsInfoCallback& callback)
+Telemetry::FixedwingMetricsHandle TelemetryImpl::subscribe_fixedwing_metrics(
+    const Telemetry::FixedwingMetricsCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _gps_info_subscription = callback;
+    if (!callback) {
+        _fixedwing_metrics_subscriptions.clear();
+        return {};
+    }
+    return _fixedwing_metrics_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_raw_gps(Telemetry::RawGpsCallback& callback)
+void TelemetryImpl::unsubscribe_fixedwing_metrics(Telemetry::FixedwingMetricsHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _raw_gps_subscription = callback;
+    _fixedwing_metrics_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_battery(Telemetry::BatteryCallback& callback)
+Telemetry::GroundTruthHandle TelemetryImpl::subscribe_ground_truth(
+    const Telemetry::GroundTruthCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _battery_subscription = callback;
+    if (!callback) {
+        _ground_truth_subscriptions.clear();
+        return {};
+    }
+    return _ground_truth_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_flight_mode(Telemetry::FlightModeCallback& callback)
+void TelemetryImpl::unsubscribe_ground_truth(Telemetry::GroundTruthHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _flight_mode_subscription = callback;
+    _ground_truth_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_health(Telemetry::HealthCallback& callback)
+Telemetry::CameraAttitudeQuaternionHandle TelemetryImpl::subscribe_camera_attitude_quaternion(
+    const Telemetry::CameraAttitudeQuaternionCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _health_subscription = callback;
+    if (!callback) {
+        _camera_attitude_quaternion_subscriptions.clear();
+        return {};
+    }
+    return _camera_attitude_quaternion_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_camera_attitude_quaternion(
+    Telemetry::CameraAttitudeQuaternionHandle handle)
+{
+    _camera_attitude_quaternion_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::CameraAttitudeEulerHandle TelemetryImpl::subscribe_camera_attitude_euler(
+    const Telemetry::CameraAttitudeEulerCallback& callback, const SubscriptionOptions& options)
+{
+    if (!callback) {
+        _camera_attitude_euler_angle_subscriptions.clear();
+        return {};
+    }
+    return _camera_attitude_euler_angle_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_camera_attitude_euler(Telemetry::CameraAttitudeEulerHandle handle)
+{
+    _camera_attitude_euler_angle_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::VelocityNedHandle TelemetryImpl::subscribe_velocity_ned(
+    const Telemetry::VelocityNedCallback& callback, const SubscriptionOptions& options)
+{
+    if (!callback) {
+        _velocity_ned_subscriptions.clear();
+        return {};
+    }
+    return _velocity_ned_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_velocity_ned(Telemetry::VelocityNedHandle handle)
+{
+    _velocity_ned_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::ImuHandle TelemetryImpl::subscribe_imu(
+    const Telemetry::ImuCallback& callback, const SubscriptionOptions& options)
+{
+    if (!callback) {
+        _imu_reading_ned_subscriptions.clear();
+        return {};
+    }
+    return _imu_reading_ned_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_imu(Telemetry::ImuHandle handle)
+{
+    _imu_reading_ned_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::ScaledImuHandle TelemetryImpl::subscribe_scaled_imu(
+    const Telemetry::ScaledImuCallback& callback, const SubscriptionOptions& options)
+{
+    if (!callback) {
+        _scaled_imu_subscriptions.clear();
+        return {};
+    }
+    return _scaled_imu_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_scaled_imu(Telemetry::ScaledImuHandle handle)
+{
+    _scaled_imu_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::RawImuHandle TelemetryImpl::subscribe_raw_imu(
+    const Telemetry::RawImuCallback& callback, const SubscriptionOptions& options)
+{
+    if (!callback) {
+        _raw_imu_subscriptions.clear();
+        return {};
+    }
+    return _raw_imu_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_raw_imu(Telemetry::RawImuHandle handle)
+{
+    _raw_imu_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::ImuBatchHandle TelemetryImpl::subscribe_imu_batch(
+    const Telemetry::ImuBatchCallback& callback, const BatchOptions& options)
+{
+    if (!callback) {
+        _imu_batch_subscriptions.clear();
+        return {};
+    }
+    return _imu_batch_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_imu_batch(Telemetry::ImuBatchHandle handle)
+{
+    _imu_batch_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::ImuBatchHandle TelemetryImpl::subscribe_scaled_imu_batch(
+    const Telemetry::ImuBatchCallback& callback, const BatchOptions& options)
+{
+    if (!callback) {
+        _scaled_imu_batch_subscriptions.clear();
+        return {};
+    }
+    return _scaled_imu_batch_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_scaled_imu_batch(Telemetry::ImuBatchHandle handle)
+{
+    _scaled_imu_batch_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::ImuBatchHandle TelemetryImpl::subscribe_raw_imu_batch(
+    const Telemetry::ImuBatchCallback& callback, const BatchOptions& options)
+{
+    if (!callback) {
+        _raw_imu_batch_subscriptions.clear();
+        return {};
+    }
+    return _raw_imu_batch_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_raw_imu_batch(Telemetry::ImuBatchHandle handle)
+{
+    _raw_imu_batch_subscriptions.unsubscribe(handle);
+}
+
+void TelemetryImpl::flush_imu_batches()
+{
+    const auto queue_func = [this](auto func) { _parent->call_user_callback(std::move(func)); };
+    _imu_batch_subscriptions.flush_overdue(queue_func);
+    _scaled_imu_batch_subscriptions.flush_overdue(queue_func);
+    _raw_imu_batch_subscriptions.flush_overdue(queue_func);
+}
+
+Telemetry::GpsInfoHandle TelemetryImpl::subscribe_gps_info(
+    const Telemetry::GpsInfoCallback& callback, const SubscriptionOptions& options)
+{
+    if (!callback) {
+        _gps_info_subscriptions.clear();
+        return {};
+    }
+    return _gps_info_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_gps_info(Telemetry::GpsInfoHandle handle)
+{
+    _gps_info_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::RawGpsHandle TelemetryImpl::subscribe_raw_gps(
+    const Telemetry::RawGpsCallback& callback, const SubscriptionOptions& options)
+{
+    if (!callback) {
+        _raw_gps_subscriptions.clear();
+        return {};
+    }
+    return _raw_gps_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_raw_gps(Telemetry::RawGpsHandle handle)
+{
+    _raw_gps_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::BatteryHandle TelemetryImpl::subscribe_battery(
+    const Telemetry::BatteryCallback& callback, const SubscriptionOptions& options)
+{
+    if (!callback) {
+        _battery_subscriptions.clear();
+        return {};
+    }
+    return _battery_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_battery(Telemetry::BatteryHandle handle)
+{
+    _battery_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::FlightModeHandle TelemetryImpl::subscribe_flight_mode(
+    const Telemetry::FlightModeCallback& callback, const SubscriptionOptions& options)
+{
+    if (!callback) {
+        _flight_mode_subscriptions.clear();
+        return {};
+    }
+    return _flight_mode_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_flight_mode(Telemetry::FlightModeHandle handle)
+{
+    _flight_mode_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::HealthHandle TelemetryImpl::subscribe_health(
+    const Telemetry::HealthCallback& callback, const SubscriptionOptions& options)
+{
+    if (!callback) {
+        _health_subscriptions.clear();
+        return {};
+    }
+    return _health_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_health(Telemetry::HealthHandle handle)
+{
+    _health_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::HealthAllOkHandle TelemetryImpl::subscribe_health_all_ok(
+    const Telemetry::HealthAllOkCallback& callback, const SubscriptionOptions& options)
+{
+    if (!callback) {
+        _health_all_ok_subscriptions.clear();
+        return {};
+    }
+    return _health_all_ok_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_health_all_ok(Telemetry::HealthAllOkHandle handle)
+{
+    _health_all_ok_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_health_all_ok(Telemetry::HealthAllOkCallback& callback)
+Telemetry::VtolStateHandle TelemetryImpl::subscribe_vtol_state(
+    const Telemetry::VtolStateCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _health_all_ok_subscription = callback;
+    if (!callback) {
+        _vtol_state_subscriptions.clear();
+        return {};
+    }
+    return _vtol_state_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_vtol_state(Telemetry::VtolStateHandle handle)
+{
+    _vtol_state_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::LandedStateHandle TelemetryImpl::subscribe_landed_state(
+    const Telemetry::LandedStateCallback& callback, const SubscriptionOptions& options)
+{
+    if (!callback) {
+        _landed_state_subscriptions.clear();
+        return {};
+    }
+    return _landed_state_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_vtol_state(Telemetry::VtolStateCallback& callback)
+void TelemetryImpl::unsubscribe_landed_state(Telemetry::LandedStateHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _votl_state_subscription = callback;
+    _landed_state_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_landed_state(Telemetry::LandedStateCallback& callback)
+Telemetry::RcStatusHandle TelemetryImpl::subscribe_rc_status(
+    const Telemetry::RcStatusCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _landed_state_subscription = callback;
+    if (!callback) {
+        _rc_status_subscriptions.clear();
+        return {};
+    }
+    return _rc_status_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_rc_status(Telemetry::RcStatusCallback& callback)
+void TelemetryImpl::unsubscribe_rc_status(Telemetry::RcStatusHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _rc_status_subscription = callback;
+    _rc_status_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_unix_epoch_time(Telemetry::UnixEpochTimeCallback& callback)
+Telemetry::UnixEpochTimeHandle TelemetryImpl::subscribe_unix_epoch_time(
+    const Telemetry::UnixEpochTimeCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _unix_epoch_time_subscription = callback;
+    if (!callback) {
+        _unix_epoch_time_subscriptions.clear();
+        return {};
+    }
+    return _unix_epoch_time_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_actuator_control_target(
-    Telemetry::ActuatorControlTargetCallback& callback)
+void TelemetryImpl::unsubscribe_unix_epoch_time(Telemetry::UnixEpochTimeHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _actuator_control_target_subscription = callback;
+    _unix_epoch_time_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_actuator_output_status(
-    Telemetry::ActuatorOutputStatusCallback& callback)
+Telemetry::ActuatorControlTargetHandle TelemetryImpl::subscribe_actuator_control_target(
+    const Telemetry::ActuatorControlTargetCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _actuator_output_status_subscription = callback;
+    if (!callback) {
+        _actuator_control_target_subscriptions.clear();
+        return {};
+    }
+    return _actuator_control_target_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_odometry(Telemetry::OdometryCallback& callback)
+void TelemetryImpl::unsubscribe_actuator_control_target(
+    Telemetry::ActuatorControlTargetHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _odometry_subscription = callback;
+    _actuator_control_target_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_distance_sensor(Telemetry::DistanceSensorCallback& callback)
+Telemetry::ActuatorOutputStatusHandle TelemetryImpl::subscribe_actuator_output_status(
+    const Telemetry::ActuatorOutputStatusCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _distance_sensor_subscription = callback;
+    if (!callback) {
+        _actuator_output_status_subscriptions.clear();
+        return {};
+    }
+    return _actuator_output_status_subscriptions.subscribe(callback, options);
 }
 
-void TelemetryImpl::subscribe_scaled_pressure(Telemetry::ScaledPressureCallback& callback)
+void TelemetryImpl::unsubscribe_actuator_output_status(Telemetry::ActuatorOutputStatusHandle handle)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _scaled_pressure_subscription = callback;
+    _actuator_output_status_subscriptions.unsubscribe(handle);
 }
 
-void TelemetryImpl::subscribe_heading(Telemetry::HeadingCallback& callback)
+Telemetry::OdometryHandle TelemetryImpl::subscribe_odometry(
+    const Telemetry::OdometryCallback& callback, const SubscriptionOptions& options)
 {
-    std::lock_guard<std::mutex> lock(_subscription_mutex);
-    _heading_subscription = callback;
+    if (!callback) {
+        _odometry_subscriptions.clear();
+        return {};
+    }
+    return _odometry_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_odometry(Telemetry::OdometryHandle handle)
+{
+    _odometry_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::DistanceSensorHandle TelemetryImpl::subscribe_distance_sensor(
+    const Telemetry::DistanceSensorCallback& callback, const SubscriptionOptions& options)
+{
+    if (!callback) {
+        _distance_sensor_subscriptions.clear();
+        return {};
+    }
+    return _distance_sensor_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_distance_sensor(Telemetry::DistanceSensorHandle handle)
+{
+    _distance_sensor_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::ScaledPressureHandle TelemetryImpl::subscribe_scaled_pressure(
+    const Telemetry::ScaledPressureCallback& callback, const SubscriptionOptions& options)
+{
+    if (!callback) {
+        _scaled_pressure_subscriptions.clear();
+        return {};
+    }
+    return _scaled_pressure_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_scaled_pressure(Telemetry::ScaledPressureHandle handle)
+{
+    _scaled_pressure_subscriptions.unsubscribe(handle);
+}
+
+Telemetry::HeadingHandle TelemetryImpl::subscribe_heading(
+    const Telemetry::HeadingCallback& callback, const SubscriptionOptions& options)
+{
+    if (!callback) {
+        _heading_subscriptions.clear();
+        return {};
+    }
+    return _heading_subscriptions.subscribe(callback, options);
+}
+
+void TelemetryImpl::unsubscribe_heading(Telemetry::HeadingHandle handle)
+{
+    _heading_subscriptions.unsubscribe(handle);
 }
 
 void TelemetryImpl::request_home_position_async()
@@ -2361,6 +2896,237 @@ void TelemetryImpl::request_home_position_async()
     _parent->send_command_async(command_request_message, nullptr);
 }
 
+void TelemetryImpl::set_rates_async(
+    const std::vector<Telemetry::RateRequest>& rate_requests, Telemetry::SetRatesCallback callback)
+{
+    // Topics which share a message result in one request, so that e.g. in air
+    // and VTOL state don't end up overwriting each other's rate.
+    std::vector<std::pair<uint16_t, double>> message_rates;
+    bool unsupported = false;
+
+    // Index into message_rates for every request, or -1 if it is unsupported.
+    std::vector<int> message_indices;
+    message_indices.reserve(rate_requests.size());
+
+    for (const auto& rate_request : rate_requests) {
+        double rate_hz = rate_request.rate_hz;
+
+        switch (rate_request.topic) {
+            case Telemetry::RateTopic::RcStatus:
+                LogWarn() << "System status is usually fixed at 1 Hz";
+                unsupported = true;
+                message_indices.push_back(-1);
+                continue;
+            case Telemetry::RateTopic::Position:
+                _position_rate_hz = rate_hz;
+                rate_hz = std::max(_position_rate_hz, _velocity_ned_rate_hz);
+                break;
+            case Telemetry::RateTopic::VelocityNed:
+                _velocity_ned_rate_hz = rate_hz;
+                rate_hz = std::max(_position_rate_hz, _velocity_ned_rate_hz);
+                break;
+            default:
+                break;
+        }
+
+        const uint16_t message_id = message_id_from_rate_topic(rate_request.topic);
+        auto it = std::find_if(message_rates.begin(), message_rates.end(), [&](const auto& rate) {
+            return rate.first == message_id;
+        });
+        if (it == message_rates.end()) {
+            message_indices.push_back(static_cast<int>(message_rates.size()));
+            message_rates.emplace_back(message_id, rate_hz);
+        } else {
+            message_indices.push_back(static_cast<int>(it - message_rates.begin()));
+            it->second = std::max(it->second, rate_hz);
+        }
+    }
+
+    const Telemetry::Result initial_result =
+        unsupported ? Telemetry::Result::Unsupported : Telemetry::Result::Success;
+
+    if (message_rates.empty()) {
+        if (callback) {
+            std::vector<Telemetry::Result> request_results(
+                rate_requests.size(), Telemetry::Result::Unsupported);
+            _parent->call_user_callback([callback, initial_result, request_results]() {
+                callback(initial_result, request_results);
+            });
+        }
+        return;
+    }
+
+    // All requests are queued at once, the results are collected in request
+    // order so the combined result doesn't depend on the order of the acks.
+    struct Batch {
+        std::vector<Telemetry::Result> results;
+        std::vector<int> message_indices;
+        std::atomic<std::size_t> remaining;
+        Telemetry::Result initial_result;
+        Telemetry::SetRatesCallback callback;
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->results.resize(message_rates.size(), Telemetry::Result::Unknown);
+    batch->message_indices = std::move(message_indices);
+    batch->remaining = message_rates.size();
+    batch->initial_result = initial_result;
+    batch->callback = std::move(callback);
+
+    for (std::size_t i = 0; i < message_rates.size(); ++i) {
+        _parent->set_msg_rate_async(
+            message_rates[i].first,
+            message_rates[i].second,
+            [batch, i](MavlinkCommandSender::Result command_result, float) {
+                if (command_result == MavlinkCommandSender::Result::InProgress) {
+                    return;
+                }
+                batch->results[i] = telemetry_result_from_command_result(command_result);
+                if (batch->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                    return;
+                }
+
+                Telemetry::Result result = batch->initial_result;
+                for (const auto& message_result : batch->results) {
+                    if (result == Telemetry::Result::Success &&
+                        message_result != Telemetry::Result::Success) {
+                        result = message_result;
+                    }
+                }
+                if (batch->callback) {
+                    std::vector<Telemetry::Result> request_results;
+                    request_results.reserve(batch->message_indices.size());
+                    for (const int index : batch->message_indices) {
+                        request_results.push_back(
+                            index < 0 ? Telemetry::Result::Unsupported :
+                                        batch->results[static_cast<std::size_t>(index)]);
+                    }
+                    batch->callback(result, request_results);
+                }
+            });
+    }
+}
+
+Telemetry::Result TelemetryImpl::set_rates(const std::vector<Telemetry::RateRequest>& rate_requests)
+{
+    SyncWaiter<Telemetry::Result> waiter;
+
+    set_rates_async(
+        rate_requests, [&waiter](Telemetry::Result result, std::vector<Telemetry::Result>) {
+            waiter.complete(result);
+        });
+    return waiter.wait();
+}
+
+Telemetry::Result
+TelemetryImpl::enable_rate_adaptation(const Telemetry::RateAdaptationConfig& config)
+{
+    for (const auto& rate : config.rates) {
+        if (rate.topic == Telemetry::RateTopic::RcStatus) {
+            LogWarn() << "System status is usually fixed at 1 Hz";
+            return Telemetry::Result::Unsupported;
+        }
+        if (!(rate.min_rate_hz > 0.0) || !(rate.max_rate_hz >= rate.min_rate_hz)) {
+            LogWarn() << "Invalid rate range for " << rate.topic << ": " << rate.min_rate_hz
+                      << " to " << rate.max_rate_hz << " Hz";
+            return Telemetry::Result::Unsupported;
+        }
+    }
+
+    RateAdaptation::Config adaptation_config;
+    adaptation_config.max_loss_rate = config.max_loss_rate;
+    adaptation_config.max_rtt_factor = config.max_rtt_factor;
+    adaptation_config.link_bytes_per_s = config.link_bytes_per_s;
+    adaptation_config.headroom = std::clamp(config.headroom, 0.0, 1.0);
+
+    {
+        std::lock_guard<std::mutex> lock(_rate_adaptation_mutex);
+        _rate_adaptation.emplace(adaptation_config);
+        _adaptive_rates = config.rates;
+        _applied_rate_scale.reset();
+    }
+
+    // The rates start at their maximum right away, not on the next check.
+    update_rate_adaptation();
+    return Telemetry::Result::Success;
+}
+
+void TelemetryImpl::disable_rate_adaptation()
+{
+    std::vector<Telemetry::RateRequest> rate_requests;
+    {
+        std::lock_guard<std::mutex> lock(_rate_adaptation_mutex);
+        if (!_rate_adaptation) {
+            return;
+        }
+        if (_applied_rate_scale && *_applied_rate_scale < 1.0) {
+            for (const auto& rate : _adaptive_rates) {
+                rate_requests.push_back(Telemetry::RateRequest{rate.topic, rate.max_rate_hz});
+            }
+        }
+        _rate_adaptation.reset();
+        _adaptive_rates.clear();
+        _applied_rate_scale.reset();
+    }
+
+    if (!rate_requests.empty()) {
+        set_rates_async(rate_requests, nullptr);
+    }
+}
+
+double TelemetryImpl::rate_adaptation_scale() const
+{
+    std::lock_guard<std::mutex> lock(_rate_adaptation_mutex);
+    return _rate_adaptation ? _rate_adaptation->scale() : 1.0;
+}
+
+void TelemetryImpl::update_rate_adaptation()
+{
+    std::vector<Telemetry::RateRequest> rate_requests;
+    {
+        std::lock_guard<std::mutex> lock(_rate_adaptation_mutex);
+        if (!_rate_adaptation) {
+            return;
+        }
+
+        const double scale = _rate_adaptation->update(_parent->link_sample(), _time.elapsed_s());
+
+        // Rates are only set when the scale changed, and one change at a
+        // time, as each is a command on the same link.
+        if ((_applied_rate_scale && *_applied_rate_scale == scale) ||
+            _adaptive_rates_in_flight) {
+            return;
+        }
+        _applied_rate_scale = scale;
+        _adaptive_rates_in_flight = true;
+
+        for (const auto& rate : _adaptive_rates) {
+            rate_requests.push_back(Telemetry::RateRequest{
+                rate.topic, RateAdaptation::rate_hz(rate.min_rate_hz, rate.max_rate_hz, scale)});
+        }
+    }
+
+    if (!rate_requests.empty()) {
+        apply_adaptive_rates(rate_requests);
+    }
+}
+
+void TelemetryImpl::apply_adaptive_rates(const std::vector<Telemetry::RateRequest>& rate_requests)
+{
+    set_rates_async(
+        rate_requests, [this](Telemetry::Result result, std::vector<Telemetry::Result>) {
+            if (result != Telemetry::Result::Success) {
+                LogWarn() << "Could not set adapted rates: " << result;
+            }
+            // Likely to get through on the next check, which is not the case
+            // for e.g. a denied command.
+            if (result == Telemetry::Result::Timeout || result == Telemetry::Result::Busy) {
+                std::lock_guard<std::mutex> lock(_rate_adaptation_mutex);
+                _applied_rate_scale.reset();
+            }
+            _adaptive_rates_in_flight = false;
+        });
+}
+
 void TelemetryImpl::get_gps_global_origin_async(
     const Telemetry::GetGpsGlobalOriginCallback callback)
 {
@@ -2390,26 +3156,22 @@ void TelemetryImpl::get_gps_global_origin_async(
 
 std::pair<Telemetry::Result, Telemetry::GpsGlobalOrigin> TelemetryImpl::get_gps_global_origin()
 {
-    auto prom = std::promise<std::pair<Telemetry::Result, Telemetry::GpsGlobalOrigin>>();
-    auto fut = prom.get_future();
+    SyncWaiter<std::pair<Telemetry::Result, Telemetry::GpsGlobalOrigin>> waiter;
 
     get_gps_global_origin_async(
-        [&prom](Telemetry::Result result, Telemetry::GpsGlobalOrigin gps_global_origin) {
-            prom.set_value(std::make_pair(result, gps_global_origin));
+        [&waiter](Telemetry::Result result, Telemetry::GpsGlobalOrigin gps_global_origin) {
+            waiter.complete(std::make_pair(result, gps_global_origin));
         });
-    return fut.get();
+    return waiter.wait();
 }
 
 void TelemetryImpl::check_calibration()
 {
-    {
-        std::lock_guard<std::mutex> lock(_health_mutex);
-        if ((_has_received_gyro_calibration && _has_received_accel_calibration &&
-             _has_received_mag_calibration) ||
-            _has_received_hitl_param) {
-            _parent->remove_call_every(_calibration_cookie);
-            return;
-        }
+    if ((_has_received_gyro_calibration && _has_received_accel_calibration &&
+         _has_received_mag_calibration) ||
+        _has_received_hitl_param) {
+        _parent->remove_call_every(_calibration_cookie);
+        return;
     }
     if (_parent->has_autopilot()) {
         if (_parent->autopilot() == SystemImpl::Autopilot::ArduPilot) {
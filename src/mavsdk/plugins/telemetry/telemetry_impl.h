@@ -6,8 +6,15 @@
 
 #include "plugins/telemetry/telemetry.h"
 #include "mavlink_include.h"
+#include "batch_callback_list.h"
+#include "callback_list.h"
+#include "fleet_table.h"
+#include "lazy_decoder.h"
 #include "plugin_impl_base.h"
+#include "rate_adaptation.h"
+#include "seqlock.h"
 #include "system.h"
+#include "time_series.h"
 
 namespace mavsdk {
 
@@ -73,6 +80,15 @@ public:
     void set_rate_scaled_pressure_async(double rate_hz, Telemetry::ResultCallback callback);
     void set_rate_unix_epoch_time_async(double rate_hz, Telemetry::ResultCallback callback);
 
+    void set_rates_async(
+        const std::vector<Telemetry::RateRequest>& rate_requests,
+        Telemetry::SetRatesCallback callback);
+    Telemetry::Result set_rates(const std::vector<Telemetry::RateRequest>& rate_requests);
+
+    Telemetry::Result enable_rate_adaptation(const Telemetry::RateAdaptationConfig& config);
+    void disable_rate_adaptation();
+    double rate_adaptation_scale() const;
+
     void get_gps_global_origin_async(const Telemetry::GetGpsGlobalOriginCallback callback);
     std::pair<Telemetry::Result, Telemetry::GpsGlobalOrigin> get_gps_global_origin();
 
@@ -109,61 +125,160 @@ public:
     Telemetry::ScaledPressure scaled_pressure() const;
     uint64_t unix_epoch_time() const;
     Telemetry::Heading heading() const;
-
-    void subscribe_position_velocity_ned(Telemetry::PositionVelocityNedCallback& callback);
-    void subscribe_position(Telemetry::PositionCallback& callback);
-    void subscribe_home(Telemetry::PositionCallback& callback);
-    void subscribe_in_air(Telemetry::InAirCallback& callback);
-    void subscribe_status_text(Telemetry::StatusTextCallback& callback);
-    void subscribe_armed(Telemetry::ArmedCallback& callback);
-    void subscribe_attitude_quaternion(Telemetry::AttitudeQuaternionCallback& callback);
-    void subscribe_attitude_euler(Telemetry::AttitudeEulerCallback& callback);
-    void subscribe_attitude_angular_velocity_body(
-        Telemetry::AttitudeAngularVelocityBodyCallback& callback);
-    void subscribe_fixedwing_metrics(Telemetry::FixedwingMetricsCallback& callback);
-    void subscribe_ground_truth(Telemetry::GroundTruthCallback& callback);
-    void subscribe_camera_attitude_quaternion(Telemetry::AttitudeQuaternionCallback& callback);
-    void subscribe_camera_attitude_euler(Telemetry::AttitudeEulerCallback& callback);
-    void subscribe_velocity_ned(Telemetry::VelocityNedCallback& callback);
-    void subscribe_imu(Telemetry::ImuCallback& callback);
-    void subscribe_scaled_imu(Telemetry::ScaledImuCallback& callback);
-    void subscribe_raw_imu(Telemetry::RawImuCallback& callback);
-    void subscribe_gps_info(Telemetry::GpsInfoCallback& callback);
-    void subscribe_raw_gps(Telemetry::RawGpsCallback& callback);
-    void subscribe_battery(Telemetry::BatteryCallback& callback);
-    void subscribe_flight_mode(Telemetry::FlightModeCallback& callback);
-    void subscribe_health(Telemetry::HealthCallback& callback);
-    void subscribe_health_all_ok(Telemetry::HealthAllOkCallback& callback);
-    void subscribe_vtol_state(Telemetry::VtolStateCallback& callback);
-    void subscribe_landed_state(Telemetry::LandedStateCallback& callback);
-    void subscribe_rc_status(Telemetry::RcStatusCallback& callback);
-    void subscribe_unix_epoch_time(Telemetry::UnixEpochTimeCallback& callback);
-    void subscribe_actuator_control_target(Telemetry::ActuatorControlTargetCallback& callback);
-    void subscribe_actuator_output_status(Telemetry::ActuatorOutputStatusCallback& callback);
-    void subscribe_odometry(Telemetry::OdometryCallback& callback);
-    void subscribe_distance_sensor(Telemetry::DistanceSensorCallback& callback);
-    void subscribe_scaled_pressure(Telemetry::ScaledPressureCallback& callback);
-    void subscribe_heading(Telemetry::HeadingCallback& callback);
+    Telemetry::Snapshot snapshot(uint32_t fields) const;
+
+    void set_history_enabled(Telemetry::HistoryTopic topic, bool enabled);
+    std::vector<std::pair<uint64_t, Telemetry::Position>>
+    position_history(uint64_t start_time_us, uint64_t end_time_us) const;
+    std::optional<Telemetry::Position> position_at(uint64_t time_us) const;
+    std::vector<std::pair<uint64_t, Telemetry::Quaternion>>
+    attitude_quaternion_history(uint64_t start_time_us, uint64_t end_time_us) const;
+    std::optional<Telemetry::Quaternion> attitude_quaternion_at(uint64_t time_us) const;
+    std::vector<std::pair<uint64_t, Telemetry::EulerAngle>>
+    attitude_euler_history(uint64_t start_time_us, uint64_t end_time_us) const;
+    std::vector<std::pair<uint64_t, Telemetry::VelocityNed>>
+    velocity_ned_history(uint64_t start_time_us, uint64_t end_time_us) const;
+    std::optional<Telemetry::VelocityNed> velocity_ned_at(uint64_t time_us) const;
+    std::vector<std::pair<uint64_t, Telemetry::Imu>>
+    imu_history(uint64_t start_time_us, uint64_t end_time_us) const;
+    std::optional<Telemetry::Imu> imu_at(uint64_t time_us) const;
+
+    Telemetry::PositionVelocityNedHandle subscribe_position_velocity_ned(
+        const Telemetry::PositionVelocityNedCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_position_velocity_ned(Telemetry::PositionVelocityNedHandle handle);
+    Telemetry::PositionHandle subscribe_position(
+        const Telemetry::PositionCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_position(Telemetry::PositionHandle handle);
+    Telemetry::HomeHandle subscribe_home(
+        const Telemetry::HomeCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_home(Telemetry::HomeHandle handle);
+    Telemetry::InAirHandle subscribe_in_air(
+        const Telemetry::InAirCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_in_air(Telemetry::InAirHandle handle);
+    Telemetry::StatusTextHandle subscribe_status_text(
+        const Telemetry::StatusTextCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_status_text(Telemetry::StatusTextHandle handle);
+    Telemetry::ArmedHandle subscribe_armed(
+        const Telemetry::ArmedCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_armed(Telemetry::ArmedHandle handle);
+    Telemetry::AttitudeQuaternionHandle subscribe_attitude_quaternion(
+        const Telemetry::AttitudeQuaternionCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_attitude_quaternion(Telemetry::AttitudeQuaternionHandle handle);
+    Telemetry::AttitudeEulerHandle subscribe_attitude_euler(
+        const Telemetry::AttitudeEulerCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_attitude_euler(Telemetry::AttitudeEulerHandle handle);
+    Telemetry::AttitudeAngularVelocityBodyHandle subscribe_attitude_angular_velocity_body(
+        const Telemetry::AttitudeAngularVelocityBodyCallback& callback,
+        const SubscriptionOptions& options);
+    void unsubscribe_attitude_angular_velocity_body(
+        Telemetry::AttitudeAngularVelocityBodyHandle handle);
+    Telemetry::FixedwingMetricsHandle subscribe_fixedwing_metrics(
+        const Telemetry::FixedwingMetricsCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_fixedwing_metrics(Telemetry::FixedwingMetricsHandle handle);
+    Telemetry::GroundTruthHandle subscribe_ground_truth(
+        const Telemetry::GroundTruthCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_ground_truth(Telemetry::GroundTruthHandle handle);
+    Telemetry::CameraAttitudeQuaternionHandle subscribe_camera_attitude_quaternion(
+        const Telemetry::CameraAttitudeQuaternionCallback& callback,
+        const SubscriptionOptions& options);
+    void unsubscribe_camera_attitude_quaternion(Telemetry::CameraAttitudeQuaternionHandle handle);
+    Telemetry::CameraAttitudeEulerHandle subscribe_camera_attitude_euler(
+        const Telemetry::CameraAttitudeEulerCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_camera_attitude_euler(Telemetry::CameraAttitudeEulerHandle handle);
+    Telemetry::VelocityNedHandle subscribe_velocity_ned(
+        const Telemetry::VelocityNedCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_velocity_ned(Telemetry::VelocityNedHandle handle);
+    Telemetry::ImuHandle subscribe_imu(
+        const Telemetry::ImuCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_imu(Telemetry::ImuHandle handle);
+    Telemetry::ScaledImuHandle subscribe_scaled_imu(
+        const Telemetry::ScaledImuCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_scaled_imu(Telemetry::ScaledImuHandle handle);
+    Telemetry::RawImuHandle subscribe_raw_imu(
+        const Telemetry::RawImuCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_raw_imu(Telemetry::RawImuHandle handle);
+    Telemetry::ImuBatchHandle subscribe_imu_batch(
+        const Telemetry::ImuBatchCallback& callback, const BatchOptions& options);
+    void unsubscribe_imu_batch(Telemetry::ImuBatchHandle handle);
+    Telemetry::ImuBatchHandle subscribe_scaled_imu_batch(
+        const Telemetry::ImuBatchCallback& callback, const BatchOptions& options);
+    void unsubscribe_scaled_imu_batch(Telemetry::ImuBatchHandle handle);
+    Telemetry::ImuBatchHandle subscribe_raw_imu_batch(
+        const Telemetry::ImuBatchCallback& callback, const BatchOptions& options);
+    void unsubscribe_raw_imu_batch(Telemetry::ImuBatchHandle handle);
+    Telemetry::GpsInfoHandle subscribe_gps_info(
+        const Telemetry::GpsInfoCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_gps_info(Telemetry::GpsInfoHandle handle);
+    Telemetry::RawGpsHandle subscribe_raw_gps(
+        const Telemetry::RawGpsCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_raw_gps(Telemetry::RawGpsHandle handle);
+    Telemetry::BatteryHandle subscribe_battery(
+        const Telemetry::BatteryCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_battery(Telemetry::BatteryHandle handle);
+    Telemetry::FlightModeHandle subscribe_flight_mode(
+        const Telemetry::FlightModeCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_flight_mode(Telemetry::FlightModeHandle handle);
+    Telemetry::HealthHandle subscribe_health(
+        const Telemetry::HealthCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_health(Telemetry::HealthHandle handle);
+    Telemetry::HealthAllOkHandle subscribe_health_all_ok(
+        const Telemetry::HealthAllOkCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_health_all_ok(Telemetry::HealthAllOkHandle handle);
+    Telemetry::VtolStateHandle subscribe_vtol_state(
+        const Telemetry::VtolStateCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_vtol_state(Telemetry::VtolStateHandle handle);
+    Telemetry::LandedStateHandle subscribe_landed_state(
+        const Telemetry::LandedStateCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_landed_state(Telemetry::LandedStateHandle handle);
+    Telemetry::RcStatusHandle subscribe_rc_status(
+        const Telemetry::RcStatusCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_rc_status(Telemetry::RcStatusHandle handle);
+    Telemetry::UnixEpochTimeHandle subscribe_unix_epoch_time(
+        const Telemetry::UnixEpochTimeCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_unix_epoch_time(Telemetry::UnixEpochTimeHandle handle);
+    Telemetry::ActuatorControlTargetHandle subscribe_actuator_control_target(
+        const Telemetry::ActuatorControlTargetCallback& callback,
+        const SubscriptionOptions& options);
+    void unsubscribe_actuator_control_target(Telemetry::ActuatorControlTargetHandle handle);
+    Telemetry::ActuatorOutputStatusHandle subscribe_actuator_output_status(
+        const Telemetry::ActuatorOutputStatusCallback& callback,
+        const SubscriptionOptions& options);
+    void unsubscribe_actuator_output_status(Telemetry::ActuatorOutputStatusHandle handle);
+    Telemetry::OdometryHandle subscribe_odometry(
+        const Telemetry::OdometryCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_odometry(Telemetry::OdometryHandle handle);
+    Telemetry::DistanceSensorHandle subscribe_distance_sensor(
+        const Telemetry::DistanceSensorCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_distance_sensor(Telemetry::DistanceSensorHandle handle);
+    Telemetry::ScaledPressureHandle subscribe_scaled_pressure(
+        const Telemetry::ScaledPressureCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_scaled_pressure(Telemetry::ScaledPressureHandle handle);
+    Telemetry::HeadingHandle subscribe_heading(
+        const Telemetry::HeadingCallback& callback, const SubscriptionOptions& options);
+    void unsubscribe_heading(Telemetry::HeadingHandle handle);
 
     TelemetryImpl(const TelemetryImpl&) = delete;
     TelemetryImpl& operator=(const TelemetryImpl&) = delete;
 
 private:
     void set_position_velocity_ned(Telemetry::PositionVelocityNed position_velocity_ned);
-    void set_position(Telemetry::Position position);
+    void set_global_position(
+        Telemetry::Position position,
+        Telemetry::VelocityNed velocity_ned,
+        Telemetry::Heading heading,
+        uint64_t time_us);
     void set_home_position(Telemetry::Position home_position);
     void set_in_air(bool in_air);
     void set_vtol_state(Telemetry::VtolState vtol_state);
     void set_landed_state(Telemetry::LandedState landed_state);
     void set_status_text(Telemetry::StatusText status_text);
     void set_armed(bool armed);
-    void set_attitude_quaternion(Telemetry::Quaternion quaternion);
+    void set_attitude_quaternion(Telemetry::Quaternion quaternion, uint64_t time_us);
     void set_attitude_angular_velocity_body(Telemetry::AngularVelocityBody angular_velocity_body);
     void set_fixedwing_metrics(Telemetry::FixedwingMetrics fixedwing_metrics);
     void set_ground_truth(Telemetry::GroundTruth ground_truth);
     void set_camera_attitude_euler_angle(Telemetry::EulerAngle euler_angle);
-    void set_velocity_ned(Telemetry::VelocityNed velocity_ned);
-    void set_imu_reading_ned(Telemetry::Imu imu);
+    void set_imu_reading_ned(Telemetry::Imu imu, uint64_t time_us);
     void set_scaled_imu(Telemetry::Imu imu);
     void set_raw_imu(Telemetry::Imu imu);
     void set_gps_info(Telemetry::GpsInfo gps_info);
@@ -178,27 +293,53 @@ private:
     void set_health_armable(bool ok);
     void set_rc_status(std::optional<bool> available, std::optional<float> signal_strength_percent);
     void set_unix_epoch_time_us(uint64_t time_us);
-    void set_actuator_control_target(uint8_t group, const std::vector<float>& controls);
-    void set_actuator_output_status(uint32_t active, const std::vector<float>& actuators);
-    void set_odometry(Telemetry::Odometry& odometry);
+    void set_actuator_control_target(const Telemetry::ActuatorControlTarget& target);
+    void set_actuator_output_status(const Telemetry::ActuatorOutputStatus& status);
     void set_distance_sensor(Telemetry::DistanceSensor& distance_sensor);
     void set_scaled_pressure(Telemetry::ScaledPressure& scaled_pressure);
-    void set_heading(Telemetry::Heading heading);
 
-    void process_position_velocity_ned(const mavlink_message_t& message);
-    void process_global_position_int(const mavlink_message_t& message);
+    uint64_t steady_time_us();
+
+    // Local time a sample with the given vehicle timestamp was taken at, if the
+    // vehicle clock is synced, otherwise the receive time.
+    uint64_t sample_time_us(uint64_t remote_us);
+
+    // A vehicle timestamp this much older than the receive time is on a
+    // different time base, e.g. UNIX epoch instead of boot time.
+    static constexpr uint64_t MAX_SAMPLE_AGE_US = 1000000;
+
+    // Returns the receive time stored with the value.
+    template<typename T>
+    uint64_t update_snapshot(
+        T Telemetry::Snapshot::*field,
+        uint64_t Telemetry::Snapshot::*receive_time_us,
+        uint32_t snapshot_field,
+        const T& value);
+
+    // The same but with the time given.
+    template<typename T>
+    void update_snapshot(
+        T Telemetry::Snapshot::*field,
+        uint64_t Telemetry::Snapshot::*receive_time_us,
+        uint32_t snapshot_field,
+        const T& value,
+        uint64_t time_us);
+
+    void process_position_velocity_ned(const mavlink_local_position_ned_t& local_position);
+    void process_global_position_int(const mavlink_global_position_int_t& global_position_int);
     void process_home_position(const mavlink_message_t& message);
-    void process_attitude(const mavlink_message_t& message);
-    void process_attitude_quaternion(const mavlink_message_t& message);
+    void process_attitude(const mavlink_attitude_t& attitude);
+    void process_attitude_quaternion(
+        const mavlink_attitude_quaternion_t& mavlink_attitude_quaternion);
     void process_gimbal_device_attitude_status(const mavlink_message_t& message);
     void process_mount_orientation(const mavlink_message_t& message);
-    void process_imu_reading_ned(const mavlink_message_t& message);
-    void process_scaled_imu(const mavlink_message_t& message);
-    void process_raw_imu(const mavlink_message_t& message);
+    void process_imu_reading_ned(const mavlink_highres_imu_t& highres_imu);
+    void process_scaled_imu(const mavlink_scaled_imu_t& scaled_imu_reading);
+    void process_raw_imu(const mavlink_raw_imu_t& raw_imu_reading);
     void process_gps_raw_int(const mavlink_message_t& message);
     void process_ground_truth(const mavlink_message_t& message);
     void process_extended_sys_state(const mavlink_message_t& message);
-    void process_fixedwing_metrics(const mavlink_message_t& message);
+    void process_fixedwing_metrics(const mavlink_vfr_hud_t& vfr_hud);
     void process_sys_status(const mavlink_message_t& message);
     void process_battery_status(const mavlink_message_t& message);
     void process_heartbeat(const mavlink_message_t& message);
@@ -206,9 +347,9 @@ private:
     void process_unix_epoch_time(const mavlink_message_t& message);
     void process_actuator_control_target(const mavlink_message_t& message);
     void process_actuator_output_status(const mavlink_message_t& message);
-    void process_odometry(const mavlink_message_t& message);
+    void process_odometry(const mavlink_odometry_t& odometry_msg);
     void process_distance_sensor(const mavlink_message_t& message);
-    void process_scaled_pressure(const mavlink_message_t& message);
+    void process_scaled_pressure(const mavlink_scaled_pressure_t& scaled_pressure_msg);
     void receive_param_cal_gyro(MAVLinkParameters::Result result, int value);
     void receive_param_cal_accel(MAVLinkParameters::Result result, int value);
     void receive_param_cal_mag(MAVLinkParameters::Result result, int value);
@@ -235,6 +376,7 @@ private:
 
     void request_home_position_async();
     void check_calibration();
+    void flush_imu_batches();
 
     static Telemetry::Result
     telemetry_result_from_command_result(MavlinkCommandSender::Result command_result);
@@ -242,26 +384,87 @@ private:
     static void command_result_callback(
         MavlinkCommandSender::Result command_result, const Telemetry::ResultCallback& callback);
 
+    static uint16_t message_id_from_rate_topic(Telemetry::RateTopic rate_topic);
+
+    static Telemetry::Odometry odometry_from_mavlink(const mavlink_odometry_t& odometry_msg);
+
     static Telemetry::LandedState to_landed_state(mavlink_extended_sys_state_t extended_sys_state);
     static Telemetry::VtolState to_vtol_state(mavlink_extended_sys_state_t extended_sys_state);
 
     static Telemetry::FlightMode
     telemetry_flight_mode_from_flight_mode(SystemImpl::FlightMode flight_mode);
 
-    // Make all fields thread-safe using mutexs
-    // The mutexs are mutable so that the lock can get aqcuired in
-    // methods marked const.
-    mutable std::mutex _position_mutex{};
-    Telemetry::Position _position{};
+    // Make all fields thread-safe.
+    // Plain data is kept in seqlocks, so getters never block on the
+    // receive path. Fields containing strings or vectors can't be copied
+    // word by word and stay protected by a mutex. The mutexes are mutable
+    // so that the lock can get acquired in methods marked const.
+    //
+    // Fields which can be read together via snapshot() all live in the
+    // snapshot itself, so one read returns all of them consistently.
+    Seqlock<Telemetry::Snapshot> _snapshot{};
+
+    Seqlock<Telemetry::Position> _home_position{};
+
+    // Opt-in history of a topic. The samples are only allocated once it is
+    // enabled, and checking whether it is enabled doesn't take the lock, so
+    // topics without history cost nothing on the receive path.
+    template<typename T> class History {
+    public:
+        static constexpr std::size_t CAPACITY = 256;
+
+        void set_enabled(bool enabled)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (enabled && !_samples) {
+                _samples = std::make_unique<TimeSeries<T, CAPACITY>>();
+            } else if (!enabled) {
+                _samples.reset();
+            }
+            _enabled.store(enabled, std::memory_order_relaxed);
+        }
 
-    mutable std::mutex _heading_mutex{};
-    Telemetry::Heading _heading{};
+        void record(uint64_t time_us, const T& value)
+        {
+            if (!_enabled.load(std::memory_order_relaxed)) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_samples) {
+                _samples->push(time_us, value);
+            }
+        }
+
+        std::vector<std::pair<uint64_t, T>>
+        between(uint64_t start_time_us, uint64_t end_time_us) const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_samples) {
+                return {};
+            }
+            return _samples->between(start_time_us, end_time_us);
+        }
+
+        template<typename Interpolate>
+        std::optional<T> at(uint64_t time_us, const Interpolate& interpolate) const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_samples) {
+                return std::nullopt;
+            }
+            return _samples->at(time_us, interpolate);
+        }
 
-    mutable std::mutex _position_velocity_ned_mutex{};
-    Telemetry::PositionVelocityNed _position_velocity_ned{};
+    private:
+        mutable std::mutex _mutex{};
+        std::unique_ptr<TimeSeries<T, CAPACITY>> _samples{};
+        std::atomic<bool> _enabled{false};
+    };
 
-    mutable std::mutex _home_position_mutex{};
-    Telemetry::Position _home_position{};
+    History<Telemetry::Position> _position_history{};
+    History<Telemetry::Quaternion> _attitude_quaternion_history{};
+    History<Telemetry::VelocityNed> _velocity_ned_history{};
+    History<Telemetry::Imu> _imu_history{};
 
     // If possible, just use atomic instead of a mutex.
     std::atomic_bool _in_air{false};
@@ -270,56 +473,25 @@ private:
     mutable std::mutex _status_text_mutex{};
     Telemetry::StatusText _status_text{};
 
-    mutable std::mutex _attitude_quaternion_mutex{};
-    Telemetry::Quaternion _attitude_quaternion{};
-
-    mutable std::mutex _camera_attitude_euler_angle_mutex{};
-    Telemetry::EulerAngle _camera_attitude_euler_angle{};
-
-    mutable std::mutex _attitude_angular_velocity_body_mutex{};
-    Telemetry::AngularVelocityBody _attitude_angular_velocity_body{};
-
-    mutable std::mutex _ground_truth_mutex{};
-    Telemetry::GroundTruth _ground_truth{};
-
-    mutable std::mutex _fixedwing_metrics_mutex{};
-    Telemetry::FixedwingMetrics _fixedwing_metrics{};
+    Seqlock<Telemetry::EulerAngle> _camera_attitude_euler_angle{};
 
-    mutable std::mutex _velocity_ned_mutex{};
-    Telemetry::VelocityNed _velocity_ned{};
+    Seqlock<Telemetry::FixedwingMetrics> _fixedwing_metrics{};
 
-    mutable std::mutex _imu_reading_ned_mutex{};
-    Telemetry::Imu _imu_reading_ned{};
+    Seqlock<Telemetry::GpsInfo> _gps_info{};
 
-    mutable std::mutex _scaled_imu_mutex{};
-    Telemetry::Imu _scaled_imu{};
+    Seqlock<Telemetry::RawGps> _raw_gps{};
 
-    mutable std::mutex _raw_imu_mutex{};
-    Telemetry::Imu _raw_imu{};
+    Seqlock<Telemetry::Battery> _battery{};
 
-    mutable std::mutex _gps_info_mutex{};
-    Telemetry::GpsInfo _gps_info{};
+    Seqlock<Telemetry::Health> _health{};
 
-    mutable std::mutex _raw_gps_mutex{};
-    Telemetry::RawGps _raw_gps{};
+    Seqlock<Telemetry::VtolState> _vtol_state{Telemetry::VtolState::Undefined};
 
-    mutable std::mutex _battery_mutex{};
-    Telemetry::Battery _battery{};
+    Seqlock<Telemetry::LandedState> _landed_state{Telemetry::LandedState::Unknown};
 
-    mutable std::mutex _health_mutex{};
-    Telemetry::Health _health{};
+    Seqlock<Telemetry::RcStatus> _rc_status{};
 
-    mutable std::mutex _vtol_state_mutex{};
-    Telemetry::VtolState _vtol_state{Telemetry::VtolState::Undefined};
-
-    mutable std::mutex _landed_state_mutex{};
-    Telemetry::LandedState _landed_state{Telemetry::LandedState::Unknown};
-
-    mutable std::mutex _rc_status_mutex{};
-    Telemetry::RcStatus _rc_status{};
-
-    mutable std::mutex _unix_epoch_time_mutex{};
-    uint64_t _unix_epoch_time_us{};
+    std::atomic<uint64_t> _unix_epoch_time_us{0};
 
     mutable std::mutex _actuator_control_target_mutex{};
     Telemetry::ActuatorControlTarget _actuator_control_target{};
@@ -327,52 +499,52 @@ private:
     mutable std::mutex _actuator_output_status_mutex{};
     Telemetry::ActuatorOutputStatus _actuator_output_status{};
 
-    mutable std::mutex _odometry_mutex{};
-    Telemetry::Odometry _odometry{};
+    LazyDecoder<mavlink_odometry_t, Telemetry::Odometry> _odometry{&odometry_from_mavlink};
 
-    mutable std::mutex _distance_sensor_mutex{};
-    Telemetry::DistanceSensor _distance_sensor{};
+    Seqlock<Telemetry::DistanceSensor> _distance_sensor{};
 
-    mutable std::mutex _scaled_pressure_mutex{};
-    Telemetry::ScaledPressure _scaled_pressure{};
+    Seqlock<Telemetry::ScaledPressure> _scaled_pressure{};
 
     std::atomic<bool> _hitl_enabled{false};
 
-    std::mutex _subscription_mutex{};
-    Telemetry::PositionVelocityNedCallback _position_velocity_ned_subscription{nullptr};
-    Telemetry::PositionCallback _position_subscription{nullptr};
-    Telemetry::PositionCallback _home_position_subscription{nullptr};
-    Telemetry::InAirCallback _in_air_subscription{nullptr};
-    Telemetry::StatusTextCallback _status_text_subscription{nullptr};
-    Telemetry::ArmedCallback _armed_subscription{nullptr};
-    Telemetry::AttitudeQuaternionCallback _attitude_quaternion_angle_subscription{nullptr};
-    Telemetry::AttitudeAngularVelocityBodyCallback _attitude_angular_velocity_body_subscription{
-        nullptr};
-    Telemetry::GroundTruthCallback _ground_truth_subscription{nullptr};
-    Telemetry::FixedwingMetricsCallback _fixedwing_metrics_subscription{nullptr};
-    Telemetry::AttitudeEulerCallback _attitude_euler_angle_subscription{nullptr};
-    Telemetry::AttitudeQuaternionCallback _camera_attitude_quaternion_subscription{nullptr};
-    Telemetry::AttitudeEulerCallback _camera_attitude_euler_angle_subscription{nullptr};
-    Telemetry::VelocityNedCallback _velocity_ned_subscription{nullptr};
-    Telemetry::ImuCallback _imu_reading_ned_subscription{nullptr};
-    Telemetry::ScaledImuCallback _scaled_imu_subscription{nullptr};
-    Telemetry::RawImuCallback _raw_imu_subscription{nullptr};
-    Telemetry::GpsInfoCallback _gps_info_subscription{nullptr};
-    Telemetry::RawGpsCallback _raw_gps_subscription{nullptr};
-    Telemetry::BatteryCallback _battery_subscription{nullptr};
-    Telemetry::FlightModeCallback _flight_mode_subscription{nullptr};
-    Telemetry::HealthCallback _health_subscription{nullptr};
-    Telemetry::HealthAllOkCallback _health_all_ok_subscription{nullptr};
-    Telemetry::VtolStateCallback _votl_state_subscription{nullptr};
-    Telemetry::LandedStateCallback _landed_state_subscription{nullptr};
-    Telemetry::RcStatusCallback _rc_status_subscription{nullptr};
-    Telemetry::UnixEpochTimeCallback _unix_epoch_time_subscription{nullptr};
-    Telemetry::ActuatorControlTargetCallback _actuator_control_target_subscription{nullptr};
-    Telemetry::ActuatorOutputStatusCallback _actuator_output_status_subscription{nullptr};
-    Telemetry::OdometryCallback _odometry_subscription{nullptr};
-    Telemetry::DistanceSensorCallback _distance_sensor_subscription{nullptr};
-    Telemetry::ScaledPressureCallback _scaled_pressure_subscription{nullptr};
-    Telemetry::HeadingCallback _heading_subscription{nullptr};
+    Time _time{};
+
+    CallbackList<Telemetry::PositionVelocityNed> _position_velocity_ned_subscriptions{};
+    CallbackList<Telemetry::Position> _position_subscriptions{};
+    CallbackList<Telemetry::Position> _home_position_subscriptions{};
+    CallbackList<bool> _in_air_subscriptions{};
+    CallbackList<Telemetry::StatusText> _status_text_subscriptions{};
+    CallbackList<bool> _armed_subscriptions{};
+    CallbackList<Telemetry::Quaternion> _attitude_quaternion_angle_subscriptions{};
+    CallbackList<Telemetry::AngularVelocityBody> _attitude_angular_velocity_body_subscriptions{};
+    CallbackList<Telemetry::GroundTruth> _ground_truth_subscriptions{};
+    CallbackList<Telemetry::FixedwingMetrics> _fixedwing_metrics_subscriptions{};
+    CallbackList<Telemetry::EulerAngle> _attitude_euler_angle_subscriptions{};
+    CallbackList<Telemetry::Quaternion> _camera_attitude_quaternion_subscriptions{};
+    CallbackList<Telemetry::EulerAngle> _camera_attitude_euler_angle_subscriptions{};
+    CallbackList<Telemetry::VelocityNed> _velocity_ned_subscriptions{};
+    CallbackList<Telemetry::Imu> _imu_reading_ned_subscriptions{};
+    CallbackList<Telemetry::Imu> _scaled_imu_subscriptions{};
+    CallbackList<Telemetry::Imu> _raw_imu_subscriptions{};
+    BatchCallbackList<Telemetry::Imu> _imu_batch_subscriptions{};
+    BatchCallbackList<Telemetry::Imu> _scaled_imu_batch_subscriptions{};
+    BatchCallbackList<Telemetry::Imu> _raw_imu_batch_subscriptions{};
+    CallbackList<Telemetry::GpsInfo> _gps_info_subscriptions{};
+    CallbackList<Telemetry::RawGps> _raw_gps_subscriptions{};
+    CallbackList<Telemetry::Battery> _battery_subscriptions{};
+    CallbackList<Telemetry::FlightMode> _flight_mode_subscriptions{};
+    CallbackList<Telemetry::Health> _health_subscriptions{};
+    CallbackList<bool> _health_all_ok_subscriptions{};
+    CallbackList<Telemetry::VtolState> _vtol_state_subscriptions{};
+    CallbackList<Telemetry::LandedState> _landed_state_subscriptions{};
+    CallbackList<Telemetry::RcStatus> _rc_status_subscriptions{};
+    CallbackList<uint64_t> _unix_epoch_time_subscriptions{};
+    CallbackList<Telemetry::ActuatorControlTarget> _actuator_control_target_subscriptions{};
+    CallbackList<Telemetry::ActuatorOutputStatus> _actuator_output_status_subscriptions{};
+    CallbackList<Telemetry::Odometry> _odometry_subscriptions{};
+    CallbackList<Telemetry::DistanceSensor> _distance_sensor_subscriptions{};
+    CallbackList<Telemetry::ScaledPressure> _scaled_pressure_subscriptions{};
+    CallbackList<Telemetry::Heading> _heading_subscriptions{};
 
     // The velocity (former ground speed) and position are coupled to the same message, therefore,
     // we just use the faster between the two.
@@ -387,7 +559,23 @@ private:
     // If no BATTERY_STATUS messages are received, use info from SYS_STATUS.
     bool _has_bat_status{false};
 
+    // This vehicle's row in the table shared with all other vehicles, if
+    // there was space left.
+    std::optional<std::size_t> _fleet_row{};
+
     void* _calibration_cookie{nullptr};
+    void* _imu_batch_cookie{nullptr};
+
+    void update_rate_adaptation();
+    void apply_adaptive_rates(const std::vector<Telemetry::RateRequest>& rate_requests);
+
+    // Checked once a second, idle unless enabled.
+    void* _rate_adaptation_cookie{nullptr};
+    mutable std::mutex _rate_adaptation_mutex{};
+    std::optional<RateAdaptation> _rate_adaptation{};
+    std::vector<Telemetry::AdaptiveRate> _adaptive_rates{};
+    std::optional<double> _applied_rate_scale{}; ///< Last scale the rates were set for
+    std::atomic<bool> _adaptive_rates_in_flight{false};
 
     std::atomic<bool> _has_received_hitl_param{false};
 
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "benchmark_helpers.h"
+#include "mavsdk.h"
+#include "plugins/telemetry/telemetry.h"
+#include "vehicle_simulator.h"
+
+using namespace mavsdk;
+
+// A ground station connected to more and more simulated vehicles, each
+// sending the PX4 default streams, with a few Telemetry subscriptions per
+// vehicle. Reports what MAVSDK uses with that many vehicles, without what
+// the simulator uses.
+//
+// There are at most 254 vehicles because system IDs are 8 bit.
+static void Telemetry_Scale(benchmark::State& state)
+{
+    const auto num_vehicles = static_cast<unsigned>(state.range(0));
+    constexpr int ground_station_port = 14650;
+    constexpr auto measuring_time = std::chrono::seconds(5);
+
+    for (auto _ : state) {
+        // Outlives Mavsdk, which calls whatever callbacks are still queued.
+        std::atomic<uint64_t> num_callbacks{0};
+
+        Mavsdk::Configuration configuration{Mavsdk::Configuration::UsageType::GroundStation};
+        configuration.set_message_latency_stats(true);
+        Mavsdk mavsdk{configuration};
+        if (mavsdk.add_any_connection("udp://:" + std::to_string(ground_station_port)) !=
+            ConnectionResult::Success) {
+            state.SkipWithError("Could not add connection");
+            return;
+        }
+
+        VehicleSimulator simulator;
+        if (!simulator.start(num_vehicles, ground_station_port)) {
+            state.SkipWithError("Could not start simulator");
+            return;
+        }
+
+        const auto discovery_start = std::chrono::steady_clock::now();
+        while (mavsdk.systems().size() < num_vehicles) {
+            if (std::chrono::steady_clock::now() - discovery_start > std::chrono::seconds(30)) {
+                state.SkipWithError("Not all vehicles discovered");
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        const auto discovery_time = std::chrono::steady_clock::now() - discovery_start;
+
+        std::vector<std::unique_ptr<Telemetry>> telemetries;
+        for (const auto& system : mavsdk.systems()) {
+            auto telemetry = std::make_unique<Telemetry>(system);
+            telemetry->subscribe_position([&](Telemetry::Position) { ++num_callbacks; });
+            telemetry->subscribe_attitude_euler([&](Telemetry::EulerAngle) { ++num_callbacks; });
+            telemetry->subscribe_battery([&](Telemetry::Battery) { ++num_callbacks; });
+            telemetries.push_back(std::move(telemetry));
+        }
+
+        // Let whatever the subscriptions and discovery started settle.
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        mavsdk.reset_message_latency_stats();
+
+        const auto before = process_stats();
+        const auto simulator_cpu_before = simulator.cpu_time_ns();
+        const auto callbacks_before = num_callbacks.load();
+        const auto start = std::chrono::steady_clock::now();
+
+        std::this_thread::sleep_for(measuring_time);
+
+        const auto after = process_stats();
+        const auto elapsed_s =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const auto simulator_cpu_ns = simulator.cpu_time_ns() - simulator_cpu_before;
+        const auto cpu_ns = after.cpu_time_ns - before.cpu_time_ns;
+        const auto mavsdk_cpu_ns = cpu_ns > simulator_cpu_ns ? cpu_ns - simulator_cpu_ns : 0;
+
+        // The worst of the messages subscribed to.
+        uint64_t callback_p50_ns = 0;
+        uint64_t callback_p99_ns = 0;
+        for (const auto& stats : mavsdk.message_latency_stats()) {
+            if (stats.callback.count == 0) {
+                continue;
+            }
+            callback_p50_ns = std::max(callback_p50_ns, stats.callback.p50_ns);
+            callback_p99_ns = std::max(callback_p99_ns, stats.callback.p99_ns);
+        }
+
+        state.counters["discovery_s"] = std::chrono::duration<double>(discovery_time).count();
+        state.counters["cpu_percent"] =
+            100.0 * static_cast<double>(mavsdk_cpu_ns) / 1e9 / elapsed_s;
+        state.counters["rss_mb"] = static_cast<double>(after.rss_bytes) / (1024.0 * 1024.0);
+        state.counters["threads"] = after.threads;
+        state.counters["callbacks/s"] =
+            static_cast<double>(num_callbacks.load() - callbacks_before) / elapsed_s;
+        state.counters["callback_p50_us"] = static_cast<double>(callback_p50_ns) / 1e3;
+        state.counters["callback_p99_us"] = static_cast<double>(callback_p99_ns) / 1e3;
+
+        telemetries.clear();
+        simulator.stop();
+    }
+}
+BENCHMARK(Telemetry_Scale)
+    ->ArgName("vehicles")
+    ->Arg(1)
+    ->Arg(10)
+    ->Arg(50)
+    ->Arg(100)
+    ->Arg(250)
+    ->Iterations(1)
+    ->Unit(benchmark::kSecond)
+    ->UseRealTime();
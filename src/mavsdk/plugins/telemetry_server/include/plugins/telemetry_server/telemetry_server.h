@@ -14,6 +14,7 @@
 #include <utility>
 #include <vector>
 
+#include "mavsdk/inline_vector.h"
 #include "mavsdk/plugin_base.h"
 
 namespace mavsdk {
@@ -425,7 +426,7 @@ public:
     struct ActuatorControlTarget {
         int32_t group{0}; /**< @brief An actuator control group is e.g. 'attitude' for the core
                              flight controls, or 'gimbal' for a payload. */
-        std::vector<float>
+        InlineVector<float, 8>
             controls{}; /**< @brief Controls normed from -1 to 1, where 0 is neutral position. */
     };
 
@@ -451,7 +452,7 @@ public:
      */
     struct ActuatorOutputStatus {
         uint32_t active{0}; /**< @brief Active outputs */
-        std::vector<float> actuator{}; /**< @brief Servo/motor output values */
+        InlineVector<float, 32> actuator{}; /**< @brief Servo/motor output values */
     };
 
     /**
@@ -479,7 +480,7 @@ public:
      * Set first to NaN if unknown.
      */
     struct Covariance {
-        std::vector<float>
+        InlineVector<float, 21>
             covariance_matrix{}; /**< @brief Representation of a covariance matrix. */
     };
 
@@ -18,9 +18,11 @@ TelemetryServerImpl::TelemetryServerImpl(std::shared_ptr<System> system) :
 TelemetryServerImpl::~TelemetryServerImpl()
 {
     _parent->unregister_plugin(this);
-    std::unique_lock<std::mutex> lock(_interval_mutex);
-    for (const auto& request : _interval_requests) {
-        _parent->remove_call_every(request.cookie);
+    std::lock_guard<std::mutex> lock(_streams_mutex);
+    for (auto& [msg_id, stream] : _streams) {
+        if (stream->cookie != nullptr) {
+            _parent->remove_call_every(stream->cookie);
+        }
     }
 }
 
@@ -30,51 +32,95 @@ void TelemetryServerImpl::init()
     _parent->register_mavlink_command_handler(
         MAV_CMD_SET_MESSAGE_INTERVAL,
         [this](const MavlinkCommandReceiver::CommandLong& command) {
-            std::lock_guard<std::mutex> lock(_interval_mutex);
-            uint32_t msgid = static_cast<uint32_t>(command.params.param1);
-            // Set interval to 1hz if 0 (default rate)
-            uint32_t interval_ms =
-                command.params.param2 == 0 ?
-                    1000 :
-                    static_cast<uint32_t>(static_cast<double>(command.params.param2) * 1E-3);
-            LogDebug() << "Setting interval for msg id: " << std::to_string(msgid)
-                       << " interval_ms:" << std::to_string(interval_ms);
-            auto found = std::find_if(
-                _interval_requests.begin(),
-                _interval_requests.end(),
-                [msgid](const RequestMsgInterval& item) { return item.msg_id == msgid; });
-
-            if (found == _interval_requests.end() && command.params.param2 != -1) {
-                // If not found interval already, add a new one
-                _interval_requests.push_back({msgid, interval_ms, nullptr});
-                _parent->add_call_every(
-                    [this, msgid]() {
-                        std::lock_guard<std::mutex> lock_interval(_interval_mutex);
-                        if (_msg_cache.find(msgid) != _msg_cache.end()) {
-                            // Publish if callback exists :)
-                            _parent->send_message(_msg_cache.at(msgid));
-                        }
-                    },
-                    static_cast<double>(interval_ms) * 1E-3,
-                    &_interval_requests.back().cookie);
-            } else {
-                if (command.params.param2 == -1) {
-                    // Deregister with -1 interval
-                    _parent->remove_call_every(found->cookie);
-                    _interval_requests.erase(found);
-                } else {
-                    // Update Interval
-                    found->interval = interval_ms;
-                    _parent->change_call_every(
-                        static_cast<double>(interval_ms) * 1E-3, found->cookie);
-                }
-            }
-
+            set_message_interval(
+                static_cast<uint32_t>(command.params.param1), command.params.param2);
             return _parent->make_command_ack_message(command, MAV_RESULT::MAV_RESULT_ACCEPTED);
         },
         this);
 }
 
+void TelemetryServerImpl::set_message_interval(uint32_t msg_id, float interval_us)
+{
+    std::lock_guard<std::mutex> lock(_streams_mutex);
+    auto& stream = stream_for(msg_id);
+
+    if (interval_us == -1.0f) {
+        // Deregister with -1 interval, the stream is not sent at all anymore.
+        LogDebug() << "Disabling msg id: " << msg_id;
+        if (stream.cookie != nullptr) {
+            _parent->remove_call_every(stream.cookie);
+            stream.cookie = nullptr;
+        }
+        stream.mode = Stream::Mode::Disabled;
+        return;
+    }
+
+    // Set interval to 1hz if 0 (default rate)
+    const double interval_s =
+        interval_us == 0.0f ? 1.0 : static_cast<double>(interval_us) * 1E-6;
+    LogDebug() << "Setting interval for msg id: " << msg_id << " interval_s: " << interval_s;
+
+    stream.mode = Stream::Mode::Interval;
+    if (stream.cookie != nullptr) {
+        _parent->change_call_every(static_cast<float>(interval_s), stream.cookie);
+        return;
+    }
+
+    // The stream is never removed, so it can be referred to from here on.
+    Stream* stream_ptr = &stream;
+    _parent->add_call_every(
+        [this, stream_ptr]() { send_stream(*stream_ptr); },
+        static_cast<float>(interval_s),
+        &stream.cookie);
+}
+
+TelemetryServerImpl::Stream& TelemetryServerImpl::stream_for(uint32_t msg_id)
+{
+    // Assumes to have the lock for _streams_mutex.
+    auto& stream = _streams[msg_id];
+    if (!stream) {
+        // Only the first publish or interval request of a message allocates.
+        stream = std::make_unique<Stream>();
+    }
+    return *stream;
+}
+
+void TelemetryServerImpl::send_stream(const Stream& stream)
+{
+    mavlink_message_t message;
+    {
+        std::lock_guard<std::mutex> lock(_streams_mutex);
+        if (!stream.has_message) {
+            // Nothing published yet.
+            return;
+        }
+        message = stream.message;
+    }
+    _parent->send_message(message);
+}
+
+template<typename Pack>
+TelemetryServer::Result TelemetryServerImpl::publish_stream(uint32_t msg_id, Pack&& pack)
+{
+    mavlink_message_t message;
+    {
+        std::lock_guard<std::mutex> lock(_streams_mutex);
+        auto& stream = stream_for(msg_id);
+        pack(stream.message);
+        stream.has_message = true;
+
+        if (stream.mode != Stream::Mode::Published) {
+            // The GCS has asked for this stream at a rate or not at all, so
+            // the latest message waits for the next interval, if any.
+            return TelemetryServer::Result::Success;
+        }
+        message = stream.message;
+    }
+
+    return _parent->send_message(message) ? TelemetryServer::Result::Success :
+                                            TelemetryServer::Result::Unsupported;
+}
+
 void TelemetryServerImpl::deinit() {}
 
 void TelemetryServerImpl::enable() {}
@@ -86,116 +132,99 @@ TelemetryServer::Result TelemetryServerImpl::publish_position(
     TelemetryServer::VelocityNed velocity_ned,
     TelemetryServer::Heading heading)
 {
-    mavlink_message_t msg;
-    mavlink_msg_global_position_int_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &msg,
-        get_boot_time_ms(),
-        static_cast<int32_t>(position.latitude_deg * 1E7),
-        static_cast<int32_t>(position.longitude_deg * 1E7),
-        static_cast<int32_t>(static_cast<double>(position.absolute_altitude_m) * 1E3),
-        static_cast<int32_t>(static_cast<double>(position.relative_altitude_m) * 1E3),
-        static_cast<int16_t>(static_cast<double>(velocity_ned.north_m_s) * 1E2),
-        static_cast<int16_t>(static_cast<double>(velocity_ned.east_m_s) * 1E2),
-        static_cast<int16_t>(static_cast<double>(velocity_ned.down_m_s) * 1E2),
-        static_cast<uint16_t>(static_cast<double>(heading.heading_deg) * 1E2));
-
-    add_msg_cache(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, msg);
-
-    return _parent->send_message(msg) ? TelemetryServer::Result::Success :
-                                        TelemetryServer::Result::Unsupported;
+    return publish_stream(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, [&](mavlink_message_t& message) {
+        mavlink_msg_global_position_int_pack(
+            _parent->get_own_system_id(),
+            _parent->get_own_component_id(),
+            &message,
+            get_boot_time_ms(),
+            static_cast<int32_t>(position.latitude_deg * 1E7),
+            static_cast<int32_t>(position.longitude_deg * 1E7),
+            static_cast<int32_t>(static_cast<double>(position.absolute_altitude_m) * 1E3),
+            static_cast<int32_t>(static_cast<double>(position.relative_altitude_m) * 1E3),
+            static_cast<int16_t>(static_cast<double>(velocity_ned.north_m_s) * 1E2),
+            static_cast<int16_t>(static_cast<double>(velocity_ned.east_m_s) * 1E2),
+            static_cast<int16_t>(static_cast<double>(velocity_ned.down_m_s) * 1E2),
+            static_cast<uint16_t>(static_cast<double>(heading.heading_deg) * 1E2));
+    });
 }
 
 TelemetryServer::Result TelemetryServerImpl::publish_home(TelemetryServer::Position home)
 {
-    mavlink_message_t msg;
     const float q[4] = {};
-    mavlink_msg_home_position_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &msg,
-        static_cast<int32_t>(home.latitude_deg * 1E7),
-        static_cast<int32_t>(home.longitude_deg * 1E7),
-        static_cast<int32_t>(static_cast<double>(home.absolute_altitude_m) * 1E-3),
-        0, // Local X
-        0, // Local Y
-        0, // Local Z
-        q, // surface normal transform
-        NAN, // approach x
-        NAN, // approach y
-        NAN, // approach z
-        get_boot_time_ms() // TO-DO: System boot
-    );
-
-    add_msg_cache(MAVLINK_MSG_ID_HOME_POSITION, msg);
-
-    return _parent->send_message(msg) ? TelemetryServer::Result::Success :
-                                        TelemetryServer::Result::Unsupported;
+    return publish_stream(MAVLINK_MSG_ID_HOME_POSITION, [&](mavlink_message_t& message) {
+        mavlink_msg_home_position_pack(
+            _parent->get_own_system_id(),
+            _parent->get_own_component_id(),
+            &message,
+            static_cast<int32_t>(home.latitude_deg * 1E7),
+            static_cast<int32_t>(home.longitude_deg * 1E7),
+            static_cast<int32_t>(static_cast<double>(home.absolute_altitude_m) * 1E-3),
+            0, // Local X
+            0, // Local Y
+            0, // Local Z
+            q, // surface normal transform
+            NAN, // approach x
+            NAN, // approach y
+            NAN, // approach z
+            get_boot_time_ms() // TO-DO: System boot
+        );
+    });
 }
 
 TelemetryServer::Result TelemetryServerImpl::publish_raw_gps(
     TelemetryServer::RawGps raw_gps, TelemetryServer::GpsInfo gps_info)
 {
-    mavlink_message_t msg;
-    mavlink_msg_gps_raw_int_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &msg,
-        raw_gps.timestamp_us,
-        static_cast<uint8_t>(gps_info.fix_type),
-        static_cast<int32_t>(raw_gps.latitude_deg * 1E7),
-        static_cast<int32_t>(raw_gps.longitude_deg * 1E7),
-        static_cast<int32_t>(static_cast<double>(raw_gps.absolute_altitude_m) * 1E3),
-        static_cast<uint16_t>(static_cast<double>(raw_gps.hdop) * 1E2),
-        static_cast<uint16_t>(static_cast<double>(raw_gps.vdop) * 1E2),
-        static_cast<uint16_t>(static_cast<double>(raw_gps.velocity_m_s) * 1E2),
-        static_cast<uint16_t>(static_cast<double>(raw_gps.cog_deg) * 1E2),
-        static_cast<uint8_t>(gps_info.num_satellites),
-        static_cast<int32_t>(static_cast<double>(raw_gps.altitude_ellipsoid_m) * 1E3),
-        static_cast<uint32_t>(static_cast<double>(raw_gps.horizontal_uncertainty_m) * 1E3),
-        static_cast<uint32_t>(static_cast<double>(raw_gps.vertical_uncertainty_m) * 1E3),
-        static_cast<uint32_t>(static_cast<double>(raw_gps.velocity_uncertainty_m_s) * 1E3),
-        static_cast<uint32_t>(static_cast<double>(raw_gps.heading_uncertainty_deg) * 1E5),
-        static_cast<uint16_t>(static_cast<double>(raw_gps.yaw_deg) * 1E2));
-
-    add_msg_cache(MAVLINK_MSG_ID_GPS_RAW_INT, msg);
-
-    return _parent->send_message(msg) ? TelemetryServer::Result::Success :
-                                        TelemetryServer::Result::Unsupported;
+    return publish_stream(MAVLINK_MSG_ID_GPS_RAW_INT, [&](mavlink_message_t& message) {
+        mavlink_msg_gps_raw_int_pack(
+            _parent->get_own_system_id(),
+            _parent->get_own_component_id(),
+            &message,
+            raw_gps.timestamp_us,
+            static_cast<uint8_t>(gps_info.fix_type),
+            static_cast<int32_t>(raw_gps.latitude_deg * 1E7),
+            static_cast<int32_t>(raw_gps.longitude_deg * 1E7),
+            static_cast<int32_t>(static_cast<double>(raw_gps.absolute_altitude_m) * 1E3),
+            static_cast<uint16_t>(static_cast<double>(raw_gps.hdop) * 1E2),
+            static_cast<uint16_t>(static_cast<double>(raw_gps.vdop) * 1E2),
+            static_cast<uint16_t>(static_cast<double>(raw_gps.velocity_m_s) * 1E2),
+            static_cast<uint16_t>(static_cast<double>(raw_gps.cog_deg) * 1E2),
+            static_cast<uint8_t>(gps_info.num_satellites),
+            static_cast<int32_t>(static_cast<double>(raw_gps.altitude_ellipsoid_m) * 1E3),
+            static_cast<uint32_t>(static_cast<double>(raw_gps.horizontal_uncertainty_m) * 1E3),
+            static_cast<uint32_t>(static_cast<double>(raw_gps.vertical_uncertainty_m) * 1E3),
+            static_cast<uint32_t>(static_cast<double>(raw_gps.velocity_uncertainty_m_s) * 1E3),
+            static_cast<uint32_t>(static_cast<double>(raw_gps.heading_uncertainty_deg) * 1E5),
+            static_cast<uint16_t>(static_cast<double>(raw_gps.yaw_deg) * 1E2));
+    });
 }
 
 TelemetryServer::Result TelemetryServerImpl::publish_battery(TelemetryServer::Battery battery)
 {
-    mavlink_message_t msg;
-
     uint16_t voltages[10] = {0};
     uint16_t voltages_ext[4] = {0};
     voltages[0] = static_cast<uint16_t>(static_cast<double>(battery.voltage_v) * 1E3);
 
-    mavlink_msg_battery_status_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &msg,
-        0,
-        MAV_BATTERY_FUNCTION_ALL,
-        MAV_BATTERY_TYPE_LIPO,
-        INT16_MAX,
-        voltages,
-        -1, // TODO publish all battery data
-        -1,
-        -1,
-        static_cast<uint16_t>(static_cast<double>(battery.remaining_percent) * 1E2),
-        0,
-        MAV_BATTERY_CHARGE_STATE_UNDEFINED,
-        voltages_ext,
-        MAV_BATTERY_MODE_UNKNOWN,
-        0);
-
-    add_msg_cache(MAVLINK_MSG_ID_BATTERY_STATUS, msg);
-
-    return _parent->send_message(msg) ? TelemetryServer::Result::Success :
-                                        TelemetryServer::Result::Unsupported;
+    return publish_stream(MAVLINK_MSG_ID_BATTERY_STATUS, [&](mavlink_message_t& message) {
+        mavlink_msg_battery_status_pack(
+            _parent->get_own_system_id(),
+            _parent->get_own_component_id(),
+            &message,
+            0,
+            MAV_BATTERY_FUNCTION_ALL,
+            MAV_BATTERY_TYPE_LIPO,
+            INT16_MAX,
+            voltages,
+            -1, // TODO publish all battery data
+            -1,
+            -1,
+            static_cast<uint16_t>(static_cast<double>(battery.remaining_percent) * 1E2),
+            0,
+            MAV_BATTERY_CHARGE_STATE_UNDEFINED,
+            voltages_ext,
+            MAV_BATTERY_MODE_UNKNOWN,
+            0);
+    });
 }
 
 TelemetryServer::Result
@@ -259,23 +288,19 @@ TelemetryServer::Result TelemetryServerImpl::publish_odometry(TelemetryServer::O
 TelemetryServer::Result TelemetryServerImpl::publish_position_velocity_ned(
     TelemetryServer::PositionVelocityNed position_velocity_ned)
 {
-    mavlink_message_t msg;
-    mavlink_msg_local_position_ned_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &msg,
-        get_boot_time_ms(),
-        position_velocity_ned.position.north_m,
-        position_velocity_ned.position.east_m,
-        position_velocity_ned.position.down_m,
-        position_velocity_ned.velocity.north_m_s,
-        position_velocity_ned.velocity.east_m_s,
-        position_velocity_ned.velocity.down_m_s);
-
-    add_msg_cache(MAVLINK_MSG_ID_LOCAL_POSITION_NED, msg);
-
-    return _parent->send_message(msg) ? TelemetryServer::Result::Success :
-                                        TelemetryServer::Result::Unsupported;
+    return publish_stream(MAVLINK_MSG_ID_LOCAL_POSITION_NED, [&](mavlink_message_t& message) {
+        mavlink_msg_local_position_ned_pack(
+            _parent->get_own_system_id(),
+            _parent->get_own_component_id(),
+            &message,
+            get_boot_time_ms(),
+            position_velocity_ned.position.north_m,
+            position_velocity_ned.position.east_m,
+            position_velocity_ned.position.down_m,
+            position_velocity_ned.velocity.north_m_s,
+            position_velocity_ned.velocity.east_m_s,
+            position_velocity_ned.velocity.down_m_s);
+    });
 }
 
 TelemetryServer::Result
@@ -344,32 +369,28 @@ TelemetryServer::Result TelemetryServerImpl::publish_sys_status(
     if (gps_status) {
         sensors |= MAV_SYS_STATUS_SENSOR_GPS;
     }
-    mavlink_message_t msg;
-    mavlink_msg_sys_status_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &msg,
-        sensors,
-        sensors,
-        sensors,
-        0,
-        static_cast<uint16_t>(static_cast<double>(battery.voltage_v) * 1E3),
-        -1,
-        static_cast<uint16_t>(static_cast<double>(battery.remaining_percent) * 1E2),
-        0,
-        0,
-        0,
-        0,
-        0,
-        0,
-        0,
-        0,
-        0);
-
-    add_msg_cache(MAVLINK_MSG_ID_SYS_STATUS, msg);
-
-    return _parent->send_message(msg) ? TelemetryServer::Result::Success :
-                                        TelemetryServer::Result::Unsupported;
+    return publish_stream(MAVLINK_MSG_ID_SYS_STATUS, [&](mavlink_message_t& message) {
+        mavlink_msg_sys_status_pack(
+            _parent->get_own_system_id(),
+            _parent->get_own_component_id(),
+            &message,
+            sensors,
+            sensors,
+            sensors,
+            0,
+            static_cast<uint16_t>(static_cast<double>(battery.voltage_v) * 1E3),
+            -1,
+            static_cast<uint16_t>(static_cast<double>(battery.remaining_percent) * 1E2),
+            0,
+            0,
+            0,
+            0,
+            0,
+            0,
+            0,
+            0,
+            0);
+    });
 }
 
 uint8_t to_mav_vtol_state(TelemetryServer::VtolState vtol_state)
@@ -409,24 +430,14 @@ uint8_t to_mav_landed_state(TelemetryServer::LandedState landed_state)
 TelemetryServer::Result TelemetryServerImpl::publish_extended_sys_state(
     TelemetryServer::VtolState vtol_state, TelemetryServer::LandedState landed_state)
 {
-    mavlink_message_t msg;
-    mavlink_msg_extended_sys_state_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &msg,
-        to_mav_vtol_state(vtol_state),
-        to_mav_landed_state(landed_state));
-
-    add_msg_cache(MAVLINK_MSG_ID_EXTENDED_SYS_STATE, msg);
-
-    return _parent->send_message(msg) ? TelemetryServer::Result::Success :
-                                        TelemetryServer::Result::Unsupported;
-}
-
-void TelemetryServerImpl::add_msg_cache(uint64_t id, mavlink_message_t& msg)
-{
-    std::unique_lock<std::mutex> lock(_interval_mutex);
-    _msg_cache.insert_or_assign(id, msg);
+    return publish_stream(MAVLINK_MSG_ID_EXTENDED_SYS_STATE, [&](mavlink_message_t& message) {
+        mavlink_msg_extended_sys_state_pack(
+            _parent->get_own_system_id(),
+            _parent->get_own_component_id(),
+            &message,
+            to_mav_vtol_state(vtol_state),
+            to_mav_landed_state(landed_state));
+    });
 }
 
 } // namespace mavsdk
@@ -5,17 +5,13 @@
 
 #include <unordered_map>
 #include <chrono>
+#include <memory>
+#include <mutex>
 
 namespace mavsdk {
 
 class TelemetryServerImpl : public PluginImplBase {
 public:
-    struct RequestMsgInterval {
-        uint32_t msg_id{0};
-        uint32_t interval{0};
-        void* cookie{nullptr};
-    };
-
     explicit TelemetryServerImpl(System& system);
     explicit TelemetryServerImpl(std::shared_ptr<System> system);
     ~TelemetryServerImpl() override;
@@ -79,11 +75,25 @@ public:
 private:
     std::chrono::time_point<std::chrono::steady_clock> _start_time;
 
-    std::vector<RequestMsgInterval> _interval_requests;
-    std::mutex _interval_mutex;
-    std::unordered_map<uint64_t, mavlink_message_t> _msg_cache;
+    // Latest message published for one message ID.
+    struct Stream {
+        enum class Mode {
+            Published, // Sent whenever it is published.
+            Interval, // Sent at the interval the GCS set.
+            Disabled, // Not sent, the GCS turned it off.
+        } mode{Mode::Published};
+        mavlink_message_t message{};
+        bool has_message{false};
+        void* cookie{nullptr};
+    };
+
+    void set_message_interval(uint32_t msg_id, float interval_us);
+    Stream& stream_for(uint32_t msg_id);
+    void send_stream(const Stream& stream);
+    template<typename Pack> TelemetryServer::Result publish_stream(uint32_t msg_id, Pack&& pack);
 
-    void add_msg_cache(uint64_t id, mavlink_message_t& msg);
+    std::mutex _streams_mutex{};
+    std::unordered_map<uint32_t, std::unique_ptr<Stream>> _streams{};
 
     uint64_t get_boot_time_ms()
     {
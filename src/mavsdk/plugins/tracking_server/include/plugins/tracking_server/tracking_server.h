@@ -243,6 +243,18 @@ public:
      */
     Result respond_tracking_off_command(CommandAnswer command_answer) const;
 
+    /**
+     * @brief Set the rate at which the tracking status is sent.
+     *
+     * By default, or with a rate of 0, each status is sent when it is set.
+     * With a rate set, setting the status only stores it, without blocking,
+     * and the latest one is sent at that rate if it changed, or once a
+     * second if it didn't.
+     *
+     * This function is non-blocking.
+     */
+    void set_tracking_status_rate(double rate_hz) const;
+
     /**
      * @brief Copy constructor.
      */
@@ -150,4 +150,9 @@ std::ostream& operator<<(std::ostream& str, TrackingServer::CommandAnswer const&
     }
 }
 
+void TrackingServer::set_tracking_status_rate(double rate_hz) const
+{
+    _impl->set_tracking_status_rate(rate_hz);
+}
+
 } // namespace mavsdk
\ No newline at end of file
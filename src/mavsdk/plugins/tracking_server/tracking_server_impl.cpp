@@ -48,6 +48,13 @@ void TrackingServerImpl::deinit()
     _parent->unregister_mavlink_command_handler(MAV_CMD_CAMERA_TRACK_POINT, this);
     _parent->unregister_mavlink_command_handler(MAV_CMD_CAMERA_TRACK_RECTANGLE, this);
     _parent->unregister_mavlink_command_handler(MAV_CMD_CAMERA_STOP_TRACKING, this);
+
+    std::lock_guard<std::mutex> lock(_status_mutex);
+    if (_status_cookie != nullptr) {
+        _parent->remove_call_every(_status_cookie);
+        _status_cookie = nullptr;
+    }
+    _status_throttled = false;
 }
 
 void TrackingServerImpl::enable() {}
@@ -56,11 +63,7 @@ void TrackingServerImpl::disable() {}
 
 void TrackingServerImpl::set_tracking_point_status(TrackingServer::TrackPoint tracked_point)
 {
-    mavlink_message_t message;
-    mavlink_msg_camera_tracking_image_status_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &message,
+    publish_status(TrackingStatus{
         CAMERA_TRACKING_STATUS_FLAGS_ACTIVE,
         CAMERA_TRACKING_MODE_POINT,
         CAMERA_TRACKING_TARGET_DATA_IN_STATUS,
@@ -70,18 +73,13 @@ void TrackingServerImpl::set_tracking_point_status(TrackingServer::TrackPoint tr
         0.0f,
         0.0f,
         0.0f,
-        0.0f);
-    _parent->send_message(message);
+        0.0f});
 }
 
 void TrackingServerImpl::set_tracking_rectangle_status(
     TrackingServer::TrackRectangle tracked_rectangle)
 {
-    mavlink_message_t message;
-    mavlink_msg_camera_tracking_image_status_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &message,
+    publish_status(TrackingStatus{
         CAMERA_TRACKING_STATUS_FLAGS_ACTIVE,
         CAMERA_TRACKING_MODE_RECTANGLE,
         CAMERA_TRACKING_TARGET_DATA_IN_STATUS,
@@ -91,17 +89,12 @@ void TrackingServerImpl::set_tracking_rectangle_status(
         tracked_rectangle.top_left_corner_x,
         tracked_rectangle.top_left_corner_y,
         tracked_rectangle.bottom_right_corner_x,
-        tracked_rectangle.bottom_right_corner_y);
-    _parent->send_message(message);
+        tracked_rectangle.bottom_right_corner_y});
 }
 
 void TrackingServerImpl::set_tracking_off_status()
 {
-    mavlink_message_t message;
-    mavlink_msg_camera_tracking_image_status_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &message,
+    publish_status(TrackingStatus{
         CAMERA_TRACKING_STATUS_FLAGS_IDLE,
         CAMERA_TRACKING_MODE_NONE,
         CAMERA_TRACKING_TARGET_DATA_NONE,
@@ -111,8 +104,91 @@ void TrackingServerImpl::set_tracking_off_status()
         0.0f,
         0.0f,
         0.0f,
-        0.0f);
-    _parent->send_message(message);
+        0.0f});
+}
+
+void TrackingServerImpl::set_tracking_status_rate(double rate_hz)
+{
+    std::lock_guard<std::mutex> lock(_status_mutex);
+
+    if (rate_hz <= 0.0) {
+        if (_status_cookie != nullptr) {
+            _parent->remove_call_every(_status_cookie);
+            _status_cookie = nullptr;
+        }
+        _status_throttled = false;
+        return;
+    }
+
+    if (_status_cookie != nullptr) {
+        _parent->change_call_every(static_cast<float>(1.0 / rate_hz), _status_cookie);
+    } else {
+        // Only what is set from now on, not what was sent before.
+        std::atomic_store(&_latest_status, std::shared_ptr<const TrackingStatus>{});
+        _last_sent_status.reset();
+        _parent->add_call_every(
+            [this]() { send_latest_status(); }, static_cast<float>(1.0 / rate_hz), &_status_cookie);
+    }
+    _status_throttled = true;
+}
+
+void TrackingServerImpl::publish_status(const TrackingStatus& status)
+{
+    if (_status_throttled) {
+        std::atomic_store(&_latest_status, std::make_shared<const TrackingStatus>(status));
+        return;
+    }
+
+    send_status(status);
+}
+
+void TrackingServerImpl::send_latest_status()
+{
+    const auto latest = std::atomic_load(&_latest_status);
+    if (!latest) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_status_mutex);
+
+    if (_last_sent_status && *_last_sent_status == *latest &&
+        _parent->get_time().elapsed_since_s(_last_sent_status_time) < STATUS_KEEP_ALIVE_S) {
+        return;
+    }
+
+    if (send_status(*latest)) {
+        _last_sent_status = latest;
+        _last_sent_status_time = _parent->get_time().steady_time();
+    }
+}
+
+bool TrackingServerImpl::send_status(const TrackingStatus& status)
+{
+    mavlink_message_t message;
+    mavlink_msg_camera_tracking_image_status_pack(
+        _parent->get_own_system_id(),
+        _parent->get_own_component_id(),
+        &message,
+        status.status_flags,
+        status.mode,
+        status.target_data,
+        status.point_x,
+        status.point_y,
+        status.radius,
+        status.rec_top_x,
+        status.rec_top_y,
+        status.rec_bottom_x,
+        status.rec_bottom_y);
+    return _parent->send_message(message);
+}
+
+bool TrackingServerImpl::TrackingStatus::operator==(const TrackingStatus& other) const
+{
+    return status_flags == other.status_flags && mode == other.mode &&
+           target_data == other.target_data && point_x == other.point_x &&
+           point_y == other.point_y && radius == other.radius && rec_top_x == other.rec_top_x &&
+           rec_top_y == other.rec_top_y && rec_bottom_x == other.rec_bottom_x &&
+           rec_bottom_y == other.rec_bottom_y;
 }
 
 void TrackingServerImpl::subscribe_tracking_point_command(
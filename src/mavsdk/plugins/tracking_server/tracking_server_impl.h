@@ -2,6 +2,9 @@
 
 #include "plugins/tracking_server/tracking_server.h"
 #include "plugin_impl_base.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <optional>
 
 namespace mavsdk {
@@ -24,6 +27,8 @@ public:
 
     void set_tracking_off_status();
 
+    void set_tracking_status_rate(double rate_hz);
+
     void subscribe_tracking_point_command(TrackingServer::TrackingPointCommandCallback callback);
 
     void
@@ -51,6 +56,40 @@ private:
     bool is_command_sender_ok(const MavlinkCommandReceiver::CommandLong& command);
     MAV_RESULT mav_result_from_command_answer(TrackingServer::CommandAnswer command_answer);
 
+    // Content of CAMERA_TRACKING_IMAGE_STATUS.
+    struct TrackingStatus {
+        uint8_t status_flags;
+        uint8_t mode;
+        uint8_t target_data;
+        float point_x;
+        float point_y;
+        float radius;
+        float rec_top_x;
+        float rec_top_y;
+        float rec_bottom_x;
+        float rec_bottom_y;
+
+        bool operator==(const TrackingStatus& other) const;
+    };
+
+    void publish_status(const TrackingStatus& status);
+    void send_latest_status();
+    bool send_status(const TrackingStatus& status);
+
+    // With a rate set, the latest status is handed to the sender with
+    // std::atomic_load/store, so whoever sets it never waits for the link.
+    std::shared_ptr<const TrackingStatus> _latest_status{};
+    std::atomic<bool> _status_throttled{false};
+
+    std::mutex _status_mutex{};
+    void* _status_cookie{nullptr};
+    std::shared_ptr<const TrackingStatus> _last_sent_status{};
+    dl_time_t _last_sent_status_time{};
+
+    // An unchanged status is still repeated now and then, for anyone who
+    // missed it.
+    static constexpr double STATUS_KEEP_ALIVE_S = 1.0;
+
     std::mutex _mutex{};
     TrackingServer::TrackingPointCommandCallback _tracking_point_callback{nullptr};
     TrackingServer::TrackingRectangleCommandCallback _tracking_rectangle_callback{nullptr};
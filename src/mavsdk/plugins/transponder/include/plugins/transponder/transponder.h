@@ -145,6 +145,14 @@ public:
      */
     friend std::ostream& operator<<(std::ostream& str, Transponder::Result const& result);
 
+    /**
+     * @brief Changes of the traffic table since the last update.
+     */
+    struct TrafficUpdate {
+        std::vector<AdsbVehicle> updated{}; /**< @brief Contacts which are new or changed */
+        std::vector<uint32_t> removed{}; /**< @brief ICAO addresses of contacts which expired */
+    };
+
     /**
      * @brief Callback type for asynchronous Transponder calls.
      */
@@ -184,6 +192,64 @@ public:
      */
     Result set_rate_transponder(double rate_hz) const;
 
+    /**
+     * @brief Callback type for subscribe_traffic.
+     */
+    using TrafficCallback = std::function<void(TrafficUpdate)>;
+
+    /**
+     * @brief Subscribe to changes of the traffic table.
+     *
+     * The traffic table keeps the latest ADS-B report of every contact, by ICAO address, and
+     * drops contacts which have not been heard of for a while. Rather than every report, the
+     * callback gets what changed, batched a few times per second. The first update after
+     * subscribing contains all contacts known.
+     *
+     * @param callback Callback to be called with the changes, `nullptr` to unsubscribe.
+     */
+    void subscribe_traffic(TrafficCallback callback);
+
+    /**
+     * @brief All contacts in the traffic table.
+     *
+     * @return The latest report of every contact.
+     */
+    std::vector<AdsbVehicle> traffic() const;
+
+    /**
+     * @brief Contacts within a horizontal distance of a position.
+     *
+     * @param latitude_deg Latitude of the position in degrees.
+     * @param longitude_deg Longitude of the position in degrees.
+     * @param radius_m Horizontal distance in metres.
+     *
+     * @return The contacts within the distance.
+     */
+    std::vector<AdsbVehicle>
+    traffic_within(double latitude_deg, double longitude_deg, double radius_m) const;
+
+    /**
+     * @brief Contacts which come within a horizontal distance of a moving position soon.
+     *
+     * Both the position and the contacts are assumed to keep their horizontal velocity.
+     *
+     * @param latitude_deg Latitude of the position in degrees.
+     * @param longitude_deg Longitude of the position in degrees.
+     * @param north_m_s Velocity of the position towards north in metres/second.
+     * @param east_m_s Velocity of the position towards east in metres/second.
+     * @param horizon_s How far to look ahead in seconds.
+     * @param radius_m Horizontal distance in metres.
+     *
+     * @return The contacts which come within the distance in the time looked ahead.
+     */
+    std::vector<AdsbVehicle> traffic_closing_within(
+        double latitude_deg,
+        double longitude_deg,
+        double north_m_s,
+        double east_m_s,
+        double horizon_s,
+        double radius_m) const;
+
     /**
      * @brief Copy constructor.
      */
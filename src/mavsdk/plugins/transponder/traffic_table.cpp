@@ -0,0 +1,248 @@
+#include "traffic_table.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mavsdk {
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+constexpr double world_radius_m = 6371000.0;
+constexpr double metres_per_degree = world_radius_m * pi / 180.0;
+constexpr double cell_size_deg = TrafficTable::CELL_SIZE_M / metres_per_degree;
+
+const int64_t num_latitude_cells = static_cast<int64_t>(std::ceil(180.0 / cell_size_deg));
+const int64_t num_longitude_cells = static_cast<int64_t>(std::ceil(360.0 / cell_size_deg));
+
+int64_t latitude_index(double latitude_deg)
+{
+    const auto index = static_cast<int64_t>(std::floor((latitude_deg + 90.0) / cell_size_deg));
+    return std::clamp<int64_t>(index, 0, num_latitude_cells - 1);
+}
+
+int64_t longitude_index(double longitude_deg)
+{
+    const auto index = static_cast<int64_t>(std::floor((longitude_deg + 180.0) / cell_size_deg));
+    return ((index % num_longitude_cells) + num_longitude_cells) % num_longitude_cells;
+}
+
+uint64_t cell_key(int64_t latitude_index, int64_t longitude_index)
+{
+    return (static_cast<uint64_t>(latitude_index) << 32) | static_cast<uint64_t>(longitude_index);
+}
+
+double wrap_longitude_deg(double longitude_deg)
+{
+    while (longitude_deg > 180.0) {
+        longitude_deg -= 360.0;
+    }
+    while (longitude_deg < -180.0) {
+        longitude_deg += 360.0;
+    }
+    return longitude_deg;
+}
+
+double to_rad(double deg)
+{
+    return deg * pi / 180.0;
+}
+
+} // namespace
+
+template<typename F>
+void TrafficTable::for_each_near(
+    double latitude_deg, double longitude_deg, double radius_m, F&& func) const
+{
+    const double radius_deg = radius_m / metres_per_degree;
+
+    const int64_t first_latitude = latitude_index(latitude_deg - radius_deg);
+    const int64_t last_latitude = latitude_index(latitude_deg + radius_deg);
+
+    // Longitude cells get narrower towards the poles, so it takes more of them
+    // to cover the radius at the latitude closest to a pole.
+    const double widest_latitude_deg = std::min(std::abs(latitude_deg) + radius_deg, 89.0);
+    const double longitude_radius_deg = radius_deg / std::cos(to_rad(widest_latitude_deg));
+    const auto longitude_span =
+        static_cast<int64_t>(std::ceil(longitude_radius_deg / cell_size_deg));
+
+    const int64_t center_longitude = longitude_index(longitude_deg);
+    const bool all_longitudes = 2 * longitude_span + 1 >= num_longitude_cells;
+    const int64_t first_offset = all_longitudes ? 0 : -longitude_span;
+    const int64_t last_offset = all_longitudes ? num_longitude_cells - 1 : longitude_span;
+
+    // With few contacts, going through all of them is cheaper than the cells.
+    const auto num_cells = static_cast<std::size_t>(
+        (last_latitude - first_latitude + 1) * (last_offset - first_offset + 1));
+    if (num_cells >= _cells.size()) {
+        for (const auto& [cell, addresses] : _cells) {
+            const auto cell_latitude = static_cast<int64_t>(cell >> 32);
+            if (cell_latitude < first_latitude || cell_latitude > last_latitude) {
+                continue;
+            }
+            for (const auto icao_address : addresses) {
+                func(_contacts.at(icao_address));
+            }
+        }
+        return;
+    }
+
+    for (int64_t latitude = first_latitude; latitude <= last_latitude; ++latitude) {
+        for (int64_t offset = first_offset; offset <= last_offset; ++offset) {
+            const int64_t longitude = all_longitudes ?
+                                          offset :
+                                          ((center_longitude + offset) % num_longitude_cells +
+                                           num_longitude_cells) %
+                                              num_longitude_cells;
+            const auto found = _cells.find(cell_key(latitude, longitude));
+            if (found == _cells.end()) {
+                continue;
+            }
+            for (const auto icao_address : found->second) {
+                func(_contacts.at(icao_address));
+            }
+        }
+    }
+}
+
+bool TrafficTable::update(const Transponder::AdsbVehicle& vehicle, double now_s)
+{
+    const uint64_t cell = cell_of(vehicle.latitude_deg, vehicle.longitude_deg);
+
+    auto found = _contacts.find(vehicle.icao_address);
+    if (found == _contacts.end()) {
+        _contacts.emplace(vehicle.icao_address, Contact{vehicle, now_s, cell});
+        add_to_cell(cell, vehicle.icao_address);
+        return true;
+    }
+
+    auto& contact = found->second;
+    contact.last_seen_s = now_s;
+    if (contact.vehicle == vehicle) {
+        return false;
+    }
+
+    contact.vehicle = vehicle;
+    if (contact.cell != cell) {
+        remove_from_cell(contact.cell, vehicle.icao_address);
+        add_to_cell(cell, vehicle.icao_address);
+        contact.cell = cell;
+    }
+    return true;
+}
+
+std::vector<uint32_t> TrafficTable::expire(double now_s, double max_age_s)
+{
+    std::vector<uint32_t> expired;
+    for (auto it = _contacts.begin(); it != _contacts.end();
+         /* no ++it */) {
+        if (now_s - it->second.last_seen_s > max_age_s) {
+            expired.push_back(it->first);
+            remove_from_cell(it->second.cell, it->first);
+            it = _contacts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return expired;
+}
+
+std::vector<Transponder::AdsbVehicle> TrafficTable::all() const
+{
+    std::vector<Transponder::AdsbVehicle> vehicles;
+    vehicles.reserve(_contacts.size());
+    for (const auto& [icao_address, contact] : _contacts) {
+        vehicles.push_back(contact.vehicle);
+    }
+    return vehicles;
+}
+
+std::vector<Transponder::AdsbVehicle>
+TrafficTable::within(double latitude_deg, double longitude_deg, double radius_m) const
+{
+    std::vector<Transponder::AdsbVehicle> vehicles;
+    for_each_near(latitude_deg, longitude_deg, radius_m, [&](const Contact& contact) {
+        const auto offset = offset_of(contact.vehicle, latitude_deg, longitude_deg);
+        if (std::hypot(offset.north_m, offset.east_m) <= radius_m) {
+            vehicles.push_back(contact.vehicle);
+        }
+    });
+    return vehicles;
+}
+
+std::vector<Transponder::AdsbVehicle> TrafficTable::closing_within(
+    double latitude_deg,
+    double longitude_deg,
+    double north_m_s,
+    double east_m_s,
+    double horizon_s,
+    double radius_m) const
+{
+    const double own_speed_m_s = std::hypot(north_m_s, east_m_s);
+    const double search_radius_m = radius_m + (MAX_CONTACT_SPEED_M_S + own_speed_m_s) * horizon_s;
+
+    std::vector<Transponder::AdsbVehicle> vehicles;
+    for_each_near(latitude_deg, longitude_deg, search_radius_m, [&](const Contact& contact) {
+        const auto offset = offset_of(contact.vehicle, latitude_deg, longitude_deg);
+
+        const double heading_rad = to_rad(contact.vehicle.heading_deg);
+        const double speed_m_s = std::isfinite(contact.vehicle.horizontal_velocity_m_s) ?
+                                     contact.vehicle.horizontal_velocity_m_s :
+                                     0.0;
+        const double relative_north_m_s = speed_m_s * std::cos(heading_rad) - north_m_s;
+        const double relative_east_m_s = speed_m_s * std::sin(heading_rad) - east_m_s;
+
+        // Time of the closest approach, within what we look ahead.
+        const double relative_speed_squared = relative_north_m_s * relative_north_m_s +
+                                              relative_east_m_s * relative_east_m_s;
+        double closest_s = 0.0;
+        if (relative_speed_squared > 0.0) {
+            closest_s = -(offset.north_m * relative_north_m_s + offset.east_m * relative_east_m_s) /
+                        relative_speed_squared;
+            closest_s = std::clamp(closest_s, 0.0, horizon_s);
+        }
+
+        const double closest_m = std::hypot(
+            offset.north_m + relative_north_m_s * closest_s,
+            offset.east_m + relative_east_m_s * closest_s);
+        if (closest_m <= radius_m) {
+            vehicles.push_back(contact.vehicle);
+        }
+    });
+    return vehicles;
+}
+
+uint64_t TrafficTable::cell_of(double latitude_deg, double longitude_deg)
+{
+    return cell_key(latitude_index(latitude_deg), longitude_index(longitude_deg));
+}
+
+TrafficTable::Offset TrafficTable::offset_of(
+    const Transponder::AdsbVehicle& vehicle, double latitude_deg, double longitude_deg)
+{
+    const double north_m = (vehicle.latitude_deg - latitude_deg) * metres_per_degree;
+    const double east_m = wrap_longitude_deg(vehicle.longitude_deg - longitude_deg) *
+                          metres_per_degree * std::cos(to_rad(latitude_deg));
+    return {north_m, east_m};
+}
+
+void TrafficTable::add_to_cell(uint64_t cell, uint32_t icao_address)
+{
+    _cells[cell].push_back(icao_address);
+}
+
+void TrafficTable::remove_from_cell(uint64_t cell, uint32_t icao_address)
+{
+    auto found = _cells.find(cell);
+    if (found == _cells.end()) {
+        return;
+    }
+
+    auto& addresses = found->second;
+    addresses.erase(std::remove(addresses.begin(), addresses.end(), icao_address), addresses.end());
+    if (addresses.empty()) {
+        _cells.erase(found);
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "plugins/transponder/transponder.h"
+
+namespace mavsdk {
+
+// ADS-B contacts by ICAO address, with a grid over latitude and longitude to
+// find the ones close to a position without going through all of them.
+//
+// Distances are computed in a flat projection around the position asked
+// about, which is plenty accurate over the few tens of kilometres traffic is
+// of interest. Altitude is not taken into account.
+//
+// Not thread-safe, the owner needs to lock around it.
+class TrafficTable {
+public:
+    TrafficTable() = default;
+    ~TrafficTable() = default;
+
+    // Non-copyable
+    TrafficTable(const TrafficTable&) = delete;
+    const TrafficTable& operator=(const TrafficTable&) = delete;
+
+    // Returns false if the contact was known exactly like this already.
+    bool update(const Transponder::AdsbVehicle& vehicle, double now_s);
+
+    // Removes the contacts not heard of for longer than max_age_s, and
+    // returns their ICAO addresses.
+    std::vector<uint32_t> expire(double now_s, double max_age_s);
+
+    [[nodiscard]] std::size_t size() const { return _contacts.size(); }
+
+    [[nodiscard]] std::vector<Transponder::AdsbVehicle> all() const;
+
+    [[nodiscard]] std::vector<Transponder::AdsbVehicle>
+    within(double latitude_deg, double longitude_deg, double radius_m) const;
+
+    // Contacts which come within radius_m of the position in the next
+    // horizon_s, assuming both keep their horizontal velocity.
+    [[nodiscard]] std::vector<Transponder::AdsbVehicle> closing_within(
+        double latitude_deg,
+        double longitude_deg,
+        double north_m_s,
+        double east_m_s,
+        double horizon_s,
+        double radius_m) const;
+
+    static constexpr double CELL_SIZE_M = 5000.0;
+    // Fast airliners, to know how far out to look for contacts which could close in.
+    static constexpr double MAX_CONTACT_SPEED_M_S = 350.0;
+
+private:
+    struct Contact {
+        Transponder::AdsbVehicle vehicle{};
+        double last_seen_s{0.0};
+        uint64_t cell{0};
+    };
+
+    struct Offset {
+        double north_m;
+        double east_m;
+    };
+
+    static uint64_t cell_of(double latitude_deg, double longitude_deg);
+    static Offset offset_of(
+        const Transponder::AdsbVehicle& vehicle, double latitude_deg, double longitude_deg);
+
+    void add_to_cell(uint64_t cell, uint32_t icao_address);
+    void remove_from_cell(uint64_t cell, uint32_t icao_address);
+
+    template<typename F>
+    void for_each_near(double latitude_deg, double longitude_deg, double radius_m, F&& func) const;
+
+    std::unordered_map<uint32_t, Contact> _contacts{};
+    std::unordered_map<uint64_t, std::vector<uint32_t>> _cells{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include "traffic_table.h"
+
+using namespace mavsdk;
+
+namespace {
+
+// Zurich airport, more or less.
+constexpr double latitude_deg = 47.46;
+constexpr double longitude_deg = 8.55;
+constexpr double metres_per_degree = 6371000.0 * 3.14159265358979323846 / 180.0;
+
+Transponder::AdsbVehicle make_contact(
+    uint32_t icao_address,
+    double north_m,
+    double east_m,
+    float heading_deg = 0.0f,
+    float speed_m_s = 0.0f)
+{
+    Transponder::AdsbVehicle vehicle;
+    vehicle.icao_address = icao_address;
+    vehicle.latitude_deg = latitude_deg + north_m / metres_per_degree;
+    vehicle.longitude_deg =
+        longitude_deg +
+        east_m / (metres_per_degree * std::cos(latitude_deg * 3.14159265358979323846 / 180.0));
+    vehicle.heading_deg = heading_deg;
+    vehicle.horizontal_velocity_m_s = speed_m_s;
+    return vehicle;
+}
+
+std::vector<uint32_t> addresses(const std::vector<Transponder::AdsbVehicle>& vehicles)
+{
+    std::vector<uint32_t> result;
+    for (const auto& vehicle : vehicles) {
+        result.push_back(vehicle.icao_address);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+} // namespace
+
+TEST(TrafficTable, KeepsOneContactPerAddress)
+{
+    TrafficTable table;
+
+    EXPECT_TRUE(table.update(make_contact(1, 0.0, 0.0), 0.0));
+    EXPECT_TRUE(table.update(make_contact(2, 100.0, 0.0), 0.0));
+    EXPECT_FALSE(table.update(make_contact(1, 0.0, 0.0), 0.5));
+    EXPECT_TRUE(table.update(make_contact(1, 10000.0, 0.0), 1.0));
+
+    EXPECT_EQ(table.size(), 2u);
+    EXPECT_EQ(addresses(table.all()), (std::vector<uint32_t>{1, 2}));
+}
+
+TEST(TrafficTable, FindsContactsWithinRadius)
+{
+    TrafficTable table;
+
+    table.update(make_contact(1, 500.0, 0.0), 0.0);
+    table.update(make_contact(2, 0.0, -3000.0), 0.0);
+    table.update(make_contact(3, 20000.0, 20000.0), 0.0);
+
+    // Enough other traffic that the grid is used rather than a full scan.
+    for (uint32_t i = 0; i < 200; ++i) {
+        table.update(make_contact(100 + i, 100000.0 + i * 1000.0, 50000.0), 0.0);
+    }
+
+    EXPECT_EQ(
+        addresses(table.within(latitude_deg, longitude_deg, 1000.0)), (std::vector<uint32_t>{1}));
+    EXPECT_EQ(
+        addresses(table.within(latitude_deg, longitude_deg, 5000.0)),
+        (std::vector<uint32_t>{1, 2}));
+    EXPECT_EQ(
+        addresses(table.within(latitude_deg, longitude_deg, 30000.0)),
+        (std::vector<uint32_t>{1, 2, 3}));
+
+    // Moving out of range is picked up.
+    table.update(make_contact(1, 50000.0, 0.0), 1.0);
+    EXPECT_TRUE(table.within(latitude_deg, longitude_deg, 1000.0).empty());
+}
+
+TEST(TrafficTable, FindsContactsClosingIn)
+{
+    TrafficTable table;
+
+    // 10 km north, heading south at 100 m/s, so 100 s away.
+    table.update(make_contact(1, 10000.0, 0.0, 180.0f, 100.0f), 0.0);
+    // 10 km north, heading north, moving away.
+    table.update(make_contact(2, 10000.0, 0.0, 0.0f, 100.0f), 0.0);
+    // Passing 5 km to the east.
+    table.update(make_contact(3, 10000.0, 5000.0, 180.0f, 100.0f), 0.0);
+
+    EXPECT_EQ(
+        addresses(table.closing_within(latitude_deg, longitude_deg, 0.0, 0.0, 120.0, 500.0)),
+        (std::vector<uint32_t>{1}));
+    EXPECT_TRUE(
+        table.closing_within(latitude_deg, longitude_deg, 0.0, 0.0, 60.0, 500.0).empty());
+
+    // Flying towards the one passing east makes it close in as well.
+    EXPECT_EQ(
+        addresses(table.closing_within(latitude_deg, longitude_deg, 0.0, 50.0, 120.0, 500.0)),
+        (std::vector<uint32_t>{3}));
+}
+
+TEST(TrafficTable, ExpiresContacts)
+{
+    TrafficTable table;
+
+    table.update(make_contact(1, 0.0, 0.0), 0.0);
+    table.update(make_contact(2, 0.0, 0.0), 5.0);
+
+    EXPECT_EQ(table.expire(12.0, 10.0), (std::vector<uint32_t>{1}));
+    EXPECT_EQ(
+        addresses(table.within(latitude_deg, longitude_deg, 100.0)), (std::vector<uint32_t>{2}));
+    EXPECT_TRUE(table.expire(12.0, 10.0).empty());
+}
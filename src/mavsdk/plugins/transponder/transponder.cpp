@@ -150,4 +150,32 @@ std::ostream& operator<<(std::ostream& str, Transponder::AdsbEmitterType const&
     }
 }
 
+void Transponder::subscribe_traffic(TrafficCallback callback)
+{
+    _impl->subscribe_traffic(callback);
+}
+
+std::vector<Transponder::AdsbVehicle> Transponder::traffic() const
+{
+    return _impl->traffic();
+}
+
+std::vector<Transponder::AdsbVehicle>
+Transponder::traffic_within(double latitude_deg, double longitude_deg, double radius_m) const
+{
+    return _impl->traffic_within(latitude_deg, longitude_deg, radius_m);
+}
+
+std::vector<Transponder::AdsbVehicle> Transponder::traffic_closing_within(
+    double latitude_deg,
+    double longitude_deg,
+    double north_m_s,
+    double east_m_s,
+    double horizon_s,
+    double radius_m) const
+{
+    return _impl->traffic_closing_within(
+        latitude_deg, longitude_deg, north_m_s, east_m_s, horizon_s, radius_m);
+}
+
 } // namespace mavsdk
\ No newline at end of file
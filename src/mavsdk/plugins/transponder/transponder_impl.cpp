@@ -23,10 +23,15 @@ void TransponderImpl::init()
         MAVLINK_MSG_ID_ADSB_VEHICLE,
         [this](const mavlink_message_t& message) { process_transponder(message); },
         this);
+
+    _parent->add_call_every(
+        [this]() { process_traffic_tick(); }, TRAFFIC_UPDATE_INTERVAL_S, &_traffic_cookie);
 }
 
 void TransponderImpl::deinit()
 {
+    _parent->remove_call_every(_traffic_cookie);
+    _traffic_cookie = nullptr;
     _parent->unregister_all_mavlink_message_handlers(this);
 }
 
@@ -87,6 +92,7 @@ void TransponderImpl::process_transponder(const mavlink_message_t& message)
     adsbVehicle.squawk = local_adsb_vehicle.squawk;
 
     set_transponder(adsbVehicle);
+    update_traffic(adsbVehicle);
 
     std::lock_guard<std::mutex> lock(_subscription_mutex);
     if (_transponder_subscription) {
@@ -96,6 +102,93 @@ void TransponderImpl::process_transponder(const mavlink_message_t& message)
     }
 }
 
+void TransponderImpl::subscribe_traffic(Transponder::TrafficCallback callback)
+{
+    std::lock_guard<std::mutex> lock(_traffic_mutex);
+    _traffic_subscription = std::move(callback);
+
+    // Start off with everything known.
+    _traffic_removed.clear();
+    _traffic_updated.clear();
+    for (const auto& vehicle : _traffic.all()) {
+        _traffic_updated[vehicle.icao_address] = vehicle;
+    }
+}
+
+std::vector<Transponder::AdsbVehicle> TransponderImpl::traffic() const
+{
+    std::lock_guard<std::mutex> lock(_traffic_mutex);
+    return _traffic.all();
+}
+
+std::vector<Transponder::AdsbVehicle>
+TransponderImpl::traffic_within(double latitude_deg, double longitude_deg, double radius_m) const
+{
+    std::lock_guard<std::mutex> lock(_traffic_mutex);
+    return _traffic.within(latitude_deg, longitude_deg, radius_m);
+}
+
+std::vector<Transponder::AdsbVehicle> TransponderImpl::traffic_closing_within(
+    double latitude_deg,
+    double longitude_deg,
+    double north_m_s,
+    double east_m_s,
+    double horizon_s,
+    double radius_m) const
+{
+    std::lock_guard<std::mutex> lock(_traffic_mutex);
+    return _traffic.closing_within(
+        latitude_deg, longitude_deg, north_m_s, east_m_s, horizon_s, radius_m);
+}
+
+void TransponderImpl::update_traffic(const Transponder::AdsbVehicle& vehicle)
+{
+    const double now = now_s();
+
+    std::lock_guard<std::mutex> lock(_traffic_mutex);
+    if (!_traffic.update(vehicle, now) || _traffic_subscription == nullptr) {
+        return;
+    }
+    _traffic_removed.erase(vehicle.icao_address);
+    _traffic_updated[vehicle.icao_address] = vehicle;
+}
+
+void TransponderImpl::process_traffic_tick()
+{
+    const double now = now_s();
+
+    std::lock_guard<std::mutex> lock(_traffic_mutex);
+    for (const auto icao_address : _traffic.expire(now, TRAFFIC_MAX_AGE_S)) {
+        if (_traffic_subscription != nullptr) {
+            _traffic_updated.erase(icao_address);
+            _traffic_removed.insert(icao_address);
+        }
+    }
+
+    if (_traffic_subscription == nullptr ||
+        (_traffic_updated.empty() && _traffic_removed.empty())) {
+        return;
+    }
+
+    Transponder::TrafficUpdate update;
+    update.updated.reserve(_traffic_updated.size());
+    for (const auto& [icao_address, vehicle] : _traffic_updated) {
+        update.updated.push_back(vehicle);
+    }
+    update.removed.assign(_traffic_removed.begin(), _traffic_removed.end());
+    _traffic_updated.clear();
+    _traffic_removed.clear();
+
+    _parent->call_user_callback(
+        [callback = _traffic_subscription, update = std::move(update)]() { callback(update); });
+}
+
+double TransponderImpl::now_s()
+{
+    return std::chrono::duration<double>(_parent->get_time().steady_time().time_since_epoch())
+        .count();
+}
+
 Transponder::Result
 TransponderImpl::transponder_result_from_command_result(MavlinkCommandSender::Result command_result)
 {
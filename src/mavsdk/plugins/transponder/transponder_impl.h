@@ -1,7 +1,13 @@
 #pragma once
 
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "plugins/transponder/transponder.h"
 #include "plugin_impl_base.h"
+#include "traffic_table.h"
 
 namespace mavsdk {
 
@@ -25,8 +31,23 @@ public:
 
     void subscribe_transponder(Transponder::TransponderCallback callback);
 
+    void subscribe_traffic(Transponder::TrafficCallback callback);
+    std::vector<Transponder::AdsbVehicle> traffic() const;
+    std::vector<Transponder::AdsbVehicle>
+    traffic_within(double latitude_deg, double longitude_deg, double radius_m) const;
+    std::vector<Transponder::AdsbVehicle> traffic_closing_within(
+        double latitude_deg,
+        double longitude_deg,
+        double north_m_s,
+        double east_m_s,
+        double horizon_s,
+        double radius_m) const;
+
 private:
     void set_transponder(Transponder::AdsbVehicle transponder);
+    void update_traffic(const Transponder::AdsbVehicle& vehicle);
+    void process_traffic_tick();
+    double now_s();
 
     void process_transponder(const mavlink_message_t& message);
 
@@ -41,6 +62,18 @@ private:
 
     std::mutex _subscription_mutex{};
     Transponder::TransponderCallback _transponder_subscription{nullptr};
+
+    // Reports are batched into traffic updates this often.
+    static constexpr float TRAFFIC_UPDATE_INTERVAL_S = 0.2f;
+    static constexpr double TRAFFIC_MAX_AGE_S = 10.0;
+
+    mutable std::mutex _traffic_mutex{};
+    TrafficTable _traffic{};
+    // Changes since the last traffic update.
+    std::unordered_map<uint32_t, Transponder::AdsbVehicle> _traffic_updated{};
+    std::unordered_set<uint32_t> _traffic_removed{};
+    Transponder::TrafficCallback _traffic_subscription{nullptr};
+    void* _traffic_cookie{nullptr};
 };
 
 } // namespace mavsdk
@@ -0,0 +1,686 @@
+// Load generator for mavsdk_server.
+//
+// Runs a mavsdk_server in a child process, attached to simulated vehicles,
+// and has clients load it with a mix of telemetry subscriptions, unary
+// commands and mission uploads, each client with a gRPC connection of its
+// own. Reports the latency percentiles per RPC as well as the CPU time and
+// memory of the server process, so changes to the server can be compared
+// under the same load.
+//
+// Linux only, as the server's CPU time and memory are read from /proc.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <grpc++/grpc++.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "action/action.grpc.pb.h"
+#include "mavsdk.h"
+#include "mavsdk_server.h"
+#include "mission_raw/mission_raw.grpc.pb.h"
+#include "plugins/action_server/action_server.h"
+#include "plugins/mission_raw_server/mission_raw_server.h"
+#include "plugins/telemetry_server/telemetry_server.h"
+#include "system_routing.h"
+#include "telemetry/telemetry.grpc.pb.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    unsigned vehicles{2};
+    unsigned telemetry_clients{8};
+    // Vehicles publish at these rates in turn, the first one at the first rate.
+    std::vector<double> telemetry_rates_hz{1.0, 10.0, 50.0};
+    unsigned command_clients{2};
+    double command_rate_hz{2.0};
+    unsigned mission_clients{1};
+    unsigned mission_items{100};
+    double duration_s{20.0};
+    int mavlink_port{14600};
+};
+
+void usage(const char* bin_name)
+{
+    std::cout
+        << "Usage: " << bin_name << " [options]\n"
+        << "\n"
+        << "Options:\n"
+        << "  --vehicles <n>           Simulated vehicles, default 2\n"
+        << "  --telemetry-clients <n>  Clients subscribed to position, default 8\n"
+        << "  --telemetry-hz <list>    Rates the vehicles publish at in turn, default 1,10,50\n"
+        << "  --command-clients <n>    Clients arming and disarming, default 2\n"
+        << "  --command-hz <hz>        Rate of commands per client, default 2\n"
+        << "  --mission-clients <n>    Clients uploading missions back to back, default 1\n"
+        << "  --mission-items <n>      Items per mission, default 100\n"
+        << "  --duration <s>           Duration of the measurement, default 20\n"
+        << "  --mavlink-port <port>    UDP port the server listens on, default 14600\n"
+        << "\n"
+        << "Clients are spread over the vehicles in turn.\n";
+}
+
+bool parse_rates(const std::string& list, std::vector<double>& rates_hz)
+{
+    rates_hz.clear();
+    std::stringstream stream(list);
+    std::string rate;
+    while (std::getline(stream, rate, ',')) {
+        char* end = nullptr;
+        const double rate_hz = std::strtod(rate.c_str(), &end);
+        if (rate.empty() || *end != '\0' || !(rate_hz > 0.0)) {
+            return false;
+        }
+        rates_hz.push_back(rate_hz);
+    }
+    return !rates_hz.empty();
+}
+
+bool parse_options(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const std::string value = argv[++i];
+        char* end = nullptr;
+        const double number = std::strtod(value.c_str(), &end);
+        const bool is_number = !value.empty() && *end == '\0' && number >= 0.0;
+
+        if (arg == "--telemetry-hz") {
+            if (!parse_rates(value, options.telemetry_rates_hz)) {
+                return false;
+            }
+            continue;
+        }
+
+        if (!is_number) {
+            return false;
+        }
+        if (arg == "--vehicles") {
+            options.vehicles = static_cast<unsigned>(number);
+        } else if (arg == "--telemetry-clients") {
+            options.telemetry_clients = static_cast<unsigned>(number);
+        } else if (arg == "--command-clients") {
+            options.command_clients = static_cast<unsigned>(number);
+        } else if (arg == "--command-hz") {
+            options.command_rate_hz = number;
+        } else if (arg == "--mission-clients") {
+            options.mission_clients = static_cast<unsigned>(number);
+        } else if (arg == "--mission-items") {
+            options.mission_items = static_cast<unsigned>(number);
+        } else if (arg == "--duration") {
+            options.duration_s = number;
+        } else if (arg == "--mavlink-port") {
+            options.mavlink_port = static_cast<int>(number);
+        } else {
+            return false;
+        }
+    }
+    return options.vehicles > 0 && options.vehicles < 245 && options.command_rate_hz > 0.0 &&
+           options.duration_s > 0.0;
+}
+
+// Latencies of all calls, by RPC.
+class LatencyRecorder {
+public:
+    void record(const std::string& rpc, Clock::duration latency)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _samples_ms[rpc].push_back(std::chrono::duration<double, std::milli>(latency).count());
+    }
+
+    void record_error(const std::string& rpc)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_errors[rpc];
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _samples_ms.clear();
+        _errors.clear();
+    }
+
+    void report(double duration_s)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::cout << std::left << std::setw(40) << "RPC" << std::right << std::setw(9) << "count"
+                  << std::setw(8) << "errors" << std::setw(9) << "per s" << std::setw(10)
+                  << "p50 ms" << std::setw(10) << "p90 ms" << std::setw(10) << "p99 ms"
+                  << std::setw(10) << "max ms" << '\n';
+
+        std::vector<std::string> rpcs;
+        for (const auto& entry : _samples_ms) {
+            rpcs.push_back(entry.first);
+        }
+        for (const auto& entry : _errors) {
+            if (_samples_ms.find(entry.first) == _samples_ms.end()) {
+                rpcs.push_back(entry.first);
+            }
+        }
+
+        for (const auto& rpc : rpcs) {
+            auto& samples = _samples_ms[rpc];
+            std::sort(samples.begin(), samples.end());
+            std::cout << std::left << std::setw(40) << rpc << std::right << std::setw(9)
+                      << samples.size() << std::setw(8) << _errors[rpc] << std::fixed
+                      << std::setprecision(1) << std::setw(9)
+                      << double(samples.size()) / duration_s << std::setprecision(2)
+                      << std::setw(10) << percentile(samples, 0.5) << std::setw(10)
+                      << percentile(samples, 0.9) << std::setw(10) << percentile(samples, 0.99)
+                      << std::setw(10) << percentile(samples, 1.0) << '\n';
+        }
+    }
+
+private:
+    static double percentile(const std::vector<double>& sorted, double fraction)
+    {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        const auto index = static_cast<std::size_t>(fraction * double(sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    std::mutex _mutex{};
+    std::map<std::string, std::vector<double>> _samples_ms{};
+    std::map<std::string, uint64_t> _errors{};
+};
+
+struct ProcessUsage {
+    double cpu_s{0.0};
+    long rss_kb{0};
+    long peak_rss_kb{0};
+};
+
+std::optional<ProcessUsage> read_usage(pid_t pid)
+{
+    ProcessUsage usage;
+
+    std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+    std::string line;
+    if (!std::getline(stat, line)) {
+        return std::nullopt;
+    }
+    // The name in parentheses can contain anything, the fields after it
+    // start with the state, utime and stime are the 12th and 13th after it.
+    const auto name_end = line.rfind(')');
+    if (name_end == std::string::npos) {
+        return std::nullopt;
+    }
+    std::stringstream fields(line.substr(name_end + 2));
+    std::string field;
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+    for (int i = 0; i < 13 && fields >> field; ++i) {
+        if (i == 11) {
+            utime = std::stoull(field);
+        } else if (i == 12) {
+            stime = std::stoull(field);
+        }
+    }
+    usage.cpu_s = double(utime + stime) / double(sysconf(_SC_CLK_TCK));
+
+    std::ifstream status("/proc/" + std::to_string(pid) + "/status");
+    while (std::getline(status, line)) {
+        std::stringstream entry(line);
+        std::string key;
+        long value_kb = 0;
+        entry >> key >> value_kb;
+        if (key == "VmRSS:") {
+            usage.rss_kb = value_kb;
+        } else if (key == "VmHWM:") {
+            usage.peak_rss_kb = value_kb;
+        }
+    }
+    return usage;
+}
+
+struct ServerProcess {
+    pid_t pid{-1};
+    int grpc_port{0};
+    // The server stops once this is closed, which also happens if the load
+    // generator crashes.
+    int control_fd{-1};
+};
+
+// Needs to be called before any thread is started, as it forks.
+std::optional<ServerProcess> start_server(int mavlink_port)
+{
+    int port_pipe[2];
+    int control_pipe[2];
+    if (pipe(port_pipe) != 0) {
+        return std::nullopt;
+    }
+    if (pipe(control_pipe) != 0) {
+        close(port_pipe[0]);
+        close(port_pipe[1]);
+        return std::nullopt;
+    }
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+        close(port_pipe[0]);
+        close(control_pipe[1]);
+
+        MavsdkServer server;
+        const int port = server.startGrpcServer(0);
+        if (write(port_pipe[1], &port, sizeof(port)) != static_cast<ssize_t>(sizeof(port))) {
+            _exit(1);
+        }
+        close(port_pipe[1]);
+
+        // Connecting only returns once the first vehicle was discovered.
+        std::thread connector(
+            [&]() { server.connect("udp://:" + std::to_string(mavlink_port)); });
+
+        char dummy;
+        while (read(control_pipe[0], &dummy, 1) > 0) {}
+        server.stop();
+        connector.join();
+        _exit(0);
+    }
+
+    close(port_pipe[1]);
+    close(control_pipe[0]);
+
+    ServerProcess server{pid, 0, control_pipe[1]};
+    const auto port_size = static_cast<ssize_t>(sizeof(server.grpc_port));
+    const bool started = pid > 0 &&
+                         read(port_pipe[0], &server.grpc_port, sizeof(server.grpc_port)) ==
+                             port_size &&
+                         server.grpc_port != 0;
+    close(port_pipe[0]);
+    if (!started) {
+        close(server.control_fd);
+        if (pid > 0) {
+            waitpid(pid, nullptr, 0);
+        }
+        return std::nullopt;
+    }
+    return server;
+}
+
+// An autopilot publishing its position, accepting arming and missions.
+class Vehicle {
+public:
+    Vehicle(uint8_t system_id, int mavlink_port, double rate_hz) :
+        _system_id(system_id),
+        _rate_hz(rate_hz)
+    {
+        mavsdk::Mavsdk::Configuration configuration(
+            mavsdk::Mavsdk::Configuration::UsageType::Autopilot);
+        configuration.set_system_id(system_id);
+        _mavsdk.set_configuration(configuration);
+        _mavsdk.add_any_connection("udp://127.0.0.1:" + std::to_string(mavlink_port));
+    }
+
+    ~Vehicle()
+    {
+        _should_exit = true;
+        if (_publisher.joinable()) {
+            _publisher.join();
+        }
+    }
+
+    // Non-copyable
+    Vehicle(const Vehicle&) = delete;
+    const Vehicle& operator=(const Vehicle&) = delete;
+
+    bool start()
+    {
+        // The server shows up once its heartbeats arrive.
+        const auto deadline = Clock::now() + std::chrono::seconds(10);
+        while (_mavsdk.systems().empty()) {
+            if (Clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        const auto server = _mavsdk.systems().front();
+
+        _telemetry_server = std::make_unique<mavsdk::TelemetryServer>(server);
+        _action_server = std::make_unique<mavsdk::ActionServer>(server);
+        _mission_raw_server = std::make_unique<mavsdk::MissionRawServer>(server);
+
+        _action_server->set_armable(true, true);
+        _action_server->set_disarmable(true, true);
+
+        _publisher = std::thread([this]() { publish(); });
+        return true;
+    }
+
+    [[nodiscard]] uint8_t system_id() const { return _system_id; }
+    [[nodiscard]] double rate_hz() const { return _rate_hz; }
+
+private:
+    void publish()
+    {
+        const auto period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / _rate_hz));
+        auto next = Clock::now();
+        while (!_should_exit) {
+            mavsdk::TelemetryServer::Position position{47.397742, 8.545594, 488.0f, 10.0f};
+            _telemetry_server->publish_position(
+                position, mavsdk::TelemetryServer::VelocityNed{}, {0.0});
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    }
+
+    const uint8_t _system_id;
+    const double _rate_hz;
+    mavsdk::Mavsdk _mavsdk{};
+    std::unique_ptr<mavsdk::TelemetryServer> _telemetry_server{};
+    std::unique_ptr<mavsdk::ActionServer> _action_server{};
+    std::unique_ptr<mavsdk::MissionRawServer> _mission_raw_server{};
+    std::atomic<bool> _should_exit{false};
+    std::thread _publisher{};
+};
+
+// Every client has a connection of its own, as separate applications would.
+std::shared_ptr<grpc::Channel> connect_client(int grpc_port)
+{
+    grpc::ChannelArguments args;
+    args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+    return grpc::CreateCustomChannel(
+        "127.0.0.1:" + std::to_string(grpc_port), grpc::InsecureChannelCredentials(), args);
+}
+
+void route_to(grpc::ClientContext& context, uint8_t system_id)
+{
+    context.AddMetadata(
+        mavsdk::mavsdk_server::system_id_metadata_key, std::to_string(unsigned(system_id)));
+}
+
+// Waits until the vehicle's position comes through the server.
+bool wait_for_position(int grpc_port, uint8_t system_id)
+{
+    auto stub = mavsdk::rpc::telemetry::TelemetryService::NewStub(connect_client(grpc_port));
+    grpc::ClientContext context;
+    route_to(context, system_id);
+    context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(20));
+    auto reader = stub->SubscribePosition(&context, {});
+    mavsdk::rpc::telemetry::PositionResponse response;
+    const bool received = reader->Read(&response);
+    context.TryCancel();
+    reader->Finish();
+    return received;
+}
+
+class TelemetryClient {
+public:
+    TelemetryClient(int grpc_port, const Vehicle& vehicle, LatencyRecorder& recorder) :
+        _stub(mavsdk::rpc::telemetry::TelemetryService::NewStub(connect_client(grpc_port))),
+        _system_id(vehicle.system_id()),
+        _rpc(
+            "Telemetry.SubscribePosition@" + std::to_string(int(vehicle.rate_hz())) +
+            "Hz (gap)"),
+        _recorder(recorder)
+    {
+        _thread = std::thread([this]() { run(); });
+    }
+
+    ~TelemetryClient()
+    {
+        _context.TryCancel();
+        _thread.join();
+    }
+
+    // Non-copyable
+    TelemetryClient(const TelemetryClient&) = delete;
+    const TelemetryClient& operator=(const TelemetryClient&) = delete;
+
+private:
+    void run()
+    {
+        route_to(_context, _system_id);
+        auto reader = _stub->SubscribePosition(&_context, {});
+        mavsdk::rpc::telemetry::PositionResponse response;
+        std::optional<Clock::time_point> last;
+        while (reader->Read(&response)) {
+            const auto now = Clock::now();
+            if (last) {
+                _recorder.record(_rpc, now - *last);
+            }
+            last = now;
+        }
+        reader->Finish();
+    }
+
+    std::unique_ptr<mavsdk::rpc::telemetry::TelemetryService::Stub> _stub;
+    const uint8_t _system_id;
+    const std::string _rpc;
+    LatencyRecorder& _recorder;
+    grpc::ClientContext _context{};
+    std::thread _thread{};
+};
+
+// Calls the function at the rate, or back to back without a rate, until stopped.
+class PacedClient {
+public:
+    PacedClient(double rate_hz, std::function<void()> call) : _call(std::move(call))
+    {
+        _thread = std::thread([this, rate_hz]() { run(rate_hz); });
+    }
+
+    ~PacedClient()
+    {
+        _should_exit = true;
+        _thread.join();
+    }
+
+    // Non-copyable
+    PacedClient(const PacedClient&) = delete;
+    const PacedClient& operator=(const PacedClient&) = delete;
+
+private:
+    void run(double rate_hz)
+    {
+        const auto period = rate_hz > 0.0 ? std::chrono::duration_cast<Clock::duration>(
+                                                std::chrono::duration<double>(1.0 / rate_hz)) :
+                                            Clock::duration::zero();
+        auto next = Clock::now();
+        while (!_should_exit) {
+            _call();
+            next += period;
+            // A server which can't keep up isn't given a burst afterwards.
+            next = std::max(next, Clock::now());
+            std::this_thread::sleep_until(next);
+        }
+    }
+
+    std::function<void()> _call;
+    std::atomic<bool> _should_exit{false};
+    std::thread _thread{};
+};
+
+template<typename Call>
+void timed(LatencyRecorder& recorder, const std::string& rpc, uint8_t system_id, Call&& call)
+{
+    grpc::ClientContext context;
+    route_to(context, system_id);
+    context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(30));
+    const auto start = Clock::now();
+    const bool success = call(context);
+    const auto latency = Clock::now() - start;
+    if (success) {
+        recorder.record(rpc, latency);
+    } else {
+        recorder.record_error(rpc);
+    }
+}
+
+std::unique_ptr<PacedClient> make_command_client(
+    int grpc_port, uint8_t system_id, double rate_hz, LatencyRecorder& recorder)
+{
+    std::shared_ptr<mavsdk::rpc::action::ActionService::Stub> stub =
+        mavsdk::rpc::action::ActionService::NewStub(connect_client(grpc_port));
+    auto arm = std::make_shared<bool>(true);
+
+    return std::make_unique<PacedClient>(rate_hz, [=, &recorder]() {
+        using mavsdk::rpc::action::ActionResult;
+        if (*arm) {
+            timed(recorder, "Action.Arm", system_id, [&](grpc::ClientContext& context) {
+                mavsdk::rpc::action::ArmResponse response;
+                return stub->Arm(&context, {}, &response).ok() &&
+                       response.action_result().result() == ActionResult::RESULT_SUCCESS;
+            });
+        } else {
+            timed(recorder, "Action.Disarm", system_id, [&](grpc::ClientContext& context) {
+                mavsdk::rpc::action::DisarmResponse response;
+                return stub->Disarm(&context, {}, &response).ok() &&
+                       response.action_result().result() == ActionResult::RESULT_SUCCESS;
+            });
+        }
+        *arm = !*arm;
+    });
+}
+
+std::unique_ptr<PacedClient>
+make_mission_client(int grpc_port, uint8_t system_id, unsigned items, LatencyRecorder& recorder)
+{
+    std::shared_ptr<mavsdk::rpc::mission_raw::MissionRawService::Stub> stub =
+        mavsdk::rpc::mission_raw::MissionRawService::NewStub(connect_client(grpc_port));
+
+    auto request = std::make_shared<mavsdk::rpc::mission_raw::UploadMissionRequest>();
+    for (unsigned i = 0; i < items; ++i) {
+        auto* item = request->add_mission_items();
+        item->set_seq(i);
+        item->set_frame(6); // MAV_FRAME_GLOBAL_RELATIVE_ALT_INT
+        item->set_command(16); // MAV_CMD_NAV_WAYPOINT
+        item->set_current(i == 0 ? 1 : 0);
+        item->set_autocontinue(1);
+        item->set_x(473977420 + int32_t(i) * 100);
+        item->set_y(85455940 + int32_t(i) * 100);
+        item->set_z(20.0f);
+        item->set_mission_type(0); // MAV_MISSION_TYPE_MISSION
+    }
+
+    return std::make_unique<PacedClient>(0.0, [=, &recorder]() {
+        using mavsdk::rpc::mission_raw::MissionRawResult;
+        timed(recorder, "MissionRaw.UploadMission", system_id, [&](grpc::ClientContext& context) {
+            mavsdk::rpc::mission_raw::UploadMissionResponse response;
+            return stub->UploadMission(&context, *request, &response).ok() &&
+                   response.mission_raw_result().result() == MissionRawResult::RESULT_SUCCESS;
+        });
+    });
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const auto server = start_server(options.mavlink_port);
+    if (!server) {
+        std::cerr << "Could not start mavsdk_server" << std::endl;
+        return 1;
+    }
+    const int grpc_port = server->grpc_port;
+    const pid_t server_pid = server->pid;
+
+    int result = 0;
+    {
+        std::vector<std::unique_ptr<Vehicle>> vehicles;
+        for (unsigned i = 0; i < options.vehicles; ++i) {
+            const auto rate_hz = options.telemetry_rates_hz[i % options.telemetry_rates_hz.size()];
+            vehicles.push_back(
+                std::make_unique<Vehicle>(uint8_t(i + 1), options.mavlink_port, rate_hz));
+        }
+        for (auto& vehicle : vehicles) {
+            if (!vehicle->start() || !wait_for_position(grpc_port, vehicle->system_id())) {
+                std::cerr << "Vehicle " << unsigned(vehicle->system_id())
+                          << " not available on mavsdk_server" << std::endl;
+                result = 1;
+            }
+        }
+
+        if (result == 0) {
+            LatencyRecorder recorder;
+            std::vector<std::unique_ptr<TelemetryClient>> telemetry_clients;
+            std::vector<std::unique_ptr<PacedClient>> clients;
+
+            for (unsigned i = 0; i < options.telemetry_clients; ++i) {
+                telemetry_clients.push_back(std::make_unique<TelemetryClient>(
+                    grpc_port, *vehicles[i % vehicles.size()], recorder));
+            }
+            for (unsigned i = 0; i < options.command_clients; ++i) {
+                clients.push_back(make_command_client(
+                    grpc_port,
+                    vehicles[i % vehicles.size()]->system_id(),
+                    options.command_rate_hz,
+                    recorder));
+            }
+            for (unsigned i = 0; i < options.mission_clients; ++i) {
+                clients.push_back(make_mission_client(
+                    grpc_port,
+                    vehicles[i % vehicles.size()]->system_id(),
+                    options.mission_items,
+                    recorder));
+            }
+
+            // Setting up the streams is not part of what is measured.
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            recorder.clear();
+            const auto usage_before = read_usage(server_pid);
+            const auto start = Clock::now();
+
+            long max_rss_kb = 0;
+            while (Clock::now() - start < std::chrono::duration<double>(options.duration_s)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(250));
+                if (const auto usage = read_usage(server_pid)) {
+                    max_rss_kb = std::max(max_rss_kb, usage->rss_kb);
+                }
+            }
+
+            const auto usage_after = read_usage(server_pid);
+            const double elapsed_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+            clients.clear();
+            telemetry_clients.clear();
+
+            std::cout << options.vehicles << " vehicles, " << options.telemetry_clients
+                      << " telemetry, " << options.command_clients << " command and "
+                      << options.mission_clients << " mission clients, " << std::fixed
+                      << std::setprecision(1) << elapsed_s << " s\n\n";
+            recorder.report(elapsed_s);
+
+            if (usage_before && usage_after) {
+                std::cout << "\nmavsdk_server: " << std::setprecision(1)
+                          << 100.0 * (usage_after->cpu_s - usage_before->cpu_s) / elapsed_s
+                          << "% CPU, " << max_rss_kb / 1024 << " MiB RSS at most, "
+                          << usage_after->peak_rss_kb / 1024 << " MiB peak since start\n";
+            }
+        }
+    }
+
+    close(server->control_fd);
+    waitpid(server_pid, nullptr, 0);
+    return result;
+}
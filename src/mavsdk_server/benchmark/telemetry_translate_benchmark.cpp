@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+#include "telemetry/telemetry_service_impl.h"
+
+using TelemetryServiceImpl = mavsdk::mavsdk_server::TelemetryServiceImpl<>;
+using PositionResponse = mavsdk::rpc::telemetry::PositionResponse;
+using ActuatorOutputStatusResponse = mavsdk::rpc::telemetry::ActuatorOutputStatusResponse;
+
+namespace {
+
+mavsdk::Telemetry::Position make_position()
+{
+    mavsdk::Telemetry::Position position;
+    position.latitude_deg = 41.848695;
+    position.longitude_deg = 75.132751;
+    position.absolute_altitude_m = 3002.1f;
+    position.relative_altitude_m = 50.3f;
+    return position;
+}
+
+mavsdk::Telemetry::ActuatorOutputStatus make_actuator_output_status()
+{
+    mavsdk::Telemetry::ActuatorOutputStatus status;
+    status.actuator = std::vector<float>(16, 0.5f);
+    return status;
+}
+
+} // namespace
+
+// Translating and serializing a response allocated for every sample, as the
+// stream handlers used to do.
+static void TelemetryTranslate_PositionFresh(benchmark::State& state)
+{
+    const auto position = make_position();
+    std::string buffer;
+
+    for (auto _ : state) {
+        PositionResponse response;
+        response.set_allocated_position(
+            TelemetryServiceImpl::translateToRpcPosition(position).release());
+        response.SerializeToString(&buffer);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+}
+BENCHMARK(TelemetryTranslate_PositionFresh);
+
+// The same with one response filled in place, as the stream handlers do now.
+static void TelemetryTranslate_PositionInPlace(benchmark::State& state)
+{
+    const auto position = make_position();
+    std::string buffer;
+    PositionResponse response;
+
+    for (auto _ : state) {
+        TelemetryServiceImpl::translateToRpcPosition(position, response.mutable_position());
+        response.SerializeToString(&buffer);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+}
+BENCHMARK(TelemetryTranslate_PositionInPlace);
+
+static void TelemetryTranslate_ActuatorOutputStatusFresh(benchmark::State& state)
+{
+    const auto status = make_actuator_output_status();
+    std::string buffer;
+
+    for (auto _ : state) {
+        ActuatorOutputStatusResponse response;
+        response.set_allocated_actuator_output_status(
+            TelemetryServiceImpl::translateToRpcActuatorOutputStatus(status).release());
+        response.SerializeToString(&buffer);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+}
+BENCHMARK(TelemetryTranslate_ActuatorOutputStatusFresh);
+
+static void TelemetryTranslate_ActuatorOutputStatusInPlace(benchmark::State& state)
+{
+    const auto status = make_actuator_output_status();
+    std::string buffer;
+    ActuatorOutputStatusResponse response;
+
+    for (auto _ : state) {
+        TelemetryServiceImpl::translateToRpcActuatorOutputStatus(
+            status, response.mutable_actuator_output_status());
+        response.SerializeToString(&buffer);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+}
+BENCHMARK(TelemetryTranslate_ActuatorOutputStatusInPlace);
@@ -3,6 +3,9 @@
 #include <grpc++/server_builder.h>
 #include <grpc++/security/server_credentials.h>
 
+#include <sstream>
+#include <vector>
+
 #include "log.h"
 
 namespace mavsdk {
@@ -13,44 +16,95 @@ void GrpcServer::set_port(const int port)
     _port = port;
 }
 
+#ifdef MAVSDK_SERVER_WITH_TELEMETRY
+void GrpcServer::set_conflate_telemetry(const bool conflate)
+{
+    _telemetry_service.set_stream_policy(
+        conflate ? StreamOutboxPolicy::Conflate : StreamOutboxPolicy::Queue);
+}
+
+bool GrpcServer::start_shm_telemetry(const std::string& name)
+{
+    auto* telemetry = _telemetry_lazy_plugin.maybe_plugin();
+    if (telemetry == nullptr) {
+        LogErr() << "No system to publish shared-memory telemetry for";
+        return false;
+    }
+
+    auto publisher = std::make_unique<ShmTelemetryPublisher>();
+    if (!publisher->open(name)) {
+        return false;
+    }
+    publisher->attach(*telemetry);
+    _shm_telemetry_publisher = std::move(publisher);
+    return true;
+}
+#else
+void GrpcServer::set_conflate_telemetry(const bool)
+{
+    LogWarn() << "Built without telemetry plugin, nothing to conflate";
+}
+
+bool GrpcServer::start_shm_telemetry(const std::string&)
+{
+    LogErr() << "Built without telemetry plugin, cannot publish shared-memory telemetry";
+    return false;
+}
+#endif
+
+void GrpcServer::set_metrics_port(const int port)
+{
+    _metrics_port = port;
+}
+
+std::string GrpcServer::render_metrics()
+{
+    std::vector<StreamOutboxStats> streams;
+    for_each_service([&](auto& service) { service.collect_stream_stats(streams); });
+
+    std::ostringstream out;
+    _metrics.render(out);
+    render_stream_metrics(out, streams);
+    render_mavsdk_metrics(out, _mavsdk.callback_queue_stats(), _mavsdk.connection_stats());
+    return out.str();
+}
+
 int GrpcServer::run()
 {
     grpc::ServerBuilder builder;
     setup_port(builder);
 
+    if (_metrics_port >= 0) {
+        std::vector<std::unique_ptr<grpc::experimental::ServerInterceptorFactoryInterface>>
+            interceptor_creators;
+        interceptor_creators.push_back(std::make_unique<MetricsInterceptorFactory>(_metrics));
+        builder.experimental().SetInterceptorCreators(std::move(interceptor_creators));
+    }
+
     builder.RegisterService(&_core);
-    builder.RegisterService(&_action_service);
-    builder.RegisterService(&_action_server_service);
-    builder.RegisterService(&_calibration_service);
-    builder.RegisterService(&_camera_service);
-    builder.RegisterService(&_failure_service);
-    builder.RegisterService(&_follow_me_service);
-    builder.RegisterService(&_ftp_service);
-    builder.RegisterService(&_geofence_service);
-    builder.RegisterService(&_gimbal_service);
-    builder.RegisterService(&_info_service);
-    builder.RegisterService(&_log_files_service);
-    builder.RegisterService(&_manual_control_service);
-    builder.RegisterService(&_mission_service);
-    builder.RegisterService(&_mission_raw_service);
-    builder.RegisterService(&_mission_raw_server_service);
-    builder.RegisterService(&_mocap_service);
-    builder.RegisterService(&_offboard_service);
-    builder.RegisterService(&_param_service);
-    builder.RegisterService(&_param_server_service);
-    builder.RegisterService(&_server_utility_service);
-    builder.RegisterService(&_shell_service);
-    builder.RegisterService(&_telemetry_service);
-    builder.RegisterService(&_telemetry_server_service);
-    builder.RegisterService(&_tracking_server_service);
-    builder.RegisterService(&_transponder_service);
-    builder.RegisterService(&_tune_service);
+    for_each_service([&](auto& service) { builder.RegisterService(&service); });
+#ifdef MAVSDK_SERVER_WITH_TELEMETRY
+    builder.RegisterService(&_telemetry_bundle_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_MAVLINK_PASSTHROUGH
+    _mavlink_passthrough_service.register_with(builder);
+#endif
 
     _server = builder.BuildAndStart();
 
+#ifdef MAVSDK_SERVER_WITH_MAVLINK_PASSTHROUGH
+    if (_server != nullptr) {
+        _mavlink_passthrough_service.start();
+    }
+#endif
+
     if (_bound_port != 0) {
         LogInfo() << "Server started";
         LogInfo() << "Server set to listen on 0.0.0.0:" << _bound_port;
+
+        if (_metrics_port >= 0) {
+            _metrics_endpoint.start(_metrics_port, [this]() { return render_metrics(); });
+        }
     } else {
         LogErr() << "Failed to bind server to port " << _port;
     }
@@ -69,35 +123,24 @@ void GrpcServer::wait()
 
 void GrpcServer::stop()
 {
+#ifdef MAVSDK_SERVER_WITH_TELEMETRY
+    _shm_telemetry_publisher.reset();
+#endif
+    _metrics_endpoint.stop();
+
     if (_server != nullptr) {
         _core.stop();
-        _action_service.stop();
-        _action_server_service.stop();
-        _calibration_service.stop();
-        _camera_service.stop();
-        _failure_service.stop();
-        _follow_me_service.stop();
-        _ftp_service.stop();
-        _geofence_service.stop();
-        _gimbal_service.stop();
-        _info_service.stop();
-        _log_files_service.stop();
-        _manual_control_service.stop();
-        _mission_service.stop();
-        _mission_raw_service.stop();
-        _mission_raw_server_service.stop();
-        _mocap_service.stop();
-        _offboard_service.stop();
-        _param_service.stop();
-        _param_server_service.stop();
-        _server_utility_service.stop();
-        _shell_service.stop();
-        _telemetry_service.stop();
-        _telemetry_server_service.stop();
-        _tracking_server_service.stop();
-        _tune_service.stop();
-        _transponder_service.stop();
+        for_each_service([](auto& service) { service.stop(); });
+#ifdef MAVSDK_SERVER_WITH_TELEMETRY
+        _telemetry_bundle_service.stop();
+#endif
+#ifdef MAVSDK_SERVER_WITH_MAVLINK_PASSTHROUGH
+        _mavlink_passthrough_service.stop();
+        _server->Shutdown();
+        _mavlink_passthrough_service.shutdown();
+#else
         _server->Shutdown();
+#endif
     } else {
         LogWarn() << "Calling 'stop()' on a non-existing server. Did you call 'run()' before?";
     }
@@ -3,189 +3,357 @@
 #include <grpcpp/server.h>
 #include <grpcpp/server_builder.h>
 #include <memory>
+#include <string>
 
 #include "mavsdk.h"
 #include "core/core_service_impl.h"
+#ifdef MAVSDK_SERVER_WITH_ACTION
 #include "plugins/action/action.h"
 #include "action/action_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_ACTION_SERVER
 #include "plugins/action_server/action_server.h"
 #include "action_server/action_server_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_CALIBRATION
 #include "plugins/calibration/calibration.h"
 #include "calibration/calibration_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_CAMERA
 #include "plugins/camera/camera.h"
 #include "camera/camera_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_FAILURE
 #include "plugins/failure/failure.h"
 #include "failure/failure_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_FOLLOW_ME
 #include "plugins/follow_me/follow_me.h"
 #include "follow_me/follow_me_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_FTP
 #include "plugins/ftp/ftp.h"
 #include "ftp/ftp_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_GEOFENCE
 #include "plugins/geofence/geofence.h"
 #include "geofence/geofence_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_GIMBAL
 #include "plugins/gimbal/gimbal.h"
 #include "gimbal/gimbal_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_INFO
 #include "plugins/info/info.h"
 #include "info/info_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_LOG_FILES
 #include "plugins/log_files/log_files.h"
 #include "log_files/log_files_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_MANUAL_CONTROL
 #include "plugins/manual_control/manual_control.h"
 #include "manual_control/manual_control_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_MISSION
 #include "plugins/mission/mission.h"
 #include "mission/mission_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_MISSION_RAW
 #include "plugins/mission_raw/mission_raw.h"
 #include "mission_raw/mission_raw_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_MISSION_RAW_SERVER
 #include "plugins/mission_raw_server/mission_raw_server.h"
 #include "mission_raw_server/mission_raw_server_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_MOCAP
 #include "plugins/mocap/mocap.h"
 #include "mocap/mocap_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_OFFBOARD
 #include "plugins/offboard/offboard.h"
 #include "offboard/offboard_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_PARAM
 #include "plugins/param/param.h"
 #include "param/param_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_PARAM_SERVER
 #include "plugins/param_server/param_server.h"
 #include "param_server/param_server_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_SERVER_UTILITY
 #include "plugins/server_utility/server_utility.h"
 #include "server_utility/server_utility_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_SHELL
 #include "plugins/shell/shell.h"
 #include "shell/shell_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_TELEMETRY
 #include "plugins/telemetry/telemetry.h"
 #include "telemetry/telemetry_service_impl.h"
+#include "telemetry/telemetry_bundle_service.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_TELEMETRY_SERVER
 #include "plugins/telemetry_server/telemetry_server.h"
 #include "telemetry_server/telemetry_server_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_TRACKING_SERVER
 #include "plugins/tracking_server/tracking_server.h"
 #include "tracking_server/tracking_server_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_TUNE
 #include "plugins/tune/tune.h"
 #include "tune/tune_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_TRANSPONDER
 #include "plugins/transponder/transponder.h"
 #include "transponder/transponder_service_impl.h"
+#endif
+#ifdef MAVSDK_SERVER_WITH_MAVLINK_PASSTHROUGH
+#include "plugins/mavlink_passthrough/mavlink_passthrough.h"
+#include "mavlink_passthrough_service.h"
+#endif
+#include "metrics_endpoint.h"
+#include "server_metrics.h"
+#ifdef MAVSDK_SERVER_WITH_TELEMETRY
+#include "shm_telemetry_publisher.h"
+#endif
 
 namespace mavsdk {
 namespace mavsdk_server {
 
 class GrpcServer {
 public:
-    GrpcServer(Mavsdk& mavsdk) :
-        _core(mavsdk),
-        _action_lazy_plugin(mavsdk),
-        _action_service(_action_lazy_plugin),
-        _action_server_lazy_plugin(mavsdk),
-        _action_server_service(_action_server_lazy_plugin),
-        _calibration_lazy_plugin(mavsdk),
-        _calibration_service(_calibration_lazy_plugin),
-        _camera_lazy_plugin(mavsdk),
-        _camera_service(_camera_lazy_plugin),
-        _failure_lazy_plugin(mavsdk),
-        _failure_service(_failure_lazy_plugin),
-        _follow_me_lazy_plugin(mavsdk),
-        _follow_me_service(_follow_me_lazy_plugin),
-        _ftp_lazy_plugin(mavsdk),
-        _ftp_service(_ftp_lazy_plugin),
-        _geofence_lazy_plugin(mavsdk),
-        _geofence_service(_geofence_lazy_plugin),
-        _gimbal_lazy_plugin(mavsdk),
-        _gimbal_service(_gimbal_lazy_plugin),
-        _info_lazy_plugin(mavsdk),
-        _info_service(_info_lazy_plugin),
-        _log_files_lazy_plugin(mavsdk),
-        _log_files_service(_log_files_lazy_plugin),
-        _manual_control_lazy_plugin(mavsdk),
-        _manual_control_service(_manual_control_lazy_plugin),
-        _mission_lazy_plugin(mavsdk),
-        _mission_service(_mission_lazy_plugin),
-        _mission_raw_lazy_plugin(mavsdk),
-        _mission_raw_service(_mission_raw_lazy_plugin),
-        _mission_raw_server_lazy_plugin(mavsdk),
-        _mission_raw_server_service(_mission_raw_server_lazy_plugin),
-        _mocap_lazy_plugin(mavsdk),
-        _mocap_service(_mocap_lazy_plugin),
-        _offboard_lazy_plugin(mavsdk),
-        _offboard_service(_offboard_lazy_plugin),
-        _param_lazy_plugin(mavsdk),
-        _param_service(_param_lazy_plugin),
-        _param_server_lazy_plugin(mavsdk),
-        _param_server_service(_param_server_lazy_plugin),
-        _server_utility_lazy_plugin(mavsdk),
-        _server_utility_service(_server_utility_lazy_plugin),
-        _shell_lazy_plugin(mavsdk),
-        _shell_service(_shell_lazy_plugin),
-        _telemetry_lazy_plugin(mavsdk),
-        _telemetry_service(_telemetry_lazy_plugin),
-        _telemetry_server_lazy_plugin(mavsdk),
-        _telemetry_server_service(_telemetry_server_lazy_plugin),
-        _tracking_server_lazy_plugin(mavsdk),
-        _tracking_server_service(_tracking_server_lazy_plugin),
-        _tune_lazy_plugin(mavsdk),
-        _tune_service(_tune_lazy_plugin),
-        _transponder_lazy_plugin(mavsdk),
-        _transponder_service(_transponder_lazy_plugin)
-    {}
+    GrpcServer(Mavsdk& mavsdk) : _mavsdk(mavsdk), _core(mavsdk) {}
 
     int run();
     void wait();
     void stop();
     void set_port(int port);
+    void set_conflate_telemetry(bool conflate);
+    // Also publishes IMU and odometry of the first system into the named
+    // shared-memory segment. Needs a connected system.
+    bool start_shm_telemetry(const std::string& name);
+    // Serves Prometheus metrics over HTTP on this port, 0 to pick a free one.
+    // Has to be set before run(), as it also instruments every call.
+    void set_metrics_port(int port);
+    std::string render_metrics();
 
 private:
     void setup_port(grpc::ServerBuilder& builder);
 
+    // Calls f with the service of each plugin built in, see cmake/plugins.cmake.
+    template<typename F> void for_each_service(F&& f)
+    {
+#ifdef MAVSDK_SERVER_WITH_ACTION
+        f(_action_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_ACTION_SERVER
+        f(_action_server_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_CALIBRATION
+        f(_calibration_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_CAMERA
+        f(_camera_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_FAILURE
+        f(_failure_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_FOLLOW_ME
+        f(_follow_me_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_FTP
+        f(_ftp_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_GEOFENCE
+        f(_geofence_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_GIMBAL
+        f(_gimbal_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_INFO
+        f(_info_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_LOG_FILES
+        f(_log_files_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_MANUAL_CONTROL
+        f(_manual_control_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_MISSION
+        f(_mission_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_MISSION_RAW
+        f(_mission_raw_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_MISSION_RAW_SERVER
+        f(_mission_raw_server_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_MOCAP
+        f(_mocap_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_OFFBOARD
+        f(_offboard_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_PARAM
+        f(_param_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_PARAM_SERVER
+        f(_param_server_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_SERVER_UTILITY
+        f(_server_utility_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_SHELL
+        f(_shell_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_TELEMETRY
+        f(_telemetry_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_TELEMETRY_SERVER
+        f(_telemetry_server_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_TRACKING_SERVER
+        f(_tracking_server_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_TUNE
+        f(_tune_service);
+#endif
+#ifdef MAVSDK_SERVER_WITH_TRANSPONDER
+        f(_transponder_service);
+#endif
+    }
+
+    Mavsdk& _mavsdk;
     CoreServiceImpl<> _core;
-    LazyPlugin<Action> _action_lazy_plugin;
-    ActionServiceImpl<> _action_service;
-    LazyPlugin<ActionServer> _action_server_lazy_plugin;
-    ActionServerServiceImpl<> _action_server_service;
-    LazyPlugin<Calibration> _calibration_lazy_plugin;
-    CalibrationServiceImpl<> _calibration_service;
-    LazyPlugin<Camera> _camera_lazy_plugin;
-    CameraServiceImpl<> _camera_service;
-    LazyPlugin<Failure> _failure_lazy_plugin;
-    FailureServiceImpl<> _failure_service;
-    LazyPlugin<FollowMe> _follow_me_lazy_plugin;
-    FollowMeServiceImpl<> _follow_me_service;
-    LazyPlugin<Ftp> _ftp_lazy_plugin;
-    FtpServiceImpl<> _ftp_service;
-    LazyPlugin<Geofence> _geofence_lazy_plugin;
-    GeofenceServiceImpl<> _geofence_service;
-    LazyPlugin<Gimbal> _gimbal_lazy_plugin;
-    GimbalServiceImpl<> _gimbal_service;
-    LazyPlugin<Info> _info_lazy_plugin;
-    InfoServiceImpl<> _info_service;
-    LazyPlugin<LogFiles> _log_files_lazy_plugin;
-    LogFilesServiceImpl<> _log_files_service;
-    LazyPlugin<ManualControl> _manual_control_lazy_plugin;
-    ManualControlServiceImpl<> _manual_control_service;
-    LazyPlugin<Mission> _mission_lazy_plugin;
-    MissionServiceImpl<> _mission_service;
-    LazyPlugin<MissionRaw> _mission_raw_lazy_plugin;
-    MissionRawServiceImpl<> _mission_raw_service;
-    LazyPlugin<MissionRawServer> _mission_raw_server_lazy_plugin;
-    MissionRawServerServiceImpl<> _mission_raw_server_service;
-    LazyPlugin<Mocap> _mocap_lazy_plugin;
-    MocapServiceImpl<> _mocap_service;
-    LazyPlugin<Offboard> _offboard_lazy_plugin;
-    OffboardServiceImpl<> _offboard_service;
-    LazyPlugin<Param> _param_lazy_plugin;
-    ParamServiceImpl<> _param_service;
-    LazyPlugin<ParamServer> _param_server_lazy_plugin;
-    ParamServerServiceImpl<> _param_server_service;
-    LazyPlugin<ServerUtility> _server_utility_lazy_plugin;
-    ServerUtilityServiceImpl<> _server_utility_service;
-    LazyPlugin<Shell> _shell_lazy_plugin;
-    ShellServiceImpl<> _shell_service;
-    LazyPlugin<Telemetry> _telemetry_lazy_plugin;
-    TelemetryServiceImpl<> _telemetry_service;
-    LazyPlugin<TelemetryServer> _telemetry_server_lazy_plugin;
-    TelemetryServerServiceImpl<> _telemetry_server_service;
-    LazyPlugin<TrackingServer> _tracking_server_lazy_plugin;
-    TrackingServerServiceImpl<> _tracking_server_service;
-    LazyPlugin<Tune> _tune_lazy_plugin;
-    TuneServiceImpl<> _tune_service;
-    LazyPlugin<Transponder> _transponder_lazy_plugin;
-    TransponderServiceImpl<> _transponder_service;
+#ifdef MAVSDK_SERVER_WITH_ACTION
+    LazyPlugin<Action> _action_lazy_plugin{_mavsdk};
+    ActionServiceImpl<> _action_service{_action_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_ACTION_SERVER
+    LazyPlugin<ActionServer> _action_server_lazy_plugin{_mavsdk};
+    ActionServerServiceImpl<> _action_server_service{_action_server_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_CALIBRATION
+    LazyPlugin<Calibration> _calibration_lazy_plugin{_mavsdk};
+    CalibrationServiceImpl<> _calibration_service{_calibration_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_CAMERA
+    LazyPlugin<Camera> _camera_lazy_plugin{_mavsdk};
+    CameraServiceImpl<> _camera_service{_camera_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_FAILURE
+    LazyPlugin<Failure> _failure_lazy_plugin{_mavsdk};
+    FailureServiceImpl<> _failure_service{_failure_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_FOLLOW_ME
+    LazyPlugin<FollowMe> _follow_me_lazy_plugin{_mavsdk};
+    FollowMeServiceImpl<> _follow_me_service{_follow_me_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_FTP
+    LazyPlugin<Ftp> _ftp_lazy_plugin{_mavsdk};
+    FtpServiceImpl<> _ftp_service{_ftp_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_GEOFENCE
+    LazyPlugin<Geofence> _geofence_lazy_plugin{_mavsdk};
+    GeofenceServiceImpl<> _geofence_service{_geofence_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_GIMBAL
+    LazyPlugin<Gimbal> _gimbal_lazy_plugin{_mavsdk};
+    GimbalServiceImpl<> _gimbal_service{_gimbal_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_INFO
+    LazyPlugin<Info> _info_lazy_plugin{_mavsdk};
+    InfoServiceImpl<> _info_service{_info_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_LOG_FILES
+    LazyPlugin<LogFiles> _log_files_lazy_plugin{_mavsdk};
+    LogFilesServiceImpl<> _log_files_service{_log_files_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_MANUAL_CONTROL
+    LazyPlugin<ManualControl> _manual_control_lazy_plugin{_mavsdk};
+    ManualControlServiceImpl<> _manual_control_service{_manual_control_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_MISSION
+    LazyPlugin<Mission> _mission_lazy_plugin{_mavsdk};
+    MissionServiceImpl<> _mission_service{_mission_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_MISSION_RAW
+    LazyPlugin<MissionRaw> _mission_raw_lazy_plugin{_mavsdk};
+    MissionRawServiceImpl<> _mission_raw_service{_mission_raw_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_MISSION_RAW_SERVER
+    LazyPlugin<MissionRawServer> _mission_raw_server_lazy_plugin{_mavsdk};
+    MissionRawServerServiceImpl<> _mission_raw_server_service{_mission_raw_server_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_MOCAP
+    LazyPlugin<Mocap> _mocap_lazy_plugin{_mavsdk};
+    MocapServiceImpl<> _mocap_service{_mocap_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_OFFBOARD
+    LazyPlugin<Offboard> _offboard_lazy_plugin{_mavsdk};
+    OffboardServiceImpl<> _offboard_service{_offboard_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_PARAM
+    LazyPlugin<Param> _param_lazy_plugin{_mavsdk};
+    ParamServiceImpl<> _param_service{_param_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_PARAM_SERVER
+    LazyPlugin<ParamServer> _param_server_lazy_plugin{_mavsdk};
+    ParamServerServiceImpl<> _param_server_service{_param_server_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_SERVER_UTILITY
+    LazyPlugin<ServerUtility> _server_utility_lazy_plugin{_mavsdk};
+    ServerUtilityServiceImpl<> _server_utility_service{_server_utility_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_SHELL
+    LazyPlugin<Shell> _shell_lazy_plugin{_mavsdk};
+    ShellServiceImpl<> _shell_service{_shell_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_TELEMETRY
+    LazyPlugin<Telemetry> _telemetry_lazy_plugin{_mavsdk};
+    TelemetryServiceImpl<> _telemetry_service{_telemetry_lazy_plugin};
+    // Not generated, so not part of for_each_service.
+    TelemetryBundleService<> _telemetry_bundle_service{_telemetry_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_TELEMETRY_SERVER
+    LazyPlugin<TelemetryServer> _telemetry_server_lazy_plugin{_mavsdk};
+    TelemetryServerServiceImpl<> _telemetry_server_service{_telemetry_server_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_TRACKING_SERVER
+    LazyPlugin<TrackingServer> _tracking_server_lazy_plugin{_mavsdk};
+    TrackingServerServiceImpl<> _tracking_server_service{_tracking_server_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_TUNE
+    LazyPlugin<Tune> _tune_lazy_plugin{_mavsdk};
+    TuneServiceImpl<> _tune_service{_tune_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_TRANSPONDER
+    LazyPlugin<Transponder> _transponder_lazy_plugin{_mavsdk};
+    TransponderServiceImpl<> _transponder_service{_transponder_lazy_plugin};
+#endif
+#ifdef MAVSDK_SERVER_WITH_MAVLINK_PASSTHROUGH
+    // Not generated, so not part of for_each_service.
+    LazyPlugin<MavlinkPassthrough> _mavlink_passthrough_lazy_plugin{_mavsdk};
+    MavlinkPassthroughService _mavlink_passthrough_service{_mavlink_passthrough_lazy_plugin};
+#endif
 
+    // Outlives the server, whose calls record into it.
+    ServerMetrics _metrics{};
     std::unique_ptr<grpc::Server> _server;
+#ifdef MAVSDK_SERVER_WITH_TELEMETRY
+    std::unique_ptr<ShmTelemetryPublisher> _shm_telemetry_publisher;
+#endif
 
     int _port{0};
     int _bound_port{0};
+
+    MetricsEndpoint _metrics_endpoint{};
+    int _metrics_port{-1};
 };
 
 } // namespace mavsdk_server
@@ -0,0 +1,96 @@
+#include "mavlink_frames_wire.h"
+#include "protobuf_wire.h"
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+using namespace protobuf_wire;
+
+bool decode_subscribe_frames_request(const std::string& data, SubscribeFramesRequest& request)
+{
+    request = {};
+
+    Reader reader{data};
+    while (!reader.done()) {
+        uint32_t field;
+        uint32_t wire_type;
+        if (!reader.read_tag(field, wire_type)) {
+            return false;
+        }
+
+        if (field == 1 && wire_type == Varint) {
+            uint32_t message_id;
+            if (!reader.read_uint32(message_id)) {
+                return false;
+            }
+            request.message_ids.push_back(message_id);
+
+        } else if (field == 1 && wire_type == LengthDelimited) {
+            const uint8_t* begin;
+            const uint8_t* end;
+            if (!reader.read_length_delimited(begin, end)) {
+                return false;
+            }
+            Reader packed{begin, end};
+            while (!packed.done()) {
+                uint32_t message_id;
+                if (!packed.read_uint32(message_id)) {
+                    return false;
+                }
+                request.message_ids.push_back(message_id);
+            }
+
+        } else if (field == 2 && wire_type == Varint) {
+            if (!reader.read_uint32(request.max_frames_per_response)) {
+                return false;
+            }
+
+        } else if (!reader.skip(wire_type)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void encode_frames_response(
+    const std::string* frames, std::size_t count, uint64_t dropped_frames, std::string& out)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        write_bytes_field(1, frames[i], out);
+    }
+    write_varint_field(2, dropped_frames, out);
+}
+
+bool decode_send_frames_request(const std::string& data, std::vector<std::string>& frames)
+{
+    Reader reader{data};
+    while (!reader.done()) {
+        uint32_t field;
+        uint32_t wire_type;
+        if (!reader.read_tag(field, wire_type)) {
+            return false;
+        }
+
+        if (field == 1 && wire_type == LengthDelimited) {
+            const uint8_t* begin;
+            const uint8_t* end;
+            if (!reader.read_length_delimited(begin, end)) {
+                return false;
+            }
+            frames.emplace_back(reinterpret_cast<const char*>(begin), end - begin);
+
+        } else if (!reader.skip(wire_type)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void encode_send_frames_response(uint64_t sent_frames, uint64_t rejected_frames, std::string& out)
+{
+    write_varint_field(1, sent_frames, out);
+    write_varint_field(2, rejected_frames, out);
+}
+
+} // namespace mavsdk_server
+} // namespace mavsdk
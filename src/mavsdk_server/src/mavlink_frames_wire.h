@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+// Protobuf wire format of the messages of the MavlinkPassthrough service (see
+// mavlink_passthrough_service.h), encoded by hand as the service is served as a
+// generic service:
+//
+//   message SubscribeFramesRequest {
+//       repeated uint32 message_ids = 1;
+//       uint32 max_frames_per_response = 2; // 0 for the default
+//   }
+//   message FramesResponse {
+//       repeated bytes frames = 1; // Serialized MAVLink frames, as on the wire
+//       uint64 dropped_frames = 2; // So far, as the client didn't keep up
+//   }
+//   message SendFramesRequest {
+//       repeated bytes frames = 1;
+//   }
+//   message SendFramesResponse {
+//       uint64 sent_frames = 1;
+//       uint64 rejected_frames = 2; // Not a valid frame, or failed to send
+//   }
+//
+// Decoding accepts packed and unpacked repeated fields and skips unknown ones,
+// like protobuf does.
+
+struct SubscribeFramesRequest {
+    std::vector<uint32_t> message_ids{};
+    uint32_t max_frames_per_response{0};
+};
+
+bool decode_subscribe_frames_request(const std::string& data, SubscribeFramesRequest& request);
+
+void encode_frames_response(
+    const std::string* frames, std::size_t count, uint64_t dropped_frames, std::string& out);
+
+bool decode_send_frames_request(const std::string& data, std::vector<std::string>& frames);
+
+void encode_send_frames_response(uint64_t sent_frames, uint64_t rejected_frames, std::string& out);
+
+} // namespace mavsdk_server
+} // namespace mavsdk
@@ -0,0 +1,552 @@
+#include "mavlink_passthrough_service.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "log.h"
+#include "mavlink_frames_wire.h"
+#include "system_routing.h"
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+namespace {
+
+// A subscriber without frames to write is still woken up this often, so it
+// notices a client which went away.
+constexpr auto idle_check_interval = std::chrono::seconds(1);
+
+std::string to_string(const grpc::ByteBuffer& buffer)
+{
+    std::vector<grpc::Slice> slices;
+    std::string result;
+    if (!buffer.Dump(&slices).ok()) {
+        return result;
+    }
+    for (const auto& slice : slices) {
+        result.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+    }
+    return result;
+}
+
+grpc::ByteBuffer to_byte_buffer(const std::string& data)
+{
+    grpc::Slice slice(data);
+    return grpc::ByteBuffer(&slice, 1);
+}
+
+// A frame needs to be complete and valid, with nothing after it.
+bool parse_frame(const std::string& frame, mavlink_message_t& message)
+{
+    mavlink_message_t buffer{};
+    mavlink_status_t status{};
+    mavlink_status_t message_status{};
+    for (std::size_t i = 0; i < frame.size(); ++i) {
+        const auto result = mavlink_frame_char_buffer(
+            &buffer, &status, static_cast<uint8_t>(frame[i]), &message, &message_status);
+        if (result == MAVLINK_FRAMING_OK) {
+            return i + 1 == frame.size();
+        }
+        if (result != MAVLINK_FRAMING_INCOMPLETE) {
+            return false;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+// One call, from being requested until it is finished, driven by the events of
+// the completion queue. It deletes itself once nothing is outstanding anymore.
+class MavlinkPassthroughService::Call {
+public:
+    enum class Op { Requested, Read, Write, Wake, Finish };
+
+    struct Event {
+        Call* call;
+        Op op;
+    };
+
+    explicit Call(MavlinkPassthroughService& service) : _service(service), _stream(&_context)
+    {
+        ++_service._calls;
+        ++_outstanding;
+        _service._generic_service.RequestCall(
+            &_context, &_stream, _service._queue.get(), _service._queue.get(), &_requested_event);
+    }
+
+    ~Call() { --_service._calls; }
+
+    // Non-copyable
+    Call(const Call&) = delete;
+    const Call& operator=(const Call&) = delete;
+
+    void proceed(Op op, bool ok)
+    {
+        --_outstanding;
+
+        switch (op) {
+            case Op::Requested:
+                if (!ok) {
+                    // The server is shutting down.
+                    _done = true;
+                    break;
+                }
+                new Call(_service);
+                start();
+                break;
+            case Op::Read:
+                on_read(ok);
+                break;
+            case Op::Write:
+                on_write(ok);
+                break;
+            case Op::Wake:
+                on_wake();
+                break;
+            case Op::Finish:
+                _done = true;
+                break;
+        }
+
+        if (_done && _outstanding == 0) {
+            delete this;
+        }
+    }
+
+    // Called with the subscribers' lock held, so the call is not gone meanwhile.
+    void queue_frame(uint32_t message_id, const std::string& frame)
+    {
+        if (_message_ids.count(message_id) == 0) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_finishing) {
+            return;
+        }
+        if (_frames.size() >= max_queued_frames) {
+            _frames.pop_front();
+            ++_dropped_frames;
+        }
+        _frames.push_back(frame);
+        wake_locked();
+    }
+
+    void wake()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        wake_locked();
+    }
+
+    [[nodiscard]] const std::set<uint32_t>& message_ids() const { return _message_ids; }
+
+private:
+    void start()
+    {
+        const auto& method = _context.method();
+        if (method != subscribe_frames_method && method != send_frames_method) {
+            finish(grpc::Status(grpc::StatusCode::UNIMPLEMENTED, "Unknown method " + method));
+            return;
+        }
+        _subscribe = method == subscribe_frames_method;
+
+        _plugin = _service._lazy_plugin.maybe_plugin(system_id_from_context(&_context));
+        if (_plugin == nullptr) {
+            finish(grpc::Status(grpc::StatusCode::UNAVAILABLE, "No system"));
+            return;
+        }
+
+        read();
+    }
+
+    void read()
+    {
+        ++_outstanding;
+        _stream.Read(&_read_buffer, &_read_event);
+    }
+
+    void on_read(bool ok)
+    {
+        if (_subscribe) {
+            on_subscribe_request(ok);
+        } else {
+            on_send_request(ok);
+        }
+    }
+
+    void on_subscribe_request(bool ok)
+    {
+        SubscribeFramesRequest request;
+        if (!ok || !decode_subscribe_frames_request(to_string(_read_buffer), request) ||
+            request.message_ids.empty()) {
+            finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "No message IDs requested"));
+            return;
+        }
+
+        _message_ids.insert(request.message_ids.begin(), request.message_ids.end());
+        _max_frames_per_response = request.max_frames_per_response > 0 ?
+                                       std::min<std::size_t>(
+                                           request.max_frames_per_response, max_queued_frames) :
+                                       default_max_frames_per_response;
+
+        _service.subscribe(*_plugin, *this);
+        _subscribed = true;
+        write_next();
+    }
+
+    void on_send_request(bool ok)
+    {
+        if (!ok) {
+            // The client is done sending.
+            std::string response;
+            encode_send_frames_response(_sent_frames, _rejected_frames, response);
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _finishing = true;
+            }
+            ++_outstanding;
+            _stream.WriteAndFinish(
+                to_byte_buffer(response), grpc::WriteOptions(), grpc::Status::OK, &_finish_event);
+            return;
+        }
+
+        _frames_to_send.clear();
+        if (!decode_send_frames_request(to_string(_read_buffer), _frames_to_send)) {
+            finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Malformed request"));
+            return;
+        }
+
+        _messages.clear();
+        for (const auto& frame : _frames_to_send) {
+            mavlink_message_t message;
+            if (parse_frame(frame, message)) {
+                _messages.push_back(message);
+            } else {
+                ++_rejected_frames;
+            }
+        }
+
+        if (!_messages.empty()) {
+            const std::size_t num_messages = _messages.size();
+            if (_plugin->send_messages(_messages) == MavlinkPassthrough::Result::Success) {
+                // Dropped by an outgoing intercept, as if sent.
+                _sent_frames += num_messages;
+            } else {
+                _rejected_frames += num_messages;
+            }
+        }
+
+        read();
+    }
+
+    void write_next()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_write_in_flight || _finishing) {
+            return;
+        }
+
+        if (_frames.empty()) {
+            arm_alarm_locked();
+            return;
+        }
+
+        const std::size_t num_frames = std::min(_frames.size(), _max_frames_per_response);
+        _batch.resize(num_frames);
+        for (std::size_t i = 0; i < num_frames; ++i) {
+            std::swap(_batch[i], _frames.front());
+            _frames.pop_front();
+        }
+
+        _response.clear();
+        encode_frames_response(_batch.data(), _batch.size(), _dropped_frames, _response);
+
+        _write_in_flight = true;
+        ++_outstanding;
+        _stream.Write(to_byte_buffer(_response), &_write_event);
+    }
+
+    void on_write(bool ok)
+    {
+        bool finish_pending;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _write_in_flight = false;
+            finish_pending = _finish_pending;
+        }
+
+        if (finish_pending) {
+            start_finish();
+        } else if (!ok) {
+            // The client went away.
+            finish(grpc::Status::CANCELLED);
+        } else {
+            write_next();
+        }
+    }
+
+    void on_wake()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _alarm_armed = false;
+            if (_finishing) {
+                return;
+            }
+        }
+
+        if (_context.IsCancelled() || _service._stopping) {
+            finish(grpc::Status::CANCELLED);
+        } else {
+            write_next();
+        }
+    }
+
+    void arm_alarm_locked()
+    {
+        if (_alarm_armed || _service._stopping) {
+            return;
+        }
+        _alarm_armed = true;
+        ++_outstanding;
+        _alarm.Set(
+            _service._queue.get(),
+            std::chrono::system_clock::now() + idle_check_interval,
+            &_wake_event);
+    }
+
+    void wake_locked()
+    {
+        // Cancelling gets the alarm's event delivered right away.
+        if (_alarm_armed) {
+            _alarm.Cancel();
+        }
+    }
+
+    void finish(const grpc::Status& status)
+    {
+        if (_subscribed) {
+            _service.unsubscribe(*_plugin, *this);
+            _subscribed = false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_finishing) {
+                return;
+            }
+            _finishing = true;
+            _status = status;
+            wake_locked();
+
+            // Finishing has to wait for the write.
+            if (_write_in_flight) {
+                _finish_pending = true;
+                return;
+            }
+        }
+        start_finish();
+    }
+
+    void start_finish()
+    {
+        ++_outstanding;
+        _stream.Finish(_status, &_finish_event);
+    }
+
+    MavlinkPassthroughService& _service;
+    grpc::GenericServerContext _context{};
+    grpc::GenericServerAsyncReaderWriter _stream;
+    grpc::ByteBuffer _read_buffer{};
+    grpc::Alarm _alarm{};
+
+    Event _requested_event{this, Op::Requested};
+    Event _read_event{this, Op::Read};
+    Event _write_event{this, Op::Write};
+    Event _wake_event{this, Op::Wake};
+    Event _finish_event{this, Op::Finish};
+
+    // Only used on the service's thread.
+    unsigned _outstanding{0};
+    bool _done{false};
+    bool _subscribe{false};
+    bool _subscribed{false};
+    MavlinkPassthrough* _plugin{nullptr};
+    grpc::Status _status{};
+
+    // Subscribe
+    std::set<uint32_t> _message_ids{};
+    std::size_t _max_frames_per_response{default_max_frames_per_response};
+    std::vector<std::string> _batch{};
+    std::string _response{};
+
+    // Send
+    std::vector<std::string> _frames_to_send{};
+    std::vector<mavlink_message_t> _messages{};
+    uint64_t _sent_frames{0};
+    uint64_t _rejected_frames{0};
+
+    // Shared with the callback thread queueing frames.
+    std::mutex _mutex{};
+    std::deque<std::string> _frames{};
+    uint64_t _dropped_frames{0};
+    bool _write_in_flight{false};
+    bool _alarm_armed{false};
+    bool _finishing{false};
+    bool _finish_pending{false};
+};
+
+MavlinkPassthroughService::MavlinkPassthroughService(LazyPlugin<MavlinkPassthrough>& lazy_plugin) :
+    _lazy_plugin(lazy_plugin)
+{}
+
+MavlinkPassthroughService::~MavlinkPassthroughService()
+{
+    stop();
+    shutdown();
+}
+
+void MavlinkPassthroughService::register_with(grpc::ServerBuilder& builder)
+{
+    builder.RegisterAsyncGenericService(&_generic_service);
+    _queue = builder.AddCompletionQueue();
+}
+
+void MavlinkPassthroughService::start()
+{
+    if (_queue == nullptr || _thread.joinable()) {
+        return;
+    }
+
+    new Call(*this);
+    _thread = std::thread(&MavlinkPassthroughService::run, this);
+}
+
+void MavlinkPassthroughService::stop()
+{
+    _stopping = true;
+
+    std::lock_guard<std::mutex> lock(_subscribers_mutex);
+    for (auto& entry : _subscribers) {
+        for (auto* call : entry.second.calls) {
+            call->wake();
+        }
+    }
+}
+
+void MavlinkPassthroughService::shutdown()
+{
+    _stopping = true;
+
+    if (_queue == nullptr) {
+        return;
+    }
+
+    // The calls were cancelled by the server, they need to have ended before
+    // the queue is shut down, as they might still arm their alarms.
+    if (_thread.joinable()) {
+        while (_calls > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    _queue->Shutdown();
+    if (_thread.joinable()) {
+        _thread.join();
+    } else {
+        void* tag;
+        bool ok;
+        while (_queue->Next(&tag, &ok)) {}
+    }
+    _queue.reset();
+}
+
+void MavlinkPassthroughService::run()
+{
+    void* tag;
+    bool ok;
+    while (_queue->Next(&tag, &ok)) {
+        auto* event = static_cast<Call::Event*>(tag);
+        event->call->proceed(event->op, ok);
+    }
+}
+
+void MavlinkPassthroughService::subscribe(MavlinkPassthrough& plugin, Call& call)
+{
+    std::lock_guard<std::mutex> lock(_subscribers_mutex);
+    auto& subscribers = _subscribers[&plugin];
+    subscribers.calls.insert(&call);
+    update_subscription_locked(plugin, subscribers);
+}
+
+void MavlinkPassthroughService::unsubscribe(MavlinkPassthrough& plugin, Call& call)
+{
+    std::lock_guard<std::mutex> lock(_subscribers_mutex);
+    const auto it = _subscribers.find(&plugin);
+    if (it == _subscribers.end()) {
+        return;
+    }
+
+    it->second.calls.erase(&call);
+    update_subscription_locked(plugin, it->second);
+    if (it->second.calls.empty()) {
+        _subscribers.erase(it);
+    }
+}
+
+void MavlinkPassthroughService::update_subscription_locked(
+    MavlinkPassthrough& plugin, Subscribers& subscribers)
+{
+    std::set<uint16_t> wanted;
+    for (const auto* call : subscribers.calls) {
+        for (const auto message_id : call->message_ids()) {
+            if (message_id <= UINT16_MAX) {
+                wanted.insert(static_cast<uint16_t>(message_id));
+            }
+        }
+    }
+
+    std::vector<uint16_t> message_ids(wanted.begin(), wanted.end());
+    if (message_ids == subscribers.message_ids) {
+        return;
+    }
+    subscribers.message_ids = message_ids;
+
+    // Messages the plugin had queued for the previous subscription are
+    // dropped, so a subscriber coming or going can cost the others a few.
+    if (message_ids.empty()) {
+        plugin.subscribe_messages_async({}, nullptr);
+    } else {
+        plugin.subscribe_messages_async(
+            message_ids,
+            [this, plugin = &plugin](const std::vector<MavlinkPassthrough::MessagePtr>& messages) {
+                on_messages(plugin, messages);
+            });
+    }
+}
+
+void MavlinkPassthroughService::on_messages(
+    MavlinkPassthrough* plugin, const std::vector<MavlinkPassthrough::MessagePtr>& messages)
+{
+    std::lock_guard<std::mutex> lock(_subscribers_mutex);
+    const auto it = _subscribers.find(plugin);
+    if (it == _subscribers.end()) {
+        return;
+    }
+
+    // Serialized once, however many subscribers there are.
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    std::string frame;
+    for (const auto& message : messages) {
+        const auto length = mavlink_msg_to_send_buffer(buffer, message.get());
+        frame.assign(reinterpret_cast<const char*>(buffer), length);
+        for (auto* call : it->second.calls) {
+            call->queue_frame(message->msgid, frame);
+        }
+    }
+}
+
+} // namespace mavsdk_server
+} // namespace mavsdk
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <grpcpp/alarm.h>
+#include <grpcpp/generic/async_generic_service.h>
+#include <grpcpp/server_builder.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lazy_plugin.h"
+#include "mavsdk.h"
+#include "plugins/mavlink_passthrough/mavlink_passthrough.h"
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+// Raw MAVLink frames for clients which need messages no other service covers,
+// without them running a second MAVLink stack next to the server:
+//
+//   service MavlinkPassthroughService {
+//       rpc SubscribeFrames(SubscribeFramesRequest) returns (stream FramesResponse);
+//       rpc SendFrames(stream SendFramesRequest) returns (SendFramesResponse);
+//   }
+//
+// with the messages in mavlink_frames_wire.h, in package mavsdk.rpc.mavlink_passthrough.
+// Clients generate their stubs from that, the server doesn't need generated code
+// for it: calls are taken from a generic service, which gets every call no other
+// service handles, and are served on a thread of this service.
+//
+// Received frames are batched, several frames per response. Frames are queued
+// per subscriber, one which doesn't keep up loses the oldest ones, counted in
+// dropped_frames of the responses.
+class MavlinkPassthroughService {
+public:
+    static constexpr auto subscribe_frames_method =
+        "/mavsdk.rpc.mavlink_passthrough.MavlinkPassthroughService/SubscribeFrames";
+    static constexpr auto send_frames_method =
+        "/mavsdk.rpc.mavlink_passthrough.MavlinkPassthroughService/SendFrames";
+
+    static constexpr std::size_t default_max_frames_per_response = 64;
+    static constexpr std::size_t max_queued_frames = 1024;
+
+    explicit MavlinkPassthroughService(LazyPlugin<MavlinkPassthrough>& lazy_plugin);
+    ~MavlinkPassthroughService();
+
+    // Needs to be called before the server is built.
+    void register_with(grpc::ServerBuilder& builder);
+
+    // Once the server is started.
+    void start();
+
+    // Before the server is shut down, so idle subscriptions end right away.
+    void stop();
+
+    // Once the server is shut down, waits for the calls to end.
+    void shutdown();
+
+    // Non-copyable
+    MavlinkPassthroughService(const MavlinkPassthroughService&) = delete;
+    const MavlinkPassthroughService& operator=(const MavlinkPassthroughService&) = delete;
+
+private:
+    class Call;
+
+    // All subscribers of a system share the plugin's subscription, which is
+    // for all message IDs any of them wants.
+    struct Subscribers {
+        std::set<Call*> calls{};
+        std::vector<uint16_t> message_ids{};
+    };
+
+    void run();
+    void subscribe(MavlinkPassthrough& plugin, Call& call);
+    void unsubscribe(MavlinkPassthrough& plugin, Call& call);
+    void update_subscription_locked(MavlinkPassthrough& plugin, Subscribers& subscribers);
+    void on_messages(
+        MavlinkPassthrough* plugin, const std::vector<MavlinkPassthrough::MessagePtr>& messages);
+
+    LazyPlugin<MavlinkPassthrough>& _lazy_plugin;
+    grpc::AsyncGenericService _generic_service{};
+    std::unique_ptr<grpc::ServerCompletionQueue> _queue{};
+    std::thread _thread{};
+    std::atomic<bool> _stopping{false};
+    std::atomic<unsigned> _calls{0};
+
+    std::mutex _subscribers_mutex{};
+    std::map<MavlinkPassthrough*, Subscribers> _subscribers{};
+};
+
+} // namespace mavsdk_server
+} // namespace mavsdk
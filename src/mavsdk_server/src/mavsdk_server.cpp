@@ -1,10 +1,14 @@
 #include "mavsdk_server.h"
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <string>
 
 #include "connection_initiator.h"
 #include "mavsdk.h"
 #include "grpc_server.h"
+#include "log.h"
 
 using namespace mavsdk::mavsdk_server;
 
@@ -15,19 +19,42 @@ public:
 
     bool connect(const std::string& connection_url)
     {
-        _connection_initiator.start(_mavsdk, connection_url);
-        return _connection_initiator.wait();
+        if (!_connection_initiator.start(_mavsdk, connection_url)) {
+            return false;
+        }
+        if (!_connection_initiator.wait()) {
+            return false;
+        }
+
+        LogInfo() << "System discovered after " << ms_since_start() << " ms";
+        _is_connected = true;
+        maybe_start_shm_telemetry();
+        return true;
     }
 
+    // The server can be started before a system is discovered. Plugins are only
+    // created on the first call that needs them, and until then calls answer
+    // with NoSystem while the core service reports the connection state.
     int startGrpcServer(const int port)
     {
         _server = std::make_unique<GrpcServer>(_mavsdk);
         _server->set_port(port);
+        _server->set_conflate_telemetry(_conflate_telemetry);
+        _server->set_metrics_port(_metrics_port);
         _grpc_port = _server->run();
+        if (_grpc_port != 0) {
+            LogInfo() << "gRPC server up after " << ms_since_start() << " ms";
+        }
+        maybe_start_shm_telemetry();
         return _grpc_port;
     }
 
-    void wait() { _server->wait(); }
+    void wait()
+    {
+        if (_server != nullptr) {
+            _server->wait();
+        }
+    }
 
     void stop()
     {
@@ -45,11 +72,46 @@ public:
         _mavsdk.set_configuration(mavsdk::Mavsdk::Configuration{system_id, component_id, false});
     }
 
+    void setConflateTelemetry(bool conflate) { _conflate_telemetry = conflate; }
+
+    void setShmTelemetry(const std::string& name) { _shm_telemetry_name = name; }
+
+    void setMetricsPort(int port) { _metrics_port = port; }
+
+    std::shared_ptr<mavsdk::System> firstSystem()
+    {
+        auto systems = _mavsdk.systems();
+        return systems.empty() ? nullptr : systems.front();
+    }
+
 private:
+    long long ms_since_start() const
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - _start_time)
+            .count();
+    }
+
+    // Needs both a running server and a discovered system, whichever comes last.
+    void maybe_start_shm_telemetry()
+    {
+        if (_shm_telemetry_name.empty() || _server == nullptr || !_is_connected) {
+            return;
+        }
+        if (!_server->start_shm_telemetry(_shm_telemetry_name)) {
+            LogErr() << "Shared-memory telemetry disabled";
+        }
+    }
+
+    const std::chrono::steady_clock::time_point _start_time{std::chrono::steady_clock::now()};
     mavsdk::Mavsdk _mavsdk;
     ConnectionInitiator<mavsdk::Mavsdk> _connection_initiator;
     std::unique_ptr<GrpcServer> _server;
-    int _grpc_port;
+    std::atomic<int> _grpc_port{0};
+    bool _is_connected{false};
+    bool _conflate_telemetry{false};
+    std::string _shm_telemetry_name{};
+    int _metrics_port{-1};
 };
 
 MavsdkServer::MavsdkServer() : _impl(std::make_unique<Impl>()) {}
@@ -84,3 +146,23 @@ void MavsdkServer::setMavlinkIds(uint8_t system_id, uint8_t component_id)
 {
     _impl->setMavlinkIds(system_id, component_id);
 }
+
+void MavsdkServer::setConflateTelemetry(bool conflate)
+{
+    _impl->setConflateTelemetry(conflate);
+}
+
+void MavsdkServer::setShmTelemetry(const std::string& name)
+{
+    _impl->setShmTelemetry(name);
+}
+
+void MavsdkServer::setMetricsPort(int port)
+{
+    _impl->setMetricsPort(port);
+}
+
+std::shared_ptr<mavsdk::System> MavsdkServer::firstSystem()
+{
+    return _impl->firstSystem();
+}
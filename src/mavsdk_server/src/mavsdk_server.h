@@ -3,6 +3,10 @@
 #include <memory>
 #include <string>
 
+namespace mavsdk {
+class System;
+}
+
 // This is a struct because it is also exported to the C interface.
 struct MavsdkServer {
 public:
@@ -17,6 +21,10 @@ public:
     void stop();
     int getPort();
     void setMavlinkIds(uint8_t system_id, uint8_t component_id);
+    void setConflateTelemetry(bool conflate);
+    void setShmTelemetry(const std::string& name);
+    void setMetricsPort(int port);
+    std::shared_ptr<mavsdk::System> firstSystem();
 
 private:
     class Impl;
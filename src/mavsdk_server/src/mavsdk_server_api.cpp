@@ -10,20 +10,27 @@ void mavsdk_server_init(MavsdkServer** mavsdk_server)
 int mavsdk_server_run(
     MavsdkServer* mavsdk_server, const char* system_address, const int mavsdk_server_port)
 {
-    if (!mavsdk_server->connect(std::string(system_address))) {
-        // Connection was cancelled
-        return false;
-    }
-
+    // Bring the port up first, so clients can connect and follow discovery through
+    // the core service instead of waiting for the system to appear.
     auto grpc_port = mavsdk_server->startGrpcServer(mavsdk_server_port);
     if (grpc_port == 0) {
         // Server failed to start
         return false;
     }
 
+    if (!mavsdk_server->connect(std::string(system_address))) {
+        // Connection failed or was cancelled
+        return false;
+    }
+
     return true;
 }
 
+int mavsdk_server_connect(MavsdkServer* mavsdk_server, const char* system_address)
+{
+    return mavsdk_server->connect(std::string(system_address));
+}
+
 int mavsdk_server_run_with_mavlink_ids(
     MavsdkServer* mavsdk_server,
     const char* system_address,
@@ -35,6 +42,21 @@ int mavsdk_server_run_with_mavlink_ids(
     return mavsdk_server_run(mavsdk_server, system_address, mavsdk_server_port);
 }
 
+void mavsdk_server_set_conflate_telemetry(MavsdkServer* mavsdk_server, const int conflate)
+{
+    mavsdk_server->setConflateTelemetry(conflate != 0);
+}
+
+void mavsdk_server_set_shm_telemetry(MavsdkServer* mavsdk_server, const char* shm_name)
+{
+    mavsdk_server->setShmTelemetry(shm_name != nullptr ? std::string(shm_name) : std::string());
+}
+
+void mavsdk_server_set_metrics_port(MavsdkServer* mavsdk_server, const int port)
+{
+    mavsdk_server->setMetricsPort(port);
+}
+
 int mavsdk_server_get_port(MavsdkServer* mavsdk_server)
 {
     return mavsdk_server->getPort();
@@ -20,9 +20,17 @@ struct MavsdkServer;
 
 DLLExport void mavsdk_server_init(struct MavsdkServer** mavsdk_server);
 
+// Starts the gRPC server and then blocks until the first system is discovered.
+// The port is already served, and mavsdk_server_get_port valid, while waiting.
 DLLExport int mavsdk_server_run(
     struct MavsdkServer* mavsdk_server, const char* system_address, const int mavsdk_server_port);
 
+// Only connects and blocks until the first system is discovered, without any
+// gRPC server. The plugins are then used in-process through the
+// <plugin>_c_api.h headers, rendered from templates/c_api_h and c_api_cpp.
+// tools/generate_from_protos.sh doesn't render them yet.
+DLLExport int mavsdk_server_connect(struct MavsdkServer* mavsdk_server, const char* system_address);
+
 DLLExport int mavsdk_server_run_with_mavlink_ids(
     struct MavsdkServer* mavsdk_server,
     const char* system_address,
@@ -30,6 +38,22 @@ DLLExport int mavsdk_server_run_with_mavlink_ids(
     const uint8_t system_id,
     const uint8_t component_id);
 
+// Only deliver the latest sample on telemetry streams to clients that read slower
+// than the vehicle publishes. Must be called before mavsdk_server_run.
+DLLExport void
+mavsdk_server_set_conflate_telemetry(struct MavsdkServer* mavsdk_server, const int conflate);
+
+// Also publish IMU and odometry into the named POSIX shared-memory segment, e.g.
+// "/mavsdk_telemetry", for readers on the same host. The layout is documented in
+// shm_telemetry_layout.h. Must be called before mavsdk_server_run.
+DLLExport void
+mavsdk_server_set_shm_telemetry(struct MavsdkServer* mavsdk_server, const char* shm_name);
+
+// Serve Prometheus metrics of the calls, streams and MAVSDK queues on
+// http://<host>:<port>/metrics, 0 to pick a free port. Off by default, since it
+// adds a little work to every call. Must be called before mavsdk_server_run.
+DLLExport void mavsdk_server_set_metrics_port(struct MavsdkServer* mavsdk_server, const int port);
+
 DLLExport int mavsdk_server_get_port(struct MavsdkServer* mavsdk_server);
 
 DLLExport void mavsdk_server_attach(struct MavsdkServer* mavsdk_server);
@@ -19,6 +19,9 @@ int main(int argc, char** argv)
     int mavsdk_server_port = default_mavsdk_server_port;
     int mavsdk_sysid = default_sysid;
     int mavsdk_compid = default_compid;
+    bool conflate_telemetry = false;
+    std::string shm_telemetry_name;
+    int metrics_port = -1;
 
     for (int i = 1; i < argc; i++) {
         const std::string current_arg = argv[i];
@@ -81,6 +84,31 @@ int main(int argc, char** argv)
                 usage(argv[0]);
                 return 1;
             }
+        } else if (current_arg == "--conflate-telemetry") {
+            conflate_telemetry = true;
+        } else if (current_arg == "--shm-telemetry") {
+            if (argc <= i + 1) {
+                usage(argv[0]);
+                return 1;
+            }
+
+            shm_telemetry_name = argv[i + 1];
+            i++;
+        } else if (current_arg == "--metrics-port") {
+            if (argc <= i + 1) {
+                usage(argv[0]);
+                return 1;
+            }
+
+            const std::string port(argv[i + 1]);
+            i++;
+
+            if (!is_integer(port)) {
+                usage(argv[0]);
+                return 1;
+            }
+
+            metrics_port = std::stoi(port);
         } else {
             connection_url = current_arg;
         }
@@ -88,6 +116,11 @@ int main(int argc, char** argv)
 
     MavsdkServer* mavsdk_server;
     mavsdk_server_init(&mavsdk_server);
+    mavsdk_server_set_conflate_telemetry(mavsdk_server, conflate_telemetry);
+    mavsdk_server_set_shm_telemetry(mavsdk_server, shm_telemetry_name.c_str());
+    if (metrics_port >= 0) {
+        mavsdk_server_set_metrics_port(mavsdk_server, metrics_port);
+    }
     const auto is_started = mavsdk_server_run_with_mavlink_ids(
         mavsdk_server,
         connection_url.c_str(),
@@ -115,6 +148,7 @@ void usage(const char* bin_name)
               << "  Serial: serial:///path/to/serial/dev[:baudrate]" << '\n'
               << "  UDP:    udp://[bind_host][:bind_port]" << '\n'
               << "  TCP:    tcp://[server_host][:server_port]" << '\n'
+              << "  TCP server: tcpin://[bind_host][:bind_port]" << '\n'
               << '\n'
               << "For example to connect to SITL use: udp://:14540" << '\n'
               << '\n'
@@ -126,7 +160,13 @@ void usage(const char* bin_name)
               << "  --sysid     : set the MAVLink system ID of the MAVSDK server itself,\n"
               << "                (default is " << default_sysid << ", range 1..255)\n"
               << "  --compid    : set the MAVLink component ID of the MAVSDK server itself,\n"
-              << "                (default is " << default_compid << ", range 1..255)\n";
+              << "                (default is " << default_compid << ", range 1..255)\n"
+              << "  --conflate-telemetry : only send the latest telemetry sample to\n"
+              << "                clients reading slower than it is published\n"
+              << "  --shm-telemetry <name> : also publish IMU and odometry into the\n"
+              << "                POSIX shared-memory segment <name>, e.g. /mavsdk_telemetry\n"
+              << "  --metrics-port <port> : serve Prometheus metrics on\n"
+              << "                http://0.0.0.0:<port>/metrics\n";
 }
 
 bool is_integer(const std::string& tested_integer)
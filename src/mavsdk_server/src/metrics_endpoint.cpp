@@ -0,0 +1,183 @@
+#include "metrics_endpoint.h"
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#if !defined(WINDOWS)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#include "log.h"
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+MetricsEndpoint::~MetricsEndpoint()
+{
+    stop();
+}
+
+bool MetricsEndpoint::start(int port, Render render)
+{
+#if defined(WINDOWS)
+    (void)port;
+    (void)render;
+    LogErr() << "Metrics endpoint is not supported on Windows";
+    return false;
+#else
+    stop();
+
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        LogErr() << "Could not create metrics socket: " << strerror(errno);
+        return false;
+    }
+
+    const int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+        LogErr() << "Could not listen for metrics on port " << port << ": " << strerror(errno);
+        close(fd);
+        return false;
+    }
+
+    socklen_t addr_len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &addr_len);
+
+    _render = std::move(render);
+    _listen_fd = fd;
+    _port = ntohs(addr.sin_port);
+    _should_exit = false;
+    if (pipe(_wakeup_pipe) != 0) {
+        _wakeup_pipe[0] = -1;
+        _wakeup_pipe[1] = -1;
+    }
+    _thread = std::thread(&MetricsEndpoint::run, this);
+
+    LogInfo() << "Metrics available on http://0.0.0.0:" << _port << "/metrics";
+    return true;
+#endif
+}
+
+void MetricsEndpoint::stop()
+{
+#if !defined(WINDOWS)
+    _should_exit = true;
+    if (_wakeup_pipe[1] >= 0) {
+        const char wakeup = 0;
+        const auto written = write(_wakeup_pipe[1], &wakeup, sizeof(wakeup));
+        (void)written;
+    }
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    if (_listen_fd >= 0) {
+        close(_listen_fd);
+        _listen_fd = -1;
+    }
+    for (auto& fd : _wakeup_pipe) {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+#endif
+}
+
+void MetricsEndpoint::run()
+{
+#if !defined(WINDOWS)
+    while (!_should_exit) {
+        // stop() writes to the pipe. Without one, wake up regularly instead.
+        pollfd pfds[2]{{_listen_fd, POLLIN, 0}, {_wakeup_pipe[0], POLLIN, 0}};
+        const bool has_pipe = _wakeup_pipe[0] >= 0;
+        if (poll(pfds, has_pipe ? 2 : 1, has_pipe ? -1 : 200) <= 0 || _should_exit) {
+            continue;
+        }
+        if ((pfds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        const int fd = accept(_listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        handle(fd);
+        close(fd);
+    }
+#endif
+}
+
+void MetricsEndpoint::handle(int fd)
+{
+#if defined(WINDOWS)
+    (void)fd;
+#else
+    // A stuck client must not block the endpoint.
+    timeval timeout{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // A client hanging up early must not kill the server with SIGPIPE.
+#if defined(MSG_NOSIGNAL)
+    const int send_flags = MSG_NOSIGNAL;
+#else
+    const int send_flags = 0;
+    const int no_sigpipe = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        const auto received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<std::size_t>(received));
+    }
+
+    std::string status;
+    std::string body;
+    if (request.rfind("GET /metrics ", 0) == 0 || request.rfind("GET /metrics?", 0) == 0) {
+        status = "200 OK";
+        body = _render();
+    } else {
+        status = "404 Not Found";
+        body = "Not found, try /metrics\n";
+    }
+
+    const std::string response = "HTTP/1.0 " + status +
+                                 "\r\n"
+                                 "Content-Type: text/plain; version=0.0.4\r\n"
+                                 "Content-Length: " +
+                                 std::to_string(body.size()) +
+                                 "\r\n"
+                                 "Connection: close\r\n\r\n" +
+                                 body;
+
+    std::size_t sent = 0;
+    while (sent < response.size()) {
+        const auto result = send(fd, response.data() + sent, response.size() - sent, send_flags);
+        if (result <= 0) {
+            break;
+        }
+        sent += static_cast<std::size_t>(result);
+    }
+#endif
+}
+
+} // namespace mavsdk_server
+} // namespace mavsdk
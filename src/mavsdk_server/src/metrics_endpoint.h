@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+// Minimal HTTP endpoint answering "GET /metrics" with the Prometheus text
+// format, so the server can be scraped without any extra dependency.
+//
+// Requests are answered one at a time on a thread of its own, which is plenty
+// for a scraper polling every few seconds.
+class MetricsEndpoint {
+public:
+    using Render = std::function<std::string()>;
+
+    MetricsEndpoint() = default;
+    ~MetricsEndpoint();
+
+    // Non-copyable
+    MetricsEndpoint(const MetricsEndpoint&) = delete;
+    const MetricsEndpoint& operator=(const MetricsEndpoint&) = delete;
+
+    // Port 0 picks a free port, see port().
+    bool start(int port, Render render);
+    void stop();
+
+    int port() const { return _port; }
+
+private:
+    void run();
+    void handle(int fd);
+
+    Render _render{};
+    int _listen_fd{-1};
+    int _port{0};
+    int _wakeup_pipe[2]{-1, -1};
+    std::atomic<bool> _should_exit{false};
+    std::thread _thread{};
+};
+
+} // namespace mavsdk_server
+} // namespace mavsdk
@@ -8,11 +8,14 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -153,11 +156,13 @@ public:
     }
 
     grpc::Status
-    Arm(grpc::ServerContext* /* context */,
+    Arm(grpc::ServerContext* context,
         const rpc::action::ArmRequest* /* request */,
         rpc::action::ArmResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -166,7 +171,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->arm();
+        auto result = plugin->arm();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -176,11 +181,13 @@ public:
     }
 
     grpc::Status Disarm(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::DisarmRequest* /* request */,
         rpc::action::DisarmResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -189,7 +196,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->disarm();
+        auto result = plugin->disarm();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -199,11 +206,13 @@ public:
     }
 
     grpc::Status Takeoff(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::TakeoffRequest* /* request */,
         rpc::action::TakeoffResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -212,7 +221,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->takeoff();
+        auto result = plugin->takeoff();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -222,11 +231,13 @@ public:
     }
 
     grpc::Status Land(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::LandRequest* /* request */,
         rpc::action::LandResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -235,7 +246,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->land();
+        auto result = plugin->land();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -245,11 +256,13 @@ public:
     }
 
     grpc::Status Reboot(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::RebootRequest* /* request */,
         rpc::action::RebootResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -258,7 +271,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->reboot();
+        auto result = plugin->reboot();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -268,11 +281,13 @@ public:
     }
 
     grpc::Status Shutdown(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::ShutdownRequest* /* request */,
         rpc::action::ShutdownResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -281,7 +296,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->shutdown();
+        auto result = plugin->shutdown();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -291,11 +306,13 @@ public:
     }
 
     grpc::Status Terminate(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::TerminateRequest* /* request */,
         rpc::action::TerminateResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -304,7 +321,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->terminate();
+        auto result = plugin->terminate();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -314,11 +331,13 @@ public:
     }
 
     grpc::Status Kill(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::KillRequest* /* request */,
         rpc::action::KillResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -327,7 +346,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->kill();
+        auto result = plugin->kill();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -337,11 +356,13 @@ public:
     }
 
     grpc::Status ReturnToLaunch(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::ReturnToLaunchRequest* /* request */,
         rpc::action::ReturnToLaunchResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -350,7 +371,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->return_to_launch();
+        auto result = plugin->return_to_launch();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -360,11 +381,13 @@ public:
     }
 
     grpc::Status GotoLocation(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::GotoLocationRequest* request,
         rpc::action::GotoLocationResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -378,7 +401,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->goto_location(
+        auto result = plugin->goto_location(
             request->latitude_deg(),
             request->longitude_deg(),
             request->absolute_altitude_m(),
@@ -392,11 +415,13 @@ public:
     }
 
     grpc::Status DoOrbit(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::DoOrbitRequest* request,
         rpc::action::DoOrbitResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -410,7 +435,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->do_orbit(
+        auto result = plugin->do_orbit(
             request->radius_m(),
             request->velocity_ms(),
             translateFromRpcOrbitYawBehavior(request->yaw_behavior()),
@@ -426,11 +451,13 @@ public:
     }
 
     grpc::Status Hold(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::HoldRequest* /* request */,
         rpc::action::HoldResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -439,7 +466,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->hold();
+        auto result = plugin->hold();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -449,11 +476,13 @@ public:
     }
 
     grpc::Status SetActuator(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::SetActuatorRequest* request,
         rpc::action::SetActuatorResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -467,7 +496,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_actuator(request->index(), request->value());
+        auto result = plugin->set_actuator(request->index(), request->value());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -477,11 +506,13 @@ public:
     }
 
     grpc::Status TransitionToFixedwing(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::TransitionToFixedwingRequest* /* request */,
         rpc::action::TransitionToFixedwingResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -490,7 +521,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->transition_to_fixedwing();
+        auto result = plugin->transition_to_fixedwing();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -500,11 +531,13 @@ public:
     }
 
     grpc::Status TransitionToMulticopter(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::TransitionToMulticopterRequest* /* request */,
         rpc::action::TransitionToMulticopterResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -513,7 +546,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->transition_to_multicopter();
+        auto result = plugin->transition_to_multicopter();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -523,11 +556,13 @@ public:
     }
 
     grpc::Status GetTakeoffAltitude(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::GetTakeoffAltitudeRequest* /* request */,
         rpc::action::GetTakeoffAltitudeResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -536,7 +571,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_takeoff_altitude();
+        auto result = plugin->get_takeoff_altitude();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -548,11 +583,13 @@ public:
     }
 
     grpc::Status SetTakeoffAltitude(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::SetTakeoffAltitudeRequest* request,
         rpc::action::SetTakeoffAltitudeResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -566,7 +603,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_takeoff_altitude(request->altitude());
+        auto result = plugin->set_takeoff_altitude(request->altitude());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -576,11 +613,13 @@ public:
     }
 
     grpc::Status GetMaximumSpeed(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::GetMaximumSpeedRequest* /* request */,
         rpc::action::GetMaximumSpeedResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -589,7 +628,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_maximum_speed();
+        auto result = plugin->get_maximum_speed();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -601,11 +640,13 @@ public:
     }
 
     grpc::Status SetMaximumSpeed(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::SetMaximumSpeedRequest* request,
         rpc::action::SetMaximumSpeedResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -619,7 +660,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_maximum_speed(request->speed());
+        auto result = plugin->set_maximum_speed(request->speed());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -629,11 +670,13 @@ public:
     }
 
     grpc::Status GetReturnToLaunchAltitude(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::GetReturnToLaunchAltitudeRequest* /* request */,
         rpc::action::GetReturnToLaunchAltitudeResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -642,7 +685,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_return_to_launch_altitude();
+        auto result = plugin->get_return_to_launch_altitude();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -654,11 +697,13 @@ public:
     }
 
     grpc::Status SetReturnToLaunchAltitude(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::SetReturnToLaunchAltitudeRequest* request,
         rpc::action::SetReturnToLaunchAltitudeResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -672,8 +717,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_return_to_launch_altitude(
-            request->relative_altitude_m());
+        auto result = plugin->set_return_to_launch_altitude(request->relative_altitude_m());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -683,11 +727,13 @@ public:
     }
 
     grpc::Status SetCurrentSpeed(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action::SetCurrentSpeedRequest* request,
         rpc::action::SetCurrentSpeedResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Action::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -701,7 +747,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_current_speed(request->speed_m_s());
+        auto result = plugin->set_current_speed(request->speed_m_s());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -713,32 +759,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"action", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -747,7 +809,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
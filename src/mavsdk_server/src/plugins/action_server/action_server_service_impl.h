@@ -9,11 +9,15 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "stream_writer.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -115,18 +119,23 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::action_server::AllowableFlightModes>
-    translateToRpcAllowableFlightModes(
-        const mavsdk::ActionServer::AllowableFlightModes& allowable_flight_modes)
+    static void translateToRpcAllowableFlightModes(
+        const mavsdk::ActionServer::AllowableFlightModes& allowable_flight_modes,
+        rpc::action_server::AllowableFlightModes* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::action_server::AllowableFlightModes>();
-
         rpc_obj->set_can_auto_mode(allowable_flight_modes.can_auto_mode);
 
         rpc_obj->set_can_guided_mode(allowable_flight_modes.can_guided_mode);
 
         rpc_obj->set_can_stabilize_mode(allowable_flight_modes.can_stabilize_mode);
+    }
 
+    static std::unique_ptr<rpc::action_server::AllowableFlightModes>
+    translateToRpcAllowableFlightModes(
+        const mavsdk::ActionServer::AllowableFlightModes& allowable_flight_modes)
+    {
+        auto rpc_obj = std::make_unique<rpc::action_server::AllowableFlightModes>();
+        translateToRpcAllowableFlightModes(allowable_flight_modes, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -144,15 +153,19 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::action_server::ArmDisarm>
-    translateToRpcArmDisarm(const mavsdk::ActionServer::ArmDisarm& arm_disarm)
+    static void translateToRpcArmDisarm(
+        const mavsdk::ActionServer::ArmDisarm& arm_disarm, rpc::action_server::ArmDisarm* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::action_server::ArmDisarm>();
-
         rpc_obj->set_arm(arm_disarm.arm);
 
         rpc_obj->set_force(arm_disarm.force);
+    }
 
+    static std::unique_ptr<rpc::action_server::ArmDisarm>
+    translateToRpcArmDisarm(const mavsdk::ActionServer::ArmDisarm& arm_disarm)
+    {
+        auto rpc_obj = std::make_unique<rpc::action_server::ArmDisarm>();
+        translateToRpcArmDisarm(arm_disarm, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -247,11 +260,13 @@ public:
     }
 
     grpc::Status SubscribeArmDisarm(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::action_server::SubscribeArmDisarmRequest* /* request */,
         grpc::ServerWriter<rpc::action_server::ArmDisarmResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::action_server::ArmDisarmResponse rpc_response;
             auto result = mavsdk::ActionServer::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -260,52 +275,44 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox = std::make_shared<StreamOutbox<rpc::action_server::ArmDisarmResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeArmDisarm");
 
-        _lazy_plugin.maybe_plugin()->subscribe_arm_disarm(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
+        plugin->subscribe_arm_disarm(
+            [outbox](
                 mavsdk::ActionServer::Result result,
                 const mavsdk::ActionServer::ArmDisarm arm_disarm) {
-                rpc::action_server::ArmDisarmResponse rpc_response;
-
-                rpc_response.set_allocated_arm(translateToRpcArmDisarm(arm_disarm).release());
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_action_server_result = new rpc::action_server::ActionServerResult();
-                rpc_action_server_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_action_server_result->set_result_str(ss.str());
-                rpc_response.set_allocated_action_server_result(rpc_action_server_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_arm_disarm(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+                outbox->emplace([&](rpc::action_server::ArmDisarmResponse& rpc_response) {
+                    translateToRpcArmDisarm(arm_disarm, rpc_response.mutable_arm());
+
+                    auto* rpc_action_server_result = rpc_response.mutable_action_server_result();
+                    rpc_action_server_result->set_result(translateToRpcResult(result));
+                    std::stringstream ss;
+                    ss << result;
+                    rpc_action_server_result->set_result_str(ss.str());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_arm_disarm(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeFlightModeChange(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::action_server::SubscribeFlightModeChangeRequest* /* request */,
         grpc::ServerWriter<rpc::action_server::FlightModeChangeResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::action_server::FlightModeChangeResponse rpc_response;
             auto result = mavsdk::ActionServer::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -314,52 +321,44 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox = std::make_shared<StreamOutbox<rpc::action_server::FlightModeChangeResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeFlightModeChange");
 
-        _lazy_plugin.maybe_plugin()->subscribe_flight_mode_change(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
+        plugin->subscribe_flight_mode_change(
+            [outbox](
                 mavsdk::ActionServer::Result result,
                 const mavsdk::ActionServer::FlightMode flight_mode_change) {
-                rpc::action_server::FlightModeChangeResponse rpc_response;
-
-                rpc_response.set_flight_mode(translateToRpcFlightMode(flight_mode_change));
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_action_server_result = new rpc::action_server::ActionServerResult();
-                rpc_action_server_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_action_server_result->set_result_str(ss.str());
-                rpc_response.set_allocated_action_server_result(rpc_action_server_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_flight_mode_change(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+                outbox->emplace([&](rpc::action_server::FlightModeChangeResponse& rpc_response) {
+                    rpc_response.set_flight_mode(translateToRpcFlightMode(flight_mode_change));
+
+                    auto* rpc_action_server_result = rpc_response.mutable_action_server_result();
+                    rpc_action_server_result->set_result(translateToRpcResult(result));
+                    std::stringstream ss;
+                    ss << result;
+                    rpc_action_server_result->set_result_str(ss.str());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_flight_mode_change(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeTakeoff(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::action_server::SubscribeTakeoffRequest* /* request */,
         grpc::ServerWriter<rpc::action_server::TakeoffResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::action_server::TakeoffResponse rpc_response;
             auto result = mavsdk::ActionServer::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -368,51 +367,42 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_takeoff(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                mavsdk::ActionServer::Result result, const bool takeoff) {
-                rpc::action_server::TakeoffResponse rpc_response;
-
-                rpc_response.set_takeoff(takeoff);
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_action_server_result = new rpc::action_server::ActionServerResult();
-                rpc_action_server_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_action_server_result->set_result_str(ss.str());
-                rpc_response.set_allocated_action_server_result(rpc_action_server_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_takeoff(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        auto outbox = std::make_shared<StreamOutbox<rpc::action_server::TakeoffResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeTakeoff");
+
+        plugin->subscribe_takeoff(
+            [outbox](mavsdk::ActionServer::Result result, const bool takeoff) {
+                outbox->emplace([&](rpc::action_server::TakeoffResponse& rpc_response) {
+                    rpc_response.set_takeoff(takeoff);
+
+                    auto* rpc_action_server_result = rpc_response.mutable_action_server_result();
+                    rpc_action_server_result->set_result(translateToRpcResult(result));
+                    std::stringstream ss;
+                    ss << result;
+                    rpc_action_server_result->set_result_str(ss.str());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_takeoff(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeLand(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::action_server::SubscribeLandRequest* /* request */,
         grpc::ServerWriter<rpc::action_server::LandResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::action_server::LandResponse rpc_response;
             auto result = mavsdk::ActionServer::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -421,51 +411,42 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_land(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                mavsdk::ActionServer::Result result, const bool land) {
-                rpc::action_server::LandResponse rpc_response;
-
-                rpc_response.set_land(land);
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_action_server_result = new rpc::action_server::ActionServerResult();
-                rpc_action_server_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_action_server_result->set_result_str(ss.str());
-                rpc_response.set_allocated_action_server_result(rpc_action_server_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_land(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        auto outbox = std::make_shared<StreamOutbox<rpc::action_server::LandResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeLand");
+
+        plugin->subscribe_land(
+            [outbox](mavsdk::ActionServer::Result result, const bool land) {
+                outbox->emplace([&](rpc::action_server::LandResponse& rpc_response) {
+                    rpc_response.set_land(land);
+
+                    auto* rpc_action_server_result = rpc_response.mutable_action_server_result();
+                    rpc_action_server_result->set_result(translateToRpcResult(result));
+                    std::stringstream ss;
+                    ss << result;
+                    rpc_action_server_result->set_result_str(ss.str());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_land(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeReboot(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::action_server::SubscribeRebootRequest* /* request */,
         grpc::ServerWriter<rpc::action_server::RebootResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::action_server::RebootResponse rpc_response;
             auto result = mavsdk::ActionServer::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -474,51 +455,42 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_reboot(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                mavsdk::ActionServer::Result result, const bool reboot) {
-                rpc::action_server::RebootResponse rpc_response;
-
-                rpc_response.set_reboot(reboot);
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_action_server_result = new rpc::action_server::ActionServerResult();
-                rpc_action_server_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_action_server_result->set_result_str(ss.str());
-                rpc_response.set_allocated_action_server_result(rpc_action_server_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_reboot(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        auto outbox = std::make_shared<StreamOutbox<rpc::action_server::RebootResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeReboot");
+
+        plugin->subscribe_reboot(
+            [outbox](mavsdk::ActionServer::Result result, const bool reboot) {
+                outbox->emplace([&](rpc::action_server::RebootResponse& rpc_response) {
+                    rpc_response.set_reboot(reboot);
+
+                    auto* rpc_action_server_result = rpc_response.mutable_action_server_result();
+                    rpc_action_server_result->set_result(translateToRpcResult(result));
+                    std::stringstream ss;
+                    ss << result;
+                    rpc_action_server_result->set_result_str(ss.str());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_reboot(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeShutdown(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::action_server::SubscribeShutdownRequest* /* request */,
         grpc::ServerWriter<rpc::action_server::ShutdownResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::action_server::ShutdownResponse rpc_response;
             auto result = mavsdk::ActionServer::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -527,51 +499,42 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_shutdown(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                mavsdk::ActionServer::Result result, const bool shutdown) {
-                rpc::action_server::ShutdownResponse rpc_response;
-
-                rpc_response.set_shutdown(shutdown);
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_action_server_result = new rpc::action_server::ActionServerResult();
-                rpc_action_server_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_action_server_result->set_result_str(ss.str());
-                rpc_response.set_allocated_action_server_result(rpc_action_server_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_shutdown(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        auto outbox = std::make_shared<StreamOutbox<rpc::action_server::ShutdownResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeShutdown");
+
+        plugin->subscribe_shutdown(
+            [outbox](mavsdk::ActionServer::Result result, const bool shutdown) {
+                outbox->emplace([&](rpc::action_server::ShutdownResponse& rpc_response) {
+                    rpc_response.set_shutdown(shutdown);
+
+                    auto* rpc_action_server_result = rpc_response.mutable_action_server_result();
+                    rpc_action_server_result->set_result(translateToRpcResult(result));
+                    std::stringstream ss;
+                    ss << result;
+                    rpc_action_server_result->set_result_str(ss.str());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_shutdown(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeTerminate(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::action_server::SubscribeTerminateRequest* /* request */,
         grpc::ServerWriter<rpc::action_server::TerminateResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::action_server::TerminateResponse rpc_response;
             auto result = mavsdk::ActionServer::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -580,51 +543,42 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_terminate(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                mavsdk::ActionServer::Result result, const bool terminate) {
-                rpc::action_server::TerminateResponse rpc_response;
-
-                rpc_response.set_terminate(terminate);
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_action_server_result = new rpc::action_server::ActionServerResult();
-                rpc_action_server_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_action_server_result->set_result_str(ss.str());
-                rpc_response.set_allocated_action_server_result(rpc_action_server_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_terminate(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        auto outbox = std::make_shared<StreamOutbox<rpc::action_server::TerminateResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeTerminate");
+
+        plugin->subscribe_terminate(
+            [outbox](mavsdk::ActionServer::Result result, const bool terminate) {
+                outbox->emplace([&](rpc::action_server::TerminateResponse& rpc_response) {
+                    rpc_response.set_terminate(terminate);
+
+                    auto* rpc_action_server_result = rpc_response.mutable_action_server_result();
+                    rpc_action_server_result->set_result(translateToRpcResult(result));
+                    std::stringstream ss;
+                    ss << result;
+                    rpc_action_server_result->set_result_str(ss.str());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_terminate(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SetAllowTakeoff(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action_server::SetAllowTakeoffRequest* request,
         rpc::action_server::SetAllowTakeoffResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::ActionServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -638,7 +592,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_allow_takeoff(request->allow_takeoff());
+        auto result = plugin->set_allow_takeoff(request->allow_takeoff());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -648,11 +602,13 @@ public:
     }
 
     grpc::Status SetArmable(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action_server::SetArmableRequest* request,
         rpc::action_server::SetArmableResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::ActionServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -667,7 +623,7 @@ public:
         }
 
         auto result =
-            _lazy_plugin.maybe_plugin()->set_armable(request->armable(), request->force_armable());
+            plugin->set_armable(request->armable(), request->force_armable());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -677,11 +633,13 @@ public:
     }
 
     grpc::Status SetDisarmable(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action_server::SetDisarmableRequest* request,
         rpc::action_server::SetDisarmableResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::ActionServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -695,8 +653,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_disarmable(
-            request->disarmable(), request->force_disarmable());
+        auto result = plugin->set_disarmable(request->disarmable(), request->force_disarmable());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -706,11 +663,13 @@ public:
     }
 
     grpc::Status SetAllowableFlightModes(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action_server::SetAllowableFlightModesRequest* request,
         rpc::action_server::SetAllowableFlightModesResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::ActionServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -724,7 +683,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_allowable_flight_modes(
+        auto result = plugin->set_allowable_flight_modes(
             translateFromRpcAllowableFlightModes(request->flight_modes()));
 
         if (response != nullptr) {
@@ -735,15 +694,17 @@ public:
     }
 
     grpc::Status GetAllowableFlightModes(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::action_server::GetAllowableFlightModesRequest* /* request */,
         rpc::action_server::GetAllowableFlightModesResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_allowable_flight_modes();
+        auto result = plugin->get_allowable_flight_modes();
 
         if (response != nullptr) {
             response->set_allocated_flight_modes(
@@ -756,32 +717,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"action_server", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -790,7 +767,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
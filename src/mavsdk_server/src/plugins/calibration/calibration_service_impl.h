@@ -8,11 +8,15 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "stream_writer.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -106,11 +110,10 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::calibration::ProgressData>
-    translateToRpcProgressData(const mavsdk::Calibration::ProgressData& progress_data)
+    static void translateToRpcProgressData(
+        const mavsdk::Calibration::ProgressData& progress_data,
+        rpc::calibration::ProgressData* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::calibration::ProgressData>();
-
         rpc_obj->set_has_progress(progress_data.has_progress);
 
         rpc_obj->set_progress(progress_data.progress);
@@ -118,7 +121,13 @@ public:
         rpc_obj->set_has_status_text(progress_data.has_status_text);
 
         rpc_obj->set_status_text(progress_data.status_text);
+    }
 
+    static std::unique_ptr<rpc::calibration::ProgressData>
+    translateToRpcProgressData(const mavsdk::Calibration::ProgressData& progress_data)
+    {
+        auto rpc_obj = std::make_unique<rpc::calibration::ProgressData>();
+        translateToRpcProgressData(progress_data, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -139,11 +148,13 @@ public:
     }
 
     grpc::Status SubscribeCalibrateGyro(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::calibration::SubscribeCalibrateGyroRequest* /* request */,
         grpc::ServerWriter<rpc::calibration::CalibrateGyroResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::calibration::CalibrateGyroResponse rpc_response;
             auto result = mavsdk::Calibration::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -152,51 +163,43 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
+        auto outbox = std::make_shared<StreamOutbox<rpc::calibration::CalibrateGyroResponse>>();
+        register_stream_outbox(outbox, "SubscribeCalibrateGyro");
 
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->calibrate_gyro_async(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
+        plugin->calibrate_gyro_async(
+            [outbox](
                 mavsdk::Calibration::Result result,
                 const mavsdk::Calibration::ProgressData calibrate_gyro) {
-                rpc::calibration::CalibrateGyroResponse rpc_response;
-
-                rpc_response.set_allocated_progress_data(
-                    translateToRpcProgressData(calibrate_gyro).release());
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_calibration_result = new rpc::calibration::CalibrationResult();
-                rpc_calibration_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_calibration_result->set_result_str(ss.str());
-                rpc_response.set_allocated_calibration_result(rpc_calibration_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+                outbox->emplace([&](rpc::calibration::CalibrateGyroResponse& rpc_response) {
+                    translateToRpcProgressData(
+                        calibrate_gyro, rpc_response.mutable_progress_data());
+
+                    auto* rpc_calibration_result = rpc_response.mutable_calibration_result();
+                    rpc_calibration_result->set_result(translateToRpcResult(result));
+                    std::stringstream ss;
+                    ss << result;
+                    rpc_calibration_result->set_result_str(ss.str());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeCalibrateAccelerometer(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::calibration::SubscribeCalibrateAccelerometerRequest* /* request */,
         grpc::ServerWriter<rpc::calibration::CalibrateAccelerometerResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::calibration::CalibrateAccelerometerResponse rpc_response;
             auto result = mavsdk::Calibration::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -205,51 +208,45 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox =
+            std::make_shared<StreamOutbox<rpc::calibration::CalibrateAccelerometerResponse>>();
+        register_stream_outbox(outbox, "SubscribeCalibrateAccelerometer");
 
-        _lazy_plugin.maybe_plugin()->calibrate_accelerometer_async(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
+        plugin->calibrate_accelerometer_async(
+            [outbox](
                 mavsdk::Calibration::Result result,
                 const mavsdk::Calibration::ProgressData calibrate_accelerometer) {
-                rpc::calibration::CalibrateAccelerometerResponse rpc_response;
-
-                rpc_response.set_allocated_progress_data(
-                    translateToRpcProgressData(calibrate_accelerometer).release());
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_calibration_result = new rpc::calibration::CalibrationResult();
-                rpc_calibration_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_calibration_result->set_result_str(ss.str());
-                rpc_response.set_allocated_calibration_result(rpc_calibration_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+                outbox->emplace(
+                    [&](rpc::calibration::CalibrateAccelerometerResponse& rpc_response) {
+                        translateToRpcProgressData(
+                            calibrate_accelerometer, rpc_response.mutable_progress_data());
+
+                        auto* rpc_calibration_result = rpc_response.mutable_calibration_result();
+                        rpc_calibration_result->set_result(translateToRpcResult(result));
+                        std::stringstream ss;
+                        ss << result;
+                        rpc_calibration_result->set_result_str(ss.str());
+                    });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeCalibrateMagnetometer(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::calibration::SubscribeCalibrateMagnetometerRequest* /* request */,
         grpc::ServerWriter<rpc::calibration::CalibrateMagnetometerResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::calibration::CalibrateMagnetometerResponse rpc_response;
             auto result = mavsdk::Calibration::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -258,51 +255,44 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
+        auto outbox =
+            std::make_shared<StreamOutbox<rpc::calibration::CalibrateMagnetometerResponse>>();
+        register_stream_outbox(outbox, "SubscribeCalibrateMagnetometer");
 
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->calibrate_magnetometer_async(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
+        plugin->calibrate_magnetometer_async(
+            [outbox](
                 mavsdk::Calibration::Result result,
                 const mavsdk::Calibration::ProgressData calibrate_magnetometer) {
-                rpc::calibration::CalibrateMagnetometerResponse rpc_response;
-
-                rpc_response.set_allocated_progress_data(
-                    translateToRpcProgressData(calibrate_magnetometer).release());
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_calibration_result = new rpc::calibration::CalibrationResult();
-                rpc_calibration_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_calibration_result->set_result_str(ss.str());
-                rpc_response.set_allocated_calibration_result(rpc_calibration_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+                outbox->emplace([&](rpc::calibration::CalibrateMagnetometerResponse& rpc_response) {
+                    translateToRpcProgressData(
+                        calibrate_magnetometer, rpc_response.mutable_progress_data());
+
+                    auto* rpc_calibration_result = rpc_response.mutable_calibration_result();
+                    rpc_calibration_result->set_result(translateToRpcResult(result));
+                    std::stringstream ss;
+                    ss << result;
+                    rpc_calibration_result->set_result_str(ss.str());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeCalibrateLevelHorizon(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::calibration::SubscribeCalibrateLevelHorizonRequest* /* request */,
         grpc::ServerWriter<rpc::calibration::CalibrateLevelHorizonResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::calibration::CalibrateLevelHorizonResponse rpc_response;
             auto result = mavsdk::Calibration::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -311,51 +301,44 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox =
+            std::make_shared<StreamOutbox<rpc::calibration::CalibrateLevelHorizonResponse>>();
+        register_stream_outbox(outbox, "SubscribeCalibrateLevelHorizon");
 
-        _lazy_plugin.maybe_plugin()->calibrate_level_horizon_async(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
+        plugin->calibrate_level_horizon_async(
+            [outbox](
                 mavsdk::Calibration::Result result,
                 const mavsdk::Calibration::ProgressData calibrate_level_horizon) {
-                rpc::calibration::CalibrateLevelHorizonResponse rpc_response;
-
-                rpc_response.set_allocated_progress_data(
-                    translateToRpcProgressData(calibrate_level_horizon).release());
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_calibration_result = new rpc::calibration::CalibrationResult();
-                rpc_calibration_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_calibration_result->set_result_str(ss.str());
-                rpc_response.set_allocated_calibration_result(rpc_calibration_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+                outbox->emplace([&](rpc::calibration::CalibrateLevelHorizonResponse& rpc_response) {
+                    translateToRpcProgressData(
+                        calibrate_level_horizon, rpc_response.mutable_progress_data());
+
+                    auto* rpc_calibration_result = rpc_response.mutable_calibration_result();
+                    rpc_calibration_result->set_result(translateToRpcResult(result));
+                    std::stringstream ss;
+                    ss << result;
+                    rpc_calibration_result->set_result_str(ss.str());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeCalibrateGimbalAccelerometer(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::calibration::SubscribeCalibrateGimbalAccelerometerRequest* /* request */,
         grpc::ServerWriter<rpc::calibration::CalibrateGimbalAccelerometerResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::calibration::CalibrateGimbalAccelerometerResponse rpc_response;
             auto result = mavsdk::Calibration::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -364,51 +347,45 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
+        auto outbox =
+            std::make_shared<StreamOutbox<rpc::calibration::CalibrateGimbalAccelerometerResponse>>();
+        register_stream_outbox(outbox, "SubscribeCalibrateGimbalAccelerometer");
 
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->calibrate_gimbal_accelerometer_async(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
+        plugin->calibrate_gimbal_accelerometer_async(
+            [outbox](
                 mavsdk::Calibration::Result result,
                 const mavsdk::Calibration::ProgressData calibrate_gimbal_accelerometer) {
-                rpc::calibration::CalibrateGimbalAccelerometerResponse rpc_response;
-
-                rpc_response.set_allocated_progress_data(
-                    translateToRpcProgressData(calibrate_gimbal_accelerometer).release());
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_calibration_result = new rpc::calibration::CalibrationResult();
-                rpc_calibration_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_calibration_result->set_result_str(ss.str());
-                rpc_response.set_allocated_calibration_result(rpc_calibration_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+                outbox->emplace(
+                    [&](rpc::calibration::CalibrateGimbalAccelerometerResponse& rpc_response) {
+                        translateToRpcProgressData(
+                            calibrate_gimbal_accelerometer, rpc_response.mutable_progress_data());
+
+                        auto* rpc_calibration_result = rpc_response.mutable_calibration_result();
+                        rpc_calibration_result->set_result(translateToRpcResult(result));
+                        std::stringstream ss;
+                        ss << result;
+                        rpc_calibration_result->set_result_str(ss.str());
+                    });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status Cancel(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::calibration::CancelRequest* /* request */,
         rpc::calibration::CancelResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Calibration::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -417,7 +394,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->cancel();
+        auto result = plugin->cancel();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -429,32 +406,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"calibration", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -463,7 +456,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
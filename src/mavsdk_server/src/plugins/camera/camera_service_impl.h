@@ -8,11 +8,15 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "stream_writer.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -152,11 +156,9 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::camera::Position>
-    translateToRpcPosition(const mavsdk::Camera::Position& position)
+    static void translateToRpcPosition(
+        const mavsdk::Camera::Position& position, rpc::camera::Position* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::camera::Position>();
-
         rpc_obj->set_latitude_deg(position.latitude_deg);
 
         rpc_obj->set_longitude_deg(position.longitude_deg);
@@ -164,7 +166,13 @@ public:
         rpc_obj->set_absolute_altitude_m(position.absolute_altitude_m);
 
         rpc_obj->set_relative_altitude_m(position.relative_altitude_m);
+    }
 
+    static std::unique_ptr<rpc::camera::Position>
+    translateToRpcPosition(const mavsdk::Camera::Position& position)
+    {
+        auto rpc_obj = std::make_unique<rpc::camera::Position>();
+        translateToRpcPosition(position, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -183,11 +191,9 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::camera::Quaternion>
-    translateToRpcQuaternion(const mavsdk::Camera::Quaternion& quaternion)
+    static void translateToRpcQuaternion(
+        const mavsdk::Camera::Quaternion& quaternion, rpc::camera::Quaternion* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::camera::Quaternion>();
-
         rpc_obj->set_w(quaternion.w);
 
         rpc_obj->set_x(quaternion.x);
@@ -195,7 +201,13 @@ public:
         rpc_obj->set_y(quaternion.y);
 
         rpc_obj->set_z(quaternion.z);
+    }
 
+    static std::unique_ptr<rpc::camera::Quaternion>
+    translateToRpcQuaternion(const mavsdk::Camera::Quaternion& quaternion)
+    {
+        auto rpc_obj = std::make_unique<rpc::camera::Quaternion>();
+        translateToRpcQuaternion(quaternion, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -215,17 +227,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::camera::EulerAngle>
-    translateToRpcEulerAngle(const mavsdk::Camera::EulerAngle& euler_angle)
+    static void translateToRpcEulerAngle(
+        const mavsdk::Camera::EulerAngle& euler_angle, rpc::camera::EulerAngle* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::camera::EulerAngle>();
-
         rpc_obj->set_roll_deg(euler_angle.roll_deg);
 
         rpc_obj->set_pitch_deg(euler_angle.pitch_deg);
 
         rpc_obj->set_yaw_deg(euler_angle.yaw_deg);
+    }
 
+    static std::unique_ptr<rpc::camera::EulerAngle>
+    translateToRpcEulerAngle(const mavsdk::Camera::EulerAngle& euler_angle)
+    {
+        auto rpc_obj = std::make_unique<rpc::camera::EulerAngle>();
+        translateToRpcEulerAngle(euler_angle, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -243,18 +259,16 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::camera::CaptureInfo>
-    translateToRpcCaptureInfo(const mavsdk::Camera::CaptureInfo& capture_info)
+    static void translateToRpcCaptureInfo(
+        const mavsdk::Camera::CaptureInfo& capture_info, rpc::camera::CaptureInfo* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::camera::CaptureInfo>();
-
-        rpc_obj->set_allocated_position(translateToRpcPosition(capture_info.position).release());
+        translateToRpcPosition(capture_info.position, rpc_obj->mutable_position());
 
-        rpc_obj->set_allocated_attitude_quaternion(
-            translateToRpcQuaternion(capture_info.attitude_quaternion).release());
+        translateToRpcQuaternion(
+            capture_info.attitude_quaternion, rpc_obj->mutable_attitude_quaternion());
 
-        rpc_obj->set_allocated_attitude_euler_angle(
-            translateToRpcEulerAngle(capture_info.attitude_euler_angle).release());
+        translateToRpcEulerAngle(
+            capture_info.attitude_euler_angle, rpc_obj->mutable_attitude_euler_angle());
 
         rpc_obj->set_time_utc_us(capture_info.time_utc_us);
 
@@ -263,7 +277,13 @@ public:
         rpc_obj->set_index(capture_info.index);
 
         rpc_obj->set_file_url(capture_info.file_url);
+    }
 
+    static std::unique_ptr<rpc::camera::CaptureInfo>
+    translateToRpcCaptureInfo(const mavsdk::Camera::CaptureInfo& capture_info)
+    {
+        auto rpc_obj = std::make_unique<rpc::camera::CaptureInfo>();
+        translateToRpcCaptureInfo(capture_info, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -289,11 +309,10 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::camera::VideoStreamSettings> translateToRpcVideoStreamSettings(
-        const mavsdk::Camera::VideoStreamSettings& video_stream_settings)
+    static void translateToRpcVideoStreamSettings(
+        const mavsdk::Camera::VideoStreamSettings& video_stream_settings,
+        rpc::camera::VideoStreamSettings* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::camera::VideoStreamSettings>();
-
         rpc_obj->set_frame_rate_hz(video_stream_settings.frame_rate_hz);
 
         rpc_obj->set_horizontal_resolution_pix(video_stream_settings.horizontal_resolution_pix);
@@ -307,7 +326,13 @@ public:
         rpc_obj->set_uri(video_stream_settings.uri);
 
         rpc_obj->set_horizontal_fov_deg(video_stream_settings.horizontal_fov_deg);
+    }
 
+    static std::unique_ptr<rpc::camera::VideoStreamSettings> translateToRpcVideoStreamSettings(
+        const mavsdk::Camera::VideoStreamSettings& video_stream_settings)
+    {
+        auto rpc_obj = std::make_unique<rpc::camera::VideoStreamSettings>();
+        translateToRpcVideoStreamSettings(video_stream_settings, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -403,18 +428,22 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::camera::VideoStreamInfo>
-    translateToRpcVideoStreamInfo(const mavsdk::Camera::VideoStreamInfo& video_stream_info)
+    static void translateToRpcVideoStreamInfo(
+        const mavsdk::Camera::VideoStreamInfo& video_stream_info,
+        rpc::camera::VideoStreamInfo* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::camera::VideoStreamInfo>();
-
-        rpc_obj->set_allocated_settings(
-            translateToRpcVideoStreamSettings(video_stream_info.settings).release());
+        translateToRpcVideoStreamSettings(video_stream_info.settings, rpc_obj->mutable_settings());
 
         rpc_obj->set_status(translateToRpcVideoStreamStatus(video_stream_info.status));
 
         rpc_obj->set_spectrum(translateToRpcVideoStreamSpectrum(video_stream_info.spectrum));
+    }
 
+    static std::unique_ptr<rpc::camera::VideoStreamInfo>
+    translateToRpcVideoStreamInfo(const mavsdk::Camera::VideoStreamInfo& video_stream_info)
+    {
+        auto rpc_obj = std::make_unique<rpc::camera::VideoStreamInfo>();
+        translateToRpcVideoStreamInfo(video_stream_info, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -514,11 +543,9 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::camera::Status>
-    translateToRpcStatus(const mavsdk::Camera::Status& status)
+    static void translateToRpcStatus(
+        const mavsdk::Camera::Status& status, rpc::camera::Status* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::camera::Status>();
-
         rpc_obj->set_video_on(status.video_on);
 
         rpc_obj->set_photo_interval_on(status.photo_interval_on);
@@ -538,7 +565,13 @@ public:
         rpc_obj->set_storage_id(status.storage_id);
 
         rpc_obj->set_storage_type(translateToRpcStorageType(status.storage_type));
+    }
 
+    static std::unique_ptr<rpc::camera::Status>
+    translateToRpcStatus(const mavsdk::Camera::Status& status)
+    {
+        auto rpc_obj = std::make_unique<rpc::camera::Status>();
+        translateToRpcStatus(status, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -569,15 +602,19 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::camera::Option>
-    translateToRpcOption(const mavsdk::Camera::Option& option)
+    static void translateToRpcOption(
+        const mavsdk::Camera::Option& option, rpc::camera::Option* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::camera::Option>();
-
         rpc_obj->set_option_id(option.option_id);
 
         rpc_obj->set_option_description(option.option_description);
+    }
 
+    static std::unique_ptr<rpc::camera::Option>
+    translateToRpcOption(const mavsdk::Camera::Option& option)
+    {
+        auto rpc_obj = std::make_unique<rpc::camera::Option>();
+        translateToRpcOption(option, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -592,19 +629,23 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::camera::Setting>
-    translateToRpcSetting(const mavsdk::Camera::Setting& setting)
+    static void translateToRpcSetting(
+        const mavsdk::Camera::Setting& setting, rpc::camera::Setting* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::camera::Setting>();
-
         rpc_obj->set_setting_id(setting.setting_id);
 
         rpc_obj->set_setting_description(setting.setting_description);
 
-        rpc_obj->set_allocated_option(translateToRpcOption(setting.option).release());
+        translateToRpcOption(setting.option, rpc_obj->mutable_option());
 
         rpc_obj->set_is_range(setting.is_range);
+    }
 
+    static std::unique_ptr<rpc::camera::Setting>
+    translateToRpcSetting(const mavsdk::Camera::Setting& setting)
+    {
+        auto rpc_obj = std::make_unique<rpc::camera::Setting>();
+        translateToRpcSetting(setting, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -623,22 +664,26 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::camera::SettingOptions>
-    translateToRpcSettingOptions(const mavsdk::Camera::SettingOptions& setting_options)
+    static void translateToRpcSettingOptions(
+        const mavsdk::Camera::SettingOptions& setting_options, rpc::camera::SettingOptions* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::camera::SettingOptions>();
-
         rpc_obj->set_setting_id(setting_options.setting_id);
 
         rpc_obj->set_setting_description(setting_options.setting_description);
 
+        rpc_obj->clear_options();
         for (const auto& elem : setting_options.options) {
-            auto* ptr = rpc_obj->add_options();
-            ptr->CopyFrom(*translateToRpcOption(elem).release());
+            translateToRpcOption(elem, rpc_obj->add_options());
         }
 
         rpc_obj->set_is_range(setting_options.is_range);
+    }
 
+    static std::unique_ptr<rpc::camera::SettingOptions>
+    translateToRpcSettingOptions(const mavsdk::Camera::SettingOptions& setting_options)
+    {
+        auto rpc_obj = std::make_unique<rpc::camera::SettingOptions>();
+        translateToRpcSettingOptions(setting_options, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -661,11 +706,9 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::camera::Information>
-    translateToRpcInformation(const mavsdk::Camera::Information& information)
+    static void translateToRpcInformation(
+        const mavsdk::Camera::Information& information, rpc::camera::Information* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::camera::Information>();
-
         rpc_obj->set_vendor_name(information.vendor_name);
 
         rpc_obj->set_model_name(information.model_name);
@@ -679,7 +722,13 @@ public:
         rpc_obj->set_horizontal_resolution_px(information.horizontal_resolution_px);
 
         rpc_obj->set_vertical_resolution_px(information.vertical_resolution_px);
+    }
 
+    static std::unique_ptr<rpc::camera::Information>
+    translateToRpcInformation(const mavsdk::Camera::Information& information)
+    {
+        auto rpc_obj = std::make_unique<rpc::camera::Information>();
+        translateToRpcInformation(information, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -706,11 +755,13 @@ public:
     }
 
     grpc::Status Prepare(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::camera::PrepareRequest* /* request */,
         rpc::camera::PrepareResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Camera::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -719,7 +770,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->prepare();
+        auto result = plugin->prepare();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -729,11 +780,13 @@ public:
     }
 
     grpc::Status TakePhoto(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::camera::TakePhotoRequest* /* request */,
         rpc::camera::TakePhotoResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Camera::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -742,7 +795,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->take_photo();
+        auto result = plugin->take_photo();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -752,11 +805,13 @@ public:
     }
 
     grpc::Status StartPhotoInterval(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::camera::StartPhotoIntervalRequest* request,
         rpc::camera::StartPhotoIntervalResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Camera::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -770,7 +825,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->start_photo_interval(request->interval_s());
+        auto result = plugin->start_photo_interval(request->interval_s());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -780,11 +835,13 @@ public:
     }
 
     grpc::Status StopPhotoInterval(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::camera::StopPhotoIntervalRequest* /* request */,
         rpc::camera::StopPhotoIntervalResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Camera::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -793,7 +850,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->stop_photo_interval();
+        auto result = plugin->stop_photo_interval();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -803,11 +860,13 @@ public:
     }
 
     grpc::Status StartVideo(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::camera::StartVideoRequest* /* request */,
         rpc::camera::StartVideoResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Camera::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -816,7 +875,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->start_video();
+        auto result = plugin->start_video();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -826,11 +885,13 @@ public:
     }
 
     grpc::Status StopVideo(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::camera::StopVideoRequest* /* request */,
         rpc::camera::StopVideoResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Camera::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -839,7 +900,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->stop_video();
+        auto result = plugin->stop_video();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -849,11 +910,13 @@ public:
     }
 
     grpc::Status StartVideoStreaming(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::camera::StartVideoStreamingRequest* /* request */,
         rpc::camera::StartVideoStreamingResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Camera::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -862,7 +925,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->start_video_streaming();
+        auto result = plugin->start_video_streaming();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -872,11 +935,13 @@ public:
     }
 
     grpc::Status StopVideoStreaming(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::camera::StopVideoStreamingRequest* /* request */,
         rpc::camera::StopVideoStreamingResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Camera::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -885,7 +950,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->stop_video_streaming();
+        auto result = plugin->stop_video_streaming();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -895,11 +960,13 @@ public:
     }
 
     grpc::Status SetMode(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::camera::SetModeRequest* request,
         rpc::camera::SetModeResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Camera::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -913,7 +980,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_mode(translateFromRpcMode(request->mode()));
+        auto result = plugin->set_mode(translateFromRpcMode(request->mode()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -923,11 +990,13 @@ public:
     }
 
     grpc::Status ListPhotos(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::camera::ListPhotosRequest* request,
         rpc::camera::ListPhotosResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Camera::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -941,15 +1010,13 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->list_photos(
-            translateFromRpcPhotosRange(request->photos_range()));
+        auto result = plugin->list_photos(translateFromRpcPhotosRange(request->photos_range()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
 
             for (auto elem : result.second) {
-                auto* ptr = response->add_capture_infos();
-                ptr->CopyFrom(*translateToRpcCaptureInfo(elem).release());
+                translateToRpcCaptureInfo(elem, response->add_capture_infos());
             }
         }
 
@@ -957,300 +1024,251 @@ public:
     }
 
     grpc::Status SubscribeMode(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::camera::SubscribeModeRequest* /* request */,
         grpc::ServerWriter<rpc::camera::ModeResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_mode(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Camera::Mode mode) {
-                rpc::camera::ModeResponse rpc_response;
-
-                rpc_response.set_mode(translateToRpcMode(mode));
+        auto outbox = std::make_shared<StreamOutbox<rpc::camera::ModeResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeMode");
 
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_mode(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        plugin->subscribe_mode(
+            [outbox](const mavsdk::Camera::Mode mode) {
+                outbox->emplace([&](rpc::camera::ModeResponse& rpc_response) {
+                    rpc_response.set_mode(translateToRpcMode(mode));
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_mode(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeInformation(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::camera::SubscribeInformationRequest* /* request */,
         grpc::ServerWriter<rpc::camera::InformationResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_information(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Camera::Information information) {
-                rpc::camera::InformationResponse rpc_response;
+        auto outbox = std::make_shared<StreamOutbox<rpc::camera::InformationResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeInformation");
 
-                rpc_response.set_allocated_information(
-                    translateToRpcInformation(information).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_information(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        plugin->subscribe_information(
+            [outbox](const mavsdk::Camera::Information information) {
+                outbox->emplace([&](rpc::camera::InformationResponse& rpc_response) {
+                    translateToRpcInformation(information, rpc_response.mutable_information());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_information(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeVideoStreamInfo(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::camera::SubscribeVideoStreamInfoRequest* /* request */,
         grpc::ServerWriter<rpc::camera::VideoStreamInfoResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox = std::make_shared<StreamOutbox<rpc::camera::VideoStreamInfoResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeVideoStreamInfo");
 
-        _lazy_plugin.maybe_plugin()->subscribe_video_stream_info(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Camera::VideoStreamInfo video_stream_info) {
-                rpc::camera::VideoStreamInfoResponse rpc_response;
-
-                rpc_response.set_allocated_video_stream_info(
-                    translateToRpcVideoStreamInfo(video_stream_info).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_video_stream_info(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        plugin->subscribe_video_stream_info(
+            [outbox](const mavsdk::Camera::VideoStreamInfo video_stream_info) {
+                outbox->emplace([&](rpc::camera::VideoStreamInfoResponse& rpc_response) {
+                    translateToRpcVideoStreamInfo(
+                        video_stream_info, rpc_response.mutable_video_stream_info());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_video_stream_info(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeCaptureInfo(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::camera::SubscribeCaptureInfoRequest* /* request */,
         grpc::ServerWriter<rpc::camera::CaptureInfoResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
+        auto outbox = std::make_shared<StreamOutbox<rpc::camera::CaptureInfoResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeCaptureInfo");
 
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_capture_info(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Camera::CaptureInfo capture_info) {
-                rpc::camera::CaptureInfoResponse rpc_response;
-
-                rpc_response.set_allocated_capture_info(
-                    translateToRpcCaptureInfo(capture_info).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_capture_info(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        plugin->subscribe_capture_info(
+            [outbox](const mavsdk::Camera::CaptureInfo capture_info) {
+                outbox->emplace([&](rpc::camera::CaptureInfoResponse& rpc_response) {
+                    translateToRpcCaptureInfo(capture_info, rpc_response.mutable_capture_info());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_capture_info(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeStatus(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::camera::SubscribeStatusRequest* /* request */,
         grpc::ServerWriter<rpc::camera::StatusResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_status(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Camera::Status status) {
-                rpc::camera::StatusResponse rpc_response;
-
-                rpc_response.set_allocated_camera_status(translateToRpcStatus(status).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_status(nullptr);
+        auto outbox = std::make_shared<StreamOutbox<rpc::camera::StatusResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeStatus");
 
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        plugin->subscribe_status(
+            [outbox](const mavsdk::Camera::Status status) {
+                outbox->emplace([&](rpc::camera::StatusResponse& rpc_response) {
+                    translateToRpcStatus(status, rpc_response.mutable_camera_status());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_status(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeCurrentSettings(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::camera::SubscribeCurrentSettingsRequest* /* request */,
         grpc::ServerWriter<rpc::camera::CurrentSettingsResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_current_settings(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const std::vector<mavsdk::Camera::Setting> current_settings) {
-                rpc::camera::CurrentSettingsResponse rpc_response;
-
-                for (const auto& elem : current_settings) {
-                    auto* ptr = rpc_response.add_current_settings();
-                    ptr->CopyFrom(*translateToRpcSetting(elem).release());
-                }
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_current_settings(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        auto outbox = std::make_shared<StreamOutbox<rpc::camera::CurrentSettingsResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeCurrentSettings");
+
+        plugin->subscribe_current_settings(
+            [outbox](const std::vector<mavsdk::Camera::Setting> current_settings) {
+                outbox->emplace([&](rpc::camera::CurrentSettingsResponse& rpc_response) {
+                    rpc_response.clear_current_settings();
+                    for (const auto& elem : current_settings) {
+                        translateToRpcSetting(elem, rpc_response.add_current_settings());
+                    }
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_current_settings(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribePossibleSettingOptions(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::camera::SubscribePossibleSettingOptionsRequest* /* request */,
         grpc::ServerWriter<rpc::camera::PossibleSettingOptionsResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_possible_setting_options(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const std::vector<mavsdk::Camera::SettingOptions> possible_setting_options) {
-                rpc::camera::PossibleSettingOptionsResponse rpc_response;
-
-                for (const auto& elem : possible_setting_options) {
-                    auto* ptr = rpc_response.add_setting_options();
-                    ptr->CopyFrom(*translateToRpcSettingOptions(elem).release());
-                }
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_possible_setting_options(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        auto outbox = std::make_shared<StreamOutbox<rpc::camera::PossibleSettingOptionsResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribePossibleSettingOptions");
+
+        plugin->subscribe_possible_setting_options(
+            [outbox](const std::vector<mavsdk::Camera::SettingOptions> possible_setting_options) {
+                outbox->emplace([&](rpc::camera::PossibleSettingOptionsResponse& rpc_response) {
+                    rpc_response.clear_setting_options();
+                    for (const auto& elem : possible_setting_options) {
+                        translateToRpcSettingOptions(elem, rpc_response.add_setting_options());
+                    }
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_possible_setting_options(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SetSetting(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::camera::SetSettingRequest* request,
         rpc::camera::SetSettingResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Camera::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1265,7 +1283,7 @@ public:
         }
 
         auto result =
-            _lazy_plugin.maybe_plugin()->set_setting(translateFromRpcSetting(request->setting()));
+            plugin->set_setting(translateFromRpcSetting(request->setting()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -1275,11 +1293,13 @@ public:
     }
 
     grpc::Status GetSetting(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::camera::GetSettingRequest* request,
         rpc::camera::GetSettingResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Camera::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1294,7 +1314,7 @@ public:
         }
 
         auto result =
-            _lazy_plugin.maybe_plugin()->get_setting(translateFromRpcSetting(request->setting()));
+            plugin->get_setting(translateFromRpcSetting(request->setting()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -1306,11 +1326,13 @@ public:
     }
 
     grpc::Status FormatStorage(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::camera::FormatStorageRequest* /* request */,
         rpc::camera::FormatStorageResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Camera::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1319,7 +1341,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->format_storage();
+        auto result = plugin->format_storage();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -1329,11 +1351,13 @@ public:
     }
 
     grpc::Status SelectCamera(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::camera::SelectCameraRequest* request,
         rpc::camera::SelectCameraResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Camera::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1347,7 +1371,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->select_camera(request->camera_id());
+        auto result = plugin->select_camera(request->camera_id());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -1359,32 +1383,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"camera", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -1393,7 +1433,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
@@ -9,11 +9,15 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "stream_writer.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -45,11 +49,10 @@ public:
             rpc_component_information_server_result);
     }
 
-    static std::unique_ptr<rpc::component_information_server::FloatParam>
-    translateToRpcFloatParam(const mavsdk::ComponentInformationServer::FloatParam& float_param)
+    static void translateToRpcFloatParam(
+        const mavsdk::ComponentInformationServer::FloatParam& float_param,
+        rpc::component_information_server::FloatParam* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::component_information_server::FloatParam>();
-
         rpc_obj->set_name(float_param.name);
 
         rpc_obj->set_short_description(float_param.short_description);
@@ -67,7 +70,13 @@ public:
         rpc_obj->set_min_value(float_param.min_value);
 
         rpc_obj->set_max_value(float_param.max_value);
+    }
 
+    static std::unique_ptr<rpc::component_information_server::FloatParam>
+    translateToRpcFloatParam(const mavsdk::ComponentInformationServer::FloatParam& float_param)
+    {
+        auto rpc_obj = std::make_unique<rpc::component_information_server::FloatParam>();
+        translateToRpcFloatParam(float_param, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -97,16 +106,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::component_information_server::FloatParamUpdate>
-    translateToRpcFloatParamUpdate(
-        const mavsdk::ComponentInformationServer::FloatParamUpdate& float_param_update)
+    static void translateToRpcFloatParamUpdate(
+        const mavsdk::ComponentInformationServer::FloatParamUpdate& float_param_update,
+        rpc::component_information_server::FloatParamUpdate* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::component_information_server::FloatParamUpdate>();
-
         rpc_obj->set_name(float_param_update.name);
 
         rpc_obj->set_value(float_param_update.value);
+    }
 
+    static std::unique_ptr<rpc::component_information_server::FloatParamUpdate>
+    translateToRpcFloatParamUpdate(
+        const mavsdk::ComponentInformationServer::FloatParamUpdate& float_param_update)
+    {
+        auto rpc_obj = std::make_unique<rpc::component_information_server::FloatParamUpdate>();
+        translateToRpcFloatParamUpdate(float_param_update, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -185,11 +199,13 @@ public:
     }
 
     grpc::Status ProvideFloatParam(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::component_information_server::ProvideFloatParamRequest* request,
         rpc::component_information_server::ProvideFloatParamResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::ComponentInformationServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -203,8 +219,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->provide_float_param(
-            translateFromRpcFloatParam(request->param()));
+        auto result = plugin->provide_float_param(translateFromRpcFloatParam(request->param()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -214,42 +229,37 @@ public:
     }
 
     grpc::Status SubscribeFloatParam(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::component_information_server::SubscribeFloatParamRequest* /* request */,
         grpc::ServerWriter<rpc::component_information_server::FloatParamResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_float_param(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::ComponentInformationServer::FloatParamUpdate float_param) {
-                rpc::component_information_server::FloatParamResponse rpc_response;
-
-                rpc_response.set_allocated_param_update(
-                    translateToRpcFloatParamUpdate(float_param).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_float_param(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        auto outbox =
+            std::make_shared<StreamOutbox<rpc::component_information_server::FloatParamResponse>>(
+                _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeFloatParam");
+
+        plugin->subscribe_float_param(
+            [outbox](const mavsdk::ComponentInformationServer::FloatParamUpdate float_param) {
+                outbox->emplace(
+                    [&](rpc::component_information_server::FloatParamResponse& rpc_response) {
+                        translateToRpcFloatParamUpdate(
+                            float_param, rpc_response.mutable_param_update());
+                    });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_float_param(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
@@ -257,32 +267,49 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back(
+                    {"component_information_server", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -291,7 +318,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
@@ -8,11 +8,14 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -80,11 +83,9 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::follow_me::Config>
-    translateToRpcConfig(const mavsdk::FollowMe::Config& config)
+    static void translateToRpcConfig(
+        const mavsdk::FollowMe::Config& config, rpc::follow_me::Config* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::follow_me::Config>();
-
         rpc_obj->set_min_height_m(config.min_height_m);
 
         rpc_obj->set_follow_distance_m(config.follow_distance_m);
@@ -92,7 +93,13 @@ public:
         rpc_obj->set_follow_direction(translateToRpcFollowDirection(config.follow_direction));
 
         rpc_obj->set_responsiveness(config.responsiveness);
+    }
 
+    static std::unique_ptr<rpc::follow_me::Config>
+    translateToRpcConfig(const mavsdk::FollowMe::Config& config)
+    {
+        auto rpc_obj = std::make_unique<rpc::follow_me::Config>();
+        translateToRpcConfig(config, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -111,11 +118,10 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::follow_me::TargetLocation>
-    translateToRpcTargetLocation(const mavsdk::FollowMe::TargetLocation& target_location)
+    static void translateToRpcTargetLocation(
+        const mavsdk::FollowMe::TargetLocation& target_location,
+        rpc::follow_me::TargetLocation* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::follow_me::TargetLocation>();
-
         rpc_obj->set_latitude_deg(target_location.latitude_deg);
 
         rpc_obj->set_longitude_deg(target_location.longitude_deg);
@@ -127,7 +133,13 @@ public:
         rpc_obj->set_velocity_y_m_s(target_location.velocity_y_m_s);
 
         rpc_obj->set_velocity_z_m_s(target_location.velocity_z_m_s);
+    }
 
+    static std::unique_ptr<rpc::follow_me::TargetLocation>
+    translateToRpcTargetLocation(const mavsdk::FollowMe::TargetLocation& target_location)
+    {
+        auto rpc_obj = std::make_unique<rpc::follow_me::TargetLocation>();
+        translateToRpcTargetLocation(target_location, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -208,15 +220,17 @@ public:
     }
 
     grpc::Status GetConfig(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::follow_me::GetConfigRequest* /* request */,
         rpc::follow_me::GetConfigResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_config();
+        auto result = plugin->get_config();
 
         if (response != nullptr) {
             response->set_allocated_config(translateToRpcConfig(result).release());
@@ -226,11 +240,13 @@ public:
     }
 
     grpc::Status SetConfig(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::follow_me::SetConfigRequest* request,
         rpc::follow_me::SetConfigResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::FollowMe::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -245,7 +261,7 @@ public:
         }
 
         auto result =
-            _lazy_plugin.maybe_plugin()->set_config(translateFromRpcConfig(request->config()));
+            plugin->set_config(translateFromRpcConfig(request->config()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -255,15 +271,17 @@ public:
     }
 
     grpc::Status IsActive(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::follow_me::IsActiveRequest* /* request */,
         rpc::follow_me::IsActiveResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->is_active();
+        auto result = plugin->is_active();
 
         if (response != nullptr) {
             response->set_is_active(result);
@@ -273,11 +291,13 @@ public:
     }
 
     grpc::Status SetTargetLocation(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::follow_me::SetTargetLocationRequest* request,
         rpc::follow_me::SetTargetLocationResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::FollowMe::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -291,7 +311,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_target_location(
+        auto result = plugin->set_target_location(
             translateFromRpcTargetLocation(request->location()));
 
         if (response != nullptr) {
@@ -302,15 +322,17 @@ public:
     }
 
     grpc::Status GetLastLocation(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::follow_me::GetLastLocationRequest* /* request */,
         rpc::follow_me::GetLastLocationResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_last_location();
+        auto result = plugin->get_last_location();
 
         if (response != nullptr) {
             response->set_allocated_location(translateToRpcTargetLocation(result).release());
@@ -320,11 +342,13 @@ public:
     }
 
     grpc::Status Start(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::follow_me::StartRequest* /* request */,
         rpc::follow_me::StartResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::FollowMe::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -333,7 +357,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->start();
+        auto result = plugin->start();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -343,11 +367,13 @@ public:
     }
 
     grpc::Status Stop(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::follow_me::StopRequest* /* request */,
         rpc::follow_me::StopResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::FollowMe::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -356,7 +382,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->stop();
+        auto result = plugin->stop();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -368,32 +394,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"follow_me", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -402,7 +444,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
@@ -8,11 +8,15 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "stream_writer.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -38,15 +42,19 @@ public:
         response->set_allocated_ftp_result(rpc_ftp_result);
     }
 
-    static std::unique_ptr<rpc::ftp::ProgressData>
-    translateToRpcProgressData(const mavsdk::Ftp::ProgressData& progress_data)
+    static void translateToRpcProgressData(
+        const mavsdk::Ftp::ProgressData& progress_data, rpc::ftp::ProgressData* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::ftp::ProgressData>();
-
         rpc_obj->set_bytes_transferred(progress_data.bytes_transferred);
 
         rpc_obj->set_total_bytes(progress_data.total_bytes);
+    }
 
+    static std::unique_ptr<rpc::ftp::ProgressData>
+    translateToRpcProgressData(const mavsdk::Ftp::ProgressData& progress_data)
+    {
+        auto rpc_obj = std::make_unique<rpc::ftp::ProgressData>();
+        translateToRpcProgressData(progress_data, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -133,11 +141,13 @@ public:
     }
 
     grpc::Status Reset(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::ftp::ResetRequest* /* request */,
         rpc::ftp::ResetResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Ftp::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -149,7 +159,7 @@ public:
         std::promise<mavsdk::Ftp::Result> prom;
         std::future<mavsdk::Ftp::Result> fut = prom.get_future();
 
-        _lazy_plugin.maybe_plugin()->reset_async(
+        plugin->reset_async(
             [&prom](const mavsdk::Ftp::Result result) { prom.set_value(result); });
         auto result = fut.get();
 
@@ -161,11 +171,13 @@ public:
     }
 
     grpc::Status SubscribeDownload(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::ftp::SubscribeDownloadRequest* request,
         grpc::ServerWriter<rpc::ftp::DownloadResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::ftp::DownloadResponse rpc_response;
             auto result = mavsdk::Ftp::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -174,52 +186,42 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox = std::make_shared<StreamOutbox<rpc::ftp::DownloadResponse>>();
+        register_stream_outbox(outbox, "SubscribeDownload");
 
-        _lazy_plugin.maybe_plugin()->download_async(
+        plugin->download_async(
             request->remote_file_path(),
             request->local_dir(),
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                mavsdk::Ftp::Result result, const mavsdk::Ftp::ProgressData download) {
-                rpc::ftp::DownloadResponse rpc_response;
-
-                rpc_response.set_allocated_progress_data(
-                    translateToRpcProgressData(download).release());
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_ftp_result = new rpc::ftp::FtpResult();
-                rpc_ftp_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_ftp_result->set_result_str(ss.str());
-                rpc_response.set_allocated_ftp_result(rpc_ftp_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+            [outbox](mavsdk::Ftp::Result result, const mavsdk::Ftp::ProgressData download) {
+                outbox->emplace([&](rpc::ftp::DownloadResponse& rpc_response) {
+                    translateToRpcProgressData(download, rpc_response.mutable_progress_data());
+
+                    auto* rpc_ftp_result = rpc_response.mutable_ftp_result();
+                    rpc_ftp_result->set_result(translateToRpcResult(result));
+                    std::stringstream ss;
+                    ss << result;
+                    rpc_ftp_result->set_result_str(ss.str());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeUpload(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::ftp::SubscribeUploadRequest* request,
         grpc::ServerWriter<rpc::ftp::UploadResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::ftp::UploadResponse rpc_response;
             auto result = mavsdk::Ftp::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -228,52 +230,42 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
+        auto outbox = std::make_shared<StreamOutbox<rpc::ftp::UploadResponse>>();
+        register_stream_outbox(outbox, "SubscribeUpload");
 
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->upload_async(
+        plugin->upload_async(
             request->local_file_path(),
             request->remote_dir(),
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                mavsdk::Ftp::Result result, const mavsdk::Ftp::ProgressData upload) {
-                rpc::ftp::UploadResponse rpc_response;
-
-                rpc_response.set_allocated_progress_data(
-                    translateToRpcProgressData(upload).release());
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_ftp_result = new rpc::ftp::FtpResult();
-                rpc_ftp_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_ftp_result->set_result_str(ss.str());
-                rpc_response.set_allocated_ftp_result(rpc_ftp_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+            [outbox](mavsdk::Ftp::Result result, const mavsdk::Ftp::ProgressData upload) {
+                outbox->emplace([&](rpc::ftp::UploadResponse& rpc_response) {
+                    translateToRpcProgressData(upload, rpc_response.mutable_progress_data());
+
+                    auto* rpc_ftp_result = rpc_response.mutable_ftp_result();
+                    rpc_ftp_result->set_result(translateToRpcResult(result));
+                    std::stringstream ss;
+                    ss << result;
+                    rpc_ftp_result->set_result_str(ss.str());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status ListDirectory(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::ftp::ListDirectoryRequest* request,
         rpc::ftp::ListDirectoryResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Ftp::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -287,7 +279,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->list_directory(request->remote_dir());
+        auto result = plugin->list_directory(request->remote_dir());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -301,11 +293,13 @@ public:
     }
 
     grpc::Status CreateDirectory(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::ftp::CreateDirectoryRequest* request,
         rpc::ftp::CreateDirectoryResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Ftp::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -319,7 +313,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->create_directory(request->remote_dir());
+        auto result = plugin->create_directory(request->remote_dir());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -329,11 +323,13 @@ public:
     }
 
     grpc::Status RemoveDirectory(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::ftp::RemoveDirectoryRequest* request,
         rpc::ftp::RemoveDirectoryResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Ftp::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -347,7 +343,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->remove_directory(request->remote_dir());
+        auto result = plugin->remove_directory(request->remote_dir());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -357,11 +353,13 @@ public:
     }
 
     grpc::Status RemoveFile(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::ftp::RemoveFileRequest* request,
         rpc::ftp::RemoveFileResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Ftp::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -375,7 +373,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->remove_file(request->remote_file_path());
+        auto result = plugin->remove_file(request->remote_file_path());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -385,11 +383,13 @@ public:
     }
 
     grpc::Status Rename(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::ftp::RenameRequest* request,
         rpc::ftp::RenameResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Ftp::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -403,8 +403,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->rename(
-            request->remote_from_path(), request->remote_to_path());
+        auto result = plugin->rename(request->remote_from_path(), request->remote_to_path());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -414,11 +413,13 @@ public:
     }
 
     grpc::Status AreFilesIdentical(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::ftp::AreFilesIdenticalRequest* request,
         rpc::ftp::AreFilesIdenticalResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Ftp::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -432,7 +433,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->are_files_identical(
+        auto result = plugin->are_files_identical(
             request->local_file_path(), request->remote_file_path());
 
         if (response != nullptr) {
@@ -445,11 +446,13 @@ public:
     }
 
     grpc::Status SetRootDirectory(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::ftp::SetRootDirectoryRequest* request,
         rpc::ftp::SetRootDirectoryResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Ftp::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -463,7 +466,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_root_directory(request->root_dir());
+        auto result = plugin->set_root_directory(request->root_dir());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -473,11 +476,13 @@ public:
     }
 
     grpc::Status SetTargetCompid(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::ftp::SetTargetCompidRequest* request,
         rpc::ftp::SetTargetCompidResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Ftp::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -491,7 +496,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_target_compid(request->compid());
+        auto result = plugin->set_target_compid(request->compid());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -501,15 +506,17 @@ public:
     }
 
     grpc::Status GetOurCompid(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::ftp::GetOurCompidRequest* /* request */,
         rpc::ftp::GetOurCompidResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_our_compid();
+        auto result = plugin->get_our_compid();
 
         if (response != nullptr) {
             response->set_compid(result);
@@ -521,32 +528,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"ftp", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -555,7 +578,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
@@ -8,11 +8,14 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -38,15 +41,19 @@ public:
         response->set_allocated_geofence_result(rpc_geofence_result);
     }
 
-    static std::unique_ptr<rpc::geofence::Point>
-    translateToRpcPoint(const mavsdk::Geofence::Point& point)
+    static void translateToRpcPoint(
+        const mavsdk::Geofence::Point& point, rpc::geofence::Point* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::geofence::Point>();
-
         rpc_obj->set_latitude_deg(point.latitude_deg);
 
         rpc_obj->set_longitude_deg(point.longitude_deg);
+    }
 
+    static std::unique_ptr<rpc::geofence::Point>
+    translateToRpcPoint(const mavsdk::Geofence::Point& point)
+    {
+        auto rpc_obj = std::make_unique<rpc::geofence::Point>();
+        translateToRpcPoint(point, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -89,18 +96,22 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::geofence::Polygon>
-    translateToRpcPolygon(const mavsdk::Geofence::Polygon& polygon)
+    static void translateToRpcPolygon(
+        const mavsdk::Geofence::Polygon& polygon, rpc::geofence::Polygon* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::geofence::Polygon>();
-
+        rpc_obj->clear_points();
         for (const auto& elem : polygon.points) {
-            auto* ptr = rpc_obj->add_points();
-            ptr->CopyFrom(*translateToRpcPoint(elem).release());
+            translateToRpcPoint(elem, rpc_obj->add_points());
         }
 
         rpc_obj->set_fence_type(translateToRpcFenceType(polygon.fence_type));
+    }
 
+    static std::unique_ptr<rpc::geofence::Polygon>
+    translateToRpcPolygon(const mavsdk::Geofence::Polygon& polygon)
+    {
+        auto rpc_obj = std::make_unique<rpc::geofence::Polygon>();
+        translateToRpcPolygon(polygon, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -171,11 +182,13 @@ public:
     }
 
     grpc::Status UploadGeofence(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::geofence::UploadGeofenceRequest* request,
         rpc::geofence::UploadGeofenceResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Geofence::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -194,7 +207,7 @@ public:
             polygons_vec.push_back(translateFromRpcPolygon(elem));
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->upload_geofence(polygons_vec);
+        auto result = plugin->upload_geofence(polygons_vec);
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -204,11 +217,13 @@ public:
     }
 
     grpc::Status ClearGeofence(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::geofence::ClearGeofenceRequest* /* request */,
         rpc::geofence::ClearGeofenceResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Geofence::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -217,7 +232,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->clear_geofence();
+        auto result = plugin->clear_geofence();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -229,32 +244,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"geofence", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -263,7 +294,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
@@ -8,11 +8,15 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "stream_writer.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -98,11 +102,9 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::gimbal::ControlStatus>
-    translateToRpcControlStatus(const mavsdk::Gimbal::ControlStatus& control_status)
+    static void translateToRpcControlStatus(
+        const mavsdk::Gimbal::ControlStatus& control_status, rpc::gimbal::ControlStatus* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::gimbal::ControlStatus>();
-
         rpc_obj->set_control_mode(translateToRpcControlMode(control_status.control_mode));
 
         rpc_obj->set_sysid_primary_control(control_status.sysid_primary_control);
@@ -112,7 +114,13 @@ public:
         rpc_obj->set_sysid_secondary_control(control_status.sysid_secondary_control);
 
         rpc_obj->set_compid_secondary_control(control_status.compid_secondary_control);
+    }
 
+    static std::unique_ptr<rpc::gimbal::ControlStatus>
+    translateToRpcControlStatus(const mavsdk::Gimbal::ControlStatus& control_status)
+    {
+        auto rpc_obj = std::make_unique<rpc::gimbal::ControlStatus>();
+        translateToRpcControlStatus(control_status, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -179,11 +187,13 @@ public:
     }
 
     grpc::Status SetPitchAndYaw(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::gimbal::SetPitchAndYawRequest* request,
         rpc::gimbal::SetPitchAndYawResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Gimbal::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -197,8 +207,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_pitch_and_yaw(
-            request->pitch_deg(), request->yaw_deg());
+        auto result = plugin->set_pitch_and_yaw(request->pitch_deg(), request->yaw_deg());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -208,11 +217,13 @@ public:
     }
 
     grpc::Status SetPitchRateAndYawRate(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::gimbal::SetPitchRateAndYawRateRequest* request,
         rpc::gimbal::SetPitchRateAndYawRateResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Gimbal::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -226,7 +237,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_pitch_rate_and_yaw_rate(
+        auto result = plugin->set_pitch_rate_and_yaw_rate(
             request->pitch_rate_deg_s(), request->yaw_rate_deg_s());
 
         if (response != nullptr) {
@@ -237,11 +248,13 @@ public:
     }
 
     grpc::Status SetMode(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::gimbal::SetModeRequest* request,
         rpc::gimbal::SetModeResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Gimbal::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -255,8 +268,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_mode(
-            translateFromRpcGimbalMode(request->gimbal_mode()));
+        auto result = plugin->set_mode(translateFromRpcGimbalMode(request->gimbal_mode()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -266,11 +278,13 @@ public:
     }
 
     grpc::Status SetRoiLocation(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::gimbal::SetRoiLocationRequest* request,
         rpc::gimbal::SetRoiLocationResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Gimbal::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -284,7 +298,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_roi_location(
+        auto result = plugin->set_roi_location(
             request->latitude_deg(), request->longitude_deg(), request->altitude_m());
 
         if (response != nullptr) {
@@ -295,11 +309,13 @@ public:
     }
 
     grpc::Status TakeControl(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::gimbal::TakeControlRequest* request,
         rpc::gimbal::TakeControlResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Gimbal::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -313,8 +329,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->take_control(
-            translateFromRpcControlMode(request->control_mode()));
+        auto result = plugin->take_control(translateFromRpcControlMode(request->control_mode()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -324,11 +339,13 @@ public:
     }
 
     grpc::Status ReleaseControl(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::gimbal::ReleaseControlRequest* /* request */,
         rpc::gimbal::ReleaseControlResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Gimbal::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -337,7 +354,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->release_control();
+        auto result = plugin->release_control();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -347,42 +364,34 @@ public:
     }
 
     grpc::Status SubscribeControl(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::gimbal::SubscribeControlRequest* /* request */,
         grpc::ServerWriter<rpc::gimbal::ControlResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_control(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Gimbal::ControlStatus control) {
-                rpc::gimbal::ControlResponse rpc_response;
+        auto outbox = std::make_shared<StreamOutbox<rpc::gimbal::ControlResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeControl");
 
-                rpc_response.set_allocated_control_status(
-                    translateToRpcControlStatus(control).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_control(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        plugin->subscribe_control(
+            [outbox](const mavsdk::Gimbal::ControlStatus control) {
+                outbox->emplace([&](rpc::gimbal::ControlResponse& rpc_response) {
+                    translateToRpcControlStatus(control, rpc_response.mutable_control_status());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_control(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
@@ -390,32 +399,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"gimbal", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -424,7 +449,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
@@ -8,11 +8,14 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -38,15 +41,19 @@ public:
         response->set_allocated_info_result(rpc_info_result);
     }
 
-    static std::unique_ptr<rpc::info::FlightInfo>
-    translateToRpcFlightInfo(const mavsdk::Info::FlightInfo& flight_info)
+    static void translateToRpcFlightInfo(
+        const mavsdk::Info::FlightInfo& flight_info, rpc::info::FlightInfo* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::info::FlightInfo>();
-
         rpc_obj->set_time_boot_ms(flight_info.time_boot_ms);
 
         rpc_obj->set_flight_uid(flight_info.flight_uid);
+    }
 
+    static std::unique_ptr<rpc::info::FlightInfo>
+    translateToRpcFlightInfo(const mavsdk::Info::FlightInfo& flight_info)
+    {
+        auto rpc_obj = std::make_unique<rpc::info::FlightInfo>();
+        translateToRpcFlightInfo(flight_info, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -62,15 +69,19 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::info::Identification>
-    translateToRpcIdentification(const mavsdk::Info::Identification& identification)
+    static void translateToRpcIdentification(
+        const mavsdk::Info::Identification& identification, rpc::info::Identification* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::info::Identification>();
-
         rpc_obj->set_hardware_uid(identification.hardware_uid);
 
         rpc_obj->set_legacy_uid(identification.legacy_uid);
+    }
 
+    static std::unique_ptr<rpc::info::Identification>
+    translateToRpcIdentification(const mavsdk::Info::Identification& identification)
+    {
+        auto rpc_obj = std::make_unique<rpc::info::Identification>();
+        translateToRpcIdentification(identification, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -86,11 +97,9 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::info::Product>
-    translateToRpcProduct(const mavsdk::Info::Product& product)
+    static void translateToRpcProduct(
+        const mavsdk::Info::Product& product, rpc::info::Product* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::info::Product>();
-
         rpc_obj->set_vendor_id(product.vendor_id);
 
         rpc_obj->set_vendor_name(product.vendor_name);
@@ -98,7 +107,13 @@ public:
         rpc_obj->set_product_id(product.product_id);
 
         rpc_obj->set_product_name(product.product_name);
+    }
 
+    static std::unique_ptr<rpc::info::Product>
+    translateToRpcProduct(const mavsdk::Info::Product& product)
+    {
+        auto rpc_obj = std::make_unique<rpc::info::Product>();
+        translateToRpcProduct(product, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -117,11 +132,9 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::info::Version>
-    translateToRpcVersion(const mavsdk::Info::Version& version)
+    static void translateToRpcVersion(
+        const mavsdk::Info::Version& version, rpc::info::Version* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::info::Version>();
-
         rpc_obj->set_flight_sw_major(version.flight_sw_major);
 
         rpc_obj->set_flight_sw_minor(version.flight_sw_minor);
@@ -143,7 +156,13 @@ public:
         rpc_obj->set_flight_sw_git_hash(version.flight_sw_git_hash);
 
         rpc_obj->set_os_sw_git_hash(version.os_sw_git_hash);
+    }
 
+    static std::unique_ptr<rpc::info::Version>
+    translateToRpcVersion(const mavsdk::Info::Version& version)
+    {
+        auto rpc_obj = std::make_unique<rpc::info::Version>();
+        translateToRpcVersion(version, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -211,11 +230,13 @@ public:
     }
 
     grpc::Status GetFlightInformation(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::info::GetFlightInformationRequest* /* request */,
         rpc::info::GetFlightInformationResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Info::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -224,7 +245,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_flight_information();
+        auto result = plugin->get_flight_information();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -236,11 +257,13 @@ public:
     }
 
     grpc::Status GetIdentification(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::info::GetIdentificationRequest* /* request */,
         rpc::info::GetIdentificationResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Info::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -249,7 +272,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_identification();
+        auto result = plugin->get_identification();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -262,11 +285,13 @@ public:
     }
 
     grpc::Status GetProduct(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::info::GetProductRequest* /* request */,
         rpc::info::GetProductResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Info::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -275,7 +300,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_product();
+        auto result = plugin->get_product();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -287,11 +312,13 @@ public:
     }
 
     grpc::Status GetVersion(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::info::GetVersionRequest* /* request */,
         rpc::info::GetVersionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Info::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -300,7 +327,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_version();
+        auto result = plugin->get_version();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -312,11 +339,13 @@ public:
     }
 
     grpc::Status GetSpeedFactor(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::info::GetSpeedFactorRequest* /* request */,
         rpc::info::GetSpeedFactorResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Info::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -325,7 +354,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_speed_factor();
+        auto result = plugin->get_speed_factor();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -339,32 +368,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"info", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -373,7 +418,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
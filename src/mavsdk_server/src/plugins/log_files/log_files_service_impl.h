@@ -8,11 +8,15 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "stream_writer.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -38,13 +42,17 @@ public:
         response->set_allocated_log_files_result(rpc_log_files_result);
     }
 
+    static void translateToRpcProgressData(
+        const mavsdk::LogFiles::ProgressData& progress_data, rpc::log_files::ProgressData* rpc_obj)
+    {
+        rpc_obj->set_progress(progress_data.progress);
+    }
+
     static std::unique_ptr<rpc::log_files::ProgressData>
     translateToRpcProgressData(const mavsdk::LogFiles::ProgressData& progress_data)
     {
         auto rpc_obj = std::make_unique<rpc::log_files::ProgressData>();
-
-        rpc_obj->set_progress(progress_data.progress);
-
+        translateToRpcProgressData(progress_data, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -58,17 +66,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::log_files::Entry>
-    translateToRpcEntry(const mavsdk::LogFiles::Entry& entry)
+    static void translateToRpcEntry(
+        const mavsdk::LogFiles::Entry& entry, rpc::log_files::Entry* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::log_files::Entry>();
-
         rpc_obj->set_id(entry.id);
 
         rpc_obj->set_date(entry.date);
 
         rpc_obj->set_size_bytes(entry.size_bytes);
+    }
 
+    static std::unique_ptr<rpc::log_files::Entry>
+    translateToRpcEntry(const mavsdk::LogFiles::Entry& entry)
+    {
+        auto rpc_obj = std::make_unique<rpc::log_files::Entry>();
+        translateToRpcEntry(entry, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -138,11 +150,13 @@ public:
     }
 
     grpc::Status GetEntries(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::log_files::GetEntriesRequest* /* request */,
         rpc::log_files::GetEntriesResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::LogFiles::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -151,14 +165,13 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_entries();
+        auto result = plugin->get_entries();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
 
             for (auto elem : result.second) {
-                auto* ptr = response->add_entries();
-                ptr->CopyFrom(*translateToRpcEntry(elem).release());
+                translateToRpcEntry(elem, response->add_entries());
             }
         }
 
@@ -166,11 +179,13 @@ public:
     }
 
     grpc::Status SubscribeDownloadLogFile(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::log_files::SubscribeDownloadLogFileRequest* request,
         grpc::ServerWriter<rpc::log_files::DownloadLogFileResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::log_files::DownloadLogFileResponse rpc_response;
             auto result = mavsdk::LogFiles::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -179,43 +194,32 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox = std::make_shared<StreamOutbox<rpc::log_files::DownloadLogFileResponse>>();
+        register_stream_outbox(outbox, "SubscribeDownloadLogFile");
 
-        _lazy_plugin.maybe_plugin()->download_log_file_async(
+        plugin->download_log_file_async(
             translateFromRpcEntry(request->entry()),
             request->path(),
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
+            [outbox](
                 mavsdk::LogFiles::Result result,
                 const mavsdk::LogFiles::ProgressData download_log_file) {
-                rpc::log_files::DownloadLogFileResponse rpc_response;
-
-                rpc_response.set_allocated_progress(
-                    translateToRpcProgressData(download_log_file).release());
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_log_files_result = new rpc::log_files::LogFilesResult();
-                rpc_log_files_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_log_files_result->set_result_str(ss.str());
-                rpc_response.set_allocated_log_files_result(rpc_log_files_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+                outbox->emplace([&](rpc::log_files::DownloadLogFileResponse& rpc_response) {
+                    translateToRpcProgressData(download_log_file, rpc_response.mutable_progress());
+
+                    auto* rpc_log_files_result = rpc_response.mutable_log_files_result();
+                    rpc_log_files_result->set_result(translateToRpcResult(result));
+                    std::stringstream ss;
+                    ss << result;
+                    rpc_log_files_result->set_result_str(ss.str());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
@@ -223,32 +227,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"log_files", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -257,7 +277,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
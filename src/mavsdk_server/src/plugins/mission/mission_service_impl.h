@@ -8,11 +8,15 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "stream_writer.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -90,11 +94,9 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::mission::MissionItem>
-    translateToRpcMissionItem(const mavsdk::Mission::MissionItem& mission_item)
+    static void translateToRpcMissionItem(
+        const mavsdk::Mission::MissionItem& mission_item, rpc::mission::MissionItem* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mission::MissionItem>();
-
         rpc_obj->set_latitude_deg(mission_item.latitude_deg);
 
         rpc_obj->set_longitude_deg(mission_item.longitude_deg);
@@ -120,7 +122,13 @@ public:
         rpc_obj->set_yaw_deg(mission_item.yaw_deg);
 
         rpc_obj->set_camera_photo_distance_m(mission_item.camera_photo_distance_m);
+    }
 
+    static std::unique_ptr<rpc::mission::MissionItem>
+    translateToRpcMissionItem(const mavsdk::Mission::MissionItem& mission_item)
+    {
+        auto rpc_obj = std::make_unique<rpc::mission::MissionItem>();
+        translateToRpcMissionItem(mission_item, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -158,16 +166,20 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::mission::MissionPlan>
-    translateToRpcMissionPlan(const mavsdk::Mission::MissionPlan& mission_plan)
+    static void translateToRpcMissionPlan(
+        const mavsdk::Mission::MissionPlan& mission_plan, rpc::mission::MissionPlan* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mission::MissionPlan>();
-
+        rpc_obj->clear_mission_items();
         for (const auto& elem : mission_plan.mission_items) {
-            auto* ptr = rpc_obj->add_mission_items();
-            ptr->CopyFrom(*translateToRpcMissionItem(elem).release());
+            translateToRpcMissionItem(elem, rpc_obj->add_mission_items());
         }
+    }
 
+    static std::unique_ptr<rpc::mission::MissionPlan>
+    translateToRpcMissionPlan(const mavsdk::Mission::MissionPlan& mission_plan)
+    {
+        auto rpc_obj = std::make_unique<rpc::mission::MissionPlan>();
+        translateToRpcMissionPlan(mission_plan, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -184,15 +196,20 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::mission::MissionProgress>
-    translateToRpcMissionProgress(const mavsdk::Mission::MissionProgress& mission_progress)
+    static void translateToRpcMissionProgress(
+        const mavsdk::Mission::MissionProgress& mission_progress,
+        rpc::mission::MissionProgress* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mission::MissionProgress>();
-
         rpc_obj->set_current(mission_progress.current);
 
         rpc_obj->set_total(mission_progress.total);
+    }
 
+    static std::unique_ptr<rpc::mission::MissionProgress>
+    translateToRpcMissionProgress(const mavsdk::Mission::MissionProgress& mission_progress)
+    {
+        auto rpc_obj = std::make_unique<rpc::mission::MissionProgress>();
+        translateToRpcMissionProgress(mission_progress, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -280,13 +297,17 @@ public:
         }
     }
 
+    static void translateToRpcProgressData(
+        const mavsdk::Mission::ProgressData& progress_data, rpc::mission::ProgressData* rpc_obj)
+    {
+        rpc_obj->set_progress(progress_data.progress);
+    }
+
     static std::unique_ptr<rpc::mission::ProgressData>
     translateToRpcProgressData(const mavsdk::Mission::ProgressData& progress_data)
     {
         auto rpc_obj = std::make_unique<rpc::mission::ProgressData>();
-
-        rpc_obj->set_progress(progress_data.progress);
-
+        translateToRpcProgressData(progress_data, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -300,20 +321,25 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::mission::ProgressDataOrMission> translateToRpcProgressDataOrMission(
-        const mavsdk::Mission::ProgressDataOrMission& progress_data_or_mission)
+    static void translateToRpcProgressDataOrMission(
+        const mavsdk::Mission::ProgressDataOrMission& progress_data_or_mission,
+        rpc::mission::ProgressDataOrMission* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mission::ProgressDataOrMission>();
-
         rpc_obj->set_has_progress(progress_data_or_mission.has_progress);
 
         rpc_obj->set_progress(progress_data_or_mission.progress);
 
         rpc_obj->set_has_mission(progress_data_or_mission.has_mission);
 
-        rpc_obj->set_allocated_mission_plan(
-            translateToRpcMissionPlan(progress_data_or_mission.mission_plan).release());
+        translateToRpcMissionPlan(
+            progress_data_or_mission.mission_plan, rpc_obj->mutable_mission_plan());
+    }
 
+    static std::unique_ptr<rpc::mission::ProgressDataOrMission> translateToRpcProgressDataOrMission(
+        const mavsdk::Mission::ProgressDataOrMission& progress_data_or_mission)
+    {
+        auto rpc_obj = std::make_unique<rpc::mission::ProgressDataOrMission>();
+        translateToRpcProgressDataOrMission(progress_data_or_mission, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -334,11 +360,13 @@ public:
     }
 
     grpc::Status UploadMission(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission::UploadMissionRequest* request,
         rpc::mission::UploadMissionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Mission::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -352,8 +380,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->upload_mission(
-            translateFromRpcMissionPlan(request->mission_plan()));
+        auto result = plugin->upload_mission(translateFromRpcMissionPlan(request->mission_plan()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -363,11 +390,13 @@ public:
     }
 
     grpc::Status SubscribeUploadMissionWithProgress(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::mission::SubscribeUploadMissionWithProgressRequest* request,
         grpc::ServerWriter<rpc::mission::UploadMissionWithProgressResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::mission::UploadMissionWithProgressResponse rpc_response;
             auto result = mavsdk::Mission::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -376,52 +405,45 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
+        auto outbox =
+            std::make_shared<StreamOutbox<rpc::mission::UploadMissionWithProgressResponse>>();
+        register_stream_outbox(outbox, "SubscribeUploadMissionWithProgress");
 
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->upload_mission_with_progress_async(
+        plugin->upload_mission_with_progress_async(
             translateFromRpcMissionPlan(request->mission_plan()),
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
+            [outbox](
                 mavsdk::Mission::Result result,
                 const mavsdk::Mission::ProgressData upload_mission_with_progress) {
-                rpc::mission::UploadMissionWithProgressResponse rpc_response;
-
-                rpc_response.set_allocated_progress_data(
-                    translateToRpcProgressData(upload_mission_with_progress).release());
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_mission_result = new rpc::mission::MissionResult();
-                rpc_mission_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_mission_result->set_result_str(ss.str());
-                rpc_response.set_allocated_mission_result(rpc_mission_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+                outbox->emplace([&](rpc::mission::UploadMissionWithProgressResponse& rpc_response) {
+                    translateToRpcProgressData(
+                        upload_mission_with_progress, rpc_response.mutable_progress_data());
+
+                    auto* rpc_mission_result = rpc_response.mutable_mission_result();
+                    rpc_mission_result->set_result(translateToRpcResult(result));
+                    std::stringstream ss;
+                    ss << result;
+                    rpc_mission_result->set_result_str(ss.str());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status CancelMissionUpload(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission::CancelMissionUploadRequest* /* request */,
         rpc::mission::CancelMissionUploadResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Mission::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -430,7 +452,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->cancel_mission_upload();
+        auto result = plugin->cancel_mission_upload();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -440,11 +462,13 @@ public:
     }
 
     grpc::Status DownloadMission(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission::DownloadMissionRequest* /* request */,
         rpc::mission::DownloadMissionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Mission::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -453,7 +477,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->download_mission();
+        auto result = plugin->download_mission();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -466,11 +490,13 @@ public:
     }
 
     grpc::Status SubscribeDownloadMissionWithProgress(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::mission::SubscribeDownloadMissionWithProgressRequest* /* request */,
         grpc::ServerWriter<rpc::mission::DownloadMissionWithProgressResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::mission::DownloadMissionWithProgressResponse rpc_response;
             auto result = mavsdk::Mission::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -479,51 +505,45 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
+        auto outbox =
+            std::make_shared<StreamOutbox<rpc::mission::DownloadMissionWithProgressResponse>>();
+        register_stream_outbox(outbox, "SubscribeDownloadMissionWithProgress");
 
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->download_mission_with_progress_async(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
+        plugin->download_mission_with_progress_async(
+            [outbox](
                 mavsdk::Mission::Result result,
                 const mavsdk::Mission::ProgressDataOrMission download_mission_with_progress) {
-                rpc::mission::DownloadMissionWithProgressResponse rpc_response;
-
-                rpc_response.set_allocated_progress_data(
-                    translateToRpcProgressDataOrMission(download_mission_with_progress).release());
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_mission_result = new rpc::mission::MissionResult();
-                rpc_mission_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_mission_result->set_result_str(ss.str());
-                rpc_response.set_allocated_mission_result(rpc_mission_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+                outbox->emplace(
+                    [&](rpc::mission::DownloadMissionWithProgressResponse& rpc_response) {
+                        translateToRpcProgressDataOrMission(
+                            download_mission_with_progress, rpc_response.mutable_progress_data());
+
+                        auto* rpc_mission_result = rpc_response.mutable_mission_result();
+                        rpc_mission_result->set_result(translateToRpcResult(result));
+                        std::stringstream ss;
+                        ss << result;
+                        rpc_mission_result->set_result_str(ss.str());
+                    });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status CancelMissionDownload(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission::CancelMissionDownloadRequest* /* request */,
         rpc::mission::CancelMissionDownloadResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Mission::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -532,7 +552,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->cancel_mission_download();
+        auto result = plugin->cancel_mission_download();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -542,11 +562,13 @@ public:
     }
 
     grpc::Status StartMission(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission::StartMissionRequest* /* request */,
         rpc::mission::StartMissionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Mission::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -555,7 +577,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->start_mission();
+        auto result = plugin->start_mission();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -565,11 +587,13 @@ public:
     }
 
     grpc::Status PauseMission(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission::PauseMissionRequest* /* request */,
         rpc::mission::PauseMissionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Mission::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -578,7 +602,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->pause_mission();
+        auto result = plugin->pause_mission();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -588,11 +612,13 @@ public:
     }
 
     grpc::Status ClearMission(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission::ClearMissionRequest* /* request */,
         rpc::mission::ClearMissionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Mission::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -601,7 +627,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->clear_mission();
+        auto result = plugin->clear_mission();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -611,11 +637,13 @@ public:
     }
 
     grpc::Status SetCurrentMissionItem(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission::SetCurrentMissionItemRequest* request,
         rpc::mission::SetCurrentMissionItemResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Mission::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -629,7 +657,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_current_mission_item(request->index());
+        auto result = plugin->set_current_mission_item(request->index());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -639,11 +667,13 @@ public:
     }
 
     grpc::Status IsMissionFinished(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission::IsMissionFinishedRequest* /* request */,
         rpc::mission::IsMissionFinishedResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Mission::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -652,7 +682,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->is_mission_finished();
+        auto result = plugin->is_mission_finished();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -664,52 +694,47 @@ public:
     }
 
     grpc::Status SubscribeMissionProgress(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::mission::SubscribeMissionProgressRequest* /* request */,
         grpc::ServerWriter<rpc::mission::MissionProgressResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_mission_progress(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Mission::MissionProgress mission_progress) {
-                rpc::mission::MissionProgressResponse rpc_response;
-
-                rpc_response.set_allocated_mission_progress(
-                    translateToRpcMissionProgress(mission_progress).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_mission_progress(nullptr);
+        auto outbox = std::make_shared<StreamOutbox<rpc::mission::MissionProgressResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeMissionProgress");
 
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        plugin->subscribe_mission_progress(
+            [outbox](const mavsdk::Mission::MissionProgress mission_progress) {
+                outbox->emplace([&](rpc::mission::MissionProgressResponse& rpc_response) {
+                    translateToRpcMissionProgress(
+                        mission_progress, rpc_response.mutable_mission_progress());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_mission_progress(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status GetReturnToLaunchAfterMission(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission::GetReturnToLaunchAfterMissionRequest* /* request */,
         rpc::mission::GetReturnToLaunchAfterMissionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Mission::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -718,7 +743,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_return_to_launch_after_mission();
+        auto result = plugin->get_return_to_launch_after_mission();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -730,11 +755,13 @@ public:
     }
 
     grpc::Status SetReturnToLaunchAfterMission(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission::SetReturnToLaunchAfterMissionRequest* request,
         rpc::mission::SetReturnToLaunchAfterMissionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Mission::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -749,7 +776,7 @@ public:
         }
 
         auto result =
-            _lazy_plugin.maybe_plugin()->set_return_to_launch_after_mission(request->enable());
+            plugin->set_return_to_launch_after_mission(request->enable());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -761,32 +788,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"mission", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -795,7 +838,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
@@ -8,11 +8,15 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "stream_writer.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -38,15 +42,20 @@ public:
         response->set_allocated_mission_raw_result(rpc_mission_raw_result);
     }
 
-    static std::unique_ptr<rpc::mission_raw::MissionProgress>
-    translateToRpcMissionProgress(const mavsdk::MissionRaw::MissionProgress& mission_progress)
+    static void translateToRpcMissionProgress(
+        const mavsdk::MissionRaw::MissionProgress& mission_progress,
+        rpc::mission_raw::MissionProgress* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mission_raw::MissionProgress>();
-
         rpc_obj->set_current(mission_progress.current);
 
         rpc_obj->set_total(mission_progress.total);
+    }
 
+    static std::unique_ptr<rpc::mission_raw::MissionProgress>
+    translateToRpcMissionProgress(const mavsdk::MissionRaw::MissionProgress& mission_progress)
+    {
+        auto rpc_obj = std::make_unique<rpc::mission_raw::MissionProgress>();
+        translateToRpcMissionProgress(mission_progress, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -62,11 +71,9 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::mission_raw::MissionItem>
-    translateToRpcMissionItem(const mavsdk::MissionRaw::MissionItem& mission_item)
+    static void translateToRpcMissionItem(
+        const mavsdk::MissionRaw::MissionItem& mission_item, rpc::mission_raw::MissionItem* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mission_raw::MissionItem>();
-
         rpc_obj->set_seq(mission_item.seq);
 
         rpc_obj->set_frame(mission_item.frame);
@@ -92,7 +99,13 @@ public:
         rpc_obj->set_z(mission_item.z);
 
         rpc_obj->set_mission_type(mission_item.mission_type);
+    }
 
+    static std::unique_ptr<rpc::mission_raw::MissionItem>
+    translateToRpcMissionItem(const mavsdk::MissionRaw::MissionItem& mission_item)
+    {
+        auto rpc_obj = std::make_unique<rpc::mission_raw::MissionItem>();
+        translateToRpcMissionItem(mission_item, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -130,26 +143,31 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::mission_raw::MissionImportData> translateToRpcMissionImportData(
-        const mavsdk::MissionRaw::MissionImportData& mission_import_data)
+    static void translateToRpcMissionImportData(
+        const mavsdk::MissionRaw::MissionImportData& mission_import_data,
+        rpc::mission_raw::MissionImportData* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mission_raw::MissionImportData>();
-
+        rpc_obj->clear_mission_items();
         for (const auto& elem : mission_import_data.mission_items) {
-            auto* ptr = rpc_obj->add_mission_items();
-            ptr->CopyFrom(*translateToRpcMissionItem(elem).release());
+            translateToRpcMissionItem(elem, rpc_obj->add_mission_items());
         }
 
+        rpc_obj->clear_geofence_items();
         for (const auto& elem : mission_import_data.geofence_items) {
-            auto* ptr = rpc_obj->add_geofence_items();
-            ptr->CopyFrom(*translateToRpcMissionItem(elem).release());
+            translateToRpcMissionItem(elem, rpc_obj->add_geofence_items());
         }
 
+        rpc_obj->clear_rally_items();
         for (const auto& elem : mission_import_data.rally_items) {
-            auto* ptr = rpc_obj->add_rally_items();
-            ptr->CopyFrom(*translateToRpcMissionItem(elem).release());
+            translateToRpcMissionItem(elem, rpc_obj->add_rally_items());
         }
+    }
 
+    static std::unique_ptr<rpc::mission_raw::MissionImportData> translateToRpcMissionImportData(
+        const mavsdk::MissionRaw::MissionImportData& mission_import_data)
+    {
+        auto rpc_obj = std::make_unique<rpc::mission_raw::MissionImportData>();
+        translateToRpcMissionImportData(mission_import_data, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -249,11 +267,13 @@ public:
     }
 
     grpc::Status UploadMission(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission_raw::UploadMissionRequest* request,
         rpc::mission_raw::UploadMissionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::MissionRaw::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -272,7 +292,7 @@ public:
             mission_items_vec.push_back(translateFromRpcMissionItem(elem));
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->upload_mission(mission_items_vec);
+        auto result = plugin->upload_mission(mission_items_vec);
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -282,11 +302,13 @@ public:
     }
 
     grpc::Status CancelMissionUpload(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission_raw::CancelMissionUploadRequest* /* request */,
         rpc::mission_raw::CancelMissionUploadResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::MissionRaw::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -295,7 +317,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->cancel_mission_upload();
+        auto result = plugin->cancel_mission_upload();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -305,11 +327,13 @@ public:
     }
 
     grpc::Status DownloadMission(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission_raw::DownloadMissionRequest* /* request */,
         rpc::mission_raw::DownloadMissionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::MissionRaw::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -318,14 +342,13 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->download_mission();
+        auto result = plugin->download_mission();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
 
             for (auto elem : result.second) {
-                auto* ptr = response->add_mission_items();
-                ptr->CopyFrom(*translateToRpcMissionItem(elem).release());
+                translateToRpcMissionItem(elem, response->add_mission_items());
             }
         }
 
@@ -333,11 +356,13 @@ public:
     }
 
     grpc::Status CancelMissionDownload(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission_raw::CancelMissionDownloadRequest* /* request */,
         rpc::mission_raw::CancelMissionDownloadResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::MissionRaw::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -346,7 +371,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->cancel_mission_download();
+        auto result = plugin->cancel_mission_download();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -356,11 +381,13 @@ public:
     }
 
     grpc::Status StartMission(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission_raw::StartMissionRequest* /* request */,
         rpc::mission_raw::StartMissionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::MissionRaw::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -369,7 +396,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->start_mission();
+        auto result = plugin->start_mission();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -379,11 +406,13 @@ public:
     }
 
     grpc::Status PauseMission(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission_raw::PauseMissionRequest* /* request */,
         rpc::mission_raw::PauseMissionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::MissionRaw::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -392,7 +421,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->pause_mission();
+        auto result = plugin->pause_mission();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -402,11 +431,13 @@ public:
     }
 
     grpc::Status ClearMission(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission_raw::ClearMissionRequest* /* request */,
         rpc::mission_raw::ClearMissionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::MissionRaw::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -415,7 +446,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->clear_mission();
+        auto result = plugin->clear_mission();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -425,11 +456,13 @@ public:
     }
 
     grpc::Status SetCurrentMissionItem(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission_raw::SetCurrentMissionItemRequest* request,
         rpc::mission_raw::SetCurrentMissionItemResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::MissionRaw::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -443,7 +476,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_current_mission_item(request->index());
+        auto result = plugin->set_current_mission_item(request->index());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -453,92 +486,80 @@ public:
     }
 
     grpc::Status SubscribeMissionProgress(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::mission_raw::SubscribeMissionProgressRequest* /* request */,
         grpc::ServerWriter<rpc::mission_raw::MissionProgressResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_mission_progress(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::MissionRaw::MissionProgress mission_progress) {
-                rpc::mission_raw::MissionProgressResponse rpc_response;
+        auto outbox = std::make_shared<StreamOutbox<rpc::mission_raw::MissionProgressResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeMissionProgress");
 
-                rpc_response.set_allocated_mission_progress(
-                    translateToRpcMissionProgress(mission_progress).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_mission_progress(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        plugin->subscribe_mission_progress(
+            [outbox](const mavsdk::MissionRaw::MissionProgress mission_progress) {
+                outbox->emplace([&](rpc::mission_raw::MissionProgressResponse& rpc_response) {
+                    translateToRpcMissionProgress(
+                        mission_progress, rpc_response.mutable_mission_progress());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_mission_progress(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeMissionChanged(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::mission_raw::SubscribeMissionChangedRequest* /* request */,
         grpc::ServerWriter<rpc::mission_raw::MissionChangedResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_mission_changed(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const bool mission_changed) {
-                rpc::mission_raw::MissionChangedResponse rpc_response;
-
-                rpc_response.set_mission_changed(mission_changed);
+        auto outbox = std::make_shared<StreamOutbox<rpc::mission_raw::MissionChangedResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeMissionChanged");
 
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_mission_changed(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        plugin->subscribe_mission_changed(
+            [outbox](const bool mission_changed) {
+                outbox->emplace([&](rpc::mission_raw::MissionChangedResponse& rpc_response) {
+                    rpc_response.set_mission_changed(mission_changed);
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_mission_changed(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status ImportQgroundcontrolMission(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission_raw::ImportQgroundcontrolMissionRequest* request,
         rpc::mission_raw::ImportQgroundcontrolMissionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::MissionRaw::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -553,7 +574,7 @@ public:
         }
 
         auto result =
-            _lazy_plugin.maybe_plugin()->import_qgroundcontrol_mission(request->qgc_plan_path());
+            plugin->import_qgroundcontrol_mission(request->qgc_plan_path());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -568,32 +589,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"mission_raw", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -602,7 +639,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
@@ -9,11 +9,15 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "stream_writer.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -39,11 +43,10 @@ public:
         response->set_allocated_mission_server_result(rpc_mission_server_result);
     }
 
-    static std::unique_ptr<rpc::mission_server::MissionItem>
-    translateToRpcMissionItem(const mavsdk::MissionServer::MissionItem& mission_item)
+    static void translateToRpcMissionItem(
+        const mavsdk::MissionServer::MissionItem& mission_item,
+        rpc::mission_server::MissionItem* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mission_server::MissionItem>();
-
         rpc_obj->set_seq(mission_item.seq);
 
         rpc_obj->set_frame(mission_item.frame);
@@ -69,7 +72,13 @@ public:
         rpc_obj->set_z(mission_item.z);
 
         rpc_obj->set_mission_type(mission_item.mission_type);
+    }
 
+    static std::unique_ptr<rpc::mission_server::MissionItem>
+    translateToRpcMissionItem(const mavsdk::MissionServer::MissionItem& mission_item)
+    {
+        auto rpc_obj = std::make_unique<rpc::mission_server::MissionItem>();
+        translateToRpcMissionItem(mission_item, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -107,16 +116,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::mission_server::MissionPlan>
-    translateToRpcMissionPlan(const mavsdk::MissionServer::MissionPlan& mission_plan)
+    static void translateToRpcMissionPlan(
+        const mavsdk::MissionServer::MissionPlan& mission_plan,
+        rpc::mission_server::MissionPlan* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mission_server::MissionPlan>();
-
+        rpc_obj->clear_mission_items();
         for (const auto& elem : mission_plan.mission_items) {
-            auto* ptr = rpc_obj->add_mission_items();
-            ptr->CopyFrom(*translateToRpcMissionItem(elem).release());
+            translateToRpcMissionItem(elem, rpc_obj->add_mission_items());
         }
+    }
 
+    static std::unique_ptr<rpc::mission_server::MissionPlan>
+    translateToRpcMissionPlan(const mavsdk::MissionServer::MissionPlan& mission_plan)
+    {
+        auto rpc_obj = std::make_unique<rpc::mission_server::MissionPlan>();
+        translateToRpcMissionPlan(mission_plan, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -133,15 +147,20 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::mission_server::MissionProgress>
-    translateToRpcMissionProgress(const mavsdk::MissionServer::MissionProgress& mission_progress)
+    static void translateToRpcMissionProgress(
+        const mavsdk::MissionServer::MissionProgress& mission_progress,
+        rpc::mission_server::MissionProgress* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mission_server::MissionProgress>();
-
         rpc_obj->set_current(mission_progress.current);
 
         rpc_obj->set_total(mission_progress.total);
+    }
 
+    static std::unique_ptr<rpc::mission_server::MissionProgress>
+    translateToRpcMissionProgress(const mavsdk::MissionServer::MissionProgress& mission_progress)
+    {
+        auto rpc_obj = std::make_unique<rpc::mission_server::MissionProgress>();
+        translateToRpcMissionProgress(mission_progress, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -226,11 +245,13 @@ public:
     }
 
     grpc::Status SubscribeIncomingMission(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::mission_server::SubscribeIncomingMissionRequest* /* request */,
         grpc::ServerWriter<rpc::mission_server::IncomingMissionResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             rpc::mission_server::IncomingMissionResponse rpc_response;
             auto result = mavsdk::MissionServer::Result::NoSystem;
             fillResponseWithResult(&rpc_response, result);
@@ -239,138 +260,117 @@ public:
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox = std::make_shared<StreamOutbox<rpc::mission_server::IncomingMissionResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeIncomingMission");
 
-        _lazy_plugin.maybe_plugin()->subscribe_incoming_mission(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
+        plugin->subscribe_incoming_mission(
+            [outbox](
                 mavsdk::MissionServer::Result result,
                 const mavsdk::MissionServer::MissionPlan incoming_mission) {
-                rpc::mission_server::IncomingMissionResponse rpc_response;
-
-                rpc_response.set_allocated_mission_plan(
-                    translateToRpcMissionPlan(incoming_mission).release());
-
-                auto rpc_result = translateToRpcResult(result);
-                auto* rpc_mission_server_result = new rpc::mission_server::MissionServerResult();
-                rpc_mission_server_result->set_result(rpc_result);
-                std::stringstream ss;
-                ss << result;
-                rpc_mission_server_result->set_result_str(ss.str());
-                rpc_response.set_allocated_mission_server_result(rpc_mission_server_result);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_incoming_mission(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+                outbox->emplace([&](rpc::mission_server::IncomingMissionResponse& rpc_response) {
+                    translateToRpcMissionPlan(
+                        incoming_mission, rpc_response.mutable_mission_plan());
+
+                    auto* rpc_mission_server_result = rpc_response.mutable_mission_server_result();
+                    rpc_mission_server_result->set_result(translateToRpcResult(result));
+                    std::stringstream ss;
+                    ss << result;
+                    rpc_mission_server_result->set_result_str(ss.str());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_incoming_mission(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeCurrentItemChanged(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::mission_server::SubscribeCurrentItemChangedRequest* /* request */,
         grpc::ServerWriter<rpc::mission_server::CurrentItemChangedResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_current_item_changed(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::MissionServer::MissionItem current_item_changed) {
-                rpc::mission_server::CurrentItemChangedResponse rpc_response;
-
-                rpc_response.set_allocated_mission_item(
-                    translateToRpcMissionItem(current_item_changed).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_current_item_changed(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        auto outbox =
+            std::make_shared<StreamOutbox<rpc::mission_server::CurrentItemChangedResponse>>(
+                _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeCurrentItemChanged");
+
+        plugin->subscribe_current_item_changed(
+            [outbox](const mavsdk::MissionServer::MissionItem current_item_changed) {
+                outbox->emplace([&](rpc::mission_server::CurrentItemChangedResponse& rpc_response) {
+                    translateToRpcMissionItem(
+                        current_item_changed, rpc_response.mutable_mission_item());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_current_item_changed(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SetCurrentItemComplete(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission_server::SetCurrentItemCompleteRequest* /* request */,
         rpc::mission_server::SetCurrentItemCompleteResponse* /* response */) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        _lazy_plugin.maybe_plugin()->set_current_item_complete();
+        plugin->set_current_item_complete();
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeClearAll(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::mission_server::SubscribeClearAllRequest* /* request */,
         grpc::ServerWriter<rpc::mission_server::ClearAllResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_clear_all(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const uint32_t clear_all) {
-                rpc::mission_server::ClearAllResponse rpc_response;
+        auto outbox = std::make_shared<StreamOutbox<rpc::mission_server::ClearAllResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeClearAll");
 
-                rpc_response.set_clear_type(clear_all);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_clear_all(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        plugin->subscribe_clear_all(
+            [outbox](const uint32_t clear_all) {
+                outbox->emplace([&](rpc::mission_server::ClearAllResponse& rpc_response) {
+                    rpc_response.set_clear_type(clear_all);
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_clear_all(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
@@ -378,32 +378,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"mission_server", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -412,7 +428,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
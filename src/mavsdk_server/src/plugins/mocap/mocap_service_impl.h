@@ -8,11 +8,14 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -38,17 +41,21 @@ public:
         response->set_allocated_mocap_result(rpc_mocap_result);
     }
 
-    static std::unique_ptr<rpc::mocap::PositionBody>
-    translateToRpcPositionBody(const mavsdk::Mocap::PositionBody& position_body)
+    static void translateToRpcPositionBody(
+        const mavsdk::Mocap::PositionBody& position_body, rpc::mocap::PositionBody* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mocap::PositionBody>();
-
         rpc_obj->set_x_m(position_body.x_m);
 
         rpc_obj->set_y_m(position_body.y_m);
 
         rpc_obj->set_z_m(position_body.z_m);
+    }
 
+    static std::unique_ptr<rpc::mocap::PositionBody>
+    translateToRpcPositionBody(const mavsdk::Mocap::PositionBody& position_body)
+    {
+        auto rpc_obj = std::make_unique<rpc::mocap::PositionBody>();
+        translateToRpcPositionBody(position_body, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -66,17 +73,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::mocap::AngleBody>
-    translateToRpcAngleBody(const mavsdk::Mocap::AngleBody& angle_body)
+    static void translateToRpcAngleBody(
+        const mavsdk::Mocap::AngleBody& angle_body, rpc::mocap::AngleBody* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mocap::AngleBody>();
-
         rpc_obj->set_roll_rad(angle_body.roll_rad);
 
         rpc_obj->set_pitch_rad(angle_body.pitch_rad);
 
         rpc_obj->set_yaw_rad(angle_body.yaw_rad);
+    }
 
+    static std::unique_ptr<rpc::mocap::AngleBody>
+    translateToRpcAngleBody(const mavsdk::Mocap::AngleBody& angle_body)
+    {
+        auto rpc_obj = std::make_unique<rpc::mocap::AngleBody>();
+        translateToRpcAngleBody(angle_body, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -94,17 +105,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::mocap::SpeedBody>
-    translateToRpcSpeedBody(const mavsdk::Mocap::SpeedBody& speed_body)
+    static void translateToRpcSpeedBody(
+        const mavsdk::Mocap::SpeedBody& speed_body, rpc::mocap::SpeedBody* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mocap::SpeedBody>();
-
         rpc_obj->set_x_m_s(speed_body.x_m_s);
 
         rpc_obj->set_y_m_s(speed_body.y_m_s);
 
         rpc_obj->set_z_m_s(speed_body.z_m_s);
+    }
 
+    static std::unique_ptr<rpc::mocap::SpeedBody>
+    translateToRpcSpeedBody(const mavsdk::Mocap::SpeedBody& speed_body)
+    {
+        auto rpc_obj = std::make_unique<rpc::mocap::SpeedBody>();
+        translateToRpcSpeedBody(speed_body, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -122,17 +137,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::mocap::AngularVelocityBody> translateToRpcAngularVelocityBody(
-        const mavsdk::Mocap::AngularVelocityBody& angular_velocity_body)
+    static void translateToRpcAngularVelocityBody(
+        const mavsdk::Mocap::AngularVelocityBody& angular_velocity_body,
+        rpc::mocap::AngularVelocityBody* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mocap::AngularVelocityBody>();
-
         rpc_obj->set_roll_rad_s(angular_velocity_body.roll_rad_s);
 
         rpc_obj->set_pitch_rad_s(angular_velocity_body.pitch_rad_s);
 
         rpc_obj->set_yaw_rad_s(angular_velocity_body.yaw_rad_s);
+    }
 
+    static std::unique_ptr<rpc::mocap::AngularVelocityBody> translateToRpcAngularVelocityBody(
+        const mavsdk::Mocap::AngularVelocityBody& angular_velocity_body)
+    {
+        auto rpc_obj = std::make_unique<rpc::mocap::AngularVelocityBody>();
+        translateToRpcAngularVelocityBody(angular_velocity_body, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -150,15 +170,20 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::mocap::Covariance>
-    translateToRpcCovariance(const mavsdk::Mocap::Covariance& covariance)
+    static void translateToRpcCovariance(
+        const mavsdk::Mocap::Covariance& covariance, rpc::mocap::Covariance* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mocap::Covariance>();
-
+        rpc_obj->clear_covariance_matrix();
         for (const auto& elem : covariance.covariance_matrix) {
             rpc_obj->add_covariance_matrix(elem);
         }
+    }
 
+    static std::unique_ptr<rpc::mocap::Covariance>
+    translateToRpcCovariance(const mavsdk::Mocap::Covariance& covariance)
+    {
+        auto rpc_obj = std::make_unique<rpc::mocap::Covariance>();
+        translateToRpcCovariance(covariance, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -174,11 +199,9 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::mocap::Quaternion>
-    translateToRpcQuaternion(const mavsdk::Mocap::Quaternion& quaternion)
+    static void translateToRpcQuaternion(
+        const mavsdk::Mocap::Quaternion& quaternion, rpc::mocap::Quaternion* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mocap::Quaternion>();
-
         rpc_obj->set_w(quaternion.w);
 
         rpc_obj->set_x(quaternion.x);
@@ -186,7 +209,13 @@ public:
         rpc_obj->set_y(quaternion.y);
 
         rpc_obj->set_z(quaternion.z);
+    }
 
+    static std::unique_ptr<rpc::mocap::Quaternion>
+    translateToRpcQuaternion(const mavsdk::Mocap::Quaternion& quaternion)
+    {
+        auto rpc_obj = std::make_unique<rpc::mocap::Quaternion>();
+        translateToRpcQuaternion(quaternion, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -206,22 +235,26 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::mocap::VisionPositionEstimate> translateToRpcVisionPositionEstimate(
-        const mavsdk::Mocap::VisionPositionEstimate& vision_position_estimate)
+    static void translateToRpcVisionPositionEstimate(
+        const mavsdk::Mocap::VisionPositionEstimate& vision_position_estimate,
+        rpc::mocap::VisionPositionEstimate* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mocap::VisionPositionEstimate>();
-
         rpc_obj->set_time_usec(vision_position_estimate.time_usec);
 
-        rpc_obj->set_allocated_position_body(
-            translateToRpcPositionBody(vision_position_estimate.position_body).release());
+        translateToRpcPositionBody(
+            vision_position_estimate.position_body, rpc_obj->mutable_position_body());
 
-        rpc_obj->set_allocated_angle_body(
-            translateToRpcAngleBody(vision_position_estimate.angle_body).release());
+        translateToRpcAngleBody(vision_position_estimate.angle_body, rpc_obj->mutable_angle_body());
 
-        rpc_obj->set_allocated_pose_covariance(
-            translateToRpcCovariance(vision_position_estimate.pose_covariance).release());
+        translateToRpcCovariance(
+            vision_position_estimate.pose_covariance, rpc_obj->mutable_pose_covariance());
+    }
 
+    static std::unique_ptr<rpc::mocap::VisionPositionEstimate> translateToRpcVisionPositionEstimate(
+        const mavsdk::Mocap::VisionPositionEstimate& vision_position_estimate)
+    {
+        auto rpc_obj = std::make_unique<rpc::mocap::VisionPositionEstimate>();
+        translateToRpcVisionPositionEstimate(vision_position_estimate, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -242,21 +275,26 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::mocap::AttitudePositionMocap> translateToRpcAttitudePositionMocap(
-        const mavsdk::Mocap::AttitudePositionMocap& attitude_position_mocap)
+    static void translateToRpcAttitudePositionMocap(
+        const mavsdk::Mocap::AttitudePositionMocap& attitude_position_mocap,
+        rpc::mocap::AttitudePositionMocap* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mocap::AttitudePositionMocap>();
-
         rpc_obj->set_time_usec(attitude_position_mocap.time_usec);
 
-        rpc_obj->set_allocated_q(translateToRpcQuaternion(attitude_position_mocap.q).release());
+        translateToRpcQuaternion(attitude_position_mocap.q, rpc_obj->mutable_q());
 
-        rpc_obj->set_allocated_position_body(
-            translateToRpcPositionBody(attitude_position_mocap.position_body).release());
+        translateToRpcPositionBody(
+            attitude_position_mocap.position_body, rpc_obj->mutable_position_body());
 
-        rpc_obj->set_allocated_pose_covariance(
-            translateToRpcCovariance(attitude_position_mocap.pose_covariance).release());
+        translateToRpcCovariance(
+            attitude_position_mocap.pose_covariance, rpc_obj->mutable_pose_covariance());
+    }
 
+    static std::unique_ptr<rpc::mocap::AttitudePositionMocap> translateToRpcAttitudePositionMocap(
+        const mavsdk::Mocap::AttitudePositionMocap& attitude_position_mocap)
+    {
+        auto rpc_obj = std::make_unique<rpc::mocap::AttitudePositionMocap>();
+        translateToRpcAttitudePositionMocap(attitude_position_mocap, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -304,31 +342,33 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::mocap::Odometry>
-    translateToRpcOdometry(const mavsdk::Mocap::Odometry& odometry)
+    static void translateToRpcOdometry(
+        const mavsdk::Mocap::Odometry& odometry, rpc::mocap::Odometry* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::mocap::Odometry>();
-
         rpc_obj->set_time_usec(odometry.time_usec);
 
         rpc_obj->set_frame_id(translateToRpcMavFrame(odometry.frame_id));
 
-        rpc_obj->set_allocated_position_body(
-            translateToRpcPositionBody(odometry.position_body).release());
+        translateToRpcPositionBody(odometry.position_body, rpc_obj->mutable_position_body());
 
-        rpc_obj->set_allocated_q(translateToRpcQuaternion(odometry.q).release());
+        translateToRpcQuaternion(odometry.q, rpc_obj->mutable_q());
 
-        rpc_obj->set_allocated_speed_body(translateToRpcSpeedBody(odometry.speed_body).release());
+        translateToRpcSpeedBody(odometry.speed_body, rpc_obj->mutable_speed_body());
 
-        rpc_obj->set_allocated_angular_velocity_body(
-            translateToRpcAngularVelocityBody(odometry.angular_velocity_body).release());
+        translateToRpcAngularVelocityBody(
+            odometry.angular_velocity_body, rpc_obj->mutable_angular_velocity_body());
 
-        rpc_obj->set_allocated_pose_covariance(
-            translateToRpcCovariance(odometry.pose_covariance).release());
+        translateToRpcCovariance(odometry.pose_covariance, rpc_obj->mutable_pose_covariance());
 
-        rpc_obj->set_allocated_velocity_covariance(
-            translateToRpcCovariance(odometry.velocity_covariance).release());
+        translateToRpcCovariance(
+            odometry.velocity_covariance, rpc_obj->mutable_velocity_covariance());
+    }
 
+    static std::unique_ptr<rpc::mocap::Odometry>
+    translateToRpcOdometry(const mavsdk::Mocap::Odometry& odometry)
+    {
+        auto rpc_obj = std::make_unique<rpc::mocap::Odometry>();
+        translateToRpcOdometry(odometry, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -400,11 +440,13 @@ public:
     }
 
     grpc::Status SetVisionPositionEstimate(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mocap::SetVisionPositionEstimateRequest* request,
         rpc::mocap::SetVisionPositionEstimateResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Mocap::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -418,7 +460,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_vision_position_estimate(
+        auto result = plugin->set_vision_position_estimate(
             translateFromRpcVisionPositionEstimate(request->vision_position_estimate()));
 
         if (response != nullptr) {
@@ -429,11 +471,13 @@ public:
     }
 
     grpc::Status SetAttitudePositionMocap(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mocap::SetAttitudePositionMocapRequest* request,
         rpc::mocap::SetAttitudePositionMocapResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Mocap::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -447,7 +491,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_attitude_position_mocap(
+        auto result = plugin->set_attitude_position_mocap(
             translateFromRpcAttitudePositionMocap(request->attitude_position_mocap()));
 
         if (response != nullptr) {
@@ -458,11 +502,13 @@ public:
     }
 
     grpc::Status SetOdometry(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mocap::SetOdometryRequest* request,
         rpc::mocap::SetOdometryResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Mocap::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -476,8 +522,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_odometry(
-            translateFromRpcOdometry(request->odometry()));
+        auto result = plugin->set_odometry(translateFromRpcOdometry(request->odometry()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -489,32 +534,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"mocap", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -523,7 +584,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
@@ -8,11 +8,14 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -38,11 +41,9 @@ public:
         response->set_allocated_offboard_result(rpc_offboard_result);
     }
 
-    static std::unique_ptr<rpc::offboard::Attitude>
-    translateToRpcAttitude(const mavsdk::Offboard::Attitude& attitude)
+    static void translateToRpcAttitude(
+        const mavsdk::Offboard::Attitude& attitude, rpc::offboard::Attitude* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::offboard::Attitude>();
-
         rpc_obj->set_roll_deg(attitude.roll_deg);
 
         rpc_obj->set_pitch_deg(attitude.pitch_deg);
@@ -50,7 +51,13 @@ public:
         rpc_obj->set_yaw_deg(attitude.yaw_deg);
 
         rpc_obj->set_thrust_value(attitude.thrust_value);
+    }
 
+    static std::unique_ptr<rpc::offboard::Attitude>
+    translateToRpcAttitude(const mavsdk::Offboard::Attitude& attitude)
+    {
+        auto rpc_obj = std::make_unique<rpc::offboard::Attitude>();
+        translateToRpcAttitude(attitude, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -70,15 +77,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::offboard::ActuatorControlGroup> translateToRpcActuatorControlGroup(
-        const mavsdk::Offboard::ActuatorControlGroup& actuator_control_group)
+    static void translateToRpcActuatorControlGroup(
+        const mavsdk::Offboard::ActuatorControlGroup& actuator_control_group,
+        rpc::offboard::ActuatorControlGroup* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::offboard::ActuatorControlGroup>();
-
+        rpc_obj->clear_controls();
         for (const auto& elem : actuator_control_group.controls) {
             rpc_obj->add_controls(elem);
         }
+    }
 
+    static std::unique_ptr<rpc::offboard::ActuatorControlGroup> translateToRpcActuatorControlGroup(
+        const mavsdk::Offboard::ActuatorControlGroup& actuator_control_group)
+    {
+        auto rpc_obj = std::make_unique<rpc::offboard::ActuatorControlGroup>();
+        translateToRpcActuatorControlGroup(actuator_control_group, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -94,16 +107,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::offboard::ActuatorControl>
-    translateToRpcActuatorControl(const mavsdk::Offboard::ActuatorControl& actuator_control)
+    static void translateToRpcActuatorControl(
+        const mavsdk::Offboard::ActuatorControl& actuator_control,
+        rpc::offboard::ActuatorControl* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::offboard::ActuatorControl>();
-
+        rpc_obj->clear_groups();
         for (const auto& elem : actuator_control.groups) {
-            auto* ptr = rpc_obj->add_groups();
-            ptr->CopyFrom(*translateToRpcActuatorControlGroup(elem).release());
+            translateToRpcActuatorControlGroup(elem, rpc_obj->add_groups());
         }
+    }
 
+    static std::unique_ptr<rpc::offboard::ActuatorControl>
+    translateToRpcActuatorControl(const mavsdk::Offboard::ActuatorControl& actuator_control)
+    {
+        auto rpc_obj = std::make_unique<rpc::offboard::ActuatorControl>();
+        translateToRpcActuatorControl(actuator_control, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -120,11 +138,9 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::offboard::AttitudeRate>
-    translateToRpcAttitudeRate(const mavsdk::Offboard::AttitudeRate& attitude_rate)
+    static void translateToRpcAttitudeRate(
+        const mavsdk::Offboard::AttitudeRate& attitude_rate, rpc::offboard::AttitudeRate* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::offboard::AttitudeRate>();
-
         rpc_obj->set_roll_deg_s(attitude_rate.roll_deg_s);
 
         rpc_obj->set_pitch_deg_s(attitude_rate.pitch_deg_s);
@@ -132,7 +148,13 @@ public:
         rpc_obj->set_yaw_deg_s(attitude_rate.yaw_deg_s);
 
         rpc_obj->set_thrust_value(attitude_rate.thrust_value);
+    }
 
+    static std::unique_ptr<rpc::offboard::AttitudeRate>
+    translateToRpcAttitudeRate(const mavsdk::Offboard::AttitudeRate& attitude_rate)
+    {
+        auto rpc_obj = std::make_unique<rpc::offboard::AttitudeRate>();
+        translateToRpcAttitudeRate(attitude_rate, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -152,11 +174,10 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::offboard::PositionNedYaw>
-    translateToRpcPositionNedYaw(const mavsdk::Offboard::PositionNedYaw& position_ned_yaw)
+    static void translateToRpcPositionNedYaw(
+        const mavsdk::Offboard::PositionNedYaw& position_ned_yaw,
+        rpc::offboard::PositionNedYaw* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::offboard::PositionNedYaw>();
-
         rpc_obj->set_north_m(position_ned_yaw.north_m);
 
         rpc_obj->set_east_m(position_ned_yaw.east_m);
@@ -164,7 +185,13 @@ public:
         rpc_obj->set_down_m(position_ned_yaw.down_m);
 
         rpc_obj->set_yaw_deg(position_ned_yaw.yaw_deg);
+    }
 
+    static std::unique_ptr<rpc::offboard::PositionNedYaw>
+    translateToRpcPositionNedYaw(const mavsdk::Offboard::PositionNedYaw& position_ned_yaw)
+    {
+        auto rpc_obj = std::make_unique<rpc::offboard::PositionNedYaw>();
+        translateToRpcPositionNedYaw(position_ned_yaw, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -216,11 +243,10 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::offboard::PositionGlobalYaw>
-    translateToRpcPositionGlobalYaw(const mavsdk::Offboard::PositionGlobalYaw& position_global_yaw)
+    static void translateToRpcPositionGlobalYaw(
+        const mavsdk::Offboard::PositionGlobalYaw& position_global_yaw,
+        rpc::offboard::PositionGlobalYaw* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::offboard::PositionGlobalYaw>();
-
         rpc_obj->set_lat_deg(position_global_yaw.lat_deg);
 
         rpc_obj->set_lon_deg(position_global_yaw.lon_deg);
@@ -230,7 +256,13 @@ public:
         rpc_obj->set_yaw_deg(position_global_yaw.yaw_deg);
 
         rpc_obj->set_altitude_type(translateToRpcAltitudeType(position_global_yaw.altitude_type));
+    }
 
+    static std::unique_ptr<rpc::offboard::PositionGlobalYaw>
+    translateToRpcPositionGlobalYaw(const mavsdk::Offboard::PositionGlobalYaw& position_global_yaw)
+    {
+        auto rpc_obj = std::make_unique<rpc::offboard::PositionGlobalYaw>();
+        translateToRpcPositionGlobalYaw(position_global_yaw, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -252,11 +284,10 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::offboard::VelocityBodyYawspeed> translateToRpcVelocityBodyYawspeed(
-        const mavsdk::Offboard::VelocityBodyYawspeed& velocity_body_yawspeed)
+    static void translateToRpcVelocityBodyYawspeed(
+        const mavsdk::Offboard::VelocityBodyYawspeed& velocity_body_yawspeed,
+        rpc::offboard::VelocityBodyYawspeed* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::offboard::VelocityBodyYawspeed>();
-
         rpc_obj->set_forward_m_s(velocity_body_yawspeed.forward_m_s);
 
         rpc_obj->set_right_m_s(velocity_body_yawspeed.right_m_s);
@@ -264,7 +295,13 @@ public:
         rpc_obj->set_down_m_s(velocity_body_yawspeed.down_m_s);
 
         rpc_obj->set_yawspeed_deg_s(velocity_body_yawspeed.yawspeed_deg_s);
+    }
 
+    static std::unique_ptr<rpc::offboard::VelocityBodyYawspeed> translateToRpcVelocityBodyYawspeed(
+        const mavsdk::Offboard::VelocityBodyYawspeed& velocity_body_yawspeed)
+    {
+        auto rpc_obj = std::make_unique<rpc::offboard::VelocityBodyYawspeed>();
+        translateToRpcVelocityBodyYawspeed(velocity_body_yawspeed, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -284,11 +321,10 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::offboard::VelocityNedYaw>
-    translateToRpcVelocityNedYaw(const mavsdk::Offboard::VelocityNedYaw& velocity_ned_yaw)
+    static void translateToRpcVelocityNedYaw(
+        const mavsdk::Offboard::VelocityNedYaw& velocity_ned_yaw,
+        rpc::offboard::VelocityNedYaw* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::offboard::VelocityNedYaw>();
-
         rpc_obj->set_north_m_s(velocity_ned_yaw.north_m_s);
 
         rpc_obj->set_east_m_s(velocity_ned_yaw.east_m_s);
@@ -296,7 +332,13 @@ public:
         rpc_obj->set_down_m_s(velocity_ned_yaw.down_m_s);
 
         rpc_obj->set_yaw_deg(velocity_ned_yaw.yaw_deg);
+    }
 
+    static std::unique_ptr<rpc::offboard::VelocityNedYaw>
+    translateToRpcVelocityNedYaw(const mavsdk::Offboard::VelocityNedYaw& velocity_ned_yaw)
+    {
+        auto rpc_obj = std::make_unique<rpc::offboard::VelocityNedYaw>();
+        translateToRpcVelocityNedYaw(velocity_ned_yaw, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -316,17 +358,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::offboard::AccelerationNed>
-    translateToRpcAccelerationNed(const mavsdk::Offboard::AccelerationNed& acceleration_ned)
+    static void translateToRpcAccelerationNed(
+        const mavsdk::Offboard::AccelerationNed& acceleration_ned,
+        rpc::offboard::AccelerationNed* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::offboard::AccelerationNed>();
-
         rpc_obj->set_north_m_s2(acceleration_ned.north_m_s2);
 
         rpc_obj->set_east_m_s2(acceleration_ned.east_m_s2);
 
         rpc_obj->set_down_m_s2(acceleration_ned.down_m_s2);
+    }
 
+    static std::unique_ptr<rpc::offboard::AccelerationNed>
+    translateToRpcAccelerationNed(const mavsdk::Offboard::AccelerationNed& acceleration_ned)
+    {
+        auto rpc_obj = std::make_unique<rpc::offboard::AccelerationNed>();
+        translateToRpcAccelerationNed(acceleration_ned, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -397,11 +444,13 @@ public:
     }
 
     grpc::Status Start(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::offboard::StartRequest* /* request */,
         rpc::offboard::StartResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Offboard::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -410,7 +459,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->start();
+        auto result = plugin->start();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -420,11 +469,13 @@ public:
     }
 
     grpc::Status Stop(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::offboard::StopRequest* /* request */,
         rpc::offboard::StopResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Offboard::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -433,7 +484,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->stop();
+        auto result = plugin->stop();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -443,15 +494,17 @@ public:
     }
 
     grpc::Status IsActive(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::offboard::IsActiveRequest* /* request */,
         rpc::offboard::IsActiveResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->is_active();
+        auto result = plugin->is_active();
 
         if (response != nullptr) {
             response->set_is_active(result);
@@ -461,11 +514,13 @@ public:
     }
 
     grpc::Status SetAttitude(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::offboard::SetAttitudeRequest* request,
         rpc::offboard::SetAttitudeResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Offboard::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -479,8 +534,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_attitude(
-            translateFromRpcAttitude(request->attitude()));
+        auto result = plugin->set_attitude(translateFromRpcAttitude(request->attitude()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -490,11 +544,13 @@ public:
     }
 
     grpc::Status SetActuatorControl(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::offboard::SetActuatorControlRequest* request,
         rpc::offboard::SetActuatorControlResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Offboard::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -508,7 +564,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_actuator_control(
+        auto result = plugin->set_actuator_control(
             translateFromRpcActuatorControl(request->actuator_control()));
 
         if (response != nullptr) {
@@ -519,11 +575,13 @@ public:
     }
 
     grpc::Status SetAttitudeRate(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::offboard::SetAttitudeRateRequest* request,
         rpc::offboard::SetAttitudeRateResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Offboard::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -537,7 +595,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_attitude_rate(
+        auto result = plugin->set_attitude_rate(
             translateFromRpcAttitudeRate(request->attitude_rate()));
 
         if (response != nullptr) {
@@ -548,11 +606,13 @@ public:
     }
 
     grpc::Status SetPositionNed(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::offboard::SetPositionNedRequest* request,
         rpc::offboard::SetPositionNedResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Offboard::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -566,7 +626,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_position_ned(
+        auto result = plugin->set_position_ned(
             translateFromRpcPositionNedYaw(request->position_ned_yaw()));
 
         if (response != nullptr) {
@@ -577,11 +637,13 @@ public:
     }
 
     grpc::Status SetPositionGlobal(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::offboard::SetPositionGlobalRequest* request,
         rpc::offboard::SetPositionGlobalResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Offboard::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -595,7 +657,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_position_global(
+        auto result = plugin->set_position_global(
             translateFromRpcPositionGlobalYaw(request->position_global_yaw()));
 
         if (response != nullptr) {
@@ -606,11 +668,13 @@ public:
     }
 
     grpc::Status SetVelocityBody(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::offboard::SetVelocityBodyRequest* request,
         rpc::offboard::SetVelocityBodyResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Offboard::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -624,7 +688,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_velocity_body(
+        auto result = plugin->set_velocity_body(
             translateFromRpcVelocityBodyYawspeed(request->velocity_body_yawspeed()));
 
         if (response != nullptr) {
@@ -635,11 +699,13 @@ public:
     }
 
     grpc::Status SetVelocityNed(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::offboard::SetVelocityNedRequest* request,
         rpc::offboard::SetVelocityNedResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Offboard::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -653,7 +719,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_velocity_ned(
+        auto result = plugin->set_velocity_ned(
             translateFromRpcVelocityNedYaw(request->velocity_ned_yaw()));
 
         if (response != nullptr) {
@@ -664,11 +730,13 @@ public:
     }
 
     grpc::Status SetPositionVelocityNed(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::offboard::SetPositionVelocityNedRequest* request,
         rpc::offboard::SetPositionVelocityNedResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Offboard::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -682,7 +750,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_position_velocity_ned(
+        auto result = plugin->set_position_velocity_ned(
             translateFromRpcPositionNedYaw(request->position_ned_yaw()),
             translateFromRpcVelocityNedYaw(request->velocity_ned_yaw()));
 
@@ -694,11 +762,13 @@ public:
     }
 
     grpc::Status SetAccelerationNed(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::offboard::SetAccelerationNedRequest* request,
         rpc::offboard::SetAccelerationNedResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Offboard::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -712,7 +782,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_acceleration_ned(
+        auto result = plugin->set_acceleration_ned(
             translateFromRpcAccelerationNed(request->acceleration_ned()));
 
         if (response != nullptr) {
@@ -725,32 +795,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"offboard", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -759,7 +845,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
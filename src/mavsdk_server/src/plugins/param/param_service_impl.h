@@ -8,11 +8,14 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -38,15 +41,19 @@ public:
         response->set_allocated_param_result(rpc_param_result);
     }
 
-    static std::unique_ptr<rpc::param::IntParam>
-    translateToRpcIntParam(const mavsdk::Param::IntParam& int_param)
+    static void translateToRpcIntParam(
+        const mavsdk::Param::IntParam& int_param, rpc::param::IntParam* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::param::IntParam>();
-
         rpc_obj->set_name(int_param.name);
 
         rpc_obj->set_value(int_param.value);
+    }
 
+    static std::unique_ptr<rpc::param::IntParam>
+    translateToRpcIntParam(const mavsdk::Param::IntParam& int_param)
+    {
+        auto rpc_obj = std::make_unique<rpc::param::IntParam>();
+        translateToRpcIntParam(int_param, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -61,15 +68,19 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::param::FloatParam>
-    translateToRpcFloatParam(const mavsdk::Param::FloatParam& float_param)
+    static void translateToRpcFloatParam(
+        const mavsdk::Param::FloatParam& float_param, rpc::param::FloatParam* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::param::FloatParam>();
-
         rpc_obj->set_name(float_param.name);
 
         rpc_obj->set_value(float_param.value);
+    }
 
+    static std::unique_ptr<rpc::param::FloatParam>
+    translateToRpcFloatParam(const mavsdk::Param::FloatParam& float_param)
+    {
+        auto rpc_obj = std::make_unique<rpc::param::FloatParam>();
+        translateToRpcFloatParam(float_param, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -85,21 +96,25 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::param::AllParams>
-    translateToRpcAllParams(const mavsdk::Param::AllParams& all_params)
+    static void translateToRpcAllParams(
+        const mavsdk::Param::AllParams& all_params, rpc::param::AllParams* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::param::AllParams>();
-
+        rpc_obj->clear_int_params();
         for (const auto& elem : all_params.int_params) {
-            auto* ptr = rpc_obj->add_int_params();
-            ptr->CopyFrom(*translateToRpcIntParam(elem).release());
+            translateToRpcIntParam(elem, rpc_obj->add_int_params());
         }
 
+        rpc_obj->clear_float_params();
         for (const auto& elem : all_params.float_params) {
-            auto* ptr = rpc_obj->add_float_params();
-            ptr->CopyFrom(*translateToRpcFloatParam(elem).release());
+            translateToRpcFloatParam(elem, rpc_obj->add_float_params());
         }
+    }
 
+    static std::unique_ptr<rpc::param::AllParams>
+    translateToRpcAllParams(const mavsdk::Param::AllParams& all_params)
+    {
+        auto rpc_obj = std::make_unique<rpc::param::AllParams>();
+        translateToRpcAllParams(all_params, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -169,11 +184,13 @@ public:
     }
 
     grpc::Status GetParamInt(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::param::GetParamIntRequest* request,
         rpc::param::GetParamIntResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Param::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -187,7 +204,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_param_int(request->name());
+        auto result = plugin->get_param_int(request->name());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -199,11 +216,13 @@ public:
     }
 
     grpc::Status SetParamInt(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::param::SetParamIntRequest* request,
         rpc::param::SetParamIntResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Param::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -217,7 +236,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_param_int(request->name(), request->value());
+        auto result = plugin->set_param_int(request->name(), request->value());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -227,11 +246,13 @@ public:
     }
 
     grpc::Status GetParamFloat(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::param::GetParamFloatRequest* request,
         rpc::param::GetParamFloatResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Param::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -245,7 +266,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_param_float(request->name());
+        auto result = plugin->get_param_float(request->name());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -257,11 +278,13 @@ public:
     }
 
     grpc::Status SetParamFloat(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::param::SetParamFloatRequest* request,
         rpc::param::SetParamFloatResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Param::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -276,7 +299,7 @@ public:
         }
 
         auto result =
-            _lazy_plugin.maybe_plugin()->set_param_float(request->name(), request->value());
+            plugin->set_param_float(request->name(), request->value());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -286,15 +309,17 @@ public:
     }
 
     grpc::Status GetAllParams(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::param::GetAllParamsRequest* /* request */,
         rpc::param::GetAllParamsResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_all_params();
+        auto result = plugin->get_all_params();
 
         if (response != nullptr) {
             response->set_allocated_params(translateToRpcAllParams(result).release());
@@ -306,32 +331,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"param", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -340,7 +381,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
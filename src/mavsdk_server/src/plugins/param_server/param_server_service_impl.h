@@ -8,11 +8,14 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -38,15 +41,19 @@ public:
         response->set_allocated_param_server_result(rpc_param_server_result);
     }
 
-    static std::unique_ptr<rpc::param_server::IntParam>
-    translateToRpcIntParam(const mavsdk::ParamServer::IntParam& int_param)
+    static void translateToRpcIntParam(
+        const mavsdk::ParamServer::IntParam& int_param, rpc::param_server::IntParam* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::param_server::IntParam>();
-
         rpc_obj->set_name(int_param.name);
 
         rpc_obj->set_value(int_param.value);
+    }
 
+    static std::unique_ptr<rpc::param_server::IntParam>
+    translateToRpcIntParam(const mavsdk::ParamServer::IntParam& int_param)
+    {
+        auto rpc_obj = std::make_unique<rpc::param_server::IntParam>();
+        translateToRpcIntParam(int_param, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -62,15 +69,19 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::param_server::FloatParam>
-    translateToRpcFloatParam(const mavsdk::ParamServer::FloatParam& float_param)
+    static void translateToRpcFloatParam(
+        const mavsdk::ParamServer::FloatParam& float_param, rpc::param_server::FloatParam* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::param_server::FloatParam>();
-
         rpc_obj->set_name(float_param.name);
 
         rpc_obj->set_value(float_param.value);
+    }
 
+    static std::unique_ptr<rpc::param_server::FloatParam>
+    translateToRpcFloatParam(const mavsdk::ParamServer::FloatParam& float_param)
+    {
+        auto rpc_obj = std::make_unique<rpc::param_server::FloatParam>();
+        translateToRpcFloatParam(float_param, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -86,21 +97,25 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::param_server::AllParams>
-    translateToRpcAllParams(const mavsdk::ParamServer::AllParams& all_params)
+    static void translateToRpcAllParams(
+        const mavsdk::ParamServer::AllParams& all_params, rpc::param_server::AllParams* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::param_server::AllParams>();
-
+        rpc_obj->clear_int_params();
         for (const auto& elem : all_params.int_params) {
-            auto* ptr = rpc_obj->add_int_params();
-            ptr->CopyFrom(*translateToRpcIntParam(elem).release());
+            translateToRpcIntParam(elem, rpc_obj->add_int_params());
         }
 
+        rpc_obj->clear_float_params();
         for (const auto& elem : all_params.float_params) {
-            auto* ptr = rpc_obj->add_float_params();
-            ptr->CopyFrom(*translateToRpcFloatParam(elem).release());
+            translateToRpcFloatParam(elem, rpc_obj->add_float_params());
         }
+    }
 
+    static std::unique_ptr<rpc::param_server::AllParams>
+    translateToRpcAllParams(const mavsdk::ParamServer::AllParams& all_params)
+    {
+        auto rpc_obj = std::make_unique<rpc::param_server::AllParams>();
+        translateToRpcAllParams(all_params, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -167,11 +182,13 @@ public:
     }
 
     grpc::Status RetrieveParamInt(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::param_server::RetrieveParamIntRequest* request,
         rpc::param_server::RetrieveParamIntResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::ParamServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -185,7 +202,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->retrieve_param_int(request->name());
+        auto result = plugin->retrieve_param_int(request->name());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -197,11 +214,13 @@ public:
     }
 
     grpc::Status ProvideParamInt(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::param_server::ProvideParamIntRequest* request,
         rpc::param_server::ProvideParamIntResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::ParamServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -216,7 +235,7 @@ public:
         }
 
         auto result =
-            _lazy_plugin.maybe_plugin()->provide_param_int(request->name(), request->value());
+            plugin->provide_param_int(request->name(), request->value());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -226,11 +245,13 @@ public:
     }
 
     grpc::Status RetrieveParamFloat(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::param_server::RetrieveParamFloatRequest* request,
         rpc::param_server::RetrieveParamFloatResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::ParamServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -244,7 +265,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->retrieve_param_float(request->name());
+        auto result = plugin->retrieve_param_float(request->name());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -256,11 +277,13 @@ public:
     }
 
     grpc::Status ProvideParamFloat(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::param_server::ProvideParamFloatRequest* request,
         rpc::param_server::ProvideParamFloatResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::ParamServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -275,7 +298,7 @@ public:
         }
 
         auto result =
-            _lazy_plugin.maybe_plugin()->provide_param_float(request->name(), request->value());
+            plugin->provide_param_float(request->name(), request->value());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -285,15 +308,17 @@ public:
     }
 
     grpc::Status RetrieveAllParams(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::param_server::RetrieveAllParamsRequest* /* request */,
         rpc::param_server::RetrieveAllParamsResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->retrieve_all_params();
+        auto result = plugin->retrieve_all_params();
 
         if (response != nullptr) {
             response->set_allocated_params(translateToRpcAllParams(result).release());
@@ -305,32 +330,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"param_server", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -339,7 +380,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "plugins/telemetry/telemetry.h"
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+// The topics of a TelemetryBundle update, only the ones which changed are set.
+struct TelemetryBundleChanges {
+    std::optional<mavsdk::Telemetry::Position> position{};
+    std::optional<mavsdk::Telemetry::EulerAngle> attitude_euler{};
+    std::optional<mavsdk::Telemetry::Battery> battery{};
+    std::optional<mavsdk::Telemetry::GpsInfo> gps_info{};
+    std::optional<mavsdk::Telemetry::FlightMode> flight_mode{};
+};
+
+// Collects several telemetry topics into one combined update, so a dashboard
+// needs one stream instead of one per topic.
+//
+// Only topics whose value changed since the last update was taken are
+// included, and updates are handed out at most at max_rate_hz. The topic
+// subscriptions are rate limited and coalesced the same way, so topics that
+// publish faster than the bundle don't cost more than one callback per tick.
+//
+// Like the other files next to the generated service, this one is written by
+// hand and not touched by tools/generate_from_protos.sh. It only uses the
+// generated Telemetry API, i.e. the subscriptions with SubscriptionOptions and
+// handles which templates/*/settings.j2 enables for telemetry.
+template<typename Telemetry = mavsdk::Telemetry> class TelemetryBundle {
+public:
+    enum Topic : uint32_t {
+        Position = 1u << 0,
+        AttitudeEuler = 1u << 1,
+        Battery = 1u << 2,
+        GpsInfo = 1u << 3,
+        FlightMode = 1u << 4,
+    };
+
+    using Changes = TelemetryBundleChanges;
+
+    TelemetryBundle(Telemetry& telemetry, uint32_t topics, double max_rate_hz) :
+        _telemetry(telemetry),
+        _period(
+            max_rate_hz > 0.0 ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                    std::chrono::duration<double>(1.0 / max_rate_hz)) :
+                                std::chrono::steady_clock::duration::zero())
+    {
+        SubscriptionOptions options;
+        options.max_rate_hz = max_rate_hz;
+        options.coalesce = true;
+
+        if (topics & Position) {
+            _position_handle = _telemetry.subscribe_position(
+                [state = _state](mavsdk::Telemetry::Position position) {
+                    state->update(state->position, std::move(position));
+                },
+                options);
+        }
+        if (topics & AttitudeEuler) {
+            _attitude_euler_handle = _telemetry.subscribe_attitude_euler(
+                [state = _state](mavsdk::Telemetry::EulerAngle attitude_euler) {
+                    state->update(state->attitude_euler, std::move(attitude_euler));
+                },
+                options);
+        }
+        if (topics & Battery) {
+            _battery_handle = _telemetry.subscribe_battery(
+                [state = _state](mavsdk::Telemetry::Battery battery) {
+                    state->update(state->battery, std::move(battery));
+                },
+                options);
+        }
+        if (topics & GpsInfo) {
+            _gps_info_handle = _telemetry.subscribe_gps_info(
+                [state = _state](mavsdk::Telemetry::GpsInfo gps_info) {
+                    state->update(state->gps_info, std::move(gps_info));
+                },
+                options);
+        }
+        if (topics & FlightMode) {
+            _flight_mode_handle = _telemetry.subscribe_flight_mode(
+                [state = _state](mavsdk::Telemetry::FlightMode flight_mode) {
+                    state->update(state->flight_mode, flight_mode);
+                },
+                options);
+        }
+    }
+
+    ~TelemetryBundle()
+    {
+        close();
+
+        if (_position_handle.valid()) {
+            _telemetry.unsubscribe_position(_position_handle);
+        }
+        if (_attitude_euler_handle.valid()) {
+            _telemetry.unsubscribe_attitude_euler(_attitude_euler_handle);
+        }
+        if (_battery_handle.valid()) {
+            _telemetry.unsubscribe_battery(_battery_handle);
+        }
+        if (_gps_info_handle.valid()) {
+            _telemetry.unsubscribe_gps_info(_gps_info_handle);
+        }
+        if (_flight_mode_handle.valid()) {
+            _telemetry.unsubscribe_flight_mode(_flight_mode_handle);
+        }
+    }
+
+    TelemetryBundle(const TelemetryBundle&) = delete;
+    TelemetryBundle& operator=(const TelemetryBundle&) = delete;
+
+    // Blocks until at least one topic changed and a period has passed since the
+    // last update. Returns false once the bundle is closed.
+    bool wait_for_changes(Changes& changes)
+    {
+        auto& state = *_state;
+        std::unique_lock<std::mutex> lock(state.mutex);
+        while (true) {
+            if (state.closed) {
+                return false;
+            }
+            if (state.has_pending()) {
+                if (std::chrono::steady_clock::now() >= state.next_update) {
+                    break;
+                }
+                state.cv.wait_until(lock, state.next_update);
+            } else {
+                state.cv.wait(lock);
+            }
+        }
+
+        changes = Changes{};
+        take(state.position, changes.position);
+        take(state.attitude_euler, changes.attitude_euler);
+        take(state.battery, changes.battery);
+        take(state.gps_info, changes.gps_info);
+        take(state.flight_mode, changes.flight_mode);
+
+        state.next_update = std::chrono::steady_clock::now() + _period;
+        return true;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_state->mutex);
+            _state->closed = true;
+        }
+        _state->cv.notify_all();
+    }
+
+private:
+    template<typename T> struct TopicState {
+        std::optional<T> pending{};
+        std::optional<T> sent{};
+    };
+
+    // Shared with the subscription callbacks, which can still be running while
+    // the bundle is destroyed.
+    struct State {
+        std::mutex mutex{};
+        std::condition_variable cv{};
+        bool closed{false};
+        std::chrono::steady_clock::time_point next_update{};
+
+        TopicState<mavsdk::Telemetry::Position> position{};
+        TopicState<mavsdk::Telemetry::EulerAngle> attitude_euler{};
+        TopicState<mavsdk::Telemetry::Battery> battery{};
+        TopicState<mavsdk::Telemetry::GpsInfo> gps_info{};
+        TopicState<mavsdk::Telemetry::FlightMode> flight_mode{};
+
+        template<typename T> void update(TopicState<T>& topic, T value)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (topic.sent && *topic.sent == value) {
+                    // Back to what the client already has.
+                    topic.pending.reset();
+                    return;
+                }
+                topic.pending = std::move(value);
+            }
+            cv.notify_one();
+        }
+
+        // Assumes to have the lock for mutex.
+        bool has_pending() const
+        {
+            return position.pending || attitude_euler.pending || battery.pending ||
+                   gps_info.pending || flight_mode.pending;
+        }
+    };
+
+    // Assumes to have the lock for the state mutex.
+    template<typename T> static void take(TopicState<T>& topic, std::optional<T>& out)
+    {
+        if (topic.pending) {
+            out = topic.pending;
+            topic.sent = std::move(topic.pending);
+            topic.pending.reset();
+        }
+    }
+
+    Telemetry& _telemetry;
+    const std::chrono::steady_clock::duration _period;
+    std::shared_ptr<State> _state{std::make_shared<State>()};
+
+    mavsdk::Telemetry::PositionHandle _position_handle{};
+    mavsdk::Telemetry::AttitudeEulerHandle _attitude_euler_handle{};
+    mavsdk::Telemetry::BatteryHandle _battery_handle{};
+    mavsdk::Telemetry::GpsInfoHandle _gps_info_handle{};
+    mavsdk::Telemetry::FlightModeHandle _flight_mode_handle{};
+};
+
+} // namespace mavsdk_server
+} // namespace mavsdk
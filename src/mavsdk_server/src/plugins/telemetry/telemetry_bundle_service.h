@@ -0,0 +1,144 @@
+#pragma once
+
+#include <grpcpp/impl/codegen/byte_buffer.h>
+#include <grpcpp/impl/codegen/method_handler.h>
+#include <grpcpp/impl/codegen/rpc_service_method.h>
+#include <grpcpp/impl/codegen/service_type.h>
+#include <grpcpp/impl/codegen/sync_stream.h>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "lazy_plugin.h"
+#include "plugins/telemetry/telemetry.h"
+#include "system_routing.h"
+#include "telemetry_bundle.h"
+#include "telemetry_bundle_wire.h"
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+// Several telemetry topics in one stream, see TelemetryBundle:
+//
+//   service TelemetryBundleService {
+//       rpc SubscribeTelemetryBundle(SubscribeTelemetryBundleRequest)
+//           returns (stream TelemetryBundleResponse);
+//   }
+//
+// with the messages in telemetry_bundle_wire.h, in package mavsdk.rpc.telemetry.
+// Like MavlinkPassthroughService it is served without generated code. As the
+// server takes only one generic service, which the passthrough uses, the method
+// is added as a raw one, reading and writing the serialized messages.
+template<typename Telemetry = Telemetry, typename LazyPlugin = LazyPlugin<Telemetry>>
+class TelemetryBundleService final : public grpc::Service {
+public:
+    static constexpr auto subscribe_telemetry_bundle_method =
+        "/mavsdk.rpc.telemetry.TelemetryBundleService/SubscribeTelemetryBundle";
+
+    explicit TelemetryBundleService(LazyPlugin& lazy_plugin) : _lazy_plugin(lazy_plugin)
+    {
+        using Handler = grpc::internal::
+            ServerStreamingHandler<TelemetryBundleService, grpc::ByteBuffer, grpc::ByteBuffer>;
+
+        AddMethod(new grpc::internal::RpcServiceMethod(
+            subscribe_telemetry_bundle_method,
+            grpc::internal::RpcMethod::SERVER_STREAMING,
+            new Handler(
+                [](TelemetryBundleService* service,
+                   grpc::ServerContext* context,
+                   const grpc::ByteBuffer* request,
+                   grpc::ServerWriter<grpc::ByteBuffer>* writer) {
+                    return service->SubscribeTelemetryBundle(context, request, writer);
+                },
+                this)));
+    }
+
+    grpc::Status SubscribeTelemetryBundle(
+        grpc::ServerContext* context,
+        const grpc::ByteBuffer* request_buffer,
+        grpc::ServerWriter<grpc::ByteBuffer>* writer)
+    {
+        SubscribeTelemetryBundleRequest request;
+        if (!decode_subscribe_telemetry_bundle_request(to_string(*request_buffer), request)) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid request");
+        }
+        if (request.topics == 0) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "No topic requested");
+        }
+
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
+            return grpc::Status::OK;
+        }
+
+        Bundle bundle{*plugin, request.topics, request.max_rate_hz};
+        register_bundle(bundle);
+
+        TelemetryBundleChanges changes;
+        std::string response;
+        while (bundle.wait_for_changes(changes)) {
+            response.clear();
+            encode_telemetry_bundle_response(changes, response);
+            grpc::Slice slice(response);
+            if (!writer->Write(grpc::ByteBuffer(&slice, 1))) {
+                break;
+            }
+        }
+
+        unregister_bundle(bundle);
+        return grpc::Status::OK;
+    }
+
+    // Ends the open streams, and the ones opened after.
+    void stop()
+    {
+        std::lock_guard<std::mutex> lock(_bundles_mutex);
+        _stopped = true;
+        for (auto* bundle : _bundles) {
+            bundle->close();
+        }
+    }
+
+private:
+    using Bundle = TelemetryBundle<Telemetry>;
+
+    static std::string to_string(const grpc::ByteBuffer& buffer)
+    {
+        std::vector<grpc::Slice> slices;
+        std::string result;
+        if (!buffer.Dump(&slices).ok()) {
+            return result;
+        }
+        for (const auto& slice : slices) {
+            result.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+        }
+        return result;
+    }
+
+    void register_bundle(Bundle& bundle)
+    {
+        std::lock_guard<std::mutex> lock(_bundles_mutex);
+        if (_stopped) {
+            bundle.close();
+            return;
+        }
+        _bundles.insert(&bundle);
+    }
+
+    void unregister_bundle(Bundle& bundle)
+    {
+        std::lock_guard<std::mutex> lock(_bundles_mutex);
+        _bundles.erase(&bundle);
+    }
+
+    LazyPlugin& _lazy_plugin;
+
+    std::mutex _bundles_mutex{};
+    std::set<Bundle*> _bundles{};
+    bool _stopped{false};
+};
+
+} // namespace mavsdk_server
+} // namespace mavsdk
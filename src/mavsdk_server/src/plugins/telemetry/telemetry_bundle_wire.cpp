@@ -0,0 +1,101 @@
+#include "telemetry_bundle_wire.h"
+
+#include "protobuf_wire.h"
+#include "telemetry/telemetry_service_impl.h"
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+using namespace protobuf_wire;
+
+namespace {
+
+using Translate = TelemetryServiceImpl<>;
+
+} // namespace
+
+bool decode_subscribe_telemetry_bundle_request(
+    const std::string& data, SubscribeTelemetryBundleRequest& request)
+{
+    using Topic = TelemetryBundle<>::Topic;
+
+    request = {};
+
+    Reader reader{data};
+    while (!reader.done()) {
+        uint32_t field;
+        uint32_t wire_type;
+        if (!reader.read_tag(field, wire_type)) {
+            return false;
+        }
+
+        if (field >= 1 && field <= 5 && wire_type == Varint) {
+            static constexpr uint32_t topic_of_field[] = {
+                Topic::Position,
+                Topic::AttitudeEuler,
+                Topic::Battery,
+                Topic::GpsInfo,
+                Topic::FlightMode,
+            };
+            bool wanted;
+            if (!reader.read_bool(wanted)) {
+                return false;
+            }
+            // The last one counts, as with protobuf.
+            if (wanted) {
+                request.topics |= topic_of_field[field - 1];
+            } else {
+                request.topics &= ~topic_of_field[field - 1];
+            }
+
+        } else if (field == 6 && wire_type == Fixed64) {
+            if (!reader.read_double(request.max_rate_hz)) {
+                return false;
+            }
+
+        } else if (!reader.skip(wire_type)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void encode_telemetry_bundle_response(const TelemetryBundleChanges& changes, std::string& out)
+{
+    // Serialized one by one into this, to be written as fields of the bundle.
+    std::string message;
+
+    if (changes.position) {
+        rpc::telemetry::Position rpc_position;
+        Translate::translateToRpcPosition(*changes.position, &rpc_position);
+        rpc_position.SerializeToString(&message);
+        write_bytes_field(1, message, out);
+    }
+    if (changes.attitude_euler) {
+        rpc::telemetry::EulerAngle rpc_attitude_euler;
+        Translate::translateToRpcEulerAngle(*changes.attitude_euler, &rpc_attitude_euler);
+        rpc_attitude_euler.SerializeToString(&message);
+        write_bytes_field(2, message, out);
+    }
+    if (changes.battery) {
+        rpc::telemetry::Battery rpc_battery;
+        Translate::translateToRpcBattery(*changes.battery, &rpc_battery);
+        rpc_battery.SerializeToString(&message);
+        write_bytes_field(3, message, out);
+    }
+    if (changes.gps_info) {
+        rpc::telemetry::GpsInfo rpc_gps_info;
+        Translate::translateToRpcGpsInfo(*changes.gps_info, &rpc_gps_info);
+        rpc_gps_info.SerializeToString(&message);
+        write_bytes_field(4, message, out);
+    }
+    if (changes.flight_mode) {
+        // With explicit presence, so it is written even if it is the default.
+        write_tag(5, Varint, out);
+        const int64_t flight_mode = Translate::translateToRpcFlightMode(*changes.flight_mode);
+        write_varint(static_cast<uint64_t>(flight_mode), out);
+    }
+}
+
+} // namespace mavsdk_server
+} // namespace mavsdk
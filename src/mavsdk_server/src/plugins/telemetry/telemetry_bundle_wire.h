@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "telemetry_bundle.h"
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+// Protobuf wire format of the messages of the TelemetryBundle service (see
+// telemetry_bundle_service.h), encoded by hand as the service is served
+// without generated code. The topics use the messages of telemetry.proto:
+//
+//   message SubscribeTelemetryBundleRequest {
+//       bool position = 1;
+//       bool attitude_euler = 2;
+//       bool battery = 3;
+//       bool gps_info = 4;
+//       bool flight_mode = 5;
+//       double max_rate_hz = 6; // 0 for every change
+//   }
+//   message TelemetryBundleResponse {
+//       // Only the topics which changed since the previous response are set.
+//       Position position = 1;
+//       EulerAngle attitude_euler = 2;
+//       Battery battery = 3;
+//       GpsInfo gps_info = 4;
+//       optional FlightMode flight_mode = 5;
+//   }
+//
+// Decoding skips unknown fields, like protobuf does.
+
+struct SubscribeTelemetryBundleRequest {
+    // Of TelemetryBundle::Topic.
+    uint32_t topics{0};
+    double max_rate_hz{0.0};
+};
+
+bool decode_subscribe_telemetry_bundle_request(
+    const std::string& data, SubscribeTelemetryBundleRequest& request);
+
+void encode_telemetry_bundle_response(const TelemetryBundleChanges& changes, std::string& out);
+
+} // namespace mavsdk_server
+} // namespace mavsdk
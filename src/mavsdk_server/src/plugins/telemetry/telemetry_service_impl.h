@@ -8,11 +8,15 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "stream_writer.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -299,11 +303,9 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::telemetry::Position>
-    translateToRpcPosition(const mavsdk::Telemetry::Position& position)
+    static void translateToRpcPosition(
+        const mavsdk::Telemetry::Position& position, rpc::telemetry::Position* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::Position>();
-
         rpc_obj->set_latitude_deg(position.latitude_deg);
 
         rpc_obj->set_longitude_deg(position.longitude_deg);
@@ -311,7 +313,13 @@ public:
         rpc_obj->set_absolute_altitude_m(position.absolute_altitude_m);
 
         rpc_obj->set_relative_altitude_m(position.relative_altitude_m);
+    }
 
+    static std::unique_ptr<rpc::telemetry::Position>
+    translateToRpcPosition(const mavsdk::Telemetry::Position& position)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::Position>();
+        translateToRpcPosition(position, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -331,13 +339,17 @@ public:
         return obj;
     }
 
+    static void translateToRpcHeading(
+        const mavsdk::Telemetry::Heading& heading, rpc::telemetry::Heading* rpc_obj)
+    {
+        rpc_obj->set_heading_deg(heading.heading_deg);
+    }
+
     static std::unique_ptr<rpc::telemetry::Heading>
     translateToRpcHeading(const mavsdk::Telemetry::Heading& heading)
     {
         auto rpc_obj = std::make_unique<rpc::telemetry::Heading>();
-
-        rpc_obj->set_heading_deg(heading.heading_deg);
-
+        translateToRpcHeading(heading, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -351,11 +363,9 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::Quaternion>
-    translateToRpcQuaternion(const mavsdk::Telemetry::Quaternion& quaternion)
+    static void translateToRpcQuaternion(
+        const mavsdk::Telemetry::Quaternion& quaternion, rpc::telemetry::Quaternion* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::Quaternion>();
-
         rpc_obj->set_w(quaternion.w);
 
         rpc_obj->set_x(quaternion.x);
@@ -365,7 +375,13 @@ public:
         rpc_obj->set_z(quaternion.z);
 
         rpc_obj->set_timestamp_us(quaternion.timestamp_us);
+    }
 
+    static std::unique_ptr<rpc::telemetry::Quaternion>
+    translateToRpcQuaternion(const mavsdk::Telemetry::Quaternion& quaternion)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::Quaternion>();
+        translateToRpcQuaternion(quaternion, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -387,11 +403,9 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::EulerAngle>
-    translateToRpcEulerAngle(const mavsdk::Telemetry::EulerAngle& euler_angle)
+    static void translateToRpcEulerAngle(
+        const mavsdk::Telemetry::EulerAngle& euler_angle, rpc::telemetry::EulerAngle* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::EulerAngle>();
-
         rpc_obj->set_roll_deg(euler_angle.roll_deg);
 
         rpc_obj->set_pitch_deg(euler_angle.pitch_deg);
@@ -399,7 +413,13 @@ public:
         rpc_obj->set_yaw_deg(euler_angle.yaw_deg);
 
         rpc_obj->set_timestamp_us(euler_angle.timestamp_us);
+    }
 
+    static std::unique_ptr<rpc::telemetry::EulerAngle>
+    translateToRpcEulerAngle(const mavsdk::Telemetry::EulerAngle& euler_angle)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::EulerAngle>();
+        translateToRpcEulerAngle(euler_angle, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -419,17 +439,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::AngularVelocityBody> translateToRpcAngularVelocityBody(
-        const mavsdk::Telemetry::AngularVelocityBody& angular_velocity_body)
+    static void translateToRpcAngularVelocityBody(
+        const mavsdk::Telemetry::AngularVelocityBody& angular_velocity_body,
+        rpc::telemetry::AngularVelocityBody* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::AngularVelocityBody>();
-
         rpc_obj->set_roll_rad_s(angular_velocity_body.roll_rad_s);
 
         rpc_obj->set_pitch_rad_s(angular_velocity_body.pitch_rad_s);
 
         rpc_obj->set_yaw_rad_s(angular_velocity_body.yaw_rad_s);
+    }
 
+    static std::unique_ptr<rpc::telemetry::AngularVelocityBody> translateToRpcAngularVelocityBody(
+        const mavsdk::Telemetry::AngularVelocityBody& angular_velocity_body)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::AngularVelocityBody>();
+        translateToRpcAngularVelocityBody(angular_velocity_body, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -447,15 +472,19 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::GpsInfo>
-    translateToRpcGpsInfo(const mavsdk::Telemetry::GpsInfo& gps_info)
+    static void translateToRpcGpsInfo(
+        const mavsdk::Telemetry::GpsInfo& gps_info, rpc::telemetry::GpsInfo* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::GpsInfo>();
-
         rpc_obj->set_num_satellites(gps_info.num_satellites);
 
         rpc_obj->set_fix_type(translateToRpcFixType(gps_info.fix_type));
+    }
 
+    static std::unique_ptr<rpc::telemetry::GpsInfo>
+    translateToRpcGpsInfo(const mavsdk::Telemetry::GpsInfo& gps_info)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::GpsInfo>();
+        translateToRpcGpsInfo(gps_info, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -471,11 +500,9 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::RawGps>
-    translateToRpcRawGps(const mavsdk::Telemetry::RawGps& raw_gps)
+    static void translateToRpcRawGps(
+        const mavsdk::Telemetry::RawGps& raw_gps, rpc::telemetry::RawGps* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::RawGps>();
-
         rpc_obj->set_timestamp_us(raw_gps.timestamp_us);
 
         rpc_obj->set_latitude_deg(raw_gps.latitude_deg);
@@ -503,7 +530,13 @@ public:
         rpc_obj->set_heading_uncertainty_deg(raw_gps.heading_uncertainty_deg);
 
         rpc_obj->set_yaw_deg(raw_gps.yaw_deg);
+    }
 
+    static std::unique_ptr<rpc::telemetry::RawGps>
+    translateToRpcRawGps(const mavsdk::Telemetry::RawGps& raw_gps)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::RawGps>();
+        translateToRpcRawGps(raw_gps, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -542,17 +575,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::Battery>
-    translateToRpcBattery(const mavsdk::Telemetry::Battery& battery)
+    static void translateToRpcBattery(
+        const mavsdk::Telemetry::Battery& battery, rpc::telemetry::Battery* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::Battery>();
-
         rpc_obj->set_id(battery.id);
 
         rpc_obj->set_voltage_v(battery.voltage_v);
 
         rpc_obj->set_remaining_percent(battery.remaining_percent);
+    }
 
+    static std::unique_ptr<rpc::telemetry::Battery>
+    translateToRpcBattery(const mavsdk::Telemetry::Battery& battery)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::Battery>();
+        translateToRpcBattery(battery, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -570,11 +607,9 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::Health>
-    translateToRpcHealth(const mavsdk::Telemetry::Health& health)
+    static void translateToRpcHealth(
+        const mavsdk::Telemetry::Health& health, rpc::telemetry::Health* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::Health>();
-
         rpc_obj->set_is_gyrometer_calibration_ok(health.is_gyrometer_calibration_ok);
 
         rpc_obj->set_is_accelerometer_calibration_ok(health.is_accelerometer_calibration_ok);
@@ -588,7 +623,13 @@ public:
         rpc_obj->set_is_home_position_ok(health.is_home_position_ok);
 
         rpc_obj->set_is_armable(health.is_armable);
+    }
 
+    static std::unique_ptr<rpc::telemetry::Health>
+    translateToRpcHealth(const mavsdk::Telemetry::Health& health)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::Health>();
+        translateToRpcHealth(health, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -613,17 +654,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::RcStatus>
-    translateToRpcRcStatus(const mavsdk::Telemetry::RcStatus& rc_status)
+    static void translateToRpcRcStatus(
+        const mavsdk::Telemetry::RcStatus& rc_status, rpc::telemetry::RcStatus* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::RcStatus>();
-
         rpc_obj->set_was_available_once(rc_status.was_available_once);
 
         rpc_obj->set_is_available(rc_status.is_available);
 
         rpc_obj->set_signal_strength_percent(rc_status.signal_strength_percent);
+    }
 
+    static std::unique_ptr<rpc::telemetry::RcStatus>
+    translateToRpcRcStatus(const mavsdk::Telemetry::RcStatus& rc_status)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::RcStatus>();
+        translateToRpcRcStatus(rc_status, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -641,15 +686,19 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::StatusText>
-    translateToRpcStatusText(const mavsdk::Telemetry::StatusText& status_text)
+    static void translateToRpcStatusText(
+        const mavsdk::Telemetry::StatusText& status_text, rpc::telemetry::StatusText* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::StatusText>();
-
         rpc_obj->set_type(translateToRpcStatusTextType(status_text.type));
 
         rpc_obj->set_text(status_text.text);
+    }
 
+    static std::unique_ptr<rpc::telemetry::StatusText>
+    translateToRpcStatusText(const mavsdk::Telemetry::StatusText& status_text)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::StatusText>();
+        translateToRpcStatusText(status_text, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -665,18 +714,24 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::ActuatorControlTarget>
-    translateToRpcActuatorControlTarget(
-        const mavsdk::Telemetry::ActuatorControlTarget& actuator_control_target)
+    static void translateToRpcActuatorControlTarget(
+        const mavsdk::Telemetry::ActuatorControlTarget& actuator_control_target,
+        rpc::telemetry::ActuatorControlTarget* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::ActuatorControlTarget>();
-
         rpc_obj->set_group(actuator_control_target.group);
 
+        rpc_obj->clear_controls();
         for (const auto& elem : actuator_control_target.controls) {
             rpc_obj->add_controls(elem);
         }
+    }
 
+    static std::unique_ptr<rpc::telemetry::ActuatorControlTarget>
+    translateToRpcActuatorControlTarget(
+        const mavsdk::Telemetry::ActuatorControlTarget& actuator_control_target)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::ActuatorControlTarget>();
+        translateToRpcActuatorControlTarget(actuator_control_target, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -694,17 +749,23 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::ActuatorOutputStatus> translateToRpcActuatorOutputStatus(
-        const mavsdk::Telemetry::ActuatorOutputStatus& actuator_output_status)
+    static void translateToRpcActuatorOutputStatus(
+        const mavsdk::Telemetry::ActuatorOutputStatus& actuator_output_status,
+        rpc::telemetry::ActuatorOutputStatus* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::ActuatorOutputStatus>();
-
         rpc_obj->set_active(actuator_output_status.active);
 
+        rpc_obj->clear_actuator();
         for (const auto& elem : actuator_output_status.actuator) {
             rpc_obj->add_actuator(elem);
         }
+    }
 
+    static std::unique_ptr<rpc::telemetry::ActuatorOutputStatus> translateToRpcActuatorOutputStatus(
+        const mavsdk::Telemetry::ActuatorOutputStatus& actuator_output_status)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::ActuatorOutputStatus>();
+        translateToRpcActuatorOutputStatus(actuator_output_status, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -722,15 +783,20 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::Covariance>
-    translateToRpcCovariance(const mavsdk::Telemetry::Covariance& covariance)
+    static void translateToRpcCovariance(
+        const mavsdk::Telemetry::Covariance& covariance, rpc::telemetry::Covariance* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::Covariance>();
-
+        rpc_obj->clear_covariance_matrix();
         for (const auto& elem : covariance.covariance_matrix) {
             rpc_obj->add_covariance_matrix(elem);
         }
+    }
 
+    static std::unique_ptr<rpc::telemetry::Covariance>
+    translateToRpcCovariance(const mavsdk::Telemetry::Covariance& covariance)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::Covariance>();
+        translateToRpcCovariance(covariance, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -746,17 +812,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::VelocityBody>
-    translateToRpcVelocityBody(const mavsdk::Telemetry::VelocityBody& velocity_body)
+    static void translateToRpcVelocityBody(
+        const mavsdk::Telemetry::VelocityBody& velocity_body, rpc::telemetry::VelocityBody* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::VelocityBody>();
-
         rpc_obj->set_x_m_s(velocity_body.x_m_s);
 
         rpc_obj->set_y_m_s(velocity_body.y_m_s);
 
         rpc_obj->set_z_m_s(velocity_body.z_m_s);
+    }
 
+    static std::unique_ptr<rpc::telemetry::VelocityBody>
+    translateToRpcVelocityBody(const mavsdk::Telemetry::VelocityBody& velocity_body)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::VelocityBody>();
+        translateToRpcVelocityBody(velocity_body, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -774,17 +844,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::PositionBody>
-    translateToRpcPositionBody(const mavsdk::Telemetry::PositionBody& position_body)
+    static void translateToRpcPositionBody(
+        const mavsdk::Telemetry::PositionBody& position_body, rpc::telemetry::PositionBody* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::PositionBody>();
-
         rpc_obj->set_x_m(position_body.x_m);
 
         rpc_obj->set_y_m(position_body.y_m);
 
         rpc_obj->set_z_m(position_body.z_m);
+    }
 
+    static std::unique_ptr<rpc::telemetry::PositionBody>
+    translateToRpcPositionBody(const mavsdk::Telemetry::PositionBody& position_body)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::PositionBody>();
+        translateToRpcPositionBody(position_body, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -838,34 +912,35 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::telemetry::Odometry>
-    translateToRpcOdometry(const mavsdk::Telemetry::Odometry& odometry)
+    static void translateToRpcOdometry(
+        const mavsdk::Telemetry::Odometry& odometry, rpc::telemetry::Odometry* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::Odometry>();
-
         rpc_obj->set_time_usec(odometry.time_usec);
 
         rpc_obj->set_frame_id(translateToRpcMavFrame(odometry.frame_id));
 
         rpc_obj->set_child_frame_id(translateToRpcMavFrame(odometry.child_frame_id));
 
-        rpc_obj->set_allocated_position_body(
-            translateToRpcPositionBody(odometry.position_body).release());
+        translateToRpcPositionBody(odometry.position_body, rpc_obj->mutable_position_body());
 
-        rpc_obj->set_allocated_q(translateToRpcQuaternion(odometry.q).release());
+        translateToRpcQuaternion(odometry.q, rpc_obj->mutable_q());
 
-        rpc_obj->set_allocated_velocity_body(
-            translateToRpcVelocityBody(odometry.velocity_body).release());
+        translateToRpcVelocityBody(odometry.velocity_body, rpc_obj->mutable_velocity_body());
 
-        rpc_obj->set_allocated_angular_velocity_body(
-            translateToRpcAngularVelocityBody(odometry.angular_velocity_body).release());
+        translateToRpcAngularVelocityBody(
+            odometry.angular_velocity_body, rpc_obj->mutable_angular_velocity_body());
 
-        rpc_obj->set_allocated_pose_covariance(
-            translateToRpcCovariance(odometry.pose_covariance).release());
+        translateToRpcCovariance(odometry.pose_covariance, rpc_obj->mutable_pose_covariance());
 
-        rpc_obj->set_allocated_velocity_covariance(
-            translateToRpcCovariance(odometry.velocity_covariance).release());
+        translateToRpcCovariance(
+            odometry.velocity_covariance, rpc_obj->mutable_velocity_covariance());
+    }
 
+    static std::unique_ptr<rpc::telemetry::Odometry>
+    translateToRpcOdometry(const mavsdk::Telemetry::Odometry& odometry)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::Odometry>();
+        translateToRpcOdometry(odometry, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -896,17 +971,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::DistanceSensor>
-    translateToRpcDistanceSensor(const mavsdk::Telemetry::DistanceSensor& distance_sensor)
+    static void translateToRpcDistanceSensor(
+        const mavsdk::Telemetry::DistanceSensor& distance_sensor,
+        rpc::telemetry::DistanceSensor* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::DistanceSensor>();
-
         rpc_obj->set_minimum_distance_m(distance_sensor.minimum_distance_m);
 
         rpc_obj->set_maximum_distance_m(distance_sensor.maximum_distance_m);
 
         rpc_obj->set_current_distance_m(distance_sensor.current_distance_m);
+    }
 
+    static std::unique_ptr<rpc::telemetry::DistanceSensor>
+    translateToRpcDistanceSensor(const mavsdk::Telemetry::DistanceSensor& distance_sensor)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::DistanceSensor>();
+        translateToRpcDistanceSensor(distance_sensor, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -924,11 +1004,10 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::ScaledPressure>
-    translateToRpcScaledPressure(const mavsdk::Telemetry::ScaledPressure& scaled_pressure)
+    static void translateToRpcScaledPressure(
+        const mavsdk::Telemetry::ScaledPressure& scaled_pressure,
+        rpc::telemetry::ScaledPressure* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::ScaledPressure>();
-
         rpc_obj->set_timestamp_us(scaled_pressure.timestamp_us);
 
         rpc_obj->set_absolute_pressure_hpa(scaled_pressure.absolute_pressure_hpa);
@@ -939,7 +1018,13 @@ public:
 
         rpc_obj->set_differential_pressure_temperature_deg(
             scaled_pressure.differential_pressure_temperature_deg);
+    }
 
+    static std::unique_ptr<rpc::telemetry::ScaledPressure>
+    translateToRpcScaledPressure(const mavsdk::Telemetry::ScaledPressure& scaled_pressure)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::ScaledPressure>();
+        translateToRpcScaledPressure(scaled_pressure, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -962,17 +1047,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::PositionNed>
-    translateToRpcPositionNed(const mavsdk::Telemetry::PositionNed& position_ned)
+    static void translateToRpcPositionNed(
+        const mavsdk::Telemetry::PositionNed& position_ned, rpc::telemetry::PositionNed* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::PositionNed>();
-
         rpc_obj->set_north_m(position_ned.north_m);
 
         rpc_obj->set_east_m(position_ned.east_m);
 
         rpc_obj->set_down_m(position_ned.down_m);
+    }
 
+    static std::unique_ptr<rpc::telemetry::PositionNed>
+    translateToRpcPositionNed(const mavsdk::Telemetry::PositionNed& position_ned)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::PositionNed>();
+        translateToRpcPositionNed(position_ned, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -990,17 +1079,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::VelocityNed>
-    translateToRpcVelocityNed(const mavsdk::Telemetry::VelocityNed& velocity_ned)
+    static void translateToRpcVelocityNed(
+        const mavsdk::Telemetry::VelocityNed& velocity_ned, rpc::telemetry::VelocityNed* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::VelocityNed>();
-
         rpc_obj->set_north_m_s(velocity_ned.north_m_s);
 
         rpc_obj->set_east_m_s(velocity_ned.east_m_s);
 
         rpc_obj->set_down_m_s(velocity_ned.down_m_s);
+    }
 
+    static std::unique_ptr<rpc::telemetry::VelocityNed>
+    translateToRpcVelocityNed(const mavsdk::Telemetry::VelocityNed& velocity_ned)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::VelocityNed>();
+        translateToRpcVelocityNed(velocity_ned, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -1018,17 +1111,20 @@ public:
         return obj;
     }
 
+    static void translateToRpcPositionVelocityNed(
+        const mavsdk::Telemetry::PositionVelocityNed& position_velocity_ned,
+        rpc::telemetry::PositionVelocityNed* rpc_obj)
+    {
+        translateToRpcPositionNed(position_velocity_ned.position, rpc_obj->mutable_position());
+
+        translateToRpcVelocityNed(position_velocity_ned.velocity, rpc_obj->mutable_velocity());
+    }
+
     static std::unique_ptr<rpc::telemetry::PositionVelocityNed> translateToRpcPositionVelocityNed(
         const mavsdk::Telemetry::PositionVelocityNed& position_velocity_ned)
     {
         auto rpc_obj = std::make_unique<rpc::telemetry::PositionVelocityNed>();
-
-        rpc_obj->set_allocated_position(
-            translateToRpcPositionNed(position_velocity_ned.position).release());
-
-        rpc_obj->set_allocated_velocity(
-            translateToRpcVelocityNed(position_velocity_ned.velocity).release());
-
+        translateToRpcPositionVelocityNed(position_velocity_ned, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -1044,17 +1140,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::GroundTruth>
-    translateToRpcGroundTruth(const mavsdk::Telemetry::GroundTruth& ground_truth)
+    static void translateToRpcGroundTruth(
+        const mavsdk::Telemetry::GroundTruth& ground_truth, rpc::telemetry::GroundTruth* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::GroundTruth>();
-
         rpc_obj->set_latitude_deg(ground_truth.latitude_deg);
 
         rpc_obj->set_longitude_deg(ground_truth.longitude_deg);
 
         rpc_obj->set_absolute_altitude_m(ground_truth.absolute_altitude_m);
+    }
 
+    static std::unique_ptr<rpc::telemetry::GroundTruth>
+    translateToRpcGroundTruth(const mavsdk::Telemetry::GroundTruth& ground_truth)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::GroundTruth>();
+        translateToRpcGroundTruth(ground_truth, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -1072,17 +1172,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::FixedwingMetrics>
-    translateToRpcFixedwingMetrics(const mavsdk::Telemetry::FixedwingMetrics& fixedwing_metrics)
+    static void translateToRpcFixedwingMetrics(
+        const mavsdk::Telemetry::FixedwingMetrics& fixedwing_metrics,
+        rpc::telemetry::FixedwingMetrics* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::FixedwingMetrics>();
-
         rpc_obj->set_airspeed_m_s(fixedwing_metrics.airspeed_m_s);
 
         rpc_obj->set_throttle_percentage(fixedwing_metrics.throttle_percentage);
 
         rpc_obj->set_climb_rate_m_s(fixedwing_metrics.climb_rate_m_s);
+    }
 
+    static std::unique_ptr<rpc::telemetry::FixedwingMetrics>
+    translateToRpcFixedwingMetrics(const mavsdk::Telemetry::FixedwingMetrics& fixedwing_metrics)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::FixedwingMetrics>();
+        translateToRpcFixedwingMetrics(fixedwing_metrics, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -1100,17 +1205,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::AccelerationFrd>
-    translateToRpcAccelerationFrd(const mavsdk::Telemetry::AccelerationFrd& acceleration_frd)
+    static void translateToRpcAccelerationFrd(
+        const mavsdk::Telemetry::AccelerationFrd& acceleration_frd,
+        rpc::telemetry::AccelerationFrd* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::AccelerationFrd>();
-
         rpc_obj->set_forward_m_s2(acceleration_frd.forward_m_s2);
 
         rpc_obj->set_right_m_s2(acceleration_frd.right_m_s2);
 
         rpc_obj->set_down_m_s2(acceleration_frd.down_m_s2);
+    }
 
+    static std::unique_ptr<rpc::telemetry::AccelerationFrd>
+    translateToRpcAccelerationFrd(const mavsdk::Telemetry::AccelerationFrd& acceleration_frd)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::AccelerationFrd>();
+        translateToRpcAccelerationFrd(acceleration_frd, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -1128,17 +1238,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::AngularVelocityFrd> translateToRpcAngularVelocityFrd(
-        const mavsdk::Telemetry::AngularVelocityFrd& angular_velocity_frd)
+    static void translateToRpcAngularVelocityFrd(
+        const mavsdk::Telemetry::AngularVelocityFrd& angular_velocity_frd,
+        rpc::telemetry::AngularVelocityFrd* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::AngularVelocityFrd>();
-
         rpc_obj->set_forward_rad_s(angular_velocity_frd.forward_rad_s);
 
         rpc_obj->set_right_rad_s(angular_velocity_frd.right_rad_s);
 
         rpc_obj->set_down_rad_s(angular_velocity_frd.down_rad_s);
+    }
 
+    static std::unique_ptr<rpc::telemetry::AngularVelocityFrd> translateToRpcAngularVelocityFrd(
+        const mavsdk::Telemetry::AngularVelocityFrd& angular_velocity_frd)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::AngularVelocityFrd>();
+        translateToRpcAngularVelocityFrd(angular_velocity_frd, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -1156,17 +1271,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::MagneticFieldFrd>
-    translateToRpcMagneticFieldFrd(const mavsdk::Telemetry::MagneticFieldFrd& magnetic_field_frd)
+    static void translateToRpcMagneticFieldFrd(
+        const mavsdk::Telemetry::MagneticFieldFrd& magnetic_field_frd,
+        rpc::telemetry::MagneticFieldFrd* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::MagneticFieldFrd>();
-
         rpc_obj->set_forward_gauss(magnetic_field_frd.forward_gauss);
 
         rpc_obj->set_right_gauss(magnetic_field_frd.right_gauss);
 
         rpc_obj->set_down_gauss(magnetic_field_frd.down_gauss);
+    }
 
+    static std::unique_ptr<rpc::telemetry::MagneticFieldFrd>
+    translateToRpcMagneticFieldFrd(const mavsdk::Telemetry::MagneticFieldFrd& magnetic_field_frd)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::MagneticFieldFrd>();
+        translateToRpcMagneticFieldFrd(magnetic_field_frd, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -1184,23 +1304,25 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::Imu> translateToRpcImu(const mavsdk::Telemetry::Imu& imu)
+    static void translateToRpcImu(const mavsdk::Telemetry::Imu& imu, rpc::telemetry::Imu* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::Imu>();
-
-        rpc_obj->set_allocated_acceleration_frd(
-            translateToRpcAccelerationFrd(imu.acceleration_frd).release());
+        translateToRpcAccelerationFrd(imu.acceleration_frd, rpc_obj->mutable_acceleration_frd());
 
-        rpc_obj->set_allocated_angular_velocity_frd(
-            translateToRpcAngularVelocityFrd(imu.angular_velocity_frd).release());
+        translateToRpcAngularVelocityFrd(
+            imu.angular_velocity_frd, rpc_obj->mutable_angular_velocity_frd());
 
-        rpc_obj->set_allocated_magnetic_field_frd(
-            translateToRpcMagneticFieldFrd(imu.magnetic_field_frd).release());
+        translateToRpcMagneticFieldFrd(
+            imu.magnetic_field_frd, rpc_obj->mutable_magnetic_field_frd());
 
         rpc_obj->set_temperature_degc(imu.temperature_degc);
 
         rpc_obj->set_timestamp_us(imu.timestamp_us);
+    }
 
+    static std::unique_ptr<rpc::telemetry::Imu> translateToRpcImu(const mavsdk::Telemetry::Imu& imu)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::Imu>();
+        translateToRpcImu(imu, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -1221,17 +1343,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry::GpsGlobalOrigin>
-    translateToRpcGpsGlobalOrigin(const mavsdk::Telemetry::GpsGlobalOrigin& gps_global_origin)
+    static void translateToRpcGpsGlobalOrigin(
+        const mavsdk::Telemetry::GpsGlobalOrigin& gps_global_origin,
+        rpc::telemetry::GpsGlobalOrigin* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry::GpsGlobalOrigin>();
-
         rpc_obj->set_latitude_deg(gps_global_origin.latitude_deg);
 
         rpc_obj->set_longitude_deg(gps_global_origin.longitude_deg);
 
         rpc_obj->set_altitude_m(gps_global_origin.altitude_m);
+    }
 
+    static std::unique_ptr<rpc::telemetry::GpsGlobalOrigin>
+    translateToRpcGpsGlobalOrigin(const mavsdk::Telemetry::GpsGlobalOrigin& gps_global_origin)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry::GpsGlobalOrigin>();
+        translateToRpcGpsGlobalOrigin(gps_global_origin, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -1302,1345 +1429,1117 @@ public:
     }
 
     grpc::Status SubscribePosition(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribePositionRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::PositionResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::PositionResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribePosition");
 
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_position(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::Position position) {
-                rpc::telemetry::PositionResponse rpc_response;
-
-                rpc_response.set_allocated_position(translateToRpcPosition(position).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_position(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_position(
+            [outbox](const mavsdk::Telemetry::Position position) {
+                outbox->emplace([&](rpc::telemetry::PositionResponse& rpc_response) {
+                    translateToRpcPosition(position, rpc_response.mutable_position());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_position(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeHome(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeHomeRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::HomeResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_home(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::Position home) {
-                rpc::telemetry::HomeResponse rpc_response;
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::HomeResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeHome");
 
-                rpc_response.set_allocated_home(translateToRpcPosition(home).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_home(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_home(
+            [outbox](const mavsdk::Telemetry::Position home) {
+                outbox->emplace([&](rpc::telemetry::HomeResponse& rpc_response) {
+                    translateToRpcPosition(home, rpc_response.mutable_home());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_home(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeInAir(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeInAirRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::InAirResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_in_air(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const bool in_air) {
-                rpc::telemetry::InAirResponse rpc_response;
-
-                rpc_response.set_is_in_air(in_air);
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::InAirResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeInAir");
 
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_in_air(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_in_air(
+            [outbox](const bool in_air) {
+                outbox->emplace([&](rpc::telemetry::InAirResponse& rpc_response) {
+                    rpc_response.set_is_in_air(in_air);
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_in_air(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeLandedState(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeLandedStateRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::LandedStateResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::LandedStateResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeLandedState");
 
-        _lazy_plugin.maybe_plugin()->subscribe_landed_state(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::LandedState landed_state) {
-                rpc::telemetry::LandedStateResponse rpc_response;
-
-                rpc_response.set_landed_state(translateToRpcLandedState(landed_state));
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_landed_state(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_landed_state(
+            [outbox](const mavsdk::Telemetry::LandedState landed_state) {
+                outbox->emplace([&](rpc::telemetry::LandedStateResponse& rpc_response) {
+                    rpc_response.set_landed_state(translateToRpcLandedState(landed_state));
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_landed_state(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeArmed(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeArmedRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::ArmedResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_armed(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const bool armed) {
-                rpc::telemetry::ArmedResponse rpc_response;
-
-                rpc_response.set_is_armed(armed);
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::ArmedResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeArmed");
 
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_armed(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_armed(
+            [outbox](const bool armed) {
+                outbox->emplace([&](rpc::telemetry::ArmedResponse& rpc_response) {
+                    rpc_response.set_is_armed(armed);
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_armed(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeVtolState(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeVtolStateRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::VtolStateResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::VtolStateResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeVtolState");
 
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_vtol_state(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::VtolState vtol_state) {
-                rpc::telemetry::VtolStateResponse rpc_response;
-
-                rpc_response.set_vtol_state(translateToRpcVtolState(vtol_state));
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_vtol_state(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_vtol_state(
+            [outbox](const mavsdk::Telemetry::VtolState vtol_state) {
+                outbox->emplace([&](rpc::telemetry::VtolStateResponse& rpc_response) {
+                    rpc_response.set_vtol_state(translateToRpcVtolState(vtol_state));
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_vtol_state(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeAttitudeQuaternion(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeAttitudeQuaternionRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::AttitudeQuaternionResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_attitude_quaternion(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::Quaternion attitude_quaternion) {
-                rpc::telemetry::AttitudeQuaternionResponse rpc_response;
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::AttitudeQuaternionResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeAttitudeQuaternion");
 
-                rpc_response.set_allocated_attitude_quaternion(
-                    translateToRpcQuaternion(attitude_quaternion).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_attitude_quaternion(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_attitude_quaternion(
+            [outbox](const mavsdk::Telemetry::Quaternion attitude_quaternion) {
+                outbox->emplace([&](rpc::telemetry::AttitudeQuaternionResponse& rpc_response) {
+                    translateToRpcQuaternion(
+                        attitude_quaternion, rpc_response.mutable_attitude_quaternion());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_attitude_quaternion(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeAttitudeEuler(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeAttitudeEulerRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::AttitudeEulerResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_attitude_euler(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::EulerAngle attitude_euler) {
-                rpc::telemetry::AttitudeEulerResponse rpc_response;
-
-                rpc_response.set_allocated_attitude_euler(
-                    translateToRpcEulerAngle(attitude_euler).release());
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::AttitudeEulerResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeAttitudeEuler");
 
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_attitude_euler(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_attitude_euler(
+            [outbox](const mavsdk::Telemetry::EulerAngle attitude_euler) {
+                outbox->emplace([&](rpc::telemetry::AttitudeEulerResponse& rpc_response) {
+                    translateToRpcEulerAngle(attitude_euler, rpc_response.mutable_attitude_euler());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_attitude_euler(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeAttitudeAngularVelocityBody(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeAttitudeAngularVelocityBodyRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::AttitudeAngularVelocityBodyResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox =
+            std::make_shared<StreamOutbox<rpc::telemetry::AttitudeAngularVelocityBodyResponse>>(
+                _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeAttitudeAngularVelocityBody");
 
-        _lazy_plugin.maybe_plugin()->subscribe_attitude_angular_velocity_body(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::AngularVelocityBody attitude_angular_velocity_body) {
-                rpc::telemetry::AttitudeAngularVelocityBodyResponse rpc_response;
-
-                rpc_response.set_allocated_attitude_angular_velocity_body(
-                    translateToRpcAngularVelocityBody(attitude_angular_velocity_body).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_attitude_angular_velocity_body(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_attitude_angular_velocity_body(
+            [outbox](const mavsdk::Telemetry::AngularVelocityBody attitude_angular_velocity_body) {
+                outbox->emplace(
+                    [&](rpc::telemetry::AttitudeAngularVelocityBodyResponse& rpc_response) {
+                        translateToRpcAngularVelocityBody(
+                            attitude_angular_velocity_body,
+                            rpc_response.mutable_attitude_angular_velocity_body());
+                    });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_attitude_angular_velocity_body(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeCameraAttitudeQuaternion(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeCameraAttitudeQuaternionRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::CameraAttitudeQuaternionResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_camera_attitude_quaternion(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::Quaternion camera_attitude_quaternion) {
-                rpc::telemetry::CameraAttitudeQuaternionResponse rpc_response;
-
-                rpc_response.set_allocated_attitude_quaternion(
-                    translateToRpcQuaternion(camera_attitude_quaternion).release());
+        auto outbox =
+            std::make_shared<StreamOutbox<rpc::telemetry::CameraAttitudeQuaternionResponse>>(
+                _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeCameraAttitudeQuaternion");
 
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_camera_attitude_quaternion(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_camera_attitude_quaternion(
+            [outbox](const mavsdk::Telemetry::Quaternion camera_attitude_quaternion) {
+                outbox->emplace(
+                    [&](rpc::telemetry::CameraAttitudeQuaternionResponse& rpc_response) {
+                        translateToRpcQuaternion(
+                            camera_attitude_quaternion, rpc_response.mutable_attitude_quaternion());
+                    });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_camera_attitude_quaternion(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeCameraAttitudeEuler(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeCameraAttitudeEulerRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::CameraAttitudeEulerResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::CameraAttitudeEulerResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeCameraAttitudeEuler");
 
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_camera_attitude_euler(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::EulerAngle camera_attitude_euler) {
-                rpc::telemetry::CameraAttitudeEulerResponse rpc_response;
-
-                rpc_response.set_allocated_attitude_euler(
-                    translateToRpcEulerAngle(camera_attitude_euler).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_camera_attitude_euler(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_camera_attitude_euler(
+            [outbox](const mavsdk::Telemetry::EulerAngle camera_attitude_euler) {
+                outbox->emplace([&](rpc::telemetry::CameraAttitudeEulerResponse& rpc_response) {
+                    translateToRpcEulerAngle(
+                        camera_attitude_euler, rpc_response.mutable_attitude_euler());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_camera_attitude_euler(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeVelocityNed(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeVelocityNedRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::VelocityNedResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_velocity_ned(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::VelocityNed velocity_ned) {
-                rpc::telemetry::VelocityNedResponse rpc_response;
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::VelocityNedResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeVelocityNed");
 
-                rpc_response.set_allocated_velocity_ned(
-                    translateToRpcVelocityNed(velocity_ned).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_velocity_ned(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_velocity_ned(
+            [outbox](const mavsdk::Telemetry::VelocityNed velocity_ned) {
+                outbox->emplace([&](rpc::telemetry::VelocityNedResponse& rpc_response) {
+                    translateToRpcVelocityNed(velocity_ned, rpc_response.mutable_velocity_ned());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_velocity_ned(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeGpsInfo(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeGpsInfoRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::GpsInfoResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_gps_info(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::GpsInfo gps_info) {
-                rpc::telemetry::GpsInfoResponse rpc_response;
-
-                rpc_response.set_allocated_gps_info(translateToRpcGpsInfo(gps_info).release());
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::GpsInfoResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeGpsInfo");
 
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_gps_info(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_gps_info(
+            [outbox](const mavsdk::Telemetry::GpsInfo gps_info) {
+                outbox->emplace([&](rpc::telemetry::GpsInfoResponse& rpc_response) {
+                    translateToRpcGpsInfo(gps_info, rpc_response.mutable_gps_info());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_gps_info(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeRawGps(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeRawGpsRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::RawGpsResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::RawGpsResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeRawGps");
 
-        _lazy_plugin.maybe_plugin()->subscribe_raw_gps(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::RawGps raw_gps) {
-                rpc::telemetry::RawGpsResponse rpc_response;
-
-                rpc_response.set_allocated_raw_gps(translateToRpcRawGps(raw_gps).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_raw_gps(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_raw_gps(
+            [outbox](const mavsdk::Telemetry::RawGps raw_gps) {
+                outbox->emplace([&](rpc::telemetry::RawGpsResponse& rpc_response) {
+                    translateToRpcRawGps(raw_gps, rpc_response.mutable_raw_gps());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_raw_gps(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeBattery(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeBatteryRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::BatteryResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_battery(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::Battery battery) {
-                rpc::telemetry::BatteryResponse rpc_response;
-
-                rpc_response.set_allocated_battery(translateToRpcBattery(battery).release());
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::BatteryResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeBattery");
 
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_battery(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_battery(
+            [outbox](const mavsdk::Telemetry::Battery battery) {
+                outbox->emplace([&](rpc::telemetry::BatteryResponse& rpc_response) {
+                    translateToRpcBattery(battery, rpc_response.mutable_battery());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_battery(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeFlightMode(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeFlightModeRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::FlightModeResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::FlightModeResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeFlightMode");
 
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_flight_mode(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::FlightMode flight_mode) {
-                rpc::telemetry::FlightModeResponse rpc_response;
-
-                rpc_response.set_flight_mode(translateToRpcFlightMode(flight_mode));
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_flight_mode(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_flight_mode(
+            [outbox](const mavsdk::Telemetry::FlightMode flight_mode) {
+                outbox->emplace([&](rpc::telemetry::FlightModeResponse& rpc_response) {
+                    rpc_response.set_flight_mode(translateToRpcFlightMode(flight_mode));
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_flight_mode(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeHealth(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeHealthRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::HealthResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_health(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::Health health) {
-                rpc::telemetry::HealthResponse rpc_response;
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::HealthResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeHealth");
 
-                rpc_response.set_allocated_health(translateToRpcHealth(health).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_health(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_health(
+            [outbox](const mavsdk::Telemetry::Health health) {
+                outbox->emplace([&](rpc::telemetry::HealthResponse& rpc_response) {
+                    translateToRpcHealth(health, rpc_response.mutable_health());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_health(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeRcStatus(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeRcStatusRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::RcStatusResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_rc_status(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::RcStatus rc_status) {
-                rpc::telemetry::RcStatusResponse rpc_response;
-
-                rpc_response.set_allocated_rc_status(translateToRpcRcStatus(rc_status).release());
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::RcStatusResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeRcStatus");
 
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_rc_status(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_rc_status(
+            [outbox](const mavsdk::Telemetry::RcStatus rc_status) {
+                outbox->emplace([&](rpc::telemetry::RcStatusResponse& rpc_response) {
+                    translateToRpcRcStatus(rc_status, rpc_response.mutable_rc_status());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_rc_status(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeStatusText(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeStatusTextRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::StatusTextResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::StatusTextResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeStatusText");
 
-        _lazy_plugin.maybe_plugin()->subscribe_status_text(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::StatusText status_text) {
-                rpc::telemetry::StatusTextResponse rpc_response;
-
-                rpc_response.set_allocated_status_text(
-                    translateToRpcStatusText(status_text).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_status_text(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_status_text(
+            [outbox](const mavsdk::Telemetry::StatusText status_text) {
+                outbox->emplace([&](rpc::telemetry::StatusTextResponse& rpc_response) {
+                    translateToRpcStatusText(status_text, rpc_response.mutable_status_text());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_status_text(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeActuatorControlTarget(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeActuatorControlTargetRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::ActuatorControlTargetResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_actuator_control_target(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::ActuatorControlTarget actuator_control_target) {
-                rpc::telemetry::ActuatorControlTargetResponse rpc_response;
-
-                rpc_response.set_allocated_actuator_control_target(
-                    translateToRpcActuatorControlTarget(actuator_control_target).release());
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::ActuatorControlTargetResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeActuatorControlTarget");
 
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_actuator_control_target(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_actuator_control_target(
+            [outbox](const mavsdk::Telemetry::ActuatorControlTarget actuator_control_target) {
+                outbox->emplace([&](rpc::telemetry::ActuatorControlTargetResponse& rpc_response) {
+                    translateToRpcActuatorControlTarget(
+                        actuator_control_target, rpc_response.mutable_actuator_control_target());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_actuator_control_target(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeActuatorOutputStatus(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeActuatorOutputStatusRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::ActuatorOutputStatusResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::ActuatorOutputStatusResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeActuatorOutputStatus");
 
-        _lazy_plugin.maybe_plugin()->subscribe_actuator_output_status(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::ActuatorOutputStatus actuator_output_status) {
-                rpc::telemetry::ActuatorOutputStatusResponse rpc_response;
-
-                rpc_response.set_allocated_actuator_output_status(
-                    translateToRpcActuatorOutputStatus(actuator_output_status).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_actuator_output_status(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_actuator_output_status(
+            [outbox](const mavsdk::Telemetry::ActuatorOutputStatus actuator_output_status) {
+                outbox->emplace([&](rpc::telemetry::ActuatorOutputStatusResponse& rpc_response) {
+                    translateToRpcActuatorOutputStatus(
+                        actuator_output_status, rpc_response.mutable_actuator_output_status());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_actuator_output_status(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeOdometry(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeOdometryRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::OdometryResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_odometry(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::Odometry odometry) {
-                rpc::telemetry::OdometryResponse rpc_response;
-
-                rpc_response.set_allocated_odometry(translateToRpcOdometry(odometry).release());
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::OdometryResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeOdometry");
 
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_odometry(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_odometry(
+            [outbox](const mavsdk::Telemetry::Odometry odometry) {
+                outbox->emplace([&](rpc::telemetry::OdometryResponse& rpc_response) {
+                    translateToRpcOdometry(odometry, rpc_response.mutable_odometry());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_odometry(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribePositionVelocityNed(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribePositionVelocityNedRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::PositionVelocityNedResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_position_velocity_ned(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::PositionVelocityNed position_velocity_ned) {
-                rpc::telemetry::PositionVelocityNedResponse rpc_response;
-
-                rpc_response.set_allocated_position_velocity_ned(
-                    translateToRpcPositionVelocityNed(position_velocity_ned).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_position_velocity_ned(nullptr);
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::PositionVelocityNedResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribePositionVelocityNed");
 
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_position_velocity_ned(
+            [outbox](const mavsdk::Telemetry::PositionVelocityNed position_velocity_ned) {
+                outbox->emplace([&](rpc::telemetry::PositionVelocityNedResponse& rpc_response) {
+                    translateToRpcPositionVelocityNed(
+                        position_velocity_ned, rpc_response.mutable_position_velocity_ned());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_position_velocity_ned(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeGroundTruth(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeGroundTruthRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::GroundTruthResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_ground_truth(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::GroundTruth ground_truth) {
-                rpc::telemetry::GroundTruthResponse rpc_response;
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::GroundTruthResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeGroundTruth");
 
-                rpc_response.set_allocated_ground_truth(
-                    translateToRpcGroundTruth(ground_truth).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_ground_truth(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_ground_truth(
+            [outbox](const mavsdk::Telemetry::GroundTruth ground_truth) {
+                outbox->emplace([&](rpc::telemetry::GroundTruthResponse& rpc_response) {
+                    translateToRpcGroundTruth(ground_truth, rpc_response.mutable_ground_truth());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_ground_truth(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeFixedwingMetrics(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeFixedwingMetricsRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::FixedwingMetricsResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::FixedwingMetricsResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeFixedwingMetrics");
 
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_fixedwing_metrics(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::FixedwingMetrics fixedwing_metrics) {
-                rpc::telemetry::FixedwingMetricsResponse rpc_response;
-
-                rpc_response.set_allocated_fixedwing_metrics(
-                    translateToRpcFixedwingMetrics(fixedwing_metrics).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_fixedwing_metrics(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_fixedwing_metrics(
+            [outbox](const mavsdk::Telemetry::FixedwingMetrics fixedwing_metrics) {
+                outbox->emplace([&](rpc::telemetry::FixedwingMetricsResponse& rpc_response) {
+                    translateToRpcFixedwingMetrics(
+                        fixedwing_metrics, rpc_response.mutable_fixedwing_metrics());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_fixedwing_metrics(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeImu(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeImuRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::ImuResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::ImuResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeImu");
 
-        _lazy_plugin.maybe_plugin()->subscribe_imu(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::Imu imu) {
-                rpc::telemetry::ImuResponse rpc_response;
-
-                rpc_response.set_allocated_imu(translateToRpcImu(imu).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_imu(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_imu(
+            [outbox](const mavsdk::Telemetry::Imu imu) {
+                outbox->emplace([&](rpc::telemetry::ImuResponse& rpc_response) {
+                    translateToRpcImu(imu, rpc_response.mutable_imu());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_imu(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeScaledImu(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeScaledImuRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::ScaledImuResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_scaled_imu(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::Imu scaled_imu) {
-                rpc::telemetry::ScaledImuResponse rpc_response;
-
-                rpc_response.set_allocated_imu(translateToRpcImu(scaled_imu).release());
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::ScaledImuResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeScaledImu");
 
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_scaled_imu(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_scaled_imu(
+            [outbox](const mavsdk::Telemetry::Imu scaled_imu) {
+                outbox->emplace([&](rpc::telemetry::ScaledImuResponse& rpc_response) {
+                    translateToRpcImu(scaled_imu, rpc_response.mutable_imu());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_scaled_imu(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeRawImu(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeRawImuRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::RawImuResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_raw_imu(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::Imu raw_imu) {
-                rpc::telemetry::RawImuResponse rpc_response;
-
-                rpc_response.set_allocated_imu(translateToRpcImu(raw_imu).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_raw_imu(nullptr);
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::RawImuResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeRawImu");
 
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_raw_imu(
+            [outbox](const mavsdk::Telemetry::Imu raw_imu) {
+                outbox->emplace([&](rpc::telemetry::RawImuResponse& rpc_response) {
+                    translateToRpcImu(raw_imu, rpc_response.mutable_imu());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_raw_imu(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeHealthAllOk(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeHealthAllOkRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::HealthAllOkResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_health_all_ok(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const bool health_all_ok) {
-                rpc::telemetry::HealthAllOkResponse rpc_response;
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::HealthAllOkResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeHealthAllOk");
 
-                rpc_response.set_is_health_all_ok(health_all_ok);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_health_all_ok(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_health_all_ok(
+            [outbox](const bool health_all_ok) {
+                outbox->emplace([&](rpc::telemetry::HealthAllOkResponse& rpc_response) {
+                    rpc_response.set_is_health_all_ok(health_all_ok);
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_health_all_ok(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeUnixEpochTime(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeUnixEpochTimeRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::UnixEpochTimeResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::UnixEpochTimeResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeUnixEpochTime");
 
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_unix_epoch_time(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const uint64_t unix_epoch_time) {
-                rpc::telemetry::UnixEpochTimeResponse rpc_response;
-
-                rpc_response.set_time_us(unix_epoch_time);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_unix_epoch_time(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_unix_epoch_time(
+            [outbox](const uint64_t unix_epoch_time) {
+                outbox->emplace([&](rpc::telemetry::UnixEpochTimeResponse& rpc_response) {
+                    rpc_response.set_time_us(unix_epoch_time);
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_unix_epoch_time(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeDistanceSensor(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeDistanceSensorRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::DistanceSensorResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::DistanceSensorResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeDistanceSensor");
 
-        _lazy_plugin.maybe_plugin()->subscribe_distance_sensor(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::DistanceSensor distance_sensor) {
-                rpc::telemetry::DistanceSensorResponse rpc_response;
-
-                rpc_response.set_allocated_distance_sensor(
-                    translateToRpcDistanceSensor(distance_sensor).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_distance_sensor(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_distance_sensor(
+            [outbox](const mavsdk::Telemetry::DistanceSensor distance_sensor) {
+                outbox->emplace([&](rpc::telemetry::DistanceSensorResponse& rpc_response) {
+                    translateToRpcDistanceSensor(
+                        distance_sensor, rpc_response.mutable_distance_sensor());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_distance_sensor(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeScaledPressure(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeScaledPressureRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::ScaledPressureResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_scaled_pressure(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::ScaledPressure scaled_pressure) {
-                rpc::telemetry::ScaledPressureResponse rpc_response;
-
-                rpc_response.set_allocated_scaled_pressure(
-                    translateToRpcScaledPressure(scaled_pressure).release());
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::ScaledPressureResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeScaledPressure");
 
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_scaled_pressure(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_scaled_pressure(
+            [outbox](const mavsdk::Telemetry::ScaledPressure scaled_pressure) {
+                outbox->emplace([&](rpc::telemetry::ScaledPressureResponse& rpc_response) {
+                    translateToRpcScaledPressure(
+                        scaled_pressure, rpc_response.mutable_scaled_pressure());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_scaled_pressure(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeHeading(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeHeadingRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::HeadingResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_heading(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Telemetry::Heading heading) {
-                rpc::telemetry::HeadingResponse rpc_response;
-
-                rpc_response.set_allocated_heading_deg(translateToRpcHeading(heading).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_heading(nullptr);
+        auto outbox = std::make_shared<StreamOutbox<rpc::telemetry::HeadingResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeHeading");
 
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        const auto handle = plugin->subscribe_heading(
+            [outbox](const mavsdk::Telemetry::Heading heading) {
+                outbox->emplace([&](rpc::telemetry::HeadingResponse& rpc_response) {
+                    translateToRpcHeading(heading, rpc_response.mutable_heading_deg());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->unsubscribe_heading(handle);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SetRatePosition(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRatePositionRequest* request,
         rpc::telemetry::SetRatePositionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -2654,7 +2553,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_position(request->rate_hz());
+        auto result = plugin->set_rate_position(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -2664,11 +2563,13 @@ public:
     }
 
     grpc::Status SetRateHome(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateHomeRequest* request,
         rpc::telemetry::SetRateHomeResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -2682,7 +2583,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_home(request->rate_hz());
+        auto result = plugin->set_rate_home(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -2692,11 +2593,13 @@ public:
     }
 
     grpc::Status SetRateInAir(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateInAirRequest* request,
         rpc::telemetry::SetRateInAirResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -2710,7 +2613,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_in_air(request->rate_hz());
+        auto result = plugin->set_rate_in_air(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -2720,11 +2623,13 @@ public:
     }
 
     grpc::Status SetRateLandedState(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateLandedStateRequest* request,
         rpc::telemetry::SetRateLandedStateResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -2738,7 +2643,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_landed_state(request->rate_hz());
+        auto result = plugin->set_rate_landed_state(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -2748,11 +2653,13 @@ public:
     }
 
     grpc::Status SetRateVtolState(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateVtolStateRequest* request,
         rpc::telemetry::SetRateVtolStateResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -2766,7 +2673,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_vtol_state(request->rate_hz());
+        auto result = plugin->set_rate_vtol_state(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -2776,11 +2683,13 @@ public:
     }
 
     grpc::Status SetRateAttitude(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateAttitudeRequest* request,
         rpc::telemetry::SetRateAttitudeResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -2794,7 +2703,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_attitude(request->rate_hz());
+        auto result = plugin->set_rate_attitude(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -2804,11 +2713,13 @@ public:
     }
 
     grpc::Status SetRateCameraAttitude(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateCameraAttitudeRequest* request,
         rpc::telemetry::SetRateCameraAttitudeResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -2822,7 +2733,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_camera_attitude(request->rate_hz());
+        auto result = plugin->set_rate_camera_attitude(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -2832,11 +2743,13 @@ public:
     }
 
     grpc::Status SetRateVelocityNed(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateVelocityNedRequest* request,
         rpc::telemetry::SetRateVelocityNedResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -2850,7 +2763,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_velocity_ned(request->rate_hz());
+        auto result = plugin->set_rate_velocity_ned(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -2860,11 +2773,13 @@ public:
     }
 
     grpc::Status SetRateGpsInfo(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateGpsInfoRequest* request,
         rpc::telemetry::SetRateGpsInfoResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -2878,7 +2793,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_gps_info(request->rate_hz());
+        auto result = plugin->set_rate_gps_info(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -2888,11 +2803,13 @@ public:
     }
 
     grpc::Status SetRateBattery(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateBatteryRequest* request,
         rpc::telemetry::SetRateBatteryResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -2906,7 +2823,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_battery(request->rate_hz());
+        auto result = plugin->set_rate_battery(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -2916,11 +2833,13 @@ public:
     }
 
     grpc::Status SetRateRcStatus(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateRcStatusRequest* request,
         rpc::telemetry::SetRateRcStatusResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -2934,7 +2853,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_rc_status(request->rate_hz());
+        auto result = plugin->set_rate_rc_status(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -2944,11 +2863,13 @@ public:
     }
 
     grpc::Status SetRateActuatorControlTarget(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateActuatorControlTargetRequest* request,
         rpc::telemetry::SetRateActuatorControlTargetResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -2963,7 +2884,7 @@ public:
         }
 
         auto result =
-            _lazy_plugin.maybe_plugin()->set_rate_actuator_control_target(request->rate_hz());
+            plugin->set_rate_actuator_control_target(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -2973,11 +2894,13 @@ public:
     }
 
     grpc::Status SetRateActuatorOutputStatus(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateActuatorOutputStatusRequest* request,
         rpc::telemetry::SetRateActuatorOutputStatusResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -2992,7 +2915,7 @@ public:
         }
 
         auto result =
-            _lazy_plugin.maybe_plugin()->set_rate_actuator_output_status(request->rate_hz());
+            plugin->set_rate_actuator_output_status(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -3002,11 +2925,13 @@ public:
     }
 
     grpc::Status SetRateOdometry(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateOdometryRequest* request,
         rpc::telemetry::SetRateOdometryResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -3020,7 +2945,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_odometry(request->rate_hz());
+        auto result = plugin->set_rate_odometry(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -3030,11 +2955,13 @@ public:
     }
 
     grpc::Status SetRatePositionVelocityNed(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRatePositionVelocityNedRequest* request,
         rpc::telemetry::SetRatePositionVelocityNedResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -3049,7 +2976,7 @@ public:
         }
 
         auto result =
-            _lazy_plugin.maybe_plugin()->set_rate_position_velocity_ned(request->rate_hz());
+            plugin->set_rate_position_velocity_ned(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -3059,11 +2986,13 @@ public:
     }
 
     grpc::Status SetRateGroundTruth(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateGroundTruthRequest* request,
         rpc::telemetry::SetRateGroundTruthResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -3077,7 +3006,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_ground_truth(request->rate_hz());
+        auto result = plugin->set_rate_ground_truth(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -3087,11 +3016,13 @@ public:
     }
 
     grpc::Status SetRateFixedwingMetrics(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateFixedwingMetricsRequest* request,
         rpc::telemetry::SetRateFixedwingMetricsResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -3105,7 +3036,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_fixedwing_metrics(request->rate_hz());
+        auto result = plugin->set_rate_fixedwing_metrics(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -3115,11 +3046,13 @@ public:
     }
 
     grpc::Status SetRateImu(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateImuRequest* request,
         rpc::telemetry::SetRateImuResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -3133,7 +3066,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_imu(request->rate_hz());
+        auto result = plugin->set_rate_imu(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -3143,11 +3076,13 @@ public:
     }
 
     grpc::Status SetRateScaledImu(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateScaledImuRequest* request,
         rpc::telemetry::SetRateScaledImuResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -3161,7 +3096,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_scaled_imu(request->rate_hz());
+        auto result = plugin->set_rate_scaled_imu(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -3171,11 +3106,13 @@ public:
     }
 
     grpc::Status SetRateRawImu(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateRawImuRequest* request,
         rpc::telemetry::SetRateRawImuResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -3189,7 +3126,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_raw_imu(request->rate_hz());
+        auto result = plugin->set_rate_raw_imu(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -3199,11 +3136,13 @@ public:
     }
 
     grpc::Status SetRateUnixEpochTime(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateUnixEpochTimeRequest* request,
         rpc::telemetry::SetRateUnixEpochTimeResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -3217,7 +3156,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_unix_epoch_time(request->rate_hz());
+        auto result = plugin->set_rate_unix_epoch_time(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -3227,11 +3166,13 @@ public:
     }
 
     grpc::Status SetRateDistanceSensor(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::SetRateDistanceSensorRequest* request,
         rpc::telemetry::SetRateDistanceSensorResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -3245,7 +3186,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_distance_sensor(request->rate_hz());
+        auto result = plugin->set_rate_distance_sensor(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -3255,11 +3196,13 @@ public:
     }
 
     grpc::Status GetGpsGlobalOrigin(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry::GetGpsGlobalOriginRequest* /* request */,
         rpc::telemetry::GetGpsGlobalOriginResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Telemetry::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -3268,7 +3211,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->get_gps_global_origin();
+        auto result = plugin->get_gps_global_origin();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result.first);
@@ -3283,32 +3226,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"telemetry", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -3317,7 +3276,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
@@ -9,11 +9,14 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -225,11 +228,9 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::telemetry_server::Position>
-    translateToRpcPosition(const mavsdk::TelemetryServer::Position& position)
+    static void translateToRpcPosition(
+        const mavsdk::TelemetryServer::Position& position, rpc::telemetry_server::Position* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::Position>();
-
         rpc_obj->set_latitude_deg(position.latitude_deg);
 
         rpc_obj->set_longitude_deg(position.longitude_deg);
@@ -237,7 +238,13 @@ public:
         rpc_obj->set_absolute_altitude_m(position.absolute_altitude_m);
 
         rpc_obj->set_relative_altitude_m(position.relative_altitude_m);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::Position>
+    translateToRpcPosition(const mavsdk::TelemetryServer::Position& position)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::Position>();
+        translateToRpcPosition(position, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -257,13 +264,17 @@ public:
         return obj;
     }
 
+    static void translateToRpcHeading(
+        const mavsdk::TelemetryServer::Heading& heading, rpc::telemetry_server::Heading* rpc_obj)
+    {
+        rpc_obj->set_heading_deg(heading.heading_deg);
+    }
+
     static std::unique_ptr<rpc::telemetry_server::Heading>
     translateToRpcHeading(const mavsdk::TelemetryServer::Heading& heading)
     {
         auto rpc_obj = std::make_unique<rpc::telemetry_server::Heading>();
-
-        rpc_obj->set_heading_deg(heading.heading_deg);
-
+        translateToRpcHeading(heading, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -277,11 +288,10 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::Quaternion>
-    translateToRpcQuaternion(const mavsdk::TelemetryServer::Quaternion& quaternion)
+    static void translateToRpcQuaternion(
+        const mavsdk::TelemetryServer::Quaternion& quaternion,
+        rpc::telemetry_server::Quaternion* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::Quaternion>();
-
         rpc_obj->set_w(quaternion.w);
 
         rpc_obj->set_x(quaternion.x);
@@ -291,7 +301,13 @@ public:
         rpc_obj->set_z(quaternion.z);
 
         rpc_obj->set_timestamp_us(quaternion.timestamp_us);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::Quaternion>
+    translateToRpcQuaternion(const mavsdk::TelemetryServer::Quaternion& quaternion)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::Quaternion>();
+        translateToRpcQuaternion(quaternion, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -313,11 +329,10 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::EulerAngle>
-    translateToRpcEulerAngle(const mavsdk::TelemetryServer::EulerAngle& euler_angle)
+    static void translateToRpcEulerAngle(
+        const mavsdk::TelemetryServer::EulerAngle& euler_angle,
+        rpc::telemetry_server::EulerAngle* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::EulerAngle>();
-
         rpc_obj->set_roll_deg(euler_angle.roll_deg);
 
         rpc_obj->set_pitch_deg(euler_angle.pitch_deg);
@@ -325,7 +340,13 @@ public:
         rpc_obj->set_yaw_deg(euler_angle.yaw_deg);
 
         rpc_obj->set_timestamp_us(euler_angle.timestamp_us);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::EulerAngle>
+    translateToRpcEulerAngle(const mavsdk::TelemetryServer::EulerAngle& euler_angle)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::EulerAngle>();
+        translateToRpcEulerAngle(euler_angle, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -345,18 +366,23 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::AngularVelocityBody>
-    translateToRpcAngularVelocityBody(
-        const mavsdk::TelemetryServer::AngularVelocityBody& angular_velocity_body)
+    static void translateToRpcAngularVelocityBody(
+        const mavsdk::TelemetryServer::AngularVelocityBody& angular_velocity_body,
+        rpc::telemetry_server::AngularVelocityBody* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::AngularVelocityBody>();
-
         rpc_obj->set_roll_rad_s(angular_velocity_body.roll_rad_s);
 
         rpc_obj->set_pitch_rad_s(angular_velocity_body.pitch_rad_s);
 
         rpc_obj->set_yaw_rad_s(angular_velocity_body.yaw_rad_s);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::AngularVelocityBody>
+    translateToRpcAngularVelocityBody(
+        const mavsdk::TelemetryServer::AngularVelocityBody& angular_velocity_body)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::AngularVelocityBody>();
+        translateToRpcAngularVelocityBody(angular_velocity_body, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -374,15 +400,19 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::GpsInfo>
-    translateToRpcGpsInfo(const mavsdk::TelemetryServer::GpsInfo& gps_info)
+    static void translateToRpcGpsInfo(
+        const mavsdk::TelemetryServer::GpsInfo& gps_info, rpc::telemetry_server::GpsInfo* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::GpsInfo>();
-
         rpc_obj->set_num_satellites(gps_info.num_satellites);
 
         rpc_obj->set_fix_type(translateToRpcFixType(gps_info.fix_type));
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::GpsInfo>
+    translateToRpcGpsInfo(const mavsdk::TelemetryServer::GpsInfo& gps_info)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::GpsInfo>();
+        translateToRpcGpsInfo(gps_info, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -398,11 +428,9 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::RawGps>
-    translateToRpcRawGps(const mavsdk::TelemetryServer::RawGps& raw_gps)
+    static void translateToRpcRawGps(
+        const mavsdk::TelemetryServer::RawGps& raw_gps, rpc::telemetry_server::RawGps* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::RawGps>();
-
         rpc_obj->set_timestamp_us(raw_gps.timestamp_us);
 
         rpc_obj->set_latitude_deg(raw_gps.latitude_deg);
@@ -430,7 +458,13 @@ public:
         rpc_obj->set_heading_uncertainty_deg(raw_gps.heading_uncertainty_deg);
 
         rpc_obj->set_yaw_deg(raw_gps.yaw_deg);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::RawGps>
+    translateToRpcRawGps(const mavsdk::TelemetryServer::RawGps& raw_gps)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::RawGps>();
+        translateToRpcRawGps(raw_gps, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -470,15 +504,19 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::Battery>
-    translateToRpcBattery(const mavsdk::TelemetryServer::Battery& battery)
+    static void translateToRpcBattery(
+        const mavsdk::TelemetryServer::Battery& battery, rpc::telemetry_server::Battery* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::Battery>();
-
         rpc_obj->set_voltage_v(battery.voltage_v);
 
         rpc_obj->set_remaining_percent(battery.remaining_percent);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::Battery>
+    translateToRpcBattery(const mavsdk::TelemetryServer::Battery& battery)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::Battery>();
+        translateToRpcBattery(battery, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -494,17 +532,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::RcStatus>
-    translateToRpcRcStatus(const mavsdk::TelemetryServer::RcStatus& rc_status)
+    static void translateToRpcRcStatus(
+        const mavsdk::TelemetryServer::RcStatus& rc_status,
+        rpc::telemetry_server::RcStatus* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::RcStatus>();
-
         rpc_obj->set_was_available_once(rc_status.was_available_once);
 
         rpc_obj->set_is_available(rc_status.is_available);
 
         rpc_obj->set_signal_strength_percent(rc_status.signal_strength_percent);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::RcStatus>
+    translateToRpcRcStatus(const mavsdk::TelemetryServer::RcStatus& rc_status)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::RcStatus>();
+        translateToRpcRcStatus(rc_status, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -522,15 +565,20 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::StatusText>
-    translateToRpcStatusText(const mavsdk::TelemetryServer::StatusText& status_text)
+    static void translateToRpcStatusText(
+        const mavsdk::TelemetryServer::StatusText& status_text,
+        rpc::telemetry_server::StatusText* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::StatusText>();
-
         rpc_obj->set_type(translateToRpcStatusTextType(status_text.type));
 
         rpc_obj->set_text(status_text.text);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::StatusText>
+    translateToRpcStatusText(const mavsdk::TelemetryServer::StatusText& status_text)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::StatusText>();
+        translateToRpcStatusText(status_text, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -546,18 +594,24 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::ActuatorControlTarget>
-    translateToRpcActuatorControlTarget(
-        const mavsdk::TelemetryServer::ActuatorControlTarget& actuator_control_target)
+    static void translateToRpcActuatorControlTarget(
+        const mavsdk::TelemetryServer::ActuatorControlTarget& actuator_control_target,
+        rpc::telemetry_server::ActuatorControlTarget* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::ActuatorControlTarget>();
-
         rpc_obj->set_group(actuator_control_target.group);
 
+        rpc_obj->clear_controls();
         for (const auto& elem : actuator_control_target.controls) {
             rpc_obj->add_controls(elem);
         }
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::ActuatorControlTarget>
+    translateToRpcActuatorControlTarget(
+        const mavsdk::TelemetryServer::ActuatorControlTarget& actuator_control_target)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::ActuatorControlTarget>();
+        translateToRpcActuatorControlTarget(actuator_control_target, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -575,18 +629,24 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::ActuatorOutputStatus>
-    translateToRpcActuatorOutputStatus(
-        const mavsdk::TelemetryServer::ActuatorOutputStatus& actuator_output_status)
+    static void translateToRpcActuatorOutputStatus(
+        const mavsdk::TelemetryServer::ActuatorOutputStatus& actuator_output_status,
+        rpc::telemetry_server::ActuatorOutputStatus* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::ActuatorOutputStatus>();
-
         rpc_obj->set_active(actuator_output_status.active);
 
+        rpc_obj->clear_actuator();
         for (const auto& elem : actuator_output_status.actuator) {
             rpc_obj->add_actuator(elem);
         }
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::ActuatorOutputStatus>
+    translateToRpcActuatorOutputStatus(
+        const mavsdk::TelemetryServer::ActuatorOutputStatus& actuator_output_status)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::ActuatorOutputStatus>();
+        translateToRpcActuatorOutputStatus(actuator_output_status, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -604,15 +664,21 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::Covariance>
-    translateToRpcCovariance(const mavsdk::TelemetryServer::Covariance& covariance)
+    static void translateToRpcCovariance(
+        const mavsdk::TelemetryServer::Covariance& covariance,
+        rpc::telemetry_server::Covariance* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::Covariance>();
-
+        rpc_obj->clear_covariance_matrix();
         for (const auto& elem : covariance.covariance_matrix) {
             rpc_obj->add_covariance_matrix(elem);
         }
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::Covariance>
+    translateToRpcCovariance(const mavsdk::TelemetryServer::Covariance& covariance)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::Covariance>();
+        translateToRpcCovariance(covariance, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -628,17 +694,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::VelocityBody>
-    translateToRpcVelocityBody(const mavsdk::TelemetryServer::VelocityBody& velocity_body)
+    static void translateToRpcVelocityBody(
+        const mavsdk::TelemetryServer::VelocityBody& velocity_body,
+        rpc::telemetry_server::VelocityBody* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::VelocityBody>();
-
         rpc_obj->set_x_m_s(velocity_body.x_m_s);
 
         rpc_obj->set_y_m_s(velocity_body.y_m_s);
 
         rpc_obj->set_z_m_s(velocity_body.z_m_s);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::VelocityBody>
+    translateToRpcVelocityBody(const mavsdk::TelemetryServer::VelocityBody& velocity_body)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::VelocityBody>();
+        translateToRpcVelocityBody(velocity_body, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -656,17 +727,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::PositionBody>
-    translateToRpcPositionBody(const mavsdk::TelemetryServer::PositionBody& position_body)
+    static void translateToRpcPositionBody(
+        const mavsdk::TelemetryServer::PositionBody& position_body,
+        rpc::telemetry_server::PositionBody* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::PositionBody>();
-
         rpc_obj->set_x_m(position_body.x_m);
 
         rpc_obj->set_y_m(position_body.y_m);
 
         rpc_obj->set_z_m(position_body.z_m);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::PositionBody>
+    translateToRpcPositionBody(const mavsdk::TelemetryServer::PositionBody& position_body)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::PositionBody>();
+        translateToRpcPositionBody(position_body, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -720,34 +796,35 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::telemetry_server::Odometry>
-    translateToRpcOdometry(const mavsdk::TelemetryServer::Odometry& odometry)
+    static void translateToRpcOdometry(
+        const mavsdk::TelemetryServer::Odometry& odometry, rpc::telemetry_server::Odometry* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::Odometry>();
-
         rpc_obj->set_time_usec(odometry.time_usec);
 
         rpc_obj->set_frame_id(translateToRpcMavFrame(odometry.frame_id));
 
         rpc_obj->set_child_frame_id(translateToRpcMavFrame(odometry.child_frame_id));
 
-        rpc_obj->set_allocated_position_body(
-            translateToRpcPositionBody(odometry.position_body).release());
+        translateToRpcPositionBody(odometry.position_body, rpc_obj->mutable_position_body());
 
-        rpc_obj->set_allocated_q(translateToRpcQuaternion(odometry.q).release());
+        translateToRpcQuaternion(odometry.q, rpc_obj->mutable_q());
 
-        rpc_obj->set_allocated_velocity_body(
-            translateToRpcVelocityBody(odometry.velocity_body).release());
+        translateToRpcVelocityBody(odometry.velocity_body, rpc_obj->mutable_velocity_body());
 
-        rpc_obj->set_allocated_angular_velocity_body(
-            translateToRpcAngularVelocityBody(odometry.angular_velocity_body).release());
+        translateToRpcAngularVelocityBody(
+            odometry.angular_velocity_body, rpc_obj->mutable_angular_velocity_body());
 
-        rpc_obj->set_allocated_pose_covariance(
-            translateToRpcCovariance(odometry.pose_covariance).release());
+        translateToRpcCovariance(odometry.pose_covariance, rpc_obj->mutable_pose_covariance());
 
-        rpc_obj->set_allocated_velocity_covariance(
-            translateToRpcCovariance(odometry.velocity_covariance).release());
+        translateToRpcCovariance(
+            odometry.velocity_covariance, rpc_obj->mutable_velocity_covariance());
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::Odometry>
+    translateToRpcOdometry(const mavsdk::TelemetryServer::Odometry& odometry)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::Odometry>();
+        translateToRpcOdometry(odometry, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -778,17 +855,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::DistanceSensor>
-    translateToRpcDistanceSensor(const mavsdk::TelemetryServer::DistanceSensor& distance_sensor)
+    static void translateToRpcDistanceSensor(
+        const mavsdk::TelemetryServer::DistanceSensor& distance_sensor,
+        rpc::telemetry_server::DistanceSensor* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::DistanceSensor>();
-
         rpc_obj->set_minimum_distance_m(distance_sensor.minimum_distance_m);
 
         rpc_obj->set_maximum_distance_m(distance_sensor.maximum_distance_m);
 
         rpc_obj->set_current_distance_m(distance_sensor.current_distance_m);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::DistanceSensor>
+    translateToRpcDistanceSensor(const mavsdk::TelemetryServer::DistanceSensor& distance_sensor)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::DistanceSensor>();
+        translateToRpcDistanceSensor(distance_sensor, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -806,11 +888,10 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::ScaledPressure>
-    translateToRpcScaledPressure(const mavsdk::TelemetryServer::ScaledPressure& scaled_pressure)
+    static void translateToRpcScaledPressure(
+        const mavsdk::TelemetryServer::ScaledPressure& scaled_pressure,
+        rpc::telemetry_server::ScaledPressure* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::ScaledPressure>();
-
         rpc_obj->set_timestamp_us(scaled_pressure.timestamp_us);
 
         rpc_obj->set_absolute_pressure_hpa(scaled_pressure.absolute_pressure_hpa);
@@ -821,7 +902,13 @@ public:
 
         rpc_obj->set_differential_pressure_temperature_deg(
             scaled_pressure.differential_pressure_temperature_deg);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::ScaledPressure>
+    translateToRpcScaledPressure(const mavsdk::TelemetryServer::ScaledPressure& scaled_pressure)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::ScaledPressure>();
+        translateToRpcScaledPressure(scaled_pressure, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -844,17 +931,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::PositionNed>
-    translateToRpcPositionNed(const mavsdk::TelemetryServer::PositionNed& position_ned)
+    static void translateToRpcPositionNed(
+        const mavsdk::TelemetryServer::PositionNed& position_ned,
+        rpc::telemetry_server::PositionNed* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::PositionNed>();
-
         rpc_obj->set_north_m(position_ned.north_m);
 
         rpc_obj->set_east_m(position_ned.east_m);
 
         rpc_obj->set_down_m(position_ned.down_m);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::PositionNed>
+    translateToRpcPositionNed(const mavsdk::TelemetryServer::PositionNed& position_ned)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::PositionNed>();
+        translateToRpcPositionNed(position_ned, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -872,17 +964,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::VelocityNed>
-    translateToRpcVelocityNed(const mavsdk::TelemetryServer::VelocityNed& velocity_ned)
+    static void translateToRpcVelocityNed(
+        const mavsdk::TelemetryServer::VelocityNed& velocity_ned,
+        rpc::telemetry_server::VelocityNed* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::VelocityNed>();
-
         rpc_obj->set_north_m_s(velocity_ned.north_m_s);
 
         rpc_obj->set_east_m_s(velocity_ned.east_m_s);
 
         rpc_obj->set_down_m_s(velocity_ned.down_m_s);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::VelocityNed>
+    translateToRpcVelocityNed(const mavsdk::TelemetryServer::VelocityNed& velocity_ned)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::VelocityNed>();
+        translateToRpcVelocityNed(velocity_ned, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -900,18 +997,21 @@ public:
         return obj;
     }
 
+    static void translateToRpcPositionVelocityNed(
+        const mavsdk::TelemetryServer::PositionVelocityNed& position_velocity_ned,
+        rpc::telemetry_server::PositionVelocityNed* rpc_obj)
+    {
+        translateToRpcPositionNed(position_velocity_ned.position, rpc_obj->mutable_position());
+
+        translateToRpcVelocityNed(position_velocity_ned.velocity, rpc_obj->mutable_velocity());
+    }
+
     static std::unique_ptr<rpc::telemetry_server::PositionVelocityNed>
     translateToRpcPositionVelocityNed(
         const mavsdk::TelemetryServer::PositionVelocityNed& position_velocity_ned)
     {
         auto rpc_obj = std::make_unique<rpc::telemetry_server::PositionVelocityNed>();
-
-        rpc_obj->set_allocated_position(
-            translateToRpcPositionNed(position_velocity_ned.position).release());
-
-        rpc_obj->set_allocated_velocity(
-            translateToRpcVelocityNed(position_velocity_ned.velocity).release());
-
+        translateToRpcPositionVelocityNed(position_velocity_ned, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -927,17 +1027,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::GroundTruth>
-    translateToRpcGroundTruth(const mavsdk::TelemetryServer::GroundTruth& ground_truth)
+    static void translateToRpcGroundTruth(
+        const mavsdk::TelemetryServer::GroundTruth& ground_truth,
+        rpc::telemetry_server::GroundTruth* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::GroundTruth>();
-
         rpc_obj->set_latitude_deg(ground_truth.latitude_deg);
 
         rpc_obj->set_longitude_deg(ground_truth.longitude_deg);
 
         rpc_obj->set_absolute_altitude_m(ground_truth.absolute_altitude_m);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::GroundTruth>
+    translateToRpcGroundTruth(const mavsdk::TelemetryServer::GroundTruth& ground_truth)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::GroundTruth>();
+        translateToRpcGroundTruth(ground_truth, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -955,17 +1060,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::FixedwingMetrics> translateToRpcFixedwingMetrics(
-        const mavsdk::TelemetryServer::FixedwingMetrics& fixedwing_metrics)
+    static void translateToRpcFixedwingMetrics(
+        const mavsdk::TelemetryServer::FixedwingMetrics& fixedwing_metrics,
+        rpc::telemetry_server::FixedwingMetrics* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::FixedwingMetrics>();
-
         rpc_obj->set_airspeed_m_s(fixedwing_metrics.airspeed_m_s);
 
         rpc_obj->set_throttle_percentage(fixedwing_metrics.throttle_percentage);
 
         rpc_obj->set_climb_rate_m_s(fixedwing_metrics.climb_rate_m_s);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::FixedwingMetrics> translateToRpcFixedwingMetrics(
+        const mavsdk::TelemetryServer::FixedwingMetrics& fixedwing_metrics)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::FixedwingMetrics>();
+        translateToRpcFixedwingMetrics(fixedwing_metrics, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -983,17 +1093,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::AccelerationFrd>
-    translateToRpcAccelerationFrd(const mavsdk::TelemetryServer::AccelerationFrd& acceleration_frd)
+    static void translateToRpcAccelerationFrd(
+        const mavsdk::TelemetryServer::AccelerationFrd& acceleration_frd,
+        rpc::telemetry_server::AccelerationFrd* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::AccelerationFrd>();
-
         rpc_obj->set_forward_m_s2(acceleration_frd.forward_m_s2);
 
         rpc_obj->set_right_m_s2(acceleration_frd.right_m_s2);
 
         rpc_obj->set_down_m_s2(acceleration_frd.down_m_s2);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::AccelerationFrd>
+    translateToRpcAccelerationFrd(const mavsdk::TelemetryServer::AccelerationFrd& acceleration_frd)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::AccelerationFrd>();
+        translateToRpcAccelerationFrd(acceleration_frd, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -1011,18 +1126,23 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::AngularVelocityFrd>
-    translateToRpcAngularVelocityFrd(
-        const mavsdk::TelemetryServer::AngularVelocityFrd& angular_velocity_frd)
+    static void translateToRpcAngularVelocityFrd(
+        const mavsdk::TelemetryServer::AngularVelocityFrd& angular_velocity_frd,
+        rpc::telemetry_server::AngularVelocityFrd* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::AngularVelocityFrd>();
-
         rpc_obj->set_forward_rad_s(angular_velocity_frd.forward_rad_s);
 
         rpc_obj->set_right_rad_s(angular_velocity_frd.right_rad_s);
 
         rpc_obj->set_down_rad_s(angular_velocity_frd.down_rad_s);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::AngularVelocityFrd>
+    translateToRpcAngularVelocityFrd(
+        const mavsdk::TelemetryServer::AngularVelocityFrd& angular_velocity_frd)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::AngularVelocityFrd>();
+        translateToRpcAngularVelocityFrd(angular_velocity_frd, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -1040,17 +1160,22 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::MagneticFieldFrd> translateToRpcMagneticFieldFrd(
-        const mavsdk::TelemetryServer::MagneticFieldFrd& magnetic_field_frd)
+    static void translateToRpcMagneticFieldFrd(
+        const mavsdk::TelemetryServer::MagneticFieldFrd& magnetic_field_frd,
+        rpc::telemetry_server::MagneticFieldFrd* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::MagneticFieldFrd>();
-
         rpc_obj->set_forward_gauss(magnetic_field_frd.forward_gauss);
 
         rpc_obj->set_right_gauss(magnetic_field_frd.right_gauss);
 
         rpc_obj->set_down_gauss(magnetic_field_frd.down_gauss);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::MagneticFieldFrd> translateToRpcMagneticFieldFrd(
+        const mavsdk::TelemetryServer::MagneticFieldFrd& magnetic_field_frd)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::MagneticFieldFrd>();
+        translateToRpcMagneticFieldFrd(magnetic_field_frd, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -1068,24 +1193,27 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::telemetry_server::Imu>
-    translateToRpcImu(const mavsdk::TelemetryServer::Imu& imu)
+    static void translateToRpcImu(
+        const mavsdk::TelemetryServer::Imu& imu, rpc::telemetry_server::Imu* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::telemetry_server::Imu>();
+        translateToRpcAccelerationFrd(imu.acceleration_frd, rpc_obj->mutable_acceleration_frd());
 
-        rpc_obj->set_allocated_acceleration_frd(
-            translateToRpcAccelerationFrd(imu.acceleration_frd).release());
+        translateToRpcAngularVelocityFrd(
+            imu.angular_velocity_frd, rpc_obj->mutable_angular_velocity_frd());
 
-        rpc_obj->set_allocated_angular_velocity_frd(
-            translateToRpcAngularVelocityFrd(imu.angular_velocity_frd).release());
-
-        rpc_obj->set_allocated_magnetic_field_frd(
-            translateToRpcMagneticFieldFrd(imu.magnetic_field_frd).release());
+        translateToRpcMagneticFieldFrd(
+            imu.magnetic_field_frd, rpc_obj->mutable_magnetic_field_frd());
 
         rpc_obj->set_temperature_degc(imu.temperature_degc);
 
         rpc_obj->set_timestamp_us(imu.timestamp_us);
+    }
 
+    static std::unique_ptr<rpc::telemetry_server::Imu>
+    translateToRpcImu(const mavsdk::TelemetryServer::Imu& imu)
+    {
+        auto rpc_obj = std::make_unique<rpc::telemetry_server::Imu>();
+        translateToRpcImu(imu, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -1159,11 +1287,13 @@ public:
     }
 
     grpc::Status PublishPosition(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry_server::PublishPositionRequest* request,
         rpc::telemetry_server::PublishPositionResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TelemetryServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1177,7 +1307,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->publish_position(
+        auto result = plugin->publish_position(
             translateFromRpcPosition(request->position()),
             translateFromRpcVelocityNed(request->velocity_ned()),
             translateFromRpcHeading(request->heading()));
@@ -1190,11 +1320,13 @@ public:
     }
 
     grpc::Status PublishHome(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry_server::PublishHomeRequest* request,
         rpc::telemetry_server::PublishHomeResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TelemetryServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1209,7 +1341,7 @@ public:
         }
 
         auto result =
-            _lazy_plugin.maybe_plugin()->publish_home(translateFromRpcPosition(request->home()));
+            plugin->publish_home(translateFromRpcPosition(request->home()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -1219,11 +1351,13 @@ public:
     }
 
     grpc::Status PublishSysStatus(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry_server::PublishSysStatusRequest* request,
         rpc::telemetry_server::PublishSysStatusResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TelemetryServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1237,7 +1371,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->publish_sys_status(
+        auto result = plugin->publish_sys_status(
             translateFromRpcBattery(request->battery()),
             request->rc_receiver_status(),
             request->gyro_status(),
@@ -1253,11 +1387,13 @@ public:
     }
 
     grpc::Status PublishExtendedSysState(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry_server::PublishExtendedSysStateRequest* request,
         rpc::telemetry_server::PublishExtendedSysStateResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TelemetryServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1271,7 +1407,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->publish_extended_sys_state(
+        auto result = plugin->publish_extended_sys_state(
             translateFromRpcVtolState(request->vtol_state()),
             translateFromRpcLandedState(request->landed_state()));
 
@@ -1283,11 +1419,13 @@ public:
     }
 
     grpc::Status PublishRawGps(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry_server::PublishRawGpsRequest* request,
         rpc::telemetry_server::PublishRawGpsResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TelemetryServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1301,7 +1439,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->publish_raw_gps(
+        auto result = plugin->publish_raw_gps(
             translateFromRpcRawGps(request->raw_gps()),
             translateFromRpcGpsInfo(request->gps_info()));
 
@@ -1313,11 +1451,13 @@ public:
     }
 
     grpc::Status PublishBattery(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry_server::PublishBatteryRequest* request,
         rpc::telemetry_server::PublishBatteryResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TelemetryServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1331,8 +1471,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->publish_battery(
-            translateFromRpcBattery(request->battery()));
+        auto result = plugin->publish_battery(translateFromRpcBattery(request->battery()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -1342,11 +1481,13 @@ public:
     }
 
     grpc::Status PublishStatusText(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry_server::PublishStatusTextRequest* request,
         rpc::telemetry_server::PublishStatusTextResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TelemetryServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1360,7 +1501,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->publish_status_text(
+        auto result = plugin->publish_status_text(
             translateFromRpcStatusText(request->status_text()));
 
         if (response != nullptr) {
@@ -1371,11 +1512,13 @@ public:
     }
 
     grpc::Status PublishOdometry(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry_server::PublishOdometryRequest* request,
         rpc::telemetry_server::PublishOdometryResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TelemetryServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1389,8 +1532,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->publish_odometry(
-            translateFromRpcOdometry(request->odometry()));
+        auto result = plugin->publish_odometry(translateFromRpcOdometry(request->odometry()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -1400,11 +1542,13 @@ public:
     }
 
     grpc::Status PublishPositionVelocityNed(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry_server::PublishPositionVelocityNedRequest* request,
         rpc::telemetry_server::PublishPositionVelocityNedResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TelemetryServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1418,7 +1562,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->publish_position_velocity_ned(
+        auto result = plugin->publish_position_velocity_ned(
             translateFromRpcPositionVelocityNed(request->position_velocity_ned()));
 
         if (response != nullptr) {
@@ -1429,11 +1573,13 @@ public:
     }
 
     grpc::Status PublishGroundTruth(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry_server::PublishGroundTruthRequest* request,
         rpc::telemetry_server::PublishGroundTruthResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TelemetryServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1447,7 +1593,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->publish_ground_truth(
+        auto result = plugin->publish_ground_truth(
             translateFromRpcGroundTruth(request->ground_truth()));
 
         if (response != nullptr) {
@@ -1458,11 +1604,13 @@ public:
     }
 
     grpc::Status PublishImu(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry_server::PublishImuRequest* request,
         rpc::telemetry_server::PublishImuResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TelemetryServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1476,7 +1624,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->publish_imu(translateFromRpcImu(request->imu()));
+        auto result = plugin->publish_imu(translateFromRpcImu(request->imu()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -1486,11 +1634,13 @@ public:
     }
 
     grpc::Status PublishScaledImu(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry_server::PublishScaledImuRequest* request,
         rpc::telemetry_server::PublishScaledImuResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TelemetryServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1505,7 +1655,7 @@ public:
         }
 
         auto result =
-            _lazy_plugin.maybe_plugin()->publish_scaled_imu(translateFromRpcImu(request->imu()));
+            plugin->publish_scaled_imu(translateFromRpcImu(request->imu()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -1515,11 +1665,13 @@ public:
     }
 
     grpc::Status PublishRawImu(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry_server::PublishRawImuRequest* request,
         rpc::telemetry_server::PublishRawImuResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TelemetryServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1534,7 +1686,7 @@ public:
         }
 
         auto result =
-            _lazy_plugin.maybe_plugin()->publish_raw_imu(translateFromRpcImu(request->imu()));
+            plugin->publish_raw_imu(translateFromRpcImu(request->imu()));
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -1544,11 +1696,13 @@ public:
     }
 
     grpc::Status PublishUnixEpochTime(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::telemetry_server::PublishUnixEpochTimeRequest* request,
         rpc::telemetry_server::PublishUnixEpochTimeResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TelemetryServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -1562,7 +1716,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->publish_unix_epoch_time(request->time_us());
+        auto result = plugin->publish_unix_epoch_time(request->time_us());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -1574,32 +1728,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"telemetry_server", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -1608,7 +1778,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
@@ -9,11 +9,15 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "stream_writer.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -83,17 +87,22 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::tracking_server::TrackPoint>
-    translateToRpcTrackPoint(const mavsdk::TrackingServer::TrackPoint& track_point)
+    static void translateToRpcTrackPoint(
+        const mavsdk::TrackingServer::TrackPoint& track_point,
+        rpc::tracking_server::TrackPoint* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::tracking_server::TrackPoint>();
-
         rpc_obj->set_point_x(track_point.point_x);
 
         rpc_obj->set_point_y(track_point.point_y);
 
         rpc_obj->set_radius(track_point.radius);
+    }
 
+    static std::unique_ptr<rpc::tracking_server::TrackPoint>
+    translateToRpcTrackPoint(const mavsdk::TrackingServer::TrackPoint& track_point)
+    {
+        auto rpc_obj = std::make_unique<rpc::tracking_server::TrackPoint>();
+        translateToRpcTrackPoint(track_point, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -111,11 +120,10 @@ public:
         return obj;
     }
 
-    static std::unique_ptr<rpc::tracking_server::TrackRectangle>
-    translateToRpcTrackRectangle(const mavsdk::TrackingServer::TrackRectangle& track_rectangle)
+    static void translateToRpcTrackRectangle(
+        const mavsdk::TrackingServer::TrackRectangle& track_rectangle,
+        rpc::tracking_server::TrackRectangle* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::tracking_server::TrackRectangle>();
-
         rpc_obj->set_top_left_corner_x(track_rectangle.top_left_corner_x);
 
         rpc_obj->set_top_left_corner_y(track_rectangle.top_left_corner_y);
@@ -123,7 +131,13 @@ public:
         rpc_obj->set_bottom_right_corner_x(track_rectangle.bottom_right_corner_x);
 
         rpc_obj->set_bottom_right_corner_y(track_rectangle.bottom_right_corner_y);
+    }
 
+    static std::unique_ptr<rpc::tracking_server::TrackRectangle>
+    translateToRpcTrackRectangle(const mavsdk::TrackingServer::TrackRectangle& track_rectangle)
+    {
+        auto rpc_obj = std::make_unique<rpc::tracking_server::TrackRectangle>();
+        translateToRpcTrackRectangle(track_rectangle, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -180,11 +194,13 @@ public:
     }
 
     grpc::Status SetTrackingPointStatus(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::tracking_server::SetTrackingPointStatusRequest* request,
         rpc::tracking_server::SetTrackingPointStatusResponse* /* response */) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
@@ -193,18 +209,19 @@ public:
             return grpc::Status::OK;
         }
 
-        _lazy_plugin.maybe_plugin()->set_tracking_point_status(
-            translateFromRpcTrackPoint(request->tracked_point()));
+        plugin->set_tracking_point_status(translateFromRpcTrackPoint(request->tracked_point()));
 
         return grpc::Status::OK;
     }
 
     grpc::Status SetTrackingRectangleStatus(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::tracking_server::SetTrackingRectangleStatusRequest* request,
         rpc::tracking_server::SetTrackingRectangleStatusResponse* /* response */) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
@@ -213,154 +230,143 @@ public:
             return grpc::Status::OK;
         }
 
-        _lazy_plugin.maybe_plugin()->set_tracking_rectangle_status(
+        plugin->set_tracking_rectangle_status(
             translateFromRpcTrackRectangle(request->tracked_rectangle()));
 
         return grpc::Status::OK;
     }
 
     grpc::Status SetTrackingOffStatus(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::tracking_server::SetTrackingOffStatusRequest* /* request */,
         rpc::tracking_server::SetTrackingOffStatusResponse* /* response */) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        _lazy_plugin.maybe_plugin()->set_tracking_off_status();
+        plugin->set_tracking_off_status();
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeTrackingPointCommand(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::tracking_server::SubscribeTrackingPointCommandRequest* /* request */,
         grpc::ServerWriter<rpc::tracking_server::TrackingPointCommandResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_tracking_point_command(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::TrackingServer::TrackPoint tracking_point_command) {
-                rpc::tracking_server::TrackingPointCommandResponse rpc_response;
-
-                rpc_response.set_allocated_track_point(
-                    translateToRpcTrackPoint(tracking_point_command).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_tracking_point_command(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        auto outbox =
+            std::make_shared<StreamOutbox<rpc::tracking_server::TrackingPointCommandResponse>>(
+                _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeTrackingPointCommand");
+
+        plugin->subscribe_tracking_point_command(
+            [outbox](const mavsdk::TrackingServer::TrackPoint tracking_point_command) {
+                outbox->emplace(
+                    [&](rpc::tracking_server::TrackingPointCommandResponse& rpc_response) {
+                        translateToRpcTrackPoint(
+                            tracking_point_command, rpc_response.mutable_track_point());
+                    });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_tracking_point_command(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeTrackingRectangleCommand(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::tracking_server::SubscribeTrackingRectangleCommandRequest* /* request */,
         grpc::ServerWriter<rpc::tracking_server::TrackingRectangleCommandResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_tracking_rectangle_command(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::TrackingServer::TrackRectangle tracking_rectangle_command) {
-                rpc::tracking_server::TrackingRectangleCommandResponse rpc_response;
-
-                rpc_response.set_allocated_track_rectangle(
-                    translateToRpcTrackRectangle(tracking_rectangle_command).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_tracking_rectangle_command(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        auto outbox =
+            std::make_shared<StreamOutbox<rpc::tracking_server::TrackingRectangleCommandResponse>>(
+                _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeTrackingRectangleCommand");
+
+        plugin->subscribe_tracking_rectangle_command(
+            [outbox](const mavsdk::TrackingServer::TrackRectangle tracking_rectangle_command) {
+                outbox->emplace(
+                    [&](rpc::tracking_server::TrackingRectangleCommandResponse& rpc_response) {
+                        translateToRpcTrackRectangle(
+                            tracking_rectangle_command, rpc_response.mutable_track_rectangle());
+                    });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_tracking_rectangle_command(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SubscribeTrackingOffCommand(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::tracking_server::SubscribeTrackingOffCommandRequest* /* request */,
         grpc::ServerWriter<rpc::tracking_server::TrackingOffCommandResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
-
-        _lazy_plugin.maybe_plugin()->subscribe_tracking_off_command(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const int32_t tracking_off_command) {
-                rpc::tracking_server::TrackingOffCommandResponse rpc_response;
-
-                rpc_response.set_dummy(tracking_off_command);
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_tracking_off_command(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        auto outbox =
+            std::make_shared<StreamOutbox<rpc::tracking_server::TrackingOffCommandResponse>>(
+                _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeTrackingOffCommand");
+
+        plugin->subscribe_tracking_off_command(
+            [outbox](const int32_t tracking_off_command) {
+                outbox->emplace(
+                    [&](rpc::tracking_server::TrackingOffCommandResponse& rpc_response) {
+                        rpc_response.set_dummy(tracking_off_command);
+                    });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_tracking_off_command(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status RespondTrackingPointCommand(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::tracking_server::RespondTrackingPointCommandRequest* request,
         rpc::tracking_server::RespondTrackingPointCommandResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TrackingServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -374,7 +380,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->respond_tracking_point_command(
+        auto result = plugin->respond_tracking_point_command(
             translateFromRpcCommandAnswer(request->command_answer()));
 
         if (response != nullptr) {
@@ -385,11 +391,13 @@ public:
     }
 
     grpc::Status RespondTrackingRectangleCommand(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::tracking_server::RespondTrackingRectangleCommandRequest* request,
         rpc::tracking_server::RespondTrackingRectangleCommandResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TrackingServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -403,7 +411,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->respond_tracking_rectangle_command(
+        auto result = plugin->respond_tracking_rectangle_command(
             translateFromRpcCommandAnswer(request->command_answer()));
 
         if (response != nullptr) {
@@ -414,11 +422,13 @@ public:
     }
 
     grpc::Status RespondTrackingOffCommand(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::tracking_server::RespondTrackingOffCommandRequest* request,
         rpc::tracking_server::RespondTrackingOffCommandResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::TrackingServer::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -432,7 +442,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->respond_tracking_off_command(
+        auto result = plugin->respond_tracking_off_command(
             translateFromRpcCommandAnswer(request->command_answer()));
 
         if (response != nullptr) {
@@ -445,32 +455,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"tracking_server", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -479,7 +505,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
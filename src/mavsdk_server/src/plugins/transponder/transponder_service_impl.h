@@ -8,11 +8,15 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "stream_writer.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -140,11 +144,10 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::transponder::AdsbVehicle>
-    translateToRpcAdsbVehicle(const mavsdk::Transponder::AdsbVehicle& adsb_vehicle)
+    static void translateToRpcAdsbVehicle(
+        const mavsdk::Transponder::AdsbVehicle& adsb_vehicle,
+        rpc::transponder::AdsbVehicle* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::transponder::AdsbVehicle>();
-
         rpc_obj->set_icao_address(adsb_vehicle.icao_address);
 
         rpc_obj->set_latitude_deg(adsb_vehicle.latitude_deg);
@@ -164,7 +167,13 @@ public:
         rpc_obj->set_emitter_type(translateToRpcAdsbEmitterType(adsb_vehicle.emitter_type));
 
         rpc_obj->set_squawk(adsb_vehicle.squawk);
+    }
 
+    static std::unique_ptr<rpc::transponder::AdsbVehicle>
+    translateToRpcAdsbVehicle(const mavsdk::Transponder::AdsbVehicle& adsb_vehicle)
+    {
+        auto rpc_obj = std::make_unique<rpc::transponder::AdsbVehicle>();
+        translateToRpcAdsbVehicle(adsb_vehicle, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -245,52 +254,46 @@ public:
     }
 
     grpc::Status SubscribeTransponder(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::transponder::SubscribeTransponderRequest* /* request */,
         grpc::ServerWriter<rpc::transponder::TransponderResponse>* writer) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             return grpc::Status::OK;
         }
 
-        auto stream_closed_promise = std::make_shared<std::promise<void>>();
-        auto stream_closed_future = stream_closed_promise->get_future();
-        register_stream_stop_promise(stream_closed_promise);
-
-        auto is_finished = std::make_shared<bool>(false);
-        auto subscribe_mutex = std::make_shared<std::mutex>();
+        auto outbox = std::make_shared<StreamOutbox<rpc::transponder::TransponderResponse>>(
+            _stream_policy.load());
+        register_stream_outbox(outbox, "SubscribeTransponder");
 
-        _lazy_plugin.maybe_plugin()->subscribe_transponder(
-            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex](
-                const mavsdk::Transponder::AdsbVehicle transponder) {
-                rpc::transponder::TransponderResponse rpc_response;
-
-                rpc_response.set_allocated_transponder(
-                    translateToRpcAdsbVehicle(transponder).release());
-
-                std::unique_lock<std::mutex> lock(*subscribe_mutex);
-                if (!*is_finished && !writer->Write(rpc_response)) {
-                    _lazy_plugin.maybe_plugin()->subscribe_transponder(nullptr);
-
-                    *is_finished = true;
-                    unregister_stream_stop_promise(stream_closed_promise);
-                    stream_closed_promise->set_value();
-                }
+        plugin->subscribe_transponder(
+            [outbox](const mavsdk::Transponder::AdsbVehicle transponder) {
+                outbox->emplace([&](rpc::transponder::TransponderResponse& rpc_response) {
+                    translateToRpcAdsbVehicle(transponder, rpc_response.mutable_transponder());
+                });
             });
 
-        stream_closed_future.wait();
-        std::unique_lock<std::mutex> lock(*subscribe_mutex);
-        *is_finished = true;
+        // Writing happens on this gRPC thread only, so a slow client can't block the
+        // callback thread; it just falls behind in its own outbox.
+        write_stream(context, writer, *outbox);
+        plugin->subscribe_transponder(nullptr);
+
+        outbox->close();
+        unregister_stream_outbox(outbox);
 
         return grpc::Status::OK;
     }
 
     grpc::Status SetRateTransponder(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::transponder::SetRateTransponderRequest* request,
         rpc::transponder::SetRateTransponderResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Transponder::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -304,7 +307,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->set_rate_transponder(request->rate_hz());
+        auto result = plugin->set_rate_transponder(request->rate_hz());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -316,32 +319,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"transponder", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -350,7 +369,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
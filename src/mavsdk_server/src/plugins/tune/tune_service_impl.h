@@ -8,11 +8,14 @@
 #include "mavsdk.h"
 #include "lazy_plugin.h"
 #include "log.h"
+#include "stream_outbox.h"
+#include "system_routing.h"
 #include <atomic>
 #include <cmath>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -142,17 +145,22 @@ public:
         }
     }
 
-    static std::unique_ptr<rpc::tune::TuneDescription>
-    translateToRpcTuneDescription(const mavsdk::Tune::TuneDescription& tune_description)
+    static void translateToRpcTuneDescription(
+        const mavsdk::Tune::TuneDescription& tune_description, rpc::tune::TuneDescription* rpc_obj)
     {
-        auto rpc_obj = std::make_unique<rpc::tune::TuneDescription>();
-
+        rpc_obj->clear_song_elements();
         for (const auto& elem : tune_description.song_elements) {
             rpc_obj->add_song_elements(translateToRpcSongElement(elem));
         }
 
         rpc_obj->set_tempo(tune_description.tempo);
+    }
 
+    static std::unique_ptr<rpc::tune::TuneDescription>
+    translateToRpcTuneDescription(const mavsdk::Tune::TuneDescription& tune_description)
+    {
+        auto rpc_obj = std::make_unique<rpc::tune::TuneDescription>();
+        translateToRpcTuneDescription(tune_description, rpc_obj.get());
         return rpc_obj;
     }
 
@@ -214,11 +222,13 @@ public:
     }
 
     grpc::Status PlayTune(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::tune::PlayTuneRequest* request,
         rpc::tune::PlayTuneResponse* response) override
     {
-        if (_lazy_plugin.maybe_plugin() == nullptr) {
+        auto* plugin = _lazy_plugin.maybe_plugin(system_id_from_context(context));
+
+        if (plugin == nullptr) {
             if (response != nullptr) {
                 auto result = mavsdk::Tune::Result::NoSystem;
                 fillResponseWithResult(response, result);
@@ -232,7 +242,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _lazy_plugin.maybe_plugin()->play_tune(
+        auto result = plugin->play_tune(
             translateFromRpcTuneDescription(request->tune_description()));
 
         if (response != nullptr) {
@@ -245,32 +255,48 @@ public:
     void stop()
     {
         _stopped.store(true);
-        for (auto& prom : _stream_stop_promises) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                handle->close();
+            }
+        }
+    }
+
+    // Applies to subscriptions made afterwards; finite streams always queue.
+    void set_stream_policy(StreamOutboxPolicy policy) { _stream_policy.store(policy); }
+
+    // Adds the queue depth and drops of each open stream.
+    void collect_stream_stats(std::vector<StreamOutboxStats>& stats)
+    {
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto& entry : _stream_outboxes) {
+            if (auto handle = entry.outbox.lock()) {
+                stats.push_back({"tune", entry.rpc, handle->size(), handle->dropped()});
             }
         }
     }
 
 private:
-    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    void register_stream_outbox(std::weak_ptr<StreamOutboxBase> outbox, const char* rpc)
     {
-        // If we have already stopped, set promise immediately and don't add it to list.
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        // If we have already stopped, close the outbox immediately and don't add it to list.
         if (_stopped.load()) {
-            if (auto handle = prom.lock()) {
-                handle->set_value();
+            if (auto handle = outbox.lock()) {
+                handle->close();
             }
         } else {
-            _stream_stop_promises.push_back(prom);
+            _stream_outboxes.push_back({rpc, outbox});
         }
     }
 
-    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    void unregister_stream_outbox(std::shared_ptr<StreamOutboxBase> outbox)
     {
-        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
-             /* ++it */) {
-            if (it->lock() == prom) {
-                it = _stream_stop_promises.erase(it);
+        std::lock_guard<std::mutex> lock(_stream_outboxes_mutex);
+        for (auto it = _stream_outboxes.begin(); it != _stream_outboxes.end(); /* ++it */) {
+            if (it->outbox.lock() == outbox) {
+                it = _stream_outboxes.erase(it);
             } else {
                 ++it;
             }
@@ -279,7 +305,9 @@ private:
 
     LazyPlugin& _lazy_plugin;
     std::atomic<bool> _stopped{false};
-    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+    std::atomic<StreamOutboxPolicy> _stream_policy{StreamOutboxPolicy::Queue};
+    std::mutex _stream_outboxes_mutex{};
+    std::vector<RegisteredStreamOutbox> _stream_outboxes{};
 };
 
 } // namespace mavsdk_server
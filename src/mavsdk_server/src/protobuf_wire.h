@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+// Reading and writing the protobuf wire format, for the messages of services
+// which are served without generated code, see mavlink_frames_wire.h and
+// telemetry_bundle_wire.h.
+namespace protobuf_wire {
+
+enum WireType : uint32_t {
+    Varint = 0,
+    Fixed64 = 1,
+    LengthDelimited = 2,
+    Fixed32 = 5,
+};
+
+class Reader {
+public:
+    explicit Reader(const std::string& data) :
+        _pos(reinterpret_cast<const uint8_t*>(data.data())),
+        _end(_pos + data.size())
+    {}
+    Reader(const uint8_t* begin, const uint8_t* end) : _pos(begin), _end(end) {}
+
+    [[nodiscard]] bool done() const { return _pos == _end; }
+
+    bool read_varint(uint64_t& value)
+    {
+        value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (_pos == _end) {
+                return false;
+            }
+            const uint8_t byte = *_pos++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool read_tag(uint32_t& field, uint32_t& wire_type)
+    {
+        uint64_t tag;
+        if (!read_varint(tag) || (tag >> 3) == 0 || (tag >> 3) > UINT32_MAX) {
+            return false;
+        }
+        field = static_cast<uint32_t>(tag >> 3);
+        wire_type = static_cast<uint32_t>(tag & 0x7);
+        return true;
+    }
+
+    bool read_length_delimited(const uint8_t*& begin, const uint8_t*& end)
+    {
+        uint64_t length;
+        if (!read_varint(length) || length > static_cast<uint64_t>(_end - _pos)) {
+            return false;
+        }
+        begin = _pos;
+        end = _pos + length;
+        _pos = end;
+        return true;
+    }
+
+    bool read_uint32(uint32_t& value)
+    {
+        uint64_t wide;
+        if (!read_varint(wide)) {
+            return false;
+        }
+        // Truncated like protobuf does for an uint32 sent as a larger type.
+        value = static_cast<uint32_t>(wide);
+        return true;
+    }
+
+    bool read_bool(bool& value)
+    {
+        uint64_t wide;
+        if (!read_varint(wide)) {
+            return false;
+        }
+        value = wide != 0;
+        return true;
+    }
+
+    bool read_double(double& value)
+    {
+        if (static_cast<std::size_t>(_end - _pos) < sizeof(value)) {
+            return false;
+        }
+        // Little endian on the wire, as on all platforms we run on.
+        std::memcpy(&value, _pos, sizeof(value));
+        _pos += sizeof(value);
+        return true;
+    }
+
+    bool skip(uint32_t wire_type)
+    {
+        const uint8_t* begin;
+        const uint8_t* end;
+        uint64_t value;
+        switch (wire_type) {
+            case Varint:
+                return read_varint(value);
+            case Fixed64:
+                return skip_bytes(8);
+            case LengthDelimited:
+                return read_length_delimited(begin, end);
+            case Fixed32:
+                return skip_bytes(4);
+            default:
+                return false;
+        }
+    }
+
+private:
+    bool skip_bytes(std::size_t num)
+    {
+        if (num > static_cast<std::size_t>(_end - _pos)) {
+            return false;
+        }
+        _pos += num;
+        return true;
+    }
+
+    const uint8_t* _pos;
+    const uint8_t* _end;
+};
+
+inline void write_varint(uint64_t value, std::string& out)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+inline void write_tag(uint32_t field, WireType wire_type, std::string& out)
+{
+    write_varint((static_cast<uint64_t>(field) << 3) | wire_type, out);
+}
+
+inline void write_varint_field(uint32_t field, uint64_t value, std::string& out)
+{
+    // Default values are not written, as protobuf does.
+    if (value == 0) {
+        return;
+    }
+    write_tag(field, Varint, out);
+    write_varint(value, out);
+}
+
+// Written however long it is, e.g. for an empty message which is set.
+inline void write_bytes_field(uint32_t field, const std::string& bytes, std::string& out)
+{
+    write_tag(field, LengthDelimited, out);
+    write_varint(bytes.size(), out);
+    out.append(bytes);
+}
+
+} // namespace protobuf_wire
+} // namespace mavsdk_server
+} // namespace mavsdk
@@ -0,0 +1,227 @@
+#include "server_metrics.h"
+
+#include <utility>
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+namespace {
+
+void write_header(std::ostream& out, const char* name, const char* type, const char* help)
+{
+    out << "# HELP " << name << ' ' << help << '\n';
+    out << "# TYPE " << name << ' ' << type << '\n';
+}
+
+double seconds(uint64_t ns)
+{
+    return static_cast<double>(ns) / 1e9;
+}
+
+class MetricsInterceptor : public grpc::experimental::Interceptor {
+public:
+    explicit MetricsInterceptor(ServerMetrics::RpcEntry& entry) :
+        _entry(entry),
+        _start_ns(MessageLatency::now_ns())
+    {
+        _entry.started.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Intercept(grpc::experimental::InterceptorBatchMethods* methods) override
+    {
+        using grpc::experimental::InterceptionHookPoints;
+
+        if (methods->QueryInterceptionHookPoint(InterceptionHookPoints::PRE_SEND_MESSAGE)) {
+            _entry.messages_sent.fetch_add(1, std::memory_order_relaxed);
+            // The message is serialized for sending anyway, this just does it first.
+            if (auto* buffer = methods->GetSerializedSendMessage()) {
+                _entry.bytes_sent.fetch_add(buffer->Length(), std::memory_order_relaxed);
+            }
+        }
+
+        if (methods->QueryInterceptionHookPoint(InterceptionHookPoints::PRE_SEND_STATUS)) {
+            _entry.handled.fetch_add(1, std::memory_order_relaxed);
+            if (!methods->GetSendStatus().ok()) {
+                _entry.failed.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            const auto now_ns = MessageLatency::now_ns();
+            std::lock_guard<std::mutex> lock(_entry.latency_mutex);
+            _entry.latency.record(now_ns > _start_ns ? now_ns - _start_ns : 0);
+        }
+
+        methods->Proceed();
+    }
+
+private:
+    ServerMetrics::RpcEntry& _entry;
+    const uint64_t _start_ns;
+};
+
+} // namespace
+
+ServerMetrics::RpcEntry& ServerMetrics::entry_for(const std::string& method)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& entry = _entries[method];
+    if (entry == nullptr) {
+        entry = std::make_unique<RpcEntry>();
+    }
+    return *entry;
+}
+
+void ServerMetrics::render(std::ostream& out) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    write_header(out, "mavsdk_server_rpc_started_total", "counter", "RPCs started.");
+    for (const auto& [method, entry] : _entries) {
+        out << "mavsdk_server_rpc_started_total{method=\"" << method << "\"} "
+            << entry->started.load() << '\n';
+    }
+
+    write_header(out, "mavsdk_server_rpc_handled_total", "counter", "RPCs completed.");
+    for (const auto& [method, entry] : _entries) {
+        out << "mavsdk_server_rpc_handled_total{method=\"" << method << "\"} "
+            << entry->handled.load() << '\n';
+    }
+
+    write_header(
+        out, "mavsdk_server_rpc_failed_total", "counter", "RPCs completed with an error status.");
+    for (const auto& [method, entry] : _entries) {
+        out << "mavsdk_server_rpc_failed_total{method=\"" << method << "\"} "
+            << entry->failed.load() << '\n';
+    }
+
+    write_header(
+        out, "mavsdk_server_rpc_sent_messages_total", "counter", "Response messages sent.");
+    for (const auto& [method, entry] : _entries) {
+        out << "mavsdk_server_rpc_sent_messages_total{method=\"" << method << "\"} "
+            << entry->messages_sent.load() << '\n';
+    }
+
+    write_header(
+        out, "mavsdk_server_rpc_sent_bytes_total", "counter", "Serialized response bytes sent.");
+    for (const auto& [method, entry] : _entries) {
+        out << "mavsdk_server_rpc_sent_bytes_total{method=\"" << method << "\"} "
+            << entry->bytes_sent.load() << '\n';
+    }
+
+    write_header(
+        out,
+        "mavsdk_server_rpc_duration_seconds",
+        "summary",
+        "Time from receiving an RPC until its status is sent, for streams their lifetime.");
+    for (const auto& [method, entry] : _entries) {
+        Mavsdk::LatencyStats stats;
+        {
+            std::lock_guard<std::mutex> latency_lock(entry->latency_mutex);
+            stats = entry->latency.stats();
+        }
+        const std::string labels = "method=\"" + method + "\"";
+        out << "mavsdk_server_rpc_duration_seconds{" << labels << ",quantile=\"0.5\"} "
+            << seconds(stats.p50_ns) << '\n';
+        out << "mavsdk_server_rpc_duration_seconds{" << labels << ",quantile=\"0.99\"} "
+            << seconds(stats.p99_ns) << '\n';
+        out << "mavsdk_server_rpc_duration_seconds{" << labels << ",quantile=\"1\"} "
+            << seconds(stats.max_ns) << '\n';
+        out << "mavsdk_server_rpc_duration_seconds_count{" << labels << "} " << stats.count
+            << '\n';
+    }
+}
+
+void render_stream_metrics(std::ostream& out, const std::vector<StreamOutboxStats>& streams)
+{
+    struct Sum {
+        std::size_t open{0};
+        std::size_t depth{0};
+        std::size_t dropped{0};
+    };
+
+    std::map<std::pair<std::string, std::string>, Sum> sums;
+    for (const auto& stream : streams) {
+        auto& sum = sums[{stream.service, stream.rpc}];
+        ++sum.open;
+        sum.depth += stream.depth;
+        sum.dropped += stream.dropped;
+    }
+
+    write_header(out, "mavsdk_server_streams_open", "gauge", "Open server streams.");
+    for (const auto& [key, sum] : sums) {
+        out << "mavsdk_server_streams_open{service=\"" << key.first << "\",rpc=\"" << key.second
+            << "\"} " << sum.open << '\n';
+    }
+
+    write_header(
+        out,
+        "mavsdk_server_stream_queue_depth",
+        "gauge",
+        "Responses queued for open streams and not yet written.");
+    for (const auto& [key, sum] : sums) {
+        out << "mavsdk_server_stream_queue_depth{service=\"" << key.first << "\",rpc=\""
+            << key.second << "\"} " << sum.depth << '\n';
+    }
+
+    write_header(
+        out,
+        "mavsdk_server_stream_dropped",
+        "gauge",
+        "Responses dropped by open streams because the client did not keep up.");
+    for (const auto& [key, sum] : sums) {
+        out << "mavsdk_server_stream_dropped{service=\"" << key.first << "\",rpc=\""
+            << key.second << "\"} " << sum.dropped << '\n';
+    }
+}
+
+void render_mavsdk_metrics(
+    std::ostream& out,
+    const Mavsdk::CallbackQueueStats& callback_queue,
+    const std::vector<Mavsdk::ConnectionStats>& connections)
+{
+    write_header(out, "mavsdk_callback_queue_depth", "gauge", "User callbacks queued.");
+    out << "mavsdk_callback_queue_depth " << callback_queue.depth << '\n';
+
+    write_header(
+        out, "mavsdk_callback_queue_max_depth", "gauge", "Most user callbacks queued at once.");
+    out << "mavsdk_callback_queue_max_depth " << callback_queue.max_depth << '\n';
+
+    write_header(out, "mavsdk_callbacks_processed_total", "counter", "User callbacks called.");
+    out << "mavsdk_callbacks_processed_total " << callback_queue.processed << '\n';
+
+    write_header(
+        out, "mavsdk_callbacks_dropped_total", "counter", "User callbacks dropped on overflow.");
+    out << "mavsdk_callbacks_dropped_total " << callback_queue.dropped << '\n';
+
+    write_header(out, "mavsdk_connection_received_bytes_total", "counter", "Bytes received.");
+    for (const auto& connection : connections) {
+        out << "mavsdk_connection_received_bytes_total{connection=\""
+            << connection.connection_index << "\"} " << connection.link.bytes_received << '\n';
+    }
+
+    write_header(
+        out, "mavsdk_connection_received_messages_total", "counter", "MAVLink messages received.");
+    for (const auto& connection : connections) {
+        out << "mavsdk_connection_received_messages_total{connection=\""
+            << connection.connection_index << "\"} " << connection.link.messages_received
+            << '\n';
+    }
+
+    write_header(
+        out,
+        "mavsdk_connection_lost_messages_total",
+        "counter",
+        "MAVLink messages missing in the sequence.");
+    for (const auto& connection : connections) {
+        out << "mavsdk_connection_lost_messages_total{connection=\""
+            << connection.connection_index << "\"} " << connection.link.messages_lost << '\n';
+    }
+}
+
+grpc::experimental::Interceptor*
+MetricsInterceptorFactory::CreateServerInterceptor(grpc::experimental::ServerRpcInfo* info)
+{
+    return new MetricsInterceptor(_metrics.entry_for(info->method()));
+}
+
+} // namespace mavsdk_server
+} // namespace mavsdk
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <grpcpp/support/server_interceptor.h>
+
+#include "mavsdk.h"
+#include "message_latency.h"
+#include "stream_outbox.h"
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+// Counters and latencies of every RPC served, keyed by the full method name
+// such as "/mavsdk.rpc.mission.MissionService/UploadMission".
+//
+// Counters are atomics so a busy stream only touches its own entry, and the
+// map lock is only taken once per call.
+class ServerMetrics {
+public:
+    struct RpcEntry {
+        std::atomic<uint64_t> started{0};
+        std::atomic<uint64_t> handled{0};
+        std::atomic<uint64_t> failed{0};
+        std::atomic<uint64_t> messages_sent{0};
+        std::atomic<uint64_t> bytes_sent{0};
+
+        std::mutex latency_mutex{};
+        LatencyHistogram latency{};
+    };
+
+    ServerMetrics() = default;
+    ~ServerMetrics() = default;
+
+    // Non-copyable
+    ServerMetrics(const ServerMetrics&) = delete;
+    const ServerMetrics& operator=(const ServerMetrics&) = delete;
+
+    // The entry stays valid for the lifetime of the metrics.
+    RpcEntry& entry_for(const std::string& method);
+
+    // Writes the RPC metrics in the Prometheus text format.
+    void render(std::ostream& out) const;
+
+private:
+    mutable std::mutex _mutex{};
+    std::map<std::string, std::unique_ptr<RpcEntry>> _entries{};
+};
+
+// Stream queues, summed up per RPC over all open streams.
+void render_stream_metrics(std::ostream& out, const std::vector<StreamOutboxStats>& streams);
+
+void render_mavsdk_metrics(
+    std::ostream& out,
+    const Mavsdk::CallbackQueueStats& callback_queue,
+    const std::vector<Mavsdk::ConnectionStats>& connections);
+
+// Feeds every call of the server into ServerMetrics.
+class MetricsInterceptorFactory : public grpc::experimental::ServerInterceptorFactoryInterface {
+public:
+    explicit MetricsInterceptorFactory(ServerMetrics& metrics) : _metrics(metrics) {}
+
+    grpc::experimental::Interceptor*
+    CreateServerInterceptor(grpc::experimental::ServerRpcInfo* info) override;
+
+private:
+    ServerMetrics& _metrics;
+};
+
+} // namespace mavsdk_server
+} // namespace mavsdk
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace mavsdk {
+namespace mavsdk_server {
+namespace shm_telemetry {
+
+// Binary layout of the shared-memory segment that mavsdk_server can publish
+// high rate telemetry into (see --shm-telemetry), so that processes on the same
+// host can read IMU and odometry samples without going through gRPC. Commands
+// and everything else still go over gRPC.
+//
+// The segment is created with shm_open() under the configured name and only
+// contains fixed size native types in host byte order. All offsets are in bytes
+// from the start of the segment:
+//
+//   Header        at 0
+//   RingHeader    at Header::ring_offset[topic], one per topic
+//   Slot[]        at ring_offset + RingHeader::slots_offset, slot_count slots of
+//                 slot_size bytes each
+//
+// Each slot starts with a 64-bit sequence followed by the sample at
+// Slot::sample_offset. There is one writer per ring. Sample n (counting from 1)
+// goes into slot (n - 1) % slot_count, and the writer:
+//
+//   1. stores 2n - 1 into the slot sequence,
+//   2. writes the sample,
+//   3. stores 2n into the slot sequence (release),
+//   4. stores n into RingHeader::write_count (release).
+//
+// A reader wanting sample n loads the slot sequence (acquire), which has to be
+// 2n, reads the sample in place, issues an acquire fence and loads the sequence
+// again. If it is still 2n the sample read is consistent, otherwise the writer
+// has lapped the reader and the data has to be discarded. The latest sample is
+// n = write_count, and as long as a reader is fewer than slot_count samples
+// behind it can also catch up on the ones it missed.
+//
+// Header::magic is written last once the segment is set up, so readers that
+// map the segment early have to wait until it matches.
+
+static constexpr uint32_t magic = 0x5453564d; // "MVST"
+static constexpr uint16_t version = 1;
+static constexpr std::size_t max_topics = 8;
+
+enum class Topic : uint16_t {
+    Imu = 0,
+    Odometry = 1,
+};
+static constexpr uint16_t topic_count = 2;
+
+struct Header {
+    std::atomic<uint32_t> magic;
+    uint16_t version;
+    uint16_t topic_count;
+    uint64_t segment_size;
+    uint64_t ring_offset[max_topics]; // 0 if the topic is not published.
+};
+
+struct alignas(64) RingHeader {
+    std::atomic<uint64_t> write_count;
+    uint16_t topic;
+    uint16_t reserved;
+    uint32_t sample_size;
+    uint32_t slot_size;
+    uint32_t slot_count;
+    uint64_t slots_offset; // From the start of this RingHeader.
+};
+
+// Matches Telemetry::Imu.
+struct ImuSample {
+    uint64_t timestamp_us;
+    float acceleration_frd_m_s2[3];
+    float angular_velocity_frd_rad_s[3];
+    float magnetic_field_frd_gauss[3];
+    float temperature_degc;
+};
+
+// Matches Telemetry::Odometry. Frames are MAV_FRAME values, covariances are the
+// upper-right triangle and start with NaN if unknown.
+struct OdometrySample {
+    uint64_t time_usec;
+    uint32_t frame_id;
+    uint32_t child_frame_id;
+    float position_body_m[3];
+    float q[4]; // w, x, y, z
+    float velocity_body_m_s[3];
+    float angular_velocity_body_rad_s[3];
+    float pose_covariance[21];
+    float velocity_covariance[21];
+    float reserved;
+};
+
+template<typename Sample> struct alignas(64) Slot {
+    static constexpr std::size_t sample_offset = 8;
+
+    std::atomic<uint64_t> sequence;
+    Sample sample;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared atomics must be lock free");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must be lock free");
+static_assert(sizeof(std::atomic<uint64_t>) == 8, "sequence must be a plain 64-bit word");
+static_assert(offsetof(Header, ring_offset) == 16, "layout is part of the interface");
+static_assert(sizeof(RingHeader) == 64, "layout is part of the interface");
+static_assert(sizeof(ImuSample) == 48, "layout is part of the interface");
+static_assert(sizeof(OdometrySample) == 240, "layout is part of the interface");
+static_assert(offsetof(Slot<ImuSample>, sample) == Slot<ImuSample>::sample_offset, "");
+static_assert(offsetof(Slot<OdometrySample>, sample) == Slot<OdometrySample>::sample_offset, "");
+static_assert(std::is_trivially_copyable<ImuSample>::value, "samples must be plain data");
+static_assert(std::is_trivially_copyable<OdometrySample>::value, "samples must be plain data");
+
+inline const RingHeader* ring(const Header& header, Topic topic)
+{
+    const auto index = static_cast<std::size_t>(topic);
+    if (header.magic.load(std::memory_order_acquire) != magic || index >= max_topics ||
+        header.ring_offset[index] == 0) {
+        return nullptr;
+    }
+    return reinterpret_cast<const RingHeader*>(
+        reinterpret_cast<const char*>(&header) + header.ring_offset[index]);
+}
+
+template<typename Sample> const Slot<Sample>& slot(const RingHeader& ring, uint64_t n)
+{
+    return *reinterpret_cast<const Slot<Sample>*>(
+        reinterpret_cast<const char*>(&ring) + ring.slots_offset +
+        ((n - 1) % ring.slot_count) * ring.slot_size);
+}
+
+// Calls visit with sample n in place, without copying it. Returns false if the
+// sample is not (or no longer) in the ring, in which case whatever visit saw has
+// to be discarded.
+template<typename Sample, typename Visit>
+bool read(const RingHeader& ring, uint64_t n, Visit&& visit)
+{
+    if (n == 0 || n > ring.write_count.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    const auto& s = slot<Sample>(ring, n);
+    if (s.sequence.load(std::memory_order_acquire) != 2 * n) {
+        return false;
+    }
+    visit(s.sample);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return s.sequence.load(std::memory_order_relaxed) == 2 * n;
+}
+
+// Copies out the latest sample. Returns its number, or 0 if nothing has been
+// published yet.
+template<typename Sample> uint64_t read_latest(const RingHeader& ring, Sample& sample)
+{
+    while (true) {
+        const auto n = ring.write_count.load(std::memory_order_acquire);
+        if (n == 0) {
+            return 0;
+        }
+        if (read<Sample>(ring, n, [&sample](const Sample& in_place) { sample = in_place; })) {
+            return n;
+        }
+    }
+}
+
+} // namespace shm_telemetry
+} // namespace mavsdk_server
+} // namespace mavsdk
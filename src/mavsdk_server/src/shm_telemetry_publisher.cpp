@@ -0,0 +1,240 @@
+#include "shm_telemetry_publisher.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+#if !defined(WINDOWS) && !defined(ANDROID)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "log.h"
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+using namespace shm_telemetry;
+
+namespace {
+
+std::size_t align_up(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+template<typename Sample> std::size_t ring_size(uint32_t slot_count)
+{
+    return sizeof(RingHeader) + sizeof(Slot<Sample>) * slot_count;
+}
+
+template<typename Sample>
+void init_ring(Header& header, Topic topic, std::size_t offset, uint32_t slot_count)
+{
+    auto* ring = new (reinterpret_cast<char*>(&header) + offset) RingHeader;
+    ring->write_count.store(0, std::memory_order_relaxed);
+    ring->topic = static_cast<uint16_t>(topic);
+    ring->reserved = 0;
+    ring->sample_size = sizeof(Sample);
+    ring->slot_size = sizeof(Slot<Sample>);
+    ring->slot_count = slot_count;
+    ring->slots_offset = sizeof(RingHeader);
+
+    auto* slots = reinterpret_cast<char*>(ring) + ring->slots_offset;
+    for (uint32_t i = 0; i < slot_count; ++i) {
+        auto* s = new (slots + i * sizeof(Slot<Sample>)) Slot<Sample>;
+        s->sequence.store(0, std::memory_order_relaxed);
+    }
+
+    header.ring_offset[static_cast<std::size_t>(topic)] = offset;
+}
+
+void copy_covariance(const Telemetry::Covariance& covariance, float (&out)[21])
+{
+    const auto& matrix = covariance.covariance_matrix;
+    for (std::size_t i = 0; i < 21; ++i) {
+        out[i] = i < matrix.size() ? matrix[i] : NAN;
+    }
+}
+
+} // namespace
+
+ShmTelemetryPublisher::~ShmTelemetryPublisher()
+{
+    detach();
+    close();
+}
+
+bool ShmTelemetryPublisher::open(const std::string& name, uint32_t slot_count)
+{
+#if defined(WINDOWS) || defined(ANDROID)
+    (void)name;
+    (void)slot_count;
+    LogErr() << "Shared-memory telemetry is not supported on this platform";
+    return false;
+#else
+    close();
+
+    if (slot_count == 0) {
+        LogErr() << "Shared-memory telemetry needs at least one slot";
+        return false;
+    }
+
+    const auto imu_offset = align_up(sizeof(Header), 64);
+    const auto odometry_offset = imu_offset + ring_size<ImuSample>(slot_count);
+    const auto size = odometry_offset + ring_size<OdometrySample>(slot_count);
+
+    // Start from a fresh segment, so readers of a previous run don't mistake
+    // stale samples for new ones.
+    shm_unlink(name.c_str());
+
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        LogErr() << "Could not create shared memory " << name << ": " << strerror(errno);
+        return false;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        LogErr() << "Could not size shared memory " << name << ": " << strerror(errno);
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        LogErr() << "Could not map shared memory " << name << ": " << strerror(errno);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    auto* header = new (memory) Header;
+    header->version = shm_telemetry::version;
+    header->topic_count = shm_telemetry::topic_count;
+    header->segment_size = size;
+    for (auto& offset : header->ring_offset) {
+        offset = 0;
+    }
+    init_ring<ImuSample>(*header, Topic::Imu, imu_offset, slot_count);
+    init_ring<OdometrySample>(*header, Topic::Odometry, odometry_offset, slot_count);
+    header->magic.store(shm_telemetry::magic, std::memory_order_release);
+
+    _name = name;
+    _header = header;
+    _size = size;
+    return true;
+#endif
+}
+
+void ShmTelemetryPublisher::close()
+{
+#if !defined(WINDOWS) && !defined(ANDROID)
+    if (_header == nullptr) {
+        return;
+    }
+
+    munmap(_header, _size);
+    shm_unlink(_name.c_str());
+    _header = nullptr;
+    _size = 0;
+    _name.clear();
+#endif
+}
+
+void ShmTelemetryPublisher::attach(Telemetry& telemetry)
+{
+    std::lock_guard<std::mutex> lock(_attach_mutex);
+    if (_telemetry != nullptr) {
+        return;
+    }
+
+    _telemetry = &telemetry;
+    _imu_handle = telemetry.subscribe_imu([this](Telemetry::Imu imu) { publish(imu); });
+    _odometry_handle = telemetry.subscribe_odometry(
+        [this](Telemetry::Odometry odometry) { publish(odometry); });
+}
+
+void ShmTelemetryPublisher::detach()
+{
+    std::lock_guard<std::mutex> lock(_attach_mutex);
+    if (_telemetry == nullptr) {
+        return;
+    }
+
+    _telemetry->unsubscribe_imu(_imu_handle);
+    _telemetry->unsubscribe_odometry(_odometry_handle);
+    _telemetry = nullptr;
+}
+
+void ShmTelemetryPublisher::publish(const Telemetry::Imu& imu)
+{
+    ImuSample sample{};
+    sample.timestamp_us = imu.timestamp_us;
+    sample.acceleration_frd_m_s2[0] = imu.acceleration_frd.forward_m_s2;
+    sample.acceleration_frd_m_s2[1] = imu.acceleration_frd.right_m_s2;
+    sample.acceleration_frd_m_s2[2] = imu.acceleration_frd.down_m_s2;
+    sample.angular_velocity_frd_rad_s[0] = imu.angular_velocity_frd.forward_rad_s;
+    sample.angular_velocity_frd_rad_s[1] = imu.angular_velocity_frd.right_rad_s;
+    sample.angular_velocity_frd_rad_s[2] = imu.angular_velocity_frd.down_rad_s;
+    sample.magnetic_field_frd_gauss[0] = imu.magnetic_field_frd.forward_gauss;
+    sample.magnetic_field_frd_gauss[1] = imu.magnetic_field_frd.right_gauss;
+    sample.magnetic_field_frd_gauss[2] = imu.magnetic_field_frd.down_gauss;
+    sample.temperature_degc = imu.temperature_degc;
+
+    write(Topic::Imu, sample);
+}
+
+void ShmTelemetryPublisher::publish(const Telemetry::Odometry& odometry)
+{
+    OdometrySample sample{};
+    sample.time_usec = odometry.time_usec;
+    sample.frame_id = static_cast<uint32_t>(odometry.frame_id);
+    sample.child_frame_id = static_cast<uint32_t>(odometry.child_frame_id);
+    sample.position_body_m[0] = odometry.position_body.x_m;
+    sample.position_body_m[1] = odometry.position_body.y_m;
+    sample.position_body_m[2] = odometry.position_body.z_m;
+    sample.q[0] = odometry.q.w;
+    sample.q[1] = odometry.q.x;
+    sample.q[2] = odometry.q.y;
+    sample.q[3] = odometry.q.z;
+    sample.velocity_body_m_s[0] = odometry.velocity_body.x_m_s;
+    sample.velocity_body_m_s[1] = odometry.velocity_body.y_m_s;
+    sample.velocity_body_m_s[2] = odometry.velocity_body.z_m_s;
+    sample.angular_velocity_body_rad_s[0] = odometry.angular_velocity_body.roll_rad_s;
+    sample.angular_velocity_body_rad_s[1] = odometry.angular_velocity_body.pitch_rad_s;
+    sample.angular_velocity_body_rad_s[2] = odometry.angular_velocity_body.yaw_rad_s;
+    copy_covariance(odometry.pose_covariance, sample.pose_covariance);
+    copy_covariance(odometry.velocity_covariance, sample.velocity_covariance);
+
+    write(Topic::Odometry, sample);
+}
+
+// Each topic is only published from its own subscription callback, so there is
+// a single writer per ring.
+template<typename Sample>
+void ShmTelemetryPublisher::write(shm_telemetry::Topic topic, const Sample& sample)
+{
+    if (_header == nullptr) {
+        return;
+    }
+
+    auto* r = const_cast<RingHeader*>(ring(*_header, topic));
+    if (r == nullptr) {
+        return;
+    }
+
+    const auto n = r->write_count.load(std::memory_order_relaxed) + 1;
+    auto& s = const_cast<Slot<Sample>&>(slot<Sample>(*r, n));
+
+    s.sequence.store(2 * n - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&s.sample, &sample, sizeof(Sample));
+    s.sequence.store(2 * n, std::memory_order_release);
+    r->write_count.store(n, std::memory_order_release);
+}
+
+} // namespace mavsdk_server
+} // namespace mavsdk
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "plugins/telemetry/telemetry.h"
+#include "shm_telemetry_layout.h"
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+// Publishes IMU and odometry samples into a shared-memory segment laid out as
+// described in shm_telemetry_layout.h, for readers on the same host.
+//
+// Needs POSIX shared memory, so open() fails on Windows and Android.
+class ShmTelemetryPublisher {
+public:
+    static constexpr uint32_t default_slot_count = 64;
+
+    ShmTelemetryPublisher() = default;
+    ~ShmTelemetryPublisher();
+
+    ShmTelemetryPublisher(const ShmTelemetryPublisher&) = delete;
+    ShmTelemetryPublisher& operator=(const ShmTelemetryPublisher&) = delete;
+
+    // Creates (or replaces) the segment, e.g. "/mavsdk_telemetry".
+    bool open(const std::string& name, uint32_t slot_count = default_slot_count);
+    void close();
+
+    // Forwards the telemetry subscriptions until detach() is called.
+    void attach(Telemetry& telemetry);
+    void detach();
+
+    void publish(const Telemetry::Imu& imu);
+    void publish(const Telemetry::Odometry& odometry);
+
+    const shm_telemetry::Header* header() const { return _header; }
+
+private:
+    template<typename Sample> void write(shm_telemetry::Topic topic, const Sample& sample);
+
+    std::string _name{};
+    shm_telemetry::Header* _header{nullptr};
+    std::size_t _size{0};
+
+    std::mutex _attach_mutex{};
+    Telemetry* _telemetry{nullptr};
+    Telemetry::ImuHandle _imu_handle{};
+    Telemetry::OdometryHandle _odometry_handle{};
+};
+
+} // namespace mavsdk_server
+} // namespace mavsdk
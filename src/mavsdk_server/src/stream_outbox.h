@@ -0,0 +1,171 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+enum class StreamOutboxPolicy {
+    Queue, // Keep up to capacity responses, dropping the oldest when full.
+    Conflate, // Keep only the latest response, replacing an unsent one in place.
+};
+
+enum class StreamOutboxPopResult { Popped, TimedOut, Closed };
+
+// Type-erased handle, so a service can close all its open streams on stop and
+// report on them.
+class StreamOutboxBase {
+public:
+    virtual ~StreamOutboxBase() = default;
+    virtual void close() = 0;
+    virtual std::size_t size() const = 0;
+    virtual std::size_t dropped() const = 0;
+};
+
+// An open stream of a service, with the name of its RPC.
+struct RegisteredStreamOutbox {
+    const char* rpc;
+    std::weak_ptr<StreamOutboxBase> outbox;
+};
+
+struct StreamOutboxStats {
+    const char* service;
+    const char* rpc;
+    std::size_t depth; // Responses queued and not yet written.
+    std::size_t dropped;
+};
+
+// Bounded queue between the MAVSDK callback thread producing responses and the
+// gRPC thread writing them to the client.
+//
+// Pushing never blocks: if the client does not keep up, the oldest queued
+// responses are dropped. A slow client therefore only loses samples of its own
+// stream instead of stalling the callback thread for everyone else.
+//
+// With StreamOutboxPolicy::Conflate the outbox holds at most one response and a
+// new one overwrites the unsent one, so a slow client always gets the latest
+// value and never a backlog of stale ones.
+//
+// Responses live in a fixed ring of slots that are filled in place, and pop()
+// swaps a slot with the caller's response instead of copying it. Once every
+// slot has been used, sub-messages and buffers just keep cycling between the
+// slots and the writer, so a steady stream does not allocate.
+template<typename Response> class StreamOutbox final : public StreamOutboxBase {
+public:
+    static constexpr std::size_t default_capacity = 32;
+
+    explicit StreamOutbox(
+        StreamOutboxPolicy policy = StreamOutboxPolicy::Queue,
+        std::size_t capacity = default_capacity) :
+        _slots(policy == StreamOutboxPolicy::Conflate ? 1 : (capacity > 0 ? capacity : 1))
+    {}
+
+    ~StreamOutbox() override = default;
+
+    // Calls fill with the slot to write the next response into. The slot may still
+    // contain an older response, so fill has to set every field it uses.
+    template<typename Fill> void emplace(Fill&& fill)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_closed) {
+                return;
+            }
+
+            Response* slot;
+            if (_count == _slots.size()) {
+                // Overwrite the oldest, which then becomes the newest.
+                slot = &_slots[_head];
+                _head = (_head + 1) % _slots.size();
+                ++_dropped;
+            } else {
+                slot = &_slots[(_head + _count) % _slots.size()];
+                ++_count;
+            }
+            fill(*slot);
+        }
+        _cv.notify_one();
+    }
+
+    void push(Response response)
+    {
+        emplace([&response](Response& slot) { slot = std::move(response); });
+    }
+
+    // Blocks until a response is available. Returns false once the outbox is
+    // closed and everything queued before that has been handed out.
+    bool pop(Response& response)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this]() { return _count > 0 || _closed; });
+        if (_count == 0) {
+            return false;
+        }
+
+        pop_locked(response);
+        return true;
+    }
+
+    // Like pop(), but gives up at the deadline.
+    StreamOutboxPopResult
+    pop_until(Response& response, std::chrono::steady_clock::time_point deadline)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (!_cv.wait_until(lock, deadline, [this]() { return _count > 0 || _closed; })) {
+            return StreamOutboxPopResult::TimedOut;
+        }
+        if (_count == 0) {
+            return StreamOutboxPopResult::Closed;
+        }
+
+        pop_locked(response);
+        return StreamOutboxPopResult::Popped;
+    }
+
+    void close() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closed = true;
+        }
+        _cv.notify_all();
+    }
+
+    std::size_t size() const override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _count;
+    }
+
+    std::size_t dropped() const override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _dropped;
+    }
+
+private:
+    void pop_locked(Response& response)
+    {
+        using std::swap;
+        swap(response, _slots[_head]);
+        _head = (_head + 1) % _slots.size();
+        --_count;
+    }
+
+    mutable std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::vector<Response> _slots;
+    std::size_t _head{0};
+    std::size_t _count{0};
+    std::size_t _dropped{0};
+    bool _closed{false};
+};
+
+} // namespace mavsdk_server
+} // namespace mavsdk
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <grpc++/server_context.h>
+#include <grpc++/support/sync_stream.h>
+
+#include "log.h"
+#include "stream_outbox.h"
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+// Clients on a slow link, e.g. cellular, can ask for a stream to be written
+// differently by adding these metadata entries to the subscription:
+//
+// - compression: "gzip" or "deflate", for the responses of this stream.
+// - batch samples: the number of responses written at once, in decimal.
+// - batch ms: how long the first response may wait for others to be written
+//   with it, in decimal. Without a number of samples, up to
+//   max_batch_samples are written at once.
+//
+// A batch is handed to gRPC in one go, so the responses share HTTP/2 frames
+// and a single write instead of one each. They still arrive as separate
+// responses, so clients don't need to change anything else. Invalid values
+// are logged and ignored.
+static constexpr auto stream_compression_metadata_key = "mavsdk-compression";
+static constexpr auto stream_batch_samples_metadata_key = "mavsdk-batch-samples";
+static constexpr auto stream_batch_ms_metadata_key = "mavsdk-batch-ms";
+
+struct StreamOptions {
+    static constexpr std::size_t max_batch_samples = 256;
+
+    std::optional<grpc_compression_algorithm> compression{};
+    std::size_t batch_samples{1};
+    std::chrono::milliseconds batch_period{0};
+
+    [[nodiscard]] bool batching() const
+    {
+        return batch_samples > 1 || batch_period > std::chrono::milliseconds(0);
+    }
+};
+
+inline StreamOptions
+stream_options_from_metadata(const std::multimap<grpc::string_ref, grpc::string_ref>& metadata)
+{
+    StreamOptions options;
+
+    const auto value_of = [&](const char* key) -> std::optional<std::string> {
+        const auto it = metadata.find(key);
+        if (it == metadata.end()) {
+            return std::nullopt;
+        }
+        return std::string(it->second.data(), it->second.size());
+    };
+
+    const auto number_of = [&](const char* key, unsigned long max) -> std::optional<unsigned long> {
+        const auto value = value_of(key);
+        if (!value) {
+            return std::nullopt;
+        }
+        char* end = nullptr;
+        const auto number = std::strtoul(value->c_str(), &end, 10);
+        if (end == value->c_str() || *end != '\0' || number == 0 || number > max) {
+            LogWarn() << "Ignoring invalid " << key << ": " << *value;
+            return std::nullopt;
+        }
+        return number;
+    };
+
+    if (const auto compression = value_of(stream_compression_metadata_key)) {
+        if (*compression == "gzip") {
+            options.compression = GRPC_COMPRESS_GZIP;
+        } else if (*compression == "deflate") {
+            options.compression = GRPC_COMPRESS_DEFLATE;
+        } else if (*compression != "none") {
+            LogWarn() << "Ignoring unknown " << stream_compression_metadata_key << ": "
+                      << *compression;
+        }
+    }
+
+    const auto batch_samples =
+        number_of(stream_batch_samples_metadata_key, StreamOptions::max_batch_samples);
+    const auto batch_ms = number_of(stream_batch_ms_metadata_key, 60 * 1000);
+    if (batch_ms) {
+        options.batch_period = std::chrono::milliseconds(*batch_ms);
+        options.batch_samples = StreamOptions::max_batch_samples;
+    }
+    if (batch_samples) {
+        options.batch_samples = *batch_samples;
+    }
+
+    return options;
+}
+
+// Writes what comes out of the outbox until it is closed, in batches if the
+// options ask for it. Returns false if the client went away.
+template<typename Response, typename Writer>
+bool write_stream(const StreamOptions& options, Writer* writer, StreamOutbox<Response>& outbox)
+{
+    if (!options.batching()) {
+        Response response;
+        while (outbox.pop(response)) {
+            if (!writer->Write(response)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Responses are swapped in and out of the batch, so its buffers are reused.
+    std::vector<Response> batch(options.batch_samples);
+    std::size_t count = 0;
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+
+    while (true) {
+        StreamOutboxPopResult result;
+        if (deadline) {
+            result = outbox.pop_until(batch[count], *deadline);
+        } else {
+            result = outbox.pop(batch[count]) ? StreamOutboxPopResult::Popped :
+                                                StreamOutboxPopResult::Closed;
+        }
+
+        if (result == StreamOutboxPopResult::Popped) {
+            if (count == 0 && options.batch_period > std::chrono::milliseconds(0)) {
+                deadline = std::chrono::steady_clock::now() + options.batch_period;
+            }
+            ++count;
+        }
+
+        // What is left is written when the stream ends as well.
+        if (count > 0 && (count == batch.size() || result != StreamOutboxPopResult::Popped)) {
+            // Buffered by gRPC until the last one of the batch is written.
+            for (std::size_t i = 0; i + 1 < count; ++i) {
+                if (!writer->Write(batch[i], grpc::WriteOptions().set_buffer_hint())) {
+                    return false;
+                }
+            }
+            if (!writer->Write(batch[count - 1])) {
+                return false;
+            }
+            count = 0;
+            deadline.reset();
+        }
+
+        if (result == StreamOutboxPopResult::Closed) {
+            return true;
+        }
+    }
+}
+
+// The same, with the options the client asked for in the subscription.
+template<typename Response>
+bool write_stream(
+    grpc::ServerContext* context,
+    grpc::ServerWriter<Response>* writer,
+    StreamOutbox<Response>& outbox)
+{
+    const auto options = stream_options_from_metadata(context->client_metadata());
+    if (options.compression) {
+        context->set_compression_algorithm(*options.compression);
+    }
+    return write_stream(options, writer, outbox);
+}
+
+} // namespace mavsdk_server
+} // namespace mavsdk
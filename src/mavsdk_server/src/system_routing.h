@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+
+#include <grpc++/server_context.h>
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+// Clients select the system an RPC is meant for by adding this metadata entry
+// with the MAVLink system ID in decimal. Without it the first discovered system
+// is used, as before. A malformed ID maps to -1, which matches no system, so the
+// call fails with NoSystem instead of going to the wrong vehicle.
+static constexpr auto system_id_metadata_key = "mavsdk-system-id";
+
+inline int system_id_from_context(const grpc::ServerContext* context)
+{
+    if (context == nullptr) {
+        return 0;
+    }
+
+    const auto& metadata = context->client_metadata();
+    const auto it = metadata.find(system_id_metadata_key);
+    if (it == metadata.end()) {
+        return 0;
+    }
+
+    const std::string value(it->second.data(), it->second.size());
+    char* end = nullptr;
+    const auto system_id = std::strtoul(value.c_str(), &end, 10);
+    if (end == value.c_str() || *end != '\0' || system_id > 255) {
+        return -1;
+    }
+
+    return static_cast<int>(system_id);
+}
+
+} // namespace mavsdk_server
+} // namespace mavsdk
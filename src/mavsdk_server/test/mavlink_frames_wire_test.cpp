@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <string>
+#include <vector>
+
+#include "mavlink_frames_wire.h"
+
+namespace {
+
+using namespace mavsdk::mavsdk_server;
+using google::protobuf::io::CodedInputStream;
+using google::protobuf::io::CodedOutputStream;
+using google::protobuf::io::StringOutputStream;
+using google::protobuf::internal::WireFormatLite;
+
+TEST(MavlinkFramesWire, decodesPackedMessageIdsLikeProtobufEncodes)
+{
+    std::string data;
+    {
+        StringOutputStream output(&data);
+        CodedOutputStream coded(&output);
+        const std::vector<uint32_t> message_ids{0, 30, 12915};
+        std::string packed;
+        {
+            StringOutputStream packed_output(&packed);
+            CodedOutputStream packed_coded(&packed_output);
+            for (const auto message_id : message_ids) {
+                packed_coded.WriteVarint32(message_id);
+            }
+        }
+        WireFormatLite::WriteBytes(1, packed, &coded);
+        WireFormatLite::WriteUInt32(2, 10, &coded);
+    }
+
+    SubscribeFramesRequest request;
+    ASSERT_TRUE(decode_subscribe_frames_request(data, request));
+    EXPECT_EQ(request.message_ids, (std::vector<uint32_t>{0, 30, 12915}));
+    EXPECT_EQ(request.max_frames_per_response, 10);
+}
+
+TEST(MavlinkFramesWire, decodesUnpackedMessageIdsAndSkipsUnknownFields)
+{
+    std::string data;
+    {
+        StringOutputStream output(&data);
+        CodedOutputStream coded(&output);
+        WireFormatLite::WriteUInt32(1, 33, &coded);
+        WireFormatLite::WriteString(7, "unknown", &coded);
+        WireFormatLite::WriteFixed64(8, 42, &coded);
+        WireFormatLite::WriteUInt32(1, 24, &coded);
+    }
+
+    SubscribeFramesRequest request;
+    ASSERT_TRUE(decode_subscribe_frames_request(data, request));
+    EXPECT_EQ(request.message_ids, (std::vector<uint32_t>{33, 24}));
+    EXPECT_EQ(request.max_frames_per_response, 0);
+}
+
+TEST(MavlinkFramesWire, decodesFramesAndRejectsTruncatedRequests)
+{
+    std::string data;
+    {
+        StringOutputStream output(&data);
+        CodedOutputStream coded(&output);
+        std::vector<std::string> frames{"abc", "defg"};
+        for (const auto& frame : frames) {
+            WireFormatLite::WriteBytes(1, frame, &coded);
+        }
+    }
+
+    std::vector<std::string> frames;
+    ASSERT_TRUE(decode_send_frames_request(data, frames));
+    EXPECT_EQ(frames, (std::vector<std::string>{"abc", "defg"}));
+
+    frames.clear();
+    EXPECT_FALSE(decode_send_frames_request(data.substr(0, data.size() - 1), frames));
+
+    SubscribeFramesRequest request;
+    EXPECT_FALSE(decode_subscribe_frames_request(std::string(1, '\x08'), request));
+}
+
+TEST(MavlinkFramesWire, encodesFramesResponseProtobufCanRead)
+{
+    const std::vector<std::string> frames{std::string("\xfd\x09\x00", 3), std::string(300, 'x')};
+    std::string data;
+    encode_frames_response(frames.data(), frames.size(), 5, data);
+
+    CodedInputStream input(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    std::vector<std::string> decoded;
+    uint64_t dropped = 0;
+    while (const auto tag = input.ReadTag()) {
+        if (WireFormatLite::GetTagFieldNumber(tag) == 1) {
+            std::string frame;
+            ASSERT_TRUE(WireFormatLite::ReadBytes(&input, &frame));
+            decoded.push_back(frame);
+        } else {
+            ASSERT_EQ(WireFormatLite::GetTagFieldNumber(tag), 2);
+            ASSERT_TRUE(input.ReadVarint64(&dropped));
+        }
+    }
+
+    EXPECT_EQ(decoded, frames);
+    EXPECT_EQ(dropped, 5);
+}
+
+TEST(MavlinkFramesWire, leavesOutDefaultValues)
+{
+    std::string data;
+    encode_send_frames_response(0, 0, data);
+    EXPECT_TRUE(data.empty());
+
+    encode_send_frames_response(3, 1, data);
+    EXPECT_EQ(data, std::string("\x08\x03\x10\x01", 4));
+}
+
+} // namespace
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if !defined(WINDOWS)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "metrics_endpoint.h"
+#include "server_metrics.h"
+
+namespace {
+
+using namespace mavsdk::mavsdk_server;
+
+static const std::string upload_mission = "/mavsdk.rpc.mission.MissionService/UploadMission";
+
+TEST(ServerMetrics, rendersRpcCounters)
+{
+    ServerMetrics metrics;
+    auto& entry = metrics.entry_for(upload_mission);
+    entry.started = 3;
+    entry.handled = 2;
+    entry.failed = 1;
+    entry.bytes_sent = 128;
+    entry.latency.record(2000000);
+
+    EXPECT_EQ(&entry, &metrics.entry_for(upload_mission));
+
+    std::ostringstream out;
+    metrics.render(out);
+    const auto text = out.str();
+
+    const std::string labels = "{method=\"" + upload_mission + "\"}";
+    EXPECT_NE(text.find("mavsdk_server_rpc_started_total" + labels + " 3\n"), std::string::npos);
+    EXPECT_NE(text.find("mavsdk_server_rpc_handled_total" + labels + " 2\n"), std::string::npos);
+    EXPECT_NE(text.find("mavsdk_server_rpc_failed_total" + labels + " 1\n"), std::string::npos);
+    EXPECT_NE(
+        text.find("mavsdk_server_rpc_sent_bytes_total" + labels + " 128\n"), std::string::npos);
+    EXPECT_NE(
+        text.find("mavsdk_server_rpc_duration_seconds_count" + labels + " 1\n"),
+        std::string::npos);
+    EXPECT_NE(text.find("# TYPE mavsdk_server_rpc_duration_seconds summary"), std::string::npos);
+}
+
+TEST(ServerMetrics, sumsStreamsPerRpc)
+{
+    std::vector<StreamOutboxStats> streams{
+        {"telemetry", "SubscribePosition", 3, 1},
+        {"telemetry", "SubscribePosition", 2, 4},
+        {"telemetry", "SubscribeBattery", 0, 0},
+    };
+
+    std::ostringstream out;
+    render_stream_metrics(out, streams);
+    const auto text = out.str();
+
+    const std::string position = "{service=\"telemetry\",rpc=\"SubscribePosition\"}";
+    EXPECT_NE(text.find("mavsdk_server_streams_open" + position + " 2\n"), std::string::npos);
+    EXPECT_NE(
+        text.find("mavsdk_server_stream_queue_depth" + position + " 5\n"), std::string::npos);
+    EXPECT_NE(text.find("mavsdk_server_stream_dropped" + position + " 5\n"), std::string::npos);
+    EXPECT_NE(
+        text.find("mavsdk_server_streams_open{service=\"telemetry\",rpc=\"SubscribeBattery\"} 1\n"),
+        std::string::npos);
+}
+
+TEST(ServerMetrics, rendersCallbackQueue)
+{
+    mavsdk::Mavsdk::CallbackQueueStats callback_queue;
+    callback_queue.depth = 7;
+    callback_queue.dropped = 2;
+
+    mavsdk::Mavsdk::ConnectionStats connection;
+    connection.link.bytes_received = 1000;
+
+    std::ostringstream out;
+    render_mavsdk_metrics(out, callback_queue, {connection});
+    const auto text = out.str();
+
+    EXPECT_NE(text.find("mavsdk_callback_queue_depth 7\n"), std::string::npos);
+    EXPECT_NE(text.find("mavsdk_callbacks_dropped_total 2\n"), std::string::npos);
+    EXPECT_NE(
+        text.find("mavsdk_connection_received_bytes_total{connection=\"0\"} 1000\n"),
+        std::string::npos);
+}
+
+#if !defined(WINDOWS)
+std::string http_get(int port, const std::string& path)
+{
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return {};
+    }
+
+    const std::string request = "GET " + path + " HTTP/1.0\r\n\r\n";
+    send(fd, request.data(), request.size(), 0);
+
+    std::string response;
+    char buffer[1024];
+    ssize_t received;
+    while ((received = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, static_cast<std::size_t>(received));
+    }
+    close(fd);
+    return response;
+}
+
+TEST(MetricsEndpoint, servesMetrics)
+{
+    MetricsEndpoint endpoint;
+    ASSERT_TRUE(endpoint.start(0, []() { return std::string("mavsdk_test 1\n"); }));
+    ASSERT_NE(endpoint.port(), 0);
+
+    const auto response = http_get(endpoint.port(), "/metrics");
+    EXPECT_EQ(response.rfind("HTTP/1.0 200 OK\r\n", 0), 0u);
+    EXPECT_NE(response.find("\r\n\r\nmavsdk_test 1\n"), std::string::npos);
+
+    EXPECT_EQ(http_get(endpoint.port(), "/").rfind("HTTP/1.0 404", 0), 0u);
+
+    endpoint.stop();
+}
+#endif
+
+} // namespace
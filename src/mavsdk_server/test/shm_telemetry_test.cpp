@@ -0,0 +1,208 @@
+#if !defined(WINDOWS) && !defined(ANDROID)
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "shm_telemetry_publisher.h"
+
+namespace {
+
+using namespace mavsdk::mavsdk_server;
+using mavsdk::Telemetry;
+
+static const std::string shm_name = "/mavsdk_server_shm_telemetry_test";
+
+// Maps the segment a second time, read-only, the way another process would.
+class ShmReader {
+public:
+    explicit ShmReader(const std::string& name)
+    {
+        const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st {};
+        fstat(fd, &st);
+        _size = static_cast<std::size_t>(st.st_size);
+        void* memory = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (memory != MAP_FAILED) {
+            _header = static_cast<const shm_telemetry::Header*>(memory);
+        }
+    }
+
+    ~ShmReader()
+    {
+        if (_header != nullptr) {
+            munmap(const_cast<shm_telemetry::Header*>(_header), _size);
+        }
+    }
+
+    const shm_telemetry::Header* header() const { return _header; }
+
+private:
+    const shm_telemetry::Header* _header{nullptr};
+    std::size_t _size{0};
+};
+
+Telemetry::Imu make_imu(uint64_t i)
+{
+    Telemetry::Imu imu;
+    imu.timestamp_us = i;
+    imu.acceleration_frd.forward_m_s2 = static_cast<float>(i);
+    imu.acceleration_frd.right_m_s2 = static_cast<float>(i) + 1.0f;
+    imu.acceleration_frd.down_m_s2 = -9.81f;
+    imu.temperature_degc = 25.0f;
+    return imu;
+}
+
+TEST(ShmTelemetry, headerDescribesRings)
+{
+    ShmTelemetryPublisher publisher;
+    ASSERT_TRUE(publisher.open(shm_name, 8));
+
+    ShmReader reader(shm_name);
+    ASSERT_NE(reader.header(), nullptr);
+
+    const auto& header = *reader.header();
+    EXPECT_EQ(header.magic.load(), shm_telemetry::magic);
+    EXPECT_EQ(header.version, shm_telemetry::version);
+    EXPECT_EQ(header.topic_count, shm_telemetry::topic_count);
+
+    const auto* imu_ring = shm_telemetry::ring(header, shm_telemetry::Topic::Imu);
+    ASSERT_NE(imu_ring, nullptr);
+    EXPECT_EQ(imu_ring->slot_count, 8u);
+    EXPECT_EQ(imu_ring->sample_size, sizeof(shm_telemetry::ImuSample));
+    EXPECT_EQ(imu_ring->write_count.load(), 0u);
+
+    const auto* odometry_ring = shm_telemetry::ring(header, shm_telemetry::Topic::Odometry);
+    ASSERT_NE(odometry_ring, nullptr);
+    EXPECT_EQ(odometry_ring->sample_size, sizeof(shm_telemetry::OdometrySample));
+    EXPECT_LE(
+        reinterpret_cast<const char*>(odometry_ring) - reinterpret_cast<const char*>(&header) +
+            odometry_ring->slots_offset + odometry_ring->slot_count * odometry_ring->slot_size,
+        header.segment_size);
+}
+
+TEST(ShmTelemetry, readsLatestSampleInPlace)
+{
+    ShmTelemetryPublisher publisher;
+    ASSERT_TRUE(publisher.open(shm_name, 8));
+    ShmReader reader(shm_name);
+    ASSERT_NE(reader.header(), nullptr);
+    const auto* ring = shm_telemetry::ring(*reader.header(), shm_telemetry::Topic::Imu);
+    ASSERT_NE(ring, nullptr);
+
+    shm_telemetry::ImuSample sample{};
+    EXPECT_EQ(shm_telemetry::read_latest(*ring, sample), 0u);
+
+    publisher.publish(make_imu(1));
+    publisher.publish(make_imu(2));
+
+    EXPECT_EQ(shm_telemetry::read_latest(*ring, sample), 2u);
+    EXPECT_EQ(sample.timestamp_us, 2u);
+    EXPECT_FLOAT_EQ(sample.acceleration_frd_m_s2[1], 3.0f);
+    EXPECT_FLOAT_EQ(sample.temperature_degc, 25.0f);
+
+    uint64_t timestamp = 0;
+    EXPECT_TRUE(shm_telemetry::read<shm_telemetry::ImuSample>(
+        *ring, 1, [&](const shm_telemetry::ImuSample& in_place) {
+            timestamp = in_place.timestamp_us;
+        }));
+    EXPECT_EQ(timestamp, 1u);
+}
+
+TEST(ShmTelemetry, lappedSamplesAreRejected)
+{
+    ShmTelemetryPublisher publisher;
+    ASSERT_TRUE(publisher.open(shm_name, 4));
+    const auto* ring = shm_telemetry::ring(*publisher.header(), shm_telemetry::Topic::Imu);
+    ASSERT_NE(ring, nullptr);
+
+    for (uint64_t i = 1; i <= 6; ++i) {
+        publisher.publish(make_imu(i));
+    }
+
+    auto ignore = [](const shm_telemetry::ImuSample&) {};
+    EXPECT_FALSE(shm_telemetry::read<shm_telemetry::ImuSample>(*ring, 2, ignore));
+    EXPECT_TRUE(shm_telemetry::read<shm_telemetry::ImuSample>(*ring, 3, ignore));
+    EXPECT_TRUE(shm_telemetry::read<shm_telemetry::ImuSample>(*ring, 6, ignore));
+    EXPECT_FALSE(shm_telemetry::read<shm_telemetry::ImuSample>(*ring, 7, ignore));
+}
+
+TEST(ShmTelemetry, odometryCovarianceIsPaddedWithNan)
+{
+    ShmTelemetryPublisher publisher;
+    ASSERT_TRUE(publisher.open(shm_name));
+    const auto* ring = shm_telemetry::ring(*publisher.header(), shm_telemetry::Topic::Odometry);
+    ASSERT_NE(ring, nullptr);
+
+    Telemetry::Odometry odometry;
+    odometry.time_usec = 42;
+    odometry.q.w = 1.0f;
+    odometry.pose_covariance.covariance_matrix = {0.5f, 0.25f};
+
+    publisher.publish(odometry);
+
+    shm_telemetry::OdometrySample sample{};
+    EXPECT_EQ(shm_telemetry::read_latest(*ring, sample), 1u);
+    EXPECT_EQ(sample.time_usec, 42u);
+    EXPECT_FLOAT_EQ(sample.q[0], 1.0f);
+    EXPECT_FLOAT_EQ(sample.pose_covariance[1], 0.25f);
+    EXPECT_TRUE(std::isnan(sample.pose_covariance[2]));
+    EXPECT_TRUE(std::isnan(sample.velocity_covariance[0]));
+}
+
+TEST(ShmTelemetry, concurrentReaderNeverSeesTornSample)
+{
+    ShmTelemetryPublisher publisher;
+    ASSERT_TRUE(publisher.open(shm_name, 2));
+    const auto* ring = shm_telemetry::ring(*publisher.header(), shm_telemetry::Topic::Imu);
+    ASSERT_NE(ring, nullptr);
+
+    static constexpr uint64_t num_samples = 100000;
+    std::atomic<bool> torn{false};
+
+    std::thread reader([&]() {
+        shm_telemetry::ImuSample sample{};
+        uint64_t n = 0;
+        while (n < num_samples) {
+            n = shm_telemetry::read_latest(*ring, sample);
+            if (n != 0 && (sample.timestamp_us != n ||
+                           sample.acceleration_frd_m_s2[1] != static_cast<float>(n) + 1.0f)) {
+                torn = true;
+            }
+        }
+    });
+
+    for (uint64_t i = 1; i <= num_samples; ++i) {
+        publisher.publish(make_imu(i));
+    }
+    reader.join();
+
+    EXPECT_FALSE(torn);
+}
+
+TEST(ShmTelemetry, closeRemovesSegment)
+{
+    ShmTelemetryPublisher publisher;
+    ASSERT_TRUE(publisher.open(shm_name));
+    publisher.close();
+
+    EXPECT_EQ(publisher.header(), nullptr);
+    EXPECT_LT(shm_open(shm_name.c_str(), O_RDONLY, 0), 0);
+}
+
+} // namespace
+
+#endif
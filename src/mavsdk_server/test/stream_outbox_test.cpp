@@ -0,0 +1,131 @@
+#include <chrono>
+#include <future>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "stream_outbox.h"
+
+namespace {
+
+using StreamOutbox = mavsdk::mavsdk_server::StreamOutbox<int>;
+using StreamOutboxPolicy = mavsdk::mavsdk_server::StreamOutboxPolicy;
+
+TEST(StreamOutbox, popsInOrder)
+{
+    StreamOutbox outbox;
+    outbox.push(1);
+    outbox.push(2);
+
+    int value = 0;
+    ASSERT_TRUE(outbox.pop(value));
+    EXPECT_EQ(1, value);
+    ASSERT_TRUE(outbox.pop(value));
+    EXPECT_EQ(2, value);
+}
+
+TEST(StreamOutbox, dropsOldestWhenFull)
+{
+    StreamOutbox outbox(StreamOutboxPolicy::Queue, 2);
+    outbox.push(1);
+    outbox.push(2);
+    outbox.push(3);
+
+    EXPECT_EQ(1, outbox.dropped());
+
+    int value = 0;
+    ASSERT_TRUE(outbox.pop(value));
+    EXPECT_EQ(2, value);
+    ASSERT_TRUE(outbox.pop(value));
+    EXPECT_EQ(3, value);
+}
+
+TEST(StreamOutbox, conflateKeepsLatestOnly)
+{
+    StreamOutbox outbox(StreamOutboxPolicy::Conflate);
+    outbox.push(1);
+    outbox.push(2);
+    outbox.push(3);
+
+    EXPECT_EQ(2, outbox.dropped());
+
+    int value = 0;
+    ASSERT_TRUE(outbox.pop(value));
+    EXPECT_EQ(3, value);
+
+    outbox.push(4);
+    ASSERT_TRUE(outbox.pop(value));
+    EXPECT_EQ(4, value);
+}
+
+TEST(StreamOutbox, reusesStorageInSteadyState)
+{
+    mavsdk::mavsdk_server::StreamOutbox<std::vector<int>> outbox(StreamOutboxPolicy::Conflate);
+    const auto fill = [](std::vector<int>& slot) { slot.assign(64, 42); };
+
+    std::vector<int> response;
+    outbox.emplace(fill);
+    ASSERT_TRUE(outbox.pop(response));
+    outbox.emplace(fill);
+    ASSERT_TRUE(outbox.pop(response));
+
+    // From now on the same two buffers are handed back and forth.
+    const auto* first = response.data();
+    outbox.emplace(fill);
+    ASSERT_TRUE(outbox.pop(response));
+    const auto* second = response.data();
+    outbox.emplace(fill);
+    ASSERT_TRUE(outbox.pop(response));
+
+    EXPECT_NE(first, second);
+    EXPECT_EQ(first, response.data());
+    EXPECT_EQ(64, response.size());
+}
+
+TEST(StreamOutbox, drainsBeforeReportingClosed)
+{
+    StreamOutbox outbox;
+    outbox.push(1);
+    outbox.close();
+    outbox.push(2);
+
+    int value = 0;
+    ASSERT_TRUE(outbox.pop(value));
+    EXPECT_EQ(1, value);
+    EXPECT_FALSE(outbox.pop(value));
+}
+
+TEST(StreamOutbox, closeWakesUpWaitingPop)
+{
+    StreamOutbox outbox;
+
+    auto pop_future = std::async(std::launch::async, [&outbox]() {
+        int value = 0;
+        return outbox.pop(value);
+    });
+
+    EXPECT_EQ(std::future_status::timeout, pop_future.wait_for(std::chrono::milliseconds(20)));
+    outbox.close();
+    EXPECT_FALSE(pop_future.get());
+}
+
+TEST(StreamOutbox, popUntilTimesOut)
+{
+    StreamOutbox outbox;
+    int value = 0;
+    EXPECT_EQ(
+        mavsdk::mavsdk_server::StreamOutboxPopResult::TimedOut,
+        outbox.pop_until(value, std::chrono::steady_clock::now() + std::chrono::milliseconds(5)));
+
+    outbox.push(1);
+    EXPECT_EQ(
+        mavsdk::mavsdk_server::StreamOutboxPopResult::Popped,
+        outbox.pop_until(value, std::chrono::steady_clock::now()));
+    EXPECT_EQ(1, value);
+
+    outbox.close();
+    EXPECT_EQ(
+        mavsdk::mavsdk_server::StreamOutboxPopResult::Closed,
+        outbox.pop_until(value, std::chrono::steady_clock::now()));
+}
+
+} // namespace
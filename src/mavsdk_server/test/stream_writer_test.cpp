@@ -0,0 +1,151 @@
+#include <chrono>
+#include <future>
+#include <gtest/gtest.h>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "stream_writer.h"
+
+namespace {
+
+using mavsdk::mavsdk_server::stream_options_from_metadata;
+using mavsdk::mavsdk_server::StreamOptions;
+using mavsdk::mavsdk_server::StreamOutbox;
+
+// Records what is written, and whether gRPC was asked to buffer it.
+struct FakeWriter {
+    struct Written {
+        int response;
+        bool buffered;
+    };
+
+    bool Write(const int& response, grpc::WriteOptions options = {})
+    {
+        writes.push_back({response, options.get_buffer_hint()});
+        return !fail;
+    }
+
+    std::vector<Written> writes{};
+    bool fail{false};
+};
+
+std::multimap<grpc::string_ref, grpc::string_ref>
+metadata(const std::vector<std::pair<const char*, const char*>>& entries)
+{
+    std::multimap<grpc::string_ref, grpc::string_ref> result;
+    for (const auto& entry : entries) {
+        result.emplace(entry.first, entry.second);
+    }
+    return result;
+}
+
+TEST(StreamWriter, parsesOptions)
+{
+    const auto none = stream_options_from_metadata(metadata({}));
+    EXPECT_FALSE(none.compression);
+    EXPECT_FALSE(none.batching());
+
+    const auto options = stream_options_from_metadata(metadata(
+        {{"mavsdk-compression", "gzip"},
+         {"mavsdk-batch-samples", "10"},
+         {"mavsdk-batch-ms", "50"}}));
+    EXPECT_EQ(GRPC_COMPRESS_GZIP, options.compression);
+    EXPECT_EQ(10u, options.batch_samples);
+    EXPECT_EQ(std::chrono::milliseconds(50), options.batch_period);
+
+    const auto period_only = stream_options_from_metadata(
+        metadata({{"mavsdk-compression", "deflate"}, {"mavsdk-batch-ms", "20"}}));
+    EXPECT_EQ(GRPC_COMPRESS_DEFLATE, period_only.compression);
+    EXPECT_EQ(StreamOptions::max_batch_samples, period_only.batch_samples);
+    EXPECT_TRUE(period_only.batching());
+}
+
+TEST(StreamWriter, ignoresInvalidOptions)
+{
+    const auto options = stream_options_from_metadata(metadata(
+        {{"mavsdk-compression", "zstd"},
+         {"mavsdk-batch-samples", "0"},
+         {"mavsdk-batch-ms", "soon"}}));
+    EXPECT_FALSE(options.compression);
+    EXPECT_FALSE(options.batching());
+
+    EXPECT_FALSE(
+        stream_options_from_metadata(metadata({{"mavsdk-batch-samples", "100000"}})).batching());
+}
+
+TEST(StreamWriter, writesOneByOneByDefault)
+{
+    StreamOutbox<int> outbox;
+    outbox.push(1);
+    outbox.push(2);
+    outbox.close();
+
+    FakeWriter writer;
+    EXPECT_TRUE(write_stream(StreamOptions{}, &writer, outbox));
+
+    ASSERT_EQ(2u, writer.writes.size());
+    EXPECT_FALSE(writer.writes[0].buffered);
+    EXPECT_FALSE(writer.writes[1].buffered);
+}
+
+TEST(StreamWriter, batchesSamples)
+{
+    StreamOutbox<int> outbox;
+    for (int i = 1; i <= 7; ++i) {
+        outbox.push(i);
+    }
+    outbox.close();
+
+    StreamOptions options;
+    options.batch_samples = 3;
+    FakeWriter writer;
+    EXPECT_TRUE(write_stream(options, &writer, outbox));
+
+    // Two full batches, and what is left once the stream ends.
+    ASSERT_EQ(7u, writer.writes.size());
+    const std::vector<bool> buffered{true, true, false, true, true, false, false};
+    for (std::size_t i = 0; i < writer.writes.size(); ++i) {
+        EXPECT_EQ(int(i + 1), writer.writes[i].response);
+        EXPECT_EQ(buffered[i], writer.writes[i].buffered);
+    }
+}
+
+TEST(StreamWriter, flushesBatchAfterPeriod)
+{
+    StreamOutbox<int> outbox;
+    StreamOptions options;
+    options.batch_samples = 100;
+    options.batch_period = std::chrono::milliseconds(20);
+
+    FakeWriter writer;
+    auto writing = std::async(
+        std::launch::async, [&]() { return write_stream(options, &writer, outbox); });
+
+    outbox.push(1);
+    outbox.push(2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    outbox.close();
+    EXPECT_TRUE(writing.get());
+
+    // Written when the period was up, not only when the stream ended.
+    ASSERT_EQ(2u, writer.writes.size());
+    EXPECT_TRUE(writer.writes[0].buffered);
+    EXPECT_FALSE(writer.writes[1].buffered);
+}
+
+TEST(StreamWriter, stopsWhenClientIsGone)
+{
+    StreamOutbox<int> outbox;
+    outbox.push(1);
+    outbox.push(2);
+
+    StreamOptions options;
+    options.batch_samples = 2;
+    FakeWriter writer;
+    writer.fail = true;
+    EXPECT_FALSE(write_stream(options, &writer, outbox));
+    EXPECT_EQ(1u, writer.writes.size());
+}
+
+} // namespace
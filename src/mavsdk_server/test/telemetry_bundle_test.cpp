@@ -0,0 +1,155 @@
+#include <chrono>
+#include <future>
+#include <gtest/gtest.h>
+
+#include "telemetry/telemetry_bundle.h"
+
+namespace {
+
+using Telemetry = mavsdk::Telemetry;
+
+// Keeps the last callback per topic so the test can publish updates.
+class FakeTelemetry {
+public:
+    Telemetry::PositionHandle subscribe_position(
+        const Telemetry::PositionCallback& callback, const mavsdk::SubscriptionOptions&)
+    {
+        position_callback = callback;
+        return {};
+    }
+    void unsubscribe_position(Telemetry::PositionHandle) {}
+
+    Telemetry::AttitudeEulerHandle subscribe_attitude_euler(
+        const Telemetry::AttitudeEulerCallback& callback, const mavsdk::SubscriptionOptions&)
+    {
+        attitude_euler_callback = callback;
+        return {};
+    }
+    void unsubscribe_attitude_euler(Telemetry::AttitudeEulerHandle) {}
+
+    Telemetry::BatteryHandle subscribe_battery(
+        const Telemetry::BatteryCallback& callback, const mavsdk::SubscriptionOptions&)
+    {
+        battery_callback = callback;
+        return {};
+    }
+    void unsubscribe_battery(Telemetry::BatteryHandle) {}
+
+    Telemetry::GpsInfoHandle subscribe_gps_info(
+        const Telemetry::GpsInfoCallback& callback, const mavsdk::SubscriptionOptions&)
+    {
+        gps_info_callback = callback;
+        return {};
+    }
+    void unsubscribe_gps_info(Telemetry::GpsInfoHandle) {}
+
+    Telemetry::FlightModeHandle subscribe_flight_mode(
+        const Telemetry::FlightModeCallback& callback, const mavsdk::SubscriptionOptions&)
+    {
+        flight_mode_callback = callback;
+        return {};
+    }
+    void unsubscribe_flight_mode(Telemetry::FlightModeHandle) {}
+
+    Telemetry::PositionCallback position_callback{};
+    Telemetry::AttitudeEulerCallback attitude_euler_callback{};
+    Telemetry::BatteryCallback battery_callback{};
+    Telemetry::GpsInfoCallback gps_info_callback{};
+    Telemetry::FlightModeCallback flight_mode_callback{};
+};
+
+using TelemetryBundle = mavsdk::mavsdk_server::TelemetryBundle<FakeTelemetry>;
+
+Telemetry::Position create_position(double latitude_deg)
+{
+    Telemetry::Position position;
+    position.latitude_deg = latitude_deg;
+    position.longitude_deg = 8.5;
+    position.absolute_altitude_m = 500.0f;
+    position.relative_altitude_m = 10.0f;
+    return position;
+}
+
+TEST(TelemetryBundle, onlySubscribesToRequestedTopics)
+{
+    FakeTelemetry telemetry;
+    TelemetryBundle bundle(telemetry, TelemetryBundle::Position | TelemetryBundle::FlightMode, 0.0);
+
+    EXPECT_TRUE(telemetry.position_callback);
+    EXPECT_TRUE(telemetry.flight_mode_callback);
+    EXPECT_FALSE(telemetry.attitude_euler_callback);
+    EXPECT_FALSE(telemetry.battery_callback);
+    EXPECT_FALSE(telemetry.gps_info_callback);
+}
+
+TEST(TelemetryBundle, combinesChangedTopics)
+{
+    FakeTelemetry telemetry;
+    TelemetryBundle bundle(telemetry, TelemetryBundle::Position | TelemetryBundle::FlightMode, 0.0);
+
+    telemetry.position_callback(create_position(47.0));
+    telemetry.flight_mode_callback(Telemetry::FlightMode::Hold);
+
+    TelemetryBundle::Changes changes;
+    ASSERT_TRUE(bundle.wait_for_changes(changes));
+    ASSERT_TRUE(changes.position);
+    EXPECT_EQ(create_position(47.0), *changes.position);
+    ASSERT_TRUE(changes.flight_mode);
+    EXPECT_EQ(Telemetry::FlightMode::Hold, *changes.flight_mode);
+}
+
+TEST(TelemetryBundle, leavesOutUnchangedTopics)
+{
+    FakeTelemetry telemetry;
+    TelemetryBundle bundle(telemetry, TelemetryBundle::Position | TelemetryBundle::FlightMode, 0.0);
+
+    telemetry.position_callback(create_position(47.0));
+    telemetry.flight_mode_callback(Telemetry::FlightMode::Hold);
+
+    TelemetryBundle::Changes changes;
+    ASSERT_TRUE(bundle.wait_for_changes(changes));
+
+    telemetry.position_callback(create_position(47.1));
+    telemetry.flight_mode_callback(Telemetry::FlightMode::Hold);
+
+    ASSERT_TRUE(bundle.wait_for_changes(changes));
+    ASSERT_TRUE(changes.position);
+    EXPECT_EQ(create_position(47.1), *changes.position);
+    EXPECT_FALSE(changes.flight_mode);
+}
+
+TEST(TelemetryBundle, limitsUpdateRate)
+{
+    FakeTelemetry telemetry;
+    TelemetryBundle bundle(telemetry, TelemetryBundle::Position, 10.0);
+
+    telemetry.position_callback(create_position(47.0));
+
+    TelemetryBundle::Changes changes;
+    ASSERT_TRUE(bundle.wait_for_changes(changes));
+
+    const auto start = std::chrono::steady_clock::now();
+    telemetry.position_callback(create_position(47.1));
+    telemetry.position_callback(create_position(47.2));
+
+    ASSERT_TRUE(bundle.wait_for_changes(changes));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+    ASSERT_TRUE(changes.position);
+    EXPECT_EQ(create_position(47.2), *changes.position);
+}
+
+TEST(TelemetryBundle, closeWakesUpWaiter)
+{
+    FakeTelemetry telemetry;
+    TelemetryBundle bundle(telemetry, TelemetryBundle::Position, 0.0);
+
+    auto wait_future = std::async(std::launch::async, [&bundle]() {
+        TelemetryBundle::Changes changes;
+        return bundle.wait_for_changes(changes);
+    });
+
+    bundle.close();
+    EXPECT_FALSE(wait_future.get());
+}
+
+} // namespace
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <string>
+
+#include "telemetry/telemetry.pb.h"
+#include "telemetry/telemetry_bundle_wire.h"
+
+namespace {
+
+using namespace mavsdk::mavsdk_server;
+using google::protobuf::io::CodedInputStream;
+using google::protobuf::io::CodedOutputStream;
+using google::protobuf::io::StringOutputStream;
+using google::protobuf::internal::WireFormatLite;
+using Topic = TelemetryBundle<>::Topic;
+
+TEST(TelemetryBundleWire, decodesRequestLikeProtobufEncodes)
+{
+    std::string data;
+    {
+        StringOutputStream output(&data);
+        CodedOutputStream coded(&output);
+        WireFormatLite::WriteBool(1, true, &coded);
+        WireFormatLite::WriteBool(4, true, &coded);
+        WireFormatLite::WriteDouble(6, 5.0, &coded);
+        // Unknown, e.g. from a newer client.
+        WireFormatLite::WriteUInt32(9, 3, &coded);
+    }
+
+    SubscribeTelemetryBundleRequest request;
+    ASSERT_TRUE(decode_subscribe_telemetry_bundle_request(data, request));
+    EXPECT_EQ(request.topics, Topic::Position | Topic::GpsInfo);
+    EXPECT_DOUBLE_EQ(request.max_rate_hz, 5.0);
+}
+
+TEST(TelemetryBundleWire, lastValueOfTopicCounts)
+{
+    std::string data;
+    {
+        StringOutputStream output(&data);
+        CodedOutputStream coded(&output);
+        WireFormatLite::WriteBool(2, true, &coded);
+        WireFormatLite::WriteBool(3, true, &coded);
+        WireFormatLite::WriteBool(2, false, &coded);
+    }
+
+    SubscribeTelemetryBundleRequest request;
+    ASSERT_TRUE(decode_subscribe_telemetry_bundle_request(data, request));
+    EXPECT_EQ(request.topics, Topic::Battery);
+}
+
+TEST(TelemetryBundleWire, rejectsTruncatedRequest)
+{
+    std::string data;
+    {
+        StringOutputStream output(&data);
+        CodedOutputStream coded(&output);
+        WireFormatLite::WriteDouble(6, 5.0, &coded);
+    }
+    data.pop_back();
+
+    SubscribeTelemetryBundleRequest request;
+    EXPECT_FALSE(decode_subscribe_telemetry_bundle_request(data, request));
+}
+
+TEST(TelemetryBundleWire, encodesChangedTopicsAsTelemetryMessages)
+{
+    TelemetryBundleChanges changes;
+    changes.position = mavsdk::Telemetry::Position{};
+    changes.position->latitude_deg = 47.39;
+    changes.position->relative_altitude_m = 10.5f;
+    changes.flight_mode = mavsdk::Telemetry::FlightMode::Hold;
+
+    std::string data;
+    encode_telemetry_bundle_response(changes, data);
+
+    CodedInputStream input(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+
+    auto tag = input.ReadTag();
+    ASSERT_EQ(WireFormatLite::GetTagFieldNumber(tag), 1);
+    std::string message;
+    ASSERT_TRUE(WireFormatLite::ReadBytes(&input, &message));
+    mavsdk::rpc::telemetry::Position position;
+    ASSERT_TRUE(position.ParseFromString(message));
+    EXPECT_DOUBLE_EQ(position.latitude_deg(), 47.39);
+    EXPECT_FLOAT_EQ(position.relative_altitude_m(), 10.5f);
+
+    tag = input.ReadTag();
+    ASSERT_EQ(WireFormatLite::GetTagFieldNumber(tag), 5);
+    uint32_t flight_mode;
+    ASSERT_TRUE(input.ReadVarint32(&flight_mode));
+    EXPECT_EQ(flight_mode, mavsdk::rpc::telemetry::FLIGHT_MODE_HOLD);
+
+    EXPECT_EQ(input.ReadTag(), 0);
+}
+
+TEST(TelemetryBundleWire, writesFlightModeEvenIfUnknown)
+{
+    TelemetryBundleChanges changes;
+    changes.flight_mode = mavsdk::Telemetry::FlightMode::Unknown;
+
+    std::string data;
+    encode_telemetry_bundle_response(changes, data);
+
+    CodedInputStream input(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    ASSERT_EQ(WireFormatLite::GetTagFieldNumber(input.ReadTag()), 5);
+    uint32_t flight_mode;
+    ASSERT_TRUE(input.ReadVarint32(&flight_mode));
+    EXPECT_EQ(flight_mode, mavsdk::rpc::telemetry::FLIGHT_MODE_UNKNOWN);
+}
+
+TEST(TelemetryBundleWire, encodesNothingWithoutChanges)
+{
+    std::string data;
+    encode_telemetry_bundle_response(TelemetryBundleChanges{}, data);
+    EXPECT_TRUE(data.empty());
+}
+
+} // namespace
@@ -182,6 +182,8 @@ ACTION_P2(SaveCallback, callback, callback_promise)
 {
     *callback = arg0;
     callback_promise->set_value();
+    // The subscription handle, if any.
+    return return_type();
 }
 
 TEST_F(TelemetryServiceImplTest, registersToTelemetryPositionAsync)
@@ -195,6 +197,24 @@ TEST_F(TelemetryServiceImplTest, registersToTelemetryPositionAsync)
     position_stream_future.wait();
 }
 
+TEST_F(TelemetryServiceImplTest, unsubscribesFromPositionWhenStreamEnds)
+{
+    std::promise<void> subscription_promise;
+    auto subscription_future = subscription_promise.get_future();
+    mavsdk::Telemetry::PositionCallback position_callback;
+    EXPECT_CALL(*_telemetry, subscribe_position(_))
+        .WillOnce(SaveCallback(&position_callback, &subscription_promise));
+    // Only its own subscription, others of the same topic are left alone.
+    EXPECT_CALL(*_telemetry, unsubscribe_position(_)).Times(1);
+
+    std::vector<Position> positions;
+    auto position_stream_future = subscribePositionAsync(positions);
+    subscription_future.wait();
+
+    _telemetry_service->stop();
+    position_stream_future.wait();
+}
+
 std::future<void> TelemetryServiceImplTest::subscribePositionAsync(std::vector<Position>& positions)
 {
     return std::async(std::launch::async, [&]() {
@@ -1836,4 +1856,50 @@ TEST_F(TelemetryServiceImplTest, sendsMultipleActuatorOutputStatusEvents)
     checkSendsActuatorOutputStatusEvents(actuator_output_status_events);
 }
 
+// Filling a reused response in place, as the stream handlers do, has to
+// give the same message as a freshly allocated one, also when it is filled
+// again. How long each takes is measured by the benchmarks.
+template<typename Response, typename Fresh, typename InPlace>
+void expectSameInPlace(Fresh fresh, InPlace in_place)
+{
+    Response expected;
+    fresh(expected);
+
+    Response reused;
+    for (int i = 0; i < 3; ++i) {
+        in_place(reused);
+        EXPECT_EQ(expected.SerializeAsString(), reused.SerializeAsString());
+    }
+}
+
+TEST_F(TelemetryServiceImplTest, translatesPositionInPlace)
+{
+    const auto position = createPosition(41.848695, 75.132751, 3002.1f, 50.3f);
+
+    expectSameInPlace<PositionResponse>(
+        [&](PositionResponse& response) {
+            response.set_allocated_position(
+                TelemetryServiceImpl::translateToRpcPosition(position).release());
+        },
+        [&](PositionResponse& response) {
+            TelemetryServiceImpl::translateToRpcPosition(position, response.mutable_position());
+        });
+}
+
+TEST_F(TelemetryServiceImplTest, translatesActuatorOutputStatusInPlace)
+{
+    std::vector<float> actuators(16, 0.5f);
+    const auto status = createActuatorOutputStatus(actuators);
+
+    expectSameInPlace<mavsdk::rpc::telemetry::ActuatorOutputStatusResponse>(
+        [&](mavsdk::rpc::telemetry::ActuatorOutputStatusResponse& response) {
+            response.set_allocated_actuator_output_status(
+                TelemetryServiceImpl::translateToRpcActuatorOutputStatus(status).release());
+        },
+        [&](mavsdk::rpc::telemetry::ActuatorOutputStatusResponse& response) {
+            TelemetryServiceImpl::translateToRpcActuatorOutputStatus(
+                status, response.mutable_actuator_output_status());
+        });
+}
+
 } // namespace